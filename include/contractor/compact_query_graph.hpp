@@ -0,0 +1,239 @@
+#ifndef OSRM_CONTRACTOR_COMPACT_QUERY_GRAPH_HPP
+#define OSRM_CONTRACTOR_COMPACT_QUERY_GRAPH_HPP
+
+#include "contractor/query_edge.hpp"
+#include "contractor/query_graph.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/integer_range.hpp"
+#include "util/prefetch.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
+
+#include "storage/shared_memory_ownership.hpp"
+#include "storage/tar_fwd.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace osrm
+{
+namespace contractor
+{
+namespace detail
+{
+template <storage::Ownership Ownership> class CompactQueryGraph;
+}
+
+namespace serialization
+{
+template <storage::Ownership Ownership>
+void read(storage::tar::FileReader &reader,
+          const std::string &name,
+          detail::CompactQueryGraph<Ownership> &graph);
+
+template <storage::Ownership Ownership>
+void write(storage::tar::FileWriter &writer,
+           const std::string &name,
+           const detail::CompactQueryGraph<Ownership> &graph);
+}
+
+// The part of an edge every relaxation of a search reads
+struct CompactQueryEdge
+{
+    NodeID target;
+    EdgeWeight weight : 30;
+    std::uint32_t forward : 1;
+    std::uint32_t backward : 1;
+};
+
+// The part of an edge only read for durations and to unpack shortcuts
+struct CompactQueryEdgeData
+{
+    // the middle node of a shortcut or the turn of an original edge, see QueryEdge::EdgeData
+    NodeID turn_id : 31;
+    bool shortcut : 1;
+    EdgeWeight duration;
+};
+
+static_assert(sizeof(CompactQueryEdge) == 8, "the searches expect eight edges per cache line");
+
+namespace detail
+{
+
+/**
+ * The contracted graph of the CH queries with the data of an edge split in two arrays.
+ *
+ * The searches relax the edges of a node through its targets, weights and directions only, they
+ * share half as many bytes per edge as QueryGraph. The middle nodes of shortcuts, the turns of
+ * original edges and the durations live in a second array indexed by the same EdgeID.
+ * GetEdgeData() puts both halves back together into a QueryEdge::EdgeData value.
+ */
+template <storage::Ownership Ownership> class CompactQueryGraph
+{
+    template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
+
+  public:
+    using NodeIterator = NodeID;
+    using EdgeIterator = EdgeID;
+    using EdgeRange = util::range<EdgeIterator>;
+    using EdgeData = QueryEdge::EdgeData;
+    using NodeArrayEntry = util::static_graph_details::NodeArrayEntry;
+    using EdgeArrayEntry = CompactQueryEdge;
+
+    static constexpr EdgeWeight MAX_EDGE_WEIGHT = (1 << 29) - 1;
+
+    CompactQueryGraph() = default;
+
+    CompactQueryGraph(Vector<NodeArrayEntry> node_array_,
+                      Vector<CompactQueryEdge> edge_array_,
+                      Vector<CompactQueryEdgeData> edge_data_array_)
+        : node_array(std::move(node_array_)), edge_array(std::move(edge_array_)),
+          edge_data_array(std::move(edge_data_array_))
+    {
+        BOOST_ASSERT(!node_array.empty());
+        BOOST_ASSERT(edge_array.size() == edge_data_array.size());
+        BOOST_ASSERT(node_array.back().first_edge == edge_array.size());
+    }
+
+    // Throws if a weight of the graph does not fit into CompactQueryEdge
+    template <storage::Ownership GraphOwnership>
+    explicit CompactQueryGraph(const QueryGraph<GraphOwnership> &graph)
+    {
+        node_array.reserve(graph.GetNumberOfNodes() + 1);
+        edge_array.reserve(graph.GetNumberOfEdges());
+        edge_data_array.reserve(graph.GetNumberOfEdges());
+
+        for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+        {
+            node_array.push_back(NodeArrayEntry{static_cast<EdgeID>(edge_array.size())});
+            for (const auto edge : graph.GetAdjacentEdgeRange(node))
+            {
+                const auto &data = graph.GetEdgeData(edge);
+                if (data.weight < 0 || data.weight > MAX_EDGE_WEIGHT)
+                {
+                    throw util::exception("Weight " + std::to_string(data.weight) +
+                                          " of a contracted edge is out of the range of the "
+                                          "query graph" +
+                                          SOURCE_REF);
+                }
+
+                edge_array.push_back(CompactQueryEdge{
+                    graph.GetTarget(edge), data.weight, data.forward, data.backward});
+                edge_data_array.push_back(
+                    CompactQueryEdgeData{data.turn_id, data.shortcut, data.duration});
+            }
+        }
+        node_array.push_back(NodeArrayEntry{static_cast<EdgeID>(edge_array.size())});
+    }
+
+    unsigned GetNumberOfNodes() const { return node_array.size() - 1; }
+
+    unsigned GetNumberOfEdges() const { return edge_array.size(); }
+
+    unsigned GetOutDegree(const NodeIterator n) const { return EndEdges(n) - BeginEdges(n); }
+
+    NodeIterator GetTarget(const EdgeIterator e) const { return edge_array[e].target; }
+
+    EdgeData GetEdgeData(const EdgeIterator e) const
+    {
+        const auto &edge = edge_array[e];
+        const auto &data = edge_data_array[e];
+        return EdgeData{
+            data.turn_id, data.shortcut, edge.weight, data.duration, edge.forward, edge.backward};
+    }
+
+    EdgeIterator BeginEdges(const NodeIterator n) const { return node_array[n].first_edge; }
+
+    EdgeIterator EndEdges(const NodeIterator n) const { return node_array[n + 1].first_edge; }
+
+    EdgeRange GetAdjacentEdgeRange(const NodeIterator n) const
+    {
+        return util::irange(BeginEdges(n), EndEdges(n));
+    }
+
+    void PrefetchAdjacentEdgeRange(const NodeIterator n) const
+    {
+        BOOST_ASSERT(n < node_array.size());
+        OSRM_PREFETCH(&node_array[n]);
+    }
+
+    // searches for a specific edge
+    EdgeIterator FindEdge(const NodeIterator from, const NodeIterator to) const
+    {
+        for (const auto edge : GetAdjacentEdgeRange(from))
+        {
+            if (to == edge_array[edge].target)
+            {
+                return edge;
+            }
+        }
+        return SPECIAL_EDGEID;
+    }
+
+    // Same as StaticGraph::FindSmallestEdge, only the candidates to `to` read the second array
+    template <typename FilterFunction>
+    EdgeIterator
+    FindSmallestEdge(const NodeIterator from, const NodeIterator to, FilterFunction &&filter) const
+    {
+        EdgeIterator smallest_edge = SPECIAL_EDGEID;
+        EdgeWeight smallest_weight = INVALID_EDGE_WEIGHT;
+        for (const auto edge : GetAdjacentEdgeRange(from))
+        {
+            const auto &compact_edge = edge_array[edge];
+            if (compact_edge.target == to && compact_edge.weight < smallest_weight &&
+                std::forward<FilterFunction>(filter)(GetEdgeData(edge)))
+            {
+                smallest_edge = edge;
+                smallest_weight = compact_edge.weight;
+            }
+        }
+        return smallest_edge;
+    }
+
+    EdgeIterator FindEdgeInEitherDirection(const NodeIterator from, const NodeIterator to) const
+    {
+        EdgeIterator tmp = FindEdge(from, to);
+        return (SPECIAL_NODEID != tmp ? tmp : FindEdge(to, from));
+    }
+
+    EdgeIterator
+    FindEdgeIndicateIfReverse(const NodeIterator from, const NodeIterator to, bool &result) const
+    {
+        EdgeIterator current_iterator = FindEdge(from, to);
+        if (SPECIAL_NODEID == current_iterator)
+        {
+            current_iterator = FindEdge(to, from);
+            if (SPECIAL_NODEID != current_iterator)
+            {
+                result = true;
+            }
+        }
+        return current_iterator;
+    }
+
+    friend void serialization::read<Ownership>(storage::tar::FileReader &reader,
+                                               const std::string &name,
+                                               CompactQueryGraph<Ownership> &graph);
+    friend void serialization::write<Ownership>(storage::tar::FileWriter &writer,
+                                                const std::string &name,
+                                                const CompactQueryGraph<Ownership> &graph);
+
+  private:
+    Vector<NodeArrayEntry> node_array;
+    Vector<CompactQueryEdge> edge_array;
+    Vector<CompactQueryEdgeData> edge_data_array;
+};
+}
+
+using CompactQueryGraph = detail::CompactQueryGraph<storage::Ownership::Container>;
+using CompactQueryGraphView = detail::CompactQueryGraph<storage::Ownership::View>;
+}
+}
+
+#endif // OSRM_CONTRACTOR_COMPACT_QUERY_GRAPH_HPP
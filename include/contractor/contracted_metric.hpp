@@ -1,7 +1,7 @@
 #ifndef OSMR_CONTRACTOR_CONTRACTED_METRIC_HPP
 #define OSMR_CONTRACTOR_CONTRACTED_METRIC_HPP
 
-#include "contractor/query_graph.hpp"
+#include "contractor/compact_query_graph.hpp"
 
 namespace osrm
 {
@@ -12,7 +12,7 @@ namespace detail
 {
 template <storage::Ownership Ownership> struct ContractedMetric
 {
-    detail::QueryGraph<Ownership> graph;
+    detail::CompactQueryGraph<Ownership> graph;
     std::vector<util::ViewOrVector<bool, Ownership>> edge_filter;
 };
 }
@@ -44,9 +44,12 @@ struct ContractorConfig final : storage::IOConfig
 {
     ContractorConfig()
         : IOConfig({".osrm.ebg", ".osrm.ebg_nodes", ".osrm.properties"},
-                   {},
+                   {".osrm.fileIndex",
+                    ".osrm.cnbg_to_ebg",
+                    ".osrm.maneuver_overrides",
+                    ".osrm.partition"},
                    {".osrm.hsgr", ".osrm.enw"}),
-          requested_num_threads(0)
+          requested_num_threads(0), renumber_nodes(false), reuse_hierarchy(false)
     {
     }
 
@@ -66,6 +69,14 @@ struct ContractorConfig final : storage::IOConfig
 
     unsigned requested_num_threads;
 
+    // Renumbers the edge-based nodes in all files after the contraction to the order of the
+    // hierarchy. Not done if the dataset was partitioned, the MLD data uses the old node IDs.
+    bool renumber_nodes;
+
+    // Keeps the node order and the edges of the existing .hsgr file and only recomputes the
+    // weights of its edges, for frequent traffic updates
+    bool reuse_hierarchy;
+
     // DEPRECATED to be removed in v6.0
     // A percentage of vertices that will be contracted for the hierarchy.
     // Offers a trade-off between preprocessing and query time.
@@ -1,8 +1,23 @@
 #ifndef OSRM_CONTRACTOR_CONTRACTOR_GRAPH_HPP_
 #define OSRM_CONTRACTOR_CONTRACTOR_GRAPH_HPP_
 
-#include "util/dynamic_graph.hpp"
+#include "util/block_pool.hpp"
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
 
 namespace osrm
 {
@@ -36,7 +51,449 @@ struct ContractorEdgeData
     bool backward : 1;
 };
 
-using ContractorGraph = util::DynamicGraph<ContractorEdgeData>;
+/**
+ * Adjacency arrays of the graph that is contracted.
+ *
+ * The edges of a node are stored consecutively in a block of a slab. Blocks of nodes that run out
+ * of space are replaced by a block of the next power of two, the old block goes to a free list of
+ * its size class and is reused by the next node that grows into that size. So unlike
+ * util::DynamicGraph, which moves growing nodes to the end of its edges and never reuses the
+ * holes, the contraction does not leave dead space behind.
+ *
+ * Edge ids are positions in the slabs and stay valid as long as the edges of their source are
+ * not changed. Inserting edges into different nodes in parallel is safe once ReserveEdges made
+ * room for them.
+ */
+class ContractorGraph
+{
+  public:
+    using EdgeData = ContractorEdgeData;
+    using NodeIterator = std::uint32_t;
+    using EdgeIterator = std::uint32_t;
+    using EdgeRange = util::range<EdgeIterator>;
+
+    class InputEdge
+    {
+      public:
+        NodeIterator source;
+        NodeIterator target;
+        EdgeData data;
+
+        InputEdge()
+            : source(std::numeric_limits<NodeIterator>::max()),
+              target(std::numeric_limits<NodeIterator>::max())
+        {
+        }
+
+        template <typename... Ts>
+        InputEdge(NodeIterator source, NodeIterator target, Ts &&... data)
+            : source(source), target(target), data(std::forward<Ts>(data)...)
+        {
+        }
+
+        bool operator<(const InputEdge &rhs) const
+        {
+            return std::tie(source, target) < std::tie(rhs.source, rhs.target);
+        }
+    };
+
+    ContractorGraph() : ContractorGraph(0) {}
+
+    explicit ContractorGraph(NodeIterator nodes) : node_array(nodes), number_of_edges(0) {}
+
+    // Constructs the graph from a list of edges sorted by source node id
+    template <class ContainerT> ContractorGraph(const NodeIterator nodes, const ContainerT &graph)
+        : node_array(nodes), number_of_edges(static_cast<EdgeIterator>(graph.size()))
+    {
+        BOOST_ASSERT(std::is_sorted(graph.begin(), graph.end()));
+
+        std::size_t edge = 0;
+        for (const auto node : util::irange(0u, nodes))
+        {
+            const auto first = edge;
+            while (edge < graph.size() && graph[edge].source == node)
+            {
+                ++edge;
+            }
+            AppendNode(node, edge - first);
+            for (const auto index : util::irange(first, edge))
+            {
+                BOOST_ASSERT(graph[index].target < nodes);
+                EmplaceEdge(node, graph[index].target, graph[index].data);
+            }
+        }
+        BOOST_ASSERT(edge == graph.size());
+    }
+
+    ContractorGraph(const ContractorGraph &other)
+        : node_array(other.node_array), free_blocks(other.free_blocks),
+          slab_end(other.slab_end),
+          number_of_edges(static_cast<EdgeIterator>(other.number_of_edges))
+    {
+        slabs.reserve(other.slabs.size());
+        for (const auto &slab : other.slabs)
+        {
+            slabs.push_back(AllocateSlab());
+            std::copy_n(slab.get(), SLAB_SIZE, slabs.back().get());
+        }
+    }
+
+    ContractorGraph &operator=(const ContractorGraph &other)
+    {
+        auto copy_other = other;
+        *this = std::move(copy_other);
+        return *this;
+    }
+
+    // atomics can't be moved, this is why the graph needs its own constructors
+    ContractorGraph(ContractorGraph &&other)
+        : node_array(std::move(other.node_array)), slabs(std::move(other.slabs)),
+          free_blocks(std::move(other.free_blocks)), slab_end(other.slab_end),
+          number_of_edges(static_cast<EdgeIterator>(other.number_of_edges))
+    {
+    }
+
+    ContractorGraph &operator=(ContractorGraph &&other)
+    {
+        node_array = std::move(other.node_array);
+        slabs = std::move(other.slabs);
+        free_blocks = std::move(other.free_blocks);
+        slab_end = other.slab_end;
+        number_of_edges = static_cast<EdgeIterator>(other.number_of_edges);
+        return *this;
+    }
+
+    // Removes all edges to and from nodes for which filter(node_id) returns false
+    template <typename Pred> ContractorGraph Filter(Pred filter) const &
+    {
+        ContractorGraph other(GetNumberOfNodes());
+        EdgeIterator filtered_edges = 0;
+        for (const auto node : util::irange(0u, GetNumberOfNodes()))
+        {
+            EdgeIterator degree = 0;
+            if (filter(node))
+            {
+                for (const auto edge : GetAdjacentEdgeRange(node))
+                {
+                    degree += filter(GetTarget(edge)) ? 1 : 0;
+                }
+            }
+
+            other.AppendNode(node, degree);
+            if (degree > 0)
+            {
+                for (const auto edge : GetAdjacentEdgeRange(node))
+                {
+                    if (filter(GetTarget(edge)))
+                    {
+                        other.EmplaceEdge(node, GetTarget(edge), GetEdgeData(edge));
+                    }
+                }
+            }
+            filtered_edges += degree;
+        }
+        other.number_of_edges = filtered_edges;
+        return other;
+    }
+
+    unsigned GetNumberOfNodes() const { return node_array.size(); }
+
+    unsigned GetNumberOfEdges() const { return number_of_edges; }
+
+    unsigned GetOutDegree(const NodeIterator n) const { return node_array[n].edges; }
+
+    NodeIterator GetTarget(const EdgeIterator e) const { return At(e).target; }
+
+    EdgeData &GetEdgeData(const EdgeIterator e) { return At(e).data; }
+
+    const EdgeData &GetEdgeData(const EdgeIterator e) const { return At(e).data; }
+
+    EdgeIterator BeginEdges(const NodeIterator n) const { return node_array[n].first_edge; }
+
+    EdgeIterator EndEdges(const NodeIterator n) const
+    {
+        return node_array[n].first_edge + node_array[n].edges;
+    }
+
+    EdgeRange GetAdjacentEdgeRange(const NodeIterator node) const
+    {
+        return util::irange(BeginEdges(node), EndEdges(node));
+    }
+
+    // Adds an edge, invalidates the edge ids of the source node
+    EdgeIterator InsertEdge(const NodeIterator from, const NodeIterator to, const EdgeData &data)
+    {
+        Node &node = node_array[from];
+        if (node.edges == node.capacity)
+        {
+            Grow(from, node.edges + 1);
+        }
+        ++number_of_edges;
+        return EmplaceEdge(from, to, data);
+    }
+
+    // Makes room for count more edges of a node. Until they are inserted InsertEdge neither
+    // allocates nor writes outside the block of the node, so that edges of different nodes can be
+    // inserted in parallel. Invalidates the edge ids of the node.
+    void ReserveEdges(const NodeIterator from, const EdgeIterator count)
+    {
+        const Node &node = node_array[from];
+        if (node.capacity - node.edges < count)
+        {
+            Grow(from, node.edges + count);
+        }
+    }
+
+    // Removes an edge, invalidates the edge ids of the source node
+    void DeleteEdge(const NodeIterator source, const EdgeIterator e)
+    {
+        Node &node = node_array[source];
+        BOOST_ASSERT(node.edges > 0);
+        --number_of_edges;
+        --node.edges;
+        At(e) = At(node.first_edge + node.edges);
+    }
+
+    // Removes all edges (source,target)
+    std::int32_t DeleteEdgesTo(const NodeIterator source, const NodeIterator target)
+    {
+        Node &node = node_array[source];
+        std::int32_t deleted = 0;
+        for (EdgeIterator edge = node.first_edge; edge < node.first_edge + node.edges;)
+        {
+            if (At(edge).target == target)
+            {
+                --node.edges;
+                At(edge) = At(node.first_edge + node.edges);
+                ++deleted;
+            }
+            else
+            {
+                ++edge;
+            }
+        }
+        number_of_edges -= deleted;
+        return deleted;
+    }
+
+    EdgeIterator FindEdge(const NodeIterator from, const NodeIterator to) const
+    {
+        for (const auto edge : GetAdjacentEdgeRange(from))
+        {
+            if (At(edge).target == to)
+            {
+                return edge;
+            }
+        }
+        return SPECIAL_EDGEID;
+    }
+
+    // Renumbers the nodes and packs their edges in the order of the new ids, which drops the
+    // free blocks and the spare room of all nodes.
+    void Renumber(const std::vector<NodeID> &old_to_new_node)
+    {
+        BOOST_ASSERT(old_to_new_node.size() == node_array.size());
+        std::vector<Node> renumbered_nodes(node_array.size());
+        for (const auto node : util::irange<NodeID>(0, node_array.size()))
+        {
+            renumbered_nodes[old_to_new_node[node]] = node_array[node];
+        }
+        node_array = std::move(renumbered_nodes);
+
+        // the slots of the edges in the new order, unused slots follow after all edges
+        const EdgeIterator number_of_slots = slabs.size() * SLAB_SIZE;
+        std::vector<EdgeIterator> old_to_new_edge(number_of_slots, SPECIAL_EDGEID);
+        EdgeIterator new_edge = 0;
+        for (auto &node : node_array)
+        {
+            for (const auto edge : util::irange(node.first_edge, node.first_edge + node.edges))
+            {
+                At(edge).target = old_to_new_node[At(edge).target];
+                old_to_new_edge[edge] = new_edge++;
+            }
+            node.first_edge = new_edge - node.edges;
+            node.capacity = node.edges;
+        }
+        const auto number_of_valid_edges = new_edge;
+        for (auto &slot : old_to_new_edge)
+        {
+            if (slot == SPECIAL_EDGEID)
+            {
+                slot = new_edge++;
+            }
+        }
+
+        // apply the permutation cycle by cycle
+        std::vector<bool> placed(number_of_slots, false);
+        for (const auto slot : util::irange<EdgeIterator>(0, number_of_slots))
+        {
+            if (placed[slot])
+            {
+                continue;
+            }
+            auto moved = At(slot);
+            auto next = old_to_new_edge[slot];
+            while (!placed[next])
+            {
+                std::swap(moved, At(next));
+                placed[next] = true;
+                next = old_to_new_edge[next];
+            }
+        }
+
+        // the rest of the last slab is taken by the next blocks allocated at the end
+        slabs.resize((number_of_valid_edges + SLAB_SIZE - 1) / SLAB_SIZE);
+        slab_end = number_of_valid_edges;
+        for (auto &blocks : free_blocks)
+        {
+            blocks.clear();
+        }
+        number_of_edges = number_of_valid_edges;
+    }
+
+  private:
+    // 2^18 edges of 20 bytes in a block of the util::BlockPool, no node can have more edges than
+    // that. The pages at the end of the block that are never written don't take up memory.
+    static constexpr std::uint32_t SLAB_BITS = 18;
+    static constexpr std::uint32_t SLAB_SIZE = 1u << SLAB_BITS;
+    static constexpr std::uint32_t MIN_BLOCK_BITS = 2;
+
+    struct Node
+    {
+        EdgeIterator first_edge = 0;
+        std::uint32_t edges = 0;
+        std::uint32_t capacity = 0;
+    };
+
+    struct Edge
+    {
+        NodeIterator target;
+        EdgeData data;
+    };
+
+    static_assert(SLAB_SIZE * sizeof(Edge) <= util::BlockPool::BLOCK_SIZE,
+                  "slabs need to fit into a block of the pool");
+
+    struct SlabDeleter
+    {
+        void operator()(Edge *slab) const { util::BlockPool::GetInstance().Deallocate(slab); }
+    };
+    using SlabPointer = std::unique_ptr<Edge[], SlabDeleter>;
+
+    static SlabPointer AllocateSlab()
+    {
+        SlabPointer slab(static_cast<Edge *>(util::BlockPool::GetInstance().Allocate()));
+        for (const auto index : util::irange(0u, SLAB_SIZE))
+        {
+            new (slab.get() + index) Edge;
+        }
+        return slab;
+    }
+
+    Edge &At(const EdgeIterator edge) const
+    {
+        return slabs[edge >> SLAB_BITS][edge & (SLAB_SIZE - 1)];
+    }
+
+    EdgeIterator EmplaceEdge(const NodeIterator from, const NodeIterator to, const EdgeData &data)
+    {
+        Node &node = node_array[from];
+        BOOST_ASSERT(node.edges < node.capacity);
+        const auto edge = node.first_edge + node.edges;
+        At(edge) = Edge{to, data};
+        ++node.edges;
+        return edge;
+    }
+
+    // Places an exactly sized block for the edges of node after the blocks of the previous nodes
+    void AppendNode(const NodeIterator node, const std::uint32_t capacity)
+    {
+        if (capacity > 0)
+        {
+            node_array[node].first_edge = AllocateAtEnd(capacity);
+        }
+        node_array[node].capacity = capacity;
+    }
+
+    // Moves the edges of a node to a block of the next power of two that holds at least size
+    void Grow(const NodeIterator from, const std::uint32_t size)
+    {
+        std::uint32_t block_bits = MIN_BLOCK_BITS;
+        while ((1u << block_bits) < size)
+        {
+            ++block_bits;
+        }
+        if (block_bits > SLAB_BITS)
+        {
+            throw util::exception("Node " + std::to_string(from) + " has more than " +
+                                  std::to_string(SLAB_SIZE) + " edges" + SOURCE_REF);
+        }
+
+        EdgeIterator first_edge;
+        if (!free_blocks[block_bits].empty())
+        {
+            first_edge = free_blocks[block_bits].back();
+            free_blocks[block_bits].pop_back();
+        }
+        else
+        {
+            first_edge = AllocateAtEnd(1u << block_bits);
+        }
+
+        Node &node = node_array[from];
+        for (const auto index : util::irange(0u, node.edges))
+        {
+            At(first_edge + index) = At(node.first_edge + index);
+        }
+        AddFreeBlocks(node.first_edge, node.capacity);
+        node.first_edge = first_edge;
+        node.capacity = 1u << block_bits;
+    }
+
+    // Takes a block from the end of the last slab, or from a new one if it does not fit anymore
+    EdgeIterator AllocateAtEnd(const std::uint32_t size)
+    {
+        BOOST_ASSERT(size <= SLAB_SIZE);
+        const auto slab_capacity = static_cast<std::size_t>(slabs.size()) * SLAB_SIZE;
+        if (slab_end + size > slab_capacity)
+        {
+            if (slab_capacity + SLAB_SIZE > std::numeric_limits<EdgeIterator>::max())
+            {
+                throw util::exception("Contractor graph has too many edges" + SOURCE_REF);
+            }
+            AddFreeBlocks(slab_end, slab_capacity - slab_end);
+            slabs.push_back(AllocateSlab());
+            slab_end = slab_capacity;
+        }
+        const auto first_edge = slab_end;
+        slab_end += size;
+        return first_edge;
+    }
+
+    // Splits a free range into blocks of powers of two, anything below the smallest block size is
+    // not worth tracking
+    void AddFreeBlocks(EdgeIterator first_edge, std::uint32_t size)
+    {
+        for (auto block_bits = SLAB_BITS; size >= (1u << MIN_BLOCK_BITS); --block_bits)
+        {
+            if (size & (1u << block_bits))
+            {
+                free_blocks[block_bits].push_back(first_edge);
+                first_edge += 1u << block_bits;
+                size -= 1u << block_bits;
+            }
+        }
+    }
+
+    std::vector<Node> node_array;
+    std::vector<SlabPointer> slabs;
+    // start of the free blocks of 2^i edges
+    std::vector<std::vector<EdgeIterator>> free_blocks =
+        std::vector<std::vector<EdgeIterator>>(SLAB_BITS + 1);
+    std::size_t slab_end = 0;
+    std::atomic_uint number_of_edges;
+};
+
 using ContractorEdge = ContractorGraph::InputEdge;
 
 } // namespace contractor
@@ -13,10 +13,22 @@ namespace osrm
 namespace contractor
 {
 
+// Bounds of a witness search. A search that stops before it finds a witness only adds a shortcut
+// that is not needed, the hierarchy stays correct.
+struct WitnessSearchLimits
+{
+    // number of settled nodes
+    int node_limit;
+    // number of edges of the witness paths
+    short hop_limit;
+};
+
+// Searches the targets marked in the heap from the sources in the heap, without passing through
+// the forbidden node
 void search(ContractorHeap &heap,
             const ContractorGraph &graph,
             const unsigned number_of_targets,
-            const int node_limit,
+            const WitnessSearchLimits limits,
             const EdgeWeight weight_limit,
             const NodeID forbidden_node);
 
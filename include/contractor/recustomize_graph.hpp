@@ -0,0 +1,40 @@
+#ifndef OSRM_CONTRACTOR_RECUSTOMIZE_GRAPH_HPP
+#define OSRM_CONTRACTOR_RECUSTOMIZE_GRAPH_HPP
+
+#include "contractor/compact_query_graph.hpp"
+#include "contractor/contract_excludable_graph.hpp"
+
+#include "extractor/edge_based_edge.hpp"
+
+#include <boost/optional.hpp>
+
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+/**
+ * Recomputes the weights and durations of a contracted graph for new weights of the edge-based
+ * graph, keeping its node order and its edges.
+ *
+ * Like the customization of a customizable contraction hierarchy the edges are relaxed bottom-up
+ * over the triangles of the hierarchy: an edge u->v gets the best path u->x->v over any node x
+ * below u and v. Shortcuts can get a new middle node and for original edges that are slower than
+ * such a path the path wins. The hierarchy of every exclude filter is customized on its own.
+ *
+ * The queries on the result find valid paths that might be longer than the best ones, since a
+ * contraction for the new weights might add shortcuts the old hierarchy does not have.
+ *
+ * Returns none if the edges of a filter do not form a hierarchy.
+ */
+boost::optional<GraphAndFilter>
+recustomizeGraph(const CompactQueryGraph &graph,
+                 const std::vector<std::vector<bool>> &edge_filters,
+                 const std::vector<extractor::EdgeBasedEdge> &edge_based_edges);
+
+} // namespace contractor
+} // namespace osrm
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef OSRM_CONTRACTOR_RENUMBER_HPP
+#define OSRM_CONTRACTOR_RENUMBER_HPP
+
+#include "contractor/query_graph.hpp"
+
+#include "extractor/edge_based_edge.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+// Orders the nodes of the contracted graph by a depth first search along the upward edges. Nodes
+// get their ID after all nodes above them in the hierarchy they reach, so the top of the hierarchy
+// ends up at the front and the upward search spaces of close nodes share cache lines and pages.
+std::vector<std::uint32_t> makePermutation(const QueryGraph &graph);
+
+// Renumbers the nodes and middle nodes of the shortcuts, the edge filters follow their edges
+void renumber(QueryGraph &graph,
+              std::vector<std::vector<bool>> &edge_filters,
+              const std::vector<std::uint32_t> &permutation);
+
+void renumber(std::vector<extractor::EdgeBasedEdge> &edges,
+              const std::vector<std::uint32_t> &permutation);
+
+} // namespace contractor
+} // namespace osrm
+
+#endif
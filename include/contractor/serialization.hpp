@@ -15,12 +15,32 @@ namespace contractor
 namespace serialization
 {
 
+template <storage::Ownership Ownership>
+void read(storage::tar::FileReader &reader,
+          const std::string &name,
+          detail::CompactQueryGraph<Ownership> &graph)
+{
+    storage::serialization::read(reader, name + "/node_array", graph.node_array);
+    storage::serialization::read(reader, name + "/edges", graph.edge_array);
+    storage::serialization::read(reader, name + "/edge_data", graph.edge_data_array);
+}
+
+template <storage::Ownership Ownership>
+void write(storage::tar::FileWriter &writer,
+           const std::string &name,
+           const detail::CompactQueryGraph<Ownership> &graph)
+{
+    storage::serialization::write(writer, name + "/node_array", graph.node_array);
+    storage::serialization::write(writer, name + "/edges", graph.edge_array);
+    storage::serialization::write(writer, name + "/edge_data", graph.edge_data_array);
+}
+
 template <storage::Ownership Ownership>
 void write(storage::tar::FileWriter &writer,
            const std::string &name,
            const detail::ContractedMetric<Ownership> &metric)
 {
-    util::serialization::write(writer, name + "/contracted_graph", metric.graph);
+    serialization::write(writer, name + "/contracted_graph", metric.graph);
 
     writer.WriteElementCount64(name + "/exclude", metric.edge_filter.size());
     for (const auto index : util::irange<std::size_t>(0, metric.edge_filter.size()))
@@ -36,7 +56,7 @@ void read(storage::tar::FileReader &reader,
           const std::string &name,
           detail::ContractedMetric<Ownership> &metric)
 {
-    util::serialization::read(reader, name + "/contracted_graph", metric.graph);
+    serialization::read(reader, name + "/contracted_graph", metric.graph);
 
     metric.edge_filter.resize(reader.ReadElementCount64(name + "/exclude"));
     for (const auto index : util::irange<std::size_t>(0, metric.edge_filter.size()))
@@ -3,17 +3,37 @@
 
 #include "partitioner/cell_storage.hpp"
 #include "partitioner/multi_level_partition.hpp"
+#include "util/integer_range.hpp"
 #include "util/query_heap.hpp"
+#include "util/radix_heap.hpp"
+
+#include <boost/assert.hpp>
 
 #include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <unordered_set>
+#include <vector>
 
 namespace osrm
 {
 namespace customizer
 {
+namespace detail
+{
+// The matrix of a cell with 1024 boundary nodes in its sub-cells takes 8 MiB
+const constexpr std::size_t MAX_SUBCELL_MATRIX_SIZE = 1024;
+const constexpr std::size_t SUBCELL_MATRIX_COST_FACTOR = 32;
+
+// Sums of two packed distances do not overflow, but are not valid anymore
+const constexpr std::uint64_t INVALID_DISTANCE = std::numeric_limits<std::uint64_t>::max() >> 2;
+}
 
 class CellCustomizer
 {
@@ -25,10 +45,20 @@ class CellCustomizer
     };
 
   public:
-    using Heap =
-        util::QueryHeap<NodeID, NodeID, EdgeWeight, HeapData, util::ArrayStorage<NodeID, int>>;
+    using Heap = util::
+        RadixQueryHeap<NodeID, NodeID, EdgeWeight, HeapData, util::ArrayStorage<NodeID, int>>;
     using HeapPtr = tbb::enumerable_thread_specific<Heap>;
 
+    // The distances between the boundary nodes of the sub-cells of a cell
+    class SubcellMatrix
+    {
+        friend class CellCustomizer;
+
+        std::vector<NodeID> nodes;
+        std::vector<std::uint64_t> distances;
+    };
+    using SubcellMatrixPtr = tbb::enumerable_thread_specific<SubcellMatrix>;
+
     CellCustomizer(const partitioner::MultiLevelPartition &partition) : partition(partition) {}
 
     template <typename GraphT>
@@ -95,30 +125,418 @@ class CellCustomizer
         }
     }
 
+    // Customizes a cell above the first level with Floyd-Warshall on the graph of the boundary
+    // nodes of its sub-cells, which contains the clique arcs of the sub-cells and the edges
+    // between them. The weight and the duration of a path are packed into one integer weight
+    // first, so that the inner loop is a branch-free minimum that the compiler vectorizes.
+    //
+    // Returns false without changing the metric if the matrix would be too large or if negative
+    // durations can not be packed.
+    template <typename GraphT>
+    bool CustomizeFromSubcells(const GraphT &graph,
+                               SubcellMatrix &matrix,
+                               const partitioner::CellStorage &cells,
+                               const std::vector<bool> &allowed_nodes,
+                               CellMetric &metric,
+                               LevelID level,
+                               CellID id) const
+    {
+        BOOST_ASSERT(level > 1);
+        const auto subcell_level = level - 1;
+        const auto begin_subcells = partition.BeginChildren(level, id);
+        const auto end_subcells = partition.EndChildren(level, id);
+
+        auto &nodes = matrix.nodes;
+        nodes.clear();
+        for (const auto subcell_id : util::irange(begin_subcells, end_subcells))
+        {
+            const auto subcell = cells.GetCell(metric, subcell_level, subcell_id);
+            for (const auto node : subcell.GetSourceNodes())
+                if (allowed_nodes[node])
+                    nodes.push_back(node);
+            for (const auto node : subcell.GetDestinationNodes())
+                if (allowed_nodes[node])
+                    nodes.push_back(node);
+        }
+        std::sort(nodes.begin(), nodes.end());
+        nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+        const std::size_t size = nodes.size();
+        if (size > detail::MAX_SUBCELL_MATRIX_SIZE)
+            return false;
+
+        const auto index_of = [&nodes](const NodeID node) {
+            const auto iter = std::lower_bound(nodes.begin(), nodes.end(), node);
+            BOOST_ASSERT(iter != nodes.end() && *iter == node);
+            return static_cast<std::size_t>(iter - nodes.begin());
+        };
+
+        auto &distances = matrix.distances;
+        distances.assign(size * size, detail::INVALID_DISTANCE);
+        const auto relax = [&](const std::size_t from,
+                               const std::size_t to,
+                               const EdgeWeight weight,
+                               const EdgeDuration duration) {
+            auto &distance = distances[from * size + to];
+            distance = std::min(distance, Pack(weight, duration));
+        };
+        for (const auto index : util::irange<std::size_t>(0, size))
+        {
+            distances[index * size + index] = 0;
+        }
+
+        for (const auto subcell_id : util::irange(begin_subcells, end_subcells))
+        {
+            const auto subcell = cells.GetCell(metric, subcell_level, subcell_id);
+            for (const auto source : subcell.GetSourceNodes())
+            {
+                if (!allowed_nodes[source])
+                    continue;
+
+                const auto from = index_of(source);
+                auto destination = subcell.GetDestinationNodes().begin();
+                auto duration = subcell.GetOutDuration(source).begin();
+                for (const auto weight : subcell.GetOutWeight(source))
+                {
+                    if (weight != INVALID_EDGE_WEIGHT && allowed_nodes[*destination])
+                    {
+                        if (weight < 0 || *duration < 0)
+                            return false;
+                        relax(from, index_of(*destination), weight, *duration);
+                    }
+                    ++destination;
+                    ++duration;
+                }
+            }
+        }
+
+        for (const auto node : nodes)
+        {
+            const auto from = index_of(node);
+            for (const auto edge : graph.GetInternalEdgeRange(level, node))
+            {
+                const NodeID to = graph.GetTarget(edge);
+                const auto &data = graph.GetEdgeData(edge);
+                if (!data.forward || !allowed_nodes[to] ||
+                    partition.GetCell(subcell_level, node) == partition.GetCell(subcell_level, to))
+                {
+                    continue;
+                }
+                if (data.weight < 0 || data.duration < 0)
+                    return false;
+                relax(from, index_of(to), data.weight, data.duration);
+            }
+        }
+
+        for (const auto middle : util::irange<std::size_t>(0, size))
+        {
+            const auto *const middle_row = distances.data() + middle * size;
+            for (const auto from : util::irange<std::size_t>(0, size))
+            {
+                auto *const row = distances.data() + from * size;
+                const auto to_middle = row[middle];
+                if (to_middle >= detail::INVALID_DISTANCE)
+                    continue;
+
+                for (std::size_t to = 0; to < size; ++to)
+                {
+                    row[to] = std::min(row[to], to_middle + middle_row[to]);
+                }
+            }
+        }
+
+        const auto cell = cells.GetCell(metric, level, id);
+        for (const auto source : cell.GetSourceNodes())
+        {
+            if (!allowed_nodes[source])
+                continue;
+
+            const auto *const row = distances.data() + index_of(source) * size;
+            auto weights = cell.GetOutWeight(source);
+            auto durations = cell.GetOutDuration(source);
+            for (const auto destination : cell.GetDestinationNodes())
+            {
+                const auto distance = allowed_nodes[destination] ? row[index_of(destination)]
+                                                                 : detail::INVALID_DISTANCE;
+                if (distance >= detail::INVALID_DISTANCE)
+                {
+                    weights.front() = INVALID_EDGE_WEIGHT;
+                    durations.front() = MAXIMAL_EDGE_DURATION;
+                }
+                else
+                {
+                    weights.front() = static_cast<EdgeWeight>(distance >> 32);
+                    durations.front() = static_cast<EdgeDuration>(distance & 0xffffffff);
+                }
+                weights.advance_begin(1);
+                durations.advance_begin(1);
+            }
+        }
+
+        return true;
+    }
+
     template <typename GraphT>
     void Customize(const GraphT &graph,
                    const partitioner::CellStorage &cells,
                    const std::vector<bool> &allowed_nodes,
                    CellMetric &metric) const
     {
-        Heap heap_exemplar(graph.GetNumberOfNodes());
-        HeapPtr heaps(heap_exemplar);
+        CustomizeCells(
+            graph, cells, {&allowed_nodes}, {&metric}, [](LevelID, CellID) { return true; });
+    }
+
+    // Only customizes the cells marked in changed_cells, the other cells keep their metric
+    template <typename GraphT>
+    void Customize(const GraphT &graph,
+                   const partitioner::CellStorage &cells,
+                   const std::vector<bool> &allowed_nodes,
+                   CellMetric &metric,
+                   const std::vector<std::vector<bool>> &changed_cells) const
+    {
+        CustomizeCells(graph, cells, {&allowed_nodes}, {&metric}, [&](LevelID level, CellID id) {
+            return changed_cells[level][id];
+        });
+    }
+
+    // Customizes the metric of every node filter, the cells of all metrics share the threads
+    template <typename GraphT>
+    void Customize(const GraphT &graph,
+                   const partitioner::CellStorage &cells,
+                   const std::vector<std::vector<bool>> &node_filters,
+                   std::vector<CellMetric> &metrics) const
+    {
+        CustomizeCells(graph,
+                       cells,
+                       filterPointers(node_filters),
+                       metricPointers(metrics),
+                       [](LevelID, CellID) { return true; });
+    }
 
+    template <typename GraphT>
+    void Customize(const GraphT &graph,
+                   const partitioner::CellStorage &cells,
+                   const std::vector<std::vector<bool>> &node_filters,
+                   std::vector<CellMetric> &metrics,
+                   const std::vector<std::vector<bool>> &changed_cells) const
+    {
+        CustomizeCells(graph,
+                       cells,
+                       filterPointers(node_filters),
+                       metricPointers(metrics),
+                       [&](LevelID level, CellID id) { return changed_cells[level][id]; });
+    }
+
+    // Returns for every level the cells whose metric depends on edges that differ between both
+    // graphs. An edge between two nodes of a cell changes the cell and all its parent cells.
+    // Graphs with different edges change all cells.
+    template <typename GraphT>
+    std::vector<std::vector<bool>> GetChangedCells(const GraphT &old_graph,
+                                                   const GraphT &new_graph) const
+    {
+        std::vector<std::vector<bool>> changed_cells(partition.GetNumberOfLevels());
         for (std::size_t level = 1; level < partition.GetNumberOfLevels(); ++level)
         {
-            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, partition.GetNumberOfCells(level)),
-                              [&](const tbb::blocked_range<std::size_t> &range) {
-                                  auto &heap = heaps.local();
-                                  for (auto id = range.begin(), end = range.end(); id != end; ++id)
-                                  {
-                                      Customize(
-                                          graph, heap, cells, allowed_nodes, metric, level, id);
-                                  }
-                              });
+            changed_cells[level].resize(partition.GetNumberOfCells(level), false);
+        }
+
+        const auto mark_cells = [&](const NodeID node, const NodeID target) {
+            for (std::size_t level = 1; level < partition.GetNumberOfLevels(); ++level)
+            {
+                const auto cell = partition.GetCell(level, node);
+                if (cell == partition.GetCell(level, target))
+                    changed_cells[level][cell] = true;
+            }
+        };
+
+        if (old_graph.GetNumberOfNodes() != new_graph.GetNumberOfNodes() ||
+            old_graph.GetNumberOfEdges() != new_graph.GetNumberOfEdges())
+        {
+            for (auto &cells : changed_cells)
+                cells.assign(cells.size(), true);
+            return changed_cells;
+        }
+
+        for (const auto node : util::irange(0u, new_graph.GetNumberOfNodes()))
+        {
+            const auto old_edges = old_graph.GetAdjacentEdgeRange(node);
+            const auto new_edges = new_graph.GetAdjacentEdgeRange(node);
+            if (old_edges.size() != new_edges.size())
+            {
+                mark_cells(node, node);
+                continue;
+            }
+
+            auto old_edge = old_edges.begin();
+            for (const auto new_edge : new_edges)
+            {
+                const auto target = new_graph.GetTarget(new_edge);
+                const auto &old_data = old_graph.GetEdgeData(*old_edge);
+                const auto &new_data = new_graph.GetEdgeData(new_edge);
+                if (old_graph.GetTarget(*old_edge) != target)
+                {
+                    mark_cells(node, node);
+                }
+                else if (old_data.weight != new_data.weight ||
+                         old_data.duration != new_data.duration ||
+                         old_data.forward != new_data.forward ||
+                         old_data.backward != new_data.backward)
+                {
+                    mark_cells(node, target);
+                }
+                ++old_edge;
+            }
         }
+
+        return changed_cells;
     }
 
   private:
+    // A search per source relaxes about all clique arcs of the sub-cells, each with a heap
+    // operation, while Floyd-Warshall needs a cubic number of vectorized minimums
+    bool PreferSubcellMatrix(const partitioner::CellStorage &cells, LevelID level, CellID id) const
+    {
+        std::size_t sources = 0, destinations = 0, subcell_arcs = 0;
+        for (const auto subcell_id :
+             util::irange(partition.BeginChildren(level, id), partition.EndChildren(level, id)))
+        {
+            const auto boundary = cells.GetBoundarySize(level - 1, subcell_id);
+            sources += boundary.first;
+            destinations += boundary.second;
+            subcell_arcs += static_cast<std::size_t>(boundary.first) * boundary.second;
+        }
+        // most boundary nodes are sources and destinations of their sub-cell
+        const auto size = std::max(sources, destinations);
+        const std::size_t number_of_sources = cells.GetBoundarySize(level, id).first;
+        return size <= detail::MAX_SUBCELL_MATRIX_SIZE &&
+               size * size * size <=
+                   detail::SUBCELL_MATRIX_COST_FACTOR * number_of_sources * subcell_arcs;
+    }
+
+    // Orders by weight and then by duration, like the searches
+    static std::uint64_t Pack(const EdgeWeight weight, const EdgeDuration duration)
+    {
+        BOOST_ASSERT(weight >= 0 && duration >= 0);
+        return (static_cast<std::uint64_t>(weight) << 32) | static_cast<std::uint32_t>(duration);
+    }
+
+    static std::vector<const std::vector<bool> *>
+    filterPointers(const std::vector<std::vector<bool>> &node_filters)
+    {
+        std::vector<const std::vector<bool> *> pointers;
+        for (const auto &node_filter : node_filters)
+        {
+            pointers.push_back(&node_filter);
+        }
+        return pointers;
+    }
+
+    static std::vector<CellMetric *> metricPointers(std::vector<CellMetric> &metrics)
+    {
+        std::vector<CellMetric *> pointers;
+        for (auto &metric : metrics)
+        {
+            pointers.push_back(&metric);
+        }
+        return pointers;
+    }
+
+    // Customizes the cells of all metrics as a task graph: a cell only depends on its sub-cells,
+    // so it is customized as soon as they are done and not after all cells of the level below.
+    // With a level by level schedule the few cells of the upper levels leave most threads idle.
+    template <typename GraphT, typename CellFilterT>
+    void CustomizeCells(const GraphT &graph,
+                        const partitioner::CellStorage &cells,
+                        const std::vector<const std::vector<bool> *> &node_filters,
+                        const std::vector<CellMetric *> &metrics,
+                        const CellFilterT &customize_cell) const
+    {
+        BOOST_ASSERT(node_filters.size() == metrics.size());
+        const LevelID number_of_levels = partition.GetNumberOfLevels();
+        if (number_of_levels < 2 || metrics.empty())
+        {
+            return;
+        }
+
+        // the parent cell of every cell and the number of sub-cells per cell and metric that are
+        // not customized yet
+        std::vector<std::vector<CellID>> parents(number_of_levels);
+        std::vector<std::vector<std::vector<std::atomic<std::uint32_t>>>> pending_subcells(
+            metrics.size());
+        for (auto &pending : pending_subcells)
+        {
+            pending.resize(number_of_levels);
+        }
+        for (LevelID level = 2; level < number_of_levels; ++level)
+        {
+            const auto number_of_cells = partition.GetNumberOfCells(level);
+            parents[level - 1].resize(partition.GetNumberOfCells(level - 1));
+            for (auto &pending : pending_subcells)
+            {
+                pending[level] = std::vector<std::atomic<std::uint32_t>>(number_of_cells);
+            }
+            for (CellID id = 0; id < number_of_cells; ++id)
+            {
+                const auto begin = partition.BeginChildren(level, id);
+                const auto end = partition.EndChildren(level, id);
+                for (auto child = begin; child != end; ++child)
+                {
+                    parents[level - 1][child] = id;
+                }
+                for (auto &pending : pending_subcells)
+                {
+                    pending[level][id].store(end - begin, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        Heap heap_exemplar(graph.GetNumberOfNodes());
+        HeapPtr heaps(heap_exemplar);
+        SubcellMatrixPtr matrices;
+        tbb::task_group tasks;
+
+        std::function<void(std::size_t, LevelID, CellID)> customize =
+            [&](const std::size_t index, const LevelID level, const CellID id) {
+                if (customize_cell(level, id))
+                {
+                    const auto &allowed_nodes = *node_filters[index];
+                    auto &metric = *metrics[index];
+                    if (level == 1 || !PreferSubcellMatrix(cells, level, id) ||
+                        !CustomizeFromSubcells(
+                            graph, matrices.local(), cells, allowed_nodes, metric, level, id))
+                    {
+                        Customize(graph, heaps.local(), cells, allowed_nodes, metric, level, id);
+                    }
+                }
+
+                if (level + 1 < number_of_levels)
+                {
+                    const auto parent = parents[level][id];
+                    if (--pending_subcells[index][level + 1][parent] == 0)
+                    {
+                        tasks.run([&customize, index, level, parent] {
+                            customize(index, level + 1, parent);
+                        });
+                    }
+                }
+            };
+
+        // the cells of the first level are independent
+        const std::size_t number_of_first_level_cells = partition.GetNumberOfCells(1);
+        tasks.run_and_wait([&] {
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, metrics.size() * number_of_first_level_cells),
+                [&](const tbb::blocked_range<std::size_t> &range) {
+                    for (auto task = range.begin(), end = range.end(); task != end; ++task)
+                    {
+                        customize(task / number_of_first_level_cells,
+                                  1,
+                                  task % number_of_first_level_cells);
+                    }
+                });
+        });
+    }
+
     template <typename GraphT>
     void RelaxNode(const GraphT &graph,
                    const partitioner::CellStorage &cells,
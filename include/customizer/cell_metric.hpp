@@ -7,10 +7,29 @@
 #include "util/typedefs.hpp"
 #include "util/vector_view.hpp"
 
+#include <cstdint>
+#include <limits>
+
 namespace osrm
 {
 namespace customizer
 {
+// Where the values of a cell are stored in a compressed metric. A cell whose finite values
+// lie in a range of less than 2^16 stores them as 16 bit offsets to its smallest value.
+struct CompressedCellValues
+{
+    static constexpr std::uint16_t INVALID_OFFSET = std::numeric_limits<std::uint16_t>::max();
+
+    // into the narrow values if the bases are valid, otherwise into the full values
+    std::uint32_t weight_offset;
+    std::uint32_t duration_offset;
+    EdgeWeight weight_base;
+    EdgeDuration duration_base;
+
+    bool NarrowWeights() const { return weight_base != INVALID_EDGE_WEIGHT; }
+    bool NarrowDurations() const { return duration_base != MAXIMAL_EDGE_DURATION; }
+};
+
 namespace detail
 {
 // Encapsulated one metric to make it easily replacable in CelLStorage
@@ -20,6 +39,14 @@ template <storage::Ownership Ownership> struct CellMetricImpl
 
     Vector<EdgeWeight> weights;
     Vector<EdgeDuration> durations;
+
+    // Only used by compressed metrics, which then only keep the values of the wide cells in the
+    // vectors above, see CellStorage::CompressMetric
+    Vector<CompressedCellValues> compressed_cells;
+    Vector<std::uint16_t> narrow_weights;
+    Vector<std::uint16_t> narrow_durations;
+
+    bool IsCompressed() const { return !compressed_cells.empty(); }
 };
 }
 
@@ -2,10 +2,12 @@
 #define OSRM_CUSTOMIZE_CUSTOMIZER_CONFIG_HPP
 
 #include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
 
 #include <array>
 #include <string>
 
+#include "customizer/time_slot.hpp"
 #include "storage/io_config.hpp"
 #include "updater/updater_config.hpp"
 
@@ -24,7 +26,8 @@ struct CustomizationConfig final : storage::IOConfig
                     ".osrm.properties"},
                    {},
                    {".osrm.cell_metrics", ".osrm.mldgr"}),
-          requested_num_threads(0)
+          requested_num_threads(0), incremental(false), number_of_evaluation_queries(0),
+          compress_cell_metrics(false)
     {
     }
 
@@ -34,7 +37,24 @@ struct CustomizationConfig final : storage::IOConfig
         updater_config.UseDefaultOutputNames(base);
     }
 
+    // The metric of a time slot is written to <base>.<name>.osrm.* next to the dataset, all
+    // inputs are read from the dataset itself
+    void UseTimeSlot(const std::string &name, const TimeSlot &slot)
+    {
+        time_slot = slot;
+        output_base_path = base_path.string() + "." + name;
+        updater_config.output_base_path = output_base_path;
+    }
+
     unsigned requested_num_threads;
+    // only customize the cells that changed since the last customization
+    bool incremental;
+    // random queries to run on the customized cells to measure the query cost of the partition
+    std::size_t number_of_evaluation_queries;
+    // store the clique values of cells with a small value range in 16 bits
+    bool compress_cell_metrics;
+    // the departure times of the metric if it is the metric of a time slot
+    boost::optional<TimeSlot> time_slot;
 
     updater::UpdaterConfig updater_config;
 };
@@ -2,6 +2,7 @@
 #define OSRM_CUSTOMIZE_EDGE_BASED_GRAPH_HPP
 
 #include "extractor/edge_based_edge.hpp"
+#include "partitioner/compact_edge_based_graph.hpp"
 #include "partitioner/edge_based_graph.hpp"
 #include "partitioner/multi_level_graph.hpp"
 #include "util/static_graph.hpp"
@@ -18,18 +19,30 @@ namespace customizer
 
 using EdgeBasedGraphEdgeData = partitioner::EdgeBasedGraphEdgeData;
 
+// The searches only read the hot half of the edges of CompactEdgeBasedGraph
 struct MultiLevelEdgeBasedGraph
-    : public partitioner::MultiLevelGraph<EdgeBasedGraphEdgeData, storage::Ownership::Container>
+    : public partitioner::MultiLevelGraph<
+          EdgeBasedGraphEdgeData,
+          storage::Ownership::Container,
+          partitioner::CompactEdgeBasedGraph<storage::Ownership::Container>>
 {
-    using Base =
-        partitioner::MultiLevelGraph<EdgeBasedGraphEdgeData, storage::Ownership::Container>;
+    using Base = partitioner::MultiLevelGraph<
+        EdgeBasedGraphEdgeData,
+        storage::Ownership::Container,
+        partitioner::CompactEdgeBasedGraph<storage::Ownership::Container>>;
     using Base::Base;
 };
 
 struct MultiLevelEdgeBasedGraphView
-    : public partitioner::MultiLevelGraph<EdgeBasedGraphEdgeData, storage::Ownership::View>
+    : public partitioner::MultiLevelGraph<
+          EdgeBasedGraphEdgeData,
+          storage::Ownership::View,
+          partitioner::CompactEdgeBasedGraph<storage::Ownership::View>>
 {
-    using Base = partitioner::MultiLevelGraph<EdgeBasedGraphEdgeData, storage::Ownership::View>;
+    using Base =
+        partitioner::MultiLevelGraph<EdgeBasedGraphEdgeData,
+                                     storage::Ownership::View,
+                                     partitioner::CompactEdgeBasedGraph<storage::Ownership::View>>;
     using Base::Base;
 };
 
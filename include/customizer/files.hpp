@@ -2,11 +2,14 @@
 #define OSRM_CUSTOMIZER_FILES_HPP
 
 #include "customizer/serialization.hpp"
+#include "customizer/time_slot.hpp"
 
 #include "storage/tar.hpp"
 
 #include "util/integer_range.hpp"
 
+#include <boost/optional.hpp>
+
 #include <unordered_map>
 
 namespace osrm
@@ -45,11 +48,21 @@ inline void readCellMetrics(const boost::filesystem::path &path,
     }
 }
 
-// writes .osrm.cell_metrics file
+// reads the departure times of the metrics of a time slot from the .osrm.cell_metrics file
+inline void readTimeSlot(const boost::filesystem::path &path, TimeSlot &time_slot)
+{
+    const auto fingerprint = storage::tar::FileReader::VerifyFingerprint;
+    storage::tar::FileReader reader{path, fingerprint};
+
+    reader.ReadInto("/mld/time_slot", time_slot);
+}
+
+// writes .osrm.cell_metrics file, the metrics of a time slot are stored with its departure times
 template <typename CellMetricT>
 inline void
 writeCellMetrics(const boost::filesystem::path &path,
-                 const std::unordered_map<std::string, std::vector<CellMetricT>> &metrics)
+                 const std::unordered_map<std::string, std::vector<CellMetricT>> &metrics,
+                 const boost::optional<TimeSlot> &time_slot = boost::none)
 {
     static_assert(std::is_same<CellMetricView, CellMetricT>::value ||
                       std::is_same<CellMetric, CellMetricT>::value,
@@ -72,6 +85,12 @@ writeCellMetrics(const boost::filesystem::path &path,
             serialization::write(writer, prefix + "/" + std::to_string(id++), exclude_metric);
         }
     }
+
+    if (time_slot)
+    {
+        writer.WriteElementCount64("/mld/time_slot", 1);
+        writer.WriteFrom("/mld/time_slot", *time_slot);
+    }
 }
 }
 }
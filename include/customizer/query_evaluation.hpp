@@ -0,0 +1,180 @@
+#ifndef OSRM_CUSTOMIZER_QUERY_EVALUATION_HPP
+#define OSRM_CUSTOMIZER_QUERY_EVALUATION_HPP
+
+#include "customizer/cell_customizer.hpp"
+#include "customizer/cell_metric.hpp"
+#include "partitioner/cell_storage.hpp"
+#include "partitioner/multi_level_partition.hpp"
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace osrm
+{
+namespace customizer
+{
+
+/**
+ * Runs shortest path queries on a customized multi-level graph to estimate the query cost of a
+ * partition. A query is a unidirectional Dijkstra that uses the same levels as the MLD search of
+ * the engine: a node is relaxed on the highest level on which its cell contains neither the
+ * source nor the target, by the clique arcs of that cell and the edges that leave it.
+ *
+ * The searches go between edge-based nodes without phantom nodes, so the times are a lower bound
+ * for routing requests but compare partitions with different cell sizes.
+ */
+template <typename GraphT> class QueryEvaluator
+{
+  public:
+    struct QueryResult
+    {
+        EdgeWeight weight;
+        std::size_t settled_nodes;
+    };
+
+    struct Summary
+    {
+        std::size_t number_of_queries = 0;
+        std::size_t number_of_routes = 0;
+        double mean_milliseconds = 0;
+        double median_milliseconds = 0;
+        double p99_milliseconds = 0;
+        double mean_settled_nodes = 0;
+    };
+
+    QueryEvaluator(const GraphT &graph,
+                   const partitioner::MultiLevelPartition &partition,
+                   const partitioner::CellStorage &cells,
+                   const CellMetric &metric,
+                   const std::vector<bool> &allowed_nodes)
+        : graph(graph), partition(partition), cells(cells), metric(metric),
+          allowed_nodes(allowed_nodes), heap(graph.GetNumberOfNodes())
+    {
+    }
+
+    // The weight of the shortest path, INVALID_EDGE_WEIGHT if target can not be reached
+    QueryResult Query(const NodeID source, const NodeID target)
+    {
+        heap.Clear();
+        heap.Insert(source, 0, {false, 0});
+
+        std::size_t settled_nodes = 0;
+        while (!heap.Empty())
+        {
+            const auto node = heap.DeleteMin();
+            const auto weight = heap.GetKey(node);
+            ++settled_nodes;
+            if (node == target)
+            {
+                return {weight, settled_nodes};
+            }
+
+            const auto level = partition.GetQueryLevel(source, target, node);
+            if (level >= 1 && !heap.GetData(node).from_clique)
+            {
+                const auto cell = cells.GetCell(metric, level, partition.GetCell(level, node));
+                auto destination = cell.GetDestinationNodes().begin();
+                for (const auto shortcut_weight : cell.GetOutWeight(node))
+                {
+                    const NodeID to = *destination++;
+                    if (shortcut_weight != INVALID_EDGE_WEIGHT && to != node)
+                    {
+                        Update(to, weight + shortcut_weight, true);
+                    }
+                }
+            }
+
+            for (const auto edge : graph.GetBorderEdgeRange(level, node))
+            {
+                const auto &data = graph.GetEdgeData(edge);
+                if (data.forward)
+                {
+                    Update(graph.GetTarget(edge), weight + data.weight, false);
+                }
+            }
+        }
+
+        return {INVALID_EDGE_WEIGHT, settled_nodes};
+    }
+
+    // Runs queries between random pairs of allowed nodes and measures their times
+    Summary Evaluate(const std::size_t number_of_queries, const unsigned seed)
+    {
+        Summary summary;
+
+        std::vector<NodeID> nodes;
+        for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+        {
+            if (allowed_nodes[node])
+                nodes.push_back(node);
+        }
+        if (nodes.empty() || number_of_queries == 0)
+            return summary;
+
+        std::mt19937 generator(seed);
+        std::uniform_int_distribution<std::size_t> distribution(0, nodes.size() - 1);
+
+        std::vector<double> milliseconds;
+        milliseconds.reserve(number_of_queries);
+        std::size_t settled_nodes = 0;
+        for (std::size_t query = 0; query < number_of_queries; ++query)
+        {
+            const auto source = nodes[distribution(generator)];
+            const auto target = nodes[distribution(generator)];
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto result = Query(source, target);
+            const auto stop = std::chrono::steady_clock::now();
+
+            milliseconds.push_back(
+                std::chrono::duration<double, std::milli>(stop - start).count());
+            settled_nodes += result.settled_nodes;
+            summary.number_of_routes += result.weight != INVALID_EDGE_WEIGHT;
+        }
+
+        std::sort(milliseconds.begin(), milliseconds.end());
+        summary.number_of_queries = number_of_queries;
+        summary.mean_milliseconds =
+            std::accumulate(milliseconds.begin(), milliseconds.end(), 0.) / number_of_queries;
+        summary.median_milliseconds = milliseconds[number_of_queries / 2];
+        summary.p99_milliseconds = milliseconds[(number_of_queries - 1) * 99 / 100];
+        summary.mean_settled_nodes = static_cast<double>(settled_nodes) / number_of_queries;
+        return summary;
+    }
+
+  private:
+    void Update(const NodeID to, const EdgeWeight to_weight, const bool from_clique)
+    {
+        if (!allowed_nodes[to])
+            return;
+
+        if (!heap.WasInserted(to))
+        {
+            heap.Insert(to, to_weight, {from_clique, 0});
+        }
+        else if (to_weight < heap.GetKey(to))
+        {
+            heap.DecreaseKey(to, to_weight);
+            heap.GetData(to).from_clique = from_clique;
+        }
+    }
+
+    const GraphT &graph;
+    const partitioner::MultiLevelPartition &partition;
+    const partitioner::CellStorage &cells;
+    const CellMetric &metric;
+    const std::vector<bool> &allowed_nodes;
+    CellCustomizer::Heap heap;
+};
+}
+}
+
+#endif // OSRM_CUSTOMIZER_QUERY_EVALUATION_HPP
@@ -21,6 +21,9 @@ inline void read(storage::tar::FileReader &reader,
 {
     storage::serialization::read(reader, name + "/weights", metric.weights);
     storage::serialization::read(reader, name + "/durations", metric.durations);
+    storage::serialization::read(reader, name + "/compressed_cells", metric.compressed_cells);
+    storage::serialization::read(reader, name + "/narrow_weights", metric.narrow_weights);
+    storage::serialization::read(reader, name + "/narrow_durations", metric.narrow_durations);
 }
 
 template <storage::Ownership Ownership>
@@ -30,6 +33,9 @@ inline void write(storage::tar::FileWriter &writer,
 {
     storage::serialization::write(writer, name + "/weights", metric.weights);
     storage::serialization::write(writer, name + "/durations", metric.durations);
+    storage::serialization::write(writer, name + "/compressed_cells", metric.compressed_cells);
+    storage::serialization::write(writer, name + "/narrow_weights", metric.narrow_weights);
+    storage::serialization::write(writer, name + "/narrow_durations", metric.narrow_durations);
 }
 }
 }
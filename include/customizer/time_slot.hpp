@@ -0,0 +1,37 @@
+#ifndef OSRM_CUSTOMIZER_TIME_SLOT_HPP
+#define OSRM_CUSTOMIZER_TIME_SLOT_HPP
+
+#include <cstdint>
+
+namespace osrm
+{
+namespace customizer
+{
+// The departure times a metric of osrm-customize --time-slot is used for, as minutes of the day.
+// A slot whose end is before its begin wraps around midnight.
+struct TimeSlot
+{
+    static constexpr std::uint32_t MINUTES_PER_DAY = 24 * 60;
+
+    std::uint32_t begin_minute;
+    std::uint32_t end_minute;
+
+    bool IsValid() const
+    {
+        return begin_minute < MINUTES_PER_DAY && end_minute < MINUTES_PER_DAY &&
+               begin_minute != end_minute;
+    }
+
+    bool Contains(const std::uint32_t minute) const
+    {
+        if (begin_minute <= end_minute)
+        {
+            return begin_minute <= minute && minute < end_minute;
+        }
+        return begin_minute <= minute || minute < end_minute;
+    }
+};
+}
+}
+
+#endif // OSRM_CUSTOMIZER_TIME_SLOT_HPP
@@ -56,6 +56,15 @@ template <typename AlgorithmT> struct HasGetTileTurns final : std::false_type
 template <typename AlgorithmT> struct HasExcludeFlags final : std::false_type
 {
 };
+template <typename AlgorithmT> struct HasOneToAllSearch final : std::false_type
+{
+};
+template <typename AlgorithmT> struct HasRestrictedManyToManySearch final : std::false_type
+{
+};
+template <typename AlgorithmT> struct HasApproximateManyToManySearch final : std::false_type
+{
+};
 
 // Algorithms supported by Contraction Hierarchies
 template <> struct HasAlternativePathSearch<ch::Algorithm> final : std::true_type
@@ -79,6 +88,12 @@ template <> struct HasGetTileTurns<ch::Algorithm> final : std::true_type
 template <> struct HasExcludeFlags<ch::Algorithm> final : std::true_type
 {
 };
+template <> struct HasOneToAllSearch<ch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasRestrictedManyToManySearch<ch::Algorithm> final : std::true_type
+{
+};
 
 // Algorithms supported by Multi-Level Dijkstra
 template <> struct HasAlternativePathSearch<mld::Algorithm> final : std::true_type
@@ -102,6 +117,12 @@ template <> struct HasGetTileTurns<mld::Algorithm> final : std::true_type
 template <> struct HasExcludeFlags<mld::Algorithm> final : std::true_type
 {
 };
+template <> struct HasOneToAllSearch<mld::Algorithm> final : std::true_type
+{
+};
+template <> struct HasApproximateManyToManySearch<mld::Algorithm> final : std::true_type
+{
+};
 }
 }
 }
@@ -4,12 +4,16 @@
 #include "engine/api/base_parameters.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
 
+#include "engine/api/binary_factory.hpp"
 #include "engine/api/json_factory.hpp"
+#include "engine/api/native_result.hpp"
 #include "engine/hint.hpp"
 
 #include <boost/assert.hpp>
 #include <boost/range/algorithm/transform.hpp>
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -66,6 +70,57 @@ class BaseAPI
         }
     }
 
+    void WriteWaypoints(const std::vector<PhantomNodes> &segment_end_coordinates,
+                        binary::Writer &writer) const
+    {
+        BOOST_ASSERT(parameters.coordinates.size() > 0);
+        BOOST_ASSERT(parameters.coordinates.size() == segment_end_coordinates.size() + 1);
+
+        writer.WriteUInt32(static_cast<std::uint32_t>(parameters.coordinates.size()));
+        WriteWaypoint(segment_end_coordinates.front().source_phantom, writer);
+        for (const auto &phantom_pair : segment_end_coordinates)
+        {
+            WriteWaypoint(phantom_pair.target_phantom, writer);
+        }
+    }
+
+    // Binary counterpart of MakeWaypoint
+    void WriteWaypoint(const PhantomNode &phantom, binary::Writer &writer) const
+    {
+        binary::writeWaypoint(
+            writer,
+            phantom.location,
+            facade.GetNameForID(facade.GetNameIndex(phantom.forward_segment_id.id)).to_string(),
+            parameters.generate_hints ? Hint{phantom, facade.GetCheckSum()}.ToBase64()
+                                      : std::string());
+    }
+
+    // Native counterpart of MakeWaypoints
+    std::vector<native::Waypoint>
+    MakeNativeWaypoints(const std::vector<PhantomNodes> &segment_end_coordinates) const
+    {
+        BOOST_ASSERT(parameters.coordinates.size() > 0);
+        BOOST_ASSERT(parameters.coordinates.size() == segment_end_coordinates.size() + 1);
+
+        std::vector<native::Waypoint> waypoints;
+        waypoints.reserve(parameters.coordinates.size());
+        waypoints.push_back(MakeNativeWaypoint(segment_end_coordinates.front().source_phantom));
+        for (const auto &phantom_pair : segment_end_coordinates)
+        {
+            waypoints.push_back(MakeNativeWaypoint(phantom_pair.target_phantom));
+        }
+        return waypoints;
+    }
+
+    // Native counterpart of MakeWaypoint
+    native::Waypoint MakeNativeWaypoint(const PhantomNode &phantom) const
+    {
+        return {phantom.location,
+                facade.GetNameForID(facade.GetNameIndex(phantom.forward_segment_id.id)).to_string(),
+                parameters.generate_hints ? Hint{phantom, facade.GetCheckSum()}.ToBase64()
+                                          : std::string()};
+    }
+
     const datafacade::BaseDataFacade &facade;
     const BaseParameters &parameters;
 };
@@ -30,12 +30,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "engine/approach.hpp"
 #include "engine/bearing.hpp"
+#include "engine/cancellation_token.hpp"
 #include "engine/hint.hpp"
 #include "util/coordinate.hpp"
 
 #include <boost/optional.hpp>
 
 #include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace osrm
@@ -57,22 +60,41 @@ namespace api
  *  - bearings: limits the search for segments in the road network to given bearing(s) in degree
  *              towards true north in clockwise direction, optional per coordinate
  *  - approaches: force the phantom node to start towards the node with the road country side.
+ *  - metric: name of a metric that was loaded next to the dataset with osrm-datastore
+ *            --metric-name, the default metric of the dataset if empty.
+ *  - format: output format of the response, JSON or binary. Only route, table and match support
+ *            the binary format.
+ *  - cancellation_token: lets the caller stop the query while it runs, e.g. at a deadline. A
+ *                        cancelled query returns Status::Timeout. Not part of the URL.
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
  */
 struct BaseParameters
 {
+    enum class OutputFormatType
+    {
+        JSON,
+        Binary
+    };
+
     std::vector<util::Coordinate> coordinates;
     std::vector<boost::optional<Hint>> hints;
     std::vector<boost::optional<double>> radiuses;
     std::vector<boost::optional<Bearing>> bearings;
     std::vector<boost::optional<Approach>> approaches;
     std::vector<std::string> exclude;
+    std::string metric;
+    // Minute of the day of the departure, selects the metric of the time slot it falls into
+    boost::optional<std::uint32_t> depart_at;
 
     // Adds hints to response which can be included in subsequent requests, see `hints` above.
     bool generate_hints = true;
 
+    OutputFormatType format = OutputFormatType::JSON;
+
+    std::shared_ptr<const CancellationToken> cancellation_token;
+
     BaseParameters(const std::vector<util::Coordinate> coordinates_ = {},
                    const std::vector<boost::optional<Hint>> hints_ = {},
                    std::vector<boost::optional<double>> radiuses_ = {},
@@ -92,6 +114,7 @@ struct BaseParameters
                (bearings.empty() || bearings.size() == coordinates.size()) &&
                (radiuses.empty() || radiuses.size() == coordinates.size()) &&
                (approaches.empty() || approaches.size() == coordinates.size()) &&
+               (!depart_at || *depart_at < 24 * 60) &&
                std::all_of(bearings.begin(),
                            bearings.end(),
                            [](const boost::optional<Bearing> bearing_and_range) {
@@ -0,0 +1,36 @@
+#ifndef ENGINE_API_BASE_RESULT_HPP
+#define ENGINE_API_BASE_RESULT_HPP
+
+#include "engine/api/native_result.hpp"
+
+#include "util/json_container.hpp"
+
+#include <mapbox/variant.hpp>
+
+#include <string>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+
+/**
+ * Result of a route, table or match query.
+ *
+ * The alternative the result holds when it is passed to a query selects the response format:
+ * a JSON object, the binary format in a string or the plain result struct of the service, see
+ * native_result.hpp. A struct of another service selects JSON. Errors are always reported as
+ * JSON objects.
+ */
+using ResultT = mapbox::util::variant<util::json::Object,
+                                      std::string,
+                                      native::RouteResult,
+                                      native::TableResult,
+                                      native::MatchResult>;
+}
+}
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef ENGINE_API_BATCH_HPP
+#define ENGINE_API_BATCH_HPP
+
+#include "engine/api/batch_parameters.hpp"
+#include "engine/api/route_api.hpp"
+
+#include "engine/datafacade/datafacade_base.hpp"
+
+#include "engine/internal_route_result.hpp"
+
+#include "util/json_container.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+
+class BatchAPI final : public RouteAPI
+{
+  public:
+    // The summaries of all routes, filled by MakeRoute and rendered by MakeResponse
+    struct Routes
+    {
+        explicit Routes(const std::size_t number_of_routes)
+        {
+            durations.values.resize(number_of_routes, util::json::Null());
+            distances.values.resize(number_of_routes, util::json::Null());
+            geometries.values.resize(number_of_routes, util::json::Null());
+        }
+
+        util::json::Array durations;
+        util::json::Array distances;
+        util::json::Array geometries;
+    };
+
+    BatchAPI(const datafacade::BaseDataFacade &facade_, const BatchParameters &parameters_)
+        : RouteAPI(facade_, parameters_), parameters(parameters_)
+    {
+    }
+
+    // Summarizes the route at index, routes that were not found stay null. Different indices
+    // can be filled in parallel.
+    void MakeRoute(const InternalRouteResult &route, const std::size_t index, Routes &routes) const
+    {
+        if (!route.is_valid())
+            return;
+
+        std::vector<guidance::RouteLeg> legs;
+        std::vector<guidance::LegGeometry> leg_geometries;
+        AssembleLegs(route.segment_end_coordinates,
+                     route.unpacked_path_segments,
+                     route.source_traversed_in_reverse,
+                     route.target_traversed_in_reverse,
+                     legs,
+                     leg_geometries);
+
+        const auto summary = guidance::assembleRoute(legs);
+        routes.durations.values[index] = summary.duration;
+        routes.distances.values[index] = summary.distance;
+
+        if (parameters.overview != RouteParameters::OverviewType::False)
+        {
+            const auto use_simplification =
+                parameters.overview == RouteParameters::OverviewType::Simplified;
+            const auto overview = guidance::assembleOverview(leg_geometries, use_simplification);
+            routes.geometries.values[index] = MakeGeometry(overview.begin(), overview.end());
+        }
+    }
+
+    void MakeResponse(Routes routes, util::json::Object &response) const
+    {
+        response.values["durations"] = std::move(routes.durations);
+        response.values["distances"] = std::move(routes.distances);
+        if (parameters.overview != RouteParameters::OverviewType::False)
+        {
+            response.values["geometries"] = std::move(routes.geometries);
+        }
+        response.values["code"] = "Ok";
+    }
+
+  protected:
+    const BatchParameters &parameters;
+};
+
+} // ns api
+} // ns engine
+} // ns osrm
+
+#endif
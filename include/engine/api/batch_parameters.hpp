@@ -0,0 +1,106 @@
+/*
+
+Copyright (c) 2017, Project OSRM contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list
+of conditions and the following disclaimer.
+Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ENGINE_API_BATCH_PARAMETERS_HPP
+#define ENGINE_API_BATCH_PARAMETERS_HPP
+
+#include "engine/api/route_parameters.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+
+/**
+ * Parameters specific to the OSRM Batch service.
+ *
+ * Holds many independent routes between pairs of coordinates, the pairs index into the
+ * coordinates. Without pairs consecutive coordinates are paired, i.e. 0 and 1, 2 and 3 and so on.
+ * Of the route options only geometries, overview and continue_straight are supported, the
+ * overview is disabled by default.
+ *
+ * \see OSRM, Coordinate, Hint, Bearing, RouteParameters, TableParameters,
+ *      NearestParameters, TripParameters, MatchParameters and TileParameters
+ */
+struct BatchParameters : public RouteParameters
+{
+    using Pair = std::pair<std::size_t, std::size_t>;
+
+    BatchParameters() { overview = OverviewType::False; }
+
+    template <typename... Args>
+    BatchParameters(std::vector<Pair> pairs_, Args &&... args_)
+        : RouteParameters{std::forward<Args>(args_)...}, pairs{std::move(pairs_)}
+    {
+    }
+
+    std::vector<Pair> pairs;
+
+    // The pairs that are routed, either the given ones or the consecutive coordinates
+    std::vector<Pair> GetPairs() const
+    {
+        if (!pairs.empty())
+            return pairs;
+
+        std::vector<Pair> consecutive_pairs;
+        consecutive_pairs.reserve(coordinates.size() / 2);
+        for (std::size_t index = 0; index + 1 < coordinates.size(); index += 2)
+            consecutive_pairs.emplace_back(index, index + 1);
+        return consecutive_pairs;
+    }
+
+    bool IsValid() const
+    {
+        if (!BaseParameters::IsValid() || coordinates.empty())
+            return false;
+
+        // only the durations, distances and geometries of the routes are returned
+        if (format != OutputFormatType::JSON || steps || alternatives ||
+            number_of_alternatives > 0 || annotations ||
+            annotations_type != AnnotationsType::None)
+            return false;
+
+        if (pairs.empty())
+            return coordinates.size() % 2 == 0;
+
+        return std::all_of(pairs.begin(), pairs.end(), [this](const Pair &pair) {
+            return pair.first < coordinates.size() && pair.second < coordinates.size();
+        });
+    }
+};
+}
+}
+}
+
+#endif // ENGINE_API_BATCH_PARAMETERS_HPP
@@ -0,0 +1,107 @@
+#ifndef ENGINE_API_BINARY_FACTORY_HPP
+#define ENGINE_API_BINARY_FACTORY_HPP
+
+#include "engine/guidance/route.hpp"
+#include "engine/guidance/route_leg.hpp"
+#include "util/coordinate.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+namespace binary
+{
+
+// Version of the binary format, incremented on incompatible layout changes
+const constexpr std::uint8_t FORMAT_VERSION = 1;
+
+// Marks missing indices and durations of unreachable table entries
+const constexpr std::uint32_t INVALID_INDEX = 0xffffffff;
+const constexpr std::int32_t INVALID_DURATION = -1;
+
+enum class ResponseType : std::uint8_t
+{
+    Route = 1,
+    Table = 2,
+    Match = 3
+};
+
+/**
+ * Appends little-endian values to the binary response, see docs/http.md for the layout.
+ *
+ * Strings are prefixed by their length in bytes and coordinates are written as fixed point
+ * longitude and latitude in 1e-6 degrees, so that no number is converted to text.
+ */
+class Writer
+{
+  public:
+    explicit Writer(std::string &buffer_) : buffer(buffer_) {}
+
+    void Reserve(const std::size_t size) { buffer.reserve(buffer.size() + size); }
+
+    void WriteUInt8(const std::uint8_t value) { buffer.push_back(static_cast<char>(value)); }
+
+    void WriteUInt32(const std::uint32_t value)
+    {
+        const char bytes[] = {static_cast<char>(value & 0xff),
+                              static_cast<char>((value >> 8) & 0xff),
+                              static_cast<char>((value >> 16) & 0xff),
+                              static_cast<char>((value >> 24) & 0xff)};
+        buffer.append(bytes, sizeof(bytes));
+    }
+
+    void WriteInt32(const std::int32_t value) { WriteUInt32(static_cast<std::uint32_t>(value)); }
+
+    void WriteDouble(const double value)
+    {
+        static_assert(sizeof(double) == sizeof(std::uint64_t), "double is not 64 bit wide");
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        WriteUInt32(static_cast<std::uint32_t>(bits & 0xffffffff));
+        WriteUInt32(static_cast<std::uint32_t>(bits >> 32));
+    }
+
+    void WriteString(const std::string &value)
+    {
+        WriteUInt32(static_cast<std::uint32_t>(value.size()));
+        buffer.append(value);
+    }
+
+    void WriteCoordinate(const util::Coordinate coordinate)
+    {
+        WriteInt32(static_cast<std::int32_t>(coordinate.lon));
+        WriteInt32(static_cast<std::int32_t>(coordinate.lat));
+    }
+
+  private:
+    std::string &buffer;
+};
+
+void writeHeader(Writer &writer, const ResponseType type);
+
+// Writes a waypoint, the hint is empty if no hints are generated
+void writeWaypoint(Writer &writer,
+                   const util::Coordinate location,
+                   const std::string &name,
+                   const std::string &hint);
+
+// Writes the summary of a route, the overview geometry is empty without overview
+void writeRoute(Writer &writer,
+                const guidance::Route &route,
+                const std::vector<guidance::RouteLeg> &legs,
+                const std::vector<util::Coordinate> &overview,
+                const char *weight_name);
+
+} // namespace binary
+} // namespace api
+} // namespace engine
+} // namespace osrm
+
+#endif // ENGINE_API_BINARY_FACTORY_HPP
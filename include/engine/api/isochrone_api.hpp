@@ -0,0 +1,157 @@
+#ifndef ENGINE_API_ISOCHRONE_API_HPP
+#define ENGINE_API_ISOCHRONE_API_HPP
+
+#include "engine/api/base_api.hpp"
+#include "engine/api/isochrone_parameters.hpp"
+
+#include "engine/api/json_factory.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/routing_algorithms/one_to_all.hpp"
+
+#include "util/coordinate.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+
+class IsochroneAPI final : public BaseAPI
+{
+  public:
+    IsochroneAPI(const datafacade::BaseDataFacade &facade_,
+                 const IsochroneParameters &parameters_)
+        : BaseAPI(facade_, parameters_), parameters(parameters_)
+    {
+    }
+
+    // Every reached segment contributes the location it starts at, locations that start several
+    // segments are written once with the smallest duration. Sorted by duration.
+    void MakeResponse(const PhantomNode &source_phantom,
+                      const std::vector<routing_algorithms::ReachedNode> &reached_nodes,
+                      util::json::Object &response) const
+    {
+        std::unordered_map<NodeID, EdgeDuration> durations;
+        durations.reserve(reached_nodes.size());
+        for (const auto &reached : reached_nodes)
+        {
+            const auto geometry_index = facade.GetGeometryIndex(reached.node);
+            const auto geometry = geometry_index.forward
+                                      ? facade.GetUncompressedForwardGeometry(geometry_index.id)
+                                      : facade.GetUncompressedReverseGeometry(geometry_index.id);
+            BOOST_ASSERT(!geometry.empty());
+
+            const auto inserted = durations.insert({geometry.front(), reached.duration});
+            if (!inserted.second)
+                inserted.first->second = std::min(inserted.first->second, reached.duration);
+        }
+
+        std::vector<std::pair<NodeID, EdgeDuration>> locations(durations.begin(),
+                                                               durations.end());
+        std::sort(locations.begin(), locations.end(), [](const auto &lhs, const auto &rhs) {
+            return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
+        });
+
+        std::vector<util::Coordinate> coordinates;
+        coordinates.reserve(locations.size() + 1);
+        util::json::Array json_locations;
+        util::json::Array json_durations;
+        json_locations.values.reserve(locations.size());
+        json_durations.values.reserve(locations.size());
+        for (const auto &location : locations)
+        {
+            coordinates.push_back(facade.GetCoordinateOfNode(location.first));
+            json_locations.values.push_back(json::detail::coordinateToLonLat(coordinates.back()));
+            json_durations.values.push_back(location.second / 10.);
+        }
+        coordinates.push_back(source_phantom.location);
+
+        util::json::Array ring;
+        for (const auto &coordinate : MakeConvexHull(std::move(coordinates)))
+        {
+            ring.values.push_back(json::detail::coordinateToLonLat(coordinate));
+        }
+        ring.values.push_back(ring.values.front());
+
+        util::json::Array rings;
+        rings.values.push_back(std::move(ring));
+        util::json::Object polygon;
+        polygon.values["type"] = "Polygon";
+        polygon.values["coordinates"] = std::move(rings);
+
+        util::json::Array waypoints;
+        waypoints.values.push_back(MakeWaypoint(source_phantom));
+
+        response.values["waypoints"] = std::move(waypoints);
+        response.values["locations"] = std::move(json_locations);
+        response.values["durations"] = std::move(json_durations);
+        response.values["polygon"] = std::move(polygon);
+        response.values["code"] = "Ok";
+    }
+
+    const IsochroneParameters &parameters;
+
+  private:
+    // Counter-clockwise convex hull without collinear points (Andrew's monotone chain), the
+    // fixed point coordinates keep the orientation tests exact
+    static std::vector<util::Coordinate> MakeConvexHull(std::vector<util::Coordinate> points)
+    {
+        const auto less = [](const util::Coordinate lhs, const util::Coordinate rhs) {
+            return std::tie(lhs.lon, lhs.lat) < std::tie(rhs.lon, rhs.lat);
+        };
+        std::sort(points.begin(), points.end(), less);
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+        if (points.size() < 3)
+            return points;
+
+        const auto turns_left = [](const util::Coordinate first,
+                                   const util::Coordinate second,
+                                   const util::Coordinate third) {
+            const auto lon = [](const util::Coordinate coordinate) {
+                return static_cast<std::int64_t>(static_cast<std::int32_t>(coordinate.lon));
+            };
+            const auto lat = [](const util::Coordinate coordinate) {
+                return static_cast<std::int64_t>(static_cast<std::int32_t>(coordinate.lat));
+            };
+            return (lon(second) - lon(first)) * (lat(third) - lat(first)) -
+                       (lat(second) - lat(first)) * (lon(third) - lon(first)) >
+                   0;
+        };
+
+        std::vector<util::Coordinate> hull(2 * points.size());
+        std::size_t size = 0;
+        for (auto point = points.begin(); point != points.end(); ++point)
+        {
+            while (size >= 2 && !turns_left(hull[size - 2], hull[size - 1], *point))
+                --size;
+            hull[size++] = *point;
+        }
+        const auto lower_size = size + 1;
+        for (auto point = std::next(points.rbegin()); point != points.rend(); ++point)
+        {
+            while (size >= lower_size && !turns_left(hull[size - 2], hull[size - 1], *point))
+                --size;
+            hull[size++] = *point;
+        }
+        // the last point closes the chain at the first one
+        hull.resize(size - 1);
+        return hull;
+    }
+};
+
+} // ns api
+} // ns engine
+} // ns osrm
+
+#endif
@@ -11,6 +11,12 @@
 #include "engine/map_matching/sub_matching.hpp"
 
 #include "util/integer_range.hpp"
+#include "util/request_trace.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -29,6 +35,70 @@ class MatchAPI final : public RouteAPI
     {
     }
 
+    // Renders the response in the format selected by the alternative the response holds
+    void MakeResponse(const std::vector<map_matching::SubMatching> &sub_matchings,
+                      const std::vector<InternalRouteResult> &sub_routes,
+                      ResultT &response) const
+    {
+        const util::TraceSpan span("response");
+        if (response.is<std::string>())
+        {
+            MakeResponse(sub_matchings, sub_routes, response.get<std::string>());
+        }
+        else if (response.is<native::MatchResult>())
+        {
+            MakeResponse(sub_matchings, sub_routes, response.get<native::MatchResult>());
+        }
+        else
+        {
+            if (!response.is<util::json::Object>())
+                response = util::json::Object();
+            MakeResponse(sub_matchings, sub_routes, response.get<util::json::Object>());
+        }
+    }
+
+    void MakeResponse(const std::vector<map_matching::SubMatching> &sub_matchings,
+                      const std::vector<InternalRouteResult> &sub_routes,
+                      native::MatchResult &response) const
+    {
+        BOOST_ASSERT(sub_matchings.size() == sub_routes.size());
+
+        response.tracepoints = MakeNativeTracepoints(sub_matchings);
+        response.matchings.clear();
+        response.matchings.reserve(sub_matchings.size());
+        for (auto index : util::irange<std::size_t>(0UL, sub_matchings.size()))
+        {
+            response.matchings.push_back(
+                {MakeNativeRoute(sub_routes[index].segment_end_coordinates,
+                                 sub_routes[index].unpacked_path_segments,
+                                 sub_routes[index].source_traversed_in_reverse,
+                                 sub_routes[index].target_traversed_in_reverse),
+                 sub_matchings[index].confidence});
+        }
+    }
+
+    void MakeResponse(const std::vector<map_matching::SubMatching> &sub_matchings,
+                      const std::vector<InternalRouteResult> &sub_routes,
+                      std::string &response) const
+    {
+        BOOST_ASSERT(sub_matchings.size() == sub_routes.size());
+
+        binary::Writer writer(response);
+        binary::writeHeader(writer, binary::ResponseType::Match);
+        WriteTracepoints(sub_matchings, writer);
+
+        writer.WriteUInt32(static_cast<std::uint32_t>(sub_matchings.size()));
+        for (auto index : util::irange<std::size_t>(0UL, sub_matchings.size()))
+        {
+            WriteRoute(sub_routes[index].segment_end_coordinates,
+                       sub_routes[index].unpacked_path_segments,
+                       sub_routes[index].source_traversed_in_reverse,
+                       sub_routes[index].target_traversed_in_reverse,
+                       writer);
+            writer.WriteDouble(sub_matchings[index].confidence);
+        }
+    }
+
     void MakeResponse(const std::vector<map_matching::SubMatching> &sub_matchings,
                       const std::vector<InternalRouteResult> &sub_routes,
                       util::json::Object &response) const
@@ -52,33 +122,30 @@ class MatchAPI final : public RouteAPI
     }
 
   protected:
-    // FIXME this logic is a little backwards. We should change the output format of the
-    // map_matching
-    // routing algorithm to be easier to consume here.
-    util::json::Array
-    MakeTracepoints(const std::vector<map_matching::SubMatching> &sub_matchings) const
+    struct MatchingIndex
     {
-        util::json::Array waypoints;
-        waypoints.values.reserve(parameters.coordinates.size());
-
-        struct MatchingIndex
+        MatchingIndex() = default;
+        MatchingIndex(unsigned sub_matching_index_, unsigned point_index_)
+            : sub_matching_index(sub_matching_index_), point_index(point_index_)
         {
-            MatchingIndex() = default;
-            MatchingIndex(unsigned sub_matching_index_, unsigned point_index_)
-                : sub_matching_index(sub_matching_index_), point_index(point_index_)
-            {
-            }
+        }
 
-            unsigned sub_matching_index = std::numeric_limits<unsigned>::max();
-            unsigned point_index = std::numeric_limits<unsigned>::max();
+        unsigned sub_matching_index = std::numeric_limits<unsigned>::max();
+        unsigned point_index = std::numeric_limits<unsigned>::max();
 
-            bool NotMatched()
-            {
-                return sub_matching_index == std::numeric_limits<unsigned>::max() &&
-                       point_index == std::numeric_limits<unsigned>::max();
-            }
-        };
+        bool NotMatched()
+        {
+            return sub_matching_index == std::numeric_limits<unsigned>::max() &&
+                   point_index == std::numeric_limits<unsigned>::max();
+        }
+    };
 
+    // FIXME this logic is a little backwards. We should change the output format of the
+    // map_matching
+    // routing algorithm to be easier to consume here.
+    std::vector<MatchingIndex>
+    MakeMatchingIndices(const std::vector<map_matching::SubMatching> &sub_matchings) const
+    {
         std::vector<MatchingIndex> trace_idx_to_matching_idx(parameters.coordinates.size());
         for (auto sub_matching_index :
              util::irange(0u, static_cast<unsigned>(sub_matchings.size())))
@@ -96,6 +163,100 @@ class MatchAPI final : public RouteAPI
                     MatchingIndex{sub_matching_index, point_index};
             }
         }
+        return trace_idx_to_matching_idx;
+    }
+
+    // Binary counterpart of MakeTracepoints, every tracepoint starts with a flag whether it was
+    // matched and missing waypoint indices are written as binary::INVALID_INDEX
+    void WriteTracepoints(const std::vector<map_matching::SubMatching> &sub_matchings,
+                          binary::Writer &writer) const
+    {
+        const auto trace_idx_to_matching_idx = MakeMatchingIndices(sub_matchings);
+
+        BOOST_ASSERT(parameters.waypoints.empty() || sub_matchings.size() == 1);
+
+        writer.WriteUInt32(static_cast<std::uint32_t>(parameters.coordinates.size()));
+        std::uint32_t was_waypoint_idx = 0;
+        for (auto trace_index : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
+        {
+            auto matching_index = trace_idx_to_matching_idx[trace_index];
+            if (tidy_result.can_be_removed[trace_index] || matching_index.NotMatched())
+            {
+                writer.WriteUInt8(0);
+                continue;
+            }
+            writer.WriteUInt8(1);
+
+            const auto &sub_matching = sub_matchings[matching_index.sub_matching_index];
+            BaseAPI::WriteWaypoint(sub_matching.nodes[matching_index.point_index], writer);
+            writer.WriteUInt32(matching_index.sub_matching_index);
+
+            // waypoint indices need to be adjusted if route legs were collapsed
+            if (parameters.waypoints.empty())
+            {
+                writer.WriteUInt32(matching_index.point_index);
+            }
+            else if (tidy_result.was_waypoint[trace_index])
+            {
+                writer.WriteUInt32(was_waypoint_idx++);
+            }
+            else
+            {
+                writer.WriteUInt32(binary::INVALID_INDEX);
+            }
+            writer.WriteUInt32(sub_matching.alternatives_count[matching_index.point_index]);
+        }
+    }
+
+    // Native counterpart of WriteTracepoints
+    std::vector<native::Tracepoint>
+    MakeNativeTracepoints(const std::vector<map_matching::SubMatching> &sub_matchings) const
+    {
+        const auto trace_idx_to_matching_idx = MakeMatchingIndices(sub_matchings);
+
+        BOOST_ASSERT(parameters.waypoints.empty() || sub_matchings.size() == 1);
+
+        std::vector<native::Tracepoint> tracepoints;
+        tracepoints.reserve(parameters.coordinates.size());
+        std::uint32_t was_waypoint_idx = 0;
+        for (auto trace_index : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
+        {
+            auto matching_index = trace_idx_to_matching_idx[trace_index];
+            if (tidy_result.can_be_removed[trace_index] || matching_index.NotMatched())
+            {
+                tracepoints.push_back({false, {}, 0, native::INVALID_INDEX, 0});
+                continue;
+            }
+
+            const auto &sub_matching = sub_matchings[matching_index.sub_matching_index];
+            native::Tracepoint tracepoint{
+                true,
+                BaseAPI::MakeNativeWaypoint(sub_matching.nodes[matching_index.point_index]),
+                matching_index.sub_matching_index,
+                native::INVALID_INDEX,
+                sub_matching.alternatives_count[matching_index.point_index]};
+
+            // waypoint indices need to be adjusted if route legs were collapsed
+            if (parameters.waypoints.empty())
+            {
+                tracepoint.waypoint_index = matching_index.point_index;
+            }
+            else if (tidy_result.was_waypoint[trace_index])
+            {
+                tracepoint.waypoint_index = was_waypoint_idx++;
+            }
+            tracepoints.push_back(std::move(tracepoint));
+        }
+        return tracepoints;
+    }
+
+    util::json::Array
+    MakeTracepoints(const std::vector<map_matching::SubMatching> &sub_matchings) const
+    {
+        util::json::Array waypoints;
+        waypoints.values.reserve(parameters.coordinates.size());
+
+        const auto trace_idx_to_matching_idx = MakeMatchingIndices(sub_matchings);
 
         BOOST_ASSERT(parameters.waypoints.empty() || sub_matchings.size() == 1);
 
@@ -30,6 +30,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "engine/api/route_parameters.hpp"
 
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -44,6 +45,8 @@ namespace api
  *
  * Holds member attributes:
  *  - timestamps: timestamp(s) for the corresponding input coordinate(s)
+ *  - session: id of the trace that the coordinates extend, a server that keeps matching
+ *             sessions only searches the candidates and transitions of the new coordinates
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
@@ -88,6 +91,7 @@ struct MatchParameters : public RouteParameters
     GapsType gaps;
     bool tidy;
     std::vector<std::size_t> waypoints;
+    std::string session;
 
     bool IsValid() const
     {
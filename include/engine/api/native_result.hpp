@@ -0,0 +1,100 @@
+#ifndef ENGINE_API_NATIVE_RESULT_HPP
+#define ENGINE_API_NATIVE_RESULT_HPP
+
+#include "util/coordinate.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+namespace native
+{
+
+/**
+ * Plain C++ results of route, table and match queries for callers that embed libosrm.
+ *
+ * They hold the same data as the binary format: waypoints, route summaries, the overview geometry
+ * and the legs, but no steps or annotations. Durations are in seconds and distances in meters.
+ */
+
+// Marks missing waypoint indices of tracepoints
+const constexpr std::uint32_t INVALID_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+struct Waypoint
+{
+    util::Coordinate location;
+    std::string name;
+    // empty if no hints are generated
+    std::string hint;
+};
+
+struct RouteLeg
+{
+    double distance;
+    double duration;
+    double weight;
+    std::string summary;
+};
+
+struct Route
+{
+    double distance;
+    double duration;
+    double weight;
+    std::string weight_name;
+    // the overview geometry, empty without overview
+    std::vector<util::Coordinate> geometry;
+    std::vector<RouteLeg> legs;
+};
+
+struct RouteResult
+{
+    std::vector<Waypoint> waypoints;
+    std::vector<Route> routes;
+};
+
+struct TableResult
+{
+    std::vector<Waypoint> sources;
+    std::vector<Waypoint> destinations;
+    // row by row for each source, empty if not requested. Unreachable pairs are infinite.
+    std::vector<double> durations;
+    std::vector<double> distances;
+};
+
+struct Tracepoint
+{
+    // the other members are only set for matched tracepoints
+    bool matched;
+    Waypoint waypoint;
+    std::uint32_t matchings_index;
+    // INVALID_INDEX for tracepoints that are no waypoints of the matching
+    std::uint32_t waypoint_index;
+    std::uint32_t alternatives_count;
+};
+
+struct Matching
+{
+    Route route;
+    double confidence;
+};
+
+struct MatchResult
+{
+    std::vector<Tracepoint> tracepoints;
+    std::vector<Matching> matchings;
+};
+
+} // namespace native
+} // namespace api
+} // namespace engine
+} // namespace osrm
+
+#endif // ENGINE_API_NATIVE_RESULT_HPP
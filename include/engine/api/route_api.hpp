@@ -3,6 +3,8 @@
 
 #include "extractor/maneuver_override.hpp"
 #include "engine/api/base_api.hpp"
+#include "engine/api/base_result.hpp"
+#include "engine/api/binary_factory.hpp"
 #include "engine/api/json_factory.hpp"
 #include "engine/api/route_parameters.hpp"
 
@@ -25,8 +27,12 @@
 #include "util/coordinate.hpp"
 #include "util/integer_range.hpp"
 #include "util/json_util.hpp"
+#include "util/request_trace.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <iterator>
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -44,6 +50,72 @@ class RouteAPI : public BaseAPI
     {
     }
 
+    // Renders the response in the format selected by the alternative the response holds
+    void MakeResponse(const InternalManyRoutesResult &raw_routes, ResultT &response) const
+    {
+        const util::TraceSpan span("response");
+        if (response.is<std::string>())
+        {
+            MakeResponse(raw_routes, response.get<std::string>());
+        }
+        else if (response.is<native::RouteResult>())
+        {
+            MakeResponse(raw_routes, response.get<native::RouteResult>());
+        }
+        else
+        {
+            if (!response.is<util::json::Object>())
+                response = util::json::Object();
+            MakeResponse(raw_routes, response.get<util::json::Object>());
+        }
+    }
+
+    void MakeResponse(const InternalManyRoutesResult &raw_routes,
+                      native::RouteResult &response) const
+    {
+        BOOST_ASSERT(!raw_routes.routes.empty());
+
+        response.waypoints =
+            BaseAPI::MakeNativeWaypoints(raw_routes.routes[0].segment_end_coordinates);
+        response.routes.clear();
+        for (const auto &route : raw_routes.routes)
+        {
+            if (!route.is_valid())
+                continue;
+
+            response.routes.push_back(MakeNativeRoute(route.segment_end_coordinates,
+                                                      route.unpacked_path_segments,
+                                                      route.source_traversed_in_reverse,
+                                                      route.target_traversed_in_reverse));
+        }
+    }
+
+    void MakeResponse(const InternalManyRoutesResult &raw_routes, std::string &response) const
+    {
+        BOOST_ASSERT(!raw_routes.routes.empty());
+
+        binary::Writer writer(response);
+        binary::writeHeader(writer, binary::ResponseType::Route);
+        BaseAPI::WriteWaypoints(raw_routes.routes[0].segment_end_coordinates, writer);
+
+        const auto number_of_routes =
+            std::count_if(raw_routes.routes.begin(),
+                          raw_routes.routes.end(),
+                          [](const InternalRouteResult &route) { return route.is_valid(); });
+        writer.WriteUInt32(static_cast<std::uint32_t>(number_of_routes));
+        for (const auto &route : raw_routes.routes)
+        {
+            if (!route.is_valid())
+                continue;
+
+            WriteRoute(route.segment_end_coordinates,
+                       route.unpacked_path_segments,
+                       route.source_traversed_in_reverse,
+                       route.target_traversed_in_reverse,
+                       writer);
+        }
+    }
+
     void MakeResponse(const InternalManyRoutesResult &raw_routes,
                       util::json::Object &response) const
     {
@@ -86,6 +158,18 @@ class RouteAPI : public BaseAPI
         return json::makeGeoJSONGeometry(begin, end);
     }
 
+    RouteParameters::AnnotationsType GetRequestedAnnotations() const
+    {
+        // To maintain support for uses of the old default constructors, we check
+        // if annotations property was set manually after default construction
+        if ((parameters.annotations == true) &&
+            (parameters.annotations_type == RouteParameters::AnnotationsType::None))
+        {
+            return RouteParameters::AnnotationsType::All;
+        }
+        return parameters.annotations_type;
+    }
+
     template <typename GetFn>
     util::json::Array GetAnnotations(const guidance::LegGeometry &leg, GetFn Get) const
     {
@@ -100,17 +184,23 @@ class RouteAPI : public BaseAPI
         return annotations_store;
     }
 
-    util::json::Object MakeRoute(const std::vector<PhantomNodes> &segment_end_coordinates,
-                                 const std::vector<std::vector<PathData>> &unpacked_path_segments,
-                                 const std::vector<bool> &source_traversed_in_reverse,
-                                 const std::vector<bool> &target_traversed_in_reverse) const
+    void AssembleLegs(const std::vector<PhantomNodes> &segment_end_coordinates,
+                      const std::vector<std::vector<PathData>> &unpacked_path_segments,
+                      const std::vector<bool> &source_traversed_in_reverse,
+                      const std::vector<bool> &target_traversed_in_reverse,
+                      std::vector<guidance::RouteLeg> &legs,
+                      std::vector<guidance::LegGeometry> &leg_geometries) const
     {
-        std::vector<guidance::RouteLeg> legs;
-        std::vector<guidance::LegGeometry> leg_geometries;
+        const util::TraceSpan span("guidance");
         auto number_of_legs = segment_end_coordinates.size();
         legs.reserve(number_of_legs);
         leg_geometries.reserve(number_of_legs);
 
+        // without an overview, steps and annotations only the distances of the legs are used
+        const bool needs_geometry =
+            parameters.steps || parameters.overview != RouteParameters::OverviewType::False ||
+            GetRequestedAnnotations() != RouteParameters::AnnotationsType::None;
+
         for (auto idx : util::irange<std::size_t>(0UL, number_of_legs))
         {
             const auto &phantoms = segment_end_coordinates[idx];
@@ -119,12 +209,18 @@ class RouteAPI : public BaseAPI
             const bool reversed_source = source_traversed_in_reverse[idx];
             const bool reversed_target = target_traversed_in_reverse[idx];
 
-            auto leg_geometry = guidance::assembleGeometry(BaseAPI::facade,
-                                                           path_data,
-                                                           phantoms.source_phantom,
-                                                           phantoms.target_phantom,
-                                                           reversed_source,
-                                                           reversed_target);
+            auto leg_geometry =
+                needs_geometry
+                    ? guidance::assembleGeometry(BaseAPI::facade,
+                                                 path_data,
+                                                 phantoms.source_phantom,
+                                                 phantoms.target_phantom,
+                                                 reversed_source,
+                                                 reversed_target)
+                    : guidance::assembleSegmentDistances(BaseAPI::facade,
+                                                         path_data,
+                                                         phantoms.source_phantom,
+                                                         phantoms.target_phantom);
             auto leg = guidance::assembleLeg(facade,
                                              path_data,
                                              leg_geometry,
@@ -133,7 +229,6 @@ class RouteAPI : public BaseAPI
                                              reversed_target,
                                              parameters.steps);
 
-            util::Log(logDEBUG) << "Assembling steps " << std::endl;
             if (parameters.steps)
             {
                 auto steps = guidance::assembleSteps(BaseAPI::facade,
@@ -199,6 +294,83 @@ class RouteAPI : public BaseAPI
             leg_geometries.push_back(std::move(leg_geometry));
             legs.push_back(std::move(leg));
         }
+    }
+
+    // Binary counterpart of MakeRoute, steps and annotations are not part of the binary format
+    void WriteRoute(const std::vector<PhantomNodes> &segment_end_coordinates,
+                    const std::vector<std::vector<PathData>> &unpacked_path_segments,
+                    const std::vector<bool> &source_traversed_in_reverse,
+                    const std::vector<bool> &target_traversed_in_reverse,
+                    binary::Writer &writer) const
+    {
+        std::vector<guidance::RouteLeg> legs;
+        std::vector<guidance::LegGeometry> leg_geometries;
+        AssembleLegs(segment_end_coordinates,
+                     unpacked_path_segments,
+                     source_traversed_in_reverse,
+                     target_traversed_in_reverse,
+                     legs,
+                     leg_geometries);
+
+        const auto route = guidance::assembleRoute(legs);
+        std::vector<util::Coordinate> overview;
+        if (parameters.overview != RouteParameters::OverviewType::False)
+        {
+            const auto use_simplification =
+                parameters.overview == RouteParameters::OverviewType::Simplified;
+            overview = guidance::assembleOverview(leg_geometries, use_simplification);
+        }
+
+        binary::writeRoute(writer, route, legs, overview, facade.GetWeightName());
+    }
+
+    // Native counterpart of WriteRoute
+    native::Route MakeNativeRoute(const std::vector<PhantomNodes> &segment_end_coordinates,
+                                  const std::vector<std::vector<PathData>> &unpacked_path_segments,
+                                  const std::vector<bool> &source_traversed_in_reverse,
+                                  const std::vector<bool> &target_traversed_in_reverse) const
+    {
+        std::vector<guidance::RouteLeg> legs;
+        std::vector<guidance::LegGeometry> leg_geometries;
+        AssembleLegs(segment_end_coordinates,
+                     unpacked_path_segments,
+                     source_traversed_in_reverse,
+                     target_traversed_in_reverse,
+                     legs,
+                     leg_geometries);
+
+        const auto route = guidance::assembleRoute(legs);
+        native::Route native_route{
+            route.distance, route.duration, route.weight, facade.GetWeightName(), {}, {}};
+        if (parameters.overview != RouteParameters::OverviewType::False)
+        {
+            const auto use_simplification =
+                parameters.overview == RouteParameters::OverviewType::Simplified;
+            native_route.geometry = guidance::assembleOverview(leg_geometries, use_simplification);
+        }
+
+        native_route.legs.reserve(legs.size());
+        for (auto &leg : legs)
+        {
+            native_route.legs.push_back(
+                {leg.distance, leg.duration, leg.weight, std::move(leg.summary)});
+        }
+        return native_route;
+    }
+
+    util::json::Object MakeRoute(const std::vector<PhantomNodes> &segment_end_coordinates,
+                                 const std::vector<std::vector<PathData>> &unpacked_path_segments,
+                                 const std::vector<bool> &source_traversed_in_reverse,
+                                 const std::vector<bool> &target_traversed_in_reverse) const
+    {
+        std::vector<guidance::RouteLeg> legs;
+        std::vector<guidance::LegGeometry> leg_geometries;
+        AssembleLegs(segment_end_coordinates,
+                     unpacked_path_segments,
+                     source_traversed_in_reverse,
+                     target_traversed_in_reverse,
+                     legs,
+                     leg_geometries);
 
         auto route = guidance::assembleRoute(legs);
         boost::optional<util::json::Value> json_overview;
@@ -252,15 +424,7 @@ class RouteAPI : public BaseAPI
 
         std::vector<util::json::Object> annotations;
 
-        // To maintain support for uses of the old default constructors, we check
-        // if annotations property was set manually after default construction
-        auto requested_annotations = parameters.annotations_type;
-        if ((parameters.annotations == true) &&
-            (parameters.annotations_type == RouteParameters::AnnotationsType::None))
-        {
-            requested_annotations = RouteParameters::AnnotationsType::All;
-        }
-
+        const auto requested_annotations = GetRequestedAnnotations();
         if (requested_annotations != RouteParameters::AnnotationsType::None)
         {
             for (const auto idx : util::irange<std::size_t>(0UL, leg_geometries.size()))
@@ -314,7 +478,8 @@ class RouteAPI : public BaseAPI
                             return anno.datasource;
                         });
                 }
-                if (requested_annotations & RouteParameters::AnnotationsType::Nodes)
+                if ((requested_annotations & RouteParameters::AnnotationsType::Nodes) &&
+                    facade.HasOSMNodeIDs())
                 {
                     util::json::Array nodes;
                     nodes.values.reserve(leg_geometry.osm_node_ids.size());
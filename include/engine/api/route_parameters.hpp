@@ -149,7 +149,11 @@ struct RouteParameters : public BaseParameters
     {
         const auto coordinates_ok = coordinates.size() >= 2;
         const auto base_params_ok = BaseParameters::IsValid();
-        return coordinates_ok && base_params_ok;
+        // the binary format only contains the route summaries
+        const auto format_ok =
+            format == OutputFormatType::JSON ||
+            (!steps && !annotations && annotations_type == AnnotationsType::None);
+        return coordinates_ok && base_params_ok && format_ok;
     }
 };
 
@@ -2,6 +2,8 @@
 #define ENGINE_API_TABLE_HPP
 
 #include "engine/api/base_api.hpp"
+#include "engine/api/base_result.hpp"
+#include "engine/api/binary_factory.hpp"
 #include "engine/api/json_factory.hpp"
 #include "engine/api/table_parameters.hpp"
 
@@ -16,10 +18,15 @@
 #include "engine/internal_route_result.hpp"
 
 #include "util/integer_range.hpp"
+#include "util/request_trace.hpp"
 
 #include <boost/range/algorithm/transform.hpp>
 
+#include <cmath>
+#include <cstdint>
 #include <iterator>
+#include <limits>
+#include <string>
 
 namespace osrm
 {
@@ -36,7 +43,88 @@ class TableAPI final : public BaseAPI
     {
     }
 
+    // Renders the response in the format selected by the alternative the response holds.
+    // The tables that were not requested are empty, the binary format only has durations.
+    void MakeResponse(const std::vector<EdgeWeight> &durations,
+                      const std::vector<double> &distances,
+                      const std::vector<PhantomNode> &phantoms,
+                      ResultT &response) const
+    {
+        const util::TraceSpan span("response");
+        if (response.is<std::string>())
+        {
+            MakeResponse(durations, phantoms, response.get<std::string>());
+        }
+        else if (response.is<native::TableResult>())
+        {
+            MakeResponse(durations, distances, phantoms, response.get<native::TableResult>());
+        }
+        else
+        {
+            if (!response.is<util::json::Object>())
+                response = util::json::Object();
+            MakeResponse(durations, distances, phantoms, response.get<util::json::Object>());
+        }
+    }
+
     virtual void MakeResponse(const std::vector<EdgeWeight> &durations,
+                              const std::vector<double> &distances,
+                              const std::vector<PhantomNode> &phantoms,
+                              native::TableResult &response) const
+    {
+        response.sources = MakeNativeWaypoints(phantoms, parameters.sources);
+        response.destinations = MakeNativeWaypoints(phantoms, parameters.destinations);
+
+        response.durations.clear();
+        if (parameters.annotations & TableParameters::AnnotationsType::Duration)
+        {
+            response.durations.reserve(durations.size());
+            for (const auto duration : durations)
+            {
+                response.durations.push_back(duration == MAXIMAL_EDGE_DURATION
+                                                 ? std::numeric_limits<double>::infinity()
+                                                 : duration / 10.);
+            }
+        }
+
+        response.distances.clear();
+        if (parameters.annotations & TableParameters::AnnotationsType::Distance)
+        {
+            response.distances.reserve(distances.size());
+            for (const auto distance : distances)
+            {
+                response.distances.push_back(distance == std::numeric_limits<double>::max()
+                                                 ? std::numeric_limits<double>::infinity()
+                                                 : std::round(distance * 10.) / 10.);
+            }
+        }
+    }
+
+    virtual void MakeResponse(const std::vector<EdgeWeight> &durations,
+                              const std::vector<PhantomNode> &phantoms,
+                              std::string &response) const
+    {
+        const auto number_of_sources =
+            parameters.sources.empty() ? phantoms.size() : parameters.sources.size();
+        const auto number_of_destinations =
+            parameters.destinations.empty() ? phantoms.size() : parameters.destinations.size();
+
+        binary::Writer writer(response);
+        binary::writeHeader(writer, binary::ResponseType::Table);
+        WriteWaypoints(phantoms, parameters.sources, writer);
+        WriteWaypoints(phantoms, parameters.destinations, writer);
+
+        BOOST_ASSERT(durations.size() == number_of_sources * number_of_destinations);
+        writer.Reserve(durations.size() * sizeof(std::int32_t));
+        for (const auto duration : durations)
+        {
+            writer.WriteInt32(duration == MAXIMAL_EDGE_DURATION ? binary::INVALID_DURATION
+                                                                : duration);
+        }
+    }
+
+    virtual void MakeResponse(const std::vector<EdgeWeight> &durations,
+                              const std::vector<double> &distances,
                               const std::vector<PhantomNode> &phantoms,
                               util::json::Object &response) const
     {
@@ -64,8 +152,16 @@ class TableAPI final : public BaseAPI
             response.values["destinations"] = MakeWaypoints(phantoms, parameters.destinations);
         }
 
-        response.values["durations"] =
-            MakeTable(durations, number_of_sources, number_of_destinations);
+        if (parameters.annotations & TableParameters::AnnotationsType::Duration)
+        {
+            response.values["durations"] =
+                MakeTable(durations, number_of_sources, number_of_destinations);
+        }
+        if (parameters.annotations & TableParameters::AnnotationsType::Distance)
+        {
+            response.values["distances"] =
+                MakeDistanceTable(distances, number_of_sources, number_of_destinations);
+        }
         response.values["code"] = "Ok";
     }
 
@@ -97,6 +193,54 @@ class TableAPI final : public BaseAPI
         return json_waypoints;
     }
 
+    // Writes the waypoints of the indices or of all phantoms if there are no indices
+    virtual void WriteWaypoints(const std::vector<PhantomNode> &phantoms,
+                                const std::vector<std::size_t> &indices,
+                                binary::Writer &writer) const
+    {
+        if (indices.empty())
+        {
+            writer.WriteUInt32(static_cast<std::uint32_t>(phantoms.size()));
+            for (const auto &phantom : phantoms)
+            {
+                BaseAPI::WriteWaypoint(phantom, writer);
+            }
+            return;
+        }
+
+        writer.WriteUInt32(static_cast<std::uint32_t>(indices.size()));
+        for (const auto index : indices)
+        {
+            BOOST_ASSERT(index < phantoms.size());
+            BaseAPI::WriteWaypoint(phantoms[index], writer);
+        }
+    }
+
+    // Native counterpart of WriteWaypoints
+    virtual std::vector<native::Waypoint>
+    MakeNativeWaypoints(const std::vector<PhantomNode> &phantoms,
+                        const std::vector<std::size_t> &indices) const
+    {
+        std::vector<native::Waypoint> waypoints;
+        if (indices.empty())
+        {
+            waypoints.reserve(phantoms.size());
+            for (const auto &phantom : phantoms)
+            {
+                waypoints.push_back(BaseAPI::MakeNativeWaypoint(phantom));
+            }
+            return waypoints;
+        }
+
+        waypoints.reserve(indices.size());
+        for (const auto index : indices)
+        {
+            BOOST_ASSERT(index < phantoms.size());
+            waypoints.push_back(BaseAPI::MakeNativeWaypoint(phantoms[index]));
+        }
+        return waypoints;
+    }
+
     virtual util::json::Array MakeTable(const std::vector<EdgeWeight> &values,
                                         std::size_t number_of_rows,
                                         std::size_t number_of_columns) const
@@ -123,6 +267,34 @@ class TableAPI final : public BaseAPI
         return json_table;
     }
 
+    // Distances are rounded to decimeters, unreachable pairs are null
+    virtual util::json::Array MakeDistanceTable(const std::vector<double> &values,
+                                                std::size_t number_of_rows,
+                                                std::size_t number_of_columns) const
+    {
+        util::json::Array json_table;
+        for (const auto row : util::irange<std::size_t>(0UL, number_of_rows))
+        {
+            util::json::Array json_row;
+            auto row_begin_iterator = values.begin() + (row * number_of_columns);
+            auto row_end_iterator = values.begin() + ((row + 1) * number_of_columns);
+            json_row.values.resize(number_of_columns);
+            std::transform(row_begin_iterator,
+                           row_end_iterator,
+                           json_row.values.begin(),
+                           [](const double distance) {
+                               if (distance == std::numeric_limits<double>::max())
+                               {
+                                   return util::json::Value(util::json::Null());
+                               }
+                               return util::json::Value(
+                                   util::json::Number(std::round(distance * 10.) / 10.));
+                           });
+            json_table.values.push_back(std::move(json_row));
+        }
+        return json_table;
+    }
+
     const TableParameters &parameters;
 };
 
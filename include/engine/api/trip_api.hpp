@@ -9,6 +9,7 @@
 #include "engine/internal_route_result.hpp"
 
 #include "util/integer_range.hpp"
+#include "util/request_trace.hpp"
 
 namespace osrm
 {
@@ -30,6 +31,7 @@ class TripAPI final : public RouteAPI
                       const std::vector<PhantomNode> &phantoms,
                       util::json::Object &response) const
     {
+        const util::TraceSpan span("response");
         auto number_of_routes = sub_trips.size();
         util::json::Array routes;
         routes.values.reserve(number_of_routes);
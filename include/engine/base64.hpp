@@ -1,6 +1,9 @@
 #ifndef OSRM_BASE64_HPP
 #define OSRM_BASE64_HPP
 
+#include "util/exception.hpp"
+
+#include <algorithm>
 #include <iterator>
 #include <string>
 #include <type_traits>
@@ -9,12 +12,6 @@
 #include <climits>
 #include <cstddef>
 
-#include <boost/algorithm/string/trim.hpp>
-#include <boost/archive/iterators/base64_from_binary.hpp>
-#include <boost/archive/iterators/binary_from_base64.hpp>
-#include <boost/archive/iterators/transform_width.hpp>
-#include <boost/range/algorithm/copy.hpp>
-
 namespace osrm
 {
 
@@ -26,46 +23,34 @@ namespace detail
 // The C++ standard guarantees none of this by default, but we need it in the following.
 static_assert(CHAR_BIT == 8u, "we assume a byte holds 8 bits");
 static_assert(sizeof(char) == 1u, "we assume a char is one byte large");
-
-using Base64FromBinary = boost::archive::iterators::base64_from_binary<
-    boost::archive::iterators::transform_width<const char *, // sequence of chars
-                                               6,            // get view of 6 bit
-                                               8             // from sequence of 8 bit
-                                               >>;
-
-using BinaryFromBase64 = boost::archive::iterators::transform_width<
-    boost::archive::iterators::binary_from_base64<std::string::const_iterator>,
-    8, // get a view of 8 bit
-    6  // from a sequence of 6 bit
-    >;
 } // ns detail
 namespace engine
 {
 
-// Encoding Implementation
-
-// Encodes a chunk of memory to Base64.
-inline std::string encodeBase64(const unsigned char *first, std::size_t size)
+// The standard alphabet ends with '+' and '/', the URL and filename safe one of section 5 with
+// '-' and '_', e.g. for the hints that are passed as GET parameters.
+enum class Base64Alphabet
 {
-    std::vector<unsigned char> bytes{first, first + size};
-    BOOST_ASSERT(!bytes.empty());
-
-    std::size_t bytes_to_pad{0};
-
-    while (bytes.size() % 3 != 0)
-    {
-        bytes_to_pad += 1;
-        bytes.push_back(0);
-    }
+    Standard,
+    URL
+};
 
-    BOOST_ASSERT(bytes_to_pad == 0 || bytes_to_pad == 1 || bytes_to_pad == 2);
-    BOOST_ASSERT_MSG(0 == bytes.size() % 3, "base64 input data size is not a multiple of 3");
-
-    std::string encoded{detail::Base64FromBinary{bytes.data()},
-                        detail::Base64FromBinary{bytes.data() + (bytes.size() - bytes_to_pad)}};
+// Encoding Implementation
 
-    return encoded.append(bytes_to_pad, '=');
-}
+// Encodes a chunk of memory to Base64, padded with '=' to a multiple of four characters.
+// Vectorized for CPUs with SSSE3.
+std::string encodeBase64(const unsigned char *first,
+                         std::size_t size,
+                         const Base64Alphabet alphabet = Base64Alphabet::Standard);
+
+// Decodes the size characters at first into out, which holds at least size / 4 * 3 bytes.
+// Returns the number of decoded bytes without the padding, or -1 for a size that isn't a
+// multiple of four, characters that are not in the alphabet or misplaced padding.
+// Vectorized for CPUs with SSSE3.
+std::ptrdiff_t decodeBase64(const char *first,
+                            std::size_t size,
+                            unsigned char *out,
+                            const Base64Alphabet alphabet = Base64Alphabet::Standard);
 
 // C++11 standard 3.9.1/1: Plain char, signed char, and unsigned char are three distinct types
 
@@ -85,13 +70,15 @@ inline std::string encodeBase64(const char *first, std::size_t size)
 inline std::string encodeBase64(const std::string &x) { return encodeBase64(x.data(), x.size()); }
 
 // Encode any sufficiently trivial object to Base64.
-template <typename T> std::string encodeBase64Bytewise(const T &x)
+template <typename T>
+std::string encodeBase64Bytewise(const T &x,
+                                 const Base64Alphabet alphabet = Base64Alphabet::Standard)
 {
 #if !defined(__GNUC__) || (__GNUC__ > 4)
     static_assert(std::is_trivially_copyable<T>::value, "requires a trivially copyable type");
 #endif
 
-    return encodeBase64(reinterpret_cast<const unsigned char *>(&x), sizeof(T));
+    return encodeBase64(reinterpret_cast<const unsigned char *>(&x), sizeof(T), alphabet);
 }
 
 // Decoding Implementation
@@ -99,16 +86,12 @@ template <typename T> std::string encodeBase64Bytewise(const T &x)
 // Decodes into a chunk of memory that is at least as large as the input.
 template <typename OutputIter> void decodeBase64(const std::string &encoded, OutputIter out)
 {
-    auto unpadded = encoded;
-
-    const auto num_padded = std::count(begin(encoded), end(encoded), '=');
-    std::replace(begin(unpadded), end(unpadded), '=', 'A'); // A_64 == \0
+    std::vector<unsigned char> decoded(encoded.size() / 4 * 3);
+    const auto size = decodeBase64(encoded.data(), encoded.size(), decoded.data());
+    if (size < 0)
+        throw util::exception("Invalid base64 encoding");
 
-    std::string decoded{detail::BinaryFromBase64{begin(unpadded)},
-                        detail::BinaryFromBase64{begin(unpadded) + unpadded.length()}};
-
-    decoded.erase(end(decoded) - num_padded, end(decoded));
-    std::copy(begin(decoded), end(decoded), out);
+    std::copy(decoded.begin(), decoded.begin() + size, out);
 }
 
 // Convenience specialization, filling string instead of byte-dumping into it.
@@ -122,15 +105,21 @@ inline std::string decodeBase64(const std::string &encoded)
 }
 
 // Decodes from Base 64 to any sufficiently trivial object.
-template <typename T> T decodeBase64Bytewise(const std::string &encoded)
+template <typename T>
+T decodeBase64Bytewise(const std::string &encoded,
+                       const Base64Alphabet alphabet = Base64Alphabet::Standard)
 {
 #if !defined(__GNUC__) || (__GNUC__ > 4)
     static_assert(std::is_trivially_copyable<T>::value, "requires a trivially copyable type");
 #endif
 
-    T x;
+    std::vector<unsigned char> decoded(encoded.size() / 4 * 3);
+    const auto size = decodeBase64(encoded.data(), encoded.size(), decoded.data(), alphabet);
+    if (size != static_cast<std::ptrdiff_t>(sizeof(T)))
+        throw util::exception("Invalid base64 encoding");
 
-    decodeBase64(encoded, reinterpret_cast<unsigned char *>(&x));
+    T x;
+    std::copy(decoded.begin(), decoded.begin() + size, reinterpret_cast<unsigned char *>(&x));
 
     return x;
 }
@@ -0,0 +1,117 @@
+#ifndef OSRM_ENGINE_CANCELLATION_TOKEN_HPP
+#define OSRM_ENGINE_CANCELLATION_TOKEN_HPP
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+
+namespace osrm
+{
+namespace engine
+{
+
+/**
+ * Lets the caller abandon a running request, e.g. once its client disconnected or its deadline
+ * passed. The routing algorithms check the token of their request periodically and stop by
+ * throwing RequestCancelled, which the engine turns into Status::Timeout.
+ *
+ * Cancel() may be called from any thread while the request runs.
+ */
+class CancellationToken
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // never expires, only Cancel() stops the request
+    CancellationToken() : cancelled(false), deadline(Clock::time_point::max()) {}
+    explicit CancellationToken(const Clock::time_point deadline)
+        : cancelled(false), deadline(deadline)
+    {
+    }
+
+    void Cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+    bool IsCancelled() const
+    {
+        return cancelled.load(std::memory_order_relaxed) || Clock::now() >= deadline;
+    }
+
+  private:
+    std::atomic<bool> cancelled;
+    const Clock::time_point deadline;
+};
+
+class RequestCancelled final : public std::exception
+{
+  public:
+    const char *what() const noexcept override { return "Request was cancelled"; }
+};
+
+namespace detail
+{
+struct ThreadCancellation
+{
+    const CancellationToken *token = nullptr;
+    unsigned checks = 0;
+};
+
+// Like the query heaps of SearchEngineData the token of the running request is thread local,
+// the search loops deep down in the routing algorithms find it here.
+inline ThreadCancellation &threadCancellation()
+{
+    static thread_local ThreadCancellation cancellation;
+    return cancellation;
+}
+}
+
+// Makes token the token of the requests on this thread until the scope ends, nullptr disables
+// the checks. Scopes nest, e.g. for the workers of parallel table queries.
+class CancellationScope
+{
+  public:
+    explicit CancellationScope(const CancellationToken *token)
+        : previous(detail::threadCancellation().token)
+    {
+        detail::threadCancellation().token = token;
+    }
+    ~CancellationScope() { detail::threadCancellation().token = previous; }
+
+    CancellationScope(const CancellationScope &) = delete;
+    CancellationScope &operator=(const CancellationScope &) = delete;
+
+  private:
+    const CancellationToken *previous;
+};
+
+inline const CancellationToken *currentCancellationToken()
+{
+    return detail::threadCancellation().token;
+}
+
+// Throws RequestCancelled if the request of this thread was cancelled
+inline void throwIfCancelled()
+{
+    const auto token = detail::threadCancellation().token;
+    if (token != nullptr && token->IsCancelled())
+    {
+        throw RequestCancelled();
+    }
+}
+
+// Same as throwIfCancelled for the hot loops, e.g. once per settled node of the searches, the
+// clock is only read on every CHECK_INTERVAL-th call.
+inline void checkCancellation()
+{
+    static constexpr unsigned CHECK_INTERVAL = 1024;
+
+    auto &cancellation = detail::threadCancellation();
+    if (cancellation.token != nullptr && ++cancellation.checks % CHECK_INTERVAL == 0 &&
+        cancellation.token->IsCancelled())
+    {
+        throw RequestCancelled();
+    }
+}
+}
+}
+
+#endif // OSRM_ENGINE_CANCELLATION_TOKEN_HPP
@@ -4,18 +4,26 @@
 #include "engine/datafacade/contiguous_internalmem_datafacade.hpp"
 #include "engine/datafacade/shared_memory_allocator.hpp"
 #include "engine/datafacade_factory.hpp"
+#include "engine/dataset_version.hpp"
 
 #include "storage/shared_datatype.hpp"
 #include "storage/shared_memory.hpp"
 #include "storage/shared_monitor.hpp"
 
+#include "util/read_epochs.hpp"
+#include "util/std_hash.hpp"
+
 #include <boost/interprocess/sync/named_upgradable_mutex.hpp>
-#include <boost/thread/lock_types.hpp>
-#include <boost/thread/locks.hpp>
-#include <boost/thread/shared_mutex.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <iterator>
 #include <memory>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace osrm
 {
@@ -34,6 +42,27 @@ class DataWatchdogImpl<AlgorithmT, datafacade::ContiguousInternalMemoryDataFacad
 {
     using mutex_type = typename storage::SharedMonitor<storage::SharedRegionRegister>::mutex_type;
     using Facade = datafacade::ContiguousInternalMemoryDataFacade<AlgorithmT>;
+    using FacadeFactory =
+        DataFacadeFactory<datafacade::ContiguousInternalMemoryDataFacade, AlgorithmT>;
+
+    // An updatable region <dataset>/updatable/<name> of a named metric
+    struct MetricRegion
+    {
+        std::string name;
+        const storage::SharedRegion *shared_region;
+        storage::SharedRegion region;
+    };
+
+    // All metrics share the mapping of the static region, only their updatable data differs
+    struct Factories
+    {
+        FacadeFactory default_metric;
+        std::unordered_map<std::string, FacadeFactory> named_metrics;
+        // the named metrics of time slots in the order of their names
+        std::vector<const FacadeFactory *> time_slots;
+        // of all regions, requests with any metric are computed on this version
+        DatasetVersion version;
+    };
 
   public:
     DataWatchdogImpl(const std::string &dataset_name) : dataset_name(dataset_name), active(true)
@@ -43,18 +72,22 @@ class DataWatchdogImpl<AlgorithmT, datafacade::ContiguousInternalMemoryDataFacad
             boost::interprocess::scoped_lock<mutex_type> current_region_lock(barrier.get_mutex());
 
             auto &shared_register = barrier.data();
-            auto region_id = shared_register.Find(dataset_name + "/data");
-            if (region_id == storage::SharedRegionRegister::INVALID_REGION_ID)
+            auto static_region_id = shared_register.Find(dataset_name + "/static");
+            auto updatable_region_id = shared_register.Find(dataset_name + "/updatable");
+            if (static_region_id == storage::SharedRegionRegister::INVALID_REGION_ID)
             {
                 throw util::exception("Could not find shared memory region for \"" + dataset_name +
-                                      "/data\". Did you run osrm-datastore?");
+                                      "/static\". Did you run osrm-datastore?");
             }
-            shared_region = &shared_register.GetRegion(region_id);
-            region = *shared_region;
+            if (updatable_region_id == storage::SharedRegionRegister::INVALID_REGION_ID)
+            {
+                throw util::exception("Could not find shared memory region for \"" + dataset_name +
+                                      "/updatable\". Did you run osrm-datastore?");
+            }
+            static_shared_region = &shared_register.GetRegion(static_region_id);
+            updatable_shared_region = &shared_register.GetRegion(updatable_region_id);
 
-            facade_factory =
-                DataFacadeFactory<datafacade::ContiguousInternalMemoryDataFacade, AlgorithmT>(
-                    std::make_shared<datafacade::SharedMemoryAllocator>(region.shm_key));
+            UpdateFactories(shared_register);
         }
 
         watcher = std::thread(&DataWatchdogImpl::Run, this);
@@ -67,35 +100,161 @@ class DataWatchdogImpl<AlgorithmT, datafacade::ContiguousInternalMemoryDataFacad
         watcher.join();
     }
 
+    // Returns no facade if the requested metric is not loaded
     std::shared_ptr<const Facade> Get(const api::BaseParameters &params) const
     {
-        return facade_factory.Get(params);
+        // the facade keeps the regions mapped once it is copied out of the factories
+        util::ReadEpochs::ReadSection read_section;
+        const auto &current_factories = *factories.load();
+        if (params.metric.empty())
+        {
+            // departures outside of all time slots use the default metric
+            if (params.depart_at)
+            {
+                for (const auto time_slot : current_factories.time_slots)
+                {
+                    if (time_slot->GetTimeSlot()->Contains(*params.depart_at))
+                    {
+                        return time_slot->Get(params);
+                    }
+                }
+            }
+            return current_factories.default_metric.Get(params);
+        }
+
+        const auto iter = current_factories.named_metrics.find(params.metric);
+        if (iter == current_factories.named_metrics.end())
+        {
+            return {};
+        }
+        return iter->second.Get(params);
     }
     std::shared_ptr<const Facade> Get(const api::TileParameters &params) const
     {
-        return facade_factory.Get(params);
+        util::ReadEpochs::ReadSection read_section;
+        return factories.load()->default_metric.Get(params);
+    }
+
+    // Changes with the timestamp of any region of the dataset, the checksum is left unset
+    DatasetVersion GetVersion() const
+    {
+        util::ReadEpochs::ReadSection read_section;
+        return factories.load()->version;
     }
 
   private:
+
+    // The names of the named metric regions of the dataset in the register
+    std::vector<std::string>
+    ListMetricRegions(const storage::SharedRegionRegister &shared_register) const
+    {
+        const auto prefix = dataset_name + "/updatable/";
+        std::vector<std::string> names;
+        shared_register.List(std::back_inserter(names));
+        names.erase(std::remove_if(names.begin(),
+                                   names.end(),
+                                   [&](const std::string &name) {
+                                       return name.compare(0, prefix.size(), prefix) != 0;
+                                   }),
+                    names.end());
+        return names;
+    }
+
+    bool RegionsChanged(const storage::SharedRegionRegister &shared_register) const
+    {
+        return static_region.timestamp != static_shared_region->timestamp ||
+               updatable_region.timestamp != updatable_shared_region->timestamp ||
+               std::any_of(metric_regions.begin(),
+                           metric_regions.end(),
+                           [](const MetricRegion &metric) {
+                               return metric.region.timestamp != metric.shared_region->timestamp;
+                           }) ||
+               metric_regions.size() != ListMetricRegions(shared_register).size();
+    }
+
+    FacadeFactory MakeFactory(const storage::SharedRegion &metric_region) const
+    {
+        return FacadeFactory(std::make_shared<datafacade::SharedMemoryAllocator>(
+            std::vector<storage::SharedRegionRegister::ShmKey>{static_region.shm_key,
+                                                               metric_region.shm_key}));
+    }
+
+    // Needs to be called with the lock of the register
+    void UpdateFactories(const storage::SharedRegionRegister &shared_register)
+    {
+        static_region = *static_shared_region;
+        updatable_region = *updatable_shared_region;
+
+        const auto prefix_size = (dataset_name + "/updatable/").size();
+        metric_regions.clear();
+        for (const auto &name : ListMetricRegions(shared_register))
+        {
+            const auto &shared_region = shared_register.GetRegion(shared_register.Find(name));
+            metric_regions.push_back({name.substr(prefix_size), &shared_region, shared_region});
+        }
+
+        auto new_factories = std::make_unique<Factories>();
+        new_factories->default_metric = MakeFactory(updatable_region);
+        for (const auto &metric : metric_regions)
+        {
+            new_factories->named_metrics.emplace(metric.name, MakeFactory(metric.region));
+        }
+        std::vector<std::string> metric_names;
+        for (const auto &metric : new_factories->named_metrics)
+        {
+            if (metric.second.GetTimeSlot())
+            {
+                metric_names.push_back(metric.first);
+            }
+        }
+        std::sort(metric_names.begin(), metric_names.end());
+        for (const auto &name : metric_names)
+        {
+            new_factories->time_slots.push_back(&new_factories->named_metrics.at(name));
+        }
+
+        // the register lists the regions in the same order for all processes
+        std::size_t generation = hash_val(static_region.shm_key,
+                                          static_region.timestamp,
+                                          updatable_region.shm_key,
+                                          updatable_region.timestamp);
+        for (const auto &metric : metric_regions)
+        {
+            hash_val(generation, metric.name, metric.region.shm_key, metric.region.timestamp);
+        }
+        new_factories->version.generation = generation;
+        new_factories->version.loaded_at = std::time(nullptr);
+
+        // request threads that still read the old factories copy their facade out of it first
+        factories.store(new_factories.get());
+        util::ReadEpochs::Synchronize();
+        current_factories = std::move(new_factories);
+    }
+
     void Run()
     {
         while (active)
         {
             boost::interprocess::scoped_lock<mutex_type> current_region_lock(barrier.get_mutex());
 
-            while (active && region.timestamp == shared_region->timestamp)
+            auto &shared_register = barrier.data();
+            while (active && !RegionsChanged(shared_register))
             {
                 barrier.wait(current_region_lock);
             }
 
-            if (region.timestamp != shared_region->timestamp)
+            if (RegionsChanged(shared_register))
             {
-                region = *shared_region;
-                facade_factory =
-                    DataFacadeFactory<datafacade::ContiguousInternalMemoryDataFacade, AlgorithmT>(
-                        std::make_shared<datafacade::SharedMemoryAllocator>(region.shm_key));
-                util::Log() << "updated facade to region " << (int)region.shm_key
-                            << " with timestamp " << region.timestamp;
+                UpdateFactories(shared_register);
+                util::Log() << "updated facade to regions " << (int)static_region.shm_key
+                            << " and " << (int)updatable_region.shm_key << " with timestamps "
+                            << static_region.timestamp << " and " << updatable_region.timestamp;
+                for (const auto &metric : metric_regions)
+                {
+                    util::Log() << "updated facade of metric " << metric.name << " to region "
+                                << (int)metric.region.shm_key << " with timestamp "
+                                << metric.region.timestamp;
+                }
             }
         }
 
@@ -106,15 +265,23 @@ class DataWatchdogImpl<AlgorithmT, datafacade::ContiguousInternalMemoryDataFacad
     storage::SharedMonitor<storage::SharedRegionRegister> barrier;
     std::thread watcher;
     bool active;
-    storage::SharedRegion region;
-    storage::SharedRegion *shared_region;
-    DataFacadeFactory<datafacade::ContiguousInternalMemoryDataFacade, AlgorithmT> facade_factory;
+    storage::SharedRegion static_region;
+    storage::SharedRegion updatable_region;
+    storage::SharedRegion *static_shared_region;
+    storage::SharedRegion *updatable_shared_region;
+    std::vector<MetricRegion> metric_regions;
+
+    // swapped by the watchdog thread while the request threads read it without locks
+    std::atomic<const Factories *> factories{nullptr};
+    std::unique_ptr<const Factories> current_factories;
 };
 }
 
 // This class monitors the shared memory region that contains the pointers to
-// the data and layout regions that should be used. This region is updated
-// once a new dataset arrives.
+// the data and layout regions that should be used. The static and the updatable
+// region are updated once a new dataset or a new metric arrives. Named metrics are
+// additional updatable regions that share the static region of the dataset, requests with a
+// departure time use the named metric of the time slot the departure falls into.
 template <typename AlgorithmT, template <typename A> class FacadeT>
 using DataWatchdog = detail::DataWatchdogImpl<AlgorithmT, FacadeT<AlgorithmT>>;
 }
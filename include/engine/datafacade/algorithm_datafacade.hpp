@@ -6,6 +6,7 @@
 #include "engine/algorithm.hpp"
 
 #include "partitioner/cell_storage.hpp"
+#include "partitioner/compact_edge_based_graph.hpp"
 #include "partitioner/multi_level_partition.hpp"
 
 #include "util/filtered_graph.hpp"
@@ -39,10 +40,14 @@ template <> class AlgorithmDataFacade<CH>
 
     virtual NodeID GetTarget(const EdgeID e) const = 0;
 
-    virtual const EdgeData &GetEdgeData(const EdgeID e) const = 0;
+    // by value, the query graph stores the edge data in two parts
+    virtual EdgeData GetEdgeData(const EdgeID e) const = 0;
 
     virtual EdgeRange GetAdjacentEdgeRange(const NodeID node) const = 0;
 
+    // Requests the edge range of node from memory, a no-op without OSRM_ENABLE_SEARCH_PREFETCH
+    virtual void PrefetchAdjacentEdgeRange(const NodeID node) const = 0;
+
     // searches for a specific edge
     virtual EdgeID FindEdge(const NodeID from, const NodeID to) const = 0;
 
@@ -71,7 +76,11 @@ template <> class AlgorithmDataFacade<MLD>
 
     virtual NodeID GetTarget(const EdgeID e) const = 0;
 
-    virtual const EdgeData &GetEdgeData(const EdgeID e) const = 0;
+    // by value, the graph stores the edge data in two parts
+    virtual EdgeData GetEdgeData(const EdgeID e) const = 0;
+
+    // the target, weight and directions of an edge, all that a search relaxes
+    virtual const partitioner::CompactEdgeBasedEdge &GetCompactEdge(const EdgeID e) const = 0;
 
     virtual EdgeRange GetAdjacentEdgeRange(const NodeID node) const = 0;
 
@@ -83,6 +92,9 @@ template <> class AlgorithmDataFacade<MLD>
 
     virtual EdgeRange GetBorderEdgeRange(const LevelID level, const NodeID node) const = 0;
 
+    // Requests the edge ranges of node from memory, a no-op without OSRM_ENABLE_SEARCH_PREFETCH
+    virtual void PrefetchAdjacentEdgeRange(const NodeID node) const = 0;
+
     // searches for a specific edge
     virtual EdgeID FindEdge(const NodeID from, const NodeID to) const = 0;
 };
@@ -1,7 +1,10 @@
 #ifndef OSRM_ENGINE_DATAFACADE_CONTIGUOUS_BLOCK_ALLOCATOR_HPP_
 #define OSRM_ENGINE_DATAFACADE_CONTIGUOUS_BLOCK_ALLOCATOR_HPP_
 
-#include "storage/shared_datatype.hpp"
+#include "storage/shared_data_index.hpp"
+
+#include <atomic>
+#include <cstdint>
 
 namespace osrm
 {
@@ -16,8 +19,20 @@ class ContiguousBlockAllocator
     virtual ~ContiguousBlockAllocator() = default;
 
     // interface to give access to the datafacades
-    virtual const storage::DataLayout &GetLayout() = 0;
-    virtual char *GetMemory() = 0;
+    virtual const storage::SharedDataIndex &GetIndex() = 0;
+
+    // Unique for every allocator of the process and increasing with every dataset loaded, allows
+    // caches to drop the results of a replaced dataset.
+    std::uint64_t GetDatasetID() const { return dataset_id; }
+
+  private:
+    static std::uint64_t NextDatasetID()
+    {
+        static std::atomic<std::uint64_t> next_dataset_id{0};
+        return ++next_dataset_id;
+    }
+
+    const std::uint64_t dataset_id = NextDatasetID();
 };
 
 } // namespace datafacade
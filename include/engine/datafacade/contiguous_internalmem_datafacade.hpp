@@ -13,6 +13,7 @@
 #include "storage/shared_memory_ownership.hpp"
 #include "storage/view_factory.hpp"
 
+#include "util/dictionary_vector.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/log.hpp"
@@ -20,7 +21,9 @@
 #include <boost/assert.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <limits>
 #include <memory>
@@ -41,7 +44,7 @@ template <>
 class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::AlgorithmDataFacade<CH>
 {
   private:
-    using QueryGraph = util::FilteredGraphView<contractor::QueryGraphView>;
+    using QueryGraph = util::FilteredGraphView<contractor::CompactQueryGraphView>;
     using GraphNode = QueryGraph::NodeArrayEntry;
     using GraphEdge = QueryGraph::EdgeArrayEntry;
 
@@ -57,17 +60,15 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::Algor
         std::size_t exclude_index)
         : allocator(std::move(allocator_))
     {
-        InitializeInternalPointers(
-            allocator->GetLayout(), allocator->GetMemory(), metric_name, exclude_index);
+        InitializeInternalPointers(allocator->GetIndex(), metric_name, exclude_index);
     }
 
-    void InitializeInternalPointers(const storage::DataLayout &data_layout,
-                                    char *memory_block,
+    void InitializeInternalPointers(const storage::SharedDataIndex &index,
                                     const std::string &metric_name,
                                     const std::size_t exclude_index)
     {
-        m_query_graph = make_filtered_graph_view(
-            memory_block, data_layout, "/ch/metrics/" + metric_name, exclude_index);
+        m_query_graph =
+            make_filtered_graph_view(index, "/ch/metrics/" + metric_name, exclude_index);
     }
 
     // search graph access
@@ -82,7 +83,7 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::Algor
 
     NodeID GetTarget(const EdgeID e) const override final { return m_query_graph.GetTarget(e); }
 
-    const EdgeData &GetEdgeData(const EdgeID e) const override final
+    EdgeData GetEdgeData(const EdgeID e) const override final
     {
         return m_query_graph.GetEdgeData(e);
     }
@@ -92,6 +93,11 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::Algor
         return m_query_graph.GetAdjacentEdgeRange(node);
     }
 
+    void PrefetchAdjacentEdgeRange(const NodeID node) const override final
+    {
+        m_query_graph.PrefetchAdjacentEdgeRange(node);
+    }
+
     // searches for a specific edge
     EdgeID FindEdge(const NodeID from, const NodeID to) const override final
     {
@@ -140,13 +146,16 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
     extractor::Datasources *m_datasources;
 
     std::uint32_t m_check_sum;
+    const std::uint64_t m_facade_id = NextFacadeID();
     util::vector_view<util::Coordinate> m_coordinate_list;
     extractor::PackedOSMIDsView m_osmnodeid_list;
+    bool has_osm_node_ids = false;
     util::vector_view<std::uint32_t> m_lane_description_offsets;
     util::vector_view<extractor::TurnLaneType::Mask> m_lane_description_masks;
-    util::vector_view<TurnPenalty> m_turn_weight_penalties;
-    util::vector_view<TurnPenalty> m_turn_duration_penalties;
+    util::DictionaryVectorView<TurnPenalty> m_turn_weight_penalties;
+    util::DictionaryVectorView<TurnPenalty> m_turn_duration_penalties;
     extractor::SegmentDataView segment_data;
+    extractor::GeometryCoordinatesView geometry_coordinates;
     extractor::EdgeBasedNodeDataView edge_based_node_data;
     guidance::TurnDataView turn_data;
 
@@ -172,8 +181,13 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
     // allocator that keeps the allocation data
     std::shared_ptr<ContiguousBlockAllocator> allocator;
 
-    void InitializeInternalPointers(const storage::DataLayout &layout,
-                                    char *memory_ptr,
+    static std::uint64_t NextFacadeID()
+    {
+        static std::atomic<std::uint64_t> next_facade_id{0};
+        return ++next_facade_id;
+    }
+
+    void InitializeInternalPointers(const storage::SharedDataIndex &index,
                                     const std::string &metric_name,
                                     const std::size_t exclude_index)
     {
@@ -181,46 +195,71 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
         (void)metric_name;
 
         m_profile_properties =
-            layout.GetBlockPtr<extractor::ProfileProperties>(memory_ptr, "/common/properties");
+            index.GetBlockPtr<extractor::ProfileProperties>("/common/properties");
 
         exclude_mask = m_profile_properties->excludable_classes[exclude_index];
 
-        m_check_sum =
-            *layout.GetBlockPtr<std::uint32_t>(memory_ptr, "/common/connectivity_checksum");
+        m_check_sum = *index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
 
-        std::tie(m_coordinate_list, m_osmnodeid_list) =
-            make_nbn_data_view(memory_ptr, layout, "/common/nbn_data");
+        // the OSM node ids are not loaded for datasets that do not serve them
+        m_coordinate_list = make_coordinates_view(index, "/common/nbn_data/coordinates");
+        has_osm_node_ids = index.HasBlock("/common/nbn_data/osm_node_ids/packed");
+        if (has_osm_node_ids)
+        {
+            m_osmnodeid_list = make_osm_ids_view(index, "/common/nbn_data/osm_node_ids");
+        }
 
-        m_static_rtree = make_search_tree_view(memory_ptr, layout, "/common/rtree");
+        m_static_rtree = make_search_tree_view(index, "/common/rtree");
         m_geospatial_query.reset(
             new SharedGeospatialQuery(m_static_rtree, m_coordinate_list, *this));
 
-        edge_based_node_data = make_ebn_data_view(memory_ptr, layout, "/common/ebg_node_data");
+        edge_based_node_data = make_ebn_data_view(index, "/common/ebg_node_data");
 
-        turn_data = make_turn_data_view(memory_ptr, layout, "/common/turn_data");
+        turn_data = make_turn_data_view(index, "/common/turn_data");
 
-        m_name_table = make_name_table_view(memory_ptr, layout, "/common/names");
+        m_name_table = make_name_table_view(index, "/common/names");
 
         std::tie(m_lane_description_offsets, m_lane_description_masks) =
-            make_turn_lane_description_views(memory_ptr, layout, "/common/turn_lanes");
-        m_lane_tupel_id_pairs = make_lane_data_view(memory_ptr, layout, "/common/turn_lanes");
+            make_turn_lane_description_views(index, "/common/turn_lanes");
+        m_lane_tupel_id_pairs = make_lane_data_view(index, "/common/turn_lanes");
 
-        m_turn_weight_penalties = make_turn_weight_view(memory_ptr, layout, "/common/turn_penalty");
-        m_turn_duration_penalties =
-            make_turn_duration_view(memory_ptr, layout, "/common/turn_penalty");
+        m_turn_weight_penalties = make_turn_weight_view(index, "/common/turn_penalty");
+        m_turn_duration_penalties = make_turn_duration_view(index, "/common/turn_penalty");
 
-        segment_data = make_segment_data_view(memory_ptr, layout, "/common/segment_data");
+        segment_data = make_segment_data_view(index, "/common/segment_data");
+        geometry_coordinates =
+            make_geometry_coordinates_view(index, "/common/geometry_coordinates");
 
-        m_datasources =
-            layout.GetBlockPtr<extractor::Datasources>(memory_ptr, "/common/data_sources_names");
+        m_datasources = index.GetBlockPtr<extractor::Datasources>("/common/data_sources_names");
 
         intersection_bearings_view =
-            make_intersection_bearings_view(memory_ptr, layout, "/common/intersection_bearings");
+            make_intersection_bearings_view(index, "/common/intersection_bearings");
 
-        m_entry_class_table = make_entry_classes_view(memory_ptr, layout, "/common/entry_classes");
+        m_entry_class_table = make_entry_classes_view(index, "/common/entry_classes");
 
         std::tie(m_maneuver_overrides, m_maneuver_override_node_sequences) =
-            make_maneuver_overrides_views(memory_ptr, layout, "/common/maneuver_overrides");
+            make_maneuver_overrides_views(index, "/common/maneuver_overrides");
+    }
+
+    // Decodes the coordinates of the nodes of a geometry in forward order
+    template <typename OutputIter>
+    void UnpackGeometryCoordinates(const EdgeID id, OutputIter out) const
+    {
+        if (geometry_coordinates.empty())
+        {
+            std::vector<NodeID> nodes;
+            segment_data.UnpackForwardGeometry(id, nodes);
+            std::transform(nodes.begin(), nodes.end(), out, [this](const NodeID node) {
+                return m_coordinate_list[node];
+            });
+            return;
+        }
+
+        const auto positions = segment_data.GetGeometryPositions(id);
+        geometry_coordinates.Unpack(
+            id, positions.first, positions.second, out, [&](const std::size_t offset) {
+                return m_coordinate_list[segment_data.GetForwardGeometry(id)[offset]];
+            });
     }
 
   public:
@@ -231,10 +270,12 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
                                            const std::size_t exclude_index)
         : allocator(std::move(allocator_))
     {
-        InitializeInternalPointers(
-            allocator->GetLayout(), allocator->GetMemory(), metric_name, exclude_index);
+        InitializeInternalPointers(allocator->GetIndex(), metric_name, exclude_index);
     }
 
+    // the blocks of all data of the facade, e.g. to report their memory
+    const storage::SharedDataIndex &GetIndex() const { return allocator->GetIndex(); }
+
     // node and edge information access
     util::Coordinate GetCoordinateOfNode(const NodeID id) const override final
     {
@@ -243,48 +284,73 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
 
     OSMNodeID GetOSMNodeIDOfNode(const NodeID id) const override final
     {
-        return m_osmnodeid_list[id];
+        return has_osm_node_ids ? m_osmnodeid_list[id] : SPECIAL_OSM_NODEID;
     }
 
+    bool HasOSMNodeIDs() const override final { return has_osm_node_ids; }
+
     std::vector<NodeID> GetUncompressedForwardGeometry(const EdgeID id) const override final
     {
-
-        auto range = segment_data.GetForwardGeometry(id);
-        return std::vector<NodeID>{range.begin(), range.end()};
+        std::vector<NodeID> values;
+        segment_data.UnpackForwardGeometry(id, values);
+        return values;
     }
 
     virtual std::vector<NodeID> GetUncompressedReverseGeometry(const EdgeID id) const override final
     {
-        auto range = segment_data.GetReverseGeometry(id);
-        return std::vector<NodeID>{range.begin(), range.end()};
+        std::vector<NodeID> values;
+        segment_data.UnpackReverseGeometry(id, values);
+        return values;
+    }
+
+    std::vector<util::Coordinate>
+    GetUncompressedForwardCoordinates(const EdgeID id) const override final
+    {
+        const auto positions = segment_data.GetGeometryPositions(id);
+        std::vector<util::Coordinate> coordinates(positions.second - positions.first);
+        UnpackGeometryCoordinates(id, coordinates.begin());
+        return coordinates;
+    }
+
+    std::vector<util::Coordinate>
+    GetUncompressedReverseCoordinates(const EdgeID id) const override final
+    {
+        const auto positions = segment_data.GetGeometryPositions(id);
+        std::vector<util::Coordinate> coordinates(positions.second - positions.first);
+        UnpackGeometryCoordinates(id, coordinates.rbegin());
+        return coordinates;
     }
 
     virtual std::vector<EdgeWeight>
     GetUncompressedForwardDurations(const EdgeID id) const override final
     {
-        auto range = segment_data.GetForwardDurations(id);
-        return std::vector<EdgeWeight>{range.begin(), range.end()};
+        std::vector<EdgeWeight> values;
+        segment_data.UnpackForwardDurations(id, values);
+        return values;
     }
 
     virtual std::vector<EdgeWeight>
     GetUncompressedReverseDurations(const EdgeID id) const override final
     {
-        auto range = segment_data.GetReverseDurations(id);
-        return std::vector<EdgeWeight>{range.begin(), range.end()};
+        std::vector<EdgeWeight> values;
+        segment_data.UnpackReverseDurations(id, values);
+        return values;
     }
 
     virtual std::vector<EdgeWeight>
     GetUncompressedForwardWeights(const EdgeID id) const override final
     {
-        auto range = segment_data.GetForwardWeights(id);
-        return std::vector<EdgeWeight>{range.begin(), range.end()};
+        std::vector<EdgeWeight> values;
+        segment_data.UnpackForwardWeights(id, values);
+        return values;
     }
 
     virtual std::vector<EdgeWeight>
     GetUncompressedReverseWeights(const EdgeID id) const override final
     {
-        auto range = segment_data.GetReverseWeights(id);
-        return std::vector<EdgeWeight>{range.begin(), range.end()};
+        std::vector<EdgeWeight> values;
+        segment_data.UnpackReverseWeights(id, values);
+        return values;
     }
 
     // Returns the data source ids that were used to supply the edge
@@ -453,6 +519,13 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
 
     std::uint32_t GetCheckSum() const override final { return m_check_sum; }
 
+    // Unique for every facade of the process, unlike the checksum it changes with updated
+    // weights or other excluded classes. Keys of results cached across requests.
+    std::uint64_t GetFacadeID() const { return m_facade_id; }
+
+    // Shared by all facades of the same dataset, see ContiguousBlockAllocator::GetDatasetID
+    std::uint64_t GetDatasetID() const { return allocator->GetDatasetID(); }
+
     GeometryID GetGeometryIndex(const NodeID id) const override final
     {
         return edge_based_node_data.GetGeometryID(id);
@@ -634,7 +707,7 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
 template <typename AlgorithmT> class ContiguousInternalMemoryDataFacade;
 
 template <>
-class ContiguousInternalMemoryDataFacade<CH>
+class ContiguousInternalMemoryDataFacade<CH> final
     : public ContiguousInternalMemoryDataFacadeBase,
       public ContiguousInternalMemoryAlgorithmDataFacade<CH>
 {
@@ -661,16 +734,15 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
 
     QueryGraph query_graph;
 
-    void InitializeInternalPointers(const storage::DataLayout &layout,
-                                    char *memory_ptr,
+    void InitializeInternalPointers(const storage::SharedDataIndex &index,
                                     const std::string &metric_name,
                                     const std::size_t exclude_index)
     {
-        mld_partition = make_partition_view(memory_ptr, layout, "/mld/multilevelpartition");
-        mld_cell_metric = make_filtered_cell_metric_view(
-            memory_ptr, layout, "/mld/metrics/" + metric_name, exclude_index);
-        mld_cell_storage = make_cell_storage_view(memory_ptr, layout, "/mld/cellstorage");
-        query_graph = make_multi_level_graph_view(memory_ptr, layout, "/mld/multilevelgraph");
+        mld_partition = make_partition_view(index, "/mld/multilevelpartition");
+        mld_cell_metric =
+            make_filtered_cell_metric_view(index, "/mld/metrics/" + metric_name, exclude_index);
+        mld_cell_storage = make_cell_storage_view(index, "/mld/cellstorage");
+        query_graph = make_multi_level_graph_view(index, "/mld/multilevelgraph");
     }
 
     // allocator that keeps the allocation data
@@ -683,18 +755,24 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
         const std::size_t exclude_index)
         : allocator(std::move(allocator_))
     {
-        InitializeInternalPointers(
-            allocator->GetLayout(), allocator->GetMemory(), metric_name, exclude_index);
+        InitializeInternalPointers(allocator->GetIndex(), metric_name, exclude_index);
     }
 
-    const partitioner::MultiLevelPartitionView &GetMultiLevelPartition() const override
+    // the routing algorithms take the final facade, these calls in the search loops are direct
+    const partitioner::MultiLevelPartitionView &GetMultiLevelPartition() const override final
     {
         return mld_partition;
     }
 
-    const partitioner::CellStorageView &GetCellStorage() const override { return mld_cell_storage; }
+    const partitioner::CellStorageView &GetCellStorage() const override final
+    {
+        return mld_cell_storage;
+    }
 
-    const customizer::CellMetricView &GetCellMetric() const override { return mld_cell_metric; }
+    const customizer::CellMetricView &GetCellMetric() const override final
+    {
+        return mld_cell_metric;
+    }
 
     // search graph access
     unsigned GetNumberOfNodes() const override final { return query_graph.GetNumberOfNodes(); }
@@ -708,11 +786,16 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
 
     NodeID GetTarget(const EdgeID e) const override final { return query_graph.GetTarget(e); }
 
-    const EdgeData &GetEdgeData(const EdgeID e) const override final
+    EdgeData GetEdgeData(const EdgeID e) const override final
     {
         return query_graph.GetEdgeData(e);
     }
 
+    const partitioner::CompactEdgeBasedEdge &GetCompactEdge(const EdgeID e) const override final
+    {
+        return query_graph.GetCompactEdge(e);
+    }
+
     EdgeRange GetAdjacentEdgeRange(const NodeID node) const override final
     {
         return query_graph.GetAdjacentEdgeRange(node);
@@ -723,6 +806,11 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
         return query_graph.GetBorderEdgeRange(level, node);
     }
 
+    void PrefetchAdjacentEdgeRange(const NodeID node) const override final
+    {
+        query_graph.PrefetchAdjacentEdgeRange(node);
+    }
+
     // searches for a specific edge
     EdgeID FindEdge(const NodeID from, const NodeID to) const override final
     {
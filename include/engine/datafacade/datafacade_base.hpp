@@ -60,6 +60,9 @@ class BaseDataFacade
 
     virtual OSMNodeID GetOSMNodeIDOfNode(const NodeID id) const = 0;
 
+    // False if the dataset was loaded without OSM node ids, GetOSMNodeIDOfNode is invalid then
+    virtual bool HasOSMNodeIDs() const = 0;
+
     virtual GeometryID GetGeometryIndex(const NodeID id) const = 0;
 
     virtual ComponentID GetComponentID(const NodeID id) const = 0;
@@ -68,6 +71,14 @@ class BaseDataFacade
 
     virtual std::vector<NodeID> GetUncompressedReverseGeometry(const EdgeID id) const = 0;
 
+    // The coordinates of the nodes of GetUncompressedForwardGeometry and
+    // GetUncompressedReverseGeometry, decoded in bulk if the dataset has compact coordinates
+    virtual std::vector<util::Coordinate>
+    GetUncompressedForwardCoordinates(const EdgeID id) const = 0;
+
+    virtual std::vector<util::Coordinate>
+    GetUncompressedReverseCoordinates(const EdgeID id) const = 0;
+
     virtual TurnPenalty GetWeightPenaltyForEdgeID(const unsigned id) const = 0;
 
     virtual TurnPenalty GetDurationPenaltyForEdgeID(const unsigned id) const = 0;
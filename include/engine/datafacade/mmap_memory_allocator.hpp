@@ -3,12 +3,9 @@
 
 #include "engine/datafacade/contiguous_block_allocator.hpp"
 
+#include "storage/image.hpp"
 #include "storage/storage_config.hpp"
 
-#include "util/vector_view.hpp"
-
-#include <boost/iostreams/device/mapped_file.hpp>
-
 #include <memory>
 
 namespace osrm
@@ -19,23 +16,25 @@ namespace datafacade
 {
 
 /**
- * This allocator uses file backed mmap memory block as the data location.
+ * This allocator maps a dataset image as the data location. A missing image is written from the
+ * .osrm files first, an existing one is mapped as it is, also when the files changed since.
  */
 class MMapMemoryAllocator : public ContiguousBlockAllocator
 {
   public:
     explicit MMapMemoryAllocator(const storage::StorageConfig &config,
                                  const boost::filesystem::path &memory_file);
+    // Only maps the image, throws if there is none
+    MMapMemoryAllocator(const boost::filesystem::path &memory_file, bool populate);
     ~MMapMemoryAllocator() override final;
 
     // interface to give access to the datafacades
-    storage::DataLayout &GetLayout() override final;
-    char *GetMemory() override final;
+    const storage::SharedDataIndex &GetIndex() override final;
+
+    const storage::ImageFileId &GetFileId() const { return image->GetFileId(); }
 
   private:
-    storage::DataLayout *data_layout;
-    util::vector_view<char> mapped_memory;
-    boost::iostreams::mapped_file mapped_memory_file;
+    std::unique_ptr<storage::MappedImage> image;
 };
 
 } // namespace datafacade
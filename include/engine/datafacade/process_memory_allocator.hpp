@@ -1,9 +1,13 @@
 #ifndef OSRM_ENGINE_DATAFACADE_PROCESS_MEMORY_ALLOCATOR_HPP_
 #define OSRM_ENGINE_DATAFACADE_PROCESS_MEMORY_ALLOCATOR_HPP_
 
+#include "storage/huge_pages.hpp"
+#include "storage/mapped_dataset.hpp"
 #include "storage/storage_config.hpp"
 #include "engine/datafacade/contiguous_block_allocator.hpp"
 
+#include <boost/optional.hpp>
+
 #include <memory>
 
 namespace osrm
@@ -18,21 +22,24 @@ namespace datafacade
  * data into.  The structure and layout is the same as when using
  * shared memory.
  * This class holds a unique_ptr to the memory block, so it
- * is auto-freed upon destruction.
+ * is auto-freed upon destruction. The block can be backed by huge pages.
+ * With lazy loading the blocks are mapped from the files instead, see storage::MappedDataset.
  */
 class ProcessMemoryAllocator : public ContiguousBlockAllocator
 {
   public:
-    explicit ProcessMemoryAllocator(const storage::StorageConfig &config);
+    // With a NUMA node the memory block is placed on that node
+    explicit ProcessMemoryAllocator(const storage::StorageConfig &config,
+                                    boost::optional<std::size_t> numa_node = boost::none);
     ~ProcessMemoryAllocator() override final;
 
     // interface to give access to the datafacades
-    const storage::DataLayout &GetLayout() override final;
-    char *GetMemory() override final;
+    const storage::SharedDataIndex &GetIndex() override final;
 
   private:
-    storage::DataLayout internal_layout;
-    std::unique_ptr<char[]> internal_memory;
+    storage::SharedDataIndex index;
+    std::unique_ptr<storage::ProcessMemory> internal_memory;
+    std::unique_ptr<storage::MappedDataset> mapped_dataset;
 };
 
 } // namespace datafacade
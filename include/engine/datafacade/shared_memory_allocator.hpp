@@ -7,6 +7,7 @@
 #include "storage/shared_memory.hpp"
 
 #include <memory>
+#include <vector>
 
 namespace osrm
 {
@@ -16,24 +17,23 @@ namespace datafacade
 {
 
 /**
- * This allocator uses an IPC shared memory block as the data location.
+ * This allocator uses IPC shared memory blocks as the data location.
  * Many SharedMemoryDataFacade objects can be created that point to the same shared
- * memory block.
+ * memory blocks.
  */
 class SharedMemoryAllocator : public ContiguousBlockAllocator
 {
   public:
-    explicit SharedMemoryAllocator(storage::SharedRegionRegister::ShmKey data_shm_key);
+    explicit SharedMemoryAllocator(
+        const std::vector<storage::SharedRegionRegister::ShmKey> &shm_keys);
     ~SharedMemoryAllocator() override final;
 
     // interface to give access to the datafacades
-    const storage::DataLayout &GetLayout() override final;
-    char *GetMemory() override final;
+    const storage::SharedDataIndex &GetIndex() override final;
 
   private:
-    std::size_t layout_size;
-    storage::DataLayout data_layout;
-    std::unique_ptr<storage::SharedMemory> m_large_memory;
+    storage::SharedDataIndex index;
+    std::vector<std::unique_ptr<storage::SharedMemory>> memory_regions;
 };
 
 } // namespace datafacade
@@ -1,6 +1,8 @@
 #ifndef OSRM_ENGINE_DATAFACADE_FACTORY_HPP
 #define OSRM_ENGINE_DATAFACADE_FACTORY_HPP
 
+#include "customizer/time_slot.hpp"
+
 #include "extractor/class_data.hpp"
 #include "extractor/profile_properties.hpp"
 
@@ -41,20 +43,26 @@ template <template <typename A> class FacadeT, typename AlgorithmT> class DataFa
         return Get(params, has_exclude_flags);
     }
 
+    // The departure times of the data if it is the metric of a time slot
+    const customizer::TimeSlot *GetTimeSlot() const { return time_slot; }
+
   private:
     // Algorithm with exclude flags
     template <typename AllocatorT>
     DataFacadeFactory(std::shared_ptr<AllocatorT> allocator, std::true_type)
     {
-        const auto &layout = allocator->GetLayout();
-        properties = layout.template GetBlockPtr<extractor::ProfileProperties>(
-            allocator->GetMemory(), "/common/properties");
+        const auto &index = allocator->GetIndex();
+        properties = index.template GetBlockPtr<extractor::ProfileProperties>("/common/properties");
         const auto &metric_name = properties->GetWeightName();
+        if (index.HasBlock("/mld/time_slot"))
+        {
+            time_slot = index.template GetBlockPtr<customizer::TimeSlot>("/mld/time_slot");
+        }
 
         std::vector<std::string> exclude_prefixes;
         auto exclude_path = std::string("/") + routing_algorithms::identifier<AlgorithmT>() +
                             std::string("/metrics/") + metric_name + "/exclude/";
-        layout.List(exclude_path, std::back_inserter(exclude_prefixes));
+        index.List(exclude_path, std::back_inserter(exclude_prefixes));
         facades.resize(exclude_prefixes.size());
 
         if (facades.empty())
@@ -89,9 +97,8 @@ template <template <typename A> class FacadeT, typename AlgorithmT> class DataFa
     template <typename AllocatorT>
     DataFacadeFactory(std::shared_ptr<AllocatorT> allocator, std::false_type)
     {
-        const auto &layout = allocator->GetLayout();
-        properties = layout.template GetBlockPtr<extractor::ProfileProperties>(
-            allocator->GetMemory(), "/common/properties");
+        const auto &index = allocator->GetIndex();
+        properties = index.template GetBlockPtr<extractor::ProfileProperties>("/common/properties");
         const auto &metric_name = properties->GetWeightName();
         facades.push_back(std::make_shared<const Facade>(allocator, metric_name, 0));
     }
@@ -153,6 +160,7 @@ template <template <typename A> class FacadeT, typename AlgorithmT> class DataFa
     std::vector<std::shared_ptr<const Facade>> facades;
     std::unordered_map<std::string, extractor::ClassData> name_to_class;
     const extractor::ProfileProperties *properties = nullptr;
+    const customizer::TimeSlot *time_slot = nullptr;
 };
 }
 }
@@ -7,6 +7,22 @@
 #include "engine/datafacade/mmap_memory_allocator.hpp"
 #include "engine/datafacade/process_memory_allocator.hpp"
 #include "engine/datafacade_factory.hpp"
+#include "engine/dataset_version.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/numa.hpp"
+#include "util/read_epochs.hpp"
+#include "util/std_hash.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace osrm
 {
@@ -24,55 +40,197 @@ template <typename AlgorithmT, template <typename A> class FacadeT> class DataFa
 
     virtual std::shared_ptr<const Facade> Get(const api::BaseParameters &) const = 0;
     virtual std::shared_ptr<const Facade> Get(const api::TileParameters &) const = 0;
+
+    // The data of the providers that do not watch shared memory never changes, so it is
+    // identified by the time it was loaded. The checksum is left to the facade.
+    virtual DatasetVersion GetVersion() const
+    {
+        DatasetVersion version;
+        version.generation = static_cast<std::uint64_t>(loaded_at);
+        version.loaded_at = loaded_at;
+        return version;
+    }
+
+  private:
+    const std::int64_t loaded_at = std::time(nullptr);
 };
 
+/**
+ * Maps a dataset image. Images are written to a new file that replaces the file at the path at
+ * once, with watch the provider checks the path every WATCH_INTERVAL and maps a new image once
+ * it appears, e.g. after osrm-datastore --prepare-image wrote it. Processes in other containers
+ * that mount the same tmpfs or hugetlbfs directory share one copy of the image and follow its
+ * updates together.
+ */
 template <typename AlgorithmT, template <typename A> class FacadeT>
 class ExternalProvider final : public DataFacadeProvider<AlgorithmT, FacadeT>
 {
+    using FacadeFactory = DataFacadeFactory<FacadeT, AlgorithmT>;
+
+    struct Image
+    {
+        FacadeFactory facade_factory;
+        DatasetVersion version;
+    };
+
   public:
     using Facade = typename DataFacadeProvider<AlgorithmT, FacadeT>::Facade;
 
+    static constexpr std::chrono::seconds WATCH_INTERVAL{1};
+
     ExternalProvider(const storage::StorageConfig &config,
-                     const boost::filesystem::path &memory_file)
-        : facade_factory(std::make_shared<datafacade::MMapMemoryAllocator>(config, memory_file))
+                     const boost::filesystem::path &memory_file,
+                     const bool watch = false)
+        : memory_file(memory_file), populate(config.populate_memory_file), active(watch)
+    {
+        UpdateImage(std::make_shared<datafacade::MMapMemoryAllocator>(config, memory_file));
+        if (watch)
+        {
+            watcher = std::thread(&ExternalProvider::Run, this);
+        }
+    }
+
+    ~ExternalProvider()
     {
+        if (watcher.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                active = false;
+            }
+            stopped.notify_all();
+            watcher.join();
+        }
     }
 
     std::shared_ptr<const Facade> Get(const api::TileParameters &params) const override final
     {
-        return facade_factory.Get(params);
+        util::ReadEpochs::ReadSection read_section;
+        return image.load()->facade_factory.Get(params);
     }
     std::shared_ptr<const Facade> Get(const api::BaseParameters &params) const override final
     {
-        return facade_factory.Get(params);
+        // named metrics are only loaded by osrm-datastore
+        if (!params.metric.empty())
+            return {};
+        util::ReadEpochs::ReadSection read_section;
+        return image.load()->facade_factory.Get(params);
+    }
+
+    // Derived from the file of the image, so all processes that map it agree on the version
+    DatasetVersion GetVersion() const override final
+    {
+        util::ReadEpochs::ReadSection read_section;
+        return image.load()->version;
     }
 
   private:
-    DataFacadeFactory<FacadeT, AlgorithmT> facade_factory;
+    void UpdateImage(std::shared_ptr<datafacade::MMapMemoryAllocator> allocator)
+    {
+        mapped_file_id = allocator->GetFileId();
+
+        auto new_image = std::make_unique<Image>();
+        std::size_t generation = 0;
+        hash_val(generation, mapped_file_id.inode, mapped_file_id.modified);
+        new_image->version.generation = generation;
+        new_image->version.loaded_at = mapped_file_id.modified;
+        new_image->facade_factory = FacadeFactory(std::move(allocator));
+
+        // the facades of requests that still run keep the old image mapped
+        image.store(new_image.get());
+        util::ReadEpochs::Synchronize();
+        current_image = std::move(new_image);
+    }
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopped.wait_for(lock, WATCH_INTERVAL, [this] { return !active; }))
+        {
+            // an image that could not be mapped is not tried again until it is replaced
+            const auto file_id = storage::getImageFileId(memory_file);
+            if (!file_id.IsValid() || file_id == mapped_file_id || file_id == failed_file_id)
+                continue;
+
+            try
+            {
+                // populating the new image delays neither the requests nor the old image
+                UpdateImage(std::make_shared<datafacade::MMapMemoryAllocator>(memory_file,
+                                                                              populate));
+                util::Log() << "updated facade to image " << memory_file.string()
+                            << " written at " << mapped_file_id.modified;
+            }
+            catch (const std::exception &error)
+            {
+                failed_file_id = file_id;
+                util::Log(logWARNING) << "Keeping the mapped image, " << error.what();
+            }
+        }
+    }
+
+    const boost::filesystem::path memory_file;
+    const bool populate;
+    std::thread watcher;
+    std::mutex mutex;
+    std::condition_variable stopped;
+    bool active;
+    storage::ImageFileId mapped_file_id;
+    storage::ImageFileId failed_file_id;
+
+    // swapped by the watcher thread while the request threads read it without locks
+    std::atomic<const Image *> image{nullptr};
+    std::unique_ptr<const Image> current_image;
 };
 
+template <typename AlgorithmT, template <typename A> class FacadeT>
+constexpr std::chrono::seconds ExternalProvider<AlgorithmT, FacadeT>::WATCH_INTERVAL;
+
 template <typename AlgorithmT, template <typename A> class FacadeT>
 class ImmutableProvider final : public DataFacadeProvider<AlgorithmT, FacadeT>
 {
   public:
     using Facade = typename DataFacadeProvider<AlgorithmT, FacadeT>::Facade;
 
-    ImmutableProvider(const storage::StorageConfig &config)
-        : facade_factory(std::make_shared<datafacade::ProcessMemoryAllocator>(config))
+    // With numa_replicas every NUMA node gets its own copy of the dataset
+    ImmutableProvider(const storage::StorageConfig &config, const bool numa_replicas = false)
     {
+        if (!numa_replicas)
+        {
+            facade_factories.emplace_back(
+                std::make_shared<datafacade::ProcessMemoryAllocator>(config));
+            return;
+        }
+
+        for (const auto node : util::irange<std::size_t>(0, util::GetNumaNodes().size()))
+        {
+            util::Log() << "Loading replica of the dataset on NUMA node "
+                        << util::GetNumaNodes()[node].id;
+            facade_factories.emplace_back(
+                std::make_shared<datafacade::ProcessMemoryAllocator>(config, node));
+        }
     }
 
     std::shared_ptr<const Facade> Get(const api::TileParameters &params) const override final
     {
-        return facade_factory.Get(params);
+        return LocalFactory().Get(params);
     }
     std::shared_ptr<const Facade> Get(const api::BaseParameters &params) const override final
     {
-        return facade_factory.Get(params);
+        // named metrics are only loaded by osrm-datastore
+        if (!params.metric.empty())
+            return {};
+        return LocalFactory().Get(params);
     }
 
   private:
-    DataFacadeFactory<FacadeT, AlgorithmT> facade_factory;
+    const DataFacadeFactory<FacadeT, AlgorithmT> &LocalFactory() const
+    {
+        if (facade_factories.size() == 1)
+            return facade_factories.front();
+        return facade_factories[util::CurrentNumaNode() % facade_factories.size()];
+    }
+
+    std::vector<DataFacadeFactory<FacadeT, AlgorithmT>> facade_factories;
 };
 
 template <typename AlgorithmT, template <typename A> class FacadeT>
@@ -93,6 +251,8 @@ class WatchingProvider : public DataFacadeProvider<AlgorithmT, FacadeT>
     {
         return watchdog.Get(params);
     }
+
+    DatasetVersion GetVersion() const override final { return watchdog.GetVersion(); }
 };
 }
 
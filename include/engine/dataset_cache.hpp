@@ -0,0 +1,116 @@
+#ifndef OSRM_ENGINE_DATASET_CACHE_HPP
+#define OSRM_ENGINE_DATASET_CACHE_HPP
+
+#include "util/lru_cache.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+/**
+ * Thread-safe LRU cache of results that stay valid as long as the dataset they were computed on.
+ *
+ * The entries are distributed over shards with their own lock so that concurrent requests
+ * rarely wait on each other. Each shard holds at most capacity / number_of_shards entries.
+ *
+ * Every access passes the id of the dataset of the request. Once a newer dataset shows up,
+ * i.e. the data watchdog swapped the shared memory region, all entries are dropped. Requests
+ * still running on the old dataset keep working since the keys contain the facade id, which
+ * never matches the keys of the new dataset.
+ */
+template <typename Key, typename ValueT, typename Hash> class DatasetCache
+{
+  public:
+    using Value = ValueT;
+
+    DatasetCache(const std::size_t capacity, const std::size_t number_of_shards = 16)
+        : current_dataset_id(0)
+    {
+        BOOST_ASSERT(capacity > 0);
+        BOOST_ASSERT(number_of_shards > 0);
+        const auto shard_count = std::min(capacity, number_of_shards);
+        const auto shard_capacity = (capacity + shard_count - 1) / shard_count;
+        shards.reserve(shard_count);
+        for (std::size_t index = 0; index < shard_count; ++index)
+        {
+            shards.push_back(std::make_unique<Shard>(shard_capacity));
+        }
+    }
+
+    Value Get(const std::uint64_t dataset_id, const Key &key)
+    {
+        UpdateDataset(dataset_id);
+        auto &shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.entries.Get(key).value_or(nullptr);
+    }
+
+    void Put(const std::uint64_t dataset_id, const Key &key, Value value)
+    {
+        UpdateDataset(dataset_id);
+        auto &shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.Put(key, std::move(value));
+    }
+
+    std::size_t Size()
+    {
+        std::size_t size = 0;
+        for (auto &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            size += shard->entries.Size();
+        }
+        return size;
+    }
+
+  private:
+    struct Shard
+    {
+        explicit Shard(const std::size_t capacity) : entries(capacity) {}
+
+        std::mutex mutex;
+        util::LRUCache<Key, Value, Hash> entries;
+    };
+
+    Shard &GetShard(const Key &key)
+    {
+        return *shards[Hash()(key) % shards.size()];
+    }
+
+    // Drops all entries the first time a newer dataset is seen
+    void UpdateDataset(const std::uint64_t dataset_id)
+    {
+        auto current = current_dataset_id.load();
+        while (dataset_id > current)
+        {
+            if (current_dataset_id.compare_exchange_weak(current, dataset_id))
+            {
+                for (auto &shard : shards)
+                {
+                    std::lock_guard<std::mutex> lock(shard->mutex);
+                    shard->entries.Clear();
+                }
+                return;
+            }
+        }
+    }
+
+    std::atomic<std::uint64_t> current_dataset_id;
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_DATASET_CACHE_HPP
@@ -0,0 +1,34 @@
+#ifndef OSRM_ENGINE_DATASET_VERSION_HPP
+#define OSRM_ENGINE_DATASET_VERSION_HPP
+
+#include <cstdint>
+
+namespace osrm
+{
+namespace engine
+{
+
+/**
+ * Identifies the data that replies are computed on, e.g. for the cache validators of HTTP replies.
+ *
+ * With shared memory the generation is derived from the timestamps of the shared regions of the
+ * dataset, so it changes whenever osrm-datastore loads new data or new weights and stays the same
+ * for all processes that serve the same regions. The generation of a memory file is derived from
+ * its inode and the time it was written, so it is the same for all processes that map it and
+ * changes once a new image replaces it. Datasets in process memory never change while they are
+ * served, their generation is the time they were loaded.
+ *
+ * \see OSRM::GetDatasetVersion
+ */
+struct DatasetVersion
+{
+    // the connectivity checksum of the dataset
+    std::uint32_t checksum = 0;
+    std::uint64_t generation = 0;
+    // seconds since the epoch when the data of this generation was loaded
+    std::int64_t loaded_at = 0;
+};
+}
+}
+
+#endif // OSRM_ENGINE_DATASET_VERSION_HPP
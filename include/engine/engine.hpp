@@ -1,14 +1,21 @@
 #ifndef ENGINE_HPP
 #define ENGINE_HPP
 
+#include "engine/api/base_result.hpp"
+#include "engine/api/batch_parameters.hpp"
+#include "engine/api/isochrone_parameters.hpp"
 #include "engine/api/match_parameters.hpp"
 #include "engine/api/nearest_parameters.hpp"
 #include "engine/api/route_parameters.hpp"
 #include "engine/api/table_parameters.hpp"
 #include "engine/api/tile_parameters.hpp"
 #include "engine/api/trip_parameters.hpp"
+#include "engine/cancellation_token.hpp"
 #include "engine/datafacade_provider.hpp"
+#include "engine/dataset_version.hpp"
 #include "engine/engine_config.hpp"
+#include "engine/plugins/batch.hpp"
+#include "engine/plugins/isochrone.hpp"
 #include "engine/plugins/match.hpp"
 #include "engine/plugins/nearest.hpp"
 #include "engine/plugins/table.hpp"
@@ -18,6 +25,8 @@
 #include "engine/routing_algorithms.hpp"
 #include "engine/status.hpp"
 
+#include "storage/memory_usage.hpp"
+
 #include "util/json_container.hpp"
 
 #include <memory>
@@ -32,31 +41,106 @@ class EngineInterface
 {
   public:
     virtual ~EngineInterface() = default;
-    virtual Status Route(const api::RouteParameters &parameters,
-                         util::json::Object &result) const = 0;
-    virtual Status Table(const api::TableParameters &parameters,
-                         util::json::Object &result) const = 0;
+    virtual Status Route(const api::RouteParameters &parameters, api::ResultT &result) const = 0;
+    virtual Status Table(const api::TableParameters &parameters, api::ResultT &result) const = 0;
     virtual Status Nearest(const api::NearestParameters &parameters,
                            util::json::Object &result) const = 0;
     virtual Status Trip(const api::TripParameters &parameters,
                         util::json::Object &result) const = 0;
-    virtual Status Match(const api::MatchParameters &parameters,
-                         util::json::Object &result) const = 0;
+    virtual Status Match(const api::MatchParameters &parameters, api::ResultT &result) const = 0;
     virtual Status Tile(const api::TileParameters &parameters, std::string &result) const = 0;
+    virtual Status Batch(const api::BatchParameters &parameters,
+                         util::json::Object &result) const = 0;
+    virtual Status Isochrone(const api::IsochroneParameters &parameters,
+                             util::json::Object &result) const = 0;
+    virtual Status Memory(util::json::Object &result) const = 0;
+    virtual DatasetVersion GetDatasetVersion() const = 0;
+    virtual void WarmUp() const = 0;
 };
 
+inline util::HeapStorageType toHeapStorageType(const EngineConfig::HeapStorage heap_storage)
+{
+    switch (heap_storage)
+    {
+    case EngineConfig::HeapStorage::GenerationArray:
+        return util::HeapStorageType::GenerationArray;
+    case EngineConfig::HeapStorage::PagedGenerationArray:
+        return util::HeapStorageType::PagedGenerationArray;
+    case EngineConfig::HeapStorage::UnorderedMap:
+    default:
+        return util::HeapStorageType::UnorderedMap;
+    }
+}
+
+// Only the MLD route searches split into parallel halves
+template <typename Algorithm>
+inline void configureParallelSearch(SearchEngineData<Algorithm> &, const double)
+{
+}
+
+inline void configureParallelSearch(SearchEngineData<routing_algorithms::mld::Algorithm> &heaps,
+                                    const double parallel_search_distance)
+{
+    heaps.parallel_search_distance = parallel_search_distance;
+}
+
+// Only CH paths are unpacked from shortcuts
+template <typename Algorithm>
+inline void configureUnpackingCache(SearchEngineData<Algorithm> &, const int)
+{
+}
+
+inline void configureUnpackingCache(SearchEngineData<routing_algorithms::ch::Algorithm> &heaps,
+                                    const int unpacking_cache_size)
+{
+    heaps.unpacking_cache_size = unpacking_cache_size;
+}
+
+inline void setTimeoutError(util::json::Object &result)
+{
+    result.values.clear();
+    result.values["code"] = "Timeout";
+    result.values["message"] = "Query was cancelled before it finished.";
+}
+
+// Errors are reported as JSON regardless of the requested response format
+inline void setTimeoutError(api::ResultT &result)
+{
+    result = util::json::Object();
+    setTimeoutError(result.get<util::json::Object>());
+}
+
 template <typename Algorithm> class Engine final : public EngineInterface
 {
   public:
     explicit Engine(const EngineConfig &config)
-        : route_plugin(config.max_locations_viaroute, config.max_alternatives),            //
-          table_plugin(config.max_locations_distance_table),                               //
+        : phast_graphs(std::make_shared<routing_algorithms::PhastGraphCache>(4)),          //
+          route_plugin(config.max_locations_viaroute,                                      //
+                       config.max_alternatives,                                            //
+                       config.max_alternative_time,                                        //
+                       config.alternative_threads,                                         //
+                       config.route_threads,                                               //
+                       config.route_cache_size),                                           //
+          table_plugin(config.max_locations_distance_table,                                //
+                       config.table_threads,                                               //
+                       config.table_cache_size,                                            //
+                       phast_graphs),                                                      //
           nearest_plugin(config.max_results_nearest),                                      //
-          trip_plugin(config.max_locations_trip),                                          //
-          match_plugin(config.max_locations_map_matching, config.max_radius_map_matching), //
-          tile_plugin()                                                                    //
+          trip_plugin(config.max_locations_trip, config.trip_threads),                     //
+          match_plugin(config.max_locations_map_matching,                                  //
+                       config.max_radius_map_matching,                                     //
+                       config.match_threads,                                               //
+                       config.match_session_cache_size),                                   //
+          tile_plugin(config.tile_cache_size),                                             //
+          batch_plugin(config.max_pairs_batch, config.batch_threads),                      //
+          isochrone_plugin(config.max_duration_isochrone, phast_graphs),                   //
+          heaps(toHeapStorageType(config.heap_storage))                                    //
 
     {
+        configureParallelSearch(heaps, config.parallel_search_distance);
+        configureUnpackingCache(heaps, config.unpacking_cache_size);
+        heaps.max_heap_memory = static_cast<std::size_t>(config.max_heap_memory) * 1024 * 1024;
+
         if (config.use_shared_memory)
         {
             util::Log(logDEBUG) << "Using shared memory with name \"" << config.dataset_name
@@ -67,14 +151,15 @@ template <typename Algorithm> class Engine final : public EngineInterface
         {
             util::Log(logDEBUG) << "Using memory mapped filed at " << config.memory_file
                                 << " with algorithm " << routing_algorithms::name<Algorithm>();
-            facade_provider = std::make_unique<ExternalProvider<Algorithm>>(config.storage_config,
-                                                                            config.memory_file);
+            facade_provider = std::make_unique<ExternalProvider<Algorithm>>(
+                config.storage_config, config.memory_file, config.watch_memory_file);
         }
         else
         {
             util::Log(logDEBUG) << "Using internal memory with algorithm "
                                 << routing_algorithms::name<Algorithm>();
-            facade_provider = std::make_unique<ImmutableProvider<Algorithm>>(config.storage_config);
+            facade_provider = std::make_unique<ImmutableProvider<Algorithm>>(
+                config.storage_config, config.numa_replicas);
         }
     }
 
@@ -85,16 +170,18 @@ template <typename Algorithm> class Engine final : public EngineInterface
     Engine &operator=(const Engine &) = delete;
     virtual ~Engine() = default;
 
-    Status Route(const api::RouteParameters &params,
-                 util::json::Object &result) const override final
+    Status Route(const api::RouteParameters &params, api::ResultT &result) const override final
     {
-        return route_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        return HandleCancellation(result, [&] {
+            return route_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        });
     }
 
-    Status Table(const api::TableParameters &params,
-                 util::json::Object &result) const override final
+    Status Table(const api::TableParameters &params, api::ResultT &result) const override final
     {
-        return table_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        return HandleCancellation(result, [&] {
+            return table_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        });
     }
 
     Status Nearest(const api::NearestParameters &params,
@@ -105,13 +192,16 @@ template <typename Algorithm> class Engine final : public EngineInterface
 
     Status Trip(const api::TripParameters &params, util::json::Object &result) const override final
     {
-        return trip_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        return HandleCancellation(result, [&] {
+            return trip_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        });
     }
 
-    Status Match(const api::MatchParameters &params,
-                 util::json::Object &result) const override final
+    Status Match(const api::MatchParameters &params, api::ResultT &result) const override final
     {
-        return match_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        return HandleCancellation(result, [&] {
+            return match_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        });
     }
 
     Status Tile(const api::TileParameters &params, std::string &result) const override final
@@ -119,13 +209,78 @@ template <typename Algorithm> class Engine final : public EngineInterface
         return tile_plugin.HandleRequest(GetAlgorithms(params), params, result);
     }
 
+    Status Batch(const api::BatchParameters &params,
+                 util::json::Object &result) const override final
+    {
+        return HandleCancellation(result, [&] {
+            return batch_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        });
+    }
+
+    Status Isochrone(const api::IsochroneParameters &params,
+                     util::json::Object &result) const override final
+    {
+        return HandleCancellation(result, [&] {
+            return isochrone_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        });
+    }
+
+    // The blocks of the dataset that answers queries without a metric parameter
+    Status Memory(util::json::Object &result) const override final
+    {
+        const auto facade = facade_provider->Get(api::BaseParameters{});
+        result = storage::makeMemoryReport(storage::getMemoryUsage(facade->GetIndex()));
+        return Status::Ok;
+    }
+
+    // The checksum is the same for all metrics of a dataset
+    DatasetVersion GetDatasetVersion() const override final
+    {
+        auto version = facade_provider->GetVersion();
+        version.checksum = facade_provider->Get(api::BaseParameters{})->GetCheckSum();
+        return version;
+    }
+
+    // The heaps are thread local and sized to the number of nodes of the dataset
+    void WarmUp() const override final
+    {
+        const auto facade = facade_provider->Get(api::BaseParameters{});
+        heaps.InitializeOrClearFirstThreadLocalStorage(facade->GetNumberOfNodes());
+        heaps.InitializeOrClearManyToManyThreadLocalStorage(facade->GetNumberOfNodes());
+    }
+
   private:
     template <typename ParametersT> auto GetAlgorithms(const ParametersT &params) const
+    {
+        return RoutingAlgorithms<Algorithm>{
+            heaps, facade_provider->Get(params), params.cancellation_token};
+    }
+
+    // tiles are bounded by their zoom level and can not be cancelled
+    auto GetAlgorithms(const api::TileParameters &params) const
     {
         return RoutingAlgorithms<Algorithm>{heaps, facade_provider->Get(params)};
     }
+
+    // A cancelled query replaces its partial result with a Timeout error
+    template <typename ResultT, typename Query>
+    static Status HandleCancellation(ResultT &result, const Query &query)
+    {
+        try
+        {
+            return query();
+        }
+        catch (const RequestCancelled &)
+        {
+            setTimeoutError(result);
+            return Status::Timeout;
+        }
+    }
     std::unique_ptr<DataFacadeProvider<Algorithm>> facade_provider;
-    mutable SearchEngineData<Algorithm> heaps;
+
+    // graphs of the PHAST sweeps of the table and isochrone plugins, kept for a few sets of
+    // excluded classes of the current dataset
+    const std::shared_ptr<routing_algorithms::PhastGraphCache> phast_graphs;
 
     const plugins::ViaRoutePlugin route_plugin;
     const plugins::TablePlugin table_plugin;
@@ -133,6 +288,10 @@ template <typename Algorithm> class Engine final : public EngineInterface
     const plugins::TripPlugin trip_plugin;
     const plugins::MatchPlugin match_plugin;
     const plugins::TilePlugin tile_plugin;
+    const plugins::BatchPlugin batch_plugin;
+    const plugins::IsochronePlugin isochrone_plugin;
+
+    mutable SearchEngineData<Algorithm> heaps;
 };
 }
 }
@@ -66,6 +66,66 @@ namespace engine
  *  - Algorithm::MLD
  *      Multi Level Dijkstra, moderately fast in both pre-processing and query.
  *
+ * The node index of the query heaps can be stored in:
+ *  - HeapStorage::UnorderedMap
+ *      A hash map, memory is proportional to the search space. The default.
+ *  - HeapStorage::GenerationArray
+ *      A flat array with O(1) lookups, allocates memory for all nodes per heap and thread.
+ *  - HeapStorage::PagedGenerationArray
+ *      A flat array that only allocates pages of nodes touched by queries.
+ *
+ * With table_threads larger than one the searches of a single table query are split
+ * across a dedicated pool of that many threads.
+ *
+ * With trip_threads larger than one the table of a single trip query and the searches between
+ * its waypoints are split across a dedicated pool of that many threads.
+ *
+ * With match_threads larger than one the routes of the sub matchings of a single match query
+ * are computed across a dedicated pool of that many threads.
+ *
+ * With alternative_threads larger than one the via candidates of a single alternative route
+ * query are evaluated across a dedicated pool of that many threads.
+ *
+ * With route_threads larger than one the legs of a single route query with waypoints are
+ * searched across a dedicated pool of that many threads and joined afterwards.
+ *
+ * With batch_threads larger than one the routes of a single batch query are computed across a
+ * dedicated pool of that many threads.
+ *
+ * With table_cache_size larger than zero the table plugin keeps the search spaces of that many
+ * sources and targets, queries that repeat them only scan the buckets of the cached nodes.
+ *
+ * With route_cache_size larger than zero the route plugin keeps the routes of that many snapped
+ * waypoint combinations, they are dropped once a new dataset is loaded.
+ *
+ * With match_session_cache_size larger than zero the match plugin keeps the candidates and
+ * network distances of that many traces, requests that extend a trace with the same session id
+ * only search the new coordinates.
+ *
+ * With tile_cache_size larger than zero the tile plugin keeps that many encoded vector tiles,
+ * they are dropped once a new dataset is loaded.
+ *
+ * With max_alternative_time other than -1 route queries spend at most about that many
+ * milliseconds on alternatives. The shortest route is always returned, alternatives only if
+ * they were found in time.
+ *
+ * With parallel_search_distance larger than zero MLD route searches between waypoints at least
+ * that many meters apart run their forward and reverse halves on two threads.
+ *
+ * With unpacking_cache_size larger than zero every query thread of the CH algorithm keeps the
+ * original edges of that many shortcuts of recently unpacked paths.
+ *
+ * With max_heap_memory larger than zero the query heaps of all threads keep at most about that
+ * many MiB between queries, threads holding more than their share shrink the heaps they reuse.
+ *
+ * With watch_memory_file the memory_file is checked every second and a new image that replaced
+ * it is mapped, requests that already run finish on the old one. The image can be shared by
+ * processes in other containers on a tmpfs or hugetlbfs mount.
+ *
+ * With numa_replicas the dataset is loaded into process memory once per NUMA node and every
+ * query uses the copy of the node its thread runs on. It needs neither shared memory nor a
+ * memory_file, and no lazy loading of the storage_config.
+ *
  * \see OSRM, StorageConfig
  */
 struct EngineConfig final
@@ -79,17 +139,43 @@ struct EngineConfig final
         MLD
     };
 
+    enum class HeapStorage
+    {
+        UnorderedMap,
+        GenerationArray,
+        PagedGenerationArray
+    };
+
     storage::StorageConfig storage_config;
     int max_locations_trip = -1;
+    int trip_threads = 1;
     int max_locations_viaroute = -1;
+    int route_cache_size = 0;
     int max_locations_distance_table = -1;
+    int table_threads = 1;
+    int table_cache_size = 0;
     int max_locations_map_matching = -1;
     double max_radius_map_matching = -1.0;
+    int match_threads = 1;
+    int match_session_cache_size = 0;
     int max_results_nearest = -1;
+    int tile_cache_size = 0;
     int max_alternatives = 3; // set an arbitrary upper bound; can be adjusted by user
+    int max_alternative_time = -1;
+    int alternative_threads = 1;
+    int route_threads = 1;
+    int max_pairs_batch = -1;
+    int batch_threads = 1;
+    double max_duration_isochrone = -1.0;
     bool use_shared_memory = true;
     boost::filesystem::path memory_file;
+    bool watch_memory_file = false;
     Algorithm algorithm = Algorithm::CH;
+    HeapStorage heap_storage = HeapStorage::UnorderedMap;
+    double parallel_search_distance = 0;
+    int unpacking_cache_size = 0;
+    int max_heap_memory = 0;
+    bool numa_replicas = false;
     std::string verbosity;
     std::string dataset_name;
 };
@@ -91,7 +91,8 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
             [this, max_distance, input_coordinate](const std::size_t,
                                                    const CandidateSegment &segment) {
                 return CheckSegmentDistance(input_coordinate, segment, max_distance);
-            });
+            },
+            util::bearing::sectorMask(bearing, bearing_range));
 
         return MakePhantomNodes(input_coordinate, results);
     }
@@ -105,8 +106,9 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                         const int bearing_range,
                         const Approach approach) const
     {
-        auto results = rtree.Nearest(
+        auto results = rtree.NearestK(
             input_coordinate,
+            max_results,
             [this, approach, &input_coordinate, bearing, bearing_range](
                 const CandidateSegment &segment) {
                 auto use_direction =
@@ -115,9 +117,8 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 return boolPairAnd(use_direction,
                                    CheckApproach(input_coordinate, segment, approach));
             },
-            [max_results](const std::size_t num_results, const CandidateSegment &) {
-                return num_results >= max_results;
-            });
+            [](const CandidateSegment &) { return false; },
+            util::bearing::sectorMask(bearing, bearing_range));
 
         return MakePhantomNodes(input_coordinate, results);
     }
@@ -133,8 +134,9 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                         const int bearing_range,
                         const Approach approach) const
     {
-        auto results = rtree.Nearest(
+        auto results = rtree.NearestK(
             input_coordinate,
+            max_results,
             [this, approach, &input_coordinate, bearing, bearing_range](
                 const CandidateSegment &segment) {
                 auto use_direction =
@@ -143,11 +145,10 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 return boolPairAnd(use_direction,
                                    CheckApproach(input_coordinate, segment, approach));
             },
-            [this, max_distance, max_results, input_coordinate](const std::size_t num_results,
-                                                                const CandidateSegment &segment) {
-                return num_results >= max_results ||
-                       CheckSegmentDistance(input_coordinate, segment, max_distance);
-            });
+            [this, max_distance, input_coordinate](const CandidateSegment &segment) {
+                return CheckSegmentDistance(input_coordinate, segment, max_distance);
+            },
+            util::bearing::sectorMask(bearing, bearing_range));
 
         return MakePhantomNodes(input_coordinate, results);
     }
@@ -159,15 +160,14 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                         const unsigned max_results,
                         const Approach approach) const
     {
-        auto results = rtree.Nearest(
+        auto results = rtree.NearestK(
             input_coordinate,
+            max_results,
             [this, approach, &input_coordinate](const CandidateSegment &segment) {
                 return boolPairAnd(boolPairAnd(HasValidEdge(segment), CheckSegmentExclude(segment)),
                                    CheckApproach(input_coordinate, segment, approach));
             },
-            [max_results](const std::size_t num_results, const CandidateSegment &) {
-                return num_results >= max_results;
-            });
+            [](const CandidateSegment &) { return false; });
 
         return MakePhantomNodes(input_coordinate, results);
     }
@@ -180,16 +180,15 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                         const double max_distance,
                         const Approach approach) const
     {
-        auto results = rtree.Nearest(
+        auto results = rtree.NearestK(
             input_coordinate,
+            max_results,
             [this, approach, &input_coordinate](const CandidateSegment &segment) {
                 return boolPairAnd(boolPairAnd(HasValidEdge(segment), CheckSegmentExclude(segment)),
                                    CheckApproach(input_coordinate, segment, approach));
             },
-            [this, max_distance, max_results, input_coordinate](const std::size_t num_results,
-                                                                const CandidateSegment &segment) {
-                return num_results >= max_results ||
-                       CheckSegmentDistance(input_coordinate, segment, max_distance);
+            [this, max_distance, input_coordinate](const CandidateSegment &segment) {
+                return CheckSegmentDistance(input_coordinate, segment, max_distance);
             });
 
         return MakePhantomNodes(input_coordinate, results);
@@ -230,7 +229,9 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 const std::size_t num_results, const CandidateSegment &segment) {
                 return (num_results > 0 && has_big_component) ||
                        CheckSegmentDistance(input_coordinate, segment, max_distance);
-            });
+            },
+            util::bearing::ALL_SECTORS,
+            true);
 
         if (results.size() == 0)
         {
@@ -275,7 +276,9 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
             },
             [&has_big_component](const std::size_t num_results, const CandidateSegment &) {
                 return num_results > 0 && has_big_component;
-            });
+            },
+            util::bearing::ALL_SECTORS,
+            true);
 
         if (results.size() == 0)
         {
@@ -332,7 +335,9 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
             },
             [&has_big_component](const std::size_t num_results, const CandidateSegment &) {
                 return num_results > 0 && has_big_component;
-            });
+            },
+            util::bearing::sectorMask(bearing, bearing_range),
+            true);
 
         if (results.size() == 0)
         {
@@ -392,7 +397,9 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 const std::size_t num_results, const CandidateSegment &segment) {
                 return (num_results > 0 && has_big_component) ||
                        CheckSegmentDistance(input_coordinate, segment, max_distance);
-            });
+            },
+            util::bearing::sectorMask(bearing, bearing_range),
+            true);
 
         if (results.size() == 0)
         {
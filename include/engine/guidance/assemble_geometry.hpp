@@ -65,7 +65,7 @@ inline LegGeometry assembleGeometry(const datafacade::BaseDataFacade &facade,
     auto prev_coordinate = geometry.locations.front();
     for (const auto &path_point : leg_data)
     {
-        auto coordinate = facade.GetCoordinateOfNode(path_point.turn_via_node);
+        auto coordinate = path_point.turn_via_coordinate;
         current_distance =
             util::coordinate_calculation::haversineDistance(prev_coordinate, coordinate);
         cumulative_distance += current_distance;
@@ -81,8 +81,12 @@ inline LegGeometry assembleGeometry(const datafacade::BaseDataFacade &facade,
         prev_coordinate = coordinate;
 
         const auto osm_node_id = facade.GetOSMNodeIDOfNode(path_point.turn_via_node);
+        // duplicated nodes share their coordinate if the OSM node ids are not loaded
+        const auto is_new_node = facade.HasOSMNodeIDs()
+                                     ? osm_node_id != geometry.osm_node_ids.back()
+                                     : coordinate != geometry.locations.back();
 
-        if (osm_node_id != geometry.osm_node_ids.back() ||
+        if (is_new_node ||
             path_point.turn_instruction.type != osrm::guidance::TurnType::NoTurn)
         {
             geometry.annotations.emplace_back(LegGeometry::Annotation{
@@ -169,6 +173,40 @@ inline LegGeometry assembleGeometry(const datafacade::BaseDataFacade &facade,
 
     return geometry;
 }
+
+// Calculates only the traveled distance of the segments, for legs whose geometry, steps and
+// annotations are not part of the response. The segment distances are the ones assembleGeometry
+// calculates, the other members of the geometry stay empty.
+inline LegGeometry assembleSegmentDistances(const datafacade::BaseDataFacade &facade,
+                                            const std::vector<PathData> &leg_data,
+                                            const PhantomNode &source_node,
+                                            const PhantomNode &target_node)
+{
+    LegGeometry geometry;
+
+    auto cumulative_distance = 0.;
+    auto prev_coordinate = source_node.location;
+    for (const auto &path_point : leg_data)
+    {
+        const auto &coordinate = path_point.turn_via_coordinate;
+        cumulative_distance +=
+            util::coordinate_calculation::haversineDistance(prev_coordinate, coordinate);
+
+        // all changes to this check have to be matched with assembleGeometry
+        if (path_point.turn_instruction.type != osrm::guidance::TurnType::NoTurn)
+        {
+            geometry.segment_distances.push_back(cumulative_distance);
+            cumulative_distance = 0.;
+        }
+
+        prev_coordinate = coordinate;
+    }
+    cumulative_distance +=
+        util::coordinate_calculation::haversineDistance(prev_coordinate, target_node.location);
+    geometry.segment_distances.push_back(cumulative_distance);
+
+    return geometry;
+}
 }
 }
 }
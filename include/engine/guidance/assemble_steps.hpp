@@ -19,6 +19,7 @@
 
 #include <boost/optional.hpp>
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -71,8 +72,9 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
 
     const auto number_of_segments = leg_geometry.GetNumberOfSegments();
 
+    // one step per segment and the arrive step
     std::vector<RouteStep> steps;
-    steps.reserve(number_of_segments);
+    steps.reserve(number_of_segments + 1);
 
     std::size_t segment_index = 0;
     BOOST_ASSERT(leg_geometry.locations.size() >= 2);
@@ -144,7 +146,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                                           maneuver,
                                           leg_geometry.FrontIndex(segment_index),
                                           leg_geometry.BackIndex(segment_index) + 1,
-                                          {intersection},
+                                          {std::move(intersection)},
                                           path_point.is_left_hand_driving});
 
                 if (leg_data_index + 1 < leg_data.size())
@@ -165,7 +167,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                 auto bearing_data = bearing_class.getAvailableBearings();
                 intersection.in = bearing_class.findMatchingBearing(bearings.first);
                 intersection.out = bearing_class.findMatchingBearing(bearings.second);
-                intersection.location = facade.GetCoordinateOfNode(path_point.turn_via_node);
+                intersection.location = path_point.turn_via_coordinate;
                 intersection.bearings.clear();
                 intersection.bearings.reserve(bearing_data.size());
                 intersection.lanes = path_point.lane_data.first;
@@ -227,7 +229,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                                   maneuver,
                                   leg_geometry.FrontIndex(segment_index),
                                   leg_geometry.BackIndex(segment_index) + 1,
-                                  {intersection},
+                                  {std::move(intersection)},
                                   facade.IsLeftHandDriving(target_node_id)});
     }
     // In this case the source + target are on the same edge segment
@@ -272,7 +274,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                                   std::move(maneuver),
                                   leg_geometry.FrontIndex(segment_index),
                                   leg_geometry.BackIndex(segment_index) + 1,
-                                  {intersection},
+                                  {std::move(intersection)},
                                   facade.IsLeftHandDriving(source_node_id)});
     }
 
@@ -315,7 +317,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                               std::move(maneuver),
                               leg_geometry.locations.size() - 1,
                               leg_geometry.locations.size(),
-                              {intersection},
+                              {std::move(intersection)},
                               facade.IsLeftHandDriving(target_node_id)});
 
     BOOST_ASSERT(steps.front().intersections.size() == 1);
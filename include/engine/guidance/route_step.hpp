@@ -11,6 +11,7 @@
 #include "util/guidance/turn_lanes.hpp"
 
 #include <cstddef>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -90,6 +91,9 @@ struct RouteStep
     // Elongate by another step in back
     RouteStep &ElongateBy(const RouteStep &following_step);
 
+    // Elongate by another step in back that is invalidated afterwards, takes its intersections
+    RouteStep &ElongateBy(RouteStep &&following_step);
+
     /* Elongate without prior knowledge of in front, or in back, convenience function if you
      * don't know if step is augmented in front or at the back */
     RouteStep &MergeWith(const RouteStep &by_step);
@@ -169,6 +173,22 @@ inline RouteStep &RouteStep::ElongateBy(const RouteStep &following_step)
     return *this;
 }
 
+inline RouteStep &RouteStep::ElongateBy(RouteStep &&following_step)
+{
+    BOOST_ASSERT(geometry_end == following_step.geometry_begin + 1);
+    BOOST_ASSERT(mode == following_step.mode);
+    duration += following_step.duration;
+    distance += following_step.distance;
+    weight += following_step.weight;
+
+    geometry_end = following_step.geometry_end;
+    intersections.insert(intersections.end(),
+                         std::make_move_iterator(following_step.intersections.begin()),
+                         std::make_move_iterator(following_step.intersections.end()));
+
+    return *this;
+}
+
 // Elongate without prior knowledge of in front, or in back.
 inline RouteStep &RouteStep::MergeWith(const RouteStep &by_step)
 {
@@ -32,6 +32,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "util/coordinate.hpp"
 
+#include <boost/optional.hpp>
+
 #include <cstdint>
 #include <iosfwd>
 #include <string>
@@ -53,11 +55,15 @@ struct Hint
     PhantomNode phantom;
     std::uint32_t data_checksum;
 
+    // A hint is used instead of snapping the coordinate if it was made for the same data and the
+    // coordinate is either the input coordinate or the snapped location of the hint
     bool IsValid(const util::Coordinate new_input_coordinates,
                  const datafacade::BaseDataFacade &facade) const;
 
     std::string ToBase64() const;
     static Hint FromBase64(const std::string &base64Hint);
+    // Decodes the characters of an encoded hint in place, none if they are no valid encoding
+    static boost::optional<Hint> FromBase64(const char *first, const char *last);
 
     friend bool operator==(const Hint &, const Hint &);
     friend std::ostream &operator<<(std::ostream &, const Hint &);
@@ -65,6 +65,9 @@ struct PathData
 
     // Driving side of the turn
     bool is_left_hand_driving;
+
+    // coordinate of the via node, decoded with the geometry of the segment
+    util::Coordinate turn_via_coordinate;
 };
 
 struct InternalRouteResult
@@ -0,0 +1,227 @@
+#ifndef OSRM_ENGINE_MAP_MATCHING_MATCHING_SESSION_HPP
+#define OSRM_ENGINE_MAP_MATCHING_MATCHING_SESSION_HPP
+
+#include "engine/approach.hpp"
+#include "engine/bearing.hpp"
+#include "engine/dataset_cache.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/route_cache.hpp"
+
+#include "util/coordinate.hpp"
+#include "util/std_hash.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace map_matching
+{
+
+// Everything the candidate search of a trace coordinate depends on
+struct CandidatesKey
+{
+    CandidatesKey(const util::Coordinate coordinate,
+                  const double radius,
+                  const boost::optional<Bearing> &bearing,
+                  const Approach approach)
+        : lon(static_cast<std::int32_t>(coordinate.lon)),
+          lat(static_cast<std::int32_t>(coordinate.lat)), radius(radius),
+          bearing(bearing ? bearing->bearing : -1), range(bearing ? bearing->range : -1),
+          approach(static_cast<std::uint8_t>(approach))
+    {
+    }
+
+    auto Tie() const { return std::tie(lon, lat, radius, bearing, range, approach); }
+
+    bool operator==(const CandidatesKey &other) const { return Tie() == other.Tie(); }
+
+    std::int32_t lon;
+    std::int32_t lat;
+    double radius;
+    // -1 if no bearing is set
+    short bearing;
+    short range;
+    std::uint8_t approach;
+};
+
+struct CandidatesKeyHash
+{
+    std::size_t operator()(const CandidatesKey &key) const
+    {
+        return hash_val(key.lon, key.lat, key.radius, key.bearing, key.range, key.approach);
+    }
+};
+
+// Identifies the network distance between two candidates. In contrast to the routes of the
+// RouteCache the distance depends on the snapped locations, and the searches stop at the weight
+// upper bound of the transition.
+struct TransitionKey
+{
+    TransitionKey(const PhantomNode &source,
+                  const PhantomNode &target,
+                  const EdgeWeight weight_upper_bound)
+        : source(source), target(target),
+          source_lon(static_cast<std::int32_t>(source.location.lon)),
+          source_lat(static_cast<std::int32_t>(source.location.lat)),
+          target_lon(static_cast<std::int32_t>(target.location.lon)),
+          target_lat(static_cast<std::int32_t>(target.location.lat)),
+          weight_upper_bound(weight_upper_bound)
+    {
+    }
+
+    bool operator==(const TransitionKey &other) const
+    {
+        return std::tie(source_lon, source_lat, target_lon, target_lat, weight_upper_bound) ==
+                   std::tie(other.source_lon,
+                            other.source_lat,
+                            other.target_lon,
+                            other.target_lat,
+                            other.weight_upper_bound) &&
+               source == other.source && target == other.target;
+    }
+
+    RouteCachePhantom source;
+    RouteCachePhantom target;
+    std::int32_t source_lon;
+    std::int32_t source_lat;
+    std::int32_t target_lon;
+    std::int32_t target_lat;
+    EdgeWeight weight_upper_bound;
+};
+
+struct TransitionKeyHash
+{
+    std::size_t operator()(const TransitionKey &key) const
+    {
+        return hash_val(key.source.forward_node,
+                        key.source.reverse_node,
+                        key.source.fwd_segment_position,
+                        key.source.flags,
+                        key.source_lon,
+                        key.source_lat,
+                        key.target.forward_node,
+                        key.target.reverse_node,
+                        key.target.fwd_segment_position,
+                        key.target.flags,
+                        key.target_lon,
+                        key.target_lat,
+                        key.weight_upper_bound);
+    }
+};
+
+/**
+ * Candidates and network distances of a trace that is matched again with new coordinates.
+ *
+ * A session is created for every request and starts out with the session of the previous
+ * request. Lookups that miss take the entry over from the previous session, so once the request
+ * is done the session holds exactly the searches of its trace and the previous session can be
+ * released. Only the searches of the new coordinates are run, the Viterbi algorithm itself is
+ * cheap enough to run over the whole trace again.
+ */
+class MatchingSession
+{
+  public:
+    using CandidateList = std::vector<PhantomNodeWithDistance>;
+
+    MatchingSession() = default;
+
+    explicit MatchingSession(std::shared_ptr<const MatchingSession> previous_)
+        : previous(std::move(previous_))
+    {
+    }
+
+    const CandidateList *FindCandidates(const CandidatesKey &key)
+    {
+        return Find(candidates, previous ? &previous->candidates : nullptr, key);
+    }
+
+    void AddCandidates(const CandidatesKey &key, CandidateList list)
+    {
+        candidates.emplace(key, std::move(list));
+    }
+
+    const double *FindTransition(const TransitionKey &key)
+    {
+        return Find(transitions, previous ? &previous->transitions : nullptr, key);
+    }
+
+    void AddTransition(const TransitionKey &key, const double distance)
+    {
+        transitions.emplace(key, distance);
+    }
+
+    // Drops the searches that the trace of this request did not use anymore
+    void ReleasePrevious() { previous.reset(); }
+
+    std::size_t NumberOfCandidateLists() const { return candidates.size(); }
+    std::size_t NumberOfTransitions() const { return transitions.size(); }
+
+  private:
+    template <typename MapT, typename KeyT>
+    static const typename MapT::mapped_type *
+    Find(MapT &current, const MapT *previous_map, const KeyT &key)
+    {
+        const auto iter = current.find(key);
+        if (iter != current.end())
+            return &iter->second;
+
+        if (previous_map)
+        {
+            const auto previous_iter = previous_map->find(key);
+            if (previous_iter != previous_map->end())
+                return &current.emplace(key, previous_iter->second).first->second;
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<const MatchingSession> previous;
+    std::unordered_map<CandidatesKey, CandidateList, CandidatesKeyHash> candidates;
+    std::unordered_map<TransitionKey, double, TransitionKeyHash> transitions;
+};
+
+// Identifies a session by the facade it was matched on and the id passed by the client
+struct MatchingSessionKey
+{
+    bool operator==(const MatchingSessionKey &other) const
+    {
+        return std::tie(facade_id, session) == std::tie(other.facade_id, other.session);
+    }
+
+    std::uint64_t facade_id;
+    std::string session;
+};
+
+struct MatchingSessionKeyHash
+{
+    std::size_t operator()(const MatchingSessionKey &key) const
+    {
+        return hash_val(key.facade_id, key.session);
+    }
+};
+
+/**
+ * Thread-safe LRU cache of the sessions of the most recently matched traces, they are dropped
+ * once a newer dataset is loaded.
+ *
+ * \see DatasetCache
+ */
+using MatchingSessionCache = DatasetCache<MatchingSessionKey,
+                                          std::shared_ptr<const MatchingSession>,
+                                          MatchingSessionKeyHash>;
+
+} // namespace map_matching
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_MAP_MATCHING_MATCHING_SESSION_HPP
@@ -0,0 +1,40 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "engine/plugins/plugin_base.hpp"
+
+#include "engine/api/batch_parameters.hpp"
+#include "engine/routing_algorithms.hpp"
+
+#include "util/json_container.hpp"
+
+#include <tbb/task_arena.h>
+
+#include <memory>
+
+namespace osrm
+{
+namespace engine
+{
+namespace plugins
+{
+
+class BatchPlugin final : public BasePlugin
+{
+  private:
+    const int max_pairs_batch;
+    // only set if the routes of a batch query are split across several threads
+    const std::unique_ptr<tbb::task_arena> batch_arena;
+
+  public:
+    BatchPlugin(const int max_pairs_batch_, const int batch_threads);
+
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::BatchParameters &parameters,
+                         util::json::Object &json_result) const;
+};
+}
+}
+}
+
+#endif // BATCH_HPP
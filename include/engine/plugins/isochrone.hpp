@@ -0,0 +1,39 @@
+#ifndef ISOCHRONE_HPP
+#define ISOCHRONE_HPP
+
+#include "engine/plugins/plugin_base.hpp"
+
+#include "engine/api/isochrone_parameters.hpp"
+#include "engine/routing_algorithms.hpp"
+#include "engine/routing_algorithms/phast.hpp"
+
+#include "util/json_container.hpp"
+
+#include <memory>
+
+namespace osrm
+{
+namespace engine
+{
+namespace plugins
+{
+
+class IsochronePlugin final : public BasePlugin
+{
+  private:
+    const double max_duration_isochrone;
+    const std::shared_ptr<routing_algorithms::PhastGraphCache> phast_graphs;
+
+  public:
+    IsochronePlugin(const double max_duration_isochrone_,
+                    std::shared_ptr<routing_algorithms::PhastGraphCache> phast_graphs_);
+
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::IsochroneParameters &parameters,
+                         util::json::Object &json_result) const;
+};
+}
+}
+}
+
+#endif // ISOCHRONE_HPP
@@ -2,11 +2,15 @@
 #define MATCH_HPP
 
 #include "engine/api/match_parameters.hpp"
+#include "engine/map_matching/matching_session.hpp"
 #include "engine/plugins/plugin_base.hpp"
 #include "engine/routing_algorithms.hpp"
 
 #include "util/json_util.hpp"
 
+#include <tbb/task_arena.h>
+
+#include <memory>
 #include <vector>
 
 namespace osrm
@@ -24,19 +28,37 @@ class MatchPlugin : public BasePlugin
     using CandidateLists = routing_algorithms::CandidateLists;
     static const constexpr double RADIUS_MULTIPLIER = 3;
 
-    MatchPlugin(const int max_locations_map_matching, const double max_radius_map_matching)
+    MatchPlugin(const int max_locations_map_matching,
+                const double max_radius_map_matching,
+                const int match_threads,
+                const int session_cache_size)
         : max_locations_map_matching(max_locations_map_matching),
-          max_radius_map_matching(max_radius_map_matching)
+          max_radius_map_matching(max_radius_map_matching),
+          match_arena(match_threads > 1 ? std::make_unique<tbb::task_arena>(match_threads)
+                                        : nullptr),
+          session_cache(session_cache_size > 0
+                            ? std::make_unique<map_matching::MatchingSessionCache>(
+                                  session_cache_size)
+                            : nullptr)
     {
     }
 
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::MatchParameters &parameters,
-                         util::json::Object &json_result) const;
+                         api::ResultT &result) const;
 
   private:
+    CandidateLists GetSessionCandidates(const datafacade::BaseDataFacade &facade,
+                                        const api::BaseParameters &parameters,
+                                        const std::vector<double> &radiuses,
+                                        map_matching::MatchingSession &session) const;
+
     const int max_locations_map_matching;
     const double max_radius_map_matching;
+    // only set if the sub matchings of a match query are routed across several threads
+    const std::unique_ptr<tbb::task_arena> match_arena;
+    // only set if the searches of matching sessions are kept across requests
+    const std::unique_ptr<map_matching::MatchingSessionCache> session_cache;
 };
 }
 }
@@ -2,6 +2,8 @@
 #define BASE_PLUGIN_HPP
 
 #include "engine/api/base_parameters.hpp"
+#include "engine/api/base_result.hpp"
+#include "engine/api/route_parameters.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
 #include "engine/phantom_node.hpp"
 #include "engine/routing_algorithms.hpp"
@@ -9,12 +11,19 @@
 
 #include "util/coordinate.hpp"
 #include "util/coordinate_calculation.hpp"
+#include "util/hilbert_value.hpp"
 #include "util/integer_range.hpp"
 #include "util/json_container.hpp"
+#include "util/request_trace.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <iterator>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <util/log.hpp>
@@ -28,6 +37,39 @@ namespace plugins
 
 class BasePlugin
 {
+    // Requests with at least that many coordinates are snapped on several threads
+    static constexpr std::size_t PARALLEL_SNAPPING_SIZE = 64;
+    static constexpr std::size_t SNAPPING_GRAIN_SIZE = 16;
+
+    // Calls snap(index) for all coordinates. They are snapped in the order of their Hilbert
+    // values, so consecutive queries walk the same r-tree nodes and leaf pages, and large
+    // requests are split into runs of close coordinates across the TBB threads.
+    template <typename SnapT>
+    static void SnapCoordinates(const std::vector<util::Coordinate> &coordinates, const SnapT &snap)
+    {
+        std::vector<std::pair<std::uint64_t, std::size_t>> order;
+        order.reserve(coordinates.size());
+        for (const auto index : util::irange<std::size_t>(0UL, coordinates.size()))
+        {
+            order.emplace_back(util::GetHilbertCode(coordinates[index]), index);
+        }
+        std::sort(order.begin(), order.end());
+
+        if (order.size() < PARALLEL_SNAPPING_SIZE)
+        {
+            for (const auto &code_and_index : order)
+                snap(code_and_index.second);
+            return;
+        }
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, order.size(), SNAPPING_GRAIN_SIZE),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              for (auto position = range.begin(); position != range.end();
+                                   ++position)
+                                  snap(order[position].second);
+                          });
+    }
+
   protected:
     bool CheckAllCoordinates(const std::vector<util::Coordinate> &coordinates) const
     {
@@ -37,15 +79,21 @@ class BasePlugin
             });
     }
 
+    template <typename ResultT>
     bool CheckAlgorithms(const api::BaseParameters &params,
                          const RoutingAlgorithmsInterface &algorithms,
-                         util::json::Object &result) const
+                         ResultT &result) const
     {
         if (algorithms.IsValid())
         {
             return true;
         }
 
+        if (!params.metric.empty() && params.exclude.empty())
+        {
+            Error("InvalidValue", "Metric " + params.metric + " is not loaded.", result);
+            return false;
+        }
         if (!algorithms.HasExcludeFlags() && !params.exclude.empty())
         {
             Error("NotImplemented", "This algorithm does not support exclude flags.", result);
@@ -57,8 +105,25 @@ class BasePlugin
             return false;
         }
 
-        BOOST_ASSERT_MSG(false,
-                         "There are only two reasons why the algorithm interface can be invalid.");
+        BOOST_ASSERT_MSG(
+            false, "There are only three reasons why the algorithm interface can be invalid.");
+        return false;
+    }
+
+    // Explicitly requested node annotations need the OSM node ids, annotations=true skips them
+    template <typename ResultT>
+    bool CheckAnnotations(const api::RouteParameters &params,
+                          const datafacade::BaseDataFacade &facade,
+                          ResultT &result) const
+    {
+        if (facade.HasOSMNodeIDs() ||
+            !(params.annotations_type & api::RouteParameters::AnnotationsType::Nodes) ||
+            params.annotations_type == api::RouteParameters::AnnotationsType::All)
+        {
+            return true;
+        }
+
+        Error("InvalidValue", "Node annotations are not supported by this dataset.", result);
         return false;
     }
 
@@ -71,6 +136,13 @@ class BasePlugin
         return Status::Error;
     }
 
+    // Errors are reported as JSON regardless of the requested response format
+    Status Error(const std::string &code, const std::string &message, api::ResultT &result) const
+    {
+        result = util::json::Object();
+        return Error(code, message, result.get<util::json::Object>());
+    }
+
     // Decides whether to use the phantom node from a big or small component if both are found.
     // Returns true if all phantom nodes are in the same component after snapping.
     std::vector<PhantomNode>
@@ -140,6 +212,7 @@ class BasePlugin
                            const api::BaseParameters &parameters,
                            const std::vector<double> radiuses) const
     {
+        const util::TraceSpan span("snapping");
         std::vector<std::vector<PhantomNodeWithDistance>> phantom_nodes(
             parameters.coordinates.size());
         BOOST_ASSERT(radiuses.size() == parameters.coordinates.size());
@@ -148,8 +221,7 @@ class BasePlugin
         const bool use_bearings = !parameters.bearings.empty();
         const bool use_approaches = !parameters.approaches.empty();
 
-        for (const auto i : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
-        {
+        SnapCoordinates(parameters.coordinates, [&](const std::size_t i) {
             Approach approach = engine::Approach::UNRESTRICTED;
             if (use_approaches && parameters.approaches[i])
                 approach = parameters.approaches[i].get();
@@ -162,7 +234,7 @@ class BasePlugin
                     util::coordinate_calculation::haversineDistance(
                         parameters.coordinates[i], parameters.hints[i]->phantom.location),
                 });
-                continue;
+                return;
             }
             if (use_bearings && parameters.bearings[i])
             {
@@ -178,7 +250,7 @@ class BasePlugin
                 phantom_nodes[i] = facade.NearestPhantomNodesInRange(
                     parameters.coordinates[i], radiuses[i], approach);
             }
-        }
+        });
 
         return phantom_nodes;
     }
@@ -188,6 +260,7 @@ class BasePlugin
                     const api::BaseParameters &parameters,
                     unsigned number_of_results) const
     {
+        const util::TraceSpan span("snapping");
         std::vector<std::vector<PhantomNodeWithDistance>> phantom_nodes(
             parameters.coordinates.size());
 
@@ -262,6 +335,7 @@ class BasePlugin
     std::vector<PhantomNodePair> GetPhantomNodes(const datafacade::BaseDataFacade &facade,
                                                  const api::BaseParameters &parameters) const
     {
+        const util::TraceSpan span("snapping");
         std::vector<PhantomNodePair> phantom_node_pairs(parameters.coordinates.size());
 
         const bool use_hints = !parameters.hints.empty();
@@ -270,8 +344,7 @@ class BasePlugin
         const bool use_approaches = !parameters.approaches.empty();
 
         BOOST_ASSERT(parameters.IsValid());
-        for (const auto i : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
-        {
+        SnapCoordinates(parameters.coordinates, [&](const std::size_t i) {
             Approach approach = engine::Approach::UNRESTRICTED;
             if (use_approaches && parameters.approaches[i])
                 approach = parameters.approaches[i].get();
@@ -281,7 +354,7 @@ class BasePlugin
             {
                 phantom_node_pairs[i].first = parameters.hints[i]->phantom;
                 // we don't set the second one - it will be marked as invalid
-                continue;
+                return;
             }
 
             if (use_bearings && parameters.bearings[i])
@@ -322,16 +395,18 @@ class BasePlugin
                 }
             }
 
-            // we didn't find a fitting node, return error
-            if (!phantom_node_pairs[i].first.IsValid())
-            {
-                // This ensures the list of phantom nodes only consists of valid nodes.
-                // We can use this on the call-site to detect an error.
-                phantom_node_pairs.pop_back();
-                break;
-            }
-            BOOST_ASSERT(phantom_node_pairs[i].first.IsValid());
-            BOOST_ASSERT(phantom_node_pairs[i].second.IsValid());
+            BOOST_ASSERT(!phantom_node_pairs[i].first.IsValid() ||
+                         phantom_node_pairs[i].second.IsValid());
+        });
+
+        // we didn't find a fitting node, return error
+        if (std::any_of(phantom_node_pairs.begin(),
+                        phantom_node_pairs.end(),
+                        [](const PhantomNodePair &pair) { return !pair.first.IsValid(); }))
+        {
+            // This ensures the list of phantom nodes does not match the coordinates.
+            // We can use this on the call-site to detect an error.
+            phantom_node_pairs.pop_back();
         }
         return phantom_node_pairs;
     }
@@ -5,9 +5,15 @@
 
 #include "engine/api/table_parameters.hpp"
 #include "engine/routing_algorithms.hpp"
+#include "engine/routing_algorithms/phast.hpp"
+#include "engine/routing_algorithms/search_space_cache.hpp"
 
 #include "util/json_container.hpp"
 
+#include <tbb/task_arena.h>
+
+#include <memory>
+
 namespace osrm
 {
 namespace engine
@@ -18,14 +24,23 @@ namespace plugins
 class TablePlugin final : public BasePlugin
 {
   public:
-    explicit TablePlugin(const int max_locations_distance_table);
+    TablePlugin(const int max_locations_distance_table,
+                const int table_threads,
+                const int table_cache_size,
+                std::shared_ptr<routing_algorithms::PhastGraphCache> phast_graphs);
 
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::TableParameters &params,
-                         util::json::Object &result) const;
+                         api::ResultT &result) const;
 
   private:
     const int max_locations_distance_table;
+    // only set if a table query is split across several threads
+    const std::unique_ptr<tbb::task_arena> table_arena;
+    // only set if the search spaces of sources and targets are cached across queries
+    const std::unique_ptr<routing_algorithms::SearchSpaceCache> search_space_cache;
+    // graphs of the restricted sweeps of large tables, shared with the isochrone plugin
+    const std::shared_ptr<routing_algorithms::PhastGraphCache> phast_graphs;
 };
 }
 }
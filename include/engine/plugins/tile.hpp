@@ -4,7 +4,10 @@
 #include "engine/api/tile_parameters.hpp"
 #include "engine/plugins/plugin_base.hpp"
 #include "engine/routing_algorithms.hpp"
+#include "engine/tile_cache.hpp"
 
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -25,7 +28,12 @@ namespace plugins
 
 class TilePlugin final : public BasePlugin
 {
+  private:
+    const std::unique_ptr<TileCache> tile_cache;
+
   public:
+    explicit TilePlugin(int tile_cache_size);
+
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::TileParameters &parameters,
                          std::string &pbf_buffer) const;
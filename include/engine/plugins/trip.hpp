@@ -10,6 +10,8 @@
 
 #include <boost/assert.hpp>
 
+#include <tbb/task_arena.h>
+
 #include <algorithm>
 #include <cstdlib>
 #include <iterator>
@@ -29,6 +31,8 @@ class TripPlugin final : public BasePlugin
 {
   private:
     const int max_locations_trip;
+    // only set if a trip query is split across several threads
+    const std::unique_ptr<tbb::task_arena> trip_arena;
 
     InternalRouteResult ComputeRoute(const RoutingAlgorithmsInterface &algorithms,
                                      const std::vector<PhantomNode> &phantom_node_list,
@@ -36,7 +40,7 @@ class TripPlugin final : public BasePlugin
                                      const bool roundtrip) const;
 
   public:
-    explicit TripPlugin(const int max_locations_trip_) : max_locations_trip(max_locations_trip_) {}
+    TripPlugin(const int max_locations_trip_, const int trip_threads);
 
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::TripParameters &parameters,
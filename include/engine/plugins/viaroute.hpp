@@ -4,10 +4,13 @@
 #include "engine/plugins/plugin_base.hpp"
 
 #include "engine/api/route_parameters.hpp"
+#include "engine/route_cache.hpp"
 #include "engine/routing_algorithms.hpp"
 
 #include "util/json_container.hpp"
 
+#include <tbb/task_arena.h>
+
 #include <cstdlib>
 
 #include <algorithm>
@@ -27,13 +30,26 @@ class ViaRoutePlugin final : public BasePlugin
   private:
     const int max_locations_viaroute;
     const int max_alternatives;
+    // milliseconds of a route query spent on alternatives, -1 for no limit
+    const int max_alternative_time;
+    // only set if the candidates of an alternative route query are split across several threads
+    const std::unique_ptr<tbb::task_arena> alternative_arena;
+    // only set if the legs of a route query with waypoints are split across several threads
+    const std::unique_ptr<tbb::task_arena> route_arena;
+    // only set if routes are cached across requests
+    const std::unique_ptr<RouteCache> route_cache;
 
   public:
-    explicit ViaRoutePlugin(int max_locations_viaroute, int max_alternatives);
+    ViaRoutePlugin(int max_locations_viaroute,
+                   int max_alternatives,
+                   int max_alternative_time,
+                   int alternative_threads,
+                   int route_threads,
+                   int route_cache_size);
 
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::RouteParameters &route_parameters,
-                         util::json::Object &json_result) const;
+                         api::ResultT &result) const;
 };
 }
 }
@@ -5,6 +5,9 @@
 
 #include <algorithm>
 #include <boost/assert.hpp>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -14,7 +17,19 @@ namespace engine
 {
 namespace detail
 {
-std::string encode(std::vector<int> &numbers);
+// Appends the zig-zag coded number in chunks of 5 bits to the output
+inline void encode(const std::int32_t number, std::string &output)
+{
+    auto number_to_encode = (static_cast<std::uint32_t>(number) << 1) ^
+                            static_cast<std::uint32_t>(number < 0 ? -1 : 0);
+    while (number_to_encode >= 0x20)
+    {
+        output.push_back(static_cast<char>((0x20 | (number_to_encode & 0x1f)) + 63));
+        number_to_encode >>= 5;
+    }
+    output.push_back(static_cast<char>(number_to_encode + 63));
+}
+
 std::int32_t decode_polyline_integer(std::string::const_iterator &first,
                                      std::string::const_iterator last);
 }
@@ -22,36 +37,37 @@ using CoordVectorForwardIter = std::vector<util::Coordinate>::const_iterator;
 // Encodes geometry into polyline format.
 // See: https://developers.google.com/maps/documentation/utilities/polylinealgorithm
 
+// Appends the polyline of the geometry to output, without intermediate buffers
 template <unsigned POLYLINE_PRECISION = 100000>
-std::string encodePolyline(CoordVectorForwardIter begin, CoordVectorForwardIter end)
+void encodePolyline(CoordVectorForwardIter begin, CoordVectorForwardIter end, std::string &output)
 {
     double coordinate_to_polyline = POLYLINE_PRECISION / COORDINATE_PRECISION;
-    auto size = std::distance(begin, end);
-    if (size == 0)
-    {
-        return {};
-    }
+    // most deltas of a route geometry take two to four characters
+    output.reserve(output.size() + std::distance(begin, end) * 8);
 
-    std::vector<int> delta_numbers;
-    BOOST_ASSERT(size > 0);
-    delta_numbers.reserve((size - 1) * 2);
     int current_lat = 0;
     int current_lon = 0;
     std::for_each(
         begin,
         end,
-        [&delta_numbers, &current_lat, &current_lon, coordinate_to_polyline](
-            const util::Coordinate loc) {
+        [&output, &current_lat, &current_lon, coordinate_to_polyline](const util::Coordinate loc) {
             const int lat_diff =
                 std::round(static_cast<int>(loc.lat) * coordinate_to_polyline) - current_lat;
             const int lon_diff =
                 std::round(static_cast<int>(loc.lon) * coordinate_to_polyline) - current_lon;
-            delta_numbers.emplace_back(lat_diff);
-            delta_numbers.emplace_back(lon_diff);
+            detail::encode(lat_diff, output);
+            detail::encode(lon_diff, output);
             current_lat += lat_diff;
             current_lon += lon_diff;
         });
-    return detail::encode(delta_numbers);
+}
+
+template <unsigned POLYLINE_PRECISION = 100000>
+std::string encodePolyline(CoordVectorForwardIter begin, CoordVectorForwardIter end)
+{
+    std::string output;
+    encodePolyline<POLYLINE_PRECISION>(begin, end, output);
+    return output;
 }
 
 // Decodes geometry from polyline format
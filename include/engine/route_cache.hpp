@@ -0,0 +1,150 @@
+#ifndef OSRM_ENGINE_ROUTE_CACHE_HPP
+#define OSRM_ENGINE_ROUTE_CACHE_HPP
+
+#include "engine/dataset_cache.hpp"
+#include "engine/internal_route_result.hpp"
+#include "engine/phantom_node.hpp"
+
+#include "util/std_hash.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Everything of a snapped phantom node the path searches and the unpacking of the path depend on.
+// The snapped and input locations are not part of it, they are taken from the current request.
+struct RouteCachePhantom
+{
+    explicit RouteCachePhantom(const PhantomNode &phantom)
+        : forward_node(phantom.forward_segment_id.id), reverse_node(phantom.reverse_segment_id.id),
+          forward_weight(phantom.forward_weight), reverse_weight(phantom.reverse_weight),
+          forward_weight_offset(phantom.forward_weight_offset),
+          reverse_weight_offset(phantom.reverse_weight_offset),
+          forward_duration(phantom.forward_duration), reverse_duration(phantom.reverse_duration),
+          forward_duration_offset(phantom.forward_duration_offset),
+          reverse_duration_offset(phantom.reverse_duration_offset),
+          fwd_segment_position(phantom.fwd_segment_position),
+          flags(static_cast<std::uint8_t>(phantom.forward_segment_id.enabled) |
+                phantom.reverse_segment_id.enabled << 1 | phantom.IsValidForwardSource() << 2 |
+                phantom.IsValidForwardTarget() << 3 | phantom.IsValidReverseSource() << 4 |
+                phantom.IsValidReverseTarget() << 5)
+    {
+    }
+
+    auto Tie() const
+    {
+        return std::tie(forward_node,
+                        reverse_node,
+                        forward_weight,
+                        reverse_weight,
+                        forward_weight_offset,
+                        reverse_weight_offset,
+                        forward_duration,
+                        reverse_duration,
+                        forward_duration_offset,
+                        reverse_duration_offset,
+                        fwd_segment_position,
+                        flags);
+    }
+
+    bool operator==(const RouteCachePhantom &other) const { return Tie() == other.Tie(); }
+
+    NodeID forward_node;
+    NodeID reverse_node;
+    EdgeWeight forward_weight;
+    EdgeWeight reverse_weight;
+    EdgeWeight forward_weight_offset;
+    EdgeWeight reverse_weight_offset;
+    EdgeWeight forward_duration;
+    EdgeWeight reverse_duration;
+    EdgeWeight forward_duration_offset;
+    EdgeWeight reverse_duration_offset;
+    unsigned short fwd_segment_position;
+    std::uint8_t flags;
+};
+
+// Identifies a route by the facade it was computed on, the snapped waypoints and the route
+// parameters that change the searches.
+struct RouteCacheKey
+{
+    RouteCacheKey(const std::uint64_t facade_id,
+                  const std::vector<PhantomNodes> &start_end_nodes,
+                  const std::uint32_t number_of_alternatives,
+                  const boost::optional<bool> continue_straight)
+        : facade_id(facade_id), number_of_alternatives(number_of_alternatives),
+          continue_straight(continue_straight ? static_cast<std::int8_t>(*continue_straight) : -1)
+    {
+        BOOST_ASSERT(!start_end_nodes.empty());
+        phantoms.reserve(start_end_nodes.size() + 1);
+        phantoms.emplace_back(start_end_nodes.front().source_phantom);
+        for (const auto &leg : start_end_nodes)
+        {
+            phantoms.emplace_back(leg.target_phantom);
+        }
+    }
+
+    bool operator==(const RouteCacheKey &other) const
+    {
+        return std::tie(facade_id, number_of_alternatives, continue_straight, phantoms) ==
+               std::tie(other.facade_id,
+                        other.number_of_alternatives,
+                        other.continue_straight,
+                        other.phantoms);
+    }
+
+    std::uint64_t facade_id;
+    // zero if no alternatives are requested
+    std::uint32_t number_of_alternatives;
+    // -1 if not set, the default of the profile is used
+    std::int8_t continue_straight;
+    std::vector<RouteCachePhantom> phantoms;
+};
+
+struct RouteCacheKeyHash
+{
+    std::size_t operator()(const RouteCacheKey &key) const
+    {
+        auto seed = hash_val(key.facade_id, key.number_of_alternatives, key.continue_straight);
+        for (const auto &phantom : key.phantoms)
+        {
+            hash_val(seed,
+                     phantom.forward_node,
+                     phantom.reverse_node,
+                     phantom.forward_weight,
+                     phantom.reverse_weight,
+                     phantom.forward_weight_offset,
+                     phantom.reverse_weight_offset,
+                     phantom.forward_duration,
+                     phantom.reverse_duration,
+                     phantom.forward_duration_offset,
+                     phantom.reverse_duration_offset,
+                     phantom.fwd_segment_position,
+                     phantom.flags);
+        }
+        return seed;
+    }
+};
+
+/**
+ * Thread-safe LRU cache of the routes computed for popular waypoints, they are dropped once a
+ * newer dataset is loaded.
+ *
+ * \see DatasetCache
+ */
+using RouteCache =
+    DatasetCache<RouteCacheKey, std::shared_ptr<const InternalManyRoutesResult>, RouteCacheKeyHash>;
+
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_ROUTE_CACHE_HPP
@@ -2,15 +2,24 @@
 #define OSRM_ENGINE_ROUTING_ALGORITHM_HPP
 
 #include "engine/algorithm.hpp"
+#include "engine/cancellation_token.hpp"
 #include "engine/internal_route_result.hpp"
 #include "engine/phantom_node.hpp"
 #include "engine/routing_algorithms/alternative_path.hpp"
 #include "engine/routing_algorithms/direct_shortest_path.hpp"
 #include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/routing_algorithms/map_matching.hpp"
+#include "engine/routing_algorithms/one_to_all.hpp"
+#include "engine/routing_algorithms/phast.hpp"
 #include "engine/routing_algorithms/shortest_path.hpp"
 #include "engine/routing_algorithms/tile_turns.hpp"
 
+#include "util/exception.hpp"
+#include "util/request_trace.hpp"
+
+#include <numeric>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -21,11 +30,14 @@ class RoutingAlgorithmsInterface
   public:
     virtual InternalManyRoutesResult
     AlternativePathSearch(const PhantomNodes &phantom_node_pair,
-                          unsigned number_of_alternatives) const = 0;
+                          unsigned number_of_alternatives,
+                          const bool parallel,
+                          const routing_algorithms::AlternativeDeadline &deadline = {}) const = 0;
 
     virtual InternalRouteResult
     ShortestPathSearch(const std::vector<PhantomNodes> &phantom_node_pair,
-                       const boost::optional<bool> continue_straight_at_waypoint) const = 0;
+                       const boost::optional<bool> continue_straight_at_waypoint,
+                       const bool parallel) const = 0;
 
     virtual InternalRouteResult
     DirectShortestPathSearch(const PhantomNodes &phantom_node_pair) const = 0;
@@ -33,14 +45,47 @@ class RoutingAlgorithmsInterface
     virtual std::vector<EdgeDuration>
     ManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
                      const std::vector<std::size_t> &source_indices,
-                     const std::vector<std::size_t> &target_indices) const = 0;
+                     const std::vector<std::size_t> &target_indices,
+                     const bool parallel,
+                     routing_algorithms::SearchSpaceCache *search_space_cache) const = 0;
+
+    // Network distances in meters, std::numeric_limits<double>::max() for unreachable pairs
+    virtual std::vector<double>
+    ManyToManyDistances(const std::vector<PhantomNode> &phantom_nodes,
+                        const std::vector<std::size_t> &source_indices,
+                        const std::vector<std::size_t> &target_indices,
+                        const bool parallel) const = 0;
+
+    // Nodes reached from the source within max_duration, the graphs of the CH sweeps are cached
+    virtual std::vector<routing_algorithms::ReachedNode>
+    OneToAllSearch(const PhantomNode &source_phantom,
+                   const EdgeDuration max_duration,
+                   routing_algorithms::PhastGraphCache &phast_graphs) const = 0;
+
+    // Same durations as ManyToManySearch with restricted sweeps instead of buckets, only
+    // available with HasRestrictedManyToManySearch. Pays off for tables with thousands of sources.
+    virtual std::vector<EdgeDuration>
+    RestrictedManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
+                               const std::vector<std::size_t> &source_indices,
+                               const std::vector<std::size_t> &target_indices,
+                               const bool parallel,
+                               routing_algorithms::PhastGraphCache &phast_graphs) const = 0;
+
+    // Upper bounds of the durations through representatives of the cells of the phantom nodes,
+    // only available with HasApproximateManyToManySearch
+    virtual std::vector<EdgeDuration>
+    ApproximateManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
+                                const std::vector<std::size_t> &source_indices,
+                                const std::vector<std::size_t> &target_indices,
+                                const bool parallel) const = 0;
 
     virtual routing_algorithms::SubMatchingList
     MapMatching(const routing_algorithms::CandidateLists &candidates_list,
                 const std::vector<util::Coordinate> &trace_coordinates,
                 const std::vector<unsigned> &trace_timestamps,
                 const std::vector<boost::optional<double>> &trace_gps_precision,
-                const bool allow_splitting) const = 0;
+                const bool allow_splitting,
+                map_matching::MatchingSession *session) const = 0;
 
     virtual std::vector<routing_algorithms::TurnData>
     GetTileTurns(const std::vector<datafacade::BaseDataFacade::RTreeLeaf> &edges,
@@ -48,6 +93,9 @@ class RoutingAlgorithmsInterface
 
     virtual const DataFacadeBase &GetFacade() const = 0;
 
+    // The token of the request or nullptr, the searches above check it while they run
+    virtual const CancellationToken *GetCancellationToken() const = 0;
+
     virtual bool HasAlternativePathSearch() const = 0;
     virtual bool HasShortestPathSearch() const = 0;
     virtual bool HasDirectShortestPathSearch() const = 0;
@@ -55,6 +103,9 @@ class RoutingAlgorithmsInterface
     virtual bool HasManyToManySearch() const = 0;
     virtual bool HasGetTileTurns() const = 0;
     virtual bool HasExcludeFlags() const = 0;
+    virtual bool HasOneToAllSearch() const = 0;
+    virtual bool HasRestrictedManyToManySearch() const = 0;
+    virtual bool HasApproximateManyToManySearch() const = 0;
     virtual bool IsValid() const = 0;
 };
 
@@ -63,8 +114,9 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
 {
   public:
     RoutingAlgorithms(SearchEngineData<Algorithm> &heaps,
-                      std::shared_ptr<const DataFacade<Algorithm>> facade)
-        : heaps(heaps), facade(facade)
+                      std::shared_ptr<const DataFacade<Algorithm>> facade,
+                      std::shared_ptr<const CancellationToken> cancellation_token = nullptr)
+        : heaps(heaps), facade(facade), cancellation_token(std::move(cancellation_token))
     {
     }
 
@@ -72,11 +124,15 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
 
     InternalManyRoutesResult
     AlternativePathSearch(const PhantomNodes &phantom_node_pair,
-                          unsigned number_of_alternatives) const final override;
+                          unsigned number_of_alternatives,
+                          const bool parallel,
+                          const routing_algorithms::AlternativeDeadline &deadline = {}) const
+        final override;
 
-    InternalRouteResult ShortestPathSearch(
-        const std::vector<PhantomNodes> &phantom_node_pair,
-        const boost::optional<bool> continue_straight_at_waypoint) const final override;
+    InternalRouteResult
+    ShortestPathSearch(const std::vector<PhantomNodes> &phantom_node_pair,
+                       const boost::optional<bool> continue_straight_at_waypoint,
+                       const bool parallel) const final override;
 
     InternalRouteResult
     DirectShortestPathSearch(const PhantomNodes &phantom_nodes) const final override;
@@ -84,14 +140,41 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
     std::vector<EdgeDuration>
     ManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
                      const std::vector<std::size_t> &source_indices,
-                     const std::vector<std::size_t> &target_indices) const final override;
+                     const std::vector<std::size_t> &target_indices,
+                     const bool parallel,
+                     routing_algorithms::SearchSpaceCache *search_space_cache) const final override;
+
+    std::vector<double> ManyToManyDistances(const std::vector<PhantomNode> &phantom_nodes,
+                                            const std::vector<std::size_t> &source_indices,
+                                            const std::vector<std::size_t> &target_indices,
+                                            const bool parallel) const final override;
+
+    std::vector<routing_algorithms::ReachedNode>
+    OneToAllSearch(const PhantomNode &source_phantom,
+                   const EdgeDuration max_duration,
+                   routing_algorithms::PhastGraphCache &phast_graphs) const final override;
+
+    std::vector<EdgeDuration>
+    RestrictedManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
+                               const std::vector<std::size_t> &source_indices,
+                               const std::vector<std::size_t> &target_indices,
+                               const bool parallel,
+                               routing_algorithms::PhastGraphCache &phast_graphs) const
+        final override;
+
+    std::vector<EdgeDuration>
+    ApproximateManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
+                                const std::vector<std::size_t> &source_indices,
+                                const std::vector<std::size_t> &target_indices,
+                                const bool parallel) const final override;
 
     routing_algorithms::SubMatchingList
     MapMatching(const routing_algorithms::CandidateLists &candidates_list,
                 const std::vector<util::Coordinate> &trace_coordinates,
                 const std::vector<unsigned> &trace_timestamps,
                 const std::vector<boost::optional<double>> &trace_gps_precision,
-                const bool allow_splitting) const final override;
+                const bool allow_splitting,
+                map_matching::MatchingSession *session) const final override;
 
     std::vector<routing_algorithms::TurnData>
     GetTileTurns(const std::vector<datafacade::BaseDataFacade::RTreeLeaf> &edges,
@@ -99,6 +182,11 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
 
     const DataFacadeBase &GetFacade() const final override { return *facade; }
 
+    const CancellationToken *GetCancellationToken() const final override
+    {
+        return cancellation_token.get();
+    }
+
     bool HasAlternativePathSearch() const final override
     {
         return routing_algorithms::HasAlternativePathSearch<Algorithm>::value;
@@ -134,35 +222,61 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
         return routing_algorithms::HasExcludeFlags<Algorithm>::value;
     }
 
+    bool HasOneToAllSearch() const final override
+    {
+        return routing_algorithms::HasOneToAllSearch<Algorithm>::value;
+    }
+
+    bool HasRestrictedManyToManySearch() const final override
+    {
+        return routing_algorithms::HasRestrictedManyToManySearch<Algorithm>::value;
+    }
+
+    bool HasApproximateManyToManySearch() const final override
+    {
+        return routing_algorithms::HasApproximateManyToManySearch<Algorithm>::value;
+    }
+
     bool IsValid() const final override { return static_cast<bool>(facade); }
 
   private:
     SearchEngineData<Algorithm> &heaps;
     std::shared_ptr<const DataFacade<Algorithm>> facade;
+    std::shared_ptr<const CancellationToken> cancellation_token;
 };
 
 template <typename Algorithm>
 InternalManyRoutesResult
-RoutingAlgorithms<Algorithm>::AlternativePathSearch(const PhantomNodes &phantom_node_pair,
-                                                    unsigned number_of_alternatives) const
+RoutingAlgorithms<Algorithm>::AlternativePathSearch(
+    const PhantomNodes &phantom_node_pair,
+    unsigned number_of_alternatives,
+    const bool parallel,
+    const routing_algorithms::AlternativeDeadline &deadline) const
 {
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
     return routing_algorithms::alternativePathSearch(
-        heaps, *facade, phantom_node_pair, number_of_alternatives);
+        heaps, *facade, phantom_node_pair, number_of_alternatives, parallel, deadline);
 }
 
 template <typename Algorithm>
 InternalRouteResult RoutingAlgorithms<Algorithm>::ShortestPathSearch(
     const std::vector<PhantomNodes> &phantom_node_pair,
-    const boost::optional<bool> continue_straight_at_waypoint) const
+    const boost::optional<bool> continue_straight_at_waypoint,
+    const bool parallel) const
 {
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
     return routing_algorithms::shortestPathSearch(
-        heaps, *facade, phantom_node_pair, continue_straight_at_waypoint);
+        heaps, *facade, phantom_node_pair, continue_straight_at_waypoint, parallel);
 }
 
 template <typename Algorithm>
 InternalRouteResult
 RoutingAlgorithms<Algorithm>::DirectShortestPathSearch(const PhantomNodes &phantom_nodes) const
 {
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
     return routing_algorithms::directShortestPathSearch(heaps, *facade, phantom_nodes);
 }
 
@@ -172,41 +286,181 @@ inline routing_algorithms::SubMatchingList RoutingAlgorithms<Algorithm>::MapMatc
     const std::vector<util::Coordinate> &trace_coordinates,
     const std::vector<unsigned> &trace_timestamps,
     const std::vector<boost::optional<double>> &trace_gps_precision,
-    const bool allow_splitting) const
+    const bool allow_splitting,
+    map_matching::MatchingSession *session) const
 {
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
     return routing_algorithms::mapMatching(heaps,
                                            *facade,
                                            candidates_list,
                                            trace_coordinates,
                                            trace_timestamps,
                                            trace_gps_precision,
-                                           allow_splitting);
+                                           allow_splitting,
+                                           session);
+}
+
+namespace detail
+{
+// Empty indices select all phantom nodes
+inline std::vector<std::size_t> allIndicesIfEmpty(const std::vector<PhantomNode> &phantom_nodes,
+                                                  const std::vector<std::size_t> &indices)
+{
+    if (!indices.empty())
+        return indices;
+
+    std::vector<std::size_t> all_indices(phantom_nodes.size());
+    std::iota(all_indices.begin(), all_indices.end(), 0);
+    return all_indices;
+}
 }
 
 template <typename Algorithm>
 std::vector<EdgeDuration> RoutingAlgorithms<Algorithm>::ManyToManySearch(
     const std::vector<PhantomNode> &phantom_nodes,
-    const std::vector<std::size_t> &_source_indices,
-    const std::vector<std::size_t> &_target_indices) const
+    const std::vector<std::size_t> &source_indices,
+    const std::vector<std::size_t> &target_indices,
+    const bool parallel,
+    routing_algorithms::SearchSpaceCache *search_space_cache) const
 {
     BOOST_ASSERT(!phantom_nodes.empty());
 
-    auto source_indices = _source_indices;
-    auto target_indices = _target_indices;
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
+    return routing_algorithms::manyToManySearch(
+        heaps,
+        *facade,
+        phantom_nodes,
+        detail::allIndicesIfEmpty(phantom_nodes, source_indices),
+        detail::allIndicesIfEmpty(phantom_nodes, target_indices),
+        parallel,
+        search_space_cache);
+}
 
-    if (source_indices.empty())
-    {
-        source_indices.resize(phantom_nodes.size());
-        std::iota(source_indices.begin(), source_indices.end(), 0);
-    }
-    if (target_indices.empty())
-    {
-        target_indices.resize(phantom_nodes.size());
-        std::iota(target_indices.begin(), target_indices.end(), 0);
-    }
+template <typename Algorithm>
+std::vector<double> RoutingAlgorithms<Algorithm>::ManyToManyDistances(
+    const std::vector<PhantomNode> &phantom_nodes,
+    const std::vector<std::size_t> &source_indices,
+    const std::vector<std::size_t> &target_indices,
+    const bool parallel) const
+{
+    BOOST_ASSERT(!phantom_nodes.empty());
 
-    return routing_algorithms::manyToManySearch(
-        heaps, *facade, phantom_nodes, std::move(source_indices), std::move(target_indices));
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
+    return routing_algorithms::getNetworkDistances(
+        heaps,
+        *facade,
+        phantom_nodes,
+        detail::allIndicesIfEmpty(phantom_nodes, source_indices),
+        detail::allIndicesIfEmpty(phantom_nodes, target_indices),
+        INVALID_EDGE_WEIGHT,
+        parallel);
+}
+
+template <typename Algorithm>
+std::vector<routing_algorithms::ReachedNode>
+RoutingAlgorithms<Algorithm>::OneToAllSearch(const PhantomNode &,
+                                             const EdgeDuration,
+                                             routing_algorithms::PhastGraphCache &) const
+{
+    throw util::exception("OneToAllSearch is not implemented");
+}
+
+template <>
+inline std::vector<routing_algorithms::ReachedNode>
+RoutingAlgorithms<routing_algorithms::ch::Algorithm>::OneToAllSearch(
+    const PhantomNode &source_phantom,
+    const EdgeDuration max_duration,
+    routing_algorithms::PhastGraphCache &phast_graphs) const
+{
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
+    const auto phast_graph = phast_graphs.Get(*facade);
+    return routing_algorithms::ch::oneToAllSearch(
+        heaps, *facade, *phast_graph, source_phantom, max_duration);
+}
+
+template <>
+inline std::vector<routing_algorithms::ReachedNode>
+RoutingAlgorithms<routing_algorithms::mld::Algorithm>::OneToAllSearch(
+    const PhantomNode &source_phantom,
+    const EdgeDuration max_duration,
+    routing_algorithms::PhastGraphCache &) const
+{
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
+    return routing_algorithms::mld::oneToAllSearch(heaps, *facade, source_phantom, max_duration);
+}
+
+// The sweeps need the node order of a contraction hierarchy, see HasRestrictedManyToManySearch
+template <typename Algorithm>
+std::vector<EdgeDuration>
+RoutingAlgorithms<Algorithm>::RestrictedManyToManySearch(
+    const std::vector<PhantomNode> &,
+    const std::vector<std::size_t> &,
+    const std::vector<std::size_t> &,
+    const bool,
+    routing_algorithms::PhastGraphCache &) const
+{
+    throw util::exception("RestrictedManyToManySearch is not implemented");
+}
+
+template <>
+inline std::vector<EdgeDuration>
+RoutingAlgorithms<routing_algorithms::ch::Algorithm>::RestrictedManyToManySearch(
+    const std::vector<PhantomNode> &phantom_nodes,
+    const std::vector<std::size_t> &source_indices,
+    const std::vector<std::size_t> &target_indices,
+    const bool parallel,
+    routing_algorithms::PhastGraphCache &phast_graphs) const
+{
+    BOOST_ASSERT(!phantom_nodes.empty());
+
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
+    const auto phast_graph = phast_graphs.Get(*facade);
+    return routing_algorithms::ch::restrictedManyToManySearch(
+        heaps,
+        *facade,
+        *phast_graph,
+        phantom_nodes,
+        detail::allIndicesIfEmpty(phantom_nodes, source_indices),
+        detail::allIndicesIfEmpty(phantom_nodes, target_indices),
+        parallel);
+}
+
+// The representatives are chosen by the cells of the multi-level partition
+template <typename Algorithm>
+std::vector<EdgeDuration>
+RoutingAlgorithms<Algorithm>::ApproximateManyToManySearch(const std::vector<PhantomNode> &,
+                                                          const std::vector<std::size_t> &,
+                                                          const std::vector<std::size_t> &,
+                                                          const bool) const
+{
+    throw util::exception("ApproximateManyToManySearch is not implemented");
+}
+
+template <>
+inline std::vector<EdgeDuration>
+RoutingAlgorithms<routing_algorithms::mld::Algorithm>::ApproximateManyToManySearch(
+    const std::vector<PhantomNode> &phantom_nodes,
+    const std::vector<std::size_t> &source_indices,
+    const std::vector<std::size_t> &target_indices,
+    const bool parallel) const
+{
+    BOOST_ASSERT(!phantom_nodes.empty());
+
+    const CancellationScope scope(cancellation_token.get());
+    const util::TraceSpan span("search");
+    return routing_algorithms::mld::approximateManyToManySearch(
+        heaps,
+        *facade,
+        phantom_nodes,
+        detail::allIndicesIfEmpty(phantom_nodes, source_indices),
+        detail::allIndicesIfEmpty(phantom_nodes, target_indices),
+        parallel);
 }
 
 template <typename Algorithm>
@@ -9,6 +9,8 @@
 
 #include "util/exception.hpp"
 
+#include <chrono>
+
 namespace osrm
 {
 namespace engine
@@ -16,15 +18,40 @@ namespace engine
 namespace routing_algorithms
 {
 
+/**
+ * Bounds the time spent on alternatives. The shortest route is always searched to the end, the
+ * search space is only widened and candidates are only evaluated until the deadline passed, so
+ * the alternatives found before it are returned.
+ */
+class AlternativeDeadline
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // never passes
+    AlternativeDeadline() : deadline(Clock::time_point::max()) {}
+    explicit AlternativeDeadline(const Clock::time_point deadline) : deadline(deadline) {}
+
+    // Reads the clock, callers in hot loops only check every few iterations
+    bool Passed() const { return deadline != Clock::time_point::max() && Clock::now() >= deadline; }
+
+  private:
+    Clock::time_point deadline;
+};
+
 InternalManyRoutesResult alternativePathSearch(SearchEngineData<ch::Algorithm> &search_engine_data,
                                                const DataFacade<ch::Algorithm> &facade,
                                                const PhantomNodes &phantom_node_pair,
-                                               unsigned number_of_alternatives);
+                                               unsigned number_of_alternatives,
+                                               const bool parallel,
+                                               const AlternativeDeadline &deadline = {});
 
 InternalManyRoutesResult alternativePathSearch(SearchEngineData<mld::Algorithm> &search_engine_data,
                                                const DataFacade<mld::Algorithm> &facade,
                                                const PhantomNodes &phantom_node_pair,
-                                               unsigned number_of_alternatives);
+                                               unsigned number_of_alternatives,
+                                               const bool parallel,
+                                               const AlternativeDeadline &deadline = {});
 
 } // namespace routing_algorithms
 } // namespace engine
@@ -2,11 +2,25 @@
 #define MANY_TO_MANY_ROUTING_HPP
 
 #include "engine/algorithm.hpp"
+#include "engine/cancellation_token.hpp"
 #include "engine/datafacade.hpp"
+#include "engine/routing_algorithms/search_space_cache.hpp"
 #include "engine/search_engine_data.hpp"
 
+#include "util/search_counters.hpp"
 #include "util/typedefs.hpp"
 
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <tuple>
 #include <vector>
 
 namespace osrm
@@ -21,17 +35,26 @@ namespace
 struct NodeBucket
 {
     NodeID middle_node;
+    NodeID parent_node;    // the predecessor of middle_node on the path towards the target
     unsigned column_index; // a column in the weight/duration matrix
     EdgeWeight weight;
     EdgeDuration duration;
 
-    NodeBucket(NodeID middle_node, unsigned column_index, EdgeWeight weight, EdgeDuration duration)
-        : middle_node(middle_node), column_index(column_index), weight(weight), duration(duration)
+    NodeBucket(NodeID middle_node,
+               NodeID parent_node,
+               unsigned column_index,
+               EdgeWeight weight,
+               EdgeDuration duration)
+        : middle_node(middle_node), parent_node(parent_node), column_index(column_index),
+          weight(weight), duration(duration)
     {
     }
 
     // partial order comparison
-    bool operator<(const NodeBucket &rhs) const { return middle_node < rhs.middle_node; }
+    bool operator<(const NodeBucket &rhs) const
+    {
+        return std::tie(middle_node, column_index) < std::tie(rhs.middle_node, rhs.column_index);
+    }
 
     // functor for equal_range
     struct Compare
@@ -46,15 +69,314 @@ struct NodeBucket
             return lhs < rhs.middle_node;
         }
     };
+
+    // functor for equal_range of a single (middle_node, column_index) bucket
+    struct ColumnCompare
+    {
+        unsigned column_index;
+
+        ColumnCompare(unsigned column_index) : column_index(column_index) {}
+
+        bool operator()(const NodeBucket &lhs, const NodeID &rhs) const
+        {
+            return std::tie(lhs.middle_node, lhs.column_index) < std::tie(rhs, column_index);
+        }
+
+        bool operator()(const NodeID &lhs, const NodeBucket &rhs) const
+        {
+            return std::tie(lhs, column_index) < std::tie(rhs.middle_node, rhs.column_index);
+        }
+    };
+};
+
+// Read-only struct-of-arrays index of sorted buckets for the forward scans.
+//
+// The buckets of one middle node are stored contiguously (CSR) and the runs are found with an
+// open addressing hash table of (middle_node, begin, end) slots, so a lookup for a settled node
+// is usually a single cache line probe instead of a binary search over all buckets.
+// Parent nodes are not stored, use the bucket vector if paths have to be retrieved.
+class NodeBucketIndex
+{
+  public:
+    struct Range
+    {
+        std::uint32_t begin;
+        std::uint32_t end;
+
+        bool empty() const { return begin == end; }
+        std::uint32_t size() const { return end - begin; }
+    };
+
+    NodeBucketIndex() = default;
+
+    // buckets must be sorted by middle node, e.g. by computeSearchSpaceWithBuckets
+    explicit NodeBucketIndex(const std::vector<NodeBucket> &sorted_buckets)
+    {
+        BOOST_ASSERT(std::is_sorted(sorted_buckets.begin(),
+                                    sorted_buckets.end(),
+                                    [](const NodeBucket &lhs, const NodeBucket &rhs) {
+                                        return lhs.middle_node < rhs.middle_node;
+                                    }));
+
+        columns.reserve(sorted_buckets.size());
+        weights.reserve(sorted_buckets.size());
+        durations.reserve(sorted_buckets.size());
+
+        std::size_t number_of_nodes = 0;
+        for (std::size_t index = 0; index < sorted_buckets.size(); ++index)
+        {
+            if (index == 0 ||
+                sorted_buckets[index - 1].middle_node != sorted_buckets[index].middle_node)
+                ++number_of_nodes;
+        }
+
+        // keep the load factor at or below 1/2 to keep the probe sequences short
+        std::size_t number_of_slots = 2;
+        while (number_of_slots < 2 * number_of_nodes)
+            number_of_slots *= 2;
+        slot_mask = number_of_slots - 1;
+        slots.resize(number_of_slots, Slot{SPECIAL_NODEID, 0, 0});
+
+        std::size_t current_slot = 0;
+        for (const auto &bucket : sorted_buckets)
+        {
+            const auto position = static_cast<std::uint32_t>(columns.size());
+            if (position == 0 || slots[current_slot].node != bucket.middle_node)
+            {
+                current_slot = FindSlot(bucket.middle_node);
+                BOOST_ASSERT(slots[current_slot].node == SPECIAL_NODEID);
+                slots[current_slot] = Slot{bucket.middle_node, position, position};
+            }
+            ++slots[current_slot].end;
+
+            columns.push_back(bucket.column_index);
+            weights.push_back(bucket.weight);
+            durations.push_back(bucket.duration);
+        }
+    }
+
+    Range Find(const NodeID node) const
+    {
+        if (slots.empty())
+            return Range{0, 0};
+
+        const auto &slot = slots[FindSlot(node)];
+        return slot.node == node ? Range{slot.begin, slot.end} : Range{0, 0};
+    }
+
+    std::size_t Size() const { return columns.size(); }
+
+    // contiguous arrays for kernels that process a whole range, see minPlusRow
+    const unsigned *GetColumns() const { return columns.data(); }
+    const EdgeWeight *GetWeights() const { return weights.data(); }
+    const EdgeDuration *GetDurations() const { return durations.data(); }
+
+    unsigned GetColumn(const std::uint32_t position) const { return columns[position]; }
+    EdgeWeight GetWeight(const std::uint32_t position) const { return weights[position]; }
+    EdgeDuration GetDuration(const std::uint32_t position) const { return durations[position]; }
+
+  private:
+    struct Slot
+    {
+        NodeID node;
+        std::uint32_t begin;
+        std::uint32_t end;
+    };
+
+    // Fibonacci hashing spreads consecutive node ids over the table
+    std::size_t FindSlot(const NodeID node) const
+    {
+        auto slot = (static_cast<std::uint64_t>(node) * 0x9E3779B97F4A7C15ull >> 32) & slot_mask;
+        while (slots[slot].node != node && slots[slot].node != SPECIAL_NODEID)
+            slot = (slot + 1) & slot_mask;
+        return slot;
+    }
+
+    std::vector<Slot> slots;
+    std::size_t slot_mask = 0;
+    std::vector<unsigned> columns;
+    std::vector<EdgeWeight> weights;
+    std::vector<EdgeDuration> durations;
 };
+
+// Runs body(range) for ranges of single indices below size across the current TBB task arena.
+// The arena threads check the cancellation token of the calling thread. A cancelled request
+// stops the remaining ranges and is rethrown on the calling thread, so RequestCancelled never
+// has to pass through TBB. With search counters the counts of the searches on the arena threads
+// are added to the counters of the calling thread, so they show up for the request.
+template <typename Body> void parallelForEach(const std::size_t size, const Body &body)
+{
+    const tbb::blocked_range<std::uint32_t> indices(0, size, 1);
+    const auto token = currentCancellationToken();
+    std::atomic<bool> cancelled{false};
+    const auto cancellable_body = [&](const tbb::blocked_range<std::uint32_t> &range) {
+        if (cancelled)
+            return;
+        const CancellationScope scope(token);
+        try
+        {
+            body(range);
+        }
+        catch (const RequestCancelled &)
+        {
+            cancelled = true;
+        }
+    };
+
+#ifdef OSRM_ENABLE_SEARCH_COUNTERS
+    tbb::enumerable_thread_specific<util::SearchCounters> worker_counters;
+    tbb::parallel_for(indices, [&](const tbb::blocked_range<std::uint32_t> &range) {
+        worker_counters.local() += util::countSearches([&] { cancellable_body(range); });
+    });
+    for (const auto &counters : worker_counters)
+    {
+        util::threadSearchCounters() += counters;
+    }
+#else
+    tbb::parallel_for(indices, cancellable_body);
+#endif
+
+    if (cancelled)
+    {
+        throw RequestCancelled();
+    }
+}
+
+// Runs backward_search(column_idx, buckets) for all target columns and returns the buckets
+// ordered for lookups. In parallel mode the columns are split across the current TBB task arena
+// and each worker collects its buckets separately, the query heaps are thread-local anyway.
+template <typename BackwardSearch>
+std::vector<NodeBucket> computeSearchSpaceWithBuckets(const std::size_t number_of_targets,
+                                                      const bool parallel,
+                                                      const BackwardSearch &backward_search)
+{
+    std::vector<NodeBucket> search_space_with_buckets;
+
+    if (!parallel)
+    {
+        for (std::uint32_t column_idx = 0; column_idx < number_of_targets; ++column_idx)
+        {
+            backward_search(column_idx, search_space_with_buckets);
+        }
+        std::sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+        return search_space_with_buckets;
+    }
+
+    tbb::enumerable_thread_specific<std::vector<NodeBucket>> worker_buckets;
+    parallelForEach(number_of_targets, [&](const tbb::blocked_range<std::uint32_t> &range) {
+        auto &buckets = worker_buckets.local();
+        for (auto column_idx = range.begin(); column_idx != range.end(); ++column_idx)
+        {
+            backward_search(column_idx, buckets);
+        }
+    });
+
+    std::size_t number_of_buckets = 0;
+    for (const auto &buckets : worker_buckets)
+    {
+        number_of_buckets += buckets.size();
+    }
+    search_space_with_buckets.reserve(number_of_buckets);
+    for (const auto &buckets : worker_buckets)
+    {
+        search_space_with_buckets.insert(
+            search_space_with_buckets.end(), buckets.begin(), buckets.end());
+    }
+
+    // (middle_node, column_index) is unique, so the order does not depend on the scheduling
+    tbb::parallel_sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+    return search_space_with_buckets;
+}
+
+// Runs forward_search(row_idx) for all source rows, in parallel mode split across the current
+// TBB task arena. Every row only writes its own entries of the result tables.
+template <typename ForwardSearch>
+void forEachSourceRow(const std::size_t number_of_sources,
+                      const bool parallel,
+                      const ForwardSearch &forward_search)
+{
+    if (!parallel)
+    {
+        for (std::uint32_t row_idx = 0; row_idx < number_of_sources; ++row_idx)
+        {
+            forward_search(row_idx);
+        }
+        return;
+    }
+
+    parallelForEach(number_of_sources, [&](const tbb::blocked_range<std::uint32_t> &range) {
+        for (auto row_idx = range.begin(); row_idx != range.end(); ++row_idx)
+        {
+            forward_search(row_idx);
+        }
+    });
 }
+}
+
+// Min-plus update of one row with a contiguous run of buckets: for every bucket the entry at
+// offset + column * stride is set to (source + bucket) weight and duration if this is smaller.
+// Candidates with a negative weight are skipped, returns true if there were any.
+// Uses AVX2 if the CPU supports it.
+bool minPlusRow(const EdgeWeight source_weight,
+                const EdgeDuration source_duration,
+                const unsigned *columns,
+                const EdgeWeight *weights,
+                const EdgeDuration *durations,
+                const std::size_t size,
+                const std::size_t offset,
+                const std::size_t stride,
+                std::vector<EdgeWeight> &weights_table,
+                std::vector<EdgeDuration> &durations_table);
 
+// With parallel set the bucket generation and the forward searches are split across the
+// TBB task arena of the calling thread, see TablePlugin.
+// If search_space_cache is set the settled nodes of the bucket and row searches are taken from
+// and added to the cache, only used for the bidirectional searches of many-to-many tables.
 template <typename Algorithm>
 std::vector<EdgeDuration> manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
                                            const DataFacade<Algorithm> &facade,
                                            const std::vector<PhantomNode> &phantom_nodes,
                                            const std::vector<std::size_t> &source_indices,
-                                           const std::vector<std::size_t> &target_indices);
+                                           const std::vector<std::size_t> &target_indices,
+                                           const bool parallel,
+                                           SearchSpaceCache *search_space_cache);
+
+// Computes the network distances in meters for all pairs of sources and targets.
+// The graph edges carry no distances, so in contrast to manyToManySearch the packed path of every
+// pair is unpacked while the forward search space of its row is still available. That is still
+// one search per source and target, used for the transitions between map matching candidates
+// and for the distance tables.
+// Pairs without a path of weight below weight_upper_bound get std::numeric_limits<double>::max().
+// With parallel set the searches are split across the TBB task arena of the calling thread.
+template <typename Algorithm>
+std::vector<double> getNetworkDistances(SearchEngineData<Algorithm> &engine_working_data,
+                                        const DataFacade<Algorithm> &facade,
+                                        const std::vector<PhantomNode> &phantom_nodes,
+                                        const std::vector<std::size_t> &source_indices,
+                                        const std::vector<std::size_t> &target_indices,
+                                        const EdgeWeight weight_upper_bound,
+                                        const bool parallel);
+
+namespace mld
+{
+// Approximate durations table for very large matrices. The sources and the targets are grouped
+// by their cells on the lowest level of the partition with few enough cells, and the exact
+// table is only computed between the first phantom node of every group, its representative.
+// The other phantom nodes are connected to their representatives by searches that end once the
+// few phantoms of the group are reached.
+//
+// An entry is the duration of a path from the source via the representatives to the target,
+// so it is never below the exact duration and exceeds it by at most the round trips between
+// the source and the target and the representatives of their cells.
+// With parallel set the searches are split across the TBB task arena of the calling thread.
+std::vector<EdgeDuration>
+approximateManyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                            const DataFacade<Algorithm> &facade,
+                            const std::vector<PhantomNode> &phantom_nodes,
+                            const std::vector<std::size_t> &source_indices,
+                            const std::vector<std::size_t> &target_indices,
+                            const bool parallel);
+} // namespace mld
 
 } // namespace routing_algorithms
 } // namespace engine
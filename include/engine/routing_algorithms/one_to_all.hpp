@@ -0,0 +1,47 @@
+#ifndef OSRM_ENGINE_ROUTING_ALGORITHMS_ONE_TO_ALL_HPP
+#define OSRM_ENGINE_ROUTING_ALGORITHMS_ONE_TO_ALL_HPP
+
+#include "engine/algorithm.hpp"
+#include "engine/datafacade.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/search_engine_data.hpp"
+
+#include "util/typedefs.hpp"
+
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+// A node of a one-to-all search with the weight and the duration of its shortest path
+struct ReachedNode
+{
+    NodeID node;
+    EdgeWeight weight;
+    EdgeDuration duration;
+};
+
+namespace mld
+{
+
+// Nodes reached from the source phantom with a duration of at most max_duration, in no
+// particular order. The weights and durations are those of the start of the nodes.
+//
+// The search runs on the overlay graph of the source first. Cells whose border nodes are all
+// reached are taken as reached as a whole and only contribute their border nodes, the other
+// cells the search entered are searched again on the level below, down to the base graph.
+std::vector<ReachedNode> oneToAllSearch(SearchEngineData<Algorithm> &engine_working_data,
+                                        const DataFacade<Algorithm> &facade,
+                                        const PhantomNode &source_phantom,
+                                        const EdgeDuration max_duration);
+
+} // namespace mld
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_ROUTING_ALGORITHMS_ONE_TO_ALL_HPP
@@ -0,0 +1,176 @@
+#ifndef OSRM_ENGINE_ROUTING_ALGORITHMS_PARALLEL_SEARCH_STATE_HPP
+#define OSRM_ENGINE_ROUTING_ALGORITHMS_PARALLEL_SEARCH_STATE_HPP
+
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+/**
+ * Keys of the nodes reached by one half of a parallel bidirectional search.
+ *
+ * Only the half owning the table writes to it while the other half looks up the nodes it
+ * reaches. Open addressing with linear probing and without deletions so that lookups never
+ * lock, Clear only resets the used slots once both halves are done.
+ */
+class ConcurrentNodeWeights
+{
+  public:
+    explicit ConcurrentNodeWeights(const std::size_t capacity)
+        : slots(new Slot[capacity]), mask(capacity - 1)
+    {
+        BOOST_ASSERT(capacity > 0 && (capacity & mask) == 0);
+        for (std::size_t index = 0; index < capacity; ++index)
+        {
+            slots[index].node.store(SPECIAL_NODEID, std::memory_order_relaxed);
+        }
+    }
+
+    // Returns false if the table is too full to add another node
+    bool Set(const NodeID node, const EdgeWeight weight)
+    {
+        for (auto index = Hash(node);; index = (index + 1) & mask)
+        {
+            auto &slot = slots[index];
+            const auto slot_node = slot.node.load(std::memory_order_relaxed);
+            if (slot_node == node)
+            {
+                slot.weight.store(weight);
+                return true;
+            }
+            if (slot_node == SPECIAL_NODEID)
+            {
+                // keeps probe sequences short
+                if (used_slots.size() >= (mask + 1) / 2)
+                    return false;
+                // the weight has to be visible before the node
+                slot.weight.store(weight);
+                slot.node.store(node);
+                used_slots.push_back(index);
+                return true;
+            }
+        }
+    }
+
+    // Returns INVALID_EDGE_WEIGHT if the node was not reached
+    EdgeWeight Get(const NodeID node) const
+    {
+        for (auto index = Hash(node);; index = (index + 1) & mask)
+        {
+            const auto &slot = slots[index];
+            const auto slot_node = slot.node.load();
+            if (slot_node == node)
+                return slot.weight.load();
+            if (slot_node == SPECIAL_NODEID)
+                return INVALID_EDGE_WEIGHT;
+        }
+    }
+
+    // Must not run concurrently with Get
+    void Clear()
+    {
+        for (const auto index : used_slots)
+        {
+            slots[index].node.store(SPECIAL_NODEID, std::memory_order_relaxed);
+        }
+        used_slots.clear();
+    }
+
+  private:
+    struct Slot
+    {
+        std::atomic<NodeID> node;
+        std::atomic<EdgeWeight> weight;
+    };
+
+    std::size_t Hash(const NodeID node) const
+    {
+        // Fibonacci hashing spreads the consecutive ids of neighbouring nodes
+        return (static_cast<std::uint64_t>(node) * 0x9E3779B97F4A7C15ull >> 32) & mask;
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    const std::size_t mask;
+    std::vector<std::size_t> used_slots;
+};
+
+/**
+ * Everything the forward and the reverse half of a parallel bidirectional search share: the
+ * keys of the reached nodes, the smallest keys of both heaps and the best path found so far.
+ *
+ * All atomics use sequential consistency. A half first publishes the key of a node and then
+ * looks it up in the other table, so for each node reached by both halves at least one of them
+ * sees both keys and updates the upper bound.
+ */
+struct ParallelSearchState
+{
+    // per half, the tables are never shrunk and hold this many nodes at most
+    static constexpr std::size_t MAX_REACHED_NODES = 1 << 18;
+
+    ParallelSearchState()
+        : reached{{ConcurrentNodeWeights(2 * MAX_REACHED_NODES),
+                   ConcurrentNodeWeights(2 * MAX_REACHED_NODES)}}
+    {
+    }
+
+    void Reset(const EdgeWeight weight_upper_bound,
+               const EdgeWeight forward_min,
+               const EdgeWeight reverse_min)
+    {
+        reached[0].Clear();
+        reached[1].Clear();
+        min_keys[0] = forward_min;
+        min_keys[1] = reverse_min;
+        upper_bound = weight_upper_bound;
+        middle = SPECIAL_NODEID;
+        stop = false;
+    }
+
+    // both halves stop once the smallest keys of their heaps add up to the upper bound
+    bool IsDone() const
+    {
+        return stop || static_cast<std::int64_t>(min_keys[0]) + min_keys[1] >= upper_bound;
+    }
+
+    void UpdateUpperBound(const NodeID node, const EdgeWeight path_weight)
+    {
+        if (path_weight >= upper_bound)
+            return;
+
+        std::lock_guard<std::mutex> lock(middle_mutex);
+        if (path_weight < upper_bound)
+        {
+            middle = node;
+            upper_bound = path_weight;
+        }
+    }
+
+    std::array<ConcurrentNodeWeights, 2> reached;
+    std::array<std::atomic<EdgeWeight>, 2> min_keys;
+    std::atomic<EdgeWeight> upper_bound;
+    // guarded by middle_mutex, together with updates of upper_bound
+    NodeID middle;
+    std::mutex middle_mutex;
+    // set if a half can not continue, e.g. its table is full or the request was cancelled
+    std::atomic<bool> stop;
+};
+
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_ROUTING_ALGORITHMS_PARALLEL_SEARCH_STATE_HPP
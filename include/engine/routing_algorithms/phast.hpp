@@ -0,0 +1,78 @@
+#ifndef OSRM_ENGINE_ROUTING_ALGORITHMS_PHAST_HPP
+#define OSRM_ENGINE_ROUTING_ALGORITHMS_PHAST_HPP
+
+#include "engine/algorithm.hpp"
+#include "engine/datafacade.hpp"
+#include "engine/dataset_cache.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/routing_algorithms/one_to_all.hpp"
+#include "engine/routing_algorithms/phast_graph.hpp"
+#include "engine/search_engine_data.hpp"
+
+#include "util/typedefs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+/**
+ * Thread-safe cache of the PHAST graphs of the facades, one per set of excluded classes.
+ *
+ * Building a graph takes a pass over the whole query graph, so only one thread builds while the
+ * others wait for it. The graphs are dropped once a newer dataset is loaded.
+ */
+class PhastGraphCache
+{
+  public:
+    explicit PhastGraphCache(const std::size_t capacity) : graphs(capacity, 1) {}
+
+    std::shared_ptr<const ch::PhastGraph> Get(const DataFacade<ch::Algorithm> &facade);
+
+  private:
+    std::mutex build_mutex;
+    DatasetCache<std::uint64_t, std::shared_ptr<const ch::PhastGraph>, std::hash<std::uint64_t>>
+        graphs;
+};
+
+namespace ch
+{
+
+// All nodes reached from the source phantom with a duration of at most max_duration, in the
+// order of the phast_graph sweep. The weights and durations are those of the start of the nodes.
+std::vector<ReachedNode> oneToAllSearch(SearchEngineData<Algorithm> &engine_working_data,
+                                        const DataFacade<Algorithm> &facade,
+                                        const PhastGraph &phast_graph,
+                                        const PhantomNode &source_phantom,
+                                        const EdgeDuration max_duration);
+
+// Durations table of the sources and targets like manyToManySearch, but with restricted PHAST
+// sweeps instead of buckets: the part of phast_graph above the targets is selected once, then
+// PHAST_LANES sources at a time are swept over it. Faster than the buckets for tables with
+// thousands of sources and targets, whose buckets don't fit into memory.
+// With parallel set the batches of sources are split across the TBB task arena of the calling
+// thread.
+std::vector<EdgeDuration>
+restrictedManyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                           const DataFacade<Algorithm> &facade,
+                           const PhastGraph &phast_graph,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const std::vector<std::size_t> &target_indices,
+                           const bool parallel);
+
+} // namespace ch
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_ROUTING_ALGORITHMS_PHAST_HPP
@@ -0,0 +1,433 @@
+#ifndef OSRM_ENGINE_ROUTING_ALGORITHMS_PHAST_GRAPH_HPP
+#define OSRM_ENGINE_ROUTING_ALGORITHMS_PHAST_GRAPH_HPP
+
+#include "engine/cancellation_token.hpp"
+
+#include "util/exception.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+namespace ch
+{
+
+/**
+ * Downward edges of a contraction hierarchy laid out for the linear sweeps of PHAST.
+ *
+ * Every edge of a CH query graph is stored at its lower node and points upwards, so the graph
+ * is a DAG. The nodes are ordered by their level, i.e. the length of the longest upward path
+ * from a node, from the top down. A node's position is always after the positions of all the
+ * nodes above it. A single pass over the positions therefore settles all nodes once the labels
+ * of an upward search are set. The incoming downward edges of a position are stored
+ * contiguously and refer to the positions of their sources, so the pass reads the edges in order,
+ * writes the labels in order and never looks at the query graph.
+ *
+ * Built once per facade, see PhastGraphCache.
+ */
+class PhastGraph
+{
+  public:
+    struct Edge
+    {
+        std::uint32_t source; // position of the higher node
+        EdgeWeight weight;
+        EdgeDuration duration;
+    };
+
+    struct EdgeRange
+    {
+        const Edge *begin() const { return first; }
+        const Edge *end() const { return last; }
+
+        const Edge *first;
+        const Edge *last;
+    };
+
+    PhastGraph() = default;
+
+    // GraphT is a CH query graph like the CH data facade or a util::StaticGraph of
+    // contractor::QueryEdge::EdgeData. Throws if the graph has a cycle, i.e. is no hierarchy.
+    template <typename GraphT> explicit PhastGraph(const GraphT &graph)
+    {
+        const auto number_of_nodes = graph.GetNumberOfNodes();
+        const auto levels = computeLevels(graph);
+
+        // counting sort by level, nodes of a level stay ordered by id
+        const auto number_of_levels =
+            levels.empty() ? 0 : *std::max_element(levels.begin(), levels.end()) + 1;
+        std::vector<std::uint32_t> level_begin(number_of_levels + 1, 0);
+        for (const auto level : levels)
+            ++level_begin[level + 1];
+        std::partial_sum(level_begin.begin(), level_begin.end(), level_begin.begin());
+
+        nodes.resize(number_of_nodes);
+        positions.resize(number_of_nodes);
+        for (NodeID node = 0; node < number_of_nodes; ++node)
+        {
+            const auto position = level_begin[levels[node]]++;
+            nodes[position] = node;
+            positions[node] = position;
+        }
+
+        first_edges.reserve(number_of_nodes + 1);
+        first_edges.push_back(0);
+        for (std::uint32_t position = 0; position < number_of_nodes; ++position)
+        {
+            const auto node = nodes[position];
+            const auto first_edge = edges.size();
+            for (const auto edge : graph.GetAdjacentEdgeRange(node))
+            {
+                const auto &data = graph.GetEdgeData(edge);
+                const auto target = graph.GetTarget(edge);
+                // backward edges of the lower node are the downward edges of the higher node
+                if (data.backward && target != node)
+                {
+                    BOOST_ASSERT(positions[target] < position);
+                    edges.push_back({positions[target], data.weight, data.duration});
+                }
+            }
+            std::sort(edges.begin() + first_edge,
+                      edges.end(),
+                      [](const Edge &lhs, const Edge &rhs) { return lhs.source < rhs.source; });
+            first_edges.push_back(static_cast<std::uint32_t>(edges.size()));
+        }
+    }
+
+    std::uint32_t GetNumberOfNodes() const { return static_cast<std::uint32_t>(nodes.size()); }
+
+    NodeID GetNode(const std::uint32_t position) const { return nodes[position]; }
+
+    std::uint32_t GetPosition(const NodeID node) const { return positions[node]; }
+
+    EdgeRange GetIncomingEdges(const std::uint32_t position) const
+    {
+        return EdgeRange{edges.data() + first_edges[position],
+                         edges.data() + first_edges[position + 1]};
+    }
+
+  private:
+    // Level 0 for nodes without upward edges, otherwise one more than the highest level of the
+    // upward neighbours. Iterative depth first search, recursion would overflow the stack.
+    template <typename GraphT> static std::vector<std::uint32_t> computeLevels(const GraphT &graph)
+    {
+        const auto UNVISITED = std::numeric_limits<std::uint32_t>::max();
+        const auto ON_STACK = UNVISITED - 1;
+
+        std::vector<std::uint32_t> levels(graph.GetNumberOfNodes(), UNVISITED);
+
+        // the iterators skip the edges removed by the exclude filters of the facade
+        using EdgeIterator = decltype(graph.GetAdjacentEdgeRange(NodeID{0}).begin());
+        struct StackEntry
+        {
+            NodeID node;
+            EdgeIterator edge;
+            EdgeIterator end;
+        };
+        std::vector<StackEntry> stack;
+        const auto push = [&](const NodeID node) {
+            levels[node] = ON_STACK;
+            const auto range = graph.GetAdjacentEdgeRange(node);
+            stack.push_back({node, range.begin(), range.end()});
+        };
+
+        for (NodeID root = 0; root < graph.GetNumberOfNodes(); ++root)
+        {
+            if (levels[root] != UNVISITED)
+                continue;
+
+            push(root);
+            while (!stack.empty())
+            {
+                auto &entry = stack.back();
+                const auto node = entry.node;
+
+                // skip the neighbours that are done already
+                while (entry.edge != entry.end && (graph.GetTarget(*entry.edge) == node ||
+                                                   levels[graph.GetTarget(*entry.edge)] < ON_STACK))
+                    ++entry.edge;
+
+                if (entry.edge == entry.end)
+                {
+                    std::uint32_t level = 0;
+                    for (const auto edge : graph.GetAdjacentEdgeRange(node))
+                    {
+                        const auto target = graph.GetTarget(edge);
+                        if (target != node)
+                            level = std::max(level, levels[target] + 1);
+                    }
+                    levels[node] = level;
+                    stack.pop_back();
+                    continue;
+                }
+
+                const auto target = graph.GetTarget(*entry.edge);
+                if (levels[target] == ON_STACK)
+                    throw util::exception("The contraction hierarchy has a cycle at node " +
+                                          std::to_string(target));
+                push(target);
+            }
+        }
+
+        return levels;
+    }
+
+    std::vector<NodeID> nodes;
+    std::vector<std::uint32_t> positions;
+    std::vector<std::uint32_t> first_edges;
+    std::vector<Edge> edges;
+};
+
+// Labels of all nodes of a PHAST sweep indexed by their position in the PhastGraph.
+// Kept per thread since they have the size of the graph, see SearchEngineData.
+struct PhastLabels
+{
+    std::vector<EdgeWeight> weights;
+    std::vector<EdgeDuration> durations;
+
+    void Reset(const std::size_t number_of_nodes)
+    {
+        weights.assign(number_of_nodes, INVALID_EDGE_WEIGHT);
+        durations.assign(number_of_nodes, MAXIMAL_EDGE_DURATION);
+    }
+};
+
+// Settles the upward search space of the nodes in query_heap and calls settle(node, weight,
+// duration) for every node. Without stalling, the sweeps need the labels of all nodes above.
+template <typename GraphT, typename HeapT, typename SettleT>
+void upwardSearch(const GraphT &graph, HeapT &query_heap, const SettleT &settle)
+{
+    while (!query_heap.Empty())
+    {
+        const auto node = query_heap.DeleteMin();
+        const auto weight = query_heap.GetKey(node);
+        const auto duration = query_heap.GetData(node).duration;
+        settle(node, weight, duration);
+
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = graph.GetEdgeData(edge);
+            if (!data.forward)
+                continue;
+
+            const auto to = graph.GetTarget(edge);
+            const auto to_weight = weight + data.weight;
+            const auto to_duration = duration + data.duration;
+            if (!query_heap.WasInserted(to))
+            {
+                query_heap.Insert(to, to_weight, {node, to_duration});
+            }
+            else if (!query_heap.WasRemoved(to) &&
+                     std::tie(to_weight, to_duration) <
+                         std::tie(query_heap.GetKey(to), query_heap.GetData(to).duration))
+            {
+                query_heap.GetData(to) = {node, to_duration};
+                query_heap.DecreaseKey(to, to_weight);
+            }
+        }
+    }
+}
+
+// PHAST one-to-all search (Delling et al., 2011). The source phantom is already inserted into
+// the query heap. An upward search sets the labels of the nodes above the source, the sweep over
+// the positions of phast_graph then relaxes all downward edges in topological order. Afterwards
+// labels holds the shortest weights, and the durations of the paths with these weights, of all
+// nodes.
+template <typename GraphT, typename HeapT>
+void phastSearch(const GraphT &graph,
+                 const PhastGraph &phast_graph,
+                 HeapT &query_heap,
+                 PhastLabels &labels)
+{
+    const auto number_of_nodes = phast_graph.GetNumberOfNodes();
+    labels.Reset(number_of_nodes);
+    auto &weights = labels.weights;
+    auto &durations = labels.durations;
+
+    upwardSearch(graph,
+                 query_heap,
+                 [&](const NodeID node, const EdgeWeight weight, const EdgeDuration duration) {
+                     const auto position = phast_graph.GetPosition(node);
+                     weights[position] = weight;
+                     durations[position] = duration;
+                 });
+
+    for (std::uint32_t position = 0; position < number_of_nodes; ++position)
+    {
+        checkCancellation();
+
+        auto weight = weights[position];
+        auto duration = durations[position];
+        for (const auto &edge : phast_graph.GetIncomingEdges(position))
+        {
+            const auto source_weight = weights[edge.source];
+            if (source_weight == INVALID_EDGE_WEIGHT)
+                continue;
+
+            const auto new_weight = source_weight + edge.weight;
+            const auto new_duration = durations[edge.source] + edge.duration;
+            if (std::tie(new_weight, new_duration) < std::tie(weight, duration))
+            {
+                weight = new_weight;
+                duration = new_duration;
+            }
+        }
+        weights[position] = weight;
+        durations[position] = duration;
+    }
+}
+
+/**
+ * The part of a PhastGraph that the sweeps to a set of targets need (RPHAST, Delling et al.,
+ * 2011), i.e. the targets and all nodes above them with a downward path to a target.
+ *
+ * Every shortest path of a CH goes up to its highest node and then down to the target, so the
+ * labels of all other nodes never end up at a target. The selected nodes keep the order of the
+ * PhastGraph and get consecutive indices, their incoming edges refer to these indices. Built
+ * once per table query, the sweeps of all sources then only scan the selected nodes.
+ */
+class RestrictedPhastGraph
+{
+  public:
+    static constexpr std::uint32_t INVALID_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+    using Edge = PhastGraph::Edge;
+    using EdgeRange = PhastGraph::EdgeRange;
+
+    RestrictedPhastGraph(const PhastGraph &phast_graph, const std::vector<NodeID> &targets)
+        : indices(phast_graph.GetNumberOfNodes(), INVALID_INDEX)
+    {
+        // depth first search along the incoming edges, selected nodes are marked with index 0
+        std::vector<std::uint32_t> selected_positions;
+        std::vector<std::uint32_t> stack;
+        const auto select = [&](const std::uint32_t position) {
+            auto &index = indices[phast_graph.GetNode(position)];
+            if (index == INVALID_INDEX)
+            {
+                index = 0;
+                selected_positions.push_back(position);
+                stack.push_back(position);
+            }
+        };
+
+        for (const auto target : targets)
+            select(phast_graph.GetPosition(target));
+        while (!stack.empty())
+        {
+            const auto position = stack.back();
+            stack.pop_back();
+            for (const auto &edge : phast_graph.GetIncomingEdges(position))
+                select(edge.source);
+        }
+
+        std::sort(selected_positions.begin(), selected_positions.end());
+        nodes.reserve(selected_positions.size());
+        for (const auto position : selected_positions)
+        {
+            const auto node = phast_graph.GetNode(position);
+            indices[node] = static_cast<std::uint32_t>(nodes.size());
+            nodes.push_back(node);
+        }
+
+        first_edges.reserve(nodes.size() + 1);
+        first_edges.push_back(0);
+        for (const auto position : selected_positions)
+        {
+            for (const auto &edge : phast_graph.GetIncomingEdges(position))
+            {
+                const auto source = indices[phast_graph.GetNode(edge.source)];
+                BOOST_ASSERT(source < nodes.size());
+                edges.push_back({source, edge.weight, edge.duration});
+            }
+            first_edges.push_back(static_cast<std::uint32_t>(edges.size()));
+        }
+    }
+
+    std::uint32_t GetNumberOfNodes() const { return static_cast<std::uint32_t>(nodes.size()); }
+
+    NodeID GetNode(const std::uint32_t index) const { return nodes[index]; }
+
+    // INVALID_INDEX if the node is not selected
+    std::uint32_t GetIndex(const NodeID node) const { return indices[node]; }
+
+    EdgeRange GetIncomingEdges(const std::uint32_t index) const
+    {
+        return EdgeRange{edges.data() + first_edges[index], edges.data() + first_edges[index + 1]};
+    }
+
+  private:
+    std::vector<std::uint32_t> indices;
+    std::vector<NodeID> nodes;
+    std::vector<std::uint32_t> first_edges;
+    std::vector<Edge> edges;
+};
+
+// Labels of the sweeps of PHAST_LANES sources at once, the labels of the sources are stored next
+// to each other for every node of a RestrictedPhastGraph.
+constexpr std::size_t PHAST_LANES = 16;
+
+struct PhastLaneLabels
+{
+    std::vector<EdgeWeight> weights;
+    std::vector<EdgeDuration> durations;
+
+    void Reset(const std::size_t number_of_nodes)
+    {
+        weights.assign(number_of_nodes * PHAST_LANES, INVALID_EDGE_WEIGHT);
+        durations.assign(number_of_nodes * PHAST_LANES, MAXIMAL_EDGE_DURATION);
+    }
+
+    EdgeWeight *GetWeights(const std::uint32_t index) { return &weights[index * PHAST_LANES]; }
+    EdgeDuration *GetDurations(const std::uint32_t index)
+    {
+        return &durations[index * PHAST_LANES];
+    }
+};
+
+// Sweeps over the nodes of graph once for all lanes of labels, the labels of the upward searches
+// of the sources are already set. Uses AVX2 if the CPU supports it, see phast_sweep.cpp.
+void restrictedSweep(const RestrictedPhastGraph &graph, PhastLaneLabels &labels);
+
+// Sets the labels of one lane of a restricted sweep with an upward search of the source in
+// query_heap, nodes that are not part of graph are settled but not stored.
+template <typename GraphT, typename HeapT>
+void restrictedUpwardSearch(const GraphT &graph,
+                            const RestrictedPhastGraph &restricted_graph,
+                            HeapT &query_heap,
+                            const std::size_t lane,
+                            PhastLaneLabels &labels)
+{
+    BOOST_ASSERT(lane < PHAST_LANES);
+    upwardSearch(graph,
+                 query_heap,
+                 [&](const NodeID node, const EdgeWeight weight, const EdgeDuration duration) {
+                     const auto index = restricted_graph.GetIndex(node);
+                     if (index != RestrictedPhastGraph::INVALID_INDEX)
+                     {
+                         labels.GetWeights(index)[lane] = weight;
+                         labels.GetDurations(index)[lane] = duration;
+                     }
+                 });
+}
+
+} // namespace ch
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_ROUTING_ALGORITHMS_PHAST_GRAPH_HPP
@@ -5,12 +5,15 @@
 #include "guidance/turn_instruction.hpp"
 
 #include "engine/algorithm.hpp"
+#include "engine/cancellation_token.hpp"
 #include "engine/datafacade.hpp"
 #include "engine/internal_route_result.hpp"
 #include "engine/phantom_node.hpp"
 #include "engine/search_engine_data.hpp"
 
 #include "util/coordinate_calculation.hpp"
+#include "util/prefetch.hpp"
+#include "util/request_trace.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
@@ -112,6 +115,38 @@ void insertTargetInHeap(ManyToManyQueryHeap &heap, const PhantomNode &phantom_no
     }
 }
 
+// Requests the heap indices of the targets of edges before the edges are relaxed one after the
+// other, so that the cache misses of the lookups overlap. A no-op without prefetching compiled in.
+template <typename FacadeT, typename Heap, typename EdgeRange>
+void prefetchTargets(const FacadeT &facade, const Heap &heap, const EdgeRange &edges)
+{
+#ifdef OSRM_ENABLE_SEARCH_PREFETCH
+    for (const auto edge : edges)
+    {
+        heap.Prefetch(facade.GetTarget(edge));
+    }
+#else
+    (void)facade;
+    (void)heap;
+    (void)edges;
+#endif
+}
+
+// Same as prefetchTargets for a range of nodes, e.g. the destinations of the shortcuts of a cell
+template <typename Heap, typename NodeRange>
+void prefetchNodes(const Heap &heap, const NodeRange &nodes)
+{
+#ifdef OSRM_ENABLE_SEARCH_PREFETCH
+    for (const auto node : nodes)
+    {
+        heap.Prefetch(node);
+    }
+#else
+    (void)heap;
+    (void)nodes;
+#endif
+}
+
 template <typename FacadeT>
 void annotatePath(const FacadeT &facade,
                   const PhantomNodes &phantom_node_pair,
@@ -119,6 +154,7 @@ void annotatePath(const FacadeT &facade,
                   const std::vector<EdgeID> &unpacked_edges,
                   std::vector<PathData> &unpacked_path)
 {
+    const util::TraceSpan span("annotation");
     BOOST_ASSERT(!unpacked_nodes.empty());
     BOOST_ASSERT(unpacked_nodes.size() == unpacked_edges.size() + 1);
 
@@ -136,6 +172,7 @@ void annotatePath(const FacadeT &facade,
 
     // datastructures to hold extracted data from geometry
     std::vector<NodeID> id_vector;
+    std::vector<util::Coordinate> coordinate_vector;
     std::vector<EdgeWeight> weight_vector;
     std::vector<EdgeWeight> duration_vector;
     std::vector<DatasourceID> datasource_vector;
@@ -144,6 +181,7 @@ void annotatePath(const FacadeT &facade,
         if (geometry_index.forward)
         {
             id_vector = facade.GetUncompressedForwardGeometry(geometry_index.id);
+            coordinate_vector = facade.GetUncompressedForwardCoordinates(geometry_index.id);
             weight_vector = facade.GetUncompressedForwardWeights(geometry_index.id);
             duration_vector = facade.GetUncompressedForwardDurations(geometry_index.id);
             datasource_vector = facade.GetUncompressedForwardDatasources(geometry_index.id);
@@ -151,6 +189,7 @@ void annotatePath(const FacadeT &facade,
         else
         {
             id_vector = facade.GetUncompressedReverseGeometry(geometry_index.id);
+            coordinate_vector = facade.GetUncompressedReverseCoordinates(geometry_index.id);
             weight_vector = facade.GetUncompressedReverseWeights(geometry_index.id);
             duration_vector = facade.GetUncompressedReverseDurations(geometry_index.id);
             datasource_vector = facade.GetUncompressedReverseDatasources(geometry_index.id);
@@ -208,7 +247,8 @@ void annotatePath(const FacadeT &facade,
                                              datasource_vector[segment_idx],
                                              osrm::guidance::TurnBearing(0),
                                              osrm::guidance::TurnBearing(0),
-                                             is_left_hand_driving});
+                                             is_left_hand_driving,
+                                             coordinate_vector[segment_idx + 1]});
         }
         BOOST_ASSERT(unpacked_path.size() > 0);
         if (facade.HasLaneData(turn_id))
@@ -266,9 +306,10 @@ void annotatePath(const FacadeT &facade,
     {
         BOOST_ASSERT(segment_idx < id_vector.size() - 1);
         BOOST_ASSERT(facade.GetTravelMode(target_node_id) > 0);
+        const auto via_index = start_index < end_index ? segment_idx + 1 : segment_idx - 1;
         unpacked_path.push_back(
             PathData{target_node_id,
-                     id_vector[start_index < end_index ? segment_idx + 1 : segment_idx - 1],
+                     id_vector[via_index],
                      facade.GetNameIndex(target_node_id),
                      facade.IsSegregated(target_node_id),
                      weight_vector[segment_idx],
@@ -283,7 +324,8 @@ void annotatePath(const FacadeT &facade,
                      datasource_vector[segment_idx],
                      guidance::TurnBearing(0),
                      guidance::TurnBearing(0),
-                     is_target_left_hand_driving});
+                     is_target_left_hand_driving,
+                     coordinate_vector[via_index]});
     }
 
     if (unpacked_path.size() > 0)
@@ -315,7 +357,7 @@ void annotatePath(const FacadeT &facade,
 }
 
 template <typename Algorithm>
-double getPathDistance(const DataFacade<Algorithm> &facade,
+double getPathDistance(const DataFacade<Algorithm> & /* facade */,
                        const std::vector<PathData> unpacked_path,
                        const PhantomNode &source_phantom,
                        const PhantomNode &target_phantom)
@@ -331,7 +373,7 @@ double getPathDistance(const DataFacade<Algorithm> &facade,
     double prev_cos = std::cos(prev_lat);
     for (const auto &p : unpacked_path)
     {
-        const auto current_coordinate = facade.GetCoordinateOfNode(p.turn_via_node);
+        const auto &current_coordinate = p.turn_via_coordinate;
 
         const double current_lat =
             static_cast<double>(util::toFloating(current_coordinate.lat)) * DEGREE_TO_RAD;
@@ -4,12 +4,17 @@
 #include "engine/algorithm.hpp"
 #include "engine/datafacade.hpp"
 #include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/routing_algorithms/unpacking_cache.hpp"
 #include "engine/search_engine_data.hpp"
 
+#include "util/request_trace.hpp"
+#include "util/search_counters.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
 
+#include <memory>
+
 namespace osrm
 {
 namespace engine
@@ -21,9 +26,9 @@ namespace routing_algorithms
 namespace ch
 {
 
-// Stalling
-template <bool DIRECTION, typename HeapT>
-bool stallAtNode(const DataFacade<Algorithm> &facade,
+// Stalling, takes any graph with the interface of the facade so that it can be benchmarked alone
+template <bool DIRECTION, typename FacadeT, typename HeapT>
+bool stallAtNode(const FacadeT &facade,
                  const NodeID node,
                  const EdgeWeight weight,
                  const HeapT &query_heap)
@@ -54,7 +59,10 @@ void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
                         const EdgeWeight weight,
                         SearchEngineData<Algorithm>::QueryHeap &heap)
 {
-    for (const auto edge : facade.GetAdjacentEdgeRange(node))
+    const auto edges = facade.GetAdjacentEdgeRange(node);
+    prefetchTargets(facade, heap, edges);
+
+    for (const auto edge : edges)
     {
         const auto &data = facade.GetEdgeData(edge);
         if (DIRECTION == FORWARD_DIRECTION ? data.forward : data.backward)
@@ -64,10 +72,13 @@ void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
 
             BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
             const EdgeWeight to_weight = weight + edge_weight;
+            OSRM_COUNT_SEARCH(RelaxEdge());
 
             // New Node discovered -> Add to Heap + Node Info Storage
             if (!heap.WasInserted(to))
             {
+                // its edges are read once it is settled
+                facade.PrefetchAdjacentEdgeRange(to);
                 heap.Insert(to, to_weight, node);
             }
             // Found a shorter Path -> Update weight
@@ -205,6 +216,29 @@ EdgeWeight getLoopWeight(const DataFacade<Algorithm> &facade, NodeID node)
     return loop_weight;
 }
 
+inline bool addLoopWeight(const DataFacade<ch::Algorithm> &facade,
+                          const NodeID node,
+                          EdgeWeight &weight,
+                          EdgeDuration &duration)
+{ // Special case for CH when contractor creates a loop edge node->node
+    BOOST_ASSERT(weight < 0);
+
+    const auto loop_weight = ch::getLoopWeight<false>(facade, node);
+    if (loop_weight != INVALID_EDGE_WEIGHT)
+    {
+        const auto new_weight_with_loop = weight + loop_weight;
+        if (new_weight_with_loop >= 0)
+        {
+            weight = new_weight_with_loop;
+            duration += ch::getLoopWeight<true>(facade, node);
+            return true;
+        }
+    }
+
+    // No loop found or adjusted weight is negative
+    return false;
+}
+
 /**
  * Given a sequence of connected `NodeID`s in the CH graph, performs a depth-first unpacking of
  * the shortcut
@@ -220,6 +254,9 @@ EdgeWeight getLoopWeight(const DataFacade<Algorithm> &facade, NodeID node)
  * the original route
  * from beginning to end.
  *
+ * If the thread has an unpacking cache the original edges of the shortcuts between consecutive
+ * nodes of the packed path are looked up there first and cached after unpacking.
+ *
  * @param packed_path_begin iterator pointing to the start of the NodeID list
  * @param packed_path_end iterator pointing to the end of the NodeID list
  * @param callback void(const std::pair<NodeID, NodeID>, const EdgeID &) called for each
@@ -235,55 +272,92 @@ void unpackPath(const DataFacade<Algorithm> &facade,
     if (packed_path_begin == packed_path_end)
         return;
 
-    std::stack<std::pair<NodeID, NodeID>> recursion_stack;
+    OSRM_TIME_UNPACKING();
+    const util::TraceSpan span("unpacking");
 
-    // We have to push the path in reverse order onto the stack because it's LIFO.
-    for (auto current = std::prev(packed_path_end); current != packed_path_begin;
-         current = std::prev(current))
-    {
-        recursion_stack.emplace(*std::prev(current), *current);
-    }
+    const auto cache = SearchEngineData<Algorithm>::unpacking_cache.get();
+    std::stack<std::pair<NodeID, NodeID>> recursion_stack;
+    UnpackedShortcut unpacked_shortcut;
 
-    std::pair<NodeID, NodeID> edge;
-    while (!recursion_stack.empty())
+    for (auto current = packed_path_begin, next = std::next(packed_path_begin);
+         next != packed_path_end;
+         current = next++)
     {
-        edge = recursion_stack.top();
-        recursion_stack.pop();
+        if (cache)
+        {
+            const auto cached_shortcut = cache->Get(facade.GetFacadeID(), *current, *next);
+            if (cached_shortcut)
+            {
+                OSRM_COUNT_SEARCH(UnpackEdges(cached_shortcut->edges.size()));
+                for (std::size_t index = 0; index < cached_shortcut->edges.size(); ++index)
+                {
+                    auto edge = cached_shortcut->edges[index];
+                    std::forward<Callback>(callback)(edge, cached_shortcut->edge_ids[index]);
+                }
+                continue;
+            }
+            unpacked_shortcut.edges.clear();
+            unpacked_shortcut.edge_ids.clear();
+        }
 
-        // Look for an edge on the forward CH graph (.forward)
-        EdgeID smaller_edge_id = facade.FindSmallestEdge(
-            edge.first, edge.second, [](const auto &data) { return data.forward; });
+        recursion_stack.emplace(*current, *next);
 
-        // If we didn't find one there, the we might be looking at a part of the path that
-        // was found using the backward search.  Here, we flip the node order (.second, .first)
-        // and only consider edges with the `.backward` flag.
-        if (SPECIAL_EDGEID == smaller_edge_id)
+        std::pair<NodeID, NodeID> edge;
+        while (!recursion_stack.empty())
         {
-            smaller_edge_id = facade.FindSmallestEdge(
-                edge.second, edge.first, [](const auto &data) { return data.backward; });
-        }
+            edge = recursion_stack.top();
+            recursion_stack.pop();
+
+            // Look for an edge on the forward CH graph (.forward)
+            EdgeID smaller_edge_id = facade.FindSmallestEdge(
+                edge.first, edge.second, [](const auto &data) { return data.forward; });
+
+            // If we didn't find one there, the we might be looking at a part of the path that
+            // was found using the backward search.  Here, we flip the node order (.second,
+            // .first) and only consider edges with the `.backward` flag.
+            if (SPECIAL_EDGEID == smaller_edge_id)
+            {
+                smaller_edge_id = facade.FindSmallestEdge(
+                    edge.second, edge.first, [](const auto &data) { return data.backward; });
+            }
 
-        // If we didn't find anything *still*, then something is broken and someone has
-        // called this function with bad values.
-        BOOST_ASSERT_MSG(smaller_edge_id != SPECIAL_EDGEID, "Invalid smaller edge ID");
-
-        const auto &data = facade.GetEdgeData(smaller_edge_id);
-        BOOST_ASSERT_MSG(data.weight != std::numeric_limits<EdgeWeight>::max(),
-                         "edge weight invalid");
-
-        // If the edge is a shortcut, we need to add the two halfs to the stack.
-        if (data.shortcut)
-        { // unpack
-            const NodeID middle_node_id = data.turn_id;
-            // Note the order here - we're adding these to a stack, so we
-            // want the first->middle to get visited before middle->second
-            recursion_stack.emplace(middle_node_id, edge.second);
-            recursion_stack.emplace(edge.first, middle_node_id);
+            // If we didn't find anything *still*, then something is broken and someone has
+            // called this function with bad values.
+            BOOST_ASSERT_MSG(smaller_edge_id != SPECIAL_EDGEID, "Invalid smaller edge ID");
+
+            const auto &data = facade.GetEdgeData(smaller_edge_id);
+            BOOST_ASSERT_MSG(data.weight != std::numeric_limits<EdgeWeight>::max(),
+                             "edge weight invalid");
+
+            // If the edge is a shortcut, we need to add the two halfs to the stack.
+            if (data.shortcut)
+            { // unpack
+                const NodeID middle_node_id = data.turn_id;
+                // Note the order here - we're adding these to a stack, so we
+                // want the first->middle to get visited before middle->second
+                recursion_stack.emplace(middle_node_id, edge.second);
+                recursion_stack.emplace(edge.first, middle_node_id);
+            }
+            else
+            {
+                // We found an original edge, call our callback.
+                OSRM_COUNT_SEARCH(UnpackEdges(1));
+                if (cache)
+                {
+                    unpacked_shortcut.edges.push_back(edge);
+                    unpacked_shortcut.edge_ids.push_back(smaller_edge_id);
+                }
+                std::forward<Callback>(callback)(edge, smaller_edge_id);
+            }
         }
-        else
+
+        if (cache && unpacked_shortcut.edges.size() >= UnpackingCache::MIN_CACHED_EDGES)
         {
-            // We found an original edge, call our callback.
-            std::forward<Callback>(callback)(edge, smaller_edge_id);
+            cache->Put(facade.GetFacadeID(),
+                       *current,
+                       *next,
+                       std::make_shared<const UnpackedShortcut>(std::move(unpacked_shortcut)));
+            unpacked_shortcut = UnpackedShortcut{};
         }
     }
 }
@@ -363,6 +437,23 @@ void search(SearchEngineData<Algorithm> &engine_working_data,
             const PhantomNodes &phantom_nodes,
             const int duration_upper_bound = INVALID_EDGE_WEIGHT);
 
+// Settles all nodes of the forward upward search space of the nodes in forward_heap, so that
+// the search space can be shared by the reverse searches of searchToSettledForwardHeap.
+void settleForwardSearchSpace(const DataFacade<Algorithm> &facade,
+                              SearchEngineData<Algorithm>::QueryHeap &forward_heap);
+
+// Searches from the nodes in reverse_heap to the settled forward search space of
+// settleForwardSearchSpace. min_forward_weight is the minimal weight the forward search started
+// with, the force_loop parameters are the ones of search.
+void searchToSettledForwardHeap(const DataFacade<Algorithm> &facade,
+                                const SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                                SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                                const EdgeWeight min_forward_weight,
+                                EdgeWeight &weight,
+                                std::vector<NodeID> &packed_leg,
+                                const bool force_loop_forward,
+                                const bool force_loop_reverse);
+
 // Requires the heaps for be empty
 // If heaps should be adjusted to be initialized outside of this function,
 // the addition of force_loop parameters might be required
@@ -4,15 +4,21 @@
 #include "engine/algorithm.hpp"
 #include "engine/datafacade.hpp"
 #include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/routing_algorithms/parallel_search_state.hpp"
 #include "engine/search_engine_data.hpp"
 
+#include "util/coordinate_calculation.hpp"
+#include "util/request_trace.hpp"
+#include "util/search_counters.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
 
 #include <algorithm>
+#include <exception>
 #include <iterator>
 #include <limits>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -28,26 +34,30 @@ namespace mld
 namespace
 {
 // Unrestricted search (Args is const PhantomNodes &):
-//   * use partition.GetQueryLevel to find the node query level based on source and target phantoms
+//   * the node query level is the lowest level on which the node and the phantoms share a cell
 //   * allow to traverse all cells
 template <typename MultiLevelPartition>
 inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
                                  NodeID node,
                                  const PhantomNodes &phantom_nodes)
 {
-    auto level = [&partition, node](const SegmentID &source, const SegmentID &target) {
-        if (source.enabled && target.enabled)
-            return partition.GetQueryLevel(source.id, target.id, node);
-        return INVALID_LEVEL_ID;
+    // The query level of a source and a target segment is the lower of their highest different
+    // levels with the node, so the minimum over all pairs of segments is the minimum over all
+    // segments as long as there is a source and a target
+    const auto highest_different_level = [&partition, node](const PhantomNode &phantom_node) {
+        auto level = INVALID_LEVEL_ID;
+        if (phantom_node.forward_segment_id.enabled)
+            level = partition.GetHighestDifferentLevel(phantom_node.forward_segment_id.id, node);
+        if (phantom_node.reverse_segment_id.enabled)
+            level = std::min(
+                level, partition.GetHighestDifferentLevel(phantom_node.reverse_segment_id.id, node));
+        return level;
     };
-    return std::min(std::min(level(phantom_nodes.source_phantom.forward_segment_id,
-                                   phantom_nodes.target_phantom.forward_segment_id),
-                             level(phantom_nodes.source_phantom.forward_segment_id,
-                                   phantom_nodes.target_phantom.reverse_segment_id)),
-                    std::min(level(phantom_nodes.source_phantom.reverse_segment_id,
-                                   phantom_nodes.target_phantom.forward_segment_id),
-                             level(phantom_nodes.source_phantom.reverse_segment_id,
-                                   phantom_nodes.target_phantom.reverse_segment_id)));
+    const auto source_level = highest_different_level(phantom_nodes.source_phantom);
+    const auto target_level = highest_different_level(phantom_nodes.target_phantom);
+    if (source_level == INVALID_LEVEL_ID || target_level == INVALID_LEVEL_ID)
+        return INVALID_LEVEL_ID;
+    return std::min(source_level, target_level);
 }
 
 inline bool checkParentCellRestriction(CellID, const PhantomNodes &) { return true; }
@@ -131,25 +141,48 @@ retrievePackedPathFromHeap(const SearchEngineData<Algorithm>::QueryHeap &forward
     return packed_path;
 }
 
-template <bool DIRECTION, typename Algorithm, typename... Args>
-void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
-                        typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
-                        const NodeID node,
-                        const EdgeWeight weight,
-                        Args... args)
+// Relaxes the edges of node and calls on_update(to, to_weight) for every node whose key was set or
+// decreased, e.g. to share the reached nodes of a parallel search half.
+template <bool DIRECTION, typename Algorithm, typename OnUpdate, typename... Args>
+void relaxOutgoingEdgesAndNotify(const DataFacade<Algorithm> &facade,
+                                 typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                                 const NodeID node,
+                                 const EdgeWeight weight,
+                                 const OnUpdate &on_update,
+                                 Args... args)
 {
     const auto &partition = facade.GetMultiLevelPartition();
     const auto &cells = facade.GetCellStorage();
     const auto &metric = facade.GetCellMetric();
 
+    const auto update = [&](const NodeID to, const EdgeWeight to_weight, const bool clique_arc) {
+        OSRM_COUNT_SEARCH(RelaxEdge());
+        if (!forward_heap.WasInserted(to))
+        {
+            // its edges are read once it is settled
+            facade.PrefetchAdjacentEdgeRange(to);
+            forward_heap.Insert(to, to_weight, {node, clique_arc});
+            on_update(to, to_weight);
+        }
+        else if (to_weight < forward_heap.GetKey(to))
+        {
+            forward_heap.GetData(to) = {node, clique_arc};
+            forward_heap.DecreaseKey(to, to_weight);
+            on_update(to, to_weight);
+        }
+    };
+
     const auto level = getNodeQueryLevel(partition, node, args...);
 
     if (level >= 1 && !forward_heap.GetData(node).from_clique_arc)
     {
+        OSRM_COUNT_SEARCH(EnterCell(level));
+
         if (DIRECTION == FORWARD_DIRECTION)
         {
             // Shortcuts in forward direction
             const auto &cell = cells.GetCell(metric, level, partition.GetCell(level, node));
+            prefetchNodes(forward_heap, cell.GetDestinationNodes());
             auto destination = cell.GetDestinationNodes().begin();
             for (auto shortcut_weight : cell.GetOutWeight(node))
             {
@@ -160,15 +193,7 @@ void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
                 {
                     const EdgeWeight to_weight = weight + shortcut_weight;
                     BOOST_ASSERT(to_weight >= weight);
-                    if (!forward_heap.WasInserted(to))
-                    {
-                        forward_heap.Insert(to, to_weight, {node, true});
-                    }
-                    else if (to_weight < forward_heap.GetKey(to))
-                    {
-                        forward_heap.GetData(to) = {node, true};
-                        forward_heap.DecreaseKey(to, to_weight);
-                    }
+                    update(to, to_weight, true);
                 }
                 ++destination;
             }
@@ -177,6 +202,7 @@ void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
         {
             // Shortcuts in backward direction
             const auto &cell = cells.GetCell(metric, level, partition.GetCell(level, node));
+            prefetchNodes(forward_heap, cell.GetSourceNodes());
             auto source = cell.GetSourceNodes().begin();
             for (auto shortcut_weight : cell.GetInWeight(node))
             {
@@ -187,15 +213,7 @@ void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
                 {
                     const EdgeWeight to_weight = weight + shortcut_weight;
                     BOOST_ASSERT(to_weight >= weight);
-                    if (!forward_heap.WasInserted(to))
-                    {
-                        forward_heap.Insert(to, to_weight, {node, true});
-                    }
-                    else if (to_weight < forward_heap.GetKey(to))
-                    {
-                        forward_heap.GetData(to) = {node, true};
-                        forward_heap.DecreaseKey(to, to_weight);
-                    }
+                    update(to, to_weight, true);
                 }
                 ++source;
             }
@@ -203,33 +221,37 @@ void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
     }
 
     // Boundary edges
-    for (const auto edge : facade.GetBorderEdgeRange(level, node))
+    const auto border_edges = facade.GetBorderEdgeRange(level, node);
+    prefetchTargets(facade, forward_heap, border_edges);
+    for (const auto edge : border_edges)
     {
-        const auto &edge_data = facade.GetEdgeData(edge);
+        const auto &edge_data = facade.GetCompactEdge(edge);
         if (DIRECTION == FORWARD_DIRECTION ? edge_data.forward : edge_data.backward)
         {
-            const NodeID to = facade.GetTarget(edge);
+            const NodeID to = edge_data.target;
 
             if (!facade.ExcludeNode(to) &&
                 checkParentCellRestriction(partition.GetCell(level + 1, to), args...))
             {
                 BOOST_ASSERT_MSG(edge_data.weight > 0, "edge_weight invalid");
                 const EdgeWeight to_weight = weight + edge_data.weight;
-
-                if (!forward_heap.WasInserted(to))
-                {
-                    forward_heap.Insert(to, to_weight, {node, false});
-                }
-                else if (to_weight < forward_heap.GetKey(to))
-                {
-                    forward_heap.GetData(to) = {node, false};
-                    forward_heap.DecreaseKey(to, to_weight);
-                }
+                update(to, to_weight, false);
             }
         }
     }
 }
 
+template <bool DIRECTION, typename Algorithm, typename... Args>
+void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
+                        typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                        const NodeID node,
+                        const EdgeWeight weight,
+                        Args... args)
+{
+    relaxOutgoingEdgesAndNotify<DIRECTION>(
+        facade, forward_heap, node, weight, [](const NodeID, const EdgeWeight) {}, args...);
+}
+
 template <bool DIRECTION, typename Algorithm, typename... Args>
 void routingStep(const DataFacade<Algorithm> &facade,
                  typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
@@ -270,6 +292,180 @@ void routingStep(const DataFacade<Algorithm> &facade,
     relaxOutgoingEdges<DIRECTION>(facade, forward_heap, node, weight, args...);
 }
 
+// One half of a parallel search, settles nodes until the smallest keys of both heaps reach the
+// upper bound. Instead of checking the other heap when settling a node like routingStep the
+// half publishes every key it sets and looks up the node in the keys of the other half.
+template <bool DIRECTION>
+void parallelRoutingSteps(const DataFacade<Algorithm> &facade,
+                          SearchEngineData<Algorithm>::QueryHeap &heap,
+                          ParallelSearchState &state,
+                          const PhantomNodes &phantom_nodes)
+{
+    const auto own = DIRECTION == FORWARD_DIRECTION ? 0 : 1;
+    auto &own_reached = state.reached[own];
+    const auto &other_reached = state.reached[1 - own];
+
+    const auto on_update = [&](const NodeID to, const EdgeWeight to_weight) {
+        if (!own_reached.Set(to, to_weight))
+        {
+            // the serial search finishes, it checks the heaps instead of the tables
+            state.stop = true;
+        }
+
+        const auto other_weight = other_reached.Get(to);
+        if (other_weight != INVALID_EDGE_WEIGHT)
+        {
+            const auto path_weight = to_weight + other_weight;
+            if (path_weight >= 0)
+            {
+                state.UpdateUpperBound(to, path_weight);
+            }
+        }
+    };
+
+    // An empty heap keeps its last key so that the other half continues alone
+    while (!heap.Empty())
+    {
+        state.min_keys[own] = heap.MinKey();
+        if (state.IsDone())
+            break;
+
+        checkCancellation();
+        const auto node = heap.DeleteMin();
+        const auto weight = heap.GetKey(node);
+
+        BOOST_ASSERT(!facade.ExcludeNode(node));
+        relaxOutgoingEdgesAndNotify<DIRECTION>(
+            facade, heap, node, weight, on_update, phantom_nodes);
+    }
+}
+
+// Restricted searches unpack overlay edges, they are too short to be split
+template <typename Algorithm, typename... Args>
+void parallelSearch(SearchEngineData<Algorithm> &,
+                    const DataFacade<Algorithm> &,
+                    typename SearchEngineData<Algorithm>::QueryHeap &,
+                    typename SearchEngineData<Algorithm>::QueryHeap &,
+                    const bool,
+                    const bool,
+                    NodeID &,
+                    EdgeWeight &,
+                    EdgeWeight &,
+                    EdgeWeight &,
+                    Args...)
+{
+}
+
+// Runs the forward half of a search on this thread and the reverse half on another one if the
+// phantoms are at least parallel_search_distance apart. Afterwards middle, weight and the heap
+// minima are those of the serial loop at the same point, the serial loop finishes the search
+// if a half stopped early.
+inline void parallelSearch(SearchEngineData<Algorithm> &engine_working_data,
+                           const DataFacade<Algorithm> &facade,
+                           SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                           SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                           const bool force_loop_forward,
+                           const bool force_loop_reverse,
+                           NodeID &middle,
+                           EdgeWeight &weight,
+                           EdgeWeight &forward_heap_min,
+                           EdgeWeight &reverse_heap_min,
+                           const PhantomNodes &phantom_nodes)
+{
+    // loops are only checked when settling nodes
+    if (engine_working_data.parallel_search_distance <= 0 || force_loop_forward ||
+        force_loop_reverse ||
+        util::coordinate_calculation::greatCircleDistance(phantom_nodes.source_phantom.location,
+                                                          phantom_nodes.target_phantom.location) <
+            engine_working_data.parallel_search_distance)
+    {
+        return;
+    }
+
+    auto &state = engine_working_data.GetParallelSearchState();
+    state.Reset(weight, forward_heap_min, reverse_heap_min);
+
+    // The heaps only hold the segments of the phantoms yet
+    const auto publish = [](const SearchEngineData<Algorithm>::QueryHeap &heap,
+                            ConcurrentNodeWeights &reached,
+                            const PhantomNode &phantom) {
+        for (const auto &segment : {phantom.forward_segment_id, phantom.reverse_segment_id})
+        {
+            if (segment.enabled && heap.WasInserted(segment.id))
+            {
+                reached.Set(segment.id, heap.GetKey(segment.id));
+            }
+        }
+    };
+    publish(forward_heap, state.reached[0], phantom_nodes.source_phantom);
+    publish(reverse_heap, state.reached[1], phantom_nodes.target_phantom);
+    for (const auto &segment : {phantom_nodes.target_phantom.forward_segment_id,
+                                phantom_nodes.target_phantom.reverse_segment_id})
+    {
+        if (segment.enabled && forward_heap.WasInserted(segment.id) &&
+            reverse_heap.WasInserted(segment.id))
+        {
+            const auto path_weight =
+                forward_heap.GetKey(segment.id) + reverse_heap.GetKey(segment.id);
+            if (path_weight >= 0)
+            {
+                state.UpdateUpperBound(segment.id, path_weight);
+            }
+        }
+    }
+
+    // A dedicated thread and not a task of the table pool, the halves have to run concurrently
+    const auto cancellation_token = currentCancellationToken();
+    std::exception_ptr reverse_exception;
+    util::SearchCounters reverse_counters;
+    std::thread reverse_half([&] {
+        const CancellationScope scope(cancellation_token);
+        try
+        {
+            reverse_counters = util::countSearches([&] {
+                parallelRoutingSteps<REVERSE_DIRECTION>(facade, reverse_heap, state, phantom_nodes);
+            });
+        }
+        catch (...)
+        {
+            reverse_exception = std::current_exception();
+            state.stop = true;
+        }
+    });
+
+    try
+    {
+        parallelRoutingSteps<FORWARD_DIRECTION>(facade, forward_heap, state, phantom_nodes);
+    }
+    catch (...)
+    {
+        state.stop = true;
+        reverse_half.join();
+        throw;
+    }
+    reverse_half.join();
+
+    if (reverse_exception)
+    {
+        std::rethrow_exception(reverse_exception);
+    }
+    util::threadSearchCounters() += reverse_counters;
+
+    middle = state.middle;
+    weight = state.upper_bound;
+    if (middle != SPECIAL_NODEID)
+    {
+        // keys of the middle node can decrease after its last lookup if a table was full
+        const auto middle_weight = forward_heap.GetKey(middle) + reverse_heap.GetKey(middle);
+        if (middle_weight >= 0 && middle_weight < weight)
+        {
+            weight = middle_weight;
+        }
+    }
+    forward_heap_min = forward_heap.Empty() ? state.min_keys[0].load() : forward_heap.MinKey();
+    reverse_heap_min = reverse_heap.Empty() ? state.min_keys[1].load() : reverse_heap.MinKey();
+}
+
 // With (s, middle, t) we trace back the paths middle -> s and middle -> t.
 // This gives us a packed path (node ids) from the base graph around s and t,
 // and overlay node ids otherwise. We then have to unpack the overlay clique
@@ -304,9 +500,21 @@ UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
     EdgeWeight weight = weight_upper_bound;
     EdgeWeight forward_heap_min = forward_heap.MinKey();
     EdgeWeight reverse_heap_min = reverse_heap.MinKey();
+    parallelSearch(engine_working_data,
+                   facade,
+                   forward_heap,
+                   reverse_heap,
+                   force_loop_forward,
+                   force_loop_reverse,
+                   middle,
+                   weight,
+                   forward_heap_min,
+                   reverse_heap_min,
+                   args...);
     while (forward_heap.Size() + reverse_heap.Size() > 0 &&
            forward_heap_min + reverse_heap_min < weight)
     {
+        checkCancellation();
         if (!forward_heap.Empty())
         {
             routingStep<FORWARD_DIRECTION>(facade,
@@ -349,6 +557,8 @@ UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
     const NodeID source_node = !packed_path.empty() ? std::get<0>(packed_path.front()) : middle;
 
     // Unpack path
+    OSRM_TIME_UNPACKING();
+    const util::TraceSpan span("unpacking");
     std::vector<NodeID> unpacked_nodes;
     std::vector<EdgeID> unpacked_edges;
     unpacked_nodes.reserve(packed_path.size());
@@ -365,6 +575,7 @@ UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
         { // a base graph edge
             unpacked_nodes.push_back(target);
             unpacked_edges.push_back(facade.FindEdge(source, target));
+            OSRM_COUNT_SEARCH(UnpackEdges(1));
         }
         else
         { // an overlay graph edge
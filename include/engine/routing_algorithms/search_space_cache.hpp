@@ -0,0 +1,185 @@
+#ifndef OSRM_ENGINE_ROUTING_ALGORITHMS_SEARCH_SPACE_CACHE_HPP
+#define OSRM_ENGINE_ROUTING_ALGORITHMS_SEARCH_SPACE_CACHE_HPP
+
+#include "engine/phantom_node.hpp"
+
+#include "util/lru_cache.hpp"
+#include "util/std_hash.hpp"
+#include "util/typedefs.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+// A node settled by a many-to-many search
+struct SettledNode
+{
+    NodeID node;
+    NodeID parent;
+    EdgeWeight weight;
+    EdgeDuration duration;
+};
+
+// Settled nodes of one search in the order they were settled
+using SearchSpace = std::vector<SettledNode>;
+
+// The searches of a many-to-many query, the MLD searches of transposed tables start the
+// bucket searches at the sources and the row searches at the targets.
+enum class SearchSpaceType : std::uint8_t
+{
+    SourceRow,
+    TargetRow,
+    SourceBuckets,
+    TargetBuckets
+};
+
+// Identifies a search by everything its settled nodes depend on: the data of the facade and
+// the segments and offsets the phantom node inserts into the query heap.
+struct SearchSpaceKey
+{
+    SearchSpaceKey(const std::uint64_t facade_id,
+                   const SearchSpaceType type,
+                   const PhantomNode &phantom)
+        : facade_id(facade_id), forward_node(phantom.forward_segment_id.id),
+          reverse_node(phantom.reverse_segment_id.id),
+          forward_weight(phantom.forward_segment_id.enabled ? phantom.GetForwardWeightPlusOffset()
+                                                            : INVALID_EDGE_WEIGHT),
+          reverse_weight(phantom.reverse_segment_id.enabled ? phantom.GetReverseWeightPlusOffset()
+                                                            : INVALID_EDGE_WEIGHT),
+          forward_duration(phantom.forward_segment_id.enabled ? phantom.GetForwardDuration()
+                                                              : MAXIMAL_EDGE_DURATION),
+          reverse_duration(phantom.reverse_segment_id.enabled ? phantom.GetReverseDuration()
+                                                              : MAXIMAL_EDGE_DURATION),
+          flags(static_cast<std::uint8_t>(phantom.forward_segment_id.enabled) |
+                phantom.reverse_segment_id.enabled << 1 | phantom.IsValidForwardSource() << 2 |
+                phantom.IsValidForwardTarget() << 3 | phantom.IsValidReverseSource() << 4 |
+                phantom.IsValidReverseTarget() << 5),
+          type(type)
+    {
+    }
+
+    bool operator==(const SearchSpaceKey &other) const
+    {
+        return std::tie(facade_id,
+                        forward_node,
+                        reverse_node,
+                        forward_weight,
+                        reverse_weight,
+                        forward_duration,
+                        reverse_duration,
+                        flags,
+                        type) == std::tie(other.facade_id,
+                                          other.forward_node,
+                                          other.reverse_node,
+                                          other.forward_weight,
+                                          other.reverse_weight,
+                                          other.forward_duration,
+                                          other.reverse_duration,
+                                          other.flags,
+                                          other.type);
+    }
+
+    std::uint64_t facade_id;
+    NodeID forward_node;
+    NodeID reverse_node;
+    EdgeWeight forward_weight;
+    EdgeWeight reverse_weight;
+    EdgeDuration forward_duration;
+    EdgeDuration reverse_duration;
+    std::uint8_t flags;
+    SearchSpaceType type;
+};
+
+struct SearchSpaceKeyHash
+{
+    std::size_t operator()(const SearchSpaceKey &key) const
+    {
+        return hash_val(key.facade_id,
+                        key.forward_node,
+                        key.reverse_node,
+                        key.forward_weight,
+                        key.reverse_weight,
+                        key.forward_duration,
+                        key.reverse_duration,
+                        key.flags,
+                        static_cast<std::uint8_t>(key.type));
+    }
+};
+
+/**
+ * Thread-safe LRU cache of the search spaces of many-to-many searches.
+ *
+ * Table queries that share sources or targets, e.g. the same depots in every query, replay the
+ * settled nodes of the earlier searches against the buckets instead of running them again.
+ * The facade id in the keys makes sure a new dataset never uses the search spaces of the old one.
+ */
+class SearchSpaceCache
+{
+  public:
+    explicit SearchSpaceCache(const std::size_t capacity) : search_spaces(capacity) {}
+
+    std::shared_ptr<const SearchSpace> Get(const SearchSpaceKey &key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return search_spaces.Get(key).value_or(nullptr);
+    }
+
+    void Put(const SearchSpaceKey &key, std::shared_ptr<const SearchSpace> search_space)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        search_spaces.Put(key, std::move(search_space));
+    }
+
+  private:
+    std::mutex mutex;
+    util::LRUCache<SearchSpaceKey, std::shared_ptr<const SearchSpace>, SearchSpaceKeyHash>
+        search_spaces;
+};
+
+// Without a cache runs search(nullptr). Otherwise replays the settled nodes of an earlier search
+// with the same key with replay(settled_node), or runs search(&search_space) which has to record
+// its settled nodes into the search space that is then cached.
+template <typename Search, typename Replay>
+void cachedSearch(SearchSpaceCache *cache,
+                  const std::uint64_t facade_id,
+                  const SearchSpaceType type,
+                  const PhantomNode &phantom,
+                  const Search &search,
+                  const Replay &replay)
+{
+    if (cache == nullptr)
+    {
+        search(nullptr);
+        return;
+    }
+
+    const SearchSpaceKey key(facade_id, type, phantom);
+    if (const auto search_space = cache->Get(key))
+    {
+        for (const auto &settled_node : *search_space)
+        {
+            replay(settled_node);
+        }
+        return;
+    }
+
+    auto search_space = std::make_shared<SearchSpace>();
+    search(search_space.get());
+    search_space->shrink_to_fit();
+    cache->Put(key, std::move(search_space));
+}
+
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_ROUTING_ALGORITHMS_SEARCH_SPACE_CACHE_HPP
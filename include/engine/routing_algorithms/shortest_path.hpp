@@ -13,11 +13,14 @@ namespace engine
 namespace routing_algorithms
 {
 
+// With parallel set the legs are searched across the TBB task arena of the calling thread and
+// joined afterwards.
 template <typename Algorithm>
 InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_working_data,
                                        const DataFacade<Algorithm> &facade,
                                        const std::vector<PhantomNodes> &phantom_nodes_vector,
-                                       const boost::optional<bool> continue_straight_at_waypoint);
+                                       const boost::optional<bool> continue_straight_at_waypoint,
+                                       const bool parallel);
 
 } // namespace routing_algorithms
 } // namespace engine
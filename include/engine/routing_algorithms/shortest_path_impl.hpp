@@ -1,11 +1,19 @@
 #ifndef OSRM_SHORTEST_PATH_IMPL_HPP
 #define OSRM_SHORTEST_PATH_IMPL_HPP
 
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/routing_algorithms/routing_base_ch.hpp"
 #include "engine/routing_algorithms/shortest_path.hpp"
 
 #include <boost/assert.hpp>
 #include <boost/optional.hpp>
 
+#include <tbb/blocked_range.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -177,6 +185,284 @@ void search(SearchEngineData<Algorithm> &engine_working_data,
     }
 }
 
+// Same as above, but the upward search space of the source nodes is searched once and shared
+// by the reverse searches to both target nodes instead of being searched again for each of them.
+inline void search(SearchEngineData<ch::Algorithm> &engine_working_data,
+                   const DataFacade<ch::Algorithm> &facade,
+                   SearchEngineData<ch::Algorithm>::QueryHeap &forward_heap,
+                   SearchEngineData<ch::Algorithm>::QueryHeap &reverse_heap,
+                   const bool search_from_forward_node,
+                   const bool search_from_reverse_node,
+                   const bool search_to_forward_node,
+                   const bool search_to_reverse_node,
+                   const PhantomNode &source_phantom,
+                   const PhantomNode &target_phantom,
+                   const int total_weight_to_forward,
+                   const int total_weight_to_reverse,
+                   int &new_total_weight_to_forward,
+                   int &new_total_weight_to_reverse,
+                   std::vector<NodeID> &leg_packed_path_forward,
+                   std::vector<NodeID> &leg_packed_path_reverse)
+{
+    // a single target node doesn't share anything
+    if (!search_to_forward_node || !search_to_reverse_node)
+    {
+        search<ch::Algorithm>(engine_working_data,
+                              facade,
+                              forward_heap,
+                              reverse_heap,
+                              search_from_forward_node,
+                              search_from_reverse_node,
+                              search_to_forward_node,
+                              search_to_reverse_node,
+                              source_phantom,
+                              target_phantom,
+                              total_weight_to_forward,
+                              total_weight_to_reverse,
+                              new_total_weight_to_forward,
+                              new_total_weight_to_reverse,
+                              leg_packed_path_forward,
+                              leg_packed_path_reverse);
+        return;
+    }
+
+    forward_heap.Clear();
+    if (search_from_forward_node)
+    {
+        forward_heap.Insert(source_phantom.forward_segment_id.id,
+                            total_weight_to_forward - source_phantom.GetForwardWeightPlusOffset(),
+                            source_phantom.forward_segment_id.id);
+    }
+    if (search_from_reverse_node)
+    {
+        forward_heap.Insert(source_phantom.reverse_segment_id.id,
+                            total_weight_to_reverse - source_phantom.GetReverseWeightPlusOffset(),
+                            source_phantom.reverse_segment_id.id);
+    }
+    if (forward_heap.Empty())
+    {
+        new_total_weight_to_forward = INVALID_EDGE_WEIGHT;
+        new_total_weight_to_reverse = INVALID_EDGE_WEIGHT;
+        return;
+    }
+
+    const auto min_forward_weight = forward_heap.MinKey();
+    ch::settleForwardSearchSpace(facade, forward_heap);
+
+    reverse_heap.Clear();
+    reverse_heap.Insert(target_phantom.forward_segment_id.id,
+                        target_phantom.GetForwardWeightPlusOffset(),
+                        target_phantom.forward_segment_id.id);
+    ch::searchToSettledForwardHeap(facade,
+                                   forward_heap,
+                                   reverse_heap,
+                                   min_forward_weight,
+                                   new_total_weight_to_forward,
+                                   leg_packed_path_forward,
+                                   needsLoopForward(source_phantom, target_phantom),
+                                   routing_algorithms::DO_NOT_FORCE_LOOP);
+
+    reverse_heap.Clear();
+    reverse_heap.Insert(target_phantom.reverse_segment_id.id,
+                        target_phantom.GetReverseWeightPlusOffset(),
+                        target_phantom.reverse_segment_id.id);
+    ch::searchToSettledForwardHeap(facade,
+                                   forward_heap,
+                                   reverse_heap,
+                                   min_forward_weight,
+                                   new_total_weight_to_reverse,
+                                   leg_packed_path_reverse,
+                                   routing_algorithms::DO_NOT_FORCE_LOOP,
+                                   needsLoopBackwards(source_phantom, target_phantom));
+}
+
+// searchWithUTurn from the source nodes of a leg, the path is assigned to the valid target nodes
+template <typename Algorithm>
+void searchLegWithUTurn(SearchEngineData<Algorithm> &engine_working_data,
+                        const DataFacade<Algorithm> &facade,
+                        typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                        typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                        const bool search_from_forward_node,
+                        const bool search_from_reverse_node,
+                        const PhantomNode &source_phantom,
+                        const PhantomNode &target_phantom,
+                        const int total_weight_to_forward,
+                        const int total_weight_to_reverse,
+                        int &new_total_weight_to_forward,
+                        int &new_total_weight_to_reverse,
+                        std::vector<NodeID> &leg_packed_path_forward,
+                        std::vector<NodeID> &leg_packed_path_reverse)
+{
+    searchWithUTurn(engine_working_data,
+                    facade,
+                    forward_heap,
+                    reverse_heap,
+                    search_from_forward_node,
+                    search_from_reverse_node,
+                    target_phantom.IsValidForwardTarget(),
+                    target_phantom.IsValidReverseTarget(),
+                    source_phantom,
+                    target_phantom,
+                    total_weight_to_forward,
+                    total_weight_to_reverse,
+                    new_total_weight_to_forward,
+                    leg_packed_path_forward);
+    // if only the reverse node is valid (e.g. when using the match plugin) we
+    // actually need to move
+    if (!target_phantom.IsValidForwardTarget())
+    {
+        BOOST_ASSERT(target_phantom.IsValidReverseTarget());
+        new_total_weight_to_reverse = new_total_weight_to_forward;
+        leg_packed_path_reverse = std::move(leg_packed_path_forward);
+        new_total_weight_to_forward = INVALID_EDGE_WEIGHT;
+
+        // (*)
+        //
+        //   The callers have to check if new_total_weight_to_forward is invalid.
+        //   This prevents use-after-move on leg_packed_path_forward.
+    }
+    else if (target_phantom.IsValidReverseTarget())
+    {
+        new_total_weight_to_reverse = new_total_weight_to_forward;
+        leg_packed_path_reverse = leg_packed_path_forward;
+    }
+}
+
+// The paths of a leg searched before the legs are joined, their weights do not include the
+// weights of the previous legs. With u-turns at the waypoints index 0 holds the paths from either
+// source node, otherwise index 0 holds the paths from the forward and 1 from the reverse node.
+struct LegPaths
+{
+    int weight_to_forward[2] = {INVALID_EDGE_WEIGHT, INVALID_EDGE_WEIGHT};
+    int weight_to_reverse[2] = {INVALID_EDGE_WEIGHT, INVALID_EDGE_WEIGHT};
+    std::vector<NodeID> path_to_forward[2];
+    std::vector<NodeID> path_to_reverse[2];
+};
+
+// Searches the paths of all legs across the current TBB task arena. With u-turns at the
+// waypoints a leg starts at the nodes the previous leg arrives at, whatever its weight, so its
+// search is the same as in the sequential case. Otherwise the weights of the previous legs are
+// offsets of the searches, so the paths from the forward and the reverse source node are
+// searched separately and joined by joinLegPaths.
+template <typename Algorithm>
+std::vector<LegPaths> searchLegPaths(SearchEngineData<Algorithm> &engine_working_data,
+                                     const DataFacade<Algorithm> &facade,
+                                     const std::vector<PhantomNodes> &phantom_nodes_vector,
+                                     const bool allow_uturn_at_waypoint)
+{
+    std::vector<LegPaths> leg_paths(phantom_nodes_vector.size());
+    const auto search_legs = [&](const tbb::blocked_range<std::uint32_t> &range) {
+        engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
+        auto &forward_heap = *engine_working_data.forward_heap_1;
+        auto &reverse_heap = *engine_working_data.reverse_heap_1;
+
+        for (const auto leg : util::irange(range.begin(), range.end()))
+        {
+            const auto &source_phantom = phantom_nodes_vector[leg].source_phantom;
+            const auto &target_phantom = phantom_nodes_vector[leg].target_phantom;
+            const bool search_to_forward_node = target_phantom.IsValidForwardTarget();
+            const bool search_to_reverse_node = target_phantom.IsValidReverseTarget();
+            if (!search_to_forward_node && !search_to_reverse_node)
+                continue;
+
+            auto &paths = leg_paths[leg];
+            if (allow_uturn_at_waypoint)
+            {
+                // the previous leg arrives at all its valid target nodes
+                const bool search_from_forward_node =
+                    leg == 0 ? source_phantom.IsValidForwardSource()
+                             : phantom_nodes_vector[leg - 1].target_phantom.IsValidForwardTarget();
+                const bool search_from_reverse_node =
+                    leg == 0 ? source_phantom.IsValidReverseSource()
+                             : phantom_nodes_vector[leg - 1].target_phantom.IsValidReverseTarget();
+                searchLegWithUTurn(engine_working_data,
+                                   facade,
+                                   forward_heap,
+                                   reverse_heap,
+                                   search_from_forward_node,
+                                   search_from_reverse_node,
+                                   source_phantom,
+                                   target_phantom,
+                                   0,
+                                   0,
+                                   paths.weight_to_forward[0],
+                                   paths.weight_to_reverse[0],
+                                   paths.path_to_forward[0],
+                                   paths.path_to_reverse[0]);
+                continue;
+            }
+
+            const bool search_from[2] = {source_phantom.IsValidForwardSource(),
+                                         source_phantom.IsValidReverseSource()};
+            for (const auto source : {0, 1})
+            {
+                if (!search_from[source])
+                    continue;
+
+                search(engine_working_data,
+                       facade,
+                       forward_heap,
+                       reverse_heap,
+                       source == 0,
+                       source == 1,
+                       search_to_forward_node,
+                       search_to_reverse_node,
+                       source_phantom,
+                       target_phantom,
+                       0,
+                       0,
+                       paths.weight_to_forward[source],
+                       paths.weight_to_reverse[source],
+                       paths.path_to_forward[source],
+                       paths.path_to_reverse[source]);
+            }
+        }
+    };
+    parallelForEach(phantom_nodes_vector.size(), search_legs);
+    return leg_paths;
+}
+
+// Adds the weights of the previous legs to the paths of a leg found by searchLegPaths and picks
+// the shortest ones to the target nodes like the sequential search of the leg does
+inline void joinLegPaths(LegPaths &paths,
+                         const bool allow_uturn_at_waypoint,
+                         const bool search_from_forward_node,
+                         const bool search_from_reverse_node,
+                         const int total_weight_to_forward,
+                         const int total_weight_to_reverse,
+                         int &new_total_weight_to_forward,
+                         int &new_total_weight_to_reverse,
+                         std::vector<NodeID> &leg_packed_path_forward,
+                         std::vector<NodeID> &leg_packed_path_reverse)
+{
+    const bool search_from[2] = {allow_uturn_at_waypoint || search_from_forward_node,
+                                 !allow_uturn_at_waypoint && search_from_reverse_node};
+    const int total_weight[2] = {
+        allow_uturn_at_waypoint ? std::min(total_weight_to_forward, total_weight_to_reverse)
+                                : total_weight_to_forward,
+        total_weight_to_reverse};
+
+    for (const auto source : {0, 1})
+    {
+        if (!search_from[source])
+            continue;
+
+        // on equal weights the path from the forward source node is kept
+        if (paths.weight_to_forward[source] != INVALID_EDGE_WEIGHT &&
+            total_weight[source] + paths.weight_to_forward[source] < new_total_weight_to_forward)
+        {
+            new_total_weight_to_forward = total_weight[source] + paths.weight_to_forward[source];
+            leg_packed_path_forward = std::move(paths.path_to_forward[source]);
+        }
+        if (paths.weight_to_reverse[source] != INVALID_EDGE_WEIGHT &&
+            total_weight[source] + paths.weight_to_reverse[source] < new_total_weight_to_reverse)
+        {
+            new_total_weight_to_reverse = total_weight[source] + paths.weight_to_reverse[source];
+            leg_packed_path_reverse = std::move(paths.path_to_reverse[source]);
+        }
+    }
+}
+
 template <typename Algorithm>
 void unpackLegs(const DataFacade<Algorithm> &facade,
                 const std::vector<PhantomNodes> &phantom_nodes_vector,
@@ -213,7 +499,8 @@ template <typename Algorithm>
 InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_working_data,
                                        const DataFacade<Algorithm> &facade,
                                        const std::vector<PhantomNodes> &phantom_nodes_vector,
-                                       const boost::optional<bool> continue_straight_at_waypoint)
+                                       const boost::optional<bool> continue_straight_at_waypoint,
+                                       const bool parallel)
 {
     InternalRouteResult raw_route_data;
     raw_route_data.segment_end_coordinates = phantom_nodes_vector;
@@ -241,6 +528,14 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
     std::vector<NodeID> total_packed_path_to_reverse;
     std::vector<std::size_t> packed_leg_to_reverse_begin;
 
+    // in parallel mode all legs are searched up front and only joined below
+    std::vector<LegPaths> leg_paths;
+    if (parallel && phantom_nodes_vector.size() > 1)
+    {
+        leg_paths = searchLegPaths(
+            engine_working_data, facade, phantom_nodes_vector, allow_uturn_at_waypoint);
+    }
+
     std::size_t current_leg = 0;
     // this implements a dynamic program that finds the shortest route through
     // a list of vias
@@ -261,43 +556,37 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
         BOOST_ASSERT(!search_from_forward_node || source_phantom.IsValidForwardSource());
         BOOST_ASSERT(!search_from_reverse_node || source_phantom.IsValidReverseSource());
 
-        if (search_to_reverse_node || search_to_forward_node)
+        if (!leg_paths.empty())
+        {
+            joinLegPaths(leg_paths[current_leg],
+                         allow_uturn_at_waypoint,
+                         search_from_forward_node,
+                         search_from_reverse_node,
+                         total_weight_to_forward,
+                         total_weight_to_reverse,
+                         new_total_weight_to_forward,
+                         new_total_weight_to_reverse,
+                         packed_leg_to_forward,
+                         packed_leg_to_reverse);
+        }
+        else if (search_to_reverse_node || search_to_forward_node)
         {
             if (allow_uturn_at_waypoint)
             {
-                searchWithUTurn(engine_working_data,
-                                facade,
-                                forward_heap,
-                                reverse_heap,
-                                search_from_forward_node,
-                                search_from_reverse_node,
-                                search_to_forward_node,
-                                search_to_reverse_node,
-                                source_phantom,
-                                target_phantom,
-                                total_weight_to_forward,
-                                total_weight_to_reverse,
-                                new_total_weight_to_forward,
-                                packed_leg_to_forward);
-                // if only the reverse node is valid (e.g. when using the match plugin) we
-                // actually need to move
-                if (!target_phantom.IsValidForwardTarget())
-                {
-                    BOOST_ASSERT(target_phantom.IsValidReverseTarget());
-                    new_total_weight_to_reverse = new_total_weight_to_forward;
-                    packed_leg_to_reverse = std::move(packed_leg_to_forward);
-                    new_total_weight_to_forward = INVALID_EDGE_WEIGHT;
-
-                    // (*)
-                    //
-                    //   Below we have to check if new_total_weight_to_forward is invalid.
-                    //   This prevents use-after-move on packed_leg_to_forward.
-                }
-                else if (target_phantom.IsValidReverseTarget())
-                {
-                    new_total_weight_to_reverse = new_total_weight_to_forward;
-                    packed_leg_to_reverse = packed_leg_to_forward;
-                }
+                searchLegWithUTurn(engine_working_data,
+                                   facade,
+                                   forward_heap,
+                                   reverse_heap,
+                                   search_from_forward_node,
+                                   search_from_reverse_node,
+                                   source_phantom,
+                                   target_phantom,
+                                   total_weight_to_forward,
+                                   total_weight_to_reverse,
+                                   new_total_weight_to_forward,
+                                   new_total_weight_to_reverse,
+                                   packed_leg_to_forward,
+                                   packed_leg_to_reverse);
             }
             else
             {
@@ -321,7 +610,7 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
         }
 
         // Note: To make sure we do not access the moved-from packed_leg_to_forward
-        // we guard its access by a check for invalid edge weight. See  (*) above.
+        // we guard its access by a check for invalid edge weight. See (*) in searchLegWithUTurn.
 
         // No path found for both target nodes?
         if ((INVALID_EDGE_WEIGHT == new_total_weight_to_forward) &&
@@ -0,0 +1,85 @@
+#ifndef OSRM_ENGINE_ROUTING_ALGORITHMS_UNPACKING_CACHE_HPP
+#define OSRM_ENGINE_ROUTING_ALGORITHMS_UNPACKING_CACHE_HPP
+
+#include "util/lru_cache.hpp"
+#include "util/typedefs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+// The original edges of a CH shortcut in path order, with the nodes as passed to the callbacks
+// of ch::unpackPath
+struct UnpackedShortcut
+{
+    std::vector<std::pair<NodeID, NodeID>> edges;
+    std::vector<EdgeID> edge_ids;
+};
+
+/**
+ * Keeps the unpacked original edges of the most recently used CH shortcuts of packed paths.
+ *
+ * Long routes mostly consist of a few high level shortcuts, e.g. along motorways, that many
+ * routes share. Like the query heaps the cache is thread local, entries of another facade are
+ * dropped on the first lookup since node ids change with the dataset.
+ */
+class UnpackingCache
+{
+  public:
+    // shortcuts of fewer original edges are cheaper to unpack than to cache
+    static constexpr std::size_t MIN_CACHED_EDGES = 8;
+
+    explicit UnpackingCache(const std::size_t capacity) : capacity(capacity), shortcuts(capacity)
+    {
+    }
+
+    std::size_t Capacity() const { return capacity; }
+
+    std::shared_ptr<const UnpackedShortcut>
+    Get(const std::uint64_t facade_id, const NodeID from, const NodeID to)
+    {
+        if (facade_id != cached_facade_id)
+        {
+            shortcuts.Clear();
+            cached_facade_id = facade_id;
+            return nullptr;
+        }
+        return shortcuts.Get(Key(from, to)).value_or(nullptr);
+    }
+
+    void Put(const std::uint64_t facade_id,
+             const NodeID from,
+             const NodeID to,
+             std::shared_ptr<const UnpackedShortcut> shortcut)
+    {
+        if (facade_id == cached_facade_id)
+        {
+            shortcuts.Put(Key(from, to), std::move(shortcut));
+        }
+    }
+
+  private:
+    static std::uint64_t Key(const NodeID from, const NodeID to)
+    {
+        return static_cast<std::uint64_t>(from) << 32 | to;
+    }
+
+    const std::size_t capacity;
+    std::uint64_t cached_facade_id = 0;
+    util::LRUCache<std::uint64_t, std::shared_ptr<const UnpackedShortcut>> shortcuts;
+};
+
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_ROUTING_ALGORITHMS_UNPACKING_CACHE_HPP
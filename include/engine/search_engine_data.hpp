@@ -2,7 +2,11 @@
 #define SEARCH_ENGINE_DATA_HPP
 
 #include "engine/algorithm.hpp"
+#include "engine/routing_algorithms/parallel_search_state.hpp"
+#include "engine/routing_algorithms/phast_graph.hpp"
+#include "engine/routing_algorithms/unpacking_cache.hpp"
 #include "util/query_heap.hpp"
+#include "util/radix_heap.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/thread/tss.hpp>
@@ -15,7 +19,7 @@ namespace engine
 // Algorithm-dependent heaps
 // - CH algorithms use CH heaps
 // - CoreCH algorithms use CH
-// - MLD algorithms use MLD heaps
+// - MLD algorithms use MLD heaps, backed by radix heaps as all MLD searches are monotone
 
 template <typename Algorithm> struct SearchEngineData
 {
@@ -36,16 +40,18 @@ struct ManyToManyHeapData : HeapData
 template <> struct SearchEngineData<routing_algorithms::ch::Algorithm>
 {
     using QueryHeap = util::
-        QueryHeap<NodeID, NodeID, EdgeWeight, HeapData, util::UnorderedMapStorage<NodeID, int>>;
+        QueryHeap<NodeID, NodeID, EdgeWeight, HeapData, util::SelectableStorage<NodeID, int>>;
 
     using ManyToManyQueryHeap = util::QueryHeap<NodeID,
                                                 NodeID,
                                                 EdgeWeight,
                                                 ManyToManyHeapData,
-                                                util::UnorderedMapStorage<NodeID, int>>;
+                                                util::SelectableStorage<NodeID, int>>;
 
     using SearchEngineHeapPtr = boost::thread_specific_ptr<QueryHeap>;
     using ManyToManyHeapPtr = boost::thread_specific_ptr<ManyToManyQueryHeap>;
+    using UnpackingCachePtr = boost::thread_specific_ptr<routing_algorithms::UnpackingCache>;
+    using PhastLabelsPtr = boost::thread_specific_ptr<routing_algorithms::ch::PhastLabels>;
 
     static SearchEngineHeapPtr forward_heap_1;
     static SearchEngineHeapPtr reverse_heap_1;
@@ -54,6 +60,26 @@ template <> struct SearchEngineData<routing_algorithms::ch::Algorithm>
     static SearchEngineHeapPtr forward_heap_3;
     static SearchEngineHeapPtr reverse_heap_3;
     static ManyToManyHeapPtr many_to_many_heap;
+    // Used by ch::unpackPath if set, initializing the heaps of a thread sets it up
+    static UnpackingCachePtr unpacking_cache;
+    static PhastLabelsPtr phast_labels;
+
+    // Heaps are thread local and shared by all engines of an algorithm,
+    // a heap is re-created if it was allocated with another storage type
+    util::HeapStorageType heap_storage_type;
+
+    // Number of unpacked shortcuts cached per thread, zero disables the cache
+    std::size_t unpacking_cache_size = 0;
+
+    // Bytes the heaps of all threads keep between queries before they are shrunk, zero keeps
+    // the memory of the largest query of every heap
+    std::size_t max_heap_memory = 0;
+
+    explicit SearchEngineData(
+        util::HeapStorageType heap_storage_type = util::HeapStorageType::UnorderedMap)
+        : heap_storage_type(heap_storage_type)
+    {
+    }
 
     void InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes);
 
@@ -62,6 +88,14 @@ template <> struct SearchEngineData<routing_algorithms::ch::Algorithm>
     void InitializeOrClearThirdThreadLocalStorage(unsigned number_of_nodes);
 
     void InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes);
+
+    // The labels are reset by the sweeps themselves
+    routing_algorithms::ch::PhastLabels &GetPhastLabels();
+
+  private:
+    static std::size_t ThreadRetainedMemory();
+
+    void InitializeOrResetUnpackingCache();
 };
 
 struct MultiLayerDijkstraHeapData
@@ -87,28 +121,56 @@ struct ManyToManyMultiLayerDijkstraHeapData : MultiLayerDijkstraHeapData
 
 template <> struct SearchEngineData<routing_algorithms::mld::Algorithm>
 {
-    using QueryHeap = util::QueryHeap<NodeID,
-                                      NodeID,
-                                      EdgeWeight,
-                                      MultiLayerDijkstraHeapData,
-                                      util::UnorderedMapStorage<NodeID, int>>;
-
-    using ManyToManyQueryHeap = util::QueryHeap<NodeID,
-                                                NodeID,
-                                                EdgeWeight,
-                                                ManyToManyMultiLayerDijkstraHeapData,
-                                                util::UnorderedMapStorage<NodeID, int>>;
+    using QueryHeap = util::RadixQueryHeap<NodeID,
+                                           NodeID,
+                                           EdgeWeight,
+                                           MultiLayerDijkstraHeapData,
+                                           util::SelectableStorage<NodeID, int>>;
+
+    using ManyToManyQueryHeap = util::RadixQueryHeap<NodeID,
+                                                     NodeID,
+                                                     EdgeWeight,
+                                                     ManyToManyMultiLayerDijkstraHeapData,
+                                                     util::SelectableStorage<NodeID, int>>;
 
     using SearchEngineHeapPtr = boost::thread_specific_ptr<QueryHeap>;
     using ManyToManyHeapPtr = boost::thread_specific_ptr<ManyToManyQueryHeap>;
 
+    using ParallelSearchStatePtr =
+        boost::thread_specific_ptr<routing_algorithms::ParallelSearchState>;
+
     static SearchEngineHeapPtr forward_heap_1;
     static SearchEngineHeapPtr reverse_heap_1;
     static ManyToManyHeapPtr many_to_many_heap;
+    static ParallelSearchStatePtr parallel_search_state;
+
+    // Heaps are thread local and shared by all engines of an algorithm,
+    // a heap is re-created if it was allocated with another storage type
+    util::HeapStorageType heap_storage_type;
+
+    // Route searches between phantoms at least this many meters apart run their
+    // forward and reverse halves on two threads, zero disables parallel searches
+    double parallel_search_distance = 0;
+
+    // Bytes the heaps of all threads keep between queries before they are shrunk, zero keeps
+    // the memory of the largest query of every heap
+    std::size_t max_heap_memory = 0;
+
+    explicit SearchEngineData(
+        util::HeapStorageType heap_storage_type = util::HeapStorageType::UnorderedMap)
+        : heap_storage_type(heap_storage_type)
+    {
+    }
 
     void InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes);
 
     void InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes);
+
+    // Shared by the two halves of the parallel searches started on this thread
+    routing_algorithms::ParallelSearchState &GetParallelSearchState();
+
+  private:
+    static std::size_t ThreadRetainedMemory();
 };
 }
 }
@@ -35,12 +35,14 @@ namespace engine
 
 /**
  * Status for indicating query success or failure.
+ * Timeout reports a query that was stopped by its cancellation token, see BaseParameters.
  * \see OSRM
  */
 enum class Status
 {
     Ok,
-    Error
+    Error,
+    Timeout
 };
 }
 }
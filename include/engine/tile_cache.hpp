@@ -0,0 +1,52 @@
+#ifndef OSRM_ENGINE_TILE_CACHE_HPP
+#define OSRM_ENGINE_TILE_CACHE_HPP
+
+#include "engine/dataset_cache.hpp"
+
+#include "util/std_hash.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Identifies a vector tile by the facade it was rendered from and its slippy map coordinates
+struct TileCacheKey
+{
+    bool operator==(const TileCacheKey &other) const
+    {
+        return std::tie(facade_id, x, y, z) ==
+               std::tie(other.facade_id, other.x, other.y, other.z);
+    }
+
+    std::uint64_t facade_id;
+    unsigned x;
+    unsigned y;
+    unsigned z;
+};
+
+struct TileCacheKeyHash
+{
+    std::size_t operator()(const TileCacheKey &key) const
+    {
+        return hash_val(key.facade_id, key.x, key.y, key.z);
+    }
+};
+
+/**
+ * Thread-safe LRU cache of the encoded vector tiles, they are dropped once a newer dataset is
+ * loaded.
+ *
+ * \see DatasetCache
+ */
+using TileCache = DatasetCache<TileCacheKey, std::shared_ptr<const std::string>, TileCacheKeyHash>;
+
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_TILE_CACHE_HPP
@@ -1,6 +1,7 @@
 #ifndef TRIP_FARTHEST_INSERTION_HPP
 #define TRIP_FARTHEST_INSERTION_HPP
 
+#include "engine/cancellation_token.hpp"
 #include "util/dist_table_wrapper.hpp"
 #include "util/typedefs.hpp"
 
@@ -98,6 +99,9 @@ inline std::vector<NodeID> FindRoute(const std::size_t &number_of_locations,
     // two nodes are already in the initial start trip, so we need to add all other nodes
     for (std::size_t added_nodes = 2; added_nodes < number_of_locations; ++added_nodes)
     {
+        // every insertion scans all pairs of locations
+        throwIfCancelled();
+
         auto farthest_distance = std::numeric_limits<int>::min();
         auto next_node = -1;
         NodeIDIter next_insert_point;
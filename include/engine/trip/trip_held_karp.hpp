@@ -0,0 +1,126 @@
+#ifndef TRIP_HELD_KARP_HPP
+#define TRIP_HELD_KARP_HPP
+
+#include "engine/cancellation_token.hpp"
+#include "util/dist_table_wrapper.hpp"
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace trip
+{
+
+// The largest number of locations HeldKarpTrip is used for, it needs about 5 * 2^(n-1) * (n-1)
+// bytes for the states, 2.4 MB for 16 locations
+const constexpr std::size_t HELD_KARP_MAX_LOCATIONS = 16;
+
+// Computes the shortest round trip with the dynamic program of Held and Karp in O(n^2 * 2^n).
+// The trip starts at location 0. A state is a subset of the other locations, stored as a bitmask,
+// together with the last location of a shortest path from 0 that visits exactly that subset.
+inline std::vector<NodeID> HeldKarpTrip(const std::size_t number_of_locations,
+                                        const util::DistTableWrapper<EdgeWeight> &dist_table)
+{
+    BOOST_ASSERT_MSG(number_of_locations > 0, "no locations given");
+    BOOST_ASSERT_MSG(number_of_locations <= HELD_KARP_MAX_LOCATIONS, "too many locations");
+
+    std::vector<NodeID> route(number_of_locations);
+    std::iota(route.begin(), route.end(), 0);
+    if (number_of_locations <= 2)
+    {
+        return route;
+    }
+
+    // location i + 1 is bit i of a subset, the start location is in no subset
+    const std::size_t number_of_others = number_of_locations - 1;
+    const std::uint32_t full_subset = (1u << number_of_others) - 1;
+    constexpr std::uint8_t FROM_START = std::numeric_limits<std::uint8_t>::max();
+
+    // the weight and the previous location of the state (subset, last) at
+    // subset * number_of_others + last
+    std::vector<EdgeWeight> weights((full_subset + 1) * number_of_others, INVALID_EDGE_WEIGHT);
+    std::vector<std::uint8_t> previous(weights.size(), FROM_START);
+    const auto state = [number_of_others](const std::uint32_t subset, const std::size_t last) {
+        return subset * number_of_others + last;
+    };
+
+    for (const auto last : util::irange<std::size_t>(0, number_of_others))
+    {
+        weights[state(1u << last, last)] = dist_table(0, last + 1);
+    }
+
+    // a subset comes after all of its subsets, so its states are final when they are extended
+    for (std::uint32_t subset = 1; subset < full_subset; ++subset)
+    {
+        for (const auto last : util::irange<std::size_t>(0, number_of_others))
+        {
+            const auto weight = weights[state(subset, last)];
+            if ((subset & (1u << last)) == 0 || weight == INVALID_EDGE_WEIGHT)
+                continue;
+
+            checkCancellation();
+            for (const auto next : util::irange<std::size_t>(0, number_of_others))
+            {
+                const auto edge_weight = dist_table(last + 1, next + 1);
+                if ((subset & (1u << next)) != 0 || edge_weight == INVALID_EDGE_WEIGHT)
+                    continue;
+
+                const auto next_state = state(subset | (1u << next), next);
+                if (weight + edge_weight < weights[next_state])
+                {
+                    weights[next_state] = weight + edge_weight;
+                    previous[next_state] = static_cast<std::uint8_t>(last);
+                }
+            }
+        }
+    }
+
+    // close the trip, without any trip the order of the locations is kept
+    EdgeWeight min_route_weight = INVALID_EDGE_WEIGHT;
+    std::size_t best_last = number_of_others;
+    for (const auto last : util::irange<std::size_t>(0, number_of_others))
+    {
+        const auto weight = weights[state(full_subset, last)];
+        const auto edge_weight = dist_table(last + 1, 0);
+        if (weight == INVALID_EDGE_WEIGHT || edge_weight == INVALID_EDGE_WEIGHT)
+            continue;
+
+        if (weight + edge_weight < min_route_weight)
+        {
+            min_route_weight = weight + edge_weight;
+            best_last = last;
+        }
+    }
+    if (best_last == number_of_others)
+    {
+        return route;
+    }
+
+    auto subset = full_subset;
+    auto last = best_last;
+    for (auto position = number_of_locations - 1; position > 0; --position)
+    {
+        route[position] = static_cast<NodeID>(last + 1);
+        const auto before = previous[state(subset, last)];
+        subset &= ~(1u << last);
+        last = before;
+    }
+    BOOST_ASSERT(subset == 0 && last == FROM_START);
+
+    return route;
+}
+
+} // namespace trip
+} // namespace engine
+} // namespace osrm
+
+#endif // TRIP_HELD_KARP_HPP
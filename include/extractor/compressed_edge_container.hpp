@@ -4,9 +4,12 @@
 #include "extractor/segment_data_container.hpp"
 
 #include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
 
 #include <unordered_map>
 
+#include <cstddef>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -15,6 +18,10 @@ namespace osrm
 namespace extractor
 {
 
+// The geometries are collected in two phases: while the graph is compressed the segments are
+// appended to an arena and chained into one list per edge, Freeze() then copies the chains into
+// contiguous buckets. Only the first, last and second to last segments of an edge can be queried
+// before the container is frozen.
 class CompressedEdgeContainer
 {
   public:
@@ -26,9 +33,8 @@ class CompressedEdgeContainer
         SegmentDuration duration; // the duration of the edge leading to this node
     };
 
-    using OnewayEdgeBucket = std::vector<OnewayCompressedEdge>;
+    using OnewayEdgeBucket = util::vector_view<const OnewayCompressedEdge>;
 
-    CompressedEdgeContainer();
     void CompressEdge(const EdgeID surviving_edge_id,
                       const EdgeID removed_edge_id,
                       const NodeID via_node_id,
@@ -47,6 +53,10 @@ class CompressedEdgeContainer
                              const SegmentWeight weight,
                              const SegmentWeight duration);
 
+    // Moves the segments of every edge next to each other, no edges can be compressed afterwards
+    void Freeze();
+    bool IsFrozen() const;
+
     void InitializeBothwayVector();
     unsigned ZipEdges(const unsigned f_edge_pos, const unsigned r_edge_pos);
 
@@ -54,10 +64,10 @@ class CompressedEdgeContainer
     bool HasZippedEntryForForwardID(const EdgeID edge_id) const;
     bool HasZippedEntryForReverseID(const EdgeID edge_id) const;
     void PrintStatistics() const;
-    unsigned GetPositionForID(const EdgeID edge_id) const;
     unsigned GetZippedPositionForForwardID(const EdgeID edge_id) const;
     unsigned GetZippedPositionForReverseID(const EdgeID edge_id) const;
-    const OnewayEdgeBucket &GetBucketReference(const EdgeID edge_id) const;
+    // Requires the container to be frozen
+    OnewayEdgeBucket GetBucketReference(const EdgeID edge_id) const;
     bool IsTrivial(const EdgeID edge_id) const;
     NodeID GetFirstEdgeTargetID(const EdgeID edge_id) const;
     NodeID GetLastEdgeTargetID(const EdgeID edge_id) const;
@@ -70,17 +80,26 @@ class CompressedEdgeContainer
     SegmentWeight ClipWeight(const SegmentWeight weight);
     SegmentDuration ClipDuration(const SegmentDuration duration);
 
-    int free_list_maximum = 0;
+    static constexpr std::size_t INVALID_SEGMENT = std::numeric_limits<std::size_t>::max();
+
+    void AppendSegment(const EdgeID edge_id, const OnewayCompressedEdge segment);
+
     std::atomic_size_t clipped_weights{0};
     std::atomic_size_t clipped_durations{0};
 
-    void IncreaseFreeList();
-    std::vector<OnewayEdgeBucket> m_compressed_oneway_geometries;
-    std::vector<unsigned> m_free_list;
-    std::unordered_map<EdgeID, unsigned> m_edge_id_to_list_index_map;
+    // the arena of all segments, ordered by edge once the container is frozen
+    std::vector<OnewayCompressedEdge> m_segments;
+    // the chains of segments of every edge, only used until the container is frozen
+    std::vector<std::size_t> m_next_segment;
+    std::vector<std::size_t> m_first_segment;
+    std::vector<std::size_t> m_last_segment;
+    // the buckets of the edges in the frozen arena, an edge has no entry if its bucket is empty
+    std::vector<std::size_t> m_bucket_offsets;
     std::unordered_map<EdgeID, unsigned> m_forward_edge_id_to_zipped_index_map;
     std::unordered_map<EdgeID, unsigned> m_reverse_edge_id_to_zipped_index_map;
     std::unique_ptr<SegmentDataContainer> segment_data;
+    // the nodes of the zipped geometries, compressed into the segment data at the end
+    std::vector<NodeID> zipped_nodes;
 };
 }
 }
@@ -19,7 +19,9 @@ struct ConditionalTurnPenalty
     // offset into the sequential list of turn penalties (see TurnIndexBlock for reference);
     std::uint64_t turn_offset;
     util::Coordinate location;
+    // the conditions are only kept if they can not be compiled into a weekly schedule
     std::vector<util::OpeningHours> conditions;
+    util::WeeklySchedule schedule;
 };
 
 } // namespace extractor
@@ -8,6 +8,7 @@
 #include "extractor/edge_based_edge.hpp"
 #include "extractor/edge_based_node_segment.hpp"
 #include "extractor/extraction_turn.hpp"
+#include "extractor/intersection/intersection_geometry_cache.hpp"
 #include "extractor/maneuver_override.hpp"
 #include "extractor/name_table.hpp"
 #include "extractor/nbg_to_ebg.hpp"
@@ -19,6 +20,7 @@
 
 #include "util/concurrent_id_map.hpp"
 #include "util/deallocating_vector.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 #include "util/typedefs.hpp"
 
@@ -32,7 +34,6 @@
 #include <queue>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 namespace osrm
@@ -67,11 +68,11 @@ class EdgeBasedGraphFactory
     explicit EdgeBasedGraphFactory(const util::NodeBasedDynamicGraph &node_based_graph,
                                    EdgeBasedNodeDataContainer &node_data_container,
                                    const CompressedEdgeContainer &compressed_edge_container,
-                                   const std::unordered_set<NodeID> &barrier_nodes,
-                                   const std::unordered_set<NodeID> &traffic_lights,
+                                   const util::IdSet<NodeID> &barrier_nodes,
+                                   const util::IdSet<NodeID> &traffic_lights,
                                    const std::vector<util::Coordinate> &coordinates,
                                    const NameTable &name_table,
-                                   const std::unordered_set<EdgeID> &segregated_edges,
+                                   const util::IdSet<EdgeID> &segregated_edges,
                                    const LaneDescriptionMap &lane_description_map);
 
     void Run(ScriptingEnvironment &scripting_environment,
@@ -91,6 +92,7 @@ class EdgeBasedGraphFactory
     void GetEdgeBasedNodeSegments(std::vector<EdgeBasedNodeSegment> &nodes);
     void GetStartPointMarkers(std::vector<bool> &node_is_startpoint);
     void GetEdgeBasedNodeWeights(std::vector<EdgeWeight> &output_node_weights);
+    void GetIntersectionGeometries(intersection::IntersectionGeometryCache &geometries);
     std::uint32_t GetConnectivityChecksum() const;
 
     std::uint64_t GetNumberOfEdgeBasedNodes() const;
@@ -124,6 +126,9 @@ class EdgeBasedGraphFactory
     util::DeallocatingVector<EdgeBasedEdge> m_edge_based_edge_list;
     std::uint32_t m_connectivity_checksum;
 
+    //! geometries of the intersections of the node-based graph, reused by the guidance
+    intersection::IntersectionGeometryCache m_intersection_geometries;
+
     // The number of edge-based nodes is mostly made up out of the edges in the node-based graph.
     // Any edge in the node-based graph represents a node in the edge-based graph. In addition, we
     // add a set of artificial edge-based nodes into the mix to model via-way turn restrictions.
@@ -134,12 +139,12 @@ class EdgeBasedGraphFactory
     const std::vector<util::Coordinate> &m_coordinates;
     const util::NodeBasedDynamicGraph &m_node_based_graph;
 
-    const std::unordered_set<NodeID> &m_barrier_nodes;
-    const std::unordered_set<NodeID> &m_traffic_lights;
+    const util::IdSet<NodeID> &m_barrier_nodes;
+    const util::IdSet<NodeID> &m_traffic_lights;
     const CompressedEdgeContainer &m_compressed_edge_container;
 
     const NameTable &name_table;
-    const std::unordered_set<EdgeID> &segregated_edges;
+    const util::IdSet<EdgeID> &segregated_edges;
     const LaneDescriptionMap &lane_description_map;
 
     // In the edge based graph, any traversable (non reversed) edge of the node-based graph forms a
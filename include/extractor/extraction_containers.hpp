@@ -9,6 +9,10 @@
 
 #include "storage/tar_fwd.hpp"
 
+#include <boost/filesystem/path.hpp>
+
+#include <memory>
+
 namespace osrm
 {
 namespace extractor
@@ -19,9 +23,17 @@ namespace extractor
  * is collected by the extractor callbacks.
  *
  * The data is the filtered, aggregated and finally written to disk.
+ *
+ * With an external memory directory the nodes and edges are collected in sorted runs
+ * that are spilled to files of that directory and merged when the data is prepared.
+ * Only the nodes that are referenced by ways are held in memory then.
  */
 class ExtractionContainers
 {
+    // the sorters of the nodes and the edges in external memory mode
+    struct ExternalMemory;
+    std::unique_ptr<ExternalMemory> external_memory;
+
     void PrepareNodes();
     void PrepareManeuverOverrides();
     void PrepareRestrictions();
@@ -67,7 +79,15 @@ class ExtractionContainers
     std::vector<InputManeuverOverride> external_maneuver_overrides_list;
     std::vector<UnresolvedManeuverOverride> internal_maneuver_overrides;
 
-    ExtractionContainers();
+    // Collects the data in memory, if external_memory_directory is empty, or spills the nodes
+    // and edges to runs of external_memory_buffer_size bytes each in that directory
+    explicit ExtractionContainers(const boost::filesystem::path &external_memory_directory = {},
+                                  std::size_t external_memory_buffer_size = 0);
+    ~ExtractionContainers();
+
+    void AddNode(const QueryNode &node);
+    void AddEdge(const InternalExtractorEdge &edge);
+    bool HasEdges() const;
 
     void PrepareData(ScriptingEnvironment &scripting_environment,
                      const std::string &osrm_path,
@@ -42,6 +42,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "util/guidance/entry_class.hpp"
 #include "util/guidance/turn_lanes.hpp"
 
+#include "util/id_set.hpp"
 #include "util/typedefs.hpp"
 
 namespace osrm
@@ -72,11 +73,11 @@ class Extractor
         const util::NodeBasedDynamicGraph &node_based_graph,
         const std::vector<util::Coordinate> &coordinates,
         const CompressedEdgeContainer &compressed_edge_container,
-        const std::unordered_set<NodeID> &barrier_nodes,
-        const std::unordered_set<NodeID> &traffic_lights,
+        const util::IdSet<NodeID> &barrier_nodes,
+        const util::IdSet<NodeID> &traffic_lights,
         const std::vector<TurnRestriction> &turn_restrictions,
         const std::vector<ConditionalTurnRestriction> &conditional_turn_restrictions,
-        const std::unordered_set<EdgeID> &segregated_edges,
+        const util::IdSet<EdgeID> &segregated_edges,
         const NameTable &name_table,
         const std::vector<UnresolvedManeuverOverride> &maneuver_overrides,
         const LaneDescriptionMap &turn_lane_map,
@@ -88,6 +89,7 @@ class Extractor
         std::vector<bool> &node_is_startpoint,
         std::vector<EdgeWeight> &edge_based_node_weights,
         util::DeallocatingVector<EdgeBasedEdge> &edge_based_edge_list,
+        intersection::IntersectionGeometryCache &intersection_geometries,
         std::uint32_t &connectivity_checksum);
 
     void FindComponents(unsigned max_edge_id,
@@ -96,7 +98,8 @@ class Extractor
                         EdgeBasedNodeDataContainer &nodes_container) const;
     void BuildRTree(std::vector<EdgeBasedNodeSegment> edge_based_node_segments,
                     std::vector<bool> node_is_startpoint,
-                    const std::vector<util::Coordinate> &coordinates);
+                    const std::vector<util::Coordinate> &coordinates,
+                    const EdgeBasedNodeDataContainer &nodes_container);
     std::shared_ptr<RestrictionMap> LoadRestrictionMap();
 
     void WriteConditionalRestrictions(
@@ -108,12 +111,19 @@ class Extractor
         const EdgeBasedNodeDataContainer &edge_based_node_container,
         const std::vector<util::Coordinate> &node_coordinates,
         const CompressedEdgeContainer &compressed_edge_container,
-        const std::unordered_set<NodeID> &barrier_nodes,
+        const intersection::IntersectionGeometryCache &intersection_geometries,
+        const util::IdSet<NodeID> &barrier_nodes,
         const std::vector<TurnRestriction> &turn_restrictions,
         const std::vector<ConditionalTurnRestriction> &conditional_turn_restrictions,
         const NameTable &name_table,
         LaneDescriptionMap lane_description_map,
         ScriptingEnvironment &scripting_environment);
+
+    // Writes the guidance files without turn instructions, lanes and intersection classes
+    void WriteGuidanceStubs(const std::size_t number_of_node_based_nodes,
+                            const std::size_t number_of_edge_based_edges,
+                            const LaneDescriptionMap &lane_description_map,
+                            const std::uint32_t connectivity_checksum);
 };
 }
 }
@@ -31,6 +31,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/filesystem/path.hpp>
 
 #include <array>
+#include <cstdint>
 #include <string>
 
 #include "storage/io_config.hpp"
@@ -67,10 +68,16 @@ struct ExtractorConfig final : storage::IOConfig
                                       ".osrm.icd",
                                       ".osrm.cnbg",
                                       ".osrm.cnbg_to_ebg",
-                                      ".osrm.maneuver_overrides"}),
+                                      ".osrm.maneuver_overrides",
+                                      ".osrm.geometry_coordinates"}),
                                  requested_num_threads(0),
+                                 external_memory_buffer_size(1024), rtree_branching_factor(64),
+                                 rtree_leaf_page_size(4096),
                                  parse_conditionals(false),
-                                 use_locations_cache(true)
+                                 use_locations_cache(true), skip_guidance(false),
+                                 compact_geometry_coordinates(false),
+                                 compress_intermediate_files(false), spatial_node_order(false),
+                                 location_index_type("auto")
     {
     }
 
@@ -80,17 +87,40 @@ struct ExtractorConfig final : storage::IOConfig
     }
 
     boost::filesystem::path input_path;
+    // OSM change files that are applied to the input, in the order they were published
+    std::vector<boost::filesystem::path> change_paths;
     boost::filesystem::path profile_path;
     std::vector<boost::filesystem::path> location_dependent_data_paths;
+    // directory of the spilled nodes and edges, empty to keep them in memory
+    boost::filesystem::path external_memory_path;
+    // the relations the profile uses, written on the first extraction of an input and read
+    // instead of the input by the next ones, empty to read the relations from the input
+    boost::filesystem::path relation_index_path;
 
     unsigned requested_num_threads;
+    // in MiB for the nodes and for the edges
+    std::size_t external_memory_buffer_size;
     unsigned small_component_size;
+    // fan-out of the inner r-tree nodes and size in bytes of the leaf pages in the .fileIndex
+    std::uint32_t rtree_branching_factor;
+    std::uint32_t rtree_leaf_page_size;
 
     bool generate_edge_lookup;
 
     bool use_metadata;
     bool parse_conditionals;
     bool use_locations_cache;
+    // do not compute turn instructions and lanes, for datasets that only serve routes without steps
+    bool skip_guidance;
+    // also store the coordinates of the segment geometries as deltas to their first node
+    bool compact_geometry_coordinates;
+    // deflate the graphs that only the other tools read, .osrm.cnbg, .osrm.enw and .osrm.ebg
+    bool compress_intermediate_files;
+    // number the nodes along the Hilbert curve of their coordinates instead of their OSM ids
+    bool spatial_node_order;
+    // libosmium index type of the node locations cache, like "flex_mem" or
+    // "dense_file_array,<path>", or "auto" to select by the input size
+    std::string location_index_type;
 };
 }
 }
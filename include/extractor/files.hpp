@@ -9,6 +9,7 @@
 #include "extractor/turn_lane_types.hpp"
 
 #include "util/coordinate.hpp"
+#include "util/dictionary_vector.hpp"
 #include "util/guidance/bearing_class.hpp"
 #include "util/guidance/entry_class.hpp"
 #include "util/guidance/turn_lanes.hpp"
@@ -81,11 +82,14 @@ template <typename EdgeBasedEdgeVector>
 void writeEdgeBasedGraph(const boost::filesystem::path &path,
                          EdgeID const number_of_edge_based_nodes,
                          const EdgeBasedEdgeVector &edge_based_edge_list,
-                         const std::uint32_t connectivity_checksum)
+                         const std::uint32_t connectivity_checksum,
+                         const storage::tar::FileWriter::CompressionFlag compression =
+                             storage::tar::FileWriter::Uncompressed)
 {
     static_assert(std::is_same<typename EdgeBasedEdgeVector::value_type, EdgeBasedEdge>::value, "");
 
-    storage::tar::FileWriter writer(path, storage::tar::FileWriter::GenerateFingerprint);
+    storage::tar::FileWriter writer(
+        path, storage::tar::FileWriter::GenerateFingerprint, compression);
 
     writer.WriteElementCount64("/common/number_of_edge_based_nodes", 1);
     writer.WriteFrom("/common/number_of_edge_based_nodes", number_of_edge_based_nodes);
@@ -217,6 +221,34 @@ inline void writeSegmentData(const boost::filesystem::path &path, const SegmentD
     serialization::write(writer, "/common/segment_data", segment_data);
 }
 
+// reads .osrm.geometry_coordinates
+template <typename GeometryCoordinatesT>
+inline void readGeometryCoordinates(const boost::filesystem::path &path,
+                                    GeometryCoordinatesT &geometry_coordinates)
+{
+    static_assert(std::is_same<GeometryCoordinatesContainer, GeometryCoordinatesT>::value ||
+                      std::is_same<GeometryCoordinatesView, GeometryCoordinatesT>::value,
+                  "");
+    const auto fingerprint = storage::tar::FileReader::VerifyFingerprint;
+    storage::tar::FileReader reader{path, fingerprint};
+
+    serialization::read(reader, "/common/geometry_coordinates", geometry_coordinates);
+}
+
+// writes .osrm.geometry_coordinates
+template <typename GeometryCoordinatesT>
+inline void writeGeometryCoordinates(const boost::filesystem::path &path,
+                                     const GeometryCoordinatesT &geometry_coordinates)
+{
+    static_assert(std::is_same<GeometryCoordinatesContainer, GeometryCoordinatesT>::value ||
+                      std::is_same<GeometryCoordinatesView, GeometryCoordinatesT>::value,
+                  "");
+    const auto fingerprint = storage::tar::FileWriter::GenerateFingerprint;
+    storage::tar::FileWriter writer{path, fingerprint};
+
+    serialization::write(writer, "/common/geometry_coordinates", geometry_coordinates);
+}
+
 // reads .osrm.ebg_nodes
 template <typename NodeDataT>
 inline void readNodeData(const boost::filesystem::path &path, NodeDataT &node_data)
@@ -337,15 +369,15 @@ inline void writeManeuverOverrides(const boost::filesystem::path &path,
         writer, "/common/maneuver_overrides/node_sequences", node_sequences);
 }
 
-// writes .osrm.turn_weight_penalties
-template <typename TurnPenaltyT>
+// writes .osrm.turn_weight_penalties, dictionary coded since most penalties repeat
 inline void writeTurnWeightPenalty(const boost::filesystem::path &path,
-                                   const TurnPenaltyT &turn_penalty)
+                                   const std::vector<TurnPenalty> &turn_penalty)
 {
     const auto fingerprint = storage::tar::FileWriter::GenerateFingerprint;
     storage::tar::FileWriter writer{path, fingerprint};
 
-    storage::serialization::write(writer, "/common/turn_penalty/weight", turn_penalty);
+    util::serialization::write(
+        writer, "/common/turn_penalty/weight", util::DictionaryVector<TurnPenalty>{turn_penalty});
 }
 
 // read .osrm.turn_weight_penalties
@@ -355,28 +387,46 @@ inline void readTurnWeightPenalty(const boost::filesystem::path &path, TurnPenal
     const auto fingerprint = storage::tar::FileReader::VerifyFingerprint;
     storage::tar::FileReader reader{path, fingerprint};
 
-    storage::serialization::read(reader, "/common/turn_penalty/weight", turn_penalty);
+    util::serialization::read(reader, "/common/turn_penalty/weight", turn_penalty);
 }
 
-// writes .osrm.turn_duration_penalties
-template <typename TurnPenaltyT>
+// read .osrm.turn_weight_penalties into a vector that can be updated
+inline void readTurnWeightPenalty(const boost::filesystem::path &path,
+                                  std::vector<TurnPenalty> &turn_penalty)
+{
+    util::DictionaryVector<TurnPenalty> compact_turn_penalty;
+    readTurnWeightPenalty(path, compact_turn_penalty);
+    turn_penalty.assign(compact_turn_penalty.begin(), compact_turn_penalty.end());
+}
+
+// writes .osrm.turn_duration_penalties, dictionary coded since most penalties repeat
 inline void writeTurnDurationPenalty(const boost::filesystem::path &path,
-                                     const TurnPenaltyT &turn_penalty)
+                                     const std::vector<TurnPenalty> &turn_penalty)
 {
     const auto fingerprint = storage::tar::FileWriter::GenerateFingerprint;
     storage::tar::FileWriter writer{path, fingerprint};
 
-    storage::serialization::write(writer, "/common/turn_penalty/duration", turn_penalty);
+    util::serialization::write(
+        writer, "/common/turn_penalty/duration", util::DictionaryVector<TurnPenalty>{turn_penalty});
 }
 
-// read .osrm.turn_weight_penalties
+// read .osrm.turn_duration_penalties
 template <typename TurnPenaltyT>
 inline void readTurnDurationPenalty(const boost::filesystem::path &path, TurnPenaltyT &turn_penalty)
 {
     const auto fingerprint = storage::tar::FileReader::VerifyFingerprint;
     storage::tar::FileReader reader{path, fingerprint};
 
-    storage::serialization::read(reader, "/common/turn_penalty/duration", turn_penalty);
+    util::serialization::read(reader, "/common/turn_penalty/duration", turn_penalty);
+}
+
+// read .osrm.turn_duration_penalties into a vector that can be updated
+inline void readTurnDurationPenalty(const boost::filesystem::path &path,
+                                    std::vector<TurnPenalty> &turn_penalty)
+{
+    util::DictionaryVector<TurnPenalty> compact_turn_penalty;
+    readTurnDurationPenalty(path, compact_turn_penalty);
+    turn_penalty.assign(compact_turn_penalty.begin(), compact_turn_penalty.end());
 }
 
 // writes .osrm.restrictions
@@ -464,10 +514,12 @@ void readEdgeBasedNodeWeights(const boost::filesystem::path &path, NodeWeigtsVec
 
 template <typename NodeWeigtsVectorT>
 void writeEdgeBasedNodeWeights(const boost::filesystem::path &path,
-                               const NodeWeigtsVectorT &weights)
+                               const NodeWeigtsVectorT &weights,
+                               const storage::tar::FileWriter::CompressionFlag compression =
+                                   storage::tar::FileWriter::Uncompressed)
 {
     const auto fingerprint = storage::tar::FileWriter::GenerateFingerprint;
-    storage::tar::FileWriter writer{path, fingerprint};
+    storage::tar::FileWriter writer{path, fingerprint, compression};
 
     storage::serialization::write(writer, "/extractor/edge_based_node_weights", weights);
 }
@@ -490,10 +542,13 @@ template <typename RTreeT> void readRamIndex(const boost::filesystem::path &path
 }
 
 template <typename EdgeListT>
-void writeCompressedNodeBasedGraph(const boost::filesystem::path &path, const EdgeListT &edge_list)
+void writeCompressedNodeBasedGraph(const boost::filesystem::path &path,
+                                   const EdgeListT &edge_list,
+                                   const storage::tar::FileWriter::CompressionFlag compression =
+                                       storage::tar::FileWriter::Uncompressed)
 {
     const auto fingerprint = storage::tar::FileWriter::GenerateFingerprint;
-    storage::tar::FileWriter writer{path, fingerprint};
+    storage::tar::FileWriter writer{path, fingerprint, compression};
 
     storage::serialization::write(writer, "/extractor/cnbg", edge_list);
 }
@@ -0,0 +1,173 @@
+#ifndef OSRM_EXTRACTOR_GEOMETRY_COORDINATES_CONTAINER_HPP_
+#define OSRM_EXTRACTOR_GEOMETRY_COORDINATES_CONTAINER_HPP_
+
+#include "extractor/segment_data_container.hpp"
+
+#include "util/coordinate.hpp"
+#include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
+
+#include "storage/shared_memory_ownership.hpp"
+#include "storage/tar_fwd.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+namespace detail
+{
+template <storage::Ownership Ownership> class GeometryCoordinatesContainerImpl;
+}
+
+namespace serialization
+{
+template <storage::Ownership Ownership>
+inline void read(storage::tar::FileReader &reader,
+                 const std::string &name,
+                 detail::GeometryCoordinatesContainerImpl<Ownership> &geometry_coordinates);
+template <storage::Ownership Ownership>
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const detail::GeometryCoordinatesContainerImpl<Ownership> &geometry_coordinates);
+}
+
+namespace detail
+{
+/**
+ * Coordinates of the nodes of the segment geometries, in the order of the nodes in the segment
+ * data. Every geometry stores the fixed-point coordinate of its first node and the other nodes as
+ * 16 bit deltas to it, the longitudes and the latitudes in separate vectors. The coordinates of a
+ * geometry are decoded from consecutive memory instead of one random access per node.
+ *
+ * Nodes that are too far from the first node of their geometry for a 16 bit delta are marked and
+ * need to be looked up by their node id.
+ */
+template <storage::Ownership Ownership> class GeometryCoordinatesContainerImpl
+{
+    template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
+
+  public:
+    using DirectionalGeometryID = SegmentDataContainer::DirectionalGeometryID;
+    using SegmentOffset = SegmentDataContainer::SegmentOffset;
+
+    // marks deltas that do not fit, the largest fitting delta is about 3.6km in latitude
+    static constexpr std::int16_t FAR_DELTA = std::numeric_limits<std::int16_t>::min();
+
+    GeometryCoordinatesContainerImpl() = default;
+
+    GeometryCoordinatesContainerImpl(Vector<std::int32_t> first_lons_,
+                                     Vector<std::int32_t> first_lats_,
+                                     Vector<std::int16_t> lon_deltas_,
+                                     Vector<std::int16_t> lat_deltas_)
+        : first_lons(std::move(first_lons_)), first_lats(std::move(first_lats_)),
+          lon_deltas(std::move(lon_deltas_)), lat_deltas(std::move(lat_deltas_))
+    {
+        BOOST_ASSERT(first_lons.size() == first_lats.size());
+        BOOST_ASSERT(lon_deltas.size() == lat_deltas.size());
+    }
+
+    template <bool enabled = (Ownership == storage::Ownership::Container)>
+    GeometryCoordinatesContainerImpl(const SegmentDataContainer &segment_data,
+                                     const std::vector<util::Coordinate> &coordinates,
+                                     typename std::enable_if<enabled>::type * = 0)
+    {
+        const auto number_of_geometries = segment_data.GetNumberOfGeometries();
+        first_lons.reserve(number_of_geometries);
+        first_lats.reserve(number_of_geometries);
+
+        const auto delta = [](const auto value, const std::int32_t first_value) {
+            return static_cast<std::int64_t>(static_cast<std::int32_t>(value)) - first_value;
+        };
+        const auto fits = [](const std::int64_t value) {
+            return std::abs(value) <= std::numeric_limits<std::int16_t>::max();
+        };
+
+        std::vector<NodeID> nodes;
+        for (DirectionalGeometryID id = 0; id < number_of_geometries; ++id)
+        {
+            segment_data.UnpackForwardGeometry(id, nodes);
+            BOOST_ASSERT(segment_data.GetGeometryPositions(id).first == lon_deltas.size());
+
+            const auto first = nodes.empty() ? util::Coordinate{} : coordinates[nodes.front()];
+            first_lons.push_back(static_cast<std::int32_t>(first.lon));
+            first_lats.push_back(static_cast<std::int32_t>(first.lat));
+
+            for (const auto node : nodes)
+            {
+                const auto lon_delta = delta(coordinates[node].lon, first_lons.back());
+                const auto lat_delta = delta(coordinates[node].lat, first_lats.back());
+                const auto is_near = fits(lon_delta) && fits(lat_delta);
+                lon_deltas.push_back(is_near ? static_cast<std::int16_t>(lon_delta) : FAR_DELTA);
+                lat_deltas.push_back(is_near ? static_cast<std::int16_t>(lat_delta) : FAR_DELTA);
+            }
+        }
+    }
+
+    // Decodes the coordinates of the nodes [first, last) of a geometry, the positions of the
+    // segment data. The coordinates of far nodes are looked up with their offset in the geometry.
+    template <typename OutputIter, typename LookupT>
+    OutputIter Unpack(const DirectionalGeometryID id,
+                      const SegmentOffset first,
+                      const SegmentOffset last,
+                      OutputIter out,
+                      LookupT lookup) const
+    {
+        BOOST_ASSERT(id < first_lons.size());
+        BOOST_ASSERT(first <= last && last <= lon_deltas.size());
+        const auto first_lon = first_lons[id];
+        const auto first_lat = first_lats[id];
+        for (auto position = first; position < last; ++position)
+        {
+            const auto lon_delta = lon_deltas[position];
+            if (lon_delta == FAR_DELTA)
+            {
+                *out++ = lookup(position - first);
+            }
+            else
+            {
+                *out++ = util::Coordinate{util::FixedLongitude{first_lon + lon_delta},
+                                          util::FixedLatitude{first_lat + lat_deltas[position]}};
+            }
+        }
+        return out;
+    }
+
+    auto GetNumberOfGeometries() const { return first_lons.size(); }
+
+    bool empty() const { return first_lons.empty(); }
+
+    friend void
+    serialization::read<Ownership>(storage::tar::FileReader &reader,
+                                   const std::string &name,
+                                   detail::GeometryCoordinatesContainerImpl<Ownership> &container);
+    friend void serialization::write<Ownership>(
+        storage::tar::FileWriter &writer,
+        const std::string &name,
+        const detail::GeometryCoordinatesContainerImpl<Ownership> &container);
+
+  private:
+    Vector<std::int32_t> first_lons;
+    Vector<std::int32_t> first_lats;
+    Vector<std::int16_t> lon_deltas;
+    Vector<std::int16_t> lat_deltas;
+};
+
+template <storage::Ownership Ownership>
+constexpr std::int16_t GeometryCoordinatesContainerImpl<Ownership>::FAR_DELTA;
+}
+
+using GeometryCoordinatesContainer =
+    detail::GeometryCoordinatesContainerImpl<storage::Ownership::Container>;
+using GeometryCoordinatesView = detail::GeometryCoordinatesContainerImpl<storage::Ownership::View>;
+}
+}
+
+#endif
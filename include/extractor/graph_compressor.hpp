@@ -2,13 +2,13 @@
 #define GEOMETRY_COMPRESSOR_HPP
 
 #include "extractor/scripting_environment.hpp"
+#include "util/id_set.hpp"
 #include "util/typedefs.hpp"
 
 #include "extractor/maneuver_override.hpp"
 #include "util/node_based_graph.hpp"
 
 #include <memory>
-#include <unordered_set>
 #include <vector>
 
 namespace osrm
@@ -24,8 +24,8 @@ class GraphCompressor
     using EdgeData = util::NodeBasedDynamicGraph::EdgeData;
 
   public:
-    void Compress(const std::unordered_set<NodeID> &barrier_nodes,
-                  const std::unordered_set<NodeID> &traffic_lights,
+    void Compress(const util::IdSet<NodeID> &barrier_nodes,
+                  const util::IdSet<NodeID> &traffic_lights,
                   ScriptingEnvironment &scripting_environment,
                   std::vector<TurnRestriction> &turn_restrictions,
                   std::vector<ConditionalTurnRestriction> &conditional_turn_restrictions,
@@ -9,6 +9,7 @@
 #include "extractor/turn_lane_types.hpp"
 
 #include "util/coordinate.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 
 #include <unordered_set>
@@ -30,7 +31,7 @@ IntersectionEdges getOutgoingEdges(const util::NodeBasedDynamicGraph &graph,
 bool isTurnAllowed(const util::NodeBasedDynamicGraph &graph,
                    const EdgeBasedNodeDataContainer &node_data_container,
                    const RestrictionMap &restriction_map,
-                   const std::unordered_set<NodeID> &barrier_nodes,
+                   const util::IdSet<NodeID> &barrier_nodes,
                    const IntersectionEdgeGeometries &geometries,
                    const TurnLanesIndexedArray &turn_lanes_data,
                    const IntersectionEdge &from,
@@ -40,6 +41,22 @@ double findEdgeBearing(const IntersectionEdgeGeometries &geometries, const EdgeI
 
 double findEdgeLength(const IntersectionEdgeGeometries &geometries, const EdgeID &edge);
 
+// Geometries of the outgoing edges of the intersection with the bearings of mergeable roads
+// adjusted, and the ids of the merged edges that are left out of the intersection views.
+// The edges are ordered by their perceived bearings before the adjustment.
+std::pair<IntersectionEdgeGeometries, std::unordered_set<EdgeID>>
+getMergedOutgoingGeometries(const util::NodeBasedDynamicGraph &graph,
+                            const extractor::CompressedEdgeContainer &compressed_geometries,
+                            const std::vector<util::Coordinate> &node_coordinates,
+                            const MergableRoadDetector &detector,
+                            const NodeID intersection);
+
+// Adds the incoming edges with the reversed bearings of the outgoing edge geometries and orders
+// all of them by their edge ids, as findEdgeBearing and findEdgeLength expect
+IntersectionEdgeGeometries addIncomingGeometries(const util::NodeBasedDynamicGraph &graph,
+                                                 const NodeID intersection,
+                                                 IntersectionEdgeGeometries outgoing_geometries);
+
 std::pair<IntersectionEdgeGeometries, std::unordered_set<EdgeID>>
 getIntersectionGeometries(const util::NodeBasedDynamicGraph &graph,
                           const extractor::CompressedEdgeContainer &compressed_geometries,
@@ -50,7 +67,7 @@ getIntersectionGeometries(const util::NodeBasedDynamicGraph &graph,
 IntersectionView convertToIntersectionView(const util::NodeBasedDynamicGraph &graph,
                                            const EdgeBasedNodeDataContainer &node_data_container,
                                            const RestrictionMap &restriction_map,
-                                           const std::unordered_set<NodeID> &barrier_nodes,
+                                           const util::IdSet<NodeID> &barrier_nodes,
                                            const IntersectionEdgeGeometries &edge_geometries,
                                            const TurnLanesIndexedArray &turn_lanes_data,
                                            const IntersectionEdge &incoming_edge,
@@ -66,7 +83,7 @@ IntersectionView getConnectedRoads(const util::NodeBasedDynamicGraph &graph,
                                    const std::vector<util::Coordinate> &node_coordinates,
                                    const extractor::CompressedEdgeContainer &compressed_geometries,
                                    const RestrictionMap &node_restriction_map,
-                                   const std::unordered_set<NodeID> &barrier_nodes,
+                                   const util::IdSet<NodeID> &barrier_nodes,
                                    const TurnLanesIndexedArray &turn_lanes_data,
                                    const IntersectionEdge &incoming_edge);
 
@@ -0,0 +1,58 @@
+#ifndef OSRM_EXTRACTOR_INTERSECTION_INTERSECTION_GEOMETRY_CACHE_HPP
+#define OSRM_EXTRACTOR_INTERSECTION_INTERSECTION_GEOMETRY_CACHE_HPP
+
+#include "extractor/compressed_edge_container.hpp"
+#include "extractor/intersection/intersection_edge.hpp"
+#include "extractor/intersection/mergable_road_detector.hpp"
+
+#include "util/coordinate.hpp"
+#include "util/node_based_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+namespace intersection
+{
+
+/**
+ * The results of getIntersectionGeometries for all intersections of a node-based graph.
+ *
+ * Merging roads needs the geometries of the neighbor intersections as well, which makes the
+ * intersection geometries the most expensive part of the turn generation and of the guidance.
+ * Both passes run over the same graph, so the geometries are computed once in parallel and
+ * shared. Only the outgoing edges are kept, at the positions of the edges of the graph, the
+ * incoming ones are derived from them on access.
+ */
+class IntersectionGeometryCache
+{
+  public:
+    IntersectionGeometryCache() = default;
+
+    IntersectionGeometryCache(const util::NodeBasedDynamicGraph &graph,
+                              const CompressedEdgeContainer &compressed_geometries,
+                              const std::vector<util::Coordinate> &node_coordinates,
+                              const MergableRoadDetector &detector);
+
+    // Same result as getIntersectionGeometries for the graph the cache was built for
+    std::pair<IntersectionEdgeGeometries, std::unordered_set<EdgeID>>
+    Get(const util::NodeBasedDynamicGraph &graph, const NodeID intersection) const;
+
+    bool Empty() const { return outgoing_geometries.empty(); }
+
+  private:
+    // Outgoing edges of a node start at its first edge in the order of getMergedOutgoingGeometries
+    IntersectionEdgeGeometries outgoing_geometries;
+    // Sorted, merged edges are rare
+    std::vector<EdgeID> merged_edges;
+};
+}
+}
+}
+
+#endif
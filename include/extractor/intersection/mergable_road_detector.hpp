@@ -11,13 +11,13 @@
 #include "guidance/intersection.hpp"
 
 #include "util/coordinate.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 #include "util/typedefs.hpp"
 
 #include <cstdint>
 #include <functional>
 #include <limits>
-#include <unordered_set>
 #include <vector>
 
 namespace osrm
@@ -50,7 +50,7 @@ class MergableRoadDetector
                          const std::vector<util::Coordinate> &node_coordinates,
                          const extractor::CompressedEdgeContainer &compressed_geometries,
                          const RestrictionMap &node_restriction_map,
-                         const std::unordered_set<NodeID> &barrier_nodes,
+                         const util::IdSet<NodeID> &barrier_nodes,
                          const TurnLanesIndexedArray &turn_lanes_data,
                          const extractor::NameTable &name_table,
                          const SuffixTable &street_name_suffix_table);
@@ -167,7 +167,7 @@ class MergableRoadDetector
     const std::vector<util::Coordinate> &node_coordinates;
     const extractor::CompressedEdgeContainer &compressed_geometries;
     const RestrictionMap &node_restriction_map;
-    const std::unordered_set<NodeID> &barrier_nodes;
+    const util::IdSet<NodeID> &barrier_nodes;
     const TurnLanesIndexedArray &turn_lanes_data;
 
     // name detection
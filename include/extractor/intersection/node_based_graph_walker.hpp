@@ -7,6 +7,7 @@
 #include "guidance/turn_lane_data.hpp"
 #include "util/coordinate.hpp"
 #include "util/coordinate_calculation.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 #include "util/typedefs.hpp"
 
@@ -34,7 +35,7 @@ class NodeBasedGraphWalker
                          const std::vector<util::Coordinate> &node_coordinates,
                          const extractor::CompressedEdgeContainer &compressed_geometries,
                          const RestrictionMap &node_restriction_map,
-                         const std::unordered_set<NodeID> &barrier_nodes,
+                         const util::IdSet<NodeID> &barrier_nodes,
                          const TurnLanesIndexedArray &turn_lanes_data);
 
     /*
@@ -57,7 +58,7 @@ class NodeBasedGraphWalker
     const std::vector<util::Coordinate> &node_coordinates;
     const extractor::CompressedEdgeContainer &compressed_geometries;
     const RestrictionMap &node_restriction_map;
-    const std::unordered_set<NodeID> &barrier_nodes;
+    const util::IdSet<NodeID> &barrier_nodes;
     const TurnLanesIndexedArray &turn_lanes_data;
 };
 
@@ -164,7 +165,7 @@ struct IntersectionFinderAccumulator
                                   const std::vector<util::Coordinate> &node_coordinates,
                                   const extractor::CompressedEdgeContainer &compressed_geometries,
                                   const RestrictionMap &node_restriction_map,
-                                  const std::unordered_set<NodeID> &barrier_nodes,
+                                  const util::IdSet<NodeID> &barrier_nodes,
                                   const TurnLanesIndexedArray &turn_lanes_data);
     // true if the path has traversed enough distance
     bool terminate();
@@ -186,7 +187,7 @@ struct IntersectionFinderAccumulator
     const std::vector<util::Coordinate> &node_coordinates;
     const extractor::CompressedEdgeContainer &compressed_geometries;
     const RestrictionMap &node_restriction_map;
-    const std::unordered_set<NodeID> &barrier_nodes;
+    const util::IdSet<NodeID> &barrier_nodes;
     const TurnLanesIndexedArray &turn_lanes_data;
 };
 
@@ -4,12 +4,13 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point_xy.hpp>
-#include <boost/geometry/index/rtree.hpp>
 
 #include <osmium/osm/way.hpp>
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace osrm
 {
@@ -26,27 +27,50 @@ struct LocationDependentData
     using box_t = boost::geometry::model::box<point_t>;
 
     using polygon_position_t = std::size_t;
-    using rtree_t = boost::geometry::index::rtree<std::pair<box_t, polygon_position_t>,
-                                                  boost::geometry::index::rstar<8>>;
 
     using property_t = boost::variant<boost::blank, double, std::string, bool>;
     using properties_t = std::unordered_map<std::string, property_t>;
 
     LocationDependentData(const std::vector<boost::filesystem::path> &file_paths);
 
-    bool empty() const { return rtree.empty(); }
+    bool empty() const { return polygons.empty(); }
 
     std::vector<std::size_t> GetPropertyIndexes(const point_t &point) const;
 
     property_t FindByKey(const std::vector<std::size_t> &property_indexes, const char *key) const;
 
   private:
-    void loadLocationDependentData(const boost::filesystem::path &file_path,
-                                   std::vector<rtree_t::value_type> &bounding_boxes);
+    struct polygon_data_t
+    {
+        box_t envelop;
+        polygon_bands_t bands;
+        std::size_t properties_index;
+    };
 
-    rtree_t rtree;
-    std::vector<std::pair<polygon_bands_t, std::size_t>> polygons;
+    // A uniform grid over the polygons. Every cell lists the polygons that cover it completely
+    // and the polygons whose boundary crosses it, only the latter need the exact test. The lists
+    // are sorted by polygon and stored in one vector, the entries are the polygon position
+    // shifted by one with the lowest bit set for crossing boundaries.
+    struct grid_t
+    {
+        box_t bounds;
+        std::size_t columns = 0;
+        std::size_t rows = 0;
+        double cell_width = 0;
+        double cell_height = 0;
+        std::vector<std::uint32_t> first_entries;
+        std::vector<std::uint32_t> entries;
+    };
+
+    void loadLocationDependentData(const boost::filesystem::path &file_path);
+
+    void buildGrid();
+
+    bool isInside(const point_t &point, const polygon_position_t polygon_position) const;
+
+    std::vector<polygon_data_t> polygons;
     std::vector<properties_t> properties;
+    grid_t grid;
 };
 }
 }
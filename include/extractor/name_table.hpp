@@ -5,7 +5,14 @@
 #include "util/string_view.hpp"
 #include "util/typedefs.hpp"
 
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace osrm
 {
@@ -46,6 +53,13 @@ namespace detail
 //
 // Offset 0 is name, 1 is destination, 2 is pronunciation, 3 is ref, 4 is exits
 // See datafacades and extractor callbacks for details.
+//
+// A string that is longer than a reference and was already stored for a smaller index is
+// stored as a reference to it: a NUL byte followed by the index of the first string. Tag
+// values never contain NUL bytes, so a reference resolves with one more block decode.
+const constexpr char NAME_REFERENCE_MARKER = '\0';
+const constexpr std::size_t NAME_REFERENCE_SIZE = 1 + sizeof(std::uint32_t);
+
 template <storage::Ownership Ownership> class NameTableImpl
 {
   public:
@@ -58,12 +72,55 @@ template <storage::Ownership Ownership> class NameTableImpl
 
     NameTableImpl(IndexedData indexed_data_) : indexed_data{std::move(indexed_data_)} {}
 
+    // Stores the strings [data + *first, data + *std::next(first)) up to the sentinel offset
+    // at std::prev(last) and replaces repeated strings by references to their first index
+    template <typename OffsetIterator, typename DataIterator>
+    NameTableImpl(OffsetIterator first, OffsetIterator last, DataIterator data)
+    {
+        BOOST_ASSERT(first < last);
+
+        std::unordered_map<util::StringView, std::uint32_t> first_indexes;
+        std::vector<std::uint32_t> offsets;
+        std::vector<unsigned char> char_data;
+        offsets.reserve(std::distance(first, last));
+
+        for (auto current = first, next = std::next(first); next != last; ++current, ++next)
+        {
+            const std::uint32_t index = std::distance(first, current);
+            offsets.push_back(char_data.size());
+
+            if (*next - *current <= NAME_REFERENCE_SIZE)
+            {
+                char_data.insert(char_data.end(), data + *current, data + *next);
+                continue;
+            }
+
+            const util::StringView value(reinterpret_cast<const char *>(&*(data + *current)),
+                                         *next - *current);
+            const auto inserted = first_indexes.insert({value, index});
+            if (inserted.second)
+            {
+                char_data.insert(char_data.end(), value.begin(), value.end());
+            }
+            else
+            {
+                const auto first_index = inserted.first->second;
+                char_data.push_back(NAME_REFERENCE_MARKER);
+                const auto reference = reinterpret_cast<const unsigned char *>(&first_index);
+                char_data.insert(char_data.end(), reference, reference + sizeof(first_index));
+            }
+        }
+        offsets.push_back(char_data.size());
+
+        indexed_data = IndexedData(offsets.begin(), offsets.end(), char_data.begin());
+    }
+
     util::StringView GetNameForID(const NameID id) const
     {
         if (id == INVALID_NAMEID)
             return {};
 
-        return indexed_data.at(id + 0);
+        return GetStringForIndex(id + 0);
     }
 
     util::StringView GetDestinationsForID(const NameID id) const
@@ -71,7 +128,7 @@ template <storage::Ownership Ownership> class NameTableImpl
         if (id == INVALID_NAMEID)
             return {};
 
-        return indexed_data.at(id + 1);
+        return GetStringForIndex(id + 1);
     }
 
     util::StringView GetExitsForID(const NameID id) const
@@ -79,7 +136,7 @@ template <storage::Ownership Ownership> class NameTableImpl
         if (id == INVALID_NAMEID)
             return {};
 
-        return indexed_data.at(id + 4);
+        return GetStringForIndex(id + 4);
     }
 
     util::StringView GetRefForID(const NameID id) const
@@ -88,7 +145,7 @@ template <storage::Ownership Ownership> class NameTableImpl
             return {};
 
         const constexpr auto OFFSET_REF = 3u;
-        return indexed_data.at(id + OFFSET_REF);
+        return GetStringForIndex(id + OFFSET_REF);
     }
 
     util::StringView GetPronunciationForID(const NameID id) const
@@ -97,7 +154,7 @@ template <storage::Ownership Ownership> class NameTableImpl
             return {};
 
         const constexpr auto OFFSET_PRONUNCIATION = 2u;
-        return indexed_data.at(id + OFFSET_PRONUNCIATION);
+        return GetStringForIndex(id + OFFSET_PRONUNCIATION);
     }
 
     friend void serialization::read<Ownership>(storage::tar::FileReader &reader,
@@ -109,6 +166,18 @@ template <storage::Ownership Ownership> class NameTableImpl
                                                 const NameTableImpl &index_data);
 
   private:
+    util::StringView GetStringForIndex(const std::uint32_t index) const
+    {
+        const util::StringView value = indexed_data.at(index);
+        if (value.size() != NAME_REFERENCE_SIZE || value.front() != NAME_REFERENCE_MARKER)
+            return value;
+
+        std::uint32_t first_index;
+        std::memcpy(&first_index, value.data() + 1, sizeof(first_index));
+        BOOST_ASSERT(first_index < index);
+        return indexed_data.at(first_index);
+    }
+
     IndexedData indexed_data;
 };
 }
@@ -9,13 +9,13 @@
 #include "extractor/scripting_environment.hpp"
 
 #include "util/coordinate.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 
 #include <boost/filesystem/path.hpp>
 
 #include <memory>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
 namespace osrm
@@ -41,7 +41,8 @@ class NodeBasedGraphFactory
                           ScriptingEnvironment &scripting_environment,
                           std::vector<TurnRestriction> &turn_restrictions,
                           std::vector<ConditionalTurnRestriction> &conditional_turn_restrictions,
-                          std::vector<UnresolvedManeuverOverride> &maneuver_overrides);
+                          std::vector<UnresolvedManeuverOverride> &maneuver_overrides,
+                          const bool spatial_node_order = false);
 
     auto const &GetGraph() const { return compressed_output_graph; }
     auto const &GetBarriers() const { return barriers; }
@@ -61,8 +62,11 @@ class NodeBasedGraphFactory
 
   private:
     // Get the information from the *.osrm file (direct product of the extractor callback/extraction
-    // containers) and prepare the graph creation process
-    void LoadDataFromFile(const boost::filesystem::path &input_file);
+    // containers) and prepare the graph creation process. With spatial_node_order the nodes are
+    // renumbered along the Hilbert curve of their coordinates instead of keeping the order of their
+    // OSM ids, the mapping of the old to the new ids is returned to renumber the restrictions.
+    std::vector<NodeID> LoadDataFromFile(const boost::filesystem::path &input_file,
+                                         const bool spatial_node_order);
 
     // Compress the node-based graph into a compact representation of itself. This removes storing a
     // single edge for every part of the geometry and might also combine meta-data for multiple
@@ -90,8 +94,8 @@ class NodeBasedGraphFactory
     std::vector<NodeBasedEdgeAnnotation> annotation_data;
 
     // General Information about the graph, not used outside of extractor
-    std::unordered_set<NodeID> barriers;
-    std::unordered_set<NodeID> traffic_signals;
+    util::IdSet<NodeID> barriers;
+    util::IdSet<NodeID> traffic_signals;
 
     std::vector<util::Coordinate> coordinates;
 
@@ -102,7 +102,7 @@ template <storage::Ownership Ownership> class EdgeBasedNodeDataContainerImpl
     template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
     void Renumber(const std::vector<std::uint32_t> &permutation)
     {
-        util::inplacePermutation(nodes.begin(), nodes.end(), permutation);
+        util::parallelPermutation(nodes.begin(), nodes.end(), permutation);
     }
 
     NodeID NumberOfNodes() const { return nodes.size(); }
@@ -0,0 +1,64 @@
+#ifndef OSRM_EXTRACTOR_OSM_CHANGE_SET_HPP
+#define OSRM_EXTRACTOR_OSM_CHANGE_SET_HPP
+
+#include <boost/filesystem/path.hpp>
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * The changes of OSM change files (.osc) that are applied to the input while it is read.
+ *
+ * The change files are read into memory once. Of several changes to an object the last one of
+ * the last file wins, so daily diffs are given in the order they were published. The input has
+ * to be sorted by type and id, like the planet files and extracts.
+ *
+ * A Merger applies the changes to the buffers of one pass over the input: modified objects
+ * replace their old version, deleted objects are dropped and created objects are inserted at
+ * their position in the order of the input.
+ */
+class OSMChangeSet
+{
+  public:
+    explicit OSMChangeSet(const std::vector<boost::filesystem::path> &change_paths);
+
+    OSMChangeSet(const OSMChangeSet &) = delete;
+    OSMChangeSet &operator=(const OSMChangeSet &) = delete;
+
+    std::size_t GetNumberOfChanges() const { return objects.size(); }
+
+    class Merger
+    {
+      public:
+        // Only changes of the entities that the pass reads are applied
+        Merger(const OSMChangeSet &change_set, const osmium::osm_entity_bits::type entities);
+
+        // Returns the objects of buffer with the changes applied
+        osmium::memory::Buffer Apply(const osmium::memory::Buffer &buffer);
+
+        // Returns the created objects that come after the last object of the input
+        osmium::memory::Buffer Finish();
+
+      private:
+        std::vector<const osmium::OSMObject *> objects;
+        std::vector<const osmium::OSMObject *>::const_iterator next;
+    };
+
+  private:
+    std::vector<osmium::memory::Buffer> buffers;
+    // the last change of each object, in the order of the input
+    std::vector<const osmium::OSMObject *> objects;
+};
+}
+}
+
+#endif
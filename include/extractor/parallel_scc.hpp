@@ -0,0 +1,437 @@
+#ifndef OSRM_EXTRACTOR_PARALLEL_SCC_HPP
+#define OSRM_EXTRACTOR_PARALLEL_SCC_HPP
+
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+// Finds the strongly connected components of a graph with the interface that TarjanSCC needs,
+// but uses all cores on large graphs. Road networks have one giant component and many tiny ones:
+//
+//  1. nodes without incoming or outgoing edges are components of their own and are trimmed,
+//  2. the giant component is the intersection of a forward and a backward search from the node
+//     of the highest degree, both searches run level by level in parallel,
+//  3. Tarjan's algorithm finds the components of the few remaining nodes.
+//
+// The components are numbered in the order of their smallest node, the ids do not depend on the
+// number of threads. Only StaticGraph-like graphs, whose methods can be called concurrently, are
+// supported.
+template <typename GraphT> class ParallelSCC
+{
+  public:
+    explicit ParallelSCC(const GraphT &graph)
+        : graph(graph), components_index(graph.GetNumberOfNodes(), SPECIAL_NODEID),
+          removed(graph.GetNumberOfNodes())
+    {
+        BOOST_ASSERT(graph.GetNumberOfNodes() > 0);
+    }
+
+    void Run()
+    {
+        TIMER_START(SCC_RUN);
+
+        BuildReverseGraph();
+        const auto trimmed_count = Trim();
+        const auto giant_component_size = SearchGiantComponent();
+        const auto remaining_count = RunTarjan();
+
+        reverse_first_edges = {};
+        reverse_sources = {};
+        Renumber();
+
+        TIMER_STOP(SCC_RUN);
+        const auto large_component_count =
+            std::count_if(component_size_vector.begin(),
+                          component_size_vector.end(),
+                          [](const NodeID size) { return size > 1000; });
+        util::Log() << "Found " << component_size_vector.size() << " SCC ("
+                    << large_component_count << " large, "
+                    << (component_size_vector.size() - large_component_count) << " small)";
+        util::Log(logDEBUG) << "Trimmed " << trimmed_count << " nodes, giant component has "
+                            << giant_component_size << " nodes, " << remaining_count
+                            << " nodes were left for Tarjan's algorithm";
+        util::Log() << "SCC run took: " << TIMER_MSEC(SCC_RUN) / 1000. << "s";
+
+        size_one_counter =
+            std::count(component_size_vector.begin(), component_size_vector.end(), 1);
+    }
+
+    std::size_t GetNumberOfComponents() const { return component_size_vector.size(); }
+
+    std::size_t GetSizeOneCount() const { return size_one_counter; }
+
+    unsigned GetComponentSize(const unsigned component_id) const
+    {
+        return component_size_vector[component_id];
+    }
+
+    unsigned GetComponentID(const NodeID node) const { return components_index[node]; }
+
+  private:
+    template <typename Callback> void ForEachTarget(const NodeID node, Callback &&callback) const
+    {
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            callback(graph.GetTarget(edge));
+        }
+    }
+
+    template <typename Callback> void ForEachSource(const NodeID node, Callback &&callback) const
+    {
+        for (auto edge = reverse_first_edges[node]; edge < reverse_first_edges[node + 1]; ++edge)
+        {
+            callback(reverse_sources[edge]);
+        }
+    }
+
+    template <typename Callback> void ParallelForEachNode(Callback &&callback) const
+    {
+        tbb::parallel_for(tbb::blocked_range<NodeID>(0, graph.GetNumberOfNodes()),
+                          [&](const tbb::blocked_range<NodeID> &range) {
+                              for (auto node = range.begin(); node != range.end(); ++node)
+                              {
+                                  callback(node);
+                              }
+                          });
+    }
+
+    void BuildReverseGraph()
+    {
+        const NodeID number_of_nodes = graph.GetNumberOfNodes();
+
+        // value initialized atomics start at zero
+        std::vector<std::atomic<EdgeID>> next_edges(number_of_nodes);
+        ParallelForEachNode([&](const NodeID node) {
+            ForEachTarget(node, [&](const NodeID target) { ++next_edges[target]; });
+        });
+
+        reverse_first_edges.resize(number_of_nodes + 1);
+        reverse_first_edges[0] = 0;
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            reverse_first_edges[node + 1] = reverse_first_edges[node] + next_edges[node];
+            next_edges[node] = reverse_first_edges[node];
+        }
+
+        reverse_sources.resize(reverse_first_edges.back());
+        ParallelForEachNode([&](const NodeID node) {
+            ForEachTarget(node, [&](const NodeID target) {
+                reverse_sources[next_edges[target]++] = node;
+            });
+        });
+    }
+
+    // Runs the callback on the nodes of the frontier in parallel, it returns the next frontier
+    template <typename Callback>
+    std::vector<NodeID> ExpandFrontier(const std::vector<NodeID> &frontier, Callback &&callback)
+    {
+        tbb::enumerable_thread_specific<std::vector<NodeID>> next_frontiers;
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, frontier.size()),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              auto &next_frontier = next_frontiers.local();
+                              for (auto index = range.begin(); index != range.end(); ++index)
+                              {
+                                  callback(frontier[index], next_frontier);
+                              }
+                          });
+
+        std::vector<NodeID> next_frontier;
+        for (const auto &thread_frontier : next_frontiers)
+        {
+            next_frontier.insert(
+                next_frontier.end(), thread_frontier.begin(), thread_frontier.end());
+        }
+        return next_frontier;
+    }
+
+    // Removes the nodes without incoming or outgoing edges until there are none left, every
+    // removed node is a component of its own
+    std::size_t Trim()
+    {
+        const NodeID number_of_nodes = graph.GetNumberOfNodes();
+        std::vector<std::atomic<EdgeID>> in_degrees(number_of_nodes);
+        std::vector<std::atomic<EdgeID>> out_degrees(number_of_nodes);
+
+        tbb::enumerable_thread_specific<std::vector<NodeID>> trimmed_nodes;
+        ParallelForEachNode([&](const NodeID node) {
+            in_degrees[node] = reverse_first_edges[node + 1] - reverse_first_edges[node];
+            out_degrees[node] = graph.GetAdjacentEdgeRange(node).size();
+            if (in_degrees[node] == 0 || out_degrees[node] == 0)
+            {
+                removed[node] = true;
+                trimmed_nodes.local().push_back(node);
+            }
+        });
+
+        std::vector<NodeID> frontier;
+        for (const auto &thread_nodes : trimmed_nodes)
+        {
+            frontier.insert(frontier.end(), thread_nodes.begin(), thread_nodes.end());
+        }
+
+        std::size_t trimmed_count = 0;
+        while (!frontier.empty())
+        {
+            trimmed_count += frontier.size();
+            frontier = ExpandFrontier(frontier, [&](const NodeID node, auto &next_frontier) {
+                components_index[node] = node;
+                const auto trim = [&](const NodeID neighbour, std::atomic<EdgeID> &degree) {
+                    if (--degree == 0 && !removed[neighbour].exchange(true))
+                    {
+                        next_frontier.push_back(neighbour);
+                    }
+                };
+                ForEachTarget(node,
+                              [&](const NodeID target) { trim(target, in_degrees[target]); });
+                ForEachSource(node,
+                              [&](const NodeID source) { trim(source, out_degrees[source]); });
+            });
+        }
+
+        return trimmed_count;
+    }
+
+    // Marks the nodes that the start reaches on the edges that the callback iterates over
+    template <typename ForEachNeighbour>
+    void Search(const NodeID start,
+                std::vector<std::atomic<bool>> &reached,
+                ForEachNeighbour &&for_each_neighbour)
+    {
+        reached[start] = true;
+        std::vector<NodeID> frontier{start};
+        while (!frontier.empty())
+        {
+            frontier = ExpandFrontier(frontier, [&](const NodeID node, auto &next_frontier) {
+                for_each_neighbour(node, [&](const NodeID neighbour) {
+                    if (!removed[neighbour] && !reached[neighbour].exchange(true))
+                    {
+                        next_frontier.push_back(neighbour);
+                    }
+                });
+            });
+        }
+    }
+
+    std::size_t SearchGiantComponent()
+    {
+        // the node of the highest degree is most likely part of the giant component
+        tbb::enumerable_thread_specific<std::pair<std::uint64_t, NodeID>> thread_pivots(
+            std::make_pair(0, SPECIAL_NODEID));
+        ParallelForEachNode([&](const NodeID node) {
+            if (removed[node])
+            {
+                return;
+            }
+            const std::uint64_t degree =
+                std::uint64_t{graph.GetAdjacentEdgeRange(node).size()} *
+                (reverse_first_edges[node + 1] - reverse_first_edges[node]);
+            auto &pivot = thread_pivots.local();
+            if (degree > pivot.first || (degree == pivot.first && node < pivot.second))
+            {
+                pivot = std::make_pair(degree, node);
+            }
+        });
+
+        auto pivot = std::make_pair(std::uint64_t{0}, SPECIAL_NODEID);
+        for (const auto &thread_pivot : thread_pivots)
+        {
+            if (thread_pivot.first > pivot.first ||
+                (thread_pivot.first == pivot.first && thread_pivot.second < pivot.second))
+            {
+                pivot = thread_pivot;
+            }
+        }
+        if (pivot.second == SPECIAL_NODEID)
+        {
+            return 0;
+        }
+
+        const NodeID number_of_nodes = graph.GetNumberOfNodes();
+        std::vector<std::atomic<bool>> reached_forward(number_of_nodes);
+        std::vector<std::atomic<bool>> reached_backward(number_of_nodes);
+        Search(pivot.second, reached_forward, [this](const NodeID node, auto &&callback) {
+            ForEachTarget(node, callback);
+        });
+        Search(pivot.second, reached_backward, [this](const NodeID node, auto &&callback) {
+            ForEachSource(node, callback);
+        });
+
+        tbb::enumerable_thread_specific<std::pair<std::size_t, NodeID>> thread_components(
+            std::make_pair(0, SPECIAL_NODEID));
+        ParallelForEachNode([&](const NodeID node) {
+            if (reached_forward[node] && reached_backward[node])
+            {
+                auto &component = thread_components.local();
+                ++component.first;
+                component.second = std::min(component.second, node);
+            }
+        });
+
+        std::size_t component_size = 0;
+        NodeID smallest_node = SPECIAL_NODEID;
+        for (const auto &component : thread_components)
+        {
+            component_size += component.first;
+            smallest_node = std::min(smallest_node, component.second);
+        }
+
+        ParallelForEachNode([&](const NodeID node) {
+            if (reached_forward[node] && reached_backward[node])
+            {
+                removed[node] = true;
+                components_index[node] = smallest_node;
+            }
+        });
+
+        return component_size;
+    }
+
+    // Iterative Tarjan on the nodes that are not removed yet, their index in components_index
+    // holds their position in the remaining nodes until their component is found
+    std::size_t RunTarjan()
+    {
+        std::vector<NodeID> remaining_nodes;
+        for (const auto node : util::irange<NodeID>(0, graph.GetNumberOfNodes()))
+        {
+            if (!removed[node])
+            {
+                components_index[node] = remaining_nodes.size();
+                remaining_nodes.push_back(node);
+            }
+        }
+
+        using EdgeIterator = decltype(graph.GetAdjacentEdgeRange(0).begin());
+        struct StackFrame
+        {
+            NodeID node;
+            EdgeIterator current;
+            EdgeIterator end;
+        };
+
+        std::vector<NodeID> index(remaining_nodes.size(), SPECIAL_NODEID);
+        std::vector<NodeID> low_link(remaining_nodes.size());
+        std::vector<StackFrame> recursion_stack;
+        std::vector<NodeID> tarjan_stack;
+        NodeID next_index = 0;
+
+        const auto visit = [&](const NodeID node) {
+            const auto position = components_index[node];
+            index[position] = low_link[position] = next_index++;
+            tarjan_stack.push_back(node);
+            const auto range = graph.GetAdjacentEdgeRange(node);
+            recursion_stack.push_back({node, range.begin(), range.end()});
+        };
+
+        for (const auto root : remaining_nodes)
+        {
+            if (removed[root] || index[components_index[root]] != SPECIAL_NODEID)
+            {
+                continue;
+            }
+
+            visit(root);
+            while (!recursion_stack.empty())
+            {
+                auto &frame = recursion_stack.back();
+                const auto position = components_index[frame.node];
+                if (frame.current != frame.end)
+                {
+                    const auto target = graph.GetTarget(*frame.current++);
+                    // the components of removed nodes are complete
+                    if (removed[target])
+                    {
+                        continue;
+                    }
+
+                    const auto target_position = components_index[target];
+                    if (index[target_position] == SPECIAL_NODEID)
+                    {
+                        visit(target);
+                    }
+                    else
+                    {
+                        low_link[position] = std::min(low_link[position], index[target_position]);
+                    }
+                    continue;
+                }
+
+                const auto node = frame.node;
+                recursion_stack.pop_back();
+                if (!recursion_stack.empty())
+                {
+                    const auto parent_position = components_index[recursion_stack.back().node];
+                    low_link[parent_position] =
+                        std::min(low_link[parent_position], low_link[position]);
+                }
+
+                if (low_link[position] == index[position])
+                {
+                    const auto component_begin =
+                        std::find(tarjan_stack.rbegin(), tarjan_stack.rend(), node).base() - 1;
+                    const auto smallest_node =
+                        *std::min_element(component_begin, tarjan_stack.end());
+                    for (auto member = component_begin; member != tarjan_stack.end(); ++member)
+                    {
+                        removed[*member] = true;
+                        components_index[*member] = smallest_node;
+                    }
+                    tarjan_stack.erase(component_begin, tarjan_stack.end());
+                }
+            }
+        }
+
+        return remaining_nodes.size();
+    }
+
+    // Every node points to the smallest node of its component, which comes first
+    void Renumber()
+    {
+        for (const auto node : util::irange<NodeID>(0, graph.GetNumberOfNodes()))
+        {
+            const auto smallest_node = components_index[node];
+            BOOST_ASSERT(smallest_node <= node);
+            if (smallest_node == node)
+            {
+                components_index[node] = component_size_vector.size();
+                component_size_vector.push_back(1);
+            }
+            else
+            {
+                components_index[node] = components_index[smallest_node];
+                ++component_size_vector[components_index[node]];
+            }
+        }
+    }
+
+    const GraphT &graph;
+    std::vector<unsigned> components_index;
+    std::vector<NodeID> component_size_vector;
+    std::size_t size_one_counter = 0;
+
+    std::vector<std::atomic<bool>> removed;
+    std::vector<EdgeID> reverse_first_edges;
+    std::vector<NodeID> reverse_sources;
+};
+}
+}
+
+#endif
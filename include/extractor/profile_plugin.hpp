@@ -0,0 +1,89 @@
+#ifndef OSRM_EXTRACTOR_PROFILE_PLUGIN_HPP
+#define OSRM_EXTRACTOR_PROFILE_PLUGIN_HPP
+
+#include "extractor/extraction_node.hpp"
+#include "extractor/extraction_relation.hpp"
+#include "extractor/extraction_segment.hpp"
+#include "extractor/extraction_turn.hpp"
+#include "extractor/extraction_way.hpp"
+#include "extractor/profile_properties.hpp"
+
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <string>
+#include <vector>
+
+// Version of the plugin interface, a plugin built against another version is rejected
+#define OSRM_PROFILE_PLUGIN_API_VERSION 1
+
+#if defined(_WIN32)
+#define OSRM_PROFILE_PLUGIN_EXPORT extern "C" __declspec(dllexport)
+#else
+#define OSRM_PROFILE_PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+// Defines the entry points that osrm-extract looks up in a profile plugin. PluginType has to be
+// default constructible and derive from osrm::extractor::ProfilePlugin.
+#define OSRM_PROFILE_PLUGIN(PluginType)                                                           \
+    OSRM_PROFILE_PLUGIN_EXPORT int osrm_profile_plugin_api_version()                              \
+    {                                                                                              \
+        return OSRM_PROFILE_PLUGIN_API_VERSION;                                                    \
+    }                                                                                              \
+    OSRM_PROFILE_PLUGIN_EXPORT osrm::extractor::ProfilePlugin *osrm_create_profile_plugin()        \
+    {                                                                                              \
+        return new PluginType();                                                                   \
+    }                                                                                              \
+    OSRM_PROFILE_PLUGIN_EXPORT void osrm_destroy_profile_plugin(                                   \
+        osrm::extractor::ProfilePlugin *plugin)                                                    \
+    {                                                                                              \
+        delete plugin;                                                                             \
+    }
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * Interface of profiles that are compiled into a shared library instead of written in lua.
+ *
+ * The functions correspond to the functions of a lua profile and work on the same osmium objects
+ * and result structs, see docs/profiles.md. Relations of the profile are parsed by osrm-extract
+ * as for lua profiles.
+ *
+ * The process functions are called concurrently from the threads of the extractor, so they
+ * must not modify shared state without synchronization. A plugin has to be built with the same
+ * compiler and the same OSRM headers as osrm-extract.
+ */
+class ProfilePlugin
+{
+  public:
+    virtual ~ProfilePlugin() = default;
+
+    // Called once after loading, corresponds to the properties returned by setup. ProcessNode is
+    // only called for nodes without tags if call_tagless_node_function is set.
+    virtual ProfileProperties GetProfileProperties() = 0;
+
+    virtual std::vector<std::vector<std::string>> GetExcludableClasses() { return {}; }
+    virtual std::vector<std::string> GetClassNames() { return {}; }
+    virtual std::vector<std::string> GetNameSuffixList() { return {}; }
+    virtual std::vector<std::string> GetRestrictions() { return {}; }
+    virtual std::vector<std::string> GetRelations() { return {}; }
+
+    // The default implementations leave the results as they are, like a lua profile that does
+    // not define the function
+    virtual void
+    ProcessNode(const osmium::Node &, ExtractionNode &, const ExtractionRelationContainer &)
+    {
+    }
+    virtual void ProcessWay(const osmium::Way &way,
+                            ExtractionWay &result,
+                            const ExtractionRelationContainer &relations) = 0;
+    virtual void ProcessTurn(ExtractionTurn &) {}
+    virtual void ProcessSegment(ExtractionSegment &) {}
+};
+}
+}
+
+#endif
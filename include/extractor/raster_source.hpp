@@ -4,16 +4,16 @@
 #include "util/coordinate.hpp"
 #include "util/exception.hpp"
 
-#include <boost/algorithm/string/trim.hpp>
 #include <boost/assert.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/filesystem/fstream.hpp>
-#include <boost/spirit/include/qi.hpp>
-#include <boost/spirit/include/qi_int.hpp>
-#include <storage/io.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
-#include <iterator>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace osrm
 {
@@ -35,64 +35,49 @@ struct RasterDatum
     RasterDatum(std::int32_t _datum) : datum(_datum) {}
 };
 
+/**
+    \brief Values of a raster source, parsed from an ASCII grid or mapped from a binary raster file.
+
+    Binary raster files start with a header of the magic "OSRMRAST", a uint32 version, the uint32
+    size of the signed values in bytes (2 or 4), and the uint64 number of columns and rows. The
+    values follow in rows from the top, in native byte order.
+*/
 class RasterGrid
 {
   public:
-    RasterGrid(const boost::filesystem::path &filepath, std::size_t _xdim, std::size_t _ydim)
-    {
-        xdim = _xdim;
-        ydim = _ydim;
-        _data.reserve(ydim * xdim);
-
-        storage::io::FileReader file_reader(filepath, storage::io::FileReader::HasNoFingerprint);
-
-        std::string buffer;
-        buffer.resize(file_reader.GetSize());
-
-        BOOST_ASSERT(buffer.size() > 1);
-
-        file_reader.ReadInto(&buffer[0], buffer.size());
+    static constexpr const char BINARY_MAGIC[] = "OSRMRAST";
+    static constexpr std::uint32_t BINARY_VERSION = 1;
+    static constexpr std::size_t BINARY_HEADER_SIZE = 32;
 
-        boost::algorithm::trim(buffer);
+    RasterGrid(const boost::filesystem::path &filepath, std::size_t _xdim, std::size_t _ydim);
 
-        auto itr = buffer.begin();
-        auto end = buffer.end();
-
-        bool r = false;
-        try
-        {
-            r = boost::spirit::qi::parse(
-                itr, end, +boost::spirit::qi::int_ % +boost::spirit::qi::space, _data);
-        }
-        catch (std::exception const &ex)
-        {
-            throw util::exception("Failed to read from raster source " + filepath.string() + ": " +
-                                  ex.what() + SOURCE_REF);
-        }
-
-        if (!r || itr != end)
-        {
-            throw util::exception("Failed to parse raster source: " + filepath.string() +
-                                  SOURCE_REF);
-        }
-    }
-
-    RasterGrid(const RasterGrid &) = default;
-    RasterGrid &operator=(const RasterGrid &) = default;
+    RasterGrid(const RasterGrid &) = delete;
+    RasterGrid &operator=(const RasterGrid &) = delete;
 
     RasterGrid(RasterGrid &&) = default;
     RasterGrid &operator=(RasterGrid &&) = default;
 
-    std::int32_t operator()(std::size_t x, std::size_t y) { return _data[y * xdim + x]; }
-    std::int32_t operator()(std::size_t x, std::size_t y) const { return _data[(y)*xdim + (x)]; }
+    std::int32_t operator()(std::size_t x, std::size_t y) const
+    {
+        const auto index = y * xdim + x;
+        return int16_values ? int16_values[index] : int32_values[index];
+    }
 
   private:
+    void ReadASCII(const boost::filesystem::path &filepath);
+    void MapBinary(const boost::filesystem::path &filepath);
+
     std::vector<std::int32_t> _data;
+    boost::iostreams::mapped_file_source region;
+    const std::int16_t *int16_values = nullptr;
+    const std::int32_t *int32_values = nullptr;
     std::size_t xdim, ydim;
 };
 
 /**
     \brief Stores raster source data in memory and provides lookup functions.
+
+    The grids of the same file are shared by the raster containers of all Lua contexts.
 */
 class RasterSource
 {
@@ -103,7 +88,7 @@ class RasterSource
     float CalcSize(int min, int max, std::size_t count) const;
 
   public:
-    RasterGrid raster_data;
+    std::shared_ptr<const RasterGrid> raster_data;
 
     const std::size_t width;
     const std::size_t height;
@@ -116,7 +101,7 @@ class RasterSource
 
     RasterDatum GetRasterInterpolate(const int lon, const int lat) const;
 
-    RasterSource(RasterGrid _raster_data,
+    RasterSource(std::shared_ptr<const RasterGrid> _raster_data,
                  std::size_t width,
                  std::size_t height,
                  int _xmin,
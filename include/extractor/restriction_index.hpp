@@ -4,8 +4,10 @@
 #include "extractor/restriction.hpp"
 #include "util/typedefs.hpp"
 
-#include <boost/unordered_map.hpp>
+#include <boost/assert.hpp>
 
+#include <algorithm>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -15,25 +17,33 @@ namespace extractor
 {
 
 // allows easy check for whether a node intersection is present at a given intersection
+//
+// The restrictions are stored sorted by their (first, second) key in a flat array. The distinct
+// first nodes index into it like the rows of a CSR matrix, a lookup only binary searches the
+// first nodes and scans the few restrictions that start at the node.
 template <typename restriction_type> class RestrictionIndex
 {
   public:
     using value_type = restriction_type;
+    using Key = std::pair<NodeID, NodeID>;
+    using Entry = std::pair<Key, restriction_type *>;
+    using const_iterator = typename std::vector<Entry>::const_iterator;
 
     template <typename extractor_type>
     RestrictionIndex(std::vector<restriction_type> &restrictions, extractor_type extractor);
 
     bool IsIndexed(NodeID first, NodeID second) const;
 
-    auto Restrictions(NodeID first, NodeID second) const
-    {
-        return restriction_hash.equal_range(std::make_pair(first, second));
-    };
+    // all restrictions indexed with (first, second), in the order they are stored in
+    std::pair<const_iterator, const_iterator> Restrictions(NodeID first, NodeID second) const;
 
-    auto Size() const { return restriction_hash.size(); }
+    auto Size() const { return entries.size(); }
 
   private:
-    boost::unordered_multimap<std::pair<NodeID, NodeID>, restriction_type *> restriction_hash;
+    std::vector<NodeID> first_nodes;
+    // entries of first_nodes[i] are in [offsets[i], offsets[i + 1])
+    std::vector<std::uint32_t> offsets;
+    std::vector<Entry> entries;
 };
 
 template <typename restriction_type>
@@ -41,15 +51,53 @@ template <typename extractor_type>
 RestrictionIndex<restriction_type>::RestrictionIndex(std::vector<restriction_type> &restrictions,
                                                      extractor_type extractor)
 {
-    // build a multi-map
+    entries.reserve(restrictions.size());
     for (auto &restriction : restrictions)
-        restriction_hash.insert(std::make_pair(extractor(restriction), &restriction));
+        entries.emplace_back(extractor(restriction), &restriction);
+
+    // restrictions with the same key keep their order
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &lhs, const Entry &rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    for (std::size_t index = 0; index < entries.size(); ++index)
+    {
+        if (first_nodes.empty() || first_nodes.back() != entries[index].first.first)
+        {
+            first_nodes.push_back(entries[index].first.first);
+            offsets.push_back(index);
+        }
+    }
+    offsets.push_back(entries.size());
+    BOOST_ASSERT(offsets.size() == first_nodes.size() + 1);
+}
+
+template <typename restriction_type>
+std::pair<typename RestrictionIndex<restriction_type>::const_iterator,
+          typename RestrictionIndex<restriction_type>::const_iterator>
+RestrictionIndex<restriction_type>::Restrictions(const NodeID first, const NodeID second) const
+{
+    const auto first_node = std::lower_bound(first_nodes.begin(), first_nodes.end(), first);
+    if (first_node == first_nodes.end() || *first_node != first)
+        return std::make_pair(entries.end(), entries.end());
+
+    const auto row = std::distance(first_nodes.begin(), first_node);
+    const auto row_end = entries.begin() + offsets[row + 1];
+    auto begin = entries.begin() + offsets[row];
+    while (begin != row_end && begin->first.second < second)
+        ++begin;
+    auto end = begin;
+    while (end != row_end && end->first.second == second)
+        ++end;
+
+    return std::make_pair(begin, end);
 }
 
 template <typename restriction_type>
 bool RestrictionIndex<restriction_type>::IsIndexed(const NodeID first, const NodeID second) const
 {
-    return restriction_hash.count(std::make_pair(first, second));
+    const auto range = Restrictions(first, second);
+    return range.first != range.second;
 }
 
 struct IndexNodeByFromAndVia
@@ -59,6 +59,8 @@ class ScriptingEnvironment
     virtual std::vector<std::string> GetRestrictions() = 0;
     virtual std::vector<std::string> GetRelations() = 0;
     virtual void ProcessTurn(ExtractionTurn &turn) = 0;
+    // Processes the turns of a chunk of intersections at once
+    virtual void ProcessTurns(std::vector<ExtractionTurn> &turns) = 0;
     virtual void ProcessSegment(ExtractionSegment &segment) = 0;
 
     virtual void
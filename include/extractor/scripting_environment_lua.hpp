@@ -5,6 +5,8 @@
 #include "extractor/location_dependent_data.hpp"
 #include "extractor/raster_source.hpp"
 #include "extractor/scripting_environment.hpp"
+#include "extractor/tag_cache.hpp"
+#include "extractor/way_result_cache.hpp"
 
 #include <tbb/enumerable_thread_specific.h>
 
@@ -33,6 +35,10 @@ struct LuaScriptingContext final
     void ProcessWay(const osmium::Way &,
                     ExtractionWay &result,
                     const ExtractionRelationContainer &relations);
+    // Processes all ways of the batch with one call of the process_ways function
+    void ProcessWays(std::vector<std::pair<const osmium::Way &, ExtractionWay>>::iterator begin,
+                     std::vector<std::pair<const osmium::Way &, ExtractionWay>>::iterator end,
+                     const ExtractionRelationContainer &relations);
 
     ProfileProperties properties;
     RasterContainer raster_sources;
@@ -41,10 +47,14 @@ struct LuaScriptingContext final
     bool has_turn_penalty_function;
     bool has_node_function;
     bool has_way_function;
+    bool has_ways_function = false;
+    bool has_turns_function = false;
     bool has_segment_function;
 
     sol::function turn_function;
     sol::function way_function;
+    sol::function ways_function;
+    sol::function turns_function;
     sol::function node_function;
     sol::function segment_function;
 
@@ -55,6 +65,12 @@ struct LuaScriptingContext final
     const LocationDependentData &location_dependent_data;
     LocationDependentData::point_t last_location_point;
     std::vector<std::size_t> last_location_indexes;
+
+    // Tag values of the node or way that is processed, by interned keys
+    TagCache tag_cache;
+
+    // Results of process_way by the declared tags, only enabled for pure profiles
+    WayResultCache way_result_cache;
 };
 
 /**
@@ -83,6 +99,7 @@ class Sol2ScriptingEnvironment final : public ScriptingEnvironment
     std::vector<std::string> GetRestrictions() override;
     std::vector<std::string> GetRelations() override;
     void ProcessTurn(ExtractionTurn &turn) override;
+    void ProcessTurns(std::vector<ExtractionTurn> &turns) override;
     void ProcessSegment(ExtractionSegment &segment) override;
 
     void
@@ -0,0 +1,67 @@
+#ifndef SCRIPTING_ENVIRONMENT_PLUGIN_HPP
+#define SCRIPTING_ENVIRONMENT_PLUGIN_HPP
+
+#include "extractor/profile_plugin.hpp"
+#include "extractor/scripting_environment.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * Loads a profile from a shared library that implements ProfilePlugin.
+ *
+ * The library is looked up for the entry points defined by OSRM_PROFILE_PLUGIN and stays loaded
+ * for the lifetime of the environment. The plugin processes the elements directly on the osmium
+ * objects, relations are parsed in the same way as for lua profiles.
+ */
+class PluginScriptingEnvironment final : public ScriptingEnvironment
+{
+  public:
+    explicit PluginScriptingEnvironment(const boost::filesystem::path &library_path);
+    ~PluginScriptingEnvironment() override;
+
+    const ProfileProperties &GetProfileProperties() override { return properties; }
+
+    std::vector<std::vector<std::string>> GetExcludableClasses() override;
+    std::vector<std::string> GetNameSuffixList() override;
+    std::vector<std::string> GetClassNames() override;
+    std::vector<std::string> GetRestrictions() override;
+    std::vector<std::string> GetRelations() override;
+    void ProcessTurn(ExtractionTurn &turn) override;
+    void ProcessTurns(std::vector<ExtractionTurn> &turns) override;
+    void ProcessSegment(ExtractionSegment &segment) override;
+
+    void
+    ProcessElements(const osmium::memory::Buffer &buffer,
+                    const RestrictionParser &restriction_parser,
+                    const ManeuverOverrideRelationParser &maneuver_override_parser,
+                    const ExtractionRelationContainer &relations,
+                    std::vector<std::pair<const osmium::Node &, ExtractionNode>> &resulting_nodes,
+                    std::vector<std::pair<const osmium::Way &, ExtractionWay>> &resulting_ways,
+                    std::vector<InputConditionalTurnRestriction> &resulting_restrictions,
+                    std::vector<InputManeuverOverride> &resulting_maneuver_overrides) override;
+
+    bool HasLocationDependentData() const override { return false; }
+
+    // Returns true if the profile path names a shared library instead of a lua script
+    static bool IsPluginPath(const boost::filesystem::path &profile_path);
+
+  private:
+    using DestroyFunction = void (*)(ProfilePlugin *);
+
+    void *library_handle = nullptr;
+    ProfilePlugin *plugin = nullptr;
+    DestroyFunction destroy_plugin = nullptr;
+    ProfileProperties properties;
+};
+}
+}
+
+#endif /* SCRIPTING_ENVIRONMENT_PLUGIN_HPP */
@@ -1,6 +1,7 @@
 #ifndef OSRM_EXTRACTOR_SEGMENT_DATA_CONTAINER_HPP_
 #define OSRM_EXTRACTOR_SEGMENT_DATA_CONTAINER_HPP_
 
+#include "util/block_compressed_vector.hpp"
 #include "util/packed_vector.hpp"
 #include "util/typedefs.hpp"
 #include "util/vector_view.hpp"
@@ -15,6 +16,7 @@
 #include <unordered_map>
 
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -55,6 +57,7 @@ template <storage::Ownership Ownership> class SegmentDataContainerImpl
     // FIXME We should change the indexing to Edge-Based-Node id
     using DirectionalGeometryID = std::uint32_t;
     using SegmentOffset = std::uint32_t;
+    using SegmentNodeVector = util::detail::BlockCompressedVector<NodeID, Ownership>;
     using SegmentWeightVector = PackedVector<SegmentWeight, SEGMENT_WEIGHT_BITS>;
     using SegmentDurationVector = PackedVector<SegmentDuration, SEGMENT_DURAITON_BITS>;
     using SegmentDatasourceVector = Vector<DatasourceID>;
@@ -62,7 +65,7 @@ template <storage::Ownership Ownership> class SegmentDataContainerImpl
     SegmentDataContainerImpl() = default;
 
     SegmentDataContainerImpl(Vector<std::uint32_t> index_,
-                             Vector<NodeID> nodes_,
+                             SegmentNodeVector nodes_,
                              SegmentWeightVector fwd_weights_,
                              SegmentWeightVector rev_weights_,
                              SegmentDurationVector fwd_durations_,
@@ -76,19 +79,6 @@ template <storage::Ownership Ownership> class SegmentDataContainerImpl
     {
     }
 
-    auto GetForwardGeometry(const DirectionalGeometryID id)
-    {
-        const auto begin = nodes.begin() + index[id];
-        const auto end = nodes.begin() + index[id + 1];
-
-        return boost::make_iterator_range(begin, end);
-    }
-
-    auto GetReverseGeometry(const DirectionalGeometryID id)
-    {
-        return boost::adaptors::reverse(GetForwardGeometry(id));
-    }
-
     auto GetForwardDurations(const DirectionalGeometryID id)
     {
         const auto begin = fwd_durations.begin() + index[id] + 1;
@@ -198,6 +188,56 @@ template <storage::Ownership Ownership> class SegmentDataContainerImpl
         return boost::adaptors::reverse(boost::make_iterator_range(begin, end));
     }
 
+    // Decode the nodes, weights or durations of a geometry in one pass. The reverse values
+    // are in the order of the reverse ranges above.
+    template <typename ValueT>
+    void UnpackForwardGeometry(const DirectionalGeometryID id, std::vector<ValueT> &values) const
+    {
+        values.resize(index[id + 1] - index[id]);
+        nodes.unpack(index[id], index[id + 1], values.begin());
+    }
+
+    template <typename ValueT>
+    void UnpackReverseGeometry(const DirectionalGeometryID id, std::vector<ValueT> &values) const
+    {
+        values.resize(index[id + 1] - index[id]);
+        nodes.unpack(index[id], index[id + 1], values.rbegin());
+    }
+
+    template <typename ValueT>
+    void UnpackForwardWeights(const DirectionalGeometryID id, std::vector<ValueT> &values) const
+    {
+        values.resize(index[id + 1] - index[id] - 1);
+        fwd_weights.unpack(index[id] + 1, index[id + 1], values.begin());
+    }
+
+    template <typename ValueT>
+    void UnpackReverseWeights(const DirectionalGeometryID id, std::vector<ValueT> &values) const
+    {
+        values.resize(index[id + 1] - index[id] - 1);
+        rev_weights.unpack(index[id], index[id + 1] - 1, values.rbegin());
+    }
+
+    template <typename ValueT>
+    void UnpackForwardDurations(const DirectionalGeometryID id, std::vector<ValueT> &values) const
+    {
+        values.resize(index[id + 1] - index[id] - 1);
+        fwd_durations.unpack(index[id] + 1, index[id + 1], values.begin());
+    }
+
+    template <typename ValueT>
+    void UnpackReverseDurations(const DirectionalGeometryID id, std::vector<ValueT> &values) const
+    {
+        values.resize(index[id + 1] - index[id] - 1);
+        rev_durations.unpack(index[id], index[id + 1] - 1, values.rbegin());
+    }
+
+    // The nodes of a geometry are at the positions [first, second) of the segment vectors
+    std::pair<SegmentOffset, SegmentOffset> GetGeometryPositions(const DirectionalGeometryID id) const
+    {
+        return std::make_pair(index[id], index[id + 1]);
+    }
+
     auto GetNumberOfGeometries() const { return index.size() - 1; }
     auto GetNumberOfSegments() const { return fwd_weights.size(); }
 
@@ -212,7 +252,8 @@ template <storage::Ownership Ownership> class SegmentDataContainerImpl
 
   private:
     Vector<std::uint32_t> index;
-    Vector<NodeID> nodes;
+    // consecutive geometries mostly use nodes with close ids
+    SegmentNodeVector nodes;
     SegmentWeightVector fwd_weights;
     SegmentWeightVector rev_weights;
     SegmentDurationVector fwd_durations;
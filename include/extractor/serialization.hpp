@@ -3,6 +3,7 @@
 
 #include "extractor/conditional_turn_penalty.hpp"
 #include "extractor/datasources.hpp"
+#include "extractor/geometry_coordinates_container.hpp"
 #include "extractor/intersection_bearings_container.hpp"
 #include "extractor/maneuver_override.hpp"
 #include "extractor/name_table.hpp"
@@ -83,7 +84,7 @@ inline void read(storage::tar::FileReader &reader,
                  detail::SegmentDataContainerImpl<Ownership> &segment_data)
 {
     storage::serialization::read(reader, name + "/index", segment_data.index);
-    storage::serialization::read(reader, name + "/nodes", segment_data.nodes);
+    util::serialization::read(reader, name + "/nodes", segment_data.nodes);
     util::serialization::read(reader, name + "/forward_weights", segment_data.fwd_weights);
     util::serialization::read(reader, name + "/reverse_weights", segment_data.rev_weights);
     util::serialization::read(reader, name + "/forward_durations", segment_data.fwd_durations);
@@ -100,7 +101,7 @@ inline void write(storage::tar::FileWriter &writer,
                   const detail::SegmentDataContainerImpl<Ownership> &segment_data)
 {
     storage::serialization::write(writer, name + "/index", segment_data.index);
-    storage::serialization::write(writer, name + "/nodes", segment_data.nodes);
+    util::serialization::write(writer, name + "/nodes", segment_data.nodes);
     util::serialization::write(writer, name + "/forward_weights", segment_data.fwd_weights);
     util::serialization::write(writer, name + "/reverse_weights", segment_data.rev_weights);
     util::serialization::write(writer, name + "/forward_durations", segment_data.fwd_durations);
@@ -111,6 +112,28 @@ inline void write(storage::tar::FileWriter &writer,
         writer, name + "/reverse_data_sources", segment_data.rev_datasources);
 }
 
+template <storage::Ownership Ownership>
+inline void read(storage::tar::FileReader &reader,
+                 const std::string &name,
+                 detail::GeometryCoordinatesContainerImpl<Ownership> &geometry_coordinates)
+{
+    storage::serialization::read(reader, name + "/first_lons", geometry_coordinates.first_lons);
+    storage::serialization::read(reader, name + "/first_lats", geometry_coordinates.first_lats);
+    storage::serialization::read(reader, name + "/lon_deltas", geometry_coordinates.lon_deltas);
+    storage::serialization::read(reader, name + "/lat_deltas", geometry_coordinates.lat_deltas);
+}
+
+template <storage::Ownership Ownership>
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const detail::GeometryCoordinatesContainerImpl<Ownership> &geometry_coordinates)
+{
+    storage::serialization::write(writer, name + "/first_lons", geometry_coordinates.first_lons);
+    storage::serialization::write(writer, name + "/first_lats", geometry_coordinates.first_lats);
+    storage::serialization::write(writer, name + "/lon_deltas", geometry_coordinates.lon_deltas);
+    storage::serialization::write(writer, name + "/lat_deltas", geometry_coordinates.lat_deltas);
+}
+
 template <storage::Ownership Ownership>
 inline void read(storage::tar::FileReader &reader,
                  const std::string &name,
@@ -146,6 +169,7 @@ inline void read(storage::io::BufferReader &reader, ConditionalTurnPenalty &turn
         storage::serialization::read(reader, condition.weekdays);
         storage::serialization::read(reader, condition.monthdays);
     }
+    storage::serialization::read(reader, turn_penalty.schedule);
 }
 
 inline void write(storage::io::BufferWriter &writer, const ConditionalTurnPenalty &turn_penalty)
@@ -161,6 +185,7 @@ inline void write(storage::io::BufferWriter &writer, const ConditionalTurnPenalt
         storage::serialization::write(writer, c.weekdays);
         storage::serialization::write(writer, c.monthdays);
     }
+    storage::serialization::write(writer, turn_penalty.schedule);
 }
 
 inline void write(storage::io::BufferWriter &writer,
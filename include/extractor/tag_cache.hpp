@@ -0,0 +1,137 @@
+#ifndef OSRM_EXTRACTOR_TAG_CACHE_HPP
+#define OSRM_EXTRACTOR_TAG_CACHE_HPP
+
+#include <boost/assert.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <osmium/osm/object.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * Caches the tag values of the OSM object that a profile is processing.
+ *
+ * Every key that the profile asks for is interned once into an integer id. When the profile
+ * looks at a new object its tags are read in one pass into an array indexed by the key ids, so
+ * all further lookups of interned keys are an array access instead of a string comparison over
+ * the tag list. The array entries are stamped with a generation per object, which moves to the
+ * next object without clearing the array.
+ *
+ * The cache refers to the object by its address, so Reset has to be called before the objects of
+ * a buffer are released. Each lua context has its own cache, so it does not need locking.
+ */
+class TagCache
+{
+  public:
+    using KeyID = std::uint32_t;
+
+    // Returns the value of key for object, nullptr if the object has no such tag
+    const char *Get(const osmium::OSMObject &object, const char *key)
+    {
+        if (&object != current_object)
+        {
+            Fill(object);
+        }
+
+        const auto key_id = Intern(key);
+        if (key_id >= keys_at_fill)
+        {
+            // the key was not known when the tags were read, look it up once and remember it
+            Set(key_id, object.tags().get_value_by_key(key));
+        }
+
+        return stamps[key_id] == generation ? values[key_id] : nullptr;
+    }
+
+    // Forgets the current object, needs to be called when the object might be released
+    void Reset() { current_object = nullptr; }
+
+    KeyID Intern(const char *key)
+    {
+        const boost::string_ref name(key);
+        const auto iter = key_ids.find(name);
+        if (iter != key_ids.end())
+        {
+            return iter->second;
+        }
+
+        // the deque keeps the strings at their address, so the map can refer to them
+        key_names.emplace_back(name.data(), name.size());
+        const auto key_id = static_cast<KeyID>(key_names.size() - 1);
+        key_ids.emplace(boost::string_ref(key_names.back()), key_id);
+        values.push_back(nullptr);
+        stamps.push_back(0);
+        return key_id;
+    }
+
+    std::size_t GetNumberOfKeys() const { return key_names.size(); }
+
+  private:
+    struct KeyHash
+    {
+        std::size_t operator()(const boost::string_ref key) const
+        {
+            // FNV-1a, the keys are short
+            std::size_t hash = 14695981039346656037ULL;
+            for (const auto c : key)
+            {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+            }
+            return hash;
+        }
+    };
+
+    void Fill(const osmium::OSMObject &object)
+    {
+        if (generation == std::numeric_limits<std::uint32_t>::max())
+        {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 0;
+        }
+        ++generation;
+        current_object = &object;
+        keys_at_fill = key_names.size();
+
+        for (const auto &tag : object.tags())
+        {
+            const auto iter = key_ids.find(boost::string_ref(tag.key()));
+            if (iter != key_ids.end())
+            {
+                Set(iter->second, tag.value());
+            }
+        }
+    }
+
+    void Set(const KeyID key_id, const char *value)
+    {
+        BOOST_ASSERT(key_id < values.size());
+        values[key_id] = value;
+        stamps[key_id] = generation;
+    }
+
+    std::deque<std::string> key_names;
+    std::unordered_map<boost::string_ref, KeyID, KeyHash> key_ids;
+
+    // the values of the current object, valid where the stamp is the current generation
+    std::vector<const char *> values;
+    std::vector<std::uint32_t> stamps;
+    std::uint32_t generation = 0;
+    std::size_t keys_at_fill = 0;
+    const osmium::OSMObject *current_object = nullptr;
+};
+}
+}
+
+#endif
@@ -4,9 +4,6 @@
 #include <utility>
 #include <vector>
 
-// to access the turn restrictions
-#include <boost/unordered_map.hpp>
-
 #include "extractor/restriction.hpp"
 #include "extractor/restriction_index.hpp"
 #include "util/integer_range.hpp"
@@ -0,0 +1,146 @@
+#ifndef OSRM_EXTRACTOR_WAY_RESULT_CACHE_HPP
+#define OSRM_EXTRACTOR_WAY_RESULT_CACHE_HPP
+
+#include "extractor/extraction_way.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <osmium/osm/way.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * Memoizes the results of process_way by the tags of the way that the profile looks at.
+ *
+ * A profile that declares the tag keys its process_way depends on and marks the function as pure
+ * gets the same result for all ways that agree on the values of these keys. Many ways only carry
+ * a handful of common tag combinations, e.g. only highway=residential, so most of them are served
+ * from the cache instead of calling into lua.
+ *
+ * The cache key is the list of the relevant tags of a way, ordered by key. The number of entries
+ * is bounded, further combinations are processed but not stored. Each lua context has its own
+ * cache, so it does not need locking.
+ */
+class WayResultCache
+{
+  public:
+    static constexpr std::size_t DEFAULT_MAX_ENTRIES = 1 << 16;
+
+    WayResultCache() = default;
+    explicit WayResultCache(const std::vector<std::string> &relevant_keys,
+                            const std::size_t max_entries = DEFAULT_MAX_ENTRIES)
+        : key_names(relevant_keys), max_entries(max_entries)
+    {
+        std::sort(key_names.begin(), key_names.end());
+        key_names.erase(std::unique(key_names.begin(), key_names.end()), key_names.end());
+        for (std::size_t index = 0; index < key_names.size(); ++index)
+        {
+            key_ids.emplace(boost::string_ref(key_names[index]), static_cast<KeyID>(index));
+        }
+    }
+
+    // the key map refers to the key names, moving keeps the strings at their address
+    WayResultCache(const WayResultCache &) = delete;
+    WayResultCache &operator=(const WayResultCache &) = delete;
+    WayResultCache(WayResultCache &&) = default;
+    WayResultCache &operator=(WayResultCache &&) = default;
+
+    bool IsEnabled() const { return !key_names.empty(); }
+
+    // Returns the cached result for the relevant tags of way, nullptr if there is none yet.
+    // The key of the way is kept for a following Insert.
+    const ExtractionWay *Find(const osmium::Way &way)
+    {
+        BOOST_ASSERT(IsEnabled());
+        BuildKey(way);
+        const auto iter = results.find(current_key);
+        if (iter == results.end())
+        {
+            ++number_of_misses;
+            return nullptr;
+        }
+        ++number_of_hits;
+        return &iter->second;
+    }
+
+    // Stores the result for the way of the last Find
+    void Insert(const ExtractionWay &result)
+    {
+        if (results.size() < max_entries)
+        {
+            results.emplace(current_key, result);
+        }
+    }
+
+    std::size_t GetNumberOfEntries() const { return results.size(); }
+    std::uint64_t GetNumberOfHits() const { return number_of_hits; }
+    std::uint64_t GetNumberOfMisses() const { return number_of_misses; }
+
+  private:
+    using KeyID = std::uint32_t;
+
+    struct KeyHash
+    {
+        std::size_t operator()(const boost::string_ref key) const
+        {
+            // FNV-1a, the keys are short
+            std::size_t hash = 14695981039346656037ULL;
+            for (const auto c : key)
+            {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+            }
+            return hash;
+        }
+    };
+
+    void BuildKey(const osmium::Way &way)
+    {
+        relevant_tags.clear();
+        for (const auto &tag : way.tags())
+        {
+            const auto iter = key_ids.find(boost::string_ref(tag.key()));
+            if (iter != key_ids.end())
+            {
+                relevant_tags.emplace_back(iter->second, tag.value());
+            }
+        }
+        std::sort(relevant_tags.begin(),
+                  relevant_tags.end(),
+                  [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+        // the key id and the terminating zero of the value delimit the tags unambiguously
+        current_key.clear();
+        for (const auto &tag : relevant_tags)
+        {
+            current_key.append(reinterpret_cast<const char *>(&tag.first), sizeof(KeyID));
+            current_key.append(tag.second);
+            current_key.push_back('\0');
+        }
+    }
+
+    std::vector<std::string> key_names;
+    std::unordered_map<boost::string_ref, KeyID, KeyHash> key_ids;
+    std::size_t max_entries = DEFAULT_MAX_ENTRIES;
+
+    std::vector<std::pair<KeyID, const char *>> relevant_tags;
+    std::string current_key;
+    std::unordered_map<std::string, ExtractionWay> results;
+
+    std::uint64_t number_of_hits = 0;
+    std::uint64_t number_of_misses = 0;
+};
+}
+}
+
+#endif
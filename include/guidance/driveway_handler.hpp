@@ -2,6 +2,7 @@
 #define OSRM_GUIDANCE_DRIVEWAY_HANDLER_HPP
 
 #include "guidance/intersection_handler.hpp"
+#include "util/id_set.hpp"
 
 namespace osrm
 {
@@ -17,7 +18,7 @@ class DrivewayHandler final : public IntersectionHandler
                     const std::vector<util::Coordinate> &coordinates,
                     const extractor::CompressedEdgeContainer &compressed_geometries,
                     const extractor::RestrictionMap &node_restriction_map,
-                    const std::unordered_set<NodeID> &barrier_nodes,
+                    const util::IdSet<NodeID> &barrier_nodes,
                     const extractor::TurnLanesIndexedArray &turn_lanes_data,
                     const extractor::NameTable &name_table,
                     const extractor::SuffixTable &street_name_suffix_table);
@@ -4,6 +4,7 @@
 #include "guidance/turn_data_container.hpp"
 
 #include "extractor/compressed_edge_container.hpp"
+#include "extractor/intersection/intersection_geometry_cache.hpp"
 #include "extractor/name_table.hpp"
 #include "extractor/node_data_container.hpp"
 #include "extractor/suffix_table.hpp"
@@ -14,9 +15,9 @@
 #include "util/guidance/bearing_class.hpp"
 #include "util/guidance/entry_class.hpp"
 #include "util/guidance/turn_lanes.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 
-#include <unordered_set>
 
 namespace osrm
 {
@@ -30,12 +31,13 @@ void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
                    const extractor::EdgeBasedNodeDataContainer &edge_based_node_container,
                    const std::vector<util::Coordinate> &node_coordinates,
                    const extractor::CompressedEdgeContainer &compressed_edge_container,
-                   const std::unordered_set<NodeID> &barrier_nodes,
+                   const util::IdSet<NodeID> &barrier_nodes,
                    const extractor::RestrictionMap &node_restriction_map,
                    const extractor::WayRestrictionMap &way_restriction_map,
                    const extractor::NameTable &name_table,
                    const extractor::SuffixTable &suffix_table,
                    const extractor::TurnLanesIndexedArray &turn_lanes_data,
+                   const extractor::intersection::IntersectionGeometryCache &intersection_geometries,
                    extractor::LaneDescriptionMap &lane_description_map,
                    util::guidance::LaneDataIdMap &lane_data_map,
                    guidance::TurnDataExternalContainer &turn_data_container,
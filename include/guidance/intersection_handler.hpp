@@ -11,6 +11,7 @@
 #include "util/assert.hpp"
 #include "util/coordinate_calculation.hpp"
 #include "util/guidance/name_announcements.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 
 #include <algorithm>
@@ -36,7 +37,7 @@ class IntersectionHandler
                         const std::vector<util::Coordinate> &node_coordinates,
                         const extractor::CompressedEdgeContainer &compressed_geometries,
                         const extractor::RestrictionMap &node_restriction_map,
-                        const std::unordered_set<NodeID> &barrier_nodes,
+                        const util::IdSet<NodeID> &barrier_nodes,
                         const extractor::TurnLanesIndexedArray &turn_lanes_data,
                         const extractor::NameTable &name_table,
                         const extractor::SuffixTable &street_name_suffix_table);
@@ -57,7 +58,7 @@ class IntersectionHandler
     const std::vector<util::Coordinate> &node_coordinates;
     const extractor::CompressedEdgeContainer &compressed_geometries;
     const extractor::RestrictionMap &node_restriction_map;
-    const std::unordered_set<NodeID> &barrier_nodes;
+    const util::IdSet<NodeID> &barrier_nodes;
     const extractor::TurnLanesIndexedArray &turn_lanes_data;
     const extractor::NameTable &name_table;
     const extractor::SuffixTable &street_name_suffix_table;
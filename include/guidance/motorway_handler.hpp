@@ -8,6 +8,7 @@
 #include "guidance/is_through_street.hpp"
 
 #include "util/attributes.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 
 #include <vector>
@@ -26,7 +27,7 @@ class MotorwayHandler : public IntersectionHandler
                     const std::vector<util::Coordinate> &coordinates,
                     const extractor::CompressedEdgeContainer &compressed_geometries,
                     const extractor::RestrictionMap &node_restriction_map,
-                    const std::unordered_set<NodeID> &barrier_nodes,
+                    const util::IdSet<NodeID> &barrier_nodes,
                     const extractor::TurnLanesIndexedArray &turn_lanes_data,
                     const extractor::NameTable &name_table,
                     const extractor::SuffixTable &street_name_suffix_table);
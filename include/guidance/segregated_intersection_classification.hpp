@@ -1,8 +1,8 @@
 #include "extractor/name_table.hpp"
 
+#include "util/id_set.hpp"
 #include "util/typedefs.hpp"
 
-#include <unordered_set>
 
 namespace osrm
 {
@@ -18,7 +18,7 @@ namespace guidance
 // - middle edges between two osm ways in one logic road (U-turn)
 // - staggered intersections (X-cross)
 // - square/circle intersections
-std::unordered_set<EdgeID> findSegregatedNodes(const extractor::NodeBasedGraphFactory &factory,
+util::IdSet<EdgeID> findSegregatedNodes(const extractor::NodeBasedGraphFactory &factory,
                                                const extractor::NameTable &names);
 }
 }
@@ -5,6 +5,7 @@
 #include "guidance/intersection_handler.hpp"
 #include "guidance/turn_instruction.hpp"
 
+#include "util/id_set.hpp"
 #include "util/log.hpp"
 
 #include <algorithm>
@@ -30,7 +31,7 @@ class StatisticsHandler final : public IntersectionHandler
                       const std::vector<util::Coordinate> &coordinates,
                       const extractor::CompressedEdgeContainer &compressed_geometries,
                       const extractor::RestrictionMap &node_restriction_map,
-                      const std::unordered_set<NodeID> &barrier_nodes,
+                      const util::IdSet<NodeID> &barrier_nodes,
                       const extractor::TurnLanesIndexedArray &turn_lanes_data,
                       const extractor::NameTable &name_table,
                       const extractor::SuffixTable &street_name_suffix_table)
@@ -6,6 +6,7 @@
 #include "guidance/intersection.hpp"
 #include "guidance/intersection_handler.hpp"
 
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 
 namespace osrm
@@ -24,7 +25,7 @@ class SuppressModeHandler final : public IntersectionHandler
                         const std::vector<util::Coordinate> &coordinates,
                         const extractor::CompressedEdgeContainer &compressed_geometries,
                         const extractor::RestrictionMap &node_restriction_map,
-                        const std::unordered_set<NodeID> &barrier_nodes,
+                        const util::IdSet<NodeID> &barrier_nodes,
                         const extractor::TurnLanesIndexedArray &turn_lanes_data,
                         const extractor::NameTable &name_table,
                         const extractor::SuffixTable &street_name_suffix_table);
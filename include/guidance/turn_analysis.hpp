@@ -18,6 +18,7 @@
 #include "guidance/turn_handler.hpp"
 
 #include "util/attributes.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 
 #include <cstdint>
@@ -25,7 +26,6 @@
 #include <memory>
 #include <string>
 #include <tuple>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -42,7 +42,7 @@ class TurnAnalysis
                  const std::vector<util::Coordinate> &node_coordinates,
                  const extractor::CompressedEdgeContainer &compressed_edge_container,
                  const extractor::RestrictionMap &restriction_map,
-                 const std::unordered_set<NodeID> &barrier_nodes,
+                 const util::IdSet<NodeID> &barrier_nodes,
                  const extractor::TurnLanesIndexedArray &turn_lanes_data,
                  const extractor::NameTable &name_table,
                  const extractor::SuffixTable &street_name_suffix_table);
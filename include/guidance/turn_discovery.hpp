@@ -4,9 +4,9 @@
 #include "extractor/restriction_index.hpp"
 #include "guidance/intersection.hpp"
 #include "guidance/turn_lane_data.hpp"
+#include "util/id_set.hpp"
 #include "util/typedefs.hpp"
 
-#include <unordered_set>
 
 namespace osrm
 {
@@ -38,7 +38,7 @@ bool findPreviousIntersection(
     const std::vector<util::Coordinate> &node_coordinates,
     const extractor::CompressedEdgeContainer &compressed_geometries,
     const extractor::RestrictionMap &node_restriction_map,
-    const std::unordered_set<NodeID> &barrier_nodes,
+    const util::IdSet<NodeID> &barrier_nodes,
     const extractor::TurnLanesIndexedArray &turn_lanes_data,
     // output parameters, will be in an arbitrary state on failure
     NodeID &result_node,
@@ -11,6 +11,7 @@
 
 #include "util/attributes.hpp"
 #include "util/guidance/turn_lanes.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 #include "util/typedefs.hpp"
 
@@ -76,7 +77,7 @@ class TurnLaneHandler
                     const std::vector<util::Coordinate> &node_coordinates,
                     const extractor::CompressedEdgeContainer &compressed_geometries,
                     const extractor::RestrictionMap &node_restriction_map,
-                    const std::unordered_set<NodeID> &barrier_nodes,
+                    const util::IdSet<NodeID> &barrier_nodes,
                     const extractor::TurnLanesIndexedArray &turn_lanes_data,
                     extractor::LaneDescriptionMap &lane_description_map,
                     const TurnAnalysis &turn_analysis,
@@ -97,7 +98,7 @@ class TurnLaneHandler
     const std::vector<util::Coordinate> &node_coordinates;
     const extractor::CompressedEdgeContainer &compressed_geometries;
     const extractor::RestrictionMap &node_restriction_map;
-    const std::unordered_set<NodeID> &barrier_nodes;
+    const util::IdSet<NodeID> &barrier_nodes;
     const extractor::TurnLanesIndexedArray &turn_lanes_data;
 
     std::vector<std::uint32_t> turn_lane_offsets;
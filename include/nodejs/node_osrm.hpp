@@ -8,11 +8,14 @@
 #include <nan.h>
 #pragma GCC diagnostic pop
 
+#include <cstddef>
 #include <memory>
 
 namespace node_osrm
 {
 
+class ThreadPool;
+
 struct Engine final : public Nan::ObjectWrap
 {
     using Base = Nan::ObjectWrap;
@@ -28,13 +31,17 @@ struct Engine final : public Nan::ObjectWrap
     static NAN_METHOD(match);
     static NAN_METHOD(trip);
 
-    Engine(osrm::EngineConfig &config);
+    Engine(osrm::EngineConfig &config, const std::size_t number_of_threads);
 
     // Thread-safe singleton accessor
     static Nan::Persistent<v8::Function> &constructor();
 
     // Ref-counted OSRM alive even after shutdown until last callback is done
     std::shared_ptr<osrm::OSRM> this_;
+
+    // Runs the requests if the object was created with a number of threads, the libuv threadpool
+    // runs them otherwise
+    std::shared_ptr<ThreadPool> pool;
 };
 
 } // ns node_osrm
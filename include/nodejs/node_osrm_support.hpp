@@ -18,10 +18,15 @@
 #include "osrm/tile_parameters.hpp"
 #include "osrm/trip_parameters.hpp"
 
+#include "util/json_renderer.hpp"
+
 #include <boost/assert.hpp>
 #include <boost/optional.hpp>
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
 #include <iterator>
 #include <string>
@@ -56,6 +61,129 @@ template <> v8::Local<v8::Value> inline render(const osrm::json::Object &result)
     return value;
 }
 
+// Hands the memory of the rendered JSON to the Buffer, which frees it when it is collected
+inline v8::Local<v8::Value> render(std::unique_ptr<std::vector<char>> buffer)
+{
+    auto *const data = buffer.get();
+    return Nan::NewBuffer(data->data(),
+                          data->size(),
+                          [](char * /*unused*/, void *hint) {
+                              delete static_cast<std::vector<char> *>(hint);
+                          },
+                          buffer.release())
+        .ToLocalChecked();
+}
+
+// Hands the values to a Float64Array on their memory, which is freed when it is collected
+inline v8::Local<v8::Value> renderToFloat64Array(std::vector<double> values)
+{
+    auto *const data = new std::vector<double>(std::move(values));
+    const auto length = data->size();
+    const auto buffer = Nan::NewBuffer(reinterpret_cast<char *>(data->data()),
+                                       length * sizeof(double),
+                                       [](char * /*unused*/, void *hint) {
+                                           delete static_cast<std::vector<double> *>(hint);
+                                       },
+                                       data)
+                            .ToLocalChecked()
+                            .As<v8::Uint8Array>();
+    return v8::Float64Array::New(buffer->Buffer(), buffer->ByteOffset(), length);
+}
+
+inline v8::Local<v8::Value> render(const osrm::engine::api::native::Waypoint &waypoint)
+{
+    v8::Local<v8::Object> object = Nan::New<v8::Object>();
+    v8::Local<v8::Array> location = Nan::New<v8::Array>(2);
+    location->Set(0, Nan::New(static_cast<double>(osrm::util::toFloating(waypoint.location.lon))));
+    location->Set(1, Nan::New(static_cast<double>(osrm::util::toFloating(waypoint.location.lat))));
+    object->Set(Nan::New("location").ToLocalChecked(), location);
+    object->Set(Nan::New("name").ToLocalChecked(), Nan::New(waypoint.name).ToLocalChecked());
+    if (!waypoint.hint.empty())
+    {
+        object->Set(Nan::New("hint").ToLocalChecked(), Nan::New(waypoint.hint).ToLocalChecked());
+    }
+    return object;
+}
+
+inline v8::Local<v8::Value>
+render(const std::vector<osrm::engine::api::native::Waypoint> &waypoints)
+{
+    v8::Local<v8::Array> array = Nan::New<v8::Array>(waypoints.size());
+    for (auto i = 0u; i < waypoints.size(); ++i)
+    {
+        array->Set(i, render(waypoints[i]));
+    }
+    return array;
+}
+
+// The flat matrices are moved into Float64Arrays, unreachable pairs are Infinity
+inline v8::Local<v8::Value> render(osrm::engine::api::native::TableResult &result)
+{
+    v8::Local<v8::Object> object = Nan::New<v8::Object>();
+    object->Set(Nan::New("sources").ToLocalChecked(), render(result.sources));
+    object->Set(Nan::New("destinations").ToLocalChecked(), render(result.destinations));
+    if (!result.durations.empty())
+    {
+        object->Set(Nan::New("durations").ToLocalChecked(),
+                    renderToFloat64Array(std::move(result.durations)));
+    }
+    if (!result.distances.empty())
+    {
+        object->Set(Nan::New("distances").ToLocalChecked(),
+                    renderToFloat64Array(std::move(result.distances)));
+    }
+    return object;
+}
+
+// Hands the memory of the binary format to the Buffer, which frees it when it is collected
+inline v8::Local<v8::Value> renderBinary(std::string result)
+{
+    auto *const data = new std::string(std::move(result));
+    return Nan::NewBuffer(&(*data)[0],
+                          data->size(),
+                          [](char * /*unused*/, void *hint) {
+                              delete static_cast<std::string *>(hint);
+                          },
+                          data)
+        .ToLocalChecked();
+}
+
+struct ResultRenderer
+{
+    v8::Local<v8::Value> operator()(osrm::json::Object &object) const { return render(object); }
+    v8::Local<v8::Value> operator()(std::string &binary) const
+    {
+        return renderBinary(std::move(binary));
+    }
+    v8::Local<v8::Value> operator()(osrm::engine::api::native::TableResult &table) const
+    {
+        return render(table);
+    }
+    template <typename NativeResultT> v8::Local<v8::Value> operator()(NativeResultT &) const
+    {
+        BOOST_ASSERT_MSG(false, "only table results are requested as native results");
+        return Nan::Undefined();
+    }
+};
+
+inline v8::Local<v8::Value> render(osrm::engine::api::ResultT &result)
+{
+    return mapbox::util::apply_visitor(ResultRenderer{}, result);
+}
+
+// Renders the JSON text of a result on the worker thread, tiles are Buffers already
+inline std::unique_ptr<std::vector<char>> renderToBuffer(const osrm::json::Object &result)
+{
+    auto buffer = std::make_unique<std::vector<char>>();
+    osrm::util::json::render(*buffer, result);
+    return buffer;
+}
+
+inline std::unique_ptr<std::vector<char>> renderToBuffer(const std::string & /*unused*/)
+{
+    return nullptr;
+}
+
 inline void ParseResult(const osrm::Status &result_status, osrm::json::Object &result)
 {
     const auto code_iter = result.values.find("code");
@@ -63,7 +191,7 @@ inline void ParseResult(const osrm::Status &result_status, osrm::json::Object &r
 
     BOOST_ASSERT(code_iter != end_iter);
 
-    if (result_status == osrm::Status::Error)
+    if (result_status != osrm::Status::Ok)
     {
         throw std::logic_error(code_iter->second.get<osrm::json::String>().value.c_str());
     }
@@ -78,6 +206,15 @@ inline void ParseResult(const osrm::Status &result_status, osrm::json::Object &r
 
 inline void ParseResult(const osrm::Status & /*result_status*/, const std::string & /*unused*/) {}
 
+// Errors and the results of services without a native result are JSON objects
+inline void ParseResult(const osrm::Status &result_status, osrm::engine::api::ResultT &result)
+{
+    if (result_status != osrm::Status::Ok || result.is<osrm::json::Object>())
+    {
+        ParseResult(result_status, result.get<osrm::json::Object>());
+    }
+}
+
 inline engine_config_ptr argumentsToEngineConfig(const Nan::FunctionCallbackInfo<v8::Value> &args)
 {
     Nan::HandleScope scope;
@@ -220,6 +357,7 @@ inline engine_config_ptr argumentsToEngineConfig(const Nan::FunctionCallbackInfo
         params->Get(Nan::New("max_locations_map_matching").ToLocalChecked());
     auto max_results_nearest = params->Get(Nan::New("max_results_nearest").ToLocalChecked());
     auto max_alternatives = params->Get(Nan::New("max_alternatives").ToLocalChecked());
+    auto max_alternative_time = params->Get(Nan::New("max_alternative_time").ToLocalChecked());
     auto max_radius_map_matching =
         params->Get(Nan::New("max_radius_map_matching").ToLocalChecked());
 
@@ -253,6 +391,11 @@ inline engine_config_ptr argumentsToEngineConfig(const Nan::FunctionCallbackInfo
         Nan::ThrowError("max_alternatives must be an integral number");
         return engine_config_ptr();
     }
+    if (!max_alternative_time->IsUndefined() && !max_alternative_time->IsNumber())
+    {
+        Nan::ThrowError("max_alternative_time must be an integral number");
+        return engine_config_ptr();
+    }
 
     if (max_locations_trip->IsNumber())
         engine_config->max_locations_trip = static_cast<int>(max_locations_trip->NumberValue());
@@ -269,6 +412,9 @@ inline engine_config_ptr argumentsToEngineConfig(const Nan::FunctionCallbackInfo
         engine_config->max_results_nearest = static_cast<int>(max_results_nearest->NumberValue());
     if (max_alternatives->IsNumber())
         engine_config->max_alternatives = static_cast<int>(max_alternatives->NumberValue());
+    if (max_alternative_time->IsNumber())
+        engine_config->max_alternative_time =
+            static_cast<int>(max_alternative_time->NumberValue());
     if (max_radius_map_matching->IsNumber())
         engine_config->max_radius_map_matching =
             static_cast<double>(max_radius_map_matching->NumberValue());
@@ -276,6 +422,117 @@ inline engine_config_ptr argumentsToEngineConfig(const Nan::FunctionCallbackInfo
     return engine_config;
 }
 
+// Number of threads of the pool of an OSRM object, zero to run its queries on the libuv threadpool
+inline boost::optional<std::size_t>
+argumentsToNumberOfThreads(const Nan::FunctionCallbackInfo<v8::Value> &args)
+{
+    Nan::HandleScope scope;
+    if (args.Length() == 0 || !args[0]->IsObject())
+    {
+        return std::size_t{0};
+    }
+
+    auto params = Nan::To<v8::Object>(args[0]).ToLocalChecked();
+    auto threads = params->Get(Nan::New("threads").ToLocalChecked());
+    if (threads.IsEmpty())
+        return boost::none;
+
+    if (threads->IsUndefined())
+    {
+        return std::size_t{0};
+    }
+
+    if (!threads->IsNumber() || threads->NumberValue() < 1 ||
+        threads->NumberValue() != static_cast<std::uint32_t>(threads->NumberValue()))
+    {
+        Nan::ThrowError("threads must be a positive integral number");
+        return boost::none;
+    }
+
+    return static_cast<std::size_t>(threads->NumberValue());
+}
+
+// The options of a query that are not parameters of the service
+struct PluginParameters
+{
+    enum class Format
+    {
+        // converts the result to objects
+        Object,
+        // returns the JSON text in a Buffer, rendered on the worker thread
+        JSONBuffer,
+        // returns the matrices of table results as Float64Arrays on the memory of the result
+        TypedArray,
+        // returns the binary format of route, table and match results in a Buffer
+        Binary
+    };
+
+    Format format = Format::Object;
+};
+
+inline boost::optional<PluginParameters>
+argumentsToPluginParameters(const Nan::FunctionCallbackInfo<v8::Value> &args)
+{
+    Nan::HandleScope scope;
+    PluginParameters plugin_params;
+
+    // the plugin config is the optional argument between the query options and the callback
+    if (args.Length() < 3)
+    {
+        return plugin_params;
+    }
+
+    if (!args[1]->IsObject())
+    {
+        Nan::ThrowTypeError("Plugin config must be an object");
+        return boost::none;
+    }
+
+    auto params = Nan::To<v8::Object>(args[1]).ToLocalChecked();
+    auto format = params->Get(Nan::New("format").ToLocalChecked());
+    if (format.IsEmpty())
+        return boost::none;
+
+    if (format->IsUndefined())
+    {
+        return plugin_params;
+    }
+
+    if (!format->IsString())
+    {
+        Nan::ThrowError("format must be a string: \"object\", \"json_buffer\", "
+                        "\"typed_array\" or \"binary\"");
+        return boost::none;
+    }
+
+    const std::string format_str =
+        *v8::String::Utf8Value(Nan::To<v8::String>(format).ToLocalChecked());
+    if (format_str == "object")
+    {
+        plugin_params.format = PluginParameters::Format::Object;
+    }
+    else if (format_str == "json_buffer")
+    {
+        plugin_params.format = PluginParameters::Format::JSONBuffer;
+    }
+    else if (format_str == "typed_array")
+    {
+        plugin_params.format = PluginParameters::Format::TypedArray;
+    }
+    else if (format_str == "binary")
+    {
+        plugin_params.format = PluginParameters::Format::Binary;
+    }
+    else
+    {
+        Nan::ThrowError("format must be a string: \"object\", \"json_buffer\", "
+                        "\"typed_array\" or \"binary\"");
+        return boost::none;
+    }
+
+    return plugin_params;
+}
+
 inline boost::optional<std::vector<osrm::Coordinate>>
 parseCoordinateArray(const v8::Local<v8::Array> &coordinates_array)
 {
@@ -657,6 +914,44 @@ inline bool argumentsToParameter(const Nan::FunctionCallbackInfo<v8::Value> &arg
         }
     }
 
+    if (obj->Has(Nan::New("metric").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> metric = obj->Get(Nan::New("metric").ToLocalChecked());
+        if (metric.IsEmpty())
+            return false;
+
+        if (!metric->IsString())
+        {
+            Nan::ThrowError("Metric must be a string");
+            return false;
+        }
+
+        params->metric = *v8::String::Utf8Value(metric);
+    }
+
+    if (obj->Has(Nan::New("depart_at").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> depart_at = obj->Get(Nan::New("depart_at").ToLocalChecked());
+        if (depart_at.IsEmpty())
+            return false;
+
+        unsigned hour = 0, minute = 0;
+        char trailing;
+        if (!depart_at->IsString() ||
+            std::sscanf(*v8::String::Utf8Value(depart_at),
+                        "%2u:%2u%c",
+                        &hour,
+                        &minute,
+                        &trailing) != 2 ||
+            hour > 23 || minute > 59)
+        {
+            Nan::ThrowError("Departure time must be a string HH:MM");
+            return false;
+        }
+
+        params->depart_at = hour * 60 + minute;
+    }
+
     return true;
 }
 
@@ -1064,6 +1359,20 @@ argumentsToTableParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
         }
     }
 
+    if (obj->Has(Nan::New("approximate").ToLocalChecked()))
+    {
+        auto approximate = obj->Get(Nan::New("approximate").ToLocalChecked());
+        if (approximate.IsEmpty())
+            return table_parameters_ptr();
+
+        if (!approximate->IsBoolean())
+        {
+            Nan::ThrowError("'approximate' param must be a boolean");
+            return table_parameters_ptr();
+        }
+        params->approximate = approximate->BooleanValue();
+    }
+
     return params;
 }
 
@@ -0,0 +1,155 @@
+#ifndef OSRM_BINDINGS_NODE_THREAD_POOL_HPP
+#define OSRM_BINDINGS_NODE_THREAD_POOL_HPP
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <nan.h>
+#pragma GCC diagnostic pop
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace node_osrm
+{
+
+/**
+ * Runs the async workers of the OSRM requests on threads of its own instead of the libuv
+ * threadpool, which has four threads by default and is shared with file system and DNS requests.
+ *
+ * Like with Nan::AsyncQueueWorker the workers are executed on the threads of the pool and are
+ * completed on the thread of the event loop. Queued requests keep the event loop and the pool
+ * alive until they are completed.
+ */
+class ThreadPool final : public std::enable_shared_from_this<ThreadPool>
+{
+  public:
+    explicit ThreadPool(const std::size_t number_of_threads) : async(new uv_async_t)
+    {
+        uv_async_init(uv_default_loop(), async, &ThreadPool::Complete);
+        async->data = this;
+        uv_unref(reinterpret_cast<uv_handle_t *>(async));
+
+        threads.reserve(number_of_threads);
+        for (std::size_t index = 0; index < number_of_threads; ++index)
+        {
+            threads.emplace_back([this] { Run(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        uv_close(reinterpret_cast<uv_handle_t *>(async),
+                 [](uv_handle_t *handle) { delete reinterpret_cast<uv_async_t *>(handle); });
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Needs to be called on the thread of the event loop
+    void Queue(Nan::AsyncWorker *worker)
+    {
+        if (number_of_requests++ == 0)
+        {
+            uv_ref(reinterpret_cast<uv_handle_t *>(async));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued.push_back(Request{worker, shared_from_this()});
+        }
+        condition.notify_one();
+    }
+
+  private:
+    struct Request
+    {
+        Nan::AsyncWorker *worker;
+        std::shared_ptr<ThreadPool> pool;
+    };
+
+    void Run()
+    {
+        while (true)
+        {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopping || !queued.empty(); });
+                if (queued.empty())
+                {
+                    return;
+                }
+                request = std::move(queued.front());
+                queued.pop_front();
+            }
+
+            request.worker->Execute();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                completed.push_back(std::move(request));
+            }
+            // the pool is not destroyed before this thread returns, see the destructor
+            uv_async_send(async);
+        }
+    }
+
+    // Called on the thread of the event loop, several sends may be coalesced into one call
+    static void Complete(uv_async_t *handle)
+    {
+        auto *const pool = static_cast<ThreadPool *>(handle->data);
+
+        std::deque<Request> requests;
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            std::swap(requests, pool->completed);
+        }
+
+        for (const auto &request : requests)
+        {
+            request.worker->WorkComplete();
+            request.worker->Destroy();
+        }
+
+        // callbacks may have queued new requests
+        pool->number_of_requests -= requests.size();
+        if (pool->number_of_requests == 0)
+        {
+            uv_unref(reinterpret_cast<uv_handle_t *>(handle));
+        }
+
+        // the last request may hold the last reference to the pool
+        requests.clear();
+    }
+
+    uv_async_t *async;
+    // only accessed on the thread of the event loop
+    std::size_t number_of_requests = 0;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Request> queued;
+    std::deque<Request> completed;
+    bool stopping = false;
+
+    std::vector<std::thread> threads;
+};
+
+} // ns node_osrm
+
+#endif
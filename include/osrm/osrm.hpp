@@ -31,13 +31,19 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "osrm/osrm_fwd.hpp"
 #include "osrm/status.hpp"
 
+#include "engine/api/base_result.hpp"
+#include "engine/dataset_version.hpp"
+
 #include <memory>
 #include <string>
 
 namespace osrm
 {
 namespace json = util::json;
+using engine::DatasetVersion;
 using engine::EngineConfig;
+using engine::api::BatchParameters;
+using engine::api::IsochroneParameters;
 using engine::api::MatchParameters;
 using engine::api::NearestParameters;
 using engine::api::RouteParameters;
@@ -56,8 +62,12 @@ using engine::api::TripParameters;
  *  - Trip: shortest round trip between coordinates
  *  - Match: snaps noisy coordinate traces to the road network
  *  - Tile: vector tiles with internal graph representation
+ *  - Batch: shortest paths between many independent pairs of coordinates
+ *  - Isochrone: locations reached from a coordinate within a duration
  *
  *  All services take service-specific parameters, fill a JSON object, and return a status code.
+ *  Route, Table and Match can also fill a binary response or plain result structs, see
+ *  engine::api::ResultT.
  */
 class OSRM final
 {
@@ -85,6 +95,17 @@ class OSRM final
      */
     Status Route(const RouteParameters &parameters, json::Object &result) const;
 
+    /**
+     * Shortest path queries for coordinates.
+     *
+     * \param parameters route query specific parameters
+     * \param result holds a JSON object, a string for the binary format or the native result of
+     *        the service, errors are JSON
+     * \return Status indicating success for the query or failure
+     * \see Status, RouteParameters and engine::api::ResultT
+     */
+    Status Route(const RouteParameters &parameters, engine::api::ResultT &result) const;
+
     /**
      * Distance tables for coordinates.
      *
@@ -94,6 +115,17 @@ class OSRM final
      */
     Status Table(const TableParameters &parameters, json::Object &result) const;
 
+    /**
+     * Distance tables for coordinates.
+     *
+     * \param parameters table query specific parameters
+     * \param result holds a JSON object, a string for the binary format or the native result of
+     *        the service, errors are JSON
+     * \return Status indicating success for the query or failure
+     * \see Status, TableParameters and engine::api::ResultT
+     */
+    Status Table(const TableParameters &parameters, engine::api::ResultT &result) const;
+
     /**
      * Nearest street segment for coordinate.
      *
@@ -121,6 +153,17 @@ class OSRM final
      */
     Status Match(const MatchParameters &parameters, json::Object &result) const;
 
+    /**
+     * Match: snaps noisy coordinate traces to the road network
+     *
+     * \param parameters match query specific parameters
+     * \param result holds a JSON object, a string for the binary format or the native result of
+     *        the service, errors are JSON
+     * \return Status indicating success for the query or failure
+     * \see Status, MatchParameters and engine::api::ResultT
+     */
+    Status Match(const MatchParameters &parameters, engine::api::ResultT &result) const;
+
     /**
      * Tile: vector tiles with internal graph representation
      *
@@ -130,6 +173,54 @@ class OSRM final
      */
     Status Tile(const TileParameters &parameters, std::string &result) const;
 
+    /**
+     * Batch: shortest paths between many independent pairs of coordinates
+     *
+     * \param parameters batch query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, BatchParameters and json::Object
+     */
+    Status Batch(const BatchParameters &parameters, json::Object &result) const;
+
+    /**
+     * Isochrone: locations reached from a coordinate within a duration
+     *
+     * \param parameters isochrone query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, IsochroneParameters and json::Object
+     */
+    Status Isochrone(const IsochroneParameters &parameters, json::Object &result) const;
+
+    /**
+     * Memory: the mapped and resident bytes of the blocks of the dataset
+     *
+     * The blocks are grouped into subsystems like the graph, the geometry, the names, the r-tree,
+     * the guidance data and the cell metrics of each metric.
+     *
+     * \return Status indicating success for the query or failure
+     * \see Status and json::Object
+     */
+    Status Memory(json::Object &result) const;
+
+    /**
+     * GetDatasetVersion: identifies the data the queries are computed on
+     *
+     * The version changes whenever other data or other weights are loaded, osrm-routed derives
+     * the ETag and the Last-Modified header of its replies from it.
+     *
+     * \return the checksum, the generation and the load time of the dataset
+     * \see DatasetVersion
+     */
+    DatasetVersion GetDatasetVersion() const;
+
+    /**
+     * WarmUp: allocates the query heaps of the calling thread
+     *
+     * The heaps are kept per thread, threads that call this before their first query do not pay
+     * for the allocation on it.
+     */
+    void WarmUp() const;
+
   private:
     std::unique_ptr<engine::EngineInterface> engine_;
 };
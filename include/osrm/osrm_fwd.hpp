@@ -52,6 +52,8 @@ struct NearestParameters;
 struct TripParameters;
 struct MatchParameters;
 struct TileParameters;
+struct BatchParameters;
+struct IsochroneParameters;
 } // ns api
 
 class EngineInterface;
@@ -5,6 +5,7 @@
 
 #include "util/assert.hpp"
 #include "util/for_each_range.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
 #include "util/typedefs.hpp"
 #include "util/vector_view.hpp"
@@ -20,7 +21,9 @@
 #include <tbb/parallel_sort.h>
 
 #include <algorithm>
+#include <limits>
 #include <numeric>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -61,11 +64,12 @@ template <storage::Ownership Ownership> class CellStorageImpl
     static constexpr auto INVALID_VALUE_OFFSET = std::numeric_limits<ValueOffset>::max();
     static constexpr auto INVALID_BOUNDARY_OFFSET = std::numeric_limits<BoundaryOffset>::max();
 
+    // The boundary of a cell holds its source nodes followed by its destination nodes, so a
+    // search that enters a cell reads all its nodes from one place, four cells per cache line.
     struct CellData
     {
         ValueOffset value_offset = INVALID_VALUE_OFFSET;
-        BoundaryOffset source_boundary_offset = INVALID_BOUNDARY_OFFSET;
-        BoundaryOffset destination_boundary_offset = INVALID_BOUNDARY_OFFSET;
+        BoundaryOffset boundary_offset = INVALID_BOUNDARY_OFFSET;
         BoundarySize num_source_nodes = 0;
         BoundarySize num_destination_nodes = 0;
     };
@@ -179,27 +183,194 @@ template <storage::Ownership Ownership> class CellStorageImpl
         CellImpl(const CellData &data,
                  WeightPtrT const all_weights,
                  DurationPtrT const all_durations,
-                 const NodeID *const all_sources,
-                 const NodeID *const all_destinations)
+                 const NodeID *const all_boundary)
             : num_source_nodes{data.num_source_nodes},
               num_destination_nodes{data.num_destination_nodes},
               weights{all_weights + data.value_offset},
               durations{all_durations + data.value_offset},
-              source_boundary{all_sources + data.source_boundary_offset},
-              destination_boundary{all_destinations + data.destination_boundary_offset}
+              source_boundary{all_boundary + data.boundary_offset},
+              destination_boundary{source_boundary + num_source_nodes}
         {
             BOOST_ASSERT(all_weights != nullptr);
             BOOST_ASSERT(all_durations != nullptr);
-            BOOST_ASSERT(num_source_nodes == 0 || all_sources != nullptr);
-            BOOST_ASSERT(num_destination_nodes == 0 || all_destinations != nullptr);
+            BOOST_ASSERT(num_source_nodes + num_destination_nodes == 0 || all_boundary != nullptr);
         }
     };
 
+    // Read-only view of a cell, which also decodes the narrow values of compressed metrics
+    class ConstCellImpl
+    {
+      private:
+        // Iterates over a row or a column of the full values or of the narrow offsets to a base
+        template <typename ValueT>
+        class ValueIterator : public boost::iterator_facade<ValueIterator<ValueT>,
+                                                            ValueT,
+                                                            boost::random_access_traversal_tag,
+                                                            ValueT>
+        {
+            typedef boost::iterator_facade<ValueIterator<ValueT>,
+                                           ValueT,
+                                           boost::random_access_traversal_tag,
+                                           ValueT>
+                base_t;
+
+          public:
+            typedef typename base_t::value_type value_type;
+            typedef typename base_t::difference_type difference_type;
+            typedef typename base_t::reference reference;
+            typedef std::random_access_iterator_tag iterator_category;
+
+            explicit ValueIterator()
+                : values(nullptr), offsets(nullptr), base(0), position(0), stride(1)
+            {
+            }
+
+            explicit ValueIterator(const ValueT *values,
+                                   const std::uint16_t *offsets,
+                                   const ValueT base,
+                                   const std::size_t position,
+                                   const std::size_t stride)
+                : values(values), offsets(offsets), base(base), position(position), stride(stride)
+            {
+            }
+
+          private:
+            void increment() { position += stride; }
+            void decrement() { position -= stride; }
+            void advance(difference_type offset) { position += stride * offset; }
+            bool equal(const ValueIterator &other) const { return position == other.position; }
+            reference dereference() const
+            {
+                if (offsets == nullptr)
+                    return values[position];
+
+                // the invalid weight and the maximal duration are both the largest value
+                const auto offset = offsets[position];
+                return offset == customizer::CompressedCellValues::INVALID_OFFSET
+                           ? std::numeric_limits<ValueT>::max()
+                           : base + offset;
+            }
+            difference_type distance_to(const ValueIterator &other) const
+            {
+                return (static_cast<std::intptr_t>(other.position) -
+                        static_cast<std::intptr_t>(position)) /
+                       static_cast<std::intptr_t>(stride);
+            }
+
+            friend class ::boost::iterator_core_access;
+            const ValueT *values;
+            const std::uint16_t *offsets;
+            ValueT base;
+            std::size_t position;
+            std::size_t stride;
+        };
+
+        template <typename ValueT>
+        auto GetOutRange(const ValueT *values,
+                         const std::uint16_t *offsets,
+                         const ValueT base,
+                         const NodeID node) const
+        {
+            auto iter = std::find(source_boundary, source_boundary + num_source_nodes, node);
+            if (iter == source_boundary + num_source_nodes)
+                return boost::make_iterator_range(ValueIterator<ValueT>{}, ValueIterator<ValueT>{});
+
+            const std::size_t row = std::distance(source_boundary, iter);
+            const auto begin = num_destination_nodes * row;
+            return boost::make_iterator_range(
+                ValueIterator<ValueT>{values, offsets, base, begin, 1},
+                ValueIterator<ValueT>{values, offsets, base, begin + num_destination_nodes, 1});
+        }
+
+        template <typename ValueT>
+        auto GetInRange(const ValueT *values,
+                        const std::uint16_t *offsets,
+                        const ValueT base,
+                        const NodeID node) const
+        {
+            auto iter =
+                std::find(destination_boundary, destination_boundary + num_destination_nodes, node);
+            if (iter == destination_boundary + num_destination_nodes)
+                return boost::make_iterator_range(ValueIterator<ValueT>{}, ValueIterator<ValueT>{});
+
+            const std::size_t column = std::distance(destination_boundary, iter);
+            const std::size_t end = column + num_source_nodes * num_destination_nodes;
+            return boost::make_iterator_range(
+                ValueIterator<ValueT>{values, offsets, base, column, num_destination_nodes},
+                ValueIterator<ValueT>{values, offsets, base, end, num_destination_nodes});
+        }
+
+      public:
+        auto GetOutWeight(NodeID node) const
+        {
+            return GetOutRange(weights, narrow_weights, weight_base, node);
+        }
+
+        auto GetInWeight(NodeID node) const
+        {
+            return GetInRange(weights, narrow_weights, weight_base, node);
+        }
+
+        auto GetOutDuration(NodeID node) const
+        {
+            return GetOutRange(durations, narrow_durations, duration_base, node);
+        }
+
+        auto GetInDuration(NodeID node) const
+        {
+            return GetInRange(durations, narrow_durations, duration_base, node);
+        }
+
+        auto GetSourceNodes() const
+        {
+            return boost::make_iterator_range(source_boundary, source_boundary + num_source_nodes);
+        }
+
+        auto GetDestinationNodes() const
+        {
+            return boost::make_iterator_range(destination_boundary,
+                                              destination_boundary + num_destination_nodes);
+        }
+
+        // Uses the full values if the narrow values are nullptr
+        ConstCellImpl(const CellData &data,
+                      const EdgeWeight *const weights,
+                      const EdgeDuration *const durations,
+                      const std::uint16_t *const narrow_weights,
+                      const std::uint16_t *const narrow_durations,
+                      const EdgeWeight weight_base,
+                      const EdgeDuration duration_base,
+                      const NodeID *const all_boundary)
+            : num_source_nodes{data.num_source_nodes},
+              num_destination_nodes{data.num_destination_nodes}, weights{weights},
+              durations{durations}, narrow_weights{narrow_weights},
+              narrow_durations{narrow_durations}, weight_base{weight_base},
+              duration_base{duration_base},
+              source_boundary{all_boundary + data.boundary_offset},
+              destination_boundary{source_boundary + num_source_nodes}
+        {
+            BOOST_ASSERT(num_source_nodes + num_destination_nodes == 0 || all_boundary != nullptr);
+        }
+
+      private:
+        BoundarySize num_source_nodes;
+        BoundarySize num_destination_nodes;
+
+        const EdgeWeight *const weights;
+        const EdgeDuration *const durations;
+        const std::uint16_t *const narrow_weights;
+        const std::uint16_t *const narrow_durations;
+        const EdgeWeight weight_base;
+        const EdgeDuration duration_base;
+        const NodeID *const source_boundary;
+        const NodeID *const destination_boundary;
+    };
+
     std::size_t LevelIDToIndex(LevelID level) const { return level - 1; }
 
   public:
     using Cell = CellImpl<EdgeWeight, EdgeDuration>;
-    using ConstCell = CellImpl<const EdgeWeight, const EdgeDuration>;
+    using ConstCell = ConstCellImpl;
 
     CellStorageImpl() {}
 
@@ -270,47 +441,27 @@ template <storage::Ownership Ownership> class CellStorageImpl
             tbb::parallel_sort(level_destination_boundary.begin(),
                                level_destination_boundary.end());
 
-            const auto insert_cell_boundary = [this, level_offset](auto &boundary,
-                                                                   auto set_num_nodes_fn,
-                                                                   auto set_boundary_offset_fn,
-                                                                   auto begin,
-                                                                   auto end) {
-                BOOST_ASSERT(std::distance(begin, end) > 0);
-
-                const auto cell_id = begin->first;
+            auto source = level_source_boundary.begin();
+            auto destination = level_destination_boundary.begin();
+            for (const auto cell_id : util::irange<CellID>(0, partition.GetNumberOfCells(level)))
+            {
                 BOOST_ASSERT(level_offset + cell_id < cells.size());
                 auto &cell = cells[level_offset + cell_id];
-                set_num_nodes_fn(cell, std::distance(begin, end));
-                set_boundary_offset_fn(cell, boundary.size());
-
-                std::transform(begin,
-                               end,
-                               std::back_inserter(boundary),
-                               [](const auto &cell_and_node) { return cell_and_node.second; });
-            };
-
-            util::for_each_range(
-                level_source_boundary.begin(),
-                level_source_boundary.end(),
-                [this, insert_cell_boundary](auto begin, auto end) {
-                    insert_cell_boundary(
-                        source_boundary,
-                        [](auto &cell, auto value) { cell.num_source_nodes = value; },
-                        [](auto &cell, auto value) { cell.source_boundary_offset = value; },
-                        begin,
-                        end);
-                });
-            util::for_each_range(
-                level_destination_boundary.begin(),
-                level_destination_boundary.end(),
-                [this, insert_cell_boundary](auto begin, auto end) {
-                    insert_cell_boundary(
-                        destination_boundary,
-                        [](auto &cell, auto value) { cell.num_destination_nodes = value; },
-                        [](auto &cell, auto value) { cell.destination_boundary_offset = value; },
-                        begin,
-                        end);
-                });
+                const BoundaryOffset boundary_offset = boundary.size();
+                for (; source != level_source_boundary.end() && source->first == cell_id; ++source)
+                    boundary.push_back(source->second);
+                cell.num_source_nodes = boundary.size() - boundary_offset;
+                for (; destination != level_destination_boundary.end() &&
+                       destination->first == cell_id;
+                     ++destination)
+                    boundary.push_back(destination->second);
+                cell.num_destination_nodes =
+                    boundary.size() - boundary_offset - cell.num_source_nodes;
+                if (boundary.size() > boundary_offset)
+                    cell.boundary_offset = boundary_offset;
+            }
+            BOOST_ASSERT(source == level_source_boundary.end());
+            BOOST_ASSERT(destination == level_destination_boundary.end());
         }
 
         // a partition that contains boundary nodes that have no arcs going into
@@ -351,13 +502,106 @@ template <storage::Ownership Ownership> class CellStorageImpl
         return metric;
     }
 
+    // Returns a compressed copy of a metric of this container. The values of a cell are stored
+    // as 16 bit offsets to the smallest value of the cell if all its finite values fit, weights
+    // and durations are compressed independently. Both metrics give the same values by GetCell.
+    customizer::CellMetric CompressMetric(const customizer::CellMetric &metric) const
+    {
+        BOOST_ASSERT(!metric.IsCompressed());
+        customizer::CellMetric compressed;
+        compressed.compressed_cells.resize(cells.size());
+
+        const auto compress = [](const auto *const values,
+                                 const std::size_t size,
+                                 auto &wide_values,
+                                 std::vector<std::uint16_t> &narrow_values,
+                                 std::uint32_t &offset) {
+            using ValueT = std::remove_const_t<std::remove_pointer_t<decltype(values)>>;
+            const auto invalid = std::numeric_limits<ValueT>::max();
+
+            auto min_value = invalid, max_value = std::numeric_limits<ValueT>::min();
+            for (const auto index : util::irange<std::size_t>(0, size))
+            {
+                if (values[index] == invalid)
+                    continue;
+                min_value = std::min(min_value, values[index]);
+                max_value = std::max(max_value, values[index]);
+            }
+
+            const auto narrow =
+                size > 0 && (min_value == invalid ||
+                             static_cast<std::int64_t>(max_value) - min_value <
+                                 customizer::CompressedCellValues::INVALID_OFFSET);
+            if (!narrow)
+            {
+                offset = wide_values.size();
+                wide_values.insert(wide_values.end(), values, values + size);
+                return invalid;
+            }
+
+            const auto base = min_value == invalid ? ValueT{0} : min_value;
+            offset = narrow_values.size();
+            for (const auto index : util::irange<std::size_t>(0, size))
+            {
+                narrow_values.push_back(values[index] == invalid
+                                            ? customizer::CompressedCellValues::INVALID_OFFSET
+                                            : static_cast<std::uint16_t>(values[index] - base));
+            }
+            return base;
+        };
+
+        for (const auto cell_index : util::irange<std::size_t>(0, cells.size()))
+        {
+            const auto &cell = cells[cell_index];
+            const std::size_t size = cell.num_source_nodes * cell.num_destination_nodes;
+            auto &values = compressed.compressed_cells[cell_index];
+            values.weight_base = compress(metric.weights.data() + cell.value_offset,
+                                          size,
+                                          compressed.weights,
+                                          compressed.narrow_weights,
+                                          values.weight_offset);
+            values.duration_base = compress(metric.durations.data() + cell.value_offset,
+                                            size,
+                                            compressed.durations,
+                                            compressed.narrow_durations,
+                                            values.duration_offset);
+        }
+
+        return compressed;
+    }
+
+    // Returns the full values of a compressed metric of this container
+    customizer::CellMetric DecompressMetric(const customizer::CellMetric &metric) const
+    {
+        BOOST_ASSERT(metric.IsCompressed());
+        auto decompressed = MakeMetric();
+        for (const auto level_index : util::irange<std::size_t>(1, level_to_cell_offset.size()))
+        {
+            const LevelID level = level_index;
+            const auto number_of_cells =
+                level_to_cell_offset[level_index] - level_to_cell_offset[level_index - 1];
+            for (const auto id : util::irange<CellID>(0, number_of_cells))
+            {
+                const auto cell = GetCell(metric, level, id);
+                auto output = GetCell(decompressed, level, id);
+                for (const auto source : cell.GetSourceNodes())
+                {
+                    const auto weights = cell.GetOutWeight(source);
+                    const auto durations = cell.GetOutDuration(source);
+                    std::copy(weights.begin(), weights.end(), output.GetOutWeight(source).begin());
+                    std::copy(
+                        durations.begin(), durations.end(), output.GetOutDuration(source).begin());
+                }
+            }
+        }
+        return decompressed;
+    }
+
     template <typename = std::enable_if<Ownership == storage::Ownership::View>>
-    CellStorageImpl(Vector<NodeID> source_boundary_,
-                    Vector<NodeID> destination_boundary_,
+    CellStorageImpl(Vector<NodeID> boundary_,
                     Vector<CellData> cells_,
                     Vector<std::uint64_t> level_to_cell_offset_)
-        : source_boundary(std::move(source_boundary_)),
-          destination_boundary(std::move(destination_boundary_)), cells(std::move(cells_)),
+        : boundary(std::move(boundary_)), cells(std::move(cells_)),
           level_to_cell_offset(std::move(level_to_cell_offset_))
     {
     }
@@ -371,11 +615,44 @@ template <storage::Ownership Ownership> class CellStorageImpl
         const auto offset = level_to_cell_offset[level_index];
         const auto cell_index = offset + id;
         BOOST_ASSERT(cell_index < cells.size());
-        return ConstCell{cells[cell_index],
-                         metric.weights.data(),
-                         metric.durations.data(),
-                         source_boundary.empty() ? nullptr : source_boundary.data(),
-                         destination_boundary.empty() ? nullptr : destination_boundary.data()};
+        const auto &cell = cells[cell_index];
+        const auto all_boundary = boundary.empty() ? nullptr : boundary.data();
+
+        if (!metric.IsCompressed())
+        {
+            return ConstCell{cell,
+                             metric.weights.data() + cell.value_offset,
+                             metric.durations.data() + cell.value_offset,
+                             nullptr,
+                             nullptr,
+                             0,
+                             0,
+                             all_boundary};
+        }
+
+        BOOST_ASSERT(cell_index < metric.compressed_cells.size());
+        const auto &values = metric.compressed_cells[cell_index];
+        const auto narrow_weights = values.NarrowWeights();
+        const auto narrow_durations = values.NarrowDurations();
+        return ConstCell{
+            cell,
+            narrow_weights ? nullptr : metric.weights.data() + values.weight_offset,
+            narrow_durations ? nullptr : metric.durations.data() + values.duration_offset,
+            narrow_weights ? metric.narrow_weights.data() + values.weight_offset : nullptr,
+            narrow_durations ? metric.narrow_durations.data() + values.duration_offset : nullptr,
+            values.weight_base,
+            values.duration_base,
+            all_boundary};
+    }
+
+    // Returns the number of source and destination nodes of a cell, which needs no metric
+    std::pair<BoundarySize, BoundarySize> GetBoundarySize(LevelID level, CellID id) const
+    {
+        const auto level_index = LevelIDToIndex(level);
+        BOOST_ASSERT(level_index < level_to_cell_offset.size());
+        const auto cell_index = level_to_cell_offset[level_index] + id;
+        BOOST_ASSERT(cell_index < cells.size());
+        return {cells[cell_index].num_source_nodes, cells[cell_index].num_destination_nodes};
     }
 
     template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
@@ -389,8 +666,7 @@ template <storage::Ownership Ownership> class CellStorageImpl
         return Cell{cells[cell_index],
                     metric.weights.data(),
                     metric.durations.data(),
-                    source_boundary.data(),
-                    destination_boundary.data()};
+                    boundary.data()};
     }
 
     friend void serialization::read<Ownership>(storage::tar::FileReader &reader,
@@ -401,8 +677,7 @@ template <storage::Ownership Ownership> class CellStorageImpl
                                                 const detail::CellStorageImpl<Ownership> &storage);
 
   private:
-    Vector<NodeID> source_boundary;
-    Vector<NodeID> destination_boundary;
+    Vector<NodeID> boundary;
     Vector<CellData> cells;
     Vector<std::uint64_t> level_to_cell_offset;
 };
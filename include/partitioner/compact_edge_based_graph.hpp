@@ -0,0 +1,195 @@
+#ifndef OSRM_PARTITIONER_COMPACT_EDGE_BASED_GRAPH_HPP
+#define OSRM_PARTITIONER_COMPACT_EDGE_BASED_GRAPH_HPP
+
+#include "partitioner/edge_based_graph.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/integer_range.hpp"
+#include "util/prefetch.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
+
+#include "storage/shared_memory_ownership.hpp"
+#include "storage/tar_fwd.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+
+namespace osrm
+{
+namespace partitioner
+{
+template <storage::Ownership Ownership> class CompactEdgeBasedGraph;
+
+namespace serialization
+{
+template <storage::Ownership Ownership>
+void read(storage::tar::FileReader &reader,
+          const std::string &name,
+          CompactEdgeBasedGraph<Ownership> &graph);
+
+template <storage::Ownership Ownership>
+void write(storage::tar::FileWriter &writer,
+           const std::string &name,
+           const CompactEdgeBasedGraph<Ownership> &graph);
+}
+
+// The part of an edge every relaxation of a search reads
+struct CompactEdgeBasedEdge
+{
+    NodeID target;
+    EdgeWeight weight : 30;
+    std::uint32_t forward : 1;
+    std::uint32_t backward : 1;
+};
+
+// The part of an edge only read for durations and to unpack paths
+struct CompactEdgeBasedEdgeData
+{
+    NodeID turn_id;
+    EdgeWeight duration;
+};
+
+static_assert(sizeof(CompactEdgeBasedEdge) == 8, "the searches expect eight edges per cache line");
+
+/**
+ * The edge based graph of the MLD queries with the data of an edge split in two arrays.
+ *
+ * Same interface as util::StaticGraph<EdgeBasedGraphEdgeData>, which MultiLevelGraph builds on.
+ * The searches relax the border edges of a node through their targets, weights and directions
+ * only and read eight bytes per edge. The turns and durations live in a second array indexed by
+ * the same EdgeID, GetEdgeData() puts both halves back together into an EdgeBasedGraphEdgeData.
+ */
+template <storage::Ownership Ownership> class CompactEdgeBasedGraph
+{
+    template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
+
+  public:
+    using NodeIterator = NodeID;
+    using EdgeIterator = EdgeID;
+    using EdgeRange = util::range<EdgeIterator>;
+    using EdgeData = EdgeBasedGraphEdgeData;
+    using InputEdge = util::static_graph_details::SortableEdgeWithData<EdgeData>;
+    using NodeArrayEntry = util::static_graph_details::NodeArrayEntry;
+    using EdgeArrayEntry = CompactEdgeBasedEdge;
+
+    static constexpr EdgeWeight MAX_EDGE_WEIGHT = (1 << 29) - 1;
+
+    CompactEdgeBasedGraph() = default;
+
+    CompactEdgeBasedGraph(Vector<NodeArrayEntry> node_array_,
+                          Vector<CompactEdgeBasedEdge> edge_array_,
+                          Vector<CompactEdgeBasedEdgeData> edge_data_array_)
+        : node_array(std::move(node_array_)), edge_array(std::move(edge_array_)),
+          edge_data_array(std::move(edge_data_array_))
+    {
+        BOOST_ASSERT(!node_array.empty());
+        BOOST_ASSERT(edge_array.size() == edge_data_array.size());
+        BOOST_ASSERT(node_array.back().first_edge == edge_array.size());
+    }
+
+    unsigned GetNumberOfNodes() const { return node_array.size() - 1; }
+
+    unsigned GetNumberOfEdges() const { return edge_array.size(); }
+
+    unsigned GetOutDegree(const NodeIterator n) const { return EndEdges(n) - BeginEdges(n); }
+
+    NodeIterator GetTarget(const EdgeIterator e) const { return edge_array[e].target; }
+
+    const CompactEdgeBasedEdge &GetCompactEdge(const EdgeIterator e) const { return edge_array[e]; }
+
+    EdgeData GetEdgeData(const EdgeIterator e) const
+    {
+        const auto &edge = edge_array[e];
+        const auto &data = edge_data_array[e];
+        return EdgeData{data.turn_id, edge.weight, data.duration, edge.forward, edge.backward};
+    }
+
+    EdgeIterator BeginEdges(const NodeIterator n) const { return node_array[n].first_edge; }
+
+    EdgeIterator EndEdges(const NodeIterator n) const { return node_array[n + 1].first_edge; }
+
+    EdgeRange GetAdjacentEdgeRange(const NodeIterator n) const
+    {
+        return util::irange(BeginEdges(n), EndEdges(n));
+    }
+
+    void PrefetchAdjacentEdgeRange(const NodeIterator n) const
+    {
+        BOOST_ASSERT(n < node_array.size());
+        OSRM_PREFETCH(&node_array[n]);
+    }
+
+    // searches for a specific edge
+    EdgeIterator FindEdge(const NodeIterator from, const NodeIterator to) const
+    {
+        for (const auto edge : GetAdjacentEdgeRange(from))
+        {
+            if (to == edge_array[edge].target)
+            {
+                return edge;
+            }
+        }
+        return SPECIAL_EDGEID;
+    }
+
+    friend void serialization::read<Ownership>(storage::tar::FileReader &reader,
+                                               const std::string &name,
+                                               CompactEdgeBasedGraph<Ownership> &graph);
+    friend void serialization::write<Ownership>(storage::tar::FileWriter &writer,
+                                                const std::string &name,
+                                                const CompactEdgeBasedGraph<Ownership> &graph);
+
+  protected:
+    // Same as StaticGraph::InitializeFromSortedEdgeRange, throws if a weight of the edges does
+    // not fit into CompactEdgeBasedEdge
+    template <typename IterT>
+    void InitializeFromSortedEdgeRange(const std::uint32_t nodes, IterT begin, IterT end)
+    {
+        const auto number_of_edges = static_cast<EdgeID>(std::distance(begin, end));
+        node_array.reserve(nodes + 1);
+        edge_array.reserve(number_of_edges);
+        edge_data_array.reserve(number_of_edges);
+
+        auto iter = begin;
+        for (const auto node : util::irange(0u, nodes))
+        {
+            node_array.push_back(NodeArrayEntry{static_cast<EdgeID>(edge_array.size())});
+            for (; iter != end && iter->source == node; ++iter)
+            {
+                const auto &data = iter->data;
+                if (data.weight < 0 || data.weight > MAX_EDGE_WEIGHT)
+                {
+                    throw util::exception("Weight " + std::to_string(data.weight) +
+                                          " of an edge is out of the range of the edge based "
+                                          "graph" +
+                                          SOURCE_REF);
+                }
+
+                edge_array.push_back(
+                    CompactEdgeBasedEdge{iter->target, data.weight, data.forward, data.backward});
+                edge_data_array.push_back(CompactEdgeBasedEdgeData{data.turn_id, data.duration});
+            }
+        }
+        node_array.push_back(NodeArrayEntry{static_cast<EdgeID>(edge_array.size())});
+        BOOST_ASSERT_MSG(
+            iter == end,
+            ("Still " + std::to_string(std::distance(iter, end)) + " edges left.").c_str());
+    }
+
+    Vector<NodeArrayEntry> node_array;
+    Vector<CompactEdgeBasedEdge> edge_array;
+    Vector<CompactEdgeBasedEdgeData> edge_data_array;
+};
+
+using CompactEdgeBasedGraphView = CompactEdgeBasedGraph<storage::Ownership::View>;
+}
+}
+
+#endif // OSRM_PARTITIONER_COMPACT_EDGE_BASED_GRAPH_HPP
@@ -3,8 +3,12 @@
 
 #include "partitioner/bisection_graph_view.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_set>
 #include <utility>
@@ -21,6 +25,65 @@ class DinicMaxFlow
     // maximal number of hops in the graph from source to sink
     using Level = std::uint32_t;
 
+  private:
+    // the level of each node in the graph (==hops in BFS from source)
+    using LevelGraph = std::vector<Level>;
+
+    // The flow on the directed edges of a view, stored as one bit per edge of the view. Like in
+    // an undirected graph a pair of nodes has at most one unit of flow: of parallel edges only the
+    // first one carries it.
+    class FlowEdges
+    {
+      public:
+        // removes all flow and sizes the bits for the edges of view
+        void Reset(const BisectionGraphView &view);
+
+        bool HasFlow(const BisectionGraphView &view, const NodeID from, const NodeID to) const;
+
+        // sends a unit of flow from `from` to `to`, cancelling flow in the opposite direction
+        void Augment(const BisectionGraphView &view, const NodeID from, const NodeID to);
+
+      private:
+        // the bit of the first edge from `from` to `to`, or INVALID_EDGE_BIT
+        std::size_t FindEdgeBit(const BisectionGraphView &view,
+                                const NodeID from,
+                                const NodeID to) const;
+
+        static const constexpr std::size_t INVALID_EDGE_BIT =
+            std::numeric_limits<std::size_t>::max();
+
+        // the bit of the first edge of every node, the bits of the edges of a node follow it
+        std::vector<std::size_t> first_edge_bit;
+        std::vector<bool> edge_has_flow;
+        // flow along pairs of nodes that have no edge in this direction, not in a valid input
+        std::set<std::pair<NodeID, NodeID>> flow_without_edge;
+    };
+
+  public:
+    // The buffers of a flow computation. A workspace keeps its memory between cuts, so reusing it
+    // avoids allocating the flow and the levels for every cut. A workspace can only be used by a
+    // single cut at a time.
+    class Workspace
+    {
+        friend class DinicMaxFlow;
+
+        LevelGraph levels;
+        FlowEdges flow;
+    };
+
+    // Hands out workspaces to concurrent cuts. A thread can not keep its own workspace, since
+    // TBB can run another cut on the same thread while the first one waits in a parallel loop.
+    class WorkspacePool
+    {
+      public:
+        std::unique_ptr<Workspace> Acquire();
+        void Release(std::unique_ptr<Workspace> workspace);
+
+      private:
+        std::mutex lock;
+        std::vector<std::unique_ptr<Workspace>> workspaces;
+    };
+
     using MinCut = struct
     {
         std::size_t num_nodes_source;
@@ -35,19 +98,26 @@ class DinicMaxFlow
                       const SourceSinkNodes &source_nodes,
                       const SourceSinkNodes &sink_nodes) const;
 
+    // Stops as soon as the flow is larger than upper_bound, which can be lowered concurrently by
+    // other cuts. The returned cut then has the flow so far as number of edges and no flags.
+    MinCut operator()(const BisectionGraphView &view,
+                      const SourceSinkNodes &source_nodes,
+                      const SourceSinkNodes &sink_nodes,
+                      const std::atomic<std::size_t> &upper_bound) const;
+
+    // Uses the buffers of workspace instead of allocating its own
+    MinCut operator()(const BisectionGraphView &view,
+                      const SourceSinkNodes &source_nodes,
+                      const SourceSinkNodes &sink_nodes,
+                      const std::atomic<std::size_t> &upper_bound,
+                      Workspace &workspace) const;
+
     // validates the inpiut parameters to the flow algorithm (e.g. not intersecting)
     bool Validate(const BisectionGraphView &view,
                   const SourceSinkNodes &source_nodes,
                   const SourceSinkNodes &sink_nodes) const;
 
   private:
-    // the level of each node in the graph (==hops in BFS from source)
-    using LevelGraph = std::vector<Level>;
-
-    // this is actually faster than using an unordered_set<Edge>, stores all edges that have
-    // capacity grouped by node
-    using FlowEdges = std::vector<std::set<NodeID>>;
-
     // The level graph (see [1]) is based on a BFS computation. We assign a level to all nodes
     // (starting with 0 for all source nodes) and assign the hop distance in the residual graph as
     // the level of the node.
@@ -57,11 +127,21 @@ class DinicMaxFlow
     //  \   /
     //    b
     // would assign s = 0, a,b = 1, t=2
-    LevelGraph ComputeLevelGraph(const BisectionGraphView &view,
-                                 const std::vector<NodeID> &border_source_nodes,
-                                 const SourceSinkNodes &source_nodes,
-                                 const SourceSinkNodes &sink_nodes,
-                                 const FlowEdges &flow) const;
+    void ComputeLevelGraph(const BisectionGraphView &view,
+                           const std::vector<NodeID> &border_source_nodes,
+                           const SourceSinkNodes &source_nodes,
+                           const SourceSinkNodes &sink_nodes,
+                           const FlowEdges &flow,
+                           LevelGraph &levels) const;
+
+    // Same levels as ComputeLevelGraph, computed level by level with a parallel BFS. Used for the
+    // big views at the top of the bisection tree, where there is only a single view to cut.
+    void ComputeLevelGraphParallel(const BisectionGraphView &view,
+                                   const std::vector<NodeID> &border_source_nodes,
+                                   const SourceSinkNodes &source_nodes,
+                                   const SourceSinkNodes &sink_nodes,
+                                   const FlowEdges &flow,
+                                   LevelGraph &levels) const;
 
     // Using the above levels (see ComputeLevelGraph), we can use multiple DFS (that can now be
     // directed at the sink) to find a flow that completely blocks the level graph (i.e. no path
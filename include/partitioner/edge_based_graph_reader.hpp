@@ -6,9 +6,16 @@
 #include "extractor/edge_based_edge.hpp"
 #include "extractor/files.hpp"
 #include "storage/io.hpp"
+#include "storage/tar.hpp"
 #include "util/coordinate.hpp"
 #include "util/dynamic_graph.hpp"
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
@@ -26,9 +33,68 @@ namespace osrm
 namespace partitioner
 {
 
+// Maps the edge list of a .osrm.ebg file read-only instead of reading it into memory. The mapped
+// pages are backed by the file, so the kernel can drop them again while the graph is built from
+// them. Edge lists that osrm-extract stored compressed can't be mapped and are read.
+class EdgeBasedGraphFile
+{
+  public:
+    explicit EdgeBasedGraphFile(const boost::filesystem::path &path)
+    {
+        const std::string name = "/common/edge_based_edge_list";
+        storage::tar::FileReader reader(path, storage::tar::FileReader::VerifyFingerprint);
+        reader.ReadInto("/common/number_of_edge_based_nodes", number_of_edge_based_nodes);
+        reader.ReadInto("/common/connectivity_checksum", connectivity_checksum);
+
+        std::vector<storage::tar::FileReader::FileEntry> entries;
+        reader.List(std::back_inserter(entries));
+        const auto entry = std::find_if(entries.begin(), entries.end(), [&](const auto &entry) {
+            return entry.name == name;
+        });
+        if (entry == entries.end())
+        {
+            throw util::exception(path.string() + " has no " + name + SOURCE_REF);
+        }
+
+        if (entry->compressed)
+        {
+            storage::serialization::read(reader, name, read_edges);
+            edges = {read_edges.data(), read_edges.size()};
+            return;
+        }
+
+        const auto number_of_edges = reader.ReadElementCount64(name);
+        if (entry->size != number_of_edges * sizeof(extractor::EdgeBasedEdge))
+        {
+            throw util::RuntimeError(path.string() + " : " + name,
+                                     ErrorCode::UnexpectedEndOfFile,
+                                     SOURCE_REF);
+        }
+        region.open(path);
+        // tar entries start at multiples of 512 bytes
+        BOOST_ASSERT(entry->offset % alignof(extractor::EdgeBasedEdge) == 0);
+        edges = {reinterpret_cast<const extractor::EdgeBasedEdge *>(region.data() + entry->offset),
+                 number_of_edges};
+    }
+
+    EdgeBasedGraphFile(const EdgeBasedGraphFile &) = delete;
+    EdgeBasedGraphFile &operator=(const EdgeBasedGraphFile &) = delete;
+
+    EdgeID GetNumberOfNodes() const { return number_of_edge_based_nodes; }
+    std::uint32_t GetConnectivityChecksum() const { return connectivity_checksum; }
+    util::vector_view<const extractor::EdgeBasedEdge> GetEdges() const { return edges; }
+
+  private:
+    EdgeID number_of_edge_based_nodes = 0;
+    std::uint32_t connectivity_checksum = 0;
+    boost::iostreams::mapped_file_source region;
+    std::vector<extractor::EdgeBasedEdge> read_edges;
+    util::vector_view<const extractor::EdgeBasedEdge> edges;
+};
+
 // Bidirectional (s,t) to (s,t) and (t,s)
-inline std::vector<extractor::EdgeBasedEdge>
-splitBidirectionalEdges(const std::vector<extractor::EdgeBasedEdge> &edges)
+template <typename EdgeContainerT>
+std::vector<extractor::EdgeBasedEdge> splitBidirectionalEdges(const EdgeContainerT &edges)
 {
     std::vector<extractor::EdgeBasedEdge> directed;
     directed.reserve(edges.size() * 2);
@@ -183,14 +249,18 @@ graphToEdges(const DynamicEdgeBasedGraph &edge_based_graph)
     return edges;
 }
 
+// The directed edges are split off the mapped file, so only they and the graph take memory
 inline DynamicEdgeBasedGraph LoadEdgeBasedGraph(const boost::filesystem::path &path)
 {
+    std::vector<extractor::EdgeBasedEdge> directed;
     EdgeID number_of_edge_based_nodes;
-    std::vector<extractor::EdgeBasedEdge> edges;
     std::uint32_t checksum;
-    extractor::files::readEdgeBasedGraph(path, number_of_edge_based_nodes, edges, checksum);
-
-    auto directed = splitBidirectionalEdges(edges);
+    {
+        const EdgeBasedGraphFile file{path};
+        number_of_edge_based_nodes = file.GetNumberOfNodes();
+        checksum = file.GetConnectivityChecksum();
+        directed = splitBidirectionalEdges(file.GetEdges());
+    }
     auto tidied = prepareEdgesForUsageInGraph<DynamicEdgeBasedGraphEdge>(std::move(directed));
 
     return DynamicEdgeBasedGraph(number_of_edge_based_nodes, std::move(tidied), checksum);
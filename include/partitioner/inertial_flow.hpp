@@ -12,7 +12,8 @@ namespace partitioner
 DinicMaxFlow::MinCut computeInertialFlowCut(const BisectionGraphView &view,
                                             const std::size_t num_slopes,
                                             const double balance,
-                                            const double source_sink_rate);
+                                            const double source_sink_rate,
+                                            DinicMaxFlow::WorkspacePool &workspaces);
 
 } // namespace partitioner
 } // namespace osrm
@@ -6,6 +6,7 @@
 #include "storage/shared_memory_ownership.hpp"
 #include "storage/tar_fwd.hpp"
 
+#include "util/prefetch.hpp"
 #include "util/static_graph.hpp"
 #include "util/vector_view.hpp"
 
@@ -19,26 +20,31 @@ namespace osrm
 
 namespace partitioner
 {
-template <typename EdgeDataT, storage::Ownership Ownership> class MultiLevelGraph;
+// GraphT is the graph of the edges, either a util::StaticGraph or a graph with the same interface
+// like CompactEdgeBasedGraph
+template <typename EdgeDataT,
+          storage::Ownership Ownership,
+          typename GraphT = util::StaticGraph<EdgeDataT, Ownership>>
+class MultiLevelGraph;
 
 namespace serialization
 {
-template <typename EdgeDataT, storage::Ownership Ownership>
+template <typename EdgeDataT, storage::Ownership Ownership, typename GraphT>
 void read(storage::tar::FileReader &reader,
           const std::string &name,
-          MultiLevelGraph<EdgeDataT, Ownership> &graph);
+          MultiLevelGraph<EdgeDataT, Ownership, GraphT> &graph);
 
-template <typename EdgeDataT, storage::Ownership Ownership>
+template <typename EdgeDataT, storage::Ownership Ownership, typename GraphT>
 void write(storage::tar::FileWriter &writer,
            const std::string &name,
-           const MultiLevelGraph<EdgeDataT, Ownership> &graph);
+           const MultiLevelGraph<EdgeDataT, Ownership, GraphT> &graph);
 }
 
-template <typename EdgeDataT, storage::Ownership Ownership>
-class MultiLevelGraph : public util::StaticGraph<EdgeDataT, Ownership>
+template <typename EdgeDataT, storage::Ownership Ownership, typename GraphT>
+class MultiLevelGraph : public GraphT
 {
   private:
-    using SuperT = util::StaticGraph<EdgeDataT, Ownership>;
+    using SuperT = GraphT;
     template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
 
   public:
@@ -60,6 +66,12 @@ class MultiLevelGraph : public util::StaticGraph<EdgeDataT, Ownership>
     {
     }
 
+    // For graphs that keep their edges in more than one array
+    MultiLevelGraph(SuperT graph_, Vector<EdgeOffset> node_to_edge_offset_)
+        : SuperT(std::move(graph_)), node_to_edge_offset(std::move(node_to_edge_offset_))
+    {
+    }
+
     template <typename ContainerT>
     MultiLevelGraph(const MultiLevelPartition &mlp,
                     const std::uint32_t num_nodes,
@@ -115,6 +127,17 @@ class MultiLevelGraph : public util::StaticGraph<EdgeDataT, Ownership>
         return util::irange<EdgeID>(begin, end);
     }
 
+    // Also requests the offsets of the border edges of node on all levels
+    void PrefetchAdjacentEdgeRange(const NodeID node) const
+    {
+        SuperT::PrefetchAdjacentEdgeRange(node);
+        const auto index = node * GetNumberOfLevels();
+        if (index < node_to_edge_offset.size() - 1)
+        {
+            OSRM_PREFETCH(&node_to_edge_offset[index]);
+        }
+    }
+
     EdgeID BeginBorderEdges(const LevelID level, const NodeID node) const
     {
         auto index = node * GetNumberOfLevels();
@@ -201,14 +224,14 @@ class MultiLevelGraph : public util::StaticGraph<EdgeDataT, Ownership>
         node_to_edge_offset.push_back(mlp.GetNumberOfLevels());
     }
 
-    friend void
-    serialization::read<EdgeDataT, Ownership>(storage::tar::FileReader &reader,
-                                              const std::string &name,
-                                              MultiLevelGraph<EdgeDataT, Ownership> &graph);
-    friend void
-    serialization::write<EdgeDataT, Ownership>(storage::tar::FileWriter &writer,
-                                               const std::string &name,
-                                               const MultiLevelGraph<EdgeDataT, Ownership> &graph);
+    friend void serialization::read<EdgeDataT, Ownership, GraphT>(
+        storage::tar::FileReader &reader,
+        const std::string &name,
+        MultiLevelGraph<EdgeDataT, Ownership, GraphT> &graph);
+    friend void serialization::write<EdgeDataT, Ownership, GraphT>(
+        storage::tar::FileWriter &writer,
+        const std::string &name,
+        const MultiLevelGraph<EdgeDataT, Ownership, GraphT> &graph);
 
     Vector<EdgeOffset> node_to_edge_offset;
     std::uint32_t connectivity_checksum;
@@ -50,11 +50,31 @@ template <storage::Ownership Ownership> class MultiLevelPartitionImpl final
 {
     // we will support at most 16 levels
     static const constexpr std::uint8_t MAX_NUM_LEVEL = 16;
-    static const constexpr std::uint8_t NUM_PARTITION_BITS = sizeof(PartitionID) * CHAR_BIT;
 
     template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
 
   public:
+    // The cell ids of all levels of a node are packed into its partition id
+    static const constexpr std::uint8_t NUM_PARTITION_BITS = sizeof(PartitionID) * CHAR_BIT;
+    // Levels above the base graph, the level offsets also hold the one of the sentinel
+    static const constexpr std::uint8_t MAX_NUM_CELL_LEVELS = MAX_NUM_LEVEL - 2;
+
+    // If we have N cells per level we need log_2 bits for every cell ID. The sentinel stores
+    // the number of cells, which needs one more value.
+    static std::uint32_t GetLevelBits(const std::uint32_t num_cells)
+    {
+        return static_cast<std::uint32_t>(std::ceil(std::log2(num_cells + 1.)));
+    }
+
+    // Bits of the partition ids of levels with this number of cells each
+    static std::uint32_t GetPartitionBits(const std::vector<std::uint32_t> &lidx_to_num_cells)
+    {
+        std::uint32_t bits = 0;
+        for (const auto num_cells : lidx_to_num_cells)
+            bits += GetLevelBits(num_cells);
+        return bits;
+    }
+
     // Contains all data necessary to describe the level hierarchy
     struct LevelData
     {
@@ -173,20 +193,27 @@ template <storage::Ownership Ownership> class MultiLevelPartitionImpl final
         partition[node] = cleared_cell | shifted_id;
     }
 
-    // If we have N cells per level we need log_2 bits for every cell ID
     auto MakeLevelOffsets(const std::vector<std::uint32_t> &lidx_to_num_cells) const
     {
         std::array<std::uint8_t, MAX_NUM_LEVEL - 1> offsets;
 
+        if (lidx_to_num_cells.size() > MAX_NUM_CELL_LEVELS)
+        {
+            throw util::exception("Can't store the partition information of " +
+                                  std::to_string(lidx_to_num_cells.size()) +
+                                  " levels, at most " + std::to_string(MAX_NUM_CELL_LEVELS) +
+                                  " levels are supported.");
+        }
+
         auto lidx = 0UL;
         auto sum_bits = 0;
         for (auto num_cells : lidx_to_num_cells)
         {
             // bits needed to number all contained vertexes
-            auto bits = static_cast<std::uint64_t>(std::ceil(std::log2(num_cells + 1)));
+            auto bits = GetLevelBits(num_cells);
             offsets[lidx++] = sum_bits;
             sum_bits += bits;
-            if (sum_bits > 64)
+            if (sum_bits > NUM_PARTITION_BITS)
             {
                 throw util::exception(
                     "Can't pack the partition information at level " + std::to_string(lidx) +
@@ -195,11 +222,18 @@ template <storage::Ownership Ownership> class MultiLevelPartitionImpl final
         }
         // sentinel
         offsets[lidx++] = sum_bits;
-        BOOST_ASSERT(lidx < MAX_NUM_LEVEL);
+        BOOST_ASSERT(lidx <= offsets.size());
 
         return offsets;
     }
 
+    // Ones in the lowest bits, all bits of the partition ids can be used by the levels
+    static PartitionID lowBitsMask(const std::uint8_t bits)
+    {
+        BOOST_ASSERT(bits <= NUM_PARTITION_BITS);
+        return bits == NUM_PARTITION_BITS ? ~PartitionID{0} : (PartitionID{1} << bits) - 1;
+    }
+
     auto MakeLevelMasks(const std::array<std::uint8_t, MAX_NUM_LEVEL - 1> &level_offsets,
                         std::uint32_t num_level) const
     {
@@ -211,11 +245,9 @@ template <storage::Ownership Ownership> class MultiLevelPartitionImpl final
                             [&](const auto offset, const auto next_offset) {
                                 // create mask that has `bits` ones at its LSBs.
                                 // 000011
-                                BOOST_ASSERT(offset < NUM_PARTITION_BITS);
-                                PartitionID mask = (1UL << offset) - 1UL;
+                                PartitionID mask = lowBitsMask(offset);
                                 // 001111
-                                BOOST_ASSERT(next_offset < NUM_PARTITION_BITS);
-                                PartitionID next_mask = (1UL << next_offset) - 1UL;
+                                PartitionID next_mask = lowBitsMask(next_offset);
                                 // 001100
                                 masks[lidx++] = next_mask ^ mask;
                             });
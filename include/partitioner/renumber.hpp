@@ -12,6 +12,10 @@
 #include "util/dynamic_graph.hpp"
 #include "util/static_graph.hpp"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_for_each.h>
+
 namespace osrm
 {
 namespace partitioner
@@ -44,53 +48,64 @@ inline void renumber(extractor::EdgeBasedNodeDataContainer &node_data_container,
 inline void renumber(std::vector<Partition> &partitions,
                      const std::vector<std::uint32_t> &permutation)
 {
-    for (auto &partition : partitions)
-    {
-        util::inplacePermutation(partition.begin(), partition.end(), permutation);
-    }
+    tbb::parallel_for_each(partitions.begin(), partitions.end(), [&permutation](auto &partition) {
+        util::parallelPermutation(partition.begin(), partition.end(), permutation);
+    });
+}
+
+namespace detail
+{
+// Renumbers the node ids of all elements of a range in parallel
+template <typename RandomAccessRange, typename RenumberElement>
+inline void renumberElements(RandomAccessRange &range, RenumberElement renumber_element)
+{
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, range.size()),
+                      [&range, &renumber_element](const tbb::blocked_range<std::size_t> &block) {
+                          for (auto index = block.begin(); index != block.end(); ++index)
+                          {
+                              renumber_element(range[index]);
+                          }
+                      });
+}
 }
 
 inline void renumber(util::vector_view<extractor::EdgeBasedNodeSegment> &segments,
                      const std::vector<std::uint32_t> &permutation)
 {
-    for (auto &segment : segments)
-    {
+    detail::renumberElements(segments, [&permutation](auto &segment) {
         BOOST_ASSERT(segment.forward_segment_id.enabled);
         segment.forward_segment_id.id = permutation[segment.forward_segment_id.id];
         if (segment.reverse_segment_id.enabled)
             segment.reverse_segment_id.id = permutation[segment.reverse_segment_id.id];
-    }
+    });
 }
 
 inline void renumber(std::vector<extractor::NBGToEBG> &mapping,
                      const std::vector<std::uint32_t> &permutation)
 {
-    for (extractor::NBGToEBG &m : mapping)
-    {
+    detail::renumberElements(mapping, [&permutation](extractor::NBGToEBG &m) {
         if (m.backward_ebg_node != SPECIAL_NODEID)
             m.backward_ebg_node = permutation[m.backward_ebg_node];
         if (m.forward_ebg_node != SPECIAL_NODEID)
             m.forward_ebg_node = permutation[m.forward_ebg_node];
-    }
+    });
 }
 
 inline void renumber(std::vector<NodeID> &node_ids, const std::vector<std::uint32_t> &permutation)
 {
-    for (auto &node_id : node_ids)
-    {
+    detail::renumberElements(node_ids, [&permutation](NodeID &node_id) {
         if (node_id != SPECIAL_NODEID)
             node_id = permutation[node_id];
-    }
+    });
 }
 
 inline void renumber(std::vector<extractor::StorageManeuverOverride> &maneuver_overrides,
                      const std::vector<std::uint32_t> &permutation)
 {
-    for (auto &maneuver_override : maneuver_overrides)
-    {
+    detail::renumberElements(maneuver_overrides, [&permutation](auto &maneuver_override) {
         if (maneuver_override.start_node != SPECIAL_NODEID)
             maneuver_override.start_node = permutation[maneuver_override.start_node];
-    }
+    });
 }
 
 } // namespace partitioner
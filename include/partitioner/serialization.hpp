@@ -2,6 +2,7 @@
 #define OSRM_PARTITIONER_SERIALIZATION_HPP
 
 #include "partitioner/cell_storage.hpp"
+#include "partitioner/compact_edge_based_graph.hpp"
 #include "partitioner/edge_based_graph.hpp"
 #include "partitioner/multi_level_graph.hpp"
 #include "partitioner/multi_level_partition.hpp"
@@ -12,6 +13,8 @@
 #include "storage/shared_memory_ownership.hpp"
 #include "storage/tar.hpp"
 
+#include "util/serialization.hpp"
+
 namespace osrm
 {
 namespace partitioner
@@ -22,20 +25,54 @@ namespace serialization
 template <typename EdgeDataT, storage::Ownership Ownership>
 inline void read(storage::tar::FileReader &reader,
                  const std::string &name,
-                 MultiLevelGraph<EdgeDataT, Ownership> &graph)
+                 util::StaticGraph<EdgeDataT, Ownership> &graph)
 {
-    storage::serialization::read(reader, name + "/node_array", graph.node_array);
-    storage::serialization::read(reader, name + "/edge_array", graph.edge_array);
-    storage::serialization::read(reader, name + "/node_to_edge_offset", graph.node_to_edge_offset);
+    util::serialization::read(reader, name, graph);
 }
 
 template <typename EdgeDataT, storage::Ownership Ownership>
 inline void write(storage::tar::FileWriter &writer,
                   const std::string &name,
-                  const MultiLevelGraph<EdgeDataT, Ownership> &graph)
+                  const util::StaticGraph<EdgeDataT, Ownership> &graph)
+{
+    util::serialization::write(writer, name, graph);
+}
+
+template <storage::Ownership Ownership>
+inline void read(storage::tar::FileReader &reader,
+                 const std::string &name,
+                 CompactEdgeBasedGraph<Ownership> &graph)
+{
+    storage::serialization::read(reader, name + "/node_array", graph.node_array);
+    storage::serialization::read(reader, name + "/edges", graph.edge_array);
+    storage::serialization::read(reader, name + "/edge_data", graph.edge_data_array);
+}
+
+template <storage::Ownership Ownership>
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const CompactEdgeBasedGraph<Ownership> &graph)
 {
     storage::serialization::write(writer, name + "/node_array", graph.node_array);
-    storage::serialization::write(writer, name + "/edge_array", graph.edge_array);
+    storage::serialization::write(writer, name + "/edges", graph.edge_array);
+    storage::serialization::write(writer, name + "/edge_data", graph.edge_data_array);
+}
+
+template <typename EdgeDataT, storage::Ownership Ownership, typename GraphT>
+inline void read(storage::tar::FileReader &reader,
+                 const std::string &name,
+                 MultiLevelGraph<EdgeDataT, Ownership, GraphT> &graph)
+{
+    serialization::read(reader, name, static_cast<GraphT &>(graph));
+    storage::serialization::read(reader, name + "/node_to_edge_offset", graph.node_to_edge_offset);
+}
+
+template <typename EdgeDataT, storage::Ownership Ownership, typename GraphT>
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const MultiLevelGraph<EdgeDataT, Ownership, GraphT> &graph)
+{
+    serialization::write(writer, name, static_cast<const GraphT &>(graph));
     storage::serialization::write(writer, name + "/node_to_edge_offset", graph.node_to_edge_offset);
 }
 
@@ -65,9 +102,7 @@ inline void read(storage::tar::FileReader &reader,
                  const std::string &name,
                  detail::CellStorageImpl<Ownership> &storage)
 {
-    storage::serialization::read(reader, name + "/source_boundary", storage.source_boundary);
-    storage::serialization::read(
-        reader, name + "/destination_boundary", storage.destination_boundary);
+    storage::serialization::read(reader, name + "/boundary", storage.boundary);
     storage::serialization::read(reader, name + "/cells", storage.cells);
     storage::serialization::read(
         reader, name + "/level_to_cell_offset", storage.level_to_cell_offset);
@@ -78,9 +113,7 @@ inline void write(storage::tar::FileWriter &writer,
                   const std::string &name,
                   const detail::CellStorageImpl<Ownership> &storage)
 {
-    storage::serialization::write(writer, name + "/source_boundary", storage.source_boundary);
-    storage::serialization::write(
-        writer, name + "/destination_boundary", storage.destination_boundary);
+    storage::serialization::write(writer, name + "/boundary", storage.boundary);
     storage::serialization::write(writer, name + "/cells", storage.cells);
     storage::serialization::write(
         writer, name + "/level_to_cell_offset", storage.level_to_cell_offset);
@@ -11,6 +11,7 @@
 #include <boost/spirit/include/phoenix.hpp>
 #include <boost/spirit/include/qi.hpp>
 
+#include <cctype>
 #include <limits>
 #include <string>
 
@@ -27,16 +28,15 @@ namespace ph = boost::phoenix;
 namespace qi = boost::spirit::qi;
 }
 
-template <typename T, char... Fmt> struct no_trailing_dot_policy : qi::real_policies<T>
+// A dot followed by a letter starts the format extension like .json, not the fraction
+template <typename T> struct no_trailing_dot_policy : qi::real_policies<T>
 {
     template <typename Iterator> static bool parse_dot(Iterator &first, Iterator const &last)
     {
         if (first == last || *first != '.')
             return false;
 
-        static const constexpr char fmt[sizeof...(Fmt)] = {Fmt...};
-
-        if (first + sizeof(fmt) < last && std::equal(fmt, fmt + sizeof(fmt), first + 1u))
+        if (first + 1 != last && std::isalpha(static_cast<unsigned char>(*(first + 1))))
             return false;
 
         ++first;
@@ -70,7 +70,7 @@ template <typename T, char... Fmt> struct no_trailing_dot_policy : qi::real_poli
 template <typename Iterator, typename Signature>
 struct BaseParametersGrammar : boost::spirit::qi::grammar<Iterator, Signature>
 {
-    using json_policy = no_trailing_dot_policy<double, 'j', 's', 'o', 'n'>;
+    using json_policy = no_trailing_dot_policy<double>;
 
     BaseParametersGrammar(qi::rule<Iterator, Signature> &root_rule)
         : BaseParametersGrammar::base_type(root_rule)
@@ -99,6 +99,12 @@ struct BaseParametersGrammar : boost::spirit::qi::grammar<Iterator, Signature>
                 base_parameters.bearings.push_back(std::move(bearing));
             };
 
+        const auto set_depart_at = [](engine::api::BaseParameters &base_parameters,
+                                      const unsigned hour,
+                                      const unsigned minute) {
+            base_parameters.depart_at = hour * 60 + minute;
+        };
+
         polyline_chars = qi::char_("a-zA-Z0-9_.--[]{}@?|\\%~`^");
         base64_char = qi::char_("a-zA-Z0-9--_=");
         unlimited_rule = qi::lit("unlimited")[qi::_val = std::numeric_limits<double>::infinity()];
@@ -166,17 +172,40 @@ struct BaseParametersGrammar : boost::spirit::qi::grammar<Iterator, Signature>
                        (qi::as_string[+qi::char_("a-zA-Z0-9")] %
                         ',')[ph::bind(&engine::api::BaseParameters::exclude, qi::_r1) = qi::_1];
 
+        metric_rule =
+            qi::lit("metric=") >
+            qi::as_string[+qi::char_("a-zA-Z0-9_")]
+                         [ph::bind(&engine::api::BaseParameters::metric, qi::_r1) = qi::_1];
+
+        hour_rule = qi::uint_parser<unsigned, 10, 1, 2>()[qi::_pass = qi::_1 < 24u,
+                                                           qi::_val = qi::_1];
+        minute_rule = qi::uint_parser<unsigned, 10, 2, 2>()[qi::_pass = qi::_1 < 60u,
+                                                             qi::_val = qi::_1];
+        depart_at_rule = qi::lit("depart_at=") >
+                         (hour_rule > ':' > minute_rule)[ph::bind(
+                             set_depart_at, qi::_r1, qi::_1, qi::_2)];
+
+        format_type.add("json", engine::api::BaseParameters::OutputFormatType::JSON)(
+            "bin", engine::api::BaseParameters::OutputFormatType::Binary);
+        format_rule =
+            qi::lit('.') >
+            format_type[ph::bind(&engine::api::BaseParameters::format, qi::_r1) = qi::_1];
+
         base_rule = radiuses_rule(qi::_r1)         //
                     | hints_rule(qi::_r1)          //
                     | bearings_rule(qi::_r1)       //
                     | generate_hints_rule(qi::_r1) //
                     | approach_rule(qi::_r1)       //
-                    | exclude_rule(qi::_r1);
+                    | exclude_rule(qi::_r1)        //
+                    | metric_rule(qi::_r1)         //
+                    | depart_at_rule(qi::_r1);
     }
 
   protected:
     qi::rule<Iterator, Signature> base_rule;
     qi::rule<Iterator, Signature> query_rule;
+    // format extension of services that support the binary format
+    qi::rule<Iterator, Signature> format_rule;
 
   private:
     qi::rule<Iterator, Signature> bearings_rule;
@@ -186,6 +215,8 @@ struct BaseParametersGrammar : boost::spirit::qi::grammar<Iterator, Signature>
     qi::rule<Iterator, Signature> generate_hints_rule;
     qi::rule<Iterator, Signature> approach_rule;
     qi::rule<Iterator, Signature> exclude_rule;
+    qi::rule<Iterator, Signature> metric_rule;
+    qi::rule<Iterator, Signature> depart_at_rule;
 
     qi::rule<Iterator, osrm::engine::Bearing()> bearing_rule;
     qi::rule<Iterator, osrm::util::Coordinate()> location_rule;
@@ -193,11 +224,14 @@ struct BaseParametersGrammar : boost::spirit::qi::grammar<Iterator, Signature>
     qi::rule<Iterator, std::vector<osrm::util::Coordinate>()> polyline6_rule;
 
     qi::rule<Iterator, unsigned char()> base64_char;
+    qi::rule<Iterator, unsigned()> hour_rule;
+    qi::rule<Iterator, unsigned()> minute_rule;
     qi::rule<Iterator, std::string()> polyline_chars;
     qi::rule<Iterator, double()> unlimited_rule;
     qi::real_parser<double, json_policy> double_;
 
     qi::symbols<char, engine::Approach> approach_type;
+    qi::symbols<char, engine::api::BaseParameters::OutputFormatType> format_type;
 };
 }
 }
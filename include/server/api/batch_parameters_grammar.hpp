@@ -0,0 +1,71 @@
+#ifndef BATCH_PARAMETERS_GRAMMAR_HPP
+#define BATCH_PARAMETERS_GRAMMAR_HPP
+
+#include "server/api/route_parameters_grammar.hpp"
+
+#include "engine/api/batch_parameters.hpp"
+
+#include <boost/fusion/include/std_pair.hpp>
+#include <boost/spirit/include/phoenix.hpp>
+#include <boost/spirit/include/qi.hpp>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+namespace
+{
+namespace ph = boost::phoenix;
+namespace qi = boost::spirit::qi;
+}
+
+template <typename Iterator = std::string::iterator,
+          typename Signature = void(engine::api::BatchParameters &)>
+struct BatchParametersGrammar final : public RouteParametersGrammar<Iterator, Signature>
+{
+    using BaseGrammar = RouteParametersGrammar<Iterator, Signature>;
+
+    BatchParametersGrammar() : BaseGrammar(root_rule)
+    {
+#ifdef BOOST_HAS_LONG_LONG
+        if (std::is_same<std::size_t, unsigned long long>::value)
+            size_t_ = qi::ulong_long;
+        else
+            size_t_ = qi::ulong_;
+#else
+        size_t_ = qi::ulong_;
+#endif
+
+        pair_rule = size_t_ > ',' > size_t_;
+
+        pairs_rule = qi::lit("pairs=") >
+                     (pair_rule % ';')[ph::bind(&engine::api::BatchParameters::pairs, qi::_r1) =
+                                           qi::_1];
+
+        continue_straight_rule =
+            qi::lit("continue_straight=") >
+            (qi::lit("default") |
+             qi::bool_[ph::bind(&engine::api::RouteParameters::continue_straight, qi::_r1) =
+                           qi::_1]);
+
+        root_rule = BaseGrammar::query_rule(qi::_r1) > -qi::lit(".json") >
+                    -('?' > (pairs_rule(qi::_r1) | continue_straight_rule(qi::_r1) |
+                             BaseGrammar::base_rule(qi::_r1)) %
+                                '&');
+    }
+
+  private:
+    qi::rule<Iterator, Signature> root_rule;
+    qi::rule<Iterator, Signature> pairs_rule;
+    qi::rule<Iterator, Signature> continue_straight_rule;
+    qi::rule<Iterator, engine::api::BatchParameters::Pair()> pair_rule;
+    qi::rule<Iterator, std::size_t()> size_t_;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SERVER_API_FAST_PARAMETERS_PARSER_HPP
+#define SERVER_API_FAST_PARAMETERS_PARSER_HPP
+
+#include "engine/api/route_parameters.hpp"
+#include "engine/api/table_parameters.hpp"
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+// Hand-written single pass parsers for the queries of the route and table services. They read
+// coordinates, hints, bearings and radiuses straight into the parameters without intermediate
+// strings and accept a subset of what the grammars accept into the same parameters.
+//
+// They return false for everything else, e.g. polylines, numbers with exponents or malformed
+// queries, the grammars then parse the query and find the position of errors.
+bool parseRouteParameters(const char *first,
+                          const char *last,
+                          engine::api::RouteParameters &parameters);
+
+bool parseTableParameters(const char *first,
+                          const char *last,
+                          engine::api::TableParameters &parameters);
+
+} // ns api
+} // ns server
+} // ns osrm
+
+#endif
@@ -28,6 +28,17 @@ struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Sig
 
     TableParametersGrammar() : BaseGrammar(root_rule)
     {
+        using AnnotationsType = engine::api::TableParameters::AnnotationsType;
+
+        // the listed annotations replace the default durations
+        const auto clear_annotations = [](engine::api::TableParameters &table_parameters) {
+            table_parameters.annotations = AnnotationsType::None;
+        };
+        const auto add_annotation = [](engine::api::TableParameters &table_parameters,
+                                       AnnotationsType table_param) {
+            table_parameters.annotations = table_parameters.annotations | table_param;
+        };
+
 #ifdef BOOST_HAS_LONG_LONG
         if (std::is_same<std::size_t, unsigned long long>::value)
             size_t_ = qi::ulong_long;
@@ -48,9 +59,21 @@ struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Sig
             (qi::lit("all") |
              (size_t_ % ';')[ph::bind(&engine::api::TableParameters::sources, qi::_r1) = qi::_1]);
 
-        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1);
+        annotations_type.add("duration", AnnotationsType::Duration)("distance",
+                                                                    AnnotationsType::Distance);
+
+        annotations_rule =
+            qi::lit("annotations=")[ph::bind(clear_annotations, qi::_r1)] >
+            (annotations_type[ph::bind(add_annotation, qi::_r1, qi::_1)] % ',');
+
+        approximate_rule =
+            qi::lit("approximate=") >
+            qi::bool_[ph::bind(&engine::api::TableParameters::approximate, qi::_r1) = qi::_1];
+
+        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1) |
+                     annotations_rule(qi::_r1) | approximate_rule(qi::_r1);
 
-        root_rule = BaseGrammar::query_rule(qi::_r1) > -qi::lit(".json") >
+        root_rule = BaseGrammar::query_rule(qi::_r1) > -BaseGrammar::format_rule(qi::_r1) >
                     -('?' > (table_rule(qi::_r1) | BaseGrammar::base_rule(qi::_r1)) % '&');
     }
 
@@ -59,7 +82,10 @@ struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Sig
     qi::rule<Iterator, Signature> table_rule;
     qi::rule<Iterator, Signature> sources_rule;
     qi::rule<Iterator, Signature> destinations_rule;
+    qi::rule<Iterator, Signature> annotations_rule;
+    qi::rule<Iterator, Signature> approximate_rule;
     qi::rule<Iterator, std::size_t()> size_t_;
+    qi::symbols<char, engine::api::TableParameters::AnnotationsType> annotations_type;
 };
 }
 }
@@ -6,11 +6,14 @@
 #include "server/http/request.hpp"
 #include "server/request_parser.hpp"
 
+#include "engine/cancellation_token.hpp"
+
 #include <boost/array.hpp>
 #include <boost/asio.hpp>
 #include <boost/config.hpp>
 #include <boost/version.hpp>
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -33,33 +36,97 @@ namespace server
 
 class RequestHandler;
 
+/// How replies are compressed for clients that accept gzip or deflate
+struct CompressionConfig
+{
+    // zlib level from 1, the fastest, to 9, the smallest output
+    int level = 1;
+    // replies with fewer bytes are sent uncompressed, their compression saves little to nothing
+    std::size_t min_size = 0;
+};
+
+/// Compresses the data with gzip or, without the gzip header, with deflate
+std::vector<char> compressBuffer(const std::vector<char> &uncompressed_data,
+                                 const http::compression_type compression_type,
+                                 const int level);
+
 /// Represents a single connection from a client.
 class Connection : public std::enable_shared_from_this<Connection>
 {
   public:
-    explicit Connection(boost::asio::io_service &io_service, RequestHandler &handler);
+    explicit Connection(boost::asio::io_service &io_service,
+                        RequestHandler &handler,
+                        const CompressionConfig &compression);
+    ~Connection();
     Connection(const Connection &) = delete;
     Connection &operator=(const Connection &) = delete;
 
-    boost::asio::ip::tcp::socket &socket();
+    // TCP or, if the server listens on one, unix domain socket of the connection
+    boost::asio::generic::stream_protocol::socket &socket();
 
     /// Start the first asynchronous operation for the connection.
     void start();
 
   private:
+    /// Read more data and close the connection if nothing arrives in time.
+    void read_more();
+
+    void handle_timeout(const boost::system::error_code &e);
+
     void handle_read(const boost::system::error_code &e, std::size_t bytes_transferred);
 
+    /// Parse the received data that was not consumed by previous requests.
+    void process_pending_data();
+
+    /// Continue reading the body once the client was told to send it.
+    void handle_continue(const boost::system::error_code &e);
+
+    /// Cancel the request that is computed for the connection if the client disconnects.
+    void watch_disconnect();
+
+    void handle_disconnect(const boost::system::error_code &e, const unsigned request);
+
+    /// Compress the reply if requested and not too small and fill the output buffers,
+    /// thread-safe as long as no other operation of the connection is pending.
+    void prepare_reply(http::compression_type compression_type);
+
+    /// Log the stages of the current request if it was sampled for tracing.
+    void log_trace() const;
+
+    /// Start writing the output buffers, must run on the strand.
+    void write_reply();
+
     /// Handle completion of a write operation.
-    void handle_write(const boost::system::error_code &e);
+    void handle_write(const boost::system::error_code &e, std::size_t bytes_transferred);
+
+    /// Compress the chunks into a single stream that is split into chunks again, the
+    /// uncompressed chunks are released while compressing.
+    std::vector<std::vector<char>>
+    compress_chunks(std::vector<std::vector<char>> &uncompressed_chunks,
+                    const http::compression_type compression_type);
 
     std::vector<char> compress_buffers(const std::vector<char> &uncompressed_data,
                                        const http::compression_type compression_type);
 
+    boost::asio::io_service &io_service;
     boost::asio::io_service::strand strand;
-    boost::asio::ip::tcp::socket TCP_socket;
+    boost::asio::generic::stream_protocol::socket stream_socket;
+    boost::asio::deadline_timer timer;
     RequestHandler &request_handler;
+    const CompressionConfig &compression;
     RequestParser request_parser;
     boost::array<char, 8192> incoming_data_buffer;
+    // received data of pipelined requests that is not parsed yet
+    char *pending_begin;
+    char *pending_end;
+    std::size_t current_request_size;
+    unsigned processed_requests;
+    bool keep_alive;
+    // set once the connection is accepted and counted as active
+    bool started;
+    // set while the reply of the current request is computed on a routing worker
+    bool computing_reply;
+    std::shared_ptr<engine::CancellationToken> cancellation_token;
     http::request current_request;
     http::reply current_reply;
     std::vector<char> compressed_output;
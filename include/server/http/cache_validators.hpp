@@ -0,0 +1,30 @@
+#ifndef OSRM_SERVER_HTTP_CACHE_VALIDATORS_HPP
+#define OSRM_SERVER_HTTP_CACHE_VALIDATORS_HPP
+
+#include "engine/dataset_version.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace osrm
+{
+namespace server
+{
+namespace http
+{
+
+// A weak entity tag of the dataset version, the replies of the same request on the same data are
+// equivalent but their compression differs per connection
+std::string makeEntityTag(const engine::DatasetVersion &version);
+
+// The IMF-fixdate of the seconds since the epoch, e.g. Sun, 06 Nov 1994 08:49:37 GMT
+std::string formatHTTPDate(const std::int64_t seconds);
+
+// Whether the value of an If-None-Match header lists the entity tag or is "*", by the weak
+// comparison of RFC 7232 that ignores the W/ prefix
+bool matchesEntityTag(const std::string &if_none_match, const std::string &entity_tag);
+}
+}
+}
+
+#endif // OSRM_SERVER_HTTP_CACHE_VALIDATORS_HPP
@@ -5,6 +5,7 @@
 
 #include <boost/asio.hpp>
 
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -20,23 +21,31 @@ class reply
     enum status_type
     {
         ok = 200,
+        not_modified = 304,
         bad_request = 400,
-        internal_server_error = 500
+        internal_server_error = 500,
+        service_unavailable = 503
     } status;
 
     std::vector<header> headers;
     std::vector<boost::asio::const_buffer> to_buffers();
     std::vector<boost::asio::const_buffer> headers_to_buffers();
     std::vector<char> content;
+    // body of replies with chunked transfer encoding, content is unused if there are chunks
+    std::vector<std::vector<char>> chunks;
     static reply stock_reply(const status_type status);
     void set_size(const std::size_t size);
     void set_uncompressed_size();
+    void set_keep_alive(const bool keep_alive);
 
     reply();
 
   private:
     std::string status_to_string(reply::status_type status);
     boost::asio::const_buffer status_to_buffer(reply::status_type status);
+
+    // hexadecimal size lines of the chunks, referenced by the buffers of to_buffers
+    std::vector<std::string> chunk_sizes;
 };
 }
 }
@@ -1,8 +1,11 @@
 #ifndef REQUEST_HPP
 #define REQUEST_HPP
 
+#include "util/request_trace.hpp"
+
 #include <boost/asio.hpp>
 
+#include <memory>
 #include <string>
 
 namespace osrm
@@ -14,10 +17,24 @@ namespace http
 
 struct request
 {
+    std::string method;
     std::string uri;
     std::string referrer;
     std::string agent;
+    std::string accept;
+    // value of the X-OSRM-Priority header, "batch" queues the request behind interactive ones
+    std::string priority;
+    // the entity tags of replies the client has cached, see RequestHandler::SetCaching
+    std::string if_none_match;
     boost::asio::ip::address endpoint;
+    // true if the client wants to reuse the connection for further requests
+    bool keep_alive = false;
+    // true for HTTP/1.1 clients, which have to accept chunked transfer encoding
+    bool chunked_encoding = false;
+    // the content of POST requests, i.e. what GET requests pass after the profile in the uri
+    std::string body;
+    // set for the sampled requests whose stages are traced
+    std::shared_ptr<util::RequestTrace> trace;
 };
 }
 }
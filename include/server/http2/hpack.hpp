@@ -0,0 +1,68 @@
+#ifndef OSRM_SERVER_HTTP2_HPACK_HPP
+#define OSRM_SERVER_HTTP2_HPACK_HPP
+
+#include "server/http/header.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace http2
+{
+
+/// Decodes the header blocks of a connection, see RFC 7541.
+///
+/// The decoder keeps the dynamic table of the connection, so all header blocks of a connection
+/// have to be decoded by the same decoder in the order they were received.
+class HPACKDecoder
+{
+  public:
+    // the default of SETTINGS_HEADER_TABLE_SIZE, which the server does not change
+    static constexpr std::size_t DEFAULT_MAX_TABLE_SIZE = 4096;
+
+    /// Appends the headers of the block to headers, returns false if the block is malformed.
+    /// A malformed block leaves the dynamic table in an undefined state, which is a connection
+    /// error.
+    bool Decode(const char *begin, const char *end, std::vector<http::header> &headers);
+
+  private:
+    bool DecodeInteger(const unsigned char *&iter,
+                       const unsigned char *end,
+                       const unsigned prefix_bits,
+                       std::uint32_t &value) const;
+    bool DecodeString(const unsigned char *&iter, const unsigned char *end, std::string &value);
+    // index 1 to 61 are in the static table, the dynamic table follows with the newest entry
+    bool LookUp(const std::uint32_t index, http::header &header) const;
+    void Insert(const http::header &header);
+    void Evict();
+
+    std::deque<http::header> dynamic_table;
+    std::size_t table_size = 0;
+    std::size_t max_table_size = DEFAULT_MAX_TABLE_SIZE;
+};
+
+/// Encodes the headers of replies.
+///
+/// Headers are sent as literals without indexing and without Huffman coding, so the encoder has
+/// no state and the peer's dynamic table stays empty. Only the names come from the static table.
+class HPACKEncoder
+{
+  public:
+    /// Appends the header block of headers to block. The names have to be lower case.
+    void Encode(const std::vector<http::header> &headers, std::string &block) const;
+};
+
+/// Decodes the Huffman coded string of the input and appends it to output, returns false if the
+/// input is not a valid Huffman code
+bool decodeHuffman(const char *begin, const char *end, std::string &output);
+}
+}
+}
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef OSRM_SERVER_HTTP2_SESSION_HPP
+#define OSRM_SERVER_HTTP2_SESSION_HPP
+
+#include "server/http/compression_type.hpp"
+#include "server/http/header.hpp"
+#include "server/http/request.hpp"
+#include "server/http2/hpack.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace http2
+{
+
+// The first bytes a client sends on an HTTP/2 connection with prior knowledge
+const constexpr char CONNECTION_PREFACE[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+const constexpr std::size_t CONNECTION_PREFACE_SIZE = sizeof(CONNECTION_PREFACE) - 1;
+
+/// The server side of the framing layer of an HTTP/2 connection, see RFC 7540.
+///
+/// The session does no I/O: Consume parses the bytes read from the client, the complete requests
+/// are taken with TakeRequests and their replies are handed back with SubmitReply. The frames to
+/// write to the client collect in the output. Replies are sent as far as the flow control
+/// windows of the client allow, the rest is sent once the client opens the windows.
+///
+/// Streams are independent requests, so many requests are in flight on a single connection.
+/// Server push and priorities are not supported, the latter are ignored.
+class Session
+{
+  public:
+    // Streams beyond this number are refused, see SETTINGS_MAX_CONCURRENT_STREAMS
+    static constexpr std::uint32_t MAX_CONCURRENT_STREAMS = 128;
+
+    struct Request
+    {
+        std::uint32_t stream_id;
+        http::request request;
+        http::compression_type compression_type;
+    };
+
+    /// Queues the settings of the server, the first frame of the connection
+    Session();
+
+    /// Parses the frames of the input, which starts with the connection preface. Returns false
+    /// on a connection error, the session then only writes a GOAWAY frame.
+    bool Consume(const char *begin, const char *end);
+
+    /// The requests whose headers and bodies are complete since the last call
+    std::vector<Request> TakeRequests();
+
+    /// The streams of requests the client cancelled since the last call
+    std::vector<std::uint32_t> TakeResetStreams();
+
+    /// Queues the reply of the stream, the body is either the content or the chunks of the
+    /// reply. Replies of streams the client reset are dropped.
+    void SubmitReply(const std::uint32_t stream_id,
+                     const int status,
+                     std::vector<http::header> headers,
+                     std::vector<char> body);
+
+    /// Frames to write to the client, empties the output
+    std::string TakeOutput();
+    bool HasOutput() const { return !output.empty(); }
+
+    /// True once the connection has failed or the client went away and all streams are done,
+    /// the connection is closed after writing the output.
+    bool IsDone() const;
+
+  private:
+    struct Stream
+    {
+        http::request request;
+        http::compression_type compression_type = http::no_compression;
+        // set once the client sent the complete request
+        bool request_complete = false;
+        // the reply that waits for the flow control windows of the client
+        std::vector<char> pending_body;
+        std::size_t pending_offset = 0;
+        bool replying = false;
+        std::int64_t send_window;
+    };
+
+    // RFC 7540, section 7
+    enum ErrorCode : std::uint32_t
+    {
+        NO_ERROR = 0x0,
+        PROTOCOL_ERROR = 0x1,
+        INTERNAL_ERROR = 0x2,
+        FLOW_CONTROL_ERROR = 0x3,
+        STREAM_CLOSED = 0x5,
+        FRAME_SIZE_ERROR = 0x6,
+        REFUSED_STREAM = 0x7,
+        CANCEL = 0x8,
+        COMPRESSION_ERROR = 0x9,
+        ENHANCE_YOUR_CALM = 0xb
+    };
+
+    bool ProcessFrame(const std::uint8_t type,
+                      const std::uint8_t flags,
+                      const std::uint32_t stream_id,
+                      const char *payload,
+                      const std::size_t length);
+    bool ProcessData(const std::uint8_t flags,
+                     const std::uint32_t stream_id,
+                     const char *payload,
+                     const std::size_t length);
+    bool ProcessHeaders(const std::uint8_t flags,
+                        const std::uint32_t stream_id,
+                        const char *payload,
+                        const std::size_t length);
+    bool ProcessContinuation(const std::uint8_t flags,
+                             const std::uint32_t stream_id,
+                             const char *payload,
+                             const std::size_t length);
+    bool ProcessSettings(const std::uint8_t flags,
+                         const std::uint32_t stream_id,
+                         const char *payload,
+                         const std::size_t length);
+    bool ProcessWindowUpdate(const std::uint32_t stream_id,
+                             const char *payload,
+                             const std::size_t length);
+    bool ProcessRstStream(const std::uint32_t stream_id, const std::size_t length);
+    bool ProcessGoAway(const std::size_t length);
+
+    // decodes the header block of the stream once it is complete
+    bool FinishHeaderBlock();
+    void CompleteRequest(const std::uint32_t stream_id, Stream &stream);
+
+    // sends the pending replies as far as the flow control windows allow
+    void Flush();
+
+    bool ConnectionError(const ErrorCode error_code);
+    void ResetStream(const std::uint32_t stream_id, const ErrorCode error_code);
+    void WriteFrame(const std::uint8_t type,
+                    const std::uint8_t flags,
+                    const std::uint32_t stream_id,
+                    const char *payload,
+                    const std::size_t length);
+    void WriteWindowUpdate(const std::uint32_t stream_id, const std::uint32_t increment);
+
+    std::string input;
+    std::string output;
+    bool preface_received = false;
+    bool failed = false;
+    bool going_away = false;
+
+    HPACKDecoder decoder;
+    HPACKEncoder encoder;
+    // the header block of a HEADERS frame that continues in CONTINUATION frames
+    std::uint32_t header_block_stream_id = 0;
+    bool header_block_ends_stream = false;
+    std::string header_block;
+
+    std::map<std::uint32_t, Stream> streams;
+    std::uint32_t last_stream_id = 0;
+    std::vector<Request> complete_requests;
+    std::vector<std::uint32_t> reset_streams;
+
+    std::int64_t connection_send_window;
+    std::int64_t initial_send_window;
+    std::size_t max_send_frame_size;
+};
+}
+}
+}
+
+#endif
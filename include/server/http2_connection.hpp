@@ -0,0 +1,99 @@
+#ifndef HTTP2_CONNECTION_HPP
+#define HTTP2_CONNECTION_HPP
+
+#include "server/connection.hpp"
+#include "server/http/reply.hpp"
+#include "server/http/request.hpp"
+#include "server/http2/session.hpp"
+
+#include "engine/cancellation_token.hpp"
+
+#include <boost/array.hpp>
+#include <boost/asio.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace osrm
+{
+namespace server
+{
+
+class RequestHandler;
+
+/// A connection of a client that speaks HTTP/2 with prior knowledge.
+///
+/// Connection hands the socket over once the first bytes it reads are the HTTP/2 connection
+/// preface. The requests of all streams are computed concurrently, their replies are written in
+/// the order they are ready.
+class Http2Connection : public std::enable_shared_from_this<Http2Connection>
+{
+  public:
+    Http2Connection(boost::asio::io_service &io_service,
+                    boost::asio::generic::stream_protocol::socket socket,
+                    RequestHandler &handler,
+                    const CompressionConfig &compression,
+                    const boost::asio::ip::address &remote_address);
+    ~Http2Connection();
+    Http2Connection(const Http2Connection &) = delete;
+    Http2Connection &operator=(const Http2Connection &) = delete;
+
+    /// Process the data Connection read before the hand-over and continue reading, must run on
+    /// the strand of the connection
+    void start(const char *begin, const char *end);
+
+  private:
+    struct Stream
+    {
+        http::request request;
+        http::reply reply;
+        http::compression_type compression_type;
+        std::shared_ptr<engine::CancellationToken> cancellation_token;
+    };
+
+    void read_more();
+
+    void handle_timeout(const boost::system::error_code &e);
+
+    void handle_read(const boost::system::error_code &e, std::size_t bytes_transferred);
+
+    /// Feed the data to the session and schedule the requests that are complete.
+    void process(const char *begin, const char *end);
+
+    /// Join the chunks and compress the reply if requested and not too small, runs on the
+    /// routing worker that computed the reply.
+    void prepare_reply(Stream &stream);
+
+    /// Hand the reply to the session, must run on the strand.
+    void submit_reply(const std::uint32_t stream_id);
+
+    /// Write the frames of the session unless a write is pending, must run on the strand.
+    void write_output();
+
+    void handle_write(const boost::system::error_code &e, std::size_t bytes_transferred);
+
+    /// Cancel all requests in flight, the client is gone.
+    void cancel_streams();
+
+    boost::asio::io_service::strand strand;
+    boost::asio::generic::stream_protocol::socket stream_socket;
+    boost::asio::deadline_timer timer;
+    RequestHandler &request_handler;
+    const CompressionConfig &compression;
+    const boost::asio::ip::address remote_address;
+    http2::Session session;
+    boost::array<char, 8192> incoming_data_buffer;
+    // streams whose requests are computed, a stream is released once its reply is submitted
+    std::unordered_map<std::uint32_t, std::unique_ptr<Stream>> streams;
+    // the frames that are written
+    std::string output;
+    bool writing;
+    bool closed;
+};
+}
+}
+
+#endif // HTTP2_CONNECTION_HPP
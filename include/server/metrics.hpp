@@ -0,0 +1,97 @@
+#ifndef SERVER_METRICS_HPP
+#define SERVER_METRICS_HPP
+
+#include "util/search_counters.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+/// Process-wide counters of osrm-routed rendered in the Prometheus text exposition format.
+///
+/// Like util::TimedHistogram requests are counted into fixed bins, here per service and with
+/// the cumulative upper bounds Prometheus expects. All methods are thread-safe, the counters
+/// are atomics and only the response codes and registered gauges are guarded by a mutex.
+class Metrics
+{
+  public:
+    using Gauge = std::function<double()>;
+    using QueueDepths = std::vector<std::pair<std::string, std::size_t>>;
+
+    // latency bins with finite upper bounds, see metrics.cpp, requests above are counted in +Inf
+    static constexpr std::size_t NUMBER_OF_LATENCY_BOUNDS = 13;
+    // route, nearest, table, match, trip, tile, batch, isochrone and all other paths
+    static constexpr std::size_t NUMBER_OF_SERVICES = 9;
+
+    Metrics();
+    Metrics(const Metrics &) = delete;
+    Metrics &operator=(const Metrics &) = delete;
+
+    /// Counts a request of the service that took seconds from arrival to reply
+    void ObserveRequest(const std::string &service, const double seconds, const unsigned status);
+
+    void AddConnection() { ++active_connections; }
+    void RemoveConnection() { --active_connections; }
+
+    void AddBytesOut(const std::size_t bytes) { bytes_out += bytes; }
+
+    /// Counts a request that got the reply of an identical request computed at the same time
+    void AddCoalescedRequest() { ++coalesced_requests; }
+
+    /// Counts the sizes of a compressed reply before and after compression
+    void AddCompression(const std::size_t uncompressed_bytes, const std::size_t compressed_bytes)
+    {
+        compression_input_bytes += uncompressed_bytes;
+        compression_output_bytes += compressed_bytes;
+    }
+
+    void AddSearchCounters(const util::SearchCounters &counters);
+
+    /// Adds a gauge that is evaluated whenever the metrics are rendered, e.g. the dataset
+    /// timestamp. The name must be a valid Prometheus metric name.
+    void RegisterGauge(const std::string &name, const std::string &help, Gauge gauge);
+
+    /// Renders all metrics, queue_depths are the queued requests of the worker pool by service
+    std::string Render(const QueueDepths &queue_depths) const;
+
+  private:
+    struct Histogram
+    {
+        std::array<std::atomic<std::uint64_t>, NUMBER_OF_LATENCY_BOUNDS + 1> bins;
+        std::atomic<std::uint64_t> count;
+        // in microseconds to be able to add them atomically
+        std::atomic<std::uint64_t> sum_us;
+    };
+
+    static std::size_t ServiceIndex(const std::string &service);
+
+    std::array<Histogram, NUMBER_OF_SERVICES> latencies;
+    std::atomic<std::int64_t> active_connections;
+    std::atomic<std::uint64_t> bytes_out;
+    std::atomic<std::uint64_t> coalesced_requests;
+    std::atomic<std::uint64_t> compression_input_bytes;
+    std::atomic<std::uint64_t> compression_output_bytes;
+
+    mutable std::mutex mutex;
+    // (service index, status) -> number of responses
+    std::map<std::pair<std::size_t, unsigned>, std::uint64_t> responses;
+    util::SearchCounters search_counters;
+    std::vector<std::tuple<std::string, std::string, Gauge>> gauges;
+};
+}
+}
+
+#endif // SERVER_METRICS_HPP
@@ -0,0 +1,48 @@
+#ifndef SERVER_REQUEST_COALESCER_HPP
+#define SERVER_REQUEST_COALESCER_HPP
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace http
+{
+class reply;
+}
+
+/// Lets identical requests that arrive while the first of them is computed share its reply.
+///
+/// The first request of a key leads the flight and computes the reply, the requests that join
+/// until it finishes follow. Followers are called with the reply of the leader, or with nullptr
+/// if they are promoted to lead the flight because the leader was cancelled.
+class RequestCoalescer
+{
+  public:
+    using Follower = std::function<void(const http::reply *leader_reply)>;
+
+    /// Returns true if the caller leads the flight of key, otherwise follower is kept until the
+    /// flight finishes.
+    bool Join(const std::string &key, Follower follower);
+
+    /// Ends the flight of key and returns its followers.
+    std::vector<Follower> Finish(const std::string &key);
+
+    /// Hands the flight of a cancelled leader to its first follower, which is returned in
+    /// follower. Ends the flight and returns false if it has no followers.
+    bool Promote(const std::string &key, Follower &follower);
+
+  private:
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<Follower>> flights;
+};
+}
+}
+
+#endif // SERVER_REQUEST_COALESCER_HPP
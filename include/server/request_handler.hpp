@@ -1,9 +1,22 @@
 #ifndef REQUEST_HANDLER_HPP
 #define REQUEST_HANDLER_HPP
 
+#include "server/metrics.hpp"
+#include "server/request_coalescer.hpp"
 #include "server/service_handler.hpp"
+#include "server/worker_pool.hpp"
 
+#include "engine/cancellation_token.hpp"
+#include "engine/dataset_version.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
@@ -26,10 +39,116 @@ class RequestHandler
 
     void RegisterServiceHandler(std::unique_ptr<ServiceHandlerInterface> service_handler);
 
-    void HandleRequest(const http::request &current_request, http::reply &current_reply);
+    /// Requests are handled by the worker pool instead of the calling thread if registered.
+    void RegisterWorkerPool(std::unique_ptr<WorkerPool> worker_pool);
+    void StopWorkerPool();
+
+    /// Allocates the query heaps of the calling thread and runs the urls of the HTTP API on it,
+    /// so that its first requests do not pay for allocations and page faults. Nothing is counted
+    /// in the metrics or the access log. Returns the number of urls that failed.
+    std::size_t WarmUpThread(const std::vector<std::string> &urls);
+
+    /// Warms up every worker of the worker pool like WarmUpThread and blocks until all are done.
+    /// Returns false without a worker pool, the threads calling HandleRequest are used then.
+    bool WarmUpWorkers(const std::vector<std::string> &urls, std::size_t &failed);
+
+    /// Requests that are not answered within the timeout, including the time they are queued,
+    /// are stopped and answered with 503. Zero disables the deadline.
+    void SetRequestTimeout(const std::chrono::steady_clock::duration timeout)
+    {
+        request_timeout = timeout;
+    }
+
+    void
+    HandleRequest(const http::request &current_request,
+                  http::reply &current_reply,
+                  std::shared_ptr<const engine::CancellationToken> cancellation_token = nullptr);
+
+    /// Handles the request on the worker pool if there is one, otherwise on the calling thread.
+    /// on_reply is called in both cases once current_reply is set, also if the request was
+    /// rejected because the queue of its service is full.
+    ///
+    /// Returns the cancellation token of the request, e.g. to cancel it once the client
+    /// disconnected. Cancelled requests are not started or stop their searches early.
+    std::shared_ptr<engine::CancellationToken>
+    ScheduleRequest(const http::request &current_request,
+                    http::reply &current_reply,
+                    std::function<void()> on_reply);
+
+    /// Requests of the services, with at least min_coordinates coordinates or with the header
+    /// X-OSRM-Priority: batch are queued on the worker pool as batch requests, which are served
+    /// after interactive ones. Zero min_coordinates disables the limit.
+    void SetBatchPriority(std::vector<std::string> services, const std::size_t min_coordinates)
+    {
+        batch_services = std::move(services);
+        batch_min_coordinates = min_coordinates;
+    }
+
+    /// Identical requests that arrive while the first of them is computed get its reply instead
+    /// of being computed again, see RequestCoalescer. They are identical if their decoded URL,
+    /// POST body, accepted format and transfer encoding match.
+    void SetRequestCoalescing(const bool coalesce_requests_)
+    {
+        coalesce_requests = coalesce_requests_;
+    }
+
+    /// The stages of this share of the requests are traced and logged once their reply is
+    /// compressed, zero disables the tracing.
+    void SetTraceSampleRate(const double trace_sample_rate_)
+    {
+        trace_sample_rate = trace_sample_rate_;
+    }
+
+    /// Whether the next request is traced, true for the share of the sample rate
+    bool SampleTrace() const;
+
+    /// With cache validators successful replies to GET requests carry an ETag and a Last-Modified
+    /// header of the version of their dataset. Requests whose If-None-Match lists the ETag are
+    /// answered with 304 without running the query. The replies of the services in
+    /// cache_control get its value as Cache-Control header, e.g. "public, max-age=3600".
+    void SetCaching(const bool cache_validators_,
+                    std::unordered_map<std::string, std::string> cache_control_)
+    {
+        cache_validators = cache_validators_;
+        cache_control = std::move(cache_control_);
+    }
+
+    /// Counters of all requests and connections, also served at /metrics
+    Metrics &GetMetrics() { return metrics; }
 
   private:
+    WorkerPool::Priority GetPriority(const std::string &service,
+                                     const http::request &current_request) const;
+
+    // The validators of the dataset version, if any, and the Cache-Control header of the service
+    void AddCacheHeaders(const std::string &service,
+                         const engine::DatasetVersion *version,
+                         http::reply &current_reply) const;
+
+    void HandleMetricsRequest(http::reply &current_reply);
+    // answered on the I/O thread like the metrics
+    void HandleMemoryRequest(http::reply &current_reply);
+
+    // Computes the request on the worker pool or the calling thread. With a key the reply is
+    // shared with the requests that joined its flight.
+    void RunRequest(const std::string &service,
+                    const std::string &key,
+                    const http::request &current_request,
+                    http::reply &current_reply,
+                    std::function<void()> observed_on_reply,
+                    std::shared_ptr<engine::CancellationToken> cancellation_token);
+
+    Metrics metrics;
+    std::chrono::steady_clock::duration request_timeout = std::chrono::seconds::zero();
     std::unique_ptr<ServiceHandlerInterface> service_handler;
+    std::unique_ptr<WorkerPool> worker_pool;
+    std::vector<std::string> batch_services;
+    std::size_t batch_min_coordinates = 0;
+    bool coalesce_requests = false;
+    RequestCoalescer coalescer;
+    double trace_sample_rate = 0.;
+    bool cache_validators = false;
+    std::unordered_map<std::string, std::string> cache_control;
 };
 }
 }
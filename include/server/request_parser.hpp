@@ -4,6 +4,8 @@
 #include "server/http/compression_type.hpp"
 #include "server/http/header.hpp"
 
+#include <cstddef>
+#include <string>
 #include <tuple>
 
 namespace osrm
@@ -28,9 +30,18 @@ class RequestParser
         indeterminate
     };
 
-    std::tuple<RequestStatus, http::compression_type>
+    // Consumes input until a request is complete or invalid. The returned position is the
+    // first character after the parsed request, pipelined requests start from there.
+    std::tuple<RequestStatus, http::compression_type, char *>
     parse(http::request &current_request, char *begin, char *end);
 
+    // Prepares the parser for the next request on a persistent connection
+    void reset();
+
+    // True once after the headers of a request with "Expect: 100-continue" were parsed, the
+    // client waits for an interim "100 Continue" reply before it sends the body.
+    bool take_expected_continue();
+
   private:
     RequestStatus consume(http::request &current_request, const char input);
 
@@ -64,11 +75,17 @@ class RequestParser
         space_before_header_value,
         header_value,
         expecting_newline_2,
-        expecting_newline_3
+        expecting_newline_3,
+        body
     } state;
 
     http::header current_header;
     http::compression_type selected_compression;
+    unsigned http_version_major;
+    unsigned http_version_minor;
+    std::string connection_header;
+    std::size_t content_length;
+    bool expect_continue;
 };
 }
 }
@@ -2,11 +2,16 @@
 #define SERVER_HPP
 
 #include "server/connection.hpp"
+#include "server/metrics.hpp"
 #include "server/request_handler.hpp"
 #include "server/service_handler.hpp"
+#include "server/worker_pool.hpp"
 
+#include "util/exception.hpp"
 #include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/numa.hpp"
+#include "util/timing_util.hpp"
 
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
@@ -18,10 +23,17 @@
 #include <sys/types.h>
 #endif
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <condition_variable>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -33,48 +45,162 @@ class Server
 {
   public:
     // Note: returns a shared instead of a unique ptr as it is captured in a lambda somewhere else
-    static std::shared_ptr<Server>
-    CreateServer(std::string &ip_address, int ip_port, unsigned requested_num_threads)
+    static std::shared_ptr<Server> CreateServer(std::string &ip_address,
+                                                int ip_port,
+                                                unsigned requested_num_threads,
+                                                bool io_service_per_thread = false)
     {
         util::Log() << "http 1.1 compression handled by zlib version " << zlibVersion();
         const unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
         const unsigned real_num_threads = std::min(hardware_threads, requested_num_threads);
-        return std::make_shared<Server>(ip_address, ip_port, real_num_threads);
+        return std::make_shared<Server>(
+            ip_address, ip_port, real_num_threads, io_service_per_thread);
     }
 
-    explicit Server(const std::string &address, const int port, const unsigned thread_pool_size)
-        : thread_pool_size(thread_pool_size), acceptor(io_service),
-          new_connection(std::make_shared<Connection>(io_service, request_handler))
+    // With io_service_per_thread every thread runs its own io_service. If SO_REUSEPORT is
+    // available each io_service gets its own acceptor and the kernel distributes incoming
+    // connections, otherwise a single acceptor hands out connections round-robin.
+    explicit Server(const std::string &address,
+                    const int port,
+                    const unsigned thread_pool_size,
+                    const bool io_service_per_thread = false)
+        : thread_pool_size(thread_pool_size), next_io_service(0)
     {
+        const auto number_of_io_services = io_service_per_thread ? thread_pool_size : 1u;
+        for (unsigned i = 0; i < number_of_io_services; ++i)
+        {
+            io_services.push_back(std::make_unique<boost::asio::io_service>());
+        }
+
         const auto port_string = std::to_string(port);
 
-        boost::asio::ip::tcp::resolver resolver(io_service);
+        boost::asio::ip::tcp::resolver resolver(*io_services.front());
         boost::asio::ip::tcp::resolver::query query(address, port_string);
         boost::asio::ip::tcp::endpoint endpoint = *resolver.resolve(query);
 
-        acceptor.open(endpoint.protocol());
 #ifdef SO_REUSEPORT
-        const int option = 1;
-        setsockopt(acceptor.native_handle(), SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option));
+        const auto number_of_acceptors = io_services.size();
+#else
+        const auto number_of_acceptors = 1u;
 #endif
-        acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
-        acceptor.bind(endpoint);
-        acceptor.listen();
+        for (const auto index : util::irange<std::size_t>(0, number_of_acceptors))
+        {
+            auto acceptor = std::make_unique<Acceptor>(*io_services[index]);
+            acceptor->open(endpoint.protocol());
+#ifdef SO_REUSEPORT
+            const int option = 1;
+            setsockopt(
+                acceptor->native_handle(), SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option));
+#endif
+            acceptor->set_option(boost::asio::socket_base::reuse_address(true));
+            acceptor->bind(endpoint);
+            acceptor->listen();
 
-        util::Log() << "Listening on: " << acceptor.local_endpoint();
+            acceptors.push_back(std::move(acceptor));
+            new_connections.push_back(nullptr);
+        }
+        number_of_tcp_acceptors = acceptors.size();
 
-        acceptor.async_accept(
-            new_connection->socket(),
-            boost::bind(&Server::HandleAccept, this, boost::asio::placeholders::error));
+        util::Log() << "Listening on: " << endpoint;
+        if (io_service_per_thread)
+        {
+            util::Log() << "Using " << io_services.size() << " io services with "
+                        << acceptors.size() << " acceptors";
+        }
+
+        for (const auto index : util::irange<std::size_t>(0, acceptors.size()))
+        {
+            StartAccept(index);
+        }
+    }
+
+    ~Server()
+    {
+        if (!unix_socket_path.empty())
+        {
+            std::remove(unix_socket_path.c_str());
+        }
+    }
+
+    // Accepts connections on a unix domain socket at path in addition to the TCP port, which
+    // spares co-located clients the TCP stack. A stale socket file at path is replaced. Needs to
+    // be called before Run.
+    void ListenOnUnixSocket(const std::string &path)
+    {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+        BOOST_ASSERT(unix_socket_path.empty());
+        std::remove(path.c_str());
+
+        const boost::asio::local::stream_protocol::endpoint endpoint(path);
+        auto acceptor = std::make_unique<Acceptor>(*io_services.front());
+        acceptor->open(endpoint.protocol());
+        acceptor->bind(endpoint);
+        acceptor->listen();
+        unix_socket_path = path;
+
+        acceptors.push_back(std::move(acceptor));
+        new_connections.push_back(nullptr);
+        util::Log() << "Listening on: " << endpoint;
+        StartAccept(acceptors.size() - 1);
+#else
+        throw util::exception("Unix domain sockets are not supported on this platform: " + path);
+#endif
     }
 
     void Run()
     {
+        TIMER_START(warm_up);
+        std::size_t failed_warm_up_urls = 0;
+        const bool warm_up_io_threads =
+            warm_up && !request_handler.WarmUpWorkers(warm_up_urls, failed_warm_up_urls);
+        unsigned warming_threads = warm_up_io_threads ? thread_pool_size : 0;
+        const auto finish_warm_up = [&] {
+            if (warm_up)
+            {
+                TIMER_STOP(warm_up);
+                util::Log() << "Warmed up the query threads with " << warm_up_urls.size()
+                            << " queries in " << TIMER_SEC(warm_up) << "s";
+                if (failed_warm_up_urls > 0)
+                {
+                    util::Log(logWARNING) << failed_warm_up_urls << " warm-up queries failed";
+                }
+            }
+            std::lock_guard<std::mutex> lock(ready_mutex);
+            ready = true;
+            ready_condition.notify_all();
+        };
+        if (warming_threads == 0)
+        {
+            finish_warm_up();
+        }
+
         std::vector<std::shared_ptr<std::thread>> threads;
         for (unsigned i = 0; i < thread_pool_size; ++i)
         {
-            std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
-                boost::bind(&boost::asio::io_service::run, &io_service));
+            auto &io_service = *io_services[i % io_services.size()];
+            std::shared_ptr<std::thread> thread = std::make_shared<std::thread>([&, i] {
+                if (pin_threads)
+                {
+                    util::PinThreadToNumaNode(i % util::GetNumaNodes().size());
+                }
+                // no thread serves connections before all of them are warm
+                if (warm_up_io_threads)
+                {
+                    const auto failed = request_handler.WarmUpThread(warm_up_urls);
+                    std::unique_lock<std::mutex> lock(ready_mutex);
+                    failed_warm_up_urls = failed;
+                    if (--warming_threads == 0)
+                    {
+                        lock.unlock();
+                        finish_warm_up();
+                    }
+                    else
+                    {
+                        ready_condition.wait(lock, [this] { return ready; });
+                    }
+                }
+                io_service.run();
+            });
             threads.push_back(thread);
         }
         for (auto thread : threads)
@@ -83,30 +209,127 @@ class Server
         }
     }
 
-    void Stop() { io_service.stop(); }
+    /// Blocks until Run has warmed up all threads that handle requests
+    void WaitUntilReady()
+    {
+        std::unique_lock<std::mutex> lock(ready_mutex);
+        ready_condition.wait(lock, [this] { return ready; });
+    }
+
+    void Stop()
+    {
+        for (auto &io_service : io_services)
+        {
+            io_service->stop();
+        }
+        request_handler.StopWorkerPool();
+    }
 
     void RegisterServiceHandler(std::unique_ptr<ServiceHandlerInterface> service_handler_)
     {
         request_handler.RegisterServiceHandler(std::move(service_handler_));
     }
 
+    void RegisterWorkerPool(std::unique_ptr<WorkerPool> worker_pool_)
+    {
+        request_handler.RegisterWorkerPool(std::move(worker_pool_));
+    }
+
+    // Allocates the query heaps of every thread that handles requests and runs the urls on each
+    // of them before any requests are served, needs to be called before Run
+    void SetWarmUp(std::vector<std::string> urls)
+    {
+        warm_up = true;
+        warm_up_urls = std::move(urls);
+    }
+
+    // Pins the threads round-robin to the NUMA nodes, needs to be called before Run
+    void SetThreadPinning(const bool pin_threads_) { pin_threads = pin_threads_; }
+
+    void SetRequestTimeout(const std::chrono::steady_clock::duration timeout)
+    {
+        request_handler.SetRequestTimeout(timeout);
+    }
+
+    // Applies to the replies of all connections, needs to be called before Run
+    void SetCompression(const CompressionConfig &compression_) { compression = compression_; }
+
+    void SetRequestCoalescing(const bool coalesce_requests)
+    {
+        request_handler.SetRequestCoalescing(coalesce_requests);
+    }
+
+    void SetBatchPriority(std::vector<std::string> services, const std::size_t min_coordinates)
+    {
+        request_handler.SetBatchPriority(std::move(services), min_coordinates);
+    }
+
+    void SetTraceSampleRate(const double trace_sample_rate)
+    {
+        request_handler.SetTraceSampleRate(trace_sample_rate);
+    }
+
+    void SetCaching(const bool cache_validators,
+                    std::unordered_map<std::string, std::string> cache_control)
+    {
+        request_handler.SetCaching(cache_validators, std::move(cache_control));
+    }
+
+    Metrics &GetMetrics() { return request_handler.GetMetrics(); }
+
   private:
-    void HandleAccept(const boost::system::error_code &e)
+    // TCP and unix domain socket acceptors accept into the same generic stream sockets
+    using Acceptor = boost::asio::basic_socket_acceptor<boost::asio::generic::stream_protocol>;
+
+    // Connections of a TCP acceptor with an io_service of its own stay on it, a single shared
+    // TCP acceptor and the unix domain socket acceptor spread the connections over all
+    // io_services.
+    boost::asio::io_service &ConnectionIOService(const std::size_t acceptor_index)
+    {
+        if (number_of_tcp_acceptors == io_services.size() &&
+            acceptor_index < number_of_tcp_acceptors)
+        {
+            return *io_services[acceptor_index];
+        }
+        return *io_services[next_io_service++ % io_services.size()];
+    }
+
+    void StartAccept(const std::size_t acceptor_index)
+    {
+        new_connections[acceptor_index] = std::make_shared<Connection>(
+            ConnectionIOService(acceptor_index), request_handler, compression);
+        acceptors[acceptor_index]->async_accept(new_connections[acceptor_index]->socket(),
+                                                boost::bind(&Server::HandleAccept,
+                                                            this,
+                                                            acceptor_index,
+                                                            boost::asio::placeholders::error));
+    }
+
+    void HandleAccept(const std::size_t acceptor_index, const boost::system::error_code &e)
     {
         if (!e)
         {
-            new_connection->start();
-            new_connection = std::make_shared<Connection>(io_service, request_handler);
-            acceptor.async_accept(
-                new_connection->socket(),
-                boost::bind(&Server::HandleAccept, this, boost::asio::placeholders::error));
+            new_connections[acceptor_index]->start();
+            StartAccept(acceptor_index);
         }
     }
 
     unsigned thread_pool_size;
-    boost::asio::io_service io_service;
-    boost::asio::ip::tcp::acceptor acceptor;
-    std::shared_ptr<Connection> new_connection;
+    std::vector<std::unique_ptr<boost::asio::io_service>> io_services;
+    // the TCP acceptors come first, followed by the unix domain socket acceptor if any
+    std::vector<std::unique_ptr<Acceptor>> acceptors;
+    std::size_t number_of_tcp_acceptors = 0;
+    std::vector<std::shared_ptr<Connection>> new_connections;
+    // shared by the single TCP acceptor and the unix domain socket acceptor
+    std::atomic<std::size_t> next_io_service;
+    std::string unix_socket_path;
+    bool pin_threads = false;
+    bool warm_up = false;
+    std::vector<std::string> warm_up_urls;
+    std::mutex ready_mutex;
+    std::condition_variable ready_condition;
+    bool ready = false;
+    CompressionConfig compression;
     RequestHandler request_handler;
 };
 }
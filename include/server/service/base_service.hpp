@@ -1,12 +1,13 @@
 #ifndef SERVER_SERVICE_BASE_SERVICE_HPP
 #define SERVER_SERVICE_BASE_SERVICE_HPP
 
+#include "engine/api/base_result.hpp"
+#include "engine/cancellation_token.hpp"
 #include "engine/status.hpp"
 #include "osrm/osrm.hpp"
 #include "util/coordinate.hpp"
 
-#include <mapbox/variant.hpp>
-
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -20,13 +21,17 @@ namespace service
 class BaseService
 {
   public:
-    using ResultT = mapbox::util::variant<util::json::Object, std::string>;
+    using ResultT = engine::api::ResultT;
 
     BaseService(OSRM &routing_machine) : routing_machine(routing_machine) {}
     virtual ~BaseService() = default;
 
+    // The services pass the cancellation token of the request on to its parameters
     virtual engine::Status
-    RunQuery(std::size_t prefix_length, std::string &query, ResultT &result) = 0;
+    RunQuery(std::size_t prefix_length,
+             std::string &query,
+             ResultT &result,
+             std::shared_ptr<const engine::CancellationToken> cancellation_token) = 0;
 
     virtual unsigned GetVersion() = 0;
 
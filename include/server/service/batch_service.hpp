@@ -0,0 +1,37 @@
+#ifndef SERVER_SERVICE_BATCH_SERVICE_HPP
+#define SERVER_SERVICE_BATCH_SERVICE_HPP
+
+#include "server/service/base_service.hpp"
+
+#include "engine/status.hpp"
+#include "osrm/osrm.hpp"
+#include "util/coordinate.hpp"
+
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace service
+{
+
+class BatchService final : public BaseService
+{
+  public:
+    BatchService(OSRM &routing_machine) : BaseService(routing_machine) {}
+
+    engine::Status
+    RunQuery(std::size_t prefix_length,
+             std::string &query,
+             ResultT &result,
+             std::shared_ptr<const engine::CancellationToken> cancellation_token) final override;
+
+    unsigned GetVersion() final override { return 1; }
+};
+}
+}
+}
+
+#endif
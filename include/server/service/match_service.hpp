@@ -23,7 +23,10 @@ class MatchService final : public BaseService
     MatchService(OSRM &routing_machine) : BaseService(routing_machine) {}
 
     engine::Status
-    RunQuery(std::size_t prefix_length, std::string &query, ResultT &result) final override;
+    RunQuery(std::size_t prefix_length,
+             std::string &query,
+             ResultT &result,
+             std::shared_ptr<const engine::CancellationToken> cancellation_token) final override;
 
     unsigned GetVersion() final override { return 1; }
 };
@@ -5,7 +5,12 @@
 
 #include "osrm/osrm.hpp"
 
+#include <cstddef>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
@@ -27,21 +32,60 @@ class ServiceHandlerInterface
 {
   public:
     virtual ~ServiceHandlerInterface() {}
-    virtual engine::Status RunQuery(api::ParsedURL parsed_url,
-                                    service::BaseService::ResultT &result) = 0;
+    virtual engine::Status
+    RunQuery(api::ParsedURL parsed_url,
+             service::BaseService::ResultT &result,
+             std::shared_ptr<const engine::CancellationToken> cancellation_token) = 0;
+
+    // Prepares the calling thread for queries and runs the urls on it, returns the number of
+    // urls that failed
+    virtual std::size_t WarmUp(const std::vector<std::string> &urls) = 0;
+
+    // The memory of the blocks of the datasets, see OSRM::Memory
+    virtual void Memory(util::json::Object &result) = 0;
+
+    // The version of the dataset of the profile, false if there is none
+    virtual bool GetDatasetVersion(const std::string &profile,
+                                   engine::DatasetVersion &version) = 0;
 };
 
+// Runs the queries on the dataset of their profile, every dataset has its own engine and
+// services. The dataset of a single config serves all profiles.
 class ServiceHandler final : public ServiceHandlerInterface
 {
   public:
     ServiceHandler(osrm::EngineConfig &config);
+    // Serves the dataset of each config for the URLs with its profile
+    ServiceHandler(std::vector<std::pair<std::string, osrm::EngineConfig>> &profile_configs);
     using ResultT = service::BaseService::ResultT;
 
-    virtual engine::Status RunQuery(api::ParsedURL parsed_url, ResultT &result) override;
+    virtual engine::Status
+    RunQuery(api::ParsedURL parsed_url,
+             ResultT &result,
+             std::shared_ptr<const engine::CancellationToken> cancellation_token) override;
+
+    virtual std::size_t WarmUp(const std::vector<std::string> &urls) override;
+
+    // The report of the single dataset, or the reports keyed by profile with several datasets
+    virtual void Memory(util::json::Object &result) override;
+
+    virtual bool GetDatasetVersion(const std::string &profile,
+                                   engine::DatasetVersion &version) override;
 
   private:
-    std::unordered_map<std::string, std::unique_ptr<service::BaseService>> service_map;
-    OSRM routing_machine;
+    struct Dataset
+    {
+        explicit Dataset(osrm::EngineConfig &config);
+
+        OSRM routing_machine;
+        std::unordered_map<std::string, std::unique_ptr<service::BaseService>> service_map;
+    };
+
+    // The dataset of the profile or of the single config, nullptr if there is none
+    Dataset *FindDataset(const std::string &profile);
+
+    // keyed by the profile, a single dataset for all profiles has an empty key
+    std::unordered_map<std::string, std::unique_ptr<Dataset>> datasets;
 };
 }
 }
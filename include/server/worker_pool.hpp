@@ -0,0 +1,120 @@
+#ifndef SERVER_WORKER_POOL_HPP
+#define SERVER_WORKER_POOL_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+/// Bounded pool of routing threads that runs requests off the I/O threads.
+///
+/// Every service gets its own FIFO queue of at most max_queue_size requests. The workers serve
+/// the queues round-robin and requests of a single service never occupy all workers, so slow
+/// requests like large tables or trips can not block cheap nearest or route requests.
+///
+/// Interactive tasks are served before batch tasks and batch tasks never occupy all workers,
+/// so a burst of batch requests does not delay interactive ones. With a max_queue_wait tasks
+/// that were queued longer are rejected instead of run, and new tasks are rejected right away
+/// while the oldest task of their queue and priority already waits longer.
+///
+/// With pin_threads the workers are pinned round-robin to the NUMA nodes.
+class WorkerPool
+{
+  public:
+    using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    enum class Priority
+    {
+        Interactive,
+        Batch
+    };
+
+    WorkerPool(const unsigned number_of_threads,
+               const std::size_t max_queue_size,
+               const bool pin_threads = false,
+               const Clock::duration max_queue_wait = Clock::duration::zero());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /// Queues the task of the service, returns false if the queue of the service is full or
+    /// its tasks of the same priority wait longer than max_queue_wait. reject runs instead of
+    /// task if the task waited longer than max_queue_wait once a worker is free.
+    bool Post(const std::string &service,
+              Task task,
+              const Priority priority = Priority::Interactive,
+              Task reject = nullptr);
+
+    /// Runs the task once on every worker, e.g. to set up thread local state, and blocks until
+    /// all of them are done. Workers busy with a request run it after their current task.
+    void RunOnEveryWorker(Task task);
+
+    /// Stops all workers after their current task, queued tasks are dropped.
+    void Stop();
+
+    /// Queued tasks by service, the services that share the overflow queue show up as "other".
+    std::vector<std::pair<std::string, std::size_t>> QueueDepths();
+
+  private:
+    static constexpr std::size_t NUMBER_OF_PRIORITIES = 2;
+
+    struct QueuedTask
+    {
+        Task task;
+        Task reject;
+        Clock::time_point queued;
+        Priority priority;
+    };
+
+    struct ServiceQueue
+    {
+        std::string service;
+        // indexed by Priority
+        std::array<std::deque<QueuedTask>, NUMBER_OF_PRIORITIES> tasks;
+        unsigned running = 0;
+    };
+
+    void Work();
+    bool PopTask(QueuedTask &task, std::size_t &queue_index);
+
+    const std::size_t max_queue_size;
+    const Clock::duration max_queue_wait;
+    unsigned max_running_per_service;
+    // leaves a worker for interactive tasks
+    unsigned max_running_batch;
+    unsigned running_batch = 0;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopped = false;
+    std::vector<ServiceQueue> queues;
+    std::unordered_map<std::string, std::size_t> queue_indices;
+    std::size_t next_queue = 0;
+
+    // workers run the task of RunOnEveryWorker once they see a new generation
+    Task every_worker_task;
+    std::size_t every_worker_generation = 0;
+    std::size_t pending_workers = 0;
+    std::condition_variable every_worker_condition;
+
+    std::vector<std::thread> workers;
+};
+}
+}
+
+#endif // SERVER_WORKER_POOL_HPP
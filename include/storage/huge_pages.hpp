@@ -0,0 +1,150 @@
+#ifndef OSRM_STORAGE_HUGE_PAGES_HPP
+#define OSRM_STORAGE_HUGE_PAGES_HPP
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+
+namespace osrm
+{
+namespace storage
+{
+
+// Page size of the memory a dataset is loaded into
+enum class HugePages
+{
+    // pages of the default size
+    None,
+    // advise the kernel to back the memory with transparent huge pages, for shared memory this
+    // needs /sys/kernel/mm/transparent_hugepage/shmem_enabled set to advise or always
+    Transparent,
+    // huge pages that the administrator reserved in /proc/sys/vm/nr_hugepages, falls back to
+    // pages of the default size if there are not enough of them
+    Explicit
+};
+
+// Parses none, transparent or explicit, for the command line options of the tools
+inline std::istream &operator>>(std::istream &in, HugePages &huge_pages)
+{
+    std::string token;
+    in >> token;
+    boost::to_lower(token);
+
+    if (token == "none")
+        huge_pages = HugePages::None;
+    else if (token == "transparent")
+        huge_pages = HugePages::Transparent;
+    else if (token == "explicit")
+        huge_pages = HugePages::Explicit;
+    else
+        in.setstate(std::ios::failbit);
+    return in;
+}
+
+// Explicit huge pages of the default size on x86-64 and arm64
+constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Asks the kernel to back a memory region with transparent huge pages
+inline void adviseHugePages(void *memory, const std::size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    if (-1 == madvise(memory, size, MADV_HUGEPAGE))
+    {
+        util::Log(logWARNING) << "Could not advise transparent huge pages";
+    }
+#else
+    (void)memory;
+    (void)size;
+    util::Log(logWARNING) << "Transparent huge pages are not supported on this platform";
+#endif
+}
+
+/**
+ * Anonymous memory of the process that is released with this object. The memory can be backed
+ * by huge pages, which reduces the TLB misses of traversing large datasets.
+ */
+class ProcessMemory
+{
+  public:
+    ProcessMemory(const std::size_t size_, const HugePages huge_pages) : size(size_)
+    {
+#ifndef _WIN32
+#ifdef MAP_HUGETLB
+        if (huge_pages == HugePages::Explicit)
+        {
+            // the kernel maps whole huge pages, munmap needs the rounded size
+            size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            memory = mmap(nullptr,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                          -1,
+                          0);
+            if (memory == MAP_FAILED)
+            {
+                util::Log(logWARNING) << "Could not allocate " << size
+                                      << " bytes of huge pages, using default pages";
+                size = size_;
+            }
+        }
+#endif
+        if (memory == MAP_FAILED)
+        {
+            memory =
+                mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED)
+            {
+                throw util::exception("Could not allocate " + std::to_string(size) +
+                                      " bytes of memory" + SOURCE_REF);
+            }
+            if (huge_pages == HugePages::Transparent)
+            {
+                adviseHugePages(memory, size);
+            }
+        }
+#else
+        if (huge_pages != HugePages::None)
+        {
+            util::Log(logWARNING) << "Huge pages are not supported on this platform";
+        }
+        buffer = std::make_unique<char[]>(size);
+        memory = buffer.get();
+#endif
+    }
+
+    ProcessMemory(const ProcessMemory &) = delete;
+    ProcessMemory &operator=(const ProcessMemory &) = delete;
+
+    ~ProcessMemory()
+    {
+#ifndef _WIN32
+        munmap(memory, size);
+#endif
+    }
+
+    char *get() const { return static_cast<char *>(memory); }
+
+  private:
+    std::size_t size;
+#ifndef _WIN32
+    void *memory = MAP_FAILED;
+#else
+    std::unique_ptr<char[]> buffer;
+    void *memory = nullptr;
+#endif
+};
+}
+}
+
+#endif
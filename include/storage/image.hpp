@@ -0,0 +1,100 @@
+#ifndef OSRM_STORAGE_IMAGE_HPP
+#define OSRM_STORAGE_IMAGE_HPP
+
+#include "storage/shared_data_index.hpp"
+#include "storage/shared_datatype.hpp"
+
+#include "util/fingerprint.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace osrm
+{
+namespace storage
+{
+
+/**
+ * A dataset image is the memory of a dataset written to one file, so that it can be mapped
+ * instead of loaded from the .osrm files. The file starts with an ImageHeader and the encoded
+ * DataLayout, the blocks of the layout follow at data_offset.
+ *
+ * The data starts at a multiple of IMAGE_ALIGNMENT, so that every mapping of the image places
+ * the blocks at the alignment they were written with. An image refers to the .osrm.fileIndex it
+ * was written from by its absolute path, unless the r-tree leaves were loaded into it.
+ */
+struct ImageHeader
+{
+    util::FingerPrint fingerprint;
+    std::uint64_t layout_size;
+    std::uint64_t data_offset;
+    std::uint64_t data_size;
+};
+
+// Larger than the pages of all platforms, so that images can be moved between machines
+constexpr std::size_t IMAGE_ALIGNMENT = 64 * 1024;
+
+/**
+ * Identifies the file of an image. Writing an image replaces the file at its path, so the id of
+ * the path changes with every image while processes that still map the old image keep its file.
+ * Processes in different containers that share the directory of the image see the same id.
+ */
+struct ImageFileId
+{
+    std::uint64_t inode = 0;
+    // seconds since the epoch when the image was written
+    std::int64_t modified = 0;
+
+    bool IsValid() const { return inode != 0 || modified != 0; }
+    bool operator==(const ImageFileId &other) const
+    {
+        return inode == other.inode && modified == other.modified;
+    }
+    bool operator!=(const ImageFileId &other) const { return !(*this == other); }
+};
+
+// The id of the file at path, an invalid id if there is none
+ImageFileId getImageFileId(const boost::filesystem::path &path);
+
+// Writes an image of layout to path, populate fills the blocks of the mapped image. The image
+// replaces the file at path at once, also on tmpfs and hugetlbfs.
+void writeImage(const boost::filesystem::path &path,
+                DataLayout layout,
+                const std::function<void(const SharedDataIndex &)> &populate);
+
+/**
+ * Maps an image read-only and shared, so that the pages of the dataset are the pages of the file
+ * in the page cache and all processes that map it share them. With populate all pages are read
+ * before the constructor returns, otherwise they are read when the first query touches them.
+ */
+class MappedImage
+{
+  public:
+    MappedImage(const boost::filesystem::path &path, bool populate);
+    ~MappedImage();
+
+    MappedImage(const MappedImage &) = delete;
+    MappedImage &operator=(const MappedImage &) = delete;
+
+    const SharedDataIndex &GetIndex() const { return index; }
+    // of the file that is mapped, the path may already name a newer image
+    const ImageFileId &GetFileId() const { return file_id; }
+
+  private:
+    SharedDataIndex index;
+    ImageFileId file_id;
+#ifndef _WIN32
+    void *memory;
+    std::size_t size;
+#else
+    boost::iostreams::mapped_file_source region;
+#endif
+};
+}
+}
+
+#endif
@@ -35,7 +35,22 @@ struct IOConfig
         return {base_path.string() + fileName};
     }
 
+    // Same as GetPath, but for the files that are written to output_base_path if it is set
+    boost::filesystem::path GetOutputPath(const std::string &fileName) const
+    {
+        const auto path = GetPath(fileName);
+        if (output_base_path.empty())
+        {
+            return path;
+        }
+
+        return {output_base_path.string() + fileName};
+    }
+
     boost::filesystem::path base_path;
+    // Writes the outputs next to the input files under another base path, e.g. the metric of a
+    // time slot that must not replace the metric of the dataset
+    boost::filesystem::path output_base_path;
 
   protected:
     // Infer the base path from the path of the .osrm file
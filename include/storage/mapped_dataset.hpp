@@ -0,0 +1,45 @@
+#ifndef OSRM_STORAGE_MAPPED_DATASET_HPP
+#define OSRM_STORAGE_MAPPED_DATASET_HPP
+
+#include "storage/huge_pages.hpp"
+#include "storage/shared_data_index.hpp"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace storage
+{
+
+/**
+ * A dataset whose blocks point into read-only mappings of the .osrm files, so that only the
+ * pages that queries touch are ever read. The blocks need to be stored in the files as they are
+ * laid out in memory, the others are loaded into memory of this object.
+ *
+ * \see Storage::MapDataset
+ */
+class MappedDataset
+{
+  public:
+    MappedDataset(std::vector<boost::iostreams::mapped_file_source> files_,
+                  std::unique_ptr<ProcessMemory> memory_,
+                  SharedDataIndex index_)
+        : files(std::move(files_)), memory(std::move(memory_)), index(std::move(index_))
+    {
+    }
+
+    const SharedDataIndex &GetIndex() const { return index; }
+
+  private:
+    std::vector<boost::iostreams::mapped_file_source> files;
+    std::unique_ptr<ProcessMemory> memory;
+    SharedDataIndex index;
+};
+}
+}
+
+#endif
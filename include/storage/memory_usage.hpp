@@ -0,0 +1,42 @@
+#ifndef OSRM_STORAGE_MEMORY_USAGE_HPP
+#define OSRM_STORAGE_MEMORY_USAGE_HPP
+
+#include "storage/shared_data_index.hpp"
+
+#include "util/json_container.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace storage
+{
+
+// Memory of a block of a loaded dataset
+struct BlockMemoryUsage
+{
+    std::string name;
+    std::string subsystem;
+    std::uint64_t entries;
+    std::uint64_t mapped_bytes;
+    // The pages of the block that are in RAM. The others were never touched, are swapped out or
+    // are not read from their file yet. Pages shared with the neighbouring blocks are counted
+    // with the part that belongs to the block.
+    std::uint64_t resident_bytes;
+};
+
+// Part of the dataset a block belongs to, e.g. "rtree", "guidance" or "mld/cells/duration" for the
+// cell metrics of the metric "duration". Blocks of one part are used or dropped together.
+std::string getSubsystem(const std::string &block_name);
+
+// Blocks of the index ordered by their names
+std::vector<BlockMemoryUsage> getMemoryUsage(const SharedDataIndex &index);
+
+// The mapped and resident bytes of all blocks, per subsystem and per block, the largest first
+util::json::Object makeMemoryReport(const std::vector<BlockMemoryUsage> &blocks);
+}
+}
+
+#endif
@@ -73,6 +73,18 @@ class DataLayout
         return blocks.find(name) != blocks.end();
     }
 
+    // Drops all blocks whose name starts with the prefix, e.g. data that is not loaded
+    inline void RemoveBlocks(const std::string &name_prefix)
+    {
+        for (auto iter = blocks.begin(); iter != blocks.end();)
+        {
+            if (iter->first.find(name_prefix) == 0)
+                iter = blocks.erase(iter);
+            else
+                ++iter;
+        }
+    }
+
     inline uint64_t GetSizeOfLayout() const
     {
         uint64_t result = 0;
@@ -25,6 +25,7 @@
 #include <exception>
 #include <thread>
 
+#include "storage/huge_pages.hpp"
 #include "storage/shared_memory_ownership.hpp"
 
 namespace osrm
@@ -55,7 +56,8 @@ class SharedMemory
     template <typename IdentifierT>
     SharedMemory(const boost::filesystem::path &lock_file,
                  const IdentifierT id,
-                 const uint64_t size = 0)
+                 const uint64_t size = 0,
+                 const HugePages huge_pages = HugePages::None)
         : key(lock_file.string().c_str(), id)
     {
         // open only
@@ -70,6 +72,15 @@ class SharedMemory
         // open or create
         else
         {
+#ifdef __linux__
+            // boost masks the flags of shmget, so the huge page segment is created beforehand
+            if (huge_pages == HugePages::Explicit &&
+                -1 == ::shmget(key.get_key(), size, IPC_CREAT | SHM_HUGETLB | 0644))
+            {
+                util::Log(logWARNING) << "Could not allocate " << size
+                                      << " bytes of huge pages, using default pages";
+            }
+#endif
             shm = boost::interprocess::xsi_shared_memory(
                 boost::interprocess::open_or_create, key, size);
             util::Log(logDEBUG) << "opening/creating " << shm.get_shmid() << " from id " << id
@@ -84,6 +95,10 @@ class SharedMemory
             }
 #endif
             region = boost::interprocess::mapped_region(shm, boost::interprocess::read_write);
+            if (huge_pages == HugePages::Transparent)
+            {
+                adviseHugePages(region.get_address(), region.get_size());
+            }
         }
     }
 
@@ -203,8 +218,15 @@ class SharedMemory
     void *Ptr() const { return region.get_address(); }
     std::size_t Size() const { return region.get_size(); }
 
-    SharedMemory(const boost::filesystem::path &lock_file, const int id, const uint64_t size = 0)
+    SharedMemory(const boost::filesystem::path &lock_file,
+                 const int id,
+                 const uint64_t size = 0,
+                 const HugePages huge_pages = HugePages::None)
     {
+        if (huge_pages != HugePages::None)
+        {
+            util::Log(logWARNING) << "Huge pages are not supported on this platform";
+        }
         sprintf(key, "%s.%d", "osrm.lock", id);
         if (0 == size)
         { // read_only
@@ -285,7 +307,9 @@ class SharedMemory
 #endif
 
 template <typename IdentifierT, typename LockFileT = OSRMLockFile>
-std::unique_ptr<SharedMemory> makeSharedMemory(const IdentifierT &id, const uint64_t size = 0)
+std::unique_ptr<SharedMemory> makeSharedMemory(const IdentifierT &id,
+                                               const uint64_t size = 0,
+                                               const HugePages huge_pages = HugePages::None)
 {
     try
     {
@@ -301,7 +325,7 @@ std::unique_ptr<SharedMemory> makeSharedMemory(const IdentifierT &id, const uint
                 boost::filesystem::ofstream ofs(lock_file());
             }
         }
-        return std::make_unique<SharedMemory>(lock_file(), id, size);
+        return std::make_unique<SharedMemory>(lock_file(), id, size, huge_pages);
     }
     catch (const boost::interprocess::interprocess_exception &e)
     {
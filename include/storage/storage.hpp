@@ -28,12 +28,18 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef STORAGE_HPP
 #define STORAGE_HPP
 
+#include "storage/mapped_dataset.hpp"
+#include "storage/shared_data_index.hpp"
 #include "storage/shared_datatype.hpp"
 #include "storage/storage_config.hpp"
 
 #include <boost/filesystem/path.hpp>
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
@@ -44,12 +50,41 @@ class Storage
   public:
     Storage(StorageConfig config);
 
-    int Run(int max_wait, const std::string &name);
+    // Loads the dataset into the regions <name>/static and <name>/updatable. With only_metric the
+    // static region of the dataset stays in place and only the updatable region is replaced.
+    // Without it the static region also stays in place if its files did not change since they
+    // were loaded, so an update of the weights only needs the memory of a second updatable region.
+    // A metric_name loads the updatable data into the region <name>/updatable/<metric_name> on
+    // top of the static region, requests select it by their metric parameter.
+    int Run(int max_wait,
+            const std::string &name,
+            bool only_metric,
+            const std::string &metric_name = "");
 
-    void PopulateLayout(DataLayout &layout);
-    void PopulateData(const DataLayout &layout, char *memory_ptr);
+    // The static data is the topology of the dataset, the updatable data is everything
+    // osrm-customize and osrm-contract write for new weights.
+    void PopulateStaticLayout(DataLayout &layout);
+    void PopulateUpdatableLayout(DataLayout &layout);
+    void PopulateStaticData(const SharedDataIndex &index);
+    void PopulateUpdatableData(const SharedDataIndex &index);
+
+    // Writes the static and the updatable data into one image file that can be mapped
+    void WriteImage(const boost::filesystem::path &image_path);
+
+    // Maps the static and the updatable data from the .osrm files instead of loading it
+    std::unique_ptr<MappedDataset> MapDataset();
 
   private:
+    using Files = std::vector<std::pair<bool, boost::filesystem::path>>;
+    Files GetStaticFiles() const;
+    Files GetUpdatableFiles() const;
+    // Changes with the paths, sizes and modification times of the static files
+    std::uint64_t GetStaticFilesSignature() const;
+    void PopulateLayout(DataLayout &layout, const Files &files);
+    void PopulateFileIndexLayout(DataLayout &layout);
+    void PopulateFileIndexPath(const SharedDataIndex &index);
+    void PopulateRTreeLeaves(const SharedDataIndex &index);
+
     StorageConfig config;
 };
 }
@@ -30,6 +30,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/filesystem/path.hpp>
 
+#include "storage/huge_pages.hpp"
 #include "storage/io_config.hpp"
 
 namespace osrm
@@ -69,10 +70,35 @@ struct StorageConfig final : IOConfig
                     ".osrm.mldgr",
                     ".osrm.tld",
                     ".osrm.tls",
-                    ".osrm.partition"},
+                    ".osrm.partition",
+                    ".osrm.geometry_coordinates"},
                    {})
     {
     }
+
+    void UseDefaultOutputNames(const boost::filesystem::path &base)
+    {
+        IOConfig::UseDefaultOutputNames(base);
+    }
+
+    // Copy the r-tree leaves of the .fileIndex into the dataset memory instead of mapping the
+    // file, so that snapping does not depend on the page cache
+    bool load_rtree_leaves = false;
+    // Lock the loaded r-tree leaves into RAM, shared memory regions are always locked
+    bool lock_rtree_leaves = false;
+    // Do not load the OSM node ids, which only annotations=nodes and the nearest service return
+    bool skip_osm_node_ids = false;
+    // Page size of the shared memory regions and of the process memory of the dataset
+    HugePages huge_pages = HugePages::None;
+    // Spread the pages of the dataset round-robin over the NUMA nodes
+    bool numa_interleave = false;
+    // Map the blocks of the .osrm files into process memory instead of loading them, their pages
+    // are read when queries first touch them
+    bool lazy_loading = false;
+    // Read all pages of a mapped dataset image at startup instead of when queries touch them
+    bool populate_memory_file = false;
+    // Compare the checksums of the blocks of the .osrm files before they are loaded or mapped
+    bool verify_checksums = false;
 };
 }
 }
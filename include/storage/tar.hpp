@@ -1,6 +1,7 @@
 #ifndef OSRM_STORAGE_TAR_HPP
 #define OSRM_STORAGE_TAR_HPP
 
+#include "util/crc32c.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/fingerprint.hpp"
@@ -9,6 +10,28 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <zlib.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <mutex>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 extern "C" {
 #include "microtar.h"
 }
@@ -21,6 +44,91 @@ namespace tar
 {
 namespace detail
 {
+// Multiple of the page size, so the reads of consecutive chunks stay page aligned
+const constexpr std::size_t READ_CHUNK_SIZE = 8 * 1024 * 1024;
+
+// Compressed entries are stored under their name with this suffix
+const constexpr char COMPRESSED_SUFFIX[] = ".deflate";
+// Smaller entries are not worth the header and the extra pass over the data
+const constexpr std::size_t MIN_COMPRESSED_ENTRY_SIZE = 1024 * 1024;
+// Blocks are compressed and decompressed independently of each other, one per task
+const constexpr std::size_t COMPRESSION_BLOCK_SIZE = 4 * 1024 * 1024;
+
+// Start of a compressed entry, followed by the compressed size of every block and the blocks
+struct CompressedEntryHeader
+{
+    std::uint64_t uncompressed_size;
+    std::uint64_t block_size;
+    std::uint64_t number_of_blocks;
+};
+
+// The checksums of an entry follow it under its name with this suffix
+const constexpr char CHECKSUMS_SUFFIX[] = ".crc32c";
+// Every block of the stored bytes of an entry has a checksum of its own, so they are computed and
+// verified in parallel
+const constexpr std::size_t CHECKSUM_BLOCK_SIZE = 4 * 1024 * 1024;
+
+// Start of the checksums of an entry, followed by the CRC-32C of every block
+struct ChecksumsHeader
+{
+    std::uint64_t block_size;
+    std::uint64_t number_of_blocks;
+};
+
+inline bool hasSuffix(const std::string &name, const char *suffix, const std::size_t suffix_size)
+{
+    return name.size() > suffix_size &&
+           name.compare(name.size() - suffix_size, suffix_size, suffix) == 0;
+}
+
+inline bool isCompressedName(const std::string &name)
+{
+    return hasSuffix(name, COMPRESSED_SUFFIX, sizeof(COMPRESSED_SUFFIX) - 1);
+}
+
+inline bool isChecksumsName(const std::string &name)
+{
+    return hasSuffix(name, CHECKSUMS_SUFFIX, sizeof(CHECKSUMS_SUFFIX) - 1);
+}
+
+// Checksums of the blocks of bytes that are written one after the other
+class BlockChecksums
+{
+  public:
+    void Add(const void *data, std::size_t size)
+    {
+        auto bytes = static_cast<const char *>(data);
+        while (size > 0)
+        {
+            const auto size_in_block = std::min(size, CHECKSUM_BLOCK_SIZE - bytes_in_block);
+            current = util::updateCRC32C(current, bytes, size_in_block);
+            bytes += size_in_block;
+            size -= size_in_block;
+            bytes_in_block += size_in_block;
+            if (bytes_in_block == CHECKSUM_BLOCK_SIZE)
+            {
+                checksums.push_back(current);
+                current = 0;
+                bytes_in_block = 0;
+            }
+        }
+    }
+
+    std::vector<std::uint32_t> Finish()
+    {
+        if (bytes_in_block > 0)
+        {
+            checksums.push_back(current);
+        }
+        return std::move(checksums);
+    }
+
+  private:
+    std::vector<std::uint32_t> checksums;
+    std::uint32_t current = 0;
+    std::size_t bytes_in_block = 0;
+};
+
 inline void
 checkMTarError(int error_code, const boost::filesystem::path &filepath, const std::string &name)
 {
@@ -74,6 +182,19 @@ checkMTarError(int error_code, const boost::filesystem::path &filepath, const st
 }
 }
 
+/**
+ * Reads the entries of a tar file.
+ *
+ * The headers are scanned once when the file is opened, so entries are found without walking the
+ * archive again. Entries are read with positional reads of up to detail::READ_CHUNK_SIZE bytes.
+ * While a chunk is copied the kernel is asked to prefetch the next one, and once an entry is read
+ * the start of the entry that follows it in the file. The reads of a FileReader don't share a file
+ * position, so independent entries can be read from several threads at once.
+ *
+ * Entries that a FileWriter compressed are listed and read under their original name and size,
+ * their blocks are decompressed in parallel. The checksums a FileWriter stores with the entries
+ * are not listed, VerifyChecksums checks them.
+ */
 class FileReader
 {
   public:
@@ -83,11 +204,31 @@ class FileReader
         HasNoFingerprint
     };
 
+    struct FileEntry
+    {
+        std::string name;
+        std::size_t size;
+        std::size_t offset;
+        // the data at offset is a compressed entry and can't be used as it is
+        bool compressed = false;
+        // size of the data at offset, which differs from the size of compressed entries
+        std::size_t stored_size = 0;
+        // offset of the checksums of the stored data, 0 for entries without checksums
+        std::size_t checksums_offset = 0;
+    };
+
     FileReader(const boost::filesystem::path &path, FingerprintFlag flag) : path(path)
     {
         auto ret = mtar_open(&handle, path.string().c_str(), "r");
         detail::checkMTarError(ret, path, "");
 
+#ifdef POSIX_FADV_SEQUENTIAL
+        // the blocks are read front to back, a larger read-ahead keeps the disk busy
+        posix_fadvise(fileno(static_cast<std::FILE *>(handle.stream)), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+        IndexEntries();
+
         if (flag == VerifyFingerprint)
         {
             ReadAndCheckFingerprint();
@@ -96,6 +237,9 @@ class FileReader
 
     ~FileReader() { mtar_close(&handle); }
 
+    FileReader(const FileReader &) = delete;
+    FileReader &operator=(const FileReader &) = delete;
+
     std::uint64_t ReadElementCount64(const std::string &name)
     {
         std::uint64_t size;
@@ -110,59 +254,160 @@ class FileReader
 
     template <typename T, typename OutIter> void ReadStreaming(const std::string &name, OutIter out)
     {
-        mtar_header_t header;
-        auto ret = mtar_find(&handle, name.c_str(), &header);
-        detail::checkMTarError(ret, path, name);
+        const auto &entry = FindEntry(name);
 
-        auto number_of_elements = header.size / sizeof(T);
+        auto number_of_elements = entry.size / sizeof(T);
         auto expected_size = sizeof(T) * number_of_elements;
-        if (header.size != expected_size)
+        if (entry.size != expected_size)
         {
             throw util::RuntimeError(name + ": Datatype size does not match file size.",
                                      ErrorCode::UnexpectedEndOfFile,
                                      SOURCE_REF);
         }
 
-        T tmp;
-        for (auto index : util::irange<std::size_t>(0, number_of_elements))
+        if (entry.compressed)
         {
-            (void)index;
-            ret = mtar_read_data(&handle, reinterpret_cast<char *>(&tmp), sizeof(T));
-            detail::checkMTarError(ret, path, name);
+            std::vector<T> buffer(number_of_elements);
+            ReadCompressed(entry, reinterpret_cast<char *>(buffer.data()));
+            for (const auto &element : buffer)
+            {
+                *out++ = element;
+            }
+            return;
+        }
 
-            *out++ = tmp;
+        std::vector<T> buffer(std::min<std::size_t>(
+            number_of_elements, std::max<std::size_t>(detail::READ_CHUNK_SIZE / sizeof(T), 1)));
+        for (std::size_t first = 0; first < number_of_elements; first += buffer.size())
+        {
+            const auto count = std::min(buffer.size(), number_of_elements - first);
+            ReadAt(entry.offset + first * sizeof(T),
+                   reinterpret_cast<char *>(buffer.data()),
+                   count * sizeof(T),
+                   name);
+            // output iterators like the function_output_iterator of a lambda are not assignable
+            for (const auto index : util::irange<std::size_t>(0, count))
+            {
+                *out++ = buffer[index];
+            }
         }
+        PrefetchNext(entry);
     }
 
     template <typename T>
     void ReadInto(const std::string &name, T *data, const std::size_t number_of_elements)
     {
-        mtar_header_t header;
-        auto ret = mtar_find(&handle, name.c_str(), &header);
-        detail::checkMTarError(ret, path, name);
+        const auto &entry = FindEntry(name);
 
         auto expected_size = sizeof(T) * number_of_elements;
-        if (header.size != expected_size)
+        if (entry.size != expected_size)
         {
             throw util::RuntimeError(name + ": Datatype size does not match file size.",
                                      ErrorCode::UnexpectedEndOfFile,
                                      SOURCE_REF);
         }
 
-        ret = mtar_read_data(&handle, reinterpret_cast<char *>(data), header.size);
-        detail::checkMTarError(ret, path, name);
+        if (entry.compressed)
+        {
+            ReadCompressed(entry, reinterpret_cast<char *>(data));
+            return;
+        }
+
+        ReadAt(entry.offset, reinterpret_cast<char *>(data), entry.size, name);
+        PrefetchNext(entry);
     }
 
-    struct FileEntry
+    template <typename OutIter> void List(OutIter out)
     {
-        std::string name;
-        std::size_t size;
-        std::size_t offset;
-    };
+        std::copy(entries.begin(), entries.end(), out);
+    }
 
-    template <typename OutIter> void List(OutIter out)
+    bool HasEntry(const std::string &name) const { return entry_indices.count(name) > 0; }
+
+    // Reads the stored data of all entries with checksums and compares the checksums of their
+    // blocks, the blocks of all entries in parallel. Entries of files written without checksums
+    // are skipped. Returns the number of verified bytes.
+    std::size_t VerifyChecksums()
+    {
+        struct ChecksummedBlock
+        {
+            const FileEntry *entry;
+            std::size_t first;
+            std::size_t size;
+            std::uint32_t checksum;
+        };
+
+        std::vector<ChecksummedBlock> blocks;
+        std::size_t verified_bytes = 0;
+        for (const auto &entry : entries)
+        {
+            if (entry.checksums_offset == 0)
+                continue;
+
+            detail::ChecksumsHeader header;
+            ReadAt(entry.checksums_offset,
+                   reinterpret_cast<char *>(&header),
+                   sizeof(header),
+                   entry.name);
+            if (header.block_size == 0 ||
+                header.number_of_blocks !=
+                    (entry.stored_size + header.block_size - 1) / header.block_size)
+            {
+                throw util::RuntimeError(path.string() + " : " + entry.name,
+                                         ErrorCode::FileReadError,
+                                         SOURCE_REF,
+                                         "corrupt checksums");
+            }
+
+            std::vector<std::uint32_t> checksums(header.number_of_blocks);
+            ReadAt(entry.checksums_offset + sizeof(header),
+                   reinterpret_cast<char *>(checksums.data()),
+                   checksums.size() * sizeof(std::uint32_t),
+                   entry.name);
+            for (const auto block : util::irange<std::size_t>(0, checksums.size()))
+            {
+                const auto first = block * header.block_size;
+                const auto size =
+                    std::min<std::size_t>(header.block_size, entry.stored_size - first);
+                blocks.push_back({&entry, first, size, checksums[block]});
+            }
+            verified_bytes += entry.stored_size;
+        }
+
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, blocks.size(), 1),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                std::vector<char> buffer;
+                for (auto index = range.begin(); index < range.end(); ++index)
+                {
+                    const auto &block = blocks[index];
+                    buffer.resize(block.size);
+                    ReadAt(block.entry->offset + block.first,
+                           buffer.data(),
+                           block.size,
+                           block.entry->name);
+                    if (util::computeCRC32C(buffer.data(), block.size) != block.checksum)
+                    {
+                        throw util::RuntimeError(path.string() + " : " + block.entry->name +
+                                                     " at byte " + std::to_string(block.first),
+                                                 ErrorCode::FileReadError,
+                                                 SOURCE_REF,
+                                                 "checksum mismatch");
+                    }
+                }
+            });
+
+        return verified_bytes;
+    }
+
+  private:
+    // Scans the headers of the regular files, in the order of the archive
+    void IndexEntries()
     {
         mtar_header_t header;
+        // the stored name of the last entry and whether it was indexed, duplicates are not
+        std::string last_stored_name;
+        bool last_indexed = false;
         while (mtar_read_header(&handle, &header) != MTAR_ENULLRECORD)
         {
             if (header.type == MTAR_TREG)
@@ -176,13 +421,160 @@ class FileReader
                 ret = mtar_seek(&handle, handle.last_header);
                 detail::checkMTarError(ret, path, header.name);
 
-                *out++ = FileEntry{header.name, header.size, offset};
+                FileEntry entry{header.name, header.size, offset};
+                entry.stored_size = header.size;
+                if (detail::isChecksumsName(entry.name))
+                {
+                    // the checksums follow the entry they belong to
+                    if (last_indexed && last_stored_name + detail::CHECKSUMS_SUFFIX == entry.name)
+                    {
+                        entries.back().checksums_offset = offset;
+                    }
+                    last_indexed = false;
+                    mtar_next(&handle);
+                    continue;
+                }
+                last_stored_name = entry.name;
+
+                if (detail::isCompressedName(entry.name))
+                {
+                    detail::CompressedEntryHeader compressed_header;
+                    ReadAt(offset,
+                           reinterpret_cast<char *>(&compressed_header),
+                           sizeof(compressed_header),
+                           entry.name);
+                    entry.name.resize(entry.name.size() - sizeof(detail::COMPRESSED_SUFFIX) + 1);
+                    entry.size = compressed_header.uncompressed_size;
+                    entry.compressed = true;
+                }
+
+                // like a search through the archive, the first of equally named entries is used
+                last_indexed = entry_indices.emplace(entry.name, entries.size()).second;
+                if (last_indexed)
+                {
+                    entries.push_back(std::move(entry));
+                }
             }
             mtar_next(&handle);
         }
     }
 
-  private:
+    const FileEntry &FindEntry(const std::string &name) const
+    {
+        const auto iter = entry_indices.find(name);
+        if (iter == entry_indices.end())
+        {
+            detail::checkMTarError(MTAR_ENOTFOUND, path, name);
+        }
+        return entries[iter->second];
+    }
+
+    void ReadAt(std::size_t offset, char *data, std::size_t size, const std::string &name)
+    {
+#ifndef _WIN32
+        const auto descriptor = fileno(static_cast<std::FILE *>(handle.stream));
+        while (size > 0)
+        {
+            const auto chunk_size = std::min(size, detail::READ_CHUNK_SIZE);
+#ifdef POSIX_FADV_WILLNEED
+            if (size > chunk_size)
+            {
+                posix_fadvise(descriptor,
+                              offset + chunk_size,
+                              std::min(size - chunk_size, detail::READ_CHUNK_SIZE),
+                              POSIX_FADV_WILLNEED);
+            }
+#endif
+            const auto bytes_read = pread(descriptor, data, chunk_size, offset);
+            if (bytes_read < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (bytes_read <= 0)
+            {
+                detail::checkMTarError(
+                    bytes_read == 0 ? MTAR_ENULLRECORD : MTAR_EREADFAIL, path, name);
+            }
+            data += bytes_read;
+            offset += bytes_read;
+            size -= bytes_read;
+        }
+#else
+        // without positional reads the file position is shared by all reads
+        std::lock_guard<std::mutex> lock(read_mutex);
+        auto ret = mtar_seek(&handle, offset);
+        detail::checkMTarError(ret, path, name);
+        if (size > 0 && std::fread(data, size, 1, static_cast<std::FILE *>(handle.stream)) != 1)
+        {
+            detail::checkMTarError(MTAR_EREADFAIL, path, name);
+        }
+#endif
+    }
+
+    // Reads the block table of the entry and decompresses the blocks in parallel
+    void ReadCompressed(const FileEntry &entry, char *data)
+    {
+        detail::CompressedEntryHeader header;
+        ReadAt(entry.offset, reinterpret_cast<char *>(&header), sizeof(header), entry.name);
+
+        std::vector<std::uint64_t> block_offsets(header.number_of_blocks + 1);
+        ReadAt(entry.offset + sizeof(header),
+               reinterpret_cast<char *>(block_offsets.data() + 1),
+               header.number_of_blocks * sizeof(std::uint64_t),
+               entry.name);
+        block_offsets[0] =
+            entry.offset + sizeof(header) + header.number_of_blocks * sizeof(std::uint64_t);
+        std::partial_sum(block_offsets.begin(), block_offsets.end(), block_offsets.begin());
+
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, header.number_of_blocks, 1),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                std::vector<unsigned char> compressed;
+                for (auto block = range.begin(); block < range.end(); ++block)
+                {
+                    compressed.resize(block_offsets[block + 1] - block_offsets[block]);
+                    ReadAt(block_offsets[block],
+                           reinterpret_cast<char *>(compressed.data()),
+                           compressed.size(),
+                           entry.name);
+
+                    const auto first = block * header.block_size;
+                    const auto expected_size =
+                        std::min<std::uint64_t>(header.block_size, entry.size - first);
+                    uLongf uncompressed_size = expected_size;
+                    const auto ret = uncompress(reinterpret_cast<Bytef *>(data + first),
+                                                &uncompressed_size,
+                                                compressed.data(),
+                                                compressed.size());
+                    if (ret != Z_OK || uncompressed_size != expected_size)
+                    {
+                        throw util::RuntimeError(path.string() + " : " + entry.name,
+                                                 ErrorCode::FileReadError,
+                                                 SOURCE_REF,
+                                                 "corrupt compressed block");
+                    }
+                }
+            });
+        PrefetchNext(entry);
+    }
+
+    // Entries are mostly read in the order of the archive, the next one is loaded in the background
+    void PrefetchNext(const FileEntry &entry) const
+    {
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+        const auto next = &entry - entries.data() + 1;
+        if (static_cast<std::size_t>(next) < entries.size() && entries[next].size > 0)
+        {
+            posix_fadvise(fileno(static_cast<std::FILE *>(handle.stream)),
+                          entries[next].offset,
+                          std::min(entries[next].size, detail::READ_CHUNK_SIZE),
+                          POSIX_FADV_WILLNEED);
+        }
+#else
+        (void)entry;
+#endif
+    }
+
     bool ReadAndCheckFingerprint()
     {
         util::FingerPrint loaded_fingerprint;
@@ -211,8 +603,20 @@ class FileReader
 
     boost::filesystem::path path;
     mtar_t handle;
+    std::vector<FileEntry> entries;
+    std::unordered_map<std::string, std::size_t> entry_indices;
+#ifdef _WIN32
+    std::mutex read_mutex;
+#endif
 };
 
+/**
+ * Writes the entries of a tar file.
+ *
+ * Every entry is followed by the CRC-32C checksums of the blocks of its stored data, which
+ * FileReader::VerifyChecksums compares. The blocks of entries written at once are checksummed in
+ * parallel.
+ */
 class FileWriter
 {
   public:
@@ -222,7 +626,17 @@ class FileWriter
         HasNoFingerprint
     };
 
-    FileWriter(const boost::filesystem::path &path, FingerprintFlag flag) : path(path)
+    enum CompressionFlag
+    {
+        Uncompressed,
+        // entries of at least detail::MIN_COMPRESSED_ENTRY_SIZE bytes written with WriteFrom
+        CompressLargeEntries
+    };
+
+    FileWriter(const boost::filesystem::path &path,
+               FingerprintFlag flag,
+               CompressionFlag compression = Uncompressed)
+        : path(path), compression(compression)
     {
         auto ret = mtar_open(&handle, path.string().c_str(), "w");
         detail::checkMTarError(ret, path, "");
@@ -257,16 +671,21 @@ class FileWriter
         auto ret = mtar_write_file_header(&handle, name.c_str(), number_of_bytes);
         detail::checkMTarError(ret, path, name);
 
+        detail::BlockChecksums checksums;
         for (auto index : util::irange<std::size_t>(0, number_of_elements))
         {
             (void)index;
             T tmp = *iter++;
             ret = mtar_write_data(&handle, &tmp, sizeof(T));
             detail::checkMTarError(ret, path, name);
+            checksums.Add(&tmp, sizeof(T));
         }
+
+        WriteChecksums(name, checksums.Finish());
     }
 
-    // Continue writing an existing file, overwrites all data after the file!
+    // Continue writing an existing file, overwrites all data after the file! That includes the
+    // checksums of the file, a continued file is not verified.
     template <typename T>
     void ContinueFrom(const std::string &name, const T *data, const std::size_t number_of_elements)
     {
@@ -296,14 +715,109 @@ class FileWriter
     {
         auto number_of_bytes = number_of_elements * sizeof(T);
 
+        if (compression == CompressLargeEntries &&
+            number_of_bytes >= detail::MIN_COMPRESSED_ENTRY_SIZE)
+        {
+            WriteCompressed(name, reinterpret_cast<const unsigned char *>(data), number_of_bytes);
+            return;
+        }
+
         auto ret = mtar_write_file_header(&handle, name.c_str(), number_of_bytes);
         detail::checkMTarError(ret, path, name);
 
         ret = mtar_write_data(&handle, reinterpret_cast<const char *>(data), number_of_bytes);
         detail::checkMTarError(ret, path, name);
+
+        WriteChecksums(
+            name, util::computeBlockCRC32C(data, number_of_bytes, detail::CHECKSUM_BLOCK_SIZE));
     }
 
   private:
+    // Compresses the blocks of an entry in parallel, the fastest level of deflate already halves
+    // the size of most graph files
+    void WriteCompressed(const std::string &name,
+                         const unsigned char *data,
+                         const std::size_t number_of_bytes)
+    {
+        const auto block_size = detail::COMPRESSION_BLOCK_SIZE;
+        detail::CompressedEntryHeader header{
+            number_of_bytes, block_size, (number_of_bytes + block_size - 1) / block_size};
+
+        std::vector<std::vector<unsigned char>> blocks(header.number_of_blocks);
+        std::vector<std::uint64_t> block_sizes(header.number_of_blocks);
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, header.number_of_blocks, 1),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                for (auto block = range.begin(); block < range.end(); ++block)
+                {
+                    const auto first = block * header.block_size;
+                    const auto size = std::min<std::uint64_t>(header.block_size,
+                                                              number_of_bytes - first);
+                    uLongf compressed_size = compressBound(size);
+                    blocks[block].resize(compressed_size);
+                    const auto ret = compress2(
+                        blocks[block].data(), &compressed_size, data + first, size, Z_BEST_SPEED);
+                    if (ret != Z_OK)
+                    {
+                        throw util::RuntimeError(path.string() + " : " + name,
+                                                 ErrorCode::FileWriteError,
+                                                 SOURCE_REF,
+                                                 "could not compress block");
+                    }
+                    blocks[block].resize(compressed_size);
+                    block_sizes[block] = compressed_size;
+                }
+            });
+
+        const auto compressed_name = name + detail::COMPRESSED_SUFFIX;
+        const auto size_of_blocks =
+            std::accumulate(block_sizes.begin(), block_sizes.end(), std::uint64_t{0});
+        auto ret = mtar_write_file_header(&handle,
+                                          compressed_name.c_str(),
+                                          sizeof(header) +
+                                              block_sizes.size() * sizeof(std::uint64_t) +
+                                              size_of_blocks);
+        detail::checkMTarError(ret, path, compressed_name);
+
+        detail::BlockChecksums checksums;
+        ret = mtar_write_data(&handle, &header, sizeof(header));
+        detail::checkMTarError(ret, path, compressed_name);
+        checksums.Add(&header, sizeof(header));
+        ret = mtar_write_data(
+            &handle, block_sizes.data(), block_sizes.size() * sizeof(std::uint64_t));
+        detail::checkMTarError(ret, path, compressed_name);
+        checksums.Add(block_sizes.data(), block_sizes.size() * sizeof(std::uint64_t));
+        for (const auto &block : blocks)
+        {
+            ret = mtar_write_data(&handle, block.data(), block.size());
+            detail::checkMTarError(ret, path, compressed_name);
+            checksums.Add(block.data(), block.size());
+        }
+
+        WriteChecksums(compressed_name, checksums.Finish());
+    }
+
+    void WriteChecksums(const std::string &name, const std::vector<std::uint32_t> &checksums)
+    {
+        const auto checksums_name = name + detail::CHECKSUMS_SUFFIX;
+        // empty entries have nothing to verify, tar headers only have room for short names
+        if (checksums.empty() || checksums_name.size() >= sizeof(mtar_header_t::name))
+            return;
+
+        const detail::ChecksumsHeader header{detail::CHECKSUM_BLOCK_SIZE, checksums.size()};
+        auto ret = mtar_write_file_header(&handle,
+                                          checksums_name.c_str(),
+                                          sizeof(header) +
+                                              checksums.size() * sizeof(std::uint32_t));
+        detail::checkMTarError(ret, path, checksums_name);
+
+        ret = mtar_write_data(&handle, &header, sizeof(header));
+        detail::checkMTarError(ret, path, checksums_name);
+        ret = mtar_write_data(
+            &handle, checksums.data(), checksums.size() * sizeof(std::uint32_t));
+        detail::checkMTarError(ret, path, checksums_name);
+    }
+
     void WriteFingerprint()
     {
         const auto fingerprint = util::FingerPrint::GetValid();
@@ -312,6 +826,7 @@ class FileWriter
 
     boost::filesystem::path path;
     mtar_t handle;
+    CompressionFlag compression;
 };
 }
 }
@@ -8,8 +8,6 @@
 #include "util/log.hpp"
 
 #include <tbb/parallel_for.h>
-#include <tbb/parallel_sort.h>
-#include <tbb/spin_mutex.h>
 
 #include <boost/exception/diagnostic_information.hpp>
 #include <boost/filesystem.hpp>
@@ -17,6 +15,12 @@
 #include <boost/spirit/include/phoenix.hpp>
 #include <boost/spirit/include/qi.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <numeric>
 #include <vector>
 
 namespace osrm
@@ -28,42 +32,67 @@ namespace updater
 // Key and Value structures must be a model of Random Access Sequence.
 // Also the Value structure must have source member that will be filled
 // with the corresponding file index in the CSV filenames vector.
+// An optional binary loader can read files of a pre-sorted binary format instead:
+// it returns false if the data is not in its format and otherwise fills the
+// entries sorted by ascending keys without duplicates.
 template <typename Key, typename Value> struct CSVFilesParser
 {
     using Iterator = boost::iostreams::mapped_file_source::iterator;
     using KeyRule = boost::spirit::qi::rule<Iterator, Key()>;
     using ValueRule = boost::spirit::qi::rule<Iterator, Value()>;
+    using Entries = std::vector<std::pair<Key, Value>>;
+    using BinaryLoader = std::function<bool(Iterator first, Iterator last, Entries &entries)>;
 
-    CSVFilesParser(std::size_t start_index, const KeyRule &key_rule, const ValueRule &value_rule)
-        : start_index(start_index), key_rule(key_rule), value_rule(value_rule)
+    // Files are split into chunks of about this size at line ends to be parsed in parallel
+    static constexpr std::size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+    // The file name that reads the values from stdin, e.g. piped from a traffic feed
+    static constexpr const char *STDIN_FILENAME = "-";
+
+    CSVFilesParser(std::size_t start_index,
+                   const KeyRule &key_rule,
+                   const ValueRule &value_rule,
+                   BinaryLoader binary_loader = {})
+        : start_index(start_index), key_rule(key_rule), value_rule(value_rule),
+          binary_loader(std::move(binary_loader))
     {
     }
 
     // Operator returns a lambda function that maps input Key to boost::optional<Value>.
     auto operator()(const std::vector<std::string> &csv_filenames) const
     {
+        if (std::count(csv_filenames.begin(), csv_filenames.end(), STDIN_FILENAME) > 1)
+        {
+            throw util::exception(std::string("Only one file can be read from stdin (") +
+                                  STDIN_FILENAME + ")" + SOURCE_REF);
+        }
+
         try
         {
-            tbb::spin_mutex mutex;
-            std::vector<std::pair<Key, Value>> lookup;
-            tbb::parallel_for(std::size_t{0},
-                              csv_filenames.size(),
-                              [&](const std::size_t idx) {
-                                  auto local = ParseCSVFile(csv_filenames[idx], start_index + idx);
-
-                                  { // Merge local CSV results into a flat global vector
-                                      tbb::spin_mutex::scoped_lock _{mutex};
-                                      lookup.insert(end(lookup),
-                                                    std::make_move_iterator(begin(local)),
-                                                    std::make_move_iterator(end(local)));
-                                  }
-                              });
-
-            // With flattened map-ish view of all the files, make a stable sort on key and source
-            // and unique them on key to keep only the value with the largest file index
-            // and the largest line number in a file.
-            // The operands order is swapped to make descending ordering on (key, source)
-            tbb::parallel_sort(begin(lookup), end(lookup), [](const auto &lhs, const auto &rhs) {
+            std::vector<Entries> file_entries(csv_filenames.size());
+            tbb::parallel_for(std::size_t{0}, csv_filenames.size(), [&](const std::size_t idx) {
+                file_entries[idx] = ParseCSVFile(csv_filenames[idx], start_index + idx);
+            });
+
+            // Every file is a run sorted descending on (key, source), so the runs of all
+            // files are merged into a flat map-ish view. Entries of the same key and source
+            // come from one file and its run keeps the entry of the largest line number first.
+            Entries lookup;
+            std::vector<std::size_t> run_offsets{0};
+            lookup.reserve(std::accumulate(
+                file_entries.begin(),
+                file_entries.end(),
+                std::size_t{0},
+                [](const std::size_t sum, const auto &entries) { return sum + entries.size(); }));
+            for (auto &entries : file_entries)
+            {
+                lookup.insert(end(lookup),
+                              std::make_move_iterator(begin(entries)),
+                              std::make_move_iterator(end(entries)));
+                run_offsets.push_back(lookup.size());
+                Entries().swap(entries);
+            }
+            MergeRuns(lookup, run_offsets, [](const auto &lhs, const auto &rhs) {
                 return std::tie(rhs.first, rhs.second.source) <
                        std::tie(lhs.first, lhs.second.source);
             });
@@ -87,42 +116,156 @@ template <typename Key, typename Value> struct CSVFilesParser
     }
 
   private:
+    static std::vector<char> ReadStream(std::istream &stream)
+    {
+        std::vector<char> buffer{std::istreambuf_iterator<char>(stream),
+                                 std::istreambuf_iterator<char>()};
+        if (stream.bad())
+            throw util::exception("Error reading the lookup values" + SOURCE_REF);
+        return buffer;
+    }
+
+    // Merges the adjacent sorted runs [run_offsets[i], run_offsets[i + 1]) pairwise in parallel
+    // until one run is left. The merge is stable, equal entries keep the order of their runs.
+    template <typename Compare>
+    static void
+    MergeRuns(Entries &entries, std::vector<std::size_t> run_offsets, const Compare &compare)
+    {
+        while (run_offsets.size() > 2)
+        {
+            const auto number_of_pairs = (run_offsets.size() - 1) / 2;
+            tbb::parallel_for(std::size_t{0}, number_of_pairs, [&](const std::size_t pair) {
+                std::inplace_merge(entries.begin() + run_offsets[2 * pair],
+                                   entries.begin() + run_offsets[2 * pair + 1],
+                                   entries.begin() + run_offsets[2 * pair + 2],
+                                   compare);
+            });
+
+            std::vector<std::size_t> merged_offsets;
+            for (std::size_t index = 0; index < run_offsets.size(); index += 2)
+            {
+                merged_offsets.push_back(run_offsets[index]);
+            }
+            if (merged_offsets.back() != run_offsets.back())
+            {
+                merged_offsets.push_back(run_offsets.back());
+            }
+            run_offsets = std::move(merged_offsets);
+        }
+    }
+
     // Parse a single CSV file and return result as a vector<Key, Value>
-    auto ParseCSVFile(const std::string &filename, std::size_t file_id) const
+    // sorted descending on the key, for equal keys the largest line number comes first
+    Entries ParseCSVFile(const std::string &filename, std::size_t file_id) const
     {
         namespace qi = boost::spirit::qi;
 
-        std::vector<std::pair<Key, Value>> result;
+        Entries result;
         try
         {
-            if (boost::filesystem::file_size(filename) == 0)
+            // Streams like "-" for stdin or a named pipe that a traffic feed writes to can not
+            // be mapped, they are read to their end into a buffer instead
+            boost::iostreams::mapped_file_source mmap;
+            std::vector<char> buffer;
+            Iterator file_begin = nullptr, file_end = nullptr;
+            if (filename == STDIN_FILENAME)
+            {
+                buffer = ReadStream(std::cin);
+            }
+            else if (!boost::filesystem::is_regular_file(filename))
+            {
+                std::ifstream stream(filename, std::ios::binary);
+                if (!stream)
+                    throw util::exception("Unable to open " + filename + SOURCE_REF);
+                buffer = ReadStream(stream);
+            }
+            else if (boost::filesystem::file_size(filename) > 0)
+            {
+                mmap.open(filename);
+                file_begin = mmap.begin();
+                file_end = mmap.end();
+            }
+            if (!buffer.empty())
+            {
+                file_begin = buffer.data();
+                file_end = buffer.data() + buffer.size();
+            }
+            if (file_begin == file_end)
                 return result;
 
-            boost::iostreams::mapped_file_source mmap(filename);
-            auto first = mmap.begin(), last = mmap.end();
-
             BOOST_ASSERT(file_id <= std::numeric_limits<std::uint8_t>::max());
+            if (binary_loader && binary_loader(file_begin, file_end, result))
+            {
+                std::reverse(result.begin(), result.end());
+                for (auto &entry : result)
+                {
+                    entry.second.source = file_id;
+                }
+                util::Log() << "Loaded " << filename << " with " << result.size() << " values";
+                return result;
+            }
+
             ValueRule value_source =
                 value_rule[qi::_val = qi::_1, bind(&Value::source, qi::_val) = file_id];
             qi::rule<Iterator, std::pair<Key, Value>()> csv_line =
                 (key_rule >> ',' >> value_source) >> -(',' >> *(qi::char_ - qi::eol));
-            const auto ok = qi::parse(first, last, -(csv_line % qi::eol) >> *qi::eol, result);
 
-            if (!ok || first != last)
+            // Split the file after line ends, so that every chunk holds complete lines
+            std::vector<Iterator> chunk_begins{file_begin};
+            while (file_end - chunk_begins.back() > static_cast<std::ptrdiff_t>(CHUNK_SIZE))
             {
-                auto begin_of_line = first - 1;
-                while (begin_of_line >= mmap.begin() && *begin_of_line != '\n')
-                    --begin_of_line;
-                auto line_number = std::count(mmap.begin(), first, '\n') + 1;
-                const auto message = boost::format("CSV file %1% malformed on line %2%:\n %3%\n") %
-                                     filename % std::to_string(line_number) %
-                                     std::string(begin_of_line + 1, std::find(first, last, '\n'));
-                throw util::exception(message.str() + SOURCE_REF);
+                const auto line_end = std::find(chunk_begins.back() + CHUNK_SIZE, file_end, '\n');
+                if (line_end == file_end)
+                    break;
+                chunk_begins.push_back(line_end + 1);
             }
+            chunk_begins.push_back(file_end);
+
+            // Every chunk is parsed into a run sorted descending on the key. The runs are
+            // stored from the last to the first chunk for the line numbers precedence.
+            const auto number_of_chunks = chunk_begins.size() - 1;
+            std::vector<Entries> chunk_entries(number_of_chunks);
+            tbb::parallel_for(std::size_t{0}, number_of_chunks, [&](const std::size_t chunk) {
+                auto first = chunk_begins[chunk], last = chunk_begins[chunk + 1];
+                auto &entries = chunk_entries[number_of_chunks - chunk - 1];
+                const auto ok = qi::parse(first, last, -(csv_line % qi::eol) >> *qi::eol, entries);
 
-            util::Log() << "Loaded " << filename << " with " << result.size() << "values";
+                if (!ok || first != last)
+                {
+                    auto begin_of_line = first - 1;
+                    while (begin_of_line >= file_begin && *begin_of_line != '\n')
+                        --begin_of_line;
+                    auto line_number = std::count(file_begin, first, '\n') + 1;
+                    const auto message =
+                        boost::format("CSV file %1% malformed on line %2%:\n %3%\n") % filename %
+                        std::to_string(line_number) %
+                        std::string(begin_of_line + 1, std::find(first, file_end, '\n'));
+                    throw util::exception(message.str() + SOURCE_REF);
+                }
 
-            return std::move(result);
+                std::reverse(entries.begin(), entries.end());
+                std::stable_sort(
+                    entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+                        return rhs.first < lhs.first;
+                    });
+            });
+
+            std::vector<std::size_t> run_offsets{0};
+            for (auto &entries : chunk_entries)
+            {
+                result.insert(end(result),
+                              std::make_move_iterator(begin(entries)),
+                              std::make_move_iterator(end(entries)));
+                run_offsets.push_back(result.size());
+                Entries().swap(entries);
+            }
+            MergeRuns(result, run_offsets, [](const auto &lhs, const auto &rhs) {
+                return rhs.first < lhs.first;
+            });
+
+            util::Log() << "Loaded " << filename << " with " << result.size() << " values";
+
+            return result;
         }
         catch (const boost::exception &e)
         {
@@ -135,7 +278,11 @@ template <typename Key, typename Value> struct CSVFilesParser
     const std::size_t start_index;
     const KeyRule key_rule;
     const ValueRule value_rule;
+    const BinaryLoader binary_loader;
 };
+
+template <typename Key, typename Value>
+constexpr const char *CSVFilesParser<Key, Value>::STDIN_FILENAME;
 }
 }
 
@@ -3,13 +3,23 @@
 
 #include "updater/source.hpp"
 
+#include <string>
+#include <vector>
+
 namespace osrm
 {
 namespace updater
 {
 namespace csv
 {
+// Reads the segment speeds of CSV files or of binary files written by writeSegmentValues
 SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths);
+
+// Writes the segment speeds into a binary file that is loaded without parsing.
+// The little-endian file starts with the 8 bytes "OSRMSPD1" and the 64 bit number of records,
+// followed by the records of 32 bytes sorted by ascending (from, to) without duplicates:
+// uint64 from, uint64 to, uint32 speed, uint32 1 if the rate is given else 0, double rate.
+void writeSegmentValues(const std::string &path, const SegmentLookupTable &table);
 TurnLookupTable readTurnValues(const std::vector<std::string> &paths);
 }
 }
@@ -3,8 +3,17 @@
 
 #include "util/typedefs.hpp"
 
+#include <boost/assert.hpp>
 #include <boost/optional.hpp>
 
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
 #include <vector>
 
 namespace osrm
@@ -12,11 +21,32 @@ namespace osrm
 namespace updater
 {
 
+// Finalizer of splitmix64 to spread the bits of packed node IDs
+inline std::uint64_t mixHash(std::uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
 template <typename Key, typename Value> struct LookupTable
 {
     boost::optional<Value> operator()(const Key &key) const
     {
         using Result = boost::optional<Value>;
+        if (!index.empty())
+        {
+            const auto mask = index.size() - 1;
+            for (auto slot = hashKey(key) & mask; index[slot] != EMPTY_SLOT;
+                 slot = (slot + 1) & mask)
+            {
+                const auto &entry = lookup[index[slot]];
+                if (entry.first == key)
+                    return Result(entry.second);
+            }
+            return Result();
+        }
+
         const auto it = std::lower_bound(
             lookup.begin(), lookup.end(), key, [](const auto &lhs, const auto &rhs) {
                 return rhs < lhs.first;
@@ -24,7 +54,44 @@ template <typename Key, typename Value> struct LookupTable
         return it != std::end(lookup) && !(it->first < key) ? Result(it->second) : Result();
     }
 
+    // Builds an open addressed hash index with linear probing over the unique keys of lookup,
+    // so that the lookups take constant time instead of a binary search over all entries.
+    void BuildIndex()
+    {
+        BOOST_ASSERT(lookup.size() < EMPTY_SLOT);
+        // at most half of the slots are used to keep the probe sequences short
+        std::size_t number_of_slots = 1;
+        while (number_of_slots < 2 * lookup.size())
+            number_of_slots *= 2;
+        const auto mask = number_of_slots - 1;
+
+        std::unique_ptr<std::atomic<std::uint32_t>[]> slots(
+            new std::atomic<std::uint32_t>[number_of_slots]);
+        tbb::parallel_for(std::size_t{0}, number_of_slots, [&](const std::size_t slot) {
+            slots[slot].store(EMPTY_SLOT, std::memory_order_relaxed);
+        });
+        tbb::parallel_for(std::size_t{0}, lookup.size(), [&](const std::size_t entry) {
+            for (auto slot = hashKey(lookup[entry].first) & mask;; slot = (slot + 1) & mask)
+            {
+                auto expected = EMPTY_SLOT;
+                if (slots[slot].compare_exchange_strong(
+                        expected, static_cast<std::uint32_t>(entry), std::memory_order_relaxed))
+                    break;
+            }
+        });
+
+        index.resize(number_of_slots);
+        tbb::parallel_for(std::size_t{0}, number_of_slots, [&](const std::size_t slot) {
+            index[slot] = slots[slot].load(std::memory_order_relaxed);
+        });
+    }
+
     std::vector<std::pair<Key, Value>> lookup;
+    // slots of the hash index that hold the positions in lookup, empty if not built
+    std::vector<std::uint32_t> index;
+
+  private:
+    static constexpr std::uint32_t EMPTY_SLOT = std::numeric_limits<std::uint32_t>::max();
 };
 
 struct Segment final
@@ -86,6 +153,17 @@ struct PenaltySource final
     std::uint8_t source;
 };
 
+inline std::uint64_t hashKey(const Segment &segment)
+{
+    return mixHash(segment.from * 0x9e3779b97f4a7c15ull ^ segment.to);
+}
+
+inline std::uint64_t hashKey(const Turn &turn)
+{
+    return mixHash((turn.from * 0x9e3779b97f4a7c15ull ^ turn.via) * 0x9e3779b97f4a7c15ull ^
+                   turn.to);
+}
+
 using SegmentLookupTable = LookupTable<Segment, SpeedSource>;
 using TurnLookupTable = LookupTable<Turn, PenaltySource>;
 }
@@ -26,6 +26,14 @@ class Updater
                                    std::vector<EdgeWeight> &node_weights,
                                    std::uint32_t &connectivity_checksum) const;
 
+    // False if no lookup file or conditional restriction changes the weights of the .osrm.ebg
+    // graph, callers can then use the graph of the file as it is
+    bool HasUpdates() const;
+
+    // Names the data sources of a graph that is used without updates, like
+    // LoadAndUpdateEdgeExpandedGraph does in that case
+    void SaveDatasourcesNames() const;
+
   private:
     UpdaterConfig config;
 };
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <boost/assert.hpp>
 #include <cmath>
+#include <cstdint>
 #include <string>
 
 namespace osrm
@@ -92,6 +93,28 @@ inline bool CheckInBounds(const int A, const int B, const int range)
     }
 }
 
+// Bearings are summarized in 32 sectors of 11.25 degrees, e.g. for the segments below a node of
+// the r-tree. Bit i of a mask is set for the bearings from i * 11.25 up to (i + 1) * 11.25.
+const constexpr std::uint32_t ALL_SECTORS = 0xffffffff;
+
+inline std::uint32_t sectorMask(const int bearing)
+{
+    const int normalized = ((bearing % 360) + 360) % 360;
+    return 1u << (normalized * 32 / 360);
+}
+
+// The sectors of all bearings A that CheckInBounds(A, bearing, range) accepts
+inline std::uint32_t sectorMask(const int bearing, const int range)
+{
+    if (range >= 180)
+        return ALL_SECTORS;
+
+    std::uint32_t sectors = 0;
+    for (int offset = -range; offset <= range; ++offset)
+        sectors |= sectorMask(bearing + offset);
+    return sectors;
+}
+
 inline double reverse(const double bearing)
 {
     if (bearing >= 180)
@@ -0,0 +1,260 @@
+#ifndef OSRM_UTIL_BLOCK_COMPRESSED_VECTOR_HPP
+#define OSRM_UTIL_BLOCK_COMPRESSED_VECTOR_HPP
+
+#include "util/vector_view.hpp"
+
+#include "storage/shared_memory_ownership.hpp"
+#include "storage/tar_fwd.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+namespace detail
+{
+template <typename T, storage::Ownership Ownership> class BlockCompressedVector;
+}
+
+namespace serialization
+{
+template <typename T, storage::Ownership Ownership>
+inline void read(storage::tar::FileReader &reader,
+                 const std::string &name,
+                 detail::BlockCompressedVector<T, Ownership> &vec);
+
+template <typename T, storage::Ownership Ownership>
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const detail::BlockCompressedVector<T, Ownership> &vec);
+}
+
+namespace detail
+{
+
+// The values of a block: its smallest value and where its deltas start in the packed words
+struct CompressedBlockHeader
+{
+    std::uint32_t base;
+    std::uint32_t word_offset;
+    std::uint8_t bits;
+    std::uint8_t unused[3];
+};
+static_assert(sizeof(CompressedBlockHeader) == 12, "CompressedBlockHeader is not packed");
+
+/**
+ * Read-only vector of unsigned 32 bit values that are close to their neighbours, like the node ids
+ * of consecutive geometries.
+ *
+ * Every block of BLOCK_ELEMENTS values stores the deltas of the values to the smallest value of
+ * the block with the number of bits that the largest delta of the block needs. Any value is
+ * decoded from the header of its block and at most two packed words, without decoding the values
+ * in front of it.
+ */
+template <typename T, storage::Ownership Ownership> class BlockCompressedVector
+{
+    static_assert(std::is_unsigned<T>::value && sizeof(T) <= sizeof(std::uint32_t),
+                  "Only unsigned values of up to 32 bits are supported");
+
+    using WordT = std::uint64_t;
+    static constexpr std::size_t WORD_BITS = sizeof(WordT) * CHAR_BIT;
+
+  public:
+    static constexpr std::size_t BLOCK_ELEMENTS = 32;
+
+    using value_type = T;
+    using header_type = CompressedBlockHeader;
+    using block_type = WordT;
+
+    class const_iterator
+        : public boost::iterator_facade<const_iterator,
+                                        const T,
+                                        boost::random_access_traversal_tag,
+                                        T>
+    {
+        using base_t = boost::
+            iterator_facade<const_iterator, const T, boost::random_access_traversal_tag, T>;
+
+      public:
+        using difference_type = typename base_t::difference_type;
+        typedef std::random_access_iterator_tag iterator_category;
+
+        const_iterator() : container(nullptr), index(std::numeric_limits<std::size_t>::max()) {}
+        const_iterator(const BlockCompressedVector *container, const std::size_t index)
+            : container(container), index(index)
+        {
+        }
+
+      private:
+        void increment() { ++index; }
+        void decrement() { --index; }
+        void advance(difference_type offset) { index += offset; }
+        bool equal(const const_iterator &other) const { return index == other.index; }
+        T dereference() const { return (*container)[index]; }
+        difference_type distance_to(const const_iterator &other) const
+        {
+            return other.index - index;
+        }
+
+        const BlockCompressedVector *container;
+        std::size_t index;
+
+        friend class ::boost::iterator_core_access;
+    };
+    using iterator = const_iterator;
+
+    BlockCompressedVector() = default;
+
+    template <bool enabled = (Ownership == storage::Ownership::Container)>
+    explicit BlockCompressedVector(const std::vector<T> &values,
+                                   typename std::enable_if<enabled>::type * = 0)
+        : num_elements(values.size())
+    {
+        const auto num_blocks = (values.size() + BLOCK_ELEMENTS - 1) / BLOCK_ELEMENTS;
+        headers.reserve(num_blocks);
+        for (std::size_t first = 0; first < values.size(); first += BLOCK_ELEMENTS)
+        {
+            const auto last = std::min(first + BLOCK_ELEMENTS, values.size());
+            const auto minmax =
+                std::minmax_element(values.begin() + first, values.begin() + last);
+            const std::uint32_t base = *minmax.first;
+            const std::uint32_t max_delta = *minmax.second - base;
+
+            std::uint8_t bits = 0;
+            while (bits < 32 && (max_delta >> bits) > 0)
+                ++bits;
+
+            BOOST_ASSERT(words.size() <= std::numeric_limits<std::uint32_t>::max());
+            headers.push_back({base, static_cast<std::uint32_t>(words.size()), bits, {0, 0, 0}});
+
+            // a block is stored as a whole number of words, the last block is padded
+            const auto block_size = (BLOCK_ELEMENTS * bits + WORD_BITS - 1) / WORD_BITS;
+            words.resize(words.size() + block_size);
+            auto block_words = words.end() - block_size;
+            for (std::size_t index = first; bits > 0 && index < last; ++index)
+            {
+                const WordT delta = values[index] - base;
+                const auto bit = (index - first) * bits;
+                block_words[bit / WORD_BITS] |= delta << (bit % WORD_BITS);
+                if (bit % WORD_BITS + bits > WORD_BITS)
+                {
+                    block_words[bit / WORD_BITS + 1] |= delta >> (WORD_BITS - bit % WORD_BITS);
+                }
+            }
+        }
+    }
+
+    BlockCompressedVector(util::ViewOrVector<header_type, Ownership> headers_,
+                          util::ViewOrVector<WordT, Ownership> words_,
+                          std::size_t num_elements)
+        : headers(std::move(headers_)), words(std::move(words_)), num_elements(num_elements)
+    {
+    }
+
+    T operator[](const std::size_t index) const
+    {
+        BOOST_ASSERT(index < num_elements);
+        const auto &header = headers[index / BLOCK_ELEMENTS];
+        if (header.bits == 0)
+        {
+            return static_cast<T>(header.base);
+        }
+
+        const auto bit = (index % BLOCK_ELEMENTS) * header.bits;
+        const auto word = header.word_offset + bit / WORD_BITS;
+        const auto offset = bit % WORD_BITS;
+        WordT delta = words[word] >> offset;
+        if (offset + header.bits > WORD_BITS)
+        {
+            delta |= words[word + 1] << (WORD_BITS - offset);
+        }
+        delta &= (WordT{1} << header.bits) - 1;
+        return static_cast<T>(header.base + delta);
+    }
+
+    // Decodes the values [first, last) in order, the header of each block is read once
+    template <typename OutputIter>
+    OutputIter unpack(const std::size_t first, const std::size_t last, OutputIter out) const
+    {
+        BOOST_ASSERT(first <= last && last <= num_elements);
+        for (auto block_first = first; block_first < last;)
+        {
+            const auto block = block_first / BLOCK_ELEMENTS;
+            const auto block_last = std::min(last, (block + 1) * BLOCK_ELEMENTS);
+            const auto &header = headers[block];
+            if (header.bits == 0)
+            {
+                out = std::fill_n(out, block_last - block_first, static_cast<T>(header.base));
+            }
+            else
+            {
+                const WordT mask = (WordT{1} << header.bits) - 1;
+                for (auto index = block_first; index < block_last; ++index)
+                {
+                    const auto bit = (index % BLOCK_ELEMENTS) * header.bits;
+                    const auto word = header.word_offset + bit / WORD_BITS;
+                    const auto offset = bit % WORD_BITS;
+                    WordT delta = words[word] >> offset;
+                    if (offset + header.bits > WORD_BITS)
+                        delta |= words[word + 1] << (WORD_BITS - offset);
+                    *out++ = static_cast<T>(header.base + (delta & mask));
+                }
+            }
+            block_first = block_last;
+        }
+        return out;
+    }
+
+    T at(const std::size_t index) const
+    {
+        if (index >= num_elements)
+            throw std::out_of_range(std::to_string(index) + " is bigger then container size " +
+                                    std::to_string(num_elements));
+        return operator[](index);
+    }
+
+    auto begin() const { return const_iterator(this, 0); }
+    auto end() const { return const_iterator(this, num_elements); }
+    auto cbegin() const { return const_iterator(this, 0); }
+    auto cend() const { return const_iterator(this, num_elements); }
+
+    T front() const { return operator[](0); }
+    T back() const { return operator[](num_elements - 1); }
+
+    std::size_t size() const { return num_elements; }
+    bool empty() const { return num_elements == 0; }
+
+    friend void serialization::read<T, Ownership>(storage::tar::FileReader &reader,
+                                                  const std::string &name,
+                                                  BlockCompressedVector &vec);
+
+    friend void serialization::write<T, Ownership>(storage::tar::FileWriter &writer,
+                                                   const std::string &name,
+                                                   const BlockCompressedVector &vec);
+
+  private:
+    util::ViewOrVector<header_type, Ownership> headers;
+    util::ViewOrVector<WordT, Ownership> words;
+    std::uint64_t num_elements = 0;
+};
+}
+
+template <typename T>
+using BlockCompressedVector = detail::BlockCompressedVector<T, storage::Ownership::Container>;
+template <typename T>
+using BlockCompressedVectorView = detail::BlockCompressedVector<T, storage::Ownership::View>;
+}
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef OSRM_UTIL_BLOCK_POOL_HPP
+#define OSRM_UTIL_BLOCK_POOL_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * Pool of the fixed size blocks that the large edge containers of the preprocessing tools are
+ * made of, like the buckets of DeallocatingVector and the slabs of the contractor graph.
+ *
+ * The blocks are mapped from the OS directly instead of being taken from the heap, so freeing
+ * them never leaves holes in the heap that can't be given back. Blocks that are freed are kept
+ * for the next container that grows, Trim returns them to the OS once a tool is done with a phase
+ * that needed them. Pages of a block that are never written don't take up any memory.
+ *
+ * The pool is shared by all threads. Blocks are big enough that a lock per block costs nothing,
+ * and blocks freed by one thread can be used by all others.
+ */
+class BlockPool
+{
+  public:
+    static constexpr std::size_t BLOCK_SIZE = 8 * 1024 * 1024;
+
+    static BlockPool &GetInstance();
+
+    // Returns a block of BLOCK_SIZE bytes, throws std::bad_alloc if the OS has no memory left
+    void *Allocate();
+
+    // Keeps the block for the next allocation
+    void Deallocate(void *block);
+
+    // Returns all blocks that are not in use to the OS
+    void Trim();
+
+    std::size_t NumberOfFreeBlocks() const;
+
+    BlockPool(const BlockPool &) = delete;
+    BlockPool &operator=(const BlockPool &) = delete;
+
+  private:
+    BlockPool() = default;
+    ~BlockPool();
+
+    mutable std::mutex mutex;
+    std::vector<void *> free_blocks;
+};
+}
+}
+
+#endif
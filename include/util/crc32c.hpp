@@ -0,0 +1,38 @@
+#ifndef OSRM_UTIL_CRC32C_HPP
+#define OSRM_UTIL_CRC32C_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * CRC-32C (Castagnoli) checksums of the data files.
+ *
+ * On x86-64 CPUs with SSE 4.2 the checksums are computed with the crc32 instruction, elsewhere
+ * with a lookup table. Both give the same checksums, so files can be checked on other machines
+ * than the ones that wrote them.
+ */
+
+// Whether the checksums are computed by the CPU
+bool hasHardwareCRC32C();
+
+// Continues the checksum of the bytes before the data, 0 for the first bytes
+std::uint32_t updateCRC32C(std::uint32_t crc, const void *data, std::size_t size);
+
+inline std::uint32_t computeCRC32C(const void *data, std::size_t size)
+{
+    return updateCRC32C(0, data, size);
+}
+
+// The checksum of every block of block_size bytes of the data, computed in parallel
+std::vector<std::uint32_t>
+computeBlockCRC32C(const void *data, std::size_t size, std::size_t block_size);
+}
+}
+
+#endif
@@ -2,12 +2,15 @@
 #define DEALLOCATING_VECTOR_HPP
 
 #include "storage/io_fwd.hpp"
+#include "util/block_pool.hpp"
 #include "util/integer_range.hpp"
 
 #include <boost/iterator/iterator_facade.hpp>
 
 #include <algorithm>
 #include <limits>
+#include <new>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -170,12 +173,36 @@ template <typename ElementT> class DeallocatingVector;
 
 template <typename T> void swap(DeallocatingVector<T> &lhs, DeallocatingVector<T> &rhs);
 
+// The buckets are blocks of the util::BlockPool, so that vectors that are freed give their memory
+// to the next vector that grows instead of fragmenting the heap until the pool is trimmed.
 template <typename ElementT> class DeallocatingVector
 {
-    static constexpr std::size_t ELEMENTS_PER_BLOCK = 8388608 / sizeof(ElementT);
+    static constexpr std::size_t ELEMENTS_PER_BLOCK = BlockPool::BLOCK_SIZE / sizeof(ElementT);
     std::size_t current_size;
     std::vector<ElementT *> bucket_list;
 
+    static ElementT *allocateBucket()
+    {
+        auto bucket = static_cast<ElementT *>(BlockPool::GetInstance().Allocate());
+        for (const auto index : irange<std::size_t>(0, ELEMENTS_PER_BLOCK))
+        {
+            new (bucket + index) ElementT;
+        }
+        return bucket;
+    }
+
+    static void deallocateBucket(ElementT *bucket)
+    {
+        if (!std::is_trivially_destructible<ElementT>::value)
+        {
+            for (const auto index : irange<std::size_t>(0, ELEMENTS_PER_BLOCK))
+            {
+                bucket[index].~ElementT();
+            }
+        }
+        BlockPool::GetInstance().Deallocate(bucket);
+    }
+
   public:
     using value_type = ElementT;
     using iterator = DeallocatingVectorIterator<ElementT, ELEMENTS_PER_BLOCK>;
@@ -183,7 +210,7 @@ template <typename ElementT> class DeallocatingVector
 
     DeallocatingVector() : current_size(0)
     {
-        bucket_list.emplace_back(new ElementT[ELEMENTS_PER_BLOCK]);
+        bucket_list.emplace_back(allocateBucket());
     }
 
     // Performs a deep copy of the buckets
@@ -192,7 +219,7 @@ template <typename ElementT> class DeallocatingVector
         bucket_list.resize(other.bucket_list.size());
         for (const auto index : util::irange<std::size_t>(0, bucket_list.size()))
         {
-            bucket_list[index] = new ElementT[ELEMENTS_PER_BLOCK];
+            bucket_list[index] = allocateBucket();
             std::copy_n(other.bucket_list[index], ELEMENTS_PER_BLOCK, bucket_list[index]);
         }
         current_size = other.current_size;
@@ -238,8 +265,7 @@ template <typename ElementT> class DeallocatingVector
         {
             if (nullptr != bucket)
             {
-                delete[] bucket;
-                bucket = nullptr;
+                deallocateBucket(bucket);
             }
         }
         bucket_list.clear();
@@ -252,7 +278,7 @@ template <typename ElementT> class DeallocatingVector
         const std::size_t current_capacity = capacity();
         if (current_size == current_capacity)
         {
-            bucket_list.push_back(new ElementT[ELEMENTS_PER_BLOCK]);
+            bucket_list.push_back(allocateBucket());
         }
 
         std::size_t current_index = size() % ELEMENTS_PER_BLOCK;
@@ -265,7 +291,7 @@ template <typename ElementT> class DeallocatingVector
         const std::size_t current_capacity = capacity();
         if (current_size == current_capacity)
         {
-            bucket_list.push_back(new ElementT[ELEMENTS_PER_BLOCK]);
+            bucket_list.push_back(allocateBucket());
         }
 
         const std::size_t current_index = size() % ELEMENTS_PER_BLOCK;
@@ -281,7 +307,7 @@ template <typename ElementT> class DeallocatingVector
         {
             while (capacity() < new_size)
             {
-                bucket_list.push_back(new ElementT[ELEMENTS_PER_BLOCK]);
+                bucket_list.push_back(allocateBucket());
             }
         }
         else
@@ -291,7 +317,7 @@ template <typename ElementT> class DeallocatingVector
             {
                 if (nullptr != bucket_list[bucket_index])
                 {
-                    delete[] bucket_list[bucket_index];
+                    deallocateBucket(bucket_list[bucket_index]);
                 }
             }
             bucket_list.resize(number_of_necessary_buckets);
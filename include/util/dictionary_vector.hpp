@@ -0,0 +1,227 @@
+#ifndef OSRM_UTIL_DICTIONARY_VECTOR_HPP
+#define OSRM_UTIL_DICTIONARY_VECTOR_HPP
+
+#include "util/vector_view.hpp"
+
+#include "storage/shared_memory_ownership.hpp"
+#include "storage/tar_fwd.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+namespace detail
+{
+template <typename T, storage::Ownership Ownership> class DictionaryVector;
+}
+
+namespace serialization
+{
+template <typename T, storage::Ownership Ownership>
+inline void read(storage::tar::FileReader &reader,
+                 const std::string &name,
+                 detail::DictionaryVector<T, Ownership> &vec);
+
+template <typename T, storage::Ownership Ownership>
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const detail::DictionaryVector<T, Ownership> &vec);
+}
+
+namespace detail
+{
+
+/**
+ * Read-only vector of integral values of which only a few are distinct, like the turn penalties
+ * that are zero for most turns and one of a few values for the others.
+ *
+ * The MAX_DICTIONARY_SIZE most frequent values are stored once in a dictionary and every element
+ * by the one byte code of its value. The elements of the remaining values have the code ESCAPE,
+ * their values are found with a binary search in a table of exceptions ordered by the index of
+ * the element.
+ */
+template <typename T, storage::Ownership Ownership> class DictionaryVector
+{
+    static_assert(std::is_integral<T>::value, "Only integral values are supported");
+
+  public:
+    using value_type = T;
+    using code_type = std::uint8_t;
+    using index_type = std::uint32_t;
+
+    static constexpr code_type ESCAPE = std::numeric_limits<code_type>::max();
+    static constexpr std::size_t MAX_DICTIONARY_SIZE = ESCAPE;
+
+    class const_iterator
+        : public boost::iterator_facade<const_iterator,
+                                        const T,
+                                        boost::random_access_traversal_tag,
+                                        T>
+    {
+        using base_t = boost::
+            iterator_facade<const_iterator, const T, boost::random_access_traversal_tag, T>;
+
+      public:
+        using difference_type = typename base_t::difference_type;
+        typedef std::random_access_iterator_tag iterator_category;
+
+        const_iterator() : container(nullptr), index(std::numeric_limits<std::size_t>::max()) {}
+        const_iterator(const DictionaryVector *container, const std::size_t index)
+            : container(container), index(index)
+        {
+        }
+
+      private:
+        void increment() { ++index; }
+        void decrement() { --index; }
+        void advance(difference_type offset) { index += offset; }
+        bool equal(const const_iterator &other) const { return index == other.index; }
+        T dereference() const { return (*container)[index]; }
+        difference_type distance_to(const const_iterator &other) const
+        {
+            return other.index - index;
+        }
+
+        const DictionaryVector *container;
+        std::size_t index;
+
+        friend class ::boost::iterator_core_access;
+    };
+    using iterator = const_iterator;
+
+    DictionaryVector() = default;
+
+    template <bool enabled = (Ownership == storage::Ownership::Container)>
+    explicit DictionaryVector(const std::vector<T> &values,
+                              typename std::enable_if<enabled>::type * = 0)
+    {
+        BOOST_ASSERT(values.size() <= std::numeric_limits<index_type>::max());
+
+        std::unordered_map<T, std::size_t> frequencies;
+        for (const auto value : values)
+            ++frequencies[value];
+
+        // the most frequent values first, equally frequent ones by their value to write the same
+        // file for the same values
+        std::vector<std::pair<T, std::size_t>> by_frequency(frequencies.begin(),
+                                                            frequencies.end());
+        std::sort(by_frequency.begin(), by_frequency.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+        });
+        by_frequency.resize(std::min(by_frequency.size(), MAX_DICTIONARY_SIZE));
+
+        std::unordered_map<T, code_type> value_codes;
+        for (const auto &value : by_frequency)
+        {
+            value_codes[value.first] = static_cast<code_type>(dictionary.size());
+            dictionary.push_back(value.first);
+        }
+
+        codes.resize(values.size());
+        for (std::size_t index = 0; index < values.size(); ++index)
+        {
+            const auto code = value_codes.find(values[index]);
+            if (code != value_codes.end())
+            {
+                codes[index] = code->second;
+            }
+            else
+            {
+                codes[index] = ESCAPE;
+                exception_indices.push_back(static_cast<index_type>(index));
+                exception_values.push_back(values[index]);
+            }
+        }
+    }
+
+    DictionaryVector(util::ViewOrVector<T, Ownership> dictionary_,
+                     util::ViewOrVector<code_type, Ownership> codes_,
+                     util::ViewOrVector<index_type, Ownership> exception_indices_,
+                     util::ViewOrVector<T, Ownership> exception_values_)
+        : dictionary(std::move(dictionary_)), codes(std::move(codes_)),
+          exception_indices(std::move(exception_indices_)),
+          exception_values(std::move(exception_values_))
+    {
+        BOOST_ASSERT(exception_indices.size() == exception_values.size());
+    }
+
+    T operator[](const std::size_t index) const
+    {
+        BOOST_ASSERT(index < codes.size());
+        const auto code = codes[index];
+        if (code != ESCAPE)
+        {
+            BOOST_ASSERT(code < dictionary.size());
+            return dictionary[code];
+        }
+
+        const auto exception =
+            std::lower_bound(exception_indices.begin(), exception_indices.end(), index);
+        BOOST_ASSERT(exception != exception_indices.end() && *exception == index);
+        return exception_values[std::distance(exception_indices.begin(), exception)];
+    }
+
+    T at(const std::size_t index) const
+    {
+        if (index >= codes.size())
+            throw std::out_of_range(std::to_string(index) + " is bigger then container size " +
+                                    std::to_string(codes.size()));
+        return operator[](index);
+    }
+
+    auto begin() const { return const_iterator(this, 0); }
+    auto end() const { return const_iterator(this, codes.size()); }
+    auto cbegin() const { return const_iterator(this, 0); }
+    auto cend() const { return const_iterator(this, codes.size()); }
+
+    T front() const { return operator[](0); }
+    T back() const { return operator[](codes.size() - 1); }
+
+    std::size_t size() const { return codes.size(); }
+    bool empty() const { return codes.empty(); }
+
+    // The values that are not in the dictionary
+    std::size_t number_of_exceptions() const { return exception_indices.size(); }
+
+    friend void serialization::read<T, Ownership>(storage::tar::FileReader &reader,
+                                                  const std::string &name,
+                                                  DictionaryVector &vec);
+
+    friend void serialization::write<T, Ownership>(storage::tar::FileWriter &writer,
+                                                   const std::string &name,
+                                                   const DictionaryVector &vec);
+
+  private:
+    util::ViewOrVector<T, Ownership> dictionary;
+    util::ViewOrVector<code_type, Ownership> codes;
+    util::ViewOrVector<index_type, Ownership> exception_indices;
+    util::ViewOrVector<T, Ownership> exception_values;
+};
+
+template <typename T, storage::Ownership Ownership>
+constexpr typename DictionaryVector<T, Ownership>::code_type DictionaryVector<T, Ownership>::ESCAPE;
+template <typename T, storage::Ownership Ownership>
+constexpr std::size_t DictionaryVector<T, Ownership>::MAX_DICTIONARY_SIZE;
+}
+
+template <typename T>
+using DictionaryVector = detail::DictionaryVector<T, storage::Ownership::Container>;
+template <typename T>
+using DictionaryVectorView = detail::DictionaryVector<T, storage::Ownership::View>;
+}
+}
+
+#endif
@@ -8,6 +8,9 @@
 
 #include <boost/assert.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include <cstdint>
 
 #include <algorithm>
@@ -316,6 +319,46 @@ template <typename EdgeDataT> class DynamicGraph
         return EdgeIterator(node.first_edge + node.edges);
     }
 
+    // makes room for count edges directly after the edges of a node. Until they are inserted
+    // InsertEdge neither moves edges nor writes outside the node, so that edges of different
+    // nodes can be inserted in parallel. Invalidates edge iterators for the node
+    void ReserveEdges(const NodeIterator from, const EdgeIterator count)
+    {
+        Node &node = node_array[from];
+        const EdgeIterator one_beyond_last_of_node = node.first_edge + node.edges;
+        EdgeIterator free_edges = 0;
+        while (free_edges < count && one_beyond_last_of_node + free_edges < edge_list.size() &&
+               isDummy(one_beyond_last_of_node + free_edges))
+        {
+            ++free_edges;
+        }
+        if (free_edges == count)
+        {
+            return;
+        }
+
+        // move this nodes edges to the end of the edge_list
+        EdgeIterator newFirstEdge = (EdgeIterator)edge_list.size();
+        unsigned newSize = std::max<unsigned>(node.edges * 1.1 + 2, node.edges + count);
+        EdgeIterator requiredCapacity = newSize + edge_list.size();
+        EdgeIterator oldCapacity = edge_list.capacity();
+        if (requiredCapacity >= oldCapacity)
+        {
+            edge_list.reserve(requiredCapacity * 1.1);
+        }
+        edge_list.resize(edge_list.size() + newSize);
+        for (const auto i : irange(0u, node.edges))
+        {
+            edge_list[newFirstEdge + i] = edge_list[node.first_edge + i];
+            makeDummy(node.first_edge + i);
+        }
+        for (const auto i : irange(node.edges, newSize))
+        {
+            makeDummy(newFirstEdge + i);
+        }
+        node.first_edge = newFirstEdge;
+    }
+
     // removes an edge. Invalidates edge iterators for the source node
     void DeleteEdge(const NodeIterator source, const EdgeIterator e)
     {
@@ -408,26 +451,36 @@ template <typename EdgeDataT> class DynamicGraph
     void Renumber(const std::vector<NodeID> &old_to_new_node)
     {
         // permutate everything but the sentinel
-        util::inplacePermutation(node_array.begin(), node_array.end(), old_to_new_node);
+        util::parallelPermutation(node_array.begin(), node_array.end(), old_to_new_node);
 
-        // Build up edge permutation
-        auto new_edge_index = 0;
-        std::vector<EdgeID> old_to_new_edge(edge_list.size(), SPECIAL_EDGEID);
+        // Build up edge permutation, the edges of a node follow the edges of the nodes before it
+        std::vector<EdgeIterator> new_first_edges(number_of_nodes + 1, 0);
         for (auto node : util::irange<NodeID>(0, number_of_nodes))
         {
-            auto new_first_edge = new_edge_index;
-            // move all filled edges
-            for (auto edge : GetAdjacentEdgeRange(node))
-            {
-                edge_list[edge].target = old_to_new_node[edge_list[edge].target];
-                BOOST_ASSERT(edge_list[edge].target != SPECIAL_NODEID);
-                old_to_new_edge[edge] = new_edge_index++;
-            }
-            node_array[node].first_edge = new_first_edge;
+            new_first_edges[node + 1] = new_first_edges[node] + node_array[node].edges;
         }
-        auto number_of_valid_edges = new_edge_index;
+        const auto number_of_valid_edges = new_first_edges.back();
+
+        std::vector<EdgeID> old_to_new_edge(edge_list.size(), SPECIAL_EDGEID);
+        tbb::parallel_for(tbb::blocked_range<NodeIterator>(0, number_of_nodes),
+                          [&](const tbb::blocked_range<NodeIterator> &range) {
+                              for (auto node = range.begin(); node != range.end(); ++node)
+                              {
+                                  // move all filled edges
+                                  auto new_edge_index = new_first_edges[node];
+                                  for (auto edge : GetAdjacentEdgeRange(node))
+                                  {
+                                      edge_list[edge].target =
+                                          old_to_new_node[edge_list[edge].target];
+                                      BOOST_ASSERT(edge_list[edge].target != SPECIAL_NODEID);
+                                      old_to_new_edge[edge] = new_edge_index++;
+                                  }
+                                  node_array[node].first_edge = new_first_edges[node];
+                              }
+                          });
 
         // move all dummy edges to the end of the renumbered range
+        auto new_edge_index = number_of_valid_edges;
         for (auto edge : util::irange<NodeID>(0, edge_list.size()))
         {
             if (old_to_new_edge[edge] == SPECIAL_EDGEID)
@@ -0,0 +1,209 @@
+#ifndef OSRM_UTIL_EXTERNAL_SORTER_HPP
+#define OSRM_UTIL_EXTERNAL_SORTER_HPP
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/integer_range.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * Sorts more elements than fit into memory.
+ *
+ * The elements are collected in a buffer of a fixed number of elements. Every full buffer is
+ * sorted and spilled as a run into a temporary file of the given directory. Merge reads the runs
+ * back in blocks with a k-way merge, so that the sorter needs about the memory of one buffer.
+ *
+ * The runs are written bytewise, so T has to be trivially copyable.
+ */
+template <typename T, typename Compare> class ExternalSorter
+{
+#if !defined(__GNUC__) || (__GNUC__ > 4)
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "bytewise spilling requires trivially copyable type");
+#endif
+
+  public:
+    ExternalSorter(boost::filesystem::path directory_,
+                   const std::size_t buffer_size_,
+                   Compare compare_ = Compare{})
+        : directory(std::move(directory_)), buffer_size(std::max<std::size_t>(1, buffer_size_)),
+          compare(std::move(compare_))
+    {
+    }
+
+    ExternalSorter(const ExternalSorter &) = delete;
+    ExternalSorter &operator=(const ExternalSorter &) = delete;
+
+    ~ExternalSorter() { RemoveRuns(); }
+
+    void push_back(const T &value)
+    {
+        buffer.push_back(value);
+        if (buffer.size() >= buffer_size)
+        {
+            Spill();
+        }
+    }
+
+    std::size_t size() const { return number_of_spilled_elements + buffer.size(); }
+
+    bool empty() const { return size() == 0; }
+
+    // Calls callback with all elements in sorted order and removes them from the sorter
+    template <typename Callback> void Merge(Callback &&callback)
+    {
+        tbb::parallel_sort(buffer.begin(), buffer.end(), compare);
+        if (runs.empty())
+        {
+            std::for_each(buffer.begin(), buffer.end(), callback);
+            std::vector<T>().swap(buffer);
+            return;
+        }
+
+        // the runs together read about one buffer of elements at a time
+        const auto block_size = std::max<std::size_t>(1, buffer_size / (runs.size() + 1));
+
+        // the last source is the buffer that was not spilled
+        std::vector<Source> sources(runs.size() + 1);
+        for (const auto index : util::irange<std::size_t>(0, runs.size()))
+        {
+            auto &source = sources[index];
+            source.stream.open(runs[index].path, std::ios::binary);
+            if (!source.stream)
+            {
+                throw util::exception("Could not open run file " + runs[index].path.string() +
+                                      SOURCE_REF);
+            }
+            source.remaining = runs[index].size;
+            Refill(source, block_size);
+        }
+        sources.back().block = std::move(buffer);
+        buffer.clear();
+
+        // searches the source with the smallest current element on a heap
+        const auto greater_source = [&](const std::size_t lhs, const std::size_t rhs) {
+            return compare(sources[rhs].Current(), sources[lhs].Current());
+        };
+        std::vector<std::size_t> heap;
+        for (const auto index : util::irange<std::size_t>(0, sources.size()))
+        {
+            if (!sources[index].Exhausted())
+                heap.push_back(index);
+        }
+        std::make_heap(heap.begin(), heap.end(), greater_source);
+
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), greater_source);
+            auto &source = sources[heap.back()];
+            callback(source.Current());
+
+            if (++source.position == source.block.size())
+            {
+                Refill(source, block_size);
+            }
+            if (source.Exhausted())
+            {
+                heap.pop_back();
+            }
+            else
+            {
+                std::push_heap(heap.begin(), heap.end(), greater_source);
+            }
+        }
+
+        sources.clear();
+        RemoveRuns();
+    }
+
+  private:
+    struct Run
+    {
+        boost::filesystem::path path;
+        std::size_t size;
+    };
+
+    struct Source
+    {
+        const T &Current() const { return block[position]; }
+        bool Exhausted() const { return position == block.size(); }
+
+        boost::filesystem::ifstream stream;
+        std::vector<T> block;
+        std::size_t position = 0;
+        std::size_t remaining = 0;
+    };
+
+    void Spill()
+    {
+        tbb::parallel_sort(buffer.begin(), buffer.end(), compare);
+
+        const auto path = directory / boost::filesystem::unique_path("osrm-%%%%-%%%%-%%%%.run");
+        boost::filesystem::ofstream stream(path, std::ios::binary);
+        stream.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(T));
+        if (!stream)
+        {
+            boost::system::error_code error;
+            boost::filesystem::remove(path, error);
+            throw util::exception("Could not write run file " + path.string() + SOURCE_REF);
+        }
+
+        runs.push_back({path, buffer.size()});
+        number_of_spilled_elements += buffer.size();
+        buffer.clear();
+    }
+
+    void Refill(Source &source, const std::size_t block_size)
+    {
+        const auto count = std::min(block_size, source.remaining);
+        source.block.resize(count);
+        source.position = 0;
+        source.remaining -= count;
+        if (count == 0)
+            return;
+
+        source.stream.read(reinterpret_cast<char *>(source.block.data()), count * sizeof(T));
+        if (!source.stream)
+        {
+            throw util::exception("Could not read run file" + SOURCE_REF);
+        }
+    }
+
+    void RemoveRuns()
+    {
+        for (const auto &run : runs)
+        {
+            boost::system::error_code error;
+            boost::filesystem::remove(run.path, error);
+        }
+        runs.clear();
+        number_of_spilled_elements = 0;
+    }
+
+    const boost::filesystem::path directory;
+    const std::size_t buffer_size;
+    const Compare compare;
+
+    std::vector<T> buffer;
+    std::vector<Run> runs;
+    std::size_t number_of_spilled_elements = 0;
+};
+}
+}
+
+#endif
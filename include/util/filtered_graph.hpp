@@ -8,24 +8,35 @@
 #include "util/static_graph.hpp"
 #include "util/vector_view.hpp"
 
+#include <algorithm>
+#include <vector>
+
 namespace osrm
 {
 namespace util
 {
-namespace detail
+inline bool allowsAllEdges(const vector_view<bool> &edge_filter) { return edge_filter.all(); }
+
+inline bool allowsAllEdges(const std::vector<bool> &edge_filter)
 {
-template <typename GraphT, storage::Ownership Ownership> class FilteredGraphImpl;
+    return std::find(edge_filter.begin(), edge_filter.end(), false) == edge_filter.end();
+}
 
+namespace detail
+{
 // For static graphs we can save the filters as a static vector since
 // we don't modify the structure of the graph. This also makes it easy to
 // swap out the filter.
-template <typename EdgeDataT, storage::Ownership Ownership>
-class FilteredGraphImpl<util::StaticGraph<EdgeDataT, Ownership>, Ownership>
+// Works for all graphs with the interface of StaticGraph, e.g. contractor::CompactQueryGraph
+// that returns its edge data by value.
+// An empty filter or one that allows all edges is not checked at all, like the filter of the CH
+// of a dataset without exclude classes.
+template <typename GraphT, storage::Ownership Ownership> class FilteredGraphImpl
 {
     template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
 
   public:
-    using Graph = util::StaticGraph<EdgeDataT, Ownership>;
+    using Graph = GraphT;
     using EdgeIterator = typename Graph::EdgeIterator;
     using NodeIterator = typename Graph::NodeIterator;
     using NodeArrayEntry = typename Graph::NodeArrayEntry;
@@ -40,31 +51,37 @@ class FilteredGraphImpl<util::StaticGraph<EdgeDataT, Ownership>, Ownership>
     {
         auto range = graph.GetAdjacentEdgeRange(n);
         return std::count_if(range.begin(), range.end(), [this](const EdgeIterator edge) {
-            return edge_filter[edge];
+            return IsAllowed(edge);
         });
     }
 
     inline NodeIterator GetTarget(const EdgeIterator e) const
     {
-        BOOST_ASSERT(edge_filter[e]);
+        BOOST_ASSERT(IsAllowed(e));
         return graph.GetTarget(e);
     }
 
-    auto &GetEdgeData(const EdgeIterator e)
+    decltype(auto) GetEdgeData(const EdgeIterator e)
     {
-        BOOST_ASSERT(edge_filter[e]);
+        BOOST_ASSERT(IsAllowed(e));
         return graph.GetEdgeData(e);
     }
 
-    const auto &GetEdgeData(const EdgeIterator e) const
+    decltype(auto) GetEdgeData(const EdgeIterator e) const
     {
-        BOOST_ASSERT(edge_filter[e]);
+        BOOST_ASSERT(IsAllowed(e));
         return graph.GetEdgeData(e);
     }
 
     auto GetAdjacentEdgeRange(const NodeIterator n) const
     {
-        return EdgeRange{graph.BeginEdges(n), graph.EndEdges(n), edge_filter};
+        return filter_edges ? EdgeRange{graph.BeginEdges(n), graph.EndEdges(n), edge_filter}
+                            : EdgeRange{graph.BeginEdges(n), graph.EndEdges(n)};
+    }
+
+    void PrefetchAdjacentEdgeRange(const NodeIterator n) const
+    {
+        graph.PrefetchAdjacentEdgeRange(n);
     }
 
     // searches for a specific edge
@@ -84,17 +101,16 @@ class FilteredGraphImpl<util::StaticGraph<EdgeDataT, Ownership>, Ownership>
     EdgeIterator
     FindSmallestEdge(const NodeIterator from, const NodeIterator to, FilterFunction &&filter) const
     {
-        static_assert(traits::HasDataMember<typename Graph::EdgeArrayEntry>::value,
-                      "Filtering on .data not possible without .data member attribute");
-
         EdgeIterator smallest_edge = SPECIAL_EDGEID;
         EdgeWeight smallest_weight = INVALID_EDGE_WEIGHT;
         for (auto edge : GetAdjacentEdgeRange(from))
         {
-            const NodeID target = GetTarget(edge);
+            // only gather the data of edges to the target
+            if (GetTarget(edge) != to)
+                continue;
+
             const auto &data = GetEdgeData(edge);
-            if (target == to && data.weight < smallest_weight &&
-                std::forward<FilterFunction>(filter)(data))
+            if (data.weight < smallest_weight && std::forward<FilterFunction>(filter)(data))
             {
                 smallest_edge = edge;
                 smallest_weight = data.weight;
@@ -127,7 +143,8 @@ class FilteredGraphImpl<util::StaticGraph<EdgeDataT, Ownership>, Ownership>
     FilteredGraphImpl() = default;
 
     FilteredGraphImpl(Graph graph, Vector<bool> edge_filter_)
-        : graph(std::move(graph)), edge_filter(std::move(edge_filter_))
+        : graph(std::move(graph)), edge_filter(std::move(edge_filter_)),
+          filter_edges(!allowsAllEdges(edge_filter))
     {
         BOOST_ASSERT(edge_filter.empty() || edge_filter.size() == graph.GetNumberOfEdges());
     }
@@ -140,6 +157,7 @@ class FilteredGraphImpl<util::StaticGraph<EdgeDataT, Ownership>, Ownership>
     {
         auto edge_ids = util::irange<EdgeID>(0, graph.GetNumberOfEdges());
         std::transform(edge_ids.begin(), edge_ids.end(), edge_filter.begin(), filter);
+        filter_edges = !allowsAllEdges(edge_filter);
     }
 
     void Renumber(const std::vector<NodeID> &old_to_new_node)
@@ -150,8 +168,11 @@ class FilteredGraphImpl<util::StaticGraph<EdgeDataT, Ownership>, Ownership>
     }
 
   private:
+    bool IsAllowed(const EdgeIterator e) const { return !filter_edges || edge_filter[e]; }
+
     Graph graph;
     Vector<bool> edge_filter;
+    bool filter_edges = false;
 };
 }
 
@@ -19,6 +19,29 @@ namespace util
 // That makes it unsuitable to use in interface where we would expect all filtered ranges
 // to be off the same type.
 
+namespace detail
+{
+// Filters with a find_next(first, last) member, like vector_view<bool>, skip the values that are
+// filtered out at once
+template <typename Integer, typename Filter>
+auto findAllowed(const Filter &filter, const Integer first, const Integer last, int)
+    -> decltype(filter.find_next(first, last), Integer())
+{
+    return static_cast<Integer>(filter.find_next(first, last));
+}
+
+template <typename Integer, typename Filter>
+Integer findAllowed(const Filter &filter, Integer first, const Integer last, long)
+{
+    while (first < last && !filter[first])
+    {
+        first++;
+    }
+    return first;
+}
+}
+
+// Iterates over the values allowed by the filter, over all values without a filter
 template <typename Integer, typename Filter>
 class filtered_integer_iterator
     : public boost::iterator_facade<filtered_integer_iterator<Integer, Filter>,
@@ -47,10 +70,11 @@ class filtered_integer_iterator
   private:
     void increment()
     {
-        do
+        ++value;
+        if (filter)
         {
-            ++value;
-        } while (value < end_value && !(*filter)[value]);
+            value = detail::findAllowed(*filter, value, end_value, 0);
+        }
     }
     bool equal(const filtered_integer_iterator &other) const { return value == other.value; }
     reference dereference() const { return value; }
@@ -67,14 +91,15 @@ template <typename Integer, typename Filter> class filtered_range
     typedef filtered_integer_iterator<Integer, Filter> const_iterator;
     typedef filtered_integer_iterator<Integer, Filter> iterator;
 
-    filtered_range(Integer begin, Integer end, const Filter &filter) : last(end, end, &filter)
+    filtered_range(Integer begin, Integer end, const Filter &filter)
+        : iter(detail::findAllowed(filter, begin, end, 0), end, &filter), last(end, end, &filter)
     {
-        while (begin < end && !filter[begin])
-        {
-            begin++;
-        }
+    }
 
-        iter = iterator(begin, end, &filter);
+    // A range of all values in [begin, end)
+    filtered_range(Integer begin, Integer end)
+        : iter(begin, end, nullptr), last(end, end, nullptr)
+    {
     }
 
     iterator begin() const noexcept { return iter; }
@@ -0,0 +1,72 @@
+#ifndef OSRM_UTIL_FLAT_ID_MAP_HPP
+#define OSRM_UTIL_FLAT_ID_MAP_HPP
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// A map of ids, like node or edge ids, to values that is built once and then only read. The
+// entries are kept sorted by id in one vector and found by a binary search, so unlike a hash map
+// there is no allocation per entry. Suits maps of few ids out of a large range, for maps of most
+// ids a vector indexed by the id is smaller.
+template <typename IdT, typename ValueT> class FlatIdMap
+{
+  public:
+    using value_type = std::pair<IdT, ValueT>;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+    using iterator = const_iterator;
+
+    FlatIdMap() = default;
+
+    // The ids of the entries need to be unique
+    explicit FlatIdMap(std::vector<value_type> entries_) : entries(std::move(entries_))
+    {
+        std::sort(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.first < rhs.first;
+        });
+        BOOST_ASSERT(std::adjacent_find(entries.begin(),
+                                        entries.end(),
+                                        [](const auto &lhs, const auto &rhs) {
+                                            return lhs.first == rhs.first;
+                                        }) == entries.end());
+    }
+
+    const_iterator find(const IdT id) const
+    {
+        const auto iter =
+            std::lower_bound(entries.begin(), entries.end(), id, [](const auto &entry, IdT id) {
+                return entry.first < id;
+            });
+        return iter != entries.end() && iter->first == id ? iter : entries.end();
+    }
+
+    std::size_t count(const IdT id) const { return find(id) != entries.end(); }
+
+    const ValueT &at(const IdT id) const
+    {
+        const auto iter = find(id);
+        BOOST_ASSERT(iter != entries.end());
+        return iter->second;
+    }
+
+    std::size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+  private:
+    std::vector<value_type> entries;
+};
+}
+}
+
+#endif // OSRM_UTIL_FLAT_ID_MAP_HPP
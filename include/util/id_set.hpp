@@ -0,0 +1,172 @@
+#ifndef OSRM_UTIL_ID_SET_HPP
+#define OSRM_UTIL_ID_SET_HPP
+
+#include <boost/assert.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// A set of dense ids, like node or edge ids, kept as a bit vector that grows up to the largest
+// id inserted. Looking up an id is a shift and a mask instead of hashing it, and the set takes a
+// bit per id below the largest one instead of a hash node per element. The ids are iterated in
+// ascending order.
+template <typename IdT> class IdSet
+{
+    using Word = std::uint64_t;
+    static constexpr std::size_t WORD_BITS = 64;
+
+  public:
+    using value_type = IdT;
+    using size_type = std::size_t;
+
+    class const_iterator : public boost::iterator_facade<const_iterator,
+                                                         const IdT,
+                                                         boost::forward_traversal_tag,
+                                                         const IdT>
+    {
+      public:
+        const_iterator() : words(nullptr), position(0) {}
+        const_iterator(const std::vector<Word> &words_, const std::size_t position_)
+            : words(&words_), position(position_)
+        {
+            skipUnset();
+        }
+
+      private:
+        friend class boost::iterator_core_access;
+
+        static std::size_t lowestBit(Word word)
+        {
+            BOOST_ASSERT(word != 0);
+#if (defined(__clang__) || defined(__GNUC__) || defined(__GNUG__))
+            return __builtin_ctzll(word);
+#else
+            std::size_t index = 0;
+            for (; (word & Word{1}) == 0; word >>= 1)
+                ++index;
+            return index;
+#endif
+        }
+
+        // moves to the next id in the set or to the end
+        void skipUnset()
+        {
+            const auto end = words->size() * WORD_BITS;
+            while (position < end)
+            {
+                const auto word = (*words)[position / WORD_BITS] >> (position % WORD_BITS);
+                if (word != 0)
+                {
+                    position += lowestBit(word);
+                    return;
+                }
+                position = (position / WORD_BITS + 1) * WORD_BITS;
+            }
+            position = end;
+        }
+
+        void increment()
+        {
+            ++position;
+            skipUnset();
+        }
+
+        bool equal(const const_iterator &other) const { return position == other.position; }
+
+        const IdT dereference() const { return static_cast<IdT>(position); }
+
+        const std::vector<Word> *words;
+        std::size_t position;
+    };
+    using iterator = const_iterator;
+
+    IdSet() = default;
+    IdSet(std::initializer_list<IdT> ids) { insert(ids.begin(), ids.end()); }
+    template <typename Iter> IdSet(Iter first, const Iter last) { insert(first, last); }
+
+    // Makes room for the ids below number_of_ids, the set still grows for larger ids
+    void resize(const std::size_t number_of_ids)
+    {
+        words.resize((number_of_ids + WORD_BITS - 1) / WORD_BITS, 0);
+    }
+
+    // Returns true if the id was not in the set before
+    bool insert(const IdT id)
+    {
+        const std::size_t index = id / WORD_BITS;
+        if (index >= words.size())
+        {
+            words.resize(index + 1, 0);
+        }
+
+        const auto mask = Word{1} << (id % WORD_BITS);
+        if (words[index] & mask)
+        {
+            return false;
+        }
+        words[index] |= mask;
+        ++number_of_ids;
+        return true;
+    }
+
+    template <typename Iter> void insert(Iter first, const Iter last)
+    {
+        for (; first != last; ++first)
+        {
+            insert(*first);
+        }
+    }
+
+    std::size_t erase(const IdT id)
+    {
+        if (!count(id))
+        {
+            return 0;
+        }
+        words[id / WORD_BITS] &= ~(Word{1} << (id % WORD_BITS));
+        BOOST_ASSERT(number_of_ids > 0);
+        --number_of_ids;
+        return 1;
+    }
+
+    std::size_t count(const IdT id) const
+    {
+        const std::size_t index = id / WORD_BITS;
+        return index < words.size() && ((words[index] >> (id % WORD_BITS)) & Word{1});
+    }
+
+    std::size_t size() const { return number_of_ids; }
+    bool empty() const { return number_of_ids == 0; }
+
+    void clear()
+    {
+        words.clear();
+        number_of_ids = 0;
+    }
+
+    void swap(IdSet &other)
+    {
+        words.swap(other.words);
+        std::swap(number_of_ids, other.number_of_ids);
+    }
+
+    const_iterator begin() const { return const_iterator(words, 0); }
+    const_iterator end() const { return const_iterator(words, words.size() * WORD_BITS); }
+
+  private:
+    std::vector<Word> words;
+    std::size_t number_of_ids = 0;
+};
+}
+}
+
+#endif // OSRM_UTIL_ID_SET_HPP
@@ -0,0 +1,190 @@
+#ifndef OSRM_UTIL_JSON_NUMBER_HPP
+#define OSRM_UTIL_JSON_NUMBER_HPP
+
+#include <rapidjson/internal/dtoa.h>
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace osrm
+{
+namespace util
+{
+namespace json
+{
+
+// Numbers are rendered with at most this many decimals, like cast::to_string_with_precision
+const constexpr int NUMBER_PRECISION = 6;
+
+// Upper bound of the characters formatNumber writes, the largest doubles have 309 digits
+const constexpr std::size_t MAX_NUMBER_LENGTH = 320;
+
+namespace detail
+{
+const constexpr std::int64_t FIXED_SCALE = 1000000;
+// Below this magnitude values 1e-6 apart map to different doubles
+const constexpr double MAX_FIXED_VALUE = 1e9;
+
+// Writes the digits of value in reverse order, returns the position after the last digit
+inline char *writeDigitsReversed(std::uint64_t value, char *out)
+{
+    do
+    {
+        *out++ = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return out;
+}
+
+inline char *writeUnsigned(const std::uint64_t value, char *out)
+{
+    char digits[20];
+    const auto end = writeDigitsReversed(value, digits);
+    for (auto digit = end; digit != digits;)
+    {
+        *out++ = *--digit;
+    }
+    return out;
+}
+
+// Formats the shortest round-trip digits of large magnitudes that are
+// value = digits * 10^exponent, rounded to NUMBER_PRECISION decimals
+inline char *formatDigits(char *digits, int length, int exponent, char *out)
+{
+    // digits left of the decimal point, always positive for the magnitudes handled here
+    const int integral_length = length + exponent;
+    BOOST_ASSERT(integral_length > 0);
+
+    const int max_length = integral_length + NUMBER_PRECISION;
+    if (length > max_length)
+    {
+        const bool round_up = digits[max_length] >= '5';
+        length = max_length;
+        if (round_up)
+        {
+            int index = length - 1;
+            while (index >= 0 && digits[index] == '9')
+            {
+                digits[index--] = '0';
+            }
+            if (index < 0)
+            {
+                *out++ = '1';
+            }
+            else
+            {
+                ++digits[index];
+            }
+        }
+    }
+
+    const int written_integral = std::min(length, integral_length);
+    std::memcpy(out, digits, written_integral);
+    out += written_integral;
+    for (int index = length; index < integral_length; ++index)
+    {
+        *out++ = '0';
+    }
+
+    while (length > integral_length && digits[length - 1] == '0')
+    {
+        --length;
+    }
+    if (length > integral_length)
+    {
+        *out++ = '.';
+        std::memcpy(out, digits + integral_length, length - integral_length);
+        out += length - integral_length;
+    }
+    return out;
+}
+}
+
+/**
+ * Writes a number as fixed point value with NUMBER_PRECISION decimals, the integer
+ * value * 10^NUMBER_PRECISION. Trailing zeros and the decimal point of integral values are
+ * omitted, since Javascript does not distinguish integers from floats.
+ *
+ * This is used for coordinates in their fixed point representation and for all numbers
+ * that are exact in this precision, i.e. durations or distances rounded for the response.
+ */
+inline char *formatFixed(const std::int64_t value, char *out)
+{
+    const std::uint64_t magnitude =
+        value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+    if (value < 0)
+    {
+        *out++ = '-';
+    }
+
+    out = detail::writeUnsigned(magnitude / detail::FIXED_SCALE, out);
+
+    auto decimals = static_cast<std::uint32_t>(magnitude % detail::FIXED_SCALE);
+    if (decimals != 0)
+    {
+        int length = NUMBER_PRECISION;
+        while (decimals % 10 == 0)
+        {
+            decimals /= 10;
+            --length;
+        }
+        *out++ = '.';
+        for (int index = length - 1; index >= 0; --index)
+        {
+            out[index] = static_cast<char>('0' + decimals % 10);
+            decimals /= 10;
+        }
+        out += length;
+    }
+    return out;
+}
+
+/**
+ * Formats a number into out without allocating and returns the end of the written range,
+ * out needs to have room for MAX_NUMBER_LENGTH characters.
+ *
+ * Like cast::to_string_with_precision the value is rounded to NUMBER_PRECISION decimals
+ * without trailing zeros. Numbers below 1e9 are formatted from their fixed point integer and
+ * match it exactly. Larger ones are formatted from their shortest round-trip digits computed
+ * with the Grisu2 implementation of rapidjson, which drops the digits of the exact binary
+ * expansion that are beyond the precision of a double. JSON has no representation for
+ * infinity or NaN, they are rendered as null.
+ */
+inline char *formatNumber(const double value, char *out)
+{
+    if (!std::isfinite(value))
+    {
+        std::memcpy(out, "null", 4);
+        return out + 4;
+    }
+
+    if (std::abs(value) < detail::MAX_FIXED_VALUE)
+    {
+        const auto fixed = static_cast<std::int64_t>(std::round(value * detail::FIXED_SCALE));
+        return formatFixed(fixed, out);
+    }
+
+    auto magnitude = value;
+    if (magnitude < 0)
+    {
+        *out++ = '-';
+        magnitude = -magnitude;
+    }
+
+    // Grisu2 generates at most 17 digits
+    char digits[32];
+    int length = 0;
+    int exponent = 0;
+    rapidjson::internal::Grisu2(magnitude, digits, &length, &exponent);
+    return detail::formatDigits(digits, length, exponent, out);
+}
+
+} // namespace json
+} // namespace util
+} // namespace osrm
+
+#endif // OSRM_UTIL_JSON_NUMBER_HPP
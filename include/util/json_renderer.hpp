@@ -4,11 +4,15 @@
 #ifndef JSON_RENDERER_HPP
 #define JSON_RENDERER_HPP
 
-#include "util/cast.hpp"
+#include "util/json_number.hpp"
 #include "util/string_util.hpp"
 
 #include "osrm/json_container.hpp"
 
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <ostream>
 #include <string>
@@ -77,22 +81,69 @@ struct Renderer
     std::ostream &out;
 };
 
-struct ArrayRenderer
+// Output of the BufferRenderer that fills a sequence of chunks of at most chunk_size bytes.
+// Unlike a single buffer it never reallocates and copies what is already rendered, and
+// the chunks can be written to the socket as they are.
+class ChunkedOutput
 {
-    explicit ArrayRenderer(std::vector<char> &_out) : out(_out) {}
+  public:
+    ChunkedOutput(std::vector<std::vector<char>> &chunks, const std::size_t chunk_size)
+        : chunks(chunks), chunk_size(chunk_size)
+    {
+        BOOST_ASSERT(chunk_size > 0);
+    }
+
+    void push_back(const char character)
+    {
+        if (chunks.empty() || chunks.back().size() == chunk_size)
+        {
+            add_chunk();
+        }
+        chunks.back().push_back(character);
+    }
+
+    void append(const char *first, const char *last)
+    {
+        while (first != last)
+        {
+            if (chunks.empty() || chunks.back().size() == chunk_size)
+            {
+                add_chunk();
+            }
+            auto &chunk = chunks.back();
+            const auto length = std::min<std::size_t>(last - first, chunk_size - chunk.size());
+            chunk.insert(chunk.end(), first, first + length);
+            first += length;
+        }
+    }
+
+  private:
+    void add_chunk()
+    {
+        chunks.emplace_back();
+        chunks.back().reserve(chunk_size);
+    }
+
+    std::vector<std::vector<char>> &chunks;
+    const std::size_t chunk_size;
+};
+
+template <typename Output> struct BufferRenderer
+{
+    explicit BufferRenderer(Output &_out) : out(_out) {}
 
     void operator()(const String &string) const
     {
         out.push_back('\"');
-        const auto string_to_insert = escape_JSON(string.value);
-        out.insert(std::end(out), std::begin(string_to_insert), std::end(string_to_insert));
+        writeEscaped(string.value);
         out.push_back('\"');
     }
 
     void operator()(const Number &number) const
     {
-        const std::string number_string = cast::to_string_with_precision(number.value);
-        out.insert(out.end(), number_string.begin(), number_string.end());
+        char buffer[MAX_NUMBER_LENGTH];
+        const auto end = formatNumber(number.value, buffer);
+        append(out, buffer, end - buffer);
     }
 
     void operator()(const Object &object) const
@@ -101,11 +152,11 @@ struct ArrayRenderer
         for (auto it = object.values.begin(), end = object.values.end(); it != end;)
         {
             out.push_back('\"');
-            out.insert(out.end(), it->first.begin(), it->first.end());
+            write(it->first);
             out.push_back('\"');
             out.push_back(':');
 
-            mapbox::util::apply_visitor(ArrayRenderer(out), it->second);
+            mapbox::util::apply_visitor(BufferRenderer(out), it->second);
             if (++it != end)
             {
                 out.push_back(',');
@@ -119,7 +170,7 @@ struct ArrayRenderer
         out.push_back('[');
         for (auto it = array.values.cbegin(), end = array.values.cend(); it != end;)
         {
-            mapbox::util::apply_visitor(ArrayRenderer(out), *it);
+            mapbox::util::apply_visitor(BufferRenderer(out), *it);
             if (++it != end)
             {
                 out.push_back(',');
@@ -128,38 +179,66 @@ struct ArrayRenderer
         out.push_back(']');
     }
 
-    void operator()(const True &) const
+    void operator()(const True &) const { append(out, "true", 4); }
+
+    void operator()(const False &) const { append(out, "false", 5); }
+
+    void operator()(const Null &) const { append(out, "null", 4); }
+
+  private:
+    void write(const std::string &string) const { append(out, string.data(), string.size()); }
+
+    // Appends the runs of characters that need no escaping at once, without a copy of the string
+    void writeEscaped(const std::string &string) const
     {
-        const std::string temp("true");
-        out.insert(out.end(), temp.begin(), temp.end());
+        auto run_begin = string.data();
+        const auto end = string.data() + string.size();
+        for (auto iter = run_begin; iter != end; ++iter)
+        {
+            if (const auto escape_sequence = getJSONEscapeSequence(*iter))
+            {
+                append(out, run_begin, iter - run_begin);
+                append(out, escape_sequence, std::strlen(escape_sequence));
+                run_begin = iter + 1;
+            }
+        }
+        append(out, run_begin, end - run_begin);
     }
 
-    void operator()(const False &) const
+    static void append(std::vector<char> &buffer, const char *data, const std::size_t size)
     {
-        const std::string temp("false");
-        out.insert(out.end(), temp.begin(), temp.end());
+        buffer.insert(buffer.end(), data, data + size);
     }
 
-    void operator()(const Null &) const
+    static void append(ChunkedOutput &output, const char *data, const std::size_t size)
     {
-        const std::string temp("null");
-        out.insert(out.end(), temp.begin(), temp.end());
+        output.append(data, data + size);
     }
 
-  private:
-    std::vector<char> &out;
+    Output &out;
 };
 
+using ArrayRenderer = BufferRenderer<std::vector<char>>;
+
 inline void render(std::ostream &out, const Object &object)
 {
-    Value value = object;
-    mapbox::util::apply_visitor(Renderer(out), value);
+    const Renderer renderer(out);
+    renderer(object);
 }
 
 inline void render(std::vector<char> &out, const Object &object)
 {
-    Value value = object;
-    mapbox::util::apply_visitor(ArrayRenderer(out), value);
+    const ArrayRenderer renderer(out);
+    renderer(object);
+}
+
+// Renders into chunks of at most chunk_size bytes that are appended to chunks
+inline void
+render(std::vector<std::vector<char>> &chunks, const Object &object, const std::size_t chunk_size)
+{
+    ChunkedOutput output(chunks, chunk_size);
+    const BufferRenderer<ChunkedOutput> renderer(output);
+    renderer(object);
 }
 
 } // namespace json
@@ -0,0 +1,84 @@
+#ifndef OSRM_UTIL_LRU_CACHE_HPP
+#define OSRM_UTIL_LRU_CACHE_HPP
+
+#include <boost/assert.hpp>
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * Map of at most capacity entries that evicts the least recently used entry on insertion.
+ *
+ * Values are copied out of the cache, use a shared_ptr for values that are expensive to copy.
+ * This is not thread-safe, callers have to lock around it.
+ */
+template <typename KeyType, typename ValueType, typename HashType = std::hash<KeyType>>
+class LRUCache
+{
+  public:
+    explicit LRUCache(const std::size_t capacity) : capacity(capacity)
+    {
+        BOOST_ASSERT(capacity > 0);
+        positions.reserve(capacity);
+    }
+
+    // Returns the value of key and marks it as the most recently used entry
+    boost::optional<ValueType> Get(const KeyType &key)
+    {
+        const auto position = positions.find(key);
+        if (position == positions.end())
+        {
+            return boost::none;
+        }
+        entries.splice(entries.begin(), entries, position->second);
+        return position->second->second;
+    }
+
+    void Put(const KeyType &key, ValueType value)
+    {
+        const auto position = positions.find(key);
+        if (position != positions.end())
+        {
+            position->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, position->second);
+            return;
+        }
+
+        if (entries.size() == capacity)
+        {
+            positions.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, std::move(value));
+        positions.emplace(key, entries.begin());
+    }
+
+    void Clear()
+    {
+        positions.clear();
+        entries.clear();
+    }
+
+    std::size_t Size() const { return entries.size(); }
+
+  private:
+    using Entries = std::list<std::pair<KeyType, ValueType>>;
+
+    const std::size_t capacity;
+    // ordered from the most to the least recently used entry
+    Entries entries;
+    std::unordered_map<KeyType, typename Entries::iterator, HashType> positions;
+};
+}
+}
+
+#endif // OSRM_UTIL_LRU_CACHE_HPP
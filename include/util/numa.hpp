@@ -0,0 +1,41 @@
+#ifndef OSRM_UTIL_NUMA_HPP
+#define OSRM_UTIL_NUMA_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * NUMA topology and memory placement on Linux, read from /sys/devices/system/node and applied
+ * with the system calls, so that no libnuma is needed.
+ *
+ * The nodes are numbered by their position in GetNumaNodes, not by their kernel ids. On other
+ * systems, or on machines without NUMA information, there is a single node with all CPUs.
+ */
+struct NumaNode
+{
+    unsigned id;
+    std::vector<unsigned> cpus;
+};
+
+const std::vector<NumaNode> &GetNumaNodes();
+
+// Pins the calling thread to the CPUs of a node
+void PinThreadToNumaNode(std::size_t node);
+
+// The node the calling thread is pinned to, or the node of the CPU it currently runs on
+std::size_t CurrentNumaNode();
+
+// Places the pages of a memory region on a node, must be called before the pages are touched
+void BindMemoryToNumaNode(void *memory, std::size_t size, std::size_t node);
+
+// Spreads the pages of a memory region round-robin over all nodes
+void InterleaveMemory(void *memory, std::size_t size);
+}
+}
+
+#endif
@@ -2,7 +2,9 @@
 #define OSRM_OPENING_HOURS_HPP
 
 #include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/optional.hpp>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -223,6 +225,16 @@ std::vector<OpeningHours> ParseOpeningHours(const std::string &str);
 
 bool CheckOpeningHours(const std::vector<OpeningHours> &input, const struct tm &time);
 
+// Opening hours that only depend on the weekday and the time of the day, compiled into the
+// sorted minutes of the week (0 is Sunday 00:00) at which they switch between closed and open.
+// They are open at a minute if an odd number of switches is not after it.
+using WeeklySchedule = std::vector<std::uint16_t>;
+
+// Returns none for opening hours with date ranges or events like sunrise
+boost::optional<WeeklySchedule> CompileWeeklySchedule(const std::vector<OpeningHours> &input);
+
+bool CheckWeeklySchedule(const WeeklySchedule &schedule, const struct tm &time);
+
 } // util
 } // osrm
 
@@ -108,6 +108,8 @@ template <typename T, std::size_t Bits, storage::Ownership Ownership> class Pack
   private:
     // number of words per block
     static constexpr std::size_t BLOCK_WORDS = (Bits * BLOCK_ELEMENTS) / WORD_BITS;
+    // the blocks are a continuous stream of values, value i starts at bit i * Bits
+    static constexpr WordT VALUE_MASK = Bits == WORD_BITS ? ~WordT{0} : (WordT{1} << Bits) - 1;
 
     // C++14 does not allow operator[] to be constexpr, this is fixed in C++17.
     static /* constexpr */ std::array<WordT, BLOCK_ELEMENTS> initialize_lower_mask()
@@ -450,6 +452,25 @@ template <typename T, std::size_t Bits, storage::Ownership Ownership> class Pack
         vec.reserve(num_blocks * BLOCK_WORDS + 1);
     }
 
+    // Decodes the values [first, last) in order without the block lookup of the iterators
+    template <typename OutputIter>
+    OutputIter unpack(const std::size_t first, const std::size_t last, OutputIter out) const
+    {
+        BOOST_ASSERT(first <= last && last <= num_elements);
+        // every value is decoded from two words without a branch, the second word is shifted
+        // in two steps so the shift is defined when the value does not reach into it
+        for (auto bit = first * Bits; bit < last * Bits; bit += Bits)
+        {
+            const auto word_index = bit / WORD_BITS;
+            const auto offset = bit % WORD_BITS;
+            // there is a sentinel word behind the last block
+            const WordT value = (vec[word_index] >> offset) |
+                                ((vec[word_index + 1] << 1) << (WORD_BITS - 1 - offset));
+            *out++ = get_lower_half_value<WordT, T>(value, VALUE_MASK, 0);
+        }
+        return out;
+    }
+
     friend void serialization::read<T, Bits, Ownership>(storage::tar::FileReader &reader,
                                                         const std::string &name,
                                                         PackedVector &vec);
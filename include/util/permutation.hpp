@@ -3,6 +3,13 @@
 
 #include "util/integer_range.hpp"
 
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <iterator>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -47,6 +54,35 @@ void inplacePermutation(RandomAccesIterator begin,
     }
 }
 
+// Moves the elements out of place in parallel and back, which needs a copy of the range as
+// auxiliary space instead of a bit per element
+template <typename RandomAccesIterator, typename IndexT>
+void parallelPermutation(RandomAccesIterator begin,
+                         RandomAccesIterator end,
+                         const std::vector<IndexT> &old_to_new)
+{
+    using ValueT = typename std::iterator_traits<RandomAccesIterator>::value_type;
+
+    const std::size_t size = std::distance(begin, end);
+    BOOST_ASSERT(old_to_new.size() == size);
+    std::vector<ValueT> permuted(size);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, size),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              BOOST_ASSERT(old_to_new[index] < size);
+                              permuted[old_to_new[index]] = std::move(begin[index]);
+                          }
+                      });
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, size),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              begin[index] = std::move(permuted[index]);
+                          }
+                      });
+}
+
 template <typename IndexT>
 std::vector<IndexT> orderingToPermutation(const std::vector<IndexT> &ordering)
 {
@@ -0,0 +1,92 @@
+#ifndef OSRM_UTIL_PHASE_REPORT_HPP
+#define OSRM_UTIL_PHASE_REPORT_HPP
+
+#include "util/json_container.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Resources the process used since it was started
+struct ResourceUsage
+{
+    double wall_seconds;
+    double cpu_seconds;
+    std::uint64_t peak_rss_bytes;
+    // bytes passed to read and write calls, not the pages of memory mapped files
+    std::uint64_t read_bytes;
+    std::uint64_t written_bytes;
+
+    static ResourceUsage Now();
+};
+
+/**
+ * Machine readable summary of the phases of a preprocessing tool, the counterpart of the timings
+ * the tools log.
+ *
+ * Phases are recorded by ReportPhase whether a report is written or not, taking a sample costs a
+ * few system calls per phase. The tools write the report as JSON with Write if they are asked to.
+ */
+class PhaseReport
+{
+  public:
+    struct Phase
+    {
+        std::string name;
+        ResourceUsage begin;
+        ResourceUsage end;
+    };
+
+    static PhaseReport &GetInstance();
+
+    void Record(std::string name, const ResourceUsage &begin, const ResourceUsage &end);
+
+    std::vector<Phase> GetPhases() const;
+
+    // The utilization of a phase is its CPU time divided by its wall time on all threads
+    json::Object ToJSON(const std::string &tool, const unsigned number_of_threads) const;
+
+    // Returns false if the file can't be written
+    bool Write(const boost::filesystem::path &path,
+               const std::string &tool,
+               const unsigned number_of_threads) const;
+
+    PhaseReport(const PhaseReport &) = delete;
+    PhaseReport &operator=(const PhaseReport &) = delete;
+
+  private:
+    PhaseReport() = default;
+
+    mutable std::mutex mutex;
+    std::vector<Phase> phases;
+};
+
+// Records a phase from its construction until Stop is called or it goes out of scope
+class ReportPhase
+{
+  public:
+    explicit ReportPhase(std::string name);
+    ~ReportPhase();
+
+    void Stop();
+
+    ReportPhase(const ReportPhase &) = delete;
+    ReportPhase &operator=(const ReportPhase &) = delete;
+
+  private:
+    std::string name;
+    ResourceUsage begin;
+    bool stopped;
+};
+}
+}
+
+#endif
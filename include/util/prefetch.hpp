@@ -0,0 +1,13 @@
+#ifndef OSRM_UTIL_PREFETCH_HPP
+#define OSRM_UTIL_PREFETCH_HPP
+
+// Prefetching in the search loops is compiled in with -DOSRM_ENABLE_SEARCH_PREFETCH
+// (cmake -DENABLE_SEARCH_PREFETCH=ON), otherwise OSRM_PREFETCH(...) expands to nothing and its
+// argument is not evaluated. It pays off for graphs and heaps that don't fit into the caches.
+#if defined(OSRM_ENABLE_SEARCH_PREFETCH) && (defined(__GNUC__) || defined(__clang__))
+#define OSRM_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define OSRM_PREFETCH(address) ((void)0)
+#endif
+
+#endif // OSRM_UTIL_PREFETCH_HPP
@@ -1,13 +1,19 @@
 #ifndef OSRM_UTIL_QUERY_HEAP_HPP
 #define OSRM_UTIL_QUERY_HEAP_HPP
 
+#include "util/prefetch.hpp"
+#include "util/search_counters.hpp"
+
 #include <boost/assert.hpp>
 #include <boost/heap/d_ary_heap.hpp>
 
 #include <algorithm>
 #include <limits>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -21,13 +27,13 @@ template <typename NodeID, typename Key> class GenerationArrayStorage
 
   public:
     explicit GenerationArrayStorage(std::size_t size)
-        : positions(size, 0), generation(1), generations(size, 0)
+        : generation(1), generations(size, 0), positions(size, 0)
     {
     }
 
     Key &operator[](NodeID node)
     {
-        generation[node] = generation;
+        generations[node] = generation;
         return positions[node];
     }
 
@@ -40,6 +46,12 @@ template <typename NodeID, typename Key> class GenerationArrayStorage
         return positions[node];
     }
 
+    void Prefetch(const NodeID node) const
+    {
+        OSRM_PREFETCH(&generations[node]);
+        OSRM_PREFETCH(&positions[node]);
+    }
+
     void Clear()
     {
         generation++;
@@ -57,6 +69,102 @@ template <typename NodeID, typename Key> class GenerationArrayStorage
     std::vector<Key> positions;
 };
 
+// Generation array that only allocates pages of nodes that were touched by a query.
+// Trades a page table lookup for not having to allocate O(number of nodes) for every heap.
+template <typename NodeID, typename Key> class PagedGenerationArrayStorage
+{
+    using GenerationCounter = std::uint16_t;
+    static constexpr std::size_t PAGE_BITS = 12;
+    static constexpr std::size_t PAGE_SIZE = 1u << PAGE_BITS;
+    static constexpr std::size_t PAGE_MASK = PAGE_SIZE - 1;
+
+    struct Page
+    {
+        Page() { std::fill(std::begin(generations), std::end(generations), 0); }
+
+        GenerationCounter generations[PAGE_SIZE];
+        Key positions[PAGE_SIZE];
+    };
+
+  public:
+    explicit PagedGenerationArrayStorage(std::size_t size)
+        : generation(1), pages((size + PAGE_SIZE - 1) >> PAGE_BITS)
+    {
+    }
+
+    Key &operator[](NodeID node)
+    {
+        BOOST_ASSERT((node >> PAGE_BITS) < pages.size());
+        auto &page = pages[node >> PAGE_BITS];
+        if (!page)
+        {
+            page = std::make_unique<Page>();
+        }
+        page->generations[node & PAGE_MASK] = generation;
+        return page->positions[node & PAGE_MASK];
+    }
+
+    Key peek_index(const NodeID node) const
+    {
+        BOOST_ASSERT((node >> PAGE_BITS) < pages.size());
+        const auto &page = pages[node >> PAGE_BITS];
+        if (!page || page->generations[node & PAGE_MASK] < generation)
+        {
+            return std::numeric_limits<Key>::max();
+        }
+        return page->positions[node & PAGE_MASK];
+    }
+
+    // Pages that were not touched yet are not allocated by prefetching
+    void Prefetch(const NodeID node) const
+    {
+        BOOST_ASSERT((node >> PAGE_BITS) < pages.size());
+        const auto &page = pages[node >> PAGE_BITS];
+        if (page)
+        {
+            OSRM_PREFETCH(&page->generations[node & PAGE_MASK]);
+            OSRM_PREFETCH(&page->positions[node & PAGE_MASK]);
+        }
+    }
+
+    void Clear()
+    {
+        generation++;
+        // if generation overflows we end up at 0 again and need to clear all allocated pages
+        if (generation == 0)
+        {
+            generation = 1;
+            for (auto &page : pages)
+            {
+                if (page)
+                {
+                    std::fill(std::begin(page->generations), std::end(page->generations), 0);
+                }
+            }
+        }
+    }
+
+    std::size_t RetainedMemory() const
+    {
+        return sizeof(Page) *
+               std::count_if(pages.begin(), pages.end(), [](const auto &page) { return !!page; });
+    }
+
+    // Releases all pages, they are allocated again once the next query touches them
+    void Shrink()
+    {
+        for (auto &page : pages)
+        {
+            page.reset();
+        }
+        generation = 1;
+    }
+
+  private:
+    GenerationCounter generation;
+    std::vector<std::unique_ptr<Page>> pages;
+};
+
 template <typename NodeID, typename Key> class ArrayStorage
 {
   public:
@@ -68,6 +176,8 @@ template <typename NodeID, typename Key> class ArrayStorage
 
     Key peek_index(const NodeID node) const { return positions[node]; }
 
+    void Prefetch(const NodeID node) const { OSRM_PREFETCH(&positions[node]); }
+
     void Clear() {}
 
   private:
@@ -93,6 +203,9 @@ template <typename NodeID, typename Key> class MapStorage
         return std::numeric_limits<Key>::max();
     }
 
+    // The tree nodes are only found by the lookup itself
+    void Prefetch(const NodeID) const {}
+
   private:
     std::map<NodeID, Key> nodes;
 };
@@ -120,12 +233,153 @@ template <typename NodeID, typename Key> class UnorderedMapStorage
         return iter->second;
     }
 
+    // The buckets are only found by hashing, which costs as much as the lookup
+    void Prefetch(const NodeID) const {}
+
     void Clear() { nodes.clear(); }
 
+    // The nodes are freed by Clear, but the buckets keep the size of the largest search
+    std::size_t RetainedMemory() const { return nodes.bucket_count() * sizeof(void *); }
+
+    void Shrink()
+    {
+        std::unordered_map<NodeID, Key>().swap(nodes);
+        nodes.rehash(1000);
+    }
+
   private:
     std::unordered_map<NodeID, Key> nodes;
 };
 
+// Index storages that can be selected at run-time by SelectableStorage
+enum class HeapStorageType
+{
+    UnorderedMap,        // memory proportional to the search space, hashing on every access
+    GenerationArray,     // O(1) access, but allocates memory for all nodes of the graph per heap
+    PagedGenerationArray // O(1) access, allocates only pages of nodes touched by the search
+};
+
+// Dispatches to the index storage selected on construction. The branch is the same on
+// every call, so it is well predicted and cheap compared to the storage access itself.
+template <typename NodeID, typename Key> class SelectableStorage
+{
+  public:
+    explicit SelectableStorage(std::size_t size,
+                               HeapStorageType type = HeapStorageType::UnorderedMap)
+        : type(type), size(size), unordered_map(size),
+          generation_array(type == HeapStorageType::GenerationArray ? size : 0),
+          paged_generation_array(type == HeapStorageType::PagedGenerationArray ? size : 0)
+    {
+    }
+
+    HeapStorageType GetType() const { return type; }
+
+    // Array storages are sized on construction and can't be reused for larger graphs
+    bool IsReusable(std::size_t new_size, HeapStorageType new_type) const
+    {
+        return new_type == type && (type == HeapStorageType::UnorderedMap || new_size <= size);
+    }
+
+    Key &operator[](const NodeID node)
+    {
+        switch (type)
+        {
+        case HeapStorageType::GenerationArray:
+            return generation_array[node];
+        case HeapStorageType::PagedGenerationArray:
+            return paged_generation_array[node];
+        case HeapStorageType::UnorderedMap:
+        default:
+            return unordered_map[node];
+        }
+    }
+
+    Key peek_index(const NodeID node) const
+    {
+        switch (type)
+        {
+        case HeapStorageType::GenerationArray:
+            return generation_array.peek_index(node);
+        case HeapStorageType::PagedGenerationArray:
+            return paged_generation_array.peek_index(node);
+        case HeapStorageType::UnorderedMap:
+        default:
+            return unordered_map.peek_index(node);
+        }
+    }
+
+    void Prefetch(const NodeID node) const
+    {
+        switch (type)
+        {
+        case HeapStorageType::GenerationArray:
+            generation_array.Prefetch(node);
+            break;
+        case HeapStorageType::PagedGenerationArray:
+            paged_generation_array.Prefetch(node);
+            break;
+        case HeapStorageType::UnorderedMap:
+        default:
+            unordered_map.Prefetch(node);
+        }
+    }
+
+    void Clear()
+    {
+        switch (type)
+        {
+        case HeapStorageType::GenerationArray:
+            generation_array.Clear();
+            break;
+        case HeapStorageType::PagedGenerationArray:
+            paged_generation_array.Clear();
+            break;
+        case HeapStorageType::UnorderedMap:
+        default:
+            unordered_map.Clear();
+        }
+    }
+
+    // Memory kept from previous searches, the generation array is sized on construction and
+    // not counted as it can not shrink
+    std::size_t RetainedMemory() const
+    {
+        switch (type)
+        {
+        case HeapStorageType::GenerationArray:
+            return 0;
+        case HeapStorageType::PagedGenerationArray:
+            return paged_generation_array.RetainedMemory();
+        case HeapStorageType::UnorderedMap:
+        default:
+            return unordered_map.RetainedMemory();
+        }
+    }
+
+    // Needs a cleared storage
+    void Shrink()
+    {
+        switch (type)
+        {
+        case HeapStorageType::GenerationArray:
+            break;
+        case HeapStorageType::PagedGenerationArray:
+            paged_generation_array.Shrink();
+            break;
+        case HeapStorageType::UnorderedMap:
+        default:
+            unordered_map.Shrink();
+        }
+    }
+
+  private:
+    HeapStorageType type;
+    std::size_t size;
+    UnorderedMapStorage<NodeID, Key> unordered_map;
+    GenerationArrayStorage<NodeID, Key> generation_array;
+    PagedGenerationArrayStorage<NodeID, Key> paged_generation_array;
+};
+
 template <typename NodeID,
           typename Key,
           typename Weight,
@@ -137,7 +391,14 @@ class QueryHeap
     using WeightType = Weight;
     using DataType = Data;
 
-    explicit QueryHeap(std::size_t maxID) : node_index(maxID) { Clear(); }
+    template <typename... StorageArgs>
+    explicit QueryHeap(std::size_t maxID, StorageArgs &&... storage_args)
+        : node_index(maxID, std::forward<StorageArgs>(storage_args)...)
+    {
+        Clear();
+    }
+
+    const IndexStorage &GetIndexStorage() const { return node_index; }
 
     void Clear()
     {
@@ -146,6 +407,22 @@ class QueryHeap
         node_index.Clear();
     }
 
+    // Memory the heap keeps from previous searches, the vectors only ever grow
+    std::size_t RetainedMemory() const
+    {
+        return inserted_nodes.capacity() * (sizeof(HeapNode) + sizeof(HeapHandle)) +
+               node_index.RetainedMemory();
+    }
+
+    // Clears the heap and releases the memory of previous searches
+    void Shrink()
+    {
+        Clear();
+        std::vector<HeapNode>().swap(inserted_nodes);
+        HeapContainer().swap(heap);
+        node_index.Shrink();
+    }
+
     std::size_t Size() const { return heap.size(); }
 
     bool Empty() const { return 0 == Size(); }
@@ -153,6 +430,7 @@ class QueryHeap
     void Insert(NodeID node, Weight weight, const Data &data)
     {
         BOOST_ASSERT(node < std::numeric_limits<NodeID>::max());
+        OSRM_COUNT_SEARCH(InsertNode());
         const auto index = static_cast<Key>(inserted_nodes.size());
         const auto handle = heap.push(std::make_pair(weight, index));
         inserted_nodes.emplace_back(HeapNode{handle, node, weight, data});
@@ -193,6 +471,9 @@ class QueryHeap
         return inserted_nodes[index].handle == none_handle;
     }
 
+    // Requests the index of node from memory, e.g. before it is looked up by WasInserted
+    void Prefetch(const NodeID node) const { node_index.Prefetch(node); }
+
     bool WasInserted(const NodeID node) const
     {
         const auto index = node_index.peek_index(node);
@@ -218,6 +499,7 @@ class QueryHeap
     NodeID DeleteMin()
     {
         BOOST_ASSERT(!heap.empty());
+        OSRM_COUNT_SEARCH(SettleNode());
         const Key removedIndex = heap.top().second;
         heap.pop();
         inserted_nodes[removedIndex].handle = heap.s_handle_from_iterator(heap.end());
@@ -236,6 +518,7 @@ class QueryHeap
     void DecreaseKey(NodeID node, Weight weight)
     {
         BOOST_ASSERT(!WasRemoved(node));
+        OSRM_COUNT_SEARCH(DecreaseKey());
         const auto index = node_index.peek_index(node);
         auto &reference = inserted_nodes[index];
         reference.weight = weight;
@@ -0,0 +1,340 @@
+#ifndef OSRM_UTIL_RADIX_HEAP_HPP
+#define OSRM_UTIL_RADIX_HEAP_HPP
+
+#include "util/query_heap.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Monotone radix heap with the same interface as QueryHeap.
+//
+// Keys are bucketed by the highest bit in which they differ from the last extracted key,
+// so all operations are amortized O(1) resp. O(number of key bits) and decrease-key is a swap
+// in a bucket vector instead of a sift-up in a d-ary heap.
+//
+// Requires integer keys and that no key smaller than the last extracted minimum is inserted
+// or used for a decrease-key, which holds for Dijkstra searches with non-negative edge weights.
+// Before the first DeleteMin arbitrary (also negative) keys like phantom node offsets are allowed.
+template <typename NodeID,
+          typename Key,
+          typename Weight,
+          typename Data,
+          typename IndexStorage = ArrayStorage<NodeID, NodeID>>
+class RadixQueryHeap
+{
+    static_assert(std::is_integral<Weight>::value, "radix heap requires integer weights");
+
+    using UnsignedWeight = typename std::make_unsigned<Weight>::type;
+    static constexpr std::size_t NUMBER_OF_BUCKETS =
+        std::numeric_limits<UnsignedWeight>::digits + 1;
+    static constexpr std::uint32_t REMOVED_BUCKET = std::numeric_limits<std::uint32_t>::max();
+
+  public:
+    using WeightType = Weight;
+    using DataType = Data;
+
+    template <typename... StorageArgs>
+    explicit RadixQueryHeap(std::size_t maxID, StorageArgs &&... storage_args)
+        : node_index(maxID, std::forward<StorageArgs>(storage_args)...)
+    {
+        Clear();
+    }
+
+    const IndexStorage &GetIndexStorage() const { return node_index; }
+
+    void Clear()
+    {
+        for (auto &bucket : buckets)
+        {
+            bucket.clear();
+        }
+        heap_size = 0;
+        last = 0;
+        min_index_valid = false;
+        inserted_nodes.clear();
+        node_index.Clear();
+    }
+
+    // Memory the heap keeps from previous searches, the vectors only ever grow
+    std::size_t RetainedMemory() const
+    {
+        auto capacity = inserted_nodes.capacity() * sizeof(HeapNode) +
+                        redistributed.capacity() * sizeof(Key) + node_index.RetainedMemory();
+        for (const auto &bucket : buckets)
+        {
+            capacity += bucket.capacity() * sizeof(Key);
+        }
+        return capacity;
+    }
+
+    // Clears the heap and releases the memory of previous searches
+    void Shrink()
+    {
+        Clear();
+        std::vector<HeapNode>().swap(inserted_nodes);
+        for (auto &bucket : buckets)
+        {
+            std::vector<Key>().swap(bucket);
+        }
+        std::vector<Key>().swap(redistributed);
+        node_index.Shrink();
+    }
+
+    std::size_t Size() const { return heap_size; }
+
+    bool Empty() const { return 0 == Size(); }
+
+    void Insert(NodeID node, Weight weight, const Data &data)
+    {
+        BOOST_ASSERT(node < std::numeric_limits<NodeID>::max());
+        OSRM_COUNT_SEARCH(InsertNode());
+        const auto index = static_cast<Key>(inserted_nodes.size());
+        inserted_nodes.emplace_back(HeapNode{node, weight, data, REMOVED_BUCKET, 0});
+        node_index[node] = index;
+        PushToBucket(index);
+        UpdateMinIndex(index);
+        ++heap_size;
+    }
+
+    Data &GetData(NodeID node)
+    {
+        const auto index = node_index.peek_index(node);
+        return inserted_nodes[index].data;
+    }
+
+    Data const &GetData(NodeID node) const
+    {
+        const auto index = node_index.peek_index(node);
+        return inserted_nodes[index].data;
+    }
+
+    const Weight &GetKey(NodeID node) const
+    {
+        const auto index = node_index.peek_index(node);
+        return inserted_nodes[index].weight;
+    }
+
+    bool WasRemoved(const NodeID node) const
+    {
+        BOOST_ASSERT(WasInserted(node));
+        const Key index = node_index.peek_index(node);
+        return inserted_nodes[index].bucket == REMOVED_BUCKET;
+    }
+
+    // Requests the index of node from memory, e.g. before it is looked up by WasInserted
+    void Prefetch(const NodeID node) const { node_index.Prefetch(node); }
+
+    bool WasInserted(const NodeID node) const
+    {
+        const auto index = node_index.peek_index(node);
+        if (index >= static_cast<decltype(index)>(inserted_nodes.size()))
+        {
+            return false;
+        }
+        return inserted_nodes[index].node == node;
+    }
+
+    NodeID Min() const
+    {
+        BOOST_ASSERT(!Empty());
+        return inserted_nodes[GetMinIndex()].node;
+    }
+
+    Weight MinKey() const
+    {
+        BOOST_ASSERT(!Empty());
+        return inserted_nodes[GetMinIndex()].weight;
+    }
+
+    NodeID DeleteMin()
+    {
+        BOOST_ASSERT(!Empty());
+        OSRM_COUNT_SEARCH(SettleNode());
+        Normalize();
+        const Key removed_index = buckets[0].back();
+        buckets[0].pop_back();
+        inserted_nodes[removed_index].bucket = REMOVED_BUCKET;
+        min_index_valid = false;
+        --heap_size;
+        return inserted_nodes[removed_index].node;
+    }
+
+    void DeleteAll()
+    {
+        for (auto &bucket : buckets)
+        {
+            for (const auto index : bucket)
+            {
+                inserted_nodes[index].bucket = REMOVED_BUCKET;
+            }
+            bucket.clear();
+        }
+        heap_size = 0;
+        min_index_valid = false;
+    }
+
+    void DecreaseKey(NodeID node, Weight weight)
+    {
+        BOOST_ASSERT(!WasRemoved(node));
+        OSRM_COUNT_SEARCH(DecreaseKey());
+        const auto index = node_index.peek_index(node);
+        auto &reference = inserted_nodes[index];
+        BOOST_ASSERT(weight <= reference.weight);
+        reference.weight = weight;
+        if (reference.bucket == REMOVED_BUCKET)
+        {
+            return;
+        }
+        RemoveFromBucket(index);
+        PushToBucket(index);
+        UpdateMinIndex(index);
+    }
+
+  private:
+    struct HeapNode
+    {
+        NodeID node;
+        Weight weight;
+        Data data;
+        std::uint32_t bucket;
+        std::uint32_t position;
+    };
+
+    // Order preserving mapping of signed keys to unsigned integers
+    static UnsignedWeight ToUnsigned(const Weight weight)
+    {
+        return std::is_signed<Weight>::value
+                   ? static_cast<UnsignedWeight>(weight) ^
+                         (UnsignedWeight{1} << (std::numeric_limits<UnsignedWeight>::digits - 1))
+                   : static_cast<UnsignedWeight>(weight);
+    }
+
+    // 0 if key equals the reference, otherwise 1 + the highest differing bit
+    static std::uint32_t BucketIndex(const UnsignedWeight key, const UnsignedWeight reference)
+    {
+        const std::uint64_t difference = key ^ reference;
+        if (difference == 0)
+        {
+            return 0;
+        }
+#if defined(__GNUC__) || defined(__clang__)
+        return 64 - __builtin_clzll(difference);
+#else
+        std::uint32_t bits = 0;
+        for (auto value = difference; value != 0; value >>= 1)
+        {
+            ++bits;
+        }
+        return bits;
+#endif
+    }
+
+    void PushToBucket(const Key index)
+    {
+        auto &reference = inserted_nodes[index];
+        const auto key = ToUnsigned(reference.weight);
+        BOOST_ASSERT_MSG(key >= last, "radix heap requires monotone keys");
+        reference.bucket = BucketIndex(key, last);
+        reference.position = static_cast<std::uint32_t>(buckets[reference.bucket].size());
+        buckets[reference.bucket].push_back(index);
+    }
+
+    void RemoveFromBucket(const Key index)
+    {
+        const auto &reference = inserted_nodes[index];
+        auto &bucket = buckets[reference.bucket];
+        BOOST_ASSERT(bucket[reference.position] == index);
+        const auto moved_index = bucket.back();
+        bucket[reference.position] = moved_index;
+        inserted_nodes[moved_index].position = reference.position;
+        bucket.pop_back();
+    }
+
+    // Peeking must not advance the last extracted key, as Dijkstra searches may insert keys
+    // between the current minimum and the last extracted key after a peek. Instead the minimum
+    // of the first non-empty bucket is cached until the next extraction.
+    Key GetMinIndex() const
+    {
+        if (!buckets[0].empty())
+        {
+            return buckets[0].back();
+        }
+
+        if (!min_index_valid)
+        {
+            const auto &bucket = buckets[FirstNonEmptyBucketIndex()];
+            min_index = *std::min_element(bucket.begin(), bucket.end(), [this](Key lhs, Key rhs) {
+                return inserted_nodes[lhs].weight < inserted_nodes[rhs].weight;
+            });
+            min_index_valid = true;
+        }
+        return min_index;
+    }
+
+    void UpdateMinIndex(const Key index)
+    {
+        if (min_index_valid && inserted_nodes[index].weight < inserted_nodes[min_index].weight)
+        {
+            min_index = index;
+        }
+    }
+
+    std::size_t FirstNonEmptyBucketIndex() const
+    {
+        std::size_t bucket_index = 1;
+        while (buckets[bucket_index].empty())
+        {
+            ++bucket_index;
+            BOOST_ASSERT(bucket_index < NUMBER_OF_BUCKETS);
+        }
+        return bucket_index;
+    }
+
+    // Makes sure the first bucket holds the minimum by redistributing the first non-empty
+    // bucket relative to its minimal key. Every element only moves to lower buckets.
+    void Normalize()
+    {
+        if (!buckets[0].empty())
+        {
+            return;
+        }
+
+        last = ToUnsigned(inserted_nodes[GetMinIndex()].weight);
+
+        const auto bucket_index = FirstNonEmptyBucketIndex();
+        redistributed.swap(buckets[bucket_index]);
+        for (const auto index : redistributed)
+        {
+            PushToBucket(index);
+        }
+        // all elements moved to lower buckets, keep the allocated memory for reuse
+        BOOST_ASSERT(buckets[bucket_index].empty());
+        redistributed.clear();
+        redistributed.swap(buckets[bucket_index]);
+    }
+
+    std::vector<HeapNode> inserted_nodes;
+    std::array<std::vector<Key>, NUMBER_OF_BUCKETS> buckets;
+    std::vector<Key> redistributed;
+    UnsignedWeight last;
+    std::size_t heap_size;
+    mutable Key min_index;
+    mutable bool min_index_valid;
+    IndexStorage node_index;
+};
+}
+}
+
+#endif // OSRM_UTIL_RADIX_HEAP_HPP
@@ -0,0 +1,128 @@
+#ifndef OSRM_UTIL_READ_EPOCHS_HPP
+#define OSRM_UTIL_READ_EPOCHS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * Epoch based reclamation for pointers that are read by many threads and swapped by few.
+ *
+ * Readers load the pointer inside a ReadSection which only writes to a slot of the thread,
+ * so readers do not share a cache line that is written. A writer swaps the pointer and calls
+ * Synchronize before it frees the old object, which waits until all read sections that could
+ * have loaded the old pointer are left.
+ *
+ * Read sections must not be nested and should be short, the writer spins until they are left.
+ */
+class ReadEpochs
+{
+    struct alignas(64) Slot
+    {
+        // the epoch the read section of the thread started in, zero outside of read sections
+        std::atomic<std::uint64_t> epoch{0};
+        bool in_use = false;
+    };
+
+    struct Registry
+    {
+        alignas(64) std::atomic<std::uint64_t> epoch{1};
+        std::mutex mutex;
+        // a deque keeps the addresses of the slots stable
+        std::deque<Slot> slots;
+    };
+
+    static Registry &GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    // Claims a slot for the lifetime of the thread, slots of finished threads are reused
+    struct ThreadSlot
+    {
+        ThreadSlot()
+        {
+            auto &registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            const auto free_slot = std::find_if(registry.slots.begin(),
+                                                registry.slots.end(),
+                                                [](const Slot &slot) { return !slot.in_use; });
+            if (free_slot == registry.slots.end())
+            {
+                registry.slots.emplace_back();
+                slot = &registry.slots.back();
+            }
+            else
+            {
+                slot = &*free_slot;
+            }
+            slot->in_use = true;
+        }
+
+        ~ThreadSlot()
+        {
+            std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+            slot->epoch.store(0);
+            slot->in_use = false;
+        }
+
+        Slot *slot;
+    };
+
+    static Slot &GetThreadSlot()
+    {
+        static thread_local ThreadSlot thread_slot;
+        return *thread_slot.slot;
+    }
+
+  public:
+    class ReadSection
+    {
+      public:
+        ReadSection() : slot(GetThreadSlot())
+        {
+            // needs to be visible to writers before the pointer is loaded
+            slot.epoch.store(GetRegistry().epoch.load());
+        }
+
+        ~ReadSection() { slot.epoch.store(0, std::memory_order_release); }
+
+        ReadSection(const ReadSection &) = delete;
+        ReadSection &operator=(const ReadSection &) = delete;
+
+      private:
+        Slot &slot;
+    };
+
+    // Waits until the read sections that started before the call are left. Objects that were
+    // swapped out before the call can be freed afterwards.
+    static void Synchronize()
+    {
+        auto &registry = GetRegistry();
+        const auto epoch = registry.epoch.fetch_add(1) + 1;
+
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto &slot : registry.slots)
+        {
+            auto reader_epoch = slot.epoch.load();
+            while (reader_epoch != 0 && reader_epoch < epoch)
+            {
+                std::this_thread::yield();
+                reader_epoch = slot.epoch.load();
+            }
+        }
+    }
+};
+}
+}
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef OSRM_UTIL_REQUEST_TRACE_HPP
+#define OSRM_UTIL_REQUEST_TRACE_HPP
+
+#include "util/json_container.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * The stages of a sampled request and how long they took, e.g. parsing its URL, snapping its
+ * coordinates, the searches and rendering and compressing its reply. Spans nest, their depth is
+ * the number of spans they are nested into. A trace is filled by a single thread at a time.
+ */
+class RequestTrace
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Span
+    {
+        const char *name;
+        unsigned depth;
+        // relative to the start of the trace
+        Clock::duration start;
+        Clock::duration duration;
+    };
+
+    // Spans of requests with many searches, e.g. trips, are dropped beyond this many
+    static constexpr std::size_t MAX_SPANS = 256;
+
+    RequestTrace() : start(Clock::now()), depth(0) {}
+
+    // Returns the index of the span that is passed to End, also if the span was dropped
+    std::size_t Begin(const char *name)
+    {
+        const auto index = spans.size();
+        if (index < MAX_SPANS)
+            spans.push_back({name, depth, Clock::now() - start, Clock::duration::zero()});
+        ++depth;
+        return index;
+    }
+
+    void End(const std::size_t index)
+    {
+        --depth;
+        if (index < spans.size())
+            spans[index].duration = Clock::now() - start - spans[index].start;
+    }
+
+    const std::vector<Span> &GetSpans() const { return spans; }
+
+    // {"uri":...,"status":...,"total_ms":...,"spans":[{"name":...,"depth":...,"start_ms":...,
+    // "duration_ms":...}]} with the time from the start of the trace until now as total
+    json::Object ToJSON(const std::string &uri, const int status) const;
+
+  private:
+    const Clock::time_point start;
+    unsigned depth;
+    std::vector<Span> spans;
+};
+
+namespace detail
+{
+// Like the cancellation token the trace of the running request is thread local, so that the
+// plugins and routing algorithms record their spans without passing it down.
+inline RequestTrace *&threadTrace()
+{
+    static thread_local RequestTrace *trace = nullptr;
+    return trace;
+}
+}
+
+// Makes trace the trace of this thread until the scope ends, nullptr disables the tracing
+class TraceScope
+{
+  public:
+    explicit TraceScope(RequestTrace *trace) : previous(detail::threadTrace())
+    {
+        detail::threadTrace() = trace;
+    }
+    ~TraceScope() { detail::threadTrace() = previous; }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+  private:
+    RequestTrace *const previous;
+};
+
+// Records a span from its construction to its destruction if the thread has a trace, otherwise
+// it costs a thread local read. The name has to outlive the trace, e.g. a string literal.
+class TraceSpan
+{
+  public:
+    explicit TraceSpan(const char *name) : trace(detail::threadTrace()), index(0)
+    {
+        if (trace)
+            index = trace->Begin(name);
+    }
+    ~TraceSpan() { Stop(); }
+
+    // Ends the span before the end of its scope
+    void Stop()
+    {
+        if (trace)
+        {
+            trace->End(index);
+            trace = nullptr;
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+  private:
+    RequestTrace *trace;
+    std::size_t index;
+};
+}
+}
+
+#endif // OSRM_UTIL_REQUEST_TRACE_HPP
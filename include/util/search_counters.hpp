@@ -0,0 +1,155 @@
+#ifndef OSRM_UTIL_SEARCH_COUNTERS_HPP
+#define OSRM_UTIL_SEARCH_COUNTERS_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Counting is compiled in with -DOSRM_ENABLE_SEARCH_COUNTERS (cmake -DENABLE_SEARCH_COUNTERS=ON),
+// otherwise OSRM_COUNT_SEARCH(...) expands to nothing and the hot paths are unchanged.
+#ifdef OSRM_ENABLE_SEARCH_COUNTERS
+#define OSRM_COUNT_SEARCH(call) (::osrm::util::threadSearchCounters().call)
+#define OSRM_TIME_UNPACKING() const ::osrm::util::UnpackingTimer osrm_unpacking_timer
+#else
+#define OSRM_COUNT_SEARCH(call) ((void)0)
+#define OSRM_TIME_UNPACKING() ((void)0)
+#endif
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * Work done by the searches of a request: the nodes settled and inserted into or decreased in
+ * the query heaps, the edges relaxed, the MLD cells whose overlay shortcuts were relaxed and the
+ * number of base graph edges of unpacked paths and the time it took to unpack them.
+ */
+struct SearchCounters
+{
+    // cells of higher levels are counted on the last one
+    static constexpr std::size_t MAX_COUNTED_LEVELS = 8;
+
+    void SettleNode() { ++settled_nodes; }
+    void InsertNode() { ++heap_inserts; }
+    void DecreaseKey() { ++heap_decreases; }
+    void RelaxEdge() { ++relaxed_edges; }
+    void EnterCell(const std::size_t level)
+    {
+        ++cells_entered[std::min(level, MAX_COUNTED_LEVELS - 1)];
+    }
+    void UnpackEdges(const std::size_t number_of_edges) { unpacked_edges += number_of_edges; }
+    void UnpackTime(const std::chrono::nanoseconds duration)
+    {
+        unpack_nanoseconds += duration.count();
+    }
+
+    SearchCounters &operator+=(const SearchCounters &other)
+    {
+        settled_nodes += other.settled_nodes;
+        heap_inserts += other.heap_inserts;
+        heap_decreases += other.heap_decreases;
+        relaxed_edges += other.relaxed_edges;
+        for (std::size_t level = 0; level < MAX_COUNTED_LEVELS; ++level)
+        {
+            cells_entered[level] += other.cells_entered[level];
+        }
+        unpacked_edges += other.unpacked_edges;
+        unpack_nanoseconds += other.unpack_nanoseconds;
+        return *this;
+    }
+
+    std::uint64_t settled_nodes = 0;
+    std::uint64_t heap_inserts = 0;
+    std::uint64_t heap_decreases = 0;
+    std::uint64_t relaxed_edges = 0;
+    std::array<std::uint64_t, MAX_COUNTED_LEVELS> cells_entered = {};
+    std::uint64_t unpacked_edges = 0;
+    std::uint64_t unpack_nanoseconds = 0;
+};
+
+// Formats the counters as "settled=1 inserts=2 decreases=0 relaxed=5 cells=0/3/1 unpacked=4" for
+// access logs, trailing levels without cells are omitted
+inline std::ostream &operator<<(std::ostream &out, const SearchCounters &counters)
+{
+    out << "settled=" << counters.settled_nodes << " inserts=" << counters.heap_inserts
+        << " decreases=" << counters.heap_decreases << " relaxed=" << counters.relaxed_edges
+        << " cells=";
+
+    std::size_t levels = SearchCounters::MAX_COUNTED_LEVELS;
+    while (levels > 1 && counters.cells_entered[levels - 1] == 0)
+    {
+        --levels;
+    }
+    for (std::size_t level = 0; level < levels; ++level)
+    {
+        out << (level == 0 ? "" : "/") << counters.cells_entered[level];
+    }
+    return out << " unpacked=" << counters.unpacked_edges;
+}
+
+// The counters of the searches running on this thread. Like the query heaps of SearchEngineData
+// they are thread local, request handlers reset them before and read them after a query.
+inline SearchCounters &threadSearchCounters()
+{
+    static thread_local SearchCounters counters;
+    return counters;
+}
+
+// Adds the time from its construction to its destruction to the unpacking time of the thread.
+// Unpacking nested into another unpacking, like the searches inside the cells of MLD overlay
+// edges, is only counted once.
+class UnpackingTimer
+{
+  public:
+    UnpackingTimer() : outermost(depth()++ == 0)
+    {
+        if (outermost)
+            start = std::chrono::steady_clock::now();
+    }
+
+    ~UnpackingTimer()
+    {
+        --depth();
+        if (outermost)
+            threadSearchCounters().UnpackTime(std::chrono::steady_clock::now() - start);
+    }
+
+    UnpackingTimer(const UnpackingTimer &) = delete;
+    UnpackingTimer &operator=(const UnpackingTimer &) = delete;
+
+  private:
+    static std::size_t &depth()
+    {
+        static thread_local std::size_t depth = 0;
+        return depth;
+    }
+
+    const bool outermost;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Runs work and returns the counts of its searches without changing the counters of the thread,
+// used to collect the counts of tasks running on other threads for a request.
+template <typename Work> SearchCounters countSearches(const Work &work)
+{
+#ifdef OSRM_ENABLE_SEARCH_COUNTERS
+    auto &counters = threadSearchCounters();
+    const auto saved = counters;
+    counters = SearchCounters{};
+    work();
+    const auto counted = counters;
+    counters = saved;
+    return counted;
+#else
+    work();
+    return SearchCounters{};
+#endif
+}
+}
+}
+
+#endif // OSRM_UTIL_SEARCH_COUNTERS_HPP
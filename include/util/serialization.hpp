@@ -1,6 +1,8 @@
 #ifndef OSMR_UTIL_SERIALIZATION_HPP
 #define OSMR_UTIL_SERIALIZATION_HPP
 
+#include "util/block_compressed_vector.hpp"
+#include "util/dictionary_vector.hpp"
 #include "util/dynamic_graph.hpp"
 #include "util/indexed_data.hpp"
 #include "util/packed_vector.hpp"
@@ -56,6 +58,48 @@ inline void write(storage::tar::FileWriter &writer,
     storage::serialization::write(writer, name + "/packed", vec.vec);
 }
 
+template <typename T, storage::Ownership Ownership>
+inline void read(storage::tar::FileReader &reader,
+                 const std::string &name,
+                 detail::BlockCompressedVector<T, Ownership> &vec)
+{
+    reader.ReadInto(name + "/number_of_elements.meta", vec.num_elements);
+    storage::serialization::read(reader, name + "/headers", vec.headers);
+    storage::serialization::read(reader, name + "/packed", vec.words);
+}
+
+template <typename T, storage::Ownership Ownership>
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const detail::BlockCompressedVector<T, Ownership> &vec)
+{
+    writer.WriteFrom(name + "/number_of_elements.meta", vec.num_elements);
+    storage::serialization::write(writer, name + "/headers", vec.headers);
+    storage::serialization::write(writer, name + "/packed", vec.words);
+}
+
+template <typename T, storage::Ownership Ownership>
+inline void read(storage::tar::FileReader &reader,
+                 const std::string &name,
+                 detail::DictionaryVector<T, Ownership> &vec)
+{
+    storage::serialization::read(reader, name + "/dictionary", vec.dictionary);
+    storage::serialization::read(reader, name + "/codes", vec.codes);
+    storage::serialization::read(reader, name + "/exceptions/indices", vec.exception_indices);
+    storage::serialization::read(reader, name + "/exceptions/values", vec.exception_values);
+}
+
+template <typename T, storage::Ownership Ownership>
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const detail::DictionaryVector<T, Ownership> &vec)
+{
+    storage::serialization::write(writer, name + "/dictionary", vec.dictionary);
+    storage::serialization::write(writer, name + "/codes", vec.codes);
+    storage::serialization::write(writer, name + "/exceptions/indices", vec.exception_indices);
+    storage::serialization::write(writer, name + "/exceptions/values", vec.exception_values);
+}
+
 template <typename EdgeDataT, storage::Ownership Ownership>
 inline void read(storage::tar::FileReader &reader,
                  const std::string &name,
@@ -129,6 +173,17 @@ void read(storage::tar::FileReader &reader,
     storage::serialization::read(reader, name + "/search_tree", rtree.m_search_tree);
     storage::serialization::read(
         reader, name + "/search_tree_level_starts", rtree.m_tree_level_starts);
+    storage::serialization::read(reader, name + "/layout", rtree.m_layout);
+    if (reader.HasEntry(name + "/bearing_masks"))
+    {
+        storage::serialization::read(reader, name + "/bearing_masks", rtree.m_bearing_masks);
+    }
+    if (reader.HasEntry(name + "/big_component_nodes"))
+    {
+        storage::serialization::read(
+            reader, name + "/big_component_nodes", rtree.m_big_component_nodes);
+    }
+    rtree.UpdateLayout();
 }
 
 template <class EdgeDataT,
@@ -142,6 +197,10 @@ void write(storage::tar::FileWriter &writer,
     storage::serialization::write(writer, name + "/search_tree", rtree.m_search_tree);
     storage::serialization::write(
         writer, name + "/search_tree_level_starts", rtree.m_tree_level_starts);
+    storage::serialization::write(writer, name + "/layout", rtree.m_layout);
+    storage::serialization::write(writer, name + "/bearing_masks", rtree.m_bearing_masks);
+    storage::serialization::write(
+        writer, name + "/big_component_nodes", rtree.m_big_component_nodes);
 }
 }
 }
@@ -5,6 +5,7 @@
 #include "util/integer_range.hpp"
 #include "util/percent.hpp"
 #include "util/permutation.hpp"
+#include "util/prefetch.hpp"
 #include "util/typedefs.hpp"
 #include "util/vector_view.hpp"
 
@@ -179,6 +180,13 @@ class StaticGraph
         return EdgeIterator(node_array.at(n + 1).first_edge);
     }
 
+    // Requests the entry of n in the node array from memory, e.g. once n is reached by a search
+    void PrefetchAdjacentEdgeRange(const NodeIterator n) const
+    {
+        BOOST_ASSERT(n < node_array.size());
+        OSRM_PREFETCH(&node_array[n]);
+    }
+
     // searches for a specific edge
     EdgeIterator FindEdge(const NodeIterator from, const NodeIterator to) const
     {
@@ -247,7 +255,8 @@ class StaticGraph
         return current_iterator;
     }
 
-    void Renumber(const std::vector<NodeID> &old_to_new_node)
+    // Returns the mapping of old to new edge IDs
+    std::vector<EdgeID> Renumber(const std::vector<NodeID> &old_to_new_node)
     {
         std::vector<NodeID> new_to_old_node(number_of_nodes);
         for (auto node : util::irange<NodeID>(0, number_of_nodes))
@@ -274,6 +283,8 @@ class StaticGraph
                      old_to_new_edge.end());
 
         util::inplacePermutation(edge_array.begin(), edge_array.end(), old_to_new_edge);
+
+        return old_to_new_edge;
     }
 
     friend void serialization::read<EdgeDataT, Ownership>(storage::tar::FileReader &reader,
@@ -30,10 +30,12 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <limits>
 #include <memory>
 #include <queue>
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace osrm
@@ -158,6 +160,17 @@ class StaticRTree
     static_assert(LEAF_PAGE_SIZE >= sizeof(EdgeDataT), "page size is too small");
     static_assert(((LEAF_PAGE_SIZE - 1) & LEAF_PAGE_SIZE) == 0, "page size is not a power of 2");
     static constexpr std::uint32_t LEAF_NODE_SIZE = (LEAF_PAGE_SIZE / sizeof(EdgeDataT));
+    // The number of leaf children whose distance bounds are computed at once
+    static constexpr std::size_t LEAF_BLOCK_SIZE = 64;
+
+    // The template parameters are the defaults for new trees, a tree stores the fan-out and the
+    // leaf page size it was built with in its .ramIndex, they are used for its queries.
+    static bool IsValidLayout(const std::uint32_t branching_factor,
+                              const std::uint32_t leaf_page_size)
+    {
+        return branching_factor >= 2 && leaf_page_size >= sizeof(EdgeDataT) &&
+               ((leaf_page_size - 1) & leaf_page_size) == 0;
+    }
 
     struct CandidateSegment
     {
@@ -221,7 +234,16 @@ class StaticRTree
     {
         QueryCandidate(std::uint64_t squared_min_dist, TreeIndex tree_index)
             : squared_min_dist(squared_min_dist), tree_index(tree_index),
-              segment_index(std::numeric_limits<std::uint32_t>::max())
+              segment_index(std::numeric_limits<std::uint32_t>::max()), is_projected(false)
+        {
+        }
+
+        // A segment that is not projected yet, squared_min_dist is a lower bound of its distance
+        QueryCandidate(std::uint64_t squared_min_dist,
+                       TreeIndex tree_index,
+                       std::uint32_t segment_index)
+            : squared_min_dist(squared_min_dist), tree_index(tree_index),
+              segment_index(segment_index), is_projected(false)
         {
         }
 
@@ -230,7 +252,8 @@ class StaticRTree
                        std::uint32_t segment_index,
                        const Coordinate &coordinate)
             : squared_min_dist(squared_min_dist), tree_index(tree_index),
-              fixed_projected_coordinate(coordinate), segment_index(segment_index)
+              fixed_projected_coordinate(coordinate), segment_index(segment_index),
+              is_projected(true)
         {
         }
 
@@ -250,8 +273,56 @@ class StaticRTree
         TreeIndex tree_index;
         Coordinate fixed_projected_coordinate;
         std::uint32_t segment_index;
+        // the input coordinate is projected onto the segment at fixed_projected_coordinate
+        bool is_projected;
+    };
+
+    // A segment NearestK found with its squared distance and its index in m_objects
+    struct NearestSegment
+    {
+        std::uint64_t squared_distance;
+        std::uint32_t segment_index;
+        EdgeDataT data;
     };
 
+    // The traversal queue of NearestK, candidates that are not nearer than the bound are dropped
+    struct PruningQueue
+    {
+        void push(const QueryCandidate &candidate)
+        {
+            if (candidate.squared_min_dist < bound)
+            {
+                candidates.push_back(candidate);
+                std::push_heap(candidates.begin(), candidates.end());
+            }
+        }
+
+        QueryCandidate pop()
+        {
+            std::pop_heap(candidates.begin(), candidates.end());
+            const auto candidate = candidates.back();
+            candidates.pop_back();
+            return candidate;
+        }
+
+        bool empty() const { return candidates.empty(); }
+
+        std::vector<QueryCandidate> &candidates;
+        std::uint64_t bound;
+    };
+
+    struct NearestKBuffers
+    {
+        std::vector<QueryCandidate> traversal_queue;
+        std::vector<NearestSegment> nearest;
+    };
+
+    static NearestKBuffers &GetNearestKBuffers()
+    {
+        static thread_local NearestKBuffers buffers;
+        return buffers;
+    }
+
     // Representation of the in-memory search tree
     Vector<TreeNode> m_search_tree;
     // Reference to the actual lon/lat data we need for doing math
@@ -262,6 +333,16 @@ class StaticRTree
     boost::iostreams::mapped_file_source m_objects_region;
     // This is a view of the EdgeDataT data mmap'd from the .fileIndex file
     util::vector_view<const EdgeDataT> m_objects;
+    // The branching factor and the leaf page size the tree was built with
+    Vector<std::uint32_t> m_layout;
+    // For every node of m_search_tree the bearing sectors of the segments below it, see
+    // util::bearing::sectorMask. Empty for trees built before the masks were stored.
+    Vector<std::uint32_t> m_bearing_masks;
+    // For every node of m_search_tree if a segment below it is in a big component. Empty if the
+    // components were not known when the tree was built.
+    Vector<bool> m_big_component_nodes;
+    std::uint32_t m_branching_factor = BRANCHING_FACTOR;
+    std::uint32_t m_leaf_node_size = LEAF_NODE_SIZE;
 
   public:
     StaticRTree() = default;
@@ -271,11 +352,27 @@ class StaticRTree
     StaticRTree &operator=(StaticRTree &&) = default;
 
     // Construct a packed Hilbert-R-Tree with Kamel-Faloutsos algorithm [1]
+    // tiny_component_segments marks the segments of input_data_vector in tiny components, if
+    // it is empty all segments are treated as part of big components.
     explicit StaticRTree(const std::vector<EdgeDataT> &input_data_vector,
                          const Vector<Coordinate> &coordinate_list,
-                         const boost::filesystem::path &on_disk_file_name)
-        : m_coordinate_list(coordinate_list.data(), coordinate_list.size())
+                         const boost::filesystem::path &on_disk_file_name,
+                         const std::uint32_t branching_factor = BRANCHING_FACTOR,
+                         const std::uint32_t leaf_page_size = LEAF_PAGE_SIZE,
+                         const std::vector<bool> &tiny_component_segments = {})
+        : m_coordinate_list(coordinate_list.data(), coordinate_list.size()),
+          m_layout({branching_factor, leaf_page_size})
     {
+        if (!IsValidLayout(branching_factor, leaf_page_size))
+        {
+            throw util::exception("Invalid r-tree layout: branching factor " +
+                                  std::to_string(branching_factor) + ", leaf page size " +
+                                  std::to_string(leaf_page_size) + SOURCE_REF);
+        }
+        UpdateLayout();
+        BOOST_ASSERT(tiny_component_segments.empty() ||
+                     tiny_component_segments.size() == input_data_vector.size());
+
         const auto element_count = input_data_vector.size();
         std::vector<WrappedInputElement> input_wrapper_vector(element_count);
 
@@ -309,125 +406,21 @@ class StaticRTree
 
         // sort the hilbert-value representatives
         tbb::parallel_sort(input_wrapper_vector.begin(), input_wrapper_vector.end());
-        {
-            boost::iostreams::mapped_file out_objects_region;
-            auto out_objects = mmapFile<EdgeDataT>(on_disk_file_name,
-                                                   out_objects_region,
-                                                   input_data_vector.size() * sizeof(EdgeDataT));
-
-            // Note, we can't just write everything in one go, because the input_data_vector
-            // is not sorted by hilbert code, only the input_wrapper_vector is in the correct
-            // order.  Instead, we iterate over input_wrapper_vector, copy the hilbert-indexed
-            // entries from input_data_vector into a temporary contiguous array, then write
-            // that array to disk.
-
-            // Create the first level of TreeNodes - each bounding LEAF_NODE_COUNT EdgeDataT
-            // objects.
-            std::size_t wrapped_element_index = 0;
-            auto objects_iter = out_objects.begin();
-
-            while (wrapped_element_index < element_count)
-            {
-                TreeNode current_node;
-
-                // Loop over the next block of EdgeDataT, calculate the bounding box
-                // for the block, and save the data to write to disk in the correct
-                // order.
-                for (std::uint32_t object_index = 0;
-                     object_index < LEAF_NODE_SIZE && wrapped_element_index < element_count;
-                     ++object_index, ++wrapped_element_index)
-                {
-                    const std::uint32_t input_object_index =
-                        input_wrapper_vector[wrapped_element_index].m_original_index;
-                    const EdgeDataT &object = input_data_vector[input_object_index];
-
-                    *objects_iter++ = object;
-
-                    Coordinate projected_u{
-                        web_mercator::fromWGS84(Coordinate{m_coordinate_list[object.u]})};
-                    Coordinate projected_v{
-                        web_mercator::fromWGS84(Coordinate{m_coordinate_list[object.v]})};
-
-                    BOOST_ASSERT(std::abs(toFloating(projected_u.lon).operator double()) <= 180.);
-                    BOOST_ASSERT(std::abs(toFloating(projected_u.lat).operator double()) <= 180.);
-                    BOOST_ASSERT(std::abs(toFloating(projected_v.lon).operator double()) <= 180.);
-                    BOOST_ASSERT(std::abs(toFloating(projected_v.lat).operator double()) <= 180.);
-
-                    Rectangle rectangle;
-                    rectangle.min_lon =
-                        std::min(rectangle.min_lon, std::min(projected_u.lon, projected_v.lon));
-                    rectangle.max_lon =
-                        std::max(rectangle.max_lon, std::max(projected_u.lon, projected_v.lon));
-
-                    rectangle.min_lat =
-                        std::min(rectangle.min_lat, std::min(projected_u.lat, projected_v.lat));
-                    rectangle.max_lat =
-                        std::max(rectangle.max_lat, std::max(projected_u.lat, projected_v.lat));
-
-                    BOOST_ASSERT(rectangle.IsValid());
-                    current_node.minimum_bounding_rectangle.MergeBoundingBoxes(rectangle);
-                }
-
-                m_search_tree.emplace_back(current_node);
-            }
-        }
-        // mmap as read-only now
-        m_objects = mmapFile<EdgeDataT>(on_disk_file_name, m_objects_region);
 
-        // Should hold the number of nodes at the lowest level of the graph (closest
-        // to the data)
-        std::uint32_t nodes_in_previous_level = m_search_tree.size();
-
-        // Holds the number of TreeNodes in each level.
-        // We always start with the root node, so
-        // m_tree_level_sizes[0] should always be 1
-        std::vector<std::uint64_t> tree_level_sizes;
-        tree_level_sizes.push_back(nodes_in_previous_level);
-
-        // Now, repeatedly create levels of nodes that contain BRANCHING_FACTOR
-        // nodes from the previous level.
-        while (nodes_in_previous_level > 1)
+        // Every leaf bounds LEAF_NODE_COUNT objects and every node of the levels above bounds
+        // BRANCHING_FACTOR nodes of the level below. Knowing the sizes of all levels up front
+        // places every node at its final position, so that the nodes of a level are built in
+        // parallel. The levels are stored from the root at 0 down to the leaves, the nodes of a
+        // level in the order of their objects, which keeps the position math during searches
+        // easy to understand.
+        const std::uint64_t number_of_leaves =
+            (element_count + m_leaf_node_size - 1) / m_leaf_node_size;
+        std::vector<std::uint64_t> tree_level_sizes = {number_of_leaves};
+        while (tree_level_sizes.back() > 1)
         {
-            auto previous_level_start_pos = m_search_tree.size() - nodes_in_previous_level;
-
-            // We can calculate how many nodes will be in this level, we divide by
-            // BRANCHING_FACTOR
-            // and round up
-            std::uint32_t nodes_in_current_level =
-                std::ceil(static_cast<double>(nodes_in_previous_level) / BRANCHING_FACTOR);
-
-            for (auto current_node_idx : irange<std::size_t>(0, nodes_in_current_level))
-            {
-                TreeNode parent_node;
-                auto first_child_index =
-                    current_node_idx * BRANCHING_FACTOR + previous_level_start_pos;
-                auto last_child_index =
-                    first_child_index +
-                    std::min<std::size_t>(BRANCHING_FACTOR,
-                                          nodes_in_previous_level -
-                                              current_node_idx * BRANCHING_FACTOR);
-
-                // Calculate the bounding box for BRANCHING_FACTOR nodes in the previous
-                // level, then save that box as a new TreeNode in the new level.
-                for (auto child_node_idx : irange<std::size_t>(first_child_index, last_child_index))
-                {
-                    parent_node.minimum_bounding_rectangle.MergeBoundingBoxes(
-                        m_search_tree[child_node_idx].minimum_bounding_rectangle);
-                }
-                m_search_tree.emplace_back(parent_node);
-            }
-            nodes_in_previous_level = nodes_in_current_level;
-            tree_level_sizes.push_back(nodes_in_previous_level);
+            tree_level_sizes.push_back((tree_level_sizes.back() + m_branching_factor - 1) /
+                                       m_branching_factor);
         }
-        // At this point, we've got our tree built, but the nodes are in a weird order.
-        // Next thing we'll do is flip it around so that we don't end up with a lot of
-        // `size - n` math later on.
-
-        // Flip the tree so that the root node is at 0.
-        // This just makes our math during search a bit more intuitive
-        std::reverse(m_search_tree.begin(), m_search_tree.end());
-
-        // Same for the level sizes - root node / base level is at 0
         std::reverse(tree_level_sizes.begin(), tree_level_sizes.end());
 
         // The first level starts at 0
@@ -437,22 +430,96 @@ class StaticRTree
                          tree_level_sizes.end(),
                          std::back_inserter(m_tree_level_starts));
         BOOST_ASSERT(m_tree_level_starts.size() >= 2);
+        m_search_tree.resize(m_tree_level_starts.back());
+        m_bearing_masks.resize(m_tree_level_starts.back());
+        // a std::vector<bool> can not be written in parallel
+        const bool has_components = !tiny_component_segments.empty();
+        std::vector<std::uint8_t> big_component_nodes(has_components ? m_search_tree.size() : 0);
 
-        // Now we have to flip the coordinates within each level so that math is easier
-        // later on.  The workflow here is:
-        // The initial order of tree nodes in the m_search_tree array is roughly:
-        // 6789 345 12 0   (each block here is a level of the tree)
-        // Then we reverse it and get:
-        // 0 21 543 9876
-        // Now the loop below reverses each level to give us the final result
-        // 0 12 345 6789
-        // This ordering keeps the position math easy to understand during later
-        // searches
-        for (auto i : irange<std::size_t>(0, tree_level_sizes.size()))
+        const auto leaf_level = tree_level_sizes.size() - 1;
         {
-            std::reverse(m_search_tree.begin() + m_tree_level_starts[i],
-                         m_search_tree.begin() + m_tree_level_starts[i] + tree_level_sizes[i]);
+            boost::iostreams::mapped_file out_objects_region;
+            auto out_objects = mmapFile<EdgeDataT>(on_disk_file_name,
+                                                   out_objects_region,
+                                                   input_data_vector.size() * sizeof(EdgeDataT));
+
+            // The input_data_vector is not sorted by hilbert code, only the input_wrapper_vector
+            // is in the correct order. Every leaf copies its objects in that order to the mapped
+            // file and computes their bounding box, the leaves write disjoint parts of the file.
+            tbb::parallel_for(
+                tbb::blocked_range<std::uint64_t>(0, number_of_leaves),
+                [&](const tbb::blocked_range<std::uint64_t> &range) {
+                    for (auto leaf = range.begin(); leaf != range.end(); ++leaf)
+                    {
+                        const auto objects_begin = leaf * m_leaf_node_size;
+                        const auto objects_end = std::min<std::uint64_t>(
+                            objects_begin + m_leaf_node_size, element_count);
+
+                        TreeNode current_node;
+                        std::uint32_t bearing_sectors = 0;
+                        bool has_big_component = false;
+                        for (auto object_index : irange(objects_begin, objects_end))
+                        {
+                            const std::uint32_t input_object_index =
+                                input_wrapper_vector[object_index].m_original_index;
+                            const EdgeDataT &object = input_data_vector[input_object_index];
+
+                            out_objects[object_index] = object;
+
+                            current_node.minimum_bounding_rectangle.MergeBoundingBoxes(
+                                ProjectedBoundingBox(object));
+                            bearing_sectors |= BearingSectors(object);
+                            has_big_component = has_big_component ||
+                                                (has_components &&
+                                                 !tiny_component_segments[input_object_index]);
+                        }
+                        const auto node_index = m_tree_level_starts[leaf_level] + leaf;
+                        m_search_tree[node_index] = current_node;
+                        m_bearing_masks[node_index] = bearing_sectors;
+                        if (has_components)
+                            big_component_nodes[node_index] = has_big_component;
+                    }
+                });
         }
+        // mmap as read-only now
+        m_objects = mmapFile<EdgeDataT>(on_disk_file_name, m_objects_region);
+
+        // Build the levels from the leaves up to the root, each from the level below
+        for (auto level = leaf_level; level > 0; --level)
+        {
+            const auto parent_level_start = m_tree_level_starts[level - 1];
+            const auto child_level_start = m_tree_level_starts[level];
+            const auto child_level_end = m_tree_level_starts[level + 1];
+
+            tbb::parallel_for(
+                tbb::blocked_range<std::uint64_t>(0, tree_level_sizes[level - 1]),
+                [&](const tbb::blocked_range<std::uint64_t> &range) {
+                    for (auto parent = range.begin(); parent != range.end(); ++parent)
+                    {
+                        const auto children_begin = child_level_start + parent * m_branching_factor;
+                        const auto children_end = std::min<std::uint64_t>(
+                            children_begin + m_branching_factor, child_level_end);
+
+                        TreeNode parent_node;
+                        std::uint32_t bearing_sectors = 0;
+                        bool has_big_component = false;
+                        for (auto child : irange(children_begin, children_end))
+                        {
+                            parent_node.minimum_bounding_rectangle.MergeBoundingBoxes(
+                                m_search_tree[child].minimum_bounding_rectangle);
+                            bearing_sectors |= m_bearing_masks[child];
+                            has_big_component =
+                                has_big_component || (has_components && big_component_nodes[child]);
+                        }
+                        m_search_tree[parent_level_start + parent] = parent_node;
+                        m_bearing_masks[parent_level_start + parent] = bearing_sectors;
+                        if (has_components)
+                            big_component_nodes[parent_level_start + parent] = has_big_component;
+                    }
+                });
+        }
+
+        m_big_component_nodes.assign(big_component_nodes.begin(), big_component_nodes.end());
     }
 
     /**
@@ -466,6 +533,31 @@ class StaticRTree
         m_objects = mmapFile<EdgeDataT>(on_disk_file_name, m_objects_region);
     }
 
+    /**
+     * Constructs an r-tree from blocks of memory loaded by someone else, including the leaves
+     * that are usually mmap'd from the .fileIndex file
+     */
+    explicit StaticRTree(Vector<TreeNode> search_tree_,
+                         Vector<std::uint64_t> tree_level_starts,
+                         Vector<std::uint32_t> layout,
+                         Vector<std::uint32_t> bearing_masks,
+                         Vector<bool> big_component_nodes,
+                         util::vector_view<const EdgeDataT> objects,
+                         const Vector<Coordinate> &coordinate_list)
+        : m_search_tree(std::move(search_tree_)),
+          m_coordinate_list(coordinate_list.data(), coordinate_list.size()),
+          m_tree_level_starts(std::move(tree_level_starts)), m_objects(std::move(objects)),
+          m_layout(std::move(layout)), m_bearing_masks(std::move(bearing_masks)),
+          m_big_component_nodes(std::move(big_component_nodes))
+    {
+        BOOST_ASSERT(m_tree_level_starts.size() >= 2);
+        // osrm-datastore creates the view before it reads the .ramIndex into it
+        if (m_layout.size() != 2 || m_layout[0] != 0)
+        {
+            UpdateLayout();
+        }
+    }
+
     /**
      * Constructs an r-tree from blocks of memory loaded by someone else
      * (usually a shared memory block created by osrm-datastore)
@@ -474,13 +566,23 @@ class StaticRTree
      */
     explicit StaticRTree(Vector<TreeNode> search_tree_,
                          Vector<std::uint64_t> tree_level_starts,
+                         Vector<std::uint32_t> layout,
+                         Vector<std::uint32_t> bearing_masks,
+                         Vector<bool> big_component_nodes,
                          const boost::filesystem::path &on_disk_file_name,
                          const Vector<Coordinate> &coordinate_list)
         : m_search_tree(std::move(search_tree_)),
           m_coordinate_list(coordinate_list.data(), coordinate_list.size()),
-          m_tree_level_starts(std::move(tree_level_starts))
+          m_tree_level_starts(std::move(tree_level_starts)), m_layout(std::move(layout)),
+          m_bearing_masks(std::move(bearing_masks)),
+          m_big_component_nodes(std::move(big_component_nodes))
     {
         BOOST_ASSERT(m_tree_level_starts.size() >= 2);
+        // osrm-datastore creates the view before it reads the .ramIndex into it
+        if (m_layout.size() != 2 || m_layout[0] != 0)
+        {
+            UpdateLayout();
+        }
         m_objects = mmapFile<EdgeDataT>(on_disk_file_name, m_objects_region);
     }
 
@@ -559,18 +661,147 @@ class StaticRTree
     std::vector<EdgeDataT> Nearest(const Coordinate input_coordinate,
                                    const std::size_t max_results) const
     {
-        return Nearest(input_coordinate,
-                       [](const CandidateSegment &) { return std::make_pair(true, true); },
-                       [max_results](const std::size_t num_results, const CandidateSegment &) {
-                           return num_results >= max_results;
-                       });
+        return NearestK(input_coordinate,
+                        max_results,
+                        [](const CandidateSegment &) { return std::make_pair(true, true); },
+                        [](const CandidateSegment &) { return false; });
     }
 
-    // Override filter and terminator for the desired behaviour.
+    // Returns the max_results nearest segments the filter accepts, nearest first, like Nearest
+    // with a terminator that counts the results. Only the max_results nearest accepted segments
+    // found so far are kept, subtrees and segments that are not nearer than the last of them
+    // are never queued. The first segment that is_too_far is true for ends the search like a
+    // terminator: no segment in the same or a larger distance is returned.
+    template <typename FilterT, typename TooFarT>
+    std::vector<EdgeDataT>
+    NearestK(const Coordinate input_coordinate,
+             const std::size_t max_results,
+             const FilterT filter,
+             const TooFarT is_too_far,
+             const std::uint32_t bearing_sectors = bearing::ALL_SECTORS) const
+    {
+        std::vector<EdgeDataT> results;
+        if (max_results == 0)
+        {
+            return results;
+        }
+
+        auto projected_coordinate = web_mercator::fromWGS84(input_coordinate);
+        Coordinate fixed_projected_coordinate{projected_coordinate};
+
+        // the buffers keep their capacity for the next query of the thread
+        auto &buffers = GetNearestKBuffers();
+        auto &nearest = buffers.nearest;
+        nearest.clear();
+        buffers.traversal_queue.clear();
+        PruningQueue traversal_queue{buffers.traversal_queue,
+                                     std::numeric_limits<std::uint64_t>::max()};
+        traversal_queue.push(QueryCandidate{0, TreeIndex{}});
+
+        // a max-heap, the farthest of the nearest segments is at the front. Segments in the same
+        // distance are ordered by their position in the leaves to return them deterministically.
+        const auto nearer = [](const NearestSegment &lhs, const NearestSegment &rhs) {
+            return std::tie(lhs.squared_distance, lhs.segment_index) <
+                   std::tie(rhs.squared_distance, rhs.segment_index);
+        };
+        std::uint64_t too_far_distance = std::numeric_limits<std::uint64_t>::max();
+        const auto update_bound = [&] {
+            traversal_queue.bound = too_far_distance;
+            if (nearest.size() == max_results)
+            {
+                traversal_queue.bound =
+                    std::min(traversal_queue.bound, nearest.front().squared_distance);
+            }
+        };
+
+        while (!traversal_queue.empty())
+        {
+            const auto current_query_node = traversal_queue.pop();
+            // all other candidates are at least as far
+            if (current_query_node.squared_min_dist >= traversal_queue.bound)
+            {
+                break;
+            }
+
+            const TreeIndex &current_tree_index = current_query_node.tree_index;
+            if (!current_query_node.is_segment())
+            {
+                if (is_leaf(current_tree_index))
+                {
+                    ExploreLeafNode(current_tree_index, input_coordinate, traversal_queue);
+                }
+                else
+                {
+                    ExploreTreeNode(current_tree_index,
+                                    fixed_projected_coordinate,
+                                    bearing_sectors,
+                                    false,
+                                    traversal_queue);
+                }
+                continue;
+            }
+
+            BOOST_ASSERT(!current_query_node.is_projected);
+            const auto projected_node = ProjectSegment(
+                current_query_node, fixed_projected_coordinate, projected_coordinate);
+            if (projected_node.squared_min_dist >= traversal_queue.bound)
+            {
+                continue;
+            }
+
+            auto edge_data = m_objects[projected_node.segment_index];
+            const auto &current_candidate =
+                CandidateSegment{projected_node.fixed_projected_coordinate, edge_data};
+            if (is_too_far(current_candidate))
+            {
+                too_far_distance = projected_node.squared_min_dist;
+                while (!nearest.empty() && nearest.front().squared_distance >= too_far_distance)
+                {
+                    std::pop_heap(nearest.begin(), nearest.end(), nearer);
+                    nearest.pop_back();
+                }
+                update_bound();
+                continue;
+            }
+
+            auto use_segment = filter(current_candidate);
+            if (!use_segment.first && !use_segment.second)
+            {
+                continue;
+            }
+            edge_data.forward_segment_id.enabled &= use_segment.first;
+            edge_data.reverse_segment_id.enabled &= use_segment.second;
+
+            nearest.push_back(NearestSegment{
+                projected_node.squared_min_dist, projected_node.segment_index, edge_data});
+            std::push_heap(nearest.begin(), nearest.end(), nearer);
+            if (nearest.size() > max_results)
+            {
+                std::pop_heap(nearest.begin(), nearest.end(), nearer);
+                nearest.pop_back();
+            }
+            update_bound();
+        }
+
+        std::sort_heap(nearest.begin(), nearest.end(), nearer);
+        results.reserve(nearest.size());
+        for (auto &segment : nearest)
+        {
+            results.push_back(std::move(segment.data));
+        }
+        return results;
+    }
+
+    // Override filter and terminator for the desired behaviour. Subtrees without a segment in
+    // one of the bearing_sectors are skipped, the filter is still applied to every segment. With
+    // big_components_after_first_result subtrees that only have segments in tiny components are
+    // skipped once a result is found, for filters that only accept big components from then on.
     template <typename FilterT, typename TerminationT>
     std::vector<EdgeDataT> Nearest(const Coordinate input_coordinate,
                                    const FilterT filter,
-                                   const TerminationT terminate) const
+                                   const TerminationT terminate,
+                                   const std::uint32_t bearing_sectors = bearing::ALL_SECTORS,
+                                   const bool big_components_after_first_result = false) const
     {
         std::vector<EdgeDataT> results;
         auto projected_coordinate = web_mercator::fromWGS84(input_coordinate);
@@ -585,21 +816,34 @@ class StaticRTree
             traversal_queue.pop();
 
             const TreeIndex &current_tree_index = current_query_node.tree_index;
+            const bool big_components_only =
+                big_components_after_first_result && !results.empty();
             if (!current_query_node.is_segment())
             { // current object is a tree node
+                // the node could have been queued before the first result was found
+                if (big_components_only && !HasBigComponent(current_tree_index))
+                {
+                    continue;
+                }
+
                 if (is_leaf(current_tree_index))
                 {
-                    ExploreLeafNode(current_tree_index,
-                                    fixed_projected_coordinate,
-                                    projected_coordinate,
-                                    traversal_queue);
+                    ExploreLeafNode(current_tree_index, input_coordinate, traversal_queue);
                 }
                 else
                 {
-                    ExploreTreeNode(
-                        current_tree_index, fixed_projected_coordinate, traversal_queue);
+                    ExploreTreeNode(current_tree_index,
+                                    fixed_projected_coordinate,
+                                    bearing_sectors,
+                                    big_components_only,
+                                    traversal_queue);
                 }
             }
+            else if (!current_query_node.is_projected)
+            { // current candidate is a road segment with a lower bound of its distance
+                traversal_queue.push(ProjectSegment(
+                    current_query_node, fixed_projected_coordinate, projected_coordinate));
+            }
             else
             { // current candidate is an actual road segment
                 // We deliberatly make a copy here, we mutate the value below
@@ -632,45 +876,147 @@ class StaticRTree
     }
 
   private:
+    // The sectors of the bearings of the directions of the segment of an object that can be
+    // snapped to, computed like GeospatialQuery::CheckSegmentBearing computes the bearings
+    std::uint32_t BearingSectors(const EdgeDataT &object) const
+    {
+        const double forward_bearing = coordinate_calculation::bearing(
+            m_coordinate_list[object.u], m_coordinate_list[object.v]);
+        const double backward_bearing =
+            (forward_bearing + 180) > 360 ? (forward_bearing - 180) : (forward_bearing + 180);
+
+        std::uint32_t sectors = 0;
+        if (object.forward_segment_id.enabled)
+            sectors |= bearing::sectorMask(static_cast<int>(std::round(forward_bearing)));
+        if (object.reverse_segment_id.enabled)
+            sectors |= bearing::sectorMask(static_cast<int>(std::round(backward_bearing)));
+        return sectors;
+    }
+
+    // The bounding box of the segment of an object in web mercator coordinates
+    Rectangle ProjectedBoundingBox(const EdgeDataT &object) const
+    {
+        Coordinate projected_u{web_mercator::fromWGS84(Coordinate{m_coordinate_list[object.u]})};
+        Coordinate projected_v{web_mercator::fromWGS84(Coordinate{m_coordinate_list[object.v]})};
+
+        BOOST_ASSERT(std::abs(toFloating(projected_u.lon).operator double()) <= 180.);
+        BOOST_ASSERT(std::abs(toFloating(projected_u.lat).operator double()) <= 180.);
+        BOOST_ASSERT(std::abs(toFloating(projected_v.lon).operator double()) <= 180.);
+        BOOST_ASSERT(std::abs(toFloating(projected_v.lat).operator double()) <= 180.);
+
+        Rectangle rectangle;
+        rectangle.min_lon = std::min(rectangle.min_lon, std::min(projected_u.lon, projected_v.lon));
+        rectangle.max_lon = std::max(rectangle.max_lon, std::max(projected_u.lon, projected_v.lon));
+
+        rectangle.min_lat = std::min(rectangle.min_lat, std::min(projected_u.lat, projected_v.lat));
+        rectangle.max_lat = std::max(rectangle.max_lat, std::max(projected_u.lat, projected_v.lat));
+
+        BOOST_ASSERT(rectangle.IsValid());
+        return rectangle;
+    }
+
     /**
      * Iterates over all the objects in a leaf node and inserts them into our
      * search priority queue.  The speed of this function is very much governed
-     * by the value of LEAF_NODE_SIZE, as we'll calculate the euclidean distance
-     * for every child of each leaf node visited.
+     * by the leaf node size, as we'll calculate a distance for every
+     * child of each leaf node visited.
+     *
+     * Projecting the segments onto the input coordinate is expensive, so the segments are
+     * inserted with a lower bound of their distance and only projected once they come to the
+     * front of the queue (see ProjectSegment).  The web mercator projection keeps longitudes
+     * and stretches latitude differences, so the squared distance of the input coordinate to
+     * the unprojected bounding box of a segment is a lower bound of its projected distance.
+     * The bounding boxes are gathered into fixed-point arrays, the bounds are computed in a
+     * loop that the compiler vectorizes.
      */
     template <typename QueueT>
     void ExploreLeafNode(const TreeIndex &leaf_id,
-                         const Coordinate &projected_input_coordinate_fixed,
-                         const FloatCoordinate &projected_input_coordinate,
+                         const Coordinate &input_coordinate,
                          QueueT &traversal_queue) const
     {
         // Check that we're actually looking at the bottom level of the tree
         BOOST_ASSERT(is_leaf(leaf_id));
 
-        for (const auto i : child_indexes(leaf_id))
+        // the projection clamps the latitudes, so the bounds are computed on clamped latitudes
+        const auto max_latitude = static_cast<std::int32_t>(
+            toFixed(FloatLatitude{web_mercator::detail::EPSG3857_MAX_LATITUDE}));
+        const auto clamp_latitude = [max_latitude](const FixedLatitude latitude) {
+            return std::max(-max_latitude,
+                            std::min(max_latitude, static_cast<std::int32_t>(latitude)));
+        };
+
+        // one unit less per axis, the projected distances are rounded to fixed-point coordinates
+        const auto lon = static_cast<std::int32_t>(input_coordinate.lon);
+        const auto lat = clamp_latitude(input_coordinate.lat);
+
+        // the leaf size is a property of the tree, the children are processed in fixed blocks
+        const auto children = child_indexes(leaf_id);
+        BOOST_ASSERT(children.size() <= m_leaf_node_size);
+        for (auto block_begin = *children.begin(); block_begin < *children.end();
+             block_begin += LEAF_BLOCK_SIZE)
         {
-            const auto &current_edge = m_objects[i];
-
-            const auto projected_u = web_mercator::fromWGS84(m_coordinate_list[current_edge.u]);
-            const auto projected_v = web_mercator::fromWGS84(m_coordinate_list[current_edge.v]);
-
-            FloatCoordinate projected_nearest;
-            std::tie(std::ignore, projected_nearest) =
-                coordinate_calculation::projectPointOnSegment(
-                    projected_u, projected_v, projected_input_coordinate);
-
-            const auto squared_distance = coordinate_calculation::squaredEuclideanDistance(
-                projected_input_coordinate_fixed, projected_nearest);
-            // distance must be non-negative
-            BOOST_ASSERT(0. <= squared_distance);
-            BOOST_ASSERT(i < std::numeric_limits<std::uint32_t>::max());
-            traversal_queue.push(QueryCandidate{squared_distance,
-                                                leaf_id,
-                                                static_cast<std::uint32_t>(i),
-                                                Coordinate{projected_nearest}});
+            const auto block_size =
+                std::min<std::size_t>(LEAF_BLOCK_SIZE, *children.end() - block_begin);
+
+            std::array<std::int32_t, LEAF_BLOCK_SIZE> min_lons, max_lons, min_lats, max_lats;
+            for (std::size_t index = 0; index < block_size; ++index)
+            {
+                const auto &current_edge = m_objects[block_begin + index];
+                const auto &u = m_coordinate_list[current_edge.u];
+                const auto &v = m_coordinate_list[current_edge.v];
+                min_lons[index] = static_cast<std::int32_t>(std::min(u.lon, v.lon));
+                max_lons[index] = static_cast<std::int32_t>(std::max(u.lon, v.lon));
+                min_lats[index] = clamp_latitude(std::min(u.lat, v.lat));
+                max_lats[index] = clamp_latitude(std::max(u.lat, v.lat));
+            }
+
+            std::array<std::uint64_t, LEAF_BLOCK_SIZE> lower_bounds;
+            for (std::size_t index = 0; index < block_size; ++index)
+            {
+                const std::uint32_t dx =
+                    std::max(0, std::max(min_lons[index] - lon, lon - max_lons[index]) - 1);
+                const std::uint32_t dy =
+                    std::max(0, std::max(min_lats[index] - lat, lat - max_lats[index]) - 1);
+                lower_bounds[index] = static_cast<std::uint64_t>(dx) * dx +
+                                      static_cast<std::uint64_t>(dy) * dy;
+            }
+
+            for (std::size_t index = 0; index < block_size; ++index)
+            {
+                BOOST_ASSERT(block_begin + index < std::numeric_limits<std::uint32_t>::max());
+                traversal_queue.push(
+                    QueryCandidate{lower_bounds[index],
+                                   leaf_id,
+                                   static_cast<std::uint32_t>(block_begin + index)});
+            }
         }
     }
 
+    // Computes the distance of a segment candidate and returns it with its projection
+    QueryCandidate ProjectSegment(const QueryCandidate &candidate,
+                                  const Coordinate &projected_input_coordinate_fixed,
+                                  const FloatCoordinate &projected_input_coordinate) const
+    {
+        const auto &current_edge = m_objects[candidate.segment_index];
+
+        const auto projected_u = web_mercator::fromWGS84(m_coordinate_list[current_edge.u]);
+        const auto projected_v = web_mercator::fromWGS84(m_coordinate_list[current_edge.v]);
+
+        FloatCoordinate projected_nearest;
+        std::tie(std::ignore, projected_nearest) = coordinate_calculation::projectPointOnSegment(
+            projected_u, projected_v, projected_input_coordinate);
+
+        const auto squared_distance = coordinate_calculation::squaredEuclideanDistance(
+            projected_input_coordinate_fixed, projected_nearest);
+        // distance must be non-negative
+        BOOST_ASSERT(0. <= squared_distance);
+        BOOST_ASSERT(candidate.squared_min_dist <= squared_distance);
+        return QueryCandidate{squared_distance,
+                              candidate.tree_index,
+                              candidate.segment_index,
+                              Coordinate{projected_nearest}};
+    }
+
     /**
      * Iterates over all the children of a TreeNode and inserts them into the search
      * priority queue using their distance from the search coordinate as the
@@ -681,6 +1027,8 @@ class StaticRTree
     template <class QueueT>
     void ExploreTreeNode(const TreeIndex &parent,
                          const Coordinate &fixed_projected_input_coordinate,
+                         const std::uint32_t bearing_sectors,
+                         const bool big_components_only,
                          QueueT &traversal_queue) const
     {
         // Figure out which_id level the parent is on, and it's offset
@@ -688,8 +1036,16 @@ class StaticRTree
         // Check that we're actually looking at the bottom level of the tree
         BOOST_ASSERT(!is_leaf(parent));
 
+        const bool check_bearings =
+            bearing_sectors != bearing::ALL_SECTORS && !m_bearing_masks.empty();
+        const bool check_components = big_components_only && !m_big_component_nodes.empty();
         for (const auto child_index : child_indexes(parent))
         {
+            if (check_bearings && (m_bearing_masks[child_index] & bearing_sectors) == 0)
+                continue;
+            if (check_components && !m_big_component_nodes[child_index])
+                continue;
+
             const auto &child = m_search_tree[child_index];
 
             const auto squared_lower_bound_to_element =
@@ -702,6 +1058,12 @@ class StaticRTree
         }
     }
 
+    bool HasBigComponent(const TreeIndex &node) const
+    {
+        return m_big_component_nodes.empty() ||
+               m_big_component_nodes[m_tree_level_starts[node.level] + node.offset];
+    }
+
     std::uint64_t GetLevelSize(const std::size_t level) const
     {
         BOOST_ASSERT(m_tree_level_starts.size() > level + 1);
@@ -729,9 +1091,10 @@ class StaticRTree
         // there is only 1 level of object data in the m_objects array
         if (is_leaf(parent))
         {
-            const std::uint64_t first_child_index = parent.offset * LEAF_NODE_SIZE;
+            const std::uint64_t first_child_index =
+                static_cast<std::uint64_t>(parent.offset) * m_leaf_node_size;
             const std::uint64_t end_child_index = std::min(
-                first_child_index + LEAF_NODE_SIZE, static_cast<std::uint64_t>(m_objects.size()));
+                first_child_index + m_leaf_node_size, static_cast<std::uint64_t>(m_objects.size()));
 
             BOOST_ASSERT(first_child_index < std::numeric_limits<std::uint32_t>::max());
             BOOST_ASSERT(end_child_index < std::numeric_limits<std::uint32_t>::max());
@@ -742,10 +1105,11 @@ class StaticRTree
         else
         {
             const std::uint64_t first_child_index =
-                m_tree_level_starts[parent.level + 1] + parent.offset * BRANCHING_FACTOR;
+                m_tree_level_starts[parent.level + 1] +
+                static_cast<std::uint64_t>(parent.offset) * m_branching_factor;
 
             const std::uint64_t end_child_index =
-                std::min(first_child_index + BRANCHING_FACTOR,
+                std::min(first_child_index + m_branching_factor,
                          m_tree_level_starts[parent.level + 1] + GetLevelSize(parent.level + 1));
             BOOST_ASSERT(first_child_index < std::numeric_limits<std::uint32_t>::max());
             BOOST_ASSERT(end_child_index < std::numeric_limits<std::uint32_t>::max());
@@ -756,6 +1120,19 @@ class StaticRTree
         }
     }
 
+    // Takes the branching factor and the leaf node size from the stored layout
+    void UpdateLayout()
+    {
+        if (m_layout.size() != 2 || !IsValidLayout(m_layout[0], m_layout[1]))
+        {
+            throw util::exception("Invalid r-tree layout, the .ramIndex needs to be extracted "
+                                  "again" +
+                                  SOURCE_REF);
+        }
+        m_branching_factor = m_layout[0];
+        m_leaf_node_size = m_layout[1] / sizeof(EdgeDataT);
+    }
+
     bool is_leaf(const TreeIndex &treeindex) const
     {
         BOOST_ASSERT(m_tree_level_starts.size() >= 2);
@@ -58,6 +58,32 @@ template <int length, int precision> char *printInt(char *buffer, int value)
     return buffer;
 }
 
+// Returns the escape sequence of a character in a JSON string or nullptr if it needs none
+inline const char *getJSONEscapeSequence(const char letter)
+{
+    switch (letter)
+    {
+    case '\\':
+        return "\\\\";
+    case '"':
+        return "\\\"";
+    case '/':
+        return "\\/";
+    case '\b':
+        return "\\b";
+    case '\f':
+        return "\\f";
+    case '\n':
+        return "\\n";
+    case '\r':
+        return "\\r";
+    case '\t':
+        return "\\t";
+    default:
+        return nullptr;
+    }
+}
+
 inline std::string escape_JSON(const std::string &input)
 {
     // escape and skip reallocations if possible
@@ -65,35 +91,13 @@ inline std::string escape_JSON(const std::string &input)
     output.reserve(input.size() + 4); // +4 assumes two backslashes on avg
     for (const char letter : input)
     {
-        switch (letter)
+        if (const auto escape_sequence = getJSONEscapeSequence(letter))
+        {
+            output += escape_sequence;
+        }
+        else
         {
-        case '\\':
-            output += "\\\\";
-            break;
-        case '"':
-            output += "\\\"";
-            break;
-        case '/':
-            output += "\\/";
-            break;
-        case '\b':
-            output += "\\b";
-            break;
-        case '\f':
-            output += "\\f";
-            break;
-        case '\n':
-            output += "\\n";
-            break;
-        case '\r':
-            output += "\\r";
-            break;
-        case '\t':
-            output += "\\t";
-            break;
-        default:
             output.append(1, letter);
-            break;
         }
     }
     return output;
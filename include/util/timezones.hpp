@@ -5,28 +5,47 @@
 
 #include <boost/filesystem/path.hpp>
 #include <boost/geometry.hpp>
-#include <boost/geometry/index/rtree.hpp>
 #include <boost/optional.hpp>
 
-#include <rapidjson/document.h>
-
 #include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace osrm
 {
 namespace updater
 {
 
-// Time zone shape polygons loaded in R-tree
-// local_time_t is a pair of a time zone shape polygon and the corresponding local time
-// rtree_t is a lookup R-tree that maps a geographic point to an index in a local_time_t vector
+// Time zone shape polygons loaded in a grid
+// point_t is a geographic point of longitude and latitude in degrees
+// polygon_t is the exterior ring of a time zone shape polygon
 using point_t = boost::geometry::model::
     point<double, 2, boost::geometry::cs::spherical_equatorial<boost::geometry::degree>>;
 using polygon_t = boost::geometry::model::polygon<point_t>;
 using box_t = boost::geometry::model::box<point_t>;
-using rtree_t =
-    boost::geometry::index::rtree<std::pair<box_t, size_t>, boost::geometry::index::rstar<8>>;
-using local_time_t = std::pair<polygon_t, struct tm>;
+
+// Polygons of the time zones in a grid of cells. Every cell lists the polygons that cover it
+// completely and those whose boundary crosses it, only the latter need an exact test.
+struct TimezoneIndex
+{
+    std::vector<polygon_t> polygons;
+    // index of the time zone of every polygon
+    std::vector<std::size_t> polygon_zones;
+    std::vector<std::string> zone_names;
+
+    box_t bounds;
+    std::size_t columns = 0;
+    std::size_t rows = 0;
+    double cell_width = 1.;
+    double cell_height = 1.;
+    // entries of the cells in rows from the bottom, every entry is the polygon << 1 and a bit
+    // that is set if the boundary of the polygon crosses the cell
+    std::vector<std::uint32_t> first_entries;
+    std::vector<std::uint32_t> entries;
+};
 
 class Timezoner
 {
@@ -34,15 +53,21 @@ class Timezoner
     Timezoner() = default;
 
     Timezoner(const char geojson[], std::time_t utc_time_now);
+    // The index of the file is cached, it is only loaded again if the file changes
     Timezoner(const boost::filesystem::path &tz_shapes_filename, std::time_t utc_time_now);
 
     boost::optional<struct tm> operator()(const point_t &point) const;
 
+    // Looks up the points in parallel and in the order of their Hilbert values, so nearby
+    // points share the cells and polygons that are tested
+    std::vector<boost::optional<struct tm>> operator()(const std::vector<point_t> &points) const;
+
   private:
-    void LoadLocalTimesRTree(rapidjson::Document &geojson, std::time_t utc_time);
+    void LoadLocalTimes(std::time_t utc_time);
 
-    rtree_t rtree;
-    std::vector<local_time_t> local_times;
+    std::shared_ptr<const TimezoneIndex> index;
+    // local time of every time zone of the index
+    std::vector<struct tm> local_times;
 };
 }
 }
@@ -226,6 +226,36 @@ template <> class vector_view<bool>
         return reference{m_ptr + bucket, static_cast<Word>(1) << offset};
     }
 
+    // Returns the index of the first set bit in [first, last) or last, a word at a time
+    std::size_t find_next(std::size_t first, const std::size_t last) const
+    {
+        BOOST_ASSERT(last <= m_size);
+        while (first < last)
+        {
+            const auto offset = first % WORD_BITS;
+            const Word word = m_ptr[first / WORD_BITS] >> offset;
+            if (word != 0)
+            {
+                return std::min<std::size_t>(first + __builtin_ctzll(word), last);
+            }
+            first += WORD_BITS - offset;
+        }
+        return last;
+    }
+
+    // True if all bits are set
+    bool all() const
+    {
+        const auto full_words = m_size / WORD_BITS;
+        if (std::any_of(m_ptr, m_ptr + full_words, [](const Word word) { return ~word != 0; }))
+        {
+            return false;
+        }
+        const auto tail_bits = m_size % WORD_BITS;
+        const Word tail_mask = (static_cast<Word>(1) << tail_bits) - 1;
+        return tail_bits == 0 || (m_ptr[full_words] & tail_mask) == tail_mask;
+    }
+
     template <typename T> friend void swap(vector_view<T> &, vector_view<T> &) noexcept;
 };
 
@@ -481,9 +481,24 @@ function process_turn(profile, turn)
   end
 end
 
+-- process all ways of a batch with one call from the extractor
+function process_ways(profile, ways, results, relations)
+  for i = 1, #ways do
+    process_way(profile, ways[i], results[i], relations)
+  end
+end
+
+function process_turns(profile, turns)
+  for i = 1, #turns do
+    process_turn(profile, turns[i])
+  end
+end
+
 return {
   setup = setup,
   process_way = process_way,
+  process_ways = process_ways,
   process_node = process_node,
-  process_turn = process_turn
+  process_turn = process_turn,
+  process_turns = process_turns
 }
@@ -0,0 +1,176 @@
+#!/usr/bin/env node
+
+'use strict';
+
+// Runs osrm-extract, osrm-partition, osrm-customize and osrm-contract on an extract with an
+// increasing number of threads and prints the speedup of every tool and of every phase of their
+// --phase-report over the run with the fewest threads. Phases that don't get faster with more
+// threads are the serial parts of the pipeline.
+//
+//   pipeline-scaling.js [options] <extract.osm.pbf>
+//
+//   --build-dir <dir>   directory of the tools, default ../build
+//   --profile <file>    profile of osrm-extract, default profiles/car.lua
+//   --threads <list>    comma separated numbers of threads, default 1,2,4,... up to the CPUs
+//   --repeat <n>        runs per number of threads, the fastest run counts, default 1
+//   --work-dir <dir>    directory of the data and the reports, default a temporary directory
+//   --output <file>     also write all reports and speedups as JSON
+
+const child_process = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+const STAGES = [
+    {tool: 'osrm-extract', args: (options, base) => [options.extract, '-p', options.profile]},
+    {tool: 'osrm-partition', args: (options, base) => [base]},
+    {tool: 'osrm-customize', args: (options, base) => [base]},
+    {tool: 'osrm-contract', args: (options, base) => [base]}
+];
+
+function defaultThreads() {
+    const cpus = os.cpus().length;
+    let threads = [];
+    for (let count = 1; count < cpus; count *= 2) threads.push(count);
+    threads.push(cpus);
+    return threads;
+}
+
+function parseArguments(argv) {
+    let options = {
+        build_dir: path.join(__dirname, '../build'),
+        profile: path.join(__dirname, '../profiles/car.lua'),
+        threads: defaultThreads(),
+        repeat: 1
+    };
+    for (let index = 0; index < argv.length; ++index) {
+        const value = () => {
+            if (index + 1 >= argv.length) throw new Error(`${argv[index]} needs a value`);
+            return argv[++index];
+        };
+        switch (argv[index]) {
+        case '--build-dir': options.build_dir = value(); break;
+        case '--profile': options.profile = value(); break;
+        case '--threads': options.threads = value().split(',').map(Number); break;
+        case '--repeat': options.repeat = Number(value()); break;
+        case '--work-dir': options.work_dir = value(); break;
+        case '--output': options.output = value(); break;
+        default:
+            if (argv[index].startsWith('-') || options.extract)
+                throw new Error(`unknown argument ${argv[index]}`);
+            options.extract = argv[index];
+        }
+    }
+    if (!options.extract) throw new Error('no extract given');
+    if (!options.threads.every((threads) => Number.isInteger(threads) && threads > 0))
+        throw new Error('the numbers of threads need to be positive integers');
+    if (!(options.repeat > 0)) throw new Error('--repeat needs to be positive');
+    return options;
+}
+
+// Runs a tool and returns its report, the wall time of phases with the same name is summed
+function runStage(options, stage, base, threads) {
+    const report_path = path.join(options.work_dir, `${stage.tool}-${threads}.json`);
+    const args = stage.args(options, base).concat(['--threads', String(threads),
+                                                     '--phase-report', report_path]);
+    const result = child_process.spawnSync(path.join(options.build_dir, stage.tool), args,
+                                           {stdio: ['ignore', 'ignore', 'inherit']});
+    if (result.error) throw result.error;
+    if (result.status !== 0) throw new Error(`${stage.tool} ${args.join(' ')} failed`);
+
+    const report = JSON.parse(fs.readFileSync(report_path, 'utf8'));
+    let phases = {};
+    report.phases.forEach((phase) => {
+        phases[phase.name] = (phases[phase.name] || 0) + phase.wall_seconds;
+    });
+    return {wall_seconds: report.wall_seconds, cpu_seconds: report.cpu_seconds, phases: phases};
+}
+
+function fastest(runs) {
+    return runs.reduce((best, run) => run.wall_seconds < best.wall_seconds ? run : best);
+}
+
+function pad(text, width) {
+    return text.length >= width ? text : ' '.repeat(width - text.length) + text;
+}
+
+function padEnd(text, width) {
+    return text.length >= width ? text : text + ' '.repeat(width - text.length);
+}
+
+// One row per tool and per phase with the seconds and the speedup for every number of threads
+function printTable(options, results) {
+    const name_width = Math.max.apply(null, results.map((result) =>
+        Math.max.apply(null, [result.tool.length]
+            .concat(Object.keys(result.runs[0].phases).map((name) => name.length + 2)))));
+    const header = pad('', name_width) + options.threads.map((threads) =>
+        pad(`${threads} thr`, 10) + pad('speedup', 9)).join('');
+    console.log(header);
+
+    const printRow = (name, seconds) => {
+        console.log(padEnd(name, name_width) + seconds.map((value) => {
+            const speedup = value > 0 ? seconds[0] / value : 0;
+            return pad(value.toFixed(2) + 's', 10) + pad(speedup.toFixed(2) + 'x', 9);
+        }).join(''));
+    };
+
+    results.forEach((result) => {
+        printRow(result.tool, result.runs.map((run) => run.wall_seconds));
+        Object.keys(result.runs[0].phases).forEach((name) => {
+            printRow('  ' + name, result.runs.map((run) => run.phases[name] || 0));
+        });
+    });
+}
+
+function main() {
+    let options;
+    try {
+        options = parseArguments(process.argv.slice(2));
+    } catch (error) {
+        console.error(`${error.message}\nUsage: pipeline-scaling.js [options] <extract.osm.pbf>`);
+        process.exit(1);
+    }
+    if (!options.work_dir) {
+        options.work_dir = path.join(os.tmpdir(), `osrm-pipeline-scaling-${process.pid}`);
+        fs.mkdirSync(options.work_dir);
+    }
+
+    // the tools write their files next to the extract
+    const extract = path.join(options.work_dir, path.basename(options.extract));
+    if (path.resolve(extract) !== path.resolve(options.extract))
+        fs.writeFileSync(extract, fs.readFileSync(options.extract));
+    options.extract = extract;
+    const base = extract.replace(/\.osm(\.pbf|\.bz2)?$/, '') + '.osrm';
+
+    let results = STAGES.map((stage) => { return {tool: stage.tool, runs: []}; });
+    options.threads.forEach((threads) => {
+        let runs = STAGES.map(() => []);
+        for (let repetition = 0; repetition < options.repeat; ++repetition) {
+            // every stage reads what the stage before it wrote with the same number of threads
+            STAGES.forEach((stage, index) => {
+                console.error(`${stage.tool} with ${threads} threads, run ${repetition + 1}`);
+                runs[index].push(runStage(options, stage, base, threads));
+            });
+        }
+        runs.forEach((stage_runs, index) => results[index].runs.push(fastest(stage_runs)));
+    });
+
+    printTable(options, results);
+
+    if (options.output) {
+        fs.writeFileSync(options.output, JSON.stringify({
+            extract: path.basename(options.extract),
+            threads: options.threads,
+            stages: results.map((result) => {
+                return {
+                    tool: result.tool,
+                    runs: result.runs.map((run, index) => Object.assign(
+                        {threads: options.threads[index],
+                         speedup: result.runs[0].wall_seconds / run.wall_seconds}, run))
+                };
+            })
+        }, null, 2) + '\n');
+    }
+}
+
+main();
@@ -0,0 +1,51 @@
+#!/usr/bin/env python
+
+# Converts an ASCII raster source of the Lua raster API into a binary raster file that is
+# mapped into memory instead of being parsed for every Lua context.
+
+import array
+import struct
+import sys
+
+if len(sys.argv) < 3:
+    sys.stderr.write("Usage: " + sys.argv[0] + " raster.asc raster.bin [int16|int32]\n")
+    sys.exit(1)
+
+ascii_path = sys.argv[1]
+binary_path = sys.argv[2]
+value_type = sys.argv[3] if len(sys.argv) > 3 else "int16"
+if value_type not in ("int16", "int32"):
+    sys.stderr.write("Unknown value type " + value_type + "\n")
+    sys.exit(1)
+
+columns = None
+rows = 0
+values = array.array("h" if value_type == "int16" else "i")
+limit = 2 ** (8 * values.itemsize - 1)
+with open(ascii_path) as f:
+    for line in f:
+        row = [int(value) for value in line.split()]
+        if not row:
+            continue
+        if columns is None:
+            columns = len(row)
+        elif len(row) != columns:
+            sys.stderr.write("Row %d has %d instead of %d columns\n" % (rows + 1, len(row), columns))
+            sys.exit(1)
+        for value in row:
+            if not -limit <= value < limit:
+                sys.stderr.write("Value %d does not fit into %s\n" % (value, value_type))
+                sys.exit(1)
+        values.extend(row)
+        rows += 1
+
+if rows == 0:
+    sys.stderr.write("No values in " + ascii_path + "\n")
+    sys.exit(1)
+
+with open(binary_path, "wb") as f:
+    f.write(b"OSRMRAST")
+    f.write(struct.pack("=IIQQ", 1, values.itemsize, columns, rows))
+    f.write(values.tobytes() if hasattr(values, "tobytes") else values.tostring())
+
+print("Wrote %d rows and %d columns of %s to %s" % (rows, columns, value_type, binary_path))
@@ -0,0 +1,278 @@
+#include "extractor/compressed_node_based_graph_edge.hpp"
+#include "extractor/files.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/route_parameters.hpp"
+#include "osrm/status.hpp"
+
+#include "util/coordinate_calculation.hpp"
+#include "util/log.hpp"
+#include "util/search_counters.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+// smallest rank 2^k of the queries, closer targets take about as long as the snapping
+const constexpr std::size_t MIN_RANK_EXPONENT = 4;
+
+struct Query
+{
+    std::size_t rank_exponent;
+    NodeID source;
+    NodeID target;
+};
+
+struct RankResult
+{
+    std::size_t queries = 0;
+    std::size_t failed = 0;
+    std::vector<double> latencies;
+    util::SearchCounters counters;
+};
+
+// Node based graph of the .osrm.cnbg edges in compressed sparse row format, the edges are as
+// long as the great circle distance between their nodes. The ranks of this metric only need
+// to stratify the queries by the size of their search space, not match the weights of the
+// profile.
+class NodeBasedGraph
+{
+  public:
+    explicit NodeBasedGraph(const std::string &base_path)
+    {
+        std::vector<extractor::CompressedNodeBasedGraphEdge> edges;
+        extractor::files::readCompressedNodeBasedGraph(base_path + ".cnbg", edges);
+        extractor::files::readNodeCoordinates(base_path + ".nbg_nodes", coordinates);
+
+        std::sort(edges.begin(), edges.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.source < rhs.source;
+        });
+
+        first_edges.resize(coordinates.size() + 1, 0);
+        targets.reserve(edges.size());
+        lengths.reserve(edges.size());
+        for (const auto &edge : edges)
+        {
+            ++first_edges[edge.source + 1];
+            targets.push_back(edge.target);
+            lengths.push_back(util::coordinate_calculation::haversineDistance(
+                coordinates[edge.source], coordinates[edge.target]));
+        }
+        std::partial_sum(first_edges.begin(), first_edges.end(), first_edges.begin());
+    }
+
+    std::size_t GetNumberOfNodes() const { return coordinates.size(); }
+
+    bool HasEdges(const NodeID node) const { return first_edges[node] < first_edges[node + 1]; }
+
+    util::Coordinate GetCoordinate(const NodeID node) const { return coordinates[node]; }
+
+    // Returns the nodes in the order Dijkstra's algorithm settles them from source, the node at
+    // index i has the Dijkstra rank i
+    std::vector<NodeID> SettleOrder(const NodeID source, const std::size_t max_rank) const
+    {
+        using QueueEntry = std::pair<double, NodeID>;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+        std::vector<double> distances(coordinates.size(), std::numeric_limits<double>::max());
+        std::vector<NodeID> settled;
+
+        distances[source] = 0;
+        queue.emplace(0, source);
+        while (!queue.empty() && settled.size() <= max_rank)
+        {
+            const auto entry = queue.top();
+            queue.pop();
+            const auto node = entry.second;
+            if (entry.first > distances[node])
+            {
+                continue;
+            }
+
+            settled.push_back(node);
+            for (auto edge = first_edges[node]; edge < first_edges[node + 1]; ++edge)
+            {
+                const auto to_distance = entry.first + lengths[edge];
+                if (to_distance < distances[targets[edge]])
+                {
+                    distances[targets[edge]] = to_distance;
+                    queue.emplace(to_distance, targets[edge]);
+                }
+            }
+        }
+        return settled;
+    }
+
+  private:
+    std::vector<util::Coordinate> coordinates;
+    std::vector<std::size_t> first_edges;
+    std::vector<NodeID> targets;
+    std::vector<double> lengths;
+};
+
+// Picks random sources and takes the nodes of rank 2^k as their targets, every rank that the
+// searches of a source reach gets one query
+std::vector<Query> makeQueries(const NodeBasedGraph &graph,
+                               const std::size_t number_of_sources,
+                               const std::size_t max_rank_exponent)
+{
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<NodeID> node(0, graph.GetNumberOfNodes() - 1);
+
+    std::vector<Query> queries;
+    for (std::size_t index = 0; index < number_of_sources; ++index)
+    {
+        auto source = node(generator);
+        while (!graph.HasEdges(source))
+        {
+            source = node(generator);
+        }
+
+        const auto settled = graph.SettleOrder(source, std::size_t{1} << max_rank_exponent);
+        for (auto exponent = MIN_RANK_EXPONENT; exponent <= max_rank_exponent; ++exponent)
+        {
+            const auto rank = std::size_t{1} << exponent;
+            if (rank < settled.size())
+            {
+                queries.push_back({exponent, source, settled[rank]});
+            }
+        }
+    }
+    return queries;
+}
+
+std::vector<RankResult> runQueries(const std::string &base_path,
+                                   const EngineConfig::Algorithm algorithm,
+                                   const NodeBasedGraph &graph,
+                                   const std::vector<Query> &queries,
+                                   const std::size_t max_rank_exponent)
+{
+    EngineConfig config;
+    config.storage_config = {base_path};
+    config.use_shared_memory = false;
+    config.algorithm = algorithm;
+    const OSRM osrm{config};
+
+    std::vector<RankResult> results(max_rank_exponent + 1);
+    for (const auto &query : queries)
+    {
+        RouteParameters parameters;
+        parameters.overview = RouteParameters::OverviewType::False;
+        parameters.steps = false;
+        parameters.coordinates = {graph.GetCoordinate(query.source),
+                                  graph.GetCoordinate(query.target)};
+
+        // the searches of the route run on this thread or are added to its counters
+        util::threadSearchCounters() = util::SearchCounters{};
+        json::Object result;
+        TIMER_START(route);
+        const auto status = osrm.Route(parameters, result);
+        TIMER_STOP(route);
+
+        auto &rank_result = results[query.rank_exponent];
+        ++rank_result.queries;
+        if (status != Status::Ok)
+        {
+            ++rank_result.failed;
+            continue;
+        }
+        rank_result.latencies.push_back(TIMER_MSEC(route));
+        rank_result.counters += util::threadSearchCounters();
+    }
+    return results;
+}
+
+void report(const std::string &algorithm, std::vector<RankResult> results)
+{
+    for (auto exponent = MIN_RANK_EXPONENT; exponent < results.size(); ++exponent)
+    {
+        auto &result = results[exponent];
+        const auto routes = result.latencies.size();
+        if (routes == 0)
+        {
+            continue;
+        }
+
+        std::sort(result.latencies.begin(), result.latencies.end());
+        double total_latency = 0;
+        for (const auto latency : result.latencies)
+        {
+            total_latency += latency;
+        }
+
+        const auto &counters = result.counters;
+        util::Log() << std::fixed << std::setprecision(3) << algorithm << " rank 2^" << exponent
+                    << ": " << result.queries << " queries, " << result.failed << " failed"
+                    << ", settled " << 1. * counters.settled_nodes / routes << ", relaxed "
+                    << 1. * counters.relaxed_edges / routes << ", unpacked "
+                    << 1. * counters.unpacked_edges / routes << " edges in "
+                    << counters.unpack_nanoseconds / 1000000. / routes << " ms, latency "
+                    << total_latency / routes << " ms (median " << result.latencies[routes / 2]
+                    << " ms)";
+    }
+}
+}
+
+int main(int argc, const char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " data.osrm [sources=100] [max_rank_exponent=24]\n"
+                  << "The dataset needs to be contracted for CH and partitioned and customized "
+                     "for MLD.\n";
+        return EXIT_FAILURE;
+    }
+
+    const std::string base_path = argv[1];
+    const std::size_t number_of_sources = argc > 2 ? std::max(std::atol(argv[2]), 1L) : 100;
+    const std::size_t max_rank_exponent =
+        argc > 3 ? std::max<std::size_t>(std::atol(argv[3]), MIN_RANK_EXPONENT) : 24;
+
+#ifndef OSRM_ENABLE_SEARCH_COUNTERS
+    util::Log(logWARNING) << "Settled nodes, relaxed edges and unpacking times are only counted "
+                             "when built with -DENABLE_SEARCH_COUNTERS=ON";
+#endif
+
+    TIMER_START(queries);
+    const NodeBasedGraph graph{base_path};
+    const auto queries = makeQueries(graph, number_of_sources, max_rank_exponent);
+    TIMER_STOP(queries);
+    util::Log() << "Generated " << queries.size() << " queries from " << number_of_sources
+                << " sources of " << graph.GetNumberOfNodes() << " nodes in "
+                << TIMER_SEC(queries) << "s";
+
+    report("CH",
+           runQueries(
+               base_path, EngineConfig::Algorithm::CH, graph, queries, max_rank_exponent));
+    report("MLD",
+           runQueries(
+               base_path, EngineConfig::Algorithm::MLD, graph, queries, max_rank_exponent));
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
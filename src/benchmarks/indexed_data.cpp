@@ -0,0 +1,243 @@
+#include "extractor/name_table.hpp"
+#include "extractor/serialization.hpp"
+#include "storage/tar.hpp"
+#include "util/indexed_data.hpp"
+#include "util/log.hpp"
+#include "util/serialization.hpp"
+#include "util/timing_util.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace osrm;
+
+#ifdef _WIN32
+#pragma optimize("", off)
+template <class T> void dont_optimize_away(T &&datum) { T local = datum; }
+#pragma optimize("", on)
+#else
+template <class T> void dont_optimize_away(T &&datum) { asm volatile("" : "+r"(datum)); }
+#endif
+
+namespace
+{
+const constexpr std::size_t NUMBER_OF_FIELDS = 5;
+
+struct NameData
+{
+    std::vector<std::uint32_t> offsets;
+    std::vector<unsigned char> char_data;
+};
+
+// Builds number_of_names unique (name, destinations, pronunciation, ref, exits) tuples the way
+// the extractor callbacks store them. Like in OSM few street names and refs make up most of the
+// ways, most ways only have a name and few have destinations, pronunciations or exits.
+NameData makeNameData(const std::size_t number_of_names)
+{
+    std::mt19937 g(1337);
+
+    const std::vector<std::string> syllables = {
+        "ba", "ker", "lin", "den", "ro", "sen", "hof", "berg", "wald", "mar", "ket", "kirch",
+        "bach", "feld", "ton", "ham", "ley", "wood", "brook", "ville", "mont", "san", "ta", "el"};
+    const std::vector<std::string> suffixes = {
+        " Street", " Avenue", " Road", " Lane", " Way", "straße", "weg", " Boulevard", " Drive"};
+
+    std::uniform_int_distribution<std::size_t> syllable_distribution(0, syllables.size() - 1);
+    std::uniform_int_distribution<std::size_t> suffix_distribution(0, suffixes.size() - 1);
+    std::uniform_int_distribution<int> syllables_distribution(2, 4);
+    const auto make_word = [&] {
+        std::string word;
+        for (auto count = syllables_distribution(g); count > 0; --count)
+            word += syllables[syllable_distribution(g)];
+        word[0] = std::toupper(word[0]);
+        return word;
+    };
+
+    std::vector<std::string> streets(number_of_names / 4 + 1);
+    std::generate(streets.begin(), streets.end(), [&] {
+        return make_word() + suffixes[suffix_distribution(g)];
+    });
+    std::vector<std::string> cities(number_of_names / 200 + 2);
+    std::generate(cities.begin(), cities.end(), make_word);
+
+    // Some streets and cities are far more common than others
+    std::geometric_distribution<std::size_t> street_distribution(8.0 / streets.size());
+    std::geometric_distribution<std::size_t> city_distribution(4.0 / cities.size());
+    std::geometric_distribution<int> ref_distribution(0.005);
+    std::uniform_real_distribution<double> share(0, 1);
+
+    std::set<std::tuple<std::string, std::string, std::string, std::string, std::string>> tuples;
+    NameData data;
+    const auto add_field = [&data](const std::string &value) {
+        data.offsets.push_back(data.char_data.size());
+        data.char_data.insert(data.char_data.end(), value.begin(), value.end());
+    };
+
+    while (tuples.size() < number_of_names)
+    {
+        std::string name, destinations, pronunciation, ref, exits;
+        if (share(g) < 0.85)
+            name = streets[street_distribution(g) % streets.size()];
+        if (share(g) < 0.05)
+            destinations = cities[city_distribution(g) % cities.size()] + ", " +
+                           cities[city_distribution(g) % cities.size()];
+        if (share(g) < 0.01)
+            pronunciation = name;
+        if (share(g) < 0.2)
+            ref = (share(g) < 0.5 ? "A " : "B ") + std::to_string(ref_distribution(g));
+        if (share(g) < 0.01)
+            exits = std::to_string(ref_distribution(g) % 100);
+
+        if (tuples.emplace(name, destinations, pronunciation, ref, exits).second)
+        {
+            add_field(name);
+            add_field(destinations);
+            add_field(pronunciation);
+            add_field(ref);
+            add_field(exits);
+        }
+    }
+    data.offsets.push_back(data.char_data.size());
+
+    return data;
+}
+
+template <typename TableT>
+std::uintmax_t serializedSize(const TableT &table, const boost::filesystem::path &path)
+{
+    {
+        storage::tar::FileWriter writer(path, storage::tar::FileWriter::GenerateFingerprint);
+        util::serialization::write(writer, "/names", table);
+    }
+    const auto size = boost::filesystem::file_size(path);
+    boost::filesystem::remove(path);
+    return size;
+}
+
+template <typename TableT>
+std::uintmax_t serializedNameTableSize(const TableT &table, const boost::filesystem::path &path)
+{
+    {
+        storage::tar::FileWriter writer(path, storage::tar::FileWriter::GenerateFingerprint);
+        extractor::serialization::write(writer, "/names", table);
+    }
+    const auto size = boost::filesystem::file_size(path);
+    boost::filesystem::remove(path);
+    return size;
+}
+
+// Reads all fields of the ids in the order given, like the step assembly does for a name id
+template <typename GetFieldsT>
+double measureAccess(const std::vector<std::uint32_t> &ids, const GetFieldsT &get_fields)
+{
+    const constexpr std::size_t number_of_rounds = 10;
+
+    TIMER_START(access);
+    for (std::size_t round = 0; round < number_of_rounds; ++round)
+    {
+        std::size_t sum = 0;
+        for (const auto id : ids)
+        {
+            sum += get_fields(id);
+        }
+        dont_optimize_away(sum);
+    }
+    TIMER_STOP(access);
+
+    return TIMER_MSEC(access) * 1e6 / (number_of_rounds * ids.size());
+}
+
+template <typename GetFieldsT>
+void logAccess(const std::string &layout,
+               const std::uintmax_t bytes,
+               const std::vector<std::uint32_t> &sequential_ids,
+               const std::vector<std::uint32_t> &random_ids,
+               const GetFieldsT &get_fields)
+{
+    util::Log() << layout << ": " << bytes << " bytes, sequential "
+                << measureAccess(sequential_ids, get_fields) << " ns per name id, random "
+                << measureAccess(random_ids, get_fields) << " ns per name id";
+}
+}
+
+int main(int argc, char **argv)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    const std::size_t number_of_names = argc > 1 ? std::atol(argv[1]) : 1000000;
+    const auto temporary_path = boost::filesystem::temp_directory_path() /
+                                boost::filesystem::unique_path("indexed-data-bench-%%%%%%.tar");
+
+    const auto data = makeNameData(number_of_names);
+    util::Log() << number_of_names << " name ids with " << data.char_data.size()
+                << " bytes of strings";
+
+    std::vector<std::uint32_t> sequential_ids(number_of_names);
+    std::iota(sequential_ids.begin(), sequential_ids.end(), 0);
+    std::transform(sequential_ids.begin(),
+                   sequential_ids.end(),
+                   sequential_ids.begin(),
+                   [](const auto index) { return index * NUMBER_OF_FIELDS; });
+    auto random_ids = sequential_ids;
+    std::shuffle(random_ids.begin(), random_ids.end(), std::mt19937(42));
+
+    TIMER_START(variable_build);
+    const util::IndexedData<util::VariableGroupBlock<16, util::StringView>> variable_data(
+        data.offsets.begin(), data.offsets.end(), data.char_data.begin());
+    TIMER_STOP(variable_build);
+
+    TIMER_START(fixed_build);
+    const util::IndexedData<util::FixedGroupBlock<16, util::StringView>> fixed_data(
+        data.offsets.begin(), data.offsets.end(), data.char_data.begin());
+    TIMER_STOP(fixed_build);
+
+    TIMER_START(name_table_build);
+    const extractor::NameTable name_table(
+        data.offsets.begin(), data.offsets.end(), data.char_data.begin());
+    TIMER_STOP(name_table_build);
+
+    util::Log() << "build: VariableGroupBlock " << TIMER_MSEC(variable_build)
+                << " ms, FixedGroupBlock " << TIMER_MSEC(fixed_build) << " ms, NameTable "
+                << TIMER_MSEC(name_table_build) << " ms";
+
+    const auto get_indexed_fields = [](const auto &indexed_data) {
+        return [&indexed_data](const std::uint32_t id) {
+            std::size_t size = 0;
+            for (std::size_t field = 0; field < NUMBER_OF_FIELDS; ++field)
+                size += indexed_data.at(id + field).size();
+            return size;
+        };
+    };
+
+    logAccess("VariableGroupBlock",
+              serializedSize(variable_data, temporary_path),
+              sequential_ids,
+              random_ids,
+              get_indexed_fields(variable_data));
+    logAccess("FixedGroupBlock",
+              serializedSize(fixed_data, temporary_path),
+              sequential_ids,
+              random_ids,
+              get_indexed_fields(fixed_data));
+    logAccess("NameTable",
+              serializedNameTableSize(name_table, temporary_path),
+              sequential_ids,
+              random_ids,
+              [&name_table](const NameID id) {
+                  return name_table.GetNameForID(id).size() +
+                         name_table.GetDestinationsForID(id).size() +
+                         name_table.GetPronunciationForID(id).size() +
+                         name_table.GetRefForID(id).size() + name_table.GetExitsForID(id).size();
+              });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include "util/cast.hpp"
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+// Builds the response of a table query with number_of_rows sources and destinations, the
+// durations are in tenth of a second like the ones of the table plugin.
+util::json::Object makeTable(const std::size_t number_of_rows)
+{
+    std::mt19937 g(1337);
+    std::uniform_int_distribution<int> duration_distribution(0, 360000);
+    std::uniform_int_distribution<int> coordinate_distribution(-90000000, 90000000);
+
+    util::json::Array durations;
+    for (std::size_t row = 0; row < number_of_rows; ++row)
+    {
+        util::json::Array columns;
+        columns.values.reserve(number_of_rows);
+        for (std::size_t column = 0; column < number_of_rows; ++column)
+        {
+            columns.values.push_back(util::json::Number(duration_distribution(g) / 10.));
+        }
+        durations.values.push_back(std::move(columns));
+    }
+
+    util::json::Array sources;
+    for (std::size_t row = 0; row < number_of_rows; ++row)
+    {
+        util::json::Array location;
+        location.values.push_back(util::json::Number(coordinate_distribution(g) / 1e6));
+        location.values.push_back(util::json::Number(coordinate_distribution(g) / 1e6));
+        util::json::Object source;
+        source.values["location"] = std::move(location);
+        source.values["name"] = "";
+        sources.values.push_back(std::move(source));
+    }
+
+    util::json::Object table;
+    table.values["code"] = "Ok";
+    table.values["durations"] = std::move(durations);
+    table.values["sources"] = sources;
+    table.values["destinations"] = std::move(sources);
+    return table;
+}
+
+// Renders all numbers of the table the way the renderer did before the allocation free
+// number formatting, to compare against
+std::size_t renderNumbersWithCast(const util::json::Array &durations, std::vector<char> &buffer)
+{
+    for (const auto &row : durations.values)
+    {
+        for (const auto &value : row.get<util::json::Array>().values)
+        {
+            const auto number = util::cast::to_string_with_precision(
+                value.get<util::json::Number>().value);
+            buffer.insert(buffer.end(), number.begin(), number.end());
+            buffer.push_back(',');
+        }
+    }
+    return buffer.size();
+}
+
+int main(int, char **)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    const std::size_t number_of_rows = 2000;
+    const auto table = makeTable(number_of_rows);
+
+    TIMER_START(cast);
+    std::vector<char> cast_buffer;
+    renderNumbersWithCast(table.values.at("durations").get<util::json::Array>(), cast_buffer);
+    TIMER_STOP(cast);
+
+    TIMER_START(buffer);
+    std::vector<char> buffer;
+    util::json::render(buffer, table);
+    TIMER_STOP(buffer);
+
+    TIMER_START(chunks);
+    std::vector<std::vector<char>> chunks;
+    util::json::render(chunks, table, 64 * 1024);
+    TIMER_STOP(chunks);
+
+    std::size_t chunks_size = 0;
+    for (const auto &chunk : chunks)
+    {
+        chunks_size += chunk.size();
+    }
+    if (chunks_size != buffer.size())
+    {
+        util::Log(logERROR) << "rendered sizes differ: " << buffer.size() << " != " << chunks_size;
+        return EXIT_FAILURE;
+    }
+
+    util::Log() << number_of_rows << "x" << number_of_rows << " table, " << buffer.size()
+                << " bytes";
+    util::Log() << "numbers with cast::to_string_with_precision " << TIMER_MSEC(cast) << " ms";
+    util::Log() << "render into buffer " << TIMER_MSEC(buffer) << " ms, into chunks "
+                << TIMER_MSEC(chunks) << " ms";
+}
@@ -0,0 +1,118 @@
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::engine::routing_algorithms;
+
+#ifdef _WIN32
+#pragma optimize("", off)
+template <class T> void dont_optimize_away(T &&datum) { T local = datum; }
+#pragma optimize("", on)
+#else
+template <class T> void dont_optimize_away(T &&datum) { asm volatile("" : "+r"(datum)); }
+#endif
+
+// Simulates the buckets of a large table: every backward search settles a random subset of the
+// nodes around its target, upper levels of the hierarchy are shared by many columns.
+std::vector<NodeBucket> generateBuckets(const std::size_t number_of_nodes,
+                                        const std::size_t number_of_columns,
+                                        const std::size_t search_space_size)
+{
+    std::mt19937 g(1337);
+    std::uniform_int_distribution<NodeID> node_distribution(0, number_of_nodes - 1);
+    std::uniform_int_distribution<NodeID> shared_distribution(0, number_of_nodes / 100);
+    std::uniform_int_distribution<EdgeWeight> weight_distribution(0, 100000);
+
+    std::vector<NodeBucket> buckets;
+    std::vector<NodeID> search_space;
+    for (auto column : util::irange<std::size_t>(0, number_of_columns))
+    {
+        search_space.clear();
+        for (auto index : util::irange<std::size_t>(0, search_space_size))
+        {
+            search_space.push_back(index % 2 == 0 ? node_distribution(g) : shared_distribution(g));
+        }
+        std::sort(search_space.begin(), search_space.end());
+        search_space.erase(std::unique(search_space.begin(), search_space.end()),
+                           search_space.end());
+
+        for (const auto node : search_space)
+        {
+            const auto weight = weight_distribution(g);
+            buckets.emplace_back(node, node, column, weight, weight);
+        }
+    }
+    std::sort(buckets.begin(), buckets.end());
+    return buckets;
+}
+
+int main(int, char **)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    const std::size_t number_of_nodes = 10000000;
+    const std::size_t number_of_columns = 1000;
+    const std::size_t search_space_size = 2000;
+    const std::size_t number_of_lookups = 5000000;
+
+    const auto buckets = generateBuckets(number_of_nodes, number_of_columns, search_space_size);
+    const NodeBucketIndex bucket_index(buckets);
+
+    // forward searches settle nodes from the same distribution as the backward searches
+    std::mt19937 g(42);
+    std::vector<NodeID> settled_nodes(number_of_lookups);
+    std::uniform_int_distribution<NodeID> node_distribution(0, number_of_nodes - 1);
+    std::uniform_int_distribution<NodeID> shared_distribution(0, number_of_nodes / 100);
+    for (auto index : util::irange<std::size_t>(0, number_of_lookups))
+    {
+        settled_nodes[index] = index % 2 == 0 ? node_distribution(g) : shared_distribution(g);
+    }
+
+    TIMER_START(equal_range);
+    std::uint64_t equal_range_sum = 0;
+    for (const auto node : settled_nodes)
+    {
+        const auto bucket_list =
+            std::equal_range(buckets.begin(), buckets.end(), node, NodeBucket::Compare());
+        for (auto bucket = bucket_list.first; bucket != bucket_list.second; ++bucket)
+        {
+            equal_range_sum += bucket->weight + bucket->column_index;
+        }
+        dont_optimize_away(equal_range_sum);
+    }
+    TIMER_STOP(equal_range);
+
+    TIMER_START(bucket_index);
+    std::uint64_t bucket_index_sum = 0;
+    for (const auto node : settled_nodes)
+    {
+        const auto range = bucket_index.Find(node);
+        for (auto position = range.begin; position != range.end; ++position)
+        {
+            bucket_index_sum +=
+                bucket_index.GetWeight(position) + bucket_index.GetColumn(position);
+        }
+        dont_optimize_away(bucket_index_sum);
+    }
+    TIMER_STOP(bucket_index);
+
+    if (equal_range_sum != bucket_index_sum)
+    {
+        util::Log(logERROR) << "bucket lookups differ: " << equal_range_sum
+                            << " != " << bucket_index_sum;
+        return EXIT_FAILURE;
+    }
+
+    util::Log() << buckets.size() << " buckets, " << number_of_lookups << " lookups";
+    util::Log() << "std::equal_range " << TIMER_MSEC(equal_range) << " ms, NodeBucketIndex "
+                << TIMER_MSEC(bucket_index) << " ms. "
+                << TIMER_MSEC(equal_range) / TIMER_MSEC(bucket_index) << "x";
+}
@@ -8,6 +8,7 @@
 #include <numeric>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace osrm;
@@ -62,6 +63,55 @@ auto measure_random_access()
     return Measurement{TIMER_MSEC(write), TIMER_MSEC(read)};
 }
 
+// Decodes short ranges like the geometries of the segment data
+template <std::size_t num_rounds, std::size_t num_entries, typename VectorT>
+auto measure_range_decoding()
+{
+    std::mt19937 g(1337);
+    std::uniform_int_distribution<std::size_t> first_index(0, num_entries - 1);
+    std::uniform_int_distribution<std::size_t> length(1, 20);
+    std::vector<std::pair<std::size_t, std::size_t>> ranges(num_entries / 10);
+    for (auto &range : ranges)
+    {
+        range.first = first_index(g);
+        range.second = std::min(num_entries, range.first + length(g));
+    }
+
+    VectorT vector(num_entries);
+    for (auto idx : util::irange<std::size_t>(0, num_entries))
+    {
+        vector[idx] = idx;
+    }
+
+    std::vector<std::uint32_t> values;
+    TIMER_START(iterate);
+    for (auto round : util::irange<std::size_t>(0, num_rounds))
+    {
+        for (const auto &range : ranges)
+        {
+            values.assign(vector.begin() + range.first, vector.begin() + range.second);
+            auto sum = values.back() + round;
+            dont_optimize_away(sum);
+        }
+    }
+    TIMER_STOP(iterate);
+
+    TIMER_START(unpack);
+    for (auto round : util::irange<std::size_t>(0, num_rounds))
+    {
+        for (const auto &range : ranges)
+        {
+            values.resize(range.second - range.first);
+            vector.unpack(range.first, range.second, values.begin());
+            auto sum = values.back() + round;
+            dont_optimize_away(sum);
+        }
+    }
+    TIMER_STOP(unpack);
+
+    return std::make_pair(TIMER_MSEC(iterate), TIMER_MSEC(unpack));
+}
+
 int main(int, char **)
 {
     util::LogPolicy::GetInstance().Unmute();
@@ -78,4 +128,9 @@ int main(int, char **)
     util::Log() << "random read: std::vector " << result_plain.random_read_ms
                 << " ms, util::packed_vector " << result_packed.random_read_ms << " ms. "
                 << read_slowdown;
+
+    auto result_ranges =
+        measure_range_decoding<1000, 1000000, util::PackedVector<std::uint32_t, 22>>();
+    util::Log() << "range decoding: iterators " << result_ranges.first << " ms, unpack "
+                << result_ranges.second << " ms. " << result_ranges.first / result_ranges.second;
 }
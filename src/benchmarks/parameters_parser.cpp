@@ -0,0 +1,112 @@
+#include "server/api/parameters_parser.hpp"
+#include "server/api/table_parameter_grammar.hpp"
+#include "server/api/url_parser.hpp"
+
+#include "engine/api/table_parameters.hpp"
+#include "engine/hint.hpp"
+
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace osrm;
+
+namespace
+{
+// A table url like the ones of clients that send back the hints of earlier responses
+std::string makeTableURL(const std::size_t number_of_coordinates)
+{
+    std::mt19937 generator(1337);
+    std::uniform_real_distribution<double> longitude(13.0, 13.7);
+    std::uniform_real_distribution<double> latitude(52.3, 52.7);
+
+    std::ostringstream coordinates, hints, radiuses;
+    coordinates << std::fixed << std::setprecision(6);
+    for (std::size_t index = 0; index < number_of_coordinates; ++index)
+    {
+        const auto separator = index > 0 ? ";" : "";
+        const auto lon = longitude(generator);
+        const auto lat = latitude(generator);
+        coordinates << separator << lon << "," << lat;
+
+        engine::Hint hint;
+        hint.phantom = engine::PhantomNode{};
+        hint.phantom.input_location =
+            util::Coordinate{util::FloatLongitude{lon}, util::FloatLatitude{lat}};
+        hint.data_checksum = generator();
+        hints << separator << hint.ToBase64();
+        radiuses << separator << (index % 2 == 0 ? "50" : "unlimited");
+    }
+
+    return "/table/v1/driving/" + coordinates.str() + "?hints=" + hints.str() + "&radiuses=" +
+           radiuses.str() + "&sources=0;1;2;3";
+}
+
+template <typename ParseT> double measure(const std::size_t number_of_rounds, ParseT parse)
+{
+    TIMER_START(parse);
+    for (std::size_t round = 0; round < number_of_rounds; ++round)
+    {
+        if (!parse())
+        {
+            util::Log(logERROR) << "Could not parse the url";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    TIMER_STOP(parse);
+    return TIMER_MSEC(parse) * 1000 / number_of_rounds;
+}
+}
+
+int main(int argc, char **argv)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    const std::size_t number_of_coordinates = argc > 1 ? std::atol(argv[1]) : 2000;
+    const std::size_t number_of_rounds = argc > 2 ? std::atol(argv[2]) : 100;
+
+    const auto url = makeTableURL(number_of_coordinates);
+    util::Log() << "Table url with " << number_of_coordinates << " coordinates and hints of "
+                << url.size() << " bytes";
+
+    const auto parsed_url = server::api::parseURL(url);
+    if (!parsed_url)
+    {
+        util::Log(logERROR) << "Could not parse the url";
+        return EXIT_FAILURE;
+    }
+
+    const auto url_us = measure(number_of_rounds, [&] {
+        auto url_copy = url;
+        auto iter = url_copy.begin();
+        return static_cast<bool>(server::api::parseURL(iter, url_copy.end()));
+    });
+
+    const auto parameters_us = measure(number_of_rounds, [&] {
+        auto query = parsed_url->query;
+        auto iter = query.begin();
+        return static_cast<bool>(
+            server::api::parseParameters<engine::api::TableParameters>(iter, query.end()));
+    });
+
+    // the grammar the service used for all queries before
+    const server::api::TableParametersGrammar<> grammar;
+    const auto grammar_us = measure(number_of_rounds, [&] {
+        auto query = parsed_url->query;
+        auto iter = query.begin();
+        engine::api::TableParameters parameters;
+        return boost::spirit::qi::parse(
+                   iter, query.end(), grammar(boost::phoenix::ref(parameters))) &&
+               iter == query.end();
+    });
+
+    util::Log() << "url: " << url_us << " us, parameters: " << parameters_us
+                << " us, parameters with the grammar: " << grammar_us << " us";
+
+    return EXIT_SUCCESS;
+}
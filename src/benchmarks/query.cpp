@@ -0,0 +1,286 @@
+#include "server/api/parameters_parser.hpp"
+#include "server/api/url_parser.hpp"
+
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/match_parameters.hpp"
+#include "osrm/nearest_parameters.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/route_parameters.hpp"
+#include "osrm/status.hpp"
+#include "osrm/table_parameters.hpp"
+#include "osrm/trip_parameters.hpp"
+
+#include "util/log.hpp"
+#include "util/string_util.hpp"
+#include "util/timing_util.hpp"
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+using QueryT = std::function<engine::Status(const OSRM &, json::Object &)>;
+
+struct Query
+{
+    std::string service;
+    QueryT run;
+};
+
+struct Measurement
+{
+    std::size_t query;
+    std::int64_t usec;
+    bool ok;
+};
+
+// selects the overload of the services that fills a JSON object
+template <typename ParameterT>
+using ServiceT = engine::Status (OSRM::*)(const ParameterT &, json::Object &) const;
+
+template <typename ParameterT>
+boost::optional<QueryT> makeQuery(std::string &query, const ServiceT<ParameterT> service)
+{
+    auto iter = query.begin();
+    const auto parameters = server::api::parseParameters<ParameterT>(iter, query.end());
+    if (!parameters || iter != query.end() || !parameters->IsValid())
+    {
+        return boost::none;
+    }
+
+    return QueryT{[query_parameters = *parameters, service](const OSRM &osrm,
+                                                            json::Object &result) {
+        return (osrm.*service)(query_parameters, result);
+    }};
+}
+
+// Queries are the paths of the HTTP API, one per line. Lines of the access log of osrm-routed
+// are used from their first path, so real request logs can be replayed as they are.
+std::vector<Query> readQueries(const std::string &path)
+{
+    std::ifstream input(path);
+    if (!input)
+    {
+        util::Log(logERROR) << "Could not open the query file " << path;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<Query> queries;
+    std::size_t skipped = 0;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        const auto first = line.find('/');
+        if (line.empty() || line[0] == '#' || first == std::string::npos)
+        {
+            continue;
+        }
+        const auto last = line.find_first_of(" \t\r", first);
+        const auto url = line.substr(first, last == std::string::npos ? last : last - first);
+
+        std::string decoded;
+        util::URIDecode(url, decoded);
+        auto parsed_url = server::api::parseURL(decoded);
+
+        boost::optional<QueryT> query;
+        if (parsed_url && parsed_url->service == "route")
+        {
+            query = makeQuery<engine::api::RouteParameters>(parsed_url->query, &OSRM::Route);
+        }
+        else if (parsed_url && parsed_url->service == "table")
+        {
+            query = makeQuery<engine::api::TableParameters>(parsed_url->query, &OSRM::Table);
+        }
+        else if (parsed_url && parsed_url->service == "nearest")
+        {
+            query = makeQuery<engine::api::NearestParameters>(parsed_url->query, &OSRM::Nearest);
+        }
+        else if (parsed_url && parsed_url->service == "trip")
+        {
+            query = makeQuery<engine::api::TripParameters>(parsed_url->query, &OSRM::Trip);
+        }
+        else if (parsed_url && parsed_url->service == "match")
+        {
+            query = makeQuery<engine::api::MatchParameters>(parsed_url->query, &OSRM::Match);
+        }
+
+        if (query)
+        {
+            queries.push_back({parsed_url->service, std::move(*query)});
+        }
+        else
+        {
+            ++skipped;
+        }
+    }
+
+    if (skipped > 0)
+    {
+        util::Log(logWARNING) << "Skipped " << skipped
+                              << " lines that are no valid route, table, nearest, trip or "
+                                 "match queries";
+    }
+
+    return queries;
+}
+
+// Nearest-rank percentile of sorted latencies
+std::int64_t percentile(const std::vector<std::int64_t> &sorted, const double fraction)
+{
+    const auto rank = static_cast<std::size_t>(fraction * sorted.size() + 0.5);
+    return sorted[std::min(std::max<std::size_t>(rank, 1), sorted.size()) - 1];
+}
+
+void report(const std::string &service,
+            std::vector<std::int64_t> latencies,
+            const std::size_t errors,
+            const double seconds)
+{
+    std::sort(latencies.begin(), latencies.end());
+    std::int64_t total = 0;
+    for (const auto latency : latencies)
+    {
+        total += latency;
+    }
+
+    util::Log() << std::left << std::setw(8) << service << std::right << std::fixed
+                << std::setprecision(1) << " queries: " << latencies.size()
+                << " errors: " << errors << " throughput: " << latencies.size() / seconds
+                << "/s latency mean: " << total / 1000. / latencies.size()
+                << " ms p50: " << percentile(latencies, 0.5) / 1000.
+                << " ms p90: " << percentile(latencies, 0.9) / 1000.
+                << " ms p99: " << percentile(latencies, 0.99) / 1000.
+                << " ms max: " << latencies.back() / 1000. << " ms";
+}
+}
+
+int main(int argc, const char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " data.osrm queries.txt [threads=1] [rounds=1] [algorithm=CH|CoreCH|MLD]\n";
+        return EXIT_FAILURE;
+    }
+
+    EngineConfig config;
+    config.storage_config = {argv[1]};
+    config.use_shared_memory = false;
+    const std::string algorithm = argc > 5 ? argv[5] : "CH";
+    if (algorithm == "CH")
+    {
+        config.algorithm = EngineConfig::Algorithm::CH;
+    }
+    else if (algorithm == "CoreCH")
+    {
+        config.algorithm = EngineConfig::Algorithm::CoreCH;
+    }
+    else if (algorithm == "MLD")
+    {
+        config.algorithm = EngineConfig::Algorithm::MLD;
+    }
+    else
+    {
+        util::Log(logERROR) << "Unknown algorithm " << algorithm;
+        return EXIT_FAILURE;
+    }
+
+    const std::size_t number_of_threads = argc > 3 ? std::max(std::atol(argv[3]), 1L) : 1;
+    const std::size_t number_of_rounds = argc > 4 ? std::max(std::atol(argv[4]), 1L) : 1;
+
+    const auto queries = readQueries(argv[2]);
+    if (queries.empty())
+    {
+        util::Log(logERROR) << "No queries in " << argv[2];
+        return EXIT_FAILURE;
+    }
+
+    const OSRM osrm{config};
+
+    util::Log() << "Running " << queries.size() << " queries " << number_of_rounds
+                << " times on " << number_of_threads << " threads";
+
+    // threads take the next query of all rounds until none is left
+    const auto number_of_runs = queries.size() * number_of_rounds;
+    std::atomic<std::size_t> next_run{0};
+    std::vector<std::vector<Measurement>> measurements(number_of_threads);
+    std::vector<std::thread> threads;
+
+    TIMER_START(queries);
+    for (std::size_t thread = 0; thread < number_of_threads; ++thread)
+    {
+        threads.emplace_back([&, thread] {
+            auto &thread_measurements = measurements[thread];
+            thread_measurements.reserve(number_of_runs / number_of_threads + 1);
+            for (auto run = next_run++; run < number_of_runs; run = next_run++)
+            {
+                const auto query = run % queries.size();
+                json::Object result;
+                TIMER_START(query);
+                const auto status = queries[query].run(osrm, result);
+                TIMER_STOP(query);
+                thread_measurements.push_back(
+                    {query, TIMER_USEC(query), status == engine::Status::Ok});
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    TIMER_STOP(queries);
+    const auto seconds = TIMER_SEC(queries);
+
+    std::map<std::string, std::vector<std::int64_t>> latencies;
+    std::map<std::string, std::size_t> errors;
+    std::vector<std::int64_t> all_latencies;
+    all_latencies.reserve(number_of_runs);
+    std::size_t all_errors = 0;
+    for (const auto &thread_measurements : measurements)
+    {
+        for (const auto &measurement : thread_measurements)
+        {
+            const auto &service = queries[measurement.query].service;
+            latencies[service].push_back(measurement.usec);
+            all_latencies.push_back(measurement.usec);
+            if (!measurement.ok)
+            {
+                ++errors[service];
+                ++all_errors;
+            }
+        }
+    }
+
+    for (const auto &service_latencies : latencies)
+    {
+        report(service_latencies.first,
+               service_latencies.second,
+               errors[service_latencies.first],
+               seconds);
+    }
+    report("all", std::move(all_latencies), all_errors, seconds);
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,397 @@
+#include "contractor/contractor_heap.hpp"
+#include "contractor/query_edge.hpp"
+#include "customizer/cell_customizer.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/routing_algorithms/routing_base_ch.hpp"
+#include "engine/search_engine_data.hpp"
+#include "partitioner/cell_storage.hpp"
+#include "partitioner/multi_level_graph.hpp"
+#include "partitioner/multi_level_partition.hpp"
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/query_heap.hpp"
+#include "util/radix_heap.hpp"
+#include "util/static_graph.hpp"
+#include "util/timing_util.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Runs the kernels of the searches alone on synthetic grid graphs, so that changes to the heaps,
+// the memory layout of the graphs or vectorized loops can be measured without whole queries:
+//
+//   search-kernels-bench [filter]
+//
+// Only kernels whose name contains the filter run. Every kernel runs once to warm up and then
+// REPETITIONS times, the median run time is reported in total and per operation, e.g. per
+// settled node of a search.
+
+using namespace osrm;
+
+#ifdef _WIN32
+#pragma optimize("", off)
+template <class T> void dont_optimize_away(T &&datum) { T local = datum; }
+#pragma optimize("", on)
+#else
+template <class T> void dont_optimize_away(T &&datum) { asm volatile("" : "+r"(datum)); }
+#endif
+
+namespace
+{
+const constexpr std::size_t REPETITIONS = 5;
+
+using EdgeData = contractor::QueryEdge::EdgeData;
+using Edge = util::static_graph_details::SortableEdgeWithData<EdgeData>;
+using Graph = util::StaticGraph<EdgeData>;
+using HeapData = engine::HeapData;
+
+struct Kernel
+{
+    std::string name;
+    // returns the number of operations of a run
+    std::function<std::size_t()> run;
+};
+
+// A grid with random weights, every node is connected to its four neighbours in both directions.
+// Edges are marked forward and backward like the edges of a contracted graph.
+std::vector<Edge> makeGridEdges(const std::uint32_t width, const std::uint32_t height)
+{
+    std::mt19937 g(1337);
+    std::uniform_int_distribution<EdgeWeight> weight_distribution(1, 100);
+
+    std::vector<Edge> edges;
+    const auto add_edge = [&](const NodeID source, const NodeID target) {
+        const auto weight = weight_distribution(g);
+        edges.emplace_back(source, target, EdgeData{source, false, weight, weight, true, true});
+        edges.emplace_back(target, source, EdgeData{source, false, weight, weight, true, true});
+    };
+    for (const auto y : util::irange(0u, height))
+    {
+        for (const auto x : util::irange(0u, width))
+        {
+            const auto node = y * width + x;
+            if (x + 1 < width)
+            {
+                add_edge(node, node + 1);
+            }
+            if (y + 1 < height)
+            {
+                add_edge(node, node + width);
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+std::vector<NodeID> randomNodes(const std::size_t number_of_nodes, const std::size_t count)
+{
+    std::mt19937 g(42);
+    std::uniform_int_distribution<NodeID> node_distribution(0, number_of_nodes - 1);
+    std::vector<NodeID> nodes(count);
+    for (auto &node : nodes)
+    {
+        node = node_distribution(g);
+    }
+    return nodes;
+}
+
+// Dijkstra searches that settle up to max_settled nodes, the pattern of the many-to-many and
+// the customization searches
+template <typename HeapT, typename DataT>
+std::size_t runSearches(const Graph &graph,
+                        HeapT &heap,
+                        const std::vector<NodeID> &sources,
+                        const std::size_t max_settled,
+                        const DataT &data)
+{
+    std::size_t settled = 0;
+    for (const auto source : sources)
+    {
+        heap.Clear();
+        heap.Insert(source, 0, data);
+        for (std::size_t count = 0; !heap.Empty() && count < max_settled; ++count)
+        {
+            const auto node = heap.DeleteMin();
+            const auto weight = heap.GetKey(node);
+            for (const auto edge : graph.GetAdjacentEdgeRange(node))
+            {
+                const auto to = graph.GetTarget(edge);
+                const auto to_weight = weight + graph.GetEdgeData(edge).weight;
+                if (!heap.WasInserted(to))
+                {
+                    heap.Insert(to, to_weight, data);
+                }
+                else if (to_weight < heap.GetKey(to))
+                {
+                    heap.DecreaseKey(to, to_weight);
+                }
+            }
+            ++settled;
+        }
+    }
+    return settled;
+}
+
+template <typename HeapT>
+Kernel makeQueryHeapKernel(const std::string &name,
+                           const Graph &graph,
+                           const std::vector<NodeID> &sources,
+                           const std::size_t max_settled)
+{
+    auto heap = std::make_shared<HeapT>(graph.GetNumberOfNodes());
+    return {name, [&graph, &sources, max_settled, heap] {
+                return runSearches(graph, *heap, sources, max_settled, HeapData{0});
+            }};
+}
+
+// Witness searches of the contraction are small and the heap is cleared for every search
+Kernel makeContractorHeapKernel(const Graph &graph, const std::vector<NodeID> &sources)
+{
+    auto heap = std::make_shared<contractor::ContractorHeap>(graph.GetNumberOfNodes());
+    return {"contractor_heap/witness_search", [&graph, &sources, heap] {
+                return runSearches(graph, *heap, sources, 500, contractor::ContractorHeapData{});
+            }};
+}
+
+// Checks every node that searches from the sources reached for stalling, the searches run before
+Kernel makeStallingKernel(const Graph &graph, const std::vector<NodeID> &sources)
+{
+    using Heap = engine::SearchEngineData<engine::routing_algorithms::ch::Algorithm>::QueryHeap;
+    auto heaps = std::make_shared<std::vector<std::unique_ptr<Heap>>>();
+    auto reached_nodes = std::make_shared<std::vector<std::vector<NodeID>>>();
+    for (const auto source : sources)
+    {
+        heaps->push_back(std::make_unique<Heap>(graph.GetNumberOfNodes()));
+        runSearches(graph, *heaps->back(), {source}, 20000, HeapData{0});
+        reached_nodes->emplace_back();
+        for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+        {
+            if (heaps->back()->WasInserted(node))
+            {
+                reached_nodes->back().push_back(node);
+            }
+        }
+    }
+
+    return {"ch/stall_at_node", [&graph, heaps, reached_nodes] {
+                std::size_t stalled = 0;
+                std::size_t calls = 0;
+                for (const auto index : util::irange<std::size_t>(0, heaps->size()))
+                {
+                    const auto &heap = *(*heaps)[index];
+                    for (const auto node : (*reached_nodes)[index])
+                    {
+                        stalled += engine::routing_algorithms::ch::stallAtNode<
+                            engine::routing_algorithms::FORWARD_DIRECTION>(
+                            graph, node, heap.GetKey(node) + 50, heap);
+                    }
+                    calls += (*reached_nodes)[index].size();
+                }
+                dont_optimize_away(stalled);
+                return calls;
+            }};
+}
+
+// The bucket lookups of a table with the columns searching from random targets
+std::vector<Kernel> makeBucketKernels(const std::size_t number_of_nodes)
+{
+    std::mt19937 g(1337);
+    std::uniform_int_distribution<NodeID> node_distribution(0, number_of_nodes - 1);
+    std::uniform_int_distribution<EdgeWeight> weight_distribution(0, 100000);
+
+    using NodeBucket = engine::routing_algorithms::NodeBucket;
+    using Compare = NodeBucket::Compare;
+    auto buckets = std::make_shared<std::vector<NodeBucket>>();
+    for (const auto column : util::irange(0u, 200u))
+    {
+        for (const auto index : util::irange(0u, 2000u))
+        {
+            (void)index;
+            const auto node = node_distribution(g);
+            const auto weight = weight_distribution(g);
+            buckets->emplace_back(node, node, column, weight, weight);
+        }
+    }
+    std::sort(buckets->begin(), buckets->end());
+    auto bucket_index = std::make_shared<engine::routing_algorithms::NodeBucketIndex>(*buckets);
+    auto lookups =
+        std::make_shared<std::vector<NodeID>>(randomNodes(number_of_nodes, 1000000));
+
+    return {{"buckets/equal_range",
+             [buckets, lookups] {
+                 std::uint64_t sum = 0;
+                 for (const auto node : *lookups)
+                 {
+                     const auto bucket_list =
+                         std::equal_range(buckets->begin(), buckets->end(), node, Compare());
+                     for (auto bucket = bucket_list.first; bucket != bucket_list.second; ++bucket)
+                     {
+                         sum += bucket->weight;
+                     }
+                 }
+                 dont_optimize_away(sum);
+                 return lookups->size();
+             }},
+            {"buckets/node_bucket_index", [bucket_index, lookups] {
+                 std::uint64_t sum = 0;
+                 for (const auto node : *lookups)
+                 {
+                     const auto range = bucket_index->Find(node);
+                     for (auto position = range.begin; position != range.end; ++position)
+                     {
+                         sum += bucket_index->GetWeight(position);
+                     }
+                 }
+                 dont_optimize_away(sum);
+                 return lookups->size();
+             }}};
+}
+
+// Cells of 8x8, 32x32 and 128x128 nodes of the grid
+std::vector<Kernel> makeCustomizerKernels(const std::uint32_t width,
+                                          const std::uint32_t height,
+                                          const std::vector<Edge> &edges)
+{
+    std::vector<std::vector<CellID>> partitions(3, std::vector<CellID>(width * height));
+    const std::uint32_t cell_sizes[] = {8, 32, 128};
+    for (const auto level : util::irange(0u, 3u))
+    {
+        const auto cell_size = cell_sizes[level];
+        const auto cells_per_row = (width + cell_size - 1) / cell_size;
+        for (const auto node : util::irange(0u, width * height))
+        {
+            partitions[level][node] =
+                (node / width / cell_size) * cells_per_row + (node % width) / cell_size;
+        }
+    }
+    std::vector<std::uint32_t> number_of_cells;
+    for (const auto &partition : partitions)
+    {
+        number_of_cells.push_back(*std::max_element(partition.begin(), partition.end()) + 1);
+    }
+
+    using MultiLevelGraph = partitioner::MultiLevelGraph<EdgeData, storage::Ownership::Container>;
+    auto partition =
+        std::make_shared<partitioner::MultiLevelPartition>(partitions, number_of_cells);
+    auto graph = std::make_shared<MultiLevelGraph>(*partition, width * height, edges);
+    auto storage = std::make_shared<partitioner::CellStorage>(*partition, *graph);
+    auto metric = std::make_shared<customizer::CellMetric>(storage->MakeMetric());
+    auto allowed_nodes = std::make_shared<std::vector<bool>>(width * height, true);
+    auto cell_customizer = std::make_shared<customizer::CellCustomizer>(*partition);
+    auto heap = std::make_shared<customizer::CellCustomizer::Heap>(width * height);
+
+    return {{"cell_customizer/first_level_cells",
+             [=] {
+                 const auto cells = partition->GetNumberOfCells(1);
+                 for (const auto cell : util::irange(0u, cells))
+                 {
+                     cell_customizer->Customize(
+                         *graph, *heap, *storage, *allowed_nodes, *metric, 1, cell);
+                 }
+                 return cells;
+             }},
+            {"cell_customizer/all_levels", [=] {
+                 cell_customizer->Customize(*graph, *storage, *allowed_nodes, *metric);
+                 std::size_t cells = 0;
+                 for (const auto level : util::irange<LevelID>(1, partition->GetNumberOfLevels()))
+                 {
+                     cells += partition->GetNumberOfCells(level);
+                 }
+                 return cells;
+             }}};
+}
+}
+
+int main(int argc, char **argv)
+{
+    util::LogPolicy::GetInstance().Unmute();
+    const std::string filter = argc > 1 ? argv[1] : "";
+
+    const std::uint32_t width = 512;
+    const std::uint32_t height = 512;
+    const auto edges = makeGridEdges(width, height);
+    const Graph graph(width * height, edges);
+    const auto sources = randomNodes(graph.GetNumberOfNodes(), 50);
+    const auto witness_sources = randomNodes(graph.GetNumberOfNodes(), 5000);
+    const std::size_t max_settled = 50000;
+
+    std::vector<Kernel> kernels;
+    kernels.push_back(makeQueryHeapKernel<util::QueryHeap<NodeID,
+                                                          NodeID,
+                                                          EdgeWeight,
+                                                          HeapData,
+                                                          util::ArrayStorage<NodeID, int>>>(
+        "query_heap/array", graph, sources, max_settled));
+    kernels.push_back(makeQueryHeapKernel<util::QueryHeap<NodeID,
+                                                          NodeID,
+                                                          EdgeWeight,
+                                                          HeapData,
+                                                          util::UnorderedMapStorage<NodeID, int>>>(
+        "query_heap/unordered_map", graph, sources, max_settled));
+    kernels.push_back(
+        makeQueryHeapKernel<util::QueryHeap<NodeID,
+                                            NodeID,
+                                            EdgeWeight,
+                                            HeapData,
+                                            util::GenerationArrayStorage<NodeID, int>>>(
+            "query_heap/generation_array", graph, sources, max_settled));
+    kernels.push_back(
+        makeQueryHeapKernel<util::QueryHeap<NodeID,
+                                            NodeID,
+                                            EdgeWeight,
+                                            HeapData,
+                                            util::PagedGenerationArrayStorage<NodeID, int>>>(
+            "query_heap/paged_generation_array", graph, sources, max_settled));
+    kernels.push_back(makeQueryHeapKernel<util::RadixQueryHeap<NodeID,
+                                                               NodeID,
+                                                               EdgeWeight,
+                                                               HeapData,
+                                                               util::ArrayStorage<NodeID, int>>>(
+        "radix_heap/array", graph, sources, max_settled));
+    kernels.push_back(makeContractorHeapKernel(graph, witness_sources));
+    kernels.push_back(makeStallingKernel(graph, randomNodes(graph.GetNumberOfNodes(), 8)));
+    for (auto &kernel : makeBucketKernels(graph.GetNumberOfNodes()))
+    {
+        kernels.push_back(std::move(kernel));
+    }
+    // the customization of all cells of a level is slow, its grid is smaller
+    for (auto &kernel : makeCustomizerKernels(256, 256, makeGridEdges(256, 256)))
+    {
+        kernels.push_back(std::move(kernel));
+    }
+
+    for (const auto &kernel : kernels)
+    {
+        if (kernel.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        kernel.run();
+        std::vector<double> times;
+        std::size_t operations = 0;
+        for (const auto repetition : util::irange<std::size_t>(0, REPETITIONS))
+        {
+            (void)repetition;
+            TIMER_START(run);
+            operations = kernel.run();
+            TIMER_STOP(run);
+            times.push_back(TIMER_MSEC(run));
+        }
+        std::nth_element(times.begin(), times.begin() + REPETITIONS / 2, times.end());
+        const auto median = times[REPETITIONS / 2];
+
+        util::Log() << kernel.name << ": " << median << " ms, "
+                    << median * 1000000. / std::max<std::size_t>(operations, 1) << " ns/op ("
+                    << operations << " ops)";
+    }
+
+    return EXIT_SUCCESS;
+}
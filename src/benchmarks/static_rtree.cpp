@@ -9,11 +9,16 @@
 #include "engine/geospatial_query.hpp"
 #include "util/coordinate.hpp"
 #include "util/serialization.hpp"
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/timing_util.hpp"
 
+#include <cstdint>
 #include <iostream>
 #include <random>
+#include <string>
 
+#include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
 namespace osrm
@@ -73,15 +78,51 @@ void benchmark(BenchStaticRTree &rtree, unsigned num_queries)
     benchmarkQuery(queries, "raw RTree queries (10 results)", [&rtree](const util::Coordinate &q) {
         return rtree.Nearest(q, 10);
     });
+    benchmarkQuery(queries, "raw RTree queries (100 results)", [&rtree](const util::Coordinate &q) {
+        return rtree.Nearest(q, 100);
+    });
+}
+
+// Rebuilds the tree from the segments of the .fileIndex with several layouts and benchmarks each
+void sweep(const boost::filesystem::path &file_index_path,
+           const std::vector<util::Coordinate> &coords,
+           unsigned num_queries)
+{
+    std::vector<RTreeLeaf> segments(boost::filesystem::file_size(file_index_path) /
+                                    sizeof(RTreeLeaf));
+    {
+        boost::filesystem::ifstream file_index(file_index_path, std::ios::binary);
+        file_index.read(reinterpret_cast<char *>(segments.data()),
+                        segments.size() * sizeof(RTreeLeaf));
+        if (!file_index)
+        {
+            throw util::exception("Could not read " + file_index_path.string() + SOURCE_REF);
+        }
+    }
+
+    const auto sweep_path =
+        boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("rtree-bench-%%%%-%%%%.fileIndex");
+    for (const std::uint32_t branching_factor : {16, 32, 64, 128})
+    {
+        for (const std::uint32_t leaf_page_size : {1024, 2048, 4096, 8192, 16384})
+        {
+            std::cout << "Branching factor " << branching_factor << ", leaf page size "
+                      << leaf_page_size << ":" << std::endl;
+            BenchStaticRTree rtree(segments, coords, sweep_path, branching_factor, leaf_page_size);
+            benchmark(rtree, num_queries);
+        }
+    }
+    boost::filesystem::remove(sweep_path);
 }
 }
 }
 
 int main(int argc, char **argv)
 {
-    if (argc < 4)
+    if (argc < 4 || (argc > 4 && std::string(argv[4]) != "--sweep"))
     {
-        std::cout << "./rtree-bench file.ramIndex file.fileIndx file.nodes"
+        std::cout << "./rtree-bench file.ramIndex file.fileIndx file.nodes [--sweep]"
                   << "\n";
         return 1;
     }
@@ -93,6 +134,12 @@ int main(int argc, char **argv)
     std::vector<osrm::util::Coordinate> coords;
     osrm::extractor::files::readNodeCoordinates(nodes_path, coords);
 
+    if (argc > 4)
+    {
+        osrm::benchmarks::sweep(file_path, coords, 10000);
+        return 0;
+    }
+
     osrm::benchmarks::BenchStaticRTree rtree(file_path, coords);
     osrm::extractor::files::readRamIndex(ram_path, rtree);
 
@@ -5,22 +5,30 @@
 #include "contractor/files.hpp"
 #include "contractor/graph_contractor.hpp"
 #include "contractor/graph_contractor_adaptors.hpp"
+#include "contractor/recustomize_graph.hpp"
+#include "contractor/renumber.hpp"
 
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/edge_based_graph_factory.hpp"
 #include "extractor/files.hpp"
 #include "extractor/node_based_edge.hpp"
 
+#include "partitioner/renumber.hpp"
+
 #include "storage/io.hpp"
 
 #include "updater/updater.hpp"
 
+#include "util/block_pool.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/exclude_flag.hpp"
 #include "util/filtered_graph.hpp"
 #include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/mmap_file.hpp"
+#include "util/permutation.hpp"
+#include "util/phase_report.hpp"
 #include "util/static_graph.hpp"
 #include "util/string_util.hpp"
 #include "util/timing_util.hpp"
@@ -35,6 +43,9 @@
 #include <vector>
 
 #include <boost/assert.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/optional.hpp>
 
 #include <tbb/task_scheduler_init.h>
 namespace osrm
@@ -42,6 +53,122 @@ namespace osrm
 namespace contractor
 {
 
+namespace
+{
+// Applies the permutation to all files that refer to edge-based nodes, like osrm-partition.
+// The graph and node weights are read again since the updater changed the ones in memory.
+void renumberFiles(const ContractorConfig &config, const std::vector<std::uint32_t> &permutation)
+{
+    {
+        EdgeID number_of_edge_based_nodes = 0;
+        std::vector<extractor::EdgeBasedEdge> edge_based_edge_list;
+        std::uint32_t connectivity_checksum = 0;
+        extractor::files::readEdgeBasedGraph(config.GetPath(".osrm.ebg"),
+                                             number_of_edge_based_nodes,
+                                             edge_based_edge_list,
+                                             connectivity_checksum);
+        renumber(edge_based_edge_list, permutation);
+        extractor::files::writeEdgeBasedGraph(config.GetPath(".osrm.ebg"),
+                                              number_of_edge_based_nodes,
+                                              edge_based_edge_list,
+                                              connectivity_checksum);
+    }
+    {
+        std::vector<EdgeWeight> node_weights;
+        extractor::files::readEdgeBasedNodeWeights(config.GetPath(".osrm.enw"), node_weights);
+        util::inplacePermutation(node_weights.begin(), node_weights.end(), permutation);
+        extractor::files::writeEdgeBasedNodeWeights(config.GetPath(".osrm.enw"), node_weights);
+    }
+    {
+        extractor::EdgeBasedNodeDataContainer node_data;
+        extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
+        partitioner::renumber(node_data, permutation);
+        extractor::files::writeNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
+    }
+    if (boost::filesystem::exists(config.GetPath(".osrm.cnbg_to_ebg")))
+    {
+        std::vector<extractor::NBGToEBG> mapping;
+        extractor::files::readNBGMapping(config.GetPath(".osrm.cnbg_to_ebg"), mapping);
+        partitioner::renumber(mapping, permutation);
+        extractor::files::writeNBGMapping(config.GetPath(".osrm.cnbg_to_ebg"), mapping);
+    }
+    if (boost::filesystem::exists(config.GetPath(".osrm.fileIndex")))
+    {
+        boost::iostreams::mapped_file segment_region;
+        auto segments = util::mmapFile<extractor::EdgeBasedNodeSegment>(
+            config.GetPath(".osrm.fileIndex"), segment_region);
+        partitioner::renumber(segments, permutation);
+    }
+    if (boost::filesystem::exists(config.GetPath(".osrm.maneuver_overrides")))
+    {
+        const auto &filename = config.GetPath(".osrm.maneuver_overrides");
+        std::vector<extractor::StorageManeuverOverride> maneuver_overrides;
+        std::vector<NodeID> node_sequences;
+        extractor::files::readManeuverOverrides(filename, maneuver_overrides, node_sequences);
+        partitioner::renumber(maneuver_overrides, permutation);
+        partitioner::renumber(node_sequences, permutation);
+        extractor::files::writeManeuverOverrides(filename, maneuver_overrides, node_sequences);
+    }
+}
+
+// Customizes the hierarchy of the existing .hsgr file for the new weights, returns none if the
+// graph needs to be contracted
+boost::optional<GraphAndFilter>
+recustomizeExistingGraph(const ContractorConfig &config,
+                         const std::string &metric_name,
+                         const EdgeID number_of_edge_based_nodes,
+                         const std::uint32_t connectivity_checksum,
+                         const std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list)
+{
+    if (!boost::filesystem::exists(config.GetPath(".osrm.hsgr")))
+    {
+        util::Log(logWARNING) << "No .osrm.hsgr file to reuse the hierarchy of, contracting the "
+                                 "whole graph.";
+        return boost::none;
+    }
+
+    std::unordered_map<std::string, ContractedMetric> metrics = {{metric_name, {}}};
+    std::uint32_t graph_connectivity_checksum = 0;
+    try
+    {
+        files::readGraph(config.GetPath(".osrm.hsgr"), metrics, graph_connectivity_checksum);
+    }
+    catch (const util::exception &e)
+    {
+        util::Log(logWARNING) << "Can not reuse the hierarchy of the .osrm.hsgr file: " << e.what()
+                              << ", contracting the whole graph.";
+        return boost::none;
+    }
+
+    const auto &metric = metrics[metric_name];
+    if (graph_connectivity_checksum != connectivity_checksum ||
+        metric.graph.GetNumberOfNodes() != number_of_edge_based_nodes)
+    {
+        util::Log(logWARNING) << "The .osrm.hsgr file belongs to another edge-based graph, "
+                                 "contracting the whole graph.";
+        return boost::none;
+    }
+
+    // a filter that allows all edges is stored empty
+    auto edge_filters = metric.edge_filter;
+    for (auto &edge_filter : edge_filters)
+    {
+        if (edge_filter.empty())
+        {
+            edge_filter.resize(metric.graph.GetNumberOfEdges(), true);
+        }
+    }
+
+    auto graph_and_filters = recustomizeGraph(metric.graph, edge_filters, edge_based_edge_list);
+    if (!graph_and_filters)
+    {
+        util::Log(logWARNING) << "The edges of the .osrm.hsgr file are no hierarchy, contracting "
+                                 "the whole graph.";
+    }
+    return graph_and_filters;
+}
+}
+
 int Contractor::Run()
 {
     tbb::task_scheduler_init init(config.requested_num_threads);
@@ -61,6 +188,7 @@ int Contractor::Run()
 
     TIMER_START(preparing);
 
+    util::ReportPhase loading_phase("loading_graph");
     util::Log() << "Reading node weights.";
     std::vector<EdgeWeight> node_weights;
     extractor::files::readEdgeBasedNodeWeights(config.GetPath(".osrm.enw"), node_weights);
@@ -77,7 +205,10 @@ int Contractor::Run()
 
     // Contracting the edge-expanded graph
 
+    loading_phase.Stop();
+
     TIMER_START(contraction);
+    util::ReportPhase contraction_phase(config.reuse_hierarchy ? "recustomization" : "contraction");
 
     std::string metric_name;
     std::vector<std::vector<bool>> node_filters;
@@ -96,18 +227,70 @@ int Contractor::Run()
     QueryGraph query_graph;
     std::vector<std::vector<bool>> edge_filters;
     std::vector<std::vector<bool>> cores;
-    std::tie(query_graph, edge_filters) = contractExcludableGraph(
-        toContractorGraph(number_of_edge_based_nodes, std::move(edge_based_edge_list)),
-        std::move(node_weights),
-        std::move(node_filters));
+    boost::optional<GraphAndFilter> recustomized_graph;
+    if (config.reuse_hierarchy)
+    {
+        recustomized_graph = recustomizeExistingGraph(config,
+                                                      metric_name,
+                                                      number_of_edge_based_nodes,
+                                                      connectivity_checksum,
+                                                      edge_based_edge_list);
+    }
+    if (recustomized_graph)
+    {
+        std::tie(query_graph, edge_filters) = std::move(*recustomized_graph);
+    }
+    else
+    {
+        std::tie(query_graph, edge_filters) = contractExcludableGraph(
+            toContractorGraph(number_of_edge_based_nodes, std::move(edge_based_edge_list)),
+            std::move(node_weights),
+            std::move(node_filters));
+    }
+    contraction_phase.Stop();
     TIMER_STOP(contraction);
+    // the contractor graph is gone, its slabs would only be reused by another contraction
+    util::BlockPool::GetInstance().Trim();
     util::Log() << "Contracted graph has " << query_graph.GetNumberOfEdges() << " edges.";
-    util::Log() << "Contraction took " << TIMER_SEC(contraction) << " sec";
+    util::Log() << (recustomized_graph ? "Customization" : "Contraction") << " took "
+                << TIMER_SEC(contraction) << " sec";
+
+    if (config.renumber_nodes)
+    {
+        if (boost::filesystem::exists(config.GetPath(".osrm.partition")))
+        {
+            util::Log(logWARNING) << "Found existing .osrm.partition file, not renumbering the "
+                                     "nodes since the MLD data uses their current IDs.";
+        }
+        else
+        {
+            TIMER_START(renumber);
+            util::ReportPhase renumber_phase("renumber");
+            const auto permutation = makePermutation(query_graph);
+            renumber(query_graph, edge_filters, permutation);
+            renumberFiles(config, permutation);
+            renumber_phase.Stop();
+            TIMER_STOP(renumber);
+            util::Log() << "Renumbered data in " << TIMER_SEC(renumber) << " seconds";
+        }
+    }
+
+    // the queries do not check a filter that allows all edges, which saves a bit per edge
+    for (auto &edge_filter : edge_filters)
+    {
+        if (util::allowsAllEdges(edge_filter))
+        {
+            edge_filter.clear();
+        }
+    }
 
     std::unordered_map<std::string, ContractedMetric> metrics = {
-        {metric_name, {std::move(query_graph), std::move(edge_filters)}}};
+        {metric_name, {CompactQueryGraph{query_graph}, std::move(edge_filters)}}};
+    query_graph = QueryGraph{};
 
+    util::ReportPhase writing_phase("writing");
     files::writeGraph(config.GetPath(".osrm.hsgr"), metrics, connectivity_checksum);
+    writing_phase.Stop();
 
     TIMER_STOP(preparing);
 
@@ -50,7 +50,7 @@ void relaxNode(ContractorHeap &heap,
 void search(ContractorHeap &heap,
             const ContractorGraph &graph,
             const unsigned number_of_targets,
-            const int node_limit,
+            const WitnessSearchLimits limits,
             const EdgeWeight weight_limit,
             const NodeID forbidden_node)
 {
@@ -61,7 +61,7 @@ void search(ContractorHeap &heap,
         const NodeID node = heap.DeleteMin();
         BOOST_ASSERT(node != SPECIAL_NODEID);
         const auto node_weight = heap.GetKey(node);
-        if (++nodes > node_limit)
+        if (++nodes > limits.node_limit)
         {
             return;
         }
@@ -80,6 +80,12 @@ void search(ContractorHeap &heap,
             }
         }
 
+        // paths through this node would have too many edges
+        if (heap.GetData(node).hop >= limits.hop_limit)
+        {
+            continue;
+        }
+
         relaxNode(heap, graph, node, node_weight, forbidden_node);
     }
 }
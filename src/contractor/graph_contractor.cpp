@@ -19,6 +19,7 @@
 #include <tbb/parallel_sort.h>
 
 #include <algorithm>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <vector>
@@ -98,6 +99,39 @@ struct RemainingNodeData
     bool is_independent : 1;
 };
 
+// The witness searches of a round are limited by the average degree of the remaining nodes. In the
+// sparse graph of the first rounds the witnesses are detours over many edges. In the dense core
+// the witnesses mostly use a few shortcuts, longer searches would run into the node limit anyway.
+// The priority simulations run far more often and get lower limits than the contraction, a
+// missed witness only makes the estimate worse [Geisberger et al. 2008].
+struct ContractionPhase
+{
+    // the phase is used up to this average number of edges of the remaining nodes
+    float max_average_degree;
+    WitnessSearchLimits simulation;
+    WitnessSearchLimits contraction;
+};
+
+const constexpr ContractionPhase CONTRACTION_PHASES[] = {
+    {6.f, {1000, 6}, {2000, 10}}, {std::numeric_limits<float>::max(), {1000, 5}, {2000, 8}}};
+
+const ContractionPhase &GetContractionPhase(const ContractorGraph &graph,
+                                            const std::vector<RemainingNodeData> &remaining_nodes)
+{
+    std::size_t edges = 0;
+    for (const auto &node : remaining_nodes)
+    {
+        edges += graph.GetOutDegree(node.id);
+    }
+    const auto average_degree =
+        remaining_nodes.empty() ? 0.f : static_cast<float>(edges) / remaining_nodes.size();
+    return *std::find_if(std::begin(CONTRACTION_PHASES),
+                         std::end(CONTRACTION_PHASES),
+                         [average_degree](const ContractionPhase &phase) {
+                             return average_degree <= phase.max_average_degree;
+                         });
+}
+
 struct ThreadDataContainer
 {
     explicit ThreadDataContainer(int number_of_nodes) : number_of_nodes(number_of_nodes) {}
@@ -140,6 +174,7 @@ void ContractNode(ContractorThreadData *data,
                   const ContractorGraph &graph,
                   const NodeID node,
                   std::vector<EdgeWeight> &node_weights,
+                  const WitnessSearchLimits limits,
                   ContractionStats *stats = nullptr)
 {
     auto &heap = data->heap;
@@ -242,16 +277,7 @@ void ContractNode(ContractorThreadData *data,
             }
         }
 
-        if (RUNSIMULATION)
-        {
-            const int constexpr SIMULATION_SEARCH_SPACE_SIZE = 1000;
-            search(heap, graph, number_of_targets, SIMULATION_SEARCH_SPACE_SIZE, max_weight, node);
-        }
-        else
-        {
-            const int constexpr FULL_SEARCH_SPACE_SIZE = 2000;
-            search(heap, graph, number_of_targets, FULL_SEARCH_SPACE_SIZE, max_weight, node);
-        }
+        search(heap, graph, number_of_targets, limits, max_weight, node);
         for (auto out_edge : graph.GetAdjacentEdgeRange(node))
         {
             const ContractorEdgeData &out_data = graph.GetEdgeData(out_edge);
@@ -342,18 +368,20 @@ void ContractNode(ContractorThreadData *data,
 void ContractNode(ContractorThreadData *data,
                   const ContractorGraph &graph,
                   const NodeID node,
-                  std::vector<EdgeWeight> &node_weights)
+                  std::vector<EdgeWeight> &node_weights,
+                  const ContractionPhase &phase)
 {
-    ContractNode<false>(data, graph, node, node_weights, nullptr);
+    ContractNode<false>(data, graph, node, node_weights, phase.contraction, nullptr);
 }
 
 ContractionStats SimulateNodeContraction(ContractorThreadData *data,
                                          const ContractorGraph &graph,
                                          const NodeID node,
-                                         std::vector<EdgeWeight> &node_weights)
+                                         std::vector<EdgeWeight> &node_weights,
+                                         const ContractionPhase &phase)
 {
     ContractionStats stats;
-    ContractNode<true>(data, graph, node, node_weights, &stats);
+    ContractNode<true>(data, graph, node, node_weights, phase.simulation, &stats);
     return stats;
 }
 
@@ -459,7 +487,8 @@ void DeleteIncomingEdges(ContractorThreadData *data, ContractorGraph &graph, con
 bool UpdateNodeNeighbours(ContractorNodeData &node_data,
                           ContractorThreadData *data,
                           const ContractorGraph &graph,
-                          const NodeID node)
+                          const NodeID node,
+                          const ContractionPhase &phase)
 {
     std::vector<NodeID> &neighbours = data->neighbours;
     neighbours.clear();
@@ -485,12 +514,86 @@ bool UpdateNodeNeighbours(ContractorNodeData &node_data,
         if (node_data.contractable[u])
         {
             node_data.priorities[u] = EvaluateNodePriority(
-                SimulateNodeContraction(data, graph, u, node_data.weights), node_data.depths[u]);
+                SimulateNodeContraction(data, graph, u, node_data.weights, phase),
+                node_data.depths[u]);
         }
     }
     return true;
 }
 
+// Inserts the shortcuts of all threads into the graph. The edges are grouped by their source,
+// after making room for the new edges of every source serially, the sources insert their edges in
+// parallel.
+void InsertNewEdges(ThreadDataContainer &thread_data_list, ContractorGraph &graph)
+{
+    // the offsets of the thread local buffers in one vector of all new edges
+    std::vector<ContractorThreadData *> thread_data;
+    std::vector<std::size_t> offsets = {0};
+    for (auto &data : thread_data_list.data)
+    {
+        thread_data.push_back(data.get());
+        offsets.push_back(offsets.back() + data->inserted_edges.size());
+    }
+
+    std::vector<ContractorEdge> inserted_edges(offsets.back());
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, thread_data.size(), 1), [&](const auto &range) {
+            for (auto index = range.begin(), end = range.end(); index != end; ++index)
+            {
+                auto &edges = thread_data[index]->inserted_edges;
+                std::copy(edges.begin(), edges.end(), inserted_edges.begin() + offsets[index]);
+                edges.clear();
+            }
+        });
+    tbb::parallel_sort(inserted_edges.begin(), inserted_edges.end());
+
+    std::vector<std::size_t> source_begins;
+    for (const auto index : util::irange<std::size_t>(0, inserted_edges.size()))
+    {
+        if (index == 0 || inserted_edges[index - 1].source != inserted_edges[index].source)
+        {
+            source_begins.push_back(index);
+        }
+    }
+    source_begins.push_back(inserted_edges.size());
+
+    for (const auto source_index : util::irange<std::size_t>(0, source_begins.size() - 1))
+    {
+        const auto begin = source_begins[source_index];
+        graph.ReserveEdges(inserted_edges[begin].source, source_begins[source_index + 1] - begin);
+    }
+
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, source_begins.size() - 1), [&](const auto &range) {
+            for (auto source_index = range.begin(), end = range.end(); source_index != end;
+                 ++source_index)
+            {
+                for (const auto index : util::irange<std::size_t>(source_begins[source_index],
+                                                                  source_begins[source_index + 1]))
+                {
+                    const ContractorEdge &edge = inserted_edges[index];
+                    const EdgeID current_edge_ID = graph.FindEdge(edge.source, edge.target);
+                    if (current_edge_ID != SPECIAL_EDGEID)
+                    {
+                        auto &current_data = graph.GetEdgeData(current_edge_ID);
+                        if (current_data.shortcut && edge.data.forward == current_data.forward &&
+                            edge.data.backward == current_data.backward)
+                        {
+                            // found a duplicate edge with smaller weight, update it.
+                            if (edge.data.weight < current_data.weight)
+                            {
+                                current_data = edge.data;
+                            }
+                            // don't insert duplicates
+                            continue;
+                        }
+                    }
+                    graph.InsertEdge(edge.source, edge.target, edge.data);
+                }
+            }
+        });
+}
+
 bool IsNodeIndependent(const util::XORFastHash<> &hash,
                        const std::vector<float> &priorities,
                        const std::vector<NodeID> &new_to_old_node_id,
@@ -613,6 +716,7 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
         }
     }
 
+    auto phase = GetContractionPhase(graph, remaining_nodes);
     {
         util::UnbufferedLog log;
         log << "initializing node priorities...";
@@ -624,7 +728,8 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
                                   auto node = remaining_nodes[x].id;
                                   BOOST_ASSERT(node_data.contractable[node]);
                                   node_data.priorities[node] = EvaluateNodePriority(
-                                      SimulateNodeContraction(data, graph, node, node_data.weights),
+                                      SimulateNodeContraction(
+                                          data, graph, node, node_data.weights, phase),
                                       node_data.depths[node]);
                               }
                           });
@@ -652,6 +757,7 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
             // only one renumbering for now
             next_renumbering = 0;
         }
+        phase = GetContractionPhase(graph, remaining_nodes);
 
         tbb::parallel_for(
             tbb::blocked_range<NodeID>(0, remaining_nodes.size(), IndependentGrainSize),
@@ -684,7 +790,7 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
                 for (auto position = range.begin(), end = range.end(); position != end; ++position)
                 {
                     const NodeID node = remaining_nodes[position].id;
-                    ContractNode(data, graph, node, node_data.weights);
+                    ContractNode(data, graph, node, node_data.weights, phase);
                 }
             });
 
@@ -707,37 +813,7 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
                 }
             });
 
-        // make sure we really sort each block
-        tbb::parallel_for(thread_data_list.data.range(), [&](const auto &range) {
-            for (auto &data : range)
-                tbb::parallel_sort(data->inserted_edges.begin(), data->inserted_edges.end());
-        });
-
-        // insert new edges
-        for (auto &data : thread_data_list.data)
-        {
-            for (const ContractorEdge &edge : data->inserted_edges)
-            {
-                const EdgeID current_edge_ID = graph.FindEdge(edge.source, edge.target);
-                if (current_edge_ID != SPECIAL_EDGEID)
-                {
-                    auto &current_data = graph.GetEdgeData(current_edge_ID);
-                    if (current_data.shortcut && edge.data.forward == current_data.forward &&
-                        edge.data.backward == current_data.backward)
-                    {
-                        // found a duplicate edge with smaller weight, update it.
-                        if (edge.data.weight < current_data.weight)
-                        {
-                            current_data = edge.data;
-                        }
-                        // don't insert duplicates
-                        continue;
-                    }
-                }
-                graph.InsertEdge(edge.source, edge.target, edge.data);
-            }
-            data->inserted_edges.clear();
-        }
+        InsertNewEdges(thread_data_list, graph);
 
         tbb::parallel_for(
             tbb::blocked_range<NodeID>(
@@ -747,7 +823,7 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
                 for (auto position = range.begin(), end = range.end(); position != end; ++position)
                 {
                     NodeID node = remaining_nodes[position].id;
-                    UpdateNodeNeighbours(node_data, data, graph, node);
+                    UpdateNodeNeighbours(node_data, data, graph, node, phase);
                 }
             });
 
@@ -0,0 +1,275 @@
+#include "contractor/recustomize_graph.hpp"
+#include "contractor/contracted_edge_container.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <tuple>
+
+namespace osrm
+{
+namespace contractor
+{
+namespace
+{
+
+// The new weights of the original edges, by their source and target
+class OriginalEdges
+{
+  public:
+    explicit OriginalEdges(const std::vector<extractor::EdgeBasedEdge> &edge_based_edges)
+    {
+        for (const auto &edge : edge_based_edges)
+        {
+            if (edge.data.weight == INVALID_EDGE_WEIGHT || edge.source == edge.target)
+                continue;
+
+            // same as the weights of toContractorGraph
+            const auto weight = std::max(edge.data.weight, 1);
+            if (edge.data.forward)
+                edges.push_back(
+                    {edge.source, edge.target, edge.data.turn_id, weight, edge.data.duration});
+            if (edge.data.backward)
+                edges.push_back(
+                    {edge.target, edge.source, edge.data.turn_id, weight, edge.data.duration});
+        }
+        // the smallest of parallel edges comes first
+        tbb::parallel_sort(edges.begin(), edges.end(), [](const auto &lhs, const auto &rhs) {
+            return std::tie(lhs.from, lhs.to, lhs.weight) < std::tie(rhs.from, rhs.to, rhs.weight);
+        });
+    }
+
+    struct Edge
+    {
+        NodeID from;
+        NodeID to;
+        EdgeID turn_id;
+        EdgeWeight weight;
+        EdgeWeight duration;
+    };
+
+    const Edge *Find(const NodeID from, const NodeID to) const
+    {
+        const auto iter = std::lower_bound(
+            edges.begin(), edges.end(), std::make_pair(from, to), [](const Edge &edge, auto key) {
+                return std::tie(edge.from, edge.to) < std::tie(key.first, key.second);
+            });
+        if (iter == edges.end() || iter->from != from || iter->to != to)
+            return nullptr;
+        return &*iter;
+    }
+
+  private:
+    std::vector<Edge> edges;
+};
+
+// A directed edge of the hierarchy, stored at its lower node like the edges of the query graph
+struct Arc
+{
+    NodeID other;   // the upper node
+    bool upward;    // from the lower to the upper node, the forward flag of a query edge
+    bool shortcut;
+    NodeID turn_id; // the middle node of shortcuts
+    EdgeWeight weight;
+    EdgeWeight duration;
+};
+
+// Customizes the hierarchy of one filter, returns its edges sorted for ContractedEdgeContainer
+boost::optional<std::vector<QueryEdge>> recustomizeFilter(const CompactQueryGraph &graph,
+                                                          const std::vector<bool> &edge_filter,
+                                                          const OriginalEdges &original_edges)
+{
+    const auto number_of_nodes = graph.GetNumberOfNodes();
+
+    std::vector<EdgeID> first_arc;
+    first_arc.reserve(number_of_nodes + 1);
+    std::vector<Arc> arcs;
+    std::vector<std::uint32_t> number_of_lower_nodes(number_of_nodes, 0);
+    for (const auto node : util::irange(0u, number_of_nodes))
+    {
+        first_arc.push_back(arcs.size());
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            if (!edge_filter[edge])
+                continue;
+
+            const auto target = graph.GetTarget(edge);
+            const auto data = graph.GetEdgeData(edge);
+            const auto add_arc = [&](const bool upward) {
+                const auto from = upward ? node : target;
+                const auto to = upward ? target : node;
+                if (data.shortcut)
+                {
+                    arcs.push_back({target, upward, true, data.turn_id, INVALID_EDGE_WEIGHT, 0});
+                }
+                else if (const auto original = original_edges.Find(from, to))
+                {
+                    arcs.push_back({target,
+                                    upward,
+                                    false,
+                                    original->turn_id,
+                                    original->weight,
+                                    original->duration});
+                }
+                else
+                {
+                    arcs.push_back({target, upward, false, data.turn_id, INVALID_EDGE_WEIGHT, 0});
+                }
+                ++number_of_lower_nodes[target];
+            };
+            if (data.forward)
+                add_arc(true);
+            if (data.backward)
+                add_arc(false);
+        }
+    }
+    first_arc.push_back(arcs.size());
+
+    const auto find_arc = [&](const NodeID from, const NodeID to) -> Arc * {
+        for (const auto index : util::irange(first_arc[from], first_arc[from + 1]))
+            if (arcs[index].other == to && arcs[index].upward)
+                return &arcs[index];
+        for (const auto index : util::irange(first_arc[to], first_arc[to + 1]))
+            if (arcs[index].other == from && !arcs[index].upward)
+                return &arcs[index];
+        return nullptr;
+    };
+
+    // bottom-up order of the nodes, a node follows all nodes below it
+    std::vector<NodeID> order;
+    order.reserve(number_of_nodes);
+    for (const auto node : util::irange(0u, number_of_nodes))
+    {
+        if (number_of_lower_nodes[node] == 0)
+            order.push_back(node);
+    }
+    for (std::size_t index = 0; index < order.size(); ++index)
+    {
+        const auto node = order[index];
+        for (const auto arc : util::irange(first_arc[node], first_arc[node + 1]))
+        {
+            if (--number_of_lower_nodes[arcs[arc].other] == 0)
+                order.push_back(arcs[arc].other);
+        }
+    }
+    if (order.size() != number_of_nodes)
+    {
+        return boost::none;
+    }
+
+    // the arcs to a node are final once all nodes below it relaxed their triangles
+    for (const auto middle : order)
+    {
+        for (const auto in_arc : util::irange(first_arc[middle], first_arc[middle + 1]))
+        {
+            const auto &in = arcs[in_arc];
+            if (in.upward || in.weight == INVALID_EDGE_WEIGHT)
+                continue;
+
+            for (const auto out_arc : util::irange(first_arc[middle], first_arc[middle + 1]))
+            {
+                const auto &out = arcs[out_arc];
+                if (!out.upward || out.weight == INVALID_EDGE_WEIGHT || out.other == in.other)
+                    continue;
+
+                const auto weight = in.weight + out.weight;
+                auto arc = find_arc(in.other, out.other);
+                if (arc != nullptr && weight < arc->weight)
+                {
+                    arc->weight = weight;
+                    arc->duration = in.duration + out.duration;
+                    arc->shortcut = true;
+                    arc->turn_id = middle;
+                }
+            }
+        }
+    }
+
+    std::vector<QueryEdge> edges;
+    edges.reserve(arcs.size());
+    for (const auto node : util::irange(0u, number_of_nodes))
+    {
+        for (const auto index : util::irange(first_arc[node], first_arc[node + 1]))
+        {
+            const auto &arc = arcs[index];
+            if (arc.weight == INVALID_EDGE_WEIGHT)
+                continue;
+            edges.push_back(QueryEdge{
+                node,
+                arc.other,
+                {arc.turn_id, arc.shortcut, arc.weight, arc.duration, arc.upward, !arc.upward}});
+        }
+    }
+
+    // merge both directions of an edge with the same data into one edge, like the contraction
+    const auto data_of = [](const QueryEdge &edge) {
+        return std::make_tuple(edge.source,
+                               edge.target,
+                               edge.data.shortcut,
+                               edge.data.turn_id,
+                               edge.data.weight,
+                               edge.data.duration);
+    };
+    tbb::parallel_sort(edges.begin(), edges.end(), [&](const auto &lhs, const auto &rhs) {
+        return std::make_tuple(data_of(lhs), lhs.data.forward) <
+               std::make_tuple(data_of(rhs), rhs.data.forward);
+    });
+    std::size_t merged_size = 0;
+    for (std::size_t index = 0; index < edges.size(); ++index)
+    {
+        if (merged_size > 0 && data_of(edges[merged_size - 1]) == data_of(edges[index]))
+        {
+            edges[merged_size - 1].data.forward |= edges[index].data.forward;
+            edges[merged_size - 1].data.backward |= edges[index].data.backward;
+        }
+        else
+        {
+            edges[merged_size++] = edges[index];
+        }
+    }
+    edges.resize(merged_size);
+
+    return edges;
+}
+}
+
+boost::optional<GraphAndFilter>
+recustomizeGraph(const CompactQueryGraph &graph,
+                 const std::vector<std::vector<bool>> &edge_filters,
+                 const std::vector<extractor::EdgeBasedEdge> &edge_based_edges)
+{
+    const OriginalEdges original_edges(edge_based_edges);
+
+    std::vector<boost::optional<std::vector<QueryEdge>>> filter_edges(edge_filters.size());
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, edge_filters.size(), 1),
+                      [&](const auto &range) {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              filter_edges[index] =
+                                  recustomizeFilter(graph, edge_filters[index], original_edges);
+                          }
+                      });
+
+    ContractedEdgeContainer edge_container;
+    for (auto &edges : filter_edges)
+    {
+        if (!edges)
+        {
+            return boost::none;
+        }
+        edge_container.Merge(std::move(*edges));
+    }
+
+    return GraphAndFilter{QueryGraph{graph.GetNumberOfNodes(), std::move(edge_container.edges)},
+                          edge_container.MakeEdgeFilters()};
+}
+
+} // namespace contractor
+} // namespace osrm
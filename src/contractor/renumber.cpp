@@ -0,0 +1,94 @@
+#include "contractor/renumber.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/permutation.hpp"
+
+#include <boost/assert.hpp>
+
+#include <utility>
+
+namespace osrm
+{
+namespace contractor
+{
+
+std::vector<std::uint32_t> makePermutation(const QueryGraph &graph)
+{
+    const auto number_of_nodes = graph.GetNumberOfNodes();
+
+    std::vector<std::uint32_t> ordering;
+    ordering.reserve(number_of_nodes);
+    std::vector<bool> visited(number_of_nodes, false);
+
+    // Every node stores the edges to the nodes contracted after it. A node is appended to the
+    // ordering once all nodes it reaches are, which is a post order of the search.
+    // The shared core of excludable graphs can contain edges in both directions, visited nodes
+    // are never entered twice.
+    std::vector<std::pair<NodeID, EdgeID>> stack;
+    for (const auto root : util::irange<NodeID>(0, number_of_nodes))
+    {
+        if (visited[root])
+            continue;
+
+        visited[root] = true;
+        stack.emplace_back(root, graph.BeginEdges(root));
+        while (!stack.empty())
+        {
+            const auto node = stack.back().first;
+            const auto edge = stack.back().second;
+            if (edge == graph.EndEdges(node))
+            {
+                ordering.push_back(node);
+                stack.pop_back();
+                continue;
+            }
+
+            stack.back().second = edge + 1;
+            const auto target = graph.GetTarget(edge);
+            if (!visited[target])
+            {
+                visited[target] = true;
+                stack.emplace_back(target, graph.BeginEdges(target));
+            }
+        }
+    }
+    BOOST_ASSERT(ordering.size() == number_of_nodes);
+
+    return util::orderingToPermutation(ordering);
+}
+
+void renumber(QueryGraph &graph,
+              std::vector<std::vector<bool>> &edge_filters,
+              const std::vector<std::uint32_t> &permutation)
+{
+    const auto old_to_new_edge = graph.Renumber(permutation);
+
+    for (const auto edge : util::irange<EdgeID>(0, graph.GetNumberOfEdges()))
+    {
+        auto &data = graph.GetEdgeData(edge);
+        if (data.shortcut)
+            data.turn_id = permutation[data.turn_id];
+    }
+
+    // std::vector<bool> has no references to swap for util::inplacePermutation
+    for (auto &filter : edge_filters)
+    {
+        std::vector<bool> renumbered_filter(filter.size());
+        for (const auto edge : util::irange<EdgeID>(0, filter.size()))
+            renumbered_filter[old_to_new_edge[edge]] = filter[edge];
+        filter = std::move(renumbered_filter);
+    }
+}
+
+void renumber(std::vector<extractor::EdgeBasedEdge> &edges,
+              const std::vector<std::uint32_t> &permutation)
+{
+    for (auto &edge : edges)
+    {
+        edge.source = permutation[edge.source];
+        edge.target = permutation[edge.target];
+    }
+}
+
+} // namespace contractor
+} // namespace osrm
@@ -4,6 +4,7 @@
 #include "customizer/customizer.hpp"
 #include "customizer/edge_based_graph.hpp"
 #include "customizer/files.hpp"
+#include "customizer/query_evaluation.hpp"
 
 #include "partitioner/cell_storage.hpp"
 #include "partitioner/edge_based_graph_reader.hpp"
@@ -14,14 +15,21 @@
 
 #include "updater/updater.hpp"
 
+#include "util/exception.hpp"
 #include "util/exclude_flag.hpp"
 #include "util/log.hpp"
+#include "util/phase_report.hpp"
 #include "util/timing_util.hpp"
 
 #include <boost/assert.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/optional.hpp>
 
 #include <tbb/task_scheduler_init.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace osrm
 {
 namespace customizer
@@ -82,6 +90,8 @@ void CellStorageStatistics(const Graph &graph,
     }
 }
 
+// Builds the graph from the mapped .osrm.ebg file if no weights are updated, otherwise the
+// updated edges are released as soon as the directed edges are split off them
 auto LoadAndUpdateEdgeExpandedGraph(const CustomizationConfig &config,
                                     const partitioner::MultiLevelPartition &mlp,
                                     std::uint32_t &connectivity_checksum)
@@ -89,11 +99,23 @@ auto LoadAndUpdateEdgeExpandedGraph(const CustomizationConfig &config,
     updater::Updater updater(config.updater_config);
 
     EdgeID num_nodes;
-    std::vector<extractor::EdgeBasedEdge> edge_based_edge_list;
-    std::tie(num_nodes, edge_based_edge_list, connectivity_checksum) =
-        updater.LoadAndUpdateEdgeExpandedGraph();
+    std::vector<extractor::EdgeBasedEdge> directed;
+    if (updater.HasUpdates())
+    {
+        std::vector<extractor::EdgeBasedEdge> edge_based_edge_list;
+        std::tie(num_nodes, edge_based_edge_list, connectivity_checksum) =
+            updater.LoadAndUpdateEdgeExpandedGraph();
+        directed = partitioner::splitBidirectionalEdges(edge_based_edge_list);
+    }
+    else
+    {
+        updater.SaveDatasourcesNames();
+        const partitioner::EdgeBasedGraphFile file{config.GetPath(".osrm.ebg")};
+        num_nodes = file.GetNumberOfNodes();
+        connectivity_checksum = file.GetConnectivityChecksum();
+        directed = partitioner::splitBidirectionalEdges(file.GetEdges());
+    }
 
-    auto directed = partitioner::splitBidirectionalEdges(edge_based_edge_list);
     auto tidied =
         partitioner::prepareEdgesForUsageInGraph<StaticEdgeBasedGraphEdge>(std::move(directed));
     auto edge_based_graph = customizer::MultiLevelEdgeBasedGraph(mlp, num_nodes, std::move(tidied));
@@ -107,15 +129,83 @@ std::vector<CellMetric> customizeFilteredMetrics(const MultiLevelEdgeBasedGraph
                                                  const std::vector<std::vector<bool>> &node_filters)
 {
     std::vector<CellMetric> metrics;
+    std::generate_n(std::back_inserter(metrics), node_filters.size(), [&] {
+        return storage.MakeMetric();
+    });
+
+    customizer.Customize(graph, storage, node_filters, metrics);
+    return metrics;
+}
+
+// Returns the metrics of the last customization with only the cells updated that contain changed
+// edges, or none if the files of the last customization don't fit the current data.
+boost::optional<std::vector<CellMetric>>
+customizeChangedMetrics(const CustomizationConfig &config,
+                        const std::string &metric_name,
+                        const MultiLevelEdgeBasedGraph &graph,
+                        const std::uint32_t connectivity_checksum,
+                        const partitioner::CellStorage &storage,
+                        const CellCustomizer &customizer,
+                        const std::vector<std::vector<bool>> &node_filters)
+{
+    if (!boost::filesystem::exists(config.GetOutputPath(".osrm.mldgr")) ||
+        !boost::filesystem::exists(config.GetOutputPath(".osrm.cell_metrics")))
+    {
+        util::Log(logWARNING) << "No .osrm.mldgr and .osrm.cell_metrics files of a last "
+                                 "customization, customizing all cells.";
+        return boost::none;
+    }
 
-    for (auto filter : node_filters)
+    std::unordered_map<std::string, std::vector<CellMetric>> metric_exclude_classes = {
+        {metric_name, {}}};
+    MultiLevelEdgeBasedGraph old_graph;
+    std::uint32_t old_connectivity_checksum = 0;
+    try
     {
-        auto metric = storage.MakeMetric();
-        customizer.Customize(graph, storage, filter, metric);
-        metrics.push_back(std::move(metric));
+        files::readCellMetrics(config.GetOutputPath(".osrm.cell_metrics"), metric_exclude_classes);
+        partitioner::files::readGraph(
+            config.GetOutputPath(".osrm.mldgr"), old_graph, old_connectivity_checksum);
+    }
+    catch (const util::exception &e)
+    {
+        util::Log(logWARNING) << "Can not reuse the last customization: " << e.what()
+                              << ", customizing all cells.";
+        return boost::none;
     }
 
-    return metrics;
+    auto &metrics = metric_exclude_classes[metric_name];
+    for (auto &metric : metrics)
+    {
+        if (metric.IsCompressed())
+            metric = storage.DecompressMetric(metric);
+    }
+    const auto metric_size = storage.MakeMetric().weights.size();
+    if (old_connectivity_checksum != connectivity_checksum ||
+        metrics.size() != node_filters.size() ||
+        std::any_of(metrics.begin(), metrics.end(), [&](const auto &metric) {
+            return metric.weights.size() != metric_size || metric.durations.size() != metric_size;
+        }))
+    {
+        util::Log(logWARNING) << "The last customization belongs to another graph, customizing "
+                                 "all cells.";
+        return boost::none;
+    }
+
+    const auto changed_cells = customizer.GetChangedCells(old_graph, graph);
+    old_graph = MultiLevelEdgeBasedGraph{};
+
+    std::size_t number_of_cells = 0, number_of_changed_cells = 0;
+    for (const auto &cells : changed_cells)
+    {
+        number_of_cells += cells.size();
+        number_of_changed_cells += std::count(cells.begin(), cells.end(), true);
+    }
+    util::Log() << "Customizing " << number_of_changed_cells << " of " << number_of_cells
+                << " cells";
+
+    customizer.Customize(graph, storage, node_filters, metrics, changed_cells);
+
+    return std::move(metrics);
 }
 }
 
@@ -125,6 +215,7 @@ int Customizer::Run(const CustomizationConfig &config)
     BOOST_ASSERT(init.is_active());
 
     TIMER_START(loading_data);
+    util::ReportPhase loading_phase("loading_data");
 
     partitioner::MultiLevelPartition mlp;
     partitioner::files::readPartition(config.GetPath(".osrm.partition"), mlp);
@@ -143,29 +234,81 @@ int Customizer::Run(const CustomizationConfig &config)
 
     extractor::ProfileProperties properties;
     extractor::files::readProfileProperties(config.GetPath(".osrm.properties"), properties);
+    loading_phase.Stop();
 
     util::Log() << "Loading partition data took " << TIMER_SEC(loading_data) << " seconds";
 
     TIMER_START(cell_customize);
+    util::ReportPhase customization_phase("customization");
     auto filter = util::excludeFlagsToNodeFilter(graph.GetNumberOfNodes(), node_data, properties);
-    auto metrics = customizeFilteredMetrics(graph, storage, CellCustomizer{mlp}, filter);
+    const CellCustomizer customizer{mlp};
+    boost::optional<std::vector<CellMetric>> changed_metrics;
+    if (config.incremental)
+    {
+        changed_metrics = customizeChangedMetrics(config,
+                                                  properties.GetWeightName(),
+                                                  graph,
+                                                  connectivity_checksum,
+                                                  storage,
+                                                  customizer,
+                                                  filter);
+    }
+    auto metrics = changed_metrics ? std::move(*changed_metrics)
+                                   : customizeFilteredMetrics(graph, storage, customizer, filter);
+    customization_phase.Stop();
     TIMER_STOP(cell_customize);
     util::Log() << "Cells customization took " << TIMER_SEC(cell_customize) << " seconds";
 
+    if (config.number_of_evaluation_queries > 0)
+    {
+        util::ReportPhase evaluation_phase("query_evaluation");
+        // the first metric has no excluded classes
+        QueryEvaluator<MultiLevelEdgeBasedGraph> evaluator{
+            graph, mlp, storage, metrics[0], filter[0]};
+        const auto summary = evaluator.Evaluate(config.number_of_evaluation_queries, 0);
+        util::Log() << "Query evaluation: " << summary.number_of_queries << " queries, "
+                    << summary.number_of_routes << " routes found, mean "
+                    << summary.mean_milliseconds << " ms, median " << summary.median_milliseconds
+                    << " ms, 99th percentile " << summary.p99_milliseconds << " ms, "
+                    << summary.mean_settled_nodes << " settled nodes on average";
+    }
+
+    if (config.compress_cell_metrics)
+    {
+        util::ReportPhase compression_phase("compression");
+        std::size_t full_bytes = 0, compressed_bytes = 0;
+        for (auto &metric : metrics)
+        {
+            full_bytes += metric.weights.size() * (sizeof(EdgeWeight) + sizeof(EdgeDuration));
+            metric = storage.CompressMetric(metric);
+            compressed_bytes += metric.weights.size() * sizeof(EdgeWeight) +
+                                metric.durations.size() * sizeof(EdgeDuration) +
+                                (metric.narrow_weights.size() + metric.narrow_durations.size()) *
+                                    sizeof(std::uint16_t) +
+                                metric.compressed_cells.size() * sizeof(CompressedCellValues);
+        }
+        util::Log() << "Compressed cell metrics from " << (full_bytes >> 20) << " MiB to "
+                    << (compressed_bytes >> 20) << " MiB";
+    }
+
+    util::ReportPhase writing_phase("writing");
     TIMER_START(writing_mld_data);
     std::unordered_map<std::string, std::vector<CellMetric>> metric_exclude_classes = {
         {properties.GetWeightName(), std::move(metrics)},
     };
-    files::writeCellMetrics(config.GetPath(".osrm.cell_metrics"), metric_exclude_classes);
+    files::writeCellMetrics(
+        config.GetOutputPath(".osrm.cell_metrics"), metric_exclude_classes, config.time_slot);
     TIMER_STOP(writing_mld_data);
     util::Log() << "MLD customization writing took " << TIMER_SEC(writing_mld_data) << " seconds";
 
     TIMER_START(writing_graph);
-    partitioner::files::writeGraph(config.GetPath(".osrm.mldgr"), graph, connectivity_checksum);
+    partitioner::files::writeGraph(
+        config.GetOutputPath(".osrm.mldgr"), graph, connectivity_checksum);
     TIMER_STOP(writing_graph);
+    writing_phase.Stop();
     util::Log() << "Graph writing took " << TIMER_SEC(writing_graph) << " seconds";
 
-    for (const auto &metric : metrics)
+    for (const auto &metric : metric_exclude_classes[properties.GetWeightName()])
     {
         CellStorageStatistics(graph, mlp, storage, metric);
     }
@@ -0,0 +1,63 @@
+#include "engine/api/binary_factory.hpp"
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+namespace binary
+{
+
+void writeHeader(Writer &writer, const ResponseType type)
+{
+    const std::string magic = "OSRM";
+    for (const auto character : magic)
+    {
+        writer.WriteUInt8(static_cast<std::uint8_t>(character));
+    }
+    writer.WriteUInt8(FORMAT_VERSION);
+    writer.WriteUInt8(static_cast<std::uint8_t>(type));
+}
+
+void writeWaypoint(Writer &writer,
+                   const util::Coordinate location,
+                   const std::string &name,
+                   const std::string &hint)
+{
+    writer.WriteCoordinate(location);
+    writer.WriteString(name);
+    writer.WriteString(hint);
+}
+
+void writeRoute(Writer &writer,
+                const guidance::Route &route,
+                const std::vector<guidance::RouteLeg> &legs,
+                const std::vector<util::Coordinate> &overview,
+                const char *weight_name)
+{
+    writer.WriteDouble(route.distance);
+    writer.WriteDouble(route.duration);
+    writer.WriteDouble(route.weight);
+    writer.WriteString(weight_name);
+
+    writer.WriteUInt32(static_cast<std::uint32_t>(overview.size()));
+    for (const auto coordinate : overview)
+    {
+        writer.WriteCoordinate(coordinate);
+    }
+
+    writer.WriteUInt32(static_cast<std::uint32_t>(legs.size()));
+    for (const auto &leg : legs)
+    {
+        writer.WriteDouble(leg.distance);
+        writer.WriteDouble(leg.duration);
+        writer.WriteDouble(leg.weight);
+        writer.WriteString(leg.summary);
+    }
+}
+
+} // namespace binary
+} // namespace api
+} // namespace engine
+} // namespace osrm
@@ -0,0 +1,282 @@
+#include "engine/base64.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OSRM_BASE64_SSSE3
+#include <immintrin.h>
+#endif
+
+namespace osrm
+{
+namespace engine
+{
+
+namespace
+{
+const char STANDARD_CHARACTERS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char URL_CHARACTERS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// The values of the characters of an alphabet, -1 for the other characters
+struct Base64Values
+{
+    constexpr Base64Values(const char character_62, const char character_63) : values()
+    {
+        for (int character = 0; character < 256; ++character)
+            values[character] = -1;
+        for (int value = 0; value < 26; ++value)
+        {
+            values['A' + value] = value;
+            values['a' + value] = value + 26;
+        }
+        for (int value = 0; value < 10; ++value)
+            values['0' + value] = value + 52;
+        values[static_cast<unsigned char>(character_62)] = 62;
+        values[static_cast<unsigned char>(character_63)] = 63;
+    }
+
+    int values[256];
+};
+constexpr Base64Values STANDARD_VALUES{'+', '/'};
+constexpr Base64Values URL_VALUES{'-', '_'};
+
+// The kernels encode and decode a prefix of whole groups of three bytes and four characters and
+// return the size of the prefix, the scalar code does the rest.
+using EncodeKernel = std::size_t (*)(const unsigned char *, std::size_t, const char *, char *);
+using DecodeKernel = std::size_t (*)(const char *, std::size_t, const char *, unsigned char *);
+
+std::size_t encodeScalar(const unsigned char *first,
+                         const std::size_t size,
+                         const char *characters,
+                         char *out)
+{
+    std::size_t index = 0;
+    for (; index + 3 <= size; index += 3)
+    {
+        const std::uint32_t bits = first[index] << 16 | first[index + 1] << 8 | first[index + 2];
+        *out++ = characters[bits >> 18];
+        *out++ = characters[bits >> 12 & 0x3f];
+        *out++ = characters[bits >> 6 & 0x3f];
+        *out++ = characters[bits & 0x3f];
+    }
+    return index;
+}
+
+std::size_t decodeScalar(const char *first,
+                         const std::size_t size,
+                         const char *characters,
+                         unsigned char *out)
+{
+    const auto &values = characters[62] == URL_CHARACTERS[62] ? URL_VALUES : STANDARD_VALUES;
+
+    std::size_t index = 0;
+    for (; index + 4 <= size; index += 4)
+    {
+        std::uint32_t bits = 0;
+        for (std::size_t offset = 0; offset < 4; ++offset)
+        {
+            const auto value = values.values[static_cast<unsigned char>(first[index + offset])];
+            if (value < 0)
+                return index;
+            bits = bits << 6 | static_cast<std::uint32_t>(value);
+        }
+        *out++ = static_cast<unsigned char>(bits >> 16);
+        *out++ = static_cast<unsigned char>(bits >> 8);
+        *out++ = static_cast<unsigned char>(bits);
+    }
+    return index;
+}
+
+#ifdef OSRM_BASE64_SSSE3
+// Encodes twelve bytes into sixteen characters at once as described by Wojciech Mula in
+// "Base64 encoding with SIMD instructions": a shuffle duplicates the bytes that hold bits of two
+// characters, the multiplications move the bits of each character into its own byte. Sixteen
+// bytes are loaded per block, so the kernel leaves at least the last four bytes to the caller.
+__attribute__((target("ssse3"))) std::size_t encodeSSSE3(const unsigned char *first,
+                                                         const std::size_t size,
+                                                         const char *characters,
+                                                         char *out)
+{
+    const auto shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    // 'A' + value for the upper case letters, 'a' - 26 + value for the lower case letters and
+    // '0' - 52 + value for the digits, the last two characters differ between the alphabets
+    const auto upper_case_offsets = _mm_set1_epi8('A');
+    const auto lower_case_offsets = _mm_set1_epi8('a' - 26 - 'A');
+    const auto digit_offsets = _mm_set1_epi8('0' - 52 - ('a' - 26));
+    const auto offsets_62 = _mm_set1_epi8(static_cast<char>(characters[62] - ('0' - 52 + 62)));
+    const auto offsets_63 = _mm_set1_epi8(static_cast<char>(characters[63] - ('0' - 52 + 63)));
+
+    std::size_t index = 0;
+    for (; index + 16 <= size; index += 12)
+    {
+        const auto bytes = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + index)), shuffle);
+        const auto high_bits = _mm_mulhi_epu16(_mm_and_si128(bytes, _mm_set1_epi32(0x0fc0fc00)),
+                                               _mm_set1_epi32(0x04000040));
+        const auto low_bits = _mm_mullo_epi16(_mm_and_si128(bytes, _mm_set1_epi32(0x003f03f0)),
+                                              _mm_set1_epi32(0x01000010));
+        const auto values = _mm_or_si128(high_bits, low_bits);
+
+        auto encoded = _mm_add_epi8(values, upper_case_offsets);
+        encoded = _mm_add_epi8(
+            encoded,
+            _mm_and_si128(_mm_cmpgt_epi8(values, _mm_set1_epi8(25)), lower_case_offsets));
+        encoded = _mm_add_epi8(
+            encoded, _mm_and_si128(_mm_cmpgt_epi8(values, _mm_set1_epi8(51)), digit_offsets));
+        encoded = _mm_add_epi8(
+            encoded, _mm_and_si128(_mm_cmpeq_epi8(values, _mm_set1_epi8(62)), offsets_62));
+        encoded = _mm_add_epi8(
+            encoded, _mm_and_si128(_mm_cmpeq_epi8(values, _mm_set1_epi8(63)), offsets_63));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), encoded);
+        out += 16;
+    }
+    return index;
+}
+
+// inclusive range of characters, the characters are compared as signed bytes so that the
+// non-ASCII ones are below all ranges
+__attribute__((target("ssse3"))) inline __m128i
+inRange(const __m128i characters, const char lowest, const char highest)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(characters, _mm_set1_epi8(lowest - 1)),
+                         _mm_cmpgt_epi8(_mm_set1_epi8(highest + 1), characters));
+}
+
+// Decodes sixteen characters into twelve bytes at once, the reverse of encodeSSSE3. Stops at the
+// first block with a character that is not in the alphabet, e.g. the padding.
+__attribute__((target("ssse3"))) std::size_t decodeSSSE3(const char *first,
+                                                         const std::size_t size,
+                                                         const char *characters,
+                                                         unsigned char *out)
+{
+    const auto shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    std::size_t index = 0;
+    for (; index + 16 <= size; index += 16)
+    {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + index));
+
+        const auto upper_case = inRange(block, 'A', 'Z');
+        const auto lower_case = inRange(block, 'a', 'z');
+        const auto digits = inRange(block, '0', '9');
+        const auto is_62 = _mm_cmpeq_epi8(block, _mm_set1_epi8(characters[62]));
+        const auto is_63 = _mm_cmpeq_epi8(block, _mm_set1_epi8(characters[63]));
+
+        const auto valid = _mm_or_si128(_mm_or_si128(upper_case, lower_case),
+                                        _mm_or_si128(digits, _mm_or_si128(is_62, is_63)));
+        if (_mm_movemask_epi8(valid) != 0xffff)
+            break;
+
+        auto offsets = _mm_and_si128(upper_case, _mm_set1_epi8(-'A'));
+        offsets = _mm_or_si128(offsets, _mm_and_si128(lower_case, _mm_set1_epi8(26 - 'a')));
+        offsets = _mm_or_si128(offsets, _mm_and_si128(digits, _mm_set1_epi8(52 - '0')));
+        offsets = _mm_or_si128(
+            offsets,
+            _mm_and_si128(is_62, _mm_set1_epi8(static_cast<char>(62 - characters[62]))));
+        offsets = _mm_or_si128(
+            offsets,
+            _mm_and_si128(is_63, _mm_set1_epi8(static_cast<char>(63 - characters[63]))));
+        const auto values = _mm_add_epi8(block, offsets);
+
+        // merge pairs of six bits into twelve, then pairs of those into the 24 bits of a group
+        const auto pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const auto groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+
+        alignas(16) unsigned char decoded[16];
+        _mm_store_si128(reinterpret_cast<__m128i *>(decoded), _mm_shuffle_epi8(groups, shuffle));
+        std::memcpy(out, decoded, 12);
+        out += 12;
+    }
+    return index;
+}
+#endif
+
+EncodeKernel selectEncodeKernel()
+{
+#ifdef OSRM_BASE64_SSSE3
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3"))
+        return encodeSSSE3;
+#endif
+    return encodeScalar;
+}
+
+DecodeKernel selectDecodeKernel()
+{
+#ifdef OSRM_BASE64_SSSE3
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3"))
+        return decodeSSSE3;
+#endif
+    return decodeScalar;
+}
+
+const char *getCharacters(const Base64Alphabet alphabet)
+{
+    return alphabet == Base64Alphabet::URL ? URL_CHARACTERS : STANDARD_CHARACTERS;
+}
+}
+
+std::string encodeBase64(const unsigned char *first,
+                         std::size_t size,
+                         const Base64Alphabet alphabet)
+{
+    BOOST_ASSERT(size > 0);
+    static const EncodeKernel encode_kernel = selectEncodeKernel();
+
+    const auto characters = getCharacters(alphabet);
+    std::string encoded((size + 2) / 3 * 4, '=');
+
+    auto index = encode_kernel(first, size, characters, &encoded[0]);
+    index += encodeScalar(first + index, size - index, characters, &encoded[index / 3 * 4]);
+
+    // the last one or two bytes are padded with zero bits
+    const auto rest = size - index;
+    if (rest > 0)
+    {
+        const auto out = &encoded[index / 3 * 4];
+        const std::uint32_t bits = first[index] << 16 | (rest > 1 ? first[index + 1] << 8 : 0);
+        out[0] = characters[bits >> 18];
+        out[1] = characters[bits >> 12 & 0x3f];
+        if (rest > 1)
+            out[2] = characters[bits >> 6 & 0x3f];
+    }
+
+    return encoded;
+}
+
+std::ptrdiff_t decodeBase64(const char *first,
+                            std::size_t size,
+                            unsigned char *out,
+                            const Base64Alphabet alphabet)
+{
+    static const DecodeKernel decode_kernel = selectDecodeKernel();
+
+    if (size % 4 != 0)
+        return -1;
+    if (size == 0)
+        return 0;
+
+    // the padding of the last group is decoded as zero bits and dropped from the size
+    const std::size_t padding = first[size - 1] != '=' ? 0 : (first[size - 2] != '=' ? 1 : 2);
+    char last_group[4];
+    std::memcpy(last_group, first + size - 4, 4);
+    std::memset(last_group + 4 - padding, 'A', padding);
+
+    const auto characters = getCharacters(alphabet);
+    auto index = decode_kernel(first, size - 4, characters, out);
+    index += decodeScalar(first + index, size - 4 - index, characters, out + index / 4 * 3);
+    if (index != size - 4 ||
+        decodeScalar(last_group, 4, characters, out + index / 4 * 3) != 4)
+        return -1;
+
+    return static_cast<std::ptrdiff_t>(size / 4 * 3 - padding);
+}
+
+} // ns engine
+} // ns osrm
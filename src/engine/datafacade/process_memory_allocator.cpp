@@ -1,6 +1,8 @@
 #include "engine/datafacade/process_memory_allocator.hpp"
 #include "storage/storage.hpp"
 
+#include "util/numa.hpp"
+
 #include "boost/assert.hpp"
 
 namespace osrm
@@ -10,22 +12,45 @@ namespace engine
 namespace datafacade
 {
 
-ProcessMemoryAllocator::ProcessMemoryAllocator(const storage::StorageConfig &config)
+ProcessMemoryAllocator::ProcessMemoryAllocator(const storage::StorageConfig &config,
+                                               boost::optional<std::size_t> numa_node)
 {
     storage::Storage storage(config);
 
+    if (config.lazy_loading)
+    {
+        mapped_dataset = storage.MapDataset();
+        index = mapped_dataset->GetIndex();
+        return;
+    }
+
     // Calculate the layout/size of the memory block
-    storage.PopulateLayout(internal_layout);
+    storage::DataLayout layout;
+    storage.PopulateStaticLayout(layout);
+    storage.PopulateUpdatableLayout(layout);
 
     // Allocate the memory block, then load data from files into it
-    internal_memory = std::make_unique<char[]>(internal_layout.GetSizeOfLayout());
-    storage.PopulateData(internal_layout, internal_memory.get());
+    internal_memory =
+        std::make_unique<storage::ProcessMemory>(layout.GetSizeOfLayout(), config.huge_pages);
+    // the pages are only placed once they are touched by populating the data
+    if (numa_node)
+    {
+        util::BindMemoryToNumaNode(internal_memory->get(), layout.GetSizeOfLayout(), *numa_node);
+    }
+    else if (config.numa_interleave)
+    {
+        util::InterleaveMemory(internal_memory->get(), layout.GetSizeOfLayout());
+    }
+
+    index = storage::SharedDataIndex({{internal_memory->get(), std::move(layout)}});
+
+    storage.PopulateStaticData(index);
+    storage.PopulateUpdatableData(index);
 }
 
 ProcessMemoryAllocator::~ProcessMemoryAllocator() {}
 
-const storage::DataLayout &ProcessMemoryAllocator::GetLayout() { return internal_layout; }
-char *ProcessMemoryAllocator::GetMemory() { return internal_memory.get(); }
+const storage::SharedDataIndex &ProcessMemoryAllocator::GetIndex() { return index; }
 
 } // namespace datafacade
 } // namespace engine
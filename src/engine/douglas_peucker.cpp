@@ -9,7 +9,7 @@
 #include <algorithm>
 #include <cmath>
 #include <iterator>
-#include <stack>
+#include <limits>
 #include <utility>
 
 namespace osrm
@@ -17,18 +17,59 @@ namespace osrm
 namespace engine
 {
 
-// Normed to the thresholds table
-std::uint64_t fastPerpendicularDistance(const util::FloatCoordinate &projected_start,
-                                        const util::FloatCoordinate &projected_target,
-                                        const util::FloatCoordinate &projected)
+namespace
 {
-    util::FloatCoordinate projected_point_on_segment;
-    std::tie(std::ignore, projected_point_on_segment) =
-        util::coordinate_calculation::projectPointOnSegment(
-            projected_start, projected_target, projected);
-    auto squared_distance = util::coordinate_calculation::squaredEuclideanDistance(
-        projected, projected_point_on_segment);
-    return squared_distance;
+// A segment between two projected locations, with the parts of the projection onto it that do
+// not depend on the projected location computed once for all locations of a range.
+//
+// This computes the same values as projectPointOnSegment and squaredEuclideanDistance of the
+// fixed point coordinates, so that the simplification does not depend on the implementation.
+struct ProjectedSegment
+{
+    ProjectedSegment(const util::FloatCoordinate &source_, const util::FloatCoordinate &target_)
+        : source_lon(static_cast<double>(source_.lon)),
+          source_lat(static_cast<double>(source_.lat)),
+          target_lon(static_cast<double>(target_.lon)),
+          target_lat(static_cast<double>(target_.lat)), slope_lon(target_lon - source_lon),
+          slope_lat(target_lat - source_lat),
+          squared_length(slope_lon * slope_lon + slope_lat * slope_lat),
+          is_degenerated(squared_length < std::numeric_limits<double>::epsilon())
+    {
+    }
+
+    // Normed to the thresholds table
+    std::uint64_t SquaredDistance(const util::FloatCoordinate &projected,
+                                  const util::Coordinate fixed_projected) const
+    {
+        double lon = source_lon;
+        double lat = source_lat;
+        if (!is_degenerated)
+        {
+            const auto rel_lon = static_cast<double>(projected.lon) - source_lon;
+            const auto rel_lat = static_cast<double>(projected.lat) - source_lat;
+            const auto ratio =
+                std::min(1., std::max(0., (slope_lon * rel_lon + slope_lat * rel_lat) /
+                                              squared_length));
+            lon = (1.0 - ratio) * source_lon + target_lon * ratio;
+            lat = (1.0 - ratio) * source_lat + target_lat * ratio;
+        }
+
+        const std::int64_t d_lon = static_cast<std::int32_t>(
+            fixed_projected.lon - util::toFixed(util::FloatLongitude{lon}));
+        const std::int64_t d_lat = static_cast<std::int32_t>(
+            fixed_projected.lat - util::toFixed(util::FloatLatitude{lat}));
+        return static_cast<std::uint64_t>(d_lon * d_lon + d_lat * d_lat);
+    }
+
+    const double source_lon;
+    const double source_lat;
+    const double target_lon;
+    const double target_lat;
+    const double slope_lon;
+    const double slope_lat;
+    const double squared_length;
+    const bool is_degenerated;
+};
 }
 
 std::vector<util::Coordinate> douglasPeucker(std::vector<util::Coordinate>::const_iterator begin,
@@ -44,10 +85,14 @@ std::vector<util::Coordinate> douglasPeucker(std::vector<util::Coordinate>::cons
         return {};
     }
 
+    // the fixed point values of the projected locations are the same for all ranges
     std::vector<util::FloatCoordinate> projected_coordinates(size);
-    std::transform(begin, end, projected_coordinates.begin(), [](const util::Coordinate coord) {
-        return util::web_mercator::fromWGS84(coord);
-    });
+    std::vector<util::Coordinate> fixed_projected_coordinates(size);
+    for (auto idx : util::irange<std::size_t>(0UL, size))
+    {
+        projected_coordinates[idx] = util::web_mercator::fromWGS84(begin[idx]);
+        fixed_projected_coordinates[idx] = util::Coordinate(projected_coordinates[idx]);
+    }
 
     std::vector<bool> is_necessary(size, false);
     BOOST_ASSERT(is_necessary.size() >= 2);
@@ -55,35 +100,38 @@ std::vector<util::Coordinate> douglasPeucker(std::vector<util::Coordinate>::cons
     is_necessary.back() = true;
     using GeometryRange = std::pair<std::size_t, std::size_t>;
 
-    std::stack<GeometryRange> recursion_stack;
+    const auto threshold = detail::DOUGLAS_PEUCKER_THRESHOLDS[zoom_level];
 
-    recursion_stack.emplace(0UL, size - 1);
+    // a vector as the stack of the ranges, it does not allocate blocks like a deque
+    std::vector<GeometryRange> recursion_stack;
+    recursion_stack.emplace_back(0UL, size - 1);
 
     // mark locations as 'necessary' by divide-and-conquer
     while (!recursion_stack.empty())
     {
         // pop next element
-        const GeometryRange pair = recursion_stack.top();
-        recursion_stack.pop();
+        const GeometryRange pair = recursion_stack.back();
+        recursion_stack.pop_back();
         // sanity checks
         BOOST_ASSERT_MSG(is_necessary[pair.first], "left border must be necessary");
         BOOST_ASSERT_MSG(is_necessary[pair.second], "right border must be necessary");
         BOOST_ASSERT_MSG(pair.second < size, "right border outside of geometry");
         BOOST_ASSERT_MSG(pair.first <= pair.second, "left border on the wrong side");
 
-        std::uint64_t max_distance = 0;
+        const ProjectedSegment segment(projected_coordinates[pair.first],
+                                       projected_coordinates[pair.second]);
+
+        // only distances above the zoom level dependent threshold are feasible maxima
+        std::uint64_t max_distance = threshold;
         auto farthest_entry_index = pair.second;
 
         // sweep over range to find the maximum
         for (auto idx = pair.first + 1; idx != pair.second; ++idx)
         {
-            using namespace util::coordinate_calculation;
-            const auto distance = fastPerpendicularDistance(projected_coordinates[pair.first],
-                                                            projected_coordinates[pair.second],
-                                                            projected_coordinates[idx]);
+            const auto distance = segment.SquaredDistance(projected_coordinates[idx],
+                                                          fixed_projected_coordinates[idx]);
             // found new feasible maximum?
-            if (distance > max_distance &&
-                distance > detail::DOUGLAS_PEUCKER_THRESHOLDS[zoom_level])
+            if (distance > max_distance)
             {
                 farthest_entry_index = idx;
                 max_distance = distance;
@@ -91,17 +139,17 @@ std::vector<util::Coordinate> douglasPeucker(std::vector<util::Coordinate>::cons
         }
 
         // check if maximum violates a zoom level dependent threshold
-        if (max_distance > detail::DOUGLAS_PEUCKER_THRESHOLDS[zoom_level])
+        if (farthest_entry_index != pair.second)
         {
             //  mark idx as necessary
             is_necessary[farthest_entry_index] = true;
             if (pair.first < farthest_entry_index)
             {
-                recursion_stack.emplace(pair.first, farthest_entry_index);
+                recursion_stack.emplace_back(pair.first, farthest_entry_index);
             }
             if (farthest_entry_index < pair.second)
             {
-                recursion_stack.emplace(farthest_entry_index, pair.second);
+                recursion_stack.emplace_back(farthest_entry_index, pair.second);
             }
         }
     }
@@ -21,9 +21,23 @@ bool EngineConfig::IsValid() const
                               unlimited_or_more_than(max_locations_trip, 2) &&
                               unlimited_or_more_than(max_locations_viaroute, 2) &&
                               unlimited_or_more_than(max_results_nearest, 0) &&
-                              max_alternatives >= 0;
+                              unlimited_or_more_than(max_pairs_batch, 0) && batch_threads >= 1 &&
+                              unlimited_or_more_than(max_duration_isochrone, 0) &&
+                              max_alternatives >= 0 && max_alternative_time >= -1 &&
+                              alternative_threads >= 1 &&
+                              route_threads >= 1 && table_threads >= 1 && trip_threads >= 1 &&
+                              match_threads >= 1 && table_cache_size >= 0 &&
+                              route_cache_size >= 0 && tile_cache_size >= 0 &&
+                              match_session_cache_size >= 0 && parallel_search_distance >= 0 &&
+                              unpacking_cache_size >= 0 && max_heap_memory >= 0;
 
-    return ((use_shared_memory && all_path_are_empty) || storage_config.IsValid()) && limits_valid;
+    const bool numa_valid = !numa_replicas || (!use_shared_memory && memory_file.empty() &&
+                                               !storage_config.lazy_loading);
+
+    const bool watch_valid = !watch_memory_file || (!use_shared_memory && !memory_file.empty());
+
+    return ((use_shared_memory && all_path_are_empty) || storage_config.IsValid()) &&
+           limits_valid && numa_valid && watch_valid;
 }
 }
 }
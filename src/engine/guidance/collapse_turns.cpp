@@ -30,12 +30,12 @@ double findTotalTurnAngle(const RouteStep &entry_step, const RouteStep &exit_ste
     if (entry_step.geometry_begin > exit_step.geometry_begin)
         return findTotalTurnAngle(exit_step, entry_step);
 
-    const auto exit_intersection = exit_step.intersections.front();
+    const auto &exit_intersection = exit_step.intersections.front();
     const auto exit_step_exit_bearing = exit_intersection.bearings[exit_intersection.out];
     const auto exit_step_entry_bearing =
         util::bearing::reverse(exit_intersection.bearings[exit_intersection.in]);
 
-    const auto entry_intersection = entry_step.intersections.front();
+    const auto &entry_intersection = entry_step.intersections.front();
     const auto entry_step_entry_bearing =
         util::bearing::reverse(entry_intersection.bearings[entry_intersection.in]);
     const auto entry_step_exit_bearing = entry_intersection.bearings[entry_intersection.out];
@@ -109,7 +109,7 @@ inline void handleSliproad(RouteStepIterator sliproad_step)
         {
             // in sliproad checks, we should have made sure not to include invalid modes
             BOOST_ASSERT(haveSameMode(*sliproad_step, *next_step));
-            sliproad_step->ElongateBy(*next_step);
+            sliproad_step->ElongateBy(std::move(*next_step));
             next_step->Invalidate();
             next_step = findNextTurn(next_step);
         }
@@ -539,7 +539,7 @@ RouteSteps collapseTurnInstructions(RouteSteps steps)
         else if (suppressedStraightBetweenTurns(previous_step, current_step, next_step))
         {
             const auto far_back_step = findPreviousTurn(previous_step);
-            previous_step->ElongateBy(*current_step);
+            previous_step->ElongateBy(std::move(*current_step));
             current_step->Invalidate();
             combineRouteSteps(*previous_step,
                               *next_step,
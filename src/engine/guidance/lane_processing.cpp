@@ -195,7 +195,7 @@ std::vector<RouteStep> anticipateLaneChange(std::vector<RouteStep> steps,
                 current_inst.type == TurnType::Suppressed && previous.mode == current.mode &&
                 previous_lanes == current_lanes)
             {
-                previous.ElongateBy(current);
+                previous.ElongateBy(std::move(current));
                 current.Invalidate();
             }
         });
@@ -48,7 +48,7 @@ void compressRange(const RouteStepIterator begin, const RouteStepIterator end)
         // ensure not to invalidate the final arrive
         if (!hasWaypointType(*itr))
         {
-            begin->ElongateBy(*itr);
+            begin->ElongateBy(std::move(*itr));
             itr->Invalidate();
         }
     }
@@ -115,9 +115,9 @@ void processRoundaboutExits(const RouteStepIterator begin, const RouteStepIterat
         else if (begin->maneuver.instruction.type == TurnType::EnterRoundaboutIntersection ||
                  begin->maneuver.instruction.type == TurnType::EnterRoundaboutIntersectionAtExit)
         {
-            const auto entry_intersection = begin->intersections.front();
+            const auto &entry_intersection = begin->intersections.front();
 
-            const auto exit_intersection = last->intersections.front();
+            const auto &exit_intersection = last->intersections.front();
             const auto exit_bearing = exit_intersection.bearings[exit_intersection.out];
 
             BOOST_ASSERT(!begin->intersections.empty());
@@ -534,7 +534,7 @@ std::vector<RouteStep> buildIntersections(std::vector<RouteStep> steps)
             BOOST_ASSERT(steps[last_valid_instruction].mode == step.mode);
             // count intersections. We cannot use exit, since intersections can follow directly
             // after a roundabout
-            steps[last_valid_instruction].ElongateBy(step);
+            steps[last_valid_instruction].ElongateBy(std::move(step));
             steps[step_index].Invalidate();
         }
         else if (!isSilent(instruction))
@@ -585,7 +585,6 @@ void applyOverrides(const datafacade::BaseDataFacade &facade,
     // we don't allow updates to
     for (auto current_step_it = steps.begin(); current_step_it != steps.end(); ++current_step_it)
     {
-        util::Log(logDEBUG) << "Searching for " << current_step_it->from_id << std::endl;
         const auto overrides = facade.GetOverridesThatStartAt(current_step_it->from_id);
         if (overrides.empty())
             continue;
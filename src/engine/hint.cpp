@@ -5,6 +5,7 @@
 #include <boost/assert.hpp>
 
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <ostream>
 #include <tuple>
@@ -19,35 +20,41 @@ bool Hint::IsValid(const util::Coordinate new_input_coordinates,
 {
     auto is_same_input_coordinate = new_input_coordinates.lon == phantom.input_location.lon &&
                                     new_input_coordinates.lat == phantom.input_location.lat;
+    // Clients often send back the snapped location of a waypoint together with its hint
+    auto is_same_snapped_coordinate = new_input_coordinates.lon == phantom.location.lon &&
+                                      new_input_coordinates.lat == phantom.location.lat;
     // FIXME this does not use the number of nodes to validate the phantom because
     // GetNumberOfNodes()
     // depends on the graph which is algorithm dependent
-    return is_same_input_coordinate && phantom.IsValid() && facade.GetCheckSum() == data_checksum;
+    return (is_same_input_coordinate || is_same_snapped_coordinate) && phantom.IsValid() &&
+           facade.GetCheckSum() == data_checksum;
 }
 
-std::string Hint::ToBase64() const
-{
-    auto base64 = encodeBase64Bytewise(*this);
-
-    // Make safe for usage as GET parameter in URLs
-    std::replace(begin(base64), end(base64), '+', '-');
-    std::replace(begin(base64), end(base64), '/', '_');
-
-    return base64;
-}
+// Safe for usage as GET parameter in URLs
+std::string Hint::ToBase64() const { return encodeBase64Bytewise(*this, Base64Alphabet::URL); }
 
 Hint Hint::FromBase64(const std::string &base64Hint)
 {
     BOOST_ASSERT_MSG(base64Hint.size() == ENCODED_HINT_SIZE, "Hint has invalid size");
 
-    // We need mutability but don't want to change the API
-    auto encoded = base64Hint;
+    return decodeBase64Bytewise<Hint>(base64Hint, Base64Alphabet::URL);
+}
+
+boost::optional<Hint> Hint::FromBase64(const char *first, const char *last)
+{
+    // a hint encodes into groups of four characters with a single padding character
+    if (static_cast<std::size_t>(last - first) != ENCODED_HINT_SIZE ||
+        std::count(first, last, '=') != 1)
+        return boost::none;
 
-    // Reverses above encoding we need for GET parameters in URL
-    std::replace(begin(encoded), end(encoded), '-', '+');
-    std::replace(begin(encoded), end(encoded), '_', '/');
+    unsigned char decoded[ENCODED_HINT_SIZE / 4 * 3];
+    if (decodeBase64(first, ENCODED_HINT_SIZE, decoded, Base64Alphabet::URL) !=
+        static_cast<std::ptrdiff_t>(sizeof(Hint)))
+        return boost::none;
 
-    return decodeBase64Bytewise<Hint>(encoded);
+    Hint hint;
+    std::memcpy(&hint, decoded, sizeof(Hint));
+    return hint;
 }
 
 bool operator==(const Hint &lhs, const Hint &rhs)
@@ -0,0 +1,111 @@
+#include "engine/plugins/batch.hpp"
+
+#include "engine/api/batch_api.hpp"
+#include "engine/api/batch_parameters.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "util/json_container.hpp"
+
+#include <boost/assert.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace plugins
+{
+
+BatchPlugin::BatchPlugin(const int max_pairs_batch_, const int batch_threads)
+    : max_pairs_batch(max_pairs_batch_),
+      batch_arena(batch_threads > 1 ? std::make_unique<tbb::task_arena>(batch_threads) : nullptr)
+{
+}
+
+Status BatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                  const api::BatchParameters &parameters,
+                                  util::json::Object &json_result) const
+{
+    if (!algorithms.HasDirectShortestPathSearch() && !algorithms.HasShortestPathSearch())
+    {
+        return Error("NotImplemented",
+                     "Shortest path search is not implemented for the chosen search algorithm.",
+                     json_result);
+    }
+
+    BOOST_ASSERT(parameters.IsValid());
+    const auto pairs = parameters.GetPairs();
+
+    // enforce maximum number of routes for performance reasons
+    if (max_pairs_batch > 0 && static_cast<int>(pairs.size()) > max_pairs_batch)
+    {
+        return Error("TooBig",
+                     "Number of pairs " + std::to_string(pairs.size()) +
+                         " is higher than current maximum (" + std::to_string(max_pairs_batch) +
+                         ")",
+                     json_result);
+    }
+
+    if (!CheckAllCoordinates(parameters.coordinates))
+    {
+        return Error("InvalidValue", "Invalid coordinate value.", json_result);
+    }
+
+    if (!CheckAlgorithms(parameters, algorithms, json_result))
+        return Status::Error;
+
+    // every coordinate is looked up once, also if it is part of several pairs
+    const auto &facade = algorithms.GetFacade();
+    const auto phantom_node_pairs = GetPhantomNodes(facade, parameters);
+    if (phantom_node_pairs.size() != parameters.coordinates.size())
+    {
+        return Error("NoSegment",
+                     std::string("Could not find a matching segment for coordinate ") +
+                         std::to_string(phantom_node_pairs.size()),
+                     json_result);
+    }
+
+    const api::BatchAPI batch_api{facade, parameters};
+    api::BatchAPI::Routes routes(pairs.size());
+
+    // the routes are independent, every thread searches with its own heaps and assembles the
+    // summaries of its routes
+    const auto route_pairs = [&](const std::size_t begin, const std::size_t end) {
+        for (auto index = begin; index < end; ++index)
+        {
+            // the pairs are snapped like independent route queries, e.g. a pair within a small
+            // component is not moved to the big component because of other pairs
+            const auto snapped_phantoms = SnapPhantomNodes(
+                {phantom_node_pairs[pairs[index].first], phantom_node_pairs[pairs[index].second]});
+            const PhantomNodes phantom_nodes{snapped_phantoms.front(), snapped_phantoms.back()};
+            const auto route = algorithms.HasDirectShortestPathSearch()
+                                   ? algorithms.DirectShortestPathSearch(phantom_nodes)
+                                   : algorithms.ShortestPathSearch(
+                                         {phantom_nodes}, parameters.continue_straight, false);
+            batch_api.MakeRoute(route, index, routes);
+        }
+    };
+
+    if (batch_arena && pairs.size() > 1)
+    {
+        // the arena is shared by all request threads and bounds the batch concurrency
+        batch_arena->execute([&] {
+            routing_algorithms::parallelForEach(pairs.size(), [&](const auto &range) {
+                route_pairs(range.begin(), range.end());
+            });
+        });
+    }
+    else
+    {
+        route_pairs(0, pairs.size());
+    }
+
+    batch_api.MakeResponse(std::move(routes), json_result);
+
+    return Status::Ok;
+}
+}
+}
+}
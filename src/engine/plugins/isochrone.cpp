@@ -0,0 +1,84 @@
+#include "engine/plugins/isochrone.hpp"
+
+#include "engine/api/isochrone_api.hpp"
+#include "engine/api/isochrone_parameters.hpp"
+#include "util/json_container.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace plugins
+{
+
+IsochronePlugin::IsochronePlugin(
+    const double max_duration_isochrone_,
+    std::shared_ptr<routing_algorithms::PhastGraphCache> phast_graphs_)
+    : max_duration_isochrone(max_duration_isochrone_), phast_graphs(std::move(phast_graphs_))
+{
+}
+
+Status IsochronePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                      const api::IsochroneParameters &parameters,
+                                      util::json::Object &json_result) const
+{
+    if (!algorithms.HasOneToAllSearch())
+    {
+        return Error("NotImplemented",
+                     "One-to-all search is not implemented for the chosen search algorithm.",
+                     json_result);
+    }
+
+    BOOST_ASSERT(parameters.IsValid());
+
+    if (!CheckAllCoordinates(parameters.coordinates))
+    {
+        return Error("InvalidValue", "Invalid coordinate value.", json_result);
+    }
+
+    // enforce maximum duration for performance reasons
+    if (max_duration_isochrone > 0 && parameters.max_duration > max_duration_isochrone)
+    {
+        return Error("TooBig",
+                     "Duration " + std::to_string(parameters.max_duration) +
+                         " is higher than current maximum (" +
+                         std::to_string(max_duration_isochrone) + ")",
+                     json_result);
+    }
+
+    if (!CheckAlgorithms(parameters, algorithms, json_result))
+        return Status::Error;
+
+    const auto &facade = algorithms.GetFacade();
+    const auto phantom_node_pairs = GetPhantomNodes(facade, parameters);
+    if (phantom_node_pairs.size() != parameters.coordinates.size())
+    {
+        return Error("NoSegment",
+                     std::string("Could not find a matching segment for coordinate ") +
+                         std::to_string(phantom_node_pairs.size()),
+                     json_result);
+    }
+    BOOST_ASSERT(phantom_node_pairs.size() == 1);
+    const auto source_phantom = SnapPhantomNodes(phantom_node_pairs).front();
+
+    // durations of the graph are in deciseconds
+    const auto max_duration = static_cast<EdgeDuration>(std::floor(parameters.max_duration * 10));
+    const auto reached_nodes =
+        algorithms.OneToAllSearch(source_phantom, max_duration, *phast_graphs);
+
+    const api::IsochroneAPI isochrone_api{facade, parameters};
+    isochrone_api.MakeResponse(source_phantom, reached_nodes, json_result);
+
+    return Status::Ok;
+}
+}
+}
+}
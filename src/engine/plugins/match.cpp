@@ -6,6 +6,7 @@
 #include "engine/api/match_parameters_tidy.hpp"
 #include "engine/map_matching/bayes_classifier.hpp"
 #include "engine/map_matching/sub_matching.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
 #include "util/coordinate_calculation.hpp"
 #include "util/integer_range.hpp"
 #include "util/json_util.hpp"
@@ -110,21 +111,92 @@ void filterCandidates(const std::vector<util::Coordinate> &coordinates,
     }
 }
 
+// Takes the candidates of the coordinates that the session already knows, only the new ones are
+// snapped. Coordinates with a hint are left to the hint since they need no search.
+MatchPlugin::CandidateLists
+MatchPlugin::GetSessionCandidates(const datafacade::BaseDataFacade &facade,
+                                  const api::BaseParameters &parameters,
+                                  const std::vector<double> &radiuses,
+                                  map_matching::MatchingSession &session) const
+{
+    const bool use_hints = !parameters.hints.empty();
+    const bool use_bearings = !parameters.bearings.empty();
+    const bool use_approaches = !parameters.approaches.empty();
+
+    const auto make_key = [&](const std::size_t index) {
+        return map_matching::CandidatesKey{
+            parameters.coordinates[index],
+            radiuses[index],
+            use_bearings ? parameters.bearings[index] : boost::optional<Bearing>{},
+            use_approaches && parameters.approaches[index] ? *parameters.approaches[index]
+                                                           : Approach::UNRESTRICTED};
+    };
+    const auto has_hint = [&](const std::size_t index) {
+        return use_hints && parameters.hints[index];
+    };
+
+    CandidateLists candidates_lists(parameters.coordinates.size());
+    api::BaseParameters new_parameters;
+    std::vector<double> new_radiuses;
+    std::vector<std::size_t> new_indices;
+    for (const auto index : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
+    {
+        if (!has_hint(index))
+        {
+            if (const auto candidates = session.FindCandidates(make_key(index)))
+            {
+                candidates_lists[index] = *candidates;
+                continue;
+            }
+        }
+
+        new_indices.push_back(index);
+        new_radiuses.push_back(radiuses[index]);
+        new_parameters.coordinates.push_back(parameters.coordinates[index]);
+        if (use_hints)
+            new_parameters.hints.push_back(parameters.hints[index]);
+        if (use_bearings)
+            new_parameters.bearings.push_back(parameters.bearings[index]);
+        if (use_approaches)
+            new_parameters.approaches.push_back(parameters.approaches[index]);
+    }
+
+    if (new_indices.empty())
+    {
+        return candidates_lists;
+    }
+
+    auto new_candidates_lists = GetPhantomNodesInRange(facade, new_parameters, new_radiuses);
+    for (const auto position : util::irange<std::size_t>(0UL, new_indices.size()))
+    {
+        const auto index = new_indices[position];
+        if (!has_hint(index))
+        {
+            session.AddCandidates(make_key(index), new_candidates_lists[position]);
+        }
+        candidates_lists[index] = std::move(new_candidates_lists[position]);
+    }
+
+    return candidates_lists;
+}
+
 Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                   const api::MatchParameters &parameters,
-                                  util::json::Object &json_result) const
+                                  api::ResultT &result) const
 {
     if (!algorithms.HasMapMatching())
     {
         return Error("NotImplemented",
                      "Map matching is not implemented for the chosen search algorithm.",
-                     json_result);
+                     result);
     }
 
-    if (!CheckAlgorithms(parameters, algorithms, json_result))
+    if (!CheckAlgorithms(parameters, algorithms, result))
         return Status::Error;
 
     const auto &facade = algorithms.GetFacade();
+    if (!CheckAnnotations(parameters, facade, result))
+        return Status::Error;
 
     BOOST_ASSERT(parameters.IsValid());
 
@@ -132,12 +204,12 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     if (max_locations_map_matching > 0 &&
         static_cast<int>(parameters.coordinates.size()) > max_locations_map_matching)
     {
-        return Error("TooBig", "Too many trace coordinates", json_result);
+        return Error("TooBig", "Too many trace coordinates", result);
     }
 
     if (!CheckAllCoordinates(parameters.coordinates))
     {
-        return Error("InvalidValue", "Invalid coordinate value.", json_result);
+        return Error("InvalidValue", "Invalid coordinate value.", result);
     }
 
     if (max_radius_map_matching > 0 && std::any_of(parameters.radiuses.begin(),
@@ -148,7 +220,7 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                                        return *radius > max_radius_map_matching;
                                                    }))
     {
-        return Error("TooBig", "Radius search size is too large for map matching.", json_result);
+        return Error("TooBig", "Radius search size is too large for map matching.", result);
     }
 
     // Check for same or increasing timestamps. Impl. note: Incontrast to `sort(first,
@@ -159,7 +231,7 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     if (!time_increases_monotonically)
     {
         return Error(
-            "InvalidValue", "Timestamps need to be monotonically increasing.", json_result);
+            "InvalidValue", "Timestamps need to be monotonically increasing.", result);
     }
 
     SubMatchingList sub_matchings;
@@ -182,7 +254,7 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     {
         return Error("InvalidValue",
                      "First and last coordinates must be specified as waypoints.",
-                     json_result);
+                     result);
     }
 
     // assuming radius is the standard deviation of a normal distribution
@@ -213,7 +285,19 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                        });
     }
 
-    auto candidates_lists = GetPhantomNodesInRange(facade, tidied.parameters, search_radiuses);
+    // the session of the previous request of the trace stays untouched, concurrent requests of
+    // the same session only overwrite each other's results
+    std::shared_ptr<map_matching::MatchingSession> session;
+    map_matching::MatchingSessionKey session_key{facade.GetFacadeID(), parameters.session};
+    if (session_cache && !parameters.session.empty())
+    {
+        session = std::make_shared<map_matching::MatchingSession>(
+            session_cache->Get(facade.GetDatasetID(), session_key));
+    }
+
+    auto candidates_lists =
+        session ? GetSessionCandidates(facade, tidied.parameters, search_radiuses, *session)
+                : GetPhantomNodesInRange(facade, tidied.parameters, search_radiuses);
 
     filterCandidates(tidied.parameters.coordinates, candidates_lists);
     if (std::all_of(candidates_lists.begin(),
@@ -224,7 +308,7 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     {
         return Error("NoSegment",
                      std::string("Could not find a matching segment for any coordinate."),
-                     json_result);
+                     result);
     }
 
     // call the actual map matching
@@ -233,17 +317,24 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                tidied.parameters.coordinates,
                                tidied.parameters.timestamps,
                                tidied.parameters.radiuses,
-                               parameters.gaps == api::MatchParameters::GapsType::Split);
+                               parameters.gaps == api::MatchParameters::GapsType::Split,
+                               session.get());
+
+    if (session)
+    {
+        session->ReleasePrevious();
+        session_cache->Put(facade.GetDatasetID(), session_key, std::move(session));
+    }
 
     if (sub_matchings.size() == 0)
     {
-        return Error("NoMatch", "Could not match the trace.", json_result);
+        return Error("NoMatch", "Could not match the trace.", result);
     }
 
     // trace was split, we don't support the waypoints parameter across multiple match objects
     if (sub_matchings.size() > 1 && !parameters.waypoints.empty())
     {
-        return Error("NoMatch", "Could not match the trace with the given waypoints.", json_result);
+        return Error("NoMatch", "Could not match the trace with the given waypoints.", result);
     }
 
     // Error: Check if user-supplied waypoints can be found in the resulting matches
@@ -260,7 +351,7 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
         if (!tidied_waypoints.empty())
         {
             return Error(
-                "NoMatch", "Requested waypoint parameter could not be matched.", json_result);
+                "NoMatch", "Requested waypoint parameter could not be matched.", result);
         }
     }
     // we haven't errored yet, only allow leg collapsing if it was originally requested
@@ -269,8 +360,7 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
 
     // each sub_route will correspond to a MatchObject
     std::vector<InternalRouteResult> sub_routes(sub_matchings.size());
-    for (auto index : util::irange<std::size_t>(0UL, sub_matchings.size()))
-    {
+    const auto compute_sub_route = [&](const std::size_t index) {
         BOOST_ASSERT(sub_matchings[index].nodes.size() > 1);
 
         // FIXME we only run this to obtain the geometry
@@ -287,8 +377,8 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
         // force uturns to be on
         // we split the phantom nodes anyway and only have bi-directional phantom nodes for
         // possible uturns
-        sub_routes[index] =
-            algorithms.ShortestPathSearch(sub_routes[index].segment_end_coordinates, {false});
+        sub_routes[index] = algorithms.ShortestPathSearch(
+            sub_routes[index].segment_end_coordinates, {false}, false);
         BOOST_ASSERT(sub_routes[index].shortest_path_weight != INVALID_EDGE_WEIGHT);
         if (collapse_legs)
         {
@@ -309,10 +399,31 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
             }
             sub_routes[index] = CollapseInternalRouteResult(sub_routes[index], waypoint_legs);
         }
+    };
+
+    if (match_arena && sub_matchings.size() > 1)
+    {
+        // the sub matchings are independent, the arena is shared by all request threads and
+        // bounds the match concurrency
+        match_arena->execute([&] {
+            routing_algorithms::parallelForEach(sub_matchings.size(), [&](const auto &range) {
+                for (auto index = range.begin(); index != range.end(); ++index)
+                {
+                    compute_sub_route(index);
+                }
+            });
+        });
+    }
+    else
+    {
+        for (const auto index : util::irange<std::size_t>(0UL, sub_matchings.size()))
+        {
+            compute_sub_route(index);
+        }
     }
 
     api::MatchAPI match_api{facade, parameters, tidied};
-    match_api.MakeResponse(sub_matchings, sub_routes, json_result);
+    match_api.MakeResponse(sub_matchings, sub_routes, result);
 
     return Status::Ok;
 }
@@ -42,18 +42,37 @@ Status NearestPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms
     if (!CheckAllCoordinates(params.coordinates))
         return Error("InvalidOptions", "Coordinates are invalid", json_result);
 
-    if (params.coordinates.size() != 1)
+    // Several coordinates are snapped in one request to return a hint for each of them
+    if (params.coordinates.size() != 1 && params.number_of_results != 1)
     {
-        return Error("InvalidOptions", "Only one input coordinate is supported", json_result);
+        return Error("InvalidOptions",
+                     "Only one input coordinate is supported for more than one result",
+                     json_result);
+    }
+
+    if (max_results > 0 &&
+        (boost::numeric_cast<std::int64_t>(params.coordinates.size()) > max_results))
+    {
+        return Error("TooBig",
+                     "Number of coordinates " + std::to_string(params.coordinates.size()) +
+                         " is higher than current maximum (" + std::to_string(max_results) + ")",
+                     json_result);
     }
 
     auto phantom_nodes = GetPhantomNodes(facade, params, params.number_of_results);
 
-    if (phantom_nodes.front().size() == 0)
+    for (const auto index : util::irange<std::size_t>(0UL, phantom_nodes.size()))
     {
-        return Error("NoSegment", "Could not find a matching segments for coordinate", json_result);
+        if (phantom_nodes[index].empty())
+        {
+            return Error("NoSegment",
+                         params.coordinates.size() == 1
+                             ? std::string("Could not find a matching segments for coordinate")
+                             : "Could not find a matching segment for coordinate " +
+                                   std::to_string(index),
+                         json_result);
+        }
     }
-    BOOST_ASSERT(phantom_nodes.front().size() > 0);
 
     api::NearestAPI nearest_api(facade, params);
     nearest_api.MakeResponse(phantom_nodes, json_result);
@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/assert.hpp>
@@ -23,14 +24,31 @@ namespace engine
 namespace plugins
 {
 
-TablePlugin::TablePlugin(const int max_locations_distance_table)
-    : max_locations_distance_table(max_locations_distance_table)
+namespace
+{
+// Tables with at least that many entries are computed with restricted PHAST sweeps if the
+// algorithm supports them. Below, the buckets of the targets are smaller than the restricted
+// graph and the bucket scans are faster than the sweeps.
+const constexpr std::size_t RESTRICTED_SWEEP_TABLE_SIZE = 1000 * 1000;
+}
+
+TablePlugin::TablePlugin(const int max_locations_distance_table,
+                         const int table_threads,
+                         const int table_cache_size,
+                         std::shared_ptr<routing_algorithms::PhastGraphCache> phast_graphs)
+    : max_locations_distance_table(max_locations_distance_table),
+      table_arena(table_threads > 1 ? std::make_unique<tbb::task_arena>(table_threads) : nullptr),
+      search_space_cache(
+          table_cache_size > 0
+              ? std::make_unique<routing_algorithms::SearchSpaceCache>(table_cache_size)
+              : nullptr),
+      phast_graphs(std::move(phast_graphs))
 {
 }
 
 Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                   const api::TableParameters &params,
-                                  util::json::Object &result) const
+                                  api::ResultT &result) const
 {
     if (!algorithms.HasManyToManySearch())
     {
@@ -81,16 +99,60 @@ Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     }
 
     auto snapped_phantoms = SnapPhantomNodes(phantom_nodes);
-    auto result_table =
-        algorithms.ManyToManySearch(snapped_phantoms, params.sources, params.destinations);
+    std::vector<EdgeDuration> durations_table;
+    // a sweep computes the rows of several sources at once
+    const bool use_restricted_sweeps =
+        phast_graphs && algorithms.HasRestrictedManyToManySearch() &&
+        num_sources >= routing_algorithms::ch::PHAST_LANES &&
+        num_sources * num_destinations >= RESTRICTED_SWEEP_TABLE_SIZE;
+    // the other algorithms compute the exact durations instead
+    const bool use_approximation = params.approximate && algorithms.HasApproximateManyToManySearch();
+    std::vector<double> distances_table;
+    const auto compute_tables = [&](const bool parallel) {
+        if (params.annotations & api::TableParameters::AnnotationsType::Duration &&
+            use_approximation)
+        {
+            durations_table = algorithms.ApproximateManyToManySearch(
+                snapped_phantoms, params.sources, params.destinations, parallel);
+        }
+        else if (params.annotations & api::TableParameters::AnnotationsType::Duration &&
+                 use_restricted_sweeps)
+        {
+            durations_table = algorithms.RestrictedManyToManySearch(
+                snapped_phantoms, params.sources, params.destinations, parallel, *phast_graphs);
+        }
+        else if (params.annotations & api::TableParameters::AnnotationsType::Duration)
+        {
+            durations_table = algorithms.ManyToManySearch(snapped_phantoms,
+                                                          params.sources,
+                                                          params.destinations,
+                                                          parallel,
+                                                          search_space_cache.get());
+        }
+        if (params.annotations & api::TableParameters::AnnotationsType::Distance)
+        {
+            distances_table = algorithms.ManyToManyDistances(
+                snapped_phantoms, params.sources, params.destinations, parallel);
+        }
+    };
+
+    if (table_arena)
+    {
+        // the arena is shared by all request threads and bounds the table concurrency
+        table_arena->execute([&] { compute_tables(true); });
+    }
+    else
+    {
+        compute_tables(false);
+    }
 
-    if (result_table.empty())
+    if (durations_table.empty() && distances_table.empty())
     {
         return Error("NoTable", "No table found", result);
     }
 
     api::TableAPI table_api{facade, params};
-    table_api.MakeResponse(result_table, snapped_phantoms, result);
+    table_api.MakeResponse(durations_table, distances_table, snapped_phantoms, result);
 
     return Status::Ok;
 }
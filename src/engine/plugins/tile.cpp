@@ -19,6 +19,7 @@
 #include <protozero/varint.hpp>
 
 #include <algorithm>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <unordered_map>
@@ -983,6 +984,11 @@ void encodeVectorTile(const DataFacadeBase &facade,
 }
 }
 
+TilePlugin::TilePlugin(const int tile_cache_size)
+    : tile_cache(tile_cache_size > 0 ? std::make_unique<TileCache>(tile_cache_size) : nullptr)
+{
+}
+
 Status TilePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                  const api::TileParameters &parameters,
                                  std::string &pbf_buffer) const
@@ -990,6 +996,17 @@ Status TilePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     BOOST_ASSERT(parameters.IsValid());
 
     const auto &facade = algorithms.GetFacade();
+
+    const TileCacheKey key{facade.GetFacadeID(), parameters.x, parameters.y, parameters.z};
+    if (tile_cache)
+    {
+        if (const auto cached_tile = tile_cache->Get(facade.GetDatasetID(), key))
+        {
+            pbf_buffer = *cached_tile;
+            return Status::Ok;
+        }
+    }
+
     auto edges = getEdges(facade, parameters.x, parameters.y, parameters.z);
     auto segregated_nodes = getSegregatedNodes(facade, edges);
 
@@ -1014,6 +1031,12 @@ Status TilePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                      segregated_nodes,
                      pbf_buffer);
 
+    if (tile_cache)
+    {
+        tile_cache->Put(
+            facade.GetDatasetID(), key, std::make_shared<const std::string>(pbf_buffer));
+    }
+
     return Status::Ok;
 }
 }
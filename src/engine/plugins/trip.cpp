@@ -2,8 +2,9 @@
 
 #include "engine/api/trip_api.hpp"
 #include "engine/api/trip_parameters.hpp"
-#include "engine/trip/trip_brute_force.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/trip/trip_farthest_insertion.hpp"
+#include "engine/trip/trip_held_karp.hpp"
 #include "engine/trip/trip_nearest_neighbour.hpp"
 #include "util/dist_table_wrapper.hpp" // to access the dist table more easily
 #include "util/json_container.hpp"
@@ -50,6 +51,15 @@ bool IsSupportedParameterCombination(const bool fixed_start,
     }
 }
 
+// The smallest number of legs that is searched on an arena thread
+const constexpr std::size_t MIN_LEGS_PER_TASK = 4;
+
+TripPlugin::TripPlugin(const int max_locations_trip_, const int trip_threads)
+    : max_locations_trip(max_locations_trip_),
+      trip_arena(trip_threads > 1 ? std::make_unique<tbb::task_arena>(trip_threads) : nullptr)
+{
+}
+
 // given the node order in which to visit, compute the actual route (with geometry, travel time and
 // so on) and return the result
 InternalRouteResult TripPlugin::ComputeRoute(const RoutingAlgorithmsInterface &algorithms,
@@ -85,9 +95,58 @@ InternalRouteResult TripPlugin::ComputeRoute(const RoutingAlgorithmsInterface &a
         BOOST_ASSERT(min_route.segment_end_coordinates.size() == trip.size() - 1);
     }
 
-    min_route = algorithms.ShortestPathSearch(min_route.segment_end_coordinates, {false});
-    BOOST_ASSERT_MSG(min_route.shortest_path_weight < INVALID_EDGE_WEIGHT, "unroutable route");
-    return min_route;
+    const auto &legs = min_route.segment_end_coordinates;
+    const auto number_of_tasks =
+        trip_arena ? std::min<std::size_t>(trip_arena->max_concurrency(),
+                                           legs.size() / MIN_LEGS_PER_TASK)
+                   : 1;
+    if (number_of_tasks <= 1)
+    {
+        min_route = algorithms.ShortestPathSearch(legs, {false}, false);
+        BOOST_ASSERT_MSG(min_route.shortest_path_weight < INVALID_EDGE_WEIGHT, "unroutable route");
+        return min_route;
+    }
+
+    // U-turns are allowed at the waypoints, so a leg does not depend on the direction in which the
+    // previous leg arrives. Consecutive legs are searched in chunks on the arena and joined.
+    std::vector<InternalRouteResult> chunk_routes(number_of_tasks);
+    trip_arena->execute([&] {
+        routing_algorithms::parallelForEach(number_of_tasks, [&](const auto &range) {
+            for (auto chunk = range.begin(); chunk != range.end(); ++chunk)
+            {
+                const auto begin = legs.begin() + chunk * legs.size() / number_of_tasks;
+                const auto end = legs.begin() + (chunk + 1) * legs.size() / number_of_tasks;
+                chunk_routes[chunk] = algorithms.ShortestPathSearch(
+                    std::vector<PhantomNodes>(begin, end), {false}, false);
+            }
+        });
+    });
+
+    InternalRouteResult route;
+    route.shortest_path_weight = 0;
+    for (auto &chunk_route : chunk_routes)
+    {
+        BOOST_ASSERT_MSG(chunk_route.is_valid(), "unroutable route");
+        if (!chunk_route.is_valid())
+        {
+            return chunk_route;
+        }
+
+        route.shortest_path_weight += chunk_route.shortest_path_weight;
+        std::move(chunk_route.unpacked_path_segments.begin(),
+                  chunk_route.unpacked_path_segments.end(),
+                  std::back_inserter(route.unpacked_path_segments));
+        route.segment_end_coordinates.insert(route.segment_end_coordinates.end(),
+                                             chunk_route.segment_end_coordinates.begin(),
+                                             chunk_route.segment_end_coordinates.end());
+        route.source_traversed_in_reverse.insert(route.source_traversed_in_reverse.end(),
+                                                 chunk_route.source_traversed_in_reverse.begin(),
+                                                 chunk_route.source_traversed_in_reverse.end());
+        route.target_traversed_in_reverse.insert(route.target_traversed_in_reverse.end(),
+                                                 chunk_route.target_traversed_in_reverse.begin(),
+                                                 chunk_route.target_traversed_in_reverse.end());
+    }
+    return route;
 }
 
 void ManipulateTableForFSE(const std::size_t source_id,
@@ -195,6 +254,8 @@ Status TripPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
         return Status::Error;
 
     const auto &facade = algorithms.GetFacade();
+    if (!CheckAnnotations(parameters, facade, json_result))
+        return Status::Error;
     auto phantom_node_pairs = GetPhantomNodes(facade, parameters);
     if (phantom_node_pairs.size() != number_of_locations)
     {
@@ -216,15 +277,26 @@ Status TripPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     BOOST_ASSERT(snapped_phantoms.size() == number_of_locations);
 
     // compute the duration table of all phantom nodes
-    auto result_table = util::DistTableWrapper<EdgeWeight>(
-        algorithms.ManyToManySearch(snapped_phantoms, {}, {}), number_of_locations);
+    std::vector<EdgeDuration> durations;
+    if (trip_arena)
+    {
+        // the arena is shared by all request threads and bounds the trip concurrency
+        trip_arena->execute([&] {
+            durations = algorithms.ManyToManySearch(snapped_phantoms, {}, {}, true, nullptr);
+        });
+    }
+    else
+    {
+        durations = algorithms.ManyToManySearch(snapped_phantoms, {}, {}, false, nullptr);
+    }
+    auto result_table =
+        util::DistTableWrapper<EdgeWeight>(std::move(durations), number_of_locations);
 
     if (result_table.size() == 0)
     {
         return Status::Error;
     }
 
-    const constexpr std::size_t BF_MAX_FEASABLE = 10;
     BOOST_ASSERT_MSG(result_table.size() == number_of_locations * number_of_locations,
                      "Distance Table has wrong size");
 
@@ -240,14 +312,18 @@ Status TripPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
 
     std::vector<NodeID> trip;
     trip.reserve(number_of_locations);
-    // get an optimized order in which the destinations should be visited
-    if (number_of_locations < BF_MAX_FEASABLE)
-    {
-        trip = trip::BruteForceTrip(number_of_locations, result_table);
-    }
-    else
+    // get an optimized order in which the destinations should be visited, the heuristics
+    // check the cancellation token of the request like the searches
     {
-        trip = trip::FarthestInsertionTrip(number_of_locations, result_table);
+        const CancellationScope scope(algorithms.GetCancellationToken());
+        if (number_of_locations <= trip::HELD_KARP_MAX_LOCATIONS)
+        {
+            trip = trip::HeldKarpTrip(number_of_locations, result_table);
+        }
+        else
+        {
+            trip = trip::FarthestInsertionTrip(number_of_locations, result_table);
+        }
     }
 
     // rotate result such that roundtrip starts at node with index 0
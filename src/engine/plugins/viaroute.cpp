@@ -10,6 +10,7 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -21,14 +22,25 @@ namespace engine
 namespace plugins
 {
 
-ViaRoutePlugin::ViaRoutePlugin(int max_locations_viaroute, int max_alternatives)
-    : max_locations_viaroute(max_locations_viaroute), max_alternatives(max_alternatives)
+ViaRoutePlugin::ViaRoutePlugin(int max_locations_viaroute,
+                               int max_alternatives,
+                               int max_alternative_time,
+                               int alternative_threads,
+                               int route_threads,
+                               int route_cache_size)
+    : max_locations_viaroute(max_locations_viaroute), max_alternatives(max_alternatives),
+      max_alternative_time(max_alternative_time),
+      alternative_arena(alternative_threads > 1
+                            ? std::make_unique<tbb::task_arena>(alternative_threads)
+                            : nullptr),
+      route_arena(route_threads > 1 ? std::make_unique<tbb::task_arena>(route_threads) : nullptr),
+      route_cache(route_cache_size > 0 ? std::make_unique<RouteCache>(route_cache_size) : nullptr)
 {
 }
 
 Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                      const api::RouteParameters &route_parameters,
-                                     util::json::Object &json_result) const
+                                     api::ResultT &result) const
 {
     BOOST_ASSERT(route_parameters.IsValid());
 
@@ -37,7 +49,7 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
         return Error("NotImplemented",
                      "Shortest path search is not implemented for the chosen search algorithm. "
                      "Only two coordinates supported.",
-                     json_result);
+                     result);
     }
 
     if (!algorithms.HasDirectShortestPathSearch() && !algorithms.HasShortestPathSearch())
@@ -45,7 +57,7 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
         return Error(
             "NotImplemented",
             "Direct shortest path search is not implemented for the chosen search algorithm.",
-            json_result);
+            result);
     }
 
     if (max_locations_viaroute > 0 &&
@@ -55,7 +67,7 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
                      "Number of entries " + std::to_string(route_parameters.coordinates.size()) +
                          " is higher than current maximum (" +
                          std::to_string(max_locations_viaroute) + ")",
-                     json_result);
+                     result);
     }
 
     // Takes care of alternatives=n and alternatives=true
@@ -65,25 +77,27 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
         return Error("TooBig",
                      "Requested number of alternatives is higher than current maximum (" +
                          std::to_string(max_alternatives) + ")",
-                     json_result);
+                     result);
     }
 
     if (!CheckAllCoordinates(route_parameters.coordinates))
     {
-        return Error("InvalidValue", "Invalid coordinate value.", json_result);
+        return Error("InvalidValue", "Invalid coordinate value.", result);
     }
 
-    if (!CheckAlgorithms(route_parameters, algorithms, json_result))
+    if (!CheckAlgorithms(route_parameters, algorithms, result))
         return Status::Error;
 
     const auto &facade = algorithms.GetFacade();
+    if (!CheckAnnotations(route_parameters, facade, result))
+        return Status::Error;
     auto phantom_node_pairs = GetPhantomNodes(facade, route_parameters);
     if (phantom_node_pairs.size() != route_parameters.coordinates.size())
     {
         return Error("NoSegment",
                      std::string("Could not find a matching segment for coordinate ") +
                          std::to_string(phantom_node_pairs.size()),
-                     json_result);
+                     result);
     }
     BOOST_ASSERT(phantom_node_pairs.size() == route_parameters.coordinates.size());
 
@@ -107,20 +121,89 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
         (route_parameters.alternatives || route_parameters.number_of_alternatives > 0);
     const auto number_of_alternatives = std::max(1u, route_parameters.number_of_alternatives);
 
-    // Alternatives do not support vias, only direct s,t queries supported
-    // See the implementation notes and high-level outline.
-    // https://github.com/Project-OSRM/osrm-backend/issues/3905
-    if (1 == start_end_nodes.size() && algorithms.HasAlternativePathSearch() && wants_alternatives)
-    {
-        routes = algorithms.AlternativePathSearch(start_end_nodes.front(), number_of_alternatives);
-    }
-    else if (1 == start_end_nodes.size() && algorithms.HasDirectShortestPathSearch())
+    // the shortest route is always returned, alternatives only as far as they are found in time
+    const auto alternative_deadline =
+        max_alternative_time >= 0
+            ? routing_algorithms::AlternativeDeadline(
+                  routing_algorithms::AlternativeDeadline::Clock::now() +
+                  std::chrono::milliseconds(max_alternative_time))
+            : routing_algorithms::AlternativeDeadline();
+
+    const auto search = [&] {
+        // Alternatives do not support vias, only direct s,t queries supported
+        // See the implementation notes and high-level outline.
+        // https://github.com/Project-OSRM/osrm-backend/issues/3905
+        if (1 == start_end_nodes.size() && algorithms.HasAlternativePathSearch() &&
+            wants_alternatives)
+        {
+            if (alternative_arena)
+            {
+                // the arena is shared by all request threads and bounds the candidate concurrency
+                alternative_arena->execute([&] {
+                    routes = algorithms.AlternativePathSearch(start_end_nodes.front(),
+                                                              number_of_alternatives,
+                                                              true,
+                                                              alternative_deadline);
+                });
+            }
+            else
+            {
+                routes = algorithms.AlternativePathSearch(start_end_nodes.front(),
+                                                          number_of_alternatives,
+                                                          false,
+                                                          alternative_deadline);
+            }
+        }
+        else if (1 == start_end_nodes.size() && algorithms.HasDirectShortestPathSearch())
+        {
+            routes = algorithms.DirectShortestPathSearch(start_end_nodes.front());
+        }
+        else if (route_arena)
+        {
+            // the arena is shared by all request threads and bounds the leg concurrency
+            route_arena->execute([&] {
+                routes = algorithms.ShortestPathSearch(
+                    start_end_nodes, route_parameters.continue_straight, true);
+            });
+        }
+        else
+        {
+            routes = algorithms.ShortestPathSearch(
+                start_end_nodes, route_parameters.continue_straight, false);
+        }
+    };
+
+    if (route_cache)
     {
-        routes = algorithms.DirectShortestPathSearch(start_end_nodes.front());
+        const RouteCacheKey key(facade.GetFacadeID(),
+                                start_end_nodes,
+                                wants_alternatives ? number_of_alternatives : 0,
+                                route_parameters.continue_straight);
+        if (const auto cached_routes = route_cache->Get(facade.GetDatasetID(), key))
+        {
+            // the waypoints of the response use the snapped and input locations of this request
+            routes = *cached_routes;
+            for (auto &route : routes.routes)
+            {
+                route.segment_end_coordinates = start_end_nodes;
+            }
+        }
+        else
+        {
+            search();
+            // routes that ran out of time might lack alternatives a later query finds
+            if (routes.routes[0].is_valid() &&
+                !(wants_alternatives && alternative_deadline.Passed()))
+            {
+                route_cache->Put(facade.GetDatasetID(),
+                                 key,
+                                 std::make_shared<const InternalManyRoutesResult>(routes));
+            }
+        }
     }
     else
     {
-        routes = algorithms.ShortestPathSearch(start_end_nodes, route_parameters.continue_straight);
+        search();
     }
 
     // The post condition for all path searches is we have at least one route in our result.
@@ -132,7 +215,7 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
 
     if (routes.routes[0].is_valid())
     {
-        route_api.MakeResponse(routes, json_result);
+        route_api.MakeResponse(routes, result);
     }
     else
     {
@@ -145,11 +228,11 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
 
         if (not_in_same_component)
         {
-            return Error("NoRoute", "Impossible route between points", json_result);
+            return Error("NoRoute", "Impossible route between points", result);
         }
         else
         {
-            return Error("NoRoute", "No route found between points", json_result);
+            return Error("NoRoute", "No route found between points", result);
         }
     }
 
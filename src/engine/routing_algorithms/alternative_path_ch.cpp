@@ -1,4 +1,5 @@
 #include "engine/routing_algorithms/alternative_path.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/routing_algorithms/routing_base_ch.hpp"
 
 #include "util/integer_range.hpp"
@@ -27,6 +28,8 @@ namespace
 const double constexpr VIAPATH_ALPHA = 0.25;   // alternative is local optimum on 25% sub-paths
 const double constexpr VIAPATH_EPSILON = 0.15; // alternative at most 15% longer
 const double constexpr VIAPATH_GAMMA = 0.75;   // alternative shares at most 75% with the shortest.
+// steps of the widened search between two reads of the clock for the deadline
+const unsigned constexpr DEADLINE_CHECK_INTERVAL = 256;
 
 using QueryHeap = SearchEngineData<Algorithm>::QueryHeap;
 using SearchSpaceEdge = std::pair<NodeID, NodeID>;
@@ -152,9 +155,12 @@ void retrievePackedAlternatePath(const QueryHeap &forward_heap1,
 // TODO: reorder parameters
 // compute and unpack <s,..,v> and <v,..,t> by exploring search spaces
 // from v and intersecting against queues. only half-searches have to be
-// done at this stage
+// done at this stage. The existing heaps are only read, so candidates can be
+// computed on several threads with the second heaps of each thread.
 void computeWeightAndSharingOfViaPath(SearchEngineData<Algorithm> &engine_working_data,
                                       const DataFacade<Algorithm> &facade,
+                                      QueryHeap &existing_forward_heap,
+                                      QueryHeap &existing_reverse_heap,
                                       const NodeID via_node,
                                       EdgeWeight *real_weight_of_via_path,
                                       EdgeWeight *sharing_of_via_path,
@@ -163,8 +169,6 @@ void computeWeightAndSharingOfViaPath(SearchEngineData<Algorithm> &engine_workin
 {
     engine_working_data.InitializeOrClearSecondThreadLocalStorage(facade.GetNumberOfNodes());
 
-    auto &existing_forward_heap = *engine_working_data.forward_heap_1;
-    auto &existing_reverse_heap = *engine_working_data.reverse_heap_1;
     auto &new_forward_heap = *engine_working_data.forward_heap_2;
     auto &new_reverse_heap = *engine_working_data.reverse_heap_2;
 
@@ -180,6 +184,7 @@ void computeWeightAndSharingOfViaPath(SearchEngineData<Algorithm> &engine_workin
     // compute path <s,..,v> by reusing forward search from s
     while (!new_reverse_heap.Empty())
     {
+        checkCancellation();
         routingStep<REVERSE_DIRECTION>(facade,
                                        new_reverse_heap,
                                        existing_forward_heap,
@@ -195,6 +200,7 @@ void computeWeightAndSharingOfViaPath(SearchEngineData<Algorithm> &engine_workin
     new_forward_heap.Insert(via_node, 0, via_node);
     while (!new_forward_heap.Empty())
     {
+        checkCancellation();
         routingStep<FORWARD_DIRECTION>(facade,
                                        new_forward_heap,
                                        existing_reverse_heap,
@@ -341,6 +347,7 @@ bool viaNodeCandidatePassesTTest(SearchEngineData<Algorithm> &engine_working_dat
     new_reverse_heap.Insert(candidate.node, 0, candidate.node);
     while (new_reverse_heap.Size() > 0)
     {
+        checkCancellation();
         routingStep<REVERSE_DIRECTION>(facade,
                                        new_reverse_heap,
                                        existing_forward_heap,
@@ -362,6 +369,7 @@ bool viaNodeCandidatePassesTTest(SearchEngineData<Algorithm> &engine_working_dat
     new_forward_heap.Insert(candidate.node, 0, candidate.node);
     while (new_forward_heap.Size() > 0)
     {
+        checkCancellation();
         routingStep<FORWARD_DIRECTION>(facade,
                                        new_forward_heap,
                                        existing_reverse_heap,
@@ -533,6 +541,7 @@ bool viaNodeCandidatePassesTTest(SearchEngineData<Algorithm> &engine_working_dat
     // exploration from s and t until deletemin/(1+epsilon) > _lengt_oO_sShortest_path
     while ((forward_heap3.Size() + reverse_heap3.Size()) > 0)
     {
+        checkCancellation();
         if (!forward_heap3.Empty())
         {
             routingStep<FORWARD_DIRECTION>(facade,
@@ -563,7 +572,9 @@ bool viaNodeCandidatePassesTTest(SearchEngineData<Algorithm> &engine_working_dat
 InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engine_working_data,
                                                const DataFacade<Algorithm> &facade,
                                                const PhantomNodes &phantom_node_pair,
-                                               unsigned /*number_of_alternatives*/)
+                                               unsigned /*number_of_alternatives*/,
+                                               const bool parallel,
+                                               const AlternativeDeadline &deadline)
 {
     InternalRouteResult primary_route;
     InternalRouteResult secondary_route;
@@ -598,9 +609,24 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
 
     insertNodesInHeaps(forward_heap1, reverse_heap1, phantom_node_pair);
 
+    // Past the stopping criterion of ch::search in both directions the shortest path is settled
+    // and the steps only widen the search space for alternatives
+    const auto settled = [&](const QueryHeap &heap) {
+        return heap.Empty() ||
+               heap.MinKey() + min_edge_offset > upper_bound_to_shortest_path_weight;
+    };
+    unsigned widening_steps = 0;
+
     // search from s and t till new_min/(1+epsilon) > weight_of_shortest_path
     while (0 < (forward_heap1.Size() + reverse_heap1.Size()))
     {
+        checkCancellation();
+        if (INVALID_EDGE_WEIGHT != upper_bound_to_shortest_path_weight &&
+            settled(forward_heap1) && settled(reverse_heap1) &&
+            ++widening_steps % DEADLINE_CHECK_INTERVAL == 0 && deadline.Passed())
+        {
+            break;
+        }
         if (0 < forward_heap1.Size())
         {
             alternativeRoutingStep<FORWARD_DIRECTION>(facade,
@@ -745,25 +771,50 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
         packed_shortest_path.insert(
             packed_shortest_path.end(), packed_reverse_path.begin(), packed_reverse_path.end());
     }
-    std::vector<RankedCandidateNode> ranked_candidates_list;
+    // prioritizing via nodes for deep inspection, candidates left at the deadline are not ranked
+    std::vector<EdgeWeight> weights_of_via_paths(preselected_node_list.size(),
+                                                 INVALID_EDGE_WEIGHT);
+    std::vector<EdgeWeight> sharings_of_via_paths(preselected_node_list.size(), 0);
+    const auto compute_via_paths = [&](const std::size_t first, const std::size_t last) {
+        for (auto index = first; index != last; ++index)
+        {
+            if (deadline.Passed())
+                break;
+            computeWeightAndSharingOfViaPath(engine_working_data,
+                                             facade,
+                                             forward_heap1,
+                                             reverse_heap1,
+                                             preselected_node_list[index],
+                                             &weights_of_via_paths[index],
+                                             &sharings_of_via_paths[index],
+                                             packed_shortest_path,
+                                             min_edge_offset);
+        }
+    };
+    if (parallel)
+    {
+        parallelForEach(preselected_node_list.size(),
+                        [&](const tbb::blocked_range<std::uint32_t> &range) {
+                            compute_via_paths(range.begin(), range.end());
+                        });
+    }
+    else
+    {
+        compute_via_paths(0, preselected_node_list.size());
+    }
 
-    // prioritizing via nodes for deep inspection
-    for (const NodeID node : preselected_node_list)
-    {
-        EdgeWeight weight_of_via_path = 0, sharing_of_via_path = 0;
-        computeWeightAndSharingOfViaPath(engine_working_data,
-                                         facade,
-                                         node,
-                                         &weight_of_via_path,
-                                         &sharing_of_via_path,
-                                         packed_shortest_path,
-                                         min_edge_offset);
+    std::vector<RankedCandidateNode> ranked_candidates_list;
+    for (const auto index : util::irange<std::size_t>(0UL, preselected_node_list.size()))
+    {
+        const auto weight_of_via_path = weights_of_via_paths[index];
+        const auto sharing_of_via_path = sharings_of_via_paths[index];
         const EdgeWeight maximum_allowed_sharing =
             static_cast<EdgeWeight>(upper_bound_to_shortest_path_weight * VIAPATH_GAMMA);
         if (sharing_of_via_path <= maximum_allowed_sharing &&
             weight_of_via_path <= upper_bound_to_shortest_path_weight * (1 + VIAPATH_EPSILON))
         {
-            ranked_candidates_list.emplace_back(node, weight_of_via_path, sharing_of_via_path);
+            ranked_candidates_list.emplace_back(
+                preselected_node_list[index], weight_of_via_path, sharing_of_via_path);
         }
     }
     std::sort(ranked_candidates_list.begin(), ranked_candidates_list.end());
@@ -773,6 +824,8 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
     NodeID s_v_middle = SPECIAL_NODEID, v_t_middle = SPECIAL_NODEID;
     for (const RankedCandidateNode &candidate : ranked_candidates_list)
     {
+        if (deadline.Passed())
+            break;
         if (viaNodeCandidatePassesTTest(engine_working_data,
                                         facade,
                                         forward_heap1,
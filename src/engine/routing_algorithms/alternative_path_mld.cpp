@@ -1,4 +1,5 @@
 #include "engine/routing_algorithms/alternative_path.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/routing_algorithms/routing_base_mld.hpp"
 
 #include "util/static_assert.hpp"
@@ -6,9 +7,11 @@
 #include <boost/assert.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -50,6 +53,8 @@ const constexpr auto kAtLeastDifferentBy = 0.85;
 // At least optimal around 10% sub-paths around the via node candidate.
 const /*constexpr*/ auto kAtLeastOptimalAroundViaBy = 0.10;
 // gcc 7.1 ICE ^
+// Steps of the widened search between two reads of the clock for the deadline.
+const constexpr auto kDeadlineCheckInterval = 256u;
 
 // Represents a via middle node where forward (from s) and backward (from t)
 // search spaces overlap and the weight a path (made up of s,via and via,t) has.
@@ -195,44 +200,32 @@ filterViaCandidatesByViaNotOnPath(const WeightedViaNodePackedPath &path, RandIt
     return std::remove_if(first, last, via_on_path);
 }
 
-// Filters packed paths with similar cells between each other. Mutates range in-place.
-// Returns an iterator to the filtered range's new end.
-template <typename RandIt>
-RandIt filterPackedPathsByCellSharing(RandIt first, RandIt last, const Partition &partition)
+// Checks packed paths for similar cells to the shortest path and the paths accepted before.
+// Paths have to be checked in the order they are ranked in, a path that is not over the sharing
+// limit adds its cells for the following paths.
+class PackedPathCellSharing
 {
-    util::static_assert_iter_category<RandIt, std::random_access_iterator_tag>();
-    util::static_assert_iter_value<RandIt, WeightedViaNodePackedPath>();
+  public:
+    PackedPathCellSharing(const WeightedViaNodePackedPath &shortest_path,
+                          const Partition &partition)
+        : partition(partition)
+    {
+        const auto number_of_levels = partition.GetNumberOfLevels();
+        (void)number_of_levels;
+        BOOST_ASSERT(number_of_levels >= 1);
+
+        if (!shortest_path.path.empty())
+            InsertCells(shortest_path);
+    }
 
     // Todo: we could scale cell sharing with edge weights. Also basing sharing on
     // cells could be problematic e.g. think of parallel ways in grid cities.
-
-    const auto size = static_cast<std::size_t>(last - first);
-
-    if (size < 2)
-        return last;
-
-    const auto number_of_levels = partition.GetNumberOfLevels();
-    (void)number_of_levels;
-    BOOST_ASSERT(number_of_levels >= 1);
-
-    // Todo: sharing could be a linear combination based on level and sharing on each level.
-    // Experimental evaluation shows using the lowest level works surprisingly well already.
-    const auto level = 1;
-    const auto get_cell = [&](auto node) { return partition.GetCell(level, node); };
-
-    const auto shortest_path = *first;
-
-    if (shortest_path.path.empty())
-        return last;
-
-    std::unordered_set<CellID> cells;
-    cells.reserve(size * (shortest_path.path.size() + 1) * (1. + kAtMostLongerBy));
-
-    cells.insert(get_cell(std::get<0>(shortest_path.path.front())));
-    for (const auto &edge : shortest_path.path)
-        cells.insert(get_cell(std::get<1>(edge)));
-
-    const auto over_sharing_limit = [&](const auto &packed) {
+    bool IsOverSharingLimit(const WeightedViaNodePackedPath &packed)
+    {
+        if (cells.empty())
+        { // the shortest path has a single-node (empty) path, there is nothing to share
+            return false;
+        }
 
         if (packed.path.empty())
         { // don't remove routes with single-node (empty) path
@@ -240,8 +233,8 @@ RandIt filterPackedPathsByCellSharing(RandIt first, RandIt last, const Partition
         }
 
         const auto not_seen = [&](const PackedEdge edge) {
-            const auto source_cell = get_cell(std::get<0>(edge));
-            const auto target_cell = get_cell(std::get<1>(edge));
+            const auto source_cell = GetCell(std::get<0>(edge));
+            const auto target_cell = GetCell(std::get<1>(edge));
             return cells.count(source_cell) < 1 && cells.count(target_cell) < 1;
         };
 
@@ -254,36 +247,39 @@ RandIt filterPackedPathsByCellSharing(RandIt first, RandIt last, const Partition
         const auto sharing = 1. - difference;
 
         if (sharing > kAtLeastDifferentBy)
-        {
             return true;
-        }
-        else
-        {
-            cells.insert(get_cell(std::get<0>(packed.path.front())));
-            for (const auto &edge : packed.path)
-                cells.insert(get_cell(std::get<1>(edge)));
 
-            return false;
-        }
-    };
+        InsertCells(packed);
+        return false;
+    }
 
-    return std::remove_if(first + 1, last, over_sharing_limit);
-}
+  private:
+    // Todo: sharing could be a linear combination based on level and sharing on each level.
+    // Experimental evaluation shows using the lowest level works surprisingly well already.
+    CellID GetCell(const NodeID node) const { return partition.GetCell(1, node); }
 
-// Filters packed paths based on local optimality. Mutates range in-place.
-// Returns an iterator to the filtered range's new end.
-template <typename RandIt>
-RandIt filterPackedPathsByLocalOptimality(const WeightedViaNodePackedPath &path,
-                                          const Heap &forward_heap,
-                                          const Heap &reverse_heap,
-                                          RandIt first,
-                                          RandIt last)
-{
-    util::static_assert_iter_category<RandIt, std::random_access_iterator_tag>();
-    util::static_assert_iter_value<RandIt, WeightedViaNodePackedPath>();
+    void InsertCells(const WeightedViaNodePackedPath &packed)
+    {
+        cells.insert(GetCell(std::get<0>(packed.path.front())));
+        for (const auto &edge : packed.path)
+            cells.insert(GetCell(std::get<1>(edge)));
+    }
 
-    if (path.path.empty())
-        return last;
+    const Partition &partition;
+    std::unordered_set<CellID> cells;
+};
+
+// Checks packed paths for local optimality around their via node.
+class PackedPathLocalOptimality
+{
+  public:
+    PackedPathLocalOptimality(const WeightedViaNodePackedPath &path,
+                              const Heap &forward_heap,
+                              const Heap &reverse_heap)
+        : path(path), forward_heap(forward_heap), reverse_heap(reverse_heap)
+    {
+        BOOST_ASSERT(path.via.weight != INVALID_EDGE_WEIGHT);
+    }
 
     // Check sub-path optimality on alternative path crossing the via node candidate.
     //
@@ -294,35 +290,11 @@ RandIt filterPackedPathsByLocalOptimality(const WeightedViaNodePackedPath &path,
     // Todo: this approach is efficient but works on packed paths only. Do we need to do a
     // thorough check on the unpacked paths instead? Or do we even need to introduce two
     // new thread-local heaps for the mld SearchEngineData and do proper s-t routing here?
+    bool IsNotLocallyOptimal(const WeightedViaNodePackedPath &packed) const
+    {
+        if (path.path.empty())
+            return false;
 
-    BOOST_ASSERT(path.via.weight != INVALID_EDGE_WEIGHT);
-
-    // node == parent_in_main_heap(parent_in_side_heap(v)) -> plateaux at `node`
-    const auto has_plateaux_at_node = [&](const NodeID node, const Heap &fst, const Heap &snd) {
-        BOOST_ASSERT(fst.WasInserted(node));
-        auto const parent = fst.GetData(node).parent;
-        return snd.WasInserted(parent) && snd.GetData(parent).parent == node;
-    };
-
-    // A plateaux is defined as a segment in which the search tree from s and the search
-    // tree from t overlap. An edge is part of such a plateaux around `v` if:
-    // v == parent_in_reverse_search(parent_in_forward_search(v)).
-    // Here we calculate the last node on the plateaux in either direction.
-    const auto plateaux_end = [&](NodeID node, const Heap &fst, const Heap &snd) {
-        BOOST_ASSERT(node != SPECIAL_NODEID);
-        BOOST_ASSERT(fst.WasInserted(node));
-        BOOST_ASSERT(snd.WasInserted(node));
-
-        // Check plateaux edges towards the target. Terminates at the source / target
-        // at the latest, since parent(target)==target for the reverse heap and
-        // parent(target) != target in the forward heap (and vice versa).
-        while (node != fst.GetData(node).parent && has_plateaux_at_node(node, fst, snd))
-            node = fst.GetData(node).parent;
-
-        return node;
-    };
-
-    const auto is_not_locally_optimal = [&](const auto &packed) {
         BOOST_ASSERT(packed.via.node != path.via.node);
         BOOST_ASSERT(packed.via.weight != INVALID_EDGE_WEIGHT);
         BOOST_ASSERT(packed.via.node != SPECIAL_NODEID);
@@ -348,8 +320,8 @@ RandIt filterPackedPathsByLocalOptimality(const WeightedViaNodePackedPath &path,
         // of the search spaces and therefore parent pointers may not be valid in heaps.
         // In these cases we know we can't have local optimality around the via already.
 
-        const auto first_on_plateaux = plateaux_end(via, forward_heap, reverse_heap);
-        const auto last_on_plateaux = plateaux_end(via, reverse_heap, forward_heap);
+        const auto first_on_plateaux = PlateauxEnd(via, forward_heap, reverse_heap);
+        const auto last_on_plateaux = PlateauxEnd(via, reverse_heap, forward_heap);
 
         //        fop - - via - - lop
         //      .'                    '.
@@ -377,10 +349,40 @@ RandIt filterPackedPathsByLocalOptimality(const WeightedViaNodePackedPath &path,
                                    reverse_heap.GetKey(via) - reverse_heap.GetKey(b);
 
         return plateaux_length < kAtLeastOptimalAroundViaBy * detour_length;
-    };
+    }
 
-    return std::remove_if(first, last, is_not_locally_optimal);
-}
+  private:
+    // node == parent_in_main_heap(parent_in_side_heap(v)) -> plateaux at `node`
+    static bool HasPlateauxAtNode(const NodeID node, const Heap &fst, const Heap &snd)
+    {
+        BOOST_ASSERT(fst.WasInserted(node));
+        auto const parent = fst.GetData(node).parent;
+        return snd.WasInserted(parent) && snd.GetData(parent).parent == node;
+    }
+
+    // A plateaux is defined as a segment in which the search tree from s and the search
+    // tree from t overlap. An edge is part of such a plateaux around `v` if:
+    // v == parent_in_reverse_search(parent_in_forward_search(v)).
+    // Here we calculate the last node on the plateaux in either direction.
+    static NodeID PlateauxEnd(NodeID node, const Heap &fst, const Heap &snd)
+    {
+        BOOST_ASSERT(node != SPECIAL_NODEID);
+        BOOST_ASSERT(fst.WasInserted(node));
+        BOOST_ASSERT(snd.WasInserted(node));
+
+        // Check plateaux edges towards the target. Terminates at the source / target
+        // at the latest, since parent(target)==target for the reverse heap and
+        // parent(target) != target in the forward heap (and vice versa).
+        while (node != fst.GetData(node).parent && HasPlateauxAtNode(node, fst, snd))
+            node = fst.GetData(node).parent;
+
+        return node;
+    }
+
+    const WeightedViaNodePackedPath &path;
+    const Heap &forward_heap;
+    const Heap &reverse_heap;
+};
 
 // Filters unpacked paths compared to all other paths. Mutates range in-place.
 // Returns an iterator to the filtered range's new end.
@@ -399,10 +401,10 @@ template <typename RandIt> RandIt filterUnpackedPathsBySharing(RandIt first, Ran
     if (shortest_path.edges.empty())
         return last;
 
-    std::unordered_set<EdgeID> edges;
-    edges.reserve(size * shortest_path.edges.size() * (1. + kAtMostLongerBy));
-
-    edges.insert(begin(shortest_path.edges), begin(shortest_path.edges));
+    // The edges of the shortest path and the accepted paths, sorted for binary searches
+    std::vector<EdgeID> edges(begin(shortest_path.edges), end(shortest_path.edges));
+    std::sort(begin(edges), end(edges));
+    std::vector<EdgeID> sorted_edges;
 
     const auto over_sharing_limit = [&](const auto &unpacked) {
 
@@ -411,7 +413,9 @@ template <typename RandIt> RandIt filterUnpackedPathsBySharing(RandIt first, Ran
             return false;
         }
 
-        const auto not_seen = [&](const EdgeID edge) { return edges.count(edge) < 1; };
+        const auto not_seen = [&](const EdgeID edge) {
+            return !std::binary_search(begin(edges), end(edges), edge);
+        };
         const auto different = std::count_if(begin(unpacked.edges), end(unpacked.edges), not_seen);
 
         const auto difference = different / static_cast<double>(unpacked.edges.size());
@@ -426,7 +430,10 @@ template <typename RandIt> RandIt filterUnpackedPathsBySharing(RandIt first, Ran
         }
         else
         {
-            edges.insert(begin(unpacked.edges), end(unpacked.edges));
+            sorted_edges.assign(begin(unpacked.edges), end(unpacked.edges));
+            std::sort(begin(sorted_edges), end(sorted_edges));
+            const auto middle = edges.insert(end(edges), begin(sorted_edges), end(sorted_edges));
+            std::inplace_merge(begin(edges), middle, end(edges));
             return false;
         }
     };
@@ -465,16 +472,109 @@ void unpackPackedPaths(InputIt first,
                        OutIt out,
                        SearchEngineData<Algorithm> &search_engine_data,
                        const Facade &facade,
-                       const PhantomNodes &phantom_node_pair)
+                       const PhantomNodes &phantom_node_pair,
+                       const bool parallel)
 {
-    util::static_assert_iter_category<InputIt, std::input_iterator_tag>();
+    util::static_assert_iter_category<InputIt, std::forward_iterator_tag>();
     util::static_assert_iter_category<OutIt, std::output_iterator_tag>();
     util::static_assert_iter_value<InputIt, WeightedViaNodePackedPath>();
 
     const Partition &partition = facade.GetMultiLevelPartition();
 
-    Heap &forward_heap = *search_engine_data.forward_heap_1;
-    Heap &reverse_heap = *search_engine_data.reverse_heap_1;
+    // Alternatives share most of their overlay edges with the shortest path and with each
+    // other, each overlay edge is only unpacked with a search once. The searches do not depend
+    // on each other and use the heaps of the thread they run on.
+    struct UnpackedOverlayEdge
+    {
+        NodeID source;
+        NodeID target;
+        std::vector<NodeID> nodes;
+        std::vector<EdgeID> edges;
+    };
+    std::vector<UnpackedOverlayEdge> overlay_edges;
+    std::unordered_map<std::uint64_t, std::size_t> overlay_edge_indexes;
+
+    const auto get_key = [](const NodeID source, const NodeID target) {
+        return static_cast<std::uint64_t>(source) << 32 | target;
+    };
+
+    for (auto it = first; it != last; ++it)
+    {
+        for (auto const &packed_edge : it->path)
+        {
+            NodeID source, target;
+            bool overlay_edge;
+            std::tie(source, target, overlay_edge) = packed_edge;
+            if (overlay_edge &&
+                overlay_edge_indexes.emplace(get_key(source, target), overlay_edges.size()).second)
+            {
+                overlay_edges.push_back({source, target, {}, {}});
+            }
+        }
+    }
+
+    const auto unpack_overlay_edges = [&](const std::size_t first_edge,
+                                          const std::size_t last_edge) {
+        // Here heaps can be reused, let's go deeper!
+        search_engine_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
+        Heap &forward_heap = *search_engine_data.forward_heap_1;
+        Heap &reverse_heap = *search_engine_data.reverse_heap_1;
+
+        for (auto index = first_edge; index != last_edge; ++index)
+        {
+            auto &overlay_edge = overlay_edges[index];
+            const auto source = overlay_edge.source;
+            const auto target = overlay_edge.target;
+
+            //
+            // Todo: dup. code with mld::search except for level entry: we run a slight mld::search
+            //       adaption here and then dispatch to mld::search for recursively descending down.
+            //
+
+            LevelID level = getNodeQueryLevel(partition, source, phantom_node_pair); // XXX
+            CellID parent_cell_id = partition.GetCell(level, source);
+            BOOST_ASSERT(parent_cell_id == partition.GetCell(level, target));
+
+            LevelID sublevel = level - 1;
+
+            forward_heap.Clear();
+            reverse_heap.Clear();
+            forward_heap.Insert(source, 0, {source});
+            reverse_heap.Insert(target, 0, {target});
+
+            BOOST_ASSERT(!facade.ExcludeNode(source));
+            BOOST_ASSERT(!facade.ExcludeNode(target));
+
+            // TODO: when structured bindings will be allowed change to
+            // auto [subpath_weight, subpath_source, subpath_target, subpath] = ...
+            EdgeWeight subpath_weight;
+            std::tie(subpath_weight, overlay_edge.nodes, overlay_edge.edges) =
+                search(search_engine_data,
+                       facade,
+                       forward_heap,
+                       reverse_heap,
+                       DO_NOT_FORCE_LOOPS,
+                       DO_NOT_FORCE_LOOPS,
+                       INVALID_EDGE_WEIGHT,
+                       sublevel,
+                       parent_cell_id);
+            BOOST_ASSERT(!overlay_edge.edges.empty());
+            BOOST_ASSERT(overlay_edge.nodes.size() > 1);
+            BOOST_ASSERT(overlay_edge.nodes.front() == source);
+            BOOST_ASSERT(overlay_edge.nodes.back() == target);
+        }
+    };
+
+    if (parallel)
+    {
+        parallelForEach(overlay_edges.size(), [&](const tbb::blocked_range<std::uint32_t> &range) {
+            unpack_overlay_edges(range.begin(), range.end());
+        });
+    }
+    else
+    {
+        unpack_overlay_edges(0, overlay_edges.size());
+    }
 
     for (auto it = first; it != last; ++it, ++out)
     {
@@ -483,11 +583,6 @@ void unpackPackedPaths(InputIt first,
 
         const auto &packed_path = it->path;
 
-        //
-        // Todo: dup. code with mld::search except for level entry: we run a slight mld::search
-        //       adaption here and then dispatch to mld::search for recursively descending down.
-        //
-
         std::vector<NodeID> unpacked_nodes;
         std::vector<EdgeID> unpacked_edges;
         unpacked_nodes.reserve(packed_path.size());
@@ -518,43 +613,12 @@ void unpackPackedPaths(InputIt first,
             }
             else
             { // an overlay graph edge
-                LevelID level = getNodeQueryLevel(partition, source, phantom_node_pair); // XXX
-                CellID parent_cell_id = partition.GetCell(level, source);
-                BOOST_ASSERT(parent_cell_id == partition.GetCell(level, target));
-
-                LevelID sublevel = level - 1;
-
-                // Here heaps can be reused, let's go deeper!
-                forward_heap.Clear();
-                reverse_heap.Clear();
-                forward_heap.Insert(source, 0, {source});
-                reverse_heap.Insert(target, 0, {target});
-
-                BOOST_ASSERT(!facade.ExcludeNode(source));
-                BOOST_ASSERT(!facade.ExcludeNode(target));
-
-                // TODO: when structured bindings will be allowed change to
-                // auto [subpath_weight, subpath_source, subpath_target, subpath] = ...
-                EdgeWeight subpath_weight;
-                std::vector<NodeID> subpath_nodes;
-                std::vector<EdgeID> subpath_edges;
-                std::tie(subpath_weight, subpath_nodes, subpath_edges) = search(search_engine_data,
-                                                                                facade,
-                                                                                forward_heap,
-                                                                                reverse_heap,
-                                                                                DO_NOT_FORCE_LOOPS,
-                                                                                DO_NOT_FORCE_LOOPS,
-                                                                                INVALID_EDGE_WEIGHT,
-                                                                                sublevel,
-                                                                                parent_cell_id);
-                BOOST_ASSERT(!subpath_edges.empty());
-                BOOST_ASSERT(subpath_nodes.size() > 1);
-                BOOST_ASSERT(subpath_nodes.front() == source);
-                BOOST_ASSERT(subpath_nodes.back() == target);
+                const auto &subpath =
+                    overlay_edges[overlay_edge_indexes.find(get_key(source, target))->second];
                 unpacked_nodes.insert(
-                    unpacked_nodes.end(), std::next(subpath_nodes.begin()), subpath_nodes.end());
+                    unpacked_nodes.end(), std::next(subpath.nodes.begin()), subpath.nodes.end());
                 unpacked_edges.insert(
-                    unpacked_edges.end(), subpath_edges.begin(), subpath_edges.end());
+                    unpacked_edges.end(), subpath.edges.begin(), subpath.edges.end());
             }
         }
 
@@ -569,11 +633,13 @@ void unpackPackedPaths(InputIt first,
 
 // Generates via candidate nodes from the overlap of the two search spaces from s and t.
 // Returns via node candidates in no particular order; they're not guaranteed to be unique.
+// Once the deadline passed the search space is not widened beyond the shortest path anymore.
 // Note: heaps are modified in-place, after the function returns they're valid and can be used.
 inline std::vector<WeightedViaNode>
 makeCandidateVias(SearchEngineData<Algorithm> &search_engine_data,
                   const Facade &facade,
-                  const PhantomNodes &phantom_node_pair)
+                  const PhantomNodes &phantom_node_pair,
+                  const AlternativeDeadline &deadline)
 {
     Heap &forward_heap = *search_engine_data.forward_heap_1;
     Heap &reverse_heap = *search_engine_data.reverse_heap_1;
@@ -601,9 +667,11 @@ makeCandidateVias(SearchEngineData<Algorithm> &search_engine_data,
 
     EdgeWeight forward_heap_min = forward_heap.MinKey();
     EdgeWeight reverse_heap_min = reverse_heap.MinKey();
+    unsigned widening_steps = 0;
 
     while (forward_heap.Size() + reverse_heap.Size() > 0)
     {
+        checkCancellation();
         if (shortest_path_weight != INVALID_EDGE_WEIGHT)
             overlap_weight = shortest_path_weight * kSearchSpaceOverlapFactor;
 
@@ -613,6 +681,13 @@ makeCandidateVias(SearchEngineData<Algorithm> &search_engine_data,
         if (!keep_going)
             break;
 
+        // Past the stopping criterion of mld::search the shortest path is settled, from here on
+        // the steps only widen the search space for alternatives.
+        const bool widening = shortest_path_weight != INVALID_EDGE_WEIGHT &&
+                              forward_heap_min + reverse_heap_min >= shortest_path_weight;
+        if (widening && ++widening_steps % kDeadlineCheckInterval == 0 && deadline.Passed())
+            break;
+
         // Force forward step to not break early when we reached the middle, continue for overlap.
         // Note: only invalidate the via node, the weight upper bound is still correct!
         overlap_via = SPECIAL_NODEID;
@@ -689,7 +764,9 @@ makeCandidateVias(SearchEngineData<Algorithm> &search_engine_data,
 InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &search_engine_data,
                                                const Facade &facade,
                                                const PhantomNodes &phantom_node_pair,
-                                               unsigned number_of_alternatives)
+                                               unsigned number_of_alternatives,
+                                               const bool parallel,
+                                               const AlternativeDeadline &deadline)
 {
     const auto max_number_of_alternatives = number_of_alternatives;
     const auto max_number_of_alternatives_to_unpack =
@@ -706,7 +783,8 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &sear
     Heap &reverse_heap = *search_engine_data.reverse_heap_1;
 
     // Do forward and backward search, save search space overlap as via candidates.
-    auto candidate_vias = makeCandidateVias(search_engine_data, facade, phantom_node_pair);
+    auto candidate_vias =
+        makeCandidateVias(search_engine_data, facade, phantom_node_pair, deadline);
 
     const auto by_weight = [](const auto &lhs, const auto &rhs) { return lhs.weight < rhs.weight; };
     auto shortest_path_via_it =
@@ -760,41 +838,48 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &sear
         return WeightedViaNodePackedPath{std::move(via), std::move(packed_path)};
     };
 
+    const auto number_of_alternatives_to_unpack =
+        static_cast<std::size_t>(max_number_of_alternatives_to_unpack);
+
     std::vector<WeightedViaNodePackedPath> weighted_packed_paths;
-    weighted_packed_paths.reserve(1 + number_of_candidate_vias);
+    weighted_packed_paths.reserve(
+        1 + std::min<std::size_t>(number_of_candidate_vias, number_of_alternatives_to_unpack));
 
     // Store shortest path
     WeightedViaNode shortest_path_weighted_via{shortest_path_via, shortest_path_weight};
-    weighted_packed_paths.push_back(extract_packed_path_from_heaps(shortest_path_weighted_via));
+    const auto shortest_packed_path = extract_packed_path_from_heaps(shortest_path_weighted_via);
+    weighted_packed_paths.push_back(shortest_packed_path);
 
     const auto last_filtered = filterViaCandidatesByViaNotOnPath(
-        weighted_packed_paths[0], candidate_vias_first + 1, candidate_vias_last);
+        shortest_packed_path, candidate_vias_first + 1, candidate_vias_last);
 
-    // Store all alternative packed paths (if there are any).
-    auto into = std::back_inserter(weighted_packed_paths);
-    std::transform(begin(candidate_vias) + 1, last_filtered, into, extract_packed_path_from_heaps);
+    // Filter packed paths with heuristics. The candidates are ranked by weight, so the packed
+    // paths are only extracted from the heaps until enough of them passed the heuristics or the
+    // deadline passed. The paths that passed until then are unpacked.
 
-    // Filter packed paths with heuristics
+    const PackedPathLocalOptimality local_optimality(shortest_packed_path,
+                                                     forward_heap,  // paths for s, via
+                                                     reverse_heap); // paths for via, t
+    PackedPathCellSharing cell_sharing(shortest_packed_path, partition);
 
-    auto alternative_paths_last = end(weighted_packed_paths);
+    for (auto via = candidate_vias_first + 1; via != last_filtered; ++via)
+    {
+        if (weighted_packed_paths.size() == 1 + number_of_alternatives_to_unpack ||
+            deadline.Passed())
+            break;
 
-    alternative_paths_last = filterPackedPathsByLocalOptimality(weighted_packed_paths[0],
-                                                                forward_heap, // paths for s, via
-                                                                reverse_heap, // paths for via, t
-                                                                begin(weighted_packed_paths) + 1,
-                                                                alternative_paths_last);
+        auto packed_path = extract_packed_path_from_heaps(*via);
+        if (local_optimality.IsNotLocallyOptimal(packed_path) ||
+            cell_sharing.IsOverSharingLimit(packed_path))
+            continue;
 
-    alternative_paths_last = filterPackedPathsByCellSharing(
-        begin(weighted_packed_paths), alternative_paths_last, partition);
+        weighted_packed_paths.push_back(std::move(packed_path));
+    }
 
     BOOST_ASSERT(weighted_packed_paths.size() >= 1);
 
-    const auto number_of_filtered_alternative_paths = std::min(
-        static_cast<std::size_t>(max_number_of_alternatives_to_unpack),
-        static_cast<std::size_t>(alternative_paths_last - (begin(weighted_packed_paths) + 1)));
-
     const auto paths_first = begin(weighted_packed_paths);
-    const auto paths_last = begin(weighted_packed_paths) + 1 + number_of_filtered_alternative_paths;
+    const auto paths_last = end(weighted_packed_paths);
     const auto number_of_packed_paths = paths_last - paths_first;
 
     std::vector<WeightedViaNodeUnpackedPath> unpacked_paths;
@@ -806,7 +891,8 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &sear
                       std::back_inserter(unpacked_paths),
                       search_engine_data,
                       facade,
-                      phantom_node_pair);
+                      phantom_node_pair,
+                      parallel);
 
     //
     // Filter and rank a second time. This time instead of being fast and doing
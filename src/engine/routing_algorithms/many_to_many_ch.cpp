@@ -18,28 +18,9 @@ namespace routing_algorithms
 namespace ch
 {
 
-inline bool addLoopWeight(const DataFacade<ch::Algorithm> &facade,
-                          const NodeID node,
-                          EdgeWeight &weight,
-                          EdgeDuration &duration)
-{ // Special case for CH when contractor creates a loop edge node->node
-    BOOST_ASSERT(weight < 0);
-
-    const auto loop_weight = ch::getLoopWeight<false>(facade, node);
-    if (loop_weight != INVALID_EDGE_WEIGHT)
-    {
-        const auto new_weight_with_loop = weight + loop_weight;
-        if (new_weight_with_loop >= 0)
-        {
-            weight = new_weight_with_loop;
-            duration += ch::getLoopWeight<true>(facade, node);
-            return true;
-        }
-    }
-
-    // No loop found or adjusted weight is negative
-    return false;
-}
+// The settled nodes of the forward searches of square tables are kept until the buckets exist,
+// larger square tables scan them during the searches like other tables
+const constexpr std::size_t SQUARE_TABLE_MAX_LOCATIONS = 1024;
 
 template <bool DIRECTION>
 void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
@@ -84,53 +65,81 @@ void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
     }
 }
 
+// Updates the table row with the buckets of a node settled by the forward search
+void updateTableRow(const DataFacade<Algorithm> &facade,
+                    const unsigned row_idx,
+                    const unsigned number_of_targets,
+                    const NodeID node,
+                    const EdgeWeight source_weight,
+                    const EdgeDuration source_duration,
+                    const NodeBucketIndex &bucket_index,
+                    std::vector<EdgeWeight> &weights_table,
+                    std::vector<EdgeDuration> &durations_table)
+{
+    // Check if each encountered node has an entry
+    const auto buckets = bucket_index.Find(node);
+    if (buckets.empty())
+        return;
+
+    const auto has_negative_weights = minPlusRow(source_weight,
+                                                 source_duration,
+                                                 bucket_index.GetColumns() + buckets.begin,
+                                                 bucket_index.GetWeights() + buckets.begin,
+                                                 bucket_index.GetDurations() + buckets.begin,
+                                                 buckets.size(),
+                                                 row_idx * number_of_targets,
+                                                 1,
+                                                 weights_table,
+                                                 durations_table);
+
+    // Negative weights are only possible if source and target are on the same segment
+    for (auto position = buckets.begin; has_negative_weights && position != buckets.end;
+         ++position)
+    {
+        const auto column_idx = bucket_index.GetColumn(position);
+        auto new_weight = source_weight + bucket_index.GetWeight(position);
+        auto new_duration = source_duration + bucket_index.GetDuration(position);
+
+        if (new_weight < 0 && addLoopWeight(facade, node, new_weight, new_duration))
+        {
+            auto &current_weight = weights_table[row_idx * number_of_targets + column_idx];
+            auto &current_duration = durations_table[row_idx * number_of_targets + column_idx];
+            current_weight = std::min(current_weight, new_weight);
+            current_duration = std::min(current_duration, new_duration);
+        }
+    }
+}
+
 void forwardRoutingStep(const DataFacade<Algorithm> &facade,
                         const unsigned row_idx,
                         const unsigned number_of_targets,
                         typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
-                        const std::vector<NodeBucket> &search_space_with_buckets,
+                        const NodeBucketIndex &bucket_index,
                         std::vector<EdgeWeight> &weights_table,
                         std::vector<EdgeDuration> &durations_table,
-                        const PhantomNode &phantom_node)
+                        const PhantomNode &phantom_node,
+                        SearchSpace *search_space)
 {
     const auto node = query_heap.DeleteMin();
     const auto source_weight = query_heap.GetKey(node);
     const auto source_duration = query_heap.GetData(node).duration;
 
-    // Check if each encountered node has an entry
-    const auto &bucket_list = std::equal_range(search_space_with_buckets.begin(),
-                                               search_space_with_buckets.end(),
-                                               node,
-                                               NodeBucket::Compare());
-    for (const auto &current_bucket : boost::make_iterator_range(bucket_list))
+    if (search_space)
     {
-        // Get target id from bucket entry
-        const auto column_idx = current_bucket.column_index;
-        const auto target_weight = current_bucket.weight;
-        const auto target_duration = current_bucket.duration;
-
-        auto &current_weight = weights_table[row_idx * number_of_targets + column_idx];
-        auto &current_duration = durations_table[row_idx * number_of_targets + column_idx];
-
-        // Check if new weight is better
-        auto new_weight = source_weight + target_weight;
-        auto new_duration = source_duration + target_duration;
-
-        if (new_weight < 0)
-        {
-            if (addLoopWeight(facade, node, new_weight, new_duration))
-            {
-                current_weight = std::min(current_weight, new_weight);
-                current_duration = std::min(current_duration, new_duration);
-            }
-        }
-        else if (std::tie(new_weight, new_duration) < std::tie(current_weight, current_duration))
-        {
-            current_weight = new_weight;
-            current_duration = new_duration;
-        }
+        search_space->push_back(
+            {node, query_heap.GetData(node).parent, source_weight, source_duration});
     }
 
+    updateTableRow(facade,
+                   row_idx,
+                   number_of_targets,
+                   node,
+                   source_weight,
+                   source_duration,
+                   bucket_index,
+                   weights_table,
+                   durations_table);
+
     relaxOutgoingEdges<FORWARD_DIRECTION>(
         facade, node, source_weight, source_duration, query_heap, phantom_node);
 }
@@ -144,14 +153,129 @@ void backwardRoutingStep(const DataFacade<Algorithm> &facade,
     const auto node = query_heap.DeleteMin();
     const auto target_weight = query_heap.GetKey(node);
     const auto target_duration = query_heap.GetData(node).duration;
+    const auto parent = query_heap.GetData(node).parent;
 
     // Store settled nodes in search space bucket
-    search_space_with_buckets.emplace_back(node, column_idx, target_weight, target_duration);
+    search_space_with_buckets.emplace_back(
+        node, parent, column_idx, target_weight, target_duration);
 
     relaxOutgoingEdges<REVERSE_DIRECTION>(
         facade, node, target_weight, target_duration, query_heap, phantom_node);
 }
 
+// Trace the forward search space from middle back to the source node
+void retrievePackedPathFromHeap(
+    const typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
+    const NodeID middle_node,
+    std::vector<NodeID> &packed_path)
+{
+    NodeID current_node = middle_node;
+    packed_path.push_back(current_node);
+    while (current_node != query_heap.GetData(current_node).parent)
+    {
+        current_node = query_heap.GetData(current_node).parent;
+        packed_path.push_back(current_node);
+    }
+    std::reverse(packed_path.begin(), packed_path.end());
+}
+
+// Trace the backward search space of column_idx from middle to the target node
+void retrievePackedPathFromSearchSpace(const NodeID middle_node,
+                                       const unsigned column_idx,
+                                       const std::vector<NodeBucket> &search_space_with_buckets,
+                                       std::vector<NodeID> &packed_path)
+{
+    NodeID current_node = middle_node;
+    while (true)
+    {
+        const auto bucket = std::lower_bound(search_space_with_buckets.begin(),
+                                             search_space_with_buckets.end(),
+                                             current_node,
+                                             NodeBucket::ColumnCompare(column_idx));
+        BOOST_ASSERT(bucket != search_space_with_buckets.end());
+        BOOST_ASSERT(bucket->middle_node == current_node && bucket->column_index == column_idx);
+
+        if (bucket->parent_node == current_node)
+            break;
+
+        current_node = bucket->parent_node;
+        packed_path.push_back(current_node);
+    }
+}
+
+// Square tables search from and to the same locations, e.g. the tables of trips. The forward
+// and the backward search of a location are still different searches, but they run in one pass
+// over the locations on the same thread and heap. The settled nodes of the forward searches are
+// kept and only scanned against the buckets once all of them exist, so the scans don't run
+// between heap operations.
+std::vector<EdgeDuration> squareManyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                                                 const DataFacade<Algorithm> &facade,
+                                                 const std::vector<PhantomNode> &phantom_nodes,
+                                                 const std::vector<std::size_t> &indices,
+                                                 const bool parallel)
+{
+    const auto number_of_locations = indices.size();
+    const auto number_of_entries = number_of_locations * number_of_locations;
+
+    std::vector<EdgeWeight> weights_table(number_of_entries, INVALID_EDGE_WEIGHT);
+    std::vector<EdgeDuration> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
+
+    // the forward steps only record their settled nodes while there are no buckets yet
+    const NodeBucketIndex no_buckets;
+    std::vector<SearchSpace> row_search_spaces(number_of_locations);
+
+    const NodeBucketIndex bucket_index(computeSearchSpaceWithBuckets(
+        number_of_locations,
+        parallel,
+        [&](const std::uint32_t idx, std::vector<NodeBucket> &buckets) {
+            const auto &phantom = phantom_nodes[indices[idx]];
+
+            engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
+                facade.GetNumberOfNodes());
+            auto &query_heap = *(engine_working_data.many_to_many_heap);
+            insertTargetInHeap(query_heap, phantom);
+            while (!query_heap.Empty())
+            {
+                checkCancellation();
+                backwardRoutingStep(facade, idx, query_heap, buckets, phantom);
+            }
+
+            query_heap.Clear();
+            insertSourceInHeap(query_heap, phantom);
+            while (!query_heap.Empty())
+            {
+                checkCancellation();
+                forwardRoutingStep(facade,
+                                   idx,
+                                   number_of_locations,
+                                   query_heap,
+                                   no_buckets,
+                                   weights_table,
+                                   durations_table,
+                                   phantom,
+                                   &row_search_spaces[idx]);
+            }
+        }));
+
+    forEachSourceRow(number_of_locations, parallel, [&](const std::uint32_t row_idx) {
+        for (const auto &settled : row_search_spaces[row_idx])
+        {
+            updateTableRow(facade,
+                           row_idx,
+                           number_of_locations,
+                           settled.node,
+                           settled.weight,
+                           settled.duration,
+                           bucket_index,
+                           weights_table,
+                           durations_table);
+        }
+        SearchSpace().swap(row_search_spaces[row_idx]);
+    });
+
+    return durations_table;
+}
+
 } // namespace ch
 
 template <>
@@ -159,8 +283,18 @@ std::vector<EdgeDuration> manyToManySearch(SearchEngineData<ch::Algorithm> &engi
                                            const DataFacade<ch::Algorithm> &facade,
                                            const std::vector<PhantomNode> &phantom_nodes,
                                            const std::vector<std::size_t> &source_indices,
-                                           const std::vector<std::size_t> &target_indices)
+                                           const std::vector<std::size_t> &target_indices,
+                                           const bool parallel,
+                                           SearchSpaceCache *search_space_cache)
 {
+    // the cache replays search spaces per search, it is not used for square tables
+    if (search_space_cache == nullptr && source_indices == target_indices &&
+        source_indices.size() <= ch::SQUARE_TABLE_MAX_LOCATIONS)
+    {
+        return ch::squareManyToManySearch(
+            engine_working_data, facade, phantom_nodes, source_indices, parallel);
+    }
+
     const auto number_of_sources = source_indices.size();
     const auto number_of_targets = target_indices.size();
     const auto number_of_entries = number_of_sources * number_of_targets;
@@ -168,56 +302,242 @@ std::vector<EdgeDuration> manyToManySearch(SearchEngineData<ch::Algorithm> &engi
     std::vector<EdgeWeight> weights_table(number_of_entries, INVALID_EDGE_WEIGHT);
     std::vector<EdgeDuration> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
 
-    std::vector<NodeBucket> search_space_with_buckets;
-
     // Populate buckets with paths from all accessible nodes to destinations via backward searches
-    for (std::uint32_t column_idx = 0; column_idx < target_indices.size(); ++column_idx)
-    {
-        const auto index = target_indices[column_idx];
+    const NodeBucketIndex bucket_index(computeSearchSpaceWithBuckets(
+        number_of_targets,
+        parallel,
+        [&](const std::uint32_t column_idx, std::vector<NodeBucket> &buckets) {
+            const auto index = target_indices[column_idx];
+            const auto &phantom = phantom_nodes[index];
+
+            const auto first_bucket = buckets.size();
+            cachedSearch(
+                search_space_cache,
+                facade.GetFacadeID(),
+                SearchSpaceType::TargetBuckets,
+                phantom,
+                [&](SearchSpace *search_space) {
+                    engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
+                        facade.GetNumberOfNodes());
+                    auto &query_heap = *(engine_working_data.many_to_many_heap);
+                    insertTargetInHeap(query_heap, phantom);
+
+                    // Explore search space
+                    while (!query_heap.Empty())
+                    {
+                        checkCancellation();
+                        backwardRoutingStep(facade, column_idx, query_heap, buckets, phantom);
+                    }
+
+                    if (search_space)
+                    {
+                        for (auto bucket = buckets.begin() + first_bucket; bucket != buckets.end();
+                             ++bucket)
+                        {
+                            search_space->push_back({bucket->middle_node,
+                                                     bucket->parent_node,
+                                                     bucket->weight,
+                                                     bucket->duration});
+                        }
+                    }
+                },
+                [&](const SettledNode &settled) {
+                    buckets.emplace_back(settled.node,
+                                         settled.parent,
+                                         column_idx,
+                                         settled.weight,
+                                         settled.duration);
+                });
+        }));
+
+    // Find shortest paths from sources to all accessible nodes
+    forEachSourceRow(number_of_sources, parallel, [&](const std::uint32_t row_idx) {
+        const auto index = source_indices[row_idx];
         const auto &phantom = phantom_nodes[index];
 
-        engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
-            facade.GetNumberOfNodes());
-        auto &query_heap = *(engine_working_data.many_to_many_heap);
-        insertTargetInHeap(query_heap, phantom);
+        cachedSearch(
+            search_space_cache,
+            facade.GetFacadeID(),
+            SearchSpaceType::SourceRow,
+            phantom,
+            [&](SearchSpace *search_space) {
+                // Clear heap and insert source nodes
+                engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
+                    facade.GetNumberOfNodes());
+                auto &query_heap = *(engine_working_data.many_to_many_heap);
+                insertSourceInHeap(query_heap, phantom);
+
+                // Explore search space
+                while (!query_heap.Empty())
+                {
+                    checkCancellation();
+                    forwardRoutingStep(facade,
+                                       row_idx,
+                                       number_of_targets,
+                                       query_heap,
+                                       bucket_index,
+                                       weights_table,
+                                       durations_table,
+                                       phantom,
+                                       search_space);
+                }
+            },
+            [&](const SettledNode &settled) {
+                updateTableRow(facade,
+                               row_idx,
+                               number_of_targets,
+                               settled.node,
+                               settled.weight,
+                               settled.duration,
+                               bucket_index,
+                               weights_table,
+                               durations_table);
+            });
+    });
 
-        // Explore search space
-        while (!query_heap.Empty())
-        {
-            backwardRoutingStep(facade, column_idx, query_heap, search_space_with_buckets, phantom);
-        }
-    }
+    return durations_table;
+}
 
-    // Order lookup buckets
-    std::sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+template <>
+std::vector<double> getNetworkDistances(SearchEngineData<ch::Algorithm> &engine_working_data,
+                                        const DataFacade<ch::Algorithm> &facade,
+                                        const std::vector<PhantomNode> &phantom_nodes,
+                                        const std::vector<std::size_t> &source_indices,
+                                        const std::vector<std::size_t> &target_indices,
+                                        const EdgeWeight weight_upper_bound,
+                                        const bool parallel)
+{
+    const auto number_of_sources = source_indices.size();
+    const auto number_of_targets = target_indices.size();
 
-    // Find shortest paths from sources to all accessible nodes
-    for (std::uint32_t row_idx = 0; row_idx < source_indices.size(); ++row_idx)
+    std::vector<double> distances_table(number_of_sources * number_of_targets,
+                                        std::numeric_limits<double>::max());
+    if (distances_table.empty())
+        return distances_table;
+
+    // Forward search keys start with negative source offsets, so the backward searches
+    // have to be explored beyond the weight upper bound by the largest source offset
+    EdgeWeight max_source_offset = 0;
+    for (const auto index : source_indices)
     {
-        const auto index = source_indices[row_idx];
         const auto &phantom = phantom_nodes[index];
+        if (phantom.IsValidForwardSource())
+            max_source_offset = std::max(max_source_offset, phantom.GetForwardWeightPlusOffset());
+        if (phantom.IsValidReverseSource())
+            max_source_offset = std::max(max_source_offset, phantom.GetReverseWeightPlusOffset());
+    }
+    const EdgeWeight backward_upper_bound =
+        weight_upper_bound == INVALID_EDGE_WEIGHT ? INVALID_EDGE_WEIGHT
+                                                  : weight_upper_bound + max_source_offset;
+
+    // Populate buckets with paths from all accessible nodes to destinations via backward searches,
+    // ordered by (middle_node, column_index) for the lookups and the path retrieval
+    const auto search_space_with_buckets = computeSearchSpaceWithBuckets(
+        number_of_targets,
+        parallel,
+        [&](const std::uint32_t column_idx, std::vector<NodeBucket> &buckets) {
+            const auto &phantom = phantom_nodes[target_indices[column_idx]];
+
+            engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
+                facade.GetNumberOfNodes());
+            auto &query_heap = *(engine_working_data.many_to_many_heap);
+            insertTargetInHeap(query_heap, phantom);
+
+            while (!query_heap.Empty() && query_heap.MinKey() < backward_upper_bound)
+            {
+                checkCancellation();
+                ch::backwardRoutingStep(facade, column_idx, query_heap, buckets, phantom);
+            }
+        });
+
+    // One forward search per source against the buckets of all targets
+    forEachSourceRow(number_of_sources, parallel, [&](const std::uint32_t row_idx) {
+        const auto &source_phantom = phantom_nodes[source_indices[row_idx]];
+
+        std::vector<EdgeWeight> weights(number_of_targets, weight_upper_bound);
+        std::vector<NodeID> middle_nodes(number_of_targets, SPECIAL_NODEID);
+        std::vector<bool> loop_paths(number_of_targets, false);
+        std::vector<NodeID> packed_path;
+        std::vector<PathData> unpacked_path;
 
-        // Clear heap and insert source nodes
         engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
             facade.GetNumberOfNodes());
         auto &query_heap = *(engine_working_data.many_to_many_heap);
-        insertSourceInHeap(query_heap, phantom);
+        insertSourceInHeap(query_heap, source_phantom);
 
-        // Explore search space
-        while (!query_heap.Empty())
+        while (!query_heap.Empty() && query_heap.MinKey() < weight_upper_bound)
         {
-            forwardRoutingStep(facade,
-                               row_idx,
-                               number_of_targets,
-                               query_heap,
-                               search_space_with_buckets,
-                               weights_table,
-                               durations_table,
-                               phantom);
+            checkCancellation();
+            const auto node = query_heap.DeleteMin();
+            const auto source_weight = query_heap.GetKey(node);
+            const auto source_duration = query_heap.GetData(node).duration;
+
+            const auto &bucket_list = std::equal_range(search_space_with_buckets.begin(),
+                                                       search_space_with_buckets.end(),
+                                                       node,
+                                                       NodeBucket::Compare());
+            for (const auto &current_bucket : boost::make_iterator_range(bucket_list))
+            {
+                const auto column_idx = current_bucket.column_index;
+                auto new_weight = source_weight + current_bucket.weight;
+                auto new_duration = source_duration + current_bucket.duration;
+
+                bool is_loop = false;
+                if (new_weight < 0)
+                {
+                    if (!ch::addLoopWeight(facade, node, new_weight, new_duration))
+                        continue;
+                    is_loop = true;
+                }
+
+                if (new_weight < weights[column_idx])
+                {
+                    weights[column_idx] = new_weight;
+                    middle_nodes[column_idx] = node;
+                    loop_paths[column_idx] = is_loop;
+                }
+            }
+
+            ch::relaxOutgoingEdges<FORWARD_DIRECTION>(
+                facade, node, source_weight, source_duration, query_heap, source_phantom);
         }
-    }
 
-    return durations_table;
+        // Unpack all found paths while the forward search space is still available
+        for (std::uint32_t column_idx = 0; column_idx < number_of_targets; ++column_idx)
+        {
+            const auto middle_node = middle_nodes[column_idx];
+            if (middle_node == SPECIAL_NODEID)
+                continue;
+
+            packed_path.clear();
+            if (loop_paths[column_idx])
+            {
+                // self loop makes up the full path
+                packed_path.push_back(middle_node);
+                packed_path.push_back(middle_node);
+            }
+            else
+            {
+                ch::retrievePackedPathFromHeap(query_heap, middle_node, packed_path);
+                ch::retrievePackedPathFromSearchSpace(
+                    middle_node, column_idx, search_space_with_buckets, packed_path);
+            }
+
+            const auto &target_phantom = phantom_nodes[target_indices[column_idx]];
+
+            unpacked_path.clear();
+            ch::unpackPath(facade,
+                           packed_path.begin(),
+                           packed_path.end(),
+                           {source_phantom, target_phantom},
+                           unpacked_path);
+
+            distances_table[row_idx * number_of_targets + column_idx] =
+                getPathDistance(facade, unpacked_path, source_phantom, target_phantom);
+        }
+    });
+
+    return distances_table;
 }
 
 } // namespace routing_algorithms
@@ -0,0 +1,211 @@
+#include "engine/routing_algorithms/many_to_many.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OSRM_MIN_PLUS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+namespace
+{
+using MinPlusKernel = bool (*)(const EdgeWeight,
+                               const EdgeDuration,
+                               const unsigned *,
+                               const EdgeWeight *,
+                               const EdgeDuration *,
+                               const std::size_t,
+                               const std::size_t,
+                               const std::size_t,
+                               EdgeWeight *,
+                               EdgeDuration *);
+
+inline bool minPlusUpdate(const EdgeWeight source_weight,
+                          const EdgeDuration source_duration,
+                          const EdgeWeight target_weight,
+                          const EdgeDuration target_duration,
+                          EdgeWeight &current_weight,
+                          EdgeDuration &current_duration)
+{
+    const auto new_weight = source_weight + target_weight;
+    const auto new_duration = source_duration + target_duration;
+
+    if (new_weight < 0)
+        return true;
+
+    if (std::tie(new_weight, new_duration) < std::tie(current_weight, current_duration))
+    {
+        current_weight = new_weight;
+        current_duration = new_duration;
+    }
+    return false;
+}
+
+bool minPlusRowScalar(const EdgeWeight source_weight,
+                      const EdgeDuration source_duration,
+                      const unsigned *columns,
+                      const EdgeWeight *weights,
+                      const EdgeDuration *durations,
+                      const std::size_t size,
+                      const std::size_t offset,
+                      const std::size_t stride,
+                      EdgeWeight *weights_table,
+                      EdgeDuration *durations_table)
+{
+    bool has_negative_weights = false;
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        const auto location = offset + columns[index] * stride;
+        has_negative_weights |= minPlusUpdate(source_weight,
+                                              source_duration,
+                                              weights[index],
+                                              durations[index],
+                                              weights_table[location],
+                                              durations_table[location]);
+    }
+    return has_negative_weights;
+}
+
+#ifdef OSRM_MIN_PLUS_AVX2
+// Computes eight candidates at once and gathers the current table entries, only the improved
+// entries are written back as AVX2 has no scatter. Columns of one run are unique, so the
+// written locations never collide.
+__attribute__((target("avx2"))) bool minPlusRowAVX2(const EdgeWeight source_weight,
+                                                    const EdgeDuration source_duration,
+                                                    const unsigned *columns,
+                                                    const EdgeWeight *weights,
+                                                    const EdgeDuration *durations,
+                                                    const std::size_t size,
+                                                    const std::size_t offset,
+                                                    const std::size_t stride,
+                                                    EdgeWeight *weights_table,
+                                                    EdgeDuration *durations_table)
+{
+    const auto source_weights = _mm256_set1_epi32(source_weight);
+    const auto source_durations = _mm256_set1_epi32(source_duration);
+    const auto offsets = _mm256_set1_epi32(static_cast<std::int32_t>(offset));
+    const auto strides = _mm256_set1_epi32(static_cast<std::int32_t>(stride));
+    const auto zeros = _mm256_setzero_si256();
+
+    bool has_negative_weights = false;
+    std::size_t index = 0;
+    for (; index + 8 <= size; index += 8)
+    {
+        const auto column_vector =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(columns + index));
+        const auto locations =
+            _mm256_add_epi32(offsets, _mm256_mullo_epi32(column_vector, strides));
+
+        const auto new_weights = _mm256_add_epi32(
+            source_weights,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + index)));
+        const auto new_durations = _mm256_add_epi32(
+            source_durations,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(durations + index)));
+
+        const auto current_weights = _mm256_i32gather_epi32(weights_table, locations, 4);
+        const auto current_durations = _mm256_i32gather_epi32(durations_table, locations, 4);
+
+        // (new_weight, new_duration) < (current_weight, current_duration) for new_weight >= 0
+        const auto negative = _mm256_cmpgt_epi32(zeros, new_weights);
+        const auto smaller_weight = _mm256_cmpgt_epi32(current_weights, new_weights);
+        const auto equal_weight = _mm256_cmpeq_epi32(current_weights, new_weights);
+        const auto smaller_duration = _mm256_cmpgt_epi32(current_durations, new_durations);
+        const auto improved = _mm256_andnot_si256(
+            negative,
+            _mm256_or_si256(smaller_weight, _mm256_and_si256(equal_weight, smaller_duration)));
+
+        has_negative_weights |= _mm256_movemask_ps(_mm256_castsi256_ps(negative)) != 0;
+
+        auto improved_mask = _mm256_movemask_ps(_mm256_castsi256_ps(improved));
+        if (improved_mask == 0)
+            continue;
+
+        alignas(32) std::int32_t new_weights_lanes[8];
+        alignas(32) std::int32_t new_durations_lanes[8];
+        alignas(32) std::int32_t locations_lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(new_weights_lanes), new_weights);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(new_durations_lanes), new_durations);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(locations_lanes), locations);
+        while (improved_mask != 0)
+        {
+            const auto lane = __builtin_ctz(improved_mask);
+            weights_table[locations_lanes[lane]] = new_weights_lanes[lane];
+            durations_table[locations_lanes[lane]] = new_durations_lanes[lane];
+            improved_mask &= improved_mask - 1;
+        }
+    }
+
+    return minPlusRowScalar(source_weight,
+                            source_duration,
+                            columns + index,
+                            weights + index,
+                            durations + index,
+                            size - index,
+                            offset,
+                            stride,
+                            weights_table,
+                            durations_table) ||
+           has_negative_weights;
+}
+#endif
+
+MinPlusKernel selectMinPlusKernel()
+{
+#ifdef OSRM_MIN_PLUS_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return minPlusRowAVX2;
+#endif
+    return minPlusRowScalar;
+}
+}
+
+bool minPlusRow(const EdgeWeight source_weight,
+                const EdgeDuration source_duration,
+                const unsigned *columns,
+                const EdgeWeight *weights,
+                const EdgeDuration *durations,
+                const std::size_t size,
+                const std::size_t offset,
+                const std::size_t stride,
+                std::vector<EdgeWeight> &weights_table,
+                std::vector<EdgeDuration> &durations_table)
+{
+    BOOST_ASSERT(weights_table.size() == durations_table.size());
+
+    static const MinPlusKernel min_plus_kernel = selectMinPlusKernel();
+
+    // gather indices are signed 32 bit integers
+    const auto kernel =
+        weights_table.size() <= static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())
+            ? min_plus_kernel
+            : minPlusRowScalar;
+
+    return kernel(source_weight,
+                  source_duration,
+                  columns,
+                  weights,
+                  durations,
+                  size,
+                  offset,
+                  stride,
+                  weights_table.data(),
+                  durations_table.data());
+}
+
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
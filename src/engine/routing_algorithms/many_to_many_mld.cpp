@@ -1,12 +1,15 @@
 #include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/routing_algorithms/routing_base_mld.hpp"
 
 #include <boost/assert.hpp>
-#include <boost/range/iterator_range_core.hpp>
 
+#include <algorithm>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -50,36 +53,72 @@ inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
     return node_level;
 }
 
-template <typename MultiLevelPartition>
-inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
-                                 NodeID node,
-                                 const std::vector<PhantomNode> &phantom_nodes,
-                                 const std::size_t phantom_index,
-                                 const std::vector<std::size_t> &phantom_indices)
+// Cells of the segments of the phantom nodes of a 1-to-N or N-to-1 request on all levels.
+// Built once per request, so the query level of a settled node doesn't depend on the
+// number of targets.
+class PhantomCellIndex
 {
-    auto min_level = [&partition, node](const PhantomNode &phantom_node) {
+  public:
+    template <typename MultiLevelPartition>
+    PhantomCellIndex(const MultiLevelPartition &partition,
+                     const std::vector<PhantomNode> &phantom_nodes,
+                     const std::size_t phantom_index,
+                     const std::vector<std::size_t> &phantom_indices)
+        : level_cells(partition.GetNumberOfLevels()), has_segments(false)
+    {
+        const auto add_segment = [this, &partition](const SegmentID &segment) {
+            if (!segment.enabled)
+                return;
+            has_segments = true;
+            for (LevelID level = 1; level < level_cells.size(); ++level)
+                level_cells[level].push_back(partition.GetCell(level, segment.id));
+        };
+        const auto add_phantom = [&add_segment](const PhantomNode &phantom_node) {
+            add_segment(phantom_node.forward_segment_id);
+            add_segment(phantom_node.reverse_segment_id);
+        };
+
+        add_phantom(phantom_nodes[phantom_index]);
+        for (const auto index : phantom_indices)
+            add_phantom(phantom_nodes[index]);
+
+        for (auto &cells : level_cells)
+        {
+            std::sort(cells.begin(), cells.end());
+            cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+        }
+    }
 
-        const auto &forward_segment = phantom_node.forward_segment_id;
-        const auto forward_level =
-            forward_segment.enabled ? partition.GetHighestDifferentLevel(node, forward_segment.id)
-                                    : INVALID_LEVEL_ID;
+    // Returns the minimum over all phantom segments of the highest level on which the cells of
+    // the segment and the node differ. Cells are nested, so this is one below the lowest level
+    // on which the cell of the node contains a phantom segment.
+    template <typename MultiLevelPartition>
+    LevelID GetQueryLevel(const MultiLevelPartition &partition, const NodeID node) const
+    {
+        if (!has_segments)
+            return INVALID_LEVEL_ID;
 
-        const auto &reverse_segment = phantom_node.reverse_segment_id;
-        const auto reverse_level =
-            reverse_segment.enabled ? partition.GetHighestDifferentLevel(node, reverse_segment.id)
-                                    : INVALID_LEVEL_ID;
+        for (LevelID level = 1; level < level_cells.size(); ++level)
+        {
+            const auto &cells = level_cells[level];
+            if (std::binary_search(cells.begin(), cells.end(), partition.GetCell(level, node)))
+                return level - 1;
+        }
+        return level_cells.size() - 1;
+    }
 
-        return std::min(forward_level, reverse_level);
-    };
+  private:
+    std::vector<std::vector<CellID>> level_cells;
+    bool has_segments;
+};
 
-    // Get minimum level over all phantoms of the highest different level with respect to node
+template <typename MultiLevelPartition>
+inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
+                                 NodeID node,
+                                 const PhantomCellIndex &phantom_cells)
+{
     // This is equivalent to min_{∀ source, target} partition.GetQueryLevel(source, node, target)
-    auto result = min_level(phantom_nodes[phantom_index]);
-    for (const auto &index : phantom_indices)
-    {
-        result = std::min(result, min_level(phantom_nodes[index]));
-    }
-    return result;
+    return phantom_cells.GetQueryLevel(partition, node);
 }
 
 template <bool DIRECTION, typename... Args>
@@ -106,6 +145,7 @@ void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
 
     if (level >= 1 && !node_data.from_clique_arc)
     {
+        OSRM_COUNT_SEARCH(EnterCell(level));
         const auto &cell = cells.GetCell(metric, level, partition.GetCell(level, node));
         if (DIRECTION == FORWARD_DIRECTION)
         { // Shortcuts in forward direction
@@ -257,6 +297,9 @@ std::vector<EdgeDuration> oneToManySearch(SearchEngineData<Algorithm> &engine_wo
         }
     }
 
+    const PhantomCellIndex phantom_cells(
+        facade.GetMultiLevelPartition(), phantom_nodes, phantom_index, phantom_indices);
+
     // Initialize query heap
     engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(facade.GetNumberOfNodes());
     auto &query_heap = *(engine_working_data.many_to_many_heap);
@@ -344,6 +387,7 @@ std::vector<EdgeDuration> oneToManySearch(SearchEngineData<Algorithm> &engine_wo
 
     while (!query_heap.Empty() && !target_nodes_index.empty())
     {
+        checkCancellation();
         // Extract node from the heap
         const auto node = query_heap.DeleteMin();
         const auto weight = query_heap.GetKey(node);
@@ -358,9 +402,7 @@ std::vector<EdgeDuration> oneToManySearch(SearchEngineData<Algorithm> &engine_wo
                                       weight,
                                       duration,
                                       query_heap,
-                                      phantom_nodes,
-                                      phantom_index,
-                                      phantom_indices);
+                                      phantom_cells);
     }
 
     return durations;
@@ -369,54 +411,69 @@ std::vector<EdgeDuration> oneToManySearch(SearchEngineData<Algorithm> &engine_wo
 //
 // Bidirectional multi-layer Dijkstra search for M-to-N matrices
 //
+// Updates the results tables with the buckets of a node settled by the forward search:
+//  * row-major direct (row_idx, column_idx) index for forward direction
+//  * row-major transposed (column_idx, row_idx) for reversed direction
+template <bool DIRECTION>
+void updateTableRow(const unsigned row_idx,
+                    const unsigned number_of_sources,
+                    const unsigned number_of_targets,
+                    const NodeID node,
+                    const EdgeWeight source_weight,
+                    const EdgeDuration source_duration,
+                    const NodeBucketIndex &bucket_index,
+                    std::vector<EdgeWeight> &weights_table,
+                    std::vector<EdgeDuration> &durations_table)
+{
+    // Check if each encountered node has an entry and update the values in the results tables
+    const auto buckets = bucket_index.Find(node);
+    if (!buckets.empty())
+    {
+        minPlusRow(source_weight,
+                   source_duration,
+                   bucket_index.GetColumns() + buckets.begin,
+                   bucket_index.GetWeights() + buckets.begin,
+                   bucket_index.GetDurations() + buckets.begin,
+                   buckets.size(),
+                   DIRECTION == FORWARD_DIRECTION ? row_idx * number_of_targets : row_idx,
+                   DIRECTION == FORWARD_DIRECTION ? 1 : number_of_sources,
+                   weights_table,
+                   durations_table);
+    }
+}
+
 template <bool DIRECTION>
 void forwardRoutingStep(const DataFacade<Algorithm> &facade,
                         const unsigned row_idx,
                         const unsigned number_of_sources,
                         const unsigned number_of_targets,
                         typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
-                        const std::vector<NodeBucket> &search_space_with_buckets,
+                        const NodeBucketIndex &bucket_index,
                         std::vector<EdgeWeight> &weights_table,
                         std::vector<EdgeDuration> &durations_table,
-                        const PhantomNode &phantom_node)
+                        const PhantomNode &phantom_node,
+                        SearchSpace *search_space)
 {
     const auto node = query_heap.DeleteMin();
     const auto source_weight = query_heap.GetKey(node);
     const auto source_duration = query_heap.GetData(node).duration;
 
-    // Check if each encountered node has an entry
-    const auto &bucket_list = std::equal_range(search_space_with_buckets.begin(),
-                                               search_space_with_buckets.end(),
-                                               node,
-                                               NodeBucket::Compare());
-    for (const auto &current_bucket : boost::make_iterator_range(bucket_list))
+    if (search_space)
     {
-        // Get target id from bucket entry
-        const auto column_idx = current_bucket.column_index;
-        const auto target_weight = current_bucket.weight;
-        const auto target_duration = current_bucket.duration;
-
-        // Get the value location in the results tables:
-        //  * row-major direct (row_idx, column_idx) index for forward direction
-        //  * row-major transposed (column_idx, row_idx) for reversed direction
-        const auto location = DIRECTION == FORWARD_DIRECTION
-                                  ? row_idx * number_of_targets + column_idx
-                                  : row_idx + column_idx * number_of_sources;
-        auto &current_weight = weights_table[location];
-        auto &current_duration = durations_table[location];
-
-        // Check if new weight is better
-        auto new_weight = source_weight + target_weight;
-        auto new_duration = source_duration + target_duration;
-
-        if (new_weight >= 0 &&
-            std::tie(new_weight, new_duration) < std::tie(current_weight, current_duration))
-        {
-            current_weight = new_weight;
-            current_duration = new_duration;
-        }
+        search_space->push_back(
+            {node, query_heap.GetData(node).parent, source_weight, source_duration});
     }
 
+    updateTableRow<DIRECTION>(row_idx,
+                              number_of_sources,
+                              number_of_targets,
+                              node,
+                              source_weight,
+                              source_duration,
+                              bucket_index,
+                              weights_table,
+                              durations_table);
+
     relaxOutgoingEdges<DIRECTION>(
         facade, node, source_weight, source_duration, query_heap, phantom_node);
 }
@@ -431,9 +488,11 @@ void backwardRoutingStep(const DataFacade<Algorithm> &facade,
     const auto node = query_heap.DeleteMin();
     const auto target_weight = query_heap.GetKey(node);
     const auto target_duration = query_heap.GetData(node).duration;
+    const auto parent = query_heap.GetData(node).parent;
 
     // Store settled nodes in search space bucket
-    search_space_with_buckets.emplace_back(node, column_idx, target_weight, target_duration);
+    search_space_with_buckets.emplace_back(
+        node, parent, column_idx, target_weight, target_duration);
 
     const auto &partition = facade.GetMultiLevelPartition();
     const auto maximal_level = partition.GetNumberOfLevels() - 1;
@@ -447,7 +506,9 @@ std::vector<EdgeDuration> manyToManySearch(SearchEngineData<Algorithm> &engine_w
                                            const DataFacade<Algorithm> &facade,
                                            const std::vector<PhantomNode> &phantom_nodes,
                                            const std::vector<std::size_t> &source_indices,
-                                           const std::vector<std::size_t> &target_indices)
+                                           const std::vector<std::size_t> &target_indices,
+                                           const bool parallel,
+                                           SearchSpaceCache *search_space_cache)
 {
     const auto number_of_sources = source_indices.size();
     const auto number_of_targets = target_indices.size();
@@ -456,66 +517,322 @@ std::vector<EdgeDuration> manyToManySearch(SearchEngineData<Algorithm> &engine_w
     std::vector<EdgeWeight> weights_table(number_of_entries, INVALID_EDGE_WEIGHT);
     std::vector<EdgeDuration> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
 
-    std::vector<NodeBucket> search_space_with_buckets;
+    // the phantom nodes swap their roles for the transposed search
+    const auto bucket_search_type = DIRECTION == FORWARD_DIRECTION
+                                        ? SearchSpaceType::TargetBuckets
+                                        : SearchSpaceType::SourceBuckets;
+    const auto row_search_type =
+        DIRECTION == FORWARD_DIRECTION ? SearchSpaceType::SourceRow : SearchSpaceType::TargetRow;
 
     // Populate buckets with paths from all accessible nodes to destinations via backward searches
-    for (std::uint32_t column_idx = 0; column_idx < target_indices.size(); ++column_idx)
-    {
-        const auto index = target_indices[column_idx];
+    const NodeBucketIndex bucket_index(computeSearchSpaceWithBuckets(
+        number_of_targets,
+        parallel,
+        [&](const std::uint32_t column_idx, std::vector<NodeBucket> &buckets) {
+            const auto index = target_indices[column_idx];
+            const auto &phantom = phantom_nodes[index];
+
+            const auto first_bucket = buckets.size();
+            cachedSearch(
+                search_space_cache,
+                facade.GetFacadeID(),
+                bucket_search_type,
+                phantom,
+                [&](SearchSpace *search_space) {
+                    engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
+                        facade.GetNumberOfNodes());
+                    auto &query_heap = *(engine_working_data.many_to_many_heap);
+
+                    if (DIRECTION == FORWARD_DIRECTION)
+                        insertTargetInHeap(query_heap, phantom);
+                    else
+                        insertSourceInHeap(query_heap, phantom);
+
+                    // explore search space
+                    while (!query_heap.Empty())
+                    {
+                        checkCancellation();
+                        backwardRoutingStep<DIRECTION>(
+                            facade, column_idx, query_heap, buckets, phantom);
+                    }
+
+                    if (search_space)
+                    {
+                        for (auto bucket = buckets.begin() + first_bucket; bucket != buckets.end();
+                             ++bucket)
+                        {
+                            search_space->push_back({bucket->middle_node,
+                                                     bucket->parent_node,
+                                                     bucket->weight,
+                                                     bucket->duration});
+                        }
+                    }
+                },
+                [&](const SettledNode &settled) {
+                    buckets.emplace_back(settled.node,
+                                         settled.parent,
+                                         column_idx,
+                                         settled.weight,
+                                         settled.duration);
+                });
+        }));
+
+    // Find shortest paths from sources to all accessible nodes
+    forEachSourceRow(number_of_sources, parallel, [&](const std::uint32_t row_idx) {
+        const auto index = source_indices[row_idx];
         const auto &phantom = phantom_nodes[index];
 
-        engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
-            facade.GetNumberOfNodes());
-        auto &query_heap = *(engine_working_data.many_to_many_heap);
+        cachedSearch(
+            search_space_cache,
+            facade.GetFacadeID(),
+            row_search_type,
+            phantom,
+            [&](SearchSpace *search_space) {
+                // Clear heap and insert source nodes
+                engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
+                    facade.GetNumberOfNodes());
+                auto &query_heap = *(engine_working_data.many_to_many_heap);
+
+                if (DIRECTION == FORWARD_DIRECTION)
+                    insertSourceInHeap(query_heap, phantom);
+                else
+                    insertTargetInHeap(query_heap, phantom);
+
+                // Explore search space
+                while (!query_heap.Empty())
+                {
+                    checkCancellation();
+                    forwardRoutingStep<DIRECTION>(facade,
+                                                  row_idx,
+                                                  number_of_sources,
+                                                  number_of_targets,
+                                                  query_heap,
+                                                  bucket_index,
+                                                  weights_table,
+                                                  durations_table,
+                                                  phantom,
+                                                  search_space);
+                }
+            },
+            [&](const SettledNode &settled) {
+                updateTableRow<DIRECTION>(row_idx,
+                                          number_of_sources,
+                                          number_of_targets,
+                                          settled.node,
+                                          settled.weight,
+                                          settled.duration,
+                                          bucket_index,
+                                          weights_table,
+                                          durations_table);
+            });
+    });
 
-        if (DIRECTION == FORWARD_DIRECTION)
-            insertTargetInHeap(query_heap, phantom);
-        else
-            insertSourceInHeap(query_heap, phantom);
+    return durations_table;
+}
+
+//
+// Unidirectional multi-layer Dijkstra search for the network distances of a 1-to-N matrix.
+// Overlay paths are unpacked with restricted searches inside the cell of the clique arc.
+//
+void oneToManyDistances(SearchEngineData<Algorithm> &engine_working_data,
+                        const DataFacade<Algorithm> &facade,
+                        const std::vector<PhantomNode> &phantom_nodes,
+                        const std::size_t phantom_index,
+                        const std::vector<std::size_t> &phantom_indices,
+                        const EdgeWeight weight_upper_bound,
+                        std::vector<double>::iterator distances)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    const auto &source_phantom = phantom_nodes[phantom_index];
+    const PhantomCellIndex phantom_cells(partition, phantom_nodes, phantom_index, phantom_indices);
+
+    std::vector<EdgeWeight> weights(phantom_indices.size(), weight_upper_bound);
+    std::vector<NodeID> middle_nodes(phantom_indices.size(), SPECIAL_NODEID);
+
+    // Collect destination nodes into a map
+    std::unordered_multimap<NodeID, std::pair<std::size_t, EdgeWeight>> target_nodes_index;
+    target_nodes_index.reserve(phantom_indices.size());
+    for (std::size_t index = 0; index < phantom_indices.size(); ++index)
+    {
+        const auto &phantom_node = phantom_nodes[phantom_indices[index]];
+        if (phantom_node.IsValidForwardTarget())
+            target_nodes_index.insert(
+                {phantom_node.forward_segment_id.id,
+                 std::make_pair(index, phantom_node.GetForwardWeightPlusOffset())});
+        if (phantom_node.IsValidReverseTarget())
+            target_nodes_index.insert(
+                {phantom_node.reverse_segment_id.id,
+                 std::make_pair(index, phantom_node.GetReverseWeightPlusOffset())});
+    }
 
-        // explore search space
-        while (!query_heap.Empty())
+    engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(facade.GetNumberOfNodes());
+    auto &query_heap = *(engine_working_data.many_to_many_heap);
+
+    // Check if node is in the destinations list and update weights and middle nodes
+    auto update_values = [&](NodeID node, EdgeWeight weight) {
+        auto candidates = target_nodes_index.equal_range(node);
+        for (auto it = candidates.first; it != candidates.second;)
         {
-            backwardRoutingStep<DIRECTION>(
-                facade, column_idx, query_heap, search_space_with_buckets, phantom);
+            const auto index = it->second.first;
+            const auto path_weight = weight + it->second.second;
+            if (path_weight >= 0)
+            {
+                if (path_weight < weights[index])
+                {
+                    weights[index] = path_weight;
+                    middle_nodes[index] = node;
+                }
+                it = target_nodes_index.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
         }
-    }
+    };
 
-    // Order lookup buckets
-    std::sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+    // Source nodes are not inserted into the heap to allow loops back to them,
+    // see oneToManySearch
+    auto insert_node = [&](NodeID node, EdgeWeight initial_weight) {
+        update_values(node, initial_weight);
+        for (auto edge : facade.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = facade.GetEdgeData(edge);
+            if (data.forward && !facade.ExcludeNode(facade.GetTarget(edge)))
+            {
+                const auto to = facade.GetTarget(edge);
+                const auto to_weight = data.weight + initial_weight;
+                if (!query_heap.WasInserted(to))
+                {
+                    query_heap.Insert(to, to_weight, {node, false, 0});
+                }
+                else if (to_weight < query_heap.GetKey(to))
+                {
+                    query_heap.GetData(to) = {node, false, 0};
+                    query_heap.DecreaseKey(to, to_weight);
+                }
+            }
+        }
+    };
 
-    // Find shortest paths from sources to all accessible nodes
-    for (std::uint32_t row_idx = 0; row_idx < source_indices.size(); ++row_idx)
+    if (source_phantom.IsValidForwardSource())
+        insert_node(source_phantom.forward_segment_id.id,
+                    -source_phantom.GetForwardWeightPlusOffset());
+    if (source_phantom.IsValidReverseSource())
+        insert_node(source_phantom.reverse_segment_id.id,
+                    -source_phantom.GetReverseWeightPlusOffset());
+
+    while (!query_heap.Empty() && !target_nodes_index.empty() &&
+           query_heap.MinKey() < weight_upper_bound)
     {
-        const auto index = source_indices[row_idx];
-        const auto &phantom = phantom_nodes[index];
+        checkCancellation();
+        const auto node = query_heap.DeleteMin();
+        const auto weight = query_heap.GetKey(node);
+        const auto duration = query_heap.GetData(node).duration;
 
-        // Clear heap and insert source nodes
-        engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
-            facade.GetNumberOfNodes());
-        auto &query_heap = *(engine_working_data.many_to_many_heap);
+        update_values(node, weight);
 
-        if (DIRECTION == FORWARD_DIRECTION)
-            insertSourceInHeap(query_heap, phantom);
-        else
-            insertTargetInHeap(query_heap, phantom);
+        relaxOutgoingEdges<FORWARD_DIRECTION>(facade,
+                                              node,
+                                              weight,
+                                              duration,
+                                              query_heap,
+                                              phantom_cells);
+    }
+
+    const auto is_source_node = [&source_phantom](const NodeID node) {
+        return (source_phantom.IsValidForwardSource() &&
+                source_phantom.forward_segment_id.id == node) ||
+               (source_phantom.IsValidReverseSource() &&
+                source_phantom.reverse_segment_id.id == node);
+    };
+
+    engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
+    auto &forward_heap = *engine_working_data.forward_heap_1;
+    auto &reverse_heap = *engine_working_data.reverse_heap_1;
 
-        // Explore search space
-        while (!query_heap.Empty())
+    PackedPath packed_path;
+    std::vector<NodeID> unpacked_nodes;
+    std::vector<EdgeID> unpacked_edges;
+    std::vector<PathData> unpacked_path;
+    for (std::size_t index = 0; index < phantom_indices.size(); ++index)
+    {
+        const auto middle_node = middle_nodes[index];
+        if (middle_node == SPECIAL_NODEID)
+            continue;
+
+        // Trace back the path until the first source node is reached. Source nodes are only
+        // in the heap if they were reached again by a loop, so a single node path stops at once.
+        packed_path.clear();
+        auto current_node = middle_node;
+        do
         {
-            forwardRoutingStep<DIRECTION>(facade,
-                                          row_idx,
-                                          number_of_sources,
-                                          number_of_targets,
-                                          query_heap,
-                                          search_space_with_buckets,
-                                          weights_table,
-                                          durations_table,
-                                          phantom);
+            if (!query_heap.WasInserted(current_node))
+                break;
+            const auto &data = query_heap.GetData(current_node);
+            packed_path.emplace_back(data.parent, current_node, data.from_clique_arc);
+            current_node = data.parent;
+        } while (!is_source_node(current_node));
+        std::reverse(packed_path.begin(), packed_path.end());
+
+        unpacked_nodes.clear();
+        unpacked_edges.clear();
+        unpacked_nodes.push_back(current_node);
+        for (const auto &packed_edge : packed_path)
+        {
+            NodeID source, target;
+            bool overlay_edge;
+            std::tie(source, target, overlay_edge) = packed_edge;
+            if (!overlay_edge)
+            {
+                unpacked_nodes.push_back(target);
+                unpacked_edges.push_back(facade.FindEdge(source, target));
+            }
+            else
+            {
+                const auto level = getNodeQueryLevel(partition, source, phantom_cells);
+                const auto parent_cell_id = partition.GetCell(level, source);
+                BOOST_ASSERT(parent_cell_id == partition.GetCell(level, target));
+
+                forward_heap.Clear();
+                reverse_heap.Clear();
+                forward_heap.Insert(source, 0, {source});
+                reverse_heap.Insert(target, 0, {target});
+
+                EdgeWeight subpath_weight;
+                std::vector<NodeID> subpath_nodes;
+                std::vector<EdgeID> subpath_edges;
+                std::tie(subpath_weight, subpath_nodes, subpath_edges) =
+                    search(engine_working_data,
+                           facade,
+                           forward_heap,
+                           reverse_heap,
+                           DO_NOT_FORCE_LOOPS,
+                           DO_NOT_FORCE_LOOPS,
+                           INVALID_EDGE_WEIGHT,
+                           static_cast<LevelID>(level - 1),
+                           parent_cell_id);
+                BOOST_ASSERT(subpath_nodes.size() > 1);
+                BOOST_ASSERT(subpath_nodes.front() == source);
+                BOOST_ASSERT(subpath_nodes.back() == target);
+                unpacked_nodes.insert(
+                    unpacked_nodes.end(), std::next(subpath_nodes.begin()), subpath_nodes.end());
+                unpacked_edges.insert(
+                    unpacked_edges.end(), subpath_edges.begin(), subpath_edges.end());
+            }
         }
-    }
 
-    return durations_table;
+        const auto &target_phantom = phantom_nodes[phantom_indices[index]];
+
+        unpacked_path.clear();
+        annotatePath(facade,
+                     {source_phantom, target_phantom},
+                     unpacked_nodes,
+                     unpacked_edges,
+                     unpacked_path);
+
+        distances[index] = getPathDistance(facade, unpacked_path, source_phantom, target_phantom);
+    }
 }
 
 } // namespace mld
@@ -537,7 +854,9 @@ std::vector<EdgeDuration> manyToManySearch(SearchEngineData<mld::Algorithm> &eng
                                            const DataFacade<mld::Algorithm> &facade,
                                            const std::vector<PhantomNode> &phantom_nodes,
                                            const std::vector<std::size_t> &source_indices,
-                                           const std::vector<std::size_t> &target_indices)
+                                           const std::vector<std::size_t> &target_indices,
+                                           const bool parallel,
+                                           SearchSpaceCache *search_space_cache)
 {
     if (source_indices.size() == 1)
     { // TODO: check if target_indices.size() == 1 and do a bi-directional search
@@ -553,13 +872,276 @@ std::vector<EdgeDuration> manyToManySearch(SearchEngineData<mld::Algorithm> &eng
 
     if (target_indices.size() < source_indices.size())
     {
-        return mld::manyToManySearch<REVERSE_DIRECTION>(
-            engine_working_data, facade, phantom_nodes, target_indices, source_indices);
+        return mld::manyToManySearch<REVERSE_DIRECTION>(engine_working_data,
+                                                        facade,
+                                                        phantom_nodes,
+                                                        target_indices,
+                                                        source_indices,
+                                                        parallel,
+                                                        search_space_cache);
+    }
+
+    return mld::manyToManySearch<FORWARD_DIRECTION>(engine_working_data,
+                                                    facade,
+                                                    phantom_nodes,
+                                                    source_indices,
+                                                    target_indices,
+                                                    parallel,
+                                                    search_space_cache);
+}
+
+// Network distances are computed with one unidirectional search per source row,
+// as all found paths must be unpacked from the forward search space.
+template <>
+std::vector<double> getNetworkDistances(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                        const DataFacade<mld::Algorithm> &facade,
+                                        const std::vector<PhantomNode> &phantom_nodes,
+                                        const std::vector<std::size_t> &source_indices,
+                                        const std::vector<std::size_t> &target_indices,
+                                        const EdgeWeight weight_upper_bound,
+                                        const bool parallel)
+{
+    const auto number_of_targets = target_indices.size();
+
+    std::vector<double> distances_table(source_indices.size() * number_of_targets,
+                                        std::numeric_limits<double>::max());
+
+    forEachSourceRow(source_indices.size(), parallel, [&](const std::uint32_t row_idx) {
+        mld::oneToManyDistances(engine_working_data,
+                                facade,
+                                phantom_nodes,
+                                source_indices[row_idx],
+                                target_indices,
+                                weight_upper_bound,
+                                distances_table.begin() + row_idx * number_of_targets);
+    });
+
+    return distances_table;
+}
+
+namespace mld
+{
+namespace
+{
+// The table between the representatives has at most this fraction of the entries of the table
+// between all sources and targets, if there is a level with so few cells
+const constexpr std::size_t APPROXIMATE_TABLE_REDUCTION = 64;
+
+// Indices into the source or target indices, the first one is the representative of the group
+using PhantomGroup = std::vector<std::uint32_t>;
+
+template <typename MultiLevelPartition>
+CellID getPhantomCell(const MultiLevelPartition &partition,
+                      const LevelID level,
+                      const PhantomNode &phantom_node)
+{
+    return partition.GetCell(level,
+                             phantom_node.forward_segment_id.enabled
+                                 ? phantom_node.forward_segment_id.id
+                                 : phantom_node.reverse_segment_id.id);
+}
+
+template <typename MultiLevelPartition>
+std::vector<PhantomGroup> groupByCell(const MultiLevelPartition &partition,
+                                      const LevelID level,
+                                      const std::vector<PhantomNode> &phantom_nodes,
+                                      const std::vector<std::size_t> &indices)
+{
+    std::vector<std::pair<CellID, std::uint32_t>> cells;
+    cells.reserve(indices.size());
+    for (std::uint32_t position = 0; position < indices.size(); ++position)
+    {
+        cells.emplace_back(getPhantomCell(partition, level, phantom_nodes[indices[position]]),
+                           position);
+    }
+    std::sort(cells.begin(), cells.end());
+
+    std::vector<PhantomGroup> groups;
+    for (auto cell = cells.begin(); cell != cells.end(); ++cell)
+    {
+        if (cell == cells.begin() || std::prev(cell)->first != cell->first)
+        {
+            groups.emplace_back();
+        }
+        groups.back().push_back(cell->second);
+    }
+    return groups;
+}
+
+// The lowest level on which the table between the cells of the sources and the targets is small
+// enough, the error of the approximation grows with the size of the cells
+template <typename MultiLevelPartition>
+LevelID getApproximationLevel(const MultiLevelPartition &partition,
+                              const std::vector<PhantomNode> &phantom_nodes,
+                              const std::vector<std::size_t> &source_indices,
+                              const std::vector<std::size_t> &target_indices)
+{
+    const auto count_cells = [&](const LevelID level, const std::vector<std::size_t> &indices) {
+        std::vector<CellID> cells;
+        cells.reserve(indices.size());
+        for (const auto index : indices)
+        {
+            cells.push_back(getPhantomCell(partition, level, phantom_nodes[index]));
+        }
+        std::sort(cells.begin(), cells.end());
+        return static_cast<std::size_t>(std::unique(cells.begin(), cells.end()) - cells.begin());
+    };
+
+    const auto number_of_entries = source_indices.size() * target_indices.size();
+    const LevelID highest_level = partition.GetNumberOfLevels() - 1;
+    for (LevelID level = 1; level < highest_level; ++level)
+    {
+        if (count_cells(level, source_indices) * count_cells(level, target_indices) *
+                APPROXIMATE_TABLE_REDUCTION <=
+            number_of_entries)
+        {
+            return level;
+        }
+    }
+    return highest_level;
+}
+
+// Durations from the members of every group to its representative for REVERSE_DIRECTION and
+// from the representative to the members for FORWARD_DIRECTION. Members that are not connected
+// to their representative become the representatives of groups of their own.
+template <bool DIRECTION>
+std::vector<EdgeDuration> connectRepresentatives(SearchEngineData<Algorithm> &engine_working_data,
+                                                 const DataFacade<Algorithm> &facade,
+                                                 const std::vector<PhantomNode> &phantom_nodes,
+                                                 const std::vector<std::size_t> &indices,
+                                                 std::vector<PhantomGroup> &groups,
+                                                 const bool parallel)
+{
+    std::vector<EdgeDuration> durations(indices.size(), 0);
+    std::vector<PhantomGroup> unconnected(groups.size());
+
+    forEachSourceRow(groups.size(), parallel, [&](const std::uint32_t group_idx) {
+        auto &group = groups[group_idx];
+        if (group.size() < 2)
+            return;
+
+        std::vector<std::size_t> member_indices;
+        member_indices.reserve(group.size() - 1);
+        for (auto member = std::next(group.begin()); member != group.end(); ++member)
+        {
+            member_indices.push_back(indices[*member]);
+        }
+
+        const auto member_durations = oneToManySearch<DIRECTION>(
+            engine_working_data, facade, phantom_nodes, indices[group.front()], member_indices);
+
+        auto connected = std::next(group.begin());
+        for (std::size_t member_idx = 0; member_idx < member_durations.size(); ++member_idx)
+        {
+            const auto member = group[member_idx + 1];
+            if (member_durations[member_idx] == MAXIMAL_EDGE_DURATION)
+            {
+                unconnected[group_idx].push_back(member);
+            }
+            else
+            {
+                durations[member] = member_durations[member_idx];
+                *connected++ = member;
+            }
+        }
+        group.erase(connected, group.end());
+    });
+
+    for (const auto &members : unconnected)
+    {
+        for (const auto member : members)
+        {
+            groups.push_back({member});
+        }
     }
 
-    return mld::manyToManySearch<FORWARD_DIRECTION>(
-        engine_working_data, facade, phantom_nodes, source_indices, target_indices);
+    return durations;
 }
+}
+
+std::vector<EdgeDuration>
+approximateManyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                            const DataFacade<Algorithm> &facade,
+                            const std::vector<PhantomNode> &phantom_nodes,
+                            const std::vector<std::size_t> &source_indices,
+                            const std::vector<std::size_t> &target_indices,
+                            const bool parallel)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    if (partition.GetNumberOfLevels() < 2)
+    {
+        return routing_algorithms::manyToManySearch(engine_working_data,
+                                                    facade,
+                                                    phantom_nodes,
+                                                    source_indices,
+                                                    target_indices,
+                                                    parallel,
+                                                    nullptr);
+    }
+
+    const auto level =
+        getApproximationLevel(partition, phantom_nodes, source_indices, target_indices);
+    auto source_groups = groupByCell(partition, level, phantom_nodes, source_indices);
+    auto target_groups = groupByCell(partition, level, phantom_nodes, target_indices);
+
+    const auto to_representatives = connectRepresentatives<REVERSE_DIRECTION>(
+        engine_working_data, facade, phantom_nodes, source_indices, source_groups, parallel);
+    const auto from_representatives = connectRepresentatives<FORWARD_DIRECTION>(
+        engine_working_data, facade, phantom_nodes, target_indices, target_groups, parallel);
+
+    const auto representatives = [](const std::vector<std::size_t> &indices,
+                                    const std::vector<PhantomGroup> &groups,
+                                    std::vector<std::uint32_t> &member_groups) {
+        std::vector<std::size_t> representative_indices;
+        representative_indices.reserve(groups.size());
+        for (std::uint32_t group_idx = 0; group_idx < groups.size(); ++group_idx)
+        {
+            representative_indices.push_back(indices[groups[group_idx].front()]);
+            for (const auto member : groups[group_idx])
+            {
+                member_groups[member] = group_idx;
+            }
+        }
+        return representative_indices;
+    };
+    std::vector<std::uint32_t> source_groups_of(source_indices.size());
+    std::vector<std::uint32_t> target_groups_of(target_indices.size());
+    const auto source_representatives =
+        representatives(source_indices, source_groups, source_groups_of);
+    const auto target_representatives =
+        representatives(target_indices, target_groups, target_groups_of);
+
+    const auto representative_durations =
+        routing_algorithms::manyToManySearch(engine_working_data,
+                                             facade,
+                                             phantom_nodes,
+                                             source_representatives,
+                                             target_representatives,
+                                             parallel,
+                                             nullptr);
+
+    const auto number_of_targets = target_indices.size();
+    std::vector<EdgeDuration> durations_table(source_indices.size() * number_of_targets);
+    forEachSourceRow(source_indices.size(), parallel, [&](const std::uint32_t row_idx) {
+        const auto source_duration = to_representatives[row_idx];
+        const auto representative_row = representative_durations.begin() +
+                                         source_groups_of[row_idx] * target_representatives.size();
+        auto entry = durations_table.begin() + row_idx * number_of_targets;
+        for (std::size_t column_idx = 0; column_idx < number_of_targets; ++column_idx, ++entry)
+        {
+            const auto duration = representative_row[target_groups_of[column_idx]];
+            if (source_indices[row_idx] == target_indices[column_idx])
+                *entry = 0;
+            else if (duration == MAXIMAL_EDGE_DURATION)
+                *entry = MAXIMAL_EDGE_DURATION;
+            else
+                *entry = source_duration + duration + from_representatives[column_idx];
+        }
+    });
+
+    return durations_table;
+}
+} // namespace mld
 
 } // namespace routing_algorithms
 } // namespace engine
@@ -1,6 +1,5 @@
 #include "engine/routing_algorithms/map_matching.hpp"
-#include "engine/routing_algorithms/routing_base_ch.hpp"
-#include "engine/routing_algorithms/routing_base_mld.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
 
 #include "engine/map_matching/hidden_markov_model.hpp"
 #include "engine/map_matching/matching_confidence.hpp"
@@ -11,8 +10,10 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <iomanip>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <utility>
@@ -31,6 +32,8 @@ using HMM = map_matching::HiddenMarkovModel<CandidateLists>;
 constexpr static const unsigned MAX_BROKEN_STATES = 10;
 constexpr static const double MATCHING_BETA = 10;
 constexpr static const double MAX_DISTANCE_DELTA = 2000.;
+// meters the great circle lower bound of a network distance may exceed it by rounding
+constexpr static const double BOUND_TOLERANCE = 0.01;
 
 unsigned getMedianSampleTime(const std::vector<unsigned> &timestamps)
 {
@@ -55,7 +58,8 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
                             const std::vector<util::Coordinate> &trace_coordinates,
                             const std::vector<unsigned> &trace_timestamps,
                             const std::vector<boost::optional<double>> &trace_gps_precision,
-                            const bool allow_splitting)
+                            const bool allow_splitting,
+                            map_matching::MatchingSession *session)
 {
     map_matching::MatchingConfidence confidence;
     map_matching::EmissionLogProbability default_emission_log_probability(DEFAULT_GPS_PRECISION);
@@ -131,11 +135,17 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
         return sub_matchings;
     }
 
-    const auto nodes_number = facade.GetNumberOfNodes();
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(nodes_number);
-
-    auto &forward_heap = *engine_working_data.forward_heap_1;
-    auto &reverse_heap = *engine_working_data.reverse_heap_1;
+    std::vector<PhantomNode> transition_phantoms;
+    std::vector<std::size_t> transition_sources;
+    std::vector<std::size_t> transition_targets;
+    std::vector<std::size_t> searched_rows;
+    std::vector<bool> searched_columns;
+    std::vector<bool> feasible;
+    std::vector<std::size_t> row_sources;
+    std::vector<double> transition_log_probabilities;
+    std::vector<double> best_log_probabilities;
+    std::vector<std::uint32_t> best_rows;
+    std::vector<double> network_distances;
 
     std::size_t breakage_begin = map_matching::INVALID_STATE;
     std::vector<std::size_t> split_points;
@@ -203,7 +213,40 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
             const EdgeWeight weight_upper_bound =
                 ((haversine_distance + max_distance_delta) / 4.) * facade.GetWeightMultiplier();
 
-            // compute d_t for this timestamp and the next one
+            // A network path is at least as long as the great circle between its snapped ends,
+            // so pairs of candidates that are too far apart for the distance delta are rejected
+            // without a search
+            const auto columns = current_viterbi.size();
+            feasible.assign(prev_viterbi.size() * columns, false);
+            for (const auto s : util::irange<std::size_t>(0UL, prev_viterbi.size()))
+            {
+                if (prev_pruned[s])
+                {
+                    continue;
+                }
+                const auto &source_location =
+                    prev_unbroken_timestamps_list[s].phantom_node.location;
+                for (const auto s_prime : util::irange<std::size_t>(0UL, columns))
+                {
+                    const auto lower_bound = util::coordinate_calculation::haversineDistance(
+                        source_location, current_timestamps_list[s_prime].phantom_node.location);
+                    feasible[s * columns + s_prime] =
+                        lower_bound - haversine_distance < max_distance_delta + BOUND_TOLERANCE;
+                }
+            }
+
+            // batch all feasible transitions from the not pruned previous candidates to the
+            // current ones, so only one search per previous candidate is needed instead of one
+            // per pair. Candidates whose transitions are all known to the session or rejected
+            // need no search at all.
+            transition_phantoms.clear();
+            transition_sources.clear();
+            transition_targets.clear();
+            searched_rows.clear();
+            row_sources.clear();
+            searched_columns.assign(columns, false);
+            network_distances.clear();
+            std::size_t number_of_rows = 0;
             for (const auto s : util::irange<std::size_t>(0UL, prev_viterbi.size()))
             {
                 if (prev_pruned[s])
@@ -211,47 +254,144 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
                     continue;
                 }
 
-                for (const auto s_prime : util::irange<std::size_t>(0UL, current_viterbi.size()))
+                const auto row = number_of_rows++;
+                row_sources.push_back(s);
+                network_distances.resize(number_of_rows * columns,
+                                         std::numeric_limits<double>::max());
+                bool known = true;
+                for (const auto s_prime : util::irange<std::size_t>(0UL, columns))
                 {
-                    const double emission_pr = emission_log_probabilities[t][s_prime];
-                    double new_value = prev_viterbi[s] + emission_pr;
-                    if (current_viterbi[s_prime] > new_value)
+                    if (!feasible[s * columns + s_prime])
                     {
                         continue;
                     }
+                    const auto distance =
+                        session ? session->FindTransition(
+                                      {prev_unbroken_timestamps_list[s].phantom_node,
+                                       current_timestamps_list[s_prime].phantom_node,
+                                       weight_upper_bound})
+                                : nullptr;
+                    if (!distance)
+                    {
+                        known = false;
+                        break;
+                    }
+                    network_distances[row * columns + s_prime] = *distance;
+                }
+                if (known)
+                {
+                    continue;
+                }
 
-                    double network_distance =
-                        getNetworkDistance(engine_working_data,
-                                           facade,
-                                           forward_heap,
-                                           reverse_heap,
-                                           prev_unbroken_timestamps_list[s].phantom_node,
-                                           current_timestamps_list[s_prime].phantom_node,
-                                           weight_upper_bound);
-
-                    // get distance diff between loc1/2 and locs/s_prime
-                    const auto d_t = std::abs(network_distance - haversine_distance);
+                searched_rows.push_back(row);
+                transition_sources.push_back(transition_phantoms.size());
+                transition_phantoms.push_back(prev_unbroken_timestamps_list[s].phantom_node);
+                for (const auto s_prime : util::irange<std::size_t>(0UL, columns))
+                {
+                    if (feasible[s * columns + s_prime])
+                    {
+                        searched_columns[s_prime] = true;
+                    }
+                }
+            }
 
-                    // very low probability transition -> prune
-                    if (d_t >= max_distance_delta)
+            if (!transition_sources.empty())
+            {
+                for (const auto s_prime : util::irange<std::size_t>(0UL, columns))
+                {
+                    if (searched_columns[s_prime])
                     {
-                        continue;
+                        transition_targets.push_back(transition_phantoms.size());
+                        transition_phantoms.push_back(
+                            current_timestamps_list[s_prime].phantom_node);
                     }
+                }
 
-                    const double transition_pr = transition_log_probability(d_t);
-                    new_value += transition_pr;
+                const auto searched_distances = getNetworkDistances(engine_working_data,
+                                                                    facade,
+                                                                    transition_phantoms,
+                                                                    transition_sources,
+                                                                    transition_targets,
+                                                                    weight_upper_bound,
+                                                                    false);
 
-                    if (new_value > current_viterbi[s_prime])
+                for (const auto index : util::irange<std::size_t>(0UL, searched_rows.size()))
+                {
+                    const auto searched_row =
+                        searched_distances.begin() + index * transition_targets.size();
+                    const auto row_distances =
+                        network_distances.begin() + searched_rows[index] * columns;
+                    const auto &source_phantom = transition_phantoms[transition_sources[index]];
+                    std::size_t column = 0;
+                    for (const auto s_prime : util::irange<std::size_t>(0UL, columns))
                     {
-                        current_viterbi[s_prime] = new_value;
-                        current_parents[s_prime] = std::make_pair(prev_unbroken_timestamp, s);
-                        current_lengths[s_prime] = network_distance;
-                        current_pruned[s_prime] = false;
-                        model.breakage[t] = false;
+                        if (!searched_columns[s_prime])
+                        {
+                            continue;
+                        }
+                        const auto distance = searched_row[column++];
+                        row_distances[s_prime] = distance;
+                        if (session)
+                        {
+                            session->AddTransition({source_phantom,
+                                                    current_timestamps_list[s_prime].phantom_node,
+                                                    weight_upper_bound},
+                                                   distance);
+                        }
                     }
                 }
             }
 
+            // compute d_t for this timestamp and the next one
+            transition_log_probabilities.resize(network_distances.size());
+            for (const auto index : util::irange<std::size_t>(0UL, network_distances.size()))
+            {
+                // get distance diff between loc1/2 and locs/s_prime
+                const auto d_t = std::abs(network_distances[index] - haversine_distance);
+
+                // very low probability transition -> prune
+                transition_log_probabilities[index] = d_t < max_distance_delta
+                                                          ? transition_log_probability(d_t)
+                                                          : map_matching::IMPOSSIBLE_LOG_PROB;
+            }
+
+            // max-plus product of the previous Viterbi values and the transitions, the rows are
+            // the not pruned previous candidates. The inner loop has no data dependent branches,
+            // so it is vectorized by the compiler. Like the row order, the strict comparison
+            // keeps the first of equally probable parents.
+            const auto &current_emissions = emission_log_probabilities[t];
+            best_log_probabilities.assign(columns, map_matching::IMPOSSIBLE_LOG_PROB);
+            best_rows.assign(columns, 0);
+            for (const auto row : util::irange<std::uint32_t>(0, row_sources.size()))
+            {
+                const auto prev_log_probability = prev_viterbi[row_sources[row]];
+                const auto row_transitions = transition_log_probabilities.data() + row * columns;
+                auto *const best = best_log_probabilities.data();
+                auto *const rows = best_rows.data();
+                for (std::size_t s_prime = 0; s_prime < columns; ++s_prime)
+                {
+                    const double new_value = prev_log_probability + current_emissions[s_prime] +
+                                             row_transitions[s_prime];
+                    const bool better = new_value > best[s_prime];
+                    best[s_prime] = better ? new_value : best[s_prime];
+                    rows[s_prime] = better ? row : rows[s_prime];
+                }
+            }
+
+            for (const auto s_prime : util::irange<std::size_t>(0UL, columns))
+            {
+                if (best_log_probabilities[s_prime] > current_viterbi[s_prime])
+                {
+                    const auto row = best_rows[s_prime];
+                    current_viterbi[s_prime] = best_log_probabilities[s_prime];
+                    current_parents[s_prime] =
+                        std::make_pair(prev_unbroken_timestamp, row_sources[row]);
+                    current_lengths[s_prime] = network_distances[row * columns + s_prime];
+                    current_pruned[s_prime] = false;
+                    model.breakage[t] = false;
+                }
+            }
+
             if (model.breakage[t])
             {
                 // save start of breakage -> we need this as split point
@@ -428,7 +568,8 @@ mapMatching(SearchEngineData<ch::Algorithm> &engine_working_data,
             const std::vector<util::Coordinate> &trace_coordinates,
             const std::vector<unsigned> &trace_timestamps,
             const std::vector<boost::optional<double>> &trace_gps_precision,
-            const bool allow_splitting);
+            const bool allow_splitting,
+            map_matching::MatchingSession *session);
 
 // MLD
 template SubMatchingList
@@ -438,7 +579,8 @@ mapMatching(SearchEngineData<mld::Algorithm> &engine_working_data,
             const std::vector<util::Coordinate> &trace_coordinates,
             const std::vector<unsigned> &trace_timestamps,
             const std::vector<boost::optional<double>> &trace_gps_precision,
-            const bool allow_splitting);
+            const bool allow_splitting,
+            map_matching::MatchingSession *session);
 
 } // namespace routing_algorithms
 } // namespace engine
@@ -0,0 +1,257 @@
+#include "engine/routing_algorithms/one_to_all.hpp"
+#include "engine/cancellation_token.hpp"
+#include "engine/routing_algorithms/routing_base.hpp"
+
+#include "util/search_counters.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+namespace mld
+{
+
+namespace
+{
+struct Label
+{
+    EdgeWeight weight;
+    EdgeDuration duration;
+};
+
+// The labels of all nodes settled by the searches, a node can be settled once per level
+using Labels = std::unordered_map<NodeID, Label>;
+
+// A cell that a search entered with its clique arcs
+using EnteredCell = std::pair<LevelID, CellID>;
+
+using QueryHeap = SearchEngineData<Algorithm>::ManyToManyQueryHeap;
+
+// Highest level on which the cells of the node and of the source differ
+template <typename MultiLevelPartition>
+LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
+                          const NodeID node,
+                          const PhantomNode &source_phantom)
+{
+    auto highest_different_level = [&partition, node](const SegmentID &segment) {
+        if (segment.enabled)
+            return partition.GetHighestDifferentLevel(segment.id, node);
+        return INVALID_LEVEL_ID;
+    };
+
+    return std::min(highest_different_level(source_phantom.forward_segment_id),
+                    highest_different_level(source_phantom.reverse_segment_id));
+}
+
+void relaxEdge(QueryHeap &query_heap,
+               const NodeID node,
+               const NodeID to,
+               const EdgeWeight to_weight,
+               const EdgeDuration to_duration,
+               const bool from_clique_arc)
+{
+    if (!query_heap.WasInserted(to))
+    {
+        query_heap.Insert(to, to_weight, {node, from_clique_arc, to_duration});
+    }
+    else if (std::tie(to_weight, to_duration) <
+             std::tie(query_heap.GetKey(to), query_heap.GetData(to).duration))
+    {
+        query_heap.GetData(to) = {node, from_clique_arc, to_duration};
+        query_heap.DecreaseKey(to, to_weight);
+    }
+}
+
+// Settles the nodes of the heap and all nodes they reach with a duration of at most max_duration.
+// Nodes are relaxed on the level query_level returns for them, edges of the base graph only if
+// in_parent_cell accepts their target. The cells whose clique arcs are used go to entered_cells.
+template <typename QueryLevel, typename InParentCell>
+void search(const DataFacade<Algorithm> &facade,
+            QueryHeap &query_heap,
+            const EdgeDuration max_duration,
+            QueryLevel query_level,
+            InParentCell in_parent_cell,
+            Labels &labels,
+            std::vector<EnteredCell> &entered_cells)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    const auto &cells = facade.GetCellStorage();
+    const auto &metric = facade.GetCellMetric();
+
+    while (!query_heap.Empty())
+    {
+        checkCancellation();
+        const auto node = query_heap.DeleteMin();
+        const auto weight = query_heap.GetKey(node);
+        const auto duration = query_heap.GetData(node).duration;
+        const auto from_clique_arc = query_heap.GetData(node).from_clique_arc;
+
+        const auto inserted = labels.insert({node, Label{weight, duration}});
+        if (!inserted.second && std::tie(weight, duration) < std::tie(inserted.first->second.weight,
+                                                                      inserted.first->second.duration))
+        {
+            inserted.first->second = Label{weight, duration};
+        }
+
+        // durations never decrease along a path, nodes behind this one are out of range as well
+        if (duration > max_duration)
+            continue;
+
+        const auto level = query_level(node);
+        if (level == INVALID_LEVEL_ID)
+            continue;
+
+        if (level >= 1 && !from_clique_arc)
+        {
+            OSRM_COUNT_SEARCH(EnterCell(level));
+            const auto cell_id = partition.GetCell(level, node);
+            entered_cells.emplace_back(level, cell_id);
+
+            const auto &cell = cells.GetCell(metric, level, cell_id);
+            auto destination = cell.GetDestinationNodes().begin();
+            auto shortcut_durations = cell.GetOutDuration(node);
+            for (auto shortcut_weight : cell.GetOutWeight(node))
+            {
+                BOOST_ASSERT(destination != cell.GetDestinationNodes().end());
+                BOOST_ASSERT(!shortcut_durations.empty());
+                const NodeID to = *destination;
+
+                if (shortcut_weight != INVALID_EDGE_WEIGHT && node != to)
+                {
+                    relaxEdge(query_heap,
+                              node,
+                              to,
+                              weight + shortcut_weight,
+                              duration + shortcut_durations.front(),
+                              true);
+                }
+                ++destination;
+                shortcut_durations.advance_begin(1);
+            }
+            BOOST_ASSERT(shortcut_durations.empty());
+        }
+
+        for (const auto edge : facade.GetBorderEdgeRange(level, node))
+        {
+            const auto &data = facade.GetEdgeData(edge);
+            if (!data.forward)
+                continue;
+
+            const NodeID to = facade.GetTarget(edge);
+            if (facade.ExcludeNode(to) || !in_parent_cell(to))
+                continue;
+
+            BOOST_ASSERT_MSG(data.weight > 0, "edge_weight invalid");
+            relaxEdge(query_heap, node, to, weight + data.weight, duration + data.duration, false);
+        }
+    }
+}
+}
+
+std::vector<ReachedNode> oneToAllSearch(SearchEngineData<Algorithm> &engine_working_data,
+                                        const DataFacade<Algorithm> &facade,
+                                        const PhantomNode &source_phantom,
+                                        const EdgeDuration max_duration)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    const auto &cells = facade.GetCellStorage();
+    const auto &metric = facade.GetCellMetric();
+
+    engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(facade.GetNumberOfNodes());
+    auto &query_heap = *(engine_working_data.many_to_many_heap);
+
+    Labels labels;
+    std::vector<EnteredCell> entered_cells;
+
+    // The overlay graph of the source only descends into the cells of the source
+    insertSourceInHeap(query_heap, source_phantom);
+    search(facade,
+           query_heap,
+           max_duration,
+           [&partition, &source_phantom](const NodeID node) {
+               return getNodeQueryLevel(partition, node, source_phantom);
+           },
+           [](const NodeID) { return true; },
+           labels,
+           entered_cells);
+
+    const auto is_reached = [&labels, max_duration](const NodeID node) {
+        const auto label = labels.find(node);
+        return label != labels.end() && label->second.duration <= max_duration;
+    };
+
+    // The shortest paths into a cell enter it at one of its source nodes, whose labels are final.
+    // Searching from them inside the cell on the level below settles the cells below it.
+    std::vector<EnteredCell> boundary_cells;
+    while (!entered_cells.empty())
+    {
+        std::sort(entered_cells.begin(), entered_cells.end());
+        entered_cells.erase(std::unique(entered_cells.begin(), entered_cells.end()),
+                            entered_cells.end());
+        boundary_cells.clear();
+        boundary_cells.swap(entered_cells);
+
+        for (const auto &entered_cell : boundary_cells)
+        {
+            const auto level = entered_cell.first;
+            const auto cell_id = entered_cell.second;
+            const auto &cell = cells.GetCell(metric, level, cell_id);
+
+            const auto source_nodes = cell.GetSourceNodes();
+            const auto destination_nodes = cell.GetDestinationNodes();
+            if (std::all_of(source_nodes.begin(), source_nodes.end(), is_reached) &&
+                std::all_of(destination_nodes.begin(), destination_nodes.end(), is_reached))
+                continue;
+
+            query_heap.Clear();
+            for (const auto node : source_nodes)
+            {
+                if (is_reached(node))
+                {
+                    const auto &label = labels.at(node);
+                    query_heap.Insert(node, label.weight, {node, false, label.duration});
+                }
+            }
+
+            const LevelID sub_level = level - 1;
+            search(facade,
+                   query_heap,
+                   max_duration,
+                   [sub_level](const NodeID) { return sub_level; },
+                   [&partition, level, cell_id](const NodeID node) {
+                       return partition.GetCell(level, node) == cell_id;
+                   },
+                   labels,
+                   entered_cells);
+        }
+    }
+
+    // the source nodes keep the negative offsets of the phantom, their start is behind it
+    std::vector<ReachedNode> reached_nodes;
+    for (const auto &label : labels)
+    {
+        const auto weight = label.second.weight;
+        const auto duration = label.second.duration;
+        if (weight >= 0 && duration >= 0 && duration <= max_duration)
+        {
+            reached_nodes.push_back({label.first, weight, duration});
+        }
+    }
+
+    return reached_nodes;
+}
+
+} // namespace mld
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
@@ -0,0 +1,239 @@
+#include "engine/routing_algorithms/phast.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/routing_algorithms/routing_base_ch.hpp"
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include <algorithm>
+#include <tuple>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+std::shared_ptr<const ch::PhastGraph>
+PhastGraphCache::Get(const DataFacade<ch::Algorithm> &facade)
+{
+    if (auto graph = graphs.Get(facade.GetDatasetID(), facade.GetFacadeID()))
+        return graph;
+
+    std::lock_guard<std::mutex> lock(build_mutex);
+    if (auto graph = graphs.Get(facade.GetDatasetID(), facade.GetFacadeID()))
+        return graph;
+
+    auto graph = std::make_shared<const ch::PhastGraph>(facade);
+    graphs.Put(facade.GetDatasetID(), facade.GetFacadeID(), graph);
+    return graph;
+}
+
+namespace ch
+{
+
+std::vector<ReachedNode> oneToAllSearch(SearchEngineData<Algorithm> &engine_working_data,
+                                        const DataFacade<Algorithm> &facade,
+                                        const PhastGraph &phast_graph,
+                                        const PhantomNode &source_phantom,
+                                        const EdgeDuration max_duration)
+{
+    engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(facade.GetNumberOfNodes());
+    auto &query_heap = *(engine_working_data.many_to_many_heap);
+    insertSourceInHeap(query_heap, source_phantom);
+
+    auto &labels = engine_working_data.GetPhastLabels();
+    phastSearch(facade, phast_graph, query_heap, labels);
+
+    // the source nodes keep the negative offsets of the phantom, their start is behind it
+    std::vector<ReachedNode> reached_nodes;
+    for (std::uint32_t position = 0; position < phast_graph.GetNumberOfNodes(); ++position)
+    {
+        const auto weight = labels.weights[position];
+        const auto duration = labels.durations[position];
+        if (weight != INVALID_EDGE_WEIGHT && weight >= 0 && duration >= 0 &&
+            duration <= max_duration)
+        {
+            reached_nodes.push_back({phast_graph.GetNode(position), weight, duration});
+        }
+    }
+
+    return reached_nodes;
+}
+
+namespace
+{
+// A node of a target phantom with the weight and duration of the phantom behind the node start
+struct TargetNode
+{
+    std::uint32_t index; // in the RestrictedPhastGraph
+    EdgeWeight weight;
+    EdgeDuration duration;
+};
+
+// Source and target on the same segment with the target behind the source: the sweep only has
+// the label of the source itself, find the paths that come back to the node instead
+bool addReturnWeight(const DataFacade<Algorithm> &facade,
+                     const RestrictedPhastGraph &restricted_graph,
+                     PhastLaneLabels &labels,
+                     const TargetNode &target,
+                     const std::size_t lane,
+                     EdgeWeight &weight,
+                     EdgeDuration &duration)
+{
+    BOOST_ASSERT(weight < 0);
+
+    auto best_weight = INVALID_EDGE_WEIGHT;
+    auto best_duration = MAXIMAL_EDGE_DURATION;
+    for (const auto &edge : restricted_graph.GetIncomingEdges(target.index))
+    {
+        const auto source_weight = labels.GetWeights(edge.source)[lane];
+        if (source_weight == INVALID_EDGE_WEIGHT)
+            continue;
+
+        const auto new_weight = source_weight + edge.weight + target.weight;
+        const auto new_duration =
+            labels.GetDurations(edge.source)[lane] + edge.duration + target.duration;
+        if (new_weight >= 0 &&
+            std::tie(new_weight, new_duration) < std::tie(best_weight, best_duration))
+        {
+            best_weight = new_weight;
+            best_duration = new_duration;
+        }
+    }
+
+    auto loop_weight = weight;
+    auto loop_duration = duration;
+    if (addLoopWeight(facade, restricted_graph.GetNode(target.index), loop_weight, loop_duration) &&
+        std::tie(loop_weight, loop_duration) < std::tie(best_weight, best_duration))
+    {
+        best_weight = loop_weight;
+        best_duration = loop_duration;
+    }
+
+    if (best_weight == INVALID_EDGE_WEIGHT)
+        return false;
+
+    weight = best_weight;
+    duration = best_duration;
+    return true;
+}
+}
+
+std::vector<EdgeDuration>
+restrictedManyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                           const DataFacade<Algorithm> &facade,
+                           const PhastGraph &phast_graph,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const std::vector<std::size_t> &target_indices,
+                           const bool parallel)
+{
+    const auto number_of_sources = source_indices.size();
+    const auto number_of_targets = target_indices.size();
+
+    std::vector<EdgeDuration> durations_table(number_of_sources * number_of_targets,
+                                              MAXIMAL_EDGE_DURATION);
+    if (durations_table.empty())
+        return durations_table;
+
+    std::vector<NodeID> target_nodes;
+    for (const auto index : target_indices)
+    {
+        const auto &phantom = phantom_nodes[index];
+        if (phantom.IsValidForwardTarget())
+            target_nodes.push_back(phantom.forward_segment_id.id);
+        if (phantom.IsValidReverseTarget())
+            target_nodes.push_back(phantom.reverse_segment_id.id);
+    }
+    const RestrictedPhastGraph restricted_graph(phast_graph, target_nodes);
+
+    // the nodes of every target column with the offsets of insertTargetInHeap
+    std::vector<std::uint32_t> first_target_nodes(number_of_targets + 1, 0);
+    std::vector<TargetNode> column_target_nodes;
+    for (std::size_t column_idx = 0; column_idx < number_of_targets; ++column_idx)
+    {
+        const auto &phantom = phantom_nodes[target_indices[column_idx]];
+        if (phantom.IsValidForwardTarget())
+            column_target_nodes.push_back(
+                {restricted_graph.GetIndex(phantom.forward_segment_id.id),
+                 phantom.GetForwardWeightPlusOffset(),
+                 phantom.GetForwardDuration()});
+        if (phantom.IsValidReverseTarget())
+            column_target_nodes.push_back(
+                {restricted_graph.GetIndex(phantom.reverse_segment_id.id),
+                 phantom.GetReverseWeightPlusOffset(),
+                 phantom.GetReverseDuration()});
+        first_target_nodes[column_idx + 1] = column_target_nodes.size();
+    }
+
+    // the labels have the size of the restricted graph, so they are kept for all batches of a
+    // worker thread instead of the request thread
+    tbb::enumerable_thread_specific<PhastLaneLabels> worker_labels;
+
+    const auto number_of_batches = (number_of_sources + PHAST_LANES - 1) / PHAST_LANES;
+    forEachSourceRow(number_of_batches, parallel, [&](const std::uint32_t batch_idx) {
+        const auto first_row = batch_idx * PHAST_LANES;
+        const auto number_of_lanes = std::min(PHAST_LANES, number_of_sources - first_row);
+
+        auto &labels = worker_labels.local();
+        labels.Reset(restricted_graph.GetNumberOfNodes());
+        for (std::size_t lane = 0; lane < number_of_lanes; ++lane)
+        {
+            checkCancellation();
+            engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
+                facade.GetNumberOfNodes());
+            auto &query_heap = *(engine_working_data.many_to_many_heap);
+            insertSourceInHeap(query_heap, phantom_nodes[source_indices[first_row + lane]]);
+            restrictedUpwardSearch(facade, restricted_graph, query_heap, lane, labels);
+        }
+
+        restrictedSweep(restricted_graph, labels);
+
+        for (std::size_t lane = 0; lane < number_of_lanes; ++lane)
+        {
+            const auto row_offset = (first_row + lane) * number_of_targets;
+            for (std::size_t column_idx = 0; column_idx < number_of_targets; ++column_idx)
+            {
+                auto best_weight = INVALID_EDGE_WEIGHT;
+                auto best_duration = MAXIMAL_EDGE_DURATION;
+                for (auto position = first_target_nodes[column_idx];
+                     position < first_target_nodes[column_idx + 1];
+                     ++position)
+                {
+                    const auto &target = column_target_nodes[position];
+                    const auto node_weight = labels.GetWeights(target.index)[lane];
+                    if (node_weight == INVALID_EDGE_WEIGHT)
+                        continue;
+
+                    auto new_weight = node_weight + target.weight;
+                    auto new_duration = labels.GetDurations(target.index)[lane] + target.duration;
+                    if (new_weight < 0 && !addReturnWeight(facade,
+                                                           restricted_graph,
+                                                           labels,
+                                                           target,
+                                                           lane,
+                                                           new_weight,
+                                                           new_duration))
+                        continue;
+
+                    if (std::tie(new_weight, new_duration) <
+                        std::tie(best_weight, best_duration))
+                    {
+                        best_weight = new_weight;
+                        best_duration = new_duration;
+                    }
+                }
+                durations_table[row_offset + column_idx] = best_duration;
+            }
+        }
+    });
+
+    return durations_table;
+}
+
+} // namespace ch
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
@@ -0,0 +1,163 @@
+#include "engine/routing_algorithms/phast_graph.hpp"
+
+#include "engine/cancellation_token.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <tuple>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OSRM_PHAST_SWEEP_AVX2
+#include <immintrin.h>
+#endif
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+namespace ch
+{
+
+constexpr std::uint32_t RestrictedPhastGraph::INVALID_INDEX;
+
+namespace
+{
+using SweepKernel = void (*)(const RestrictedPhastGraph &, PhastLaneLabels &);
+
+void restrictedSweepScalar(const RestrictedPhastGraph &graph, PhastLaneLabels &labels)
+{
+    for (std::uint32_t index = 0; index < graph.GetNumberOfNodes(); ++index)
+    {
+        checkCancellation();
+
+        auto weights = labels.GetWeights(index);
+        auto durations = labels.GetDurations(index);
+        for (const auto &edge : graph.GetIncomingEdges(index))
+        {
+            const auto source_weights = labels.GetWeights(edge.source);
+            const auto source_durations = labels.GetDurations(edge.source);
+            for (std::size_t lane = 0; lane < PHAST_LANES; ++lane)
+            {
+                if (source_weights[lane] == INVALID_EDGE_WEIGHT)
+                    continue;
+
+                const auto new_weight = source_weights[lane] + edge.weight;
+                const auto new_duration = source_durations[lane] + edge.duration;
+                if (std::tie(new_weight, new_duration) < std::tie(weights[lane], durations[lane]))
+                {
+                    weights[lane] = new_weight;
+                    durations[lane] = new_duration;
+                }
+            }
+        }
+    }
+}
+
+#ifdef OSRM_PHAST_SWEEP_AVX2
+static_assert(PHAST_LANES == 16, "the AVX2 sweep keeps the lanes of a node in two registers");
+
+__attribute__((target("avx2"))) inline __m256i loadLanes(const std::int32_t *lanes)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lanes));
+}
+
+__attribute__((target("avx2"))) inline void storeLanes(std::int32_t *lanes, const __m256i &vector)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), vector);
+}
+
+// (new_weight, new_duration) < (weight, duration) for the lanes with valid source weights
+__attribute__((target("avx2"))) inline void relaxLanes(const std::int32_t *source_weights,
+                                                       const std::int32_t *source_durations,
+                                                       const __m256i &edge_weights,
+                                                       const __m256i &edge_durations,
+                                                       __m256i &weights,
+                                                       __m256i &durations)
+{
+    const auto source_weight_lanes = loadLanes(source_weights);
+    const auto new_weights = _mm256_add_epi32(source_weight_lanes, edge_weights);
+    const auto new_durations = _mm256_add_epi32(loadLanes(source_durations), edge_durations);
+
+    const auto invalid =
+        _mm256_cmpeq_epi32(source_weight_lanes, _mm256_set1_epi32(INVALID_EDGE_WEIGHT));
+    const auto smaller_weight = _mm256_cmpgt_epi32(weights, new_weights);
+    const auto equal_weight = _mm256_cmpeq_epi32(weights, new_weights);
+    const auto smaller_duration = _mm256_cmpgt_epi32(durations, new_durations);
+    const auto improved = _mm256_andnot_si256(
+        invalid, _mm256_or_si256(smaller_weight, _mm256_and_si256(equal_weight, smaller_duration)));
+
+    weights = _mm256_blendv_epi8(weights, new_weights, improved);
+    durations = _mm256_blendv_epi8(durations, new_durations, improved);
+}
+
+// The labels of a node stay in two registers per array while its incoming edges are relaxed,
+// every edge adds its weight and duration to eight lanes at once.
+__attribute__((target("avx2"))) void restrictedSweepAVX2(const RestrictedPhastGraph &graph,
+                                                         PhastLaneLabels &labels)
+{
+    for (std::uint32_t index = 0; index < graph.GetNumberOfNodes(); ++index)
+    {
+        checkCancellation();
+
+        const auto weights = labels.GetWeights(index);
+        const auto durations = labels.GetDurations(index);
+        auto low_weights = loadLanes(weights);
+        auto high_weights = loadLanes(weights + 8);
+        auto low_durations = loadLanes(durations);
+        auto high_durations = loadLanes(durations + 8);
+
+        for (const auto &edge : graph.GetIncomingEdges(index))
+        {
+            const auto source_weights = labels.GetWeights(edge.source);
+            const auto source_durations = labels.GetDurations(edge.source);
+            const auto edge_weights = _mm256_set1_epi32(edge.weight);
+            const auto edge_durations = _mm256_set1_epi32(edge.duration);
+            relaxLanes(source_weights,
+                       source_durations,
+                       edge_weights,
+                       edge_durations,
+                       low_weights,
+                       low_durations);
+            relaxLanes(source_weights + 8,
+                       source_durations + 8,
+                       edge_weights,
+                       edge_durations,
+                       high_weights,
+                       high_durations);
+        }
+
+        storeLanes(weights, low_weights);
+        storeLanes(weights + 8, high_weights);
+        storeLanes(durations, low_durations);
+        storeLanes(durations + 8, high_durations);
+    }
+}
+#endif
+
+SweepKernel selectSweepKernel()
+{
+#ifdef OSRM_PHAST_SWEEP_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return restrictedSweepAVX2;
+#endif
+    return restrictedSweepScalar;
+}
+}
+
+void restrictedSweep(const RestrictedPhastGraph &graph, PhastLaneLabels &labels)
+{
+    BOOST_ASSERT(labels.weights.size() == graph.GetNumberOfNodes() * PHAST_LANES);
+    BOOST_ASSERT(labels.durations.size() == labels.weights.size());
+
+    static const SweepKernel sweep_kernel = selectSweepKernel();
+    sweep_kernel(graph, labels);
+}
+
+} // namespace ch
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
@@ -100,6 +100,7 @@ void search(SearchEngineData<Algorithm> & /*engine_working_data*/,
     // run two-Target Dijkstra routing step.
     while (0 < (forward_heap.Size() + reverse_heap.Size()))
     {
+        checkCancellation();
         if (!forward_heap.Empty())
         {
             routingStep<FORWARD_DIRECTION>(facade,
@@ -147,6 +148,107 @@ void search(SearchEngineData<Algorithm> & /*engine_working_data*/,
     }
 }
 
+void settleForwardSearchSpace(const DataFacade<Algorithm> &facade,
+                              SearchEngineData<Algorithm>::QueryHeap &forward_heap)
+{
+    while (!forward_heap.Empty())
+    {
+        checkCancellation();
+        const NodeID node = forward_heap.DeleteMin();
+        const EdgeWeight weight = forward_heap.GetKey(node);
+
+        if (stallAtNode<FORWARD_DIRECTION>(facade, node, weight, forward_heap))
+        {
+            continue;
+        }
+
+        relaxOutgoingEdges<FORWARD_DIRECTION>(facade, node, weight, forward_heap);
+    }
+}
+
+void searchToSettledForwardHeap(const DataFacade<Algorithm> &facade,
+                                const SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                                SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                                const EdgeWeight min_forward_weight,
+                                EdgeWeight &weight,
+                                std::vector<NodeID> &packed_leg,
+                                const bool force_loop_forward,
+                                const bool force_loop_reverse)
+{
+    NodeID middle = SPECIAL_NODEID;
+    weight = INVALID_EDGE_WEIGHT;
+
+    while (!reverse_heap.Empty())
+    {
+        checkCancellation();
+        const NodeID node = reverse_heap.DeleteMin();
+        const EdgeWeight reverse_weight = reverse_heap.GetKey(node);
+
+        // all paths over the remaining nodes are at least as heavy as the forward search started
+        if (reverse_weight + min_forward_weight > weight)
+        {
+            reverse_heap.DeleteAll();
+            break;
+        }
+
+        if (forward_heap.WasInserted(node))
+        {
+            const EdgeWeight new_weight = forward_heap.GetKey(node) + reverse_weight;
+            if (new_weight < weight)
+            {
+                // same as in routingStep, loops are forced at the source or the target
+                if ((force_loop_forward && forward_heap.GetData(node).parent == node) ||
+                    (force_loop_reverse && reverse_heap.GetData(node).parent == node) ||
+                    new_weight < 0)
+                {
+                    for (const auto edge : facade.GetAdjacentEdgeRange(node))
+                    {
+                        const auto &data = facade.GetEdgeData(edge);
+                        if (data.backward && facade.GetTarget(edge) == node)
+                        {
+                            const EdgeWeight loop_weight = new_weight + data.weight;
+                            if (loop_weight >= 0 && loop_weight < weight)
+                            {
+                                middle = node;
+                                weight = loop_weight;
+                            }
+                        }
+                    }
+                }
+                else
+                {
+                    middle = node;
+                    weight = new_weight;
+                }
+            }
+        }
+
+        if (stallAtNode<REVERSE_DIRECTION>(facade, node, reverse_weight, reverse_heap))
+        {
+            continue;
+        }
+
+        relaxOutgoingEdges<REVERSE_DIRECTION>(facade, node, reverse_weight, reverse_heap);
+    }
+
+    if (SPECIAL_NODEID == middle)
+    {
+        weight = INVALID_EDGE_WEIGHT;
+        return;
+    }
+
+    // make sure to correctly unpack loops
+    if (weight != forward_heap.GetKey(middle) + reverse_heap.GetKey(middle))
+    {
+        packed_leg.push_back(middle);
+        packed_leg.push_back(middle);
+    }
+    else
+    {
+        retrievePackedPathFromHeap(forward_heap, reverse_heap, middle, packed_leg);
+    }
+}
+
 // Requires the heaps for be empty
 // If heaps should be adjusted to be initialized outside of this function,
 // the addition of force_loop parameters might be required
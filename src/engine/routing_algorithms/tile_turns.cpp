@@ -1,5 +1,11 @@
 #include "engine/routing_algorithms/tile_turns.hpp"
 
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -20,6 +26,7 @@ struct EdgeBasedNodeInfo
 
 struct SegmentData
 {
+    NodeID source_node;
     NodeID target_node;
     EdgeID edge_based_node_id;
 };
@@ -28,21 +35,31 @@ template <typename edge_extractor, typename datafacade>
 std::vector<TurnData> generateTurns(const datafacade &facade,
                                     const std::vector<RTreeLeaf> &edges,
                                     const std::vector<std::size_t> &sorted_edge_indexes,
-                                    edge_extractor const &find_edge)
+                                    edge_extractor &find_edge)
 {
     // Lookup table for edge-based-nodes
     std::unordered_map<NodeID, EdgeBasedNodeInfo> edge_based_node_info;
-    std::unordered_map<NodeID, std::vector<SegmentData>> directed_graph;
+    edge_based_node_info.reserve(edges.size() * 2);
 
+    // The node based graph of the tile as one array of segments sorted by their source node.
     // Reserve enough space for unique edge-based-nodes on every edge.
-    // Only a tile with all unique edges will use this much, but
-    // it saves us a bunch of re-allocations during iteration.
+    std::vector<SegmentData> directed_graph;
     directed_graph.reserve(edges.size() * 2);
 
     const auto get_geometry_id = [&facade](auto edge) {
         return facade.GetGeometryIndex(edge.forward_segment_id.id).id;
     };
 
+    const auto add_edge_based_node = [&](const NodeID edge_based_node_id,
+                                         const bool is_geometry_forward,
+                                         const RTreeLeaf &edge) {
+        const auto inserted = edge_based_node_info.insert(
+            {edge_based_node_id, EdgeBasedNodeInfo{is_geometry_forward, get_geometry_id(edge)}});
+        BOOST_ASSERT(inserted.first->second.is_geometry_forward == is_geometry_forward);
+        BOOST_ASSERT(inserted.first->second.packed_geometry_id == get_geometry_id(edge));
+        (void)inserted;
+    };
+
     // To build a tile, we can only rely on the r-tree to quickly find all data visible within the
     // tile itself. The Rtree returns a series of segments that may or may not offer turns
     // associated with them. To be able to extract turn penalties, we extract a node based graph
@@ -52,46 +69,39 @@ std::vector<TurnData> generateTurns(const datafacade &facade,
         const auto &edge = edges[edge_index];
         if (edge.forward_segment_id.enabled)
         {
-            // operator[] will construct an empty vector at [edge.u] if there is no value.
-            directed_graph[edge.u].push_back({edge.v, edge.forward_segment_id.id});
-            if (edge_based_node_info.count(edge.forward_segment_id.id) == 0)
-            {
-                edge_based_node_info[edge.forward_segment_id.id] = {true, get_geometry_id(edge)};
-            }
-            else
-            {
-                BOOST_ASSERT(edge_based_node_info[edge.forward_segment_id.id].is_geometry_forward ==
-                             true);
-                BOOST_ASSERT(edge_based_node_info[edge.forward_segment_id.id].packed_geometry_id ==
-                             get_geometry_id(edge));
-            }
+            directed_graph.push_back({edge.u, edge.v, edge.forward_segment_id.id});
+            add_edge_based_node(edge.forward_segment_id.id, true, edge);
         }
         if (edge.reverse_segment_id.enabled)
         {
-            directed_graph[edge.v].push_back({edge.u, edge.reverse_segment_id.id});
-            if (edge_based_node_info.count(edge.reverse_segment_id.id) == 0)
-            {
-                edge_based_node_info[edge.reverse_segment_id.id] = {false, get_geometry_id(edge)};
-            }
-            else
-            {
-                BOOST_ASSERT(edge_based_node_info[edge.reverse_segment_id.id].is_geometry_forward ==
-                             false);
-                BOOST_ASSERT(edge_based_node_info[edge.reverse_segment_id.id].packed_geometry_id ==
-                             get_geometry_id(edge));
-            }
+            directed_graph.push_back({edge.v, edge.u, edge.reverse_segment_id.id});
+            add_edge_based_node(edge.reverse_segment_id.id, false, edge);
         }
     }
 
     // Make sure we traverse the startnodes in a consistent order
-    // to ensure identical PBF encoding on all platforms.
-    std::vector<NodeID> sorted_startnodes;
-    sorted_startnodes.reserve(directed_graph.size());
-    std::transform(directed_graph.begin(),
-                   directed_graph.end(),
-                   std::back_inserter(sorted_startnodes),
-                   [](auto const &node) { return node.first; });
-    std::sort(sorted_startnodes.begin(), sorted_startnodes.end());
+    // to ensure identical PBF encoding on all platforms. The segments of a node keep the order
+    // of the sorted edges.
+    std::stable_sort(directed_graph.begin(),
+                     directed_graph.end(),
+                     [](const SegmentData &lhs, const SegmentData &rhs) {
+                         return lhs.source_node < rhs.source_node;
+                     });
+
+    const auto get_outgoing_segments = [&directed_graph](const NodeID node) {
+        struct SourceLess
+        {
+            bool operator()(const SegmentData &segment, const NodeID node) const
+            {
+                return segment.source_node < node;
+            }
+            bool operator()(const NodeID node, const SegmentData &segment) const
+            {
+                return node < segment.source_node;
+            }
+        };
+        return std::equal_range(directed_graph.begin(), directed_graph.end(), node, SourceLess{});
+    };
 
     std::vector<TurnData> all_turn_data;
 
@@ -101,128 +111,104 @@ std::vector<TurnData> generateTurns(const datafacade &facade,
     //         w
     //  uv is the "approach"
     //  vw is the "exit"
-    std::vector<EdgeWeight> approach_weight_vector;
-    std::vector<EdgeWeight> approach_duration_vector;
 
-    // Look at every node in the directed graph we created
-    for (const auto &startnode : sorted_startnodes)
+    // Look at every segment in the directed graph we created
+    for (const auto &approachedge : directed_graph)
     {
-        BOOST_ASSERT(directed_graph.find(startnode) != directed_graph.end());
-        const auto &nodedata = directed_graph.find(startnode)->second;
-        // For all the outgoing edges from the node
-        for (const auto &approachedge : nodedata)
+        // If the target of this edge doesn't exist in our directed
+        // graph, it's probably outside the tile, so we can skip it
+        const auto exit_edges = get_outgoing_segments(approachedge.target_node);
+
+        // The weight and the coordinates of the approach are only needed once a turn is found
+        bool has_approach_data = false;
+        EdgeWeight sum_node_weight = 0;
+        EdgeWeight sum_node_duration = 0;
+        util::Coordinate coord_via;
+        int angle_in = 0;
+
+        // For each of the outgoing edges from our target coordinate
+        for (auto exit_edge = exit_edges.first; exit_edge != exit_edges.second; ++exit_edge)
         {
-            // If the target of this edge doesn't exist in our directed
-            // graph, it's probably outside the tile, so we can skip it
-            if (directed_graph.count(approachedge.target_node) == 0)
+            // If the next edge has the same edge_based_node_id, then it's
+            // not a turn, so skip it
+            if (approachedge.edge_based_node_id == exit_edge->edge_based_node_id)
                 continue;
 
-            // For each of the outgoing edges from our target coordinate
-            for (const auto &exit_edge : directed_graph.find(approachedge.target_node)->second)
+            // Skip u-turns
+            if (approachedge.source_node == exit_edge->target_node)
+                continue;
+
+            // Find the connection between our source road and the target node
+            EdgeID edge_based_edge_id =
+                find_edge(approachedge.edge_based_node_id, exit_edge->edge_based_node_id);
+
+            if (edge_based_edge_id == SPECIAL_EDGEID)
+                continue;
+
+            if (!has_approach_data)
             {
-                // If the next edge has the same edge_based_node_id, then it's
-                // not a turn, so skip it
-                if (approachedge.edge_based_node_id == exit_edge.edge_based_node_id)
-                    continue;
-
-                // Skip u-turns
-                if (startnode == exit_edge.target_node)
-                    continue;
-
-                // Find the connection between our source road and the target node
-                // Since we only want to find direct edges, we cannot check shortcut edges here.
-                // Otherwise we might find a forward edge even though a shorter backward edge
-                // exists (due to oneways).
-                //
-                // a > - > - > - b
-                // |             |
-                // |------ c ----|
-                //
-                // would offer a backward edge at `b` to `a` (due to the oneway from a to b)
-                // but could also offer a shortcut (b-c-a) from `b` to `a` which is longer.
-                EdgeID edge_based_edge_id =
-                    find_edge(approachedge.edge_based_node_id, exit_edge.edge_based_node_id);
-
-                if (edge_based_edge_id != SPECIAL_EDGEID)
-                {
-                    const auto &data = facade.GetEdgeData(edge_based_edge_id);
-
-                    // Now, calculate the sum of the weight of all the segments.
-                    if (edge_based_node_info.find(approachedge.edge_based_node_id)
-                            ->second.is_geometry_forward)
-                    {
-                        approach_weight_vector = facade.GetUncompressedForwardWeights(
-                            edge_based_node_info.find(approachedge.edge_based_node_id)
-                                ->second.packed_geometry_id);
-                        approach_duration_vector = facade.GetUncompressedForwardDurations(
-                            edge_based_node_info.find(approachedge.edge_based_node_id)
-                                ->second.packed_geometry_id);
-                    }
-                    else
-                    {
-                        approach_weight_vector = facade.GetUncompressedReverseWeights(
-                            edge_based_node_info.find(approachedge.edge_based_node_id)
-                                ->second.packed_geometry_id);
-                        approach_duration_vector = facade.GetUncompressedReverseDurations(
-                            edge_based_node_info.find(approachedge.edge_based_node_id)
-                                ->second.packed_geometry_id);
-                    }
-                    const auto sum_node_weight = std::accumulate(approach_weight_vector.begin(),
-                                                                 approach_weight_vector.end(),
-                                                                 EdgeWeight{0});
-                    const auto sum_node_duration = std::accumulate(approach_duration_vector.begin(),
-                                                                   approach_duration_vector.end(),
-                                                                   EdgeWeight{0});
-
-                    // The edge.weight is the whole edge weight, which includes the turn
-                    // cost.
-                    // The turn cost is the edge.weight minus the sum of the individual road
-                    // segment weights.  This might not be 100% accurate, because some
-                    // intersections include stop signs, traffic signals and other
-                    // penalties, but at this stage, we can't divide those out, so we just
-                    // treat the whole lot as the "turn cost" that we'll stick on the map.
-                    const auto turn_weight = data.weight - sum_node_weight;
-                    const auto turn_duration = data.duration - sum_node_duration;
-                    const auto turn_instruction = facade.GetTurnInstructionForEdgeID(data.turn_id);
-
-                    // Find the three nodes that make up the turn movement)
-                    const auto node_from = startnode;
-                    const auto node_via = approachedge.target_node;
-                    const auto node_to = exit_edge.target_node;
-
-                    const auto coord_from = facade.GetCoordinateOfNode(node_from);
-                    const auto coord_via = facade.GetCoordinateOfNode(node_via);
-                    const auto coord_to = facade.GetCoordinateOfNode(node_to);
-
-                    // Calculate the bearing that we approach the intersection at
-                    const auto angle_in = static_cast<int>(
-                        util::coordinate_calculation::bearing(coord_from, coord_via));
-
-                    const auto exit_bearing = static_cast<int>(
-                        util::coordinate_calculation::bearing(coord_via, coord_to));
-
-                    // Figure out the angle of the turn
-                    auto turn_angle = exit_bearing - angle_in;
-                    while (turn_angle > 180)
-                    {
-                        turn_angle -= 360;
-                    }
-                    while (turn_angle < -180)
-                    {
-                        turn_angle += 360;
-                    }
-
-                    // Save everything we need to later add all the points to the tile.
-                    // We need the coordinate of the intersection, the angle in, the turn
-                    // angle and the turn cost.
-                    all_turn_data.push_back(TurnData{coord_via,
-                                                     angle_in,
-                                                     turn_angle,
-                                                     turn_weight,
-                                                     turn_duration,
-                                                     turn_instruction});
-                }
+                BOOST_ASSERT(edge_based_node_info.count(approachedge.edge_based_node_id) > 0);
+                const auto &node_info =
+                    edge_based_node_info.find(approachedge.edge_based_node_id)->second;
+
+                // Now, calculate the sum of the weight of all the segments.
+                const auto approach_weight_vector =
+                    node_info.is_geometry_forward
+                        ? facade.GetUncompressedForwardWeights(node_info.packed_geometry_id)
+                        : facade.GetUncompressedReverseWeights(node_info.packed_geometry_id);
+                const auto approach_duration_vector =
+                    node_info.is_geometry_forward
+                        ? facade.GetUncompressedForwardDurations(node_info.packed_geometry_id)
+                        : facade.GetUncompressedReverseDurations(node_info.packed_geometry_id);
+                sum_node_weight = std::accumulate(approach_weight_vector.begin(),
+                                                  approach_weight_vector.end(),
+                                                  EdgeWeight{0});
+                sum_node_duration = std::accumulate(approach_duration_vector.begin(),
+                                                    approach_duration_vector.end(),
+                                                    EdgeWeight{0});
+
+                // Calculate the bearing that we approach the intersection at
+                const auto coord_from = facade.GetCoordinateOfNode(approachedge.source_node);
+                coord_via = facade.GetCoordinateOfNode(approachedge.target_node);
+                angle_in =
+                    static_cast<int>(util::coordinate_calculation::bearing(coord_from, coord_via));
+
+                has_approach_data = true;
+            }
+
+            const auto &data = facade.GetEdgeData(edge_based_edge_id);
+
+            // The edge.weight is the whole edge weight, which includes the turn
+            // cost.
+            // The turn cost is the edge.weight minus the sum of the individual road
+            // segment weights.  This might not be 100% accurate, because some
+            // intersections include stop signs, traffic signals and other
+            // penalties, but at this stage, we can't divide those out, so we just
+            // treat the whole lot as the "turn cost" that we'll stick on the map.
+            const auto turn_weight = data.weight - sum_node_weight;
+            const auto turn_duration = data.duration - sum_node_duration;
+            const auto turn_instruction = facade.GetTurnInstructionForEdgeID(data.turn_id);
+
+            const auto coord_to = facade.GetCoordinateOfNode(exit_edge->target_node);
+            const auto exit_bearing =
+                static_cast<int>(util::coordinate_calculation::bearing(coord_via, coord_to));
+
+            // Figure out the angle of the turn
+            auto turn_angle = exit_bearing - angle_in;
+            while (turn_angle > 180)
+            {
+                turn_angle -= 360;
+            }
+            while (turn_angle < -180)
+            {
+                turn_angle += 360;
             }
+
+            // Save everything we need to later add all the points to the tile.
+            // We need the coordinate of the intersection, the angle in, the turn
+            // angle and the turn cost.
+            all_turn_data.push_back(TurnData{
+                coord_via, angle_in, turn_angle, turn_weight, turn_duration, turn_instruction});
         }
     }
 
@@ -294,9 +280,29 @@ std::vector<TurnData> getTileTurns(const DataFacade<mld::Algorithm> &facade,
         EdgeFinderMLD(const DataFacade<mld::Algorithm> &facade) : facade(facade) {}
         const DataFacade<mld::Algorithm> &facade;
 
-        EdgeID operator()(const NodeID approach_node, const NodeID exit_node) const
+        // All exits of an approach are looked up in a row, so the adjacency of the approach
+        // node is only walked once for all of them
+        NodeID approach_node = SPECIAL_NODEID;
+        std::vector<std::pair<NodeID, EdgeID>> approach_edges;
+
+        EdgeID operator()(const NodeID approach_node_, const NodeID exit_node)
         {
-            return facade.FindEdge(approach_node, exit_node);
+            if (approach_node != approach_node_)
+            {
+                approach_node = approach_node_;
+                approach_edges.clear();
+                for (const auto edge : facade.GetAdjacentEdgeRange(approach_node))
+                {
+                    approach_edges.emplace_back(facade.GetTarget(edge), edge);
+                }
+            }
+
+            // The first edge to the exit node, as FindEdge does
+            const auto found = std::find_if(
+                approach_edges.begin(), approach_edges.end(), [exit_node](const auto &edge) {
+                    return edge.first == exit_node;
+                });
+            return found == approach_edges.end() ? SPECIAL_EDGEID : found->second;
         }
     };
 
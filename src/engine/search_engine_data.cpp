@@ -1,92 +1,178 @@
 #include "engine/search_engine_data.hpp"
 
+#include <atomic>
+
 namespace osrm
 {
 namespace engine
 {
 
-// CH heaps
-using CH = routing_algorithms::ch::Algorithm;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_1;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_1;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_2;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_2;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_3;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_3;
-SearchEngineData<CH>::ManyToManyHeapPtr SearchEngineData<CH>::many_to_many_heap;
-
-void SearchEngineData<CH>::InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes)
+namespace
+{
+template <typename HeapPtr>
+void initializeOrClearHeap(HeapPtr &heap,
+                           const unsigned number_of_nodes,
+                           const util::HeapStorageType storage_type)
 {
-    if (forward_heap_1.get())
+    if (heap.get() && heap->GetIndexStorage().IsReusable(number_of_nodes, storage_type))
     {
-        forward_heap_1->Clear();
+        heap->Clear();
     }
     else
     {
-        forward_heap_1.reset(new QueryHeap(number_of_nodes));
+        heap.reset(new typename HeapPtr::element_type(number_of_nodes, storage_type));
     }
+}
 
-    if (reverse_heap_1.get())
-    {
-        reverse_heap_1->Clear();
-    }
-    else
+// Memory that the heaps of all threads keep from previous queries, shared by all heap types
+std::atomic<std::size_t> retained_heap_memory{0};
+std::atomic<std::size_t> heap_threads{0};
+
+// The share of a thread in retained_heap_memory, given back when the thread exits
+struct ThreadHeapMemory
+{
+    ThreadHeapMemory() { ++heap_threads; }
+    ~ThreadHeapMemory()
     {
-        reverse_heap_1.reset(new QueryHeap(number_of_nodes));
+        retained_heap_memory -= retained;
+        --heap_threads;
     }
+
+    std::size_t retained = 0;
+};
+
+template <typename Algorithm> ThreadHeapMemory &threadHeapMemory()
+{
+    thread_local ThreadHeapMemory memory;
+    return memory;
 }
 
-void SearchEngineData<CH>::InitializeOrClearSecondThreadLocalStorage(unsigned number_of_nodes)
+std::size_t retainedMemory() { return 0; }
+
+template <typename HeapPtr, typename... HeapPtrs>
+std::size_t retainedMemory(const HeapPtr &heap, const HeapPtrs &... heaps)
 {
-    if (forward_heap_2.get())
-    {
-        forward_heap_2->Clear();
-    }
-    else
+    return (heap.get() ? heap->RetainedMemory() : 0) + retainedMemory(heaps...);
+}
+
+void shrink() {}
+
+template <typename HeapPtr, typename... HeapPtrs> void shrink(HeapPtr &heap, HeapPtrs &... heaps)
+{
+    if (heap.get())
     {
-        forward_heap_2.reset(new QueryHeap(number_of_nodes));
+        heap->Shrink();
     }
+    shrink(heaps...);
+}
+
+// Updates the share of the calling thread in retained_heap_memory, returns the total
+template <typename Algorithm> std::size_t accountRetainedMemory(const std::size_t retained)
+{
+    auto &thread_memory = threadHeapMemory<Algorithm>();
+    // unsigned arithmetic wraps, so this also works if the heaps of the thread shrank
+    const auto total = retained_heap_memory += retained - thread_memory.retained;
+    thread_memory.retained = retained;
+    return total;
+}
 
-    if (reverse_heap_2.get())
+// Heaps keep the memory of the largest search they ran. Once the heaps of all threads keep more
+// than max_heap_memory, threads keeping more than their share shrink the heaps they are about to
+// clear anyway, the others leave it to them. Heaps that are still in use by the query are only
+// counted, thread_retained returns the memory of all heaps of the thread.
+template <typename Algorithm, typename ThreadRetained, typename... HeapPtrs>
+void limitRetainedMemory(const std::size_t max_heap_memory,
+                         const ThreadRetained &thread_retained,
+                         HeapPtrs &... heaps)
+{
+    if (max_heap_memory == 0)
     {
-        reverse_heap_2->Clear();
+        return;
     }
-    else
+
+    const auto retained = thread_retained();
+    const auto total = accountRetainedMemory<Algorithm>(retained);
+    if (total <= max_heap_memory || retained * heap_threads <= max_heap_memory)
     {
-        reverse_heap_2.reset(new QueryHeap(number_of_nodes));
+        return;
     }
+
+    shrink(heaps...);
+    accountRetainedMemory<Algorithm>(thread_retained());
+}
+}
+
+// CH heaps
+using CH = routing_algorithms::ch::Algorithm;
+SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_1;
+SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_1;
+SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_2;
+SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_2;
+SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_3;
+SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_3;
+SearchEngineData<CH>::ManyToManyHeapPtr SearchEngineData<CH>::many_to_many_heap;
+SearchEngineData<CH>::UnpackingCachePtr SearchEngineData<CH>::unpacking_cache;
+SearchEngineData<CH>::PhastLabelsPtr SearchEngineData<CH>::phast_labels;
+
+void SearchEngineData<CH>::InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes)
+{
+    limitRetainedMemory<CH>(max_heap_memory, &ThreadRetainedMemory, forward_heap_1, reverse_heap_1);
+    initializeOrClearHeap(forward_heap_1, number_of_nodes, heap_storage_type);
+    initializeOrClearHeap(reverse_heap_1, number_of_nodes, heap_storage_type);
+    InitializeOrResetUnpackingCache();
+}
+
+void SearchEngineData<CH>::InitializeOrClearSecondThreadLocalStorage(unsigned number_of_nodes)
+{
+    limitRetainedMemory<CH>(max_heap_memory, &ThreadRetainedMemory, forward_heap_2, reverse_heap_2);
+    initializeOrClearHeap(forward_heap_2, number_of_nodes, heap_storage_type);
+    initializeOrClearHeap(reverse_heap_2, number_of_nodes, heap_storage_type);
 }
 
 void SearchEngineData<CH>::InitializeOrClearThirdThreadLocalStorage(unsigned number_of_nodes)
 {
-    if (forward_heap_3.get())
-    {
-        forward_heap_3->Clear();
-    }
-    else
-    {
-        forward_heap_3.reset(new QueryHeap(number_of_nodes));
-    }
+    limitRetainedMemory<CH>(max_heap_memory, &ThreadRetainedMemory, forward_heap_3, reverse_heap_3);
+    initializeOrClearHeap(forward_heap_3, number_of_nodes, heap_storage_type);
+    initializeOrClearHeap(reverse_heap_3, number_of_nodes, heap_storage_type);
+}
 
-    if (reverse_heap_3.get())
-    {
-        reverse_heap_3->Clear();
-    }
-    else
+void SearchEngineData<CH>::InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes)
+{
+    limitRetainedMemory<CH>(max_heap_memory, &ThreadRetainedMemory, many_to_many_heap);
+    initializeOrClearHeap(many_to_many_heap, number_of_nodes, heap_storage_type);
+    InitializeOrResetUnpackingCache();
+}
+
+routing_algorithms::ch::PhastLabels &SearchEngineData<CH>::GetPhastLabels()
+{
+    if (!phast_labels.get())
     {
-        reverse_heap_3.reset(new QueryHeap(number_of_nodes));
+        phast_labels.reset(new routing_algorithms::ch::PhastLabels());
     }
+    return *phast_labels;
 }
 
-void SearchEngineData<CH>::InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes)
+std::size_t SearchEngineData<CH>::ThreadRetainedMemory()
 {
-    if (many_to_many_heap.get())
+    return retainedMemory(forward_heap_1,
+                          reverse_heap_1,
+                          forward_heap_2,
+                          reverse_heap_2,
+                          forward_heap_3,
+                          reverse_heap_3,
+                          many_to_many_heap);
+}
+
+// Unlike the heaps the cache is kept between queries
+void SearchEngineData<CH>::InitializeOrResetUnpackingCache()
+{
+    if (unpacking_cache_size == 0)
     {
-        many_to_many_heap->Clear();
+        unpacking_cache.reset();
     }
-    else
+    else if (!unpacking_cache.get() || unpacking_cache->Capacity() != unpacking_cache_size)
     {
-        many_to_many_heap.reset(new ManyToManyQueryHeap(number_of_nodes));
+        unpacking_cache.reset(new routing_algorithms::UnpackingCache(unpacking_cache_size));
     }
 }
 
@@ -95,38 +181,34 @@ using MLD = routing_algorithms::mld::Algorithm;
 SearchEngineData<MLD>::SearchEngineHeapPtr SearchEngineData<MLD>::forward_heap_1;
 SearchEngineData<MLD>::SearchEngineHeapPtr SearchEngineData<MLD>::reverse_heap_1;
 SearchEngineData<MLD>::ManyToManyHeapPtr SearchEngineData<MLD>::many_to_many_heap;
+SearchEngineData<MLD>::ParallelSearchStatePtr SearchEngineData<MLD>::parallel_search_state;
 
 void SearchEngineData<MLD>::InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes)
 {
-    if (forward_heap_1.get())
-    {
-        forward_heap_1->Clear();
-    }
-    else
-    {
-        forward_heap_1.reset(new QueryHeap(number_of_nodes));
-    }
-
-    if (reverse_heap_1.get())
-    {
-        reverse_heap_1->Clear();
-    }
-    else
-    {
-        reverse_heap_1.reset(new QueryHeap(number_of_nodes));
-    }
+    limitRetainedMemory<MLD>(
+        max_heap_memory, &ThreadRetainedMemory, forward_heap_1, reverse_heap_1);
+    initializeOrClearHeap(forward_heap_1, number_of_nodes, heap_storage_type);
+    initializeOrClearHeap(reverse_heap_1, number_of_nodes, heap_storage_type);
 }
 
 void SearchEngineData<MLD>::InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes)
 {
-    if (many_to_many_heap.get())
-    {
-        many_to_many_heap->Clear();
-    }
-    else
+    limitRetainedMemory<MLD>(max_heap_memory, &ThreadRetainedMemory, many_to_many_heap);
+    initializeOrClearHeap(many_to_many_heap, number_of_nodes, heap_storage_type);
+}
+
+std::size_t SearchEngineData<MLD>::ThreadRetainedMemory()
+{
+    return retainedMemory(forward_heap_1, reverse_heap_1, many_to_many_heap);
+}
+
+routing_algorithms::ParallelSearchState &SearchEngineData<MLD>::GetParallelSearchState()
+{
+    if (!parallel_search_state.get())
     {
-        many_to_many_heap.reset(new ManyToManyQueryHeap(number_of_nodes));
+        parallel_search_state.reset(new routing_algorithms::ParallelSearchState());
     }
+    return *parallel_search_state;
 }
 }
 }
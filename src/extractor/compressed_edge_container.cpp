@@ -1,4 +1,5 @@
 #include "extractor/compressed_edge_container.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
 
 #include <boost/assert.hpp>
@@ -6,8 +7,10 @@
 #include <boost/filesystem/fstream.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
+#include <algorithm>
 #include <limits>
 #include <string>
+#include <utility>
 
 #include <iostream>
 
@@ -16,26 +19,18 @@ namespace osrm
 namespace extractor
 {
 
-CompressedEdgeContainer::CompressedEdgeContainer()
-{
-    m_free_list.reserve(100);
-    IncreaseFreeList();
-}
+constexpr std::size_t CompressedEdgeContainer::INVALID_SEGMENT;
 
-void CompressedEdgeContainer::IncreaseFreeList()
-{
-    m_compressed_oneway_geometries.resize(m_compressed_oneway_geometries.size() + 100);
-    for (unsigned i = 100; i > 0; --i)
-    {
-        m_free_list.emplace_back(free_list_maximum);
-        ++free_list_maximum;
-    }
-}
+bool CompressedEdgeContainer::IsFrozen() const { return !m_bucket_offsets.empty(); }
 
 bool CompressedEdgeContainer::HasEntryForID(const EdgeID edge_id) const
 {
-    auto iter = m_edge_id_to_list_index_map.find(edge_id);
-    return iter != m_edge_id_to_list_index_map.end();
+    if (IsFrozen())
+    {
+        return edge_id + std::size_t{1} < m_bucket_offsets.size() &&
+               m_bucket_offsets[edge_id] != m_bucket_offsets[edge_id + 1];
+    }
+    return edge_id < m_first_segment.size() && m_first_segment[edge_id] != INVALID_SEGMENT;
 }
 
 bool CompressedEdgeContainer::HasZippedEntryForForwardID(const EdgeID edge_id) const
@@ -50,19 +45,11 @@ bool CompressedEdgeContainer::HasZippedEntryForReverseID(const EdgeID edge_id) c
     return iter != m_reverse_edge_id_to_zipped_index_map.end();
 }
 
-unsigned CompressedEdgeContainer::GetPositionForID(const EdgeID edge_id) const
-{
-    auto map_iterator = m_edge_id_to_list_index_map.find(edge_id);
-    BOOST_ASSERT(map_iterator != m_edge_id_to_list_index_map.end());
-    BOOST_ASSERT(map_iterator->second < m_compressed_oneway_geometries.size());
-    return map_iterator->second;
-}
-
 unsigned CompressedEdgeContainer::GetZippedPositionForForwardID(const EdgeID edge_id) const
 {
     auto map_iterator = m_forward_edge_id_to_zipped_index_map.find(edge_id);
     BOOST_ASSERT(map_iterator != m_forward_edge_id_to_zipped_index_map.end());
-    BOOST_ASSERT(map_iterator->second < segment_data->nodes.size());
+    BOOST_ASSERT(map_iterator->second < zipped_nodes.size());
     return map_iterator->second;
 }
 
@@ -70,7 +57,7 @@ unsigned CompressedEdgeContainer::GetZippedPositionForReverseID(const EdgeID edg
 {
     auto map_iterator = m_reverse_edge_id_to_zipped_index_map.find(edge_id);
     BOOST_ASSERT(map_iterator != m_reverse_edge_id_to_zipped_index_map.end());
-    BOOST_ASSERT(map_iterator->second < segment_data->nodes.size());
+    BOOST_ASSERT(map_iterator->second < zipped_nodes.size());
     return map_iterator->second;
 }
 
@@ -129,78 +116,45 @@ void CompressedEdgeContainer::CompressEdge(const EdgeID edge_id_1,
     // 1. append via node id to list of edge_id_1
     // 2. find list for edge_id_2, if yes add all elements and delete it
 
-    // Add via node id. List is created if it does not exist
-    if (!HasEntryForID(edge_id_1))
-    {
-        // create a new entry in the map
-        if (0 == m_free_list.size())
-        {
-            // make sure there is a place to put the entries
-            IncreaseFreeList();
-        }
-        BOOST_ASSERT(!m_free_list.empty());
-        m_edge_id_to_list_index_map[edge_id_1] = m_free_list.back();
-        m_free_list.pop_back();
-    }
-
-    // find bucket index
-    const auto iter = m_edge_id_to_list_index_map.find(edge_id_1);
-    BOOST_ASSERT(iter != m_edge_id_to_list_index_map.end());
-    const unsigned edge_bucket_id1 = iter->second;
-    BOOST_ASSERT(edge_bucket_id1 == GetPositionForID(edge_id_1));
-    BOOST_ASSERT(edge_bucket_id1 < m_compressed_oneway_geometries.size());
-
-    std::vector<OnewayCompressedEdge> &edge_bucket_list1 =
-        m_compressed_oneway_geometries[edge_bucket_id1];
-
-    bool was_empty = edge_bucket_list1.empty();
+    BOOST_ASSERT(!IsFrozen());
 
     // note we don't save the start coordinate: it is implicitly given by edge 1
     // weight1 is the distance to the (currently) last coordinate in the bucket
-    if (was_empty)
+    if (!HasEntryForID(edge_id_1))
     {
-        edge_bucket_list1.emplace_back(
+        AppendSegment(
+            edge_id_1,
             OnewayCompressedEdge{via_node_id, ClipWeight(weight1), ClipDuration(duration1)});
     }
 
-    BOOST_ASSERT(0 < edge_bucket_list1.size());
-    BOOST_ASSERT(!edge_bucket_list1.empty());
-
     // if the via-node offers a penalty, we add the weight of the penalty as an artificial
     // segment that references SPECIAL_NODEID
     if (node_weight_penalty != INVALID_EDGE_WEIGHT &&
         node_duration_penalty != MAXIMAL_EDGE_DURATION)
     {
-        edge_bucket_list1.emplace_back(OnewayCompressedEdge{
-            via_node_id, ClipWeight(node_weight_penalty), ClipDuration(node_duration_penalty)});
+        AppendSegment(edge_id_1,
+                      OnewayCompressedEdge{via_node_id,
+                                           ClipWeight(node_weight_penalty),
+                                           ClipDuration(node_duration_penalty)});
     }
 
     if (HasEntryForID(edge_id_2))
     {
-        // second edge is not atomic anymore
-        const unsigned list_to_remove_index = GetPositionForID(edge_id_2);
-        BOOST_ASSERT(list_to_remove_index < m_compressed_oneway_geometries.size());
-
-        std::vector<OnewayCompressedEdge> &edge_bucket_list2 =
-            m_compressed_oneway_geometries[list_to_remove_index];
-
-        // found an existing list, append it to the list of edge_id_1
-        edge_bucket_list1.insert(
-            edge_bucket_list1.end(), edge_bucket_list2.begin(), edge_bucket_list2.end());
+        // second edge is not atomic anymore, its chain is linked to the end of the chain of
+        // edge_id_1 without copying any segments
+        m_next_segment[m_last_segment[edge_id_1]] = m_first_segment[edge_id_2];
+        m_last_segment[edge_id_1] = m_last_segment[edge_id_2];
 
         // remove the list of edge_id_2
-        m_edge_id_to_list_index_map.erase(edge_id_2);
-        BOOST_ASSERT(m_edge_id_to_list_index_map.end() ==
-                     m_edge_id_to_list_index_map.find(edge_id_2));
-        edge_bucket_list2.clear();
-        BOOST_ASSERT(0 == edge_bucket_list2.size());
-        m_free_list.emplace_back(list_to_remove_index);
-        BOOST_ASSERT(list_to_remove_index == m_free_list.back());
+        m_first_segment[edge_id_2] = INVALID_SEGMENT;
+        m_last_segment[edge_id_2] = INVALID_SEGMENT;
+        BOOST_ASSERT(!HasEntryForID(edge_id_2));
     }
     else
     {
         // we are certain that the second edge is atomic.
-        edge_bucket_list1.emplace_back(
+        AppendSegment(
+            edge_id_1,
             OnewayCompressedEdge{target_node_id, ClipWeight(weight2), ClipDuration(duration2)});
     }
 }
@@ -215,51 +169,87 @@ void CompressedEdgeContainer::AddUncompressedEdge(const EdgeID edge_id,
     BOOST_ASSERT(SPECIAL_NODEID != target_node_id);
     BOOST_ASSERT(INVALID_EDGE_WEIGHT != weight);
 
-    // Add via node id. List is created if it does not exist
+    BOOST_ASSERT(!IsFrozen());
+
+    // note we don't save the start coordinate: it is implicitly given by edge_id
+    // weight is the distance to the (currently) last coordinate in the bucket
+    // Don't re-add this if it's already in there.
     if (!HasEntryForID(edge_id))
     {
-        // create a new entry in the map
-        if (0 == m_free_list.size())
-        {
-            // make sure there is a place to put the entries
-            IncreaseFreeList();
-        }
-        BOOST_ASSERT(!m_free_list.empty());
-        m_edge_id_to_list_index_map[edge_id] = m_free_list.back();
-        m_free_list.pop_back();
+        AppendSegment(
+            edge_id,
+            OnewayCompressedEdge{target_node_id, ClipWeight(weight), ClipDuration(duration)});
     }
+}
 
-    // find bucket index
-    const auto iter = m_edge_id_to_list_index_map.find(edge_id);
-    BOOST_ASSERT(iter != m_edge_id_to_list_index_map.end());
-    const unsigned edge_bucket_id = iter->second;
-    BOOST_ASSERT(edge_bucket_id == GetPositionForID(edge_id));
-    BOOST_ASSERT(edge_bucket_id < m_compressed_oneway_geometries.size());
+void CompressedEdgeContainer::AppendSegment(const EdgeID edge_id,
+                                            const OnewayCompressedEdge segment)
+{
+    if (edge_id >= m_first_segment.size())
+    {
+        m_first_segment.resize(edge_id + std::size_t{1}, INVALID_SEGMENT);
+        m_last_segment.resize(edge_id + std::size_t{1}, INVALID_SEGMENT);
+    }
 
-    std::vector<OnewayCompressedEdge> &edge_bucket_list =
-        m_compressed_oneway_geometries[edge_bucket_id];
+    const auto segment_index = m_segments.size();
+    m_segments.push_back(segment);
+    m_next_segment.push_back(INVALID_SEGMENT);
 
-    // note we don't save the start coordinate: it is implicitly given by edge_id
-    // weight is the distance to the (currently) last coordinate in the bucket
-    // Don't re-add this if it's already in there.
-    if (edge_bucket_list.empty())
+    if (m_first_segment[edge_id] == INVALID_SEGMENT)
     {
-        edge_bucket_list.emplace_back(
-            OnewayCompressedEdge{target_node_id, ClipWeight(weight), ClipDuration(duration)});
+        m_first_segment[edge_id] = segment_index;
     }
+    else
+    {
+        m_next_segment[m_last_segment[edge_id]] = segment_index;
+    }
+    m_last_segment[edge_id] = segment_index;
+}
+
+void CompressedEdgeContainer::Freeze()
+{
+    if (IsFrozen())
+        return;
+
+    // every segment belongs to exactly one chain, chains are only ever linked together
+    std::vector<OnewayCompressedEdge> buckets;
+    buckets.reserve(m_segments.size());
+    m_bucket_offsets.reserve(m_first_segment.size() + 1);
+    m_bucket_offsets.push_back(0);
+    for (const auto first_segment : m_first_segment)
+    {
+        for (auto segment = first_segment; segment != INVALID_SEGMENT;
+             segment = m_next_segment[segment])
+        {
+            buckets.push_back(m_segments[segment]);
+        }
+        m_bucket_offsets.push_back(buckets.size());
+    }
+    BOOST_ASSERT(buckets.size() == m_segments.size());
+
+    m_segments = std::move(buckets);
+    m_next_segment = std::vector<std::size_t>{};
+    m_first_segment = std::vector<std::size_t>{};
+    m_last_segment = std::vector<std::size_t>{};
 }
 
 void CompressedEdgeContainer::InitializeBothwayVector()
 {
+    BOOST_ASSERT(IsFrozen());
+
+    // every geometry zips the buckets of an edge and its reverse edge and adds a start node
+    const auto number_of_geometries = m_bucket_offsets.size() / 2;
+    const auto number_of_nodes = m_segments.size() / 2 + number_of_geometries;
+
     segment_data = std::make_unique<SegmentDataContainer>();
-    segment_data->index.reserve(m_compressed_oneway_geometries.size());
-    segment_data->nodes.reserve(m_compressed_oneway_geometries.size());
-    segment_data->fwd_weights.reserve(m_compressed_oneway_geometries.size());
-    segment_data->rev_weights.reserve(m_compressed_oneway_geometries.size());
-    segment_data->fwd_durations.reserve(m_compressed_oneway_geometries.size());
-    segment_data->rev_durations.reserve(m_compressed_oneway_geometries.size());
-    segment_data->fwd_datasources.reserve(m_compressed_oneway_geometries.size());
-    segment_data->rev_datasources.reserve(m_compressed_oneway_geometries.size());
+    segment_data->index.reserve(number_of_geometries + 1);
+    zipped_nodes.reserve(number_of_nodes);
+    segment_data->fwd_weights.reserve(number_of_nodes);
+    segment_data->rev_weights.reserve(number_of_nodes);
+    segment_data->fwd_durations.reserve(number_of_nodes);
+    segment_data->rev_durations.reserve(number_of_nodes);
+    segment_data->fwd_datasources.reserve(number_of_nodes);
+    segment_data->rev_datasources.reserve(number_of_nodes);
 }
 
 unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID r_edge_id)
@@ -267,8 +257,8 @@ unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID
     if (!segment_data)
         InitializeBothwayVector();
 
-    const auto &forward_bucket = GetBucketReference(f_edge_id);
-    const auto &reverse_bucket = GetBucketReference(r_edge_id);
+    const auto forward_bucket = GetBucketReference(f_edge_id);
+    const auto reverse_bucket = GetBucketReference(r_edge_id);
 
     BOOST_ASSERT(forward_bucket.size() == reverse_bucket.size());
 
@@ -276,13 +266,13 @@ unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID
     m_forward_edge_id_to_zipped_index_map[f_edge_id] = zipped_geometry_id;
     m_reverse_edge_id_to_zipped_index_map[r_edge_id] = zipped_geometry_id;
 
-    segment_data->index.emplace_back(segment_data->nodes.size());
+    segment_data->index.emplace_back(zipped_nodes.size());
 
     const auto &first_node = reverse_bucket.back();
 
     constexpr DatasourceID LUA_SOURCE = 0;
 
-    segment_data->nodes.emplace_back(first_node.node_id);
+    zipped_nodes.emplace_back(first_node.node_id);
     segment_data->fwd_weights.emplace_back(INVALID_SEGMENT_WEIGHT);
     segment_data->rev_weights.emplace_back(first_node.weight);
     segment_data->fwd_durations.emplace_back(INVALID_SEGMENT_DURATION);
@@ -297,7 +287,7 @@ unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID
 
         BOOST_ASSERT(fwd_node.node_id == rev_node.node_id);
 
-        segment_data->nodes.emplace_back(fwd_node.node_id);
+        zipped_nodes.emplace_back(fwd_node.node_id);
         segment_data->fwd_weights.emplace_back(fwd_node.weight);
         segment_data->rev_weights.emplace_back(rev_node.weight);
         segment_data->fwd_durations.emplace_back(fwd_node.duration);
@@ -308,7 +298,7 @@ unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID
 
     const auto &last_node = forward_bucket.back();
 
-    segment_data->nodes.emplace_back(last_node.node_id);
+    zipped_nodes.emplace_back(last_node.node_id);
     segment_data->fwd_weights.emplace_back(last_node.weight);
     segment_data->rev_weights.emplace_back(INVALID_SEGMENT_WEIGHT);
     segment_data->fwd_durations.emplace_back(last_node.duration);
@@ -321,17 +311,18 @@ unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID
 
 void CompressedEdgeContainer::PrintStatistics() const
 {
-    const uint64_t compressed_edges = m_compressed_oneway_geometries.size();
-    BOOST_ASSERT(0 == compressed_edges % 2);
-    BOOST_ASSERT(m_compressed_oneway_geometries.size() + m_free_list.size() > 0);
+    BOOST_ASSERT(IsFrozen());
 
-    uint64_t compressed_geometries = 0;
+    uint64_t compressed_edges = 0;
     uint64_t longest_chain_length = 0;
-    for (const std::vector<OnewayCompressedEdge> &current_vector : m_compressed_oneway_geometries)
+    for (const auto edge_id : util::irange<std::size_t>(1, m_bucket_offsets.size()))
     {
-        compressed_geometries += current_vector.size();
-        longest_chain_length = std::max(longest_chain_length, (uint64_t)current_vector.size());
+        const uint64_t chain_length = m_bucket_offsets[edge_id] - m_bucket_offsets[edge_id - 1];
+        compressed_edges += chain_length > 0;
+        longest_chain_length = std::max(longest_chain_length, chain_length);
     }
+    BOOST_ASSERT(0 == compressed_edges % 2);
+    const uint64_t compressed_geometries = m_segments.size();
 
     if (clipped_weights > 0)
     {
@@ -353,11 +344,13 @@ void CompressedEdgeContainer::PrintStatistics() const
                 << (float)compressed_geometries / std::max((uint64_t)1, compressed_edges);
 }
 
-const CompressedEdgeContainer::OnewayEdgeBucket &
+CompressedEdgeContainer::OnewayEdgeBucket
 CompressedEdgeContainer::GetBucketReference(const EdgeID edge_id) const
 {
-    const unsigned index = m_edge_id_to_list_index_map.at(edge_id);
-    return m_compressed_oneway_geometries.at(index);
+    BOOST_ASSERT(IsFrozen());
+    const auto begin = m_bucket_offsets.at(edge_id);
+    const auto end = m_bucket_offsets.at(edge_id + std::size_t{1});
+    return OnewayEdgeBucket(m_segments.data() + begin, end - begin);
 }
 
 // Since all edges are technically in the compressed geometry container,
@@ -366,33 +359,54 @@ CompressedEdgeContainer::GetBucketReference(const EdgeID edge_id) const
 // that only contain one original segment
 bool CompressedEdgeContainer::IsTrivial(const EdgeID edge_id) const
 {
-    const auto &bucket = GetBucketReference(edge_id);
-    return bucket.size() == 1;
+    if (IsFrozen())
+        return GetBucketReference(edge_id).size() == 1;
+
+    BOOST_ASSERT(HasEntryForID(edge_id));
+    return m_first_segment[edge_id] == m_last_segment[edge_id];
 }
 
 NodeID CompressedEdgeContainer::GetFirstEdgeTargetID(const EdgeID edge_id) const
 {
-    const auto &bucket = GetBucketReference(edge_id);
-    BOOST_ASSERT(bucket.size() >= 1);
-    return bucket.front().node_id;
+    if (IsFrozen())
+        return GetBucketReference(edge_id).front().node_id;
+
+    BOOST_ASSERT(HasEntryForID(edge_id));
+    return m_segments[m_first_segment[edge_id]].node_id;
 }
 NodeID CompressedEdgeContainer::GetLastEdgeTargetID(const EdgeID edge_id) const
 {
-    const auto &bucket = GetBucketReference(edge_id);
-    BOOST_ASSERT(bucket.size() >= 1);
-    return bucket.back().node_id;
+    if (IsFrozen())
+        return GetBucketReference(edge_id).back().node_id;
+
+    BOOST_ASSERT(HasEntryForID(edge_id));
+    return m_segments[m_last_segment[edge_id]].node_id;
 }
 NodeID CompressedEdgeContainer::GetLastEdgeSourceID(const EdgeID edge_id) const
 {
-    const auto &bucket = GetBucketReference(edge_id);
-    BOOST_ASSERT(bucket.size() >= 2);
-    return bucket[bucket.size() - 2].node_id;
+    if (IsFrozen())
+    {
+        const auto bucket = GetBucketReference(edge_id);
+        BOOST_ASSERT(bucket.size() >= 2);
+        return bucket[bucket.size() - 2].node_id;
+    }
+
+    BOOST_ASSERT(HasEntryForID(edge_id));
+    auto segment = m_first_segment[edge_id];
+    BOOST_ASSERT(segment != m_last_segment[edge_id]);
+    while (m_next_segment[segment] != m_last_segment[edge_id])
+    {
+        segment = m_next_segment[segment];
+    }
+    return m_segments[segment].node_id;
 }
 
 std::unique_ptr<SegmentDataContainer> CompressedEdgeContainer::ToSegmentData()
 {
     // Finalize the index
-    segment_data->index.push_back(segment_data->nodes.size());
+    segment_data->index.push_back(zipped_nodes.size());
+    segment_data->nodes = SegmentDataContainer::SegmentNodeVector(zipped_nodes);
+    zipped_nodes = std::vector<NodeID>{};
 
     return std::move(segment_data);
 }
@@ -17,6 +17,7 @@
 #include "util/exception.hpp"
 #include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/opening_hours.hpp"
 #include "util/percent.hpp"
 #include "util/timing_util.hpp"
 
@@ -24,6 +25,7 @@
 #include <boost/crc.hpp>
 #include <boost/functional/hash.hpp>
 #include <boost/numeric/conversion/cast.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <algorithm>
 #include <cmath>
@@ -36,7 +38,6 @@
 
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
-#include <tbb/pipeline.h>
 #include <tbb/task_scheduler_init.h>
 
 namespace std
@@ -66,11 +67,11 @@ EdgeBasedGraphFactory::EdgeBasedGraphFactory(
     const util::NodeBasedDynamicGraph &node_based_graph,
     EdgeBasedNodeDataContainer &node_data_container,
     const CompressedEdgeContainer &compressed_edge_container,
-    const std::unordered_set<NodeID> &barrier_nodes,
-    const std::unordered_set<NodeID> &traffic_lights,
+    const util::IdSet<NodeID> &barrier_nodes,
+    const util::IdSet<NodeID> &traffic_lights,
     const std::vector<util::Coordinate> &coordinates,
     const NameTable &name_table,
-    const std::unordered_set<EdgeID> &segregated_edges,
+    const util::IdSet<EdgeID> &segregated_edges,
     const extractor::LaneDescriptionMap &lane_description_map)
     : m_edge_based_node_container(node_data_container), m_connectivity_checksum(0),
       m_number_of_edge_based_nodes(0), m_coordinates(coordinates),
@@ -107,6 +108,13 @@ void EdgeBasedGraphFactory::GetEdgeBasedNodeWeights(std::vector<EdgeWeight> &out
     swap(m_edge_based_node_weights, output_node_weights);
 }
 
+void EdgeBasedGraphFactory::GetIntersectionGeometries(
+    intersection::IntersectionGeometryCache &geometries)
+{
+    using std::swap; // Koenig swap
+    swap(m_intersection_geometries, geometries);
+}
+
 std::uint32_t EdgeBasedGraphFactory::GetConnectivityChecksum() const
 {
     return m_connectivity_checksum;
@@ -146,7 +154,7 @@ NBGToEBG EdgeBasedGraphFactory::InsertEdgeBasedNode(const NodeID node_u, const N
                  m_compressed_edge_container.HasEntryForID(edge_id_2));
     BOOST_ASSERT(m_compressed_edge_container.HasEntryForID(edge_id_1));
     BOOST_ASSERT(m_compressed_edge_container.HasEntryForID(edge_id_2));
-    const auto &forward_geometry = m_compressed_edge_container.GetBucketReference(edge_id_1);
+    const auto forward_geometry = m_compressed_edge_container.GetBucketReference(edge_id_1);
     BOOST_ASSERT(forward_geometry.size() ==
                  m_compressed_edge_container.GetBucketReference(edge_id_2).size());
     const auto segment_count = forward_geometry.size();
@@ -439,6 +447,15 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                                                               name_table,
                                                               street_name_suffix_table);
 
+    util::Log() << "Computing intersection geometries ...";
+    TIMER_START(intersection_geometries);
+    m_intersection_geometries = intersection::IntersectionGeometryCache(m_node_based_graph,
+                                                                        m_compressed_edge_container,
+                                                                        m_coordinates,
+                                                                        mergable_road_detector);
+    TIMER_STOP(intersection_geometries);
+    util::Log() << "ok, after " << TIMER_SEC(intersection_geometries) << "s";
+
     // FIXME these need to be tuned in pre-allocated size
     std::vector<TurnPenalty> turn_weight_penalties;
     std::vector<TurnPenalty> turn_duration_penalties;
@@ -452,25 +469,20 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
 
     // filled in during next stage, kept alive through following scope
     std::vector<Conditional> conditionals;
-    // The following block generates the edge-based-edges using a parallel processing pipeline.
-    // Sets of intersection IDs are batched in groups of GRAINSIZE (100) `generator_stage`, then
-    // those groups are processed in parallel `processor_stage`.  Finally, results are appended to
-    // the various buffer vectors by the `output_stage` in the same order that the `generator_stage`
-    // created them in (tbb::filter::serial_in_order creates this guarantee).  The order needs to be
-    // maintained because we depend on it later in the processing pipeline.
+    // The following block generates the edge-based-edges in parallel. Sets of intersection IDs
+    // are batched in groups of GRAINSIZE (100) and processed in parallel by
+    // `process_intersections` into their own buffers. Finally, the buffers are concatenated into
+    // the various output vectors in the order of the intersection IDs.
     {
         const NodeID node_count = m_node_based_graph.GetNumberOfNodes();
 
-        // Because we write TurnIndexBlock data as we go, we'll
-        // buffer them into groups of 1000 to reduce the syscall
-        // count by 1000x.  This doesn't need much memory, but
-        // greatly reduces the syscall overhead of writing lots
-        // of small objects
+        // The TurnIndexBlock data of the edges is written per wave of intersections, this buffer
+        // collects the turn indexes of the delayed data that is appended at the end
         std::vector<lookup::TurnIndexBlock> turn_indexes_write_buffer;
         turn_indexes_write_buffer.reserve(TURN_INDEX_WRITE_BUFFER_SIZE);
 
-        // This struct is the buffered output of the `processor_stage`.  This data is
-        // appended to the various output arrays/files by the `output_stage`.
+        // This struct is the buffered output of `process_intersections`.  This data is
+        // appended to the various output arrays/files after every wave of intersections.
         // same as IntersectionData, but grouped with edge to allow sorting after creating.
         struct EdgeWithData
         {
@@ -478,6 +490,8 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
             lookup::TurnIndexBlock turn_index;
             TurnPenalty turn_weight_penalty;
             TurnPenalty turn_duration_penalty;
+            // index of the turn in the buffer, the penalties are added once it is processed
+            std::uint32_t turn_id;
         };
 
         auto const transfer_data = [&](const EdgeWithData &edge_with_data) {
@@ -487,7 +501,7 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
             turn_indexes_write_buffer.push_back(edge_with_data.turn_index);
         };
 
-        struct EdgesPipelineBuffer
+        struct EdgesBuffer
         {
             std::size_t nodes_processed = 0;
 
@@ -495,11 +509,14 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
             std::vector<EdgeWithData> delayed_data;    // may need this
             std::vector<Conditional> conditionals;
 
+            // the turns of all edges of the buffer, processed by the profile with one call
+            std::vector<ExtractionTurn> turns;
+
             std::unordered_map<NodeBasedTurn, std::pair<NodeID, NodeID>> turn_to_ebn_map;
 
             util::ConnectivityChecksum checksum;
         };
-        using EdgesPipelineBufferPtr = std::shared_ptr<EdgesPipelineBuffer>;
+        using EdgesBufferPtr = std::shared_ptr<EdgesBuffer>;
 
         m_connectivity_checksum = 0;
 
@@ -507,83 +524,28 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
 
         // going over all nodes (which form the center of an intersection), we compute all possible
         // turns along these intersections.
-        NodeID current_node = 0;
 
-        // Handle intersections in sets of 100.  The pipeline below has a serial bottleneck during
-        // the writing phase, so we want to make the parallel workers do more work to give the
-        // serial final stage time to complete its tasks.
+        // Handle intersections in sets of 100. Each set writes into its own buffer, so the
+        // parallel workers do not share any state.
         const constexpr unsigned GRAINSIZE = 100;
 
-        // First part of the pipeline generates iterator ranges of IDs in sets of GRAINSIZE
-        tbb::filter_t<void, tbb::blocked_range<NodeID>> generator_stage(
-            tbb::filter::serial_in_order, [&](tbb::flow_control &fc) {
-                if (current_node < node_count)
-                {
-                    auto next_node = std::min(current_node + GRAINSIZE, node_count);
-                    auto result = tbb::blocked_range<NodeID>(current_node, next_node);
-                    current_node = next_node;
-                    return result;
-                }
-                else
-                {
-                    fc.stop();
-                    return tbb::blocked_range<NodeID>(node_count, node_count);
-                }
-            });
-
-        // Generate edges for either artificial nodes or the main graph
-        const auto generate_edge = [this,
-                                    &scripting_environment,
-                                    weight_multiplier,
-                                    &conditional_restriction_map](
-            // what nodes will be used? In most cases this will be the id
-            // stored in the edge_data. In case of duplicated nodes (e.g.
-            // due to via-way restrictions), one/both of these might
-            // refer to a newly added edge based node
-            const auto edge_based_node_from,
-            const auto edge_based_node_to,
-            // the situation of the turn
-            const auto node_along_road_entering,
-            const auto node_based_edge_from,
-            const auto intersection_node,
-            const auto node_based_edge_to,
-            const auto &turn_angle,
-            const auto &road_legs_on_the_right,
-            const auto &road_legs_on_the_left,
-            const auto &edge_geometries) {
-
-            const auto node_restricted =
-                isRestricted(node_along_road_entering,
-                             intersection_node,
-                             m_node_based_graph.GetTarget(node_based_edge_to),
-                             conditional_restriction_map);
-
-            boost::optional<Conditional> conditional = boost::none;
-            if (node_restricted.first)
-            {
-                auto const &conditions = node_restricted.second->condition;
-                // get conditions of the restriction limiting the node
-                conditional = {{edge_based_node_from,
-                                edge_based_node_to,
-                                {static_cast<std::uint64_t>(-1),
-                                 m_coordinates[intersection_node],
-                                 conditions}}};
-            }
-
+        // Describe a turn for the profile. The turn is the same for the edges of the main graph
+        // and of the artificial nodes, so it is processed once for all of them.
+        const auto generate_turn = [this](const auto node_based_edge_from,
+                                          const auto intersection_node,
+                                          const auto node_based_edge_to,
+                                          const auto &turn_angle,
+                                          const auto &road_legs_on_the_right,
+                                          const auto &road_legs_on_the_left,
+                                          const auto &edge_geometries) {
             const auto &edge_data1 = m_node_based_graph.GetEdgeData(node_based_edge_from);
             const auto &edge_data2 = m_node_based_graph.GetEdgeData(node_based_edge_to);
 
-            BOOST_ASSERT(nbe_to_ebn_mapping[node_based_edge_from] !=
-                         nbe_to_ebn_mapping[node_based_edge_to]);
-            BOOST_ASSERT(!edge_data1.reversed);
-            BOOST_ASSERT(!edge_data2.reversed);
-
-            // compute weight and duration penalties
             const auto is_traffic_light = m_traffic_lights.count(intersection_node);
             const auto is_uturn =
                 guidance::getTurnDirection(turn_angle) == guidance::DirectionModifier::UTurn;
 
-            ExtractionTurn extracted_turn(
+            return ExtractionTurn(
                 // general info
                 turn_angle,
                 road_legs_on_the_right.size() + road_legs_on_the_left.size() + 2 - is_uturn,
@@ -618,29 +580,59 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                 // connected roads
                 road_legs_on_the_right,
                 road_legs_on_the_left);
+        };
 
-            scripting_environment.ProcessTurn(extracted_turn);
+        // Generate edges for either artificial nodes or the main graph
+        const auto generate_edge = [this, &conditional_restriction_map](
+            // what nodes will be used? In most cases this will be the id
+            // stored in the edge_data. In case of duplicated nodes (e.g.
+            // due to via-way restrictions), one/both of these might
+            // refer to a newly added edge based node
+            const auto edge_based_node_from,
+            const auto edge_based_node_to,
+            // the situation of the turn
+            const auto node_along_road_entering,
+            const auto node_based_edge_from,
+            const auto intersection_node,
+            const auto node_based_edge_to,
+            const auto turn_id) {
 
-            // turn penalties are limited to [-2^15, 2^15) which roughly translates to 54 minutes
-            // and fits signed 16bit deci-seconds
-            auto weight_penalty =
-                boost::numeric_cast<TurnPenalty>(extracted_turn.weight * weight_multiplier);
-            auto duration_penalty = boost::numeric_cast<TurnPenalty>(extracted_turn.duration * 10.);
+            const auto node_restricted =
+                isRestricted(node_along_road_entering,
+                             intersection_node,
+                             m_node_based_graph.GetTarget(node_based_edge_to),
+                             conditional_restriction_map);
+
+            boost::optional<Conditional> conditional = boost::none;
+            if (node_restricted.first)
+            {
+                auto const &conditions = node_restricted.second->condition;
+                // get conditions of the restriction limiting the node
+                conditional = {{edge_based_node_from,
+                                edge_based_node_to,
+                                {static_cast<std::uint64_t>(-1),
+                                 m_coordinates[intersection_node],
+                                 conditions}}};
+            }
+
+            const auto &edge_data1 = m_node_based_graph.GetEdgeData(node_based_edge_from);
+
+            BOOST_ASSERT(nbe_to_ebn_mapping[node_based_edge_from] !=
+                         nbe_to_ebn_mapping[node_based_edge_to]);
+            BOOST_ASSERT(!edge_data1.reversed);
+            BOOST_ASSERT(!m_node_based_graph.GetEdgeData(node_based_edge_to).reversed);
 
             BOOST_ASSERT(SPECIAL_NODEID != nbe_to_ebn_mapping[node_based_edge_from]);
             BOOST_ASSERT(SPECIAL_NODEID != nbe_to_ebn_mapping[node_based_edge_to]);
 
-            // auto turn_id = m_edge_based_edge_list.size();
-            auto weight = boost::numeric_cast<EdgeWeight>(edge_data1.weight + weight_penalty);
-            auto duration = boost::numeric_cast<EdgeWeight>(edge_data1.duration + duration_penalty);
-
+            // the turn penalties are added once the turn is processed
             EdgeBasedEdge edge_based_edge = {
                 edge_based_node_from,
                 edge_based_node_to,
                 SPECIAL_NODEID, // This will be updated once the main loop
                                 // completes!
-                weight,
-                duration,
+                edge_data1.weight,
+                edge_data1.duration,
                 true,
                 false};
 
@@ -664,18 +656,42 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
             lookup::TurnIndexBlock turn_index_block = {from_node, intersection_node, to_node};
 
             // insert data into the designated buffer
-            return std::make_pair(
-                EdgeWithData{edge_based_edge, turn_index_block, weight_penalty, duration_penalty},
-                conditional);
+            return std::make_pair(EdgeWithData{edge_based_edge,
+                                               turn_index_block,
+                                               0,
+                                               0,
+                                               static_cast<std::uint32_t>(turn_id)},
+                                  conditional);
+        };
+
+        // Add the penalties of the processed turns to the edges of a buffer
+        const auto apply_turn_penalties = [weight_multiplier](
+            std::vector<EdgeWithData> &edges, const std::vector<ExtractionTurn> &turns) {
+            for (auto &edge_with_data : edges)
+            {
+                const auto &extracted_turn = turns[edge_with_data.turn_id];
+
+                // turn penalties are limited to [-2^15, 2^15) which roughly translates to 54
+                // minutes and fits signed 16bit deci-seconds
+                const auto weight_penalty =
+                    boost::numeric_cast<TurnPenalty>(extracted_turn.weight * weight_multiplier);
+                const auto duration_penalty =
+                    boost::numeric_cast<TurnPenalty>(extracted_turn.duration * 10.);
+
+                auto &data = edge_with_data.edge.data;
+                data.weight = boost::numeric_cast<EdgeWeight>(data.weight + weight_penalty);
+                data.duration = boost::numeric_cast<EdgeWeight>(data.duration + duration_penalty);
+                edge_with_data.turn_weight_penalty = weight_penalty;
+                edge_with_data.turn_duration_penalty = duration_penalty;
+            }
         };
 
         //
         // Edge-based-graph stage
         //
-        tbb::filter_t<tbb::blocked_range<NodeID>, EdgesPipelineBufferPtr> processor_stage(
-            tbb::filter::parallel, [&](const tbb::blocked_range<NodeID> &intersection_node_range) {
-
-                auto buffer = std::make_shared<EdgesPipelineBuffer>();
+        const auto process_intersections =
+            [&](const tbb::blocked_range<NodeID> &intersection_node_range) {
+                auto buffer = std::make_shared<EdgesBuffer>();
                 buffer->nodes_processed = intersection_node_range.size();
 
                 for (auto intersection_node = intersection_node_range.begin(),
@@ -693,11 +709,7 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                     intersection::IntersectionEdgeGeometries edge_geometries;
                     std::unordered_set<EdgeID> merged_edge_ids;
                     std::tie(edge_geometries, merged_edge_ids) =
-                        intersection::getIntersectionGeometries(m_node_based_graph,
-                                                                m_compressed_edge_container,
-                                                                m_coordinates,
-                                                                mergable_road_detector,
-                                                                intersection_node);
+                        m_intersection_geometries.Get(m_node_based_graph, intersection_node);
 
                     buffer->checksum.process_byte(incoming_edges.size());
                     buffer->checksum.process_byte(outgoing_edges.size());
@@ -888,6 +900,17 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                                 }
                             }
 
+                            // the turn is shared by the edge of the main graph and the edges of
+                            // the duplicated nodes below
+                            const auto turn_id = buffer->turns.size();
+                            buffer->turns.push_back(generate_turn(incoming_edge.edge,
+                                                                  outgoing_edge.node,
+                                                                  outgoing_edge.edge,
+                                                                  turn->angle,
+                                                                  road_legs_on_the_right,
+                                                                  road_legs_on_the_left,
+                                                                  edge_geometries));
+
                             { // scope to forget edge_with_data after
                                 const auto edge_with_data_and_condition =
                                     generate_edge(nbe_to_ebn_mapping[incoming_edge.edge],
@@ -896,10 +919,7 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                                                   incoming_edge.edge,
                                                   outgoing_edge.node,
                                                   outgoing_edge.edge,
-                                                  turn->angle,
-                                                  road_legs_on_the_right,
-                                                  road_legs_on_the_left,
-                                                  edge_geometries);
+                                                  turn_id);
 
                                 buffer->continuous_data.push_back(
                                     edge_with_data_and_condition.first);
@@ -951,10 +971,7 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                                                           incoming_edge.edge,
                                                           outgoing_edge.node,
                                                           outgoing_edge.edge,
-                                                          turn->angle,
-                                                          road_legs_on_the_right,
-                                                          road_legs_on_the_left,
-                                                          edge_geometries);
+                                                          turn_id);
 
                                         buffer->delayed_data.push_back(
                                             edge_with_data_and_condition.first);
@@ -985,10 +1002,7 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                                                           incoming_edge.edge,
                                                           outgoing_edge.node,
                                                           outgoing_edge.edge,
-                                                          turn->angle,
-                                                          road_legs_on_the_right,
-                                                          road_legs_on_the_left,
-                                                          edge_geometries);
+                                                          turn_id);
 
                                         buffer->delayed_data.push_back(
                                             edge_with_data_and_condition.first);
@@ -1004,38 +1018,99 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                     }
                 }
 
+                // cross into the profile once for all turns of the set
+                scripting_environment.ProcessTurns(buffer->turns);
+                apply_turn_penalties(buffer->continuous_data, buffer->turns);
+                apply_turn_penalties(buffer->delayed_data, buffer->turns);
+                buffer->turns.clear();
+                buffer->turns.shrink_to_fit();
+
                 return buffer;
-            });
+            };
 
-        // Last part of the pipeline puts all the calculated data into the serial buffers
         util::UnbufferedLog log;
         util::Percent routing_progress(log, node_count);
         std::vector<EdgeWithData> delayed_data;
-        tbb::filter_t<EdgesPipelineBufferPtr, void> output_stage(
-            tbb::filter::serial_in_order, [&](auto buffer) {
 
+        // The sets are processed in waves of many sets at once. The buffers of a wave are then
+        // concatenated in parallel, every buffer is copied to the offset that a prefix sum over the
+        // buffer sizes gives it. This keeps the order of the edges the same as with a serial loop
+        // over all nodes, which we depend on later in the processing pipeline. The waves bound the
+        // memory of the buffers that are alive at the same time.
+        const std::size_t sets_per_wave = tbb::task_scheduler_init::default_num_threads() * 32;
+        std::vector<EdgesBufferPtr> buffers;
+        std::vector<std::size_t> buffer_offsets;
+        std::vector<lookup::TurnIndexBlock> wave_turn_indexes;
+        NodeID wave_begin = 0;
+        while (wave_begin < node_count)
+        {
+            const NodeID wave_end = static_cast<NodeID>(
+                std::min<std::size_t>(wave_begin + sets_per_wave * GRAINSIZE, node_count));
+            const std::size_t number_of_sets = (wave_end - wave_begin + GRAINSIZE - 1) / GRAINSIZE;
+
+            buffers.resize(number_of_sets);
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, number_of_sets, 1),
+                              [&](const tbb::blocked_range<std::size_t> &range) {
+                                  for (auto set = range.begin(); set != range.end(); ++set)
+                                  {
+                                      const NodeID begin = wave_begin + set * GRAINSIZE;
+                                      const NodeID end = std::min(begin + GRAINSIZE, wave_end);
+                                      buffers[set] = process_intersections(
+                                          tbb::blocked_range<NodeID>(begin, end));
+                                  }
+                              });
+
+            buffer_offsets.resize(number_of_sets + 1);
+            buffer_offsets[0] = 0;
+            for (const auto set : util::irange<std::size_t>(0, number_of_sets))
+            {
+                buffer_offsets[set + 1] =
+                    buffer_offsets[set] + buffers[set]->continuous_data.size();
+            }
+
+            const auto wave_offset = m_edge_based_edge_list.size();
+            const auto new_size = wave_offset + buffer_offsets.back();
+            // NOTE: potential overflow here if we hit 2^32 routable edges
+            BOOST_ASSERT(new_size <= std::numeric_limits<NodeID>::max());
+            m_edge_based_edge_list.resize(new_size);
+            turn_weight_penalties.resize(new_size);
+            turn_duration_penalties.resize(new_size);
+            wave_turn_indexes.resize(buffer_offsets.back());
+
+            // Copy data from local buffers into global EBG data
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, number_of_sets, 1),
+                [&](const tbb::blocked_range<std::size_t> &range) {
+                    for (auto set = range.begin(); set != range.end(); ++set)
+                    {
+                        auto offset = buffer_offsets[set];
+                        for (const auto &edge_with_data : buffers[set]->continuous_data)
+                        {
+                            m_edge_based_edge_list[wave_offset + offset] = edge_with_data.edge;
+                            turn_weight_penalties[wave_offset + offset] =
+                                edge_with_data.turn_weight_penalty;
+                            turn_duration_penalties[wave_offset + offset] =
+                                edge_with_data.turn_duration_penalty;
+                            wave_turn_indexes[offset] = edge_with_data.turn_index;
+                            ++offset;
+                        }
+                    }
+                });
+
+            turn_penalties_index_file.ContinueFrom(
+                "/extractor/turn_index", wave_turn_indexes.data(), wave_turn_indexes.size());
+
+            // The remaining data is small compared to the edges and is merged in order
+            for (const auto &buffer : buffers)
+            {
                 routing_progress.PrintAddition(buffer->nodes_processed);
 
-                m_connectivity_checksum = buffer->checksum.update_checksum(m_connectivity_checksum);
+                m_connectivity_checksum =
+                    buffer->checksum.update_checksum(m_connectivity_checksum);
 
-                // Copy data from local buffers into global EBG data
-                std::for_each(
-                    buffer->continuous_data.begin(), buffer->continuous_data.end(), transfer_data);
                 conditionals.insert(
                     conditionals.end(), buffer->conditionals.begin(), buffer->conditionals.end());
 
-                // NOTE: potential overflow here if we hit 2^32 routable edges
-                BOOST_ASSERT(m_edge_based_edge_list.size() <= std::numeric_limits<NodeID>::max());
-
-                // Buffer writes to reduce syscall count
-                if (turn_indexes_write_buffer.size() >= TURN_INDEX_WRITE_BUFFER_SIZE)
-                {
-                    turn_penalties_index_file.ContinueFrom("/extractor/turn_index",
-                                                           turn_indexes_write_buffer.data(),
-                                                           turn_indexes_write_buffer.size());
-                    turn_indexes_write_buffer.clear();
-                }
-
                 // Copy via-way restrictions delayed data
                 delayed_data.insert(
                     delayed_data.end(), buffer->delayed_data.begin(), buffer->delayed_data.end());
@@ -1046,15 +1121,11 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                                   // TODO: log conflicts here
                                   global_turn_to_ebn_map.insert(p);
                               });
-            });
+            }
+            buffers.clear();
 
-        // Now, execute the pipeline.  The value of "5" here was chosen by experimentation
-        // on a 16-CPU machine and seemed to give the best performance.  This value needs
-        // to be balanced with the GRAINSIZE above - ideally, the pipeline puts as much work
-        // as possible in the `intersection_handler` step so that those parallel workers don't
-        // get blocked too much by the slower (io-performing) `buffer_storage`
-        tbb::parallel_pipeline(tbb::task_scheduler_init::default_num_threads() * 5,
-                               generator_stage & processor_stage & output_stage);
+            wave_begin = wave_end;
+        }
 
         // NOTE: buffer.delayed_data and buffer.delayed_turn_data have the same index
         std::for_each(delayed_data.begin(), delayed_data.end(), transfer_data);
@@ -1150,10 +1221,20 @@ EdgeBasedGraphFactory::IndexConditionals(std::vector<Conditional> &&conditionals
 {
     boost::unordered_multimap<std::pair<NodeID, NodeID>, ConditionalTurnPenalty *> index;
 
-    // build and index of all conditional restrictions
+    // build and index of all conditional restrictions, conditions that only depend on the
+    // weekday and the time of the day are compiled once here instead of on every update
     for (auto &conditional : conditionals)
-        index.insert(std::make_pair(std::make_pair(conditional.from_node, conditional.to_node),
-                                    &conditional.penalty));
+    {
+        auto &penalty = conditional.penalty;
+        if (auto schedule = util::CompileWeeklySchedule(penalty.conditions))
+        {
+            penalty.schedule = std::move(*schedule);
+            penalty.conditions.clear();
+        }
+
+        index.insert(
+            std::make_pair(std::make_pair(conditional.from_node, conditional.to_node), &penalty));
+    }
 
     std::vector<ConditionalTurnPenalty> indexed_restrictions;
 
@@ -10,6 +10,7 @@
 
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
+#include "util/external_sorter.hpp"
 #include "util/fingerprint.hpp"
 #include "util/log.hpp"
 #include "util/timing_util.hpp"
@@ -22,9 +23,13 @@
 #include <boost/numeric/conversion/cast.hpp>
 #include <boost/ref.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <tbb/parallel_sort.h>
 
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 #include <limits>
 #include <mutex>
 #include <sstream>
@@ -33,6 +38,15 @@ namespace
 {
 namespace oe = osrm::extractor;
 
+struct CmpNodeByID
+{
+    using value_type = oe::QueryNode;
+    bool operator()(const value_type &lhs, const value_type &rhs) const
+    {
+        return lhs.node_id < rhs.node_id;
+    }
+};
+
 struct CmpEdgeByOSMStartID
 {
     using value_type = oe::InternalExtractorEdge;
@@ -106,8 +120,28 @@ namespace osrm
 namespace extractor
 {
 
-ExtractionContainers::ExtractionContainers()
+struct ExtractionContainers::ExternalMemory
+{
+    ExternalMemory(const boost::filesystem::path &directory, const std::size_t buffer_size)
+        : nodes(directory, buffer_size / sizeof(QueryNode)),
+          edges(directory, buffer_size / sizeof(InternalExtractorEdge))
+    {
+    }
+
+    util::ExternalSorter<QueryNode, CmpNodeByID> nodes;
+    util::ExternalSorter<InternalExtractorEdge, CmpEdgeByOSMStartID> edges;
+};
+
+ExtractionContainers::ExtractionContainers(
+    const boost::filesystem::path &external_memory_directory,
+    const std::size_t external_memory_buffer_size)
 {
+    if (!external_memory_directory.empty())
+    {
+        external_memory = std::make_unique<ExternalMemory>(external_memory_directory,
+                                                           external_memory_buffer_size);
+    }
+
     // Insert four empty strings offsets for name, ref, destination, pronunciation, and exits
     name_offsets.push_back(0);
     name_offsets.push_back(0);
@@ -159,6 +193,29 @@ void ExtractionContainers::PrepareData(ScriptingEnvironment &scripting_environme
     WriteCharData(name_file_name);
 }
 
+ExtractionContainers::~ExtractionContainers() = default;
+
+void ExtractionContainers::AddNode(const QueryNode &node)
+{
+    if (external_memory)
+        external_memory->nodes.push_back(node);
+    else
+        all_nodes_list.push_back(node);
+}
+
+void ExtractionContainers::AddEdge(const InternalExtractorEdge &edge)
+{
+    if (external_memory)
+        external_memory->edges.push_back(edge);
+    else
+        all_edges_list.push_back(edge);
+}
+
+bool ExtractionContainers::HasEdges() const
+{
+    return external_memory ? !external_memory->edges.empty() : !all_edges_list.empty();
+}
+
 void ExtractionContainers::WriteCharData(const std::string &file_name)
 {
     util::UnbufferedLog log;
@@ -166,8 +223,7 @@ void ExtractionContainers::WriteCharData(const std::string &file_name)
     TIMER_START(write_index);
 
     files::writeNames(file_name,
-                      NameTable{NameTable::IndexedData(
-                          name_offsets.begin(), name_offsets.end(), name_char_data.begin())});
+                      NameTable(name_offsets.begin(), name_offsets.end(), name_char_data.begin()));
 
     TIMER_STOP(write_index);
     log << "ok, after " << TIMER_SEC(write_index) << "s";
@@ -194,14 +250,31 @@ void ExtractionContainers::PrepareNodes()
         log << "ok, after " << TIMER_SEC(erasing_dups) << "s";
     }
 
+    if (external_memory)
+    {
+        util::UnbufferedLog log;
+        log << "Merging used nodes        ... " << std::flush;
+        TIMER_START(merging_nodes);
+        // only the nodes that are referenced by ways are kept in memory
+        all_nodes_list.clear();
+        all_nodes_list.reserve(used_node_id_list.size());
+        auto ref_iter = used_node_id_list.begin();
+        const auto used_node_id_list_end = used_node_id_list.end();
+        external_memory->nodes.Merge([&](const QueryNode &node) {
+            while (ref_iter != used_node_id_list_end && *ref_iter < node.node_id)
+                ++ref_iter;
+            if (ref_iter != used_node_id_list_end && *ref_iter == node.node_id)
+                all_nodes_list.push_back(node);
+        });
+        TIMER_STOP(merging_nodes);
+        log << "ok, after " << TIMER_SEC(merging_nodes) << "s";
+    }
+    else
     {
         util::UnbufferedLog log;
         log << "Sorting all nodes         ... " << std::flush;
         TIMER_START(sorting_nodes);
-        tbb::parallel_sort(
-            all_nodes_list.begin(), all_nodes_list.end(), [](const auto &left, const auto &right) {
-                return left.node_id < right.node_id;
-            });
+        tbb::parallel_sort(all_nodes_list.begin(), all_nodes_list.end(), CmpNodeByID());
         TIMER_STOP(sorting_nodes);
         log << "ok, after " << TIMER_SEC(sorting_nodes) << "s";
     }
@@ -252,75 +325,86 @@ void ExtractionContainers::PrepareNodes()
 
 void ExtractionContainers::PrepareEdges(ScriptingEnvironment &scripting_environment)
 {
-    // Sort edges by start.
-    {
-        util::UnbufferedLog log;
-        log << "Sorting edges by start    ... " << std::flush;
-        TIMER_START(sort_edges_by_start);
-        tbb::parallel_sort(all_edges_list.begin(), all_edges_list.end(), CmpEdgeByOSMStartID());
-        TIMER_STOP(sort_edges_by_start);
-        log << "ok, after " << TIMER_SEC(sort_edges_by_start) << "s";
-    }
-
-    {
-        util::UnbufferedLog log;
-        log << "Setting start coords      ... " << std::flush;
-        TIMER_START(set_start_coords);
-        // Traverse list of edges and nodes in parallel and set start coord
-        auto node_iterator = all_nodes_list.begin();
-        auto edge_iterator = all_edges_list.begin();
+    // Traverse the edges sorted by start and the nodes in parallel and set the start coordinates
+    auto node_iterator = all_nodes_list.cbegin();
+    const auto all_nodes_list_end = all_nodes_list.cend();
+    const auto set_start_coordinate = [&](InternalExtractorEdge &edge) {
+        while (node_iterator != all_nodes_list_end &&
+               node_iterator->node_id < edge.result.osm_source_id)
+        {
+            ++node_iterator;
+        }
 
-        const auto all_edges_list_end = all_edges_list.end();
-        const auto all_nodes_list_end = all_nodes_list.end();
+        // Remove all remaining edges. They are invalid because there are no corresponding nodes
+        // for them. This happens when using osmosis with bbox or polygon to extract smaller areas.
+        if (node_iterator == all_nodes_list_end)
+        {
+            util::Log(logDEBUG) << "Found invalid node reference " << edge.result.source;
+            edge.result.source = SPECIAL_NODEID;
+            edge.result.osm_source_id = SPECIAL_OSM_NODEID;
+            return;
+        }
+        if (edge.result.osm_source_id < node_iterator->node_id)
+        {
+            util::Log(logDEBUG) << "Found invalid node reference " << edge.result.source;
+            edge.result.source = SPECIAL_NODEID;
+            return;
+        }
 
-        while (edge_iterator != all_edges_list_end && node_iterator != all_nodes_list_end)
+        // remove loops
+        if (edge.result.osm_source_id == edge.result.osm_target_id)
         {
-            if (edge_iterator->result.osm_source_id < node_iterator->node_id)
-            {
-                util::Log(logDEBUG) << "Found invalid node reference "
-                                    << edge_iterator->result.source;
-                edge_iterator->result.source = SPECIAL_NODEID;
-                ++edge_iterator;
-                continue;
-            }
-            if (edge_iterator->result.osm_source_id > node_iterator->node_id)
-            {
-                node_iterator++;
-                continue;
-            }
+            edge.result.source = SPECIAL_NODEID;
+            edge.result.target = SPECIAL_NODEID;
+            return;
+        }
 
-            // remove loops
-            if (edge_iterator->result.osm_source_id == edge_iterator->result.osm_target_id)
-            {
-                edge_iterator->result.source = SPECIAL_NODEID;
-                edge_iterator->result.target = SPECIAL_NODEID;
-                ++edge_iterator;
-                continue;
-            }
+        BOOST_ASSERT(edge.result.osm_source_id == node_iterator->node_id);
 
-            BOOST_ASSERT(edge_iterator->result.osm_source_id == node_iterator->node_id);
+        // assign new node id
+        const auto node_id = mapExternalToInternalNodeID(
+            used_node_id_list.begin(), used_node_id_list.end(), node_iterator->node_id);
+        BOOST_ASSERT(node_id != SPECIAL_NODEID);
+        edge.result.source = node_id;
 
-            // assign new node id
-            const auto node_id = mapExternalToInternalNodeID(
-                used_node_id_list.begin(), used_node_id_list.end(), node_iterator->node_id);
-            BOOST_ASSERT(node_id != SPECIAL_NODEID);
-            edge_iterator->result.source = node_id;
+        edge.source_coordinate.lat = node_iterator->lat;
+        edge.source_coordinate.lon = node_iterator->lon;
+    };
 
-            edge_iterator->source_coordinate.lat = node_iterator->lat;
-            edge_iterator->source_coordinate.lon = node_iterator->lon;
-            ++edge_iterator;
+    if (external_memory)
+    {
+        util::UnbufferedLog log;
+        log << "Merging edges by start    ... " << std::flush;
+        TIMER_START(merge_edges_by_start);
+        all_edges_list.clear();
+        all_edges_list.reserve(external_memory->edges.size());
+        external_memory->edges.Merge([&](InternalExtractorEdge edge) {
+            set_start_coordinate(edge);
+            all_edges_list.push_back(edge);
+        });
+        TIMER_STOP(merge_edges_by_start);
+        log << "ok, after " << TIMER_SEC(merge_edges_by_start) << "s";
+    }
+    else
+    {
+        // Sort edges by start.
+        {
+            util::UnbufferedLog log;
+            log << "Sorting edges by start    ... " << std::flush;
+            TIMER_START(sort_edges_by_start);
+            tbb::parallel_sort(all_edges_list.begin(), all_edges_list.end(), CmpEdgeByOSMStartID());
+            TIMER_STOP(sort_edges_by_start);
+            log << "ok, after " << TIMER_SEC(sort_edges_by_start) << "s";
         }
 
-        // Remove all remaining edges. They are invalid because there are no corresponding nodes for
-        // them. This happens when using osmosis with bbox or polygon to extract smaller areas.
-        auto markSourcesInvalid = [](InternalExtractorEdge &edge) {
-            util::Log(logDEBUG) << "Found invalid node reference " << edge.result.source;
-            edge.result.source = SPECIAL_NODEID;
-            edge.result.osm_source_id = SPECIAL_OSM_NODEID;
-        };
-        std::for_each(edge_iterator, all_edges_list_end, markSourcesInvalid);
-        TIMER_STOP(set_start_coords);
-        log << "ok, after " << TIMER_SEC(set_start_coords) << "s";
+        {
+            util::UnbufferedLog log;
+            log << "Setting start coords      ... " << std::flush;
+            TIMER_START(set_start_coords);
+            std::for_each(all_edges_list.begin(), all_edges_list.end(), set_start_coordinate);
+            TIMER_STOP(set_start_coords);
+            log << "ok, after " << TIMER_SEC(set_start_coords) << "s";
+        }
     }
 
     {
@@ -921,9 +1005,9 @@ void ExtractionContainers::PrepareManeuverOverrides()
 
 void ExtractionContainers::PrepareRestrictions()
 {
-
-    // contain the start/end nodes of each way that is part of an restriction
-    std::unordered_map<OSMWayID, FirstAndLastSegmentOfWay> referenced_ways;
+    // the ids of the ways that are part of a restriction, sorted, and their start/end segments
+    std::vector<OSMWayID> referenced_way_ids;
+    std::vector<FirstAndLastSegmentOfWay> referenced_ways;
 
     // prepare for extracting source/destination nodes for all restrictions
     {
@@ -933,41 +1017,64 @@ void ExtractionContainers::PrepareRestrictions()
         TIMER_START(prepare_restrictions);
 
         const auto mark_ids = [&](auto const &turn_restriction) {
-            FirstAndLastSegmentOfWay dummy_segment{
-                MAX_OSM_WAYID, MAX_OSM_NODEID, MAX_OSM_NODEID, MAX_OSM_NODEID, MAX_OSM_NODEID};
             if (turn_restriction.Type() == RestrictionType::WAY_RESTRICTION)
             {
                 const auto &way = turn_restriction.AsWayRestriction();
-                referenced_ways[way.from] = dummy_segment;
-                referenced_ways[way.to] = dummy_segment;
-                referenced_ways[way.via] = dummy_segment;
+                referenced_way_ids.push_back(way.from);
+                referenced_way_ids.push_back(way.to);
+                referenced_way_ids.push_back(way.via);
             }
             else
             {
                 BOOST_ASSERT(turn_restriction.Type() == RestrictionType::NODE_RESTRICTION);
                 const auto &node = turn_restriction.AsNodeRestriction();
-                referenced_ways[node.from] = dummy_segment;
-                referenced_ways[node.to] = dummy_segment;
+                referenced_way_ids.push_back(node.from);
+                referenced_way_ids.push_back(node.to);
             }
         };
 
+        referenced_way_ids.reserve(2 * restrictions_list.size());
         std::for_each(restrictions_list.begin(), restrictions_list.end(), mark_ids);
-
-        // enter invalid IDs into the above maps to indicate that we want to find out about
-        // start/end
-        // nodes of these ways
-        // update the values for all edges already sporting SPECIAL_NODEID
-        const auto set_ids = [&](auto const &start_end) {
-            auto itr = referenced_ways.find(start_end.way_id);
-            if (itr != referenced_ways.end())
-                itr->second = start_end;
+        tbb::parallel_sort(referenced_way_ids.begin(), referenced_way_ids.end());
+        referenced_way_ids.erase(std::unique(referenced_way_ids.begin(), referenced_way_ids.end()),
+                                 referenced_way_ids.end());
+
+        // the ways are sorted by their id, ways we do not know about keep an invalid id to
+        // indicate that we could not find out about their start/end nodes
+        referenced_ways.resize(referenced_way_ids.size(),
+                               FirstAndLastSegmentOfWay{MAX_OSM_WAYID,
+                                                        MAX_OSM_NODEID,
+                                                        MAX_OSM_NODEID,
+                                                        MAX_OSM_NODEID,
+                                                        MAX_OSM_NODEID});
+        const auto set_ids = [&](const tbb::blocked_range<std::size_t> &range) {
+            for (auto index = range.begin(); index != range.end(); ++index)
+            {
+                FirstAndLastSegmentOfWay key;
+                key.way_id = referenced_way_ids[index];
+                // the last entry of a way wins, like it would when overwriting them in order
+                auto itr = std::upper_bound(way_start_end_id_list.cbegin(),
+                                            way_start_end_id_list.cend(),
+                                            key,
+                                            FirstAndLastSegmentOfWayCompare());
+                if (itr != way_start_end_id_list.cbegin() && (--itr)->way_id == key.way_id)
+                    referenced_ways[index] = *itr;
+            }
         };
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, referenced_way_ids.size()), set_ids);
 
-        std::for_each(way_start_end_id_list.cbegin(), way_start_end_id_list.cend(), set_ids);
         TIMER_STOP(prepare_restrictions);
         log << "ok, after " << TIMER_SEC(prepare_restrictions) << "s";
     }
 
+    const auto find_referenced_way =
+        [&](const OSMWayID way_id) -> const FirstAndLastSegmentOfWay & {
+            const auto itr =
+                std::lower_bound(referenced_way_ids.begin(), referenced_way_ids.end(), way_id);
+            BOOST_ASSERT(itr != referenced_way_ids.end() && *itr == way_id);
+            return referenced_ways[std::distance(referenced_way_ids.begin(), itr)];
+        };
+
     auto const to_internal = [&](auto const osm_node) {
         auto internal = mapExternalToInternalNodeID(
             used_node_id_list.begin(), used_node_id_list.end(), osm_node);
@@ -1039,20 +1146,20 @@ void ExtractionContainers::PrepareRestrictions()
     // be connected at a single location)
     auto const get_node_restriction_from_OSM_ids = [&](
         auto const from_id, auto const to_id, const OSMNodeID via_node) {
-        auto const from_segment_itr = referenced_ways.find(from_id);
-        if (from_segment_itr->second.way_id != from_id)
+        auto const &from_segment = find_referenced_way(from_id);
+        if (from_segment.way_id != from_id)
         {
             util::Log(logDEBUG) << "Restriction references invalid way: " << from_id;
             return NodeRestriction{SPECIAL_NODEID, SPECIAL_NODEID, SPECIAL_NODEID};
         }
 
-        auto const to_segment_itr = referenced_ways.find(to_id);
-        if (to_segment_itr->second.way_id != to_id)
+        auto const &to_segment = find_referenced_way(to_id);
+        if (to_segment.way_id != to_id)
         {
             util::Log(logDEBUG) << "Restriction references invalid way: " << to_id;
             return NodeRestriction{SPECIAL_NODEID, SPECIAL_NODEID, SPECIAL_NODEID};
         }
-        return find_node_restriction(from_segment_itr->second, to_segment_itr->second, via_node);
+        return find_node_restriction(from_segment, to_segment, via_node);
     };
 
     // Transform an OSMRestriction (based on WayIDs) into an OSRM restriction (base on NodeIDs).
@@ -1110,7 +1217,9 @@ void ExtractionContainers::PrepareRestrictions()
     // wrapper function to handle distinction between conditional and unconditional turn
     // restrictions
     const auto transform_into_internal_types =
-        [&](const InputConditionalTurnRestriction &external_restriction) {
+        [&](const InputConditionalTurnRestriction &external_restriction,
+            std::vector<TurnRestriction> &unconditional_restrictions,
+            std::vector<ConditionalTurnRestriction> &conditional_restrictions) {
             // unconditional restriction
             if (external_restriction.condition.empty() &&
                 external_restriction.Type() == RestrictionType::NODE_RESTRICTION)
@@ -1118,7 +1227,7 @@ void ExtractionContainers::PrepareRestrictions()
                 TurnRestriction restriction;
                 restriction.is_only = external_restriction.is_only;
                 if (transform(external_restriction, restriction))
-                    unconditional_turn_restrictions.push_back(std::move(restriction));
+                    unconditional_restrictions.push_back(std::move(restriction));
             }
             // conditional turn restriction
             else
@@ -1128,19 +1237,48 @@ void ExtractionContainers::PrepareRestrictions()
                 restriction.condition = std::move(external_restriction.condition);
                 if (transform(external_restriction, restriction))
                 {
-                    conditional_turn_restrictions.push_back(std::move(restriction));
+                    conditional_restrictions.push_back(std::move(restriction));
                 }
             }
         };
 
-    // Transforming the restrictions into the dedicated internal types
+    // Transforming the restrictions into the dedicated internal types. The restrictions are
+    // transformed in chunks in parallel, appending the chunks in order keeps the input order.
     {
         util::UnbufferedLog log;
         log << "Collecting start/end information on " << restrictions_list.size()
             << " restrictions...";
         TIMER_START(transform);
-        std::for_each(
-            restrictions_list.begin(), restrictions_list.end(), transform_into_internal_types);
+
+        const constexpr std::size_t RESTRICTIONS_PER_CHUNK = 4096;
+        const auto number_of_chunks =
+            (restrictions_list.size() + RESTRICTIONS_PER_CHUNK - 1) / RESTRICTIONS_PER_CHUNK;
+        std::vector<std::vector<TurnRestriction>> unconditional_chunks(number_of_chunks);
+        std::vector<std::vector<ConditionalTurnRestriction>> conditional_chunks(number_of_chunks);
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, number_of_chunks),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              for (auto chunk = range.begin(); chunk != range.end(); ++chunk)
+                              {
+                                  const auto begin = chunk * RESTRICTIONS_PER_CHUNK;
+                                  const auto end = std::min(begin + RESTRICTIONS_PER_CHUNK,
+                                                            restrictions_list.size());
+                                  for (auto index = begin; index != end; ++index)
+                                  {
+                                      transform_into_internal_types(restrictions_list[index],
+                                                                    unconditional_chunks[chunk],
+                                                                    conditional_chunks[chunk]);
+                                  }
+                              }
+                          });
+
+        for (auto &chunk : unconditional_chunks)
+            std::move(
+                chunk.begin(), chunk.end(), std::back_inserter(unconditional_turn_restrictions));
+        for (auto &chunk : conditional_chunks)
+            std::move(
+                chunk.begin(), chunk.end(), std::back_inserter(conditional_turn_restrictions));
+
         TIMER_STOP(transform);
         log << "ok, after " << TIMER_SEC(transform) << "s";
     }
@@ -11,6 +11,7 @@
 #include "extractor/maneuver_override_relation_parser.hpp"
 #include "extractor/name_table.hpp"
 #include "extractor/node_based_graph_factory.hpp"
+#include "extractor/osm_change_set.hpp"
 #include "extractor/raster_source.hpp"
 #include "extractor/restriction_filter.hpp"
 #include "extractor/restriction_parser.hpp"
@@ -23,10 +24,12 @@
 
 #include "storage/io.hpp"
 
+#include "util/block_pool.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/phase_report.hpp"
 #include "util/range_table.hpp"
 #include "util/timing_util.hpp"
 
@@ -39,7 +42,7 @@
 // Keep debug include to make sure the debug header is in sync with types.
 #include "util/debug.hpp"
 
-#include "extractor/tarjan_scc.hpp"
+#include "extractor/parallel_scc.hpp"
 
 #include <boost/assert.hpp>
 #include <boost/filesystem.hpp>
@@ -49,8 +52,10 @@
 #include <boost/scope_exit.hpp>
 
 #include <osmium/handler/node_locations_for_ways.hpp>
-#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/index/map/all.hpp>
 #include <osmium/io/any_input.hpp>
+#include <osmium/io/pbf_output.hpp>
+#include <osmium/io/writer.hpp>
 #include <osmium/thread/pool.hpp>
 #include <osmium/visitor.hpp>
 
@@ -59,6 +64,10 @@
 
 #include <cstdlib>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include <algorithm>
 #include <atomic>
 #include <bitset>
@@ -80,6 +89,115 @@ namespace extractor
 
 namespace
 {
+using LocationIndex = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
+using LocationIndexFactory =
+    osmium::index::MapFactory<osmium::unsigned_object_id_type, osmium::Location>;
+
+// Returns 0 if unknown, which keeps the node locations index in memory
+std::uint64_t getPhysicalMemory()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    const auto pages = sysconf(_SC_PHYS_PAGES);
+    const auto page_size = sysconf(_SC_PAGE_SIZE);
+    return pages > 0 && page_size > 0 ? static_cast<std::uint64_t>(pages) * page_size : 0;
+#endif
+}
+
+// Creates the node locations index of the configured type. The "auto" type keeps the index in
+// memory while it takes at most a quarter of the physical memory and otherwise stores a dense
+// array in a file of the external memory directory or of the output directory. That file is
+// returned in index_file to be removed after the extraction.
+std::unique_ptr<LocationIndex> createLocationIndex(const ExtractorConfig &config,
+                                                   boost::filesystem::path &index_file)
+{
+    auto type = config.location_index_type;
+    if (type == "auto")
+    {
+        // about one node per 8 bytes of a PBF file, the other formats have less nodes per byte
+        const std::uint64_t sparse_bytes_per_node = 16;
+        const auto estimated_index_size =
+            boost::filesystem::file_size(config.input_path) / 8 * sparse_bytes_per_node;
+        const auto physical_memory = getPhysicalMemory();
+
+        type = "flex_mem";
+        if (physical_memory > 0 && estimated_index_size > physical_memory / 4)
+        {
+            const auto directory = config.external_memory_path.empty()
+                                       ? config.GetPath(".osrm").parent_path()
+                                       : config.external_memory_path;
+            index_file = boost::filesystem::absolute(
+                directory / boost::filesystem::unique_path("osrm-%%%%-%%%%-%%%%.locations"));
+            type = "dense_file_array," + index_file.string();
+        }
+    }
+
+    util::Log() << "Using node location index " << type;
+    const auto &factory = LocationIndexFactory::instance();
+    try
+    {
+        return factory.create_map(type);
+    }
+    catch (const osmium::map_factory_error &error)
+    {
+        std::string types;
+        for (const auto &name : factory.map_types())
+        {
+            types += " " + name;
+        }
+        throw util::exception(std::string(error.what()) + ", available types: auto" + types +
+                              SOURCE_REF);
+    }
+}
+
+// The PBF header only keeps a few fields, the relation index stores its signature as generator
+const constexpr char RELATION_INDEX_GENERATOR[] = "osrm-extract relation index ";
+
+// The input and change files and the relation types of the profile a relation index is written
+// for. An index is only read again for the same files with the same sizes and modification times.
+std::string relationIndexSignature(const ExtractorConfig &config,
+                                   const std::vector<std::string> &relation_types)
+{
+    std::string signature;
+    const auto add_file = [&signature](const boost::filesystem::path &path) {
+        signature += boost::filesystem::absolute(path).string() + ":" +
+                     std::to_string(boost::filesystem::file_size(path)) + ":" +
+                     std::to_string(boost::filesystem::last_write_time(path)) + ";";
+    };
+    add_file(config.input_path);
+    for (const auto &path : config.change_paths)
+    {
+        add_file(path);
+    }
+    for (const auto &type : relation_types)
+    {
+        signature += type + ",";
+    }
+    return signature;
+}
+
+bool isValidRelationIndex(const boost::filesystem::path &path, const std::string &signature)
+{
+    if (!boost::filesystem::exists(path))
+    {
+        return false;
+    }
+
+    try
+    {
+        osmium::io::Reader reader(osmium::io::File(path.string(), "pbf"),
+                                  osmium::osm_entity_bits::nothing);
+        const auto generator = reader.header().get("generator");
+        reader.close();
+        return generator == RELATION_INDEX_GENERATOR + signature;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
 // Converts the class name map into a fixed mapping of index to name
 void SetClassNames(const std::vector<std::string> &class_names,
                    ExtractorCallbacks::ClassesMap &classes_map,
@@ -219,6 +337,10 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
                                                     : tbb::task_scheduler_init::automatic);
     BOOST_ASSERT(init.is_active());
 
+    const auto intermediate_compression = config.compress_intermediate_files
+                                              ? storage::tar::FileWriter::CompressLargeEntries
+                                              : storage::tar::FileWriter::Uncompressed;
+
     LaneDescriptionMap turn_lane_map;
     std::vector<TurnRestriction> turn_restrictions;
     std::vector<ConditionalTurnRestriction> conditional_turn_restrictions;
@@ -235,6 +357,7 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
     util::Log() << "Generating edge-expanded graph representation";
 
     TIMER_START(expansion);
+    util::ReportPhase expansion_phase("expansion");
 
     EdgeBasedNodeDataContainer edge_based_nodes_container;
     std::vector<EdgeBasedNodeSegment> edge_based_node_segments;
@@ -248,19 +371,25 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
                                                    scripting_environment,
                                                    turn_restrictions,
                                                    conditional_turn_restrictions,
-                                                   unresolved_maneuver_overrides);
+                                                   unresolved_maneuver_overrides,
+                                                   config.spatial_node_order);
 
     NameTable name_table;
     files::readNames(config.GetPath(".osrm.names"), name_table);
 
-    util::Log() << "Find segregated edges in node-based graph ..." << std::flush;
-    TIMER_START(segregated);
+    // the segregated edges are only used by the guidance
+    util::IdSet<EdgeID> segregated_edges;
+    if (!config.skip_guidance)
+    {
+        util::Log() << "Find segregated edges in node-based graph ..." << std::flush;
+        TIMER_START(segregated);
 
-    auto segregated_edges = guidance::findSegregatedNodes(node_based_graph_factory, name_table);
+        segregated_edges = guidance::findSegregatedNodes(node_based_graph_factory, name_table);
 
-    TIMER_STOP(segregated);
-    util::Log() << "ok, after " << TIMER_SEC(segregated) << "s";
-    util::Log() << "Segregated edges count = " << segregated_edges.size();
+        TIMER_STOP(segregated);
+        util::Log() << "ok, after " << TIMER_SEC(segregated) << "s";
+        util::Log() << "Segregated edges count = " << segregated_edges.size();
+    }
 
     util::Log() << "Writing nodes for nodes-based and edges-based graphs ...";
     auto const &coordinates = node_based_graph_factory.GetCoordinates();
@@ -288,7 +417,8 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
     };
 
     files::writeCompressedNodeBasedGraph(config.GetPath(".osrm.cnbg").string(),
-                                         toEdgeList(node_based_graph));
+                                         toEdgeList(node_based_graph),
+                                         intermediate_compression);
 
     node_based_graph_factory.GetCompressedEdges().PrintStatistics();
 
@@ -303,6 +433,7 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
 
     const auto number_of_node_based_nodes = node_based_graph.GetNumberOfNodes();
 
+    intersection::IntersectionGeometryCache intersection_geometries;
     const auto number_of_edge_based_nodes =
         BuildEdgeExpandedGraph(node_based_graph,
                                coordinates,
@@ -321,45 +452,88 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
                                node_is_startpoint,
                                edge_based_node_weights,
                                edge_based_edge_list,
+                               intersection_geometries,
                                ebg_connectivity_checksum);
 
-    ProcessGuidanceTurns(node_based_graph,
-                         edge_based_nodes_container,
-                         coordinates,
-                         node_based_graph_factory.GetCompressedEdges(),
-                         barrier_nodes,
-                         turn_restrictions,
-                         conditional_turn_restrictions,
-                         name_table,
-                         std::move(turn_lane_map),
-                         scripting_environment);
+    if (config.skip_guidance)
+    {
+        WriteGuidanceStubs(number_of_node_based_nodes,
+                           edge_based_edge_list.size(),
+                           turn_lane_map,
+                           ebg_connectivity_checksum);
+    }
+    else
+    {
+        ProcessGuidanceTurns(node_based_graph,
+                             edge_based_nodes_container,
+                             coordinates,
+                             node_based_graph_factory.GetCompressedEdges(),
+                             intersection_geometries,
+                             barrier_nodes,
+                             turn_restrictions,
+                             conditional_turn_restrictions,
+                             name_table,
+                             std::move(turn_lane_map),
+                             scripting_environment);
+    }
+    // the geometries take memory in the order of the node-based graph
+    intersection_geometries = intersection::IntersectionGeometryCache();
 
+    expansion_phase.Stop();
     TIMER_STOP(expansion);
 
+    // hands the blocks of the temporary graphs of the expansion and the guidance back to the OS
+    util::BlockPool::GetInstance().Trim();
+
+    util::ReportPhase writing_phase("writing_geometry");
+
     // output the geometry of the node-based graph, needs to be done after the last usage, since it
     // destroys internal containers
-    files::writeSegmentData(config.GetPath(".osrm.geometry"),
-                            *node_based_graph_factory.GetCompressedEdges().ToSegmentData());
+    {
+        const auto segment_data = node_based_graph_factory.GetCompressedEdges().ToSegmentData();
+        files::writeSegmentData(config.GetPath(".osrm.geometry"), *segment_data);
+
+        // a file of an earlier extraction would not match the new segment data
+        const auto geometry_coordinates_path = config.GetPath(".osrm.geometry_coordinates");
+        if (config.compact_geometry_coordinates)
+        {
+            files::writeGeometryCoordinates(
+                geometry_coordinates_path,
+                GeometryCoordinatesContainer{*segment_data, coordinates});
+        }
+        else if (boost::filesystem::exists(geometry_coordinates_path))
+        {
+            boost::filesystem::remove(geometry_coordinates_path);
+        }
+    }
 
     util::Log() << "Saving edge-based node weights to file.";
     TIMER_START(timer_write_node_weights);
-    extractor::files::writeEdgeBasedNodeWeights(config.GetPath(".osrm.enw"),
-                                                edge_based_node_weights);
+    extractor::files::writeEdgeBasedNodeWeights(
+        config.GetPath(".osrm.enw"), edge_based_node_weights, intermediate_compression);
     TIMER_STOP(timer_write_node_weights);
     util::Log() << "Done writing. (" << TIMER_SEC(timer_write_node_weights) << ")";
+    writing_phase.Stop();
 
     util::Log() << "Computing strictly connected components ...";
+    util::ReportPhase components_phase("components");
     FindComponents(number_of_edge_based_nodes,
                    edge_based_edge_list,
                    edge_based_node_segments,
                    edge_based_nodes_container);
+    components_phase.Stop();
 
     util::Log() << "Building r-tree ...";
     TIMER_START(rtree);
-    BuildRTree(std::move(edge_based_node_segments), std::move(node_is_startpoint), coordinates);
-
+    util::ReportPhase rtree_phase("rtree");
+    BuildRTree(std::move(edge_based_node_segments),
+               std::move(node_is_startpoint),
+               coordinates,
+               edge_based_nodes_container);
+    rtree_phase.Stop();
     TIMER_STOP(rtree);
 
+    util::ReportPhase writing_graph_phase("writing_graph");
     files::writeNodeData(config.GetPath(".osrm.ebg_nodes"), edge_based_nodes_container);
 
     util::Log() << "Writing edge-based-graph edges       ... " << std::flush;
@@ -367,8 +541,10 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
     files::writeEdgeBasedGraph(config.GetPath(".osrm.ebg"),
                                number_of_edge_based_nodes,
                                edge_based_edge_list,
-                               ebg_connectivity_checksum);
+                               ebg_connectivity_checksum,
+                               intermediate_compression);
     TIMER_STOP(write_edges);
+    writing_graph_phase.Stop();
     util::Log() << "ok, after " << TIMER_SEC(write_edges) << "s";
 
     util::Log() << "Processed " << edge_based_edge_list.size() << " edges";
@@ -407,6 +583,7 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
 
     util::Log() << "Parsing in progress..";
     TIMER_START(parsing);
+    util::ReportPhase parsing_phase("parsing");
 
     { // Parse OSM header
         osmium::io::Reader reader(input_file, pool, osmium::osm_entity_bits::nothing);
@@ -429,7 +606,8 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
     }
 
     // Extraction containers and restriction parser
-    ExtractionContainers extraction_containers;
+    ExtractionContainers extraction_containers(config.external_memory_path,
+                                               config.external_memory_buffer_size * 1024 * 1024);
     ExtractorCallbacks::ClassesMap classes_map;
     LaneDescriptionMap turn_lane_map;
     auto extractor_callbacks =
@@ -465,32 +643,74 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
 
     ExtractionRelationContainer relations;
 
-    const auto buffer_reader = [](osmium::io::Reader &reader) {
+    // the changes of the change files are applied to the input while it is read
+    std::unique_ptr<OSMChangeSet> change_set;
+    if (!config.change_paths.empty())
+    {
+        change_set = std::make_unique<OSMChangeSet>(config.change_paths);
+    }
+
+    // the changes are already applied to the relations of a relation index
+    const auto buffer_reader = [&change_set](osmium::io::Reader &reader,
+                                             const osmium::osm_entity_bits::type entities,
+                                             const bool apply_changes) {
+        std::shared_ptr<OSMChangeSet::Merger> merger;
+        if (change_set && apply_changes)
+        {
+            merger = std::make_shared<OSMChangeSet::Merger>(*change_set, entities);
+        }
+
         return tbb::filter_t<void, SharedBuffer>(
-            tbb::filter::serial_in_order, [&reader](tbb::flow_control &fc) {
+            tbb::filter::serial_in_order, [&reader, merger](tbb::flow_control &fc) {
                 if (auto buffer = reader.read())
                 {
+                    if (merger)
+                    {
+                        return std::make_shared<osmium::memory::Buffer>(merger->Apply(buffer));
+                    }
                     return std::make_shared<osmium::memory::Buffer>(std::move(buffer));
                 }
-                else
+
+                if (merger)
                 {
-                    fc.stop();
-                    return SharedBuffer{};
+                    // objects created after the last object of the input
+                    auto created = merger->Finish();
+                    if (created.committed() > 0)
+                    {
+                        return std::make_shared<osmium::memory::Buffer>(std::move(created));
+                    }
                 }
+
+                fc.stop();
+                return SharedBuffer{};
             });
     };
 
     // Node locations cache (assumes nodes are placed before ways)
-    using osmium_index_type =
-        osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
-    using osmium_location_handler_type = osmium::handler::NodeLocationsForWays<osmium_index_type>;
+    using osmium_location_handler_type = osmium::handler::NodeLocationsForWays<LocationIndex>;
 
-    osmium_index_type location_cache;
-    osmium_location_handler_type location_handler(location_cache);
+    const auto use_location_cache =
+        scripting_environment.HasLocationDependentData() && config.use_locations_cache;
+    boost::filesystem::path location_index_file;
+    BOOST_SCOPE_EXIT_ALL(&)
+    {
+        if (!location_index_file.empty())
+        {
+            boost::system::error_code error;
+            boost::filesystem::remove(location_index_file, error);
+        }
+    };
+    std::unique_ptr<LocationIndex> location_cache;
+    std::unique_ptr<osmium_location_handler_type> location_handler;
+    if (use_location_cache)
+    {
+        location_cache = createLocationIndex(config, location_index_file);
+        location_handler = std::make_unique<osmium_location_handler_type>(*location_cache);
+    }
 
     tbb::filter_t<SharedBuffer, SharedBuffer> location_cacher(
         tbb::filter::serial_in_order, [&location_handler](SharedBuffer buffer) {
-            osmium::apply(buffer->begin(), buffer->end(), location_handler);
+            osmium::apply(buffer->begin(), buffer->end(), *location_handler);
             return buffer;
         });
 
@@ -545,12 +765,26 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
 
         });
 
-    tbb::filter_t<SharedBuffer, std::shared_ptr<ExtractionRelationContainer>> buffer_relation_cache(
+    // relations of the profile are copied to a buffer for the relation index while it is written
+    std::unique_ptr<osmium::io::Writer> relation_index_writer;
+    struct ParsedRelations
+    {
+        std::shared_ptr<ExtractionRelationContainer> relations;
+        SharedBuffer index_buffer;
+    };
+
+    tbb::filter_t<SharedBuffer, ParsedRelations> buffer_relation_cache(
         tbb::filter::parallel, [&](const SharedBuffer buffer) {
             if (!buffer)
-                return std::shared_ptr<ExtractionRelationContainer>{};
+                return ParsedRelations{};
 
             auto relations = std::make_shared<ExtractionRelationContainer>();
+            SharedBuffer index_buffer;
+            if (relation_index_writer)
+            {
+                index_buffer = std::make_shared<osmium::memory::Buffer>(
+                    buffer->committed() / 4 + 1024, osmium::memory::Buffer::auto_grow::yes);
+            }
             for (auto entity = buffer->cbegin(), end = buffer->cend(); entity != end; ++entity)
             {
                 if (entity->type() != osmium::item_type::relation)
@@ -564,6 +798,11 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
                         relation_types.begin(), relation_types.end(), std::string(rel_type)))
                     continue;
 
+                if (index_buffer)
+                {
+                    index_buffer->push_back(rel);
+                }
+
                 ExtractionRelation extracted_rel({rel.id(), osmium::item_type::relation});
                 for (auto const &t : rel.tags())
                     extracted_rel.attributes.emplace_back(std::make_pair(t.key(), t.value()));
@@ -577,16 +816,19 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
 
                 relations->AddRelation(std::move(extracted_rel));
             };
-            return relations;
+            return ParsedRelations{relations, index_buffer};
         });
 
     unsigned number_of_relations = 0;
-    tbb::filter_t<std::shared_ptr<ExtractionRelationContainer>, void> buffer_storage_relation(
-        tbb::filter::serial_in_order,
-        [&](const std::shared_ptr<ExtractionRelationContainer> parsed_relations) {
+    tbb::filter_t<ParsedRelations, void> buffer_storage_relation(
+        tbb::filter::serial_in_order, [&](const ParsedRelations &parsed_relations) {
 
-            number_of_relations += parsed_relations->GetRelationsNum();
-            relations.Merge(std::move(*parsed_relations));
+            number_of_relations += parsed_relations.relations->GetRelationsNum();
+            relations.Merge(std::move(*parsed_relations.relations));
+            if (parsed_relations.index_buffer && parsed_relations.index_buffer->committed() > 0)
+            {
+                (*relation_index_writer)(std::move(*parsed_relations.index_buffer));
+            }
         });
 
     // Parse OSM elements with parallel transformer
@@ -596,37 +838,84 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
         config.use_metadata ? osmium::io::read_meta::yes : osmium::io::read_meta::no;
 
     { // Relations reading pipeline
-        util::Log() << "Parse relations ...";
-        osmium::io::Reader reader(input_file, pool, osmium::osm_entity_bits::relation, read_meta);
-        tbb::parallel_pipeline(
-            num_threads, buffer_reader(reader) & buffer_relation_cache & buffer_storage_relation);
+        const auto &index_path = config.relation_index_path;
+        std::string signature;
+        if (!index_path.empty())
+        {
+            signature = relationIndexSignature(config, relation_types);
+        }
+
+        if (!index_path.empty() && isValidRelationIndex(index_path, signature))
+        {
+            util::Log() << "Parse relations from relation index " << index_path.string()
+                        << " ...";
+            osmium::io::Reader reader(osmium::io::File(index_path.string(), "pbf"),
+                                      pool,
+                                      osmium::osm_entity_bits::relation);
+            tbb::parallel_pipeline(num_threads,
+                                   buffer_reader(reader, osmium::osm_entity_bits::relation, false) &
+                                       buffer_relation_cache & buffer_storage_relation);
+        }
+        else
+        {
+            // the index is written to a temporary file first, a failed extraction leaves no
+            // index behind that looks valid
+            boost::filesystem::path temporary_index_path;
+            if (!index_path.empty())
+            {
+                util::Log() << "Writing relation index " << index_path.string();
+                temporary_index_path = index_path.string() + ".tmp";
+                osmium::io::Header header;
+                header.set("generator", RELATION_INDEX_GENERATOR + signature);
+                relation_index_writer = std::make_unique<osmium::io::Writer>(
+                    osmium::io::File(temporary_index_path.string(), "pbf"),
+                    header,
+                    osmium::io::overwrite::allow);
+            }
+
+            util::Log() << "Parse relations ...";
+            osmium::io::Reader reader(
+                input_file, pool, osmium::osm_entity_bits::relation, read_meta);
+            tbb::parallel_pipeline(num_threads,
+                                   buffer_reader(reader, osmium::osm_entity_bits::relation, true) &
+                                       buffer_relation_cache & buffer_storage_relation);
+
+            if (relation_index_writer)
+            {
+                relation_index_writer->close();
+                relation_index_writer.reset();
+                boost::filesystem::rename(temporary_index_path, index_path);
+            }
+        }
     }
 
     { // Nodes and ways reading pipeline
         util::Log() << "Parse ways and nodes ...";
-        osmium::io::Reader reader(input_file,
-                                  pool,
-                                  osmium::osm_entity_bits::node | osmium::osm_entity_bits::way |
-                                      osmium::osm_entity_bits::relation,
-                                  read_meta);
-
-        const auto pipeline =
-            scripting_environment.HasLocationDependentData() && config.use_locations_cache
-                ? buffer_reader(reader) & location_cacher & buffer_transformer & buffer_storage
-                : buffer_reader(reader) & buffer_transformer & buffer_storage;
+        const auto entities = osmium::osm_entity_bits::node | osmium::osm_entity_bits::way |
+                              osmium::osm_entity_bits::relation;
+        osmium::io::Reader reader(input_file, pool, entities, read_meta);
+
+        const auto pipeline = use_location_cache ? buffer_reader(reader, entities, true) &
+                                                       location_cacher & buffer_transformer &
+                                                       buffer_storage
+                                                 : buffer_reader(reader, entities, true) &
+                                                       buffer_transformer & buffer_storage;
         tbb::parallel_pipeline(num_threads, pipeline);
     }
 
+    parsing_phase.Stop();
     TIMER_STOP(parsing);
     util::Log() << "Parsing finished after " << TIMER_SEC(parsing) << " seconds";
 
+    util::ReportPhase preparing_phase("preparing_data");
+
     util::Log() << "Raw input contains " << number_of_nodes << " nodes, " << number_of_ways
                 << " ways, and " << number_of_relations << " relations, " << number_of_restrictions
                 << " restrictions";
 
     extractor_callbacks.reset();
 
-    if (extraction_containers.all_edges_list.empty())
+    if (!extraction_containers.HasEdges())
     {
         throw util::exception(std::string("There are no edges remaining after parsing.") +
                               SOURCE_REF);
@@ -642,6 +931,7 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
     SetExcludableClasses(classes_map, excludable_classes, profile_properties);
     files::writeProfileProperties(config.GetPath(".osrm.properties").string(), profile_properties);
 
+    preparing_phase.Stop();
     TIMER_STOP(extracting);
     util::Log() << "extraction finished after " << TIMER_SEC(extracting) << "s";
 
@@ -696,7 +986,7 @@ void Extractor::FindComponents(unsigned number_of_edge_based_nodes,
 
     auto uncontracted_graph = UncontractedGraph(number_of_edge_based_nodes, edges);
 
-    TarjanSCC<UncontractedGraph> component_search(uncontracted_graph);
+    ParallelSCC<UncontractedGraph> component_search(uncontracted_graph);
     component_search.Run();
 
     for (NodeID node_id = 0; node_id < number_of_edge_based_nodes; ++node_id)
@@ -718,11 +1008,11 @@ EdgeID Extractor::BuildEdgeExpandedGraph(
     const util::NodeBasedDynamicGraph &node_based_graph,
     const std::vector<util::Coordinate> &coordinates,
     const CompressedEdgeContainer &compressed_edge_container,
-    const std::unordered_set<NodeID> &barrier_nodes,
-    const std::unordered_set<NodeID> &traffic_signals,
+    const util::IdSet<NodeID> &barrier_nodes,
+    const util::IdSet<NodeID> &traffic_signals,
     const std::vector<TurnRestriction> &turn_restrictions,
     const std::vector<ConditionalTurnRestriction> &conditional_turn_restrictions,
-    const std::unordered_set<EdgeID> &segregated_edges,
+    const util::IdSet<EdgeID> &segregated_edges,
     const NameTable &name_table,
     const std::vector<UnresolvedManeuverOverride> &maneuver_overrides,
     const LaneDescriptionMap &turn_lane_map,
@@ -734,6 +1024,7 @@ EdgeID Extractor::BuildEdgeExpandedGraph(
     std::vector<bool> &node_is_startpoint,
     std::vector<EdgeWeight> &edge_based_node_weights,
     util::DeallocatingVector<EdgeBasedEdge> &edge_based_edge_list,
+    intersection::IntersectionGeometryCache &intersection_geometries,
     std::uint32_t &connectivity_checksum)
 {
     EdgeBasedGraphFactory edge_based_graph_factory(node_based_graph,
@@ -782,6 +1073,7 @@ EdgeID Extractor::BuildEdgeExpandedGraph(
     edge_based_graph_factory.GetEdgeBasedNodeSegments(edge_based_node_segments);
     edge_based_graph_factory.GetStartPointMarkers(node_is_startpoint);
     edge_based_graph_factory.GetEdgeBasedNodeWeights(edge_based_node_weights);
+    edge_based_graph_factory.GetIntersectionGeometries(intersection_geometries);
     connectivity_checksum = edge_based_graph_factory.GetConnectivityChecksum();
 
     return number_of_edge_based_nodes;
@@ -790,11 +1082,13 @@ EdgeID Extractor::BuildEdgeExpandedGraph(
 /**
     \brief Building rtree-based nearest-neighbor data structure
 
-    Saves tree into '.ramIndex' and leaves into '.fileIndex'.
+    Saves tree into '.ramIndex' and leaves into '.fileIndex'. The components of the nodes let
+    the tree skip the segments of tiny components when snapping to a big component.
  */
 void Extractor::BuildRTree(std::vector<EdgeBasedNodeSegment> edge_based_node_segments,
                            std::vector<bool> node_is_startpoint,
-                           const std::vector<util::Coordinate> &coordinates)
+                           const std::vector<util::Coordinate> &coordinates,
+                           const EdgeBasedNodeDataContainer &nodes_container)
 {
     util::Log() << "Constructing r-tree of " << edge_based_node_segments.size()
                 << " segments build on-top of " << coordinates.size() << " coordinates";
@@ -823,9 +1117,23 @@ void Extractor::BuildRTree(std::vector<EdgeBasedNodeSegment> edge_based_node_seg
     }
     edge_based_node_segments.resize(new_size);
 
+    // the forward and the reverse node of a segment are in the same component
+    std::vector<bool> tiny_component_segments(edge_based_node_segments.size());
+    for (auto index : util::irange<std::size_t>(0UL, edge_based_node_segments.size()))
+    {
+        const auto &segment = edge_based_node_segments[index];
+        const auto node_id = segment.forward_segment_id.enabled ? segment.forward_segment_id.id
+                                                                : segment.reverse_segment_id.id;
+        tiny_component_segments[index] = nodes_container.GetComponentID(node_id).is_tiny;
+    }
+
     TIMER_START(construction);
-    util::StaticRTree<EdgeBasedNodeSegment> rtree(
-        edge_based_node_segments, coordinates, config.GetPath(".osrm.fileIndex"));
+    util::StaticRTree<EdgeBasedNodeSegment> rtree(edge_based_node_segments,
+                                                  coordinates,
+                                                  config.GetPath(".osrm.fileIndex"),
+                                                  config.rtree_branching_factor,
+                                                  config.rtree_leaf_page_size,
+                                                  tiny_component_segments);
 
     files::writeRamIndex(config.GetPath(".osrm.ramIndex"), rtree);
 
@@ -849,7 +1157,8 @@ void Extractor::ProcessGuidanceTurns(
     const extractor::EdgeBasedNodeDataContainer &edge_based_node_container,
     const std::vector<util::Coordinate> &node_coordinates,
     const CompressedEdgeContainer &compressed_edge_container,
-    const std::unordered_set<NodeID> &barrier_nodes,
+    const intersection::IntersectionGeometryCache &intersection_geometries,
+    const util::IdSet<NodeID> &barrier_nodes,
     const std::vector<TurnRestriction> &turn_restrictions,
     const std::vector<ConditionalTurnRestriction> &conditional_turn_restrictions,
     const NameTable &name_table,
@@ -888,6 +1197,7 @@ void Extractor::ProcessGuidanceTurns(
                                       name_table,
                                       street_name_suffix_table,
                                       turn_lanes_data,
+                                      intersection_geometries,
                                       lane_description_map,
                                       lane_data_map,
                                       turn_data_container,
@@ -933,5 +1243,52 @@ void Extractor::ProcessGuidanceTurns(
     util::Log() << "ok, after " << TIMER_SEC(write_guidance_data) << "s";
 }
 
+void Extractor::WriteGuidanceStubs(const std::size_t number_of_node_based_nodes,
+                                   const std::size_t number_of_edge_based_edges,
+                                   const LaneDescriptionMap &lane_description_map,
+                                   const std::uint32_t connectivity_checksum)
+{
+    util::Log() << "Skipping guidance, writing turns and intersections without guidance data...";
+    TIMER_START(write_guidance_stubs);
+
+    // All intersections share one empty bearing class and all turns one empty entry class, so the
+    // files stay valid for the engine. The checksum of the edge-based graph is used for the turns,
+    // since it is the same that the turn analysis of the guidance would compute.
+    std::vector<BearingClassID> bearing_class_by_node_based_node(number_of_node_based_nodes, 0);
+    files::writeIntersections(
+        config.GetPath(".osrm.icd").string(),
+        IntersectionBearingsContainer{bearing_class_by_node_based_node,
+                                      {util::guidance::BearingClass{}}},
+        std::vector<util::guidance::EntryClass>{util::guidance::EntryClass{}});
+
+    files::writeTurnLaneData(config.GetPath(".osrm.tld"),
+                             std::vector<util::guidance::LaneTupleIdPair>{});
+
+    {
+        std::vector<std::uint32_t> turn_lane_offsets;
+        std::vector<TurnLaneType::Mask> turn_lane_masks;
+        std::tie(turn_lane_offsets, turn_lane_masks) =
+            transformTurnLaneMapIntoArrays(lane_description_map);
+        files::writeTurnLaneDescriptions(
+            config.GetPath(".osrm.tls"), turn_lane_offsets, turn_lane_masks);
+    }
+
+    osrm::guidance::TurnDataExternalContainer turn_data_container;
+    const osrm::guidance::TurnData no_turn{osrm::guidance::TurnInstruction::NO_TURN(),
+                                           INVALID_LANE_DATAID,
+                                           0,
+                                           osrm::guidance::TurnBearing(0),
+                                           osrm::guidance::TurnBearing(0)};
+    for (std::size_t turn = 0; turn < number_of_edge_based_edges; ++turn)
+    {
+        turn_data_container.push_back(no_turn);
+    }
+    osrm::guidance::files::writeTurnData(
+        config.GetPath(".osrm.edges").string(), turn_data_container, connectivity_checksum);
+
+    TIMER_STOP(write_guidance_stubs);
+    util::Log() << "ok, after " << TIMER_SEC(write_guidance_stubs) << "s";
+}
+
 } // namespace extractor
 } // namespace osrm
@@ -54,7 +54,7 @@ void ExtractorCallbacks::ProcessNode(const osmium::Node &input_node,
 {
     const auto id = OSMNodeID{static_cast<std::uint64_t>(input_node.id())};
 
-    external_memory.all_nodes_list.push_back(
+    external_memory.AddNode(
         QueryNode{util::toFixed(util::UnsafeFloatLongitude{input_node.location().lon()}),
                   util::toFixed(util::UnsafeFloatLatitude{input_node.location().lat()}),
                   id});
@@ -428,7 +428,7 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
                      parsed_way.highway_turn_classification,
                      parsed_way.access_turn_classification}};
 
-                external_memory.all_edges_list.push_back(InternalExtractorEdge(
+                external_memory.AddEdge(InternalExtractorEdge(
                     std::move(edge), forward_weight_data, forward_duration_data, {}));
             });
     }
@@ -463,7 +463,7 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
                      parsed_way.highway_turn_classification,
                      parsed_way.access_turn_classification}};
 
-                external_memory.all_edges_list.push_back(InternalExtractorEdge(
+                external_memory.AddEdge(InternalExtractorEdge(
                     std::move(edge), backward_weight_data, backward_duration_data, {}));
             });
     }
@@ -517,7 +517,7 @@ util::Coordinate CoordinateExtractor::GetCoordinateCloseToTurn(const NodeID from
         return node_coordinates[end_node];
     else
     {
-        const auto &geometry = compressed_geometries.GetBucketReference(turn_edge);
+        const auto geometry = compressed_geometries.GetBucketReference(turn_edge);
 
         // the compressed edges contain node ids, we transfer them to coordinates accessing the
         // node_coordinates array
@@ -578,7 +578,7 @@ CoordinateExtractor::GetCoordinatesAlongRoad(const NodeID intersection_node,
     {
         // extracts the geometry in coordinates from the compressed edge container
         std::vector<util::Coordinate> result;
-        const auto &geometry = compressed_geometries.GetBucketReference(turn_edge);
+        const auto geometry = compressed_geometries.GetBucketReference(turn_edge);
         result.reserve(geometry.size() + 2);
 
         // the compressed edges contain node ids, we transfer them to coordinates accessing the
@@ -64,7 +64,7 @@ getEdgeCoordinates(const extractor::CompressedEdgeContainer &compressed_geometri
 
     // extracts the geometry in coordinates from the compressed edge container
     std::vector<util::Coordinate> result;
-    const auto &geometry = compressed_geometries.GetBucketReference(edge);
+    const auto geometry = compressed_geometries.GetBucketReference(edge);
     result.reserve(geometry.size() + 1);
 
     result.push_back(node_coordinates[from_node]);
@@ -251,11 +251,11 @@ getIntersectionOutgoingGeometries(const util::NodeBasedDynamicGraph &graph,
 }
 
 std::pair<IntersectionEdgeGeometries, std::unordered_set<EdgeID>>
-getIntersectionGeometries(const util::NodeBasedDynamicGraph &graph,
-                          const extractor::CompressedEdgeContainer &compressed_geometries,
-                          const std::vector<util::Coordinate> &node_coordinates,
-                          const MergableRoadDetector &detector,
-                          const NodeID intersection_node)
+getMergedOutgoingGeometries(const util::NodeBasedDynamicGraph &graph,
+                            const extractor::CompressedEdgeContainer &compressed_geometries,
+                            const std::vector<util::Coordinate> &node_coordinates,
+                            const MergableRoadDetector &detector,
+                            const NodeID intersection_node)
 {
     IntersectionEdgeGeometries edge_geometries = getIntersectionOutgoingGeometries<false>(
         graph, compressed_geometries, node_coordinates, intersection_node);
@@ -386,7 +386,15 @@ getIntersectionGeometries(const util::NodeBasedDynamicGraph &graph,
         }
     }
 
+    return std::make_pair(std::move(edge_geometries), std::move(merged_edge_ids));
+}
+
+IntersectionEdgeGeometries addIncomingGeometries(const util::NodeBasedDynamicGraph &graph,
+                                                 const NodeID intersection_node,
+                                                 IntersectionEdgeGeometries edge_geometries)
+{
     // Add incoming edges with reversed bearings
+    const auto edges_number = edge_geometries.size();
     edge_geometries.resize(2 * edges_number);
     for (std::size_t index = 0; index < edges_number; ++index)
     {
@@ -402,7 +410,22 @@ getIntersectionGeometries(const util::NodeBasedDynamicGraph &graph,
     // Enforce ordering of edges by IDs
     std::sort(edge_geometries.begin(), edge_geometries.end());
 
-    return std::make_pair(edge_geometries, merged_edge_ids);
+    return edge_geometries;
+}
+
+std::pair<IntersectionEdgeGeometries, std::unordered_set<EdgeID>>
+getIntersectionGeometries(const util::NodeBasedDynamicGraph &graph,
+                          const extractor::CompressedEdgeContainer &compressed_geometries,
+                          const std::vector<util::Coordinate> &node_coordinates,
+                          const MergableRoadDetector &detector,
+                          const NodeID intersection_node)
+{
+    auto outgoing_geometries = getMergedOutgoingGeometries(
+        graph, compressed_geometries, node_coordinates, detector, intersection_node);
+
+    return std::make_pair(
+        addIncomingGeometries(graph, intersection_node, std::move(outgoing_geometries.first)),
+        std::move(outgoing_geometries.second));
 }
 
 inline auto findEdge(const IntersectionEdgeGeometries &geometries, const EdgeID &edge)
@@ -451,7 +474,7 @@ bool isTurnRestricted(const RestrictionsRange &restrictions, const NodeID to)
 bool isTurnAllowed(const util::NodeBasedDynamicGraph &graph,
                    const EdgeBasedNodeDataContainer &node_data_container,
                    const RestrictionMap &restriction_map,
-                   const std::unordered_set<NodeID> &barrier_nodes,
+                   const util::IdSet<NodeID> &barrier_nodes,
                    const IntersectionEdgeGeometries &geometries,
                    const TurnLanesIndexedArray &turn_lanes_data,
                    const IntersectionEdge &from,
@@ -524,7 +547,7 @@ bool isTurnAllowed(const util::NodeBasedDynamicGraph &graph,
     }
 
     // 3) if the intersection has a barrier
-    const bool is_barrier_node = barrier_nodes.find(intersection_node) != barrier_nodes.end();
+    const bool is_barrier_node = barrier_nodes.count(intersection_node) > 0;
 
     // Check a U-turn
     if (from.node == destination_node)
@@ -614,7 +637,7 @@ bool isTurnAllowed(const util::NodeBasedDynamicGraph &graph,
 IntersectionView convertToIntersectionView(const util::NodeBasedDynamicGraph &graph,
                                            const EdgeBasedNodeDataContainer &node_data_container,
                                            const RestrictionMap &restriction_map,
-                                           const std::unordered_set<NodeID> &barrier_nodes,
+                                           const util::IdSet<NodeID> &barrier_nodes,
                                            const IntersectionEdgeGeometries &edge_geometries,
                                            const TurnLanesIndexedArray &turn_lanes_data,
                                            const IntersectionEdge &incoming_edge,
@@ -750,31 +773,17 @@ IntersectionView getConnectedRoads(const util::NodeBasedDynamicGraph &graph,
                                    const std::vector<util::Coordinate> &node_coordinates,
                                    const extractor::CompressedEdgeContainer &compressed_geometries,
                                    const RestrictionMap &node_restriction_map,
-                                   const std::unordered_set<NodeID> &barrier_nodes,
+                                   const util::IdSet<NodeID> &barrier_nodes,
                                    const TurnLanesIndexedArray &turn_lanes_data,
                                    const IntersectionEdge &incoming_edge)
 {
     const auto intersection_node = graph.GetTarget(incoming_edge.edge);
     const auto &outgoing_edges = intersection::getOutgoingEdges(graph, intersection_node);
-    auto edge_geometries = getIntersectionOutgoingGeometries<USE_CLOSE_COORDINATE>(
-        graph, compressed_geometries, node_coordinates, intersection_node);
-
-    // Add incoming edges with reversed bearings
-    const auto edges_number = edge_geometries.size();
-    edge_geometries.resize(2 * edges_number);
-    for (std::size_t index = 0; index < edges_number; ++index)
-    {
-        const auto &geometry = edge_geometries[index];
-        const auto remote_node = graph.GetTarget(geometry.eid);
-        const auto incoming_edge = graph.FindEdge(remote_node, intersection_node);
-        edge_geometries[edges_number + index] = {incoming_edge,
-                                                 util::bearing::reverse(geometry.initial_bearing),
-                                                 util::bearing::reverse(geometry.perceived_bearing),
-                                                 geometry.segment_length};
-    }
-
-    // Enforce ordering of edges by IDs
-    std::sort(edge_geometries.begin(), edge_geometries.end());
+    const auto edge_geometries = addIncomingGeometries(
+        graph,
+        intersection_node,
+        getIntersectionOutgoingGeometries<USE_CLOSE_COORDINATE>(
+            graph, compressed_geometries, node_coordinates, intersection_node));
 
     return convertToIntersectionView(graph,
                                      node_data_container,
@@ -793,7 +802,7 @@ getConnectedRoads<false>(const util::NodeBasedDynamicGraph &graph,
                          const std::vector<util::Coordinate> &node_coordinates,
                          const extractor::CompressedEdgeContainer &compressed_geometries,
                          const RestrictionMap &node_restriction_map,
-                         const std::unordered_set<NodeID> &barrier_nodes,
+                         const util::IdSet<NodeID> &barrier_nodes,
                          const TurnLanesIndexedArray &turn_lanes_data,
                          const IntersectionEdge &incoming_edge);
 
@@ -803,7 +812,7 @@ getConnectedRoads<true>(const util::NodeBasedDynamicGraph &graph,
                         const std::vector<util::Coordinate> &node_coordinates,
                         const extractor::CompressedEdgeContainer &compressed_geometries,
                         const RestrictionMap &node_restriction_map,
-                        const std::unordered_set<NodeID> &barrier_nodes,
+                        const util::IdSet<NodeID> &barrier_nodes,
                         const TurnLanesIndexedArray &turn_lanes_data,
                         const IntersectionEdge &incoming_edge);
 
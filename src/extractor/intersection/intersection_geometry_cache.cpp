@@ -0,0 +1,74 @@
+#include "extractor/intersection/intersection_geometry_cache.hpp"
+#include "extractor/intersection/intersection_analysis.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+
+namespace osrm
+{
+namespace extractor
+{
+namespace intersection
+{
+
+IntersectionGeometryCache::IntersectionGeometryCache(
+    const util::NodeBasedDynamicGraph &graph,
+    const CompressedEdgeContainer &compressed_geometries,
+    const std::vector<util::Coordinate> &node_coordinates,
+    const MergableRoadDetector &detector)
+    : outgoing_geometries(graph.GetEdgeCapacity())
+{
+    tbb::enumerable_thread_specific<std::vector<EdgeID>> thread_merged_edges;
+
+    tbb::parallel_for(tbb::blocked_range<NodeID>(0, graph.GetNumberOfNodes()),
+                      [&](const tbb::blocked_range<NodeID> &range) {
+                          auto &local_merged_edges = thread_merged_edges.local();
+                          for (auto node = range.begin(); node != range.end(); ++node)
+                          {
+                              const auto geometries = getMergedOutgoingGeometries(
+                                  graph, compressed_geometries, node_coordinates, detector, node);
+                              BOOST_ASSERT(geometries.first.size() == graph.GetOutDegree(node));
+
+                              std::copy(geometries.first.begin(),
+                                        geometries.first.end(),
+                                        outgoing_geometries.begin() + graph.BeginEdges(node));
+                              local_merged_edges.insert(local_merged_edges.end(),
+                                                        geometries.second.begin(),
+                                                        geometries.second.end());
+                          }
+                      });
+
+    for (const auto &local_merged_edges : thread_merged_edges)
+    {
+        merged_edges.insert(merged_edges.end(), local_merged_edges.begin(), local_merged_edges.end());
+    }
+    std::sort(merged_edges.begin(), merged_edges.end());
+}
+
+std::pair<IntersectionEdgeGeometries, std::unordered_set<EdgeID>>
+IntersectionGeometryCache::Get(const util::NodeBasedDynamicGraph &graph,
+                               const NodeID intersection) const
+{
+    BOOST_ASSERT(graph.EndEdges(intersection) <= outgoing_geometries.size());
+    const auto begin = outgoing_geometries.begin() + graph.BeginEdges(intersection);
+    const auto end = outgoing_geometries.begin() + graph.EndEdges(intersection);
+
+    std::unordered_set<EdgeID> merged_edge_ids;
+    const auto merged_begin = std::lower_bound(
+        merged_edges.begin(), merged_edges.end(), graph.BeginEdges(intersection));
+    const auto merged_end =
+        std::lower_bound(merged_begin, merged_edges.end(), graph.EndEdges(intersection));
+    merged_edge_ids.insert(merged_begin, merged_end);
+
+    return std::make_pair(
+        addIncomingGeometries(graph, intersection, IntersectionEdgeGeometries(begin, end)),
+        std::move(merged_edge_ids));
+}
+}
+}
+}
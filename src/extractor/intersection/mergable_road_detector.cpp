@@ -57,7 +57,7 @@ MergableRoadDetector::MergableRoadDetector(
     const std::vector<util::Coordinate> &node_coordinates,
     const extractor::CompressedEdgeContainer &compressed_geometries,
     const RestrictionMap &node_restriction_map,
-    const std::unordered_set<NodeID> &barrier_nodes,
+    const util::IdSet<NodeID> &barrier_nodes,
     const extractor::TurnLanesIndexedArray &turn_lanes_data,
     const NameTable &name_table,
     const SuffixTable &street_name_suffix_table)
@@ -2,39 +2,53 @@
 
 #include "util/exception.hpp"
 #include "util/geojson_validation.hpp"
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
 
 #include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
 #include <rapidjson/istreamwrapper.h>
 
 #include <boost/filesystem.hpp>
-#include <boost/function_output_iterator.hpp>
-#include <boost/geometry/algorithms/equals.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
+#include <limits>
+#include <numeric>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
 namespace extractor
 {
 
+namespace
+{
+bool covers(const LocationDependentData::box_t &box, const LocationDependentData::point_t &point)
+{
+    return box.min_corner().x() <= point.x() && point.x() <= box.max_corner().x() &&
+           box.min_corner().y() <= point.y() && point.y() <= box.max_corner().y();
+}
+}
+
 LocationDependentData::LocationDependentData(const std::vector<boost::filesystem::path> &file_paths)
 {
-    std::vector<rtree_t::value_type> bounding_boxes;
     for (const auto &path : file_paths)
     {
-        loadLocationDependentData(path, bounding_boxes);
+        loadLocationDependentData(path);
     }
 
-    // Create R-tree for bounding boxes of collected polygons
-    rtree = rtree_t(bounding_boxes);
+    // Create the grid of the candidate polygons of every location
+    buildGrid();
     util::Log() << "Parsed " << properties.size() << " location-dependent features with "
                 << polygons.size() << " GeoJSON polygons";
 }
 
-void LocationDependentData::loadLocationDependentData(
-    const boost::filesystem::path &file_path, std::vector<rtree_t::value_type> &bounding_boxes)
+void LocationDependentData::loadLocationDependentData(const boost::filesystem::path &file_path)
 {
     if (file_path.empty())
         return;
@@ -88,7 +102,7 @@ void LocationDependentData::loadLocationDependentData(
         return index;
     };
 
-    auto index_polygon = [this, &bounding_boxes](const auto &rings, auto properties_index) {
+    auto index_polygon = [this](const auto &rings, auto properties_index) {
         // At least an outer ring in polygon https://tools.ietf.org/html/rfc7946#section-3.1.6
         BOOST_ASSERT(rings.Size() > 0);
 
@@ -123,7 +137,6 @@ void LocationDependentData::loadLocationDependentData(
         };
 
         auto envelop = append_ring_segments(rings[0].GetArray());
-        bounding_boxes.emplace_back(envelop, polygons.size());
         for (rapidjson::SizeType iring = 1; iring < rings.Size(); ++iring)
         {
             append_ring_segments(rings[iring].GetArray());
@@ -161,7 +174,7 @@ void LocationDependentData::loadLocationDependentData(
             }
         }
 
-        polygons.emplace_back(std::make_pair(bands, properties_index));
+        polygons.push_back({envelop, std::move(bands), properties_index});
     };
 
     for (rapidjson::SizeType ifeature = 0; ifeature < features_array.Size(); ifeature++)
@@ -207,72 +220,229 @@ LocationDependentData::FindByKey(const std::vector<std::size_t> &property_indexe
     return property_t{};
 }
 
-std::vector<std::size_t> LocationDependentData::GetPropertyIndexes(const point_t &point) const
+void LocationDependentData::buildGrid()
 {
-    std::vector<std::size_t> result;
-    auto inserter = [this, &result](const rtree_t::value_type &rtree_entry) {
-        const auto properties_index = polygons[rtree_entry.second].second;
-        result.push_back(properties_index);
+    if (polygons.empty())
+        return;
+
+    auto x_min = std::numeric_limits<double>::max(), x_max = std::numeric_limits<double>::lowest();
+    auto y_min = std::numeric_limits<double>::max(), y_max = std::numeric_limits<double>::lowest();
+    std::size_t number_of_segments = 0;
+    for (const auto &polygon : polygons)
+    {
+        x_min = std::min(x_min, polygon.envelop.min_corner().x());
+        x_max = std::max(x_max, polygon.envelop.max_corner().x());
+        y_min = std::min(y_min, polygon.envelop.min_corner().y());
+        y_max = std::max(y_max, polygon.envelop.max_corner().y());
+        for (const auto &band : polygon.bands)
+            number_of_segments += band.size();
+    }
+    if (x_min > x_max || y_min > y_max)
+        return;
+    grid.bounds = box_t{{x_min, y_min}, {x_max, y_max}};
+
+    // About as many cells as segments, the exact tests of the boundary cells have a few segments
+    constexpr const std::size_t min_cells_per_axis = 16;
+    constexpr const std::size_t max_cells_per_axis = 1024;
+    const auto cells_per_axis =
+        std::min(max_cells_per_axis,
+                 std::max(min_cells_per_axis,
+                          static_cast<std::size_t>(std::sqrt(number_of_segments)) * 4));
+    const auto width = x_max - x_min;
+    const auto height = y_max - y_min;
+    grid.columns = width > 0 ? cells_per_axis : 1;
+    grid.rows = height > 0 ? cells_per_axis : 1;
+    grid.cell_width = width > 0 ? width / grid.columns : 1.;
+    grid.cell_height = height > 0 ? height / grid.rows : 1.;
+
+    const auto to_column = [&](const double x) {
+        return std::min<std::size_t>(grid.columns - 1,
+                                     std::max(0., std::floor((x - x_min) / grid.cell_width)));
     };
+    const auto to_row = [&](const double y) {
+        return std::min<std::size_t>(grid.rows - 1,
+                                     std::max(0., std::floor((y - y_min) / grid.cell_height)));
+    };
+    // segments are rasterized with a margin so rounding can't miss a cell they touch
+    const auto x_margin = grid.cell_width * 1e-6;
+    const auto y_margin = grid.cell_height * 1e-6;
+
+    // pairs of cell and entry
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> cell_entries;
+    std::vector<bool> is_boundary;
+    for (const auto polygon_position : util::irange<std::size_t>(0, polygons.size()))
+    {
+        const auto &polygon = polygons[polygon_position];
+        const auto &envelop = polygon.envelop;
+        if (envelop.min_corner().x() > envelop.max_corner().x() ||
+            envelop.min_corner().y() > envelop.max_corner().y())
+            continue;
+
+        const auto first_column = to_column(envelop.min_corner().x());
+        const auto last_column = to_column(envelop.max_corner().x());
+        const auto first_row = to_row(envelop.min_corner().y());
+        const auto last_row = to_row(envelop.max_corner().y());
+        const auto columns = last_column - first_column + 1;
+        is_boundary.assign(columns * (last_row - first_row + 1), false);
+
+        // mark the cells that the segments cross column by column
+        for (const auto &band : polygon.bands)
+        {
+            for (const auto &segment : band)
+            {
+                const auto from_x = segment.first.x(), from_y = segment.first.y();
+                const auto to_x = segment.second.x(), to_y = segment.second.y();
+                const std::pair<double, double> segment_x = std::minmax(from_x, to_x);
+                const auto y_at = [&](const double x) {
+                    return from_y + (x - from_x) * (to_y - from_y) / (to_x - from_x);
+                };
+
+                for (auto column = to_column(segment_x.first - x_margin),
+                          end_column = to_column(segment_x.second + x_margin);
+                     column <= end_column;
+                     ++column)
+                {
+                    const auto column_x = x_min + column * grid.cell_width;
+                    const std::pair<double, double> y_range =
+                        from_x == to_x
+                            ? std::minmax(from_y, to_y)
+                            : std::minmax(y_at(std::max(segment_x.first, column_x)),
+                                          y_at(std::min(segment_x.second,
+                                                        column_x + grid.cell_width)));
+                    for (auto row = to_row(y_range.first - y_margin),
+                              end_row = to_row(y_range.second + y_margin);
+                         row <= end_row;
+                         ++row)
+                    {
+                        if (column >= first_column && column <= last_column && row >= first_row &&
+                            row <= last_row)
+                        {
+                            is_boundary[(row - first_row) * columns + column - first_column] = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        // the other cells are inside or outside of the polygon as a whole
+        for (auto row = first_row; row <= last_row; ++row)
+        {
+            for (auto column = first_column; column <= last_column; ++column)
+            {
+                const std::uint32_t cell = row * grid.columns + column;
+                const std::uint32_t entry = polygon_position << 1;
+                if (is_boundary[(row - first_row) * columns + column - first_column])
+                {
+                    cell_entries.emplace_back(cell, entry | 1);
+                }
+                else if (isInside({x_min + (column + 0.5) * grid.cell_width,
+                                   y_min + (row + 0.5) * grid.cell_height},
+                                  polygon_position))
+                {
+                    cell_entries.emplace_back(cell, entry);
+                }
+            }
+        }
+    }
+
+    std::sort(cell_entries.begin(), cell_entries.end());
+
+    grid.first_entries.resize(grid.columns * grid.rows + 1, 0);
+    grid.entries.reserve(cell_entries.size());
+    for (const auto &cell_entry : cell_entries)
+    {
+        ++grid.first_entries[cell_entry.first + 1];
+        grid.entries.push_back(cell_entry.second);
+    }
+    std::partial_sum(
+        grid.first_entries.begin(), grid.first_entries.end(), grid.first_entries.begin());
+}
 
-    // Search the R-tree and collect a Lua table of tags that correspond to the location
-    rtree.query(boost::geometry::index::intersects(point) &&
-                    boost::geometry::index::satisfies([this, &point](const rtree_t::value_type &v) {
+bool LocationDependentData::isInside(const point_t &point,
+                                     const polygon_position_t polygon_position) const
+{
+    // Simple point-in-polygon algorithm adapted from
+    // https://www.ecse.rpi.edu/Homepages/wrf/Research/Short_Notes/pnpoly.html
 
-                        // Simple point-in-polygon algorithm adapted from
-                        // https://www.ecse.rpi.edu/Homepages/wrf/Research/Short_Notes/pnpoly.html
+    const auto &envelop = polygons[polygon_position].envelop;
+    const auto &bands = polygons[polygon_position].bands;
 
-                        const auto &envelop = v.first;
-                        const auto &bands = polygons[v.second].first;
+    if (!covers(envelop, point))
+    {
+        return false;
+    }
 
-                        const auto y_min = envelop.min_corner().y();
-                        const auto y_max = envelop.max_corner().y();
-                        const auto dy = (y_max - y_min) / bands.size();
+    const auto y_min = envelop.min_corner().y();
+    const auto y_max = envelop.max_corner().y();
+    const auto dy = (y_max - y_min) / bands.size();
 
-                        std::size_t band = (point.y() - y_min) / dy;
-                        if (band >= bands.size())
-                        {
-                            band = bands.size() - 1;
-                        }
+    std::size_t band = (point.y() - y_min) / dy;
+    if (band >= bands.size())
+    {
+        band = bands.size() - 1;
+    }
 
-                        bool inside = false;
+    bool inside = false;
 
-                        for (const auto &segment : bands[band])
-                        {
-                            const auto point_x = point.x(), point_y = point.y();
-                            const auto from_x = segment.first.x(), from_y = segment.first.y();
-                            const auto to_x = segment.second.x(), to_y = segment.second.y();
-
-                            if (to_y == from_y)
-                            { // handle horizontal segments: check if on boundary or skip
-                                if ((to_y == point_y) &&
-                                    (from_x == point_x || (to_x > point_x) != (from_x > point_x)))
-                                    return true;
-                                continue;
-                            }
-
-                            if ((to_y > point_y) != (from_y > point_y))
-                            {
-                                const auto ax = to_x - from_x;
-                                const auto ay = to_y - from_y;
-                                const auto tx = point_x - from_x;
-                                const auto ty = point_y - from_y;
-
-                                const auto cross_product = tx * ay - ax * ty;
-
-                                if (cross_product == 0)
-                                    return true;
-
-                                if ((ay > 0) == (cross_product > 0))
-                                {
-                                    inside = !inside;
-                                }
-                            }
-                        }
+    for (const auto &segment : bands[band])
+    {
+        const auto point_x = point.x(), point_y = point.y();
+        const auto from_x = segment.first.x(), from_y = segment.first.y();
+        const auto to_x = segment.second.x(), to_y = segment.second.y();
+
+        if (to_y == from_y)
+        { // handle horizontal segments: check if on boundary or skip
+            if ((to_y == point_y) && (from_x == point_x || (to_x > point_x) != (from_x > point_x)))
+                return true;
+            continue;
+        }
 
-                        return inside;
-                    }),
-                boost::make_function_output_iterator(std::ref(inserter)));
+        if ((to_y > point_y) != (from_y > point_y))
+        {
+            const auto ax = to_x - from_x;
+            const auto ay = to_y - from_y;
+            const auto tx = point_x - from_x;
+            const auto ty = point_y - from_y;
+
+            const auto cross_product = tx * ay - ax * ty;
+
+            if (cross_product == 0)
+                return true;
+
+            if ((ay > 0) == (cross_product > 0))
+            {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+std::vector<std::size_t> LocationDependentData::GetPropertyIndexes(const point_t &point) const
+{
+    std::vector<std::size_t> result;
+    if (grid.entries.empty() || !covers(grid.bounds, point))
+    {
+        return result;
+    }
+
+    const auto column = std::min<std::size_t>(
+        grid.columns - 1, (point.x() - grid.bounds.min_corner().x()) / grid.cell_width);
+    const auto row = std::min<std::size_t>(
+        grid.rows - 1, (point.y() - grid.bounds.min_corner().y()) / grid.cell_height);
+    const auto cell = row * grid.columns + column;
+
+    // Only the polygons whose boundary crosses the cell need the exact test
+    for (auto index = grid.first_entries[cell]; index < grid.first_entries[cell + 1]; ++index)
+    {
+        const auto entry = grid.entries[index];
+        const polygon_position_t polygon_position = entry >> 1;
+        if ((entry & 1) == 0 || isInside(point, polygon_position))
+        {
+            result.push_back(polygons[polygon_position].properties_index);
+        }
+    }
 
     return result;
 }
@@ -3,26 +3,114 @@
 #include "extractor/graph_compressor.hpp"
 #include "storage/io.hpp"
 
+#include "util/hilbert_value.hpp"
 #include "util/log.hpp"
+#include "util/permutation.hpp"
 #include "util/timing_util.hpp"
 
 #include <boost/assert.hpp>
+#include <boost/iterator/function_output_iterator.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <numeric>
 #include <set>
+#include <tuple>
 
 namespace osrm
 {
 namespace extractor
 {
 
+namespace
+{
+// The nodes along the Hilbert curve of their coordinates, nodes at the same coordinate keep the
+// order of their OSM ids
+std::vector<NodeID> spatialNodeOrder(const std::vector<util::Coordinate> &coordinates)
+{
+    std::vector<std::uint64_t> hilbert_codes(coordinates.size());
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, coordinates.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto node = range.begin(); node != range.end(); ++node)
+                              hilbert_codes[node] = util::GetHilbertCode(coordinates[node]);
+                      });
+
+    std::vector<NodeID> ordering(coordinates.size());
+    std::iota(ordering.begin(), ordering.end(), 0);
+    tbb::parallel_sort(ordering.begin(), ordering.end(), [&](const NodeID lhs, const NodeID rhs) {
+        return std::tie(hilbert_codes[lhs], lhs) < std::tie(hilbert_codes[rhs], rhs);
+    });
+    return ordering;
+}
+
+void renumber(const std::vector<NodeID> &old_to_new, NodeID &node)
+{
+    if (node != SPECIAL_NODEID)
+        node = old_to_new[node];
+}
+
+void renumber(const std::vector<NodeID> &old_to_new, NodeRestriction &restriction)
+{
+    renumber(old_to_new, restriction.from);
+    renumber(old_to_new, restriction.via);
+    renumber(old_to_new, restriction.to);
+}
+
+void renumber(const std::vector<NodeID> &old_to_new, TurnRestriction &restriction)
+{
+    if (restriction.Type() == RestrictionType::WAY_RESTRICTION)
+    {
+        renumber(old_to_new, restriction.AsWayRestriction().in_restriction);
+        renumber(old_to_new, restriction.AsWayRestriction().out_restriction);
+    }
+    else
+    {
+        renumber(old_to_new, restriction.AsNodeRestriction());
+    }
+}
+
+void renumber(const std::vector<NodeID> &old_to_new, UnresolvedManeuverOverride &maneuver)
+{
+    for (auto &turn : maneuver.turn_sequence)
+    {
+        renumber(old_to_new, turn.from);
+        renumber(old_to_new, turn.via);
+        renumber(old_to_new, turn.to);
+    }
+    renumber(old_to_new, maneuver.instruction_node);
+}
+
+void renumber(const std::vector<NodeID> &old_to_new, util::IdSet<NodeID> &nodes)
+{
+    util::IdSet<NodeID> renumbered_nodes;
+    renumbered_nodes.resize(old_to_new.size());
+    for (const auto node : nodes)
+        renumbered_nodes.insert(old_to_new[node]);
+    nodes.swap(renumbered_nodes);
+}
+}
+
 NodeBasedGraphFactory::NodeBasedGraphFactory(
     const boost::filesystem::path &input_file,
     ScriptingEnvironment &scripting_environment,
     std::vector<TurnRestriction> &turn_restrictions,
     std::vector<ConditionalTurnRestriction> &conditional_turn_restrictions,
-    std::vector<UnresolvedManeuverOverride> &maneuver_overrides)
+    std::vector<UnresolvedManeuverOverride> &maneuver_overrides,
+    const bool spatial_node_order)
 {
-    LoadDataFromFile(input_file);
+    const auto old_to_new = LoadDataFromFile(input_file, spatial_node_order);
+    if (!old_to_new.empty())
+    {
+        for (auto &restriction : turn_restrictions)
+            renumber(old_to_new, restriction);
+        for (auto &restriction : conditional_turn_restrictions)
+            renumber(old_to_new, restriction);
+        for (auto &maneuver : maneuver_overrides)
+            renumber(old_to_new, maneuver);
+    }
+
     Compress(scripting_environment,
              turn_restrictions,
              conditional_turn_restrictions,
@@ -32,10 +120,14 @@ NodeBasedGraphFactory::NodeBasedGraphFactory(
 }
 
 // load the data serialised during the extraction run
-void NodeBasedGraphFactory::LoadDataFromFile(const boost::filesystem::path &input_file)
+std::vector<NodeID>
+NodeBasedGraphFactory::LoadDataFromFile(const boost::filesystem::path &input_file,
+                                        const bool spatial_node_order)
 {
-    auto barriers_iter = inserter(barriers, end(barriers));
-    auto traffic_signals_iter = inserter(traffic_signals, end(traffic_signals));
+    auto barriers_iter = boost::make_function_output_iterator(
+        [this](const NodeID node) { barriers.insert(node); });
+    auto traffic_signals_iter = boost::make_function_output_iterator(
+        [this](const NodeID node) { traffic_signals.insert(node); });
     std::vector<NodeBasedEdge> edge_list;
 
     files::readRawNBGraph(input_file,
@@ -53,6 +145,39 @@ void NodeBasedGraphFactory::LoadDataFromFile(const boost::filesystem::path &inpu
                               SOURCE_REF);
     }
 
+    // Nodes that are close to each other get close ids, and so do the edge-based nodes and
+    // segments that are numbered in the order of their node-based nodes
+    std::vector<NodeID> old_to_new;
+    if (spatial_node_order)
+    {
+        TIMER_START(spatial_order);
+        const auto ordering = spatialNodeOrder(coordinates);
+        old_to_new = util::orderingToPermutation(ordering);
+
+        util::parallelPermutation(coordinates.begin(), coordinates.end(), old_to_new);
+
+        decltype(osm_node_ids) renumbered_osm_node_ids;
+        renumbered_osm_node_ids.reserve(number_of_node_based_nodes);
+        for (const auto old_node : ordering)
+            renumbered_osm_node_ids.push_back(osm_node_ids[old_node]);
+        osm_node_ids = std::move(renumbered_osm_node_ids);
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, edge_list.size()),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              for (auto index = range.begin(); index != range.end(); ++index)
+                              {
+                                  edge_list[index].source = old_to_new[edge_list[index].source];
+                                  edge_list[index].target = old_to_new[edge_list[index].target];
+                              }
+                          });
+        renumber(old_to_new, barriers);
+        renumber(old_to_new, traffic_signals);
+
+        TIMER_STOP(spatial_order);
+        util::Log() << "Ordered " << number_of_node_based_nodes
+                    << " nodes along a Hilbert curve in " << TIMER_SEC(spatial_order) << "s";
+    }
+
     // at this point, the data isn't compressed, but since we update the graph in-place, we assign
     // it here.
     compressed_output_graph =
@@ -80,6 +205,8 @@ void NodeBasedGraphFactory::LoadDataFromFile(const boost::filesystem::path &inpu
         }
         return true;
     }());
+
+    return old_to_new;
 }
 
 void NodeBasedGraphFactory::Compress(
@@ -0,0 +1,146 @@
+#include "extractor/osm_change_set.hpp"
+
+#include "util/log.hpp"
+
+#include <osmium/io/any_input.hpp>
+#include <osmium/osm/item_type.hpp>
+
+#include <algorithm>
+#include <tuple>
+
+namespace osrm
+{
+namespace extractor
+{
+
+namespace
+{
+// the order of the objects in sorted OSM files, without the version
+auto orderKey(const osmium::OSMObject &object)
+{
+    return std::make_tuple(object.type(), object.id() > 0, object.positive_id());
+}
+
+bool isObject(const osmium::memory::Item &item)
+{
+    return item.type() == osmium::item_type::node || item.type() == osmium::item_type::way ||
+           item.type() == osmium::item_type::relation;
+}
+
+void addChange(osmium::memory::Buffer &buffer, const osmium::OSMObject &object)
+{
+    // deleted objects are read as invisible objects
+    if (object.visible())
+    {
+        buffer.add_item(object);
+        buffer.commit();
+    }
+}
+}
+
+OSMChangeSet::OSMChangeSet(const std::vector<boost::filesystem::path> &change_paths)
+{
+    for (const auto &path : change_paths)
+    {
+        osmium::io::Reader reader(path.string(),
+                                  osmium::osm_entity_bits::nwr,
+                                  osmium::io::read_meta::yes);
+        while (auto buffer = reader.read())
+        {
+            buffers.push_back(std::move(buffer));
+        }
+        reader.close();
+    }
+
+    // moving the buffers keeps their memory, so the objects can be collected after reading
+    for (const auto &buffer : buffers)
+    {
+        for (const auto &object : buffer.select<osmium::OSMObject>())
+        {
+            objects.push_back(&object);
+        }
+    }
+
+    // the stable sort keeps the changes of an object in the order of the files
+    std::stable_sort(objects.begin(), objects.end(), [](const auto lhs, const auto rhs) {
+        return orderKey(*lhs) < orderKey(*rhs);
+    });
+
+    // keep the last change of each object
+    auto output = objects.begin();
+    for (auto iter = objects.begin(); iter != objects.end(); ++iter)
+    {
+        const auto last = std::next(iter) == objects.end() ||
+                          orderKey(**std::next(iter)) != orderKey(**iter);
+        if (last)
+        {
+            *output++ = *iter;
+        }
+    }
+    objects.erase(output, objects.end());
+
+    util::Log() << "Read changes of " << objects.size() << " objects from "
+                << change_paths.size() << " change files";
+}
+
+OSMChangeSet::Merger::Merger(const OSMChangeSet &change_set,
+                             const osmium::osm_entity_bits::type entities)
+{
+    std::copy_if(change_set.objects.begin(),
+                 change_set.objects.end(),
+                 std::back_inserter(objects),
+                 [entities](const auto object) {
+                     return (osmium::osm_entity_bits::from_item_type(object->type()) &
+                             entities) != osmium::osm_entity_bits::nothing;
+                 });
+    next = objects.begin();
+}
+
+osmium::memory::Buffer OSMChangeSet::Merger::Apply(const osmium::memory::Buffer &buffer)
+{
+    osmium::memory::Buffer result(std::max<std::size_t>(buffer.committed(), 1024),
+                                  osmium::memory::Buffer::auto_grow::yes);
+
+    for (auto entity = buffer.cbegin(), end = buffer.cend(); entity != end; ++entity)
+    {
+        if (!isObject(*entity))
+        {
+            result.add_item(*entity);
+            result.commit();
+            continue;
+        }
+
+        const auto &object = static_cast<const osmium::OSMObject &>(*entity);
+        const auto key = orderKey(object);
+
+        // objects created before this one
+        while (next != objects.end() && orderKey(**next) < key)
+        {
+            addChange(result, **next++);
+        }
+
+        if (next != objects.end() && orderKey(**next) == key)
+        {
+            addChange(result, **next++);
+        }
+        else
+        {
+            result.add_item(object);
+            result.commit();
+        }
+    }
+
+    return result;
+}
+
+osmium::memory::Buffer OSMChangeSet::Merger::Finish()
+{
+    osmium::memory::Buffer result(1024, osmium::memory::Buffer::auto_grow::yes);
+    while (next != objects.end())
+    {
+        addChange(result, **next++);
+    }
+    return result;
+}
+}
+}
@@ -1,19 +1,174 @@
 #include "extractor/raster_source.hpp"
 
+#include "storage/io.hpp"
+
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/log.hpp"
 #include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
 
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/spirit/include/qi.hpp>
+#include <boost/spirit/include/qi_int.hpp>
+
 #include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 namespace osrm
 {
 namespace extractor
 {
 
-RasterSource::RasterSource(RasterGrid _raster_data,
+constexpr const char RasterGrid::BINARY_MAGIC[];
+constexpr std::uint32_t RasterGrid::BINARY_VERSION;
+constexpr std::size_t RasterGrid::BINARY_HEADER_SIZE;
+
+namespace
+{
+bool isBinaryRaster(const boost::filesystem::path &filepath)
+{
+    char magic[sizeof(RasterGrid::BINARY_MAGIC) - 1] = {};
+    boost::filesystem::ifstream file(filepath, std::ios::binary);
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, RasterGrid::BINARY_MAGIC, sizeof(magic)) == 0;
+}
+
+// Every Lua context has a raster container of its own, the grids of the same file are loaded
+// once and shared by all of them
+std::shared_ptr<const RasterGrid>
+loadSharedGrid(const boost::filesystem::path &filepath, std::size_t xdim, std::size_t ydim)
+{
+    static std::mutex mutex;
+    static std::map<std::tuple<std::string, std::size_t, std::size_t>,
+                    std::weak_ptr<const RasterGrid>>
+        grids;
+
+    // the other contexts wait for the grid instead of loading it as well
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &weak_grid = grids[std::make_tuple(filepath.string(), xdim, ydim)];
+    auto grid = weak_grid.lock();
+    if (!grid)
+    {
+        grid = std::make_shared<const RasterGrid>(filepath, xdim, ydim);
+        weak_grid = grid;
+    }
+    return grid;
+}
+}
+
+RasterGrid::RasterGrid(const boost::filesystem::path &filepath,
+                       std::size_t _xdim,
+                       std::size_t _ydim)
+    : xdim(_xdim), ydim(_ydim)
+{
+    if (isBinaryRaster(filepath))
+    {
+        MapBinary(filepath);
+    }
+    else
+    {
+        ReadASCII(filepath);
+    }
+}
+
+void RasterGrid::ReadASCII(const boost::filesystem::path &filepath)
+{
+    _data.reserve(ydim * xdim);
+
+    storage::io::FileReader file_reader(filepath, storage::io::FileReader::HasNoFingerprint);
+
+    std::string buffer;
+    buffer.resize(file_reader.GetSize());
+
+    BOOST_ASSERT(buffer.size() > 1);
+
+    file_reader.ReadInto(&buffer[0], buffer.size());
+
+    boost::algorithm::trim(buffer);
+
+    auto itr = buffer.begin();
+    auto end = buffer.end();
+
+    bool r = false;
+    try
+    {
+        r = boost::spirit::qi::parse(
+            itr, end, +boost::spirit::qi::int_ % +boost::spirit::qi::space, _data);
+    }
+    catch (std::exception const &ex)
+    {
+        throw util::exception("Failed to read from raster source " + filepath.string() + ": " +
+                              ex.what() + SOURCE_REF);
+    }
+
+    if (!r || itr != end)
+    {
+        throw util::exception("Failed to parse raster source: " + filepath.string() + SOURCE_REF);
+    }
+
+    int32_values = _data.data();
+}
+
+void RasterGrid::MapBinary(const boost::filesystem::path &filepath)
+{
+    try
+    {
+        region.open(filepath);
+    }
+    catch (const std::exception &exc)
+    {
+        throw util::exception("Failed to map raster source " + filepath.string() + ": " +
+                              exc.what() + SOURCE_REF);
+    }
+
+    std::uint32_t version = 0;
+    std::uint32_t value_size = 0;
+    std::uint64_t columns = 0;
+    std::uint64_t rows = 0;
+    if (region.size() >= BINARY_HEADER_SIZE)
+    {
+        const auto header = region.data() + sizeof(BINARY_MAGIC) - 1;
+        std::memcpy(&version, header, sizeof(version));
+        std::memcpy(&value_size, header + 4, sizeof(value_size));
+        std::memcpy(&columns, header + 8, sizeof(columns));
+        std::memcpy(&rows, header + 16, sizeof(rows));
+    }
+
+    if (version != BINARY_VERSION || (value_size != 2 && value_size != 4))
+    {
+        throw util::exception("Unsupported binary raster source " + filepath.string() +
+                              SOURCE_REF);
+    }
+    if (columns != xdim || rows != ydim)
+    {
+        throw util::exception("Binary raster source " + filepath.string() + " has " +
+                              std::to_string(rows) + " rows and " + std::to_string(columns) +
+                              " columns instead of " + std::to_string(ydim) + " rows and " +
+                              std::to_string(xdim) + " columns" + SOURCE_REF);
+    }
+    if (region.size() < BINARY_HEADER_SIZE + xdim * ydim * value_size)
+    {
+        throw util::exception("Binary raster source " + filepath.string() + " is truncated" +
+                              SOURCE_REF);
+    }
+
+    const auto values = region.data() + BINARY_HEADER_SIZE;
+    if (value_size == 2)
+    {
+        int16_values = reinterpret_cast<const std::int16_t *>(values);
+    }
+    else
+    {
+        int32_values = reinterpret_cast<const std::int32_t *>(values);
+    }
+}
+
+RasterSource::RasterSource(std::shared_ptr<const RasterGrid> _raster_data,
                            std::size_t _width,
                            std::size_t _height,
                            int _xmin,
@@ -45,7 +200,7 @@ RasterDatum RasterSource::GetRasterData(const int lon, const int lat) const
     const std::size_t xth = static_cast<std::size_t>(round((lon - xmin) / xstep));
     const std::size_t yth = static_cast<std::size_t>(round((ymax - lat) / ystep));
 
-    return {raster_data(xth, yth)};
+    return {(*raster_data)(xth, yth)};
 }
 
 // Query raster source using bilinear interpolation
@@ -72,13 +227,14 @@ RasterDatum RasterSource::GetRasterInterpolate(const int lon, const int lat) con
     const float fromRight = 1 - fromLeft;
     const float fromBottom = 1 - fromTop;
 
-    return {static_cast<std::int32_t>(raster_data(left, top) * (fromRight * fromBottom) +
-                                      raster_data(right, top) * (fromLeft * fromBottom) +
-                                      raster_data(left, bottom) * (fromRight * fromTop) +
-                                      raster_data(right, bottom) * (fromLeft * fromTop))};
+    const auto &grid = *raster_data;
+    return {static_cast<std::int32_t>(grid(left, top) * (fromRight * fromBottom) +
+                                      grid(right, top) * (fromLeft * fromBottom) +
+                                      grid(left, bottom) * (fromRight * fromTop) +
+                                      grid(right, bottom) * (fromLeft * fromTop))};
 }
 
-// Load raster source into memory
+// Load raster source into memory or map a binary raster file
 int RasterContainer::LoadRasterSource(const std::string &path_string,
                                       double xmin,
                                       double xmax,
@@ -112,9 +268,8 @@ int RasterContainer::LoadRasterSource(const std::string &path_string,
             path_string, ErrorCode::FileOpenError, SOURCE_REF, "File not found");
     }
 
-    RasterGrid rasterData{filepath, ncols, nrows};
-
-    RasterSource source{std::move(rasterData), ncols, nrows, _xmin, _xmax, _ymin, _ymax};
+    RasterSource source{
+        loadSharedGrid(filepath, ncols, nrows), ncols, nrows, _xmin, _xmax, _ymin, _ymax};
     TIMER_STOP(loading_source);
     LoadedSourcePaths.emplace(path_string, source_id);
     LoadedSources.push_back(std::move(source));
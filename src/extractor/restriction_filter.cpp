@@ -5,6 +5,11 @@
 #include <algorithm>
 #include <boost/assert.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <cstdint>
+
 namespace osrm
 {
 namespace extractor
@@ -78,9 +83,25 @@ removeInvalidRestrictions(std::vector<ConditionalTurnRestriction> restrictions,
         }
     };
 
-    const auto end_valid_restrictions =
-        std::remove_if(restrictions.begin(), restrictions.end(), is_invalid);
-    restrictions.erase(end_valid_restrictions, restrictions.end());
+    // the checks only read the graph and run in parallel, the removal keeps the order
+    std::vector<std::uint8_t> invalid(restrictions.size());
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, restrictions.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                              invalid[index] = is_invalid(restrictions[index]);
+                      });
+
+    std::size_t end_valid_restrictions = 0;
+    for (std::size_t index = 0; index < restrictions.size(); ++index)
+    {
+        if (!invalid[index])
+        {
+            if (end_valid_restrictions != index)
+                restrictions[end_valid_restrictions] = std::move(restrictions[index]);
+            ++end_valid_restrictions;
+        }
+    }
+    restrictions.erase(restrictions.begin() + end_valid_restrictions, restrictions.end());
 
     return restrictions;
 }
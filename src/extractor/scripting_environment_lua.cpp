@@ -60,6 +60,20 @@ auto get_value_by_key(T const &object, const char *key) -> decltype(object.get_v
     }
 }
 
+const char *
+get_cached_value_by_key(TagCache &cache, osmium::OSMObject const &object, const char *key)
+{
+    auto v = cache.Get(object, key);
+    if (v && *v)
+    { // non-empty string?
+        return v;
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+
 template <class T, class D>
 const char *get_value_by_key(T const &object, const char *key, D const default_value)
 {
@@ -253,7 +267,9 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
     context.state.new_usertype<osmium::Way>(
         "Way",
         "get_value_by_key",
-        &get_value_by_key<osmium::Way>,
+        [&context](const osmium::Way &way, const char *key) {
+            return get_cached_value_by_key(context.tag_cache, way, key);
+        },
         "id",
         &osmium::Way::id,
         "version",
@@ -275,7 +291,9 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
         "location",
         &osmium::Node::location,
         "get_value_by_key",
-        &get_value_by_key<osmium::Node>,
+        [&context](const osmium::Node &node, const char *key) {
+            return get_cached_value_by_key(context.tag_cache, node, key);
+        },
         "id",
         &osmium::Node::id,
         "version",
@@ -535,11 +553,15 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
         context.turn_function = function_table.value()["process_turn"];
         context.node_function = function_table.value()["process_node"];
         context.way_function = function_table.value()["process_way"];
+        context.ways_function = function_table.value()["process_ways"];
+        context.turns_function = function_table.value()["process_turns"];
         context.segment_function = function_table.value()["process_segment"];
 
         context.has_turn_penalty_function = context.turn_function.valid();
         context.has_node_function = context.node_function.valid();
         context.has_way_function = context.way_function.valid();
+        context.has_ways_function = context.ways_function.valid();
+        context.has_turns_function = context.turns_function.valid();
         context.has_segment_function = context.segment_function.valid();
 
         // read properties from 'profile.properties' table
@@ -585,6 +607,20 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
             sol::optional<bool> force_split_edges = properties["force_split_edges"];
             if (force_split_edges != sol::nullopt)
                 context.properties.force_split_edges = force_split_edges.value();
+
+            // the results of a pure process_way only depend on the declared tags of the way
+            sol::optional<bool> pure_way_function = properties["pure_way_function"];
+            sol::table way_cache_tags = context.profile_table["way_cache_tags"];
+            if (pure_way_function != sol::nullopt && pure_way_function.value() &&
+                way_cache_tags.valid() && context.location_dependent_data.empty())
+            {
+                std::vector<std::string> keys;
+                for (auto &&pair : way_cache_tags)
+                {
+                    keys.push_back(pair.second.as<std::string>());
+                }
+                context.way_result_cache = WayResultCache(keys);
+            }
         }
     };
 
@@ -877,6 +913,8 @@ void Sol2ScriptingEnvironment::ProcessElements(
     ExtractionNode result_node;
     ExtractionWay result_way;
     auto &local_context = this->GetSol2Context();
+    // the ways of the buffer are processed with one call if the profile has process_ways
+    const auto first_way = resulting_ways.size();
 
     for (auto entity = buffer.cbegin(), end = buffer.cend(); entity != end; ++entity)
     {
@@ -898,7 +936,7 @@ void Sol2ScriptingEnvironment::ProcessElements(
         {
             const osmium::Way &way = static_cast<const osmium::Way &>(*entity);
             result_way.clear();
-            if (local_context.has_way_function)
+            if (local_context.has_way_function && !local_context.has_ways_function)
             {
                 local_context.ProcessWay(way, result_way, relations);
             }
@@ -922,6 +960,12 @@ void Sol2ScriptingEnvironment::ProcessElements(
             break;
         }
     }
+
+    if (local_context.has_ways_function && first_way < resulting_ways.size())
+    {
+        local_context.ProcessWays(
+            resulting_ways.begin() + first_way, resulting_ways.end(), relations);
+    }
 }
 
 std::vector<std::string>
@@ -1127,6 +1171,42 @@ void Sol2ScriptingEnvironment::ProcessTurn(ExtractionTurn &turn)
     }
 }
 
+void Sol2ScriptingEnvironment::ProcessTurns(std::vector<ExtractionTurn> &turns)
+{
+    auto &context = GetSol2Context();
+
+    // process_turns is only available from api version 2 on, older profiles go turn by turn
+    if (!context.has_turns_function || context.api_version < 2)
+    {
+        for (auto &turn : turns)
+        {
+            ProcessTurn(turn);
+        }
+        return;
+    }
+
+    // the array holds references to the turns that are modified in place
+    sol::table turns_table = context.state.create_table(static_cast<int>(turns.size()), 0);
+    int index = 1;
+    for (auto &turn : turns)
+    {
+        turns_table[index++] = &turn;
+    }
+
+    context.turns_function(context.profile_table, turns_table);
+
+    for (auto &turn : turns)
+    {
+        // Turn weight falls back to the duration value in deciseconds
+        // or uses the extracted unit-less weight value
+        if (context.properties.fallback_to_duration)
+            turn.weight = turn.duration;
+        else
+            // cap turn weight to max turn weight, which depend on weight precision
+            turn.weight = std::min(turn.weight, context.properties.GetMaxTurnWeight());
+    }
+}
+
 void Sol2ScriptingEnvironment::ProcessSegment(ExtractionSegment &segment)
 {
     auto &context = GetSol2Context();
@@ -1157,6 +1237,7 @@ void LuaScriptingContext::ProcessNode(const osmium::Node &node,
                                       const ExtractionRelationContainer &relations)
 {
     BOOST_ASSERT(state.lua_state() != nullptr);
+    tag_cache.Reset();
 
     switch (api_version)
     {
@@ -1179,6 +1260,16 @@ void LuaScriptingContext::ProcessWay(const osmium::Way &way,
                                      const ExtractionRelationContainer &relations)
 {
     BOOST_ASSERT(state.lua_state() != nullptr);
+    tag_cache.Reset();
+
+    if (way_result_cache.IsEnabled())
+    {
+        if (const auto cached_result = way_result_cache.Find(way))
+        {
+            result = *cached_result;
+            return;
+        }
+    }
 
     switch (api_version)
     {
@@ -1194,6 +1285,33 @@ void LuaScriptingContext::ProcessWay(const osmium::Way &way,
         way_function(way, result);
         break;
     }
+
+    if (way_result_cache.IsEnabled())
+    {
+        way_result_cache.Insert(result);
+    }
+}
+
+void LuaScriptingContext::ProcessWays(
+    std::vector<std::pair<const osmium::Way &, ExtractionWay>>::iterator begin,
+    std::vector<std::pair<const osmium::Way &, ExtractionWay>>::iterator end,
+    const ExtractionRelationContainer &relations)
+{
+    BOOST_ASSERT(state.lua_state() != nullptr);
+    tag_cache.Reset();
+
+    // the arrays hold references to the ways and to the results that are filled in place
+    const auto number_of_ways = static_cast<int>(std::distance(begin, end));
+    sol::table ways = state.create_table(number_of_ways, 0);
+    sol::table results = state.create_table(number_of_ways, 0);
+    int index = 1;
+    for (auto iter = begin; iter != end; ++iter, ++index)
+    {
+        ways[index] = &iter->first;
+        results[index] = &iter->second;
+    }
+
+    ways_function(profile_table, ways, results, relations);
 }
 
 } // namespace extractor
@@ -0,0 +1,241 @@
+#include "extractor/scripting_environment_plugin.hpp"
+
+#include "extractor/extraction_node.hpp"
+#include "extractor/extraction_relation.hpp"
+#include "extractor/extraction_segment.hpp"
+#include "extractor/extraction_turn.hpp"
+#include "extractor/extraction_way.hpp"
+#include "extractor/maneuver_override_relation_parser.hpp"
+#include "extractor/restriction_parser.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+
+#include <osmium/osm.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include <algorithm>
+#include <string>
+
+namespace osrm
+{
+namespace extractor
+{
+
+namespace
+{
+void *openLibrary(const boost::filesystem::path &library_path)
+{
+#if defined(_WIN32)
+    return ::LoadLibraryW(library_path.wstring().c_str());
+#else
+    // the symbols of the plugin are resolved at load time, missing ones fail here
+    return ::dlopen(library_path.string().c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+}
+
+void *findSymbol(void *handle, const char *name)
+{
+#if defined(_WIN32)
+    return reinterpret_cast<void *>(::GetProcAddress(static_cast<HMODULE>(handle), name));
+#else
+    return ::dlsym(handle, name);
+#endif
+}
+
+void closeLibrary(void *handle)
+{
+#if defined(_WIN32)
+    ::FreeLibrary(static_cast<HMODULE>(handle));
+#else
+    ::dlclose(handle);
+#endif
+}
+
+std::string lastError()
+{
+#if defined(_WIN32)
+    return "error code " + std::to_string(::GetLastError());
+#else
+    const auto error = ::dlerror();
+    return error ? error : "unknown error";
+#endif
+}
+}
+
+PluginScriptingEnvironment::PluginScriptingEnvironment(const boost::filesystem::path &library_path)
+{
+    library_handle = openLibrary(library_path);
+    if (library_handle == nullptr)
+    {
+        throw util::exception("Could not load profile plugin " + library_path.string() + ": " +
+                              lastError() + SOURCE_REF);
+    }
+
+    using VersionFunction = int (*)();
+    using CreateFunction = ProfilePlugin *(*)();
+    const auto plugin_api_version = reinterpret_cast<VersionFunction>(
+        findSymbol(library_handle, "osrm_profile_plugin_api_version"));
+    const auto create_plugin = reinterpret_cast<CreateFunction>(
+        findSymbol(library_handle, "osrm_create_profile_plugin"));
+    destroy_plugin = reinterpret_cast<DestroyFunction>(
+        findSymbol(library_handle, "osrm_destroy_profile_plugin"));
+    if (plugin_api_version == nullptr || create_plugin == nullptr || destroy_plugin == nullptr)
+    {
+        closeLibrary(library_handle);
+        throw util::exception("Profile plugin " + library_path.string() +
+                              " does not define the entry points of OSRM_PROFILE_PLUGIN" +
+                              SOURCE_REF);
+    }
+
+    const auto version = plugin_api_version();
+    if (version != OSRM_PROFILE_PLUGIN_API_VERSION)
+    {
+        closeLibrary(library_handle);
+        throw util::exception("Invalid profile plugin API version " + std::to_string(version) +
+                              " only version " + std::to_string(OSRM_PROFILE_PLUGIN_API_VERSION) +
+                              " is supported." + SOURCE_REF);
+    }
+
+    plugin = create_plugin();
+    if (plugin == nullptr)
+    {
+        closeLibrary(library_handle);
+        throw util::exception("Profile plugin " + library_path.string() +
+                              " did not create a profile" + SOURCE_REF);
+    }
+    properties = plugin->GetProfileProperties();
+
+    util::Log() << "Using profile plugin " << library_path.string() << " with API version "
+                << version;
+}
+
+PluginScriptingEnvironment::~PluginScriptingEnvironment()
+{
+    // the plugin has to be destroyed by the library that allocated it
+    destroy_plugin(plugin);
+    closeLibrary(library_handle);
+}
+
+bool PluginScriptingEnvironment::IsPluginPath(const boost::filesystem::path &profile_path)
+{
+    const auto extension = profile_path.extension().string();
+    return boost::iequals(extension, ".so") || boost::iequals(extension, ".dylib") ||
+           boost::iequals(extension, ".dll");
+}
+
+std::vector<std::vector<std::string>> PluginScriptingEnvironment::GetExcludableClasses()
+{
+    return plugin->GetExcludableClasses();
+}
+
+std::vector<std::string> PluginScriptingEnvironment::GetNameSuffixList()
+{
+    return plugin->GetNameSuffixList();
+}
+
+std::vector<std::string> PluginScriptingEnvironment::GetClassNames()
+{
+    return plugin->GetClassNames();
+}
+
+std::vector<std::string> PluginScriptingEnvironment::GetRestrictions()
+{
+    return plugin->GetRestrictions();
+}
+
+std::vector<std::string> PluginScriptingEnvironment::GetRelations()
+{
+    return plugin->GetRelations();
+}
+
+void PluginScriptingEnvironment::ProcessTurn(ExtractionTurn &turn)
+{
+    plugin->ProcessTurn(turn);
+
+    // same as for lua profiles: the turn weight falls back to the duration value
+    // or is capped to the max turn weight, which depends on the weight precision
+    if (properties.fallback_to_duration)
+        turn.weight = turn.duration;
+    else
+        turn.weight = std::min(turn.weight, properties.GetMaxTurnWeight());
+}
+
+void PluginScriptingEnvironment::ProcessTurns(std::vector<ExtractionTurn> &turns)
+{
+    for (auto &turn : turns)
+    {
+        ProcessTurn(turn);
+    }
+}
+
+void PluginScriptingEnvironment::ProcessSegment(ExtractionSegment &segment)
+{
+    plugin->ProcessSegment(segment);
+}
+
+void PluginScriptingEnvironment::ProcessElements(
+    const osmium::memory::Buffer &buffer,
+    const RestrictionParser &restriction_parser,
+    const ManeuverOverrideRelationParser &maneuver_override_parser,
+    const ExtractionRelationContainer &relations,
+    std::vector<std::pair<const osmium::Node &, ExtractionNode>> &resulting_nodes,
+    std::vector<std::pair<const osmium::Way &, ExtractionWay>> &resulting_ways,
+    std::vector<InputConditionalTurnRestriction> &resulting_restrictions,
+    std::vector<InputManeuverOverride> &resulting_maneuver_overrides)
+{
+    ExtractionNode result_node;
+    ExtractionWay result_way;
+
+    for (auto entity = buffer.cbegin(), end = buffer.cend(); entity != end; ++entity)
+    {
+        switch (entity->type())
+        {
+        case osmium::item_type::node:
+        {
+            const auto &node = static_cast<const osmium::Node &>(*entity);
+            result_node.clear();
+            if (!node.tags().empty() || properties.call_tagless_node_function)
+            {
+                plugin->ProcessNode(node, result_node, relations);
+            }
+            resulting_nodes.push_back({node, std::move(result_node)});
+        }
+        break;
+        case osmium::item_type::way:
+        {
+            const osmium::Way &way = static_cast<const osmium::Way &>(*entity);
+            result_way.clear();
+            plugin->ProcessWay(way, result_way, relations);
+            resulting_ways.push_back({way, std::move(result_way)});
+        }
+        break;
+        case osmium::item_type::relation:
+        {
+            const auto &relation = static_cast<const osmium::Relation &>(*entity);
+            if (auto result_res = restriction_parser.TryParse(relation))
+            {
+                resulting_restrictions.push_back(*result_res);
+            }
+            else if (auto result_res = maneuver_override_parser.TryParse(relation))
+            {
+                resulting_maneuver_overrides.push_back(*result_res);
+            }
+        }
+        break;
+        default:
+            break;
+        }
+    }
+}
+
+} // namespace extractor
+} // namespace osrm
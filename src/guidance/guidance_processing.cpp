@@ -6,27 +6,116 @@
 
 #include "util/assert.hpp"
 #include "util/connectivity_checksum.hpp"
+#include "util/integer_range.hpp"
 #include "util/percent.hpp"
 
+#include <boost/assert.hpp>
+
 #include <tbb/blocked_range.h>
 #include <tbb/pipeline.h>
 #include <tbb/task_scheduler_init.h>
 
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace osrm
 {
 namespace guidance
 {
 
+namespace
+{
+// Classes found by a worker of the guidance stage, numbered in the order they are found. The output
+// stage translates them into global ids in the order of the nodes, which keeps the ids independent
+// of the scheduling of the workers.
+template <typename Class> struct LocalClasses
+{
+    std::vector<Class> classes;
+    std::unordered_map<Class, std::uint32_t> ids;
+
+    std::uint32_t FindOrAdd(const Class &value)
+    {
+        const auto inserted = ids.insert({value, static_cast<std::uint32_t>(classes.size())});
+        if (inserted.second)
+            classes.push_back(value);
+        return inserted.first->second;
+    }
+};
+
+// The lane data and the lane descriptions the lane handler adds get their ids from maps shared by
+// the workers. `lane_data_ids` renumbers the lane data in the order of the turns that use them, the
+// maps are rebuilt with these ids and the added lane descriptions are renumbered in the order of
+// the lane data that refer to them. Lane data and added descriptions that no turn uses are dropped.
+void renumberLaneData(const std::vector<LaneDataID> &lane_data_ids,
+                      const LaneDataID number_of_lane_data,
+                      const LaneDescriptionID number_of_lane_descriptions,
+                      util::guidance::LaneDataIdMap &lane_data_map,
+                      extractor::LaneDescriptionMap &lane_description_map)
+{
+    std::vector<util::guidance::LaneTupleIdPair> lane_data(number_of_lane_data);
+    for (const auto &entry : lane_data_map.data)
+    {
+        if (entry.second < lane_data_ids.size() &&
+            lane_data_ids[entry.second] != INVALID_LANE_DATAID)
+            lane_data[lane_data_ids[entry.second]] = entry.first;
+    }
+
+    BOOST_ASSERT(lane_description_map.data.size() >= number_of_lane_descriptions);
+    std::vector<LaneDescriptionID> lane_description_ids(
+        lane_description_map.data.size() - number_of_lane_descriptions,
+        INVALID_LANE_DESCRIPTIONID);
+    auto next_lane_description_id = number_of_lane_descriptions;
+    for (auto &key : lane_data)
+    {
+        if (key.second == INVALID_LANE_DESCRIPTIONID || key.second < number_of_lane_descriptions)
+            continue;
+
+        auto &lane_description_id = lane_description_ids[key.second - number_of_lane_descriptions];
+        if (lane_description_id == INVALID_LANE_DESCRIPTIONID)
+            lane_description_id = next_lane_description_id++;
+        key.second = lane_description_id;
+    }
+
+    for (auto itr = lane_description_map.data.begin(); itr != lane_description_map.data.end();)
+    {
+        if (itr->second < number_of_lane_descriptions)
+        {
+            ++itr;
+            continue;
+        }
+
+        const auto lane_description_id =
+            lane_description_ids[itr->second - number_of_lane_descriptions];
+        if (lane_description_id == INVALID_LANE_DESCRIPTIONID)
+        {
+            itr = lane_description_map.data.erase(itr);
+        }
+        else
+        {
+            itr->second = lane_description_id;
+            ++itr;
+        }
+    }
+
+    lane_data_map.data.clear();
+    for (const auto lane_data_id : util::irange<LaneDataID>(0, number_of_lane_data))
+        lane_data_map.data[lane_data[lane_data_id]] = lane_data_id;
+}
+} // namespace
+
 void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
                    const extractor::EdgeBasedNodeDataContainer &edge_based_node_container,
                    const std::vector<util::Coordinate> &node_coordinates,
                    const extractor::CompressedEdgeContainer &compressed_edge_container,
-                   const std::unordered_set<NodeID> &barrier_nodes,
+                   const util::IdSet<NodeID> &barrier_nodes,
                    const extractor::RestrictionMap &node_restriction_map,
                    const extractor::WayRestrictionMap &way_restriction_map,
                    const extractor::NameTable &name_table,
                    const extractor::SuffixTable &suffix_table,
                    const extractor::TurnLanesIndexedArray &turn_lanes_data,
+                   const extractor::intersection::IntersectionGeometryCache &intersection_geometries,
                    extractor::LaneDescriptionMap &lane_description_map,
                    util::guidance::LaneDataIdMap &lane_data_map,
                    guidance::TurnDataExternalContainer &turn_data_container,
@@ -37,15 +126,8 @@ void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
 {
     util::Log() << "Generating guidance turns ";
 
-    extractor::intersection::MergableRoadDetector mergable_road_detector(node_based_graph,
-                                                                         edge_based_node_container,
-                                                                         node_coordinates,
-                                                                         compressed_edge_container,
-                                                                         node_restriction_map,
-                                                                         barrier_nodes,
-                                                                         turn_lanes_data,
-                                                                         name_table,
-                                                                         suffix_table);
+    const auto number_of_lane_descriptions =
+        static_cast<LaneDescriptionID>(lane_description_map.data.size());
 
     guidance::TurnAnalysis turn_analysis(node_based_graph,
                                          edge_based_node_container,
@@ -78,6 +160,11 @@ void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
         std::vector<guidance::TurnData> continuous_turn_data; // populate answers from guidance
         std::vector<guidance::TurnData> delayed_turn_data;    // populate answers from guidance
 
+        // the turns of the range refer to these classes by their position
+        LocalClasses<util::guidance::EntryClass> entry_classes;
+        LocalClasses<util::guidance::BearingClass> bearing_classes;
+        std::vector<std::pair<NodeID, BearingClassID>> bearing_class_by_node;
+
         util::ConnectivityChecksum checksum;
     };
     using TurnsPipelineBufferPtr = std::shared_ptr<TurnsPipelineBuffer>;
@@ -133,12 +220,7 @@ void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
                     const auto &outgoing_edges = extractor::intersection::getOutgoingEdges(
                         node_based_graph, intersection_node);
                     const auto &edge_geometries_and_merged_edges =
-                        extractor::intersection::getIntersectionGeometries(
-                            node_based_graph,
-                            compressed_edge_container,
-                            node_coordinates,
-                            mergable_road_detector,
-                            intersection_node);
+                        intersection_geometries.Get(node_based_graph, intersection_node);
                     const auto &edge_geometries = edge_geometries_and_merged_edges.first;
                     const auto &merged_edge_ids = edge_geometries_and_merged_edges.second;
 
@@ -191,15 +273,12 @@ void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
                             classifyIntersection(intersection, node_coordinates[intersection_node]);
 
                         const auto entry_class_id =
-                            entry_class_hash.ConcurrentFindOrAdd(turn_classification.first);
+                            buffer->entry_classes.FindOrAdd(turn_classification.first);
 
                         const auto bearing_class_id =
-                            bearing_class_hash.ConcurrentFindOrAdd(turn_classification.second);
-
-                        // Note - this is strictly speaking not thread safe, but we know we
-                        // should never be touching the same element twice, so we should
-                        // be fine.
-                        bearing_class_by_node_based_node[intersection_node] = bearing_class_id;
+                            buffer->bearing_classes.FindOrAdd(turn_classification.second);
+                        buffer->bearing_class_by_node.emplace_back(intersection_node,
+                                                                   bearing_class_id);
 
                         // check if we are turning off a via way
                         const auto turning_off_via_way =
@@ -291,6 +370,8 @@ void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
                     }
                 }
 
+                buffer->entry_classes.ids.clear();
+                buffer->bearing_classes.ids.clear();
                 return buffer;
             });
 
@@ -299,6 +380,10 @@ void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
         util::Percent guidance_progress(log, node_count);
         std::vector<guidance::TurnData> delayed_turn_data;
 
+        // ids of the lane data in the order of the turns, by the id the lane handler assigned
+        std::vector<LaneDataID> lane_data_ids;
+        LaneDataID number_of_lane_data = 0;
+
         tbb::filter_t<TurnsPipelineBufferPtr, void> guidance_output_stage(
             tbb::filter::serial_in_order, [&](auto buffer) {
 
@@ -306,14 +391,47 @@ void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
 
                 connectivity_checksum = buffer->checksum.update_checksum(connectivity_checksum);
 
+                // Only this stage writes to the class maps, the ids do not depend on the order
+                // the ranges were processed in
+                std::vector<EntryClassID> entry_class_ids;
+                entry_class_ids.reserve(buffer->entry_classes.classes.size());
+                for (const auto &entry_class : buffer->entry_classes.classes)
+                    entry_class_ids.push_back(entry_class_hash.ConcurrentFindOrAdd(entry_class));
+
+                std::vector<BearingClassID> bearing_class_ids;
+                bearing_class_ids.reserve(buffer->bearing_classes.classes.size());
+                for (const auto &bearing_class : buffer->bearing_classes.classes)
+                    bearing_class_ids.push_back(
+                        bearing_class_hash.ConcurrentFindOrAdd(bearing_class));
+
+                for (const auto &node_and_class : buffer->bearing_class_by_node)
+                    bearing_class_by_node_based_node[node_and_class.first] =
+                        bearing_class_ids[node_and_class.second];
+
+                const auto renumber = [&](guidance::TurnData &turn_data) {
+                    turn_data.entry_class_id = entry_class_ids[turn_data.entry_class_id];
+
+                    const auto lane_data_id = turn_data.lane_data_id;
+                    if (lane_data_id == INVALID_LANE_DATAID)
+                        return;
+                    if (lane_data_id >= lane_data_ids.size())
+                        lane_data_ids.resize(lane_data_id + 1, INVALID_LANE_DATAID);
+                    if (lane_data_ids[lane_data_id] == INVALID_LANE_DATAID)
+                        lane_data_ids[lane_data_id] = number_of_lane_data++;
+                    turn_data.lane_data_id = lane_data_ids[lane_data_id];
+                };
+
                 // Guidance data
                 std::for_each(buffer->continuous_turn_data.begin(),
                               buffer->continuous_turn_data.end(),
-                              [&turn_data_container](const auto &turn_data) {
+                              [&](auto &turn_data) {
+                                  renumber(turn_data);
                                   turn_data_container.push_back(turn_data);
                               });
 
                 // Copy via-way restrictions delayed data
+                std::for_each(
+                    buffer->delayed_turn_data.begin(), buffer->delayed_turn_data.end(), renumber);
                 delayed_turn_data.insert(delayed_turn_data.end(),
                                          buffer->delayed_turn_data.begin(),
                                          buffer->delayed_turn_data.end());
@@ -333,6 +451,12 @@ void annotateTurns(const util::NodeBasedDynamicGraph &node_based_graph,
                       [&turn_data_container](const auto &turn_data) {
                           turn_data_container.push_back(turn_data);
                       });
+
+        renumberLaneData(lane_data_ids,
+                         number_of_lane_data,
+                         number_of_lane_descriptions,
+                         lane_data_map,
+                         lane_description_map);
     }
 
     util::Log() << "done.";
@@ -50,7 +50,7 @@ IntersectionHandler::IntersectionHandler(
     const std::vector<util::Coordinate> &node_coordinates,
     const extractor::CompressedEdgeContainer &compressed_geometries,
     const extractor::RestrictionMap &node_restriction_map,
-    const std::unordered_set<NodeID> &barrier_nodes,
+    const util::IdSet<NodeID> &barrier_nodes,
     const extractor::TurnLanesIndexedArray &turn_lanes_data,
     const extractor::NameTable &name_table,
     const extractor::SuffixTable &street_name_suffix_table)
@@ -28,7 +28,7 @@ RoundaboutHandler::RoundaboutHandler(
     const std::vector<util::Coordinate> &coordinates,
     const extractor::CompressedEdgeContainer &compressed_geometries,
     const extractor::RestrictionMap &node_restriction_map,
-    const std::unordered_set<NodeID> &barrier_nodes,
+    const util::IdSet<NodeID> &barrier_nodes,
     const extractor::TurnLanesIndexedArray &turn_lanes_data,
     const extractor::NameTable &name_table,
     const extractor::SuffixTable &street_name_suffix_table)
@@ -267,7 +267,7 @@ RoundaboutType RoundaboutHandler::getRoundaboutType(const NodeID nid) const
     const auto getEdgeLength = [&](const NodeID source_node, EdgeID eid) {
         double length = 0.;
         auto last_coord = node_coordinates[source_node];
-        const auto &edge_bucket = compressed_geometries.GetBucketReference(eid);
+        const auto edge_bucket = compressed_geometries.GetBucketReference(eid);
         for (const auto &compressed_edge : edge_bucket)
         {
             const auto next_coord = node_coordinates[compressed_edge.node_id];
@@ -4,7 +4,13 @@
 #include "guidance/turn_instruction.hpp"
 
 #include "util/coordinate_calculation.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
 #include <set>
+#include <vector>
 
 using osrm::guidance::getTurnDirection;
 
@@ -40,7 +46,7 @@ struct EdgeInfo
     };
 };
 
-std::unordered_set<EdgeID> findSegregatedNodes(const extractor::NodeBasedGraphFactory &factory,
+util::IdSet<EdgeID> findSegregatedNodes(const extractor::NodeBasedGraphFactory &factory,
                                                const extractor::NameTable &names)
 {
     auto const &graph = factory.GetGraph();
@@ -265,26 +271,44 @@ std::unordered_set<EdgeID> findSegregatedNodes(const extractor::NodeBasedGraphFa
                             edge_length);
     };
 
-    std::unordered_set<EdgeID> segregated_edges;
-
-    for (NodeID source_id = 0; source_id < graph.GetNumberOfNodes(); ++source_id)
-    {
-        auto const source_edges = graph.GetAdjacentEdgeRange(source_id);
-        for (EdgeID edge_id : source_edges)
-        {
-            auto const &edgeData = graph.GetEdgeData(edge_id);
-
-            if (edgeData.reversed)
-                continue;
+    // the edges are classified independently, only reading the graph and the geometries
+    tbb::enumerable_thread_specific<std::vector<EdgeID>> thread_segregated_edges;
 
-            NodeID const target_id = graph.GetTarget(edge_id);
-            auto const targetEdges = graph.GetAdjacentEdgeRange(target_id);
+    tbb::parallel_for(
+        tbb::blocked_range<NodeID>(0, graph.GetNumberOfNodes()),
+        [&](const tbb::blocked_range<NodeID> &range) {
+            auto &local_segregated_edges = thread_segregated_edges.local();
+            for (auto source_id = range.begin(); source_id != range.end(); ++source_id)
+            {
+                auto const source_edges = graph.GetAdjacentEdgeRange(source_id);
+                for (EdgeID edge_id : source_edges)
+                {
+                    auto const &edgeData = graph.GetEdgeData(edge_id);
+
+                    if (edgeData.reversed)
+                        continue;
+
+                    NodeID const target_id = graph.GetTarget(edge_id);
+                    auto const targetEdges = graph.GetAdjacentEdgeRange(target_id);
+
+                    double const length = get_edge_length(source_id, edge_id, target_id);
+                    if (isSegregatedFn(edge_id,
+                                       edgeData,
+                                       source_edges,
+                                       source_id,
+                                       targetEdges,
+                                       target_id,
+                                       length))
+                        local_segregated_edges.push_back(edge_id);
+                }
+            }
+        });
 
-            double const length = get_edge_length(source_id, edge_id, target_id);
-            if (isSegregatedFn(
-                    edge_id, edgeData, source_edges, source_id, targetEdges, target_id, length))
-                segregated_edges.insert(edge_id);
-        }
+    util::IdSet<EdgeID> segregated_edges;
+    segregated_edges.resize(graph.GetNumberOfEdges());
+    for (const auto &local_segregated_edges : thread_segregated_edges)
+    {
+        segregated_edges.insert(local_segregated_edges.begin(), local_segregated_edges.end());
     }
 
     return segregated_edges;
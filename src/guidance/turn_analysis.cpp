@@ -7,7 +7,6 @@
 
 #include <cstddef>
 #include <set>
-#include <unordered_set>
 #include <utility>
 
 using osrm::guidance::getTurnDirection;
@@ -24,7 +23,7 @@ TurnAnalysis::TurnAnalysis(const util::NodeBasedDynamicGraph &node_based_graph,
                            const std::vector<util::Coordinate> &node_coordinates,
                            const extractor::CompressedEdgeContainer &compressed_edge_container,
                            const extractor::RestrictionMap &restriction_map,
-                           const std::unordered_set<NodeID> &barrier_nodes,
+                           const util::IdSet<NodeID> &barrier_nodes,
                            const extractor::TurnLanesIndexedArray &turn_lanes_data,
                            const extractor::NameTable &name_table,
                            const extractor::SuffixTable &street_name_suffix_table)
@@ -22,7 +22,7 @@ bool findPreviousIntersection(const NodeID node_v,
                               const std::vector<util::Coordinate> &node_coordinates,
                               const extractor::CompressedEdgeContainer &compressed_geometries,
                               const extractor::RestrictionMap &node_restriction_map,
-                              const std::unordered_set<NodeID> &barrier_nodes,
+                              const util::IdSet<NodeID> &barrier_nodes,
                               const extractor::TurnLanesIndexedArray &turn_lanes_data,
                               // output parameters
                               NodeID &result_node,
@@ -113,7 +113,7 @@ TurnHandler::TurnHandler(const util::NodeBasedDynamicGraph &node_based_graph,
                          const std::vector<util::Coordinate> &coordinates,
                          const extractor::CompressedEdgeContainer &compressed_geometries,
                          const extractor::RestrictionMap &node_restriction_map,
-                         const std::unordered_set<NodeID> &barrier_nodes,
+                         const util::IdSet<NodeID> &barrier_nodes,
                          const extractor::TurnLanesIndexedArray &turn_lanes_data,
                          const extractor::NameTable &name_table,
                          const extractor::SuffixTable &street_name_suffix_table)
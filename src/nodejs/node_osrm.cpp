@@ -8,17 +8,27 @@
 #include "osrm/tile_parameters.hpp"
 #include "osrm/trip_parameters.hpp"
 
+#include <cstddef>
 #include <exception>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 
 #include "nodejs/node_osrm.hpp"
 #include "nodejs/node_osrm_support.hpp"
+#include "nodejs/thread_pool.hpp"
 
 namespace node_osrm
 {
 
-Engine::Engine(osrm::EngineConfig &config) : Base(), this_(std::make_shared<osrm::OSRM>(config)) {}
+Engine::Engine(osrm::EngineConfig &config, const std::size_t number_of_threads)
+    : Base(), this_(std::make_shared<osrm::OSRM>(config))
+{
+    if (number_of_threads > 0)
+    {
+        pool = std::make_shared<ThreadPool>(number_of_threads);
+    }
+}
 
 Nan::Persistent<v8::Function> &Engine::constructor()
 {
@@ -80,6 +90,8 @@ NAN_MODULE_INIT(Engine::Init)
  * @param {Number} [options.max_radius_map_matching] Max. radius size supported in map matching query (default: 5).
  * @param {Number} [options.max_results_nearest] Max. results supported in nearest query (default: unlimited).
  * @param {Number} [options.max_alternatives] Max. number of alternatives supported in alternative routes query (default: 3).
+ * @param {Number} [options.max_alternative_time] Max. milliseconds a route query spends on alternatives, the shortest route is always returned (default: unlimited).
+ * @param {Number} [options.threads] Number of threads of a pool of this object that runs its queries. By default the queries run on the libuv threadpool, which is shared with file system and DNS requests.
  *
  * @class OSRM
  *
@@ -95,7 +107,11 @@ NAN_METHOD(Engine::New)
             if (!config)
                 return;
 
-            auto *const self = new Engine(*config);
+            const auto number_of_threads = argumentsToNumberOfThreads(info);
+            if (!number_of_threads)
+                return;
+
+            auto *const self = new Engine(*config, *number_of_threads);
             self->Wrap(info.This());
         }
         catch (const std::exception &ex)
@@ -112,11 +128,42 @@ NAN_METHOD(Engine::New)
     }
 }
 
-template <typename ParameterParser, typename ServiceMemFn>
+// Selects the overload of a service that fills a JSON object
+template <typename ParameterT>
+using JSONServiceMemFn = osrm::Status (osrm::OSRM::*)(const ParameterT &, osrm::json::Object &)
+    const;
+
+// Selects the overload of a service that fills a result in the format of the alternative it holds
+template <typename ParameterT>
+using ResultServiceMemFn = osrm::Status (osrm::OSRM::*)(const ParameterT &,
+                                                        osrm::engine::api::ResultT &) const;
+
+template <typename ParamPtr, typename ResultServiceMemFn>
+inline osrm::Status callResultService(const osrm::OSRM &osrm,
+                                      const ParamPtr &params,
+                                      ResultServiceMemFn service,
+                                      osrm::engine::api::ResultT &result)
+{
+    return (osrm.*(service))(*params, result);
+}
+
+template <typename ParamPtr>
+inline osrm::Status callResultService(const osrm::OSRM &,
+                                      const ParamPtr &,
+                                      std::nullptr_t,
+                                      osrm::engine::api::ResultT &)
+{
+    throw std::logic_error("The service has no binary format");
+}
+
+template <typename ParameterParser,
+          typename ServiceMemFn,
+          typename ResultServiceMemFn = std::nullptr_t>
 inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
                   ParameterParser argsToParams,
                   ServiceMemFn service,
-                  bool requires_multiple_coordinates)
+                  bool requires_multiple_coordinates,
+                  ResultServiceMemFn result_service = nullptr)
 {
     auto params = argsToParams(info, requires_multiple_coordinates);
     if (!params)
@@ -124,6 +171,17 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
 
     BOOST_ASSERT(params->IsValid());
 
+    const auto plugin_params = argumentsToPluginParameters(info);
+    if (!plugin_params)
+        return;
+
+    using Format = PluginParameters::Format;
+    const auto format = plugin_params->format;
+    if (format == Format::Binary && std::is_same<ResultServiceMemFn, std::nullptr_t>::value)
+        return Nan::ThrowError("format binary is only supported by route, table and match");
+    if (format == Format::TypedArray && !std::is_same<decltype(params), table_parameters_ptr>::value)
+        return Nan::ThrowError("format typed_array is only supported by table");
+
     if (!info[info.Length() - 1]->IsFunction())
         return Nan::ThrowTypeError("last argument must be a callback function");
 
@@ -137,16 +195,43 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
         Worker(std::shared_ptr<osrm::OSRM> osrm_,
                ParamPtr params_,
                ServiceMemFn service,
+               ResultServiceMemFn result_service,
+               const PluginParameters &plugin_params_,
                Nan::Callback *callback)
             : Base(callback), osrm{std::move(osrm_)}, service{std::move(service)},
-              params{std::move(params_)}
+              result_service{std::move(result_service)}, params{std::move(params_)},
+              plugin_params{plugin_params_}
+        {
+        }
+
+        bool HasNativeResult() const
         {
+            return plugin_params.format == PluginParameters::Format::TypedArray ||
+                   plugin_params.format == PluginParameters::Format::Binary;
         }
 
         void Execute() override try
         {
+            if (HasNativeResult())
+            {
+                // the alternative of the result selects the format the service fills in
+                if (plugin_params.format == PluginParameters::Format::Binary)
+                    native_result = std::string();
+                else
+                    native_result = osrm::engine::api::native::TableResult();
+
+                const auto status =
+                    callResultService(*osrm, params, result_service, native_result);
+                ParseResult(status, native_result);
+                return;
+            }
+
             const auto status = ((*osrm).*(service))(*params, result);
             ParseResult(status, result);
+            if (plugin_params.format == PluginParameters::Format::JSONBuffer)
+            {
+                buffer = renderToBuffer(result);
+            }
         }
         catch (const std::exception &e)
         {
@@ -158,7 +243,10 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
             Nan::HandleScope scope;
 
             const constexpr auto argc = 2u;
-            v8::Local<v8::Value> argv[argc] = {Nan::Null(), render(result)};
+            v8::Local<v8::Value> argv[argc] = {
+                Nan::Null(),
+                HasNativeResult() ? render(native_result)
+                                  : buffer ? render(std::move(buffer)) : render(result)};
 
             callback->Call(argc, argv);
         }
@@ -166,7 +254,9 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
         // Keeps the OSRM object alive even after shutdown until we're done with callback
         std::shared_ptr<osrm::OSRM> osrm;
         ServiceMemFn service;
+        ResultServiceMemFn result_service;
         const ParamPtr params;
+        const PluginParameters plugin_params;
 
         // All services return json::Object .. except for Tile!
         using ObjectOrString =
@@ -175,10 +265,23 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
                                       osrm::json::Object>::type;
 
         ObjectOrString result;
+        // The JSON result rendered on the worker thread, if requested
+        std::unique_ptr<std::vector<char>> buffer;
+        // The binary format or the plain table result, if requested
+        osrm::engine::api::ResultT native_result;
     };
 
     auto *callback = new Nan::Callback{info[info.Length() - 1].As<v8::Function>()};
-    Nan::AsyncQueueWorker(new Worker{self->this_, std::move(params), service, callback});
+    auto *worker = new Worker{
+        self->this_, std::move(params), service, result_service, *plugin_params, callback};
+    if (self->pool)
+    {
+        self->pool->Queue(worker);
+    }
+    else
+    {
+        Nan::AsyncQueueWorker(worker);
+    }
 }
 
 // clang-format off
@@ -203,6 +306,8 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
  * @param {Boolean} [options.continue_straight] Forces the route to keep going straight at waypoints and don't do a uturn even if it would be faster. Default value depends on the profile.
  * @param {Array} [options.approaches] Keep waypoints on curb side. Can be `null` (unrestricted, default) or `curb`.
  *                  `null`/`true`/`false`
+ * @param {Object} [plugin_config] - Plugin configuration for the query.
+ * @param {String} [plugin_config.format=object] The format of the result: `object` for an object, `json_buffer` for a Buffer with the JSON text that is rendered on the worker thread, or `binary` for a Buffer with the binary format of the result.
  * @param {Function} callback
  *
  * @returns {Object} An array of [Waypoint](#waypoint) objects representing all waypoints in order AND an array of [`Route`](#route) objects ordered by descending recommendation rank.
@@ -218,7 +323,11 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
 // clang-format on
 NAN_METHOD(Engine::route) //
 {
-    async(info, &argumentsToRouteParameter, &osrm::OSRM::Route, true);
+    async(info,
+          &argumentsToRouteParameter,
+          static_cast<JSONServiceMemFn<osrm::RouteParameters>>(&osrm::OSRM::Route),
+          true,
+          static_cast<ResultServiceMemFn<osrm::RouteParameters>>(&osrm::OSRM::Route));
 }
 
 // clang-format off
@@ -238,6 +347,8 @@ NAN_METHOD(Engine::route) //
  * @param {Number} [options.number=1] Number of nearest segments that should be returned.
  * Must be an integer greater than or equal to `1`.
  * @param {Array} [options.approaches] Keep waypoints on curb side. Can be `null` (unrestricted, default) or `curb`.
+ * @param {Object} [plugin_config] - Plugin configuration for the query.
+ * @param {String} [plugin_config.format=object] The format of the result: `object` for an object, or `json_buffer` for a Buffer with the JSON text that is rendered on the worker thread.
  * @param {Function} callback
  *
  * @returns {Object} containing `waypoints`.
@@ -280,6 +391,10 @@ NAN_METHOD(Engine::nearest) //
  * @param {Array} [options.destinations] An array of `index` elements (`0 <= integer <
  * #coordinates`) to use location with given index as destination. Default is to use all.
  * @param {Array} [options.approaches] Keep waypoints on curb side. Can be `null` (unrestricted, default) or `curb`.
+ * @param {Boolean} [options.approximate=false] Durations as upper bounds through representatives of the cells of the sources and destinations, for very large tables. Only supported by the `MLD` algorithm, ignored otherwise.
+ * @param {Object} [plugin_config] - Plugin configuration for the query.
+ * @param {String} [plugin_config.format=object] The format of the result: `object` for an object, `json_buffer` for a Buffer with the JSON text that is rendered on the worker thread, `typed_array` for an object whose `durations` and `distances` are `Float64Array`s on the memory of the result, or `binary` for a Buffer with the binary format of the result.
+ *                                                With `typed_array` the matrices are flat in row-major order, `durations[i * destinations.length + j]` is the duration from the i-th source to the j-th destination. Unreachable pairs are `Infinity` instead of `null`.
  * @param {Function} callback
  *
  * @returns {Object} containing `durations`, `sources`, and `destinations`.
@@ -306,7 +421,11 @@ NAN_METHOD(Engine::nearest) //
 // clang-format on
 NAN_METHOD(Engine::table) //
 {
-    async(info, &argumentsToTableParameter, &osrm::OSRM::Table, true);
+    async(info,
+          &argumentsToTableParameter,
+          static_cast<JSONServiceMemFn<osrm::TableParameters>>(&osrm::OSRM::Table),
+          true,
+          static_cast<ResultServiceMemFn<osrm::TableParameters>>(&osrm::OSRM::Table));
 }
 
 // clang-format off
@@ -364,6 +483,8 @@ NAN_METHOD(Engine::tile)
  * @param {String} [options.gaps] Allows the input track splitting based on huge timestamp gaps between points. Either `split` or `ignore` (optional, default `split`).
  * @param {Boolean} [options.tidy] Allows the input track modification to obtain better matching quality for noisy tracks (optional, default `false`).
  *
+ * @param {Object} [plugin_config] - Plugin configuration for the query.
+ * @param {String} [plugin_config.format=object] The format of the result: `object` for an object, `json_buffer` for a Buffer with the JSON text that is rendered on the worker thread, or `binary` for a Buffer with the binary format of the result.
  * @param {Function} callback
  *
  * @returns {Object} containing `tracepoints` and `matchings`.
@@ -391,15 +512,19 @@ NAN_METHOD(Engine::tile)
 // clang-format on
 NAN_METHOD(Engine::match) //
 {
-    async(info, &argumentsToMatchParameter, &osrm::OSRM::Match, true);
+    async(info,
+          &argumentsToMatchParameter,
+          static_cast<JSONServiceMemFn<osrm::MatchParameters>>(&osrm::OSRM::Match),
+          true,
+          static_cast<ResultServiceMemFn<osrm::MatchParameters>>(&osrm::OSRM::Match));
 }
 
 // clang-format off
 /**
- * The trip plugin solves the Traveling Salesman Problem using a greedy heuristic
- * (farthest-insertion algorithm) for 10 or * more waypoints and uses brute force for less than 10
- * waypoints. The returned path does not have to be the shortest path, * as TSP is NP-hard it is
- * only an approximation.
+ * The trip plugin solves the Traveling Salesman Problem exactly with dynamic programming for up
+ * to 16 waypoints and uses a greedy heuristic (farthest-insertion algorithm) for more than 16
+ * waypoints. For more waypoints the returned path does not have to be the shortest path, * as TSP
+ * is NP-hard it is only an approximation.
  *
  * Note that all input coordinates have to be connected for the trip service to work.
  * Currently, not all combinations of `roundtrip`, `source` and `destination` are supported.
@@ -428,6 +553,8 @@ NAN_METHOD(Engine::match) //
  * @param {Array|Boolean} [options.annotations=false] An array with strings of `duration`, `nodes`, `distance`, `weight`, `datasources`, `speed` or boolean for enabling/disabling all.
  * @param {String} [options.geometries=polyline] Returned route geometry format (influences overview and per step). Can also be `geojson`.
  * @param {String} [options.overview=simplified] Add overview geometry either `full`, `simplified`
+ * @param {Object} [plugin_config] - Plugin configuration for the query.
+ * @param {String} [plugin_config.format=object] The format of the result: `object` for an object, or `json_buffer` for a Buffer with the JSON text that is rendered on the worker thread.
  * @param {Function} callback
  * @param {Boolean} [options.roundtrip=true] Return route is a roundtrip.
  * @param {String} [options.source=any] Return route starts at `any` or `first` coordinate.
@@ -1,6 +1,8 @@
 #include "osrm/osrm.hpp"
 
 #include "engine/algorithm.hpp"
+#include "engine/api/batch_parameters.hpp"
+#include "engine/api/isochrone_parameters.hpp"
 #include "engine/api/match_parameters.hpp"
 #include "engine/api/nearest_parameters.hpp"
 #include "engine/api/route_parameters.hpp"
@@ -11,6 +13,7 @@
 #include "engine/status.hpp"
 
 #include <memory>
+#include <utility>
 
 namespace osrm
 {
@@ -57,12 +60,31 @@ OSRM &OSRM::operator=(OSRM &&) noexcept = default;
 // Forward to implementation
 
 engine::Status OSRM::Route(const engine::api::RouteParameters &params,
-                           util::json::Object &result) const
+                           util::json::Object &json_result) const
+{
+    engine::api::ResultT result = json::Object();
+    const auto status = engine_->Route(params, result);
+    json_result = std::move(result.get<json::Object>());
+    return status;
+}
+
+engine::Status OSRM::Route(const engine::api::RouteParameters &params,
+                           engine::api::ResultT &result) const
 {
     return engine_->Route(params, result);
 }
 
-engine::Status OSRM::Table(const engine::api::TableParameters &params, json::Object &result) const
+engine::Status OSRM::Table(const engine::api::TableParameters &params,
+                           json::Object &json_result) const
+{
+    engine::api::ResultT result = json::Object();
+    const auto status = engine_->Table(params, result);
+    json_result = std::move(result.get<json::Object>());
+    return status;
+}
+
+engine::Status OSRM::Table(const engine::api::TableParameters &params,
+                           engine::api::ResultT &result) const
 {
     return engine_->Table(params, result);
 }
@@ -78,7 +100,17 @@ engine::Status OSRM::Trip(const engine::api::TripParameters &params, json::Objec
     return engine_->Trip(params, result);
 }
 
-engine::Status OSRM::Match(const engine::api::MatchParameters &params, json::Object &result) const
+engine::Status OSRM::Match(const engine::api::MatchParameters &params,
+                           json::Object &json_result) const
+{
+    engine::api::ResultT result = json::Object();
+    const auto status = engine_->Match(params, result);
+    json_result = std::move(result.get<json::Object>());
+    return status;
+}
+
+engine::Status OSRM::Match(const engine::api::MatchParameters &params,
+                           engine::api::ResultT &result) const
 {
     return engine_->Match(params, result);
 }
@@ -88,4 +120,21 @@ engine::Status OSRM::Tile(const engine::api::TileParameters &params, std::string
     return engine_->Tile(params, result);
 }
 
+engine::Status OSRM::Batch(const engine::api::BatchParameters &params, json::Object &result) const
+{
+    return engine_->Batch(params, result);
+}
+
+engine::Status OSRM::Isochrone(const engine::api::IsochroneParameters &params,
+                               json::Object &result) const
+{
+    return engine_->Isochrone(params, result);
+}
+
+engine::Status OSRM::Memory(json::Object &result) const { return engine_->Memory(result); }
+
+engine::DatasetVersion OSRM::GetDatasetVersion() const { return engine_->GetDatasetVersion(); }
+
+void OSRM::WarmUp() const { engine_->WarmUp(); }
+
 } // ns osrm
@@ -1,8 +1,13 @@
 #include "partitioner/dinic_max_flow.hpp"
 #include "util/integer_range.hpp"
 
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
 #include <algorithm>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <queue>
 #include <set>
@@ -18,6 +23,9 @@ namespace
 
 const auto constexpr INVALID_LEVEL = std::numeric_limits<DinicMaxFlow::Level>::max();
 
+// views with fewer nodes compute their level graph with a sequential BFS
+const std::size_t constexpr PARALLEL_LEVEL_GRAPH_MIN_NODES = 1 << 16;
+
 auto makeHasNeighborNotInCheck(const DinicMaxFlow::SourceSinkNodes &set,
                                const BisectionGraphView &view)
 {
@@ -35,6 +43,101 @@ auto makeHasNeighborNotInCheck(const DinicMaxFlow::SourceSinkNodes &set,
 DinicMaxFlow::MinCut DinicMaxFlow::operator()(const BisectionGraphView &view,
                                               const SourceSinkNodes &source_nodes,
                                               const SourceSinkNodes &sink_nodes) const
+{
+    const std::atomic<std::size_t> no_upper_bound{std::numeric_limits<std::size_t>::max()};
+    return (*this)(view, source_nodes, sink_nodes, no_upper_bound);
+}
+
+void DinicMaxFlow::FlowEdges::Reset(const BisectionGraphView &view)
+{
+    first_edge_bit.resize(view.NumberOfNodes() + 1);
+    first_edge_bit[0] = 0;
+    for (const auto node : util::irange<NodeID>(0, view.NumberOfNodes()))
+    {
+        first_edge_bit[node + 1] =
+            first_edge_bit[node] + std::distance(view.BeginEdges(node), view.EndEdges(node));
+    }
+    edge_has_flow.assign(first_edge_bit.back(), false);
+    flow_without_edge.clear();
+}
+
+std::size_t DinicMaxFlow::FlowEdges::FindEdgeBit(const BisectionGraphView &view,
+                                                 const NodeID from,
+                                                 const NodeID to) const
+{
+    const auto begin = view.BeginEdges(from);
+    const auto end = view.EndEdges(from);
+    const auto edge = std::find_if(
+        begin, end, [to](const BisectionEdge &edge) { return edge.target == to; });
+    if (edge == end)
+        return INVALID_EDGE_BIT;
+    return first_edge_bit[from] + std::distance(begin, edge);
+}
+
+bool DinicMaxFlow::FlowEdges::HasFlow(const BisectionGraphView &view,
+                                      const NodeID from,
+                                      const NodeID to) const
+{
+    const auto bit = FindEdgeBit(view, from, to);
+    if (bit == INVALID_EDGE_BIT)
+        return flow_without_edge.count(std::make_pair(from, to)) != 0;
+    return edge_has_flow[bit];
+}
+
+void DinicMaxFlow::FlowEdges::Augment(const BisectionGraphView &view,
+                                      const NodeID from,
+                                      const NodeID to)
+{
+    // remove flow from reverse edges first, only add flow if no opposite flow exists
+    const auto reverse_bit = FindEdgeBit(view, to, from);
+    if (reverse_bit != INVALID_EDGE_BIT ? edge_has_flow[reverse_bit]
+                                        : flow_without_edge.count(std::make_pair(to, from)) != 0)
+    {
+        if (reverse_bit != INVALID_EDGE_BIT)
+            edge_has_flow[reverse_bit] = false;
+        else
+            flow_without_edge.erase(std::make_pair(to, from));
+        return;
+    }
+
+    const auto bit = FindEdgeBit(view, from, to);
+    if (bit != INVALID_EDGE_BIT)
+        edge_has_flow[bit] = true;
+    else
+        flow_without_edge.insert(std::make_pair(from, to));
+}
+
+std::unique_ptr<DinicMaxFlow::Workspace> DinicMaxFlow::WorkspacePool::Acquire()
+{
+    std::lock_guard<std::mutex> guard{lock};
+    if (workspaces.empty())
+        return std::make_unique<Workspace>();
+
+    auto workspace = std::move(workspaces.back());
+    workspaces.pop_back();
+    return workspace;
+}
+
+void DinicMaxFlow::WorkspacePool::Release(std::unique_ptr<Workspace> workspace)
+{
+    std::lock_guard<std::mutex> guard{lock};
+    workspaces.push_back(std::move(workspace));
+}
+
+DinicMaxFlow::MinCut DinicMaxFlow::operator()(const BisectionGraphView &view,
+                                              const SourceSinkNodes &source_nodes,
+                                              const SourceSinkNodes &sink_nodes,
+                                              const std::atomic<std::size_t> &upper_bound) const
+{
+    Workspace workspace;
+    return (*this)(view, source_nodes, sink_nodes, upper_bound, workspace);
+}
+
+DinicMaxFlow::MinCut DinicMaxFlow::operator()(const BisectionGraphView &view,
+                                              const SourceSinkNodes &source_nodes,
+                                              const SourceSinkNodes &sink_nodes,
+                                              const std::atomic<std::size_t> &upper_bound,
+                                              Workspace &workspace) const
 {
     BOOST_ASSERT(Validate(view, source_nodes, sink_nodes));
     // for the inertial flow algorithm, we use quite a large set of nodes as source/sink nodes. Only
@@ -64,12 +167,18 @@ DinicMaxFlow::MinCut DinicMaxFlow::operator()(const BisectionGraphView &view,
     // from `t` to `s`, we can remove `(s,t)` from the flow, if we send flow back the first time,
     // and insert `(t,s)` only if we send flow again.
 
-    // allocate storage for the flow
-    FlowEdges flow(view.NumberOfNodes());
+    // reuse the storage for the flow and the levels
+    auto &flow = workspace.flow;
+    auto &levels = workspace.levels;
+    flow.Reset(view);
     std::size_t flow_value = 0;
     do
     {
-        auto levels = ComputeLevelGraph(view, border_source_nodes, source_nodes, sink_nodes, flow);
+        if (view.NumberOfNodes() >= PARALLEL_LEVEL_GRAPH_MIN_NODES)
+            ComputeLevelGraphParallel(
+                view, border_source_nodes, source_nodes, sink_nodes, flow, levels);
+        else
+            ComputeLevelGraph(view, border_source_nodes, source_nodes, sink_nodes, flow, levels);
 
         // check if the sink can be reached from the source, it's enough to check the border
         const auto separated = std::find_if(border_sink_nodes.begin(),
@@ -81,6 +190,10 @@ DinicMaxFlow::MinCut DinicMaxFlow::operator()(const BisectionGraphView &view,
         if (!separated)
         {
             flow_value += BlockingFlow(flow, levels, view, source_nodes, border_sink_nodes);
+
+            // the flow only grows, so this cut can not get better than the bound anymore
+            if (flow_value > upper_bound.load(std::memory_order_relaxed))
+                return {0, flow_value, {}};
         }
         else
         {
@@ -112,14 +225,14 @@ DinicMaxFlow::MinCut DinicMaxFlow::MakeCut(const BisectionGraphView &view,
     return {source_side_count, flow_value, std::move(result)};
 }
 
-DinicMaxFlow::LevelGraph
-DinicMaxFlow::ComputeLevelGraph(const BisectionGraphView &view,
-                                const std::vector<NodeID> &border_source_nodes,
-                                const SourceSinkNodes &source_nodes,
-                                const SourceSinkNodes &sink_nodes,
-                                const FlowEdges &flow) const
+void DinicMaxFlow::ComputeLevelGraph(const BisectionGraphView &view,
+                                     const std::vector<NodeID> &border_source_nodes,
+                                     const SourceSinkNodes &source_nodes,
+                                     const SourceSinkNodes &sink_nodes,
+                                     const FlowEdges &flow,
+                                     LevelGraph &levels) const
 {
-    LevelGraph levels(view.NumberOfNodes(), INVALID_LEVEL);
+    levels.assign(view.NumberOfNodes(), INVALID_LEVEL);
     std::queue<NodeID> level_queue;
 
     // set the front of the source nodes to zero and add them to the BFS queue. In addition, set all
@@ -135,7 +248,7 @@ DinicMaxFlow::ComputeLevelGraph(const BisectionGraphView &view,
     }
     // check if there is flow present on an edge
     const auto has_flow = [&](const NodeID from, const NodeID to) {
-        return flow[from].find(to) != flow[from].end();
+        return flow.HasFlow(view, from, to);
     };
 
     // perform a relaxation step in the BFS algorithm
@@ -167,8 +280,82 @@ DinicMaxFlow::ComputeLevelGraph(const BisectionGraphView &view,
         relax_node(level_queue.front());
         level_queue.pop();
     }
+}
+
+void DinicMaxFlow::ComputeLevelGraphParallel(const BisectionGraphView &view,
+                                             const std::vector<NodeID> &border_source_nodes,
+                                             const SourceSinkNodes &source_nodes,
+                                             const SourceSinkNodes &sink_nodes,
+                                             const FlowEdges &flow,
+                                             LevelGraph &levels) const
+{
+    const auto number_of_nodes = view.NumberOfNodes();
+    std::unique_ptr<std::atomic<Level>[]> atomic_levels(new std::atomic<Level>[number_of_nodes]);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, number_of_nodes),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto node = range.begin(); node != range.end(); ++node)
+                              atomic_levels[node].store(INVALID_LEVEL, std::memory_order_relaxed);
+                      });
+
+    // same start as the sequential BFS: the border sources and their neighboring sources
+    std::vector<NodeID> frontier;
+    for (const auto node_id : border_source_nodes)
+    {
+        atomic_levels[node_id].store(0, std::memory_order_relaxed);
+        frontier.push_back(node_id);
+        for (const auto &edge : view.Edges(node_id))
+            if (source_nodes.count(edge.target))
+                atomic_levels[edge.target].store(0, std::memory_order_relaxed);
+    }
 
-    return levels;
+    // every node is claimed by the one thread that sets its level, so each node is added to
+    // exactly one of the next frontiers
+    tbb::enumerable_thread_specific<std::vector<NodeID>> next_frontiers;
+    for (Level level = 1; !frontier.empty(); ++level)
+    {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, frontier.size(), 256),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              auto &next_frontier = next_frontiers.local();
+                              for (auto index = range.begin(); index != range.end(); ++index)
+                              {
+                                  const auto node_id = frontier[index];
+                                  // don't relax sink nodes
+                                  if (sink_nodes.count(node_id))
+                                      continue;
+
+                                  for (const auto &edge : view.Edges(node_id))
+                                  {
+                                      const auto target = edge.target;
+                                      // don't relax edges with flow on them
+                                      if (flow.HasFlow(view, node_id, target))
+                                          continue;
+
+                                      auto unvisited = INVALID_LEVEL;
+                                      if (atomic_levels[target].load(std::memory_order_relaxed) ==
+                                              INVALID_LEVEL &&
+                                          atomic_levels[target].compare_exchange_strong(
+                                              unvisited, level, std::memory_order_relaxed))
+                                      {
+                                          next_frontier.push_back(target);
+                                      }
+                                  }
+                              }
+                          });
+
+        frontier.clear();
+        for (auto &next_frontier : next_frontiers)
+        {
+            frontier.insert(frontier.end(), next_frontier.begin(), next_frontier.end());
+            next_frontier.clear();
+        }
+    }
+
+    levels.resize(number_of_nodes);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, number_of_nodes),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto node = range.begin(); node != range.end(); ++node)
+                              levels[node] = atomic_levels[node].load(std::memory_order_relaxed);
+                      });
 }
 
 std::size_t DinicMaxFlow::BlockingFlow(FlowEdges &flow,
@@ -182,16 +369,11 @@ std::size_t DinicMaxFlow::BlockingFlow(FlowEdges &flow,
     std::size_t flow_increase = 0;
 
     // augment the flow along a path in the level graph
-    const auto augment_flow = [&flow](const std::vector<NodeID> &path) {
+    const auto augment_flow = [&flow, &view](const std::vector<NodeID> &path) {
 
         // add/remove flow edges from the current residual graph
-        const auto augment_one = [&flow](const NodeID from, const NodeID to) {
-            // check if there is flow in the opposite direction
-            auto existing_edge = flow[to].find(from);
-            if (existing_edge != flow[to].end())
-                flow[to].erase(existing_edge); // remove flow from reverse edges first
-            else
-                flow[from].insert(to); // only add flow if no opposite flow exists
+        const auto augment_one = [&flow, &view](const NodeID from, const NodeID to) {
+            flow.Augment(view, from, to);
 
             // do augmentation on all pairs, never stop early:
             return false;
@@ -262,7 +444,7 @@ std::vector<NodeID> DinicMaxFlow::GetAugmentingPath(LevelGraph &levels,
             dfs_stack.top().edge_iterator++;
 
             // check if the edge is valid
-            const auto has_capacity = flow[target].count(path.back()) == 0;
+            const auto has_capacity = !flow.HasFlow(view, target, path.back());
             const auto descends_level_graph = levels[target] + 1 == levels[path.back()];
 
             if (has_capacity && descends_level_graph)
@@ -4,9 +4,11 @@
 #include "partitioner/reorder_first_last.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
+#include <limits>
 #include <mutex>
 #include <set>
 #include <tuple>
@@ -93,7 +95,8 @@ makeSpatialOrder(const BisectionGraphView &view, const double ratio, const doubl
 DinicMaxFlow::MinCut bestMinCut(const BisectionGraphView &view,
                                 const std::size_t n,
                                 const double ratio,
-                                const double balance)
+                                const double balance,
+                                DinicMaxFlow::WorkspacePool &workspaces)
 {
     DinicMaxFlow::MinCut best;
     best.num_edges = -1;
@@ -112,6 +115,9 @@ DinicMaxFlow::MinCut bestMinCut(const BisectionGraphView &view,
 
     auto best_balance = 1;
 
+    // the value of the best cut so far, the flow computations of worse cuts are stopped early
+    std::atomic<std::size_t> best_value{std::numeric_limits<std::size_t>::max()};
+
     std::mutex lock;
 
     tbb::blocked_range<std::size_t> range{0, n, 1};
@@ -128,7 +134,14 @@ DinicMaxFlow::MinCut bestMinCut(const BisectionGraphView &view,
             const auto slope = -1. + round * (2. / n);
 
             auto order = makeSpatialOrder(view, ratio, slope);
-            auto cut = DinicMaxFlow()(view, order.sources, order.sinks);
+            auto workspace = workspaces.Acquire();
+            auto cut = DinicMaxFlow()(view, order.sources, order.sinks, best_value, *workspace);
+            workspaces.Release(std::move(workspace));
+
+            // the flow exceeded the best cut, the balance can only make this cut worse
+            if (cut.flags.empty())
+                continue;
+
             auto cut_balance = get_balance(cut.num_nodes_source);
 
             {
@@ -141,6 +154,7 @@ DinicMaxFlow::MinCut bestMinCut(const BisectionGraphView &view,
                 {
                     best_balance = cut_balance;
                     std::swap(best, cut);
+                    best_value.store(best.num_edges * best_balance, std::memory_order_relaxed);
                 }
             }
             // cut gets destroyed here
@@ -154,9 +168,10 @@ DinicMaxFlow::MinCut bestMinCut(const BisectionGraphView &view,
 DinicMaxFlow::MinCut computeInertialFlowCut(const BisectionGraphView &view,
                                             const std::size_t num_slopes,
                                             const double balance,
-                                            const double source_sink_rate)
+                                            const double source_sink_rate,
+                                            DinicMaxFlow::WorkspacePool &workspaces)
 {
-    return bestMinCut(view, num_slopes, source_sink_rate, balance);
+    return bestMinCut(view, num_slopes, source_sink_rate, balance, workspaces);
 }
 
 } // namespace partitioner
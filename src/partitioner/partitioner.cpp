@@ -19,6 +19,7 @@
 #include "util/json_container.hpp"
 #include "util/log.hpp"
 #include "util/mmap_file.hpp"
+#include "util/phase_report.hpp"
 
 #include <algorithm>
 #include <iterator>
@@ -27,6 +28,7 @@
 #include <boost/assert.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include <tbb/parallel_invoke.h>
 #include <tbb/task_scheduler_init.h>
 
 #include "util/geojson_debug_logger.hpp"
@@ -38,6 +40,72 @@ namespace osrm
 {
 namespace partitioner
 {
+namespace
+{
+// Logs the boundary nodes per level and the memory that the clique arcs of the cells will take,
+// which together with the cell sizes decide the query times of MLD.
+void LogCellStorageStatistics(const MultiLevelPartition &mlp, const CellStorage &storage)
+{
+    std::size_t total_bytes = 0;
+    for (const auto level : util::irange<LevelID>(1, mlp.GetNumberOfLevels()))
+    {
+        const auto number_of_cells = mlp.GetNumberOfCells(level);
+        std::size_t sources = 0, destinations = 0, max_boundary = 0, arcs = 0;
+        for (const auto cell : util::irange<CellID>(0, number_of_cells))
+        {
+            const auto boundary = storage.GetBoundarySize(level, cell);
+            sources += boundary.first;
+            destinations += boundary.second;
+            max_boundary = std::max<std::size_t>(
+                max_boundary, std::max<std::size_t>(boundary.first, boundary.second));
+            arcs += static_cast<std::size_t>(boundary.first) * boundary.second;
+        }
+
+        // every metric stores a weight and a duration per arc
+        const auto bytes = arcs * (sizeof(EdgeWeight) + sizeof(EdgeDuration));
+        total_bytes += bytes;
+        util::Log() << "  level " << level << " #cells " << number_of_cells << " source nodes "
+                    << sources << " (average " << (1. * sources / number_of_cells)
+                    << ") destination nodes " << destinations << " (average "
+                    << (1. * destinations / number_of_cells) << ") max boundary " << max_boundary
+                    << " clique arcs " << arcs << " (" << (bytes >> 20) << " MiB per metric)";
+    }
+    util::Log() << "Clique arcs of all levels take " << (total_bytes >> 20) << " MiB per metric";
+}
+
+// Renumbers the edge based nodes referenced by the files of the other tools
+void renumberFiles(const PartitionerConfig &config,
+                   std::vector<extractor::NBGToEBG> &mapping,
+                   const std::vector<std::uint32_t> &permutation)
+{
+    {
+        renumber(mapping, permutation);
+        extractor::files::writeNBGMapping(config.GetPath(".osrm.cnbg_to_ebg").string(), mapping);
+    }
+    {
+        boost::iostreams::mapped_file segment_region;
+        auto segments = util::mmapFile<extractor::EdgeBasedNodeSegment>(
+            config.GetPath(".osrm.fileIndex"), segment_region);
+        renumber(segments, permutation);
+    }
+    {
+        extractor::EdgeBasedNodeDataContainer node_data;
+        extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
+        renumber(node_data, permutation);
+        extractor::files::writeNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
+    }
+    {
+        const auto &filename = config.GetPath(".osrm.maneuver_overrides");
+        std::vector<extractor::StorageManeuverOverride> maneuver_overrides;
+        std::vector<NodeID> node_sequences;
+        extractor::files::readManeuverOverrides(filename, maneuver_overrides, node_sequences);
+        renumber(maneuver_overrides, permutation);
+        renumber(node_sequences, permutation);
+        extractor::files::writeManeuverOverrides(filename, maneuver_overrides, node_sequences);
+    }
+}
+}
+
 auto getGraphBisection(const PartitionerConfig &config)
 {
     std::vector<extractor::CompressedNodeBasedGraphEdge> edges;
@@ -72,7 +140,9 @@ int Partitioner::Run(const PartitionerConfig &config)
     tbb::task_scheduler_init init(config.requested_num_threads);
     BOOST_ASSERT(init.is_active());
 
+    util::ReportPhase bisection_phase("bisection");
     const std::vector<BisectionID> &node_based_partition_ids = getGraphBisection(config);
+    bisection_phase.Stop();
 
     // Up until now we worked on the compressed node based graph.
     // But what we actually need is a partition for the edge based graph to work on.
@@ -80,6 +150,7 @@ int Partitioner::Run(const PartitionerConfig &config)
     // Then loads the edge based graph tanslates the partition and modifies it.
     // For details see #3205
 
+    util::ReportPhase annotation_phase("annotation");
     std::vector<extractor::NBGToEBG> mapping;
     extractor::files::readNBGMapping(config.GetPath(".osrm.cnbg_to_ebg").string(), mapping);
     util::Log() << "Loaded node based graph to edge based graph mapping";
@@ -120,47 +191,40 @@ int Partitioner::Run(const PartitionerConfig &config)
     for (std::size_t level = 0; level < level_to_num_cells.size(); ++level)
     {
         util::Log() << "  level " << level + 1 << " #cells " << level_to_num_cells[level]
-                    << " bit size " << std::ceil(std::log2(level_to_num_cells[level] + 1));
+                    << " bit size " << MultiLevelPartition::GetLevelBits(level_to_num_cells[level]);
     }
 
-    TIMER_START(renumber);
-    auto permutation = makePermutation(edge_based_graph, partitions);
-    renumber(edge_based_graph, permutation);
-    renumber(partitions, permutation);
-    {
-        renumber(mapping, permutation);
-        extractor::files::writeNBGMapping(config.GetPath(".osrm.cnbg_to_ebg").string(), mapping);
-    }
-    {
-        boost::iostreams::mapped_file segment_region;
-        auto segments = util::mmapFile<extractor::EdgeBasedNodeSegment>(
-            config.GetPath(".osrm.fileIndex"), segment_region);
-        renumber(segments, permutation);
-    }
-    {
-        extractor::EdgeBasedNodeDataContainer node_data;
-        extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
-        renumber(node_data, permutation);
-        extractor::files::writeNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
-    }
+    // checked before the files are renumbered, they can't be partitioned again otherwise
+    const auto partition_bits = MultiLevelPartition::GetPartitionBits(level_to_num_cells);
+    if (partition_bits > MultiLevelPartition::NUM_PARTITION_BITS)
     {
-        const auto &filename = config.GetPath(".osrm.maneuver_overrides");
-        std::vector<extractor::StorageManeuverOverride> maneuver_overrides;
-        std::vector<NodeID> node_sequences;
-        extractor::files::readManeuverOverrides(filename, maneuver_overrides, node_sequences);
-        renumber(maneuver_overrides, permutation);
-        renumber(node_sequences, permutation);
-        extractor::files::writeManeuverOverrides(filename, maneuver_overrides, node_sequences);
+        util::Log(logERROR) << "The cell ids of all levels need " << partition_bits << " bits, but "
+                            << "only " << static_cast<int>(MultiLevelPartition::NUM_PARTITION_BITS)
+                            << " are available. Use fewer levels or larger cells with "
+                            << "--max-cell-sizes.";
+        return 1;
     }
+
+    annotation_phase.Stop();
+
+    TIMER_START(renumber);
+    util::ReportPhase renumber_phase("renumber");
+    auto permutation = makePermutation(edge_based_graph, partitions);
+    // the edges of the graph are permuted in place on one thread, which overlaps with the rest
+    tbb::parallel_invoke([&] { renumber(edge_based_graph, permutation); },
+                         [&] { renumber(partitions, permutation); },
+                         [&] { renumberFiles(config, mapping, permutation); });
     if (boost::filesystem::exists(config.GetPath(".osrm.hsgr")))
     {
         util::Log(logWARNING) << "Found existing .osrm.hsgr file, removing. You need to re-run "
                                  "osrm-contract after osrm-partition.";
         boost::filesystem::remove(config.GetPath(".osrm.hsgr"));
     }
+    renumber_phase.Stop();
     TIMER_STOP(renumber);
     util::Log() << "Renumbered data in " << TIMER_SEC(renumber) << " seconds";
 
+    util::ReportPhase cell_storage_phase("cell_storage");
     TIMER_START(packed_mlp);
     MultiLevelPartition mlp{partitions, level_to_num_cells};
     TIMER_STOP(packed_mlp);
@@ -169,15 +233,19 @@ int Partitioner::Run(const PartitionerConfig &config)
     TIMER_START(cell_storage);
     CellStorage storage(mlp, edge_based_graph);
     TIMER_STOP(cell_storage);
+    cell_storage_phase.Stop();
     util::Log() << "CellStorage constructed in " << TIMER_SEC(cell_storage) << " seconds";
+    LogCellStorageStatistics(mlp, storage);
 
     TIMER_START(writing_mld_data);
+    util::ReportPhase writing_phase("writing");
     files::writePartition(config.GetPath(".osrm.partition"), mlp);
     files::writeCells(config.GetPath(".osrm.cells"), storage);
     extractor::files::writeEdgeBasedGraph(config.GetPath(".osrm.ebg"),
                                           edge_based_graph.GetNumberOfNodes(),
                                           graphToEdges(edge_based_graph),
                                           edge_based_graph.connectivity_checksum);
+    writing_phase.Stop();
     TIMER_STOP(writing_mld_data);
     util::Log() << "MLD data writing took " << TIMER_SEC(writing_mld_data) << " seconds";
 
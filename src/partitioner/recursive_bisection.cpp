@@ -66,12 +66,15 @@ RecursiveBisection::RecursiveBisection(BisectionGraph &bisection_graph_,
 
     using Feeder = tbb::parallel_do_feeder<TreeNode>;
 
+    // the buffers of the flow computations are reused by all cuts
+    DinicMaxFlow::WorkspacePool workspaces;
+
     TIMER_START(bisection);
 
     // Bisect graph into two parts. Get partition point and recurse left and right in parallel.
     tbb::parallel_do(begin(forest), end(forest), [&](const TreeNode &node, Feeder &feeder) {
-        const auto cut =
-            computeInertialFlowCut(node.graph, num_optimizing_cuts, balance, boundary_factor);
+        const auto cut = computeInertialFlowCut(
+            node.graph, num_optimizing_cuts, balance, boundary_factor, workspaces);
         const auto center = internal_state.ApplyBisection(
             node.graph.Begin(), node.graph.End(), node.depth, cut.flags);
 
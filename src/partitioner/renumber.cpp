@@ -2,6 +2,14 @@
 
 #include "util/permutation.hpp"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <atomic>
+#include <numeric>
+#include <vector>
+
 namespace osrm
 {
 namespace partitioner
@@ -12,29 +20,51 @@ namespace
 std::vector<LevelID> getHighestBorderLevel(const DynamicEdgeBasedGraph &graph,
                                            const std::vector<Partition> &partitions)
 {
-    std::vector<LevelID> border_level(graph.GetNumberOfNodes(), 0);
+    const auto number_of_nodes = graph.GetNumberOfNodes();
+    std::vector<std::atomic<LevelID>> border_level(number_of_nodes);
 
-    for (const auto level : util::irange<LevelID>(1, partitions.size() + 1))
-    {
-        const auto &partition = partitions[level - 1];
-        for (auto node : util::irange<NodeID>(0, graph.GetNumberOfNodes()))
+    // the highest level on which the nodes of an edge are in different cells
+    const auto edge_level = [&partitions](const NodeID node, const NodeID target) {
+        for (LevelID level = partitions.size(); level > 0; --level)
+        {
+            const auto &partition = partitions[level - 1];
+            if (partition[node] != partition[target])
+                return level;
+        }
+        return LevelID{0};
+    };
+    // targets of other nodes can be raised concurrently, few edges cross cells
+    const auto raise_level = [&border_level](const NodeID node, const LevelID level) {
+        auto current = border_level[node].load(std::memory_order_relaxed);
+        while (current < level &&
+               !border_level[node].compare_exchange_weak(current, level, std::memory_order_relaxed))
         {
-            for (auto edge : graph.GetAdjacentEdgeRange(node))
-            {
-                auto target = graph.GetTarget(edge);
-                if (partition[node] != partition[target])
-                {
-                    // level is monotone increasing so we wil
-                    // always overwrite here with a value equal
-                    // or greater then the current border_level
-                    border_level[node] = level;
-                    border_level[target] = level;
-                }
-            }
         }
-    }
+    };
 
-    return border_level;
+    tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                      [&](const tbb::blocked_range<NodeID> &range) {
+                          for (auto node = range.begin(); node != range.end(); ++node)
+                              border_level[node].store(0, std::memory_order_relaxed);
+                      });
+    tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                      [&](const tbb::blocked_range<NodeID> &range) {
+                          for (auto node = range.begin(); node != range.end(); ++node)
+                          {
+                              for (auto edge : graph.GetAdjacentEdgeRange(node))
+                              {
+                                  const auto target = graph.GetTarget(edge);
+                                  const auto level = edge_level(node, target);
+                                  if (level > 0)
+                                  {
+                                      raise_level(node, level);
+                                      raise_level(target, level);
+                                  }
+                              }
+                          }
+                      });
+
+    return std::vector<LevelID>(border_level.begin(), border_level.end());
 }
 }
 
@@ -44,25 +74,25 @@ std::vector<std::uint32_t> makePermutation(const DynamicEdgeBasedGraph &graph,
     std::vector<std::uint32_t> ordering(graph.GetNumberOfNodes());
     std::iota(ordering.begin(), ordering.end(), 0);
 
-    // Sort the nodes by cell ID recursively:
-    // Nodes in the same cell will be sorted by cell ID on the level below
-    for (const auto &partition : partitions)
-    {
-        std::stable_sort(
-            ordering.begin(), ordering.end(), [&partition](const auto lhs, const auto rhs) {
-                return partition[lhs] < partition[rhs];
-            });
-    }
-
-    // Now sort the nodes by the level at which they are a border node, descening.
+    // Sort the nodes by the level at which they are a border node, descening.
     // That means nodes that are border nodes on the highest level will have a very low ID,
     // whereas nodes that are nerver border nodes are sorted to the end of the array.
-    // Note: Since we use a stable sort that preserves the cell sorting within each level
-    auto border_level = getHighestBorderLevel(graph, partitions);
-    std::stable_sort(
-        ordering.begin(), ordering.end(), [&border_level](const auto lhs, const auto rhs) {
+    // Nodes of the same border level are sorted by cell ID recursively: nodes in the same cell
+    // are sorted by cell ID on the level below and finally by their ID. This is the order of
+    // stable sorts by the cells of each level and the border level, but sorts only once.
+    const auto border_level = getHighestBorderLevel(graph, partitions);
+    const auto by_border_level_and_cells = [&border_level, &partitions](const auto lhs,
+                                                                        const auto rhs) {
+        if (border_level[lhs] != border_level[rhs])
             return border_level[lhs] > border_level[rhs];
-        });
+        for (auto partition = partitions.rbegin(); partition != partitions.rend(); ++partition)
+        {
+            if ((*partition)[lhs] != (*partition)[rhs])
+                return (*partition)[lhs] < (*partition)[rhs];
+        }
+        return lhs < rhs;
+    };
+    tbb::parallel_sort(ordering.begin(), ordering.end(), by_border_level_and_cells);
 
     return util::orderingToPermutation(ordering);
 }
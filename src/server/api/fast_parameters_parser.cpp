@@ -0,0 +1,567 @@
+#include "server/api/fast_parameters_parser.hpp"
+
+#include "engine/approach.hpp"
+#include "engine/bearing.hpp"
+#include "engine/hint.hpp"
+
+#include "util/coordinate.hpp"
+
+#include <boost/numeric/conversion/cast.hpp>
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+namespace
+{
+// Numbers with more digits could be rounded differently than by the grammars, they parse them
+const constexpr int MAX_NUMBER_DIGITS = 15;
+// Exact powers of ten, the grammars scale the digits of fractions by the same values
+const constexpr double POWERS_OF_TEN[MAX_NUMBER_DIGITS + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+inline bool isDigit(const char character) { return character >= '0' && character <= '9'; }
+
+inline bool isAlpha(const char character)
+{
+    return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z');
+}
+
+inline bool isAlphaNumeral(const char character)
+{
+    return isAlpha(character) || isDigit(character);
+}
+
+// A cursor over the query, all parse functions leave it unchanged if they return false
+class QueryScanner
+{
+  public:
+    QueryScanner(const char *first, const char *last) : current(first), last(last) {}
+
+    bool AtEnd() const { return current == last; }
+
+    // Options are separated by '&'
+    bool AtOptionEnd() const { return current == last || *current == '&'; }
+
+    // Elements of the list of an option are separated by the delimiter, they can be empty
+    bool AtElementEnd(const char delimiter) const { return AtOptionEnd() || *current == delimiter; }
+
+    // Number of elements of the list in front of the cursor, to reserve room for them
+    std::size_t CountElements(const char delimiter, const char terminator) const
+    {
+        return std::count(current, std::find(current, last, terminator), delimiter) + 1;
+    }
+
+    bool Accept(const char character)
+    {
+        if (current == last || *current != character)
+            return false;
+        ++current;
+        return true;
+    }
+
+    template <std::size_t N> bool Accept(const char (&literal)[N])
+    {
+        const std::size_t length = N - 1;
+        if (static_cast<std::size_t>(last - current) < length ||
+            std::memcmp(current, literal, length) != 0)
+            return false;
+        current += length;
+        return true;
+    }
+
+    bool ParseBool(bool &value)
+    {
+        if (Accept("true"))
+            value = true;
+        else if (Accept("false"))
+            value = false;
+        else
+            return false;
+        return true;
+    }
+
+    // Like the unsigned parsers of the grammars no sign is accepted and overflows fail
+    template <typename T> bool ParseUnsigned(T &value)
+    {
+        const auto first = current;
+        T number = 0;
+        for (; current != last && isDigit(*current); ++current)
+        {
+            const T digit = *current - '0';
+            if (number > (std::numeric_limits<T>::max() - digit) / 10)
+            {
+                current = first;
+                return false;
+            }
+            number = number * 10 + digit;
+        }
+        if (current == first)
+            return false;
+        value = number;
+        return true;
+    }
+
+    bool ParseShort(short &value)
+    {
+        const auto first = current;
+        const auto negative = Accept('-');
+        if (!negative)
+            Accept('+');
+
+        unsigned number;
+        const unsigned maximum = std::numeric_limits<short>::max() + (negative ? 1 : 0);
+        if (!ParseUnsigned(number) || number > maximum)
+        {
+            current = first;
+            return false;
+        }
+        value = static_cast<short>(negative ? -static_cast<int>(number) : number);
+        return true;
+    }
+
+    // Accumulates the digits and scales them by the fraction like the real parsers of the grammars
+    // do. Exponents, nan and inf are left to them. With format_dot a dot followed by a letter
+    // starts the format extension like .json instead of the fraction.
+    bool ParseDouble(double &value, const bool format_dot)
+    {
+        const auto first = current;
+        const auto negative = Accept('-');
+        if (!negative)
+            Accept('+');
+
+        double number = 0;
+        int digits = 0;
+        for (; current != last && isDigit(*current); ++current, ++digits)
+            number = number * 10 + (*current - '0');
+
+        int fraction_digits = 0;
+        if (current != last && *current == '.' &&
+            !(format_dot && current + 1 != last && isAlpha(*(current + 1))))
+        {
+            ++current;
+            for (; current != last && isDigit(*current); ++current, ++fraction_digits)
+                number = number * 10 + (*current - '0');
+        }
+
+        if (digits + fraction_digits == 0 || digits + fraction_digits > MAX_NUMBER_DIGITS)
+        {
+            current = first;
+            return false;
+        }
+
+        number /= POWERS_OF_TEN[fraction_digits];
+        value = negative ? -number : number;
+        return true;
+    }
+
+    template <typename Predicate> bool ParseWord(std::string &value, Predicate predicate)
+    {
+        const auto first = current;
+        current = std::find_if_not(current, last, predicate);
+        value.assign(first, current);
+        return current != first;
+    }
+
+    // H:MM or HH:MM into the minute of the day
+    bool ParseTimeOfDay(std::uint32_t &value)
+    {
+        const auto first = current;
+        unsigned hour, minute;
+        if (!ParseUnsigned(hour) || current - first > 2 || hour > 23 || !Accept(':'))
+        {
+            current = first;
+            return false;
+        }
+        const auto minute_first = current;
+        if (!ParseUnsigned(minute) || current - minute_first != 2 || minute > 59)
+        {
+            current = first;
+            return false;
+        }
+        value = hour * 60 + minute;
+        return true;
+    }
+
+    boost::optional<engine::Hint> ParseHint()
+    {
+        if (static_cast<std::size_t>(last - current) < engine::ENCODED_HINT_SIZE)
+            return boost::none;
+
+        auto hint = engine::Hint::FromBase64(current, current + engine::ENCODED_HINT_SIZE);
+        if (hint)
+            current += engine::ENCODED_HINT_SIZE;
+        return hint;
+    }
+
+  private:
+    const char *current;
+    const char *const last;
+};
+
+// Parses the elements of a list up to the end of the option
+template <typename ElementParser>
+bool parseList(QueryScanner &scanner, const char delimiter, ElementParser parse_element)
+{
+    do
+    {
+        if (!parse_element())
+            return false;
+    } while (scanner.Accept(delimiter));
+    return scanner.AtOptionEnd();
+}
+
+bool parseCoordinates(QueryScanner &scanner, std::vector<util::Coordinate> &coordinates)
+{
+    coordinates.reserve(scanner.CountElements(';', '?'));
+    do
+    {
+        double longitude, latitude;
+        if (!scanner.ParseDouble(longitude, true) || !scanner.Accept(',') ||
+            !scanner.ParseDouble(latitude, true))
+            return false;
+
+        coordinates.emplace_back(util::toFixed(util::UnsafeFloatLongitude{longitude}),
+                                 util::toFixed(util::UnsafeFloatLatitude{latitude}));
+    } while (scanner.Accept(';'));
+    return true;
+}
+
+bool parseFormat(QueryScanner &scanner, engine::api::BaseParameters &parameters)
+{
+    if (!scanner.Accept('.'))
+        return true;
+
+    if (scanner.Accept("json"))
+        parameters.format = engine::api::BaseParameters::OutputFormatType::JSON;
+    else if (scanner.Accept("bin"))
+        parameters.format = engine::api::BaseParameters::OutputFormatType::Binary;
+    else
+        return false;
+    return true;
+}
+
+bool parseBaseOption(QueryScanner &scanner, engine::api::BaseParameters &parameters)
+{
+    if (scanner.Accept("radiuses="))
+    {
+        parameters.radiuses.clear();
+        parameters.radiuses.reserve(scanner.CountElements(';', '&'));
+        return parseList(scanner, ';', [&] {
+            double radius;
+            if (scanner.AtElementEnd(';'))
+                parameters.radiuses.push_back(boost::none);
+            else if (scanner.Accept("unlimited"))
+                parameters.radiuses.push_back(std::numeric_limits<double>::infinity());
+            else if (scanner.ParseDouble(radius, false))
+                parameters.radiuses.push_back(radius);
+            else
+                return false;
+            return true;
+        });
+    }
+
+    // hints and bearings repeated across options are appended
+    if (scanner.Accept("hints="))
+    {
+        parameters.hints.reserve(parameters.hints.size() + scanner.CountElements(';', '&'));
+        return parseList(scanner, ';', [&] {
+            if (scanner.AtElementEnd(';'))
+            {
+                parameters.hints.push_back(boost::none);
+                return true;
+            }
+            auto hint = scanner.ParseHint();
+            parameters.hints.push_back(std::move(hint));
+            return static_cast<bool>(parameters.hints.back());
+        });
+    }
+
+    if (scanner.Accept("bearings="))
+    {
+        parameters.bearings.reserve(parameters.bearings.size() + scanner.CountElements(';', '&'));
+        return parseList(scanner, ';', [&] {
+            short bearing, range;
+            if (scanner.AtElementEnd(';'))
+                parameters.bearings.push_back(boost::none);
+            else if (scanner.ParseShort(bearing) && scanner.Accept(',') &&
+                     scanner.ParseShort(range))
+                parameters.bearings.push_back(engine::Bearing{bearing, range});
+            else
+                return false;
+            return true;
+        });
+    }
+
+    if (scanner.Accept("generate_hints="))
+    {
+        return scanner.ParseBool(parameters.generate_hints);
+    }
+
+    if (scanner.Accept("approaches="))
+    {
+        parameters.approaches.clear();
+        parameters.approaches.reserve(scanner.CountElements(';', '&'));
+        return parseList(scanner, ';', [&] {
+            if (scanner.AtElementEnd(';'))
+                parameters.approaches.push_back(boost::none);
+            else if (scanner.Accept("unrestricted"))
+                parameters.approaches.push_back(engine::Approach::UNRESTRICTED);
+            else if (scanner.Accept("curb"))
+                parameters.approaches.push_back(engine::Approach::CURB);
+            else
+                return false;
+            return true;
+        });
+    }
+
+    if (scanner.Accept("exclude="))
+    {
+        parameters.exclude.clear();
+        return parseList(scanner, ',', [&] {
+            parameters.exclude.emplace_back();
+            return scanner.ParseWord(parameters.exclude.back(), isAlphaNumeral);
+        });
+    }
+
+    if (scanner.Accept("metric="))
+    {
+        return scanner.ParseWord(parameters.metric, [](const char character) {
+            return isAlphaNumeral(character) || character == '_';
+        });
+    }
+
+    if (scanner.Accept("depart_at="))
+    {
+        std::uint32_t minute;
+        if (!scanner.ParseTimeOfDay(minute))
+            return false;
+        parameters.depart_at = minute;
+        return true;
+    }
+
+    return false;
+}
+
+bool parseRouteOption(QueryScanner &scanner, engine::api::RouteParameters &parameters)
+{
+    using AnnotationsType = engine::api::RouteParameters::AnnotationsType;
+    using GeometriesType = engine::api::RouteParameters::GeometriesType;
+    using OverviewType = engine::api::RouteParameters::OverviewType;
+
+    if (scanner.Accept("alternatives="))
+    {
+        unsigned number_of_alternatives;
+        bool alternatives;
+        if (scanner.ParseUnsigned(number_of_alternatives))
+        {
+            parameters.number_of_alternatives = number_of_alternatives;
+            parameters.alternatives = number_of_alternatives > 0;
+        }
+        else if (scanner.ParseBool(alternatives))
+        {
+            parameters.number_of_alternatives = alternatives;
+            parameters.alternatives = alternatives;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    if (scanner.Accept("continue_straight="))
+    {
+        bool continue_straight;
+        if (scanner.Accept("default"))
+            return true;
+        if (!scanner.ParseBool(continue_straight))
+            return false;
+        parameters.continue_straight = continue_straight;
+        return true;
+    }
+
+    if (scanner.Accept("steps="))
+    {
+        return scanner.ParseBool(parameters.steps);
+    }
+
+    if (scanner.Accept("geometries="))
+    {
+        if (scanner.Accept("geojson"))
+            parameters.geometries = GeometriesType::GeoJSON;
+        else if (scanner.Accept("polyline6"))
+            parameters.geometries = GeometriesType::Polyline6;
+        else if (scanner.Accept("polyline"))
+            parameters.geometries = GeometriesType::Polyline;
+        else
+            return false;
+        return true;
+    }
+
+    if (scanner.Accept("overview="))
+    {
+        if (scanner.Accept("simplified"))
+            parameters.overview = OverviewType::Simplified;
+        else if (scanner.Accept("full"))
+            parameters.overview = OverviewType::Full;
+        else if (scanner.Accept("false"))
+            parameters.overview = OverviewType::False;
+        else
+            return false;
+        return true;
+    }
+
+    if (scanner.Accept("annotations="))
+    {
+        const auto add_annotation = [&parameters](const AnnotationsType annotation) {
+            parameters.annotations_type = parameters.annotations_type | annotation;
+            parameters.annotations = parameters.annotations_type != AnnotationsType::None;
+        };
+
+        if (scanner.Accept("true"))
+        {
+            add_annotation(AnnotationsType::All);
+            return true;
+        }
+        if (scanner.Accept("false"))
+        {
+            add_annotation(AnnotationsType::None);
+            return true;
+        }
+        return parseList(scanner, ',', [&] {
+            if (scanner.Accept("duration"))
+                add_annotation(AnnotationsType::Duration);
+            else if (scanner.Accept("nodes"))
+                add_annotation(AnnotationsType::Nodes);
+            else if (scanner.Accept("distance"))
+                add_annotation(AnnotationsType::Distance);
+            else if (scanner.Accept("weight"))
+                add_annotation(AnnotationsType::Weight);
+            else if (scanner.Accept("datasources"))
+                add_annotation(AnnotationsType::Datasources);
+            else if (scanner.Accept("speed"))
+                add_annotation(AnnotationsType::Speed);
+            else
+                return false;
+            return true;
+        });
+    }
+
+    return parseBaseOption(scanner, parameters);
+}
+
+bool parseTableOption(QueryScanner &scanner, engine::api::TableParameters &parameters)
+{
+    const auto parse_indices = [&scanner](std::vector<std::size_t> &indices) {
+        // all keeps the indices of earlier options like the grammar does
+        if (scanner.Accept("all"))
+            return true;
+
+        indices.clear();
+        indices.reserve(scanner.CountElements(';', '&'));
+        return parseList(scanner, ';', [&] {
+            std::size_t index;
+            if (!scanner.ParseUnsigned(index))
+                return false;
+            indices.push_back(index);
+            return true;
+        });
+    };
+
+    if (scanner.Accept("sources="))
+    {
+        return parse_indices(parameters.sources);
+    }
+
+    if (scanner.Accept("destinations="))
+    {
+        return parse_indices(parameters.destinations);
+    }
+
+    if (scanner.Accept("annotations="))
+    {
+        using AnnotationsType = engine::api::TableParameters::AnnotationsType;
+
+        // the listed annotations replace the default durations
+        parameters.annotations = AnnotationsType::None;
+        return parseList(scanner, ',', [&] {
+            if (scanner.Accept("duration"))
+                parameters.annotations = parameters.annotations | AnnotationsType::Duration;
+            else if (scanner.Accept("distance"))
+                parameters.annotations = parameters.annotations | AnnotationsType::Distance;
+            else
+                return false;
+            return true;
+        });
+    }
+
+    if (scanner.Accept("approximate="))
+    {
+        return scanner.ParseBool(parameters.approximate);
+    }
+
+    return parseBaseOption(scanner, parameters);
+}
+
+// coordinates[.format][?option&option...]
+template <typename ParameterT, typename OptionParser>
+bool parseQuery(const char *first,
+                const char *last,
+                ParameterT &parameters,
+                OptionParser parse_option)
+{
+    QueryScanner scanner(first, last);
+    try
+    {
+        if (!parseCoordinates(scanner, parameters.coordinates) || !parseFormat(scanner, parameters))
+            return false;
+
+        if (scanner.Accept('?'))
+        {
+            do
+            {
+                if (!parse_option(scanner, parameters) || !scanner.AtOptionEnd())
+                    return false;
+            } while (scanner.Accept('&'));
+        }
+    }
+    catch (const boost::numeric::bad_numeric_cast &)
+    {
+        // coordinates out of range, the grammar rejects them as well
+        return false;
+    }
+
+    return scanner.AtEnd();
+}
+} // anon.
+
+bool parseRouteParameters(const char *first,
+                          const char *last,
+                          engine::api::RouteParameters &parameters)
+{
+    return parseQuery(first, last, parameters, parseRouteOption);
+}
+
+bool parseTableParameters(const char *first,
+                          const char *last,
+                          engine::api::TableParameters &parameters)
+{
+    return parseQuery(first, last, parameters, parseTableOption);
+}
+
+} // ns api
+} // ns server
+} // ns osrm
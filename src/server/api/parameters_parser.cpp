@@ -1,5 +1,8 @@
 #include "server/api/parameters_parser.hpp"
 
+#include "server/api/batch_parameters_grammar.hpp"
+#include "server/api/fast_parameters_parser.hpp"
+#include "server/api/isochrone_parameters_grammar.hpp"
 #include "server/api/match_parameter_grammar.hpp"
 #include "server/api/nearest_parameter_grammar.hpp"
 #include "server/api/route_parameters_grammar.hpp"
@@ -26,7 +29,9 @@ using is_grammar_t =
                                std::is_same<NearestParametersGrammar<>, T>::value ||
                                std::is_same<TripParametersGrammar<>, T>::value ||
                                std::is_same<MatchParametersGrammar<>, T>::value ||
-                               std::is_same<TileParametersGrammar<>, T>::value>;
+                               std::is_same<TileParametersGrammar<>, T>::value ||
+                               std::is_same<BatchParametersGrammar<>, T>::value ||
+                               std::is_same<IsochroneParametersGrammar<>, T>::value>;
 
 template <typename ParameterT,
           typename GrammarT,
@@ -63,22 +68,43 @@ boost::optional<ParameterT> parseParameters(std::string::iterator &iter,
 
     return boost::none;
 }
+
+// The hand-written parsers read well-formed queries of the services with many coordinates, the
+// grammars parse everything else and find the position of errors.
+template <typename ParameterT, typename GrammarT, typename FastParserT>
+boost::optional<ParameterT> parseParameters(std::string::iterator &iter,
+                                            const std::string::iterator end,
+                                            FastParserT fast_parser)
+{
+    if (iter != end)
+    {
+        ParameterT parameters;
+        const auto first = &*iter;
+        if (fast_parser(first, first + std::distance(iter, end), parameters))
+        {
+            iter = end;
+            return std::move(parameters);
+        }
+    }
+
+    return parseParameters<ParameterT, GrammarT>(iter, end);
+}
 } // ns detail
 
 template <>
 boost::optional<engine::api::RouteParameters> parseParameters(std::string::iterator &iter,
                                                               const std::string::iterator end)
 {
-    return detail::parseParameters<engine::api::RouteParameters, RouteParametersGrammar<>>(iter,
-                                                                                           end);
+    return detail::parseParameters<engine::api::RouteParameters, RouteParametersGrammar<>>(
+        iter, end, parseRouteParameters);
 }
 
 template <>
 boost::optional<engine::api::TableParameters> parseParameters(std::string::iterator &iter,
                                                               const std::string::iterator end)
 {
-    return detail::parseParameters<engine::api::TableParameters, TableParametersGrammar<>>(iter,
-                                                                                           end);
+    return detail::parseParameters<engine::api::TableParameters, TableParametersGrammar<>>(
+        iter, end, parseTableParameters);
 }
 
 template <>
@@ -111,6 +137,22 @@ boost::optional<engine::api::TileParameters> parseParameters(std::string::iterat
     return detail::parseParameters<engine::api::TileParameters, TileParametersGrammar<>>(iter, end);
 }
 
+template <>
+boost::optional<engine::api::BatchParameters> parseParameters(std::string::iterator &iter,
+                                                              const std::string::iterator end)
+{
+    return detail::parseParameters<engine::api::BatchParameters, BatchParametersGrammar<>>(iter,
+                                                                                           end);
+}
+
+template <>
+boost::optional<engine::api::IsochroneParameters> parseParameters(std::string::iterator &iter,
+                                                                  const std::string::iterator end)
+{
+    return detail::parseParameters<engine::api::IsochroneParameters,
+                                   IsochroneParametersGrammar<>>(iter, end);
+}
+
 } // ns api
 } // ns server
 } // ns osrm
@@ -6,6 +6,9 @@
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/repository/include/qi_iter_pos.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
 #include <string>
 #include <type_traits>
 
@@ -60,6 +63,102 @@ struct URLParser final : qi::grammar<Iterator, Into>
     qi::rule<Iterator, char()> percent_encoding;
 };
 
+constexpr bool isAlphaNumeral(const char character)
+{
+    return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') ||
+           (character >= '0' && character <= '9');
+}
+
+// The characters of all_chars in the grammar above besides percent encodings
+struct QueryChars
+{
+    constexpr QueryChars() : values()
+    {
+        for (int character = 0; character < 256; ++character)
+            values[character] = isAlphaNumeral(static_cast<char>(character));
+        for (const auto character : "-?@[\\]^_`{|}~&(),.:;=")
+            values[static_cast<unsigned char>(character)] = character != '\0';
+    }
+
+    bool values[256];
+};
+constexpr QueryChars QUERY_CHARS{};
+
+inline bool isQueryChar(const char character)
+{
+    return QUERY_CHARS.values[static_cast<unsigned char>(character)];
+}
+
+inline int hexValue(const char character)
+{
+    if (character >= '0' && character <= '9')
+        return character - '0';
+    if (character >= 'a' && character <= 'f')
+        return character - 'a' + 10;
+    if (character >= 'A' && character <= 'F')
+        return character - 'A' + 10;
+    return -1;
+}
+
+// Splits a well-formed url in a single pass, returns false for everything the grammar rejects
+template <typename Iterator>
+bool splitURL(const Iterator first, const Iterator last, osrm::server::api::ParsedURL &out)
+{
+    auto iter = first;
+    const auto accept = [&](const char character) {
+        if (iter == last || *iter != character)
+            return false;
+        ++iter;
+        return true;
+    };
+    const auto parse_alpha_numerals = [&](std::string &value) {
+        const auto begin = iter;
+        iter = std::find_if_not(iter, last, isAlphaNumeral);
+        value.assign(begin, iter);
+        return begin != iter;
+    };
+    const auto parse_version = [&](unsigned &value) {
+        const auto begin = iter;
+        value = 0;
+        for (; iter != last && *iter >= '0' && *iter <= '9'; ++iter)
+        {
+            const unsigned digit = *iter - '0';
+            if (value > (std::numeric_limits<unsigned>::max() - digit) / 10)
+                return false;
+            value = value * 10 + digit;
+        }
+        return begin != iter;
+    };
+
+    if (!accept('/') || !parse_alpha_numerals(out.service) || !accept('/') || !accept('v') ||
+        !parse_version(out.version) || !accept('/') || !parse_alpha_numerals(out.profile) ||
+        !accept('/') || iter == last)
+        return false;
+
+    out.prefix_length = std::distance(first, iter);
+    out.query.clear();
+    out.query.reserve(std::distance(iter, last));
+    while (iter != last)
+    {
+        const auto plain_end = std::find_if_not(iter, last, isQueryChar);
+        out.query.append(iter, plain_end);
+        iter = plain_end;
+
+        if (iter != last)
+        {
+            if (*iter != '%' || std::distance(iter, last) < 3)
+                return false;
+            const auto high = hexValue(*(iter + 1));
+            const auto low = hexValue(*(iter + 2));
+            if (high < 0 || low < 0)
+                return false;
+            out.query.push_back(static_cast<char>(high * 16 + low));
+            iter += 3;
+        }
+    }
+    return true;
+}
+
 } // anon.
 
 namespace osrm
@@ -73,9 +172,18 @@ boost::optional<ParsedURL> parseURL(std::string::iterator &iter, const std::stri
 {
     using It = std::decay<decltype(iter)>::type;
 
-    static URLParser<It, ParsedURL(It)> const parser;
     ParsedURL out;
 
+    // The grammar only runs to find the position of errors in malformed urls
+    if (splitURL(iter, end, out))
+    {
+        iter = end;
+        return boost::make_optional(std::move(out));
+    }
+
+    static URLParser<It, ParsedURL(It)> const parser;
+    out = ParsedURL{};
+
     try
     {
         const auto ok = boost::spirit::qi::parse(iter, end, parser(boost::phoenix::val(iter)), out);
@@ -1,13 +1,22 @@
 #include "server/connection.hpp"
+#include "server/http2/session.hpp"
+#include "server/http2_connection.hpp"
 #include "server/request_handler.hpp"
 #include "server/request_parser.hpp"
 
+#include "util/json_renderer.hpp"
+#include "util/log.hpp"
+#include "util/request_trace.hpp"
+
 #include <boost/assert.hpp>
 #include <boost/bind.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <iterator>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -16,17 +25,94 @@ namespace osrm
 namespace server
 {
 
-Connection::Connection(boost::asio::io_service &io_service, RequestHandler &handler)
-    : strand(io_service), TCP_socket(io_service), request_handler(handler)
+namespace
+{
+// Requests may be split over several reads, e.g. long table URLs, but are bounded in size.
+// Bodies of POST requests are limited by the request parser.
+const constexpr std::size_t MAX_REQUEST_SIZE = 1024 * 1024;
+// Interim reply to clients that wait for the server to accept the body of a request
+const constexpr char CONTINUE_REPLY[] = "HTTP/1.1 100 Continue\r\n\r\n";
+// Persistent connections are closed after this many requests or seconds without a request
+const constexpr unsigned MAX_REQUESTS_PER_CONNECTION = 512;
+const constexpr long KEEP_ALIVE_TIMEOUT_SECONDS = 5;
+// Compressed output of chunked replies is sent in chunks of at least this size
+const constexpr std::size_t COMPRESSED_CHUNK_SIZE = 16 * 1024;
+
+// Clients of a unix domain socket have no address, they are logged as the unspecified address
+boost::asio::ip::address
+remoteAddress(const boost::asio::generic::stream_protocol::endpoint &remote)
 {
+    const auto family = remote.protocol().family();
+    if (family != AF_INET && family != AF_INET6)
+    {
+        return boost::asio::ip::address();
+    }
+
+    boost::asio::ip::tcp::endpoint tcp_endpoint;
+    std::memcpy(tcp_endpoint.data(), remote.data(), remote.size());
+    tcp_endpoint.resize(remote.size());
+    return tcp_endpoint.address();
 }
 
-boost::asio::ip::tcp::socket &Connection::socket() { return TCP_socket; }
+// The preface may arrive in several reads, its first bytes already tell it from HTTP/1.x requests
+bool isHttp2Preface(const char *begin, const char *end)
+{
+    const auto size =
+        std::min<std::size_t>(std::distance(begin, end), http2::CONNECTION_PREFACE_SIZE);
+    return size >= 4 && std::equal(begin, begin + size, http2::CONNECTION_PREFACE);
+}
+
+boost::iostreams::gzip_params compressionParameters(const http::compression_type compression_type,
+                                                    const int level)
+{
+    boost::iostreams::gzip_params compression_parameters;
+    compression_parameters.level = level;
+    // check which compression flavor is used
+    if (http::deflate_rfc1951 == compression_type)
+    {
+        compression_parameters.noheader = true;
+    }
+    return compression_parameters;
+}
+}
+
+Connection::Connection(boost::asio::io_service &io_service,
+                       RequestHandler &handler,
+                       const CompressionConfig &compression)
+    : io_service(io_service), strand(io_service), stream_socket(io_service), timer(io_service),
+      request_handler(handler), compression(compression),
+      pending_begin(incoming_data_buffer.data()), pending_end(incoming_data_buffer.data()),
+      current_request_size(0), processed_requests(0), keep_alive(false), started(false),
+      computing_reply(false)
+{
+}
+
+Connection::~Connection()
+{
+    if (started)
+    {
+        request_handler.GetMetrics().RemoveConnection();
+    }
+}
+
+boost::asio::generic::stream_protocol::socket &Connection::socket() { return stream_socket; }
 
 /// Start the first asynchronous operation for the connection.
 void Connection::start()
 {
-    TCP_socket.async_read_some(
+    started = true;
+    request_handler.GetMetrics().AddConnection();
+    read_more();
+}
+
+void Connection::read_more()
+{
+    // close idle connections, the timer is cancelled as soon as data arrives
+    timer.expires_from_now(boost::posix_time::seconds(KEEP_ALIVE_TIMEOUT_SECONDS));
+    timer.async_wait(strand.wrap(boost::bind(
+        &Connection::handle_timeout, this->shared_from_this(), boost::asio::placeholders::error)));
+
+    stream_socket.async_read_some(
         boost::asio::buffer(incoming_data_buffer),
         strand.wrap(boost::bind(&Connection::handle_read,
                                 this->shared_from_this(),
@@ -34,115 +120,354 @@ void Connection::start()
                                 boost::asio::placeholders::bytes_transferred)));
 }
 
+void Connection::handle_timeout(const boost::system::error_code &error)
+{
+    if (error == boost::asio::error::operation_aborted)
+    {
+        return;
+    }
+
+    // the timer may have been restarted after this handler was queued
+    if (timer.expires_at() <= boost::asio::deadline_timer::traits_type::now())
+    {
+        boost::system::error_code ignore_error;
+        stream_socket.close(ignore_error);
+    }
+}
+
 void Connection::handle_read(const boost::system::error_code &error, std::size_t bytes_transferred)
 {
     if (error)
     {
+        // releases the connection right away instead of once the idle timeout expires
+        timer.cancel();
         return;
     }
+    // cancels the timeout, also if its handler is already queued
+    timer.expires_at(boost::posix_time::pos_infin);
 
+    pending_begin = incoming_data_buffer.data();
+    pending_end = incoming_data_buffer.data() + bytes_transferred;
+
+    // clients with prior knowledge of HTTP/2 start with its preface instead of a request
+    if (processed_requests == 0 && current_request_size == 0 &&
+        isHttp2Preface(pending_begin, pending_end))
+    {
+        const auto remote_address = remoteAddress(stream_socket.remote_endpoint());
+        std::make_shared<Http2Connection>(io_service,
+                                          std::move(stream_socket),
+                                          request_handler,
+                                          compression,
+                                          remote_address)
+            ->start(pending_begin, pending_end);
+        return;
+    }
+
+    process_pending_data();
+}
+
+void Connection::process_pending_data()
+{
     // no error detected, let's parse the request
     http::compression_type compression_type(http::no_compression);
     RequestParser::RequestStatus result;
-    std::tie(result, compression_type) =
-        request_parser.parse(current_request,
-                             incoming_data_buffer.data(),
-                             incoming_data_buffer.data() + bytes_transferred);
+    char *parsed_end;
+    std::tie(result, compression_type, parsed_end) =
+        request_parser.parse(current_request, pending_begin, pending_end);
+
+    current_request_size += std::distance(pending_begin, parsed_end);
+    pending_begin = parsed_end;
 
     // the request has been parsed
     if (result == RequestParser::RequestStatus::valid)
     {
-        current_request.endpoint = TCP_socket.remote_endpoint().address();
-        request_handler.HandleRequest(current_request, current_reply);
+        current_request.endpoint = remoteAddress(stream_socket.remote_endpoint());
+        keep_alive =
+            current_request.keep_alive && ++processed_requests < MAX_REQUESTS_PER_CONNECTION;
+
+        // the reply is computed and compressed on a routing worker if there is a worker pool,
+        // writing always happens on the connection strand
+        if (request_handler.SampleTrace())
+        {
+            current_request.trace = std::make_shared<util::RequestTrace>();
+        }
+
+        auto self = this->shared_from_this();
+        computing_reply = true;
+        cancellation_token = request_handler.ScheduleRequest(
+            current_request, current_reply, [self, compression_type] {
+                self->current_reply.set_keep_alive(self->keep_alive);
+                {
+                    const util::TraceScope trace_scope(self->current_request.trace.get());
+                    self->prepare_reply(compression_type);
+                }
+                self->log_trace();
+                self->strand.dispatch(boost::bind(&Connection::write_reply, self));
+            });
+
+        // without a worker pool the reply is already written
+        if (computing_reply && cancellation_token)
+        {
+            watch_disconnect();
+        }
+    }
+    else if (result == RequestParser::RequestStatus::invalid ||
+             current_request_size - current_request.body.size() > MAX_REQUEST_SIZE)
+    { // request is not parseable
+        keep_alive = false;
+        current_reply = http::reply::stock_reply(http::reply::bad_request);
+
+        boost::asio::async_write(
+            stream_socket,
+            current_reply.to_buffers(),
+            strand.wrap(boost::bind(&Connection::handle_write,
+                                    this->shared_from_this(),
+                                    boost::asio::placeholders::error,
+                                    boost::asio::placeholders::bytes_transferred)));
+    }
+    else if (request_parser.take_expected_continue())
+    {
+        BOOST_ASSERT(pending_begin == pending_end);
+        boost::asio::async_write(
+            stream_socket,
+            boost::asio::buffer(CONTINUE_REPLY, sizeof(CONTINUE_REPLY) - 1),
+            strand.wrap(boost::bind(&Connection::handle_continue,
+                                    this->shared_from_this(),
+                                    boost::asio::placeholders::error)));
+    }
+    else
+    {
+        // we don't have a result yet, so continue reading
+        BOOST_ASSERT(pending_begin == pending_end);
+        read_more();
+    }
+}
+
+void Connection::handle_continue(const boost::system::error_code &error)
+{
+    if (!error)
+    {
+        read_more();
+    }
+}
+
+void Connection::watch_disconnect()
+{
+    // waits until the socket is readable without reading, which happens if the client
+    // disconnects or sends pipelined requests
+    stream_socket.async_read_some(boost::asio::null_buffers(),
+                               strand.wrap(boost::bind(&Connection::handle_disconnect,
+                                                       this->shared_from_this(),
+                                                       boost::asio::placeholders::error,
+                                                       processed_requests)));
+}
+
+void Connection::handle_disconnect(const boost::system::error_code &error, const unsigned request)
+{
+    // the reply of the watched request was written in the meantime
+    if (!computing_reply || request != processed_requests)
+    {
+        return;
+    }
 
-        // compress the result w/ gzip/deflate if requested
+    // a readable socket without data means the client closed the connection, data is read
+    // once the reply is written
+    boost::system::error_code available_error;
+    if (error || stream_socket.available(available_error) == 0 || available_error)
+    {
+        cancellation_token->Cancel();
+    }
+}
+
+void Connection::prepare_reply(http::compression_type compression_type)
+{
+    const util::TraceSpan span("compression");
+    std::size_t reply_size = current_reply.content.size();
+    for (const auto &chunk : current_reply.chunks)
+    {
+        reply_size += chunk.size();
+    }
+    // replies without a body, like 304, stay without one
+    if (reply_size < compression.min_size || current_reply.status == http::reply::not_modified)
+    {
+        compression_type = http::no_compression;
+    }
+
+    // chunked replies are compressed chunk by chunk and keep their chunked encoding
+    if (!current_reply.chunks.empty())
+    {
         switch (compression_type)
         {
         case http::deflate_rfc1951:
-            // use deflate for compression
             current_reply.headers.insert(current_reply.headers.begin(),
                                          {"Content-Encoding", "deflate"});
-            compressed_output = compress_buffers(current_reply.content, compression_type);
-            current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
-            output_buffer = current_reply.headers_to_buffers();
-            output_buffer.push_back(boost::asio::buffer(compressed_output));
+            current_reply.chunks = compress_chunks(current_reply.chunks, compression_type);
             break;
         case http::gzip_rfc1952:
-            // use gzip for compression
             current_reply.headers.insert(current_reply.headers.begin(),
                                          {"Content-Encoding", "gzip"});
-            compressed_output = compress_buffers(current_reply.content, compression_type);
-            current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
-            output_buffer = current_reply.headers_to_buffers();
-            output_buffer.push_back(boost::asio::buffer(compressed_output));
+            current_reply.chunks = compress_chunks(current_reply.chunks, compression_type);
             break;
         case http::no_compression:
-            // don't use any compression
-            current_reply.set_uncompressed_size();
-            output_buffer = current_reply.to_buffers();
             break;
         }
-        // write result to stream
-        boost::asio::async_write(TCP_socket,
-                                 output_buffer,
-                                 strand.wrap(boost::bind(&Connection::handle_write,
-                                                         this->shared_from_this(),
-                                                         boost::asio::placeholders::error)));
-    }
-    else if (result == RequestParser::RequestStatus::invalid)
-    { // request is not parseable
-        current_reply = http::reply::stock_reply(http::reply::bad_request);
+        output_buffer = current_reply.to_buffers();
+        return;
+    }
 
-        boost::asio::async_write(TCP_socket,
-                                 current_reply.to_buffers(),
-                                 strand.wrap(boost::bind(&Connection::handle_write,
-                                                         this->shared_from_this(),
-                                                         boost::asio::placeholders::error)));
+    // compress the result w/ gzip/deflate if requested
+    switch (compression_type)
+    {
+    case http::deflate_rfc1951:
+        // use deflate for compression
+        current_reply.headers.insert(current_reply.headers.begin(),
+                                     {"Content-Encoding", "deflate"});
+        compressed_output = compress_buffers(current_reply.content, compression_type);
+        current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
+        output_buffer = current_reply.headers_to_buffers();
+        output_buffer.push_back(boost::asio::buffer(compressed_output));
+        break;
+    case http::gzip_rfc1952:
+        // use gzip for compression
+        current_reply.headers.insert(current_reply.headers.begin(), {"Content-Encoding", "gzip"});
+        compressed_output = compress_buffers(current_reply.content, compression_type);
+        current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
+        output_buffer = current_reply.headers_to_buffers();
+        output_buffer.push_back(boost::asio::buffer(compressed_output));
+        break;
+    case http::no_compression:
+        // don't use any compression
+        current_reply.set_uncompressed_size();
+        output_buffer = current_reply.to_buffers();
+        break;
     }
-    else
+}
+
+void Connection::log_trace() const
+{
+    if (!current_request.trace)
     {
-        // we don't have a result yet, so continue reading
-        TCP_socket.async_read_some(
-            boost::asio::buffer(incoming_data_buffer),
-            strand.wrap(boost::bind(&Connection::handle_read,
-                                    this->shared_from_this(),
-                                    boost::asio::placeholders::error,
-                                    boost::asio::placeholders::bytes_transferred)));
+        return;
     }
+
+    std::ostringstream trace;
+    util::json::render(trace,
+                       current_request.trace->ToJSON(current_request.uri, current_reply.status));
+    util::Log() << "[trace] " << trace.str();
+}
+
+void Connection::write_reply()
+{
+    computing_reply = false;
+    cancellation_token.reset();
+
+
+    // write result to stream
+    boost::asio::async_write(
+        stream_socket,
+        output_buffer,
+        strand.wrap(boost::bind(&Connection::handle_write,
+                                this->shared_from_this(),
+                                boost::asio::placeholders::error,
+                                boost::asio::placeholders::bytes_transferred)));
 }
 
 /// Handle completion of a write operation.
-void Connection::handle_write(const boost::system::error_code &error)
+void Connection::handle_write(const boost::system::error_code &error,
+                              std::size_t bytes_transferred)
 {
-    if (!error)
+    request_handler.GetMetrics().AddBytesOut(bytes_transferred);
+    if (error)
     {
-        // Initiate graceful connection closure.
-        boost::system::error_code ignore_error;
-        TCP_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignore_error);
+        return;
+    }
+
+    if (keep_alive)
+    {
+        current_request = http::request();
+        current_reply = http::reply();
+        request_parser.reset();
+        current_request_size = 0;
+        compressed_output.clear();
+        output_buffer.clear();
+
+        // continue with pipelined requests that arrived with the previous one
+        if (pending_begin != pending_end)
+        {
+            process_pending_data();
+        }
+        else
+        {
+            read_more();
+        }
+        return;
     }
+
+    // Initiate graceful connection closure.
+    boost::system::error_code ignore_error;
+    stream_socket.shutdown(boost::asio::socket_base::shutdown_both, ignore_error);
 }
 
-std::vector<char> Connection::compress_buffers(const std::vector<char> &uncompressed_data,
-                                               const http::compression_type compression_type)
+std::vector<std::vector<char>>
+Connection::compress_chunks(std::vector<std::vector<char>> &uncompressed_chunks,
+                            const http::compression_type compression_type)
 {
-    boost::iostreams::gzip_params compression_parameters;
+    const auto compression_parameters = compressionParameters(compression_type, compression.level);
 
-    // there's a trade-off between speed and size. speed wins
-    compression_parameters.level = boost::iostreams::zlib::best_speed;
-    // check which compression flavor is used
-    if (http::deflate_rfc1951 == compression_type)
+    std::vector<std::vector<char>> compressed_chunks;
+    std::vector<char> compressed_data;
+    std::size_t uncompressed_size = 0;
+    std::size_t compressed_size = 0;
+    const auto take_compressed_data = [&] {
+        if (!compressed_data.empty())
+        {
+            compressed_size += compressed_data.size();
+            compressed_chunks.push_back(std::move(compressed_data));
+            compressed_data.clear();
+        }
+    };
+
+    boost::iostreams::filtering_ostream gzip_stream;
+    gzip_stream.push(boost::iostreams::gzip_compressor(compression_parameters));
+    gzip_stream.push(boost::iostreams::back_inserter(compressed_data));
+    for (auto &chunk : uncompressed_chunks)
     {
-        compression_parameters.noheader = true;
+        uncompressed_size += chunk.size();
+        gzip_stream.write(chunk.data(), chunk.size());
+        // free the uncompressed data as soon as it is consumed
+        std::vector<char>().swap(chunk);
+        if (compressed_data.size() >= COMPRESSED_CHUNK_SIZE)
+        {
+            take_compressed_data();
+        }
     }
+    boost::iostreams::close(gzip_stream);
+    take_compressed_data();
+
+    request_handler.GetMetrics().AddCompression(uncompressed_size, compressed_size);
+    return compressed_chunks;
+}
+
+std::vector<char> Connection::compress_buffers(const std::vector<char> &uncompressed_data,
+                                               const http::compression_type compression_type)
+{
+    auto compressed_data = compressBuffer(uncompressed_data, compression_type, compression.level);
+    request_handler.GetMetrics().AddCompression(uncompressed_data.size(), compressed_data.size());
+    return compressed_data;
+}
 
+std::vector<char> compressBuffer(const std::vector<char> &uncompressed_data,
+                                 const http::compression_type compression_type,
+                                 const int level)
+{
     std::vector<char> compressed_data;
     // plug data into boost's compression stream
     boost::iostreams::filtering_ostream gzip_stream;
-    gzip_stream.push(boost::iostreams::gzip_compressor(compression_parameters));
+    gzip_stream.push(
+        boost::iostreams::gzip_compressor(compressionParameters(compression_type, level)));
     gzip_stream.push(boost::iostreams::back_inserter(compressed_data));
-    gzip_stream.write(&uncompressed_data[0], uncompressed_data.size());
+    gzip_stream.write(uncompressed_data.data(), uncompressed_data.size());
     boost::iostreams::close(gzip_stream);
-
     return compressed_data;
 }
 }
@@ -0,0 +1,72 @@
+#include "server/http/cache_validators.hpp"
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+namespace osrm
+{
+namespace server
+{
+namespace http
+{
+
+namespace
+{
+std::string withoutWeakPrefix(const std::string &entity_tag)
+{
+    if (entity_tag.compare(0, 2, "W/") == 0)
+        return entity_tag.substr(2);
+    return entity_tag;
+}
+}
+
+std::string makeEntityTag(const engine::DatasetVersion &version)
+{
+    std::ostringstream entity_tag;
+    entity_tag << "W/\"" << std::hex << version.checksum << '-' << version.generation << '"';
+    return entity_tag.str();
+}
+
+std::string formatHTTPDate(const std::int64_t seconds)
+{
+    const std::time_t time = seconds;
+    std::tm utc;
+    gmtime_r(&time, &utc);
+
+    // the names are fixed by the standard, strftime would use the names of the locale
+    static const char *const weekdays[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char *const months[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    std::ostringstream date;
+    date << weekdays[utc.tm_wday] << ", " << std::setfill('0') << std::setw(2) << utc.tm_mday
+         << ' ' << months[utc.tm_mon] << ' ' << 1900 + utc.tm_year << ' ' << std::setw(2)
+         << utc.tm_hour << ':' << std::setw(2) << utc.tm_min << ':' << std::setw(2) << utc.tm_sec
+         << " GMT";
+    return date.str();
+}
+
+bool matchesEntityTag(const std::string &if_none_match, const std::string &entity_tag)
+{
+    const auto opaque_tag = withoutWeakPrefix(entity_tag);
+
+    std::size_t begin = 0;
+    while (begin <= if_none_match.size())
+    {
+        const auto end = std::min(if_none_match.find(',', begin), if_none_match.size());
+        const auto listed_tag =
+            boost::algorithm::trim_copy(if_none_match.substr(begin, end - begin));
+        if (listed_tag == "*" ||
+            (!listed_tag.empty() && withoutWeakPrefix(listed_tag) == opaque_tag))
+            return true;
+        begin = end + 1;
+    }
+    return false;
+}
+}
+}
+}
@@ -1,5 +1,6 @@
 #include "server/http/reply.hpp"
 
+#include <sstream>
 #include <string>
 
 namespace osrm
@@ -13,11 +14,15 @@ const char ok_html[] = "";
 const char bad_request_html[] = "";
 const char internal_server_error_html[] =
     "{\"code\": \"InternalError\",\"message\":\"Internal Server Error\"}";
+const char service_unavailable_html[] =
+    "{\"code\": \"ServiceUnavailable\",\"message\":\"Too many requests in flight\"}";
 const char seperators[] = {':', ' '};
 const char crlf[] = {'\r', '\n'};
-const std::string http_ok_string = "HTTP/1.0 200 OK\r\n";
-const std::string http_bad_request_string = "HTTP/1.0 400 Bad Request\r\n";
-const std::string http_internal_server_error_string = "HTTP/1.0 500 Internal Server Error\r\n";
+const std::string http_ok_string = "HTTP/1.1 200 OK\r\n";
+const std::string http_not_modified_string = "HTTP/1.1 304 Not Modified\r\n";
+const std::string http_bad_request_string = "HTTP/1.1 400 Bad Request\r\n";
+const std::string http_internal_server_error_string = "HTTP/1.1 500 Internal Server Error\r\n";
+const std::string http_service_unavailable_string = "HTTP/1.1 503 Service Unavailable\r\n";
 
 void reply::set_size(const std::size_t size)
 {
@@ -32,6 +37,17 @@ void reply::set_size(const std::size_t size)
 
 void reply::set_uncompressed_size() { set_size(content.size()); }
 
+void reply::set_keep_alive(const bool keep_alive)
+{
+    for (header &h : headers)
+    {
+        if ("Connection" == h.name)
+        {
+            h.value = keep_alive ? "keep-alive" : "close";
+        }
+    }
+}
+
 std::vector<boost::asio::const_buffer> reply::to_buffers()
 {
     std::vector<boost::asio::const_buffer> buffers;
@@ -44,7 +60,26 @@ std::vector<boost::asio::const_buffer> reply::to_buffers()
         buffers.push_back(boost::asio::buffer(crlf));
     }
     buffers.push_back(boost::asio::buffer(crlf));
-    buffers.push_back(boost::asio::buffer(content));
+    if (chunks.empty())
+    {
+        buffers.push_back(boost::asio::buffer(content));
+        return buffers;
+    }
+
+    // every chunk is preceded by its size and the body ends with an empty chunk
+    chunk_sizes.clear();
+    chunk_sizes.reserve(chunks.size() + 1);
+    for (const auto &chunk : chunks)
+    {
+        std::ostringstream size_line;
+        size_line << std::hex << chunk.size() << "\r\n";
+        chunk_sizes.push_back(size_line.str());
+        buffers.push_back(boost::asio::buffer(chunk_sizes.back()));
+        buffers.push_back(boost::asio::buffer(chunk));
+        buffers.push_back(boost::asio::buffer(crlf));
+    }
+    chunk_sizes.push_back("0\r\n\r\n");
+    buffers.push_back(boost::asio::buffer(chunk_sizes.back()));
     return buffers;
 }
 
@@ -87,6 +122,10 @@ std::string reply::status_to_string(const reply::status_type status)
     {
         return bad_request_html;
     }
+    if (reply::service_unavailable == status)
+    {
+        return service_unavailable_html;
+    }
     return internal_server_error_html;
 }
 
@@ -96,16 +135,24 @@ boost::asio::const_buffer reply::status_to_buffer(const reply::status_type statu
     {
         return boost::asio::buffer(http_ok_string);
     }
+    if (reply::not_modified == status)
+    {
+        return boost::asio::buffer(http_not_modified_string);
+    }
     if (reply::internal_server_error == status)
     {
         return boost::asio::buffer(http_internal_server_error_string);
     }
+    if (reply::service_unavailable == status)
+    {
+        return boost::asio::buffer(http_service_unavailable_string);
+    }
     return boost::asio::buffer(http_bad_request_string);
 }
 
 reply::reply() : status(ok)
 {
-    // We do not currently support keep alive. Always set 'Connection: close'.
+    // Connections are closed unless the connection enables keep alive, see set_keep_alive
     headers.emplace_back("Connection", "close");
 }
 }
@@ -0,0 +1,424 @@
+#include "server/http2/hpack.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace osrm
+{
+namespace server
+{
+namespace http2
+{
+
+namespace
+{
+// RFC 7541, Appendix A
+const constexpr std::size_t STATIC_TABLE_SIZE = 61;
+const char *const STATIC_TABLE[STATIC_TABLE_SIZE][2] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""}};
+
+// every entry of the dynamic table counts with this overhead besides its name and value
+const constexpr std::size_t ENTRY_OVERHEAD = 32;
+
+// RFC 7541, Appendix B: the length of the code of every byte and of EOS, the last symbol. The
+// code is canonical, the codes follow from their lengths.
+const constexpr std::size_t NUMBER_OF_SYMBOLS = 257;
+const constexpr unsigned EOS_SYMBOL = 256;
+const constexpr unsigned MAX_CODE_LENGTH = 30;
+const constexpr std::uint8_t HUFFMAN_CODE_LENGTHS[NUMBER_OF_SYMBOLS] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30,
+};
+
+struct HuffmanTable
+{
+    HuffmanTable()
+    {
+        count.fill(0);
+        for (const auto length : HUFFMAN_CODE_LENGTHS)
+        {
+            ++count[length];
+        }
+
+        // the symbols ordered by the length of their code, then by their value
+        std::array<std::uint32_t, MAX_CODE_LENGTH + 1> offset;
+        std::uint32_t next_offset = 0;
+        std::uint32_t code = 0;
+        for (unsigned length = 1; length <= MAX_CODE_LENGTH; ++length)
+        {
+            code = (code + count[length - 1]) << 1;
+            first_code[length] = code;
+            offset[length] = next_offset;
+            first_index[length] = next_offset;
+            next_offset += count[length];
+        }
+        for (unsigned symbol = 0; symbol < NUMBER_OF_SYMBOLS; ++symbol)
+        {
+            symbols[offset[HUFFMAN_CODE_LENGTHS[symbol]]++] = symbol;
+        }
+    }
+
+    std::array<std::uint32_t, MAX_CODE_LENGTH + 1> count;
+    std::array<std::uint32_t, MAX_CODE_LENGTH + 1> first_code;
+    std::array<std::uint32_t, MAX_CODE_LENGTH + 1> first_index;
+    std::array<std::uint16_t, NUMBER_OF_SYMBOLS> symbols;
+};
+
+const HuffmanTable &huffmanTable()
+{
+    static const HuffmanTable table;
+    return table;
+}
+
+void encodeInteger(std::uint32_t value,
+                   const unsigned prefix_bits,
+                   const std::uint8_t pattern,
+                   std::string &block)
+{
+    const std::uint32_t max_prefix = (1u << prefix_bits) - 1;
+    if (value < max_prefix)
+    {
+        block.push_back(static_cast<char>(pattern | value));
+        return;
+    }
+    block.push_back(static_cast<char>(pattern | max_prefix));
+    value -= max_prefix;
+    while (value >= 128)
+    {
+        block.push_back(static_cast<char>((value % 128) | 128));
+        value /= 128;
+    }
+    block.push_back(static_cast<char>(value));
+}
+
+void encodeString(const std::string &value, std::string &block)
+{
+    encodeInteger(value.size(), 7, 0, block);
+    block += value;
+}
+}
+
+bool decodeHuffman(const char *begin, const char *end, std::string &output)
+{
+    const auto &table = huffmanTable();
+
+    std::uint32_t code = 0;
+    unsigned length = 0;
+    for (auto iter = begin; iter != end; ++iter)
+    {
+        const auto byte = static_cast<unsigned char>(*iter);
+        for (int bit = 7; bit >= 0; --bit)
+        {
+            code = (code << 1) | ((byte >> bit) & 1);
+            ++length;
+
+            const auto index = code - table.first_code[length];
+            if (code >= table.first_code[length] && index < table.count[length])
+            {
+                const auto symbol = table.symbols[table.first_index[length] + index];
+                if (symbol == EOS_SYMBOL)
+                {
+                    return false;
+                }
+                output.push_back(static_cast<char>(symbol));
+                code = 0;
+                length = 0;
+            }
+            else if (length == MAX_CODE_LENGTH)
+            {
+                return false;
+            }
+        }
+    }
+
+    // the padding is a prefix of the code of EOS, which consists of ones only
+    return length < 8 && code == (1u << length) - 1;
+}
+
+bool HPACKDecoder::Decode(const char *begin, const char *end, std::vector<http::header> &headers)
+{
+    auto iter = reinterpret_cast<const unsigned char *>(begin);
+    const auto block_end = reinterpret_cast<const unsigned char *>(end);
+    while (iter != block_end)
+    {
+        const auto first_byte = *iter;
+        std::uint32_t index;
+        // indexed header field
+        if (first_byte & 0x80)
+        {
+            http::header header{"", ""};
+            if (!DecodeInteger(iter, block_end, 7, index) || !LookUp(index, header))
+            {
+                return false;
+            }
+            headers.push_back(std::move(header));
+            continue;
+        }
+
+        // dynamic table size update, at most to the size of SETTINGS_HEADER_TABLE_SIZE
+        if ((first_byte & 0xe0) == 0x20)
+        {
+            std::uint32_t size;
+            if (!DecodeInteger(iter, block_end, 5, size) || size > DEFAULT_MAX_TABLE_SIZE)
+            {
+                return false;
+            }
+            max_table_size = size;
+            Evict();
+            continue;
+        }
+
+        // literal header fields with incremental indexing, without indexing or never indexed
+        const auto incremental_indexing = (first_byte & 0xc0) == 0x40;
+        http::header header{"", ""};
+        if (!DecodeInteger(iter, block_end, incremental_indexing ? 6 : 4, index))
+        {
+            return false;
+        }
+        if (index == 0)
+        {
+            if (!DecodeString(iter, block_end, header.name))
+            {
+                return false;
+            }
+        }
+        else if (!LookUp(index, header))
+        {
+            return false;
+        }
+        header.value.clear();
+        if (!DecodeString(iter, block_end, header.value))
+        {
+            return false;
+        }
+
+        if (incremental_indexing)
+        {
+            Insert(header);
+        }
+        headers.push_back(std::move(header));
+    }
+    return true;
+}
+
+bool HPACKDecoder::DecodeInteger(const unsigned char *&iter,
+                                 const unsigned char *end,
+                                 const unsigned prefix_bits,
+                                 std::uint32_t &value) const
+{
+    BOOST_ASSERT(iter != end);
+    const std::uint32_t max_prefix = (1u << prefix_bits) - 1;
+    value = *iter++ & max_prefix;
+    if (value < max_prefix)
+    {
+        return true;
+    }
+
+    // values beyond 2^28 are not sensible for indices or lengths
+    for (unsigned shift = 0; shift <= 21; shift += 7)
+    {
+        if (iter == end)
+        {
+            return false;
+        }
+        const auto byte = *iter++;
+        value += static_cast<std::uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HPACKDecoder::DecodeString(const unsigned char *&iter,
+                                const unsigned char *end,
+                                std::string &value)
+{
+    if (iter == end)
+    {
+        return false;
+    }
+    const auto huffman_coded = (*iter & 0x80) != 0;
+    std::uint32_t length;
+    if (!DecodeInteger(iter, end, 7, length) || length > static_cast<std::size_t>(end - iter))
+    {
+        return false;
+    }
+
+    const auto string_begin = reinterpret_cast<const char *>(iter);
+    iter += length;
+    if (huffman_coded)
+    {
+        return decodeHuffman(string_begin, string_begin + length, value);
+    }
+    value.append(string_begin, length);
+    return true;
+}
+
+bool HPACKDecoder::LookUp(const std::uint32_t index, http::header &header) const
+{
+    if (index == 0)
+    {
+        return false;
+    }
+    if (index <= STATIC_TABLE_SIZE)
+    {
+        header.name = STATIC_TABLE[index - 1][0];
+        header.value = STATIC_TABLE[index - 1][1];
+        return true;
+    }
+    const auto dynamic_index = index - STATIC_TABLE_SIZE - 1;
+    if (dynamic_index >= dynamic_table.size())
+    {
+        return false;
+    }
+    header = dynamic_table[dynamic_index];
+    return true;
+}
+
+void HPACKDecoder::Insert(const http::header &header)
+{
+    const auto entry_size = header.name.size() + header.value.size() + ENTRY_OVERHEAD;
+    // an entry larger than the table empties it and is not added
+    if (entry_size > max_table_size)
+    {
+        dynamic_table.clear();
+        table_size = 0;
+        return;
+    }
+    dynamic_table.push_front(header);
+    table_size += entry_size;
+    Evict();
+}
+
+void HPACKDecoder::Evict()
+{
+    while (table_size > max_table_size)
+    {
+        const auto &oldest = dynamic_table.back();
+        table_size -= oldest.name.size() + oldest.value.size() + ENTRY_OVERHEAD;
+        dynamic_table.pop_back();
+    }
+}
+
+void HPACKEncoder::Encode(const std::vector<http::header> &headers, std::string &block) const
+{
+    for (const auto &header : headers)
+    {
+        std::uint32_t name_index = 0;
+        std::uint32_t field_index = 0;
+        for (std::uint32_t index = 0; index < STATIC_TABLE_SIZE; ++index)
+        {
+            if (header.name != STATIC_TABLE[index][0])
+            {
+                continue;
+            }
+            if (name_index == 0)
+            {
+                name_index = index + 1;
+            }
+            if (header.value == STATIC_TABLE[index][1])
+            {
+                field_index = index + 1;
+                break;
+            }
+        }
+
+        // e.g. :status 200 is sent as its index only
+        if (field_index != 0)
+        {
+            encodeInteger(field_index, 7, 0x80, block);
+            continue;
+        }
+
+        // literal header field without indexing
+        encodeInteger(name_index, 4, 0x00, block);
+        if (name_index == 0)
+        {
+            encodeString(header.name, block);
+        }
+        encodeString(header.value, block);
+    }
+}
+}
+}
+}
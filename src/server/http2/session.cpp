@@ -0,0 +1,757 @@
+#include "server/http2/session.hpp"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace osrm
+{
+namespace server
+{
+namespace http2
+{
+
+namespace
+{
+// RFC 7540, section 6
+enum FrameType : std::uint8_t
+{
+    DATA = 0x0,
+    HEADERS = 0x1,
+    PRIORITY = 0x2,
+    RST_STREAM = 0x3,
+    SETTINGS = 0x4,
+    PUSH_PROMISE = 0x5,
+    PING = 0x6,
+    GOAWAY = 0x7,
+    WINDOW_UPDATE = 0x8,
+    CONTINUATION = 0x9
+};
+
+const constexpr std::uint8_t FLAG_END_STREAM = 0x1;
+const constexpr std::uint8_t FLAG_ACK = 0x1;
+const constexpr std::uint8_t FLAG_END_HEADERS = 0x4;
+const constexpr std::uint8_t FLAG_PADDED = 0x8;
+const constexpr std::uint8_t FLAG_PRIORITY = 0x20;
+
+const constexpr std::uint16_t SETTINGS_ENABLE_PUSH = 0x2;
+const constexpr std::uint16_t SETTINGS_MAX_CONCURRENT_STREAMS = 0x3;
+const constexpr std::uint16_t SETTINGS_INITIAL_WINDOW_SIZE = 0x4;
+const constexpr std::uint16_t SETTINGS_MAX_FRAME_SIZE = 0x5;
+
+const constexpr std::size_t FRAME_HEADER_SIZE = 9;
+// the server keeps the default SETTINGS_MAX_FRAME_SIZE and windows for what it receives
+const constexpr std::size_t DEFAULT_MAX_FRAME_SIZE = 16384;
+const constexpr std::size_t MAX_ALLOWED_FRAME_SIZE = 16777215;
+const constexpr std::int64_t DEFAULT_WINDOW_SIZE = 65535;
+const constexpr std::int64_t MAX_WINDOW_SIZE = 0x7fffffff;
+
+// Same limits as for HTTP/1.1 requests, see Connection and RequestParser
+const constexpr std::size_t MAX_HEADER_BLOCK_SIZE = 1024 * 1024;
+const constexpr std::size_t MAX_BODY_SIZE = 64 * 1024 * 1024;
+
+std::uint32_t readUInt32(const char *data)
+{
+    const auto bytes = reinterpret_cast<const unsigned char *>(data);
+    return (static_cast<std::uint32_t>(bytes[0]) << 24) |
+           (static_cast<std::uint32_t>(bytes[1]) << 16) |
+           (static_cast<std::uint32_t>(bytes[2]) << 8) | static_cast<std::uint32_t>(bytes[3]);
+}
+
+void appendUInt32(std::string &output, const std::uint32_t value)
+{
+    output.push_back(static_cast<char>(value >> 24));
+    output.push_back(static_cast<char>(value >> 16));
+    output.push_back(static_cast<char>(value >> 8));
+    output.push_back(static_cast<char>(value));
+}
+
+// headers of the connection that have no meaning for a stream, RFC 7540, section 8.1.2.2
+bool isConnectionHeader(const std::string &name)
+{
+    return name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+           name == "transfer-encoding" || name == "upgrade";
+}
+}
+
+Session::Session()
+    : connection_send_window(DEFAULT_WINDOW_SIZE), initial_send_window(DEFAULT_WINDOW_SIZE),
+      max_send_frame_size(DEFAULT_MAX_FRAME_SIZE)
+{
+    std::string settings;
+    settings.push_back(static_cast<char>(SETTINGS_MAX_CONCURRENT_STREAMS >> 8));
+    settings.push_back(static_cast<char>(SETTINGS_MAX_CONCURRENT_STREAMS));
+    appendUInt32(settings, MAX_CONCURRENT_STREAMS);
+    WriteFrame(SETTINGS, 0, 0, settings.data(), settings.size());
+}
+
+bool Session::Consume(const char *begin, const char *end)
+{
+    if (failed)
+    {
+        return false;
+    }
+    input.append(begin, end);
+
+    std::size_t position = 0;
+    if (!preface_received)
+    {
+        const auto compared = std::min(input.size(), CONNECTION_PREFACE_SIZE);
+        if (input.compare(0, compared, CONNECTION_PREFACE, compared) != 0)
+        {
+            return ConnectionError(PROTOCOL_ERROR);
+        }
+        if (input.size() < CONNECTION_PREFACE_SIZE)
+        {
+            return true;
+        }
+        preface_received = true;
+        position = CONNECTION_PREFACE_SIZE;
+    }
+
+    while (input.size() - position >= FRAME_HEADER_SIZE)
+    {
+        const auto header = input.data() + position;
+        const auto length = readUInt32(header) >> 8;
+        const auto type = static_cast<std::uint8_t>(header[3]);
+        const auto flags = static_cast<std::uint8_t>(header[4]);
+        const auto stream_id = readUInt32(header + 5) & 0x7fffffff;
+        if (length > DEFAULT_MAX_FRAME_SIZE)
+        {
+            return ConnectionError(FRAME_SIZE_ERROR);
+        }
+        if (input.size() - position - FRAME_HEADER_SIZE < length)
+        {
+            break;
+        }
+
+        if (!ProcessFrame(type, flags, stream_id, header + FRAME_HEADER_SIZE, length))
+        {
+            return false;
+        }
+        position += FRAME_HEADER_SIZE + length;
+    }
+    input.erase(0, position);
+    return true;
+}
+
+std::vector<Session::Request> Session::TakeRequests()
+{
+    std::vector<Request> requests;
+    requests.swap(complete_requests);
+    return requests;
+}
+
+std::vector<std::uint32_t> Session::TakeResetStreams()
+{
+    std::vector<std::uint32_t> streams;
+    streams.swap(reset_streams);
+    return streams;
+}
+
+void Session::SubmitReply(const std::uint32_t stream_id,
+                          const int status,
+                          std::vector<http::header> headers,
+                          std::vector<char> body)
+{
+    const auto found = streams.find(stream_id);
+    if (failed || found == streams.end() || !found->second.request_complete ||
+        found->second.replying)
+    {
+        return;
+    }
+
+    std::vector<http::header> reply_headers;
+    reply_headers.reserve(headers.size() + 2);
+    reply_headers.emplace_back(":status", std::to_string(status));
+    for (auto &header : headers)
+    {
+        boost::algorithm::to_lower(header.name);
+        if (!isConnectionHeader(header.name) && header.name != "content-length")
+        {
+            reply_headers.push_back(std::move(header));
+        }
+    }
+    reply_headers.emplace_back("content-length", std::to_string(body.size()));
+
+    std::string block;
+    encoder.Encode(reply_headers, block);
+
+    // the header block is split into a HEADERS and CONTINUATION frames of at most the frame
+    // size of the client
+    const auto end_stream = body.empty() ? FLAG_END_STREAM : 0;
+    std::size_t offset = 0;
+    do
+    {
+        const auto size = std::min(block.size() - offset, max_send_frame_size);
+        const auto last = offset + size == block.size();
+        WriteFrame(offset == 0 ? HEADERS : CONTINUATION,
+                   (offset == 0 ? end_stream : 0) | (last ? FLAG_END_HEADERS : 0),
+                   stream_id,
+                   block.data() + offset,
+                   size);
+        offset += size;
+    } while (offset < block.size());
+
+    if (body.empty())
+    {
+        streams.erase(found);
+        return;
+    }
+    found->second.pending_body = std::move(body);
+    found->second.replying = true;
+    Flush();
+}
+
+std::string Session::TakeOutput()
+{
+    std::string taken;
+    taken.swap(output);
+    return taken;
+}
+
+bool Session::IsDone() const { return failed || (going_away && streams.empty()); }
+
+bool Session::ProcessFrame(const std::uint8_t type,
+                           const std::uint8_t flags,
+                           const std::uint32_t stream_id,
+                           const char *payload,
+                           const std::size_t length)
+{
+    // the frames of a header block must not be interleaved with other frames
+    if (header_block_stream_id != 0 && type != CONTINUATION)
+    {
+        return ConnectionError(PROTOCOL_ERROR);
+    }
+
+    switch (type)
+    {
+    case DATA:
+        return ProcessData(flags, stream_id, payload, length);
+    case HEADERS:
+        return ProcessHeaders(flags, stream_id, payload, length);
+    case PRIORITY:
+        if (stream_id == 0)
+        {
+            return ConnectionError(PROTOCOL_ERROR);
+        }
+        if (length != 5)
+        {
+            ResetStream(stream_id, FRAME_SIZE_ERROR);
+        }
+        return true;
+    case RST_STREAM:
+        return ProcessRstStream(stream_id, length);
+    case SETTINGS:
+        return ProcessSettings(flags, stream_id, payload, length);
+    case PUSH_PROMISE:
+        // clients do not push
+        return ConnectionError(PROTOCOL_ERROR);
+    case PING:
+        if (stream_id != 0)
+        {
+            return ConnectionError(PROTOCOL_ERROR);
+        }
+        if (length != 8)
+        {
+            return ConnectionError(FRAME_SIZE_ERROR);
+        }
+        if ((flags & FLAG_ACK) == 0)
+        {
+            WriteFrame(PING, FLAG_ACK, 0, payload, length);
+        }
+        return true;
+    case GOAWAY:
+        if (stream_id != 0)
+        {
+            return ConnectionError(PROTOCOL_ERROR);
+        }
+        return ProcessGoAway(length);
+    case WINDOW_UPDATE:
+        return ProcessWindowUpdate(stream_id, payload, length);
+    case CONTINUATION:
+        return ProcessContinuation(flags, stream_id, payload, length);
+    default:
+        // unknown frame types are ignored
+        return true;
+    }
+}
+
+bool Session::ProcessData(const std::uint8_t flags,
+                          const std::uint32_t stream_id,
+                          const char *payload,
+                          const std::size_t length)
+{
+    if (stream_id == 0 || stream_id > last_stream_id)
+    {
+        return ConnectionError(PROTOCOL_ERROR);
+    }
+
+    std::size_t offset = 0;
+    std::size_t padding = 0;
+    if (flags & FLAG_PADDED)
+    {
+        if (length < 1)
+        {
+            return ConnectionError(FRAME_SIZE_ERROR);
+        }
+        padding = static_cast<unsigned char>(payload[0]);
+        offset = 1;
+    }
+    if (offset + padding > length)
+    {
+        return ConnectionError(PROTOCOL_ERROR);
+    }
+
+    // the whole frame counts against the windows, bodies are bounded by MAX_BODY_SIZE so the
+    // data is acknowledged right away
+    if (length > 0)
+    {
+        WriteWindowUpdate(0, length);
+    }
+
+    const auto found = streams.find(stream_id);
+    // frames of streams that were reset are ignored
+    if (found == streams.end())
+    {
+        return true;
+    }
+    auto &stream = found->second;
+    if (stream.request_complete)
+    {
+        ResetStream(stream_id, STREAM_CLOSED);
+        return true;
+    }
+
+    stream.request.body.append(payload + offset, length - offset - padding);
+    if (stream.request.body.size() > MAX_BODY_SIZE)
+    {
+        ResetStream(stream_id, ENHANCE_YOUR_CALM);
+        return true;
+    }
+
+    if (flags & FLAG_END_STREAM)
+    {
+        CompleteRequest(stream_id, stream);
+    }
+    else if (length > 0)
+    {
+        WriteWindowUpdate(stream_id, length);
+    }
+    return true;
+}
+
+bool Session::ProcessHeaders(const std::uint8_t flags,
+                             const std::uint32_t stream_id,
+                             const char *payload,
+                             const std::size_t length)
+{
+    if (stream_id == 0)
+    {
+        return ConnectionError(PROTOCOL_ERROR);
+    }
+
+    std::size_t offset = 0;
+    std::size_t padding = 0;
+    if (flags & FLAG_PADDED)
+    {
+        if (length < 1)
+        {
+            return ConnectionError(FRAME_SIZE_ERROR);
+        }
+        padding = static_cast<unsigned char>(payload[0]);
+        offset = 1;
+    }
+    // the priority of the stream is ignored
+    if (flags & FLAG_PRIORITY)
+    {
+        offset += 5;
+    }
+    if (offset + padding > length)
+    {
+        return ConnectionError(PROTOCOL_ERROR);
+    }
+
+    header_block_stream_id = stream_id;
+    header_block_ends_stream = (flags & FLAG_END_STREAM) != 0;
+    header_block.assign(payload + offset, length - offset - padding);
+    if (flags & FLAG_END_HEADERS)
+    {
+        return FinishHeaderBlock();
+    }
+    return true;
+}
+
+bool Session::ProcessContinuation(const std::uint8_t flags,
+                                  const std::uint32_t stream_id,
+                                  const char *payload,
+                                  const std::size_t length)
+{
+    if (header_block_stream_id == 0 || stream_id != header_block_stream_id)
+    {
+        return ConnectionError(PROTOCOL_ERROR);
+    }
+
+    header_block.append(payload, length);
+    if (header_block.size() > MAX_HEADER_BLOCK_SIZE)
+    {
+        return ConnectionError(ENHANCE_YOUR_CALM);
+    }
+    if (flags & FLAG_END_HEADERS)
+    {
+        return FinishHeaderBlock();
+    }
+    return true;
+}
+
+bool Session::ProcessSettings(const std::uint8_t flags,
+                              const std::uint32_t stream_id,
+                              const char *payload,
+                              const std::size_t length)
+{
+    if (stream_id != 0)
+    {
+        return ConnectionError(PROTOCOL_ERROR);
+    }
+    if (flags & FLAG_ACK)
+    {
+        return length == 0 || ConnectionError(FRAME_SIZE_ERROR);
+    }
+    if (length % 6 != 0)
+    {
+        return ConnectionError(FRAME_SIZE_ERROR);
+    }
+
+    for (std::size_t offset = 0; offset < length; offset += 6)
+    {
+        const auto identifier = static_cast<std::uint16_t>(
+            (static_cast<unsigned char>(payload[offset]) << 8) |
+            static_cast<unsigned char>(payload[offset + 1]));
+        const auto value = readUInt32(payload + offset + 2);
+        switch (identifier)
+        {
+        case SETTINGS_ENABLE_PUSH:
+            if (value > 1)
+            {
+                return ConnectionError(PROTOCOL_ERROR);
+            }
+            break;
+        case SETTINGS_INITIAL_WINDOW_SIZE:
+        {
+            if (value > MAX_WINDOW_SIZE)
+            {
+                return ConnectionError(FLOW_CONTROL_ERROR);
+            }
+            // applies to the windows of all open streams
+            const auto delta = static_cast<std::int64_t>(value) - initial_send_window;
+            for (auto &stream : streams)
+            {
+                stream.second.send_window += delta;
+                if (stream.second.send_window > MAX_WINDOW_SIZE)
+                {
+                    return ConnectionError(FLOW_CONTROL_ERROR);
+                }
+            }
+            initial_send_window = value;
+            break;
+        }
+        case SETTINGS_MAX_FRAME_SIZE:
+            if (value < DEFAULT_MAX_FRAME_SIZE || value > MAX_ALLOWED_FRAME_SIZE)
+            {
+                return ConnectionError(PROTOCOL_ERROR);
+            }
+            max_send_frame_size = value;
+            break;
+        default:
+            // the header table size does not matter, the encoder does not index
+            break;
+        }
+    }
+
+    WriteFrame(SETTINGS, FLAG_ACK, 0, nullptr, 0);
+    Flush();
+    return true;
+}
+
+bool Session::ProcessWindowUpdate(const std::uint32_t stream_id,
+                                  const char *payload,
+                                  const std::size_t length)
+{
+    if (length != 4)
+    {
+        return ConnectionError(FRAME_SIZE_ERROR);
+    }
+
+    const auto increment = readUInt32(payload) & 0x7fffffff;
+    if (stream_id == 0)
+    {
+        if (increment == 0)
+        {
+            return ConnectionError(PROTOCOL_ERROR);
+        }
+        connection_send_window += increment;
+        if (connection_send_window > MAX_WINDOW_SIZE)
+        {
+            return ConnectionError(FLOW_CONTROL_ERROR);
+        }
+    }
+    else
+    {
+        const auto found = streams.find(stream_id);
+        if (found == streams.end())
+        {
+            // the reply may have been sent completely before the update arrived
+            return stream_id <= last_stream_id || ConnectionError(PROTOCOL_ERROR);
+        }
+        if (increment == 0)
+        {
+            ResetStream(stream_id, PROTOCOL_ERROR);
+            return true;
+        }
+        found->second.send_window += increment;
+        if (found->second.send_window > MAX_WINDOW_SIZE)
+        {
+            ResetStream(stream_id, FLOW_CONTROL_ERROR);
+            return true;
+        }
+    }
+
+    Flush();
+    return true;
+}
+
+bool Session::ProcessRstStream(const std::uint32_t stream_id, const std::size_t length)
+{
+    if (length != 4)
+    {
+        return ConnectionError(FRAME_SIZE_ERROR);
+    }
+    if (stream_id == 0 || stream_id > last_stream_id)
+    {
+        return ConnectionError(PROTOCOL_ERROR);
+    }
+
+    const auto found = streams.find(stream_id);
+    if (found != streams.end())
+    {
+        // the request may be computed already
+        if (found->second.request_complete)
+        {
+            reset_streams.push_back(stream_id);
+        }
+        streams.erase(found);
+    }
+    return true;
+}
+
+bool Session::ProcessGoAway(const std::size_t length)
+{
+    if (length < 8)
+    {
+        return ConnectionError(FRAME_SIZE_ERROR);
+    }
+    // the streams in flight are answered, the client does not open new ones
+    going_away = true;
+    return true;
+}
+
+bool Session::FinishHeaderBlock()
+{
+    // the block is decoded even if the stream is refused, the dynamic table depends on it
+    std::vector<http::header> headers;
+    if (!decoder.Decode(header_block.data(), header_block.data() + header_block.size(), headers))
+    {
+        return ConnectionError(COMPRESSION_ERROR);
+    }
+    const auto stream_id = header_block_stream_id;
+    header_block_stream_id = 0;
+    header_block.clear();
+
+    const auto found = streams.find(stream_id);
+    if (found != streams.end())
+    {
+        // trailers end the request, their fields are ignored
+        if (found->second.request_complete || !header_block_ends_stream)
+        {
+            ResetStream(stream_id,
+                        found->second.request_complete ? STREAM_CLOSED : PROTOCOL_ERROR);
+            return true;
+        }
+        CompleteRequest(stream_id, found->second);
+        return true;
+    }
+
+    // streams of clients have odd ids that increase
+    if (stream_id % 2 == 0 || stream_id <= last_stream_id)
+    {
+        return ConnectionError(PROTOCOL_ERROR);
+    }
+    last_stream_id = stream_id;
+
+    if (streams.size() >= MAX_CONCURRENT_STREAMS)
+    {
+        ResetStream(stream_id, REFUSED_STREAM);
+        return true;
+    }
+
+    Stream stream;
+    stream.send_window = initial_send_window;
+    auto &request = stream.request;
+    for (const auto &header : headers)
+    {
+        if (header.name == ":method")
+        {
+            request.method = header.value;
+        }
+        else if (header.name == ":path")
+        {
+            request.uri = header.value;
+        }
+        else if (header.name == "accept-encoding")
+        {
+            // giving gzip precedence over deflate like for HTTP/1.1
+            if (boost::icontains(header.value, "gzip"))
+            {
+                stream.compression_type = http::gzip_rfc1952;
+            }
+            else if (boost::icontains(header.value, "deflate") &&
+                     stream.compression_type == http::no_compression)
+            {
+                stream.compression_type = http::deflate_rfc1951;
+            }
+        }
+        else if (header.name == "referer")
+        {
+            request.referrer = header.value;
+        }
+        else if (header.name == "user-agent")
+        {
+            request.agent = header.value;
+        }
+        else if (header.name == "accept")
+        {
+            request.accept = header.value;
+        }
+        else if (header.name == "x-osrm-priority")
+        {
+            request.priority = header.value;
+        }
+        else if (header.name == "if-none-match")
+        {
+            request.if_none_match = header.value;
+        }
+    }
+    if (request.method.empty() || request.uri.empty())
+    {
+        ResetStream(stream_id, PROTOCOL_ERROR);
+        return true;
+    }
+    // streams are always multiplexed on the connection and replies never chunked
+    request.keep_alive = true;
+    request.chunked_encoding = false;
+
+    auto &inserted = streams.emplace(stream_id, std::move(stream)).first->second;
+    if (header_block_ends_stream)
+    {
+        CompleteRequest(stream_id, inserted);
+    }
+    return true;
+}
+
+void Session::CompleteRequest(const std::uint32_t stream_id, Stream &stream)
+{
+    stream.request_complete = true;
+    complete_requests.push_back(
+        Request{stream_id, std::move(stream.request), stream.compression_type});
+}
+
+void Session::Flush()
+{
+    // one frame per stream and round, so large replies do not hold back the others
+    bool sent = true;
+    while (sent && connection_send_window > 0)
+    {
+        sent = false;
+        for (auto iter = streams.begin();
+             iter != streams.end() && connection_send_window > 0;)
+        {
+            auto &stream = iter->second;
+            if (!stream.replying || stream.send_window <= 0)
+            {
+                ++iter;
+                continue;
+            }
+
+            const auto remaining = stream.pending_body.size() - stream.pending_offset;
+            const auto size = static_cast<std::size_t>(
+                std::min<std::int64_t>(std::min(remaining, max_send_frame_size),
+                                       std::min(stream.send_window, connection_send_window)));
+            const auto last = size == remaining;
+            WriteFrame(DATA,
+                       last ? FLAG_END_STREAM : 0,
+                       iter->first,
+                       stream.pending_body.data() + stream.pending_offset,
+                       size);
+            stream.pending_offset += size;
+            stream.send_window -= size;
+            connection_send_window -= size;
+            sent = true;
+
+            if (last)
+            {
+                iter = streams.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+}
+
+bool Session::ConnectionError(const ErrorCode error_code)
+{
+    std::string payload;
+    appendUInt32(payload, last_stream_id);
+    appendUInt32(payload, error_code);
+    WriteFrame(GOAWAY, 0, 0, payload.data(), payload.size());
+
+    failed = true;
+    streams.clear();
+    complete_requests.clear();
+    return false;
+}
+
+void Session::ResetStream(const std::uint32_t stream_id, const ErrorCode error_code)
+{
+    std::string payload;
+    appendUInt32(payload, error_code);
+    WriteFrame(RST_STREAM, 0, stream_id, payload.data(), payload.size());
+    streams.erase(stream_id);
+}
+
+void Session::WriteFrame(const std::uint8_t type,
+                         const std::uint8_t flags,
+                         const std::uint32_t stream_id,
+                         const char *payload,
+                         const std::size_t length)
+{
+    BOOST_ASSERT(length <= MAX_ALLOWED_FRAME_SIZE);
+    appendUInt32(output, static_cast<std::uint32_t>(length << 8) | type);
+    output.push_back(static_cast<char>(flags));
+    appendUInt32(output, stream_id);
+    output.append(payload, length);
+}
+
+void Session::WriteWindowUpdate(const std::uint32_t stream_id, const std::uint32_t increment)
+{
+    std::string payload;
+    appendUInt32(payload, increment);
+    WriteFrame(WINDOW_UPDATE, 0, stream_id, payload.data(), payload.size());
+}
+}
+}
+}
@@ -0,0 +1,250 @@
+#include "server/http2_connection.hpp"
+#include "server/request_handler.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace
+{
+// Same as for persistent HTTP/1.1 connections, but only while no request is in flight
+const constexpr long IDLE_TIMEOUT_SECONDS = 5;
+}
+
+Http2Connection::Http2Connection(boost::asio::io_service &io_service,
+                                 boost::asio::generic::stream_protocol::socket socket,
+                                 RequestHandler &handler,
+                                 const CompressionConfig &compression,
+                                 const boost::asio::ip::address &remote_address)
+    : strand(io_service), stream_socket(std::move(socket)), timer(io_service),
+      request_handler(handler), compression(compression), remote_address(remote_address),
+      writing(false), closed(false)
+{
+    request_handler.GetMetrics().AddConnection();
+}
+
+Http2Connection::~Http2Connection() { request_handler.GetMetrics().RemoveConnection(); }
+
+void Http2Connection::start(const char *begin, const char *end) { process(begin, end); }
+
+void Http2Connection::read_more()
+{
+    timer.expires_from_now(boost::posix_time::seconds(IDLE_TIMEOUT_SECONDS));
+    timer.async_wait(strand.wrap(boost::bind(&Http2Connection::handle_timeout,
+                                             this->shared_from_this(),
+                                             boost::asio::placeholders::error)));
+
+    stream_socket.async_read_some(
+        boost::asio::buffer(incoming_data_buffer),
+        strand.wrap(boost::bind(&Http2Connection::handle_read,
+                                this->shared_from_this(),
+                                boost::asio::placeholders::error,
+                                boost::asio::placeholders::bytes_transferred)));
+}
+
+void Http2Connection::handle_timeout(const boost::system::error_code &error)
+{
+    if (error == boost::asio::error::operation_aborted ||
+        timer.expires_at() > boost::asio::deadline_timer::traits_type::now())
+    {
+        return;
+    }
+
+    // the client waits for replies, check again later
+    if (!streams.empty() || writing)
+    {
+        timer.expires_from_now(boost::posix_time::seconds(IDLE_TIMEOUT_SECONDS));
+        timer.async_wait(strand.wrap(boost::bind(&Http2Connection::handle_timeout,
+                                                 this->shared_from_this(),
+                                                 boost::asio::placeholders::error)));
+        return;
+    }
+
+    closed = true;
+    boost::system::error_code ignore_error;
+    stream_socket.close(ignore_error);
+}
+
+void Http2Connection::handle_read(const boost::system::error_code &error,
+                                  std::size_t bytes_transferred)
+{
+    // cancels the timeout, also if its handler is already queued
+    timer.expires_at(boost::posix_time::pos_infin);
+    if (error)
+    {
+        closed = true;
+        timer.cancel();
+        cancel_streams();
+        return;
+    }
+
+    process(incoming_data_buffer.data(), incoming_data_buffer.data() + bytes_transferred);
+}
+
+void Http2Connection::process(const char *begin, const char *end)
+{
+    if (!session.Consume(begin, end))
+    {
+        // only the GOAWAY frame is written, then the connection is closed
+        cancel_streams();
+        write_output();
+        return;
+    }
+
+    for (auto &complete_request : session.TakeRequests())
+    {
+        const auto stream_id = complete_request.stream_id;
+        auto stream = std::make_unique<Stream>();
+        stream->request = std::move(complete_request.request);
+        stream->request.endpoint = remote_address;
+        stream->compression_type = complete_request.compression_type;
+
+        // the stream stays alive until its reply is submitted, also if the client resets it
+        auto &scheduled = *stream;
+        streams.emplace(stream_id, std::move(stream));
+        auto self = this->shared_from_this();
+        auto cancellation_token = request_handler.ScheduleRequest(
+            scheduled.request, scheduled.reply, [self, stream_id, &scheduled] {
+                self->prepare_reply(scheduled);
+                self->strand.dispatch(
+                    boost::bind(&Http2Connection::submit_reply, self, stream_id));
+            });
+
+        // without a worker pool the reply is submitted already
+        const auto found = streams.find(stream_id);
+        if (found != streams.end())
+        {
+            found->second->cancellation_token = std::move(cancellation_token);
+        }
+    }
+
+    for (const auto stream_id : session.TakeResetStreams())
+    {
+        const auto found = streams.find(stream_id);
+        if (found != streams.end() && found->second->cancellation_token)
+        {
+            found->second->cancellation_token->Cancel();
+        }
+    }
+
+    write_output();
+    if (!session.IsDone())
+    {
+        read_more();
+    }
+}
+
+void Http2Connection::prepare_reply(Stream &stream)
+{
+    auto &reply = stream.reply;
+
+    // HTTP/2 has its own framing, the chunks of a reply are sent as one body
+    if (!reply.chunks.empty())
+    {
+        std::size_t reply_size = 0;
+        for (const auto &chunk : reply.chunks)
+        {
+            reply_size += chunk.size();
+        }
+        reply.content.clear();
+        reply.content.reserve(reply_size);
+        for (auto &chunk : reply.chunks)
+        {
+            reply.content.insert(reply.content.end(), chunk.begin(), chunk.end());
+            std::vector<char>().swap(chunk);
+        }
+        reply.chunks.clear();
+    }
+
+    if (stream.compression_type == http::no_compression ||
+        reply.content.size() < compression.min_size || reply.status == http::reply::not_modified)
+    {
+        return;
+    }
+
+    auto compressed_content =
+        compressBuffer(reply.content, stream.compression_type, compression.level);
+    request_handler.GetMetrics().AddCompression(reply.content.size(),
+                                                compressed_content.size());
+    reply.content = std::move(compressed_content);
+    reply.headers.emplace_back("content-encoding",
+                               stream.compression_type == http::gzip_rfc1952 ? "gzip"
+                                                                             : "deflate");
+}
+
+void Http2Connection::submit_reply(const std::uint32_t stream_id)
+{
+    const auto found = streams.find(stream_id);
+    BOOST_ASSERT(found != streams.end());
+
+    auto &reply = found->second->reply;
+    session.SubmitReply(
+        stream_id, reply.status, std::move(reply.headers), std::move(reply.content));
+    streams.erase(found);
+    write_output();
+}
+
+void Http2Connection::write_output()
+{
+    if (writing || closed)
+    {
+        return;
+    }
+
+    if (!session.HasOutput())
+    {
+        if (session.IsDone())
+        {
+            closed = true;
+            boost::system::error_code ignore_error;
+            stream_socket.shutdown(boost::asio::socket_base::shutdown_both, ignore_error);
+        }
+        return;
+    }
+
+    writing = true;
+    output = session.TakeOutput();
+    boost::asio::async_write(
+        stream_socket,
+        boost::asio::buffer(output),
+        strand.wrap(boost::bind(&Http2Connection::handle_write,
+                                this->shared_from_this(),
+                                boost::asio::placeholders::error,
+                                boost::asio::placeholders::bytes_transferred)));
+}
+
+void Http2Connection::handle_write(const boost::system::error_code &error,
+                                   std::size_t bytes_transferred)
+{
+    request_handler.GetMetrics().AddBytesOut(bytes_transferred);
+    writing = false;
+    if (error)
+    {
+        closed = true;
+        cancel_streams();
+        return;
+    }
+
+    // frames that were queued while writing
+    write_output();
+}
+
+void Http2Connection::cancel_streams()
+{
+    for (auto &stream : streams)
+    {
+        if (stream.second->cancellation_token)
+        {
+            stream.second->cancellation_token->Cancel();
+        }
+    }
+}
+}
+}
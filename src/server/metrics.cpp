@@ -0,0 +1,200 @@
+#include "server/metrics.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace
+{
+const constexpr double LATENCY_BOUNDS[Metrics::NUMBER_OF_LATENCY_BOUNDS] = {
+    0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+
+// only known services get a label to bound the number of time series
+const constexpr char *SERVICES[Metrics::NUMBER_OF_SERVICES] = {
+    "route", "nearest", "table", "match", "trip", "tile", "batch", "isochrone", "other"};
+
+void renderHeader(std::ostream &out, const char *name, const char *type, const char *help)
+{
+    out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+}
+}
+
+constexpr std::size_t Metrics::NUMBER_OF_LATENCY_BOUNDS;
+constexpr std::size_t Metrics::NUMBER_OF_SERVICES;
+
+Metrics::Metrics()
+    : active_connections(0), bytes_out(0), coalesced_requests(0), compression_input_bytes(0),
+      compression_output_bytes(0)
+{
+    for (auto &histogram : latencies)
+    {
+        for (auto &bin : histogram.bins)
+        {
+            bin = 0;
+        }
+        histogram.count = 0;
+        histogram.sum_us = 0;
+    }
+}
+
+std::size_t Metrics::ServiceIndex(const std::string &service)
+{
+    const auto last = std::prev(std::end(SERVICES));
+    return std::distance(std::begin(SERVICES), std::find(std::begin(SERVICES), last, service));
+}
+
+void Metrics::ObserveRequest(const std::string &service,
+                             const double seconds,
+                             const unsigned status)
+{
+    const auto service_index = ServiceIndex(service);
+    auto &histogram = latencies[service_index];
+
+    const auto bin = std::distance(
+        std::begin(LATENCY_BOUNDS),
+        std::lower_bound(std::begin(LATENCY_BOUNDS), std::end(LATENCY_BOUNDS), seconds));
+    ++histogram.bins[bin];
+    ++histogram.count;
+    histogram.sum_us += static_cast<std::uint64_t>(std::max(0., seconds) * 1e6);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++responses[std::make_pair(service_index, status)];
+}
+
+void Metrics::AddSearchCounters(const util::SearchCounters &counters)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    search_counters += counters;
+}
+
+void Metrics::RegisterGauge(const std::string &name, const std::string &help, Gauge gauge)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    gauges.emplace_back(name, help, std::move(gauge));
+}
+
+std::string Metrics::Render(const QueueDepths &queue_depths) const
+{
+    std::ostringstream out;
+
+    renderHeader(out,
+                 "osrm_http_request_duration_seconds",
+                 "histogram",
+                 "Time from receiving a request to its reply, including the worker queue.");
+    for (std::size_t service_index = 0; service_index < NUMBER_OF_SERVICES; ++service_index)
+    {
+        const auto &histogram = latencies[service_index];
+        const auto service = SERVICES[service_index];
+
+        std::uint64_t cumulative = 0;
+        for (std::size_t bin = 0; bin < NUMBER_OF_LATENCY_BOUNDS; ++bin)
+        {
+            cumulative += histogram.bins[bin];
+            out << "osrm_http_request_duration_seconds_bucket{service=\"" << service
+                << "\",le=\"" << LATENCY_BOUNDS[bin] << "\"} " << cumulative << "\n";
+        }
+        // read the count after the bins, so +Inf is never below the finite bins
+        const std::uint64_t count = histogram.count;
+        out << "osrm_http_request_duration_seconds_bucket{service=\"" << service
+            << "\",le=\"+Inf\"} " << std::max(count, cumulative) << "\n";
+        out << "osrm_http_request_duration_seconds_sum{service=\"" << service << "\"} "
+            << histogram.sum_us * 1e-6 << "\n";
+        out << "osrm_http_request_duration_seconds_count{service=\"" << service << "\"} "
+            << std::max(count, cumulative) << "\n";
+    }
+
+    renderHeader(
+        out, "osrm_worker_queue_depth", "gauge", "Requests waiting for a routing worker.");
+    for (const auto &queue_depth : queue_depths)
+    {
+        out << "osrm_worker_queue_depth{service=\"" << queue_depth.first << "\"} "
+            << queue_depth.second << "\n";
+    }
+
+    renderHeader(out, "osrm_http_active_connections", "gauge", "Open client connections.");
+    out << "osrm_http_active_connections " << active_connections << "\n";
+
+    renderHeader(out, "osrm_http_response_bytes_total", "counter", "Bytes written to clients.");
+    out << "osrm_http_response_bytes_total " << bytes_out << "\n";
+
+    renderHeader(out,
+                 "osrm_http_coalesced_requests_total",
+                 "counter",
+                 "Requests answered with the reply of an identical request computed meanwhile.");
+    out << "osrm_http_coalesced_requests_total " << coalesced_requests << "\n";
+
+    renderHeader(out,
+                 "osrm_http_compression_input_bytes_total",
+                 "counter",
+                 "Bytes of compressed replies before compression.");
+    out << "osrm_http_compression_input_bytes_total " << compression_input_bytes << "\n";
+    renderHeader(out,
+                 "osrm_http_compression_output_bytes_total",
+                 "counter",
+                 "Bytes of compressed replies after compression.");
+    out << "osrm_http_compression_output_bytes_total " << compression_output_bytes << "\n";
+
+    const std::uint64_t compression_input = compression_input_bytes;
+    renderHeader(out,
+                 "osrm_http_compression_ratio",
+                 "gauge",
+                 "Compressed divided by uncompressed bytes of all compressed replies.");
+    out << "osrm_http_compression_ratio "
+        << (compression_input == 0 ? 1. : static_cast<double>(compression_output_bytes) /
+                                               compression_input)
+        << "\n";
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    renderHeader(out, "osrm_http_responses_total", "counter", "Replies by service and status.");
+    for (const auto &response : responses)
+    {
+        out << "osrm_http_responses_total{service=\"" << SERVICES[response.first.first]
+            << "\",code=\"" << response.first.second << "\"} " << response.second << "\n";
+    }
+
+#ifdef OSRM_ENABLE_SEARCH_COUNTERS
+    renderHeader(out, "osrm_search_settled_nodes_total", "counter", "Nodes settled by searches.");
+    out << "osrm_search_settled_nodes_total " << search_counters.settled_nodes << "\n";
+    renderHeader(
+        out, "osrm_search_heap_inserts_total", "counter", "Nodes inserted into query heaps.");
+    out << "osrm_search_heap_inserts_total " << search_counters.heap_inserts << "\n";
+    renderHeader(out,
+                 "osrm_search_heap_decreases_total",
+                 "counter",
+                 "Decreased keys of query heap nodes.");
+    out << "osrm_search_heap_decreases_total " << search_counters.heap_decreases << "\n";
+    renderHeader(out,
+                 "osrm_search_cells_entered_total",
+                 "counter",
+                 "MLD cells whose shortcuts were relaxed by level.");
+    for (std::size_t level = 0; level < util::SearchCounters::MAX_COUNTED_LEVELS; ++level)
+    {
+        out << "osrm_search_cells_entered_total{level=\"" << level << "\"} "
+            << search_counters.cells_entered[level] << "\n";
+    }
+    renderHeader(out,
+                 "osrm_search_unpacked_edges_total",
+                 "counter",
+                 "Base graph edges of unpacked paths.");
+    out << "osrm_search_unpacked_edges_total " << search_counters.unpacked_edges << "\n";
+#endif
+
+    for (const auto &gauge : gauges)
+    {
+        const auto &name = std::get<0>(gauge);
+        renderHeader(out, name.c_str(), "gauge", std::get<1>(gauge).c_str());
+        out << name << " " << std::get<2>(gauge)() << "\n";
+    }
+
+    return out.str();
+}
+}
+}
@@ -0,0 +1,51 @@
+#include "server/request_coalescer.hpp"
+
+#include <boost/assert.hpp>
+
+#include <utility>
+
+namespace osrm
+{
+namespace server
+{
+
+bool RequestCoalescer::Join(const std::string &key, Follower follower)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto flight = flights.find(key);
+    if (flight == flights.end())
+    {
+        flights.emplace(key, std::vector<Follower>());
+        return true;
+    }
+    flight->second.push_back(std::move(follower));
+    return false;
+}
+
+std::vector<RequestCoalescer::Follower> RequestCoalescer::Finish(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto flight = flights.find(key);
+    BOOST_ASSERT(flight != flights.end());
+    auto followers = std::move(flight->second);
+    flights.erase(flight);
+    return followers;
+}
+
+bool RequestCoalescer::Promote(const std::string &key, Follower &follower)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto flight = flights.find(key);
+    BOOST_ASSERT(flight != flights.end());
+    auto &followers = flight->second;
+    if (followers.empty())
+    {
+        flights.erase(flight);
+        return false;
+    }
+    follower = std::move(followers.front());
+    followers.erase(followers.begin());
+    return true;
+}
+}
+}
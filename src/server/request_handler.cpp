@@ -2,11 +2,14 @@
 #include "server/service_handler.hpp"
 
 #include "server/api/url_parser.hpp"
+#include "server/http/cache_validators.hpp"
 #include "server/http/reply.hpp"
 #include "server/http/request.hpp"
 
 #include "util/json_renderer.hpp"
 #include "util/log.hpp"
+#include "util/request_trace.hpp"
+#include "util/search_counters.hpp"
 #include "util/string_util.hpp"
 #include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
@@ -15,6 +18,7 @@
 #include "osrm/osrm.hpp"
 #include "util/json_container.hpp"
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/iostreams/copy.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
@@ -22,8 +26,11 @@
 #include <ctime>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <iterator>
+#include <random>
 #include <string>
 #include <thread>
 
@@ -32,13 +39,407 @@ namespace osrm
 namespace server
 {
 
+namespace
+{
+// JSON replies larger than this are sent in chunks to HTTP/1.1 clients
+const constexpr std::size_t REPLY_CHUNK_SIZE = 64 * 1024;
+
+const constexpr char BINARY_CONTENT_TYPE[] = "application/x-osrm-binary";
+
+// Prometheus scrapes /metrics
+const constexpr char METRICS_SERVICE[] = "metrics";
+
+// The memory of the blocks of the datasets as JSON
+const constexpr char MEMORY_SERVICE[] = "memory";
+
+// Requests with the same key get the same reply: the decoded URL, the body of POST requests and
+// the request headers the reply depends on, the compression is applied per connection later
+std::string coalescingKey(const http::request &current_request)
+{
+    std::string key;
+    util::URIDecode(current_request.uri, key);
+    if (current_request.method == "POST")
+    {
+        key += '\n';
+        key += current_request.body;
+    }
+    key += '\n';
+    key += boost::icontains(current_request.accept, BINARY_CONTENT_TYPE) ? 'b' : 'j';
+    key += current_request.chunked_encoding ? 'c' : 'f';
+    key += current_request.if_none_match;
+    return key;
+}
+
+// Coordinates are separated by ';' in the path of GET requests and the body of POST requests,
+// the list of a polyline counts as one
+std::size_t numberOfCoordinates(const http::request &current_request)
+{
+    std::string path;
+    util::URIDecode(current_request.uri, path);
+    path.erase(std::min(path.find('?'), path.size()));
+    const auto body_end = std::min(current_request.body.find('?'), current_request.body.size());
+    return 1 + std::count(path.begin(), path.end(), ';') +
+           std::count(current_request.body.begin(), current_request.body.begin() + body_end, ';');
+}
+
+// Clients accepting the binary format get it for services that support it as if the URL had
+// the .bin extension, an explicit extension in the URL takes precedence.
+void selectBinaryFormat(const http::request &current_request, api::ParsedURL &parsed_url)
+{
+    if (!boost::icontains(current_request.accept, BINARY_CONTENT_TYPE))
+        return;
+
+    if (parsed_url.service != "route" && parsed_url.service != "table" &&
+        parsed_url.service != "match")
+        return;
+
+    const auto options_begin = parsed_url.query.find('?');
+    const auto path = parsed_url.query.substr(0, options_begin);
+    if (boost::ends_with(path, ".json") || boost::ends_with(path, ".bin"))
+        return;
+
+    parsed_url.query.insert(path.size(), ".bin");
+}
+
+// Renders the result into the content or the chunks of the reply and sets its size
+void renderResult(const http::request &current_request,
+                  const std::string &service,
+                  const ServiceHandler::ResultT &result,
+                  http::reply &current_reply)
+{
+    util::TraceSpan rendering_span("rendering");
+    if (result.is<util::json::Object>())
+    {
+        current_reply.headers.emplace_back("Content-Type", "application/json; charset=UTF-8");
+        current_reply.headers.emplace_back("Content-Disposition",
+                                           "inline; filename=\"response.json\"");
+
+        if (current_request.chunked_encoding)
+        {
+            util::json::render(
+                current_reply.chunks, result.get<util::json::Object>(), REPLY_CHUNK_SIZE);
+            // small replies keep a fixed content length
+            if (current_reply.chunks.size() == 1)
+            {
+                current_reply.content.swap(current_reply.chunks.front());
+                current_reply.chunks.clear();
+            }
+        }
+        else
+        {
+            util::json::render(current_reply.content, result.get<util::json::Object>());
+        }
+    }
+    else
+    {
+        BOOST_ASSERT(result.is<std::string>());
+        current_reply.content.resize(result.get<std::string>().size());
+        std::copy(result.get<std::string>().cbegin(),
+                  result.get<std::string>().cend(),
+                  current_reply.content.begin());
+
+        // string results are either vector tiles or responses in the binary format
+        current_reply.headers.emplace_back("Content-Type",
+                                           service == "tile" ? "application/x-protobuf"
+                                                             : BINARY_CONTENT_TYPE);
+    }
+
+    rendering_span.Stop();
+
+    // set headers
+    if (current_reply.chunks.empty())
+    {
+        current_reply.headers.emplace_back("Content-Length",
+                                           std::to_string(current_reply.content.size()));
+    }
+    else
+    {
+        current_reply.headers.emplace_back("Transfer-Encoding", "chunked");
+    }
+}
+}
+
 void RequestHandler::RegisterServiceHandler(
     std::unique_ptr<ServiceHandlerInterface> service_handler_)
 {
     service_handler = std::move(service_handler_);
 }
 
-void RequestHandler::HandleRequest(const http::request &current_request, http::reply &current_reply)
+void RequestHandler::RegisterWorkerPool(std::unique_ptr<WorkerPool> worker_pool_)
+{
+    worker_pool = std::move(worker_pool_);
+}
+
+void RequestHandler::StopWorkerPool()
+{
+    if (worker_pool)
+    {
+        worker_pool->Stop();
+    }
+}
+
+bool RequestHandler::SampleTrace() const
+{
+    if (trace_sample_rate <= 0.)
+    {
+        return false;
+    }
+
+    // every thread draws from its own generator, the requests need no synchronization
+    static thread_local std::minstd_rand generator{std::random_device{}()};
+    return std::uniform_real_distribution<double>(0., 1.)(generator) < trace_sample_rate;
+}
+
+std::size_t RequestHandler::WarmUpThread(const std::vector<std::string> &urls)
+{
+    if (!service_handler)
+    {
+        return urls.size();
+    }
+    return service_handler->WarmUp(urls);
+}
+
+bool RequestHandler::WarmUpWorkers(const std::vector<std::string> &urls, std::size_t &failed)
+{
+    if (!worker_pool)
+    {
+        return false;
+    }
+
+    std::atomic<std::size_t> failed_urls{0};
+    // all workers run the same urls, so they fail the same
+    worker_pool->RunOnEveryWorker([&] { failed_urls = WarmUpThread(urls); });
+    failed = failed_urls;
+    return true;
+}
+
+std::shared_ptr<engine::CancellationToken>
+RequestHandler::ScheduleRequest(const http::request &current_request,
+                                http::reply &current_reply,
+                                std::function<void()> on_reply)
+{
+    // the service is the first path segment, e.g. /route/v1/driving/...
+    const auto service_begin = current_request.uri.find_first_not_of('/');
+    const auto service_end = current_request.uri.find_first_of("/?", service_begin);
+    const auto service =
+        service_begin == std::string::npos
+            ? std::string()
+            : current_request.uri.substr(service_begin, service_end - service_begin);
+
+    // answered on the I/O thread so that metrics can be scraped while all workers are busy
+    if (service == METRICS_SERVICE && service_end == std::string::npos)
+    {
+        HandleMetricsRequest(current_reply);
+        on_reply();
+        return nullptr;
+    }
+    if (service == MEMORY_SERVICE && service_end == std::string::npos)
+    {
+        HandleMemoryRequest(current_reply);
+        on_reply();
+        return nullptr;
+    }
+
+    const auto request_start = std::chrono::steady_clock::now();
+    const auto cancellation_token =
+        request_timeout > std::chrono::steady_clock::duration::zero()
+            ? std::make_shared<engine::CancellationToken>(request_start + request_timeout)
+            : std::make_shared<engine::CancellationToken>();
+
+    auto observed_on_reply = [this, service, request_start, &current_reply, on_reply] {
+        const std::chrono::duration<double> duration =
+            std::chrono::steady_clock::now() - request_start;
+        metrics.ObserveRequest(service, duration.count(), current_reply.status);
+        on_reply();
+    };
+
+    if (!coalesce_requests)
+    {
+        RunRequest(service,
+                   std::string(),
+                   current_request,
+                   current_reply,
+                   std::move(observed_on_reply),
+                   cancellation_token);
+        return cancellation_token;
+    }
+
+    auto key = coalescingKey(current_request);
+    auto follower = [this,
+                     service,
+                     key,
+                     &current_request,
+                     &current_reply,
+                     observed_on_reply,
+                     cancellation_token](const http::reply *leader_reply) {
+        if (leader_reply)
+        {
+            current_reply = *leader_reply;
+            observed_on_reply();
+        }
+        else
+        {
+            RunRequest(service,
+                       key,
+                       current_request,
+                       current_reply,
+                       observed_on_reply,
+                       cancellation_token);
+        }
+    };
+    const auto lead = coalescer.Join(key, std::move(follower));
+    if (lead)
+    {
+        RunRequest(service,
+                   key,
+                   current_request,
+                   current_reply,
+                   std::move(observed_on_reply),
+                   cancellation_token);
+    }
+    else
+    {
+        metrics.AddCoalescedRequest();
+    }
+    return cancellation_token;
+}
+
+void RequestHandler::RunRequest(const std::string &service,
+                                const std::string &key,
+                                const http::request &current_request,
+                                http::reply &current_reply,
+                                std::function<void()> observed_on_reply,
+                                std::shared_ptr<engine::CancellationToken> cancellation_token)
+{
+    // shares the reply with the requests that joined the flight before the reply is sent
+    auto finish = [this, key, &current_reply, observed_on_reply, cancellation_token] {
+        if (key.empty())
+        {
+            observed_on_reply();
+        }
+        else if (cancellation_token->IsCancelled())
+        {
+            // the other clients are still waiting, the first of them computes the reply itself
+            observed_on_reply();
+            RequestCoalescer::Follower follower;
+            if (coalescer.Promote(key, follower))
+            {
+                follower(nullptr);
+            }
+        }
+        else
+        {
+            for (const auto &follower : coalescer.Finish(key))
+            {
+                follower(&current_reply);
+            }
+            observed_on_reply();
+        }
+    };
+
+    if (!worker_pool)
+    {
+        HandleRequest(current_request, current_reply, cancellation_token);
+        finish();
+        return;
+    }
+
+    // shed once it waited longer than the queue wait budget of the worker pool
+    auto reject = [service, &current_reply, finish] {
+        util::Log(logWARNING) << "[server busy] shed request for service " << service;
+        current_reply = http::reply::stock_reply(http::reply::service_unavailable);
+        finish();
+    };
+    const auto queued = worker_pool->Post(
+        service,
+        [this, &current_request, &current_reply, finish, cancellation_token] {
+            // the client is gone or the deadline passed while the request was queued
+            if (cancellation_token->IsCancelled())
+            {
+                current_reply = http::reply::stock_reply(http::reply::service_unavailable);
+            }
+            else
+            {
+                HandleRequest(current_request, current_reply, cancellation_token);
+            }
+            finish();
+        },
+        GetPriority(service, current_request),
+        std::move(reject));
+
+    if (!queued)
+    {
+        util::Log(logWARNING) << "[server busy] rejected request for service " << service;
+        current_reply = http::reply::stock_reply(http::reply::service_unavailable);
+        finish();
+    }
+}
+
+WorkerPool::Priority RequestHandler::GetPriority(const std::string &service,
+                                                const http::request &current_request) const
+{
+    const auto is_batch = boost::iequals(current_request.priority, "batch") ||
+                          std::find(batch_services.begin(), batch_services.end(), service) !=
+                              batch_services.end() ||
+                          (batch_min_coordinates > 0 &&
+                           numberOfCoordinates(current_request) >= batch_min_coordinates);
+    return is_batch ? WorkerPool::Priority::Batch : WorkerPool::Priority::Interactive;
+}
+
+void RequestHandler::HandleMetricsRequest(http::reply &current_reply)
+{
+    const auto content =
+        metrics.Render(worker_pool ? worker_pool->QueueDepths() : Metrics::QueueDepths{});
+
+    current_reply.status = http::reply::ok;
+    current_reply.content.assign(content.begin(), content.end());
+    current_reply.headers.emplace_back("Content-Type", "text/plain; version=0.0.4");
+    current_reply.headers.emplace_back("Content-Length",
+                                       std::to_string(current_reply.content.size()));
+}
+
+void RequestHandler::HandleMemoryRequest(http::reply &current_reply)
+{
+    if (!service_handler)
+    {
+        current_reply = http::reply::stock_reply(http::reply::internal_server_error);
+        return;
+    }
+
+    util::json::Object report;
+    service_handler->Memory(report);
+
+    current_reply.status = http::reply::ok;
+    util::json::render(current_reply.content, report);
+    current_reply.headers.emplace_back("Content-Type", "application/json; charset=UTF-8");
+    current_reply.headers.emplace_back("Content-Length",
+                                       std::to_string(current_reply.content.size()));
+}
+
+void RequestHandler::AddCacheHeaders(const std::string &service,
+                                     const engine::DatasetVersion *version,
+                                     http::reply &current_reply) const
+{
+    if (version)
+    {
+        current_reply.headers.emplace_back("ETag", http::makeEntityTag(*version));
+        current_reply.headers.emplace_back("Last-Modified",
+                                           http::formatHTTPDate(version->loaded_at));
+        // the format and the compression of the reply are negotiated
+        current_reply.headers.emplace_back("Vary", "Accept, Accept-Encoding");
+    }
+
+    const auto cache_control_iter = cache_control.find(service);
+    if (cache_control_iter != cache_control.end())
+    {
+        current_reply.headers.emplace_back("Cache-Control", cache_control_iter->second);
+    }
+}
+
+void RequestHandler::HandleRequest(
+    const http::request &current_request,
+    http::reply &current_reply,
+    std::shared_ptr<const engine::CancellationToken> cancellation_token)
 {
     if (!service_handler)
     {
@@ -53,41 +454,87 @@ void RequestHandler::HandleRequest(const http::request &current_request, http::r
     try
     {
         TIMER_START(request_duration);
+        const util::TraceScope trace_scope(current_request.trace.get());
+        util::TraceSpan parse_span("parse_url");
         std::string request_string;
         util::URIDecode(current_request.uri, request_string);
 
         util::Log(logDEBUG) << "[req][" << tid << "] " << request_string;
 
-        auto api_iterator = request_string.begin();
-        auto maybe_parsed_url = api::parseURL(api_iterator, request_string.end());
+        // POST requests carry what follows the profile of GET requests in the body, e.g. the
+        // coordinates and options of large table and match queries without URL length limits.
+        // The body does not need to be percent-encoded.
+        const bool has_body = current_request.method == "POST" && !current_request.body.empty();
+        std::string post_string;
+        if (has_body)
+        {
+            post_string.reserve(request_string.size() + 1 + current_request.body.size());
+            post_string = request_string;
+            if (post_string.empty() || post_string.back() != '/')
+                post_string.push_back('/');
+            post_string += current_request.body;
+        }
+        std::string &url_string = has_body ? post_string : request_string;
+
+        auto api_iterator = url_string.begin();
+        auto maybe_parsed_url = api::parseURL(api_iterator, url_string.end());
+        parse_span.Stop();
         ServiceHandler::ResultT result;
+        std::string service;
+        engine::DatasetVersion dataset_version;
+        bool has_dataset_version = false;
 
         // check if the was an error with the request
-        if (maybe_parsed_url && api_iterator == request_string.end())
+        if (maybe_parsed_url && api_iterator == url_string.end())
         {
 
-            const engine::Status status =
-                service_handler->RunQuery(*std::move(maybe_parsed_url), result);
-            if (status != engine::Status::Ok)
+            service = maybe_parsed_url->service;
+            selectBinaryFormat(current_request, *maybe_parsed_url);
+
+            // taken before the query, which can only run on the same or newer data
+            has_dataset_version =
+                cache_validators && current_request.method == "GET" &&
+                service_handler->GetDatasetVersion(maybe_parsed_url->profile, dataset_version);
+            if (has_dataset_version && !current_request.if_none_match.empty() &&
+                http::matchesEntityTag(current_request.if_none_match,
+                                       http::makeEntityTag(dataset_version)))
             {
-                // 4xx bad request return code
-                current_reply.status = http::reply::bad_request;
+                current_reply.status = http::reply::not_modified;
             }
             else
             {
-                BOOST_ASSERT(status == engine::Status::Ok);
+#ifdef OSRM_ENABLE_SEARCH_COUNTERS
+                util::threadSearchCounters() = util::SearchCounters{};
+#endif
+                util::TraceSpan query_span("query");
+                const engine::Status status = service_handler->RunQuery(
+                    *std::move(maybe_parsed_url), result, std::move(cancellation_token));
+                query_span.Stop();
+                if (status == engine::Status::Timeout)
+                {
+                    current_reply.status = http::reply::service_unavailable;
+                }
+                else if (status != engine::Status::Ok)
+                {
+                    // 4xx bad request return code
+                    current_reply.status = http::reply::bad_request;
+                }
+                else
+                {
+                    BOOST_ASSERT(status == engine::Status::Ok);
+                }
             }
         }
         else
         {
-            const auto position = std::distance(request_string.begin(), api_iterator);
+            const auto position = std::distance(url_string.begin(), api_iterator);
             BOOST_ASSERT(position >= 0);
             const auto context_begin =
-                request_string.begin() + ((position < 3) ? 0 : (position - 3UL));
-            BOOST_ASSERT(context_begin >= request_string.begin());
-            const auto context_end = request_string.begin() +
-                                     std::min<std::size_t>(position + 3UL, request_string.size());
-            BOOST_ASSERT(context_end <= request_string.end());
+                url_string.begin() + ((position < 3) ? 0 : (position - 3UL));
+            BOOST_ASSERT(context_begin >= url_string.begin());
+            const auto context_end =
+                url_string.begin() + std::min<std::size_t>(position + 3UL, url_string.size());
+            BOOST_ASSERT(context_end <= url_string.end());
             std::string context(context_begin, context_end);
 
             current_reply.status = http::reply::bad_request;
@@ -99,32 +546,21 @@ void RequestHandler::HandleRequest(const http::request &current_request, http::r
         }
 
         current_reply.headers.emplace_back("Access-Control-Allow-Origin", "*");
-        current_reply.headers.emplace_back("Access-Control-Allow-Methods", "GET");
+        current_reply.headers.emplace_back("Access-Control-Allow-Methods", "GET, POST");
         current_reply.headers.emplace_back("Access-Control-Allow-Headers",
                                            "X-Requested-With, Content-Type");
-        if (result.is<util::json::Object>())
+        if (current_reply.status == http::reply::ok ||
+            current_reply.status == http::reply::not_modified)
         {
-            current_reply.headers.emplace_back("Content-Type", "application/json; charset=UTF-8");
-            current_reply.headers.emplace_back("Content-Disposition",
-                                               "inline; filename=\"response.json\"");
-
-            util::json::render(current_reply.content, result.get<util::json::Object>());
+            AddCacheHeaders(service, has_dataset_version ? &dataset_version : nullptr,
+                            current_reply);
         }
-        else
+        // a 304 reply has no body
+        if (current_reply.status != http::reply::not_modified)
         {
-            BOOST_ASSERT(result.is<std::string>());
-            current_reply.content.resize(result.get<std::string>().size());
-            std::copy(result.get<std::string>().cbegin(),
-                      result.get<std::string>().cend(),
-                      current_reply.content.begin());
-
-            current_reply.headers.emplace_back("Content-Type", "application/x-protobuf");
+            renderResult(current_request, service, result, current_reply);
         }
 
-        // set headers
-        current_reply.headers.emplace_back("Content-Length",
-                                           std::to_string(current_reply.content.size()));
-
         if (!std::getenv("DISABLE_ACCESS_LOGGING"))
         {
             // deactivated as GCC apparently does not implement that, not even in 4.9
@@ -144,20 +580,32 @@ void RequestHandler::HandleRequest(const http::request &current_request, http::r
             ltime = time(nullptr);
             time_stamp = localtime(&ltime);
             // log timestamp
-            util::Log() << (time_stamp->tm_mday < 10 ? "0" : "") << time_stamp->tm_mday << "-"
-                        << (time_stamp->tm_mon + 1 < 10 ? "0" : "") << (time_stamp->tm_mon + 1)
-                        << "-" << 1900 + time_stamp->tm_year << " "
-                        << (time_stamp->tm_hour < 10 ? "0" : "") << time_stamp->tm_hour << ":"
-                        << (time_stamp->tm_min < 10 ? "0" : "") << time_stamp->tm_min << ":"
-                        << (time_stamp->tm_sec < 10 ? "0" : "") << time_stamp->tm_sec << " "
-                        << TIMER_MSEC(request_duration) << "ms "
-                        << current_request.endpoint.to_string() << " " << current_request.referrer
-                        << (0 == current_request.referrer.length() ? "- " : " ")
-                        << current_request.agent
-                        << (0 == current_request.agent.length() ? "- " : " ")
-                        << current_reply.status << " " //
-                        << request_string;
+            util::Log access_log;
+            access_log << (time_stamp->tm_mday < 10 ? "0" : "") << time_stamp->tm_mday << "-"
+                       << (time_stamp->tm_mon + 1 < 10 ? "0" : "") << (time_stamp->tm_mon + 1)
+                       << "-" << 1900 + time_stamp->tm_year << " "
+                       << (time_stamp->tm_hour < 10 ? "0" : "") << time_stamp->tm_hour << ":"
+                       << (time_stamp->tm_min < 10 ? "0" : "") << time_stamp->tm_min << ":"
+                       << (time_stamp->tm_sec < 10 ? "0" : "") << time_stamp->tm_sec << " "
+                       << TIMER_MSEC(request_duration) << "ms "
+                       << current_request.endpoint.to_string() << " " << current_request.referrer
+                       << (0 == current_request.referrer.length() ? "- " : " ")
+                       << current_request.agent
+                       << (0 == current_request.agent.length() ? "- " : " ")
+                       << current_reply.status << " " //
+                       << request_string;
+            // bodies of POST requests are too large to be logged
+            if (has_body)
+            {
+                access_log << " (" << current_request.body.size() << " bytes of POST data)";
+            }
+#ifdef OSRM_ENABLE_SEARCH_COUNTERS
+            access_log << " " << util::threadSearchCounters();
+#endif
         }
+#ifdef OSRM_ENABLE_SEARCH_COUNTERS
+        metrics.AddSearchCounters(util::threadSearchCounters());
+#endif
     }
     catch (const std::exception &e)
     {
@@ -6,6 +6,8 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 
+#include <algorithm>
+#include <iterator>
 #include <string>
 
 namespace osrm
@@ -13,26 +15,81 @@ namespace osrm
 namespace server
 {
 
+namespace
+{
+// Bodies of POST requests hold the coordinates of large table and match queries
+const constexpr std::size_t MAX_BODY_SIZE = 64 * 1024 * 1024;
+}
+
 RequestParser::RequestParser()
     : state(internal_state::method_start), current_header({"", ""}),
-      selected_compression(http::no_compression)
+      selected_compression(http::no_compression), http_version_major(0), http_version_minor(0),
+      content_length(0), expect_continue(false)
 {
 }
 
-std::tuple<RequestParser::RequestStatus, http::compression_type>
+void RequestParser::reset()
+{
+    state = internal_state::method_start;
+    current_header.clear();
+    selected_compression = http::no_compression;
+    http_version_major = 0;
+    http_version_minor = 0;
+    connection_header.clear();
+    content_length = 0;
+    expect_continue = false;
+}
+
+bool RequestParser::take_expected_continue()
+{
+    const bool expected = expect_continue && state == internal_state::body;
+    expect_continue = false;
+    return expected;
+}
+
+std::tuple<RequestParser::RequestStatus, http::compression_type, char *>
 RequestParser::parse(http::request &current_request, char *begin, char *end)
 {
     while (begin != end)
     {
-        RequestStatus result = consume(current_request, *begin++);
+        RequestStatus result;
+        if (state == internal_state::body)
+        {
+            // the body is not parsed, copy as much of it as there is
+            const auto length = std::min<std::size_t>(
+                content_length - current_request.body.size(), std::distance(begin, end));
+            current_request.body.append(begin, length);
+            begin += length;
+            result = current_request.body.size() == content_length ? RequestStatus::valid
+                                                                   : RequestStatus::indeterminate;
+        }
+        else
+        {
+            result = consume(current_request, *begin++);
+        }
+
+        if (result == RequestStatus::valid)
+        {
+            const bool is_http_1_1 =
+                http_version_major > 1 || (http_version_major == 1 && http_version_minor >= 1);
+            current_request.chunked_encoding = is_http_1_1;
+
+            // HTTP/1.1 connections are persistent unless the client asks to close them
+            if (boost::icontains(connection_header, "close"))
+                current_request.keep_alive = false;
+            else if (boost::icontains(connection_header, "keep-alive"))
+                current_request.keep_alive = true;
+            else
+                current_request.keep_alive = is_http_1_1;
+        }
         if (result != RequestStatus::indeterminate)
         {
-            return std::make_tuple(result, selected_compression);
+            return std::make_tuple(result, selected_compression, begin);
         }
     }
     RequestStatus result = RequestStatus::indeterminate;
 
-    return std::make_tuple(result, selected_compression);
+    return std::make_tuple(result, selected_compression, begin);
 }
 
 RequestParser::RequestStatus RequestParser::consume(http::request &current_request,
@@ -46,6 +103,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
             return RequestStatus::invalid;
         }
         state = internal_state::method;
+        current_request.method.push_back(input);
         return RequestStatus::indeterminate;
     case internal_state::method:
         if (input == ' ')
@@ -57,6 +115,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         {
             return RequestStatus::invalid;
         }
+        current_request.method.push_back(input);
         return RequestStatus::indeterminate;
     case internal_state::uri_start:
         if (is_CTL(input))
@@ -116,6 +175,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
     case internal_state::http_version_major_start:
         if (is_digit(input))
         {
+            http_version_major = input - '0';
             state = internal_state::http_version_major;
             return RequestStatus::indeterminate;
         }
@@ -128,12 +188,14 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         }
         if (is_digit(input))
         {
+            http_version_major = http_version_major * 10 + (input - '0');
             return RequestStatus::indeterminate;
         }
         return RequestStatus::invalid;
     case internal_state::http_version_minor_start:
         if (is_digit(input))
         {
+            http_version_minor = input - '0';
             state = internal_state::http_version_minor;
             return RequestStatus::indeterminate;
         }
@@ -146,6 +208,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         }
         if (is_digit(input))
         {
+            http_version_minor = http_version_minor * 10 + (input - '0');
             return RequestStatus::indeterminate;
         }
         return RequestStatus::invalid;
@@ -180,6 +243,55 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
             current_request.agent = current_header.value;
         }
 
+        if (boost::iequals(current_header.name, "Accept"))
+        {
+            current_request.accept = current_header.value;
+        }
+
+        if (boost::iequals(current_header.name, "X-OSRM-Priority"))
+        {
+            current_request.priority = current_header.value;
+        }
+
+        if (boost::iequals(current_header.name, "If-None-Match"))
+        {
+            current_request.if_none_match = current_header.value;
+        }
+
+        if (boost::iequals(current_header.name, "Connection"))
+        {
+            connection_header = current_header.value;
+        }
+
+        if (boost::iequals(current_header.name, "Content-Length"))
+        {
+            const auto &value = current_header.value;
+            if (value.empty() || value.size() > 9 ||
+                !std::all_of(value.begin(), value.end(), [this](const char character) {
+                    return is_digit(character);
+                }))
+            {
+                return RequestStatus::invalid;
+            }
+            content_length = std::stoul(value);
+            if (content_length > MAX_BODY_SIZE)
+            {
+                return RequestStatus::invalid;
+            }
+        }
+
+        // only bodies with a content length are supported
+        if (boost::iequals(current_header.name, "Transfer-Encoding") &&
+            !boost::iequals(current_header.value, "identity"))
+        {
+            return RequestStatus::invalid;
+        }
+
+        if (boost::iequals(current_header.name, "Expect"))
+        {
+            expect_continue = boost::icontains(current_header.value, "100-continue");
+        }
+
         if (input == '\r')
         {
             state = internal_state::expecting_newline_3;
@@ -247,8 +359,22 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
             return RequestStatus::indeterminate;
         }
         return RequestStatus::invalid;
-    default: // expecting_newline_3
-        return input == '\n' ? RequestStatus::valid : RequestStatus::invalid;
+    case internal_state::expecting_newline_3:
+        if (input != '\n')
+        {
+            return RequestStatus::invalid;
+        }
+        if (content_length == 0)
+        {
+            return RequestStatus::valid;
+        }
+        state = internal_state::body;
+        current_request.body.reserve(content_length);
+        return RequestStatus::indeterminate;
+    default: // body
+        current_request.body.push_back(input);
+        return current_request.body.size() == content_length ? RequestStatus::valid
+                                                             : RequestStatus::indeterminate;
     }
 }
 
@@ -0,0 +1,101 @@
+#include "server/service/batch_service.hpp"
+#include "server/service/utils.hpp"
+
+#include "server/api/parameters_parser.hpp"
+#include "engine/api/batch_parameters.hpp"
+
+#include "util/json_container.hpp"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+
+namespace osrm
+{
+namespace server
+{
+namespace service
+{
+namespace
+{
+std::string getWrongOptionHelp(const engine::api::BatchParameters &parameters)
+{
+    using AnnotationsType = engine::api::RouteParameters::AnnotationsType;
+
+    std::string help;
+
+    const auto coord_size = parameters.coordinates.size();
+
+    const bool param_size_mismatch =
+        constrainParamSize(
+            PARAMETER_SIZE_MISMATCH_MSG, "hints", parameters.hints, coord_size, help) ||
+        constrainParamSize(
+            PARAMETER_SIZE_MISMATCH_MSG, "bearings", parameters.bearings, coord_size, help) ||
+        constrainParamSize(
+            PARAMETER_SIZE_MISMATCH_MSG, "radiuses", parameters.radiuses, coord_size, help) ||
+        constrainParamSize(
+            PARAMETER_SIZE_MISMATCH_MSG, "approaches", parameters.approaches, coord_size, help);
+
+    if (param_size_mismatch)
+    {
+        return help;
+    }
+
+    if (parameters.steps || parameters.alternatives || parameters.number_of_alternatives > 0 ||
+        parameters.annotations || parameters.annotations_type != AnnotationsType::None)
+    {
+        help = "Steps, alternatives and annotations are not supported.";
+    }
+    else if (parameters.pairs.empty() && parameters.coordinates.size() % 2 != 0)
+    {
+        help = "Number of coordinates needs to be even without pairs.";
+    }
+    else if (std::any_of(parameters.pairs.begin(),
+                         parameters.pairs.end(),
+                         [coord_size](const engine::api::BatchParameters::Pair &pair) {
+                             return pair.first >= coord_size || pair.second >= coord_size;
+                         }))
+    {
+        help = "Pairs need to refer to coordinates.";
+    }
+
+    return help;
+}
+} // anon. ns
+
+engine::Status
+BatchService::RunQuery(std::size_t prefix_length,
+                       std::string &query,
+                       ResultT &result,
+                       std::shared_ptr<const engine::CancellationToken> cancellation_token)
+{
+    result = util::json::Object();
+    auto &json_result = result.get<util::json::Object>();
+
+    auto query_iterator = query.begin();
+    auto parameters =
+        api::parseParameters<engine::api::BatchParameters>(query_iterator, query.end());
+    if (!parameters || query_iterator != query.end())
+    {
+        const auto position = std::distance(query.begin(), query_iterator);
+        json_result.values["code"] = "InvalidQuery";
+        json_result.values["message"] =
+            "Query string malformed close to position " + std::to_string(prefix_length + position);
+        return engine::Status::Error;
+    }
+    BOOST_ASSERT(parameters);
+
+    if (!parameters->IsValid())
+    {
+        json_result.values["code"] = "InvalidOptions";
+        json_result.values["message"] = getWrongOptionHelp(*parameters);
+        return engine::Status::Error;
+    }
+    BOOST_ASSERT(parameters->IsValid());
+
+    parameters->cancellation_token = std::move(cancellation_token);
+    return BaseService::routing_machine.Batch(*parameters, json_result);
+}
+}
+}
+}
@@ -37,12 +37,22 @@ std::string getWrongOptionHelp(const engine::api::MatchParameters &parameters)
         help = "Number of coordinates needs to be at least two.";
     }
 
+    if (!param_size_mismatch &&
+        parameters.format == engine::api::BaseParameters::OutputFormatType::Binary &&
+        (parameters.steps || parameters.annotations))
+    {
+        help = "Steps and annotations are not supported by the binary format.";
+    }
+
     return help;
 }
 } // anon. ns
 
 engine::Status
-MatchService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+MatchService::RunQuery(std::size_t prefix_length,
+                       std::string &query,
+                       ResultT &result,
+                       std::shared_ptr<const engine::CancellationToken> cancellation_token)
 {
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
@@ -68,7 +78,12 @@ MatchService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &r
     }
     BOOST_ASSERT(parameters->IsValid());
 
-    return BaseService::routing_machine.Match(*parameters, json_result);
+    if (parameters->format == engine::api::BaseParameters::OutputFormatType::Binary)
+    {
+        result = std::string();
+    }
+    parameters->cancellation_token = std::move(cancellation_token);
+    return BaseService::routing_machine.Match(*parameters, result);
 }
 }
 }
@@ -36,7 +36,10 @@ std::string getWrongOptionHelp(const engine::api::NearestParameters &parameters)
 } // anon. ns
 
 engine::Status
-NearestService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+NearestService::RunQuery(std::size_t prefix_length,
+                         std::string &query,
+                         ResultT &result,
+                         std::shared_ptr<const engine::CancellationToken> cancellation_token)
 {
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
@@ -62,6 +65,7 @@ NearestService::RunQuery(std::size_t prefix_length, std::string &query, ResultT
     }
     BOOST_ASSERT(parameters->IsValid());
 
+    parameters->cancellation_token = std::move(cancellation_token);
     return BaseService::routing_machine.Nearest(*parameters, json_result);
 }
 }
@@ -56,12 +56,22 @@ std::string getWrongOptionHelp(const engine::api::TableParameters &parameters)
         help = "Number of coordinates needs to be at least two.";
     }
 
+    if (!param_size_mismatch &&
+        parameters.format == engine::api::BaseParameters::OutputFormatType::Binary &&
+        parameters.annotations != engine::api::TableParameters::AnnotationsType::Duration)
+    {
+        help = "Distances are not supported by the binary format.";
+    }
+
     return help;
 }
 } // anon. ns
 
 engine::Status
-TableService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+TableService::RunQuery(std::size_t prefix_length,
+                       std::string &query,
+                       ResultT &result,
+                       std::shared_ptr<const engine::CancellationToken> cancellation_token)
 {
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
@@ -87,7 +97,12 @@ TableService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &r
     }
     BOOST_ASSERT(parameters->IsValid());
 
-    return BaseService::routing_machine.Table(*parameters, json_result);
+    if (parameters->format == engine::api::BaseParameters::OutputFormatType::Binary)
+    {
+        result = std::string();
+    }
+    parameters->cancellation_token = std::move(cancellation_token);
+    return BaseService::routing_machine.Table(*parameters, result);
 }
 }
 }
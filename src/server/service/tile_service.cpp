@@ -15,7 +15,11 @@ namespace server
 namespace service
 {
 
-engine::Status TileService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+engine::Status
+TileService::RunQuery(std::size_t prefix_length,
+                      std::string &query,
+                      ResultT &result,
+                      std::shared_ptr<const engine::CancellationToken>)
 {
     auto query_iterator = query.begin();
     auto parameters =
@@ -41,7 +41,11 @@ std::string getWrongOptionHelp(const engine::api::TripParameters &parameters)
 }
 } // anon. ns
 
-engine::Status TripService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+engine::Status
+TripService::RunQuery(std::size_t prefix_length,
+                      std::string &query,
+                      ResultT &result,
+                      std::shared_ptr<const engine::CancellationToken> cancellation_token)
 {
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
@@ -69,6 +73,7 @@ engine::Status TripService::RunQuery(std::size_t prefix_length, std::string &que
     }
     BOOST_ASSERT(parameters->IsValid());
 
+    parameters->cancellation_token = std::move(cancellation_token);
     return BaseService::routing_machine.Trip(*parameters, json_result);
 }
 }
@@ -1,5 +1,7 @@
 #include "server/service_handler.hpp"
 
+#include "server/service/batch_service.hpp"
+#include "server/service/isochrone_service.hpp"
 #include "server/service/match_service.hpp"
 #include "server/service/nearest_service.hpp"
 #include "server/service/route_service.hpp"
@@ -8,6 +10,9 @@
 #include "server/service/trip_service.hpp"
 
 #include "server/api/parsed_url.hpp"
+#include "server/api/url_parser.hpp"
+
+#include "osrm/engine_config.hpp"
 #include "util/json_util.hpp"
 
 #include <memory>
@@ -16,7 +21,21 @@ namespace osrm
 {
 namespace server
 {
-ServiceHandler::ServiceHandler(osrm::EngineConfig &config) : routing_machine(config)
+ServiceHandler::ServiceHandler(osrm::EngineConfig &config)
+{
+    datasets.emplace(std::string(), std::make_unique<Dataset>(config));
+}
+
+ServiceHandler::ServiceHandler(
+    std::vector<std::pair<std::string, osrm::EngineConfig>> &profile_configs)
+{
+    for (auto &profile_config : profile_configs)
+    {
+        datasets.emplace(profile_config.first, std::make_unique<Dataset>(profile_config.second));
+    }
+}
+
+ServiceHandler::Dataset::Dataset(osrm::EngineConfig &config) : routing_machine(config)
 {
     service_map["route"] = std::make_unique<service::RouteService>(routing_machine);
     service_map["table"] = std::make_unique<service::TableService>(routing_machine);
@@ -24,11 +43,37 @@ ServiceHandler::ServiceHandler(osrm::EngineConfig &config) : routing_machine(con
     service_map["trip"] = std::make_unique<service::TripService>(routing_machine);
     service_map["match"] = std::make_unique<service::MatchService>(routing_machine);
     service_map["tile"] = std::make_unique<service::TileService>(routing_machine);
+    service_map["batch"] = std::make_unique<service::BatchService>(routing_machine);
+    service_map["isochrone"] = std::make_unique<service::IsochroneService>(routing_machine);
 }
 
-engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
-                                        service::BaseService::ResultT &result)
+ServiceHandler::Dataset *ServiceHandler::FindDataset(const std::string &profile)
 {
+    auto dataset_iter = datasets.find(profile);
+    if (dataset_iter == datasets.end())
+    {
+        // the dataset of the single config serves all profiles
+        dataset_iter = datasets.find(std::string());
+    }
+    return dataset_iter == datasets.end() ? nullptr : dataset_iter->second.get();
+}
+
+engine::Status
+ServiceHandler::RunQuery(api::ParsedURL parsed_url,
+                         service::BaseService::ResultT &result,
+                         std::shared_ptr<const engine::CancellationToken> cancellation_token)
+{
+    auto *dataset = FindDataset(parsed_url.profile);
+    if (!dataset)
+    {
+        result = util::json::Object();
+        auto &json_result = result.get<util::json::Object>();
+        json_result.values["code"] = "InvalidProfile";
+        json_result.values["message"] = "Profile " + parsed_url.profile + " not found!";
+        return engine::Status::Error;
+    }
+    auto &service_map = dataset->service_map;
+
     const auto &service_iter = service_map.find(parsed_url.service);
     if (service_iter == service_map.end())
     {
@@ -49,7 +94,59 @@ engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
         return engine::Status::Error;
     }
 
-    return service->RunQuery(parsed_url.prefix_length, parsed_url.query, result);
+    return service->RunQuery(
+        parsed_url.prefix_length, parsed_url.query, result, std::move(cancellation_token));
+}
+
+std::size_t ServiceHandler::WarmUp(const std::vector<std::string> &urls)
+{
+    for (const auto &dataset : datasets)
+    {
+        dataset.second->routing_machine.WarmUp();
+    }
+
+    std::size_t failed = 0;
+    for (const auto &url : urls)
+    {
+        const auto parsed_url = api::parseURL(url);
+        ResultT result;
+        if (!parsed_url || RunQuery(*parsed_url, result, {}) != engine::Status::Ok)
+        {
+            ++failed;
+        }
+    }
+    return failed;
+}
+
+void ServiceHandler::Memory(util::json::Object &result)
+{
+    const auto single_dataset = datasets.find(std::string());
+    if (single_dataset != datasets.end())
+    {
+        single_dataset->second->routing_machine.Memory(result);
+        return;
+    }
+
+    util::json::Object profiles;
+    for (const auto &dataset : datasets)
+    {
+        util::json::Object report;
+        dataset.second->routing_machine.Memory(report);
+        profiles.values[dataset.first] = std::move(report);
+    }
+    result.values["profiles"] = std::move(profiles);
+}
+
+bool ServiceHandler::GetDatasetVersion(const std::string &profile,
+                                       engine::DatasetVersion &version)
+{
+    const auto *dataset = FindDataset(profile);
+    if (!dataset)
+    {
+        return false;
+    }
+    version = dataset->routing_machine.GetDatasetVersion();
+    return true;
 }
 }
 }
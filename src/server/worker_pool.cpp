@@ -0,0 +1,267 @@
+#include "server/worker_pool.hpp"
+
+#include "util/log.hpp"
+#include "util/numa.hpp"
+
+#include <boost/assert.hpp>
+
+#include <exception>
+#include <utility>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace
+{
+// Service names come from the request URI, so unknown services share the first queue
+// instead of creating a queue per distinct name.
+const constexpr std::size_t MAX_NUMBER_OF_QUEUES = 16;
+}
+
+WorkerPool::WorkerPool(const unsigned number_of_threads,
+                       const std::size_t max_queue_size,
+                       const bool pin_threads,
+                       const Clock::duration max_queue_wait)
+    : max_queue_size(max_queue_size), max_queue_wait(max_queue_wait),
+      max_running_per_service(number_of_threads > 1 ? number_of_threads - 1 : 1),
+      max_running_batch(number_of_threads > 1 ? number_of_threads - 1 : 1), queues(1)
+{
+    queues.front().service = "other";
+    BOOST_ASSERT(number_of_threads > 0);
+    for (unsigned i = 0; i < number_of_threads; ++i)
+    {
+        workers.emplace_back([this, i, pin_threads] {
+            if (pin_threads)
+            {
+                util::PinThreadToNumaNode(i % util::GetNumaNodes().size());
+            }
+            Work();
+        });
+    }
+}
+
+WorkerPool::~WorkerPool() { Stop(); }
+
+bool WorkerPool::Post(const std::string &service,
+                      Task task,
+                      const Priority priority,
+                      Task reject)
+{
+    const auto now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped)
+        {
+            return false;
+        }
+
+        auto queue_index = queue_indices.find(service);
+        if (queue_index == queue_indices.end())
+        {
+            const auto index = queues.size() < MAX_NUMBER_OF_QUEUES ? queues.size() : 0;
+            if (index != 0)
+            {
+                queues.emplace_back();
+                queues.back().service = service;
+            }
+            queue_index = queue_indices.emplace(service, index).first;
+        }
+
+        auto &queue = queues[queue_index->second];
+        std::size_t queued_tasks = 0;
+        for (const auto &tasks : queue.tasks)
+        {
+            queued_tasks += tasks.size();
+        }
+        if (queued_tasks >= max_queue_size)
+        {
+            return false;
+        }
+
+        // the queue is not drained in time, so the new task would wait too long as well
+        auto &tasks = queue.tasks[static_cast<std::size_t>(priority)];
+        if (max_queue_wait > Clock::duration::zero() && !tasks.empty() &&
+            now - tasks.front().queued > max_queue_wait)
+        {
+            return false;
+        }
+        tasks.push_back(QueuedTask{std::move(task), std::move(reject), now, priority});
+    }
+    condition.notify_one();
+    return true;
+}
+
+void WorkerPool::RunOnEveryWorker(Task task)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    // one task at a time, the workers only remember the last generation they ran
+    every_worker_condition.wait(lock, [this] { return stopped || pending_workers == 0; });
+    if (stopped)
+    {
+        return;
+    }
+
+    every_worker_task = std::move(task);
+    ++every_worker_generation;
+    pending_workers = workers.size();
+    condition.notify_all();
+
+    every_worker_condition.wait(lock, [this] { return stopped || pending_workers == 0; });
+    every_worker_task = nullptr;
+    // lets the next caller of RunOnEveryWorker in
+    every_worker_condition.notify_all();
+}
+
+void WorkerPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped)
+        {
+            return;
+        }
+        stopped = true;
+        for (auto &queue : queues)
+        {
+            for (auto &tasks : queue.tasks)
+            {
+                tasks.clear();
+            }
+        }
+    }
+    condition.notify_all();
+    every_worker_condition.notify_all();
+
+    for (auto &worker : workers)
+    {
+        if (worker.joinable() && worker.get_id() != std::this_thread::get_id())
+        {
+            worker.join();
+        }
+    }
+}
+
+std::vector<std::pair<std::string, std::size_t>> WorkerPool::QueueDepths()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, std::size_t>> depths;
+    depths.reserve(queues.size());
+    for (const auto &queue : queues)
+    {
+        std::size_t depth = 0;
+        for (const auto &tasks : queue.tasks)
+        {
+            depth += tasks.size();
+        }
+        depths.emplace_back(queue.service, depth);
+    }
+    return depths;
+}
+
+// Needs the lock, takes the oldest task of the next queue in round-robin order that has not
+// reached its limit of running tasks. Interactive tasks of all queues come before batch tasks.
+bool WorkerPool::PopTask(QueuedTask &task, std::size_t &queue_index)
+{
+    for (const auto priority : {Priority::Interactive, Priority::Batch})
+    {
+        if (priority == Priority::Batch && running_batch >= max_running_batch)
+        {
+            return false;
+        }
+
+        for (std::size_t offset = 0; offset < queues.size(); ++offset)
+        {
+            const auto index = (next_queue + offset) % queues.size();
+            auto &queue = queues[index];
+            auto &tasks = queue.tasks[static_cast<std::size_t>(priority)];
+            if (!tasks.empty() && queue.running < max_running_per_service)
+            {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                ++queue.running;
+                if (priority == Priority::Batch)
+                {
+                    ++running_batch;
+                }
+                queue_index = index;
+                next_queue = index + 1;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void WorkerPool::Work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    std::size_t seen_generation = 0;
+    while (true)
+    {
+        QueuedTask queued_task;
+        std::size_t queue_index;
+        condition.wait(lock, [&] {
+            return stopped || seen_generation != every_worker_generation ||
+                   PopTask(queued_task, queue_index);
+        });
+        if (stopped)
+        {
+            return;
+        }
+
+        if (seen_generation != every_worker_generation)
+        {
+            seen_generation = every_worker_generation;
+            auto task = every_worker_task;
+            lock.unlock();
+            try
+            {
+                task();
+            }
+            catch (const std::exception &e)
+            {
+                util::Log(logWARNING) << "[worker pool] " << e.what();
+            }
+            task = nullptr;
+            lock.lock();
+
+            if (--pending_workers == 0)
+            {
+                every_worker_condition.notify_all();
+            }
+            continue;
+        }
+
+        lock.unlock();
+        const auto priority = queued_task.priority;
+        const auto expired = max_queue_wait > Clock::duration::zero() &&
+                             Clock::now() - queued_task.queued > max_queue_wait;
+        auto &task = expired ? queued_task.reject : queued_task.task;
+        try
+        {
+            if (task)
+            {
+                task();
+            }
+        }
+        catch (const std::exception &e)
+        {
+            util::Log(logWARNING) << "[worker pool] " << e.what();
+        }
+        // release captured state before taking the lock again
+        queued_task = QueuedTask{};
+        lock.lock();
+
+        --queues[queue_index].running;
+        if (priority == Priority::Batch)
+        {
+            --running_batch;
+        }
+        // a queue at its limit may have become runnable for a waiting worker
+        condition.notify_all();
+    }
+}
+}
+}
@@ -0,0 +1,224 @@
+#include "storage/image.hpp"
+#include "storage/io.hpp"
+#include "storage/serialization.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+#include "util/mmap_file.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace osrm
+{
+namespace storage
+{
+
+namespace
+{
+// Reads the header and the layout of a mapped image
+SharedDataIndex readIndex(const char *image, const std::size_t size, const std::string &path)
+{
+    ImageHeader header;
+    if (size < sizeof(header))
+    {
+        throw util::exception(path + " is not a dataset image" + SOURCE_REF);
+    }
+    std::memcpy(&header, image, sizeof(header));
+
+    if (!header.fingerprint.IsValid())
+    {
+        throw util::exception(path + " is not a dataset image, write it with osrm-datastore "
+                                     "--prepare-image" +
+                              SOURCE_REF);
+    }
+    if (!header.fingerprint.IsDataCompatible(util::FingerPrint::GetValid()))
+    {
+        throw util::exception(path + " was written by OSRM " +
+                              std::to_string(header.fingerprint.GetMajorVersion()) + "." +
+                              std::to_string(header.fingerprint.GetMinorVersion()) +
+                              ", write it again with this version" + SOURCE_REF);
+    }
+    if (sizeof(header) + header.layout_size > header.data_offset ||
+        header.data_offset + header.data_size > size)
+    {
+        throw util::exception(path + " is truncated" + SOURCE_REF);
+    }
+
+    DataLayout layout;
+    io::BufferReader reader(image + sizeof(header), header.layout_size);
+    serialization::read(reader, layout);
+
+    // the mapping is read-only, the facades never write to the dataset
+    return SharedDataIndex({{const_cast<char *>(image) + header.data_offset, std::move(layout)}});
+}
+
+// Files on hugetlbfs can only be truncated to multiples of its pages, which statvfs reports as
+// the block size. On other file systems this adds less than a block that is never mapped.
+std::size_t roundToBlockSize(const boost::filesystem::path &path, const std::size_t size)
+{
+#ifndef _WIN32
+    auto directory = path.parent_path();
+    if (directory.empty())
+        directory = ".";
+    struct statvfs file_system;
+    if (::statvfs(directory.string().c_str(), &file_system) == 0 && file_system.f_bsize > 0)
+    {
+        return (size + file_system.f_bsize - 1) / file_system.f_bsize * file_system.f_bsize;
+    }
+#endif
+    return size;
+}
+
+#ifndef _WIN32
+ImageFileId makeFileId(const struct stat &file_stat)
+{
+    ImageFileId file_id;
+    file_id.inode = file_stat.st_ino;
+    file_id.modified = file_stat.st_mtime;
+    return file_id;
+}
+#endif
+}
+
+#ifndef _WIN32
+ImageFileId getImageFileId(const boost::filesystem::path &path)
+{
+    struct stat file_stat;
+    if (-1 == ::stat(path.string().c_str(), &file_stat))
+        return {};
+    return makeFileId(file_stat);
+}
+#else
+ImageFileId getImageFileId(const boost::filesystem::path &path)
+{
+    boost::system::error_code error;
+    const auto modified = boost::filesystem::last_write_time(path, error);
+    ImageFileId file_id;
+    if (!error)
+        file_id.modified = modified;
+    return file_id;
+}
+#endif
+
+void writeImage(const boost::filesystem::path &path,
+                DataLayout layout,
+                const std::function<void(const SharedDataIndex &)> &populate)
+{
+    io::BufferWriter writer;
+    serialization::write(writer, layout);
+    const auto encoded_layout = writer.GetBuffer();
+
+    ImageHeader header;
+    header.fingerprint = util::FingerPrint::GetValid();
+    header.layout_size = encoded_layout.size();
+    header.data_offset = (sizeof(header) + encoded_layout.size() + IMAGE_ALIGNMENT - 1) /
+                         IMAGE_ALIGNMENT * IMAGE_ALIGNMENT;
+    header.data_size = layout.GetSizeOfLayout();
+
+    const auto file_size = roundToBlockSize(path, header.data_offset + header.data_size);
+    util::Log() << "Writing dataset image of " << file_size << " bytes to " << path.string();
+
+    // an image is only renamed to its path once it is complete, a process that maps it never
+    // sees a partially written image. The temporary name is unique, so that processes in other
+    // containers that write the same image don't write into each other's files.
+    const auto temporary_path =
+        boost::filesystem::unique_path(path.string() + ".%%%%-%%%%-%%%%.tmp");
+    try
+    {
+        boost::iostreams::mapped_file region;
+        auto image = util::mmapFile<char>(temporary_path, region, file_size);
+        std::memcpy(image.data(), &header, sizeof(header));
+        std::copy_n(encoded_layout.data(), encoded_layout.size(), image.data() + sizeof(header));
+
+        populate(SharedDataIndex({{image.data() + header.data_offset, std::move(layout)}}));
+    }
+    catch (...)
+    {
+        // on tmpfs and hugetlbfs the pages of the file stay in memory until it is removed
+        boost::system::error_code error;
+        boost::filesystem::remove(temporary_path, error);
+        throw;
+    }
+    boost::filesystem::rename(temporary_path, path);
+}
+
+#ifndef _WIN32
+MappedImage::MappedImage(const boost::filesystem::path &path, const bool populate)
+{
+    const auto fd = ::open(path.string().c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        throw util::RuntimeError(
+            path.string(), ErrorCode::FileOpenError, SOURCE_REF, std::strerror(errno));
+    }
+
+    struct stat file_stat;
+    if (-1 == ::fstat(fd, &file_stat))
+    {
+        ::close(fd);
+        throw util::RuntimeError(
+            path.string(), ErrorCode::FileIOError, SOURCE_REF, std::strerror(errno));
+    }
+    size = file_stat.st_size;
+    file_id = makeFileId(file_stat);
+
+    auto flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (populate)
+        flags |= MAP_POPULATE;
+#endif
+    memory = ::mmap(nullptr, size, PROT_READ, flags, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        throw util::exception("Could not map " + path.string() + ": " + std::strerror(errno) +
+                              SOURCE_REF);
+    }
+#ifndef MAP_POPULATE
+    if (populate)
+        ::madvise(memory, size, MADV_WILLNEED);
+#endif
+
+    try
+    {
+        index = readIndex(static_cast<const char *>(memory), size, path.string());
+    }
+    catch (...)
+    {
+        ::munmap(memory, size);
+        throw;
+    }
+}
+
+MappedImage::~MappedImage() { ::munmap(memory, size); }
+#else
+MappedImage::MappedImage(const boost::filesystem::path &path, const bool populate)
+{
+    file_id = getImageFileId(path);
+    auto image = util::mmapFile<char>(path, region);
+    if (populate)
+    {
+        util::Log(logWARNING) << "Populating the mapping of an image is not supported on this "
+                                 "platform";
+    }
+    index = readIndex(image.data(), image.size(), path.string());
+}
+
+MappedImage::~MappedImage() {}
+#endif
+}
+}
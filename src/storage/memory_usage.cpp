@@ -0,0 +1,180 @@
+#include "storage/memory_usage.hpp"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <utility>
+
+namespace osrm
+{
+namespace storage
+{
+
+namespace
+{
+// The first prefix that matches the name of a block selects its subsystem
+const std::vector<std::pair<std::string, std::string>> SUBSYSTEM_PREFIXES = {
+    {"/common/rtree", "rtree"},
+    {"/common/names", "names"},
+    {"/common/segment_data", "geometry"},
+    {"/common/geometry_coordinates", "geometry"},
+    {"/common/nbn_data", "geometry"},
+    {"/common/turn_data", "guidance"},
+    {"/common/turn_lanes", "guidance"},
+    {"/common/entry_classes", "guidance"},
+    {"/common/intersection_bearings", "guidance"},
+    {"/common/maneuver_overrides", "guidance"},
+    {"/common/ebg_node_data", "nodes"},
+    {"/common/turn_penalty", "turn_penalties"},
+    {"/mld/multilevelgraph", "mld/graph"},
+    {"/mld/multilevelpartition", "mld/partition"},
+    {"/mld/cellstorage", "mld/cells"}};
+
+// Blocks of the metrics are grouped by the metric, e.g. /mld/metrics/duration/exclude/0/weights
+const std::vector<std::pair<std::string, std::string>> METRIC_PREFIXES = {
+    {"/ch/metrics/", "ch/graph/"}, {"/mld/metrics/", "mld/cells/"}};
+
+std::uint64_t residentBytes(const char *block, const std::uint64_t size)
+{
+    if (size == 0)
+        return 0;
+
+#ifndef _WIN32
+    const auto page_size = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const auto block_begin = reinterpret_cast<std::uintptr_t>(block);
+    const auto block_end = block_begin + size;
+    const auto pages_begin = block_begin / page_size * page_size;
+    const auto number_of_pages = (block_end - pages_begin + page_size - 1) / page_size;
+
+#ifdef __APPLE__
+    std::vector<char> residency(number_of_pages);
+#else
+    std::vector<unsigned char> residency(number_of_pages);
+#endif
+    if (::mincore(
+            reinterpret_cast<void *>(pages_begin), block_end - pages_begin, residency.data()))
+    {
+        return 0;
+    }
+
+    std::uint64_t resident_bytes = 0;
+    for (std::size_t page = 0; page < number_of_pages; ++page)
+    {
+        if (residency[page] & 1)
+        {
+            const auto page_begin = pages_begin + page * page_size;
+            resident_bytes += std::min(block_end, page_begin + page_size) -
+                              std::max(block_begin, page_begin);
+        }
+    }
+    return resident_bytes;
+#else
+    // the residency of pages is not known, all are counted
+    (void)block;
+    return size;
+#endif
+}
+
+util::json::Object toJSON(const std::uint64_t mapped_bytes, const std::uint64_t resident_bytes)
+{
+    util::json::Object object;
+    object.values["mapped_bytes"] = static_cast<double>(mapped_bytes);
+    object.values["resident_bytes"] = static_cast<double>(resident_bytes);
+    return object;
+}
+}
+
+std::string getSubsystem(const std::string &block_name)
+{
+    for (const auto &prefix : METRIC_PREFIXES)
+    {
+        if (block_name.compare(0, prefix.first.size(), prefix.first) == 0)
+        {
+            const auto metric_end = block_name.find('/', prefix.first.size());
+            return prefix.second +
+                   block_name.substr(prefix.first.size(), metric_end - prefix.first.size());
+        }
+    }
+
+    for (const auto &prefix : SUBSYSTEM_PREFIXES)
+    {
+        if (block_name.compare(0, prefix.first.size(), prefix.first) == 0)
+            return prefix.second;
+    }
+
+    return "other";
+}
+
+std::vector<BlockMemoryUsage> getMemoryUsage(const SharedDataIndex &index)
+{
+    std::vector<std::string> names;
+    index.List("", std::back_inserter(names));
+    std::sort(names.begin(), names.end());
+
+    std::vector<BlockMemoryUsage> blocks;
+    blocks.reserve(names.size());
+    for (const auto &name : names)
+    {
+        const auto size = index.GetBlockSize(name);
+        blocks.push_back({name,
+                          getSubsystem(name),
+                          index.GetBlockEntries(name),
+                          size,
+                          residentBytes(index.GetBlockPtr<char>(name), size)});
+    }
+    return blocks;
+}
+
+util::json::Object makeMemoryReport(const std::vector<BlockMemoryUsage> &blocks)
+{
+    std::uint64_t mapped_bytes = 0;
+    std::uint64_t resident_bytes = 0;
+    std::map<std::string, std::pair<std::uint64_t, std::uint64_t>> subsystems;
+    for (const auto &block : blocks)
+    {
+        mapped_bytes += block.mapped_bytes;
+        resident_bytes += block.resident_bytes;
+        auto &subsystem = subsystems[block.subsystem];
+        subsystem.first += block.mapped_bytes;
+        subsystem.second += block.resident_bytes;
+    }
+
+    auto report = toJSON(mapped_bytes, resident_bytes);
+
+    util::json::Object subsystems_json;
+    for (const auto &subsystem : subsystems)
+    {
+        subsystems_json.values[subsystem.first] =
+            toJSON(subsystem.second.first, subsystem.second.second);
+    }
+    report.values["subsystems"] = std::move(subsystems_json);
+
+    std::vector<const BlockMemoryUsage *> largest_blocks;
+    for (const auto &block : blocks)
+        largest_blocks.push_back(&block);
+    std::stable_sort(largest_blocks.begin(),
+                     largest_blocks.end(),
+                     [](const auto lhs, const auto rhs) {
+                         return lhs->mapped_bytes > rhs->mapped_bytes;
+                     });
+
+    util::json::Array blocks_json;
+    for (const auto block : largest_blocks)
+    {
+        auto block_json = toJSON(block->mapped_bytes, block->resident_bytes);
+        block_json.values["name"] = block->name;
+        block_json.values["subsystem"] = block->subsystem;
+        block_json.values["entries"] = static_cast<double>(block->entries);
+        blocks_json.values.push_back(std::move(block_json));
+    }
+    report.values["blocks"] = std::move(blocks_json);
+
+    return report;
+}
+}
+}
@@ -1,5 +1,6 @@
 #include "storage/storage.hpp"
 
+#include "storage/image.hpp"
 #include "storage/io.hpp"
 #include "storage/shared_datatype.hpp"
 #include "storage/shared_memory.hpp"
@@ -17,6 +18,9 @@
 #include "util/exception_utils.hpp"
 #include "util/fingerprint.hpp"
 #include "util/log.hpp"
+#include "util/numa.hpp"
+#include "util/phase_report.hpp"
+#include "util/timing_util.hpp"
 
 #ifdef __linux__
 #include <sys/mman.h>
@@ -24,10 +28,14 @@
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/interprocess/sync/file_lock.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 
+#include <tbb/task_group.h>
+
 #include <cstdint>
 
 #include <fstream>
@@ -42,9 +50,24 @@ namespace storage
 {
 namespace
 {
-inline void readBlocks(const boost::filesystem::path &path, DataLayout &layout)
+// Compares the checksums the tools stored with the blocks of a file
+void verifyChecksums(const boost::filesystem::path &path, tar::FileReader &reader)
+{
+    TIMER_START(verify_checksums);
+    const auto verified_bytes = reader.VerifyChecksums();
+    TIMER_STOP(verify_checksums);
+    util::Log() << "Verified the checksums of " << verified_bytes << " bytes of " << path.string()
+                << " in " << TIMER_SEC(verify_checksums) << "s";
+}
+
+inline void
+readBlocks(const boost::filesystem::path &path, DataLayout &layout, const bool verify_checksums)
 {
     tar::FileReader reader(path, tar::FileReader::VerifyFingerprint);
+    if (verify_checksums)
+    {
+        verifyChecksums(path, reader);
+    }
 
     std::vector<tar::FileReader::FileEntry> entries;
     reader.List(std::back_inserter(entries));
@@ -59,13 +82,106 @@ inline void readBlocks(const boost::filesystem::path &path, DataLayout &layout)
         }
     }
 }
+
+// Graphs and turns of different extracts do not fit together
+void checkConnectivityChecksum(const boost::filesystem::path &graph_path,
+                               const std::uint32_t graph_checksum,
+                               const boost::filesystem::path &turns_path,
+                               const std::uint32_t turns_checksum)
+{
+    if (turns_checksum != graph_checksum)
+    {
+        throw util::exception("Connectivity checksum " + std::to_string(graph_checksum) + " in " +
+                              graph_path.string() + " does not equal to checksum " +
+                              std::to_string(turns_checksum) + " in " + turns_path.string());
+    }
+}
+
+struct RegionHandle
+{
+    std::unique_ptr<SharedMemory> memory;
+    char *data_ptr = nullptr;
+    std::uint8_t shm_key = 0;
+};
+
+// Allocates a new shared memory region for the layout and writes the layout to its beginning
+RegionHandle setupRegion(SharedRegionRegister &shared_register,
+                         const DataLayout &layout,
+                         const StorageConfig &config)
+{
+    // This is safe because we have an exclusive lock for all osrm-datastore processes.
+    auto shm_key = shared_register.ReserveKey();
+
+    // ensure that the shared memory region we want to write to is really removed
+    // this is only needef for failure recovery because we actually wait for all clients
+    // to detach at the end of the function
+    if (storage::SharedMemory::RegionExists(shm_key))
+    {
+        util::Log(logWARNING) << "Old shared memory region " << static_cast<int>(shm_key)
+                              << " still exists.";
+        util::UnbufferedLog() << "Retrying removal... ";
+        storage::SharedMemory::Remove(shm_key);
+        util::UnbufferedLog() << "ok.";
+    }
+
+    io::BufferWriter writer;
+    serialization::write(writer, layout);
+    auto encoded_layout = writer.GetBuffer();
+
+    // Allocate shared memory block
+    auto regions_size = encoded_layout.size() + layout.GetSizeOfLayout();
+    util::Log() << "Data layout has a size of " << encoded_layout.size() << " bytes";
+    util::Log() << "Allocating shared memory of " << regions_size << " bytes";
+    auto memory = makeSharedMemory(shm_key, regions_size, config.huge_pages);
+    if (config.numa_interleave)
+    {
+        util::InterleaveMemory(memory->Ptr(), memory->Size());
+    }
+
+    // Copy memory layout to shared memory and populate data
+    char *shared_memory_ptr = static_cast<char *>(memory->Ptr());
+    std::copy_n(encoded_layout.data(), encoded_layout.size(), shared_memory_ptr);
+
+    return RegionHandle{std::move(memory), shared_memory_ptr + encoded_layout.size(), shm_key};
+}
+
+// Attaches to an existing shared memory region and reads its layout
+RegionHandle getRegion(const std::uint8_t shm_key, DataLayout &layout)
+{
+    auto memory = makeSharedMemory(shm_key);
+
+    io::BufferReader reader(reinterpret_cast<char *>(memory->Ptr()), memory->Size());
+    serialization::read(reader, layout);
+    auto layout_size = reader.GetPosition();
+
+    auto data_ptr = reinterpret_cast<char *>(memory->Ptr()) + layout_size;
+    return RegionHandle{std::move(memory), data_ptr, shm_key};
+}
+
+const constexpr char STATIC_FILES_SIGNATURE[] = "/common/static_files_signature";
+
+// Regions of older versions do not have the signature and are always replaced
+bool hasStaticFilesSignature(const std::uint8_t shm_key, const std::uint64_t signature)
+{
+    DataLayout layout;
+    auto region = getRegion(shm_key, layout);
+    if (!layout.HasBlock(STATIC_FILES_SIGNATURE))
+    {
+        return false;
+    }
+    return *layout.GetBlockPtr<std::uint64_t>(region.data_ptr, STATIC_FILES_SIGNATURE) ==
+           signature;
+}
 }
 
 using Monitor = SharedMonitor<SharedRegionRegister>;
 
 Storage::Storage(StorageConfig config_) : config(std::move(config_)) {}
 
-int Storage::Run(int max_wait, const std::string &dataset_name)
+int Storage::Run(int max_wait,
+                 const std::string &dataset_name,
+                 bool only_metric,
+                 const std::string &metric_name)
 {
     BOOST_ASSERT_MSG(config.IsValid(), "Invalid storage config");
 
@@ -103,44 +219,76 @@ int Storage::Run(int max_wait, const std::string &dataset_name)
     Monitor monitor(SharedRegionRegister{});
     auto &shared_register = monitor.data();
 
-    // This is safe because we have an exclusive lock for all osrm-datastore processes.
-    auto shm_key = shared_register.ReserveKey();
+    const auto static_region_name = dataset_name + "/static";
+    // a named metric is an additional updatable region next to the one of the default metric
+    const auto updatable_region_name = metric_name.empty()
+                                           ? dataset_name + "/updatable"
+                                           : dataset_name + "/updatable/" + metric_name;
 
-    // ensure that the shared memory region we want to write to is really removed
-    // this is only needef for failure recovery because we actually wait for all clients
-    // to detach at the end of the function
-    if (storage::SharedMemory::RegionExists(shm_key))
+    util::ReportPhase allocation_phase("allocation");
+    std::vector<SharedDataIndex::AllocatedRegion> regions;
+    std::vector<std::pair<std::string, RegionHandle>> new_regions;
+    RegionHandle static_region;
+
+    const auto static_region_id = shared_register.Find(static_region_name);
+    auto keep_static_region = only_metric;
+    if (!only_metric && static_region_id != SharedRegionRegister::INVALID_REGION_ID)
     {
-        util::Log(logWARNING) << "Old shared memory region " << shm_key << " still exists.";
-        util::UnbufferedLog() << "Retrying removal... ";
-        storage::SharedMemory::Remove(shm_key);
-        util::UnbufferedLog() << "ok.";
+        keep_static_region = hasStaticFilesSignature(
+            shared_register.GetRegion(static_region_id).shm_key, GetStaticFilesSignature());
     }
 
-    util::Log() << "Loading data into " << static_cast<int>(shm_key);
+    if (keep_static_region)
+    {
+        if (static_region_id == SharedRegionRegister::INVALID_REGION_ID)
+        {
+            util::Log(logERROR) << "Could not find shared memory region for \""
+                                << static_region_name
+                                << "\" to update the metric of. Run osrm-datastore without "
+                                   "--only-metric first.";
+            return EXIT_FAILURE;
+        }
 
-    // Populate a memory layout into stack memory
-    DataLayout layout;
-    PopulateLayout(layout);
+        DataLayout static_layout;
+        static_region =
+            getRegion(shared_register.GetRegion(static_region_id).shm_key, static_layout);
+        util::Log() << "Keeping " << (only_metric ? "" : "unchanged ") << "static data in "
+                    << static_cast<int>(static_region.shm_key);
+        regions.push_back({static_region.data_ptr, std::move(static_layout)});
+    }
+    else
+    {
+        DataLayout static_layout;
+        PopulateStaticLayout(static_layout);
+        auto region = setupRegion(shared_register, static_layout, config);
+        util::Log() << "Loading static data into " << static_cast<int>(region.shm_key);
+        regions.push_back({region.data_ptr, std::move(static_layout)});
+        new_regions.emplace_back(static_region_name, std::move(region));
+    }
 
-    io::BufferWriter writer;
-    serialization::write(writer, layout);
-    auto encoded_layout = writer.GetBuffer();
+    {
+        DataLayout updatable_layout;
+        PopulateUpdatableLayout(updatable_layout);
+        auto region = setupRegion(shared_register, updatable_layout, config);
+        util::Log() << "Loading updatable data into " << static_cast<int>(region.shm_key);
+        regions.push_back({region.data_ptr, std::move(updatable_layout)});
+        new_regions.emplace_back(updatable_region_name, std::move(region));
+    }
 
-    // Allocate shared memory block
-    auto regions_size = encoded_layout.size() + layout.GetSizeOfLayout();
-    util::Log() << "Data layout has a size of " << encoded_layout.size() << " bytes";
-    util::Log() << "Allocating shared memory of " << regions_size << " bytes";
-    auto data_memory = makeSharedMemory(shm_key, regions_size);
+    allocation_phase.Stop();
 
-    // Copy memory layout to shared memory and populate data
-    char *shared_memory_ptr = static_cast<char *>(data_memory->Ptr());
-    std::copy_n(encoded_layout.data(), encoded_layout.size(), shared_memory_ptr);
-    PopulateData(layout, shared_memory_ptr + encoded_layout.size());
+    util::ReportPhase loading_phase("loading");
+    SharedDataIndex index{std::move(regions)};
+    if (!keep_static_region)
+    {
+        PopulateStaticData(index);
+    }
+    PopulateUpdatableData(index);
+    loading_phase.Stop();
 
-    std::uint32_t next_timestamp = 0;
-    std::uint8_t in_use_key = SharedRegionRegister::MAX_SHM_KEYS;
+    std::vector<SharedRegionRegister::ShmKey> in_use_keys;
 
+    util::ReportPhase publishing_phase("publishing");
     { // Lock for write access shared region mutex
         boost::interprocess::scoped_lock<Monitor::mutex_type> lock(monitor.get_mutex(),
                                                                    boost::interprocess::defer_lock);
@@ -152,7 +300,10 @@ int Storage::Run(int max_wait, const std::string &dataset_name)
             {
                 util::Log(logERROR) << "Could not aquire current region lock after " << max_wait
                                     << " seconds. Data update failed.";
-                SharedMemory::Remove(shm_key);
+                for (const auto &name_and_region : new_regions)
+                {
+                    SharedMemory::Remove(name_and_region.second.shm_key);
+                }
                 return EXIT_FAILURE;
             }
         }
@@ -161,100 +312,139 @@ int Storage::Run(int max_wait, const std::string &dataset_name)
             lock.lock();
         }
 
-        auto region_id = shared_register.Find(dataset_name + "/data");
-        if (region_id == SharedRegionRegister::INVALID_REGION_ID)
+        // Both regions of a full load are swapped together, clients never see a static region
+        // next to the updatable region of another dataset
+        for (const auto &name_and_region : new_regions)
         {
-            region_id = shared_register.Register(dataset_name + "/data", shm_key);
-        }
-        else
-        {
-            auto &shared_region = shared_register.GetRegion(region_id);
-            next_timestamp = shared_region.timestamp + 1;
-            in_use_key = shared_region.shm_key;
-            shared_region.shm_key = shm_key;
-            shared_region.timestamp = next_timestamp;
+            const auto &region_name = name_and_region.first;
+            const auto shm_key = name_and_region.second.shm_key;
+
+            auto region_id = shared_register.Find(region_name);
+            if (region_id == SharedRegionRegister::INVALID_REGION_ID)
+            {
+                region_id = shared_register.Register(region_name, shm_key);
+            }
+            else
+            {
+                auto &shared_region = shared_register.GetRegion(region_id);
+                in_use_keys.push_back(shared_region.shm_key);
+                shared_region.shm_key = shm_key;
+                shared_region.timestamp = shared_region.timestamp + 1;
+            }
+
+            util::Log() << "All data loaded. Notify all client about new data in "
+                        << static_cast<int>(shm_key) << " with timestamp "
+                        << shared_register.GetRegion(region_id).timestamp << " for "
+                        << region_name;
         }
     }
 
-    util::Log() << "All data loaded. Notify all client about new data in "
-                << static_cast<int>(shm_key) << " with timestamp " << next_timestamp;
     monitor.notify_all();
+    publishing_phase.Stop();
 
-    // SHMCTL(2): Mark the segment to be destroyed. The segment will actually be destroyed
-    // only after the last process detaches it.
-    if (in_use_key != SharedRegionRegister::MAX_SHM_KEYS &&
-        storage::SharedMemory::RegionExists(in_use_key))
+    util::ReportPhase detaching_phase("detaching");
+    for (const auto in_use_key : in_use_keys)
     {
-        util::UnbufferedLog() << "Marking old shared memory region " << static_cast<int>(in_use_key)
-                              << " for removal... ";
+        // SHMCTL(2): Mark the segment to be destroyed. The segment will actually be destroyed
+        // only after the last process detaches it.
+        if (storage::SharedMemory::RegionExists(in_use_key))
+        {
+            util::UnbufferedLog() << "Marking old shared memory region "
+                                  << static_cast<int>(in_use_key) << " for removal... ";
 
-        // aquire a handle for the old shared memory region before we mark it for deletion
-        // we will need this to wait for all users to detach
-        auto in_use_shared_memory = makeSharedMemory(in_use_key);
+            // aquire a handle for the old shared memory region before we mark it for deletion
+            // we will need this to wait for all users to detach
+            auto in_use_shared_memory = makeSharedMemory(in_use_key);
 
-        storage::SharedMemory::Remove(in_use_key);
-        util::UnbufferedLog() << "ok.";
+            storage::SharedMemory::Remove(in_use_key);
+            util::UnbufferedLog() << "ok.";
 
-        util::UnbufferedLog() << "Waiting for clients to detach... ";
-        in_use_shared_memory->WaitForDetach();
-        util::UnbufferedLog() << " ok.";
+            util::UnbufferedLog() << "Waiting for clients to detach... ";
+            in_use_shared_memory->WaitForDetach();
+            util::UnbufferedLog() << " ok.";
 
-        shared_register.ReleaseKey(in_use_key);
+            shared_register.ReleaseKey(in_use_key);
+        }
     }
+    detaching_phase.Stop();
 
     util::Log() << "All clients switched.";
 
     return EXIT_SUCCESS;
 }
 
-/**
- * This function examines all our data files and figures out how much
- * memory needs to be allocated, and the position of each data structure
- * in that big block.  It updates the fields in the DataLayout parameter.
- */
-void Storage::PopulateLayout(DataLayout &layout)
+Storage::Files Storage::GetStaticFiles() const
 {
-    {
-        auto absolute_file_index_path =
-            boost::filesystem::absolute(config.GetPath(".osrm.fileIndex"));
-
-        layout.SetBlock("/common/rtree/file_index_path",
-                        make_block<char>(absolute_file_index_path.string().length() + 1));
-    }
-
     constexpr bool REQUIRED = true;
     constexpr bool OPTIONAL = false;
-    std::vector<std::pair<bool, boost::filesystem::path>> tar_files = {
-        {OPTIONAL, config.GetPath(".osrm.mldgr")},
+    return {
         {OPTIONAL, config.GetPath(".osrm.cells")},
         {OPTIONAL, config.GetPath(".osrm.partition")},
-        {OPTIONAL, config.GetPath(".osrm.cell_metrics")},
-        {OPTIONAL, config.GetPath(".osrm.hsgr")},
         {REQUIRED, config.GetPath(".osrm.icd")},
         {REQUIRED, config.GetPath(".osrm.properties")},
         {REQUIRED, config.GetPath(".osrm.nbg_nodes")},
-        {REQUIRED, config.GetPath(".osrm.datasource_names")},
-        {REQUIRED, config.GetPath(".osrm.geometry")},
         {REQUIRED, config.GetPath(".osrm.ebg_nodes")},
         {REQUIRED, config.GetPath(".osrm.tls")},
         {REQUIRED, config.GetPath(".osrm.tld")},
         {REQUIRED, config.GetPath(".osrm.maneuver_overrides")},
-        {REQUIRED, config.GetPath(".osrm.turn_weight_penalties")},
-        {REQUIRED, config.GetPath(".osrm.turn_duration_penalties")},
         {REQUIRED, config.GetPath(".osrm.edges")},
         {REQUIRED, config.GetPath(".osrm.names")},
         {REQUIRED, config.GetPath(".osrm.ramIndex")},
+        {OPTIONAL, config.GetPath(".osrm.geometry_coordinates")},
     };
+}
+
+std::uint64_t Storage::GetStaticFilesSignature() const
+{
+    auto files = GetStaticFiles();
+    files.emplace_back(true, config.GetPath(".osrm.fileIndex"));
 
-    for (const auto &file : tar_files)
+    std::size_t signature = config.load_rtree_leaves;
+    boost::hash_combine(signature, config.skip_osm_node_ids);
+    for (const auto &file : files)
+    {
+        const auto &path = file.second;
+        boost::hash_combine(signature, boost::filesystem::absolute(path).string());
+        if (boost::filesystem::exists(path))
+        {
+            boost::hash_combine(signature, boost::filesystem::file_size(path));
+            boost::hash_combine(signature, boost::filesystem::last_write_time(path));
+        }
+    }
+    return signature;
+}
+
+Storage::Files Storage::GetUpdatableFiles() const
+{
+    constexpr bool REQUIRED = true;
+    constexpr bool OPTIONAL = false;
+    return {
+        {OPTIONAL, config.GetPath(".osrm.mldgr")},
+        {OPTIONAL, config.GetPath(".osrm.cell_metrics")},
+        {OPTIONAL, config.GetPath(".osrm.hsgr")},
+        {REQUIRED, config.GetPath(".osrm.datasource_names")},
+        {REQUIRED, config.GetPath(".osrm.geometry")},
+        {REQUIRED, config.GetPath(".osrm.turn_weight_penalties")},
+        {REQUIRED, config.GetPath(".osrm.turn_duration_penalties")},
+    };
+}
+
+/**
+ * This function examines all our data files and figures out how much
+ * memory needs to be allocated, and the position of each data structure
+ * in that big block.  It updates the fields in the DataLayout parameter.
+ */
+void Storage::PopulateLayout(DataLayout &layout, const Files &files)
+{
+    for (const auto &file : files)
     {
         if (boost::filesystem::exists(file.second))
         {
-            readBlocks(file.second, layout);
+            readBlocks(file.second, layout, config.verify_checksums);
         }
         else
         {
-            if (file.first == REQUIRED)
+            if (file.first)
             {
                 throw util::exception("Could not find required filed: " +
                                       std::get<1>(file).string());
@@ -263,199 +453,423 @@ void Storage::PopulateLayout(DataLayout &layout)
     }
 }
 
-void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
+// The blocks of the r-tree that are not stored in the .osrm.ramIndex
+void Storage::PopulateFileIndexLayout(DataLayout &layout)
 {
-    BOOST_ASSERT(memory_ptr != nullptr);
+    {
+        auto absolute_file_index_path =
+            boost::filesystem::absolute(config.GetPath(".osrm.fileIndex"));
 
-    // Connectivity matrix checksum
-    std::uint32_t turns_connectivity_checksum = 0;
+        layout.SetBlock("/common/rtree/file_index_path",
+                        make_block<char>(absolute_file_index_path.string().length() + 1));
+    }
 
-    // read actual data into shared memory object //
+    if (config.load_rtree_leaves)
+    {
+        const auto file_index_size =
+            boost::filesystem::file_size(config.GetPath(".osrm.fileIndex"));
+        layout.SetBlock("/common/rtree/leaves",
+                        make_block<extractor::EdgeBasedNodeSegment>(
+                            file_index_size / sizeof(extractor::EdgeBasedNodeSegment)));
+    }
+}
 
-    // store the filename of the on-disk portion of the RTree
+void Storage::PopulateStaticLayout(DataLayout &layout)
+{
+    layout.SetBlock(STATIC_FILES_SIGNATURE, make_block<std::uint64_t>(1));
+    PopulateFileIndexLayout(layout);
+    PopulateLayout(layout, GetStaticFiles());
+
+    if (config.skip_osm_node_ids)
     {
-        const auto file_index_path_ptr =
-            layout.GetBlockPtr<char>(memory_ptr, "/common/rtree/file_index_path");
-        // make sure we have 0 ending
-        std::fill(file_index_path_ptr,
-                  file_index_path_ptr + layout.GetBlockSize("/common/rtree/file_index_path"),
-                  0);
-        const auto absolute_file_index_path =
-            boost::filesystem::absolute(config.GetPath(".osrm.fileIndex")).string();
-        BOOST_ASSERT(static_cast<std::size_t>(layout.GetBlockSize(
-                         "/common/rtree/file_index_path")) >= absolute_file_index_path.size());
-        std::copy(
-            absolute_file_index_path.begin(), absolute_file_index_path.end(), file_index_path_ptr);
+        layout.RemoveBlocks("/common/nbn_data/osm_node_ids");
     }
+}
 
-    // Name data
+void Storage::PopulateUpdatableLayout(DataLayout &layout)
+{
+    PopulateLayout(layout, GetUpdatableFiles());
+}
+
+std::unique_ptr<MappedDataset> Storage::MapDataset()
+{
+    // the exclude filters of the CH are vectors of bool that the files store packed in words
+    const auto is_packed = [](const std::string &name) {
+        const std::string suffix = "/edge_filter";
+        return name.size() >= suffix.size() &&
+               name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+
+    auto all_files = GetStaticFiles();
+    const auto updatable_files = GetUpdatableFiles();
+    all_files.insert(all_files.end(), updatable_files.begin(), updatable_files.end());
+
+    std::vector<boost::iostreams::mapped_file_source> files;
+    // every mapped block is a region of its own that starts at its entry in the file
+    std::vector<SharedDataIndex::AllocatedRegion> regions;
+    DataLayout loaded_layout;
+    std::vector<std::pair<boost::filesystem::path, std::string>> packed_blocks;
+    // compressed entries can't be mapped either and are decompressed into the process memory
+    std::vector<std::pair<boost::filesystem::path, std::string>> compressed_blocks;
+    for (const auto &file : all_files)
     {
-        auto name_table = make_name_table_view(memory_ptr, layout, "/common/names");
-        extractor::files::readNames(config.GetPath(".osrm.names"), name_table);
+        const auto &path = file.second;
+        if (!boost::filesystem::exists(path))
+        {
+            if (file.first)
+            {
+                throw util::exception("Could not find required filed: " + path.string());
+            }
+            continue;
+        }
+
+        tar::FileReader reader(path, tar::FileReader::VerifyFingerprint);
+        if (config.verify_checksums)
+        {
+            verifyChecksums(path, reader);
+        }
+        std::vector<tar::FileReader::FileEntry> entries;
+        reader.List(std::back_inserter(entries));
+
+        files.emplace_back(path.string());
+        // the mappings are read-only, the facades never write to the dataset
+        auto file_memory = const_cast<char *>(files.back().data());
+
+        for (const auto &entry : entries)
+        {
+            if (entry.name.rfind(".meta") != std::string::npos)
+                continue;
+
+            Block block{reader.ReadElementCount64(entry.name), entry.size};
+            if (is_packed(entry.name))
+            {
+                loaded_layout.SetBlock(entry.name, std::move(block));
+                packed_blocks.emplace_back(path, entry.name);
+            }
+            else if (entry.compressed)
+            {
+                loaded_layout.SetBlock(entry.name, std::move(block));
+                compressed_blocks.emplace_back(path, entry.name);
+            }
+            else
+            {
+                // tar entries start at multiples of 512 bytes, which keeps the block alignment
+                BOOST_ASSERT(entry.offset % 512 == 0);
+                DataLayout block_layout;
+                block_layout.SetBlock(entry.name, std::move(block));
+                regions.push_back({file_memory + entry.offset, std::move(block_layout)});
+            }
+        }
     }
 
-    // Turn lane data
+    PopulateFileIndexLayout(loaded_layout);
+    auto memory =
+        std::make_unique<ProcessMemory>(loaded_layout.GetSizeOfLayout(), config.huge_pages);
+    regions.push_back({memory->get(), std::move(loaded_layout)});
+    SharedDataIndex index{std::move(regions)};
+
+    PopulateFileIndexPath(index);
+    PopulateRTreeLeaves(index);
+    for (const auto &path_and_name : packed_blocks)
     {
-        auto turn_lane_data = make_lane_data_view(memory_ptr, layout, "/common/turn_lanes");
-        extractor::files::readTurnLaneData(config.GetPath(".osrm.tld"), turn_lane_data);
+        tar::FileReader reader(path_and_name.first, tar::FileReader::VerifyFingerprint);
+        auto packed = make_vector_view<bool>(index, path_and_name.second);
+        serialization::read(reader, path_and_name.second, packed);
+    }
+    for (const auto &path_and_name : compressed_blocks)
+    {
+        tar::FileReader reader(path_and_name.first, tar::FileReader::VerifyFingerprint);
+        reader.ReadInto(path_and_name.second,
+                        index.GetBlockPtr<char>(path_and_name.second),
+                        index.GetBlockSize(path_and_name.second));
     }
 
-    // Turn lane descriptions
+    const auto turns_connectivity_checksum =
+        *index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
+    if (index.HasBlock("/ch/connectivity_checksum"))
+    {
+        checkConnectivityChecksum(config.GetPath(".osrm.hsgr"),
+                                  *index.GetBlockPtr<std::uint32_t>("/ch/connectivity_checksum"),
+                                  config.GetPath(".osrm.edges"),
+                                  turns_connectivity_checksum);
+    }
+    if (index.HasBlock("/mld/connectivity_checksum"))
     {
-        auto views = make_turn_lane_description_views(memory_ptr, layout, "/common/turn_lanes");
+        checkConnectivityChecksum(config.GetPath(".osrm.mldgr"),
+                                  *index.GetBlockPtr<std::uint32_t>("/mld/connectivity_checksum"),
+                                  config.GetPath(".osrm.edges"),
+                                  turns_connectivity_checksum);
+    }
+
+    return std::make_unique<MappedDataset>(std::move(files), std::move(memory), std::move(index));
+}
+
+void Storage::WriteImage(const boost::filesystem::path &image_path)
+{
+    DataLayout layout;
+    PopulateStaticLayout(layout);
+    PopulateUpdatableLayout(layout);
+
+    util::ReportPhase writing_phase("writing_image");
+    writeImage(image_path, std::move(layout), [this](const SharedDataIndex &index) {
+        PopulateStaticData(index);
+        PopulateUpdatableData(index);
+    });
+}
+
+// Stores the absolute path of the on-disk portion of the RTree
+void Storage::PopulateFileIndexPath(const SharedDataIndex &index)
+{
+    const auto file_index_path_ptr = index.GetBlockPtr<char>("/common/rtree/file_index_path");
+    // make sure we have 0 ending
+    std::fill(file_index_path_ptr,
+              file_index_path_ptr + index.GetBlockSize("/common/rtree/file_index_path"),
+              0);
+    const auto absolute_file_index_path =
+        boost::filesystem::absolute(config.GetPath(".osrm.fileIndex")).string();
+    BOOST_ASSERT(static_cast<std::size_t>(index.GetBlockSize("/common/rtree/file_index_path")) >=
+                 absolute_file_index_path.size());
+    std::copy(
+        absolute_file_index_path.begin(), absolute_file_index_path.end(), file_index_path_ptr);
+}
+
+void Storage::PopulateRTreeLeaves(const SharedDataIndex &index)
+{
+    if (index.HasBlock("/common/rtree/leaves"))
+    {
+        const auto leaves_ptr =
+            index.GetBlockPtr<extractor::EdgeBasedNodeSegment>("/common/rtree/leaves");
+        const auto number_of_leaves = index.GetBlockEntries("/common/rtree/leaves");
+        io::FileReader reader(config.GetPath(".osrm.fileIndex"), io::FileReader::HasNoFingerprint);
+        reader.ReadInto(leaves_ptr, number_of_leaves);
+
+#ifdef __linux__
+        if (config.lock_rtree_leaves &&
+            -1 == mlock(leaves_ptr, index.GetBlockSize("/common/rtree/leaves")))
+        {
+            util::Log(logWARNING) << "Could not lock the r-tree leaves to RAM";
+        }
+#endif
+    }
+}
+
+void Storage::PopulateStaticData(const SharedDataIndex &index)
+{
+    // read actual data into shared memory object //
+
+    *index.GetBlockPtr<std::uint64_t>(STATIC_FILES_SIGNATURE) = GetStaticFilesSignature();
+
+    // the search tree view needs the path of the file index
+    PopulateFileIndexPath(index);
+
+    // the blocks are read from different files into disjoint memory, the reads of large
+    // datasets are bound by the throughput of the disk which one thread does not saturate
+    tbb::task_group loaders;
+
+    // Name data
+    loaders.run([&] {
+        auto name_table = make_name_table_view(index, "/common/names");
+        extractor::files::readNames(config.GetPath(".osrm.names"), name_table);
+    });
+
+    // Turn lane data
+    loaders.run([&] {
+        auto turn_lane_data = make_lane_data_view(index, "/common/turn_lanes");
+        extractor::files::readTurnLaneData(config.GetPath(".osrm.tld"), turn_lane_data);
+    });
+
+    // Turn lane descriptions
+    loaders.run([&] {
+        auto views = make_turn_lane_description_views(index, "/common/turn_lanes");
         extractor::files::readTurnLaneDescriptions(
             config.GetPath(".osrm.tls"), std::get<0>(views), std::get<1>(views));
-    }
+    });
 
     // Load edge-based nodes data
-    {
-        auto node_data = make_ebn_data_view(memory_ptr, layout, "/common/ebg_node_data");
+    loaders.run([&] {
+        auto node_data = make_ebn_data_view(index, "/common/ebg_node_data");
         extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
-    }
+    });
 
     // Load original edge data
-    {
-        auto turn_data = make_turn_data_view(memory_ptr, layout, "/common/turn_data");
+    loaders.run([&] {
+        auto turn_data = make_turn_data_view(index, "/common/turn_data");
 
         auto connectivity_checksum_ptr =
-            layout.GetBlockPtr<std::uint32_t>(memory_ptr, "/common/connectivity_checksum");
+            index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
 
         guidance::files::readTurnData(
             config.GetPath(".osrm.edges"), turn_data, *connectivity_checksum_ptr);
-
-        turns_connectivity_checksum = *connectivity_checksum_ptr;
-    }
-
-    // load compressed geometry
-    {
-        auto segment_data = make_segment_data_view(memory_ptr, layout, "/common/segment_data");
-        extractor::files::readSegmentData(config.GetPath(".osrm.geometry"), segment_data);
-    }
-
-    {
-        const auto datasources_names_ptr =
-            layout.GetBlockPtr<extractor::Datasources>(memory_ptr, "/common/data_sources_names");
-        extractor::files::readDatasources(config.GetPath(".osrm.datasource_names"),
-                                          *datasources_names_ptr);
-    }
+    });
 
     // Loading list of coordinates
-    {
-        auto views = make_nbn_data_view(memory_ptr, layout, "/common/nbn_data");
+    loaders.run([&] {
+        if (!index.HasBlock("/common/nbn_data/osm_node_ids/packed"))
+        {
+            auto coordinates = make_coordinates_view(index, "/common/nbn_data/coordinates");
+            extractor::files::readNodeCoordinates(config.GetPath(".osrm.nbg_nodes"), coordinates);
+            return;
+        }
+
+        auto views = make_nbn_data_view(index, "/common/nbn_data");
         extractor::files::readNodes(
             config.GetPath(".osrm.nbg_nodes"), std::get<0>(views), std::get<1>(views));
-    }
+    });
 
-    // load turn weight penalties
-    {
-        auto turn_duration_penalties =
-            make_turn_weight_view(memory_ptr, layout, "/common/turn_penalty");
-        extractor::files::readTurnWeightPenalty(config.GetPath(".osrm.turn_weight_penalties"),
-                                                turn_duration_penalties);
-    }
+    loaders.run([&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.geometry_coordinates")))
+        {
+            auto geometry_coordinates =
+                make_geometry_coordinates_view(index, "/common/geometry_coordinates");
+            extractor::files::readGeometryCoordinates(
+                config.GetPath(".osrm.geometry_coordinates"), geometry_coordinates);
+        }
+    });
 
-    // load turn duration penalties
-    {
-        auto turn_duration_penalties =
-            make_turn_duration_view(memory_ptr, layout, "/common/turn_penalty");
-        extractor::files::readTurnDurationPenalty(config.GetPath(".osrm.turn_duration_penalties"),
-                                                  turn_duration_penalties);
-    }
+    // Copy the leaves of the r-tree, the search tree maps the file otherwise
+    loaders.run([&] { PopulateRTreeLeaves(index); });
 
     // store search tree portion of rtree
-    {
-        auto rtree = make_search_tree_view(memory_ptr, layout, "/common/rtree");
+    loaders.run([&] {
+        auto rtree = make_search_tree_view(index, "/common/rtree");
         extractor::files::readRamIndex(config.GetPath(".osrm.ramIndex"), rtree);
-    }
+    });
 
-    // FIXME we only need to get the weight name
-    std::string metric_name;
     // load profile properties
-    {
+    loaders.run([&] {
         const auto profile_properties_ptr =
-            layout.GetBlockPtr<extractor::ProfileProperties>(memory_ptr, "/common/properties");
+            index.GetBlockPtr<extractor::ProfileProperties>("/common/properties");
         extractor::files::readProfileProperties(config.GetPath(".osrm.properties"),
                                                 *profile_properties_ptr);
-
-        metric_name = profile_properties_ptr->GetWeightName();
-    }
+    });
 
     // Load intersection data
-    {
+    loaders.run([&] {
         auto intersection_bearings_view =
-            make_intersection_bearings_view(memory_ptr, layout, "/common/intersection_bearings");
-        auto entry_classes = make_entry_classes_view(memory_ptr, layout, "/common/entry_classes");
+            make_intersection_bearings_view(index, "/common/intersection_bearings");
+        auto entry_classes = make_entry_classes_view(index, "/common/entry_classes");
         extractor::files::readIntersections(
             config.GetPath(".osrm.icd"), intersection_bearings_view, entry_classes);
-    }
+    });
 
-    if (boost::filesystem::exists(config.GetPath(".osrm.hsgr")))
-    {
-        const std::string metric_prefix = "/ch/metrics/" + metric_name;
-        auto contracted_metric = make_contracted_metric_view(memory_ptr, layout, metric_prefix);
-        std::unordered_map<std::string, contractor::ContractedMetricView> metrics = {
-            {metric_name, std::move(contracted_metric)}};
-
-        std::uint32_t graph_connectivity_checksum = 0;
-        contractor::files::readGraph(
-            config.GetPath(".osrm.hsgr"), metrics, graph_connectivity_checksum);
+    loaders.run([&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.partition")))
+        {
+            auto mlp = make_partition_view(index, "/mld/multilevelpartition");
+            partitioner::files::readPartition(config.GetPath(".osrm.partition"), mlp);
+        }
+    });
 
-        if (turns_connectivity_checksum != graph_connectivity_checksum)
+    loaders.run([&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.cells")))
         {
-            throw util::exception(
-                "Connectivity checksum " + std::to_string(graph_connectivity_checksum) + " in " +
-                config.GetPath(".osrm.hsgr").string() + " does not equal to checksum " +
-                std::to_string(turns_connectivity_checksum) + " in " +
-                config.GetPath(".osrm.edges").string());
+            auto storage = make_cell_storage_view(index, "/mld/cellstorage");
+            partitioner::files::readCells(config.GetPath(".osrm.cells"), storage);
         }
-    }
+    });
 
-    if (boost::filesystem::exists(config.GetPath(".osrm.partition")))
-    {
-        auto mlp = make_partition_view(memory_ptr, layout, "/mld/multilevelpartition");
-        partitioner::files::readPartition(config.GetPath(".osrm.partition"), mlp);
-    }
+    // load maneuver overrides
+    loaders.run([&] {
+        auto views = make_maneuver_overrides_views(index, "/common/maneuver_overrides");
+        extractor::files::readManeuverOverrides(
+            config.GetPath(".osrm.maneuver_overrides"), std::get<0>(views), std::get<1>(views));
+    });
 
-    if (boost::filesystem::exists(config.GetPath(".osrm.cells")))
-    {
-        auto storage = make_cell_storage_view(memory_ptr, layout, "/mld/cellstorage");
-        partitioner::files::readCells(config.GetPath(".osrm.cells"), storage);
-    }
+    loaders.wait();
+}
 
-    if (boost::filesystem::exists(config.GetPath(".osrm.cell_metrics")))
-    {
-        auto exclude_metrics =
-            make_cell_metric_view(memory_ptr, layout, "/mld/metrics/" + metric_name);
-        std::unordered_map<std::string, std::vector<customizer::CellMetricView>> metrics = {
-            {metric_name, std::move(exclude_metrics)},
-        };
-        customizer::files::readCellMetrics(config.GetPath(".osrm.cell_metrics"), metrics);
-    }
+void Storage::PopulateUpdatableData(const SharedDataIndex &index)
+{
+    // the static data of the dataset is already loaded, also when only the metric is replaced
+    const auto turns_connectivity_checksum =
+        *index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
 
-    if (boost::filesystem::exists(config.GetPath(".osrm.mldgr")))
-    {
-        auto graph_view = make_multi_level_graph_view(memory_ptr, layout, "/mld/multilevelgraph");
-        std::uint32_t graph_connectivity_checksum = 0;
-        partitioner::files::readGraph(
-            config.GetPath(".osrm.mldgr"), graph_view, graph_connectivity_checksum);
+    // FIXME we only need to get the weight name
+    const auto metric_name =
+        index.GetBlockPtr<extractor::ProfileProperties>("/common/properties")->GetWeightName();
+
+    tbb::task_group loaders;
+
+    // load compressed geometry
+    loaders.run([&] {
+        auto segment_data = make_segment_data_view(index, "/common/segment_data");
+        extractor::files::readSegmentData(config.GetPath(".osrm.geometry"), segment_data);
+    });
+
+    loaders.run([&] {
+        const auto datasources_names_ptr =
+            index.GetBlockPtr<extractor::Datasources>("/common/data_sources_names");
+        extractor::files::readDatasources(config.GetPath(".osrm.datasource_names"),
+                                          *datasources_names_ptr);
+    });
+
+    // load turn weight penalties
+    loaders.run([&] {
+        auto turn_duration_penalties = make_turn_weight_view(index, "/common/turn_penalty");
+        extractor::files::readTurnWeightPenalty(config.GetPath(".osrm.turn_weight_penalties"),
+                                                turn_duration_penalties);
+    });
 
-        if (turns_connectivity_checksum != graph_connectivity_checksum)
+    // load turn duration penalties
+    loaders.run([&] {
+        auto turn_duration_penalties = make_turn_duration_view(index, "/common/turn_penalty");
+        extractor::files::readTurnDurationPenalty(config.GetPath(".osrm.turn_duration_penalties"),
+                                                  turn_duration_penalties);
+    });
+
+    loaders.run([&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.hsgr")))
         {
-            throw util::exception(
-                "Connectivity checksum " + std::to_string(graph_connectivity_checksum) + " in " +
-                config.GetPath(".osrm.mldgr").string() + " does not equal to checksum " +
-                std::to_string(turns_connectivity_checksum) + " in " +
-                config.GetPath(".osrm.edges").string());
+            const std::string metric_prefix = "/ch/metrics/" + metric_name;
+            auto contracted_metric = make_contracted_metric_view(index, metric_prefix);
+            std::unordered_map<std::string, contractor::ContractedMetricView> metrics = {
+                {metric_name, std::move(contracted_metric)}};
+
+            std::uint32_t graph_connectivity_checksum = 0;
+            contractor::files::readGraph(
+                config.GetPath(".osrm.hsgr"), metrics, graph_connectivity_checksum);
+
+            checkConnectivityChecksum(config.GetPath(".osrm.hsgr"),
+                                      graph_connectivity_checksum,
+                                      config.GetPath(".osrm.edges"),
+                                      turns_connectivity_checksum);
         }
-    }
+    });
 
-    // load maneuver overrides
-    {
-        auto views =
-            make_maneuver_overrides_views(memory_ptr, layout, "/common/maneuver_overrides");
-        extractor::files::readManeuverOverrides(
-            config.GetPath(".osrm.maneuver_overrides"), std::get<0>(views), std::get<1>(views));
-    }
+    loaders.run([&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.cell_metrics")))
+        {
+            auto exclude_metrics = make_cell_metric_view(index, "/mld/metrics/" + metric_name);
+            std::unordered_map<std::string, std::vector<customizer::CellMetricView>> metrics = {
+                {metric_name, std::move(exclude_metrics)},
+            };
+            customizer::files::readCellMetrics(config.GetPath(".osrm.cell_metrics"), metrics);
+
+            if (index.HasBlock("/mld/time_slot"))
+            {
+                customizer::files::readTimeSlot(
+                    config.GetPath(".osrm.cell_metrics"),
+                    *index.GetBlockPtr<customizer::TimeSlot>("/mld/time_slot"));
+            }
+        }
+    });
+
+    loaders.run([&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.mldgr")))
+        {
+            auto graph_view = make_multi_level_graph_view(index, "/mld/multilevelgraph");
+            std::uint32_t graph_connectivity_checksum = 0;
+            partitioner::files::readGraph(
+                config.GetPath(".osrm.mldgr"), graph_view, graph_connectivity_checksum);
+
+            checkConnectivityChecksum(config.GetPath(".osrm.mldgr"),
+                                      graph_connectivity_checksum,
+                                      config.GetPath(".osrm.edges"),
+                                      turns_connectivity_checksum);
+        }
+    });
+
+    loaders.wait();
 }
 }
 }
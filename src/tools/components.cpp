@@ -1,6 +1,6 @@
 #include "extractor/files.hpp"
 #include "extractor/packed_osm_ids.hpp"
-#include "extractor/tarjan_scc.hpp"
+#include "extractor/parallel_scc.hpp"
 
 #include "util/coordinate.hpp"
 #include "util/coordinate_calculation.hpp"
@@ -13,7 +13,10 @@
 #include <boost/filesystem.hpp>
 #include <boost/function_output_iterator.hpp>
 
+#include <tbb/blocked_range.h>
 #include <tbb/parallel_sort.h>
+#include <tbb/pipeline.h>
+#include <tbb/task_scheduler_init.h>
 
 #include <cstdint>
 #include <cstdlib>
@@ -22,6 +25,7 @@
 #include <fstream>
 #include <memory>
 #include <ostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -68,13 +72,10 @@ std::size_t loadGraph(const std::string &path,
     return osm_node_ids.size();
 }
 
-struct FeatureWriter
+// The features of the edges of a range of nodes, they are formatted in parallel and streamed to the
+// output in the order of the ranges
+struct FeatureBuffer
 {
-    FeatureWriter(std::ostream &out_) : out(out_)
-    {
-        out << "{\"type\":\"FeatureCollection\",\"features\":[";
-    }
-
     void AddLine(const util::Coordinate from,
                  const util::Coordinate to,
                  const OSMNodeID from_id,
@@ -86,9 +87,7 @@ struct FeatureWriter
         const auto to_lon = static_cast<double>(util::toFloating(to.lon));
         const auto to_lat = static_cast<double>(util::toFloating(to.lat));
 
-        static bool first = true;
-
-        if (!first)
+        if (!empty)
         {
             out << ",";
         }
@@ -98,12 +97,42 @@ struct FeatureWriter
             << "\"},\"geometry\":{\"type\":\"LineString\",\"coordinates\":[[" << from_lon << ","
             << from_lat << "],[" << to_lon << "," << to_lat << "]]}}";
 
+        empty = false;
+    }
+
+    std::ostringstream out;
+    bool empty = true;
+    std::uint64_t network_length = 0;
+};
+
+struct FeatureWriter
+{
+    FeatureWriter(std::ostream &out_) : out(out_)
+    {
+        out << "{\"type\":\"FeatureCollection\",\"features\":[";
+    }
+
+    void AddFeatures(const FeatureBuffer &buffer)
+    {
+        if (buffer.empty)
+        {
+            return;
+        }
+
+        if (!first)
+        {
+            out << ",";
+        }
+
+        out << buffer.out.rdbuf();
+
         first = false;
     }
 
     ~FeatureWriter() { out << "]}" << std::flush; }
 
     std::ostream &out;
+    bool first = true;
 };
 
 //
@@ -152,7 +181,7 @@ int main(int argc, char *argv[])
 
     util::Log() << "Starting SCC graph traversal";
 
-    extractor::TarjanSCC<tools::TarjanGraph> tarjan{*graph};
+    extractor::ParallelSCC<tools::TarjanGraph> tarjan{*graph};
     tarjan.Run();
 
     util::Log() << "Identified: " << tarjan.GetNumberOfComponents() << " components";
@@ -162,43 +191,85 @@ int main(int argc, char *argv[])
 
     tools::FeatureWriter writer{outfile};
 
-    for (const NodeID source : osrm::util::irange(0u, graph->GetNumberOfNodes()))
-    {
-        for (const auto current_edge : graph->GetAdjacentEdgeRange(source))
-        {
-            const auto target = graph->GetTarget(current_edge);
-
-            if (source < target || SPECIAL_EDGEID == graph->FindEdge(target, source))
-            {
-                BOOST_ASSERT(current_edge != SPECIAL_EDGEID);
-                BOOST_ASSERT(source != SPECIAL_NODEID);
-                BOOST_ASSERT(target != SPECIAL_NODEID);
-
-                total_network_length += 100 * util::coordinate_calculation::greatCircleDistance(
-                                                  coordinate_list[source], coordinate_list[target]);
+    const NodeID node_count = graph->GetNumberOfNodes();
+    NodeID current_node = 0;
 
-                auto source_component_id = tarjan.GetComponentID(source);
-                auto target_component_id = tarjan.GetComponentID(target);
+    // Format the features of sets of nodes in parallel and write them in order, only the features
+    // of a few sets are held in memory at a time
+    const constexpr unsigned GRAINSIZE = 10000;
 
-                auto source_component_size = tarjan.GetComponentSize(source_component_id);
-                auto target_component_size = tarjan.GetComponentSize(target_component_id);
+    tbb::filter_t<void, tbb::blocked_range<NodeID>> generator_stage(
+        tbb::filter::serial_in_order, [&](tbb::flow_control &fc) {
+            if (current_node < node_count)
+            {
+                auto next_node = std::min(current_node + GRAINSIZE, node_count);
+                auto result = tbb::blocked_range<NodeID>(current_node, next_node);
+                current_node = next_node;
+                return result;
+            }
+            else
+            {
+                fc.stop();
+                return tbb::blocked_range<NodeID>(node_count, node_count);
+            }
+        });
 
-                const auto smallest = std::min(source_component_size, target_component_size);
+    using FeatureBufferPtr = std::shared_ptr<tools::FeatureBuffer>;
+    tbb::filter_t<tbb::blocked_range<NodeID>, FeatureBufferPtr> feature_stage(
+        tbb::filter::parallel, [&](const tbb::blocked_range<NodeID> &range) {
+            auto buffer = std::make_shared<tools::FeatureBuffer>();
 
-                if (smallest < 1000)
+            for (auto source = range.begin(), end = range.end(); source < end; ++source)
+            {
+                for (const auto current_edge : graph->GetAdjacentEdgeRange(source))
                 {
-                    auto same_component = source_component_id == target_component_id;
-                    std::string type = same_component ? "inner" : "border";
-
-                    writer.AddLine(coordinate_list[source],
-                                   coordinate_list[target],
-                                   osm_node_ids[source],
-                                   osm_node_ids[target],
-                                   type);
+                    const auto target = graph->GetTarget(current_edge);
+
+                    if (source < target || SPECIAL_EDGEID == graph->FindEdge(target, source))
+                    {
+                        BOOST_ASSERT(current_edge != SPECIAL_EDGEID);
+                        BOOST_ASSERT(source != SPECIAL_NODEID);
+                        BOOST_ASSERT(target != SPECIAL_NODEID);
+
+                        buffer->network_length +=
+                            100 * util::coordinate_calculation::greatCircleDistance(
+                                      coordinate_list[source], coordinate_list[target]);
+
+                        auto source_component_id = tarjan.GetComponentID(source);
+                        auto target_component_id = tarjan.GetComponentID(target);
+
+                        auto source_component_size = tarjan.GetComponentSize(source_component_id);
+                        auto target_component_size = tarjan.GetComponentSize(target_component_id);
+
+                        const auto smallest =
+                            std::min(source_component_size, target_component_size);
+
+                        if (smallest < 1000)
+                        {
+                            auto same_component = source_component_id == target_component_id;
+                            std::string type = same_component ? "inner" : "border";
+
+                            buffer->AddLine(coordinate_list[source],
+                                            coordinate_list[target],
+                                            osm_node_ids[source],
+                                            osm_node_ids[target],
+                                            type);
+                        }
+                    }
                 }
             }
-        }
-    }
+
+            return buffer;
+        });
+
+    tbb::filter_t<FeatureBufferPtr, void> output_stage(
+        tbb::filter::serial_in_order, [&](const FeatureBufferPtr buffer) {
+            total_network_length += buffer->network_length;
+            writer.AddFeatures(*buffer);
+        });
+
+    tbb::parallel_pipeline(tbb::task_scheduler_init::default_num_threads() * 2,
+                           generator_stage & feature_stage & output_stage);
 
     util::Log() << "Total network distance: " << (total_network_length / 100 / 1000) << " km";
 }
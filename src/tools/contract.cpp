@@ -3,6 +3,7 @@
 #include "osrm/contractor_config.hpp"
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
+#include "util/phase_report.hpp"
 #include "util/timezones.hpp"
 #include "util/version.hpp"
 
@@ -31,6 +32,7 @@ enum class return_code : unsigned
 return_code parseArguments(int argc,
                            char *argv[],
                            std::string &verbosity,
+                           boost::filesystem::path &phase_report_path,
                            contractor::ContractorConfig &contractor_config)
 {
     // declare a group of options that will be allowed only on command line
@@ -38,7 +40,10 @@ return_code parseArguments(int argc,
     generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message")(
         "verbosity,l",
         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
-        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str())(
+        "phase-report",
+        boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+        "Write the time, peak memory and I/O of each phase as JSON to this file");
 
     // declare a group of options that will be allowed on command line
     boost::program_options::options_description config_options("Configuration");
@@ -54,7 +59,8 @@ return_code parseArguments(int argc,
                    boost::program_options::value<std::vector<std::string>>(
                        &contractor_config.updater_config.segment_speed_lookup_paths)
                        ->composing(),
-                   "Lookup files containing nodeA, nodeB, speed data to adjust edge weights")(
+                   "Lookup files containing nodeA, nodeB, speed data to adjust edge weights, "
+                   "`-` reads them from stdin")(
         "turn-penalty-file",
         boost::program_options::value<std::vector<std::string>>(
             &contractor_config.updater_config.turn_penalty_lookup_paths)
@@ -81,7 +87,18 @@ return_code parseArguments(int argc,
         "time-zone-file",
         boost::program_options::value<std::string>(&contractor_config.updater_config.tz_file_path),
         "Required for conditional turn restriction parsing, provide a geojson file containing "
-        "time zone boundaries");
+        "time zone boundaries")(
+        "renumber-nodes",
+        boost::program_options::bool_switch(&contractor_config.renumber_nodes)
+            ->default_value(false),
+        "Renumber the nodes of all files to the order of the contracted hierarchy for a better "
+        "memory locality of queries. Skipped if the dataset was partitioned with osrm-partition.")(
+        "reuse-hierarchy",
+        boost::program_options::bool_switch(&contractor_config.reuse_hierarchy)
+            ->default_value(false),
+        "Keep the node order and the shortcuts of the existing .hsgr file and only recompute the "
+        "weights of its edges for the updated speeds. Much faster than a contraction, but "
+        "routes can be longer than the best ones after large changes.");
 
     // hidden options, will be allowed on command line, but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -147,9 +164,11 @@ int main(int argc, char *argv[]) try
 {
     util::LogPolicy::GetInstance().Unmute();
     std::string verbosity;
+    boost::filesystem::path phase_report_path;
     contractor::ContractorConfig contractor_config;
 
-    const return_code result = parseArguments(argc, argv, verbosity, contractor_config);
+    const return_code result =
+        parseArguments(argc, argv, verbosity, phase_report_path, contractor_config);
 
     if (return_code::fail == result)
     {
@@ -192,6 +211,15 @@ int main(int argc, char *argv[]) try
     util::DumpSTXXLStats();
     util::DumpMemoryStats();
 
+    if (!phase_report_path.empty() &&
+        !util::PhaseReport::GetInstance().Write(
+            phase_report_path, "osrm-contract", contractor_config.requested_num_threads))
+    {
+        util::Log(logERROR) << "Could not write the phase report to "
+                            << phase_report_path.string();
+        return EXIT_FAILURE;
+    }
+
     return EXIT_SUCCESS;
 }
 catch (const osrm::RuntimeError &e)
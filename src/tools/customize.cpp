@@ -2,6 +2,7 @@
 
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
+#include "util/phase_report.hpp"
 #include "util/meminfo.hpp"
 #include "util/version.hpp"
 
@@ -10,6 +11,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
 #include <iostream>
 
 using namespace osrm;
@@ -21,9 +25,40 @@ enum class return_code : unsigned
     exit
 };
 
+// Parses <name>=<HH:MM>-<HH:MM>, the name is used for the files and as the metric name of the slot
+bool parseTimeSlot(const std::string &option, std::string &name, customizer::TimeSlot &time_slot)
+{
+    const auto separator = option.find('=');
+    if (separator == std::string::npos || separator == 0)
+        return false;
+
+    name = option.substr(0, separator);
+    if (!std::all_of(name.begin(), name.end(), [](const char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+        }))
+        return false;
+
+    unsigned begin_hour, begin_minute, end_hour, end_minute;
+    char trailing;
+    if (std::sscanf(option.c_str() + separator + 1,
+                    "%2u:%2u-%2u:%2u%c",
+                    &begin_hour,
+                    &begin_minute,
+                    &end_hour,
+                    &end_minute,
+                    &trailing) != 4 ||
+        begin_hour > 23 || begin_minute > 59 || end_hour > 23 || end_minute > 59)
+        return false;
+
+    time_slot = {begin_hour * 60 + begin_minute, end_hour * 60 + end_minute};
+    return time_slot.IsValid();
+}
+
 return_code parseArguments(int argc,
                            char *argv[],
                            std::string &verbosity,
+                           boost::filesystem::path &phase_report_path,
+                           std::string &time_slot,
                            customizer::CustomizationConfig &customization_config)
 {
     // declare a group of options that will be allowed only on command line
@@ -31,7 +66,10 @@ return_code parseArguments(int argc,
     generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message")(
         "verbosity,l",
         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
-        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str())(
+        "phase-report",
+        boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+        "Write the time, peak memory and I/O of each phase as JSON to this file");
 
     // declare a group of options that will be allowed both on command line
     boost::program_options::options_description config_options("Configuration");
@@ -45,7 +83,8 @@ return_code parseArguments(int argc,
             boost::program_options::value<std::vector<std::string>>(
                 &customization_config.updater_config.segment_speed_lookup_paths)
                 ->composing(),
-            "Lookup files containing nodeA, nodeB, speed data to adjust edge weights")(
+            "Lookup files containing nodeA, nodeB, speed data to adjust edge weights, "
+            "`-` reads them from stdin")(
             "turn-penalty-file",
             boost::program_options::value<std::vector<std::string>>(
                 &customization_config.updater_config.turn_penalty_lookup_paths)
@@ -70,7 +109,28 @@ return_code parseArguments(int argc,
                 &customization_config.updater_config.tz_file_path)
                 ->default_value(""),
             "Required for conditional turn restriction parsing, provide a geojson file containing "
-            "time zone boundaries");
+            "time zone boundaries")(
+            "incremental",
+            boost::program_options::bool_switch(&customization_config.incremental)
+                ->default_value(false),
+            "Reuse the existing .osrm.cell_metrics and only customize the cells whose edges "
+            "changed since the last customization")(
+            "evaluate-queries",
+            boost::program_options::value<std::size_t>(
+                &customization_config.number_of_evaluation_queries)
+                ->default_value(0),
+            "Run this number of random queries on the customized cells and report their times "
+            "to compare partitions with different cell sizes")(
+            "compress-cell-metrics",
+            boost::program_options::bool_switch(&customization_config.compress_cell_metrics)
+                ->default_value(false),
+            "Store the clique arcs of cells whose values fit as 16 bit offsets to reduce the "
+            "memory of the metrics")(
+            "time-slot",
+            boost::program_options::value<std::string>(&time_slot),
+            "Customize the metric of the departures of a time slot <name>=<HH:MM>-<HH:MM> and "
+            "write it to <input>.<name>.osrm.* instead of replacing the metric of the dataset. "
+            "Load it with osrm-datastore --metric-name, requests select it by depart_at");
 
     // hidden options, will be allowed on command line, but will not be
     // shown to the user
@@ -136,9 +196,12 @@ int main(int argc, char *argv[]) try
 {
     util::LogPolicy::GetInstance().Unmute();
     std::string verbosity;
+    boost::filesystem::path phase_report_path;
+    std::string time_slot;
     customizer::CustomizationConfig customization_config;
 
-    const auto result = parseArguments(argc, argv, verbosity, customization_config);
+    const auto result = parseArguments(
+        argc, argv, verbosity, phase_report_path, time_slot, customization_config);
 
     if (return_code::fail == result)
     {
@@ -155,6 +218,22 @@ int main(int argc, char *argv[]) try
     // set the default in/output names
     customization_config.UseDefaultOutputNames(customization_config.base_path);
 
+    if (!time_slot.empty())
+    {
+        std::string name;
+        customizer::TimeSlot slot;
+        if (!parseTimeSlot(time_slot, name, slot))
+        {
+            util::Log(logERROR) << "Time slot " << time_slot
+                                << " is not of the form <name>=<HH:MM>-<HH:MM> with a name of "
+                                   "letters, digits and underscores.";
+            return EXIT_FAILURE;
+        }
+        customization_config.UseTimeSlot(name, slot);
+        util::Log() << "Writing the metric of time slot " << name << " to "
+                    << customization_config.output_base_path.string() << ".osrm.*";
+    }
+
     if (1 > customization_config.requested_num_threads)
     {
         util::Log(logERROR) << "Number of threads must be 1 or larger";
@@ -170,6 +249,15 @@ int main(int argc, char *argv[]) try
 
     util::DumpMemoryStats();
 
+    if (!phase_report_path.empty() &&
+        !util::PhaseReport::GetInstance().Write(
+            phase_report_path, "osrm-customize", customization_config.requested_num_threads))
+    {
+        util::Log(logERROR) << "Could not write the phase report to "
+                            << phase_report_path.string();
+        return EXIT_FAILURE;
+    }
+
     return exitcode;
 }
 catch (const osrm::RuntimeError &e)
@@ -2,6 +2,7 @@
 #include "osrm/extractor.hpp"
 #include "osrm/extractor_config.hpp"
 #include "util/log.hpp"
+#include "util/phase_report.hpp"
 #include "util/version.hpp"
 
 #include <tbb/task_scheduler_init.h>
@@ -27,6 +28,7 @@ enum class return_code : unsigned
 return_code parseArguments(int argc,
                            char *argv[],
                            std::string &verbosity,
+                           boost::filesystem::path &phase_report_path,
                            extractor::ExtractorConfig &extractor_config)
 {
     // declare a group of options that will be a llowed only on command line
@@ -34,7 +36,10 @@ return_code parseArguments(int argc,
     generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message")(
         "verbosity,l",
         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
-        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str())(
+        "phase-report",
+        boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+        "Write the time, peak memory and I/O of each phase as JSON to this file");
 
     // declare a group of options that will be allowed both on command line
     boost::program_options::options_description config_options("Configuration");
@@ -42,7 +47,7 @@ return_code parseArguments(int argc,
         "profile,p",
         boost::program_options::value<boost::filesystem::path>(&extractor_config.profile_path)
             ->default_value("profiles/car.lua"),
-        "Path to LUA routing profile")(
+        "Path to LUA routing profile or to a shared library of a profile plugin")(
         "threads,t",
         boost::program_options::value<unsigned int>(&extractor_config.requested_num_threads)
             ->default_value(tbb::task_scheduler_init::default_num_threads()),
@@ -62,16 +67,77 @@ return_code parseArguments(int argc,
             ->implicit_value(true)
             ->default_value(false),
         "Save conditional restrictions found during extraction to disk for use "
-        "during contraction")("location-dependent-data",
-                              boost::program_options::value<std::vector<boost::filesystem::path>>(
-                                  &extractor_config.location_dependent_data_paths)
-                                  ->composing(),
-                              "GeoJSON files with location-dependent data")(
+        "during contraction")(
+        "skip-guidance",
+        boost::program_options::bool_switch(&extractor_config.skip_guidance)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Do not compute turn instructions and turn lanes. The dataset can not return route steps "
+        "with guidance, e.g. for datasets that only serve the table service")(
+        "compact-geometry-coordinates",
+        boost::program_options::bool_switch(&extractor_config.compact_geometry_coordinates)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Also store the coordinates of the segment geometries grouped by geometry as 16 bit deltas "
+        "to the first node, which routes decode without a random access per node")(
+        "compress-intermediate-files",
+        boost::program_options::bool_switch(&extractor_config.compress_intermediate_files)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Compress the large entries of the .osrm.cnbg, .osrm.enw and .osrm.ebg files that only "
+        "osrm-partition and osrm-contract read. Saves disk space and I/O on slow disks, their "
+        "rewrites after renumbering the nodes are stored uncompressed")(
+        "spatial-node-order",
+        boost::program_options::bool_switch(&extractor_config.spatial_node_order)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Number the nodes along a Hilbert curve of their coordinates instead of by their OSM ids, "
+        "so that nearby nodes, edge-based nodes and geometries are stored close to each other")(
+        "change-file",
+        boost::program_options::value<std::vector<boost::filesystem::path>>(
+            &extractor_config.change_paths)
+            ->composing(),
+        "OSM change files (.osc, .osc.gz) to apply to the input while it is read, in the order "
+        "they were published. The input has to be sorted by type and id")(
+        "location-dependent-data",
+        boost::program_options::value<std::vector<boost::filesystem::path>>(
+            &extractor_config.location_dependent_data_paths)
+            ->composing(),
+        "GeoJSON files with location-dependent data")(
         "disable-location-cache",
         boost::program_options::bool_switch(&extractor_config.use_locations_cache)
             ->implicit_value(false)
             ->default_value(true),
-        "Use internal nodes locations cache for location-dependent data lookups");
+        "Use internal nodes locations cache for location-dependent data lookups")(
+        "location-index",
+        boost::program_options::value<std::string>(&extractor_config.location_index_type)
+            ->default_value("auto"),
+        "Index type of the nodes locations cache: a libosmium index type like `flex_mem`, "
+        "`sparse_mem_array`, `dense_mmap_array` or `dense_file_array,<path>`, or `auto` to store "
+        "a dense file array for inputs that are large compared to the memory")(
+        "external-memory",
+        boost::program_options::value<boost::filesystem::path>(
+            &extractor_config.external_memory_path),
+        "Directory to spill the sorted nodes and edges to, instead of keeping them in memory")(
+        "relation-index",
+        boost::program_options::value<boost::filesystem::path>(
+            &extractor_config.relation_index_path),
+        "File to write the relations the profile uses to. Later extractions of the same input "
+        "and change files with a profile that uses the same relation types read the relations "
+        "from this file instead of decoding the input twice")(
+        "external-memory-buffer-size",
+        boost::program_options::value<std::size_t>(&extractor_config.external_memory_buffer_size)
+            ->default_value(1024),
+        "Size in MiB of the sorted runs of nodes and of edges in the `--external-memory` "
+        "directory")(
+        "rtree-branching-factor",
+        boost::program_options::value<std::uint32_t>(&extractor_config.rtree_branching_factor)
+            ->default_value(64),
+        "Number of children of the inner nodes of the r-tree for nearest neighbor snapping")(
+        "rtree-leaf-page-size",
+        boost::program_options::value<std::uint32_t>(&extractor_config.rtree_leaf_page_size)
+            ->default_value(4096),
+        "Size in bytes of the r-tree leaves in the .fileIndex, a power of two");
 
     bool dummy;
     // hidden options, will be allowed on command line, but will not be
@@ -143,8 +209,10 @@ int main(int argc, char *argv[]) try
     util::LogPolicy::GetInstance().Unmute();
     extractor::ExtractorConfig extractor_config;
     std::string verbosity;
+    boost::filesystem::path phase_report_path;
 
-    const auto result = parseArguments(argc, argv, verbosity, extractor_config);
+    const auto result =
+        parseArguments(argc, argv, verbosity, phase_report_path, extractor_config);
 
     if (return_code::fail == result)
     {
@@ -173,6 +241,15 @@ int main(int argc, char *argv[]) try
         return EXIT_FAILURE;
     }
 
+    for (const auto &change_path : extractor_config.change_paths)
+    {
+        if (!boost::filesystem::is_regular_file(change_path))
+        {
+            util::Log(logERROR) << "Change file " << change_path.string() << " not found!";
+            return EXIT_FAILURE;
+        }
+    }
+
     if (!boost::filesystem::is_regular_file(extractor_config.profile_path))
     {
         util::Log(logERROR) << "Profile " << extractor_config.profile_path.string()
@@ -185,6 +262,15 @@ int main(int argc, char *argv[]) try
     util::DumpSTXXLStats();
     util::DumpMemoryStats();
 
+    if (!phase_report_path.empty() &&
+        !util::PhaseReport::GetInstance().Write(
+            phase_report_path, "osrm-extract", extractor_config.requested_num_threads))
+    {
+        util::Log(logERROR) << "Could not write the phase report to "
+                            << phase_report_path.string();
+        return EXIT_FAILURE;
+    }
+
     return EXIT_SUCCESS;
 }
 catch (const osrm::RuntimeError &e)
@@ -1,23 +1,35 @@
+#include "server/api/url_parser.hpp"
+#include "server/service_handler.hpp"
+
+#include "osrm/engine_config.hpp"
+
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/log.hpp"
+#include "util/string_util.hpp"
 #include "util/timing_util.hpp"
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
+#include <cerrno>
 #include <cmath>
-#include <cstdio>
-#include <fcntl.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #ifdef __linux__
-#include <malloc.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 #include <algorithm>
-#include <chrono>
 #include <iomanip>
+#include <memory>
 #include <numeric>
-#include <random>
+#include <sstream>
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -25,11 +37,12 @@ namespace osrm
 namespace tools
 {
 
-const unsigned NUMBER_OF_ELEMENTS = 268435456;
+// granularity of the trace, the page size of the page cache
+const constexpr std::size_t IO_BLOCK_SIZE = 4096;
 
 struct Statistics
 {
-    double min, max, med, mean, dev;
+    double min, max, med, p99, mean, dev;
 };
 
 void runStatistics(std::vector<double> &timings_vector, Statistics &stats)
@@ -38,6 +51,7 @@ void runStatistics(std::vector<double> &timings_vector, Statistics &stats)
     stats.min = timings_vector.front();
     stats.max = timings_vector.back();
     stats.med = timings_vector[timings_vector.size() / 2];
+    stats.p99 = timings_vector[timings_vector.size() * 99 / 100];
     double primary_sum = std::accumulate(timings_vector.begin(), timings_vector.end(), 0.0);
     stats.mean = primary_sum / timings_vector.size();
 
@@ -45,268 +59,456 @@ void runStatistics(std::vector<double> &timings_vector, Statistics &stats)
         timings_vector.begin(), timings_vector.end(), timings_vector.begin(), 0.0);
     stats.dev = std::sqrt(primary_sq_sum / timings_vector.size() - (stats.mean * stats.mean));
 }
-}
-}
 
-boost::filesystem::path test_path;
+// A block of a dataset file that a query read first
+struct Access
+{
+    std::uint32_t query;
+    std::uint32_t file;
+    std::uint64_t block;
+};
 
-int main(int argc, char *argv[])
+struct Trace
 {
+    std::vector<std::string> files;
+    std::size_t number_of_queries = 0;
+    std::vector<Access> accesses;
+};
 
-#ifdef __FreeBSD__
-    osrm::util::Log() << "Not supported on FreeBSD";
-    return 0;
-#endif
-#ifdef _WIN32
-    osrm::util::Log() << "Not supported on Windows";
-    return 0;
-#else
+#ifdef __linux__
 
-    osrm::util::LogPolicy::GetInstance().Unmute();
-    if (1 == argc)
+// The file paths of the .osrm files of a dataset
+std::vector<std::string> getDatasetFiles(const boost::filesystem::path &base_path)
+{
+    const auto directory =
+        base_path.has_parent_path() ? base_path.parent_path() : boost::filesystem::path{"."};
+    const auto prefix = base_path.filename().string() + ".";
+
+    std::vector<std::string> files;
+    for (const auto &entry : boost::filesystem::directory_iterator(directory))
     {
-        osrm::util::Log(logWARNING) << "usage: " << argv[0] << " /path/on/device";
-        return -1;
+        const auto name = entry.path().filename().string();
+        if (boost::filesystem::is_regular_file(entry.path()) &&
+            name.compare(0, prefix.size(), prefix) == 0)
+        {
+            // the engine maps the files with their canonical paths
+            files.push_back(boost::filesystem::canonical(entry.path()).string());
+        }
     }
+    std::sort(files.begin(), files.end());
+    return files;
+}
 
-    test_path = boost::filesystem::path(argv[1]);
-    test_path /= "osrm.tst";
-    osrm::util::Log(logDEBUG) << "temporary file: " << test_path.string();
-
-    // create files for testing
-    if (2 == argc)
+// Read-only shared mapping of a file, touched blocks are read through the page cache
+class FileMapping
+{
+  public:
+    explicit FileMapping(const std::string &path) : path(path)
     {
-        // create file to test
-        if (boost::filesystem::exists(test_path))
+        file_desc = open(path.c_str(), O_RDONLY);
+        if (-1 == file_desc)
         {
-            throw osrm::util::exception("Data file already exists: " + test_path.string() +
-                                        SOURCE_REF);
+            throw util::exception("Could not open " + path + ": " + std::strerror(errno) +
+                                  SOURCE_REF);
         }
 
-        int *random_array = new int[osrm::tools::NUMBER_OF_ELEMENTS];
-        std::generate(random_array, random_array + osrm::tools::NUMBER_OF_ELEMENTS, std::rand);
-#ifdef __APPLE__
-        FILE *fd = fopen(test_path.string().c_str(), "w");
-        fcntl(fileno(fd), F_NOCACHE, 1);
-        fcntl(fileno(fd), F_RDAHEAD, 0);
-        TIMER_START(write_1gb);
-        write(fileno(fd), (char *)random_array, osrm::tools::NUMBER_OF_ELEMENTS * sizeof(unsigned));
-        TIMER_STOP(write_1gb);
-        fclose(fd);
-#endif
-#ifdef __linux__
-        int file_desc =
-            open(test_path.string().c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_SYNC, S_IRWXU);
-        if (-1 == file_desc)
+        struct stat file_stat;
+        fstat(file_desc, &file_stat);
+        size = file_stat.st_size;
+        if (size > 0)
         {
-            throw osrm::util::exception("Could not open random data file" + test_path.string() +
-                                        SOURCE_REF);
+            data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file_desc, 0);
+            if (MAP_FAILED == data)
+            {
+                close(file_desc);
+                throw util::exception("Could not map " + path + ": " + std::strerror(errno) +
+                                      SOURCE_REF);
+            }
+            // no read-ahead, only the blocks that are touched are read
+            madvise(data, size, MADV_RANDOM);
         }
-        TIMER_START(write_1gb);
-        int ret =
-            write(file_desc, random_array, osrm::tools::NUMBER_OF_ELEMENTS * sizeof(unsigned));
-        if (0 > ret)
+    }
+
+    ~FileMapping()
+    {
+        if (size > 0)
         {
-            throw osrm::util::exception("could not write random data file" + test_path.string() +
-                                        SOURCE_REF);
+            munmap(data, size);
         }
-        TIMER_STOP(write_1gb);
         close(file_desc);
-#endif
-        delete[] random_array;
-        osrm::util::Log(logDEBUG) << "writing raw 1GB took " << TIMER_SEC(write_1gb) << "s";
-        osrm::util::Log() << "raw write performance: " << std::setprecision(5) << std::fixed
-                          << 1024 * 1024 / TIMER_SEC(write_1gb) << "MB/sec";
+    }
+
+    FileMapping(const FileMapping &) = delete;
+    FileMapping &operator=(const FileMapping &) = delete;
 
-        osrm::util::Log(logDEBUG) << "finished creation of random data. Flush disk cache now!";
+    // Drops the clean, not mapped pages of the file from the page cache
+    void Evict() const { posix_fadvise(file_desc, 0, 0, POSIX_FADV_DONTNEED); }
+
+    // Which blocks of the file are in the page cache
+    std::vector<unsigned char> GetResidency() const
+    {
+        std::vector<unsigned char> residency(GetNumberOfBlocks());
+        if (size > 0 && -1 == mincore(data, size, residency.data()))
+        {
+            throw util::exception("Could not get the resident pages of " + path + ": " +
+                                  std::strerror(errno) + SOURCE_REF);
+        }
+        return residency;
     }
-    else
+
+    char Touch(const std::uint64_t block) const
     {
-        // Run Non-Cached I/O benchmarks
-        if (!boost::filesystem::exists(test_path))
+        return static_cast<const volatile char *>(data)[block * IO_BLOCK_SIZE];
+    }
+
+    std::size_t GetNumberOfBlocks() const { return (size + IO_BLOCK_SIZE - 1) / IO_BLOCK_SIZE; }
+
+  private:
+    std::string path;
+    int file_desc;
+    std::size_t size;
+    void *data = nullptr;
+};
+
+// The engine maps the files of a lazily loaded dataset itself, read-ahead on its mappings would
+// add blocks to the trace that no query reads
+void adviseRandomAccess(const std::vector<std::string> &files)
+{
+    boost::filesystem::ifstream maps("/proc/self/maps");
+    std::string line;
+    while (std::getline(maps, line))
+    {
+        std::istringstream fields(line);
+        std::string range, permissions, offset, device, inode, path;
+        fields >> range >> permissions >> offset >> device >> inode >> path;
+        if (std::find(files.begin(), files.end(), path) == files.end())
         {
-            throw osrm::util::exception("data file does not exist" + SOURCE_REF);
+            continue;
         }
 
-        // volatiles do not get optimized
-        osrm::tools::Statistics stats;
+        const auto separator = range.find('-');
+        const auto start = std::stoull(range.substr(0, separator), nullptr, 16);
+        const auto end = std::stoull(range.substr(separator + 1), nullptr, 16);
+        madvise(reinterpret_cast<void *>(start), end - start, MADV_RANDOM);
+    }
+}
 
-#ifdef __APPLE__
-        volatile unsigned single_block[1024];
-        char *raw_array = new char[osrm::tools::NUMBER_OF_ELEMENTS * sizeof(unsigned)];
-        FILE *fd = fopen(test_path.string().c_str(), "r");
-        fcntl(fileno(fd), F_NOCACHE, 1);
-        fcntl(fileno(fd), F_RDAHEAD, 0);
-#endif
-#ifdef __linux__
-        char *single_block = (char *)memalign(512, 1024 * sizeof(unsigned));
+void writeTrace(const std::string &path, const Trace &trace)
+{
+    boost::filesystem::ofstream output(path, std::ios::trunc);
+    output << "queries " << trace.number_of_queries << "\n";
+    for (const auto &file : trace.files)
+    {
+        output << "file " << file << "\n";
+    }
+    for (const auto &access : trace.accesses)
+    {
+        output << access.query << " " << access.file << " " << access.block << "\n";
+    }
+    if (!output)
+    {
+        throw util::exception("Could not write the trace " + path + SOURCE_REF);
+    }
+}
 
-        int file_desc = open(test_path.string().c_str(), O_RDONLY | O_DIRECT | O_SYNC);
-        if (-1 == file_desc)
+Trace readTrace(const std::string &path)
+{
+    boost::filesystem::ifstream input(path);
+    if (!input)
+    {
+        throw util::exception("Could not open the trace " + path + SOURCE_REF);
+    }
+
+    Trace trace;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (line.compare(0, 8, "queries ") == 0)
         {
-            osrm::util::Log(logDEBUG) << "opened, error: " << strerror(errno);
-            return -1;
+            trace.number_of_queries = std::stoull(line.substr(8));
         }
-        char *raw_array = (char *)memalign(512, osrm::tools::NUMBER_OF_ELEMENTS * sizeof(unsigned));
-#endif
-        TIMER_START(read_1gb);
-#ifdef __APPLE__
-        read(fileno(fd), raw_array, osrm::tools::NUMBER_OF_ELEMENTS * sizeof(unsigned));
-        close(fileno(fd));
-        fd = fopen(test_path.string().c_str(), "r");
-#endif
-#ifdef __linux__
-        int ret = read(file_desc, raw_array, osrm::tools::NUMBER_OF_ELEMENTS * sizeof(unsigned));
-        osrm::util::Log(logDEBUG) << "read " << ret << " bytes, error: " << strerror(errno);
-        close(file_desc);
-        file_desc = open(test_path.string().c_str(), O_RDONLY | O_DIRECT | O_SYNC);
-        osrm::util::Log(logDEBUG) << "opened, error: " << strerror(errno);
-#endif
-        TIMER_STOP(read_1gb);
+        else if (line.compare(0, 5, "file ") == 0)
+        {
+            trace.files.push_back(line.substr(5));
+        }
+        else if (!line.empty())
+        {
+            std::istringstream fields(line);
+            Access access;
+            fields >> access.query >> access.file >> access.block;
+            if (!fields || access.file >= trace.files.size() ||
+                access.query >= trace.number_of_queries)
+            {
+                throw util::exception("Invalid line in the trace " + path + ": " + line +
+                                      SOURCE_REF);
+            }
+            trace.accesses.push_back(access);
+        }
+    }
+    return trace;
+}
 
-        osrm::util::Log(logDEBUG) << "reading raw 1GB took " << TIMER_SEC(read_1gb) << "s";
-        osrm::util::Log() << "raw read performance: " << std::setprecision(5) << std::fixed
-                          << 1024 * 1024 / TIMER_SEC(read_1gb) << "MB/sec";
+// Runs the queries of a file against a lazily loaded dataset and records for every query the
+// blocks of the dataset files that it reads first. Blocks that stay in the page cache after
+// loading, like the tar headers, are not part of the trace.
+Trace recordTrace(const std::string &base_path,
+                  const std::string &queries_path,
+                  const EngineConfig::Algorithm algorithm)
+{
+    Trace trace;
+    trace.files = getDatasetFiles(base_path);
+
+    EngineConfig config;
+    config.storage_config = {base_path};
+    config.storage_config.lazy_loading = true;
+    config.use_shared_memory = false;
+    config.algorithm = algorithm;
+    server::ServiceHandler service_handler{config};
+
+    adviseRandomAccess(trace.files);
+    std::vector<std::unique_ptr<FileMapping>> mappings;
+    std::vector<std::vector<unsigned char>> residencies;
+    for (const auto &file : trace.files)
+    {
+        mappings.push_back(std::make_unique<FileMapping>(file));
+        mappings.back()->Evict();
+        residencies.push_back(mappings.back()->GetResidency());
+    }
 
-        std::vector<double> timing_results_raw_random;
-        osrm::util::Log(logDEBUG) << "running 1000 random I/Os of 4KB";
+    boost::filesystem::ifstream queries(queries_path);
+    if (!queries)
+    {
+        throw util::exception("Could not open the query file " + queries_path + SOURCE_REF);
+    }
 
-#ifdef __APPLE__
-        fseek(fd, 0, SEEK_SET);
-#endif
-#ifdef __linux__
-        lseek(file_desc, 0, SEEK_SET);
-#endif
-        // make 1000 random access, time each I/O seperately
-        unsigned number_of_blocks = (osrm::tools::NUMBER_OF_ELEMENTS * sizeof(unsigned) - 1) / 4096;
-        std::random_device rd;
-        std::default_random_engine e1(rd());
-        std::uniform_int_distribution<unsigned> uniform_dist(0, number_of_blocks - 1);
-        for (unsigned i = 0; i < 1000; ++i)
+    std::size_t failed = 0;
+    std::string line;
+    while (std::getline(queries, line))
+    {
+        // the paths of the HTTP API, or the access log lines of osrm-routed
+        const auto first = line.find('/');
+        if (line.empty() || line[0] == '#' || first == std::string::npos)
         {
-            unsigned block_to_read = uniform_dist(e1);
-            off_t current_offset = block_to_read * 4096;
-            TIMER_START(random_access);
-#ifdef __APPLE__
-            int ret1 = fseek(fd, current_offset, SEEK_SET);
-            int ret2 = read(fileno(fd), (char *)&single_block[0], 4096);
-#endif
+            continue;
+        }
+        const auto last = line.find_first_of(" \t\r", first);
+        std::string url;
+        util::URIDecode(line.substr(first, last == std::string::npos ? last : last - first), url);
 
-#ifdef __FreeBSD__
-            int ret1 = 0;
-            int ret2 = 0;
-#endif
+        const auto parsed_url = server::api::parseURL(url);
+        server::ServiceHandler::ResultT result;
+        if (!parsed_url || service_handler.RunQuery(*parsed_url, result, {}) != engine::Status::Ok)
+        {
+            ++failed;
+        }
 
-#ifdef __linux__
-            int ret1 = lseek(file_desc, current_offset, SEEK_SET);
-            int ret2 = read(file_desc, (char *)single_block, 4096);
-#endif
-            TIMER_STOP(random_access);
-            if (((off_t)-1) == ret1)
-            {
-                osrm::util::Log(logWARNING) << "offset: " << current_offset;
-                osrm::util::Log(logWARNING) << "seek error " << strerror(errno);
-                throw osrm::util::exception("seek error" + SOURCE_REF);
-            }
-            if (-1 == ret2)
+        for (std::uint32_t file = 0; file < mappings.size(); ++file)
+        {
+            auto residency = mappings[file]->GetResidency();
+            for (std::uint64_t block = 0; block < residency.size(); ++block)
             {
-                osrm::util::Log(logWARNING) << "offset: " << current_offset;
-                osrm::util::Log(logWARNING) << "read error " << strerror(errno);
-                throw osrm::util::exception("read error" + SOURCE_REF);
+                if ((residency[block] & 1) && !(residencies[file][block] & 1))
+                {
+                    trace.accesses.push_back(
+                        {static_cast<std::uint32_t>(trace.number_of_queries), file, block});
+                }
             }
-            timing_results_raw_random.push_back(TIMER_SEC(random_access));
+            residencies[file] = std::move(residency);
         }
+        ++trace.number_of_queries;
+    }
 
-        // Do statistics
-        osrm::util::Log(logDEBUG) << "running raw random I/O statistics";
-        std::ofstream random_csv("random.csv", std::ios::trunc);
-        for (unsigned i = 0; i < timing_results_raw_random.size(); ++i)
+    if (failed > 0)
+    {
+        util::Log(logWARNING) << failed << " queries failed, their reads are part of the trace";
+    }
+    return trace;
+}
+
+// Replays the blocks of every query with read_block and returns the time per query in ms
+template <typename ReadBlock>
+std::vector<double> replayTrace(const Trace &trace, const ReadBlock &read_block)
+{
+    std::vector<double> timings;
+    timings.reserve(trace.number_of_queries);
+    auto access = trace.accesses.begin();
+    for (std::uint32_t query = 0; query < trace.number_of_queries; ++query)
+    {
+        TIMER_START(query);
+        for (; access != trace.accesses.end() && access->query == query; ++access)
         {
-            random_csv << i << ", " << timing_results_raw_random[i] << std::endl;
+            read_block(*access);
         }
-        osrm::tools::runStatistics(timing_results_raw_random, stats);
-
-        osrm::util::Log() << "raw random I/O: " << std::setprecision(5) << std::fixed
-                          << "min: " << stats.min << "ms, "
-                          << "mean: " << stats.mean << "ms, "
-                          << "med: " << stats.med << "ms, "
-                          << "max: " << stats.max << "ms, "
-                          << "dev: " << stats.dev << "ms";
-
-        std::vector<double> timing_results_raw_seq;
-#ifdef __APPLE__
-        fseek(fd, 0, SEEK_SET);
-#endif
-#ifdef __linux__
-        lseek(file_desc, 0, SEEK_SET);
-#endif
+        TIMER_STOP(query);
+        timings.push_back(TIMER_MSEC(query));
+    }
+    return timings;
+}
 
-        // read every 100th block
-        for (unsigned i = 0; i < 1000; ++i)
-        {
-            off_t current_offset = i * 4096;
-            TIMER_START(read_every_100);
-#ifdef __APPLE__
-            int ret1 = fseek(fd, current_offset, SEEK_SET);
-            int ret2 = read(fileno(fd), (char *)&single_block, 4096);
-#endif
+void logTimings(const std::string &mode, const Trace &trace, std::vector<double> timings)
+{
+    if (timings.empty())
+    {
+        return;
+    }
 
-#ifdef __FreeBSD__
-            int ret1 = 0;
-            int ret2 = 0;
-#endif
+    const auto total = std::accumulate(timings.begin(), timings.end(), 0.0);
+    Statistics stats;
+    runStatistics(timings, stats);
+    util::Log() << mode << ": " << trace.accesses.size() << " blocks of "
+                << trace.number_of_queries << " queries in " << std::setprecision(5)
+                << std::fixed << total / 1000. << "s, per query "
+                << "min: " << stats.min << "ms, "
+                << "mean: " << stats.mean << "ms, "
+                << "med: " << stats.med << "ms, "
+                << "p99: " << stats.p99 << "ms, "
+                << "max: " << stats.max << "ms, "
+                << "dev: " << stats.dev << "ms";
+}
 
-#ifdef __linux__
-            int ret1 = lseek(file_desc, current_offset, SEEK_SET);
+// Pages of a file-backed deployment, the blocks are read from the page cache or the device
+void replayMapped(const Trace &trace)
+{
+    std::vector<std::unique_ptr<FileMapping>> mappings;
+    for (const auto &file : trace.files)
+    {
+        mappings.push_back(std::make_unique<FileMapping>(file));
+        mappings.back()->Evict();
+    }
 
-            int ret2 = read(file_desc, (char *)single_block, 4096);
-#endif
-            TIMER_STOP(read_every_100);
-            if (((off_t)-1) == ret1)
-            {
-                osrm::util::Log(logWARNING) << "offset: " << current_offset;
-                osrm::util::Log(logWARNING) << "seek error " << strerror(errno);
-                throw osrm::util::exception("seek error" + SOURCE_REF);
-            }
-            if (-1 == ret2)
-            {
-                osrm::util::Log(logWARNING) << "offset: " << current_offset;
-                osrm::util::Log(logWARNING) << "read error " << strerror(errno);
-                throw osrm::util::exception("read error" + SOURCE_REF);
-            }
-            timing_results_raw_seq.push_back(TIMER_SEC(read_every_100));
-        }
-#ifdef __APPLE__
-        fclose(fd);
-        // free(single_element);
-        free(raw_array);
-// free(single_block);
-#endif
-#ifdef __linux__
-        close(file_desc);
-#endif
-        // Do statistics
-        osrm::util::Log(logDEBUG) << "running sequential I/O statistics";
-        // print simple statistics: min, max, median, variance
-        std::ofstream seq_csv("sequential.csv", std::ios::trunc);
-        for (unsigned i = 0; i < timing_results_raw_seq.size(); ++i)
+    volatile char sink = 0;
+    logTimings("mmap", trace, replayTrace(trace, [&](const Access &access) {
+                   sink = sink + mappings[access.file]->Touch(access.block);
+               }));
+}
+
+// The files loaded into memory like osrm-datastore does for shared memory deployments
+void replayMemory(const Trace &trace)
+{
+    TIMER_START(load);
+    std::vector<std::vector<char>> memory;
+    for (const auto &file : trace.files)
+    {
+        boost::filesystem::ifstream input(file, std::ios::binary);
+        memory.emplace_back(boost::filesystem::file_size(file));
+        input.read(memory.back().data(), memory.back().size());
+    }
+    TIMER_STOP(load);
+    util::Log() << "memory: loaded the files in " << TIMER_SEC(load) << "s";
+
+    volatile char sink = 0;
+    logTimings("memory", trace, replayTrace(trace, [&](const Access &access) {
+                   sink = sink + memory[access.file][access.block * IO_BLOCK_SIZE];
+               }));
+}
+
+// Reads of the blocks that bypass the page cache, the latency of the device
+void replayDirect(const Trace &trace)
+{
+    std::vector<int> file_descs;
+    for (const auto &file : trace.files)
+    {
+        const int file_desc = open(file.c_str(), O_RDONLY | O_DIRECT);
+        if (-1 == file_desc)
         {
-            seq_csv << i << ", " << timing_results_raw_seq[i] << std::endl;
+            throw util::exception("Could not open " + file + " with O_DIRECT: " +
+                                  std::strerror(errno) + SOURCE_REF);
         }
-        osrm::tools::runStatistics(timing_results_raw_seq, stats);
-        osrm::util::Log() << "raw sequential I/O: " << std::setprecision(5) << std::fixed
-                          << "min: " << stats.min << "ms, "
-                          << "mean: " << stats.mean << "ms, "
-                          << "med: " << stats.med << "ms, "
-                          << "max: " << stats.max << "ms, "
-                          << "dev: " << stats.dev << "ms";
-
-        if (boost::filesystem::exists(test_path))
+        file_descs.push_back(file_desc);
+    }
+
+    void *aligned_memory = nullptr;
+    if (0 != posix_memalign(&aligned_memory, IO_BLOCK_SIZE, IO_BLOCK_SIZE))
+    {
+        throw util::exception("Could not allocate the read buffer" + SOURCE_REF);
+    }
+    const std::unique_ptr<void, decltype(&free)> buffer(aligned_memory, &free);
+
+    logTimings("direct", trace, replayTrace(trace, [&](const Access &access) {
+                   if (-1 == pread(file_descs[access.file],
+                                   buffer.get(),
+                                   IO_BLOCK_SIZE,
+                                   access.block * IO_BLOCK_SIZE))
+                   {
+                       throw util::exception("Could not read " + trace.files[access.file] +
+                                             ": " + std::strerror(errno) + SOURCE_REF);
+                   }
+               }));
+
+    for (const auto file_desc : file_descs)
+    {
+        close(file_desc);
+    }
+}
+
+void logTrace(const Trace &trace)
+{
+    std::vector<std::size_t> blocks(trace.files.size(), 0);
+    for (const auto &access : trace.accesses)
+    {
+        ++blocks[access.file];
+    }
+
+    for (std::size_t file = 0; file < trace.files.size(); ++file)
+    {
+        if (blocks[file] > 0)
         {
-            boost::filesystem::remove(test_path);
-            osrm::util::Log(logDEBUG) << "removing temporary files";
+            util::Log() << trace.files[file] << ": " << blocks[file] << " blocks ("
+                        << (blocks[file] * IO_BLOCK_SIZE >> 20) << " MiB)";
         }
     }
-    return EXIT_SUCCESS;
+    util::Log() << trace.number_of_queries << " queries read " << trace.accesses.size()
+                << " blocks (" << (trace.accesses.size() * IO_BLOCK_SIZE >> 20) << " MiB)";
+}
+
 #endif
 }
+}
+
+int main(int argc, char *argv[]) try
+{
+#ifndef __linux__
+    osrm::util::Log() << "Only supported on Linux";
+    return 0;
+#else
+    using namespace osrm;
+
+    util::LogPolicy::GetInstance().Unmute();
+    const std::string command = argc > 1 ? argv[1] : "";
+    if (command == "record" && argc >= 5)
+    {
+        const std::string algorithm = argc > 5 ? argv[5] : "CH";
+        const auto trace = tools::recordTrace(argv[2],
+                                              argv[3],
+                                              algorithm == "MLD" ? EngineConfig::Algorithm::MLD
+                                                                 : EngineConfig::Algorithm::CH);
+        tools::logTrace(trace);
+        tools::writeTrace(argv[4], trace);
+        return EXIT_SUCCESS;
+    }
+    if (command == "replay" && argc >= 3)
+    {
+        const auto trace = tools::readTrace(argv[2]);
+        const std::string mode = argc > 3 ? argv[3] : "all";
+        tools::logTrace(trace);
+        if (mode == "mmap" || mode == "all")
+            tools::replayMapped(trace);
+        if (mode == "memory" || mode == "all")
+            tools::replayMemory(trace);
+        if (mode == "direct" || mode == "all")
+            tools::replayDirect(trace);
+        return EXIT_SUCCESS;
+    }
+
+    util::Log(logWARNING) << "usage: " << argv[0]
+                          << " record data.osrm queries.txt trace.txt [CH|MLD]\n"
+                          << "       " << argv[0]
+                          << " replay trace.txt [mmap|memory|direct|all]";
+    return EXIT_FAILURE;
+#endif
+}
+catch (const std::exception &e)
+{
+    osrm::util::Log(logERROR) << e.what();
+    return EXIT_FAILURE;
+}
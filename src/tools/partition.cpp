@@ -1,8 +1,10 @@
+#include "partitioner/multi_level_partition.hpp"
 #include "partitioner/partitioner.hpp"
 #include "partitioner/partitioner_config.hpp"
 
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
+#include "util/phase_report.hpp"
 #include "util/meminfo.hpp"
 #include "util/timing_util.hpp"
 #include "util/version.hpp"
@@ -71,6 +73,7 @@ void validate(boost::any &v, const std::vector<std::string> &values, MaxCellSize
 return_code parseArguments(int argc,
                            char *argv[],
                            std::string &verbosity,
+                           boost::filesystem::path &phase_report_path,
                            partitioner::PartitionerConfig &config)
 {
     // declare a group of options that will be allowed only on command line
@@ -78,7 +81,10 @@ return_code parseArguments(int argc,
     generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message")(
         "verbosity,l",
         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
-        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str())(
+        "phase-report",
+        boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+        "Write the time, peak memory and I/O of each phase as JSON to this file");
 
     // declare a group of options that will be allowed both on command line
     boost::program_options::options_description config_options("Configuration");
@@ -181,6 +187,15 @@ return_code parseArguments(int argc,
                 << "The maximum cell sizes array must be sorted in non-descending order.";
             return return_code::fail;
         }
+        if (config.max_cell_sizes.empty() ||
+            config.max_cell_sizes.size() > partitioner::MultiLevelPartition::MAX_NUM_CELL_LEVELS)
+        {
+            util::Log(logERROR) << "The maximum cell sizes array needs between 1 and "
+                                << static_cast<int>(
+                                       partitioner::MultiLevelPartition::MAX_NUM_CELL_LEVELS)
+                                << " values.";
+            return return_code::fail;
+        }
     }
 
     return return_code::ok;
@@ -190,9 +205,11 @@ int main(int argc, char *argv[]) try
 {
     util::LogPolicy::GetInstance().Unmute();
     std::string verbosity;
+    boost::filesystem::path phase_report_path;
     partitioner::PartitionerConfig partition_config;
 
-    const auto result = parseArguments(argc, argv, verbosity, partition_config);
+    const auto result =
+        parseArguments(argc, argv, verbosity, phase_report_path, partition_config);
 
     if (return_code::fail == result)
     {
@@ -243,6 +260,15 @@ int main(int argc, char *argv[]) try
 
     util::DumpMemoryStats();
 
+    if (!phase_report_path.empty() &&
+        !util::PhaseReport::GetInstance().Write(
+            phase_report_path, "osrm-partition", partition_config.requested_num_threads))
+    {
+        util::Log(logERROR) << "Could not write the phase report to "
+                            << phase_report_path.string();
+        return EXIT_FAILURE;
+    }
+
     return exitcode;
 }
 catch (const osrm::RuntimeError &e)
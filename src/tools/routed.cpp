@@ -1,7 +1,10 @@
 #include "server/server.hpp"
+#include "storage/shared_datatype.hpp"
+#include "storage/shared_monitor.hpp"
 #include "util/exception_utils.hpp"
 #include "util/log.hpp"
 #include "util/meminfo.hpp"
+#include "util/string_util.hpp"
 #include "util/version.hpp"
 
 #include "osrm/engine_config.hpp"
@@ -12,6 +15,7 @@
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/any.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
 #include <boost/program_options.hpp>
 
 #include <cstdlib>
@@ -26,6 +30,9 @@
 #include <new>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #ifdef _WIN32
 boost::function0<void> console_ctrl_function;
@@ -70,7 +77,44 @@ std::istream &operator>>(std::istream &in, EngineConfig::Algorithm &algorithm)
         throw util::RuntimeError(token, ErrorCode::UnknownAlgorithm, SOURCE_REF);
     return in;
 }
+
+std::istream &operator>>(std::istream &in, EngineConfig::HeapStorage &heap_storage)
+{
+    std::string token;
+    in >> token;
+    boost::to_lower(token);
+
+    if (token == "map")
+        heap_storage = EngineConfig::HeapStorage::UnorderedMap;
+    else if (token == "array")
+        heap_storage = EngineConfig::HeapStorage::GenerationArray;
+    else if (token == "paged")
+        heap_storage = EngineConfig::HeapStorage::PagedGenerationArray;
+    else
+        throw boost::program_options::invalid_option_value(token);
+    return in;
+}
+}
 }
+
+// The paths of the HTTP API, or the access log lines of osrm-routed, one per line
+std::vector<std::string> readWarmUpURLs(std::istream &input)
+{
+    std::vector<std::string> urls;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        const auto first = line.find('/');
+        if (line.empty() || line[0] == '#' || first == std::string::npos)
+        {
+            continue;
+        }
+        const auto last = line.find_first_of(" \t\r", first);
+        std::string url;
+        util::URIDecode(line.substr(first, last == std::string::npos ? last : last - first), url);
+        urls.push_back(std::move(url));
+    }
+    return urls;
 }
 
 // generate boost::program_options object for the routing part
@@ -79,9 +123,26 @@ inline unsigned generateServerProgramOptions(const int argc,
                                              boost::filesystem::path &base_path,
                                              std::string &ip_address,
                                              int &ip_port,
+                                             std::string &unix_socket_path,
                                              bool &trial,
                                              EngineConfig &config,
-                                             int &requested_thread_num)
+                                             int &requested_thread_num,
+                                             bool &io_service_per_thread,
+                                             int &worker_thread_num,
+                                             int &worker_queue_size,
+                                             double &max_queue_wait,
+                                             std::vector<std::string> &batch_services,
+                                             int &batch_min_coordinates,
+                                             double &request_timeout,
+                                             bool &coalesce_requests,
+                                             double &trace_sample_rate,
+                                             bool &cache_validators,
+                                             std::vector<std::string> &cache_control,
+                                             server::CompressionConfig &compression,
+                                             bool &pin_threads,
+                                             bool &warm_up,
+                                             boost::filesystem::path &warm_up_file,
+                                             std::vector<std::string> &profiles)
 {
     using boost::filesystem::path;
     using boost::program_options::value;
@@ -111,15 +172,143 @@ inline unsigned generateServerProgramOptions(const int argc,
         ("port,p",
          value<int>(&ip_port)->default_value(5000),
          "TCP/IP port") //
+        ("unix-socket",
+         value<std::string>(&unix_socket_path),
+         "Path of a unix domain socket to accept connections on in addition to the TCP/IP "
+         "port") //
         ("threads,t",
          value<int>(&requested_thread_num)->default_value(hardware_threads),
          "Number of threads to use") //
+        ("io-service-per-thread",
+         value<bool>(&io_service_per_thread)->implicit_value(true)->default_value(false),
+         "Run a separate io service and acceptor on every thread instead of sharing one") //
+        ("worker-threads",
+         value<int>(&worker_thread_num)->default_value(0),
+         "Number of routing worker threads. Default: 0, requests are handled on the I/O "
+         "threads.") //
+        ("worker-queue-size",
+         value<int>(&worker_queue_size)->default_value(128),
+         "Max. queued requests per service before the server replies with 503") //
+        ("max-queue-wait",
+         value<double>(&max_queue_wait)->default_value(0),
+         "Seconds a request may wait for a routing worker before it is answered with 503. New "
+         "requests are rejected right away while the queue is that far behind. Default: 0, no "
+         "limit.") //
+        ("batch-service",
+         value<std::vector<std::string>>(&batch_services)->composing(),
+         "Service whose requests the routing workers serve after all others, e.g. table. Can be "
+         "repeated. Requests with the header X-OSRM-Priority: batch are served last as "
+         "well.") //
+        ("batch-min-coordinates",
+         value<int>(&batch_min_coordinates)->default_value(0),
+         "Serve requests with at least this many coordinates after all others. Default: 0, "
+         "disabled.") //
+        ("request-timeout",
+         value<double>(&request_timeout)->default_value(0),
+         "Seconds after which a request, including the time it is queued, is stopped and "
+         "answered with 503. Default: 0, no timeout.") //
+        ("coalesce-requests",
+         value<bool>(&coalesce_requests)->implicit_value(true)->default_value(false),
+         "Answer identical requests that arrive while the first of them is computed with its "
+         "reply instead of computing them again.") //
+        ("trace-sample-rate",
+         value<double>(&trace_sample_rate)->default_value(0),
+         "Share of the requests, from 0 to 1, whose stages are timed and logged as [trace] "
+         "lines. Default: 0, no requests are traced.") //
+        ("cache-validators",
+         value<bool>(&cache_validators)->implicit_value(true)->default_value(false),
+         "Send an ETag and a Last-Modified header of the dataset version with successful "
+         "replies and answer GET requests whose If-None-Match matches with 304.") //
+        ("cache-control",
+         value<std::vector<std::string>>(&cache_control)->composing(),
+         "Cache-Control header of the successful replies of a service, given as "
+         "<service>=<value>, e.g. route=public,max-age=3600. Can be repeated.") //
+        ("compression-level",
+         value<int>(&compression.level)->default_value(1),
+         "zlib level of gzip and deflate compressed replies, from 1, the fastest, to 9, the "
+         "smallest.") //
+        ("compression-min-size",
+         value<std::size_t>(&compression.min_size)->default_value(0),
+         "Replies of fewer bytes are sent uncompressed. Default: 0, all replies are compressed "
+         "for clients that accept it.") //
+        ("warm-up",
+         value<bool>(&warm_up)->implicit_value(true)->default_value(false),
+         "Allocate the query heaps of all threads that handle requests before serving them.") //
+        ("warm-up-file",
+         value<boost::filesystem::path>(&warm_up_file),
+         "File of request URLs, or osrm-routed access log lines, that every thread runs before "
+         "serving requests to touch the data they need. Implies --warm-up.") //
+        ("profile",
+         value<std::vector<std::string>>(&profiles)->composing(),
+         "Serve a dataset for the requests of a profile, given as <profile>=<base.osrm> or as "
+         "<profile>=<dataset name> with shared memory. Can be repeated, all datasets share the "
+         "threads of the server. Replaces the base path.") //
         ("shared-memory,s",
          value<bool>(&config.use_shared_memory)->implicit_value(true)->default_value(false),
          "Load data from shared memory") //
         ("memory_file",
          value<boost::filesystem::path>(&config.memory_file),
-         "Store data in a memory mapped file rather than in process memory.") //
+         "Map the dataset from an image file rather than loading it into process memory. A "
+         "missing image is written first, osrm-datastore --prepare-image writes it ahead.") //
+        ("populate-memory-file",
+         value<bool>(&config.storage_config.populate_memory_file)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Read all pages of the memory_file at startup instead of when queries first touch "
+         "them.") //
+        ("watch-memory-file",
+         value<bool>(&config.watch_memory_file)->implicit_value(true)->default_value(false),
+         "Map the new image once osrm-datastore --prepare-image replaced the memory_file. Servers "
+         "in other containers that mount the directory of the image on tmpfs or hugetlbfs share "
+         "its memory.") //
+        ("lazy-loading",
+         value<bool>(&config.storage_config.lazy_loading)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Map the .osrm files instead of loading them into process memory, so that the server "
+         "starts at once and only reads the parts of the dataset that requests use.") //
+        ("load-rtree-leaves",
+         value<bool>(&config.storage_config.load_rtree_leaves)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Load the r-tree leaves of the .fileIndex into memory instead of mapping the file. "
+         "With shared memory osrm-datastore decides this.") //
+        ("lock-rtree-leaves",
+         value<bool>(&config.storage_config.lock_rtree_leaves)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Lock the loaded r-tree leaves into RAM. Implies --load-rtree-leaves.") //
+        ("skip-osm-node-ids",
+         value<bool>(&config.storage_config.skip_osm_node_ids)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Do not load the OSM node ids. Responses omit the nodes of nearest waypoints and of "
+         "annotations=true, requests for annotations=nodes are rejected. With shared memory "
+         "osrm-datastore decides this, mapped files are not affected.") //
+        ("numa-interleave",
+         value<bool>(&config.storage_config.numa_interleave)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Spread the pages of the process memory round-robin over the NUMA nodes.") //
+        ("verify-checksums",
+         value<bool>(&config.storage_config.verify_checksums)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Compare the checksums that the tools store with the blocks of the files before "
+         "loading or mapping them. With shared memory osrm-datastore decides this.") //
+        ("numa-replicas",
+         value<bool>(&config.numa_replicas)->implicit_value(true)->default_value(false),
+         "Load one copy of the dataset per NUMA node into process memory, queries use the copy "
+         "of the node their thread runs on. Best combined with --pin-threads.") //
+        ("pin-threads",
+         value<bool>(&pin_threads)->implicit_value(true)->default_value(false),
+         "Pin the I/O and worker threads round-robin to the NUMA nodes.") //
+        ("huge-pages",
+         value<storage::HugePages>(&config.storage_config.huge_pages)
+             ->default_value(storage::HugePages::None, "none"),
+         "Page size of the process memory the data is loaded into. Can be none, transparent "
+         "or explicit (pages reserved in /proc/sys/vm/nr_hugepages). With shared memory "
+         "osrm-datastore decides this.") //
         ("dataset-name",
          value<std::string>(&config.dataset_name),
          "Name of the shared memory dataset to connect to.") //
@@ -127,24 +316,92 @@ inline unsigned generateServerProgramOptions(const int argc,
          value<EngineConfig::Algorithm>(&config.algorithm)
              ->default_value(EngineConfig::Algorithm::CH, "CH"),
          "Algorithm to use for the data. Can be CH, CoreCH, MLD.") //
+        ("heap-storage",
+         value<EngineConfig::HeapStorage>(&config.heap_storage)
+             ->default_value(EngineConfig::HeapStorage::UnorderedMap, "map"),
+         "Node index storage of the query heaps. Can be map, array (fastest, memory per node "
+         "and thread) or paged (array pages allocated on demand).") //
+        ("max-heap-memory",
+         value<int>(&config.max_heap_memory)->default_value(0),
+         "Max. MiB that the query heaps of all threads keep from previous queries, threads "
+         "above their share shrink their heaps. Default: 0, heaps keep the memory of their "
+         "largest query.") //
+        ("parallel-search-distance",
+         value<double>(&config.parallel_search_distance)->default_value(0),
+         "Min. distance in meters between two waypoints for the MLD route search to run its "
+         "forward and reverse halves on two threads. Default: 0, searches run on one thread.") //
+        ("unpacking-cache-size",
+         value<int>(&config.unpacking_cache_size)->default_value(0),
+         "Number of CH shortcuts per thread whose unpacked paths are cached across queries. "
+         "Default: 0, no caching.") //
         ("max-viaroute-size",
          value<int>(&config.max_locations_viaroute)->default_value(500),
          "Max. locations supported in viaroute query") //
+        ("route-cache-size",
+         value<int>(&config.route_cache_size)->default_value(0),
+         "Number of routes cached across route queries, the cache is cleared when a new dataset "
+         "is loaded. Default: 0, no caching.") //
         ("max-trip-size",
          value<int>(&config.max_locations_trip)->default_value(100),
          "Max. locations supported in trip query") //
+        ("trip-threads",
+         value<int>(&config.trip_threads)->default_value(1),
+         "Number of threads that compute the table and the route of a single trip query. "
+         "Default: 1, everything is computed on the request thread.") //
         ("max-table-size",
          value<int>(&config.max_locations_distance_table)->default_value(100),
          "Max. locations supported in distance table query") //
+        ("table-threads",
+         value<int>(&config.table_threads)->default_value(1),
+         "Number of threads that compute a single distance table query. Default: 1, "
+         "table rows are computed on the request thread.") //
+        ("table-cache-size",
+         value<int>(&config.table_cache_size)->default_value(0),
+         "Number of source and target search spaces cached across distance table queries. "
+         "Default: 0, no caching.") //
         ("max-matching-size",
          value<int>(&config.max_locations_map_matching)->default_value(100),
          "Max. locations supported in map matching query") //
+        ("match-threads",
+         value<int>(&config.match_threads)->default_value(1),
+         "Number of threads that compute the routes of the sub matchings of a single match "
+         "query. Default: 1, everything is computed on the request thread.") //
+        ("match-session-cache-size",
+         value<int>(&config.match_session_cache_size)->default_value(0),
+         "Number of traces whose candidates and transitions are kept for match queries that "
+         "extend them with the same session id. Default: 0, no sessions.") //
         ("max-nearest-size",
          value<int>(&config.max_results_nearest)->default_value(100),
          "Max. results supported in nearest query") //
+        ("tile-cache-size",
+         value<int>(&config.tile_cache_size)->default_value(0),
+         "Number of vector tiles cached across tile queries, the cache is cleared when a new "
+         "dataset is loaded. Default: 0, no caching.") //
         ("max-alternatives",
          value<int>(&config.max_alternatives)->default_value(3),
          "Max. number of alternatives supported in the MLD route query") //
+        ("max-alternative-time",
+         value<int>(&config.max_alternative_time)->default_value(-1),
+         "Max. milliseconds a route query spends on alternatives. The shortest route is always "
+         "returned, alternatives only if they were found in time. Default: -1, no limit.") //
+        ("alternative-threads",
+         value<int>(&config.alternative_threads)->default_value(1),
+         "Number of threads that evaluate the via candidates of a single alternative route query. "
+         "Default: 1, candidates are evaluated on the request thread.") //
+        ("route-threads",
+         value<int>(&config.route_threads)->default_value(1),
+         "Number of threads that search the legs of a single route query with waypoints. "
+         "Default: 1, legs are searched on the request thread.") //
+        ("max-batch-size",
+         value<int>(&config.max_pairs_batch)->default_value(1000),
+         "Max. pairs of coordinates supported in batch query") //
+        ("batch-threads",
+         value<int>(&config.batch_threads)->default_value(1),
+         "Number of threads that compute the routes of a single batch query. Default: 1, "
+         "routes are computed on the request thread.") //
+        ("max-isochrone-duration",
+         value<double>(&config.max_duration_isochrone)->default_value(3600.0),
+         "Max. duration in seconds supported in isochrone query") //
         ("max-matching-radius",
          value<double>(&config.max_radius_map_matching)->default_value(-1.0),
          "Max. radius size supported in map matching query. Default: unlimited.");
@@ -197,7 +454,15 @@ inline unsigned generateServerProgramOptions(const int argc,
 
     boost::program_options::notify(option_variables);
 
-    if (!config.use_shared_memory && option_variables.count("base"))
+    if (!profiles.empty())
+    {
+        if (!option_variables.count("base"))
+        {
+            return INIT_OK_START_ENGINE;
+        }
+        util::Log(logWARNING) << "Profile settings conflict with path settings.";
+    }
+    else if (!config.use_shared_memory && option_variables.count("base"))
     {
         return INIT_OK_START_ENGINE;
     }
@@ -224,13 +489,53 @@ int main(int argc, const char *argv[]) try
     bool trial_run = false;
     std::string ip_address;
     int ip_port;
+    std::string unix_socket_path;
 
     EngineConfig config;
     boost::filesystem::path base_path;
 
     int requested_thread_num = 1;
-    const unsigned init_result = generateServerProgramOptions(
-        argc, argv, base_path, ip_address, ip_port, trial_run, config, requested_thread_num);
+    bool io_service_per_thread = false;
+    int worker_thread_num = 0;
+    int worker_queue_size = 128;
+    double max_queue_wait = 0;
+    std::vector<std::string> batch_services;
+    int batch_min_coordinates = 0;
+    double request_timeout = 0;
+    bool coalesce_requests = false;
+    double trace_sample_rate = 0;
+    bool cache_validators = false;
+    std::vector<std::string> cache_control;
+    server::CompressionConfig compression;
+    bool pin_threads = false;
+    bool warm_up = false;
+    boost::filesystem::path warm_up_file;
+    std::vector<std::string> profiles;
+    const unsigned init_result = generateServerProgramOptions(argc,
+                                                              argv,
+                                                              base_path,
+                                                              ip_address,
+                                                              ip_port,
+                                                              unix_socket_path,
+                                                              trial_run,
+                                                              config,
+                                                              requested_thread_num,
+                                                              io_service_per_thread,
+                                                              worker_thread_num,
+                                                              worker_queue_size,
+                                                              max_queue_wait,
+                                                              batch_services,
+                                                              batch_min_coordinates,
+                                                              request_timeout,
+                                                              coalesce_requests,
+                                                              trace_sample_rate,
+                                                              cache_validators,
+                                                              cache_control,
+                                                              compression,
+                                                              pin_threads,
+                                                              warm_up,
+                                                              warm_up_file,
+                                                              profiles);
     if (init_result == INIT_OK_DO_NOT_START_ENGINE)
     {
         return EXIT_SUCCESS;
@@ -244,19 +549,95 @@ int main(int argc, const char *argv[]) try
 
     if (!base_path.empty())
     {
-        config.storage_config = storage::StorageConfig(base_path);
+        // keeps the memory options of the storage config
+        config.storage_config.UseDefaultOutputNames(base_path);
     }
-    if (!config.use_shared_memory && !config.storage_config.IsValid())
+    config.storage_config.load_rtree_leaves |= config.storage_config.lock_rtree_leaves;
+
+    std::unordered_map<std::string, std::string> service_cache_control;
+    for (const auto &service_value : cache_control)
     {
-        util::Log(logERROR) << "Required files are missing, cannot continue";
-        return EXIT_FAILURE;
+        const auto separator = service_value.find('=');
+        if (separator == 0 || separator == std::string::npos)
+        {
+            util::Log(logERROR) << "Cache-Control needs to be given as <service>=<value>, not "
+                                << service_value;
+            return EXIT_FAILURE;
+        }
+        service_cache_control[service_value.substr(0, separator)] =
+            service_value.substr(separator + 1);
+    }
+
+    // every profile gets a copy of the config with its own dataset
+    std::vector<std::pair<std::string, EngineConfig>> profile_configs;
+    for (const auto &profile : profiles)
+    {
+        const auto separator = profile.find('=');
+        if (separator == 0 || separator == std::string::npos || separator + 1 == profile.size())
+        {
+            util::Log(logERROR) << "Profiles need to be given as <profile>=<dataset>, not "
+                                << profile;
+            return EXIT_FAILURE;
+        }
+        auto profile_config = config;
+        const auto dataset = profile.substr(separator + 1);
+        if (config.use_shared_memory)
+        {
+            profile_config.dataset_name = dataset;
+        }
+        else
+        {
+            profile_config.storage_config.UseDefaultOutputNames(dataset);
+        }
+        util::Log() << "Profile " << profile.substr(0, separator) << ": " << dataset;
+        profile_configs.emplace_back(profile.substr(0, separator), std::move(profile_config));
     }
-    if (!config.IsValid())
+    if (profile_configs.size() > 1 && !config.memory_file.empty())
     {
-        if (base_path.empty() != config.use_shared_memory)
+        util::Log(logERROR) << "A memory_file can only hold the dataset of a single profile.";
+        return EXIT_FAILURE;
+    }
+
+    const auto has_path = !base_path.empty() || !profile_configs.empty();
+    const auto check_config = [has_path](const EngineConfig &config) {
+        if (!config.use_shared_memory && !config.storage_config.IsValid())
         {
-            util::Log(logWARNING) << "Path settings and shared memory conflicts.";
+            util::Log(logERROR) << "Required files are missing, cannot continue";
+            return false;
         }
+        if (!config.IsValid())
+        {
+            if (!has_path != config.use_shared_memory)
+            {
+                util::Log(logWARNING) << "Path settings and shared memory conflicts.";
+            }
+            if (config.numa_replicas &&
+                (config.use_shared_memory || !config.memory_file.empty() ||
+                 config.storage_config.lazy_loading))
+            {
+                util::Log(logWARNING) << "NUMA replicas need the data in process memory.";
+            }
+            if (config.watch_memory_file &&
+                (config.use_shared_memory || config.memory_file.empty()))
+            {
+                util::Log(logWARNING) << "--watch-memory-file needs a memory_file.";
+            }
+            return false;
+        }
+        return true;
+    };
+    bool configs_valid = profile_configs.empty() ? check_config(config) : true;
+    for (const auto &profile_config : profile_configs)
+    {
+        configs_valid = configs_valid && check_config(profile_config.second);
+    }
+    if (!configs_valid)
+    {
+        return EXIT_FAILURE;
+    }
+    if (compression.level < 1 || compression.level > 9)
+    {
+        util::Log(logERROR) << "The compression level needs to be between 1 and 9.";
         return EXIT_FAILURE;
     }
 
@@ -279,10 +660,124 @@ int main(int argc, const char *argv[]) try
     pthread_sigmask(SIG_BLOCK, &new_mask, &old_mask);
 #endif
 
-    auto service_handler = std::make_unique<server::ServiceHandler>(config);
-    auto routing_server = server::Server::CreateServer(ip_address, ip_port, requested_thread_num);
+    auto service_handler = profile_configs.empty()
+                               ? std::make_unique<server::ServiceHandler>(config)
+                               : std::make_unique<server::ServiceHandler>(profile_configs);
+    auto routing_server = server::Server::CreateServer(
+        ip_address, ip_port, requested_thread_num, io_service_per_thread);
 
     routing_server->RegisterServiceHandler(std::move(service_handler));
+    if (!unix_socket_path.empty())
+    {
+        routing_server->ListenOnUnixSocket(unix_socket_path);
+    }
+    if (pin_threads)
+    {
+        util::Log() << "Pinning threads to " << util::GetNumaNodes().size() << " NUMA nodes";
+        routing_server->SetThreadPinning(true);
+    }
+    if (worker_thread_num > 0)
+    {
+        util::Log() << "Routing worker threads: " << worker_thread_num;
+        if (max_queue_wait > 0)
+        {
+            util::Log() << "Max. queue wait: " << max_queue_wait << "s";
+        }
+        routing_server->RegisterWorkerPool(std::make_unique<server::WorkerPool>(
+            worker_thread_num,
+            std::max(1, worker_queue_size),
+            pin_threads,
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(std::max(0., max_queue_wait)))));
+        routing_server->SetBatchPriority(batch_services, std::max(0, batch_min_coordinates));
+    }
+    else if (max_queue_wait > 0 || !batch_services.empty() || batch_min_coordinates > 0)
+    {
+        util::Log(logWARNING) << "--max-queue-wait, --batch-service and --batch-min-coordinates "
+                                 "need --worker-threads and are ignored";
+    }
+    if (request_timeout > 0)
+    {
+        util::Log() << "Request timeout: " << request_timeout << "s";
+        routing_server->SetRequestTimeout(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(request_timeout)));
+    }
+    if (coalesce_requests)
+    {
+        util::Log() << "Coalescing identical concurrent requests";
+        routing_server->SetRequestCoalescing(true);
+    }
+    if (trace_sample_rate > 0)
+    {
+        util::Log() << "Tracing " << std::min(trace_sample_rate, 1.) * 100 << "% of the requests";
+        routing_server->SetTraceSampleRate(trace_sample_rate);
+    }
+    if (cache_validators || !service_cache_control.empty())
+    {
+        if (cache_validators)
+        {
+            util::Log() << "Sending cache validators of the dataset version";
+        }
+        for (const auto &service_value : service_cache_control)
+        {
+            util::Log() << "Cache-Control of " << service_value.first << ": "
+                        << service_value.second;
+        }
+        routing_server->SetCaching(cache_validators, std::move(service_cache_control));
+    }
+    routing_server->SetCompression(compression);
+
+    if (warm_up || !warm_up_file.empty())
+    {
+        std::vector<std::string> warm_up_urls;
+        if (!warm_up_file.empty())
+        {
+            boost::filesystem::ifstream input(warm_up_file);
+            if (!input)
+            {
+                util::Log(logERROR) << "Could not open the warm-up file " << warm_up_file;
+                return EXIT_FAILURE;
+            }
+            warm_up_urls = readWarmUpURLs(input);
+        }
+        util::Log() << "Warm-up queries: " << warm_up_urls.size();
+        routing_server->SetWarmUp(std::move(warm_up_urls));
+    }
+
+    if (config.use_shared_memory)
+    {
+        using Monitor = storage::SharedMonitor<storage::SharedRegionRegister>;
+        auto barrier = std::make_shared<Monitor>();
+        const auto register_timestamp = [&](const std::string &metric_name,
+                                            const std::string &dataset_name) {
+            const auto region_name = dataset_name + "/updatable";
+            routing_server->GetMetrics().RegisterGauge(
+                metric_name,
+                "Timestamp of the shared memory dataset, osrm-datastore increments it on every "
+                "load.",
+                [barrier, region_name] {
+                    boost::interprocess::scoped_lock<Monitor::mutex_type> lock(
+                        barrier->get_mutex());
+                    const auto &shared_register = barrier->data();
+                    const auto region_id = shared_register.Find(region_name);
+                    if (region_id == storage::SharedRegionRegister::INVALID_REGION_ID)
+                    {
+                        return 0.;
+                    }
+                    return static_cast<double>(shared_register.GetRegion(region_id).timestamp);
+                });
+        };
+        if (profile_configs.empty())
+        {
+            register_timestamp("osrm_dataset_timestamp", config.dataset_name);
+        }
+        for (const auto &profile_config : profile_configs)
+        {
+            register_timestamp("osrm_dataset_timestamp_" + profile_config.first,
+                               profile_config.second.dataset_name);
+        }
+    }
 
     if (trial_run)
     {
@@ -296,6 +791,7 @@ int main(int argc, const char *argv[]) try
         });
         auto future = server_task.get_future();
         std::thread server_thread(std::move(server_task));
+        routing_server->WaitUntilReady();
 
 #ifndef _WIN32
         sigset_t wait_mask;
@@ -1,17 +1,28 @@
+#include "storage/memory_usage.hpp"
+#include "storage/serialization.hpp"
 #include "storage/shared_memory.hpp"
 #include "storage/shared_monitor.hpp"
 #include "storage/storage.hpp"
 #include "osrm/exception.hpp"
+#include "util/json_renderer.hpp"
 #include "util/log.hpp"
 #include "util/meminfo.hpp"
+#include "util/phase_report.hpp"
 #include "util/typedefs.hpp"
 #include "util/version.hpp"
 
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
+#include <tbb/task_scheduler_init.h>
+
+#include <algorithm>
+#include <cctype>
 #include <csignal>
 #include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <vector>
 
 using namespace osrm;
 
@@ -43,6 +54,42 @@ void listRegions()
     }
 }
 
+// Prints the memory of the blocks of all regions of the dataset as JSON
+void printMemoryReport(const std::string &dataset_name)
+{
+    storage::SharedMonitor<storage::SharedRegionRegister> monitor;
+    std::vector<std::string> names;
+    const auto &shared_register = monitor.data();
+    shared_register.List(std::back_inserter(names));
+
+    const auto region_prefix = dataset_name + "/";
+    util::json::Object regions;
+    for (const auto &name : names)
+    {
+        if (name.compare(0, region_prefix.size(), region_prefix) != 0)
+            continue;
+
+        const auto &region = shared_register.GetRegion(shared_register.Find(name));
+        auto memory = storage::makeSharedMemory(region.shm_key);
+        auto memory_ptr = reinterpret_cast<char *>(memory->Ptr());
+
+        storage::io::BufferReader reader(memory_ptr, memory->Size());
+        storage::DataLayout layout;
+        storage::serialization::read(reader, layout);
+        const storage::SharedDataIndex index(
+            {{memory_ptr + reader.GetPosition(), std::move(layout)}});
+
+        auto report = storage::makeMemoryReport(storage::getMemoryUsage(index));
+        report.values["shm_key"] = static_cast<double>(region.shm_key);
+        regions.values[name] = std::move(report);
+    }
+
+    util::json::Object result;
+    result.values["regions"] = std::move(regions);
+    util::json::render(std::cout, result);
+    std::cout << std::endl;
+}
+
 void springClean()
 {
     osrm::util::Log() << "Releasing all locks";
@@ -72,10 +119,20 @@ void springClean()
 bool generateDataStoreOptions(const int argc,
                               const char *argv[],
                               std::string &verbosity,
+                              boost::filesystem::path &phase_report_path,
                               boost::filesystem::path &base_path,
                               int &max_wait,
                               std::string &dataset_name,
-                              bool &list_datasets)
+                              bool &list_datasets,
+                              bool &memory_report,
+                              bool &only_metric,
+                              std::string &metric_name,
+                              bool &load_rtree_leaves,
+                              bool &skip_osm_node_ids,
+                              storage::HugePages &huge_pages,
+                              bool &numa_interleave,
+                              bool &verify_checksums,
+                              boost::filesystem::path &image_path)
 {
     // declare a group of options that will be allowed only on command line
     boost::program_options::options_description generic_options("Options");
@@ -85,7 +142,10 @@ bool generateDataStoreOptions(const int argc,
         ("verbosity,l",
          boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
          std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str()) //
-        ("remove-locks,r", "Remove locks")                                            //
+        ("phase-report",
+         boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+         "Write the time, peak memory and I/O of each phase as JSON to this file") //
+        ("remove-locks,r", "Remove locks")                                         //
         ("spring-clean,s", "Spring-cleaning all shared memory regions");
 
     // declare a group of options that will be allowed both on command line
@@ -105,7 +165,58 @@ bool generateDataStoreOptions(const int argc,
              ->default_value(false)
              ->implicit_value(true),
          "Name of the dataset to load into memory. This allows having multiple datasets in memory "
-         "at the same time.");
+         "at the same time.") //
+        ("memory-report",
+         boost::program_options::value<bool>(&memory_report)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Print the mapped and resident bytes of the blocks of the dataset in shared memory, "
+         "per block and per subsystem, as JSON.") //
+        ("only-metric",
+         boost::program_options::value<bool>(&only_metric)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Only reload the metric data of the dataset: the weights and durations of the graphs, "
+         "the segments and the turns. The rest of the dataset stays in memory.") //
+        ("metric-name",
+         boost::program_options::value<std::string>(&metric_name)->default_value(""),
+         "Load the metric data as an additional named metric of the dataset. Requests select it "
+         "with the metric parameter, the static data of the dataset is shared. Implies "
+         "--only-metric.") //
+        ("load-rtree-leaves",
+         boost::program_options::value<bool>(&load_rtree_leaves)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Load the r-tree leaves of the .fileIndex into the shared memory instead of mapping "
+         "the file in osrm-routed, so that snapping does not depend on the page cache.") //
+        ("skip-osm-node-ids",
+         boost::program_options::value<bool>(&skip_osm_node_ids)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Do not load the OSM node ids. Responses omit the nodes of nearest waypoints and of "
+         "annotations=true, requests for annotations=nodes are rejected.") //
+        ("huge-pages",
+         boost::program_options::value<storage::HugePages>(&huge_pages)
+             ->default_value(storage::HugePages::None, "none"),
+         "Page size of the shared memory regions. Can be none, transparent (needs "
+         "/sys/kernel/mm/transparent_hugepage/shmem_enabled set to advise) or explicit (pages "
+         "reserved in /proc/sys/vm/nr_hugepages).") //
+        ("numa-interleave",
+         boost::program_options::value<bool>(&numa_interleave)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Spread the pages of the shared memory regions round-robin over the NUMA nodes, so "
+         "that osrm-routed threads on all nodes see the same memory latency.") //
+        ("verify-checksums",
+         boost::program_options::value<bool>(&verify_checksums)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Compare the checksums that the tools store with the blocks of the files before "
+         "loading them, the blocks are read and checked in parallel.") //
+        ("prepare-image",
+         boost::program_options::value<boost::filesystem::path>(&image_path),
+         "Write the dataset into an image file that osrm-routed maps with --memory_file, "
+         "instead of loading it into shared memory.");
 
     // hidden options, will be allowed on command line but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -179,6 +290,21 @@ bool generateDataStoreOptions(const int argc,
     return true;
 }
 
+// The data is loaded on the default number of threads
+bool writePhaseReport(const boost::filesystem::path &phase_report_path)
+{
+    if (phase_report_path.empty() ||
+        util::PhaseReport::GetInstance().Write(phase_report_path,
+                                               "osrm-datastore",
+                                               tbb::task_scheduler_init::default_num_threads()))
+    {
+        return true;
+    }
+
+    util::Log(logERROR) << "Could not write the phase report to " << phase_report_path.string();
+    return false;
+}
+
 [[noreturn]] void CleanupSharedBarriers(int signum)
 { // Here the lock state of named mutexes is unknown, make a hard cleanup
     removeLocks();
@@ -196,12 +322,37 @@ int main(const int argc, const char *argv[]) try
     util::LogPolicy::GetInstance().Unmute();
 
     std::string verbosity;
+    boost::filesystem::path phase_report_path;
     boost::filesystem::path base_path;
     int max_wait = -1;
     std::string dataset_name;
     bool list_datasets = false;
-    if (!generateDataStoreOptions(
-            argc, argv, verbosity, base_path, max_wait, dataset_name, list_datasets))
+    bool memory_report = false;
+    bool only_metric = false;
+    std::string metric_name;
+    bool load_rtree_leaves = false;
+    bool skip_osm_node_ids = false;
+    storage::HugePages huge_pages = storage::HugePages::None;
+    bool numa_interleave = false;
+    bool verify_checksums = false;
+    boost::filesystem::path image_path;
+    if (!generateDataStoreOptions(argc,
+                                  argv,
+                                  verbosity,
+                                  phase_report_path,
+                                  base_path,
+                                  max_wait,
+                                  dataset_name,
+                                  list_datasets,
+                                  memory_report,
+                                  only_metric,
+                                  metric_name,
+                                  load_rtree_leaves,
+                                  skip_osm_node_ids,
+                                  huge_pages,
+                                  numa_interleave,
+                                  verify_checksums,
+                                  image_path))
     {
         return EXIT_SUCCESS;
     }
@@ -214,15 +365,57 @@ int main(const int argc, const char *argv[]) try
         return EXIT_SUCCESS;
     }
 
+    if (memory_report)
+    {
+        printMemoryReport(dataset_name);
+        return EXIT_SUCCESS;
+    }
+
+    if (!metric_name.empty())
+    {
+        if (!std::all_of(metric_name.begin(), metric_name.end(), [](const char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+            }))
+        {
+            util::Log(logERROR) << "Metric name " << metric_name
+                                << " may only contain letters, digits and underscores.";
+            return EXIT_FAILURE;
+        }
+        only_metric = true;
+    }
+
     storage::StorageConfig config(base_path);
-    if (!config.IsValid())
+    config.load_rtree_leaves = load_rtree_leaves;
+    config.skip_osm_node_ids = skip_osm_node_ids;
+    config.huge_pages = huge_pages;
+    config.numa_interleave = numa_interleave;
+    config.verify_checksums = verify_checksums;
+    // a metric only needs the updatable files, e.g. the files osrm-customize --time-slot writes
+    if (!only_metric && !config.IsValid())
     {
         util::Log(logERROR) << "Config contains invalid file paths. Exiting!";
         return EXIT_FAILURE;
     }
     storage::Storage storage(std::move(config));
 
-    return storage.Run(max_wait, dataset_name);
+    if (!image_path.empty())
+    {
+        if (only_metric)
+        {
+            util::Log(logERROR) << "An image always contains the whole dataset, --prepare-image "
+                                   "can not be combined with --only-metric or --metric-name.";
+            return EXIT_FAILURE;
+        }
+        storage.WriteImage(image_path);
+        return writePhaseReport(phase_report_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const auto exitcode = storage.Run(max_wait, dataset_name, only_metric, metric_name);
+    if (exitcode == EXIT_SUCCESS && !writePhaseReport(phase_report_path))
+    {
+        return EXIT_FAILURE;
+    }
+    return exitcode;
 }
 catch (const osrm::RuntimeError &e)
 {
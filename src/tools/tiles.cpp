@@ -0,0 +1,350 @@
+#include "util/log.hpp"
+#include "util/version.hpp"
+#include "util/web_mercator.hpp"
+
+#include "osrm/engine_config.hpp"
+#include "osrm/exception.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+#include "osrm/tile_parameters.hpp"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/program_options.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+namespace osrm
+{
+namespace engine
+{
+std::istream &operator>>(std::istream &in, EngineConfig::Algorithm &algorithm)
+{
+    std::string token;
+    in >> token;
+    boost::to_lower(token);
+
+    if (token == "ch" || token == "corech")
+        algorithm = EngineConfig::Algorithm::CH;
+    else if (token == "mld")
+        algorithm = EngineConfig::Algorithm::MLD;
+    else
+        throw util::RuntimeError(token, ErrorCode::UnknownAlgorithm, SOURCE_REF);
+    return in;
+}
+}
+}
+
+namespace
+{
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+struct TilesConfig
+{
+    boost::filesystem::path output_path;
+    std::string bounding_box;
+    unsigned min_zoom = 12;
+    unsigned max_zoom = 16;
+    unsigned requested_num_threads = 1;
+};
+
+// The tile of a slippy map zoom level that contains the location
+unsigned lonToTileX(const double lon, const unsigned zoom)
+{
+    const auto pixel = util::web_mercator::degreeToPixel(
+        util::web_mercator::clamp(util::FloatLongitude{lon}), zoom);
+    const auto tile = static_cast<long>(std::floor(pixel / util::web_mercator::TILE_SIZE));
+    return static_cast<unsigned>(std::min(std::max(tile, 0l), (1l << zoom) - 1));
+}
+
+unsigned latToTileY(const double lat, const unsigned zoom)
+{
+    const auto pixel = util::web_mercator::degreeToPixel(
+        util::web_mercator::clamp(util::FloatLatitude{lat}), zoom);
+    const auto tile = static_cast<long>(std::floor(pixel / util::web_mercator::TILE_SIZE));
+    return static_cast<unsigned>(std::min(std::max(tile, 0l), (1l << zoom) - 1));
+}
+
+// All tiles of the zoom levels that intersect the bounding box, the pyramid of the box
+std::vector<TileParameters> getTiles(const double min_lon,
+                                     const double min_lat,
+                                     const double max_lon,
+                                     const double max_lat,
+                                     const unsigned min_zoom,
+                                     const unsigned max_zoom)
+{
+    std::vector<TileParameters> tiles;
+    for (auto zoom = min_zoom; zoom <= max_zoom; ++zoom)
+    {
+        // the y axis of tiles points south
+        const auto min_x = lonToTileX(min_lon, zoom);
+        const auto max_x = lonToTileX(max_lon, zoom);
+        const auto min_y = latToTileY(max_lat, zoom);
+        const auto max_y = latToTileY(min_lat, zoom);
+        for (auto x = min_x; x <= max_x; ++x)
+        {
+            for (auto y = min_y; y <= max_y; ++y)
+            {
+                tiles.push_back(TileParameters{x, y, zoom});
+            }
+        }
+    }
+    return tiles;
+}
+
+return_code parseArguments(int argc,
+                           char *argv[],
+                           std::string &verbosity,
+                           boost::filesystem::path &base_path,
+                           EngineConfig &engine_config,
+                           TilesConfig &tiles_config)
+{
+    using boost::program_options::value;
+
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()            //
+        ("version,v", "Show version")        //
+        ("help,h", "Show this help message") //
+        ("verbosity,l",
+         value<std::string>(&verbosity)->default_value("INFO"),
+         std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+
+    // declare a group of options that will be allowed on command line
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("output,o",
+         value<boost::filesystem::path>(&tiles_config.output_path)->required(),
+         "Directory the tiles are written to as <z>/<x>/<y>.mvt") //
+        ("bbox,b",
+         value<std::string>(&tiles_config.bounding_box)->required(),
+         "Bounding box of the tiles as min_lon,min_lat,max_lon,max_lat") //
+        ("min-zoom",
+         value<unsigned>(&tiles_config.min_zoom)->default_value(12),
+         "Lowest zoom level of the tiles, at least 12") //
+        ("max-zoom",
+         value<unsigned>(&tiles_config.max_zoom)->default_value(16),
+         "Highest zoom level of the tiles, at most 19") //
+        ("threads,t",
+         value<unsigned>(&tiles_config.requested_num_threads)
+             ->default_value(tbb::task_scheduler_init::default_num_threads()),
+         "Number of threads to use") //
+        ("shared-memory,s",
+         value<bool>(&engine_config.use_shared_memory)->implicit_value(true)->default_value(false),
+         "Load data from shared memory") //
+        ("dataset-name",
+         value<std::string>(&engine_config.dataset_name),
+         "Name of the shared memory dataset to connect to.") //
+        ("algorithm,a",
+         value<EngineConfig::Algorithm>(&engine_config.algorithm)
+             ->default_value(EngineConfig::Algorithm::CH, "CH"),
+         "Algorithm to use for the data. Can be CH, CoreCH, MLD.");
+
+    // hidden options, will be allowed on command line, but will not be shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "base", value<boost::filesystem::path>(&base_path), "base path to .osrm file");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("base", 1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(executable).filename().string() + " <base.osrm> [<options>]");
+    visible_options.add(generic_options).add(config_options);
+
+    // parse command line options
+    boost::program_options::variables_map option_variables;
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+
+        if (option_variables.count("version"))
+        {
+            std::cout << OSRM_VERSION << std::endl;
+            return return_code::exit;
+        }
+
+        if (option_variables.count("help"))
+        {
+            std::cout << visible_options;
+            return return_code::exit;
+        }
+
+        boost::program_options::notify(option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (!engine_config.use_shared_memory && !option_variables.count("base"))
+    {
+        std::cout << visible_options;
+        return return_code::fail;
+    }
+
+    return return_code::ok;
+}
+}
+
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    std::string verbosity;
+    boost::filesystem::path base_path;
+    EngineConfig engine_config;
+    TilesConfig tiles_config;
+    const auto result =
+        parseArguments(argc, argv, verbosity, base_path, engine_config, tiles_config);
+
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    util::LogPolicy::GetInstance().SetLevel(verbosity);
+
+    double min_lon, min_lat, max_lon, max_lat;
+    char trailing;
+    if (std::sscanf(tiles_config.bounding_box.c_str(),
+                    "%lf,%lf,%lf,%lf%c",
+                    &min_lon,
+                    &min_lat,
+                    &max_lon,
+                    &max_lat,
+                    &trailing) != 4 ||
+        min_lon > max_lon || min_lat > max_lat)
+    {
+        util::Log(logERROR) << "The bounding box needs to be min_lon,min_lat,max_lon,max_lat";
+        return EXIT_FAILURE;
+    }
+
+    if (tiles_config.min_zoom < 12 || tiles_config.max_zoom > 19 ||
+        tiles_config.min_zoom > tiles_config.max_zoom)
+    {
+        util::Log(logERROR) << "The zoom levels need to be between 12 and 19";
+        return EXIT_FAILURE;
+    }
+
+    if (1 > tiles_config.requested_num_threads)
+    {
+        util::Log(logERROR) << "Number of threads must be 1 or larger";
+        return EXIT_FAILURE;
+    }
+
+    if (!base_path.empty())
+    {
+        engine_config.storage_config.UseDefaultOutputNames(base_path);
+    }
+    if (!engine_config.IsValid())
+    {
+        util::Log(logERROR) << "Required files are missing, cannot continue";
+        return EXIT_FAILURE;
+    }
+
+    const auto tiles = getTiles(
+        min_lon, min_lat, max_lon, max_lat, tiles_config.min_zoom, tiles_config.max_zoom);
+    util::Log() << "Rendering " << tiles.size() << " tiles of zoom levels " << tiles_config.min_zoom
+                << " to " << tiles_config.max_zoom << " with " << tiles_config.requested_num_threads
+                << " threads";
+
+    const OSRM osrm(engine_config);
+
+    // the directories of all columns exist before the tiles are written in parallel
+    for (const auto &tile : tiles)
+    {
+        boost::filesystem::create_directories(tiles_config.output_path /
+                                              std::to_string(tile.z) / std::to_string(tile.x));
+    }
+
+    tbb::task_scheduler_init init(tiles_config.requested_num_threads);
+
+    std::atomic<std::size_t> failed_tiles{0};
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, tiles.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          std::string pbf_buffer;
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              const auto &tile = tiles[index];
+                              pbf_buffer.clear();
+                              if (osrm.Tile(tile, pbf_buffer) != Status::Ok)
+                              {
+                                  ++failed_tiles;
+                                  continue;
+                              }
+
+                              const auto path = tiles_config.output_path /
+                                                std::to_string(tile.z) / std::to_string(tile.x) /
+                                                (std::to_string(tile.y) + ".mvt");
+                              boost::filesystem::ofstream output(path, std::ios::binary);
+                              output.write(pbf_buffer.data(), pbf_buffer.size());
+                              if (!output)
+                              {
+                                  ++failed_tiles;
+                              }
+                          }
+                      });
+
+    if (failed_tiles > 0)
+    {
+        util::Log(logERROR) << "Could not render or write " << failed_tiles << " tiles";
+        return EXIT_FAILURE;
+    }
+
+    util::Log() << "Wrote " << tiles.size() << " tiles to " << tiles_config.output_path.string();
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const std::bad_alloc &e)
+{
+    util::Log(logERROR) << "[exception] " << e.what();
+    util::Log(logERROR) << "Please provide more memory or consider using a larger swapfile";
+    return EXIT_FAILURE;
+}
+#ifdef _WIN32
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << "[exception] " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
+#endif
@@ -2,6 +2,8 @@
 
 #include "updater/csv_file_parser.hpp"
 
+#include "storage/io.hpp"
+
 #include <boost/fusion/adapted/std_pair.hpp>
 #include <boost/fusion/include/adapt_adt.hpp>
 
@@ -31,13 +33,74 @@ namespace updater
 {
 namespace csv
 {
+namespace
+{
+// The binary speed file is the magic string followed by the number of records
+// and the records sorted by ascending (from, to) without duplicated segments.
+const constexpr char BINARY_SEGMENT_MAGIC[8] = {'O', 'S', 'R', 'M', 'S', 'P', 'D', '1'};
+
+struct BinarySegmentRecord
+{
+    std::uint64_t from;
+    std::uint64_t to;
+    std::uint32_t speed;
+    std::uint32_t has_rate; // 0 if the line had no rate column
+    double rate;            // NaN for a blank rate column
+};
+static_assert(sizeof(BinarySegmentRecord) == 32, "binary segment record has a fixed size");
+
+bool loadBinarySegmentValues(const char *first,
+                             const char *last,
+                             std::vector<std::pair<Segment, SpeedSource>> &entries)
+{
+    const std::size_t size = last - first;
+    if (size < sizeof(BINARY_SEGMENT_MAGIC) ||
+        !std::equal(std::begin(BINARY_SEGMENT_MAGIC), std::end(BINARY_SEGMENT_MAGIC), first))
+        return false;
+
+    std::uint64_t count = 0;
+    const auto header_size = sizeof(BINARY_SEGMENT_MAGIC) + sizeof(count);
+    if (size < header_size)
+        throw util::exception("Binary speed file has no record count" + SOURCE_REF);
+    std::copy_n(
+        first + sizeof(BINARY_SEGMENT_MAGIC), sizeof(count), reinterpret_cast<char *>(&count));
+    if ((size - header_size) % sizeof(BinarySegmentRecord) != 0 ||
+        (size - header_size) / sizeof(BinarySegmentRecord) != count)
+        throw util::exception("Binary speed file has a wrong size for " + std::to_string(count) +
+                              " records" + SOURCE_REF);
+
+    // Mappings and buffers are aligned for any value and the header keeps the records aligned
+    const auto records = reinterpret_cast<const BinarySegmentRecord *>(first + header_size);
+    entries.resize(count);
+    tbb::parallel_for(std::size_t{0}, count, [&](const std::size_t index) {
+        const auto &record = records[index];
+        auto &entry = entries[index];
+        entry.first = Segment{record.from, record.to};
+        entry.second.speed = record.speed;
+        if (record.has_rate != 0)
+            entry.second.rate = record.rate;
+    });
+
+    const auto unsorted =
+        std::adjacent_find(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+            return !(lhs.first < rhs.first);
+        });
+    if (unsorted != entries.end())
+        throw util::exception("Binary speed file is not sorted by unique segments at node " +
+                              std::to_string(unsorted->first.from) + SOURCE_REF);
+
+    return true;
+}
+}
+
 SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths)
 {
     static const auto value_if_blank = std::numeric_limits<double>::quiet_NaN();
     CSVFilesParser<Segment, SpeedSource> parser(
         1,
         qi::ulong_long >> ',' >> qi::ulong_long,
-        qi::uint_ >> -(',' >> (qi::double_ | qi::attr(value_if_blank))));
+        qi::uint_ >> -(',' >> (qi::double_ | qi::attr(value_if_blank))),
+        loadBinarySegmentValues);
 
     // Check consistency of keys in the result lookup table
     auto result = parser(paths);
@@ -54,6 +117,25 @@ SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths)
     return result;
 }
 
+void writeSegmentValues(const std::string &path, const SegmentLookupTable &table)
+{
+    // the lookup table is sorted descending
+    std::vector<BinarySegmentRecord> records;
+    records.reserve(table.lookup.size());
+    std::for_each(table.lookup.rbegin(), table.lookup.rend(), [&](const auto &entry) {
+        records.push_back({entry.first.from,
+                           entry.first.to,
+                           entry.second.speed,
+                           entry.second.rate ? 1u : 0u,
+                           entry.second.rate.value_or(0.)});
+    });
+
+    storage::io::FileWriter writer(path, storage::io::FileWriter::HasNoFingerprint);
+    writer.WriteFrom(BINARY_SEGMENT_MAGIC, sizeof(BINARY_SEGMENT_MAGIC));
+    writer.WriteElementCount64(records.size());
+    writer.WriteFrom(records);
+}
+
 TurnLookupTable readTurnValues(const std::vector<std::string> &paths)
 {
     CSVFilesParser<Turn, PenaltySource> parser(1,
@@ -29,6 +29,7 @@
 
 #include <boost/assert.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/geometry.hpp>
 #include <boost/geometry/index/rtree.hpp>
 #include <boost/interprocess/file_mapping.hpp>
@@ -40,6 +41,7 @@
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_invoke.h>
 #include <tbb/parallel_sort.h>
+#include <tbb/task_group.h>
 
 #include <algorithm>
 #include <atomic>
@@ -218,9 +220,10 @@ updateSegmentData(const UpdaterConfig &config,
     tbb::parallel_for(range, [&](const auto &range) {
         auto &counters = segment_speeds_counters.local();
         std::vector<double> segment_lengths;
+        std::vector<NodeID> nodes_range;
         for (auto geometry_id = range.begin(); geometry_id < range.end(); geometry_id++)
         {
-            auto nodes_range = segment_data.GetForwardGeometry(geometry_id);
+            segment_data.UnpackForwardGeometry(geometry_id, nodes_range);
 
             segment_lengths.clear();
             segment_lengths.reserve(nodes_range.size() + 1);
@@ -415,11 +418,36 @@ void saveDatasourcesNames(const UpdaterConfig &config)
     // for rendering in the debug tiles.
     for (auto const &name : config.segment_speed_lookup_paths)
     {
-        sources.SetSourceName(source, boost::filesystem::path(name).stem().string());
+        sources.SetSourceName(
+            source, name == "-" ? "stdin" : boost::filesystem::path(name).stem().string());
         source++;
     }
 
-    extractor::files::writeDatasources(config.GetPath(".osrm.datasource_names"), sources);
+    extractor::files::writeDatasources(config.GetOutputPath(".osrm.datasource_names"), sources);
+}
+
+// Outputs under another base path are a metric on their own, the files that were not updated are
+// copied there as they are
+void copyUnchangedFiles(const UpdaterConfig &config,
+                        const bool segment_data_updated,
+                        const bool turn_penalties_updated)
+{
+    if (config.output_base_path.empty())
+        return;
+
+    const auto copy = [&config](const std::string &file_name) {
+        const auto output_path = config.GetOutputPath(file_name);
+        boost::filesystem::remove(output_path);
+        boost::filesystem::copy_file(config.GetPath(file_name), output_path);
+    };
+
+    if (!segment_data_updated)
+        copy(".osrm.geometry");
+    if (!turn_penalties_updated)
+    {
+        copy(".osrm.turn_weight_penalties");
+        copy(".osrm.turn_duration_penalties");
+    }
 }
 
 std::vector<std::uint64_t>
@@ -479,53 +507,71 @@ updateTurnPenalties(const UpdaterConfig &config,
     return updated_turns;
 }
 
-bool IsRestrictionValid(const Timezoner &tz_handler, const extractor::ConditionalTurnPenalty &turn)
+bool IsRestrictionValid(const struct tm &local_time, const extractor::ConditionalTurnPenalty &turn)
 {
-    BOOST_ASSERT(!turn.conditions.empty());
-
-    // we utilize the via node (first on ways) to represent the turn restriction
-    auto const via = turn.location;
-
-    const auto lon = static_cast<double>(toFloating(via.lon));
-    const auto lat = static_cast<double>(toFloating(via.lat));
-    const auto &conditions = turn.conditions;
-
-    // Get local time of the restriction
-    const auto &local_time = tz_handler(point_t{lon, lat});
-    if (!local_time)
-        return false;
-
     // TODO: check restriction type [:<transportation mode>][:<direction>]
     // http://wiki.openstreetmap.org/wiki/Conditional_restrictions#Tagging
 
     // TODO: parsing will fail for combined conditions, e.g. Sa-Su AND weight>7
     // http://wiki.openstreetmap.org/wiki/Conditional_restrictions#Combined_conditions:_AND
 
-    return osrm::util::CheckOpeningHours(conditions, *local_time);
+    // conditions that only depend on the weekday and time were compiled by the extractor
+    if (turn.conditions.empty())
+        return osrm::util::CheckWeeklySchedule(turn.schedule, local_time);
+
+    return osrm::util::CheckOpeningHours(turn.conditions, local_time);
 }
 
 std::vector<std::uint64_t>
 updateConditionalTurns(std::vector<TurnPenalty> &turn_weight_penalties,
                        const std::vector<extractor::ConditionalTurnPenalty> &conditional_turns,
-                       Timezoner time_zone_handler)
+                       const Timezoner &time_zone_handler)
 {
     std::vector<std::uint64_t> updated_turns;
     if (conditional_turns.size() == 0)
         return updated_turns;
 
-    for (const auto &penalty : conditional_turns)
+    // we utilize the via node (first on ways) to represent the turn restriction
+    std::vector<point_t> locations;
+    locations.reserve(conditional_turns.size());
+    for (const auto &turn : conditional_turns)
+    {
+        locations.emplace_back(static_cast<double>(toFloating(turn.location.lon)),
+                               static_cast<double>(toFloating(turn.location.lat)));
+    }
+
+    // Get local time of the restrictions
+    const auto local_times = time_zone_handler(locations);
+
+    for (const auto index : util::irange<std::size_t>(0, conditional_turns.size()))
     {
-        if (IsRestrictionValid(time_zone_handler, penalty))
+        const auto &turn = conditional_turns[index];
+        if (local_times[index] && IsRestrictionValid(*local_times[index], turn))
         {
-            std::cout << "Disabling: " << penalty.turn_offset << std::endl;
-            turn_weight_penalties[penalty.turn_offset] = INVALID_TURN_PENALTY;
-            updated_turns.push_back(penalty.turn_offset);
+            turn_weight_penalties[turn.turn_offset] = INVALID_TURN_PENALTY;
+            updated_turns.push_back(turn.turn_offset);
         }
     }
+
+    util::Log() << "Disabled " << updated_turns.size() << " of " << conditional_turns.size()
+                << " conditional turns";
     return updated_turns;
 }
 }
 
+bool Updater::HasUpdates() const
+{
+    return !config.segment_speed_lookup_paths.empty() ||
+           !config.turn_penalty_lookup_paths.empty() ||
+           (!config.GetPath(".osrm.restrictions").empty() && config.valid_now);
+}
+
+void Updater::SaveDatasourcesNames() const
+{
+    saveDatasourcesNames(config);
+    copyUnchangedFiles(config, false, false);
+}
+
 Updater::NumNodesAndEdges Updater::LoadAndUpdateEdgeExpandedGraph() const
 {
     std::vector<EdgeWeight> node_weights;
@@ -559,9 +605,10 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
     const bool update_edge_weights = !config.segment_speed_lookup_paths.empty();
     const bool update_turn_penalties = !config.turn_penalty_lookup_paths.empty();
 
-    if (!update_edge_weights && !update_turn_penalties && !update_conditional_turns)
+    if (!HasUpdates())
     {
         saveDatasourcesNames(config);
+        copyUnchangedFiles(config, false, false);
         return number_of_edge_based_nodes;
     }
 
@@ -603,10 +650,16 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                                                       conditional_turns);
     }
 
+    // The outputs are written while the remaining updates run, a writer only reads its data and
+    // nothing changes the data once it is written. Declared after the data to be destroyed, and
+    // so waited for, before it.
+    tbb::task_group writers;
+
     tbb::concurrent_vector<GeometryID> updated_segments;
     if (update_edge_weights)
     {
         auto segment_speed_lookup = csv::readSegmentValues(config.segment_speed_lookup_paths);
+        segment_speed_lookup.BuildIndex();
 
         TIMER_START(segment);
         updated_segments = updateSegmentData(config,
@@ -615,13 +668,17 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                                              segment_data,
                                              coordinates,
                                              osm_node_ids);
-        // Now save out the updated compressed geometries
-        extractor::files::writeSegmentData(config.GetPath(".osrm.geometry"), segment_data);
         TIMER_STOP(segment);
+        // Now save out the updated compressed geometries, the edges only read them
+        writers.run([&] {
+            extractor::files::writeSegmentData(config.GetOutputPath(".osrm.geometry"),
+                                               segment_data);
+        });
         util::Log() << "Updating segment data took " << TIMER_MSEC(segment) << "ms.";
     }
 
     auto turn_penalty_lookup = csv::readTurnValues(config.turn_penalty_lookup_paths);
+    turn_penalty_lookup.BuildIndex();
     if (update_turn_penalties)
     {
         auto updated_turn_penalties = updateTurnPenalties(config,
@@ -675,50 +732,42 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                        });
 
     using WeightAndDuration = std::tuple<EdgeWeight, EdgeWeight>;
+    // the segment values are decoded into a buffer of the thread in one pass
     const auto compute_new_weight_and_duration =
-        [&](const GeometryID geometry_id) -> WeightAndDuration {
+        [&](const GeometryID geometry_id,
+            std::vector<SegmentWeight> &values) -> WeightAndDuration {
         EdgeWeight new_weight = 0;
         EdgeWeight new_duration = 0;
         if (geometry_id.forward)
-        {
-            const auto weights = segment_data.GetForwardWeights(geometry_id.id);
-            for (const auto weight : weights)
-            {
-                if (weight == INVALID_SEGMENT_WEIGHT)
-                {
-                    new_weight = INVALID_EDGE_WEIGHT;
-                    break;
-                }
-                new_weight += weight;
-            }
-            const auto durations = segment_data.GetForwardDurations(geometry_id.id);
-            new_duration = std::accumulate(durations.begin(), durations.end(), EdgeWeight{0});
-        }
+            segment_data.UnpackForwardWeights(geometry_id.id, values);
         else
+            segment_data.UnpackReverseWeights(geometry_id.id, values);
+        for (const auto weight : values)
         {
-            const auto weights = segment_data.GetReverseWeights(geometry_id.id);
-            for (const auto weight : weights)
+            if (weight == INVALID_SEGMENT_WEIGHT)
             {
-                if (weight == INVALID_SEGMENT_WEIGHT)
-                {
-                    new_weight = INVALID_EDGE_WEIGHT;
-                    break;
-                }
-                new_weight += weight;
+                new_weight = INVALID_EDGE_WEIGHT;
+                break;
             }
-            const auto durations = segment_data.GetReverseDurations(geometry_id.id);
-            new_duration = std::accumulate(durations.begin(), durations.end(), EdgeWeight{0});
+            new_weight += weight;
         }
+
+        if (geometry_id.forward)
+            segment_data.UnpackForwardDurations(geometry_id.id, values);
+        else
+            segment_data.UnpackReverseDurations(geometry_id.id, values);
+        new_duration = std::accumulate(values.begin(), values.end(), EdgeWeight{0});
         return std::make_tuple(new_weight, new_duration);
     };
 
     std::vector<WeightAndDuration> accumulated_segment_data(updated_segments.size());
     tbb::parallel_for(tbb::blocked_range<std::size_t>(0, updated_segments.size()),
                       [&](const auto &range) {
+                          std::vector<SegmentWeight> values;
                           for (auto index = range.begin(); index < range.end(); ++index)
                           {
                               accumulated_segment_data[index] =
-                                  compute_new_weight_and_duration(updated_segments[index]);
+                                  compute_new_weight_and_duration(updated_segments[index], values);
                           }
                       });
 
@@ -797,18 +846,24 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                           });
     }
 
+    // the turn weight penalties are clamped while the edges are updated
     if (update_turn_penalties || update_conditional_turns)
     {
-        tbb::parallel_invoke(
-            [&] {
-                extractor::files::writeTurnWeightPenalty(
-                    config.GetPath(".osrm.turn_weight_penalties"), turn_weight_penalties);
-            },
-            [&] {
-                extractor::files::writeTurnDurationPenalty(
-                    config.GetPath(".osrm.turn_duration_penalties"), turn_duration_penalties);
-            });
+        writers.run([&] {
+            extractor::files::writeTurnWeightPenalty(
+                config.GetOutputPath(".osrm.turn_weight_penalties"), turn_weight_penalties);
+        });
+        writers.run([&] {
+            extractor::files::writeTurnDurationPenalty(
+                config.GetOutputPath(".osrm.turn_duration_penalties"), turn_duration_penalties);
+        });
     }
+    writers.run([&] { saveDatasourcesNames(config); });
+    writers.run([&] {
+        copyUnchangedFiles(
+            config, update_edge_weights, update_turn_penalties || update_conditional_turns);
+    });
+    writers.wait();
 
 #if !defined(NDEBUG)
     if (config.turn_penalty_lookup_paths.empty())
@@ -818,8 +873,6 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
     }
 #endif
 
-    saveDatasourcesNames(config);
-
     TIMER_STOP(load_edges);
     util::Log() << "Done reading edges in " << TIMER_MSEC(load_edges) << "ms.";
     return number_of_edge_based_nodes;
@@ -0,0 +1,94 @@
+#include "util/block_pool.hpp"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include <new>
+
+namespace osrm
+{
+namespace util
+{
+
+namespace
+{
+void *mapBlock()
+{
+#ifndef _WIN32
+    auto block = ::mmap(nullptr,
+                        BlockPool::BLOCK_SIZE,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1,
+                        0);
+    if (block == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+#else
+    return ::operator new(BlockPool::BLOCK_SIZE);
+#endif
+}
+
+void unmapBlock(void *block)
+{
+#ifndef _WIN32
+    ::munmap(block, BlockPool::BLOCK_SIZE);
+#else
+    ::operator delete(block);
+#endif
+}
+}
+
+constexpr std::size_t BlockPool::BLOCK_SIZE;
+
+BlockPool &BlockPool::GetInstance()
+{
+    static BlockPool pool;
+    return pool;
+}
+
+BlockPool::~BlockPool() { Trim(); }
+
+void *BlockPool::Allocate()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!free_blocks.empty())
+        {
+            auto block = free_blocks.back();
+            free_blocks.pop_back();
+            return block;
+        }
+    }
+    return mapBlock();
+}
+
+void BlockPool::Deallocate(void *block)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    free_blocks.push_back(block);
+}
+
+void BlockPool::Trim()
+{
+    std::vector<void *> blocks;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        blocks.swap(free_blocks);
+    }
+    for (auto block : blocks)
+    {
+        unmapBlock(block);
+    }
+}
+
+std::size_t BlockPool::NumberOfFreeBlocks() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return free_blocks.size();
+}
+}
+}
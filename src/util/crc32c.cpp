@@ -0,0 +1,111 @@
+#include "util/crc32c.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define OSRM_HARDWARE_CRC32C
+#include <nmmintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace osrm
+{
+namespace util
+{
+
+namespace
+{
+// the reflected Castagnoli polynomial
+const constexpr std::uint32_t CRC32C_POLYNOMIAL = 0x82f63b78;
+
+std::array<std::uint32_t, 256> makeTable()
+{
+    std::array<std::uint32_t, 256> table;
+    for (std::uint32_t byte = 0; byte < table.size(); ++byte)
+    {
+        auto crc = byte;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLYNOMIAL : 0);
+        }
+        table[byte] = crc;
+    }
+    return table;
+}
+
+std::uint32_t updateInSoftware(std::uint32_t crc, const unsigned char *data, std::size_t size)
+{
+    static const auto table = makeTable();
+    while (size--)
+    {
+        crc = table[(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef OSRM_HARDWARE_CRC32C
+__attribute__((target("sse4.2"))) std::uint32_t
+updateInHardware(std::uint32_t crc, const unsigned char *data, std::size_t size)
+{
+    std::uint64_t crc64 = crc;
+    for (; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t))
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += sizeof(word);
+    }
+    crc = static_cast<std::uint32_t>(crc64);
+    while (size--)
+    {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+    return crc;
+}
+#endif
+}
+
+bool hasHardwareCRC32C()
+{
+#ifdef OSRM_HARDWARE_CRC32C
+    static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+    return has_sse42;
+#else
+    return false;
+#endif
+}
+
+std::uint32_t updateCRC32C(std::uint32_t crc, const void *data, std::size_t size)
+{
+    const auto bytes = static_cast<const unsigned char *>(data);
+#ifdef OSRM_HARDWARE_CRC32C
+    if (hasHardwareCRC32C())
+    {
+        return ~updateInHardware(~crc, bytes, size);
+    }
+#endif
+    return ~updateInSoftware(~crc, bytes, size);
+}
+
+std::vector<std::uint32_t>
+computeBlockCRC32C(const void *data, std::size_t size, std::size_t block_size)
+{
+    const auto bytes = static_cast<const unsigned char *>(data);
+    std::vector<std::uint32_t> checksums((size + block_size - 1) / block_size);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, checksums.size(), 1),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto block = range.begin(); block < range.end(); ++block)
+                          {
+                              const auto first = block * block_size;
+                              checksums[block] = computeCRC32C(
+                                  bytes + first, std::min(block_size, size - first));
+                          }
+                      });
+    return checksums;
+}
+}
+}
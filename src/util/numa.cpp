@@ -0,0 +1,206 @@
+#include "util/numa.hpp"
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace osrm
+{
+namespace util
+{
+
+namespace
+{
+// The node a thread is pinned to
+thread_local std::size_t pinned_node = std::numeric_limits<std::size_t>::max();
+
+// Parses a cpulist like 0-7,16-23
+std::vector<unsigned> parseCPUList(const std::string &cpu_list)
+{
+    std::vector<unsigned> cpus;
+    std::istringstream stream(cpu_list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        const auto dash = range.find('-');
+        try
+        {
+            const auto first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+            const auto last = dash == std::string::npos
+                                  ? first
+                                  : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+            for (auto cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        catch (const std::exception &)
+        {
+            // an empty list of a node without CPUs
+        }
+    }
+    return cpus;
+}
+
+std::vector<NumaNode> readNumaNodes()
+{
+    std::vector<NumaNode> nodes;
+#ifdef __linux__
+    const boost::filesystem::path node_directory("/sys/devices/system/node");
+    boost::system::error_code error;
+    for (boost::filesystem::directory_iterator iter(node_directory, error), end;
+         !error && iter != end;
+         iter.increment(error))
+    {
+        const auto name = iter->path().filename().string();
+        if (name.compare(0, 4, "node") != 0 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos || name.size() == 4)
+            continue;
+
+        boost::filesystem::ifstream cpu_list_file(iter->path() / "cpulist");
+        std::string cpu_list;
+        std::getline(cpu_list_file, cpu_list);
+        auto cpus = parseCPUList(cpu_list);
+        // nodes without CPUs only have memory, no threads can be local to them
+        if (!cpus.empty())
+            nodes.push_back({static_cast<unsigned>(std::stoul(name.substr(4))), std::move(cpus)});
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const NumaNode &lhs, const NumaNode &rhs) {
+        return lhs.id < rhs.id;
+    });
+#endif
+
+    if (nodes.empty())
+    {
+        NumaNode node{0, {}};
+        for (const auto cpu : util::irange(0u, std::max(1u, std::thread::hardware_concurrency())))
+            node.cpus.push_back(cpu);
+        nodes.push_back(std::move(node));
+    }
+    return nodes;
+}
+
+#ifdef __linux__
+void setMemoryPolicy(void *memory,
+                     const std::size_t size,
+                     const int mode,
+                     const std::vector<unsigned> &node_ids)
+{
+    constexpr auto BITS_PER_WORD = sizeof(unsigned long) * 8;
+    const auto max_id = *std::max_element(node_ids.begin(), node_ids.end());
+    std::vector<unsigned long> node_mask(max_id / BITS_PER_WORD + 1, 0);
+    for (const auto id : node_ids)
+        node_mask[id / BITS_PER_WORD] |= 1UL << (id % BITS_PER_WORD);
+
+    // mbind needs page aligned memory
+    const auto page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const auto begin = reinterpret_cast<std::uintptr_t>(memory) / page_size * page_size;
+    const auto end = reinterpret_cast<std::uintptr_t>(memory) + size;
+    if (-1 == syscall(SYS_mbind,
+                      begin,
+                      end - begin,
+                      mode,
+                      node_mask.data(),
+                      node_mask.size() * BITS_PER_WORD + 1,
+                      0))
+    {
+        util::Log(logWARNING) << "Could not set the NUMA memory policy";
+    }
+}
+#endif
+}
+
+const std::vector<NumaNode> &GetNumaNodes()
+{
+    static const std::vector<NumaNode> nodes = readNumaNodes();
+    return nodes;
+}
+
+void PinThreadToNumaNode(const std::size_t node)
+{
+    const auto &nodes = GetNumaNodes();
+    BOOST_ASSERT(node < nodes.size());
+    pinned_node = node;
+
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const auto cpu : nodes[node].cpus)
+        CPU_SET(cpu, &cpu_set);
+    if (0 != pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set))
+    {
+        util::Log(logWARNING) << "Could not pin thread to NUMA node " << nodes[node].id;
+    }
+#endif
+}
+
+std::size_t CurrentNumaNode()
+{
+    if (pinned_node != std::numeric_limits<std::size_t>::max())
+        return pinned_node;
+
+    const auto &nodes = GetNumaNodes();
+#ifdef __linux__
+    unsigned cpu = 0;
+    unsigned node_id = 0;
+    if (nodes.size() > 1 && 0 == syscall(SYS_getcpu, &cpu, &node_id, nullptr))
+    {
+        const auto iter =
+            std::find_if(nodes.begin(), nodes.end(), [node_id](const NumaNode &node) {
+                return node.id == node_id;
+            });
+        if (iter != nodes.end())
+            return iter - nodes.begin();
+    }
+#endif
+    return 0;
+}
+
+void BindMemoryToNumaNode(void *memory, const std::size_t size, const std::size_t node)
+{
+    const auto &nodes = GetNumaNodes();
+    BOOST_ASSERT(node < nodes.size());
+#ifdef __linux__
+    if (nodes.size() > 1)
+        setMemoryPolicy(memory, size, MPOL_BIND, {nodes[node].id});
+#else
+    (void)memory;
+    (void)size;
+    (void)nodes;
+#endif
+}
+
+void InterleaveMemory(void *memory, const std::size_t size)
+{
+    const auto &nodes = GetNumaNodes();
+#ifdef __linux__
+    if (nodes.size() > 1)
+    {
+        std::vector<unsigned> node_ids;
+        for (const auto &node : nodes)
+            node_ids.push_back(node.id);
+        setMemoryPolicy(memory, size, MPOL_INTERLEAVE, node_ids);
+    }
+#else
+    (void)memory;
+    (void)size;
+    (void)nodes;
+#endif
+}
+}
+}
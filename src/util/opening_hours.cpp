@@ -431,5 +431,58 @@ bool CheckOpeningHours(const std::vector<OpeningHours> &input, const struct tm &
     return is_open;
 }
 
+boost::optional<WeeklySchedule> CompileWeeklySchedule(const std::vector<OpeningHours> &input)
+{
+    const std::uint16_t minutes_per_day = 24 * 60;
+
+    // the opening hours can only change at these minutes of a day
+    std::vector<std::uint16_t> day_minutes = {0};
+    for (const auto &opening_hours : input)
+    {
+        if (!opening_hours.monthdays.empty())
+            return boost::none;
+
+        for (const auto &span : opening_hours.times)
+        {
+            if (span.from.event != OpeningHours::Time::none ||
+                span.to.event != OpeningHours::Time::none || span.from.minutes < 0 ||
+                span.to.minutes < 0)
+                return boost::none;
+
+            day_minutes.push_back(span.from.minutes % minutes_per_day);
+            day_minutes.push_back(span.to.minutes % minutes_per_day);
+        }
+    }
+    std::sort(day_minutes.begin(), day_minutes.end());
+    day_minutes.erase(std::unique(day_minutes.begin(), day_minutes.end()), day_minutes.end());
+
+    WeeklySchedule schedule;
+    bool is_open = false;
+    struct tm time = {};
+    for (int weekday = 0; weekday < 7; ++weekday)
+    {
+        time.tm_wday = weekday;
+        for (const auto minute : day_minutes)
+        {
+            time.tm_hour = minute / 60;
+            time.tm_min = minute % 60;
+            if (CheckOpeningHours(input, time) != is_open)
+            {
+                is_open = !is_open;
+                schedule.push_back(weekday * minutes_per_day + minute);
+            }
+        }
+    }
+
+    return schedule;
+}
+
+bool CheckWeeklySchedule(const WeeklySchedule &schedule, const struct tm &time)
+{
+    const std::uint16_t minute = (time.tm_wday * 24 + time.tm_hour) * 60 + time.tm_min;
+    const auto switches = std::upper_bound(schedule.begin(), schedule.end(), minute);
+    return std::distance(schedule.begin(), switches) % 2 == 1;
+}
+
 } // util
 } // osrm
@@ -0,0 +1,161 @@
+#include "util/phase_report.hpp"
+#include "util/json_renderer.hpp"
+
+#include <boost/filesystem/fstream.hpp>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <utility>
+
+namespace osrm
+{
+namespace util
+{
+
+namespace
+{
+// initialized when the tool is loaded, before main runs
+const auto process_start = std::chrono::steady_clock::now();
+
+#ifndef _WIN32
+double toSeconds(const timeval &time) { return time.tv_sec + 0.000001 * time.tv_usec; }
+#endif
+
+// Adds the bytes of the read and write calls of the process, /proc/self/io only exists on Linux
+void readIOCounters(ResourceUsage &usage)
+{
+#ifdef __linux__
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    std::uint64_t value;
+    while (io >> key >> value)
+    {
+        if (key == "rchar:")
+            usage.read_bytes = value;
+        else if (key == "wchar:")
+            usage.written_bytes = value;
+    }
+#else
+    (void)usage;
+#endif
+}
+
+json::Object toJSON(const ResourceUsage &begin,
+                    const ResourceUsage &end,
+                    const unsigned number_of_threads)
+{
+    const auto wall_seconds = end.wall_seconds - begin.wall_seconds;
+    const auto cpu_seconds = end.cpu_seconds - begin.cpu_seconds;
+
+    json::Object object;
+    object.values["start_seconds"] = begin.wall_seconds;
+    object.values["wall_seconds"] = wall_seconds;
+    object.values["cpu_seconds"] = cpu_seconds;
+    object.values["thread_utilization"] =
+        wall_seconds > 0 ? cpu_seconds / (wall_seconds * std::max(1u, number_of_threads)) : 0.;
+    // the peak of the process up to the end of the phase, phases don't have a peak of their own
+    object.values["peak_rss_bytes"] = static_cast<double>(end.peak_rss_bytes);
+    object.values["read_bytes"] = static_cast<double>(end.read_bytes - begin.read_bytes);
+    object.values["written_bytes"] = static_cast<double>(end.written_bytes - begin.written_bytes);
+    return object;
+}
+}
+
+ResourceUsage ResourceUsage::Now()
+{
+    ResourceUsage usage{};
+    usage.wall_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - process_start).count();
+
+#ifndef _WIN32
+    rusage resources;
+    getrusage(RUSAGE_SELF, &resources);
+    usage.cpu_seconds = toSeconds(resources.ru_utime) + toSeconds(resources.ru_stime);
+#ifdef __linux__
+    // Under linux, ru.maxrss is in kb
+    usage.peak_rss_bytes = static_cast<std::uint64_t>(resources.ru_maxrss) * 1024;
+#else
+    usage.peak_rss_bytes = static_cast<std::uint64_t>(resources.ru_maxrss);
+#endif
+#else
+    usage.cpu_seconds = static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+
+    readIOCounters(usage);
+    return usage;
+}
+
+PhaseReport &PhaseReport::GetInstance()
+{
+    static PhaseReport report;
+    return report;
+}
+
+void PhaseReport::Record(std::string name, const ResourceUsage &begin, const ResourceUsage &end)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    phases.push_back(Phase{std::move(name), begin, end});
+}
+
+std::vector<PhaseReport::Phase> PhaseReport::GetPhases() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return phases;
+}
+
+json::Object PhaseReport::ToJSON(const std::string &tool, const unsigned number_of_threads) const
+{
+    json::Object report = toJSON(ResourceUsage{}, ResourceUsage::Now(), number_of_threads);
+    report.values.erase("start_seconds");
+    report.values["tool"] = tool;
+    report.values["threads"] = number_of_threads;
+
+    json::Array phases_json;
+    for (const auto &phase : GetPhases())
+    {
+        auto phase_json = toJSON(phase.begin, phase.end, number_of_threads);
+        phase_json.values["name"] = phase.name;
+        phases_json.values.push_back(std::move(phase_json));
+    }
+    report.values["phases"] = std::move(phases_json);
+
+    return report;
+}
+
+bool PhaseReport::Write(const boost::filesystem::path &path,
+                        const std::string &tool,
+                        const unsigned number_of_threads) const
+{
+    boost::filesystem::ofstream out(path);
+    if (!out)
+        return false;
+
+    json::render(out, ToJSON(tool, number_of_threads));
+    out << std::endl;
+    return static_cast<bool>(out);
+}
+
+ReportPhase::ReportPhase(std::string name_)
+    : name(std::move(name_)), begin(ResourceUsage::Now()), stopped(false)
+{
+}
+
+ReportPhase::~ReportPhase() { Stop(); }
+
+void ReportPhase::Stop()
+{
+    if (!stopped)
+    {
+        PhaseReport::GetInstance().Record(std::move(name), begin, ResourceUsage::Now());
+        stopped = true;
+    }
+}
+}
+}
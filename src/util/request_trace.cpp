@@ -0,0 +1,41 @@
+#include "util/request_trace.hpp"
+
+namespace osrm
+{
+namespace util
+{
+
+namespace
+{
+double toMilliseconds(const RequestTrace::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+}
+
+constexpr std::size_t RequestTrace::MAX_SPANS;
+
+json::Object RequestTrace::ToJSON(const std::string &uri, const int status) const
+{
+    json::Object trace;
+    trace.values["uri"] = uri;
+    trace.values["status"] = status;
+    trace.values["total_ms"] = toMilliseconds(Clock::now() - start);
+
+    json::Array spans_json;
+    spans_json.values.reserve(spans.size());
+    for (const auto &span : spans)
+    {
+        json::Object span_json;
+        span_json.values["name"] = span.name;
+        span_json.values["depth"] = span.depth;
+        span_json.values["start_ms"] = toMilliseconds(span.start);
+        span_json.values["duration_ms"] = toMilliseconds(span.duration);
+        spans_json.values.push_back(std::move(span_json));
+    }
+    trace.values["spans"] = std::move(spans_json);
+
+    return trace;
+}
+}
+}
@@ -1,71 +1,48 @@
 #include "util/timezones.hpp"
 #include "util/exception.hpp"
 #include "util/geojson_validation.hpp"
+#include "util/coordinate.hpp"
+#include "util/hilbert_value.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
 
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/math/constants/constants.hpp>
 #include <boost/optional.hpp>
 
 #include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
 #include <rapidjson/istreamwrapper.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <limits>
+#include <mutex>
+#include <numeric>
 #include <regex>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 
 #include <time.h>
 
 // Function loads time zone shape polygons, computes a zone local time for utc_time,
-// creates a lookup R-tree and returns a lambda function that maps a point
+// creates a lookup grid and returns a lambda function that maps a point
 // to the corresponding local time
 namespace osrm
 {
 namespace updater
 {
 
-Timezoner::Timezoner(const char geojson[], std::time_t utc_time_now)
+namespace
 {
-    util::Log() << "Time zone validation based on UTC time : " << utc_time_now;
-    rapidjson::Document doc;
-    rapidjson::ParseResult ok = doc.Parse(geojson);
-    if (!ok)
-    {
-        auto code = ok.Code();
-        auto offset = ok.Offset();
-        throw osrm::util::exception("Failed to parse timezone geojson with error code " +
-                                    std::to_string(code) + " malformed at offset " +
-                                    std::to_string(offset));
-    }
-    LoadLocalTimesRTree(doc, utc_time_now);
-}
-
-Timezoner::Timezoner(const boost::filesystem::path &tz_shapes_filename, std::time_t utc_time_now)
-{
-    util::Log() << "Time zone validation based on UTC time : " << utc_time_now;
-
-    if (tz_shapes_filename.empty())
-        throw osrm::util::exception("Missing time zone geojson file");
-    std::ifstream file(tz_shapes_filename.string());
-    if (!file.is_open())
-        throw osrm::util::exception("failed to open " + tz_shapes_filename.string());
-
-    util::Log() << "Parsing " + tz_shapes_filename.string();
-    rapidjson::IStreamWrapper isw(file);
-    rapidjson::Document geojson;
-    geojson.ParseStream(isw);
-    if (geojson.HasParseError())
-    {
-        throw osrm::util::exception(std::string("Failed to parse ") + tz_shapes_filename.string() +
-                                    ":" + std::to_string(geojson.GetErrorOffset()) + " error: " +
-                                    rapidjson::GetParseError_En(geojson.GetParseError()));
-    }
-    LoadLocalTimesRTree(geojson, utc_time_now);
-}
-
-void Timezoner::LoadLocalTimesRTree(rapidjson::Document &geojson, std::time_t utc_time)
+std::shared_ptr<TimezoneIndex> loadIndex(rapidjson::Document &geojson)
 {
     if (!geojson.HasMember("type"))
         throw osrm::util::exception("Failed to parse time zone file. Missing type member.");
@@ -78,31 +55,11 @@ void Timezoner::LoadLocalTimesRTree(rapidjson::Document &geojson, std::time_t ut
     if (!geojson.HasMember("features"))
         throw osrm::util::exception("Failed to parse time zone file. Missing features list.");
 
-    // Lambda function that returns local time in the tzname time zone
-    // Thread safety: MT-Unsafe const:env
-    std::unordered_map<std::string, struct tm> local_time_memo;
-    auto get_local_time_in_tz = [utc_time, &local_time_memo](const char *tzname) {
-        auto it = local_time_memo.find(tzname);
-        if (it == local_time_memo.end())
-        {
-            struct tm timeinfo;
-#if defined(_WIN32)
-            _putenv_s("TZ", tzname);
-            _tzset();
-            localtime_s(&timeinfo, &utc_time);
-#else
-            setenv("TZ", tzname, 1);
-            tzset();
-            localtime_r(&utc_time, &timeinfo);
-#endif
-            it = local_time_memo.insert({tzname, timeinfo}).first;
-        }
+    auto index = std::make_shared<TimezoneIndex>();
+    std::unordered_map<std::string, std::size_t> zones;
 
-        return it->second;
-    };
     BOOST_ASSERT(geojson["features"].IsArray());
     const auto &features_array = geojson["features"].GetArray();
-    std::vector<rtree_t::value_type> polygons;
     for (rapidjson::SizeType i = 0; i < features_array.Size(); i++)
     {
         util::validateFeature(features_array[i]);
@@ -133,34 +90,360 @@ void Timezoner::LoadLocalTimesRTree(rapidjson::Document &geojson, std::time_t ut
                 const auto &coords = coords_outer_array[i].GetArray();
                 polygon.outer().emplace_back(coords[0].GetDouble(), coords[1].GetDouble());
             }
-            polygons.emplace_back(boost::geometry::return_envelope<box_t>(polygon),
-                                  local_times.size());
 
-            // Get time zone name and emplace polygon and local time for the UTC input
-            const auto &tzname = properties["tzid"].GetString();
-            local_times.push_back(local_time_t{polygon, get_local_time_in_tz(tzname)});
+            // Get time zone name and emplace polygon and the index of its time zone
+            const std::string tzname = properties["tzid"].GetString();
+            const auto zone = zones.insert({tzname, index->zone_names.size()}).first->second;
+            if (zone == index->zone_names.size())
+                index->zone_names.push_back(tzname);
+            index->polygons.push_back(std::move(polygon));
+            index->polygon_zones.push_back(zone);
         }
         else
         {
             util::Log(logDEBUG) << "Skipping non-polygon shape in timezone file";
         }
     }
-    util::Log() << "Parsed " << polygons.size() << "time zone polygons." << std::endl;
-    // Create R-tree for collected shape polygons
-    rtree = rtree_t(polygons);
+
+    return index;
 }
 
-boost::optional<struct tm> Timezoner::operator()(const point_t &point) const
+// The edges of the polygons are great circle arcs, which bulge towards the poles from the straight
+// lines between their points in degrees. The arcs stay within the bounds of the lines extended
+// by this latitude.
+double maxBulge(const point_t &from, const point_t &to)
+{
+    const auto length = std::max(std::abs(to.get<0>() - from.get<0>()),
+                                 std::abs(to.get<1>() - from.get<1>()));
+    return length * length * boost::math::constants::pi<double>() / (180. * 16.);
+}
+
+void buildGrid(TimezoneIndex &index)
+{
+    using Bounds = std::tuple<double, double, double, double>;
+
+    // bounds of the arcs of every polygon
+    std::vector<Bounds> polygon_bounds;
+    std::size_t number_of_points = 0;
+    auto x_min = std::numeric_limits<double>::max(), x_max = std::numeric_limits<double>::lowest();
+    auto y_min = std::numeric_limits<double>::max(), y_max = std::numeric_limits<double>::lowest();
+    for (const auto &polygon : index.polygons)
+    {
+        const auto &ring = polygon.outer();
+        Bounds bounds{std::numeric_limits<double>::max(),
+                      std::numeric_limits<double>::max(),
+                      std::numeric_limits<double>::lowest(),
+                      std::numeric_limits<double>::lowest()};
+        for (const auto position : util::irange<std::size_t>(0, ring.size()))
+        {
+            const auto &from = ring[position];
+            const auto &to = ring[(position + 1) % ring.size()];
+            const auto bulge = maxBulge(from, to);
+            std::get<0>(bounds) = std::min(std::get<0>(bounds), from.get<0>());
+            std::get<1>(bounds) =
+                std::min(std::get<1>(bounds), std::min(from.get<1>(), to.get<1>()) - bulge);
+            std::get<2>(bounds) = std::max(std::get<2>(bounds), from.get<0>());
+            std::get<3>(bounds) =
+                std::max(std::get<3>(bounds), std::max(from.get<1>(), to.get<1>()) + bulge);
+        }
+        polygon_bounds.push_back(bounds);
+        number_of_points += ring.size();
+
+        if (!ring.empty())
+        {
+            x_min = std::min(x_min, std::get<0>(bounds));
+            y_min = std::min(y_min, std::get<1>(bounds));
+            x_max = std::max(x_max, std::get<2>(bounds));
+            y_max = std::max(y_max, std::get<3>(bounds));
+        }
+    }
+    if (x_min > x_max || y_min > y_max)
+        return;
+    index.bounds = box_t{{x_min, y_min}, {x_max, y_max}};
+
+    // About as many cells as points, the exact tests of the boundary cells have a few points
+    constexpr const std::size_t min_cells_per_axis = 16;
+    constexpr const std::size_t max_cells_per_axis = 1024;
+    const auto cells_per_axis = std::min(
+        max_cells_per_axis,
+        std::max(min_cells_per_axis, static_cast<std::size_t>(std::sqrt(number_of_points))));
+    const auto width = x_max - x_min;
+    const auto height = y_max - y_min;
+    index.columns = width > 0 ? cells_per_axis : 1;
+    index.rows = height > 0 ? cells_per_axis : 1;
+    index.cell_width = width > 0 ? width / index.columns : 1.;
+    index.cell_height = height > 0 ? height / index.rows : 1.;
+
+    const auto to_column = [&](const double x) {
+        return std::min<std::size_t>(index.columns - 1,
+                                     std::max(0., std::floor((x - x_min) / index.cell_width)));
+    };
+    const auto to_row = [&](const double y) {
+        return std::min<std::size_t>(index.rows - 1,
+                                     std::max(0., std::floor((y - y_min) / index.cell_height)));
+    };
+    // arcs are rasterized with a margin so rounding can't miss a cell they touch
+    const auto x_margin = index.cell_width * 1e-6;
+    const auto y_margin = index.cell_height * 1e-6;
+
+    const std::uint8_t outside = 0, boundary = 1, inside = 2;
+
+    // pairs of cell and entry
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> cell_entries;
+    std::vector<std::uint8_t> cells;
+    for (const auto polygon_position : util::irange<std::size_t>(0, index.polygons.size()))
+    {
+        const auto &ring = index.polygons[polygon_position].outer();
+        if (ring.empty())
+            continue;
+
+        const auto &bounds = polygon_bounds[polygon_position];
+        const auto first_column = to_column(std::get<0>(bounds));
+        const auto last_column = to_column(std::get<2>(bounds));
+        const auto first_row = to_row(std::get<1>(bounds));
+        const auto last_row = to_row(std::get<3>(bounds));
+        const auto columns = last_column - first_column + 1;
+        cells.assign(columns * (last_row - first_row + 1), outside);
+
+        // mark the cells of the bounds of every arc
+        for (const auto position : util::irange<std::size_t>(0, ring.size()))
+        {
+            const auto &from = ring[position];
+            const auto &to = ring[(position + 1) % ring.size()];
+            const auto bulge = maxBulge(from, to);
+            const std::pair<double, double> arc_x = std::minmax(from.get<0>(), to.get<0>());
+            const std::pair<double, double> arc_y = std::minmax(from.get<1>(), to.get<1>());
+            for (auto row = std::max(first_row, to_row(arc_y.first - bulge - y_margin)),
+                      end_row = std::min(last_row, to_row(arc_y.second + bulge + y_margin));
+                 row <= end_row;
+                 ++row)
+            {
+                for (auto column = std::max(first_column, to_column(arc_x.first - x_margin)),
+                          end_column = std::min(last_column, to_column(arc_x.second + x_margin));
+                     column <= end_column;
+                     ++column)
+                {
+                    cells[(row - first_row) * columns + column - first_column] = boundary;
+                }
+            }
+        }
+
+        // the boundary does not cross the cells between the boundary cells of a row, one test
+        // decides whether they are inside the polygon
+        for (const auto row : util::irange(first_row, last_row + 1))
+        {
+            auto cell = cells.begin() + (row - first_row) * columns;
+            const auto end = cell + columns;
+            while (cell != end)
+            {
+                if (*cell == boundary)
+                {
+                    ++cell;
+                    continue;
+                }
+
+                const auto column = first_column + (cell - cells.begin()) % columns;
+                const point_t center{x_min + (column + 0.5) * index.cell_width,
+                                     y_min + (row + 0.5) * index.cell_height};
+                const auto state =
+                    boost::geometry::within(center, index.polygons[polygon_position]) ? inside
+                                                                                       : outside;
+                for (; cell != end && *cell != boundary; ++cell)
+                {
+                    *cell = state;
+                }
+            }
+        }
+
+        for (const auto row : util::irange(first_row, last_row + 1))
+        {
+            for (const auto column : util::irange(first_column, last_column + 1))
+            {
+                const auto state = cells[(row - first_row) * columns + column - first_column];
+                if (state != outside)
+                {
+                    cell_entries.emplace_back(row * index.columns + column,
+                                              polygon_position << 1 | (state == boundary));
+                }
+            }
+        }
+    }
+
+    // the entries of a cell keep the order of the polygons in the file
+    std::stable_sort(cell_entries.begin(),
+                     cell_entries.end(),
+                     [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+    index.first_entries.assign(index.columns * index.rows + 1, 0);
+    index.entries.reserve(cell_entries.size());
+    for (const auto &cell_entry : cell_entries)
+    {
+        ++index.first_entries[cell_entry.first + 1];
+        index.entries.push_back(cell_entry.second);
+    }
+    std::partial_sum(
+        index.first_entries.begin(), index.first_entries.end(), index.first_entries.begin());
+}
+
+std::shared_ptr<const TimezoneIndex> buildIndex(rapidjson::Document &geojson)
+{
+    auto index = loadIndex(geojson);
+    buildGrid(*index);
+    util::Log() << "Parsed " << index->polygons.size() << " time zone polygons in "
+                << index->zone_names.size() << " time zones";
+    return std::move(index);
+}
+
+// Returns the index of the file of the last time zones, unless the file was modified
+std::shared_ptr<const TimezoneIndex>
+loadCachedIndex(const boost::filesystem::path &tz_shapes_filename)
 {
-    std::vector<rtree_t::value_type> result;
-    rtree.query(boost::geometry::index::intersects(point), std::back_inserter(result));
-    for (const auto v : result)
+    static std::mutex mutex;
+    static std::tuple<std::string, std::time_t, std::uintmax_t> cached_file;
+    static std::shared_ptr<const TimezoneIndex> cached_index;
+
+    if (tz_shapes_filename.empty())
+        throw osrm::util::exception("Missing time zone geojson file");
+    std::ifstream file(tz_shapes_filename.string());
+    if (!file.is_open())
+        throw osrm::util::exception("failed to open " + tz_shapes_filename.string());
+
+    const auto file_key = std::make_tuple(boost::filesystem::canonical(tz_shapes_filename).string(),
+                                          boost::filesystem::last_write_time(tz_shapes_filename),
+                                          boost::filesystem::file_size(tz_shapes_filename));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cached_index && cached_file == file_key)
     {
-        const auto index = v.second;
-        if (boost::geometry::within(point, local_times[index].first))
-            return local_times[index].second;
+        util::Log() << "Using the parsed " + tz_shapes_filename.string();
+        return cached_index;
+    }
+
+    util::Log() << "Parsing " + tz_shapes_filename.string();
+    rapidjson::IStreamWrapper isw(file);
+    rapidjson::Document geojson;
+    geojson.ParseStream(isw);
+    if (geojson.HasParseError())
+    {
+        throw osrm::util::exception(std::string("Failed to parse ") + tz_shapes_filename.string() +
+                                    ":" + std::to_string(geojson.GetErrorOffset()) + " error: " +
+                                    rapidjson::GetParseError_En(geojson.GetParseError()));
+    }
+
+    cached_index = buildIndex(geojson);
+    cached_file = file_key;
+    return cached_index;
+}
+
+boost::optional<std::size_t> findZone(const TimezoneIndex &index, const point_t &point)
+{
+    const auto x = point.get<0>(), y = point.get<1>();
+    if (index.entries.empty() || x < index.bounds.min_corner().get<0>() ||
+        x > index.bounds.max_corner().get<0>() || y < index.bounds.min_corner().get<1>() ||
+        y > index.bounds.max_corner().get<1>())
+        return boost::none;
+
+    const auto column = std::min<std::size_t>(
+        index.columns - 1,
+        std::floor((x - index.bounds.min_corner().get<0>()) / index.cell_width));
+    const auto row = std::min<std::size_t>(
+        index.rows - 1, std::floor((y - index.bounds.min_corner().get<1>()) / index.cell_height));
+    const auto cell = row * index.columns + column;
+    for (auto entry = index.first_entries[cell]; entry < index.first_entries[cell + 1]; ++entry)
+    {
+        const auto polygon = index.entries[entry] >> 1;
+        const bool is_boundary = index.entries[entry] & 1;
+        if (!is_boundary || boost::geometry::within(point, index.polygons[polygon]))
+            return index.polygon_zones[polygon];
     }
     return boost::none;
 }
 }
+
+Timezoner::Timezoner(const char geojson[], std::time_t utc_time_now)
+{
+    util::Log() << "Time zone validation based on UTC time : " << utc_time_now;
+    rapidjson::Document doc;
+    rapidjson::ParseResult ok = doc.Parse(geojson);
+    if (!ok)
+    {
+        auto code = ok.Code();
+        auto offset = ok.Offset();
+        throw osrm::util::exception("Failed to parse timezone geojson with error code " +
+                                    std::to_string(code) + " malformed at offset " +
+                                    std::to_string(offset));
+    }
+    index = buildIndex(doc);
+    LoadLocalTimes(utc_time_now);
+}
+
+Timezoner::Timezoner(const boost::filesystem::path &tz_shapes_filename, std::time_t utc_time_now)
+{
+    util::Log() << "Time zone validation based on UTC time : " << utc_time_now;
+
+    index = loadCachedIndex(tz_shapes_filename);
+    LoadLocalTimes(utc_time_now);
+}
+
+void Timezoner::LoadLocalTimes(std::time_t utc_time)
+{
+    // Local time in the tzname time zone
+    // Thread safety: MT-Unsafe const:env
+    local_times.clear();
+    for (const auto &tzname : index->zone_names)
+    {
+        struct tm timeinfo;
+#if defined(_WIN32)
+        _putenv_s("TZ", tzname.c_str());
+        _tzset();
+        localtime_s(&timeinfo, &utc_time);
+#else
+        setenv("TZ", tzname.c_str(), 1);
+        tzset();
+        localtime_r(&utc_time, &timeinfo);
+#endif
+        local_times.push_back(timeinfo);
+    }
+}
+
+boost::optional<struct tm> Timezoner::operator()(const point_t &point) const
+{
+    if (!index)
+        return boost::none;
+
+    const auto zone = findZone(*index, point);
+    if (!zone)
+        return boost::none;
+    return local_times[*zone];
+}
+
+std::vector<boost::optional<struct tm>> Timezoner::
+operator()(const std::vector<point_t> &points) const
+{
+    std::vector<boost::optional<struct tm>> times(points.size());
+    if (!index)
+        return times;
+
+    std::vector<std::pair<std::uint64_t, std::size_t>> order;
+    order.reserve(points.size());
+    for (const auto position : util::irange<std::size_t>(0, points.size()))
+    {
+        const util::Coordinate coordinate{util::FloatLongitude{points[position].get<0>()},
+                                          util::FloatLatitude{points[position].get<1>()}};
+        order.emplace_back(coordinate.IsValid() ? util::GetHilbertCode(coordinate) : 0, position);
+    }
+    std::sort(order.begin(), order.end());
+
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, order.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto rank = range.begin(); rank < range.end(); ++rank)
+                          {
+                              const auto position = order[rank].second;
+                              times[position] = (*this)(points[position]);
+                          }
+                      });
+
+    return times;
+}
+}
 }
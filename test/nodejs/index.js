@@ -4,6 +4,7 @@ var monaco_path = require('./constants').data_path;
 var test_memory_file = require('./constants').test_memory_file;
 var monaco_mld_path = require('./constants').mld_data_path;
 var monaco_corech_path = require('./constants').corech_data_path;
+var two_test_coordinates = require('./constants').two_test_coordinates;
 
 test('constructor: throws if new keyword is not used', function(assert) {
     assert.plan(1);
@@ -143,6 +144,27 @@ test('constructor: throws on invalid custom limits', function(assert) {
     });
 });
 
+test('constructor: takes a number of threads', function(assert) {
+    assert.plan(6);
+    var osrm = new OSRM({path: monaco_path, threads: 2});
+    for (var i = 0; i < 3; ++i) {
+        osrm.route({coordinates: two_test_coordinates}, function(err, route) {
+            assert.ifError(err);
+            assert.ok(route.routes.length);
+        });
+    }
+});
+
+test('constructor: throws if given an invalid number of threads', function(assert) {
+    assert.plan(3);
+    assert.throws(function() { new OSRM({path: monaco_path, threads: 0}); },
+        /threads must be a positive integral number/);
+    assert.throws(function() { new OSRM({path: monaco_path, threads: 1.5}); },
+        /threads must be a positive integral number/);
+    assert.throws(function() { new OSRM({path: monaco_path, threads: 'many'}); },
+        /threads must be a positive integral number/);
+});
+
 require('./route.js');
 require('./trip.js');
 require('./match.js');
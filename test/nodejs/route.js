@@ -19,6 +19,41 @@ test('route: routes Monaco', function(assert) {
     });
 });
 
+test('route: routes Monaco and returns a JSON buffer', function(assert) {
+    assert.plan(6);
+    var osrm = new OSRM(monaco_path);
+    osrm.route({coordinates: two_test_coordinates}, {format: 'json_buffer'}, function(err, result) {
+        assert.ifError(err);
+        assert.ok(result instanceof Buffer);
+        var route = JSON.parse(result);
+        assert.ok(route.waypoints);
+        assert.ok(route.routes);
+        assert.ok(route.routes.length);
+        assert.ok(route.routes[0].geometry);
+    });
+});
+
+test('route: routes Monaco and returns a binary buffer', function(assert) {
+    assert.plan(3);
+    var osrm = new OSRM(monaco_path);
+    osrm.route({coordinates: two_test_coordinates}, {format: 'binary'}, function(err, result) {
+        assert.ifError(err);
+        assert.ok(result instanceof Buffer);
+        assert.ok(result.length > 0);
+    });
+});
+
+test('route: throws on an invalid plugin config', function(assert) {
+    assert.plan(3);
+    var osrm = new OSRM(monaco_path);
+    assert.throws(function() { osrm.route({coordinates: two_test_coordinates}, 'json', function(err, route) {}) },
+        /Plugin config must be an object/);
+    assert.throws(function() { osrm.route({coordinates: two_test_coordinates}, {format: 'xml'}, function(err, route) {}) },
+        /format must be a string: "object", "json_buffer", "typed_array" or "binary"/);
+    assert.throws(function() { osrm.route({coordinates: two_test_coordinates}, {format: 'typed_array'}, function(err, route) {}) },
+        /typed_array/);
+});
+
 test('route: routes Monaco on MLD', function(assert) {
     assert.plan(5);
     var osrm = new OSRM({path: monaco_mld_path, algorithm: 'MLD'});
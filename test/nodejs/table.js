@@ -36,6 +36,26 @@ test('table: distance table in Monaco', function(assert) {
     });
 });
 
+test('table: distance table in Monaco as typed arrays', function(assert) {
+    assert.plan(8);
+    var osrm = new OSRM(data_path);
+    var options = {
+        coordinates: [three_test_coordinates[0], three_test_coordinates[1]],
+        annotations: ['duration', 'distance']
+    };
+    osrm.table(options, {format: 'typed_array'}, function(err, table) {
+        assert.ifError(err);
+        assert.ok(table.durations instanceof Float64Array, 'durations must be a Float64Array');
+        assert.ok(table.distances instanceof Float64Array, 'distances must be a Float64Array');
+        var count = options.coordinates.length;
+        assert.equal(table.durations.length, count * count);
+        assert.equal(table.distances.length, count * count);
+        assert.equal(table.durations[0], 0, 'diagonal must be zero');
+        assert.equal(table.durations[count + 1], 0, 'diagonal must be zero');
+        assert.ok(table.durations[1] > 0, 'other entries must be non-zero');
+    });
+});
+
 test('table: distance table in Monaco with sources/destinations', function(assert) {
     assert.plan(7);
     var osrm = new OSRM(data_path);
@@ -69,7 +89,7 @@ test('table: distance table in Monaco with sources/destinations', function(asser
 });
 
 test('table: throws on invalid arguments', function(assert) {
-    assert.plan(14);
+    assert.plan(15);
     var osrm = new OSRM(data_path);
     var options = {};
     assert.throws(function() { osrm.table(options); },
@@ -118,6 +138,11 @@ test('table: throws on invalid arguments', function(assert) {
     assert.doesNotThrow(function() { osrm.table(options, function(err, response) {}) },
         /You can either specify sources and destinations, or coordinates/);
 
+    options.approximate = 'yes';
+    assert.throws(function() { osrm.table(options, function(err, response) {}) },
+        /'approximate' param must be a boolean/);
+    delete options.approximate;
+
     assert.throws(function() { osrm.route({coordinates: two_test_coordinates, generate_hints: null}, function(err, route) {}) },
         /generate_hints must be of type Boolean/);
 });
@@ -181,3 +206,19 @@ test('table: table in Monaco without motorways', function(assert) {
     });
 });
 
+
+test('table: approximate table in Monaco', function(assert) {
+    assert.plan(5);
+    var osrm = new OSRM({path: mld_data_path, algorithm: 'MLD'});
+    var options = {
+        coordinates: three_test_coordinates,
+        approximate: true
+    };
+    osrm.table(options, function(err, response) {
+        assert.ifError(err);
+        assert.equal(response.durations.length, 3);
+        for (var i = 0; i < 3; ++i) {
+            assert.equal(response.durations[i][i], 0);
+        }
+    });
+});
@@ -0,0 +1,65 @@
+#include "contractor/compact_query_graph.hpp"
+
+#include "util/exception.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(compact_query_graph)
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+namespace
+{
+QueryGraph makeQueryGraph(const EdgeWeight weight_of_last_edge)
+{
+    std::vector<QueryEdge> edges = {
+        {0, 1, {7, false, 3, 6, true, false}},
+        {0, 2, {8, false, 2, 4, false, true}},
+        {0, 2, {1, true, 1, 3, true, true}},
+        {2, 3, {9, false, weight_of_last_edge, 10, true, false}},
+    };
+    return QueryGraph{4, edges};
+}
+}
+
+BOOST_AUTO_TEST_CASE(edges_keep_their_data)
+{
+    const auto graph = makeQueryGraph(5);
+    const CompactQueryGraph compact_graph{graph};
+
+    BOOST_REQUIRE_EQUAL(compact_graph.GetNumberOfNodes(), graph.GetNumberOfNodes());
+    BOOST_REQUIRE_EQUAL(compact_graph.GetNumberOfEdges(), graph.GetNumberOfEdges());
+    for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+    {
+        BOOST_CHECK_EQUAL(compact_graph.BeginEdges(node), graph.BeginEdges(node));
+        BOOST_CHECK_EQUAL(compact_graph.EndEdges(node), graph.EndEdges(node));
+    }
+    for (const auto edge : util::irange(0u, graph.GetNumberOfEdges()))
+    {
+        BOOST_CHECK_EQUAL(compact_graph.GetTarget(edge), graph.GetTarget(edge));
+        BOOST_CHECK(QueryEdge(0, compact_graph.GetTarget(edge), compact_graph.GetEdgeData(edge)) ==
+                    QueryEdge(0, graph.GetTarget(edge), graph.GetEdgeData(edge)));
+    }
+
+    BOOST_CHECK_EQUAL(compact_graph.FindEdge(0, 2), 1);
+    BOOST_CHECK_EQUAL(compact_graph.FindEdge(2, 0), SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(compact_graph.FindEdgeInEitherDirection(3, 2), 3);
+
+    const auto forward = [](const auto &data) { return data.forward; };
+    const auto backward = [](const auto &data) { return data.backward; };
+    BOOST_CHECK_EQUAL(compact_graph.FindSmallestEdge(0, 2, forward), 2);
+    BOOST_CHECK_EQUAL(compact_graph.FindSmallestEdge(0, 2, backward), 2);
+    BOOST_CHECK_EQUAL(compact_graph.FindSmallestEdge(0, 1, backward), SPECIAL_EDGEID);
+}
+
+BOOST_AUTO_TEST_CASE(weights_out_of_range_are_rejected)
+{
+    BOOST_CHECK_NO_THROW(CompactQueryGraph{makeQueryGraph(CompactQueryGraph::MAX_EDGE_WEIGHT)});
+    BOOST_CHECK_THROW(CompactQueryGraph{makeQueryGraph(CompactQueryGraph::MAX_EDGE_WEIGHT + 1)},
+                      util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#include "contractor/contractor_graph.hpp"
+
+#include "helper.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::contractor;
+using namespace osrm::unit_test;
+
+namespace
+{
+std::vector<NodeID> targets(const ContractorGraph &graph, const NodeID node)
+{
+    std::vector<NodeID> result;
+    for (const auto edge : graph.GetAdjacentEdgeRange(node))
+    {
+        result.push_back(graph.GetTarget(edge));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+ContractorEdgeData makeData(const EdgeWeight weight)
+{
+    return ContractorEdgeData{weight, weight, 1, 0, true, true, false};
+}
+}
+
+BOOST_AUTO_TEST_SUITE(contractor_graph)
+
+BOOST_AUTO_TEST_CASE(insert_and_delete_edges)
+{
+    // 0 <-> 1 <-> 2 <-> 3
+    auto graph = makeGraph({TestEdge{0, 1, 1}, TestEdge{1, 2, 1}, TestEdge{2, 3, 1}});
+    BOOST_CHECK_EQUAL(graph.GetNumberOfNodes(), 4);
+    BOOST_CHECK_EQUAL(graph.GetNumberOfEdges(), 6);
+    BOOST_CHECK((targets(graph, 1) == std::vector<NodeID>{0, 2}));
+
+    // grows the block of node 1 several times
+    for (const auto weight : util::irange<EdgeWeight>(0, 100))
+    {
+        graph.InsertEdge(1, 3, makeData(weight));
+    }
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(1), 102);
+    BOOST_CHECK_EQUAL(graph.GetNumberOfEdges(), 106);
+    BOOST_CHECK((targets(graph, 0) == std::vector<NodeID>{1}));
+    BOOST_CHECK((targets(graph, 2) == std::vector<NodeID>{1, 3}));
+
+    BOOST_CHECK_EQUAL(graph.DeleteEdgesTo(1, 3), 100);
+    BOOST_CHECK_EQUAL(graph.GetNumberOfEdges(), 6);
+    BOOST_CHECK((targets(graph, 1) == std::vector<NodeID>{0, 2}));
+
+    // the nodes that grow next reuse the blocks that node 1 left behind
+    graph.ReserveEdges(2, 16);
+    for (const auto weight : util::irange<EdgeWeight>(0, 16))
+    {
+        graph.InsertEdge(2, 0, makeData(weight));
+    }
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(2), 18);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(2, 1)).shortcut, false);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(2, 0)).shortcut, true);
+    BOOST_CHECK_EQUAL(graph.FindEdge(0, 3), SPECIAL_EDGEID);
+
+    graph.DeleteEdge(2, graph.FindEdge(2, 3));
+    BOOST_CHECK_EQUAL(graph.FindEdge(2, 3), SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(graph.GetNumberOfEdges(), 21);
+}
+
+BOOST_AUTO_TEST_CASE(renumber_and_filter)
+{
+    auto graph = makeGraph({TestEdge{0, 1, 1}, TestEdge{1, 2, 2}, TestEdge{2, 3, 3}});
+    for (const auto weight : util::irange<EdgeWeight>(0, 10))
+    {
+        graph.InsertEdge(0, 3, makeData(weight));
+    }
+
+    graph.Renumber({3, 2, 1, 0});
+    BOOST_CHECK_EQUAL(graph.GetNumberOfEdges(), 16);
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(3), 11);
+    BOOST_CHECK((targets(graph, 2) == std::vector<NodeID>{1, 3}));
+    BOOST_CHECK((targets(graph, 0) == std::vector<NodeID>{1}));
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(1, 2)).weight, 2);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(3, 2)).weight, 1);
+
+    // blocks allocated after the edges were packed must not overlap
+    graph.InsertEdge(1, 3, makeData(5));
+    for (const auto weight : util::irange<EdgeWeight>(0, 10))
+    {
+        graph.InsertEdge(2, 0, makeData(weight));
+    }
+    BOOST_CHECK((targets(graph, 1) == std::vector<NodeID>{0, 2, 3}));
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(2), 12);
+    graph.DeleteEdgesTo(2, 0);
+
+    const auto filtered = graph.Filter([](const NodeID node) { return node != 0; });
+    BOOST_CHECK_EQUAL(filtered.GetNumberOfNodes(), 4);
+    BOOST_CHECK_EQUAL(filtered.GetOutDegree(0), 0);
+    BOOST_CHECK((targets(filtered, 1) == std::vector<NodeID>{2, 3}));
+    BOOST_CHECK((targets(filtered, 3) == std::vector<NodeID>{2}));
+    BOOST_CHECK_EQUAL(filtered.GetNumberOfEdges(), 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
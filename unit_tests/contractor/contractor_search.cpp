@@ -0,0 +1,36 @@
+#include "contractor/contractor_search.hpp"
+
+#include "helper.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace osrm;
+using namespace osrm::contractor;
+using namespace osrm::unit_test;
+
+BOOST_AUTO_TEST_SUITE(contractor_search)
+
+BOOST_AUTO_TEST_CASE(hop_limit_bounds_the_witness_paths)
+{
+    // 0 -> 1 -> 2 -> 3 with weight 3 and 0 -> 3 with weight 10, 4 is the contracted node
+    auto graph = makeGraph({TestEdge{0, 1, 1},
+                            TestEdge{1, 2, 1},
+                            TestEdge{2, 3, 1},
+                            TestEdge{0, 3, 10},
+                            TestEdge{0, 4, 1},
+                            TestEdge{4, 3, 1}});
+
+    const auto witness_weight = [&graph](const short hop_limit) {
+        ContractorHeap heap(graph.GetNumberOfNodes());
+        heap.Insert(0, 0, ContractorHeapData{});
+        heap.Insert(3, INVALID_EDGE_WEIGHT, ContractorHeapData{0, true});
+        search(heap, graph, 1, WitnessSearchLimits{1000, hop_limit}, 20, 4);
+        return heap.GetKey(3);
+    };
+
+    BOOST_CHECK_EQUAL(witness_weight(1), 10);
+    BOOST_CHECK_EQUAL(witness_weight(2), 10);
+    BOOST_CHECK_EQUAL(witness_weight(3), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
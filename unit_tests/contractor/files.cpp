@@ -23,7 +23,7 @@ BOOST_AUTO_TEST_CASE(read_write_hsgr)
                                    TestEdge{3, 1, 1},
                                    TestEdge{4, 3, 1},
                                    TestEdge{5, 1, 1}};
-    auto reference_graph = QueryGraph{6, toEdges<QueryEdge>(makeGraph(edges))};
+    auto reference_graph = CompactQueryGraph{QueryGraph{6, toEdges<QueryEdge>(makeGraph(edges))}};
     std::vector<std::vector<bool>> reference_filters = {
         {false, false, true, true, false, false, true},
         {true, false, true, false, true, false, true},
@@ -43,6 +43,16 @@ BOOST_AUTO_TEST_CASE(read_write_hsgr)
     contractor::files::readGraph(tmp.path, metrics, connectivity_checksum);
 
     BOOST_CHECK_EQUAL(connectivity_checksum, reference_connectivity_checksum);
+    const auto &graph = metrics["duration"].graph;
+    const auto &reference = reference_metrics["duration"].graph;
+    BOOST_REQUIRE_EQUAL(graph.GetNumberOfNodes(), reference.GetNumberOfNodes());
+    BOOST_REQUIRE_EQUAL(graph.GetNumberOfEdges(), reference.GetNumberOfEdges());
+    for (const auto edge : util::irange(0u, graph.GetNumberOfEdges()))
+    {
+        BOOST_CHECK_EQUAL(graph.GetTarget(edge), reference.GetTarget(edge));
+        BOOST_CHECK(QueryEdge(0, graph.GetTarget(edge), graph.GetEdgeData(edge)) ==
+                    QueryEdge(0, reference.GetTarget(edge), reference.GetEdgeData(edge)));
+    }
     BOOST_CHECK_EQUAL(metrics["duration"].edge_filter.size(),
                       reference_metrics["duration"].edge_filter.size());
     CHECK_EQUAL_COLLECTIONS(metrics["duration"].edge_filter[0],
@@ -0,0 +1,102 @@
+#include "contractor/recustomize_graph.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(recustomize_graph)
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+namespace
+{
+// node 0 is below 1 and 2, the edges 1->0 and 0->2 were no shortcut for 1->2
+CompactQueryGraph makeHierarchy()
+{
+    std::vector<QueryEdge> edges = {{0, 1, {10, false, 5, 5, false, true}},
+                                    {0, 2, {11, false, 5, 5, true, false}},
+                                    {1, 2, {12, false, 7, 7, true, false}}};
+    return CompactQueryGraph{QueryGraph{3, edges}};
+}
+
+std::vector<extractor::EdgeBasedEdge> makeEdgeBasedEdges(const EdgeWeight weight_1_2)
+{
+    return {{1, 0, 10, 1, 2, true, false},
+            {0, 2, 11, 1, 2, true, false},
+            {1, 2, 12, weight_1_2, weight_1_2, true, false}};
+}
+
+QueryEdge getEdge(const QueryGraph &graph, const EdgeID edge)
+{
+    for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+    {
+        if (graph.BeginEdges(node) <= edge && edge < graph.EndEdges(node))
+        {
+            return QueryEdge{node, graph.GetTarget(edge), graph.GetEdgeData(edge)};
+        }
+    }
+    return QueryEdge{};
+}
+}
+
+BOOST_AUTO_TEST_CASE(edges_get_the_new_weights)
+{
+    const auto result =
+        recustomizeGraph(makeHierarchy(), {{true, true, true}}, makeEdgeBasedEdges(2));
+    BOOST_REQUIRE(result);
+    const auto &graph = std::get<0>(*result);
+    const auto &filters = std::get<1>(*result);
+
+    BOOST_REQUIRE_EQUAL(graph.GetNumberOfEdges(), 3);
+    BOOST_REQUIRE_EQUAL(filters.size(), 1);
+    BOOST_CHECK(getEdge(graph, 0) == QueryEdge(0, 1, {10, false, 1, 2, false, true}));
+    BOOST_CHECK(getEdge(graph, 1) == QueryEdge(0, 2, {11, false, 1, 2, true, false}));
+    // the original edge is not slower than the path over node 0
+    BOOST_CHECK(getEdge(graph, 2) == QueryEdge(1, 2, {12, false, 2, 2, true, false}));
+}
+
+BOOST_AUTO_TEST_CASE(slower_original_edges_become_shortcuts)
+{
+    const auto result =
+        recustomizeGraph(makeHierarchy(), {{true, true, true}}, makeEdgeBasedEdges(5));
+    BOOST_REQUIRE(result);
+    const auto &graph = std::get<0>(*result);
+
+    BOOST_REQUIRE_EQUAL(graph.GetNumberOfEdges(), 3);
+    BOOST_CHECK(getEdge(graph, 2) == QueryEdge(1, 2, {0, true, 2, 4, true, false}));
+}
+
+BOOST_AUTO_TEST_CASE(filters_are_customized_on_their_own)
+{
+    const auto result = recustomizeGraph(
+        makeHierarchy(), {{true, true, true}, {true, false, true}}, makeEdgeBasedEdges(5));
+    BOOST_REQUIRE(result);
+    const auto &graph = std::get<0>(*result);
+    const auto &filters = std::get<1>(*result);
+
+    BOOST_REQUIRE_EQUAL(graph.GetNumberOfEdges(), 4);
+    BOOST_REQUIRE_EQUAL(filters.size(), 2);
+    const auto shortcut = graph.FindSmallestEdge(1, 2, [](const auto &data) { return true; });
+    const auto original =
+        graph.FindSmallestEdge(1, 2, [](const auto &data) { return !data.shortcut; });
+    BOOST_REQUIRE(shortcut != original);
+    BOOST_CHECK(getEdge(graph, shortcut) == QueryEdge(1, 2, {0, true, 2, 4, true, false}));
+    BOOST_CHECK(filters[0][shortcut] && !filters[1][shortcut]);
+    BOOST_CHECK(getEdge(graph, original) == QueryEdge(1, 2, {12, false, 5, 5, true, false}));
+    BOOST_CHECK(!filters[0][original] && filters[1][original]);
+
+    const auto shared = graph.FindEdge(0, 1);
+    BOOST_CHECK(filters[0][shared] && filters[1][shared]);
+}
+
+BOOST_AUTO_TEST_CASE(cycles_are_no_hierarchy)
+{
+    std::vector<QueryEdge> edges = {{0, 1, {10, false, 5, 5, true, false}},
+                                    {1, 0, {11, false, 5, 5, true, false}}};
+    std::vector<extractor::EdgeBasedEdge> edge_based_edges = {{0, 1, 10, 1, 1, true, false},
+                                                              {1, 0, 11, 1, 1, true, false}};
+    const auto result =
+        recustomizeGraph(CompactQueryGraph{QueryGraph{2, edges}}, {{true, true}}, edge_based_edges);
+    BOOST_CHECK(!result);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+#include "contractor/renumber.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+BOOST_AUTO_TEST_SUITE(contractor_renumber)
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+namespace
+{
+QueryGraph makeContractedGraph()
+{
+    // contracted in the order 1, 3, 0, 2, 4, every node keeps its edges to the later nodes
+    std::vector<QueryEdge> edges = {
+        {0, 2, {1, true, 2, 2, true, true}},
+        {1, 0, {10, false, 1, 1, true, true}},
+        {1, 2, {11, false, 1, 1, true, true}},
+        {1, 4, {12, false, 5, 5, true, false}},
+        {2, 4, {3, true, 2, 2, true, true}},
+        {3, 2, {13, false, 1, 1, true, true}},
+        {3, 4, {14, false, 1, 1, true, true}},
+    };
+    return QueryGraph{5, edges};
+}
+}
+
+BOOST_AUTO_TEST_CASE(upper_nodes_come_first)
+{
+    const auto graph = makeContractedGraph();
+    const auto permutation = makePermutation(graph);
+
+    BOOST_REQUIRE_EQUAL(permutation.size(), graph.GetNumberOfNodes());
+    auto sorted_permutation = permutation;
+    std::sort(sorted_permutation.begin(), sorted_permutation.end());
+    std::vector<std::uint32_t> identity(permutation.size());
+    std::iota(identity.begin(), identity.end(), 0);
+    BOOST_CHECK(sorted_permutation == identity);
+    BOOST_CHECK_EQUAL(permutation[4], 0);
+
+    // the hierarchy has no cycles, all edges point to smaller IDs
+    for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+    {
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            BOOST_CHECK_LT(permutation[graph.GetTarget(edge)], permutation[node]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(edges_and_filters_are_renumbered)
+{
+    const auto graph = makeContractedGraph();
+    const auto permutation = makePermutation(graph);
+
+    std::vector<std::vector<bool>> filters(1);
+    for (const auto edge : util::irange(0u, graph.GetNumberOfEdges()))
+    {
+        filters.front().push_back(edge % 2 == 0);
+    }
+
+    auto renumbered_graph = graph;
+    auto renumbered_filters = filters;
+    renumber(renumbered_graph, renumbered_filters, permutation);
+
+    BOOST_REQUIRE_EQUAL(renumbered_graph.GetNumberOfEdges(), graph.GetNumberOfEdges());
+    BOOST_REQUIRE_EQUAL(renumbered_filters.front().size(), filters.front().size());
+    bool has_shortcut = false;
+    for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+    {
+        BOOST_CHECK_EQUAL(renumbered_graph.GetOutDegree(permutation[node]),
+                          graph.GetOutDegree(node));
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = graph.GetEdgeData(edge);
+            auto expected_data = data;
+            if (data.shortcut)
+            {
+                has_shortcut = true;
+                expected_data.turn_id = permutation[data.turn_id];
+            }
+
+            const auto renumbered_edge = renumbered_graph.FindSmallestEdge(
+                permutation[node], permutation[graph.GetTarget(edge)], [&](const auto &other) {
+                    return QueryEdge(0, 0, other) == QueryEdge(0, 0, expected_data);
+                });
+            BOOST_REQUIRE(renumbered_edge != SPECIAL_EDGEID);
+            BOOST_CHECK_EQUAL(renumbered_filters.front()[renumbered_edge], filters.front()[edge]);
+        }
+    }
+    BOOST_CHECK(has_shortcut);
+}
+
+BOOST_AUTO_TEST_CASE(edge_based_edges_are_renumbered)
+{
+    std::vector<extractor::EdgeBasedEdge> edges = {
+        {0, 2, 5, 1, 1, true, false}, {2, 1, 6, 1, 1, true, false}};
+    renumber(edges, {1, 2, 0});
+
+    BOOST_CHECK_EQUAL(edges[0].source, 1);
+    BOOST_CHECK_EQUAL(edges[0].target, 0);
+    BOOST_CHECK_EQUAL(edges[0].data.turn_id, 5);
+    BOOST_CHECK_EQUAL(edges[1].source, 0);
+    BOOST_CHECK_EQUAL(edges[1].target, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <random>
+
 using namespace osrm;
 using namespace osrm::customizer;
 using namespace osrm::partitioner;
@@ -409,4 +411,153 @@ BOOST_AUTO_TEST_CASE(exclude_test)
     CHECK_EQUAL_RANGE(cell_2_1.GetInWeight(5), 1, 0);
 }
 
+BOOST_AUTO_TEST_CASE(changed_cells_test)
+{
+    // 0 --- 1 --- 5 --- 6
+    // |  /  |     |     |
+    // 2 ----3 --- 4 --- 7
+    std::vector<MockEdge> edges = {{0, 1, 1},
+                                   {0, 2, 1},
+                                   {1, 2, 10},
+                                   {1, 3, 1},
+                                   {1, 5, 1},
+                                   {2, 3, 1},
+                                   {3, 4, 1},
+                                   {4, 5, 1},
+                                   {4, 7, 1},
+                                   {5, 6, 1},
+                                   {6, 7, 1}};
+
+    // node:                0  1  2  3  4  5  6  7
+    std::vector<CellID> l1{{0, 0, 1, 1, 3, 2, 2, 3}};
+    std::vector<CellID> l2{{0, 0, 0, 0, 1, 1, 1, 1}};
+    std::vector<CellID> l3{{0, 0, 0, 0, 0, 0, 0, 0}};
+    MultiLevelPartition mlp{{l1, l2, l3}, {4, 2, 1}};
+
+    auto graph = makeGraph(mlp, edges);
+    std::vector<bool> node_filter(graph.GetNumberOfNodes(), true);
+
+    CellCustomizer customizer(mlp);
+    CellStorage storage(mlp, graph);
+    auto metric = storage.MakeMetric();
+    customizer.Customize(graph, storage, node_filter, metric);
+
+    const auto unchanged_cells = customizer.GetChangedCells(graph, graph);
+    for (const auto level : {1, 2, 3})
+    {
+        BOOST_CHECK(std::none_of(unchanged_cells[level].begin(),
+                                 unchanged_cells[level].end(),
+                                 [](const bool changed) { return changed; }));
+    }
+
+    // 2 -> 3 is inside of cell 1 on level 1, 1 -> 5 is only inside of the cell on level 3
+    edges[5].weight = 5;
+    edges[4].weight = 3;
+    auto updated_graph = makeGraph(mlp, edges);
+    const auto changed_cells = customizer.GetChangedCells(graph, updated_graph);
+    BOOST_REQUIRE_EQUAL(changed_cells.size(), 4);
+    const std::vector<bool> changed_cells_1 = {false, true, false, false};
+    const std::vector<bool> changed_cells_2 = {true, false};
+    const std::vector<bool> changed_cells_3 = {true};
+    CHECK_EQUAL_COLLECTIONS(changed_cells[1], changed_cells_1);
+    CHECK_EQUAL_COLLECTIONS(changed_cells[2], changed_cells_2);
+    CHECK_EQUAL_COLLECTIONS(changed_cells[3], changed_cells_3);
+
+    customizer.Customize(updated_graph, storage, node_filter, metric, changed_cells);
+
+    auto updated_metric = storage.MakeMetric();
+    customizer.Customize(updated_graph, storage, node_filter, updated_metric);
+    CHECK_EQUAL_COLLECTIONS(metric.weights, updated_metric.weights);
+    CHECK_EQUAL_COLLECTIONS(metric.durations, updated_metric.durations);
+}
+
+BOOST_AUTO_TEST_CASE(subcell_matrix_test)
+{
+    // 64 nodes in cells of 4, 16 and 64 nodes
+    const NodeID number_of_nodes = 64;
+    std::vector<CellID> l1, l2, l3;
+    for (const auto node : util::irange(0u, number_of_nodes))
+    {
+        l1.push_back(node / 4);
+        l2.push_back(node / 16);
+        l3.push_back(0);
+    }
+    MultiLevelPartition mlp{{l1, l2, l3}, {16, 4, 1}};
+
+    // one-way edges, mostly inside of the cells of the first level
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<NodeID> node_distribution(0, number_of_nodes - 1);
+    std::uniform_int_distribution<EdgeWeight> weight_distribution(1, 10);
+    std::vector<MockEdge> edges;
+    for (std::size_t index = 0; index < 200; ++index)
+    {
+        const auto start = node_distribution(generator);
+        auto target = node_distribution(generator);
+        if (index % 3 != 0)
+            target = start / 4 * 4 + target % 4;
+        if (start != target)
+            edges.push_back({start, target, weight_distribution(generator)});
+    }
+    edges.push_back({0, number_of_nodes - 1, 1});
+
+    auto graph = makeGraph(mlp, edges);
+    CellCustomizer customizer(mlp);
+    CellStorage storage(mlp, graph);
+    CellCustomizer::Heap heap(graph.GetNumberOfNodes());
+    CellCustomizer::SubcellMatrix matrix;
+
+    std::vector<bool> node_filter(graph.GetNumberOfNodes(), true);
+    for (const auto excluded_nodes : {0, 8})
+    {
+        for (const auto node : util::irange(0, excluded_nodes))
+            node_filter[node * 7] = false;
+
+        auto searched_metric = storage.MakeMetric();
+        auto matrix_metric = storage.MakeMetric();
+        for (const auto level : util::irange<LevelID>(1, mlp.GetNumberOfLevels()))
+        {
+            for (const auto id : util::irange(0u, mlp.GetNumberOfCells(level)))
+            {
+                customizer.Customize(graph, heap, storage, node_filter, searched_metric, level, id);
+                if (level == 1)
+                {
+                    customizer.Customize(
+                        graph, heap, storage, node_filter, matrix_metric, level, id);
+                }
+                else
+                {
+                    BOOST_CHECK(customizer.CustomizeFromSubcells(
+                        graph, matrix, storage, node_filter, matrix_metric, level, id));
+                }
+            }
+        }
+        CHECK_EQUAL_COLLECTIONS(searched_metric.weights, matrix_metric.weights);
+        CHECK_EQUAL_COLLECTIONS(searched_metric.durations, matrix_metric.durations);
+
+        auto metric = storage.MakeMetric();
+        customizer.Customize(graph, storage, node_filter, metric);
+        CHECK_EQUAL_COLLECTIONS(searched_metric.weights, metric.weights);
+        CHECK_EQUAL_COLLECTIONS(searched_metric.durations, metric.durations);
+    }
+
+    // all filters at once give the same metrics as one filter at a time
+    std::vector<std::vector<bool>> node_filters(3, std::vector<bool>(number_of_nodes, true));
+    for (const auto node : util::irange(0u, number_of_nodes))
+    {
+        node_filters[1][node] = node % 5 != 0;
+        node_filters[2][node] = node % 16 != 3;
+    }
+    std::vector<CellMetric> metrics;
+    for (std::size_t index = 0; index < node_filters.size(); ++index)
+        metrics.push_back(storage.MakeMetric());
+    customizer.Customize(graph, storage, node_filters, metrics);
+    for (const auto index : util::irange<std::size_t>(0, node_filters.size()))
+    {
+        auto metric = storage.MakeMetric();
+        customizer.Customize(graph, storage, node_filters[index], metric);
+        CHECK_EQUAL_COLLECTIONS(metrics[index].weights, metric.weights);
+        CHECK_EQUAL_COLLECTIONS(metrics[index].durations, metric.durations);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
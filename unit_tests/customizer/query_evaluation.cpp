@@ -0,0 +1,113 @@
+#include "customizer/cell_customizer.hpp"
+#include "customizer/query_evaluation.hpp"
+#include "partitioner/multi_level_graph.hpp"
+#include "partitioner/multi_level_partition.hpp"
+#include "util/static_graph.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+using namespace osrm;
+using namespace osrm::customizer;
+using namespace osrm::partitioner;
+using namespace osrm::util;
+
+namespace
+{
+struct EdgeData
+{
+    EdgeWeight weight;
+    EdgeDuration duration;
+    bool forward;
+    bool backward;
+};
+using Edge = static_graph_details::SortableEdgeWithData<EdgeData>;
+using Graph = partitioner::MultiLevelGraph<EdgeData, osrm::storage::Ownership::Container>;
+
+// Plain Dijkstra on the level zero edges
+EdgeWeight dijkstra(const Graph &graph, const NodeID source, const NodeID target)
+{
+    CellCustomizer::Heap heap(graph.GetNumberOfNodes());
+    heap.Insert(source, 0, {false, 0});
+    while (!heap.Empty())
+    {
+        const auto node = heap.DeleteMin();
+        const auto weight = heap.GetKey(node);
+        if (node == target)
+            return weight;
+
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = graph.GetEdgeData(edge);
+            const auto to = graph.GetTarget(edge);
+            if (!data.forward)
+                continue;
+            if (!heap.WasInserted(to))
+                heap.Insert(to, weight + data.weight, {false, 0});
+            else if (weight + data.weight < heap.GetKey(to))
+                heap.DecreaseKey(to, weight + data.weight);
+        }
+    }
+    return INVALID_EDGE_WEIGHT;
+}
+}
+
+BOOST_AUTO_TEST_SUITE(query_evaluation_tests)
+
+BOOST_AUTO_TEST_CASE(random_graph_test)
+{
+    // 64 nodes in cells of 4, 16 and 64 nodes
+    const NodeID number_of_nodes = 64;
+    std::vector<CellID> l1, l2, l3;
+    for (const auto node : util::irange(0u, number_of_nodes))
+    {
+        l1.push_back(node / 4);
+        l2.push_back(node / 16);
+        l3.push_back(0);
+    }
+    MultiLevelPartition mlp{{l1, l2, l3}, {16, 4, 1}};
+
+    // directed edges, mostly inside of the cells
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<NodeID> node_distribution(0, number_of_nodes - 1);
+    std::uniform_int_distribution<EdgeWeight> weight_distribution(1, 10);
+    std::vector<Edge> edges;
+    for (std::size_t index = 0; index < 200; ++index)
+    {
+        const auto start = node_distribution(generator);
+        auto target = node_distribution(generator);
+        if (index % 3 != 0)
+            target = start / 4 * 4 + target % 4;
+        if (start == target)
+            continue;
+        const auto weight = weight_distribution(generator);
+        edges.push_back(Edge{start, target, weight, weight, true, false});
+        edges.push_back(Edge{target, start, weight, weight, false, true});
+    }
+    std::sort(edges.begin(), edges.end());
+    Graph graph(mlp, number_of_nodes, edges);
+
+    std::vector<bool> node_filter(number_of_nodes, true);
+    CellStorage storage(mlp, graph);
+    auto metric = storage.MakeMetric();
+    CellCustomizer customizer(mlp);
+    customizer.Customize(graph, storage, node_filter, metric);
+
+    QueryEvaluator<Graph> evaluator{graph, mlp, storage, metric, node_filter};
+    for (const auto source : util::irange(0u, number_of_nodes))
+    {
+        for (const auto target : util::irange(0u, number_of_nodes))
+        {
+            BOOST_CHECK_EQUAL(evaluator.Query(source, target).weight,
+                              dijkstra(graph, source, target));
+        }
+    }
+
+    const auto summary = evaluator.Evaluate(100, 0);
+    BOOST_CHECK_EQUAL(summary.number_of_queries, 100);
+    BOOST_CHECK_GT(summary.number_of_routes, 0);
+    BOOST_CHECK_GE(summary.p99_milliseconds, summary.median_milliseconds);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
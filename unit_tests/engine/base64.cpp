@@ -36,6 +36,74 @@ BOOST_AUTO_TEST_CASE(rfc4648_test_vectors_roundtrip)
     BOOST_CHECK_EQUAL(decodeBase64(encodeBase64("foobar")), "foobar");
 }
 
+// Long enough for the vectorized blocks, with all characters of both alphabets
+BOOST_AUTO_TEST_CASE(long_test_vectors)
+{
+    using namespace osrm::engine;
+
+    std::string bytes;
+    for (int repetition = 0; repetition < 2; ++repetition)
+        for (int byte = 0; byte < 256; byte += 3)
+            bytes.push_back(static_cast<char>(byte));
+
+    const std::string standard = "AAMGCQwPEhUYGx4hJCcqLTAzNjk8P0JFSEtOUVRXWl1gY2ZpbG9ydXh7foGEh4qN"
+                                 "kJOWmZyfoqWoq66xtLe6vcDDxsnMz9LV2Nve4eTn6u3w8/b5/P8AAwYJDA8SFRgb"
+                                 "HiEkJyotMDM2OTw/QkVIS05RVFdaXWBjZmlsb3J1eHt+gYSHio2Qk5aZnJ+ipair"
+                                 "rrG0t7q9wMPGyczP0tXY297h5Ofq7fDz9vn8/w==";
+    std::string url = standard;
+    std::replace(begin(url), end(url), '+', '-');
+    std::replace(begin(url), end(url), '/', '_');
+
+    BOOST_CHECK_EQUAL(encodeBase64(bytes), standard);
+    BOOST_CHECK_EQUAL(encodeBase64(reinterpret_cast<const unsigned char *>(bytes.data()),
+                                   bytes.size(),
+                                   Base64Alphabet::URL),
+                      url);
+    BOOST_CHECK_EQUAL(decodeBase64(standard), bytes);
+
+    std::vector<unsigned char> decoded(url.size() / 4 * 3);
+    BOOST_CHECK_EQUAL(decodeBase64(url.data(), url.size(), decoded.data(), Base64Alphabet::URL),
+                      bytes.size());
+    BOOST_CHECK(std::equal(bytes.begin(), bytes.end(), decoded.begin(), [](char lhs, auto rhs) {
+        return static_cast<unsigned char>(lhs) == rhs;
+    }));
+}
+
+BOOST_AUTO_TEST_CASE(roundtrip_all_sizes)
+{
+    using namespace osrm::engine;
+
+    std::string bytes;
+    for (int size = 1; size < 100; ++size)
+    {
+        bytes.push_back(static_cast<char>(size * 37 % 256));
+        BOOST_CHECK_EQUAL(decodeBase64(encodeBase64(bytes)), bytes);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(invalid_encodings)
+{
+    using namespace osrm::engine;
+
+    const auto decode = [](const std::string &encoded, const Base64Alphabet alphabet) {
+        std::vector<unsigned char> decoded(encoded.size() / 4 * 3);
+        return decodeBase64(encoded.data(), encoded.size(), decoded.data(), alphabet);
+    };
+
+    const std::string valid = "Zm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFy";
+    BOOST_CHECK_EQUAL(decode(valid, Base64Alphabet::Standard), 24);
+    BOOST_CHECK_EQUAL(decode(valid.substr(1), Base64Alphabet::Standard), -1);
+    BOOST_CHECK_EQUAL(decode("Zm9vYmE=", Base64Alphabet::Standard), 5);
+    BOOST_CHECK_EQUAL(decode("Zm9vYg==", Base64Alphabet::Standard), 4);
+    BOOST_CHECK_EQUAL(decode("Zm9=YmFy", Base64Alphabet::Standard), -1);
+    BOOST_CHECK_EQUAL(decode("Zm9vY===", Base64Alphabet::Standard), -1);
+    BOOST_CHECK_EQUAL(decode("Zm9vYmFyZm9vYm-yZm9vYmFyZm9vYmFy", Base64Alphabet::Standard), -1);
+    BOOST_CHECK_EQUAL(decode("Zm9vYmFyZm9vYm-yZm9vYmFyZm9vYmFy", Base64Alphabet::URL), 24);
+    BOOST_CHECK_EQUAL(decode("Zm9vYmFyZm9vYm+yZm9vYmFyZm9vYmFy", Base64Alphabet::URL), -1);
+    BOOST_CHECK_EQUAL(decode("Zm9vYmFyZm9vYm\xc3yZm9vYmFyZm9vYmFy", Base64Alphabet::URL), -1);
+    BOOST_CHECK_THROW(decodeBase64("Zm9vYmF"), osrm::util::exception);
+}
+
 BOOST_AUTO_TEST_CASE(hint_encoding_decoding_roundtrip)
 {
     using namespace osrm::engine;
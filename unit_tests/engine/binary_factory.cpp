@@ -0,0 +1,55 @@
+#include "engine/api/binary_factory.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(binary_factory)
+
+using namespace osrm;
+using namespace osrm::engine::api;
+
+BOOST_AUTO_TEST_CASE(write_little_endian_values)
+{
+    std::string buffer;
+    binary::Writer writer(buffer);
+
+    writer.WriteUInt8(0x7f);
+    writer.WriteUInt32(0x04030201);
+    writer.WriteInt32(-1);
+    writer.WriteString("ab");
+
+    const std::string expected{'\x7f', '\x01', '\x02', '\x03', '\x04', '\xff', '\xff',
+                               '\xff', '\xff', '\x02', '\x00', '\x00', '\x00', 'a',
+                               'b'};
+    BOOST_CHECK_EQUAL(buffer, expected);
+}
+
+BOOST_AUTO_TEST_CASE(write_double_and_coordinate)
+{
+    std::string buffer;
+    binary::Writer writer(buffer);
+
+    // 1.0 is 0x3ff0000000000000
+    writer.WriteDouble(1.0);
+    writer.WriteCoordinate(util::Coordinate{util::FloatLongitude{7.5}, util::FloatLatitude{-1}});
+
+    const std::string expected{'\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\xf0', '\x3f',
+                               '\xe0', '\x70', '\x72', '\x00', '\xc0', '\xbd', '\xf0', '\xff'};
+    BOOST_CHECK_EQUAL(buffer, expected);
+}
+
+BOOST_AUTO_TEST_CASE(write_header)
+{
+    std::string buffer;
+    binary::Writer writer(buffer);
+
+    binary::writeHeader(writer, binary::ResponseType::Table);
+
+    BOOST_CHECK_EQUAL(buffer.size(), 6);
+    BOOST_CHECK_EQUAL(buffer.substr(0, 4), "OSRM");
+    BOOST_CHECK_EQUAL(static_cast<int>(buffer[4]), binary::FORMAT_VERSION);
+    BOOST_CHECK_EQUAL(static_cast<int>(buffer[5]), static_cast<int>(binary::ResponseType::Table));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
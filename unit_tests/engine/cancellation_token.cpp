@@ -0,0 +1,74 @@
+#include "engine/cancellation_token.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+
+BOOST_AUTO_TEST_SUITE(cancellation_token)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+BOOST_AUTO_TEST_CASE(tokens_expire_at_their_deadline)
+{
+    CancellationToken token;
+    BOOST_CHECK(!token.IsCancelled());
+    token.Cancel();
+    BOOST_CHECK(token.IsCancelled());
+
+    const auto now = CancellationToken::Clock::now();
+    BOOST_CHECK(CancellationToken(now).IsCancelled());
+    BOOST_CHECK(!CancellationToken(now + std::chrono::hours(1)).IsCancelled());
+}
+
+BOOST_AUTO_TEST_CASE(scopes_select_the_checked_token)
+{
+    CancellationToken cancelled;
+    cancelled.Cancel();
+    const CancellationToken running;
+
+    // no token, no checks
+    BOOST_CHECK_NO_THROW(throwIfCancelled());
+    {
+        const CancellationScope outer(&cancelled);
+        BOOST_CHECK(currentCancellationToken() == &cancelled);
+        BOOST_CHECK_THROW(throwIfCancelled(), RequestCancelled);
+        {
+            const CancellationScope inner(&running);
+            BOOST_CHECK_NO_THROW(throwIfCancelled());
+        }
+        BOOST_CHECK_THROW(throwIfCancelled(), RequestCancelled);
+
+        // the hot loops only look at the token every few calls
+        BOOST_CHECK_THROW(
+            for (int call = 0; call < 4096; ++call) { checkCancellation(); }, RequestCancelled);
+    }
+    BOOST_CHECK(currentCancellationToken() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_searches_rethrow_on_the_calling_thread)
+{
+    CancellationToken token;
+    const CancellationScope scope(&token);
+
+    std::atomic<std::size_t> finished{0};
+    BOOST_CHECK_NO_THROW(routing_algorithms::parallelForEach(
+        64, [&](const tbb::blocked_range<std::uint32_t> &range) {
+            BOOST_REQUIRE(currentCancellationToken() == &token);
+            finished += range.size();
+        }));
+    BOOST_CHECK_EQUAL(finished, 64);
+
+    token.Cancel();
+    BOOST_CHECK_THROW(routing_algorithms::parallelForEach(
+                          64,
+                          [&](const tbb::blocked_range<std::uint32_t> &) {
+                              // the arena threads throw from their searches
+                              throwIfCancelled();
+                          }),
+                      RequestCancelled);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,8 @@
 #include "engine/guidance/assemble_steps.hpp"
 #include "engine/guidance/post_processing.hpp"
 
+#include "../mocks/mock_datafacade.hpp"
+
 #include <boost/test/test_case_template.hpp>
 #include <boost/test/unit_test.hpp>
 
@@ -106,4 +108,70 @@ BOOST_AUTO_TEST_CASE(trim_short_segments)
     BOOST_CHECK_EQUAL(geometry.osm_node_ids.size(), 2);
 }
 
+BOOST_AUTO_TEST_CASE(segment_distances_match_geometry)
+{
+    using namespace osrm::guidance;
+    using namespace osrm::engine::guidance;
+    using namespace osrm::engine;
+    using namespace osrm::util;
+
+    // places node n at n/1000 degrees east and compresses all edges to one geometry of 3 nodes
+    struct GeometryDataFacade : osrm::test::MockBaseDataFacade
+    {
+        Coordinate GetCoordinateOfNode(const NodeID id) const override
+        {
+            return {FloatLongitude{id / 1000.}, FloatLatitude{id / 2000.}};
+        }
+        OSMNodeID GetOSMNodeIDOfNode(const NodeID id) const override { return OSMNodeID{id}; }
+        bool HasOSMNodeIDs() const override { return true; }
+        GeometryID GetGeometryIndex(const NodeID /* id */) const override
+        {
+            return GeometryID{0, true};
+        }
+        std::vector<NodeID> GetUncompressedForwardGeometry(const EdgeID /* id */) const override
+        {
+            return {0, 1, 2};
+        }
+        std::vector<DatasourceID>
+        GetUncompressedForwardDatasources(const EdgeID /* id */) const override
+        {
+            return {0, 0};
+        }
+    } facade;
+
+    PhantomNode source;
+    source.location = {FloatLongitude{0.0}, FloatLatitude{0.0}};
+    source.forward_segment_id = {0, true};
+    source.fwd_segment_position = 0;
+    PhantomNode target;
+    target.location = {FloatLongitude{0.02}, FloatLatitude{0.003}};
+    target.forward_segment_id = {1, true};
+    target.fwd_segment_position = 1;
+    target.forward_duration = 10;
+    target.forward_weight = 10;
+
+    std::vector<PathData> path;
+    for (const NodeID via : {1, 5, 6, 12, 17})
+    {
+        PathData point{};
+        point.turn_via_node = via;
+        point.turn_via_coordinate = facade.GetCoordinateOfNode(via);
+        point.turn_instruction = (via == 5 || via == 12)
+                                     ? TurnInstruction{TurnType::Turn, DirectionModifier::Right}
+                                     : TurnInstruction::NO_TURN();
+        path.push_back(point);
+    }
+
+    const auto geometry = assembleGeometry(facade, path, source, target, false, false);
+    const auto distances = assembleSegmentDistances(facade, path, source, target);
+
+    BOOST_CHECK_EQUAL(distances.segment_distances.size(), 3);
+    BOOST_CHECK_EQUAL_COLLECTIONS(distances.segment_distances.begin(),
+                                  distances.segment_distances.end(),
+                                  geometry.segment_distances.begin(),
+                                  geometry.segment_distances.end());
+    BOOST_CHECK(distances.locations.empty());
+    BOOST_CHECK(distances.annotations.empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
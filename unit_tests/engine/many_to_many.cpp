@@ -0,0 +1,220 @@
+#include "engine/routing_algorithms/many_to_many.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(many_to_many_test)
+
+using namespace osrm;
+using namespace osrm::engine;
+using namespace osrm::engine::routing_algorithms;
+
+namespace
+{
+// Fake backward search that settles a column dependent set of nodes
+void fakeBackwardSearch(const std::uint32_t column_idx, std::vector<NodeBucket> &buckets)
+{
+    for (NodeID node = 0; node < 100; node += column_idx % 7 + 1)
+    {
+        buckets.emplace_back(node, node, column_idx, node + column_idx, node);
+    }
+}
+
+bool equalBuckets(const std::vector<NodeBucket> &lhs, const std::vector<NodeBucket> &rhs)
+{
+    return std::equal(lhs.begin(),
+                      lhs.end(),
+                      rhs.begin(),
+                      rhs.end(),
+                      [](const NodeBucket &lhs, const NodeBucket &rhs) {
+                          return lhs.middle_node == rhs.middle_node &&
+                                 lhs.column_index == rhs.column_index &&
+                                 lhs.weight == rhs.weight && lhs.duration == rhs.duration;
+                      });
+}
+}
+
+BOOST_AUTO_TEST_CASE(parallel_buckets_match_serial_buckets)
+{
+    const auto serial_buckets = computeSearchSpaceWithBuckets(250, false, fakeBackwardSearch);
+
+    std::vector<NodeBucket> parallel_buckets;
+    tbb::task_arena arena(4);
+    arena.execute([&] {
+        parallel_buckets = computeSearchSpaceWithBuckets(250, true, fakeBackwardSearch);
+    });
+
+    BOOST_CHECK(std::is_sorted(serial_buckets.begin(), serial_buckets.end()));
+    BOOST_CHECK(equalBuckets(serial_buckets, parallel_buckets));
+}
+
+BOOST_AUTO_TEST_CASE(parallel_rows_visit_every_row_once)
+{
+    std::vector<std::atomic<int>> visits(250);
+    for (auto &visit : visits)
+        visit = 0;
+
+    tbb::task_arena arena(4);
+    arena.execute([&] {
+        forEachSourceRow(visits.size(), true, [&](const std::uint32_t row_idx) {
+            ++visits[row_idx];
+        });
+    });
+
+    for (const auto &visit : visits)
+        BOOST_CHECK_EQUAL(visit, 1);
+}
+
+BOOST_AUTO_TEST_CASE(bucket_index_matches_equal_range)
+{
+    const auto buckets = computeSearchSpaceWithBuckets(250, false, fakeBackwardSearch);
+    const NodeBucketIndex bucket_index(buckets);
+
+    BOOST_CHECK_EQUAL(bucket_index.Size(), buckets.size());
+
+    for (NodeID node = 0; node < 120; ++node)
+    {
+        const auto bucket_list =
+            std::equal_range(buckets.begin(), buckets.end(), node, NodeBucket::Compare());
+        const auto range = bucket_index.Find(node);
+
+        BOOST_REQUIRE_EQUAL(range.size(),
+                            static_cast<std::uint32_t>(
+                                std::distance(bucket_list.first, bucket_list.second)));
+        auto position = range.begin;
+        for (auto bucket = bucket_list.first; bucket != bucket_list.second; ++bucket, ++position)
+        {
+            BOOST_CHECK_EQUAL(bucket_index.GetColumn(position), bucket->column_index);
+            BOOST_CHECK_EQUAL(bucket_index.GetWeight(position), bucket->weight);
+            BOOST_CHECK_EQUAL(bucket_index.GetDuration(position), bucket->duration);
+        }
+    }
+
+    const NodeBucketIndex empty_index;
+    BOOST_CHECK(empty_index.Find(0).empty());
+    BOOST_CHECK(NodeBucketIndex(std::vector<NodeBucket>{}).Find(0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(min_plus_row_matches_scalar_update)
+{
+    const std::size_t number_of_rows = 3;
+    const std::size_t number_of_columns = 37;
+
+    std::mt19937 g(1337);
+    std::uniform_int_distribution<EdgeWeight> value_distribution(-5, 20);
+
+    std::vector<unsigned> columns(number_of_columns);
+    std::iota(columns.begin(), columns.end(), 0);
+    std::shuffle(columns.begin(), columns.end(), g);
+
+    for (const auto stride : {std::size_t{1}, number_of_rows})
+    {
+        std::vector<EdgeWeight> weights_table(number_of_rows * number_of_columns);
+        std::vector<EdgeDuration> durations_table(number_of_rows * number_of_columns);
+        for (auto &weight : weights_table)
+            weight = value_distribution(g) + 10;
+        for (auto &duration : durations_table)
+            duration = value_distribution(g) + 10;
+        auto expected_weights = weights_table;
+        auto expected_durations = durations_table;
+
+        std::vector<EdgeWeight> weights(number_of_columns);
+        std::vector<EdgeDuration> durations(number_of_columns);
+        for (auto &weight : weights)
+            weight = value_distribution(g);
+        for (auto &duration : durations)
+            duration = value_distribution(g);
+
+        const EdgeWeight source_weight = 2;
+        const EdgeDuration source_duration = 1;
+        const std::size_t offset = stride == 1 ? number_of_columns : 1;
+
+        bool expected_negative_weights = false;
+        for (std::size_t index = 0; index < number_of_columns; ++index)
+        {
+            const auto location = offset + columns[index] * stride;
+            const auto new_weight = source_weight + weights[index];
+            const auto new_duration = source_duration + durations[index];
+            expected_negative_weights |= new_weight < 0;
+            if (new_weight >= 0 && std::tie(new_weight, new_duration) <
+                                       std::tie(expected_weights[location],
+                                                expected_durations[location]))
+            {
+                expected_weights[location] = new_weight;
+                expected_durations[location] = new_duration;
+            }
+        }
+
+        const auto has_negative_weights = minPlusRow(source_weight,
+                                                     source_duration,
+                                                     columns.data(),
+                                                     weights.data(),
+                                                     durations.data(),
+                                                     number_of_columns,
+                                                     offset,
+                                                     stride,
+                                                     weights_table,
+                                                     durations_table);
+
+        BOOST_CHECK_EQUAL(has_negative_weights, expected_negative_weights);
+        BOOST_CHECK_EQUAL_COLLECTIONS(weights_table.begin(),
+                                      weights_table.end(),
+                                      expected_weights.begin(),
+                                      expected_weights.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(durations_table.begin(),
+                                      durations_table.end(),
+                                      expected_durations.begin(),
+                                      expected_durations.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cached_search_replays_settled_nodes)
+{
+    PhantomNode phantom;
+    phantom.forward_segment_id = {1, true};
+    phantom.forward_weight = 10;
+    phantom.forward_duration = 20;
+
+    PhantomNode other_phantom = phantom;
+    other_phantom.forward_weight_offset = 5;
+
+    SearchSpaceCache cache(2);
+    int number_of_searches = 0;
+    std::vector<NodeID> visited;
+    const auto search = [&](SearchSpace *search_space) {
+        ++number_of_searches;
+        for (NodeID node = 0; node < 3; ++node)
+        {
+            visited.push_back(node);
+            if (search_space)
+                search_space->push_back({node, node, EdgeWeight(node), EdgeDuration(node)});
+        }
+    };
+    const auto replay = [&](const SettledNode &settled) { visited.push_back(settled.node); };
+
+    cachedSearch(&cache, 1, SearchSpaceType::SourceRow, phantom, search, replay);
+    cachedSearch(&cache, 1, SearchSpaceType::SourceRow, phantom, search, replay);
+    BOOST_CHECK_EQUAL(number_of_searches, 1);
+    BOOST_CHECK_EQUAL(visited.size(), 6);
+    BOOST_CHECK(std::equal(visited.begin(), visited.begin() + 3, visited.begin() + 3));
+
+    // other search types, facades and phantom nodes are searched again
+    cachedSearch(&cache, 1, SearchSpaceType::TargetBuckets, phantom, search, replay);
+    cachedSearch(&cache, 2, SearchSpaceType::SourceRow, phantom, search, replay);
+    cachedSearch(&cache, 2, SearchSpaceType::SourceRow, other_phantom, search, replay);
+    BOOST_CHECK_EQUAL(number_of_searches, 4);
+
+    // without a cache every search is run
+    cachedSearch(nullptr, 1, SearchSpaceType::SourceRow, phantom, search, replay);
+    BOOST_CHECK_EQUAL(number_of_searches, 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
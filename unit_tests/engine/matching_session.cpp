@@ -0,0 +1,114 @@
+#include "engine/map_matching/matching_session.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(matching_session)
+
+using namespace osrm;
+using namespace osrm::engine;
+using namespace osrm::engine::map_matching;
+
+namespace
+{
+PhantomNode makePhantom(const NodeID node, const double lon)
+{
+    PhantomNode phantom;
+    phantom.forward_segment_id = {node, true};
+    phantom.forward_weight = 10;
+    phantom.location = util::Coordinate{util::FloatLongitude{lon}, util::FloatLatitude{52.5}};
+    return phantom;
+}
+
+CandidatesKey makeKey(const double lon)
+{
+    return {util::Coordinate{util::FloatLongitude{lon}, util::FloatLatitude{52.5}},
+            15.,
+            boost::none,
+            Approach::UNRESTRICTED};
+}
+}
+
+BOOST_AUTO_TEST_CASE(keys_depend_on_search_parameters)
+{
+    const auto key = makeKey(13.4);
+    BOOST_CHECK(key == makeKey(13.4));
+    BOOST_CHECK_EQUAL(CandidatesKeyHash()(key), CandidatesKeyHash()(makeKey(13.4)));
+    BOOST_CHECK(!(key == makeKey(13.5)));
+
+    const CandidatesKey wider{
+        util::Coordinate{util::FloatLongitude{13.4}, util::FloatLatitude{52.5}},
+        30.,
+        boost::none,
+        Approach::UNRESTRICTED};
+    BOOST_CHECK(!(key == wider));
+    const CandidatesKey with_bearing{
+        util::Coordinate{util::FloatLongitude{13.4}, util::FloatLatitude{52.5}},
+        15.,
+        Bearing{90, 10},
+        Approach::UNRESTRICTED};
+    BOOST_CHECK(!(key == with_bearing));
+
+    const TransitionKey transition{makePhantom(1, 13.4), makePhantom(2, 13.5), 100};
+    BOOST_CHECK(transition == TransitionKey(makePhantom(1, 13.4), makePhantom(2, 13.5), 100));
+    BOOST_CHECK_EQUAL(
+        TransitionKeyHash()(transition),
+        TransitionKeyHash()(TransitionKey(makePhantom(1, 13.4), makePhantom(2, 13.5), 100)));
+    // the network distances start at the snapped locations
+    BOOST_CHECK(!(transition == TransitionKey(makePhantom(1, 13.41), makePhantom(2, 13.5), 100)));
+    BOOST_CHECK(!(transition == TransitionKey(makePhantom(2, 13.4), makePhantom(1, 13.5), 100)));
+    BOOST_CHECK(!(transition == TransitionKey(makePhantom(1, 13.4), makePhantom(2, 13.5), 200)));
+}
+
+BOOST_AUTO_TEST_CASE(keeps_searches_of_last_request)
+{
+    const TransitionKey first{makePhantom(1, 13.4), makePhantom(2, 13.5), 100};
+    const TransitionKey second{makePhantom(2, 13.5), makePhantom(3, 13.6), 100};
+
+    auto previous = std::make_shared<MatchingSession>();
+    previous->AddCandidates(makeKey(13.4), {PhantomNodeWithDistance{makePhantom(1, 13.4), 1.}});
+    previous->AddCandidates(makeKey(13.5), {PhantomNodeWithDistance{makePhantom(2, 13.5), 2.}});
+    previous->AddTransition(first, 42.);
+    previous->AddTransition(second, 23.);
+
+    // the trace moved on by one coordinate
+    MatchingSession session(previous);
+    BOOST_CHECK(session.FindCandidates(makeKey(13.6)) == nullptr);
+    const auto candidates = session.FindCandidates(makeKey(13.5));
+    BOOST_REQUIRE(candidates != nullptr);
+    BOOST_REQUIRE_EQUAL(candidates->size(), 1);
+    BOOST_CHECK_EQUAL(candidates->front().distance, 2.);
+    const auto distance = session.FindTransition(second);
+    BOOST_REQUIRE(distance != nullptr);
+    BOOST_CHECK_EQUAL(*distance, 23.);
+    session.AddCandidates(makeKey(13.6), {});
+
+    // only what the request looked up or added is kept once the previous session is released
+    session.ReleasePrevious();
+    BOOST_CHECK_EQUAL(session.NumberOfCandidateLists(), 2);
+    BOOST_CHECK_EQUAL(session.NumberOfTransitions(), 1);
+    BOOST_CHECK(session.FindCandidates(makeKey(13.4)) == nullptr);
+    BOOST_CHECK(session.FindTransition(first) == nullptr);
+    BOOST_CHECK(session.FindCandidates(makeKey(13.6)) != nullptr);
+
+    // the previous session of concurrent requests is never changed
+    BOOST_CHECK_EQUAL(previous->NumberOfCandidateLists(), 2);
+    BOOST_CHECK_EQUAL(previous->NumberOfTransitions(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(sessions_depend_on_facade)
+{
+    MatchingSessionCache cache(4, 2);
+    cache.Put(1, {1, "trace"}, std::make_shared<const MatchingSession>());
+
+    BOOST_CHECK(cache.Get(1, {1, "trace"}) != nullptr);
+    BOOST_CHECK(cache.Get(1, {1, "other"}) == nullptr);
+    BOOST_CHECK(cache.Get(1, {2, "trace"}) == nullptr);
+
+    // a new dataset drops all sessions
+    BOOST_CHECK(cache.Get(2, {1, "trace"}) == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
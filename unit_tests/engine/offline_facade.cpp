@@ -125,10 +125,12 @@ class ContiguousInternalMemoryDataFacade<routing_algorithms::offline::Algorithm>
 
     NodeID GetTarget(const EdgeID /*edgeID*/) const { return 0; }
 
-    const EdgeData &GetEdgeData(const EdgeID /*edgeID*/) const
+    EdgeData GetEdgeData(const EdgeID /*edgeID*/) const { return EdgeData{}; }
+
+    const partitioner::CompactEdgeBasedEdge &GetCompactEdge(const EdgeID /*edgeID*/) const
     {
-        static EdgeData outData;
-        return outData;
+        static partitioner::CompactEdgeBasedEdge outEdge{};
+        return outEdge;
     }
 
     const auto &GetMultiLevelPartition() const { return external_partition; }
@@ -142,6 +144,8 @@ class ContiguousInternalMemoryDataFacade<routing_algorithms::offline::Algorithm>
         return util::irange<EdgeID>(0, 0);
     }
 
+    void PrefetchAdjacentEdgeRange(const NodeID /*node*/) const {}
+
     EdgeID FindEdge(const NodeID /*from*/, const NodeID /*to*/) const { return SPECIAL_EDGEID; }
 
     unsigned GetCheckSum() const override { return 0; }
@@ -154,6 +158,8 @@ class ContiguousInternalMemoryDataFacade<routing_algorithms::offline::Algorithm>
 
     OSMNodeID GetOSMNodeIDOfNode(const NodeID /*id*/) const override { return OSMNodeID(); }
 
+    bool HasOSMNodeIDs() const override { return true; }
+
     GeometryID GetGeometryIndex(const NodeID /*id*/) const override { return GeometryID{0, false}; }
 
     std::vector<NodeID> GetUncompressedForwardGeometry(const EdgeID /*id*/) const override
@@ -166,6 +172,18 @@ class ContiguousInternalMemoryDataFacade<routing_algorithms::offline::Algorithm>
         return {};
     }
 
+    std::vector<util::Coordinate>
+    GetUncompressedForwardCoordinates(const EdgeID /*id*/) const override
+    {
+        return {};
+    }
+
+    std::vector<util::Coordinate>
+    GetUncompressedReverseCoordinates(const EdgeID /*id*/) const override
+    {
+        return {};
+    }
+
     TurnPenalty GetWeightPenaltyForEdgeID(const unsigned /*id*/) const override
     {
         return INVALID_TURN_PENALTY;
@@ -432,8 +450,8 @@ BOOST_AUTO_TEST_CASE(shortest_path)
     std::vector<osrm::engine::PhantomNodes> phantom_nodes;
     phantom_nodes.push_back({osrm::engine::PhantomNode{}, osrm::engine::PhantomNode{}});
 
-    auto route =
-        osrm::engine::routing_algorithms::shortestPathSearch(heaps, facade, phantom_nodes, false);
+    auto route = osrm::engine::routing_algorithms::shortestPathSearch(
+        heaps, facade, phantom_nodes, false, false);
 
     BOOST_CHECK_EQUAL(route.shortest_path_weight, INVALID_EDGE_WEIGHT);
 }
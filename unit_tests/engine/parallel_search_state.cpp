@@ -0,0 +1,76 @@
+#include "engine/routing_algorithms/parallel_search_state.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(parallel_search_state)
+
+using namespace osrm;
+using namespace osrm::engine::routing_algorithms;
+
+BOOST_AUTO_TEST_CASE(node_weights_keep_the_last_key)
+{
+    ConcurrentNodeWeights weights(16);
+    BOOST_CHECK_EQUAL(weights.Get(3), INVALID_EDGE_WEIGHT);
+
+    BOOST_CHECK(weights.Set(3, 10));
+    BOOST_CHECK(weights.Set(19, -5));
+    BOOST_CHECK(weights.Set(3, 7));
+    BOOST_CHECK_EQUAL(weights.Get(3), 7);
+    BOOST_CHECK_EQUAL(weights.Get(19), -5);
+    BOOST_CHECK_EQUAL(weights.Get(35), INVALID_EDGE_WEIGHT);
+
+    weights.Clear();
+    BOOST_CHECK_EQUAL(weights.Get(3), INVALID_EDGE_WEIGHT);
+    BOOST_CHECK_EQUAL(weights.Get(19), INVALID_EDGE_WEIGHT);
+}
+
+BOOST_AUTO_TEST_CASE(node_weights_refuse_new_nodes_once_half_full)
+{
+    ConcurrentNodeWeights weights(16);
+    for (NodeID node = 0; node < 8; ++node)
+    {
+        BOOST_CHECK(weights.Set(node * 100, node));
+    }
+    BOOST_CHECK(!weights.Set(1000, 1));
+    // known nodes can still be decreased
+    BOOST_CHECK(weights.Set(700, 0));
+    BOOST_CHECK_EQUAL(weights.Get(700), 0);
+    BOOST_CHECK_EQUAL(weights.Get(1000), INVALID_EDGE_WEIGHT);
+}
+
+BOOST_AUTO_TEST_CASE(halves_see_the_nodes_of_each_other)
+{
+    ParallelSearchState state;
+    state.Reset(INVALID_EDGE_WEIGHT, 0, 0);
+
+    // both halves reach all nodes, for each node one of them has to find the other key
+    const NodeID number_of_nodes = 10000;
+    std::array<bool, 2> all_set = {{true, true}};
+    const auto run_half = [&](const int own) {
+        for (NodeID node = 0; node < number_of_nodes; ++node)
+        {
+            all_set[own] = state.reached[own].Set(node, node + 1) && all_set[own];
+            const auto other_weight = state.reached[1 - own].Get(node);
+            if (other_weight != INVALID_EDGE_WEIGHT)
+            {
+                state.UpdateUpperBound(node, node + 1 + other_weight);
+            }
+        }
+    };
+    std::thread reverse_half(run_half, 1);
+    run_half(0);
+    reverse_half.join();
+
+    BOOST_CHECK(all_set[0] && all_set[1]);
+    BOOST_CHECK_EQUAL(state.upper_bound.load(), 2);
+    BOOST_CHECK_EQUAL(state.middle, 0);
+    BOOST_CHECK(!state.IsDone());
+    state.min_keys[0] = 1;
+    state.min_keys[1] = 1;
+    BOOST_CHECK(state.IsDone());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,148 @@
+#include "engine/routing_algorithms/phast_graph.hpp"
+#include "engine/search_engine_data.hpp"
+
+#include "contractor/query_edge.hpp"
+#include "util/static_graph.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(phast)
+
+using namespace osrm;
+using namespace osrm::engine;
+using namespace osrm::engine::routing_algorithms::ch;
+
+namespace
+{
+using Graph = util::StaticGraph<contractor::QueryEdge::EdgeData>;
+using Heap = SearchEngineData<routing_algorithms::ch::Algorithm>::ManyToManyQueryHeap;
+
+// edges are stored at their lower node, valid in both directions, duration is twice the weight
+Graph::InputEdge makeEdge(const NodeID lower, const NodeID higher, const EdgeWeight weight)
+{
+    return {lower,
+            higher,
+            contractor::QueryEdge::EdgeData{SPECIAL_NODEID, false, weight, 2 * weight, true, true}};
+}
+
+// 1 - 0 - 2 - 3 and 1 - 2 with the ranks 1 < 3 < 0 < 2, 0 - 2 is the shortcut over 1
+Graph makeHierarchy()
+{
+    std::vector<Graph::InputEdge> edges = {
+        makeEdge(0, 2, 3), makeEdge(1, 0, 1), makeEdge(1, 2, 2), makeEdge(3, 2, 3)};
+    return Graph(4, edges);
+}
+}
+
+BOOST_AUTO_TEST_CASE(higher_nodes_come_first)
+{
+    const auto graph = makeHierarchy();
+    const PhastGraph phast_graph(graph);
+
+    BOOST_REQUIRE_EQUAL(phast_graph.GetNumberOfNodes(), 4);
+    BOOST_CHECK_EQUAL(phast_graph.GetNode(0), 2);
+    BOOST_CHECK_EQUAL(phast_graph.GetNode(3), 1);
+    for (std::uint32_t position = 0; position < 4; ++position)
+    {
+        BOOST_CHECK_EQUAL(phast_graph.GetPosition(phast_graph.GetNode(position)), position);
+        for (const auto &edge : phast_graph.GetIncomingEdges(position))
+            BOOST_CHECK_LT(edge.source, position);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sweep_sets_the_labels_of_all_nodes)
+{
+    const auto graph = makeHierarchy();
+    const PhastGraph phast_graph(graph);
+
+    Heap heap(graph.GetNumberOfNodes());
+    heap.Insert(3, 0, {3, 0});
+    PhastLabels labels;
+    phastSearch(graph, phast_graph, heap, labels);
+
+    const std::vector<EdgeWeight> expected_weights = {6, 5, 3, 0};
+    for (NodeID node = 0; node < 4; ++node)
+    {
+        const auto position = phast_graph.GetPosition(node);
+        BOOST_CHECK_EQUAL(labels.weights[position], expected_weights[node]);
+        BOOST_CHECK_EQUAL(labels.durations[position], 2 * expected_weights[node]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(unreached_nodes_keep_invalid_labels)
+{
+    std::vector<Graph::InputEdge> edges = {makeEdge(1, 0, 1)};
+    const Graph graph(3, edges);
+    const PhastGraph phast_graph(graph);
+
+    Heap heap(graph.GetNumberOfNodes());
+    heap.Insert(1, 0, {1, 0});
+    PhastLabels labels;
+    phastSearch(graph, phast_graph, heap, labels);
+
+    BOOST_CHECK_EQUAL(labels.weights[phast_graph.GetPosition(0)], 1);
+    BOOST_CHECK_EQUAL(labels.weights[phast_graph.GetPosition(2)], INVALID_EDGE_WEIGHT);
+}
+
+BOOST_AUTO_TEST_CASE(cycles_are_no_hierarchy)
+{
+    std::vector<Graph::InputEdge> edges = {makeEdge(0, 1, 1), makeEdge(1, 2, 1), makeEdge(2, 0, 1)};
+    const Graph graph(3, edges);
+    BOOST_CHECK_THROW(PhastGraph{graph}, util::exception);
+}
+
+BOOST_AUTO_TEST_CASE(restricted_graph_has_the_nodes_above_the_targets)
+{
+    const auto graph = makeHierarchy();
+    const PhastGraph phast_graph(graph);
+
+    // 3 is only reached by its upward edge to 2
+    const RestrictedPhastGraph restricted_graph(phast_graph, {0});
+    BOOST_CHECK_EQUAL(restricted_graph.GetNumberOfNodes(), 2);
+    BOOST_CHECK_EQUAL(restricted_graph.GetNode(0), 2);
+    BOOST_CHECK_EQUAL(restricted_graph.GetNode(1), 0);
+    BOOST_CHECK_EQUAL(restricted_graph.GetIndex(1), RestrictedPhastGraph::INVALID_INDEX);
+    BOOST_CHECK_EQUAL(restricted_graph.GetIndex(3), RestrictedPhastGraph::INVALID_INDEX);
+}
+
+BOOST_AUTO_TEST_CASE(restricted_sweep_sets_the_labels_of_all_lanes)
+{
+    const auto graph = makeHierarchy();
+    const PhastGraph phast_graph(graph);
+    const RestrictedPhastGraph restricted_graph(phast_graph, {0, 1});
+
+    // every lane has its own source, the last lanes have none
+    const std::vector<NodeID> sources = {3, 1, 0, 2, 3};
+    PhastLaneLabels lane_labels;
+    lane_labels.Reset(restricted_graph.GetNumberOfNodes());
+    for (std::size_t lane = 0; lane < sources.size(); ++lane)
+    {
+        Heap heap(graph.GetNumberOfNodes());
+        heap.Insert(sources[lane], 0, {sources[lane], 0});
+        restrictedUpwardSearch(graph, restricted_graph, heap, lane, lane_labels);
+    }
+    restrictedSweep(restricted_graph, lane_labels);
+
+    for (std::size_t lane = 0; lane < sources.size(); ++lane)
+    {
+        Heap heap(graph.GetNumberOfNodes());
+        heap.Insert(sources[lane], 0, {sources[lane], 0});
+        PhastLabels labels;
+        phastSearch(graph, phast_graph, heap, labels);
+
+        for (const NodeID target : {0, 1})
+        {
+            const auto index = restricted_graph.GetIndex(target);
+            const auto position = phast_graph.GetPosition(target);
+            BOOST_CHECK_EQUAL(lane_labels.GetWeights(index)[lane], labels.weights[position]);
+            BOOST_CHECK_EQUAL(lane_labels.GetDurations(index)[lane], labels.durations[position]);
+        }
+    }
+
+    for (std::uint32_t index = 0; index < restricted_graph.GetNumberOfNodes(); ++index)
+        BOOST_CHECK_EQUAL(lane_labels.GetWeights(index)[PHAST_LANES - 1], INVALID_EDGE_WEIGHT);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -46,4 +46,22 @@ BOOST_AUTO_TEST_CASE(polyline6_test_case)
         decodePolyline<1000000>(encodePolyline<1000000>(coords.begin(), coords.end())).begin()));
 }
 
+BOOST_AUTO_TEST_CASE(polyline_append_test_case)
+{
+    using namespace osrm::engine;
+    using namespace osrm::util;
+
+    const std::vector<Coordinate> coords({{FixedLongitude{-73990171}, FixedLatitude{40714701}},
+                                          {FixedLongitude{-73991801}, FixedLatitude{40717571}},
+                                          {FixedLongitude{-73985751}, FixedLatitude{40715651}},
+                                          {FixedLongitude{179999999}, FixedLatitude{-89999999}}});
+
+    std::string output = "prefix";
+    encodePolyline<1000000>(coords.begin(), coords.end(), output);
+    BOOST_CHECK_EQUAL(output, "prefix" + encodePolyline<1000000>(coords.begin(), coords.end()));
+    BOOST_CHECK(std::equal(coords.begin(),
+                           coords.end(),
+                           decodePolyline<1000000>(output.substr(6)).begin()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
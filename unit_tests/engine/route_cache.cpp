@@ -0,0 +1,95 @@
+#include "engine/route_cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(route_cache)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+PhantomNode makePhantom(const NodeID node, const EdgeWeight offset)
+{
+    PhantomNode phantom;
+    phantom.forward_segment_id = {node, true};
+    phantom.forward_weight = 10;
+    phantom.forward_weight_offset = offset;
+    phantom.forward_duration = 20;
+    return phantom;
+}
+
+std::shared_ptr<const InternalManyRoutesResult> makeRoutes(const EdgeWeight weight)
+{
+    InternalRouteResult route;
+    route.shortest_path_weight = weight;
+    return std::make_shared<const InternalManyRoutesResult>(route);
+}
+}
+
+BOOST_AUTO_TEST_CASE(keys_depend_on_phantoms_and_parameters)
+{
+    const std::vector<PhantomNodes> legs = {{makePhantom(1, 0), makePhantom(2, 0)}};
+    const RouteCacheKey key(1, legs, 0, boost::none);
+
+    auto moved_snapping = legs;
+    moved_snapping.front().target_phantom.input_location =
+        util::Coordinate{util::FloatLongitude{13.4}, util::FloatLatitude{52.5}};
+    BOOST_CHECK(key == RouteCacheKey(1, moved_snapping, 0, boost::none));
+    BOOST_CHECK_EQUAL(RouteCacheKeyHash()(key),
+                      RouteCacheKeyHash()(RouteCacheKey(1, moved_snapping, 0, boost::none)));
+
+    auto other_offset = legs;
+    other_offset.front().target_phantom.forward_weight_offset = 5;
+    BOOST_CHECK(!(key == RouteCacheKey(1, other_offset, 0, boost::none)));
+    BOOST_CHECK(!(key == RouteCacheKey(2, legs, 0, boost::none)));
+    BOOST_CHECK(!(key == RouteCacheKey(1, legs, 2, boost::none)));
+    BOOST_CHECK(!(key == RouteCacheKey(1, legs, 0, false)));
+    BOOST_CHECK(!(RouteCacheKey(1, legs, 0, true) == RouteCacheKey(1, legs, 0, false)));
+
+    const std::vector<PhantomNodes> via_legs = {{makePhantom(1, 0), makePhantom(2, 0)},
+                                                {makePhantom(2, 0), makePhantom(3, 0)}};
+    BOOST_CHECK(!(key == RouteCacheKey(1, via_legs, 0, boost::none)));
+}
+
+BOOST_AUTO_TEST_CASE(evicts_least_recently_used_routes)
+{
+    RouteCache cache(4, 2);
+    std::vector<RouteCacheKey> keys;
+    for (NodeID node = 0; node < 32; ++node)
+    {
+        keys.emplace_back(1, std::vector<PhantomNodes>{{makePhantom(node, 0), makePhantom(0, 0)}},
+                          0, boost::none);
+        cache.Put(1, keys.back(), makeRoutes(node));
+        BOOST_CHECK_LE(cache.Size(), 4);
+    }
+
+    const auto last = cache.Get(1, keys.back());
+    BOOST_REQUIRE(last);
+    BOOST_CHECK_EQUAL(last->routes.front().shortest_path_weight, 31);
+    BOOST_CHECK(!cache.Get(1, keys.front()));
+}
+
+BOOST_AUTO_TEST_CASE(clears_routes_of_replaced_dataset)
+{
+    RouteCache cache(8);
+    const RouteCacheKey old_key(
+        1, std::vector<PhantomNodes>{{makePhantom(1, 0), makePhantom(2, 0)}}, 0, boost::none);
+    const RouteCacheKey new_key(
+        2, std::vector<PhantomNodes>{{makePhantom(1, 0), makePhantom(2, 0)}}, 0, boost::none);
+
+    cache.Put(1, old_key, makeRoutes(1));
+    BOOST_CHECK(cache.Get(1, old_key));
+    BOOST_CHECK(!cache.Get(2, new_key));
+    BOOST_CHECK_EQUAL(cache.Size(), 0);
+
+    // requests still running on the old dataset do not clear the routes of the new one
+    cache.Put(2, new_key, makeRoutes(2));
+    BOOST_CHECK(!cache.Get(1, old_key));
+    BOOST_CHECK(cache.Get(2, new_key));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
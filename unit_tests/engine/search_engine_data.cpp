@@ -0,0 +1,50 @@
+#include "engine/search_engine_data.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(search_engine_data)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+using CH = routing_algorithms::ch::Algorithm;
+
+void fillHeap(SearchEngineData<CH>::QueryHeap &heap)
+{
+    for (NodeID node = 0; node < 50000; ++node)
+    {
+        heap.Insert(node, node, {node});
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(heaps_above_the_memory_limit_are_shrunk)
+{
+    SearchEngineData<CH> heaps;
+    heaps.max_heap_memory = 64 * 1024;
+
+    heaps.InitializeOrClearFirstThreadLocalStorage(100000);
+    fillHeap(*heaps.forward_heap_1);
+    const auto retained = heaps.forward_heap_1->RetainedMemory();
+    BOOST_CHECK_GT(retained, heaps.max_heap_memory);
+
+    // heaps that the query still uses are not shrunk
+    heaps.InitializeOrClearManyToManyThreadLocalStorage(100000);
+    BOOST_CHECK_EQUAL(heaps.forward_heap_1->RetainedMemory(), retained);
+    BOOST_CHECK_EQUAL(heaps.forward_heap_1->Size(), 50000);
+
+    heaps.InitializeOrClearFirstThreadLocalStorage(100000);
+    BOOST_CHECK_LT(heaps.forward_heap_1->RetainedMemory(), retained);
+    BOOST_CHECK(heaps.forward_heap_1->Empty());
+
+    // without a limit heaps keep the memory of their largest search
+    heaps.max_heap_memory = 0;
+    fillHeap(*heaps.forward_heap_1);
+    const auto unlimited_retained = heaps.forward_heap_1->RetainedMemory();
+    heaps.InitializeOrClearFirstThreadLocalStorage(100000);
+    BOOST_CHECK_EQUAL(heaps.forward_heap_1->RetainedMemory(), unlimited_retained);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,44 @@
+#include "engine/tile_cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(tile_cache)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+BOOST_AUTO_TEST_CASE(keys_depend_on_facade_and_coordinates)
+{
+    const TileCacheKey key{1, 8800, 5373, 14};
+    BOOST_CHECK(key == (TileCacheKey{1, 8800, 5373, 14}));
+    BOOST_CHECK_EQUAL(TileCacheKeyHash()(key), TileCacheKeyHash()(TileCacheKey{1, 8800, 5373, 14}));
+
+    BOOST_CHECK(!(key == (TileCacheKey{2, 8800, 5373, 14})));
+    BOOST_CHECK(!(key == (TileCacheKey{1, 8801, 5373, 14})));
+    BOOST_CHECK(!(key == (TileCacheKey{1, 8800, 5374, 14})));
+    BOOST_CHECK(!(key == (TileCacheKey{1, 8800, 5373, 15})));
+}
+
+BOOST_AUTO_TEST_CASE(keeps_tiles_of_current_dataset)
+{
+    TileCache cache(4, 2);
+    for (unsigned x = 0; x < 16; ++x)
+    {
+        cache.Put(1, TileCacheKey{1, x, 0, 12}, std::make_shared<const std::string>(1, 'a' + x));
+        BOOST_CHECK_LE(cache.Size(), 4);
+    }
+
+    const auto last = cache.Get(1, TileCacheKey{1, 15, 0, 12});
+    BOOST_REQUIRE(last);
+    BOOST_CHECK_EQUAL(*last, "p");
+    BOOST_CHECK(!cache.Get(1, TileCacheKey{1, 0, 0, 12}));
+
+    // a newer dataset drops all tiles
+    BOOST_CHECK(!cache.Get(2, TileCacheKey{2, 15, 0, 12}));
+    BOOST_CHECK_EQUAL(cache.Size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
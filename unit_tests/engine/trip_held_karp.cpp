@@ -0,0 +1,100 @@
+#include "engine/trip/trip_held_karp.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(trip_held_karp)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+EdgeWeight TripWeight(const util::DistTableWrapper<EdgeWeight> &table,
+                      const std::vector<NodeID> &trip)
+{
+    EdgeWeight weight = 0;
+    for (std::size_t index = 0; index < trip.size(); ++index)
+    {
+        const auto edge_weight = table(trip[index], trip[(index + 1) % trip.size()]);
+        if (edge_weight == INVALID_EDGE_WEIGHT)
+            return INVALID_EDGE_WEIGHT;
+        weight += edge_weight;
+    }
+    return weight;
+}
+
+// the shortest trip of all permutations that start at location 0
+EdgeWeight MinTripWeight(const util::DistTableWrapper<EdgeWeight> &table)
+{
+    std::vector<NodeID> trip(table.GetNumberOfNodes());
+    std::iota(trip.begin(), trip.end(), 0);
+    EdgeWeight min_weight = INVALID_EDGE_WEIGHT;
+    do
+    {
+        min_weight = std::min(min_weight, TripWeight(table, trip));
+    } while (std::next_permutation(trip.begin() + 1, trip.end()));
+    return min_weight;
+}
+}
+
+BOOST_AUTO_TEST_CASE(finds_the_shortest_trip)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<EdgeWeight> weight_distribution(1, 1000);
+    std::bernoulli_distribution invalid_distribution(0.2);
+
+    for (std::size_t number_of_locations = 1; number_of_locations <= 8; ++number_of_locations)
+    {
+        for (int round = 0; round < 20; ++round)
+        {
+            std::vector<EdgeWeight> weights(number_of_locations * number_of_locations);
+            for (auto &weight : weights)
+            {
+                weight = invalid_distribution(generator) ? INVALID_EDGE_WEIGHT
+                                                         : weight_distribution(generator);
+            }
+            const util::DistTableWrapper<EdgeWeight> table(weights, number_of_locations);
+
+            const auto trip = trip::HeldKarpTrip(number_of_locations, table);
+            BOOST_REQUIRE_EQUAL(trip.size(), number_of_locations);
+            BOOST_CHECK_EQUAL(trip.front(), 0);
+
+            auto sorted_trip = trip;
+            std::sort(sorted_trip.begin(), sorted_trip.end());
+            std::vector<NodeID> locations(number_of_locations);
+            std::iota(locations.begin(), locations.end(), 0);
+            BOOST_CHECK(sorted_trip == locations);
+
+            BOOST_CHECK_EQUAL(TripWeight(table, trip), MinTripWeight(table));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(solves_the_largest_trips)
+{
+    // locations on a line, the shortest trip goes to the end and back
+    const auto number_of_locations = trip::HELD_KARP_MAX_LOCATIONS;
+    std::vector<EdgeWeight> weights(number_of_locations * number_of_locations);
+    std::vector<NodeID> order{0, 5, 3, 9, 1, 15, 7, 12, 2, 14, 4, 11, 6, 13, 8, 10};
+    for (std::size_t from = 0; from < number_of_locations; ++from)
+    {
+        for (std::size_t to = 0; to < number_of_locations; ++to)
+        {
+            const auto from_position = std::find(order.begin(), order.end(), from) - order.begin();
+            const auto to_position = std::find(order.begin(), order.end(), to) - order.begin();
+            weights[from * number_of_locations + to] =
+                10 * std::abs(static_cast<int>(from_position - to_position));
+        }
+    }
+    const util::DistTableWrapper<EdgeWeight> table(weights, number_of_locations);
+
+    const auto trip = trip::HeldKarpTrip(number_of_locations, table);
+    BOOST_CHECK_EQUAL(TripWeight(table, trip), 2 * 10 * (number_of_locations - 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,63 @@
+#include "engine/routing_algorithms/unpacking_cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+
+BOOST_AUTO_TEST_SUITE(unpacking_cache)
+
+using namespace osrm;
+using namespace osrm::engine::routing_algorithms;
+
+namespace
+{
+std::shared_ptr<const UnpackedShortcut> makeShortcut(const NodeID from, const NodeID to)
+{
+    UnpackedShortcut shortcut;
+    shortcut.edges = {{from, from + 1}, {from + 1, to}};
+    shortcut.edge_ids = {from, to};
+    return std::make_shared<const UnpackedShortcut>(std::move(shortcut));
+}
+}
+
+BOOST_AUTO_TEST_CASE(shortcuts_are_directed)
+{
+    UnpackingCache cache(4);
+    BOOST_CHECK(!cache.Get(1, 10, 20));
+    cache.Put(1, 10, 20, makeShortcut(10, 20));
+
+    const auto shortcut = cache.Get(1, 10, 20);
+    BOOST_REQUIRE(shortcut);
+    BOOST_CHECK_EQUAL(shortcut->edges.size(), 2);
+    BOOST_CHECK_EQUAL(shortcut->edges.back().second, 20);
+    BOOST_CHECK(!cache.Get(1, 20, 10));
+}
+
+BOOST_AUTO_TEST_CASE(least_recently_used_shortcuts_are_evicted)
+{
+    UnpackingCache cache(2);
+    cache.Get(1, 0, 0);
+    cache.Put(1, 1, 2, makeShortcut(1, 2));
+    cache.Put(1, 2, 3, makeShortcut(2, 3));
+    BOOST_CHECK(cache.Get(1, 1, 2));
+    cache.Put(1, 3, 4, makeShortcut(3, 4));
+
+    BOOST_CHECK(cache.Get(1, 1, 2));
+    BOOST_CHECK(!cache.Get(1, 2, 3));
+    BOOST_CHECK(cache.Get(1, 3, 4));
+}
+
+BOOST_AUTO_TEST_CASE(another_facade_drops_all_shortcuts)
+{
+    UnpackingCache cache(4);
+    cache.Get(1, 0, 0);
+    cache.Put(1, 1, 2, makeShortcut(1, 2));
+
+    BOOST_CHECK(!cache.Get(2, 1, 2));
+    // shortcuts of the old facade are not cached anymore
+    cache.Put(1, 1, 2, makeShortcut(1, 2));
+    BOOST_CHECK(!cache.Get(1, 1, 2));
+    BOOST_CHECK(!cache.Get(2, 1, 2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -87,4 +87,61 @@ BOOST_AUTO_TEST_CASE(t_crossing)
     BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(2), 3);
 }
 
+BOOST_AUTO_TEST_CASE(frozen_buckets)
+{
+    //   0   1    2    3
+    // 0---1----2----3----4
+    //   5   6
+    // 5---6----7
+    CompressedEdgeContainer container;
+    container.CompressEdge(2, 3, 3, 4, 1, 2, 11, 12);
+    container.CompressEdge(5, 6, 6, 7, 3, 4, 13, 14, 5, 15);
+    container.CompressEdge(0, 1, 1, 2, 6, 7, 16, 17);
+    container.CompressEdge(0, 2, 2, 4, 13, 3, 33, 23);
+    container.AddUncompressedEdge(4, 9, 8, 18);
+    container.AddUncompressedEdge(0, 9, 8, 18);
+    BOOST_CHECK(container.IsTrivial(4));
+    BOOST_CHECK(!container.IsTrivial(0));
+    BOOST_CHECK_EQUAL(container.GetLastEdgeTargetID(0), 4);
+
+    container.Freeze();
+    BOOST_CHECK(container.IsFrozen());
+    BOOST_CHECK(container.HasEntryForID(0));
+    BOOST_CHECK(!container.HasEntryForID(1));
+    BOOST_CHECK(!container.HasEntryForID(2));
+    BOOST_CHECK(!container.HasEntryForID(3));
+    BOOST_CHECK(container.HasEntryForID(4));
+    BOOST_CHECK(container.HasEntryForID(5));
+    BOOST_CHECK(!container.HasEntryForID(6));
+    BOOST_CHECK(!container.HasEntryForID(7));
+
+    const auto road = container.GetBucketReference(0);
+    BOOST_REQUIRE_EQUAL(road.size(), 4);
+    BOOST_CHECK_EQUAL(road[0].node_id, 1);
+    BOOST_CHECK_EQUAL(road[1].node_id, 2);
+    BOOST_CHECK_EQUAL(road[2].node_id, 3);
+    BOOST_CHECK_EQUAL(road[3].node_id, 4);
+    BOOST_CHECK_EQUAL(road[0].weight, 6);
+    BOOST_CHECK_EQUAL(road[1].weight, 7);
+    BOOST_CHECK_EQUAL(road[2].weight, 1);
+    BOOST_CHECK_EQUAL(road[3].weight, 2);
+    BOOST_CHECK_EQUAL(road[3].duration, 12);
+
+    // the penalty of the via node is an artificial segment
+    const auto penalized = container.GetBucketReference(5);
+    BOOST_REQUIRE_EQUAL(penalized.size(), 3);
+    BOOST_CHECK_EQUAL(penalized[0].node_id, 6);
+    BOOST_CHECK_EQUAL(penalized[1].node_id, 6);
+    BOOST_CHECK_EQUAL(penalized[1].weight, 5);
+    BOOST_CHECK_EQUAL(penalized[1].duration, 15);
+    BOOST_CHECK_EQUAL(penalized[2].node_id, 7);
+
+    BOOST_CHECK(container.IsTrivial(4));
+    BOOST_CHECK_EQUAL(container.GetBucketReference(4).front().node_id, 9);
+    BOOST_CHECK_EQUAL(container.GetFirstEdgeTargetID(0), 1);
+    BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(0), 3);
+    BOOST_CHECK_EQUAL(container.GetLastEdgeTargetID(5), 7);
+    BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(5), 6);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,70 @@
+#include "extractor/geometry_coordinates_container.hpp"
+#include "extractor/segment_data_container.hpp"
+#include "util/coordinate.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(geometry_coordinates_container)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+// two geometries: 0 -> 1 -> 2 and 3 -> 4, node 2 is too far from node 0 for a delta
+SegmentDataContainer makeSegmentData()
+{
+    const std::vector<NodeID> nodes{0, 1, 2, 3, 4};
+    return SegmentDataContainer{{0, 3, 5},
+                                SegmentDataContainer::SegmentNodeVector{nodes},
+                                SegmentDataContainer::SegmentWeightVector(nodes.size()),
+                                SegmentDataContainer::SegmentWeightVector(nodes.size()),
+                                SegmentDataContainer::SegmentDurationVector(nodes.size()),
+                                SegmentDataContainer::SegmentDurationVector(nodes.size()),
+                                std::vector<DatasourceID>(nodes.size()),
+                                std::vector<DatasourceID>(nodes.size())};
+}
+
+const std::vector<util::Coordinate> coordinates{
+    {util::FixedLongitude{13000000}, util::FixedLatitude{52000000}},
+    {util::FixedLongitude{13032767}, util::FixedLatitude{51967233}},
+    {util::FixedLongitude{13000000}, util::FixedLatitude{52032768}},
+    {util::FixedLongitude{-179999000}, util::FixedLatitude{-89000000}},
+    {util::FixedLongitude{-179999100}, util::FixedLatitude{-88999900}}};
+}
+
+BOOST_AUTO_TEST_CASE(unpack_geometries)
+{
+    const auto segment_data = makeSegmentData();
+    const GeometryCoordinatesContainer geometry_coordinates{segment_data, coordinates};
+    BOOST_CHECK_EQUAL(geometry_coordinates.GetNumberOfGeometries(), 2);
+
+    std::vector<NodeID> looked_up;
+    for (const auto id : {0u, 1u})
+    {
+        std::vector<NodeID> nodes;
+        segment_data.UnpackForwardGeometry(id, nodes);
+        const auto positions = segment_data.GetGeometryPositions(id);
+
+        std::vector<util::Coordinate> result(nodes.size());
+        geometry_coordinates.Unpack(
+            id, positions.first, positions.second, result.begin(), [&](const std::size_t offset) {
+                looked_up.push_back(nodes[offset]);
+                return coordinates[nodes[offset]];
+            });
+
+        std::vector<util::Coordinate> expected;
+        for (const auto node : nodes)
+            expected.push_back(coordinates[node]);
+        BOOST_CHECK(result == expected);
+    }
+
+    // only the coordinate without a delta is looked up
+    BOOST_REQUIRE_EQUAL(looked_up.size(), 1);
+    BOOST_CHECK_EQUAL(looked_up.front(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,7 @@
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/maneuver_override.hpp"
 #include "extractor/restriction.hpp"
+#include "util/id_set.hpp"
 #include "util/node_based_graph.hpp"
 #include "util/typedefs.hpp"
 
@@ -11,7 +12,6 @@
 #include <boost/test/unit_test.hpp>
 
 #include <iostream>
-#include <unordered_set>
 #include <vector>
 
 BOOST_AUTO_TEST_SUITE(graph_compressor)
@@ -65,8 +65,8 @@ BOOST_AUTO_TEST_CASE(long_road_test)
     //
     GraphCompressor compressor;
 
-    std::unordered_set<NodeID> barrier_nodes;
-    std::unordered_set<NodeID> traffic_lights;
+    util::IdSet<NodeID> barrier_nodes;
+    util::IdSet<NodeID> traffic_lights;
     std::vector<TurnRestriction> restrictions;
     std::vector<ConditionalTurnRestriction> conditional_restrictions;
     std::vector<NodeBasedEdgeAnnotation> annotations(1);
@@ -113,8 +113,8 @@ BOOST_AUTO_TEST_CASE(loop_test)
     //
     GraphCompressor compressor;
 
-    std::unordered_set<NodeID> barrier_nodes;
-    std::unordered_set<NodeID> traffic_lights;
+    util::IdSet<NodeID> barrier_nodes;
+    util::IdSet<NodeID> traffic_lights;
     std::vector<TurnRestriction> restrictions;
     std::vector<ConditionalTurnRestriction> conditional_restrictions;
     CompressedEdgeContainer container;
@@ -178,8 +178,8 @@ BOOST_AUTO_TEST_CASE(t_intersection)
     //
     GraphCompressor compressor;
 
-    std::unordered_set<NodeID> barrier_nodes;
-    std::unordered_set<NodeID> traffic_lights;
+    util::IdSet<NodeID> barrier_nodes;
+    util::IdSet<NodeID> traffic_lights;
     std::vector<NodeBasedEdgeAnnotation> annotations(1);
     std::vector<TurnRestriction> restrictions;
     std::vector<ConditionalTurnRestriction> conditional_restrictions;
@@ -223,8 +223,8 @@ BOOST_AUTO_TEST_CASE(street_name_changes)
     //
     GraphCompressor compressor;
 
-    std::unordered_set<NodeID> barrier_nodes;
-    std::unordered_set<NodeID> traffic_lights;
+    util::IdSet<NodeID> barrier_nodes;
+    util::IdSet<NodeID> traffic_lights;
     std::vector<NodeBasedEdgeAnnotation> annotations(2);
     std::vector<TurnRestriction> restrictions;
     std::vector<ConditionalTurnRestriction> conditional_restrictions;
@@ -263,8 +263,8 @@ BOOST_AUTO_TEST_CASE(direction_changes)
     //
     GraphCompressor compressor;
 
-    std::unordered_set<NodeID> barrier_nodes;
-    std::unordered_set<NodeID> traffic_lights;
+    util::IdSet<NodeID> barrier_nodes;
+    util::IdSet<NodeID> traffic_lights;
     std::vector<NodeBasedEdgeAnnotation> annotations(1);
     std::vector<TurnRestriction> restrictions;
     std::vector<ConditionalTurnRestriction> conditional_restrictions;
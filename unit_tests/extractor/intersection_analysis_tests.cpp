@@ -1,9 +1,11 @@
 #include "extractor/intersection/intersection_analysis.hpp"
+#include "extractor/intersection/intersection_geometry_cache.hpp"
 
 #include "extractor/graph_compressor.hpp"
 
 #include "../common/range_tools.hpp"
 #include "../unit_tests/mocks/mock_scripting_environment.hpp"
+#include "util/id_set.hpp"
 
 #include <boost/test/test_case_template.hpp>
 #include <boost/test/unit_test.hpp>
@@ -19,8 +21,8 @@ using Graph = util::NodeBasedDynamicGraph;
 
 BOOST_AUTO_TEST_CASE(simple_intersection_connectivity)
 {
-    std::unordered_set<NodeID> barrier_nodes{6};
-    std::unordered_set<NodeID> traffic_lights;
+    util::IdSet<NodeID> barrier_nodes{6};
+    util::IdSet<NodeID> traffic_lights;
     std::vector<NodeBasedEdgeAnnotation> annotations{
         {EMPTY_NAMEID, 0, INAVLID_CLASS_DATA, TRAVEL_MODE_DRIVING, false},
         {EMPTY_NAMEID, 1, INAVLID_CLASS_DATA, TRAVEL_MODE_DRIVING, false}};
@@ -152,8 +154,8 @@ BOOST_AUTO_TEST_CASE(simple_intersection_connectivity)
 
 BOOST_AUTO_TEST_CASE(roundabout_intersection_connectivity)
 {
-    std::unordered_set<NodeID> barrier_nodes;
-    std::unordered_set<NodeID> traffic_lights;
+    util::IdSet<NodeID> barrier_nodes;
+    util::IdSet<NodeID> traffic_lights;
     std::vector<NodeBasedEdgeAnnotation> annotations;
     std::vector<TurnRestriction> restrictions;
     std::vector<ConditionalTurnRestriction> conditional_restrictions;
@@ -258,8 +260,8 @@ BOOST_AUTO_TEST_CASE(roundabout_intersection_connectivity)
 
 BOOST_AUTO_TEST_CASE(skip_degree_two_nodes)
 {
-    std::unordered_set<NodeID> barrier_nodes{1};
-    std::unordered_set<NodeID> traffic_lights{2};
+    util::IdSet<NodeID> barrier_nodes{1};
+    util::IdSet<NodeID> traffic_lights{2};
     std::vector<NodeBasedEdgeAnnotation> annotations(1);
     std::vector<TurnRestriction> restrictions;
     std::vector<ConditionalTurnRestriction> conditional_restrictions;
@@ -318,4 +320,79 @@ BOOST_AUTO_TEST_CASE(skip_degree_two_nodes)
     BOOST_CHECK_EQUAL(graph.GetTarget(skipDegreeTwoNodes(graph, {7, 12}).edge), 7);
 }
 
+BOOST_AUTO_TEST_CASE(geometry_cache_matches_the_analysis)
+{
+    util::IdSet<NodeID> barrier_nodes;
+    std::vector<NodeBasedEdgeAnnotation> annotations(1);
+    std::vector<TurnRestriction> restrictions;
+    CompressedEdgeContainer container;
+    test::MockScriptingEnvironment scripting_environment;
+    TurnLanesIndexedArray turn_lanes_data;
+    NameTable name_table;
+    SuffixTable suffix_table(scripting_environment);
+
+    // Graph with the oneways 0→2 and 3→0 of a divided road and a short road to 5
+    //     4   2
+    //     ↕ ↗
+    // 1 ↔ 0 ↔ 5
+    //       ↖
+    //         3
+    const auto unit_edge = [](const NodeID from, const NodeID to, bool allowed) {
+        return InputEdge{
+            from, to, 1, 1, GeometryID{0, false}, !allowed, NodeBasedEdgeClassification{}, 0};
+    };
+    std::vector<InputEdge> edges = {unit_edge(0, 1, true),
+                                    unit_edge(0, 2, true),
+                                    unit_edge(0, 3, false),
+                                    unit_edge(0, 4, true),
+                                    unit_edge(0, 5, true),
+                                    unit_edge(1, 0, true),
+                                    unit_edge(2, 0, false),
+                                    unit_edge(3, 0, true),
+                                    unit_edge(4, 0, true),
+                                    unit_edge(5, 0, true)};
+    const std::vector<util::Coordinate> coordinates = {
+        {util::FloatLongitude{7.0}, util::FloatLatitude{43.0}},
+        {util::FloatLongitude{6.999}, util::FloatLatitude{43.0}},
+        {util::FloatLongitude{7.001}, util::FloatLatitude{43.0001}},
+        {util::FloatLongitude{7.001}, util::FloatLatitude{42.9999}},
+        {util::FloatLongitude{7.0}, util::FloatLatitude{43.001}},
+        {util::FloatLongitude{7.0001}, util::FloatLatitude{43.0}}};
+
+    Graph graph(6, edges);
+    EdgeBasedNodeDataContainer node_data_container(
+        std::vector<EdgeBasedNode>(graph.GetNumberOfEdges()), annotations);
+    RestrictionMap restriction_map(restrictions, IndexNodeByFromAndVia());
+    MergableRoadDetector detector(graph,
+                                  node_data_container,
+                                  coordinates,
+                                  container,
+                                  restriction_map,
+                                  barrier_nodes,
+                                  turn_lanes_data,
+                                  name_table,
+                                  suffix_table);
+
+    const IntersectionGeometryCache cache(graph, container, coordinates, detector);
+    for (NodeID node = 0; node < graph.GetNumberOfNodes(); ++node)
+    {
+        const auto expected =
+            getIntersectionGeometries(graph, container, coordinates, detector, node);
+        const auto cached = cache.Get(graph, node);
+
+        BOOST_REQUIRE_EQUAL(cached.first.size(), expected.first.size());
+        for (std::size_t index = 0; index < expected.first.size(); ++index)
+        {
+            BOOST_CHECK_EQUAL(cached.first[index].eid, expected.first[index].eid);
+            BOOST_CHECK_EQUAL(cached.first[index].initial_bearing,
+                              expected.first[index].initial_bearing);
+            BOOST_CHECK_EQUAL(cached.first[index].perceived_bearing,
+                              expected.first[index].perceived_bearing);
+            BOOST_CHECK_EQUAL(cached.first[index].segment_length,
+                              expected.first[index].segment_length);
+        }
+        BOOST_CHECK(cached.second == expected.second);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
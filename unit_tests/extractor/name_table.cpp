@@ -106,6 +106,44 @@ BOOST_AUTO_TEST_CASE(check_name_table_nofill)
     // CALLGRIND_STOP_INSTRUMENTATION;
 }
 
+BOOST_AUTO_TEST_CASE(check_name_table_references)
+{
+    const std::vector<std::string> strings = {
+        "Main Street", "Main Street", "",   "A1", "Long Destination",    // 0
+        "Side Street", "Side Street", "A1", "A1", "Long Destination",    // 5
+        "Main Street", "",            "",   "A1", "Other Destination",   // 10
+        "short",       "short",       "",   "",   std::string("\0x", 2) // 15
+    };
+
+    std::vector<unsigned char> name_char_data;
+    std::vector<std::uint32_t> name_offsets;
+    for (const auto &s : strings)
+    {
+        name_offsets.push_back(name_char_data.size());
+        std::copy(s.begin(), s.end(), std::back_inserter(name_char_data));
+    }
+    name_offsets.push_back(name_char_data.size());
+
+    NameTable name_table(name_offsets.begin(), name_offsets.end(), name_char_data.begin());
+    for (std::size_t index = 0; index < strings.size() / 5; ++index)
+    {
+        const NameID id = 5 * index;
+        BOOST_CHECK_EQUAL(name_table.GetNameForID(id), strings[id]);
+        BOOST_CHECK_EQUAL(name_table.GetDestinationsForID(id), strings[id + 1]);
+        BOOST_CHECK_EQUAL(name_table.GetPronunciationForID(id), strings[id + 2]);
+        BOOST_CHECK_EQUAL(name_table.GetRefForID(id), strings[id + 3]);
+        BOOST_CHECK_EQUAL(name_table.GetExitsForID(id), strings[id + 4]);
+    }
+
+    // Repeated strings point to the characters of their first occurrence
+    BOOST_CHECK_EQUAL(name_table.GetDestinationsForID(0).data(),
+                      name_table.GetNameForID(0).data());
+    BOOST_CHECK_EQUAL(name_table.GetNameForID(10).data(), name_table.GetNameForID(0).data());
+    BOOST_CHECK_EQUAL(name_table.GetExitsForID(5).data(), name_table.GetExitsForID(0).data());
+    // Strings that are not longer than a reference are stored again
+    BOOST_CHECK_NE(name_table.GetDestinationsForID(15).data(), name_table.GetNameForID(15).data());
+}
+
 BOOST_AUTO_TEST_CASE(check_invalid_ids)
 {
     NameTable name_table;
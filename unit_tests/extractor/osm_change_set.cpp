@@ -0,0 +1,89 @@
+#include "extractor/osm_change_set.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(osm_change_set)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+boost::filesystem::path writeChangeFile(const std::string &contents)
+{
+    const auto path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path("osrm-changes-%%%%%%%%.osc");
+    boost::filesystem::ofstream out(path);
+    out << "<?xml version='1.0' encoding='UTF-8'?>\n<osmChange version=\"0.6\">\n"
+        << contents << "</osmChange>\n";
+    return path;
+}
+
+std::vector<osmium::object_id_type> ids(const osmium::memory::Buffer &buffer)
+{
+    std::vector<osmium::object_id_type> result;
+    for (const auto &object : buffer.select<osmium::OSMObject>())
+    {
+        result.push_back(object.type() == osmium::item_type::way ? 1000 + object.id()
+                                                                 : object.id());
+    }
+    return result;
+}
+}
+
+BOOST_AUTO_TEST_CASE(apply_changes)
+{
+    using namespace osmium::builder::attr;
+
+    const auto first = writeChangeFile(
+        "<create><node id=\"2\" version=\"1\" lat=\"1\" lon=\"1\"/>"
+        "<node id=\"9\" version=\"1\" lat=\"1\" lon=\"1\"/></create>"
+        "<modify><node id=\"3\" version=\"2\" lat=\"2\" lon=\"2\"/></modify>"
+        "<delete><way id=\"5\" version=\"2\"/></delete>\n");
+    const auto second = writeChangeFile(
+        "<modify><node id=\"3\" version=\"3\" lat=\"3\" lon=\"3\"/></modify>"
+        "<create><way id=\"7\" version=\"1\"><nd ref=\"1\"/><nd ref=\"3\"/></way></create>\n");
+
+    OSMChangeSet changes({first, second});
+    BOOST_CHECK_EQUAL(changes.GetNumberOfChanges(), 5);
+
+    osmium::memory::Buffer input(1024, osmium::memory::Buffer::auto_grow::yes);
+    osmium::builder::add_node(input, _id(1), _location(0, 0));
+    osmium::builder::add_node(input, _id(3), _location(0, 0));
+    osmium::builder::add_way(input, _id(5), _nodes({1, 3}));
+    osmium::builder::add_way(input, _id(6), _nodes({1, 3}));
+
+    OSMChangeSet::Merger merger(changes,
+                                osmium::osm_entity_bits::node | osmium::osm_entity_bits::way);
+    const auto merged = merger.Apply(input);
+    BOOST_CHECK((ids(merged) == std::vector<osmium::object_id_type>{1, 2, 3, 9, 1006}));
+
+    // the node is modified by the last change file
+    auto iter = merged.select<osmium::Node>().begin();
+    std::advance(iter, 2);
+    BOOST_CHECK_EQUAL(iter->location().lat(), 3);
+
+    const auto rest = merger.Finish();
+    BOOST_CHECK((ids(rest) == std::vector<osmium::object_id_type>{1007}));
+    BOOST_CHECK_EQUAL(merger.Finish().committed(), 0);
+
+    // changes of other entities are not applied
+    OSMChangeSet::Merger way_merger(changes, osmium::osm_entity_bits::way);
+    osmium::memory::Buffer ways(1024, osmium::memory::Buffer::auto_grow::yes);
+    osmium::builder::add_way(ways, _id(6), _nodes({1, 3}));
+    BOOST_CHECK((ids(way_merger.Apply(ways)) == std::vector<osmium::object_id_type>{1006}));
+
+    boost::filesystem::remove(first);
+    boost::filesystem::remove(second);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
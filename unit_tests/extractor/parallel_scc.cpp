@@ -0,0 +1,90 @@
+#include "extractor/parallel_scc.hpp"
+#include "extractor/tarjan_scc.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(parallel_scc)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+using Graph = util::StaticGraph<void>;
+using Edge = util::static_graph_details::SortableEdgeWithData<void>;
+
+Graph makeGraph(const NodeID number_of_nodes, std::vector<Edge> edges)
+{
+    std::sort(edges.begin(), edges.end());
+    return Graph(number_of_nodes, edges);
+}
+}
+
+BOOST_AUTO_TEST_CASE(small_components)
+{
+    //   0 <-> 1 -> 2 <-> 3 -> 4    5 -> 6 -> 7 -> 5    8 -> 8
+    const auto graph = makeGraph(
+        9, {{0, 1}, {1, 0}, {1, 2}, {2, 3}, {3, 2}, {3, 4}, {5, 6}, {6, 7}, {7, 5}, {8, 8}});
+
+    ParallelSCC<Graph> scc(graph);
+    scc.Run();
+
+    // the components are numbered by their smallest node
+    const std::vector<unsigned> component_ids = {0, 0, 1, 1, 2, 3, 3, 3, 4};
+    for (const auto node : util::irange<NodeID>(0, 9))
+    {
+        BOOST_CHECK_EQUAL(scc.GetComponentID(node), component_ids[node]);
+    }
+
+    BOOST_CHECK_EQUAL(scc.GetNumberOfComponents(), 5);
+    BOOST_CHECK_EQUAL(scc.GetSizeOneCount(), 2);
+    BOOST_CHECK_EQUAL(scc.GetComponentSize(0), 2);
+    BOOST_CHECK_EQUAL(scc.GetComponentSize(1), 2);
+    BOOST_CHECK_EQUAL(scc.GetComponentSize(2), 1);
+    BOOST_CHECK_EQUAL(scc.GetComponentSize(3), 3);
+    BOOST_CHECK_EQUAL(scc.GetComponentSize(4), 1);
+}
+
+BOOST_AUTO_TEST_CASE(same_components_as_tarjan)
+{
+    std::mt19937 generator(42);
+    const NodeID number_of_nodes = 5000;
+    std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+
+    for (const auto number_of_edges : {2000, 5000, 10000, 20000})
+    {
+        std::vector<Edge> edges;
+        for (int index = 0; index < number_of_edges; ++index)
+        {
+            edges.push_back({node(generator), node(generator)});
+        }
+        const auto graph = makeGraph(number_of_nodes, edges);
+
+        TarjanSCC<Graph> tarjan(graph);
+        tarjan.Run();
+        ParallelSCC<Graph> scc(graph);
+        scc.Run();
+
+        BOOST_CHECK_EQUAL(scc.GetNumberOfComponents(), tarjan.GetNumberOfComponents());
+        BOOST_CHECK_EQUAL(scc.GetSizeOneCount(), tarjan.GetSizeOneCount());
+
+        // both find the same partition of the nodes
+        std::map<unsigned, unsigned> tarjan_to_parallel;
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            const auto inserted =
+                tarjan_to_parallel.emplace(tarjan.GetComponentID(node), scc.GetComponentID(node));
+            BOOST_CHECK_EQUAL(inserted.first->second, scc.GetComponentID(node));
+            BOOST_CHECK_EQUAL(tarjan.GetComponentSize(tarjan.GetComponentID(node)),
+                              scc.GetComponentSize(scc.GetComponentID(node)));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,8 +5,12 @@
 #include <osrm/coordinate.hpp>
 
 #include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <cstdint>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(raster_source)
 
 using namespace osrm;
@@ -79,4 +83,74 @@ BOOST_AUTO_TEST_CASE(raster_test)
         util::exception);
 }
 
+// Writes the values of raster_data.asc as a binary raster file
+template <typename ValueT>
+boost::filesystem::path writeBinaryRaster(const std::uint64_t columns, const std::uint64_t rows)
+{
+    std::vector<ValueT> values;
+    boost::filesystem::ifstream ascii(OSRM_FIXTURES_DIR "/raster_data.asc");
+    for (int value; ascii >> value;)
+    {
+        values.push_back(static_cast<ValueT>(value));
+    }
+    BOOST_REQUIRE_EQUAL(values.size(), 100);
+
+    const auto path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path("raster-%%%%-%%%%.bin");
+    boost::filesystem::ofstream binary(path, std::ios::binary);
+    const std::uint32_t version = RasterGrid::BINARY_VERSION;
+    const std::uint32_t value_size = sizeof(ValueT);
+    binary.write(RasterGrid::BINARY_MAGIC, sizeof(RasterGrid::BINARY_MAGIC) - 1);
+    binary.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    binary.write(reinterpret_cast<const char *>(&value_size), sizeof(value_size));
+    binary.write(reinterpret_cast<const char *>(&columns), sizeof(columns));
+    binary.write(reinterpret_cast<const char *>(&rows), sizeof(rows));
+    binary.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(ValueT));
+    return path;
+}
+
+template <typename ValueT> void checkBinaryRaster()
+{
+    const auto path = writeBinaryRaster<ValueT>(10, 10);
+
+    RasterContainer sources;
+    BOOST_CHECK_EQUAL(sources.LoadRasterSource(path.string(), 1, 1.09, 1, 1.09, 10, 10), 0);
+
+    CHECK_QUERY(0, 1.00, 1.00, 10);
+    CHECK_QUERY(0, 1.09, 1.00, 40);
+    CHECK_QUERY(0, 1.09, 1.07, 140);
+    CHECK_QUERY(0, 1.08, 1.05, 160);
+    CHECK_QUERY(0, 1.056, 1.028, 80);
+    CHECK_QUERY(0, -1.1, 1.07, RasterDatum::get_invalid());
+
+    CHECK_INTERPOLATE(0, 1.09, 1.09, 100);
+    CHECK_INTERPOLATE(0, 1.054, 1.023, 54);
+    CHECK_INTERPOLATE(0, 1.056, 1.028, 68);
+    CHECK_INTERPOLATE(0, 1.05, 1.028, 56);
+
+    // the dimensions need to match the header
+    RasterContainer other_sources;
+    BOOST_CHECK_THROW(other_sources.LoadRasterSource(path.string(), 1, 1.09, 1, 1.09, 5, 20),
+                      util::exception);
+
+    boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(binary_raster_test)
+{
+    checkBinaryRaster<std::int16_t>();
+    checkBinaryRaster<std::int32_t>();
+}
+
+BOOST_AUTO_TEST_CASE(truncated_binary_raster_test)
+{
+    const auto path = writeBinaryRaster<std::int16_t>(10, 11);
+
+    RasterContainer sources;
+    BOOST_CHECK_THROW(sources.LoadRasterSource(path.string(), 1, 1.09, 1, 1.09, 11, 10),
+                      util::exception);
+
+    boost::filesystem::remove(path);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,66 @@
+#include "extractor/restriction_filter.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(restriction_filter)
+
+using namespace osrm;
+using namespace osrm::extractor;
+using InputEdge = util::NodeBasedDynamicGraph::InputEdge;
+using Graph = util::NodeBasedDynamicGraph;
+
+BOOST_AUTO_TEST_CASE(invalid_restrictions_are_removed_in_order)
+{
+    // 0 ↔ 1 ↔ 2 ↔ 3, 1 → 4
+    const auto unit_edge = [](const NodeID from, const NodeID to, bool allowed) {
+        return InputEdge{from,
+                         to,
+                         1,
+                         1,
+                         GeometryID{0, false},
+                         !allowed,
+                         NodeBasedEdgeClassification(),
+                         0};
+    };
+    std::vector<InputEdge> edges = {unit_edge(0, 1, true),
+                                    unit_edge(1, 0, true),
+                                    unit_edge(1, 2, true),
+                                    unit_edge(1, 4, true),
+                                    unit_edge(2, 1, true),
+                                    unit_edge(2, 3, true),
+                                    unit_edge(3, 2, true),
+                                    unit_edge(4, 1, false)};
+    Graph graph(5, edges);
+
+    const auto node_restriction = [](const NodeID from, const NodeID via, const NodeID to) {
+        ConditionalTurnRestriction restriction;
+        restriction.node_or_way = NodeRestriction{from, via, to};
+        return restriction;
+    };
+    const auto way_restriction = [](const NodeRestriction in, const NodeRestriction out) {
+        ConditionalTurnRestriction restriction;
+        restriction.node_or_way = WayRestriction{in, out};
+        return restriction;
+    };
+
+    std::vector<ConditionalTurnRestriction> restrictions{
+        node_restriction(0, 1, 2),
+        node_restriction(0, 1, 3), // 3 is not adjacent to 1
+        node_restriction(4, 1, 2),
+        way_restriction({0, 1, 2}, {1, 2, 3}),
+        way_restriction({0, 1, 2}, {2, 3, 2}), // not connected to the in restriction
+        node_restriction(2, 3, 1),             // 1 is not adjacent to 3
+        node_restriction(3, 2, 1)};
+
+    const auto valid = removeInvalidRestrictions(restrictions, graph);
+
+    BOOST_REQUIRE_EQUAL(valid.size(), 4);
+    BOOST_CHECK_EQUAL(valid[0].AsNodeRestriction().to, 2);
+    BOOST_CHECK_EQUAL(valid[1].AsNodeRestriction().from, 4);
+    BOOST_CHECK(valid[2].Type() == RestrictionType::WAY_RESTRICTION);
+    BOOST_CHECK_EQUAL(valid[3].AsNodeRestriction().from, 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
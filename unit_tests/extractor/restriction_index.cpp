@@ -0,0 +1,42 @@
+#include "extractor/restriction_index.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(restriction_index)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+BOOST_AUTO_TEST_CASE(restrictions_by_from_and_via)
+{
+    std::vector<TurnRestriction> restrictions{TurnRestriction{NodeRestriction{3, 1, 4}},
+                                              TurnRestriction{NodeRestriction{0, 1, 2}},
+                                              TurnRestriction{NodeRestriction{3, 2, 0}, true},
+                                              TurnRestriction{NodeRestriction{0, 1, 5}},
+                                              TurnRestriction{NodeRestriction{7, 1, 0}}};
+    RestrictionMap restriction_map(restrictions, IndexNodeByFromAndVia());
+
+    BOOST_CHECK_EQUAL(restriction_map.Size(), 5);
+    BOOST_CHECK(restriction_map.IsIndexed(0, 1));
+    BOOST_CHECK(restriction_map.IsIndexed(3, 2));
+    BOOST_CHECK(!restriction_map.IsIndexed(1, 0));
+    BOOST_CHECK(!restriction_map.IsIndexed(3, 3));
+    BOOST_CHECK(!restriction_map.IsIndexed(8, 1));
+
+    // restrictions of the same turn keep their order
+    const auto range = restriction_map.Restrictions(0, 1);
+    BOOST_REQUIRE_EQUAL(std::distance(range.first, range.second), 2);
+    BOOST_CHECK_EQUAL(range.first->second, &restrictions[1]);
+    BOOST_CHECK_EQUAL(std::next(range.first)->second, &restrictions[3]);
+
+    BOOST_CHECK(isRestricted(0, 1, 5, restriction_map).first);
+    BOOST_CHECK(!isRestricted(0, 1, 4, restriction_map).first);
+    BOOST_CHECK(isRestricted(3, 2, 1, restriction_map).first);
+    BOOST_CHECK_EQUAL(isRestricted(3, 2, 1, restriction_map).second, &restrictions[2]);
+    BOOST_CHECK(!isRestricted(3, 2, 0, restriction_map).first);
+    BOOST_CHECK(!isRestricted(4, 1, 3, restriction_map).first);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
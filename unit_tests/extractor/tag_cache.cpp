@@ -0,0 +1,83 @@
+#include "extractor/tag_cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(tag_cache)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+osmium::memory::Buffer makeBuffer()
+{
+    using namespace osmium::builder::attr;
+    osmium::memory::Buffer buffer(1024, osmium::memory::Buffer::auto_grow::yes);
+    osmium::builder::add_way(buffer, _id(1), _tag("highway", "primary"), _tag("maxspeed", "50"));
+    osmium::builder::add_way(buffer, _id(2), _tag("highway", "service"), _tag("access", "no"));
+    osmium::builder::add_node(buffer, _id(3), _tag("highway", "traffic_signals"));
+    return buffer;
+}
+}
+
+BOOST_AUTO_TEST_CASE(get_values_of_objects)
+{
+    const auto buffer = makeBuffer();
+    auto iter = buffer.select<osmium::OSMObject>().begin();
+    const auto &first = *iter++;
+    const auto &second = *iter++;
+    const auto &third = *iter++;
+
+    TagCache cache;
+    BOOST_CHECK_EQUAL(std::string(cache.Get(first, "highway")), "primary");
+    BOOST_CHECK_EQUAL(std::string(cache.Get(first, "maxspeed")), "50");
+    BOOST_CHECK(cache.Get(first, "access") == nullptr);
+
+    // the keys are known now and are read with the tags of the next objects
+    BOOST_CHECK_EQUAL(std::string(cache.Get(second, "highway")), "service");
+    BOOST_CHECK(cache.Get(second, "maxspeed") == nullptr);
+    BOOST_CHECK_EQUAL(std::string(cache.Get(second, "access")), "no");
+    BOOST_CHECK_EQUAL(std::string(cache.Get(third, "highway")), "traffic_signals");
+    BOOST_CHECK(cache.Get(third, "access") == nullptr);
+
+    // a key interned while an object is cached is looked up for that object
+    BOOST_CHECK(cache.Get(third, "name") == nullptr);
+    BOOST_CHECK_EQUAL(std::string(cache.Get(first, "highway")), "primary");
+    BOOST_CHECK_EQUAL(cache.GetNumberOfKeys(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(intern_keys)
+{
+    TagCache cache;
+    const auto highway = cache.Intern("highway");
+    const auto access = cache.Intern("access");
+    BOOST_CHECK_NE(highway, access);
+    BOOST_CHECK_EQUAL(cache.Intern(std::string("highway").c_str()), highway);
+    BOOST_CHECK_EQUAL(cache.GetNumberOfKeys(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(reset_rereads_object)
+{
+    using namespace osmium::builder::attr;
+
+    TagCache cache;
+    osmium::memory::Buffer buffer(1024, osmium::memory::Buffer::auto_grow::yes);
+    osmium::builder::add_way(buffer, _id(1), _tag("highway", "primary"));
+    BOOST_CHECK_EQUAL(std::string(cache.Get(buffer.get<osmium::Way>(0), "highway")), "primary");
+
+    // a new object at the same address is only seen after a reset
+    buffer.clear();
+    osmium::builder::add_way(buffer, _id(2), _tag("highway", "residential"));
+    cache.Reset();
+    BOOST_CHECK_EQUAL(std::string(cache.Get(buffer.get<osmium::Way>(0), "highway")),
+                      "residential");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,85 @@
+#include "extractor/way_result_cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(way_result_cache)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+BOOST_AUTO_TEST_CASE(reuse_results_by_relevant_tags)
+{
+    using namespace osmium::builder::attr;
+    osmium::memory::Buffer buffer(1024, osmium::memory::Buffer::auto_grow::yes);
+    osmium::builder::add_way(buffer, _id(1), _tag("highway", "primary"), _tag("name", "A"));
+    osmium::builder::add_way(buffer, _id(2), _tag("name", "B"), _tag("highway", "primary"));
+    osmium::builder::add_way(buffer, _id(3), _tag("highway", "primary"), _tag("oneway", "yes"));
+    osmium::builder::add_way(buffer, _id(4), _tag("oneway", "yes"), _tag("highway", "primary"));
+
+    auto iter = buffer.select<osmium::Way>().begin();
+    const auto &first = *iter++;
+    const auto &second = *iter++;
+    const auto &third = *iter++;
+    const auto &fourth = *iter++;
+
+    WayResultCache cache({"oneway", "highway", "oneway"});
+    BOOST_CHECK(cache.IsEnabled());
+
+    BOOST_CHECK(cache.Find(first) == nullptr);
+    ExtractionWay result;
+    result.forward_speed = 50;
+    cache.Insert(result);
+
+    // the name is not relevant, the ways share the result
+    const auto cached = cache.Find(second);
+    BOOST_REQUIRE(cached != nullptr);
+    BOOST_CHECK_EQUAL(cached->forward_speed, 50);
+
+    BOOST_CHECK(cache.Find(third) == nullptr);
+    result.backward_speed = 0;
+    cache.Insert(result);
+
+    // the order of the tags does not matter
+    BOOST_REQUIRE(cache.Find(fourth) != nullptr);
+    BOOST_CHECK_EQUAL(cache.Find(fourth)->backward_speed, 0);
+
+    BOOST_CHECK_EQUAL(cache.GetNumberOfEntries(), 2);
+    BOOST_CHECK_EQUAL(cache.GetNumberOfHits(), 3);
+    BOOST_CHECK_EQUAL(cache.GetNumberOfMisses(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(bounded_number_of_entries)
+{
+    using namespace osmium::builder::attr;
+    osmium::memory::Buffer buffer(1024, osmium::memory::Buffer::auto_grow::yes);
+    osmium::builder::add_way(buffer, _id(1), _tag("highway", "primary"));
+    osmium::builder::add_way(buffer, _id(2), _tag("highway", "secondary"));
+
+    auto iter = buffer.select<osmium::Way>().begin();
+    const auto &first = *iter++;
+    const auto &second = *iter++;
+
+    WayResultCache cache({"highway"}, 1);
+    BOOST_CHECK(cache.Find(first) == nullptr);
+    cache.Insert(ExtractionWay());
+    BOOST_CHECK(cache.Find(second) == nullptr);
+    cache.Insert(ExtractionWay());
+
+    BOOST_CHECK_EQUAL(cache.GetNumberOfEntries(), 1);
+    BOOST_CHECK(cache.Find(first) != nullptr);
+    BOOST_CHECK(cache.Find(second) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(disabled_without_keys)
+{
+    WayResultCache cache;
+    BOOST_CHECK(!cache.IsEnabled());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "coordinates.hpp"
+#include "fixture.hpp"
+
+#include "osrm/batch_parameters.hpp"
+#include "osrm/route_parameters.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+
+BOOST_AUTO_TEST_SUITE(batch)
+
+namespace
+{
+// every pair has the summary of the route query between its coordinates
+void checkRoutesOfPairs(const osrm::OSRM &osrm, const osrm::BatchParameters &params)
+{
+    using namespace osrm;
+
+    json::Object result;
+    const auto rc = osrm.Batch(params, result);
+    BOOST_REQUIRE(rc == Status::Ok);
+
+    const auto code = result.values.at("code").get<json::String>().value;
+    BOOST_CHECK_EQUAL(code, "Ok");
+
+    const auto pairs = params.GetPairs();
+    const auto &durations = result.values.at("durations").get<json::Array>().values;
+    const auto &distances = result.values.at("distances").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(durations.size(), pairs.size());
+    BOOST_REQUIRE_EQUAL(distances.size(), pairs.size());
+
+    const bool has_geometries = params.overview != RouteParameters::OverviewType::False;
+    BOOST_CHECK_EQUAL(result.values.count("geometries"), has_geometries ? 1 : 0);
+
+    for (std::size_t index = 0; index < pairs.size(); ++index)
+    {
+        RouteParameters route_params;
+        route_params.coordinates = {params.coordinates[pairs[index].first],
+                                    params.coordinates[pairs[index].second]};
+        route_params.overview = params.overview;
+
+        json::Object route_result;
+        BOOST_REQUIRE(osrm.Route(route_params, route_result) == Status::Ok);
+        const auto &route =
+            route_result.values.at("routes").get<json::Array>().values.at(0).get<json::Object>();
+
+        BOOST_CHECK_EQUAL(durations[index].get<json::Number>().value,
+                          route.values.at("duration").get<json::Number>().value);
+        BOOST_CHECK_EQUAL(distances[index].get<json::Number>().value,
+                          route.values.at("distance").get<json::Number>().value);
+        if (has_geometries)
+        {
+            const auto &geometries = result.values.at("geometries").get<json::Array>().values;
+            BOOST_REQUIRE_EQUAL(geometries.size(), pairs.size());
+            BOOST_CHECK_EQUAL(geometries[index].get<json::String>().value,
+                              route.values.at("geometry").get<json::String>().value);
+        }
+    }
+}
+
+osrm::BatchParameters getPairsInBigComponent()
+{
+    const auto locations = get_locations_in_big_component();
+
+    osrm::BatchParameters params;
+    params.coordinates = {locations.at(0), locations.at(1), locations.at(2)};
+    params.pairs = {{0, 1}, {1, 2}, {2, 0}, {1, 1}};
+    params.overview = osrm::RouteParameters::OverviewType::Full;
+    return params;
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_routes_of_pairs)
+{
+    checkRoutesOfPairs(getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm"), getPairsInBigComponent());
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_routes_of_pairs_mld)
+{
+    checkRoutesOfPairs(
+        getOSRM(OSRM_TEST_DATA_DIR "/mld/monaco.osrm", osrm::EngineConfig::Algorithm::MLD),
+        getPairsInBigComponent());
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_routes_on_threads)
+{
+    osrm::EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.batch_threads = 2;
+
+    checkRoutesOfPairs(osrm::OSRM{config}, getPairsInBigComponent());
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_consecutive_pairs_in_components)
+{
+    using namespace osrm;
+
+    const auto small_component = get_locations_in_small_component();
+    const auto big_component = get_locations_in_big_component();
+
+    // the first pair stays in the small component, the second is snapped like a route query
+    BatchParameters params;
+    params.coordinates = {
+        small_component.at(0), small_component.at(1), small_component.at(2), big_component.at(0)};
+
+    checkRoutesOfPairs(getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm"), params);
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_too_many_pairs)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_pairs_batch = 2;
+
+    OSRM osrm{config};
+    json::Object result;
+    BOOST_CHECK(osrm.Batch(getPairsInBigComponent(), result) == Status::Error);
+    BOOST_CHECK_EQUAL(result.values.at("code").get<json::String>().value, "TooBig");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
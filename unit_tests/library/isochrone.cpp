@@ -0,0 +1,92 @@
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "coordinates.hpp"
+#include "fixture.hpp"
+
+#include "osrm/isochrone_parameters.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+
+BOOST_AUTO_TEST_SUITE(isochrone)
+
+namespace
+{
+void checkIsochrone(const osrm::OSRM &osrm)
+{
+    using namespace osrm;
+
+    IsochroneParameters params;
+    params.coordinates.push_back(get_dummy_location());
+    params.max_duration = 120;
+
+    json::Object result;
+    const auto rc = osrm.Isochrone(params, result);
+    BOOST_REQUIRE(rc == Status::Ok);
+    BOOST_CHECK_EQUAL(result.values.at("code").get<json::String>().value, "Ok");
+    BOOST_CHECK_EQUAL(result.values.at("waypoints").get<json::Array>().values.size(), 1);
+
+    const auto &locations = result.values.at("locations").get<json::Array>().values;
+    const auto &durations = result.values.at("durations").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(locations.size(), durations.size());
+    BOOST_REQUIRE(!locations.empty());
+
+    double last_duration = 0;
+    for (const auto &duration : durations)
+    {
+        const auto value = duration.get<json::Number>().value;
+        BOOST_CHECK_GE(value, last_duration);
+        BOOST_CHECK_LE(value, params.max_duration);
+        last_duration = value;
+    }
+
+    const auto &polygon = result.values.at("polygon").get<json::Object>().values;
+    BOOST_CHECK_EQUAL(polygon.at("type").get<json::String>().value, "Polygon");
+    const auto &rings = polygon.at("coordinates").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(rings.size(), 1);
+    const auto &ring = rings.front().get<json::Array>().values;
+    BOOST_REQUIRE_GE(ring.size(), 4);
+    BOOST_CHECK_LE(ring.size(), locations.size() + 2);
+    for (const auto index : {0, 1})
+    {
+        BOOST_CHECK_EQUAL(ring.front().get<json::Array>().values[index].get<json::Number>().value,
+                          ring.back().get<json::Array>().values[index].get<json::Number>().value);
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_isochrone_locations_within_duration)
+{
+    checkIsochrone(getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm"));
+}
+
+BOOST_AUTO_TEST_CASE(test_isochrone_locations_within_duration_mld)
+{
+    checkIsochrone(
+        getOSRM(OSRM_TEST_DATA_DIR "/mld/monaco.osrm", osrm::EngineConfig::Algorithm::MLD));
+}
+
+BOOST_AUTO_TEST_CASE(test_isochrone_too_long)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_duration_isochrone = 60;
+
+    OSRM osrm{config};
+    IsochroneParameters params;
+    params.coordinates.push_back(get_dummy_location());
+    params.max_duration = 120;
+
+    json::Object result;
+    BOOST_CHECK(osrm.Isochrone(params, result) == Status::Error);
+    BOOST_CHECK_EQUAL(result.values.at("code").get<json::String>().value, "TooBig");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -116,4 +116,50 @@ BOOST_AUTO_TEST_CASE(test_match_split)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_match_native_result_matches_json)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    MatchParameters params;
+    params.coordinates = get_split_trace_locations();
+    params.timestamps = {1, 2, 1700, 1800};
+
+    json::Object json_result;
+    BOOST_CHECK(osrm.Match(params, json_result) == Status::Ok);
+
+    engine::api::ResultT result = engine::api::native::MatchResult();
+    BOOST_CHECK(osrm.Match(params, result) == Status::Ok);
+    BOOST_REQUIRE(result.is<engine::api::native::MatchResult>());
+    const auto &native_result = result.get<engine::api::native::MatchResult>();
+
+    const auto &tracepoints = json_result.values.at("tracepoints").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(native_result.tracepoints.size(), tracepoints.size());
+    for (std::size_t index = 0; index < tracepoints.size(); ++index)
+    {
+        const auto &native_tracepoint = native_result.tracepoints[index];
+        BOOST_CHECK_EQUAL(native_tracepoint.matched, !tracepoints[index].is<json::Null>());
+        if (!native_tracepoint.matched)
+            continue;
+
+        const auto &tracepoint = tracepoints[index].get<json::Object>().values;
+        BOOST_CHECK_EQUAL(native_tracepoint.matchings_index,
+                          tracepoint.at("matchings_index").get<json::Number>().value);
+        BOOST_CHECK_EQUAL(native_tracepoint.waypoint_index,
+                          tracepoint.at("waypoint_index").get<json::Number>().value);
+    }
+
+    const auto &matchings = json_result.values.at("matchings").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(native_result.matchings.size(), matchings.size());
+    for (std::size_t index = 0; index < matchings.size(); ++index)
+    {
+        const auto &matching = matchings[index].get<json::Object>().values;
+        BOOST_CHECK_EQUAL(native_result.matchings[index].confidence,
+                          matching.at("confidence").get<json::Number>().value);
+        BOOST_CHECK_EQUAL(native_result.matchings[index].route.duration,
+                          matching.at("duration").get<json::Number>().value);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
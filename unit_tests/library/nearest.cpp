@@ -66,6 +66,7 @@ BOOST_AUTO_TEST_CASE(test_nearest_response_multiple_coordinates)
     NearestParameters params;
     params.coordinates.push_back(get_dummy_location());
     params.coordinates.push_back(get_dummy_location());
+    params.number_of_results = 2;
 
     json::Object result;
     const auto rc = osrm.Nearest(params, result);
@@ -113,4 +114,72 @@ BOOST_AUTO_TEST_CASE(test_nearest_response_for_location_in_small_component)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_nearest_response_hints_for_multiple_coordinates)
+{
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    using namespace osrm;
+
+    NearestParameters params;
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_locations_in_small_component().at(0));
+    params.coordinates.push_back(get_dummy_location());
+
+    json::Object result;
+    const auto rc = osrm.Nearest(params, result);
+    BOOST_REQUIRE(rc == Status::Ok);
+
+    const auto &waypoints = result.values.at("waypoints").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(waypoints.size(), params.coordinates.size());
+
+    // one waypoint for each coordinate in the order of the coordinates
+    for (const auto index : {0, 1, 2})
+    {
+        NearestParameters single_params;
+        single_params.coordinates.push_back(params.coordinates[index]);
+
+        json::Object single_result;
+        BOOST_REQUIRE(osrm.Nearest(single_params, single_result) == Status::Ok);
+        const auto &single_waypoints =
+            single_result.values.at("waypoints").get<json::Array>().values;
+        BOOST_REQUIRE_EQUAL(single_waypoints.size(), 1);
+
+        const auto &waypoint = waypoints[index].get<json::Object>();
+        const auto &single_waypoint = single_waypoints.front().get<json::Object>();
+        BOOST_CHECK_EQUAL(waypoint.values.at("hint").get<json::String>().value,
+                          single_waypoint.values.at("hint").get<json::String>().value);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_nearest_response_uses_hint_for_snapped_location)
+{
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    using namespace osrm;
+
+    NearestParameters params;
+    params.coordinates.push_back(get_dummy_location());
+
+    json::Object result;
+    BOOST_REQUIRE(osrm.Nearest(params, result) == Status::Ok);
+    const auto &waypoint =
+        result.values.at("waypoints").get<json::Array>().values.front().get<json::Object>();
+    const auto hint =
+        engine::Hint::FromBase64(waypoint.values.at("hint").get<json::String>().value);
+
+    // a client sends back the snapped location together with the hint, which is used as is
+    // instead of snapping the location again
+    NearestParameters hinted_params;
+    hinted_params.coordinates.push_back(hint.phantom.location);
+    hinted_params.hints.push_back(hint);
+
+    json::Object hinted_result;
+    BOOST_REQUIRE(osrm.Nearest(hinted_params, hinted_result) == Status::Ok);
+    const auto &hinted_waypoint =
+        hinted_result.values.at("waypoints").get<json::Array>().values.front().get<json::Object>();
+    BOOST_CHECK_EQUAL(hinted_waypoint.values.at("hint").get<json::String>().value,
+                      hint.ToBase64());
+    BOOST_CHECK_EQUAL(hinted_waypoint.values.at("distance").get<json::Number>().value, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -325,6 +325,121 @@ BOOST_AUTO_TEST_CASE(test_route_response_for_locations_in_big_component)
     }
 }
 
+namespace
+{
+// routes through waypoints whose legs are searched on threads match the routes searched leg by leg
+void checkRoutesWithLegsOnThreads(const std::string &base_path,
+                                  const osrm::EngineConfig::Algorithm algorithm)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {base_path};
+    config.use_shared_memory = false;
+    config.algorithm = algorithm;
+    const OSRM sequential_osrm{config};
+    config.route_threads = 2;
+    const OSRM parallel_osrm{config};
+
+    const auto locations = get_locations_in_big_component();
+    for (const bool continue_straight : {false, true})
+    {
+        RouteParameters params;
+        params.coordinates = {
+            locations.at(0), locations.at(1), locations.at(2), locations.at(1), locations.at(0)};
+        params.continue_straight = continue_straight;
+
+        json::Object sequential_result;
+        BOOST_REQUIRE(sequential_osrm.Route(params, sequential_result) == Status::Ok);
+        json::Object parallel_result;
+        BOOST_REQUIRE(parallel_osrm.Route(params, parallel_result) == Status::Ok);
+
+        const auto &sequential_route = sequential_result.values.at("routes")
+                                           .get<json::Array>()
+                                           .values.at(0)
+                                           .get<json::Object>()
+                                           .values;
+        const auto &parallel_route = parallel_result.values.at("routes")
+                                         .get<json::Array>()
+                                         .values.at(0)
+                                         .get<json::Object>()
+                                         .values;
+        BOOST_CHECK_EQUAL(parallel_route.at("weight").get<json::Number>().value,
+                          sequential_route.at("weight").get<json::Number>().value);
+        BOOST_CHECK_EQUAL(parallel_route.at("duration").get<json::Number>().value,
+                          sequential_route.at("duration").get<json::Number>().value);
+        BOOST_CHECK_EQUAL(parallel_route.at("legs").get<json::Array>().values.size(),
+                          params.coordinates.size() - 1);
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_route_legs_on_threads)
+{
+    checkRoutesWithLegsOnThreads(OSRM_TEST_DATA_DIR "/ch/monaco.osrm",
+                                 osrm::EngineConfig::Algorithm::CH);
+}
+
+BOOST_AUTO_TEST_CASE(test_route_legs_on_threads_mld)
+{
+    checkRoutesWithLegsOnThreads(OSRM_TEST_DATA_DIR "/mld/monaco.osrm",
+                                 osrm::EngineConfig::Algorithm::MLD);
+}
+
+namespace
+{
+// without time for alternatives the shortest route is still returned, but no alternatives
+void checkRoutesWithoutAlternativeTime(const std::string &base_path,
+                                       const osrm::EngineConfig::Algorithm algorithm)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {base_path};
+    config.use_shared_memory = false;
+    config.algorithm = algorithm;
+    const OSRM unbounded_osrm{config};
+    config.max_alternative_time = 0;
+    const OSRM bounded_osrm{config};
+
+    const auto locations = get_locations_in_big_component();
+    RouteParameters params;
+    params.coordinates = {locations.at(0), locations.at(2)};
+    params.alternatives = true;
+    params.number_of_alternatives = 2;
+
+    json::Object unbounded_result;
+    BOOST_REQUIRE(unbounded_osrm.Route(params, unbounded_result) == Status::Ok);
+    json::Object bounded_result;
+    BOOST_REQUIRE(bounded_osrm.Route(params, bounded_result) == Status::Ok);
+
+    const auto &bounded_routes = bounded_result.values.at("routes").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(bounded_routes.size(), 1);
+    const auto &bounded_route = bounded_routes.at(0).get<json::Object>().values;
+    const auto &unbounded_route = unbounded_result.values.at("routes")
+                                      .get<json::Array>()
+                                      .values.at(0)
+                                      .get<json::Object>()
+                                      .values;
+    BOOST_CHECK_EQUAL(bounded_route.at("weight").get<json::Number>().value,
+                      unbounded_route.at("weight").get<json::Number>().value);
+    BOOST_CHECK_EQUAL(bounded_route.at("distance").get<json::Number>().value,
+                      unbounded_route.at("distance").get<json::Number>().value);
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_route_without_alternative_time)
+{
+    checkRoutesWithoutAlternativeTime(OSRM_TEST_DATA_DIR "/ch/monaco.osrm",
+                                      osrm::EngineConfig::Algorithm::CH);
+}
+
+BOOST_AUTO_TEST_CASE(test_route_without_alternative_time_mld)
+{
+    checkRoutesWithoutAlternativeTime(OSRM_TEST_DATA_DIR "/mld/monaco.osrm",
+                                      osrm::EngineConfig::Algorithm::MLD);
+}
+
 BOOST_AUTO_TEST_CASE(test_route_response_for_locations_across_components)
 {
     auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
@@ -456,4 +571,55 @@ BOOST_AUTO_TEST_CASE(test_manual_setting_of_annotations_property)
     BOOST_CHECK_EQUAL(annotations.size(), 6);
 }
 
+BOOST_AUTO_TEST_CASE(test_route_native_result_matches_json)
+{
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    using namespace osrm;
+
+    RouteParameters params;
+    params.overview = RouteParameters::OverviewType::Full;
+    params.coordinates = get_locations_in_big_component();
+
+    json::Object json_result;
+    BOOST_CHECK(osrm.Route(params, json_result) == Status::Ok);
+
+    engine::api::ResultT result = engine::api::native::RouteResult();
+    BOOST_CHECK(osrm.Route(params, result) == Status::Ok);
+    BOOST_REQUIRE(result.is<engine::api::native::RouteResult>());
+    const auto &native_result = result.get<engine::api::native::RouteResult>();
+
+    const auto &waypoints = json_result.values.at("waypoints").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(native_result.waypoints.size(), waypoints.size());
+    for (std::size_t index = 0; index < waypoints.size(); ++index)
+    {
+        const auto &waypoint = waypoints[index].get<json::Object>().values;
+        BOOST_CHECK_EQUAL(native_result.waypoints[index].name,
+                          waypoint.at("name").get<json::String>().value);
+        BOOST_CHECK_EQUAL(native_result.waypoints[index].hint,
+                          waypoint.at("hint").get<json::String>().value);
+    }
+
+    const auto &routes = json_result.values.at("routes").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(native_result.routes.size(), routes.size());
+    const auto &route = routes[0].get<json::Object>().values;
+    const auto &native_route = native_result.routes[0];
+    BOOST_CHECK_EQUAL(native_route.duration, route.at("duration").get<json::Number>().value);
+    BOOST_CHECK_EQUAL(native_route.distance, route.at("distance").get<json::Number>().value);
+    BOOST_CHECK_EQUAL(native_route.weight_name,
+                      route.at("weight_name").get<json::String>().value);
+    BOOST_CHECK_GE(native_route.geometry.size(), 2);
+
+    const auto &legs = route.at("legs").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(native_route.legs.size(), legs.size());
+    for (std::size_t index = 0; index < legs.size(); ++index)
+    {
+        const auto &leg = legs[index].get<json::Object>().values;
+        BOOST_CHECK_EQUAL(native_route.legs[index].duration,
+                          leg.at("duration").get<json::Number>().value);
+        BOOST_CHECK_EQUAL(native_route.legs[index].summary,
+                          leg.at("summary").get<json::String>().value);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -151,6 +151,45 @@ BOOST_AUTO_TEST_CASE(test_table_three_coordinates_matrix)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_table_three_coordinates_distance_matrix)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_dummy_location());
+    params.annotations = TableParameters::AnnotationsType::All;
+
+    json::Object result;
+
+    const auto rc = osrm.Table(params, result);
+
+    BOOST_CHECK(rc == Status::Ok);
+    const auto code = result.values.at("code").get<json::String>().value;
+    BOOST_CHECK_EQUAL(code, "Ok");
+
+    for (const auto annotation : {"durations", "distances"})
+    {
+        const auto &array = result.values.at(annotation).get<json::Array>().values;
+        BOOST_CHECK_EQUAL(array.size(), params.coordinates.size());
+        for (unsigned int i = 0; i < array.size(); i++)
+        {
+            const auto matrix = array[i].get<json::Array>().values;
+            BOOST_CHECK_EQUAL(matrix[i].get<json::Number>().value, 0);
+            BOOST_CHECK_EQUAL(matrix.size(), params.coordinates.size());
+        }
+    }
+
+    params.annotations = TableParameters::AnnotationsType::Distance;
+    result.values.clear();
+    BOOST_CHECK(osrm.Table(params, result) == Status::Ok);
+    BOOST_CHECK(result.values.count("distances") == 1);
+    BOOST_CHECK(result.values.count("durations") == 0);
+}
+
 // See https://github.com/Project-OSRM/osrm-backend/pull/3992
 BOOST_AUTO_TEST_CASE(test_table_no_segment_for_some_coordinates)
 {
@@ -174,4 +213,78 @@ BOOST_AUTO_TEST_CASE(test_table_no_segment_for_some_coordinates)
     BOOST_CHECK_EQUAL(code, "NoSegment");
 }
 
+BOOST_AUTO_TEST_CASE(test_table_native_result_matches_json)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    params.coordinates = get_locations_in_big_component();
+    params.sources.push_back(0);
+    params.annotations =
+        TableParameters::AnnotationsType::Duration | TableParameters::AnnotationsType::Distance;
+
+    json::Object json_result;
+    BOOST_CHECK(osrm.Table(params, json_result) == Status::Ok);
+
+    engine::api::ResultT result = engine::api::native::TableResult();
+    BOOST_CHECK(osrm.Table(params, result) == Status::Ok);
+    BOOST_REQUIRE(result.is<engine::api::native::TableResult>());
+    const auto &native_result = result.get<engine::api::native::TableResult>();
+
+    BOOST_CHECK_EQUAL(native_result.sources.size(), 1);
+    BOOST_CHECK_EQUAL(native_result.destinations.size(), params.coordinates.size());
+
+    const auto &durations =
+        json_result.values.at("durations").get<json::Array>().values[0].get<json::Array>().values;
+    const auto &distances =
+        json_result.values.at("distances").get<json::Array>().values[0].get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(native_result.durations.size(), durations.size());
+    BOOST_REQUIRE_EQUAL(native_result.distances.size(), distances.size());
+    for (std::size_t index = 0; index < durations.size(); ++index)
+    {
+        BOOST_CHECK_EQUAL(native_result.durations[index],
+                          durations[index].get<json::Number>().value);
+        BOOST_CHECK_EQUAL(native_result.distances[index],
+                          distances[index].get<json::Number>().value);
+    }
+}
+
+// square tables run both searches of a location in one pass, rows compare to the other tables
+BOOST_AUTO_TEST_CASE(test_table_square_matrix_matches_rows)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    params.coordinates = get_locations_in_big_component();
+
+    json::Object square_result;
+    BOOST_REQUIRE(osrm.Table(params, square_result) == Status::Ok);
+    const auto &square_rows = square_result.values.at("durations").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(square_rows.size(), params.coordinates.size());
+
+    for (std::size_t source = 0; source < params.coordinates.size(); ++source)
+    {
+        params.sources = {source};
+        json::Object row_result;
+        BOOST_REQUIRE(osrm.Table(params, row_result) == Status::Ok);
+
+        const auto &row = row_result.values.at("durations")
+                              .get<json::Array>()
+                              .values.at(0)
+                              .get<json::Array>()
+                              .values;
+        const auto &square_row = square_rows[source].get<json::Array>().values;
+        BOOST_REQUIRE_EQUAL(row.size(), square_row.size());
+        for (std::size_t target = 0; target < row.size(); ++target)
+        {
+            BOOST_CHECK_EQUAL(square_row[target].get<json::Number>().value,
+                              row[target].get<json::Number>().value);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -37,6 +37,7 @@ class MockBaseDataFacade : public engine::datafacade::BaseDataFacade
         return {util::FixedLongitude{0}, util::FixedLatitude{0}};
     }
     OSMNodeID GetOSMNodeIDOfNode(const NodeID /* id */) const override { return OSMNodeID{0}; }
+    bool HasOSMNodeIDs() const override { return true; }
     bool EdgeIsCompressed(const EdgeID /* id */) const { return false; }
     GeometryID GetGeometryIndex(const NodeID /* id */) const override
     {
@@ -62,6 +63,16 @@ class MockBaseDataFacade : public engine::datafacade::BaseDataFacade
     {
         return {};
     }
+    std::vector<util::Coordinate>
+    GetUncompressedForwardCoordinates(const EdgeID /* id */) const override
+    {
+        return {};
+    }
+    std::vector<util::Coordinate>
+    GetUncompressedReverseCoordinates(const EdgeID /* id */) const override
+    {
+        return {};
+    }
     std::vector<EdgeWeight> GetUncompressedForwardWeights(const EdgeID /* id */) const override
     {
         std::vector<EdgeWeight> result_weights;
@@ -287,11 +298,12 @@ class MockAlgorithmDataFacade<engine::datafacade::CH>
     unsigned GetNumberOfEdges() const override { return 0; }
     unsigned GetOutDegree(const NodeID /* n */) const override { return 0; }
     NodeID GetTarget(const EdgeID /* e */) const override { return SPECIAL_NODEID; }
-    const EdgeData &GetEdgeData(const EdgeID /* e */) const override { return foo; }
+    EdgeData GetEdgeData(const EdgeID /* e */) const override { return foo; }
     EdgeRange GetAdjacentEdgeRange(const NodeID /* node */) const override
     {
         return EdgeRange(static_cast<EdgeID>(0), static_cast<EdgeID>(0), {});
     }
+    void PrefetchAdjacentEdgeRange(const NodeID /* node */) const override {}
     EdgeID FindEdge(const NodeID /* from */, const NodeID /* to */) const override
     {
         return SPECIAL_EDGEID;
@@ -2,6 +2,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "partitioner/cell_storage.hpp"
+#include "util/integer_range.hpp"
 #include "util/static_graph.hpp"
 
 using namespace osrm;
@@ -243,6 +244,12 @@ BOOST_AUTO_TEST_CASE(immutable_cell_storage)
     CHECK_EQUAL_COLLECTIONS(const_cell_1_4.GetDestinationNodes(), std::vector<EdgeWeight>{});
     CHECK_EQUAL_RANGE(const_cell_1_5.GetDestinationNodes(), 11);
 
+    // the destination nodes of a cell follow its source nodes
+    BOOST_CHECK(const_cell_1_2.GetSourceNodes().end() ==
+                const_cell_1_2.GetDestinationNodes().begin());
+    BOOST_CHECK(const_cell_1_5.GetSourceNodes().end() ==
+                const_cell_1_5.GetDestinationNodes().begin());
+
     auto out_const_range_1_0_0 = const_cell_1_0.GetOutWeight(0);
     auto out_const_range_1_2_4 = const_cell_1_2.GetOutWeight(4);
     auto out_const_range_1_3_6 = const_cell_1_3.GetOutWeight(6);
@@ -329,4 +336,76 @@ BOOST_AUTO_TEST_CASE(immutable_cell_storage)
     CHECK_EQUAL_COLLECTIONS(const_cell_4_0.GetDestinationNodes(), std::vector<EdgeWeight>{});
 }
 
+BOOST_AUTO_TEST_CASE(compressed_cell_metric)
+{
+    // node:                0  1  2  3  4  5  6  7  8  9 10 11
+    std::vector<CellID> l1{{0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5}};
+    std::vector<CellID> l2{{0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 3, 3}};
+    std::vector<CellID> l3{{0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1}};
+    std::vector<CellID> l4{{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+    MultiLevelPartition mlp{{l1, l2, l3, l4}, {6, 4, 2, 1}};
+
+    std::vector<MockEdge> edges = {{0, 1},
+                                   {2, 3},
+                                   {3, 7},
+                                   {4, 0},
+                                   {4, 5},
+                                   {5, 6},
+                                   {6, 4},
+                                   {6, 7},
+                                   {7, 11},
+                                   {8, 9},
+                                   {9, 8},
+                                   {10, 11},
+                                   {11, 10}};
+    auto graph = makeGraph(edges);
+
+    const CellStorage storage(mlp, graph);
+    auto metric = storage.MakeMetric();
+    // the last entry of a metric does not belong to a cell
+    for (const auto index : util::irange<std::size_t>(0, metric.weights.size() - 1))
+    {
+        metric.weights[index] = index % 5 == 0 ? INVALID_EDGE_WEIGHT : 1000 + 7 * index;
+        metric.durations[index] = 10 * index;
+    }
+    // the values of cell 1 on level 3 do not fit into 16 bits
+    const auto cell_3_1 = storage.GetCell(metric, 3, 1);
+    BOOST_REQUIRE_EQUAL(cell_3_1.GetOutWeight(4).size(), 2);
+    cell_3_1.GetOutWeight(4).front() = 1;
+    cell_3_1.GetOutWeight(7).front() = 100000;
+
+    const auto compressed = storage.CompressMetric(metric);
+    BOOST_CHECK(compressed.IsCompressed());
+    BOOST_CHECK_EQUAL(compressed.weights.size(), 4);
+    BOOST_CHECK(compressed.durations.empty());
+
+    const auto &const_metric = metric;
+    for (const auto level : util::irange<LevelID>(1, mlp.GetNumberOfLevels()))
+    {
+        for (const auto id : util::irange(0u, mlp.GetNumberOfCells(level)))
+        {
+            const auto cell = storage.GetCell(const_metric, level, id);
+            const auto compressed_cell = storage.GetCell(compressed, level, id);
+            for (const auto source : cell.GetSourceNodes())
+            {
+                CHECK_EQUAL_COLLECTIONS(cell.GetOutWeight(source),
+                                        compressed_cell.GetOutWeight(source));
+                CHECK_EQUAL_COLLECTIONS(cell.GetOutDuration(source),
+                                        compressed_cell.GetOutDuration(source));
+            }
+            for (const auto destination : cell.GetDestinationNodes())
+            {
+                CHECK_EQUAL_COLLECTIONS(cell.GetInWeight(destination),
+                                        compressed_cell.GetInWeight(destination));
+                CHECK_EQUAL_COLLECTIONS(cell.GetInDuration(destination),
+                                        compressed_cell.GetInDuration(destination));
+            }
+        }
+    }
+
+    const auto decompressed = storage.DecompressMetric(compressed);
+    CHECK_EQUAL_COLLECTIONS(decompressed.weights, metric.weights);
+    CHECK_EQUAL_COLLECTIONS(decompressed.durations, metric.durations);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
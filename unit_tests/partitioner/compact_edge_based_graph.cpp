@@ -0,0 +1,87 @@
+#include "partitioner/compact_edge_based_graph.hpp"
+#include "partitioner/multi_level_graph.hpp"
+
+#include "util/exception.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(compact_edge_based_graph)
+
+using namespace osrm;
+using namespace osrm::partitioner;
+
+namespace
+{
+using Edge = CompactEdgeBasedGraph<storage::Ownership::Container>::InputEdge;
+using CompactGraph = MultiLevelGraph<EdgeBasedGraphEdgeData,
+                                     storage::Ownership::Container,
+                                     CompactEdgeBasedGraph<storage::Ownership::Container>>;
+using Graph = MultiLevelGraph<EdgeBasedGraphEdgeData, storage::Ownership::Container>;
+
+MultiLevelPartition makePartition()
+{
+    // node:                0  1  2  3
+    std::vector<CellID> l1{{0, 0, 1, 1}};
+    return MultiLevelPartition{{l1}, {2}};
+}
+
+std::vector<Edge> makeEdges(const EdgeWeight weight_of_last_edge)
+{
+    std::vector<Edge> edges = {
+        {0, 1, 7, 3, 6, true, false},
+        {0, 2, 8, 2, 4, false, true},
+        {1, 3, 1, 1, 3, true, true},
+        {2, 3, 9, weight_of_last_edge, 10, true, false},
+    };
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+}
+
+BOOST_AUTO_TEST_CASE(edges_keep_their_data)
+{
+    const auto mlp = makePartition();
+    const auto edges = makeEdges(5);
+    const CompactGraph compact_graph{mlp, 4, edges};
+    const Graph graph{mlp, 4, edges};
+
+    BOOST_REQUIRE_EQUAL(compact_graph.GetNumberOfNodes(), graph.GetNumberOfNodes());
+    BOOST_REQUIRE_EQUAL(compact_graph.GetNumberOfEdges(), graph.GetNumberOfEdges());
+    for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+    {
+        BOOST_CHECK_EQUAL(compact_graph.BeginEdges(node), graph.BeginEdges(node));
+        BOOST_CHECK_EQUAL(compact_graph.EndEdges(node), graph.EndEdges(node));
+        BOOST_CHECK_EQUAL(compact_graph.BeginBorderEdges(1, node), graph.BeginBorderEdges(1, node));
+    }
+    for (const auto edge : util::irange(0u, graph.GetNumberOfEdges()))
+    {
+        BOOST_CHECK_EQUAL(compact_graph.GetTarget(edge), graph.GetTarget(edge));
+        BOOST_CHECK_EQUAL(compact_graph.GetCompactEdge(edge).target, graph.GetTarget(edge));
+
+        const auto compact_data = compact_graph.GetEdgeData(edge);
+        const auto &data = graph.GetEdgeData(edge);
+        BOOST_CHECK_EQUAL(compact_data.turn_id, data.turn_id);
+        BOOST_CHECK_EQUAL(compact_data.weight, data.weight);
+        BOOST_CHECK_EQUAL(compact_data.duration, data.duration);
+        BOOST_CHECK_EQUAL(compact_data.forward, data.forward);
+        BOOST_CHECK_EQUAL(compact_data.backward, data.backward);
+    }
+
+    BOOST_CHECK_EQUAL(compact_graph.FindEdge(0, 2), graph.FindEdge(0, 2));
+    BOOST_CHECK_EQUAL(compact_graph.FindEdge(3, 2), SPECIAL_EDGEID);
+}
+
+BOOST_AUTO_TEST_CASE(weights_out_of_range_are_rejected)
+{
+    const auto mlp = makePartition();
+    using CompactBaseGraph = CompactEdgeBasedGraph<storage::Ownership::Container>;
+    BOOST_CHECK_NO_THROW((CompactGraph{mlp, 4, makeEdges(CompactBaseGraph::MAX_EDGE_WEIGHT)}));
+    BOOST_CHECK_THROW((CompactGraph{mlp, 4, makeEdges(CompactBaseGraph::MAX_EDGE_WEIGHT + 1)}),
+                      util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,8 @@
 #include "partitioner/recursive_bisection_state.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
 #include <vector>
 
 #include <boost/test/test_case_template.hpp>
@@ -72,4 +74,106 @@ BOOST_AUTO_TEST_CASE(horizontal_cut_between_two_grids)
     BOOST_CHECK(cut.num_edges == 4);
 }
 
+namespace
+{
+// a grid that is big enough for the parallel level graph computation, sources are the first and
+// sinks the last column, so the min cut crosses every row once
+BisectionGraph makeWideGrid(const int rows, const int cols)
+{
+    auto grid_edges = makeGridEdges(rows, cols, 0);
+    groupEdgesBySource(grid_edges.begin(), grid_edges.end());
+    return makeBisectionGraph(makeGridCoordinates(rows, cols, 0.01, 0, 0),
+                              adaptToBisectionEdge(std::move(grid_edges)));
+}
+}
+
+BOOST_AUTO_TEST_CASE(vertical_cut_through_big_grid)
+{
+    const int rows = 200;
+    const int cols = 400;
+    const auto graph = makeWideGrid(rows, cols);
+    BisectionGraphView view(graph);
+
+    DinicMaxFlow::SourceSinkNodes sources, sinks;
+    for (int row = 0; row < rows; ++row)
+    {
+        sources.insert(static_cast<NodeID>(row * cols));
+        sinks.insert(static_cast<NodeID>(row * cols + cols - 1));
+    }
+
+    const auto cut = DinicMaxFlow()(view, sources, sinks);
+    BOOST_CHECK_EQUAL(cut.num_edges, rows);
+    BOOST_CHECK_EQUAL(cut.flags.size(), rows * cols);
+    for (int row = 0; row < rows; ++row)
+    {
+        BOOST_CHECK(cut.flags[row * cols]);
+        BOOST_CHECK(!cut.flags[row * cols + cols - 1]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(stop_at_upper_bound)
+{
+    const int rows = 20;
+    const int cols = 40;
+    const auto graph = makeWideGrid(rows, cols);
+    BisectionGraphView view(graph);
+
+    DinicMaxFlow::SourceSinkNodes sources, sinks;
+    for (int row = 0; row < rows; ++row)
+    {
+        sources.insert(static_cast<NodeID>(row * cols));
+        sinks.insert(static_cast<NodeID>(row * cols + cols - 1));
+    }
+
+    const std::atomic<std::size_t> low_bound{5};
+    const auto stopped = DinicMaxFlow()(view, sources, sinks, low_bound);
+    BOOST_CHECK(stopped.flags.empty());
+    BOOST_CHECK_GT(stopped.num_edges, 5);
+
+    const std::atomic<std::size_t> exact_bound{rows};
+    const auto cut = DinicMaxFlow()(view, sources, sinks, exact_bound);
+    BOOST_CHECK_EQUAL(cut.num_edges, rows);
+    BOOST_CHECK_EQUAL(cut.flags.size(), rows * cols);
+}
+
+BOOST_AUTO_TEST_CASE(reuse_workspace)
+{
+    const auto make_terminals = [](const int rows, const int cols) {
+        DinicMaxFlow::SourceSinkNodes sources, sinks;
+        for (int row = 0; row < rows; ++row)
+        {
+            sources.insert(static_cast<NodeID>(row * cols));
+            sinks.insert(static_cast<NodeID>(row * cols + cols - 1));
+        }
+        return std::make_pair(sources, sinks);
+    };
+
+    const auto big_graph = makeWideGrid(30, 40);
+    const auto small_graph = makeWideGrid(10, 20);
+    BisectionGraphView big_view(big_graph);
+    BisectionGraphView small_view(small_graph);
+    const auto big_terminals = make_terminals(30, 40);
+    const auto small_terminals = make_terminals(10, 20);
+
+    // the buffers of the big cut must not leak into the smaller cuts that follow
+    DinicMaxFlow::WorkspacePool workspaces;
+    const std::atomic<std::size_t> no_bound{std::numeric_limits<std::size_t>::max()};
+    for (int round = 0; round < 2; ++round)
+    {
+        auto workspace = workspaces.Acquire();
+        const auto big_cut = DinicMaxFlow()(
+            big_view, big_terminals.first, big_terminals.second, no_bound, *workspace);
+        BOOST_CHECK_EQUAL(big_cut.num_edges, 30);
+        BOOST_CHECK_EQUAL(big_cut.num_nodes_source,
+                          DinicMaxFlow()(big_view, big_terminals.first, big_terminals.second)
+                              .num_nodes_source);
+
+        const auto small_cut = DinicMaxFlow()(
+            small_view, small_terminals.first, small_terminals.second, no_bound, *workspace);
+        BOOST_CHECK_EQUAL(small_cut.num_edges, 10);
+        BOOST_CHECK_EQUAL(small_cut.flags.size(), 10 * 20);
+        workspaces.Release(std::move(workspace));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,75 @@
+#include <boost/test/unit_test.hpp>
+
+#include "partitioner/edge_based_graph_reader.hpp"
+
+#include "../common/temporary_file.hpp"
+
+using namespace osrm;
+using namespace osrm::partitioner;
+
+namespace
+{
+std::vector<extractor::EdgeBasedEdge> makeEdges(const NodeID number_of_nodes)
+{
+    std::vector<extractor::EdgeBasedEdge> edges;
+    for (NodeID node = 0; node + 1 < number_of_nodes; ++node)
+    {
+        edges.emplace_back(node, node + 1, node, 10 + node % 7, 20 + node % 5, true, false);
+    }
+    return edges;
+}
+
+void checkFile(const boost::filesystem::path &path,
+               const NodeID number_of_nodes,
+               const std::vector<extractor::EdgeBasedEdge> &edges)
+{
+    const EdgeBasedGraphFile file{path};
+    BOOST_CHECK_EQUAL(file.GetNumberOfNodes(), number_of_nodes);
+    BOOST_CHECK_EQUAL(file.GetConnectivityChecksum(), 1337);
+
+    const auto mapped_edges = file.GetEdges();
+    BOOST_REQUIRE_EQUAL(mapped_edges.size(), edges.size());
+    for (std::size_t index = 0; index < edges.size(); ++index)
+    {
+        BOOST_CHECK_EQUAL(mapped_edges[index].source, edges[index].source);
+        BOOST_CHECK_EQUAL(mapped_edges[index].target, edges[index].target);
+        BOOST_CHECK_EQUAL(mapped_edges[index].data.turn_id, edges[index].data.turn_id);
+        BOOST_CHECK_EQUAL(mapped_edges[index].data.weight, edges[index].data.weight);
+    }
+}
+}
+
+BOOST_AUTO_TEST_SUITE(edge_based_graph_reader)
+
+BOOST_AUTO_TEST_CASE(map_edge_based_graph)
+{
+    TemporaryFile tmp;
+    const NodeID number_of_nodes = 100;
+    const auto edges = makeEdges(number_of_nodes);
+    extractor::files::writeEdgeBasedGraph(tmp.path, number_of_nodes, edges, 1337);
+
+    checkFile(tmp.path, number_of_nodes, edges);
+
+    // every edge is split into a forward and a backward edge
+    const auto graph = LoadEdgeBasedGraph(tmp.path);
+    BOOST_CHECK_EQUAL(graph.GetNumberOfNodes(), number_of_nodes);
+    BOOST_CHECK_EQUAL(graph.GetNumberOfEdges(), 2 * edges.size());
+    BOOST_CHECK_EQUAL(graph.connectivity_checksum, 1337);
+}
+
+BOOST_AUTO_TEST_CASE(read_compressed_edge_based_graph)
+{
+    TemporaryFile tmp;
+    // large enough that the edge list is compressed
+    const NodeID number_of_nodes = 100000;
+    const auto edges = makeEdges(number_of_nodes);
+    extractor::files::writeEdgeBasedGraph(tmp.path,
+                                          number_of_nodes,
+                                          edges,
+                                          1337,
+                                          storage::tar::FileWriter::CompressLargeEntries);
+
+    checkFile(tmp.path, number_of_nodes, edges);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
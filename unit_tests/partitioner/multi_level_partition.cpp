@@ -3,6 +3,10 @@
 
 #include "partitioner/multi_level_partition.hpp"
 
+#include "util/integer_range.hpp"
+
+#include <limits>
+
 #define CHECK_SIZE_RANGE(range, ref) BOOST_CHECK_EQUAL(range.second - range.first, ref)
 #define CHECK_EQUAL_RANGE(range, ref)                                                              \
     do                                                                                             \
@@ -175,4 +179,42 @@ BOOST_AUTO_TEST_CASE(mlp_sorted)
     BOOST_CHECK_EQUAL(mlp.EndChildren(4, 0), 2);
 }
 
+BOOST_AUTO_TEST_CASE(mlp_all_partition_bits)
+{
+    // node:                0  1  2  3  4  5  6  7
+    std::vector<CellID> l1{{0, 0, 1, 1, 2, 2, 3, 3}};
+    std::vector<CellID> l2{{0, 0, 0, 0, 1, 1, 1, 1}};
+    // reserves 32 bits for the cell ids of each level
+    const std::vector<std::uint32_t> num_cells{std::numeric_limits<std::uint32_t>::max(),
+                                               std::numeric_limits<std::uint32_t>::max()};
+    BOOST_CHECK_EQUAL(MultiLevelPartition::GetPartitionBits(num_cells), 64);
+    MultiLevelPartition mlp{{l1, l2}, num_cells};
+
+    BOOST_CHECK_EQUAL(mlp.GetNumberOfCells(1), 4);
+    BOOST_CHECK_EQUAL(mlp.GetNumberOfCells(2), 2);
+    for (const auto node : util::irange<NodeID>(0, 8))
+    {
+        BOOST_CHECK_EQUAL(mlp.GetCell(1, node), l1[node]);
+        BOOST_CHECK_EQUAL(mlp.GetCell(2, node), l2[node]);
+    }
+    BOOST_CHECK_EQUAL(mlp.GetHighestDifferentLevel(0, 1), 0);
+    BOOST_CHECK_EQUAL(mlp.GetHighestDifferentLevel(0, 2), 1);
+    BOOST_CHECK_EQUAL(mlp.GetHighestDifferentLevel(0, 7), 2);
+}
+
+BOOST_AUTO_TEST_CASE(mlp_too_many_levels)
+{
+    std::vector<CellID> level{{0, 0}};
+    std::vector<std::vector<CellID>> partitions(MultiLevelPartition::MAX_NUM_CELL_LEVELS + 1,
+                                                level);
+    std::vector<std::uint32_t> num_cells(partitions.size(), 1);
+    BOOST_CHECK_THROW((MultiLevelPartition{partitions, num_cells}), util::exception);
+
+    partitions.pop_back();
+    num_cells.pop_back();
+    MultiLevelPartition mlp{partitions, num_cells};
+    BOOST_CHECK_EQUAL(mlp.GetNumberOfLevels(), MultiLevelPartition::MAX_NUM_CELL_LEVELS + 1);
+    BOOST_CHECK_EQUAL(mlp.GetCell(MultiLevelPartition::MAX_NUM_CELL_LEVELS, 1), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,46 @@
+#include "server/http/cache_validators.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(cache_validators)
+
+using namespace osrm;
+using namespace osrm::server;
+
+BOOST_AUTO_TEST_CASE(entity_tag_of_version)
+{
+    engine::DatasetVersion version;
+    version.checksum = 0xdeadbeef;
+    version.generation = 42;
+    version.loaded_at = 784111777;
+    BOOST_CHECK_EQUAL(http::makeEntityTag(version), "W/\"deadbeef-2a\"");
+
+    auto next_version = version;
+    next_version.generation = 43;
+    BOOST_CHECK(http::makeEntityTag(next_version) != http::makeEntityTag(version));
+}
+
+BOOST_AUTO_TEST_CASE(http_date)
+{
+    BOOST_CHECK_EQUAL(http::formatHTTPDate(0), "Thu, 01 Jan 1970 00:00:00 GMT");
+    BOOST_CHECK_EQUAL(http::formatHTTPDate(784111777), "Sun, 06 Nov 1994 08:49:37 GMT");
+}
+
+BOOST_AUTO_TEST_CASE(if_none_match)
+{
+    const std::string tag = "W/\"deadbeef-2a\"";
+
+    BOOST_CHECK(http::matchesEntityTag("W/\"deadbeef-2a\"", tag));
+    // weak comparison ignores the W/ prefix of both tags
+    BOOST_CHECK(http::matchesEntityTag("\"deadbeef-2a\"", tag));
+    BOOST_CHECK(http::matchesEntityTag("\"1-1\", W/\"deadbeef-2a\"", tag));
+    BOOST_CHECK(http::matchesEntityTag("\"1-1\" ,W/\"deadbeef-2a\" , \"2-2\"", tag));
+    BOOST_CHECK(http::matchesEntityTag("*", tag));
+
+    BOOST_CHECK(!http::matchesEntityTag("", tag));
+    BOOST_CHECK(!http::matchesEntityTag(",", tag));
+    BOOST_CHECK(!http::matchesEntityTag("W/\"deadbeef-2b\"", tag));
+    BOOST_CHECK(!http::matchesEntityTag("\"1-1\", \"2-2\"", tag));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,196 @@
+#include "server/api/fast_parameters_parser.hpp"
+#include "server/api/route_parameters_grammar.hpp"
+#include "server/api/table_parameter_grammar.hpp"
+
+#include "engine/hint.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(api_fast_parameters_parser)
+
+using namespace osrm;
+using namespace osrm::server;
+using namespace osrm::server::api;
+using namespace osrm::engine::api;
+
+template <typename ParameterT, typename GrammarT>
+bool parseWithGrammar(std::string query, ParameterT &parameters)
+{
+    static const GrammarT grammar;
+    auto iter = query.begin();
+    return boost::spirit::qi::parse(iter, query.end(), grammar(boost::phoenix::ref(parameters))) &&
+           iter == query.end();
+}
+
+bool parseRoute(const std::string &query, RouteParameters &parameters)
+{
+    return parseRouteParameters(query.data(), query.data() + query.size(), parameters);
+}
+
+bool parseTable(const std::string &query, TableParameters &parameters)
+{
+    return parseTableParameters(query.data(), query.data() + query.size(), parameters);
+}
+
+void checkBaseParameters(const BaseParameters &reference, const BaseParameters &result)
+{
+    BOOST_CHECK(reference.coordinates == result.coordinates);
+    BOOST_CHECK(reference.hints == result.hints);
+    BOOST_CHECK(reference.radiuses == result.radiuses);
+    BOOST_CHECK(reference.bearings == result.bearings);
+    BOOST_CHECK(reference.approaches == result.approaches);
+    BOOST_CHECK(reference.exclude == result.exclude);
+    BOOST_CHECK_EQUAL(reference.metric, result.metric);
+    BOOST_CHECK(reference.depart_at == result.depart_at);
+    BOOST_CHECK_EQUAL(reference.generate_hints, result.generate_hints);
+    BOOST_CHECK(reference.format == result.format);
+}
+
+void checkRouteQuery(const std::string &query)
+{
+    RouteParameters reference, result;
+    const auto parsed =
+        parseWithGrammar<RouteParameters, RouteParametersGrammar<>>(query, reference);
+    BOOST_REQUIRE(parsed);
+    BOOST_REQUIRE_MESSAGE(parseRoute(query, result), query);
+    checkBaseParameters(reference, result);
+    BOOST_CHECK_EQUAL(reference.steps, result.steps);
+    BOOST_CHECK_EQUAL(reference.alternatives, result.alternatives);
+    BOOST_CHECK_EQUAL(reference.number_of_alternatives, result.number_of_alternatives);
+    BOOST_CHECK_EQUAL(reference.annotations, result.annotations);
+    BOOST_CHECK(reference.annotations_type == result.annotations_type);
+    BOOST_CHECK(reference.geometries == result.geometries);
+    BOOST_CHECK(reference.overview == result.overview);
+    BOOST_CHECK(reference.continue_straight == result.continue_straight);
+}
+
+void checkTableQuery(const std::string &query)
+{
+    TableParameters reference, result;
+    const auto parsed =
+        parseWithGrammar<TableParameters, TableParametersGrammar<>>(query, reference);
+    BOOST_REQUIRE(parsed);
+    BOOST_REQUIRE_MESSAGE(parseTable(query, result), query);
+    checkBaseParameters(reference, result);
+    BOOST_CHECK(reference.sources == result.sources);
+    BOOST_CHECK(reference.destinations == result.destinations);
+    BOOST_CHECK(reference.annotations == result.annotations);
+}
+
+BOOST_AUTO_TEST_CASE(same_route_parameters_as_grammar)
+{
+    checkRouteQuery("1,2;3,4");
+    checkRouteQuery("-1.5,+2.;.25,-.75.json");
+    checkRouteQuery("7.416351,43.731205;7.420363,43.736189.bin?overview=false");
+    checkRouteQuery("1,2;3,4?steps=true&alternatives=3&geometries=polyline6&overview=full");
+    checkRouteQuery("1,2;3,4?alternatives=true&continue_straight=false&geometries=polyline");
+    checkRouteQuery("1,2;3,4?alternatives=0&continue_straight=default&geometries=geojson");
+    checkRouteQuery("1,2;3,4?annotations=true&overview=simplified");
+    checkRouteQuery("1,2;3,4?annotations=duration,nodes,distance&annotations=speed");
+    checkRouteQuery("1,2;3,4?annotations=weight,datasources&generate_hints=false");
+    checkRouteQuery("1,2;3,4?radiuses=5.5;unlimited&radiuses=;10");
+    checkRouteQuery("1,2;3,4?bearings=200,10;-1,+15&bearings=;");
+    checkRouteQuery("1,2;3,4?approaches=curb;unrestricted&approaches=;curb");
+    checkRouteQuery("1,2;3,4?exclude=toll,motorway&metric=dist_ance");
+    checkRouteQuery("1,2;3,4?hints=;");
+    checkRouteQuery("1,2;3,4?depart_at=7:05&metric=truck");
+}
+
+BOOST_AUTO_TEST_CASE(same_table_parameters_as_grammar)
+{
+    checkTableQuery("1,2;3,4");
+    checkTableQuery("1,2;3,4.json?sources=1;0&destinations=all");
+    checkTableQuery("1,2;3,4?sources=1&sources=all&destinations=0");
+    checkTableQuery("1,2;3,4?annotations=distance&sources=0");
+    checkTableQuery("1,2;3,4?annotations=duration,distance&annotations=distance");
+    checkTableQuery("1,2;3,4?radiuses=1;2&bearings=;90,20&approaches=curb;");
+}
+
+BOOST_AUTO_TEST_CASE(same_random_queries_as_grammar)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> longitude(-180, 180);
+    std::uniform_real_distribution<double> latitude(-85, 85);
+    std::uniform_real_distribution<double> radius(0, 500);
+    std::uniform_int_distribution<int> precision(0, 9);
+    std::uniform_int_distribution<int> bearing(0, 359);
+
+    for (int query_index = 0; query_index < 50; ++query_index)
+    {
+        std::ostringstream coordinates, hints, radiuses, bearings;
+        coordinates << std::fixed;
+        radiuses << std::fixed;
+        for (int index = 0; index < 100; ++index)
+        {
+            const auto separator = index > 0 ? ";" : "";
+            const auto lon = longitude(generator);
+            const auto lat = latitude(generator);
+            coordinates << separator << std::setprecision(precision(generator)) << lon << ","
+                        << std::setprecision(precision(generator)) << lat;
+
+            engine::Hint hint;
+            hint.phantom = engine::PhantomNode{};
+            hint.phantom.input_location =
+                util::Coordinate{util::FloatLongitude{lon}, util::FloatLatitude{lat}};
+            hint.data_checksum = generator();
+            hints << separator << (index % 7 == 0 ? "" : hint.ToBase64());
+            radiuses << separator << std::setprecision(precision(generator)) << radius(generator);
+            bearings << separator << bearing(generator) << "," << bearing(generator) % 180;
+        }
+
+        checkRouteQuery(coordinates.str() + "?hints=" + hints.str() + "&radiuses=" +
+                        radiuses.str() + "&bearings=" + bearings.str());
+        checkTableQuery(coordinates.str() + "?hints=" + hints.str() + "&radiuses=" +
+                        radiuses.str() + "&sources=0;1;2");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(leave_queries_to_grammar)
+{
+    RouteParameters route_parameters;
+    // polylines, exponents and unknown options
+    BOOST_CHECK(!parseRoute("polyline(_ibE_seK_seK_seK)", route_parameters));
+    BOOST_CHECK(!parseRoute("1,2;3,4?radiuses=1e3", route_parameters));
+    BOOST_CHECK(!parseRoute("1,2;3,4?foo=bar", route_parameters));
+    // malformed queries
+    BOOST_CHECK(!parseRoute("", route_parameters));
+    BOOST_CHECK(!parseRoute("1,2;3,4;", route_parameters));
+    BOOST_CHECK(!parseRoute("1,2;3,4?", route_parameters));
+    BOOST_CHECK(!parseRoute("1,2;3,4?steps=truex", route_parameters));
+    BOOST_CHECK(!parseRoute("1,2;3,4?bearings=400000,1", route_parameters));
+    BOOST_CHECK(!parseRoute("1,2;3,4?hints=foo", route_parameters));
+    BOOST_CHECK(!parseRoute("1,2;3,4?depart_at=12:60", route_parameters));
+    BOOST_CHECK(!parseRoute("90000000,2;3,4", route_parameters));
+
+    TableParameters table_parameters;
+    BOOST_CHECK(!parseTable("1,2;3,4?sources=-1", table_parameters));
+    BOOST_CHECK(!parseTable("1,2;3,4?steps=true", table_parameters));
+}
+
+BOOST_AUTO_TEST_CASE(decode_hints_in_place)
+{
+    engine::Hint hint;
+    hint.phantom = engine::PhantomNode{};
+    hint.phantom.input_location =
+        util::Coordinate{util::FloatLongitude{7.432251}, util::FloatLatitude{43.745995}};
+    hint.data_checksum = 0xdeadbeef;
+    const auto encoded = hint.ToBase64();
+
+    const auto decoded = engine::Hint::FromBase64(encoded.data(), encoded.data() + encoded.size());
+    BOOST_REQUIRE(decoded);
+    BOOST_CHECK(*decoded == engine::Hint::FromBase64(encoded));
+    BOOST_CHECK(*decoded == hint);
+
+    BOOST_CHECK(!engine::Hint::FromBase64(encoded.data(), encoded.data() + encoded.size() - 1));
+    auto invalid = encoded;
+    invalid[3] = '+';
+    BOOST_CHECK(!engine::Hint::FromBase64(invalid.data(), invalid.data() + invalid.size()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
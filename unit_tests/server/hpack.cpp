@@ -0,0 +1,129 @@
+#include "server/http/header.hpp"
+#include "server/http2/hpack.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(hpack)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+std::string fromHex(const std::string &hex)
+{
+    std::string bytes;
+    for (std::size_t index = 0; index + 1 < hex.size(); index += 2)
+    {
+        bytes.push_back(static_cast<char>(std::stoi(hex.substr(index, 2), nullptr, 16)));
+    }
+    return bytes;
+}
+
+using Fields = std::vector<std::pair<std::string, std::string>>;
+
+Fields decode(http2::HPACKDecoder &decoder, const std::string &block)
+{
+    std::vector<http::header> headers;
+    BOOST_REQUIRE(decoder.Decode(block.data(), block.data() + block.size(), headers));
+
+    Fields fields;
+    for (const auto &header : headers)
+    {
+        fields.emplace_back(header.name, header.value);
+    }
+    return fields;
+}
+}
+
+// RFC 7541, appendix C.3 and C.4
+BOOST_AUTO_TEST_CASE(decodes_the_requests_of_the_rfc)
+{
+    http2::HPACKDecoder decoder;
+    const Fields first{{":method", "GET"},
+                       {":scheme", "http"},
+                       {":path", "/"},
+                       {":authority", "www.example.com"}};
+    const auto first_fields = decode(decoder, fromHex("828684410f7777772e6578616d706c652e636f6d"));
+    BOOST_CHECK(first_fields == first);
+
+    http2::HPACKDecoder huffman_decoder;
+    BOOST_CHECK(decode(huffman_decoder, fromHex("828684418cf1e3c2e5f23a6ba0ab90f4ff")) == first);
+
+    // the authority is indexed in the dynamic table by now
+    const Fields second{{":method", "GET"},
+                        {":scheme", "http"},
+                        {":path", "/"},
+                        {":authority", "www.example.com"},
+                        {"cache-control", "no-cache"}};
+    BOOST_CHECK(decode(huffman_decoder, fromHex("828684be5886a8eb10649cbf")) == second);
+
+    const Fields third{{":method", "GET"},
+                       {":scheme", "https"},
+                       {":path", "/index.html"},
+                       {":authority", "www.example.com"},
+                       {"custom-key", "custom-value"}};
+    BOOST_CHECK(decode(huffman_decoder,
+                       fromHex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf")) == third);
+}
+
+BOOST_AUTO_TEST_CASE(rejects_malformed_blocks)
+{
+    std::vector<http::header> headers;
+
+    // index 0 is not used
+    const auto zero_index = fromHex("80");
+    BOOST_CHECK(!http2::HPACKDecoder().Decode(
+        zero_index.data(), zero_index.data() + zero_index.size(), headers));
+
+    // the dynamic table is empty
+    const auto missing_entry = fromHex("be");
+    BOOST_CHECK(!http2::HPACKDecoder().Decode(
+        missing_entry.data(), missing_entry.data() + missing_entry.size(), headers));
+
+    // the string is longer than the block
+    const auto truncated = fromHex("410f7777");
+    BOOST_CHECK(!http2::HPACKDecoder().Decode(
+        truncated.data(), truncated.data() + truncated.size(), headers));
+}
+
+BOOST_AUTO_TEST_CASE(huffman_padding)
+{
+    const auto decode_huffman = [](const std::string &hex, std::string &decoded) {
+        const auto bytes = fromHex(hex);
+        return http2::decodeHuffman(bytes.data(), bytes.data() + bytes.size(), decoded);
+    };
+
+    std::string decoded;
+    BOOST_CHECK(decode_huffman("a8eb10649cbf", decoded));
+    BOOST_CHECK_EQUAL(decoded, "no-cache");
+
+    // the padding has to be ones and shorter than a byte
+    BOOST_CHECK(!decode_huffman("a8eb10649cbe", decoded));
+    BOOST_CHECK(!decode_huffman("a8eb10649cbfff", decoded));
+}
+
+BOOST_AUTO_TEST_CASE(encoded_headers_are_decoded)
+{
+    const std::vector<http::header> headers{{":status", "200"},
+                                            {":status", "503"},
+                                            {"content-type", "application/json; charset=UTF-8"},
+                                            {"access-control-allow-origin", "*"},
+                                            {"x-custom", std::string(200, 'x')}};
+    std::string block;
+    http2::HPACKEncoder().Encode(headers, block);
+
+    http2::HPACKDecoder decoder;
+    Fields expected;
+    for (const auto &header : headers)
+    {
+        expected.emplace_back(header.name, header.value);
+    }
+    BOOST_CHECK(decode(decoder, block) == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,203 @@
+#include "server/http/header.hpp"
+#include "server/http2/hpack.hpp"
+#include "server/http2/session.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(http2_session)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+const constexpr std::uint8_t DATA = 0x0;
+const constexpr std::uint8_t HEADERS = 0x1;
+const constexpr std::uint8_t RST_STREAM = 0x3;
+const constexpr std::uint8_t SETTINGS = 0x4;
+const constexpr std::uint8_t GOAWAY = 0x7;
+const constexpr std::uint8_t WINDOW_UPDATE = 0x8;
+
+const constexpr std::uint8_t END_STREAM = 0x1;
+const constexpr std::uint8_t ACK = 0x1;
+const constexpr std::uint8_t END_HEADERS = 0x4;
+
+struct Frame
+{
+    std::uint8_t type;
+    std::uint8_t flags;
+    std::uint32_t stream_id;
+    std::string payload;
+};
+
+std::string uint32(const std::uint32_t value)
+{
+    return {static_cast<char>(value >> 24),
+            static_cast<char>(value >> 16),
+            static_cast<char>(value >> 8),
+            static_cast<char>(value)};
+}
+
+std::string frame(const std::uint8_t type,
+                  const std::uint8_t flags,
+                  const std::uint32_t stream_id,
+                  const std::string &payload)
+{
+    auto bytes = uint32(static_cast<std::uint32_t>(payload.size() << 8) | type);
+    bytes.push_back(static_cast<char>(flags));
+    return bytes + uint32(stream_id) + payload;
+}
+
+std::string requestHeaders(const std::uint32_t stream_id, const std::string &path)
+{
+    std::string block;
+    http2::HPACKEncoder().Encode({{":method", "GET"},
+                                  {":scheme", "http"},
+                                  {":path", path},
+                                  {":authority", "localhost"},
+                                  {"accept-encoding", "gzip, deflate"}},
+                                 block);
+    return frame(HEADERS, END_STREAM | END_HEADERS, stream_id, block);
+}
+
+std::vector<Frame> frames(const std::string &output)
+{
+    std::vector<Frame> parsed;
+    for (std::size_t offset = 0; offset + 9 <= output.size();)
+    {
+        const auto bytes = reinterpret_cast<const unsigned char *>(output.data() + offset);
+        const std::size_t length = (bytes[0] << 16) | (bytes[1] << 8) | bytes[2];
+        const std::uint32_t stream_id = (bytes[5] << 24) | (bytes[6] << 16) | (bytes[7] << 8) |
+                                        bytes[8];
+        parsed.push_back(Frame{bytes[3], bytes[4], stream_id, output.substr(offset + 9, length)});
+        offset += 9 + length;
+    }
+    return parsed;
+}
+
+bool consume(http2::Session &session, const std::string &input)
+{
+    return session.Consume(input.data(), input.data() + input.size());
+}
+
+// starts a session with a request on stream 1, settings are sent before
+void startSession(http2::Session &session, const std::string &settings)
+{
+    BOOST_REQUIRE(consume(session,
+                          std::string(http2::CONNECTION_PREFACE) +
+                              frame(SETTINGS, 0, 0, settings) +
+                              requestHeaders(1, "/route/v1/driving/1,2;3,4")));
+    BOOST_REQUIRE_EQUAL(session.TakeRequests().size(), 1);
+    session.TakeOutput();
+}
+}
+
+BOOST_AUTO_TEST_CASE(request_and_reply)
+{
+    http2::Session session;
+    const auto input = std::string(http2::CONNECTION_PREFACE) + frame(SETTINGS, 0, 0, "") +
+                       requestHeaders(1, "/route/v1/driving/1,2;3,4");
+
+    // the preface and frames may be split anywhere
+    BOOST_REQUIRE(session.Consume(input.data(), input.data() + 10));
+    BOOST_REQUIRE(session.Consume(input.data() + 10, input.data() + input.size()));
+
+    auto output = frames(session.TakeOutput());
+    BOOST_REQUIRE_EQUAL(output.size(), 2);
+    BOOST_CHECK_EQUAL(output[0].type, SETTINGS);
+    BOOST_CHECK_EQUAL(output[0].flags, 0);
+    BOOST_CHECK_EQUAL(output[1].type, SETTINGS);
+    BOOST_CHECK_EQUAL(output[1].flags, ACK);
+
+    const auto requests = session.TakeRequests();
+    BOOST_REQUIRE_EQUAL(requests.size(), 1);
+    BOOST_CHECK_EQUAL(requests[0].stream_id, 1);
+    BOOST_CHECK_EQUAL(requests[0].request.method, "GET");
+    BOOST_CHECK_EQUAL(requests[0].request.uri, "/route/v1/driving/1,2;3,4");
+    BOOST_CHECK_EQUAL(requests[0].compression_type, http::gzip_rfc1952);
+
+    session.SubmitReply(1,
+                        200,
+                        {{"Content-Type", "application/json"}, {"Connection", "keep-alive"}},
+                        {'{', '}'});
+    output = frames(session.TakeOutput());
+    BOOST_REQUIRE_EQUAL(output.size(), 2);
+    BOOST_CHECK_EQUAL(output[0].type, HEADERS);
+    BOOST_CHECK_EQUAL(output[0].flags, END_HEADERS);
+    BOOST_CHECK_EQUAL(output[0].stream_id, 1);
+    BOOST_CHECK_EQUAL(output[1].type, DATA);
+    BOOST_CHECK_EQUAL(output[1].flags, END_STREAM);
+    BOOST_CHECK_EQUAL(output[1].payload, "{}");
+
+    std::vector<http::header> headers;
+    const auto &block = output[0].payload;
+    BOOST_REQUIRE(
+        http2::HPACKDecoder().Decode(block.data(), block.data() + block.size(), headers));
+    BOOST_REQUIRE_EQUAL(headers.size(), 3);
+    BOOST_CHECK_EQUAL(headers[0].name, ":status");
+    BOOST_CHECK_EQUAL(headers[0].value, "200");
+    BOOST_CHECK_EQUAL(headers[1].name, "content-type");
+    BOOST_CHECK_EQUAL(headers[2].name, "content-length");
+    BOOST_CHECK_EQUAL(headers[2].value, "2");
+}
+
+BOOST_AUTO_TEST_CASE(replies_wait_for_the_flow_control_window)
+{
+    http2::Session session;
+    // SETTINGS_INITIAL_WINDOW_SIZE of 10 bytes
+    startSession(session, std::string{0, 4} + uint32(10));
+
+    session.SubmitReply(1, 200, {}, std::vector<char>(25, 'x'));
+    auto output = frames(session.TakeOutput());
+    BOOST_REQUIRE_EQUAL(output.size(), 2);
+    BOOST_CHECK_EQUAL(output[1].type, DATA);
+    BOOST_CHECK_EQUAL(output[1].flags, 0);
+    BOOST_CHECK_EQUAL(output[1].payload.size(), 10);
+
+    BOOST_REQUIRE(consume(session, frame(WINDOW_UPDATE, 0, 1, uint32(100))));
+    output = frames(session.TakeOutput());
+    BOOST_REQUIRE_EQUAL(output.size(), 1);
+    BOOST_CHECK_EQUAL(output[0].type, DATA);
+    BOOST_CHECK_EQUAL(output[0].flags, END_STREAM);
+    BOOST_CHECK_EQUAL(output[0].payload.size(), 15);
+}
+
+BOOST_AUTO_TEST_CASE(replies_of_reset_streams_are_dropped)
+{
+    http2::Session session;
+    startSession(session, "");
+
+    BOOST_REQUIRE(consume(session, frame(RST_STREAM, 0, 1, uint32(0x8))));
+    const auto reset_streams = session.TakeResetStreams();
+    BOOST_REQUIRE_EQUAL(reset_streams.size(), 1);
+    BOOST_CHECK_EQUAL(reset_streams[0], 1);
+
+    session.SubmitReply(1, 200, {}, {'{', '}'});
+    BOOST_CHECK(!session.HasOutput());
+}
+
+BOOST_AUTO_TEST_CASE(protocol_errors_close_the_connection)
+{
+    http2::Session bad_preface;
+    BOOST_CHECK(!consume(bad_preface, "GET / HTTP/1.1\r\n\r\n"));
+    auto output = frames(bad_preface.TakeOutput());
+    BOOST_REQUIRE_EQUAL(output.size(), 2);
+    BOOST_CHECK_EQUAL(output[1].type, GOAWAY);
+    BOOST_CHECK(bad_preface.IsDone());
+
+    // streams of clients have odd ids
+    http2::Session even_stream;
+    BOOST_CHECK(!consume(even_stream,
+                         std::string(http2::CONNECTION_PREFACE) + requestHeaders(2, "/")));
+    output = frames(even_stream.TakeOutput());
+    BOOST_REQUIRE_EQUAL(output.size(), 2);
+    BOOST_CHECK_EQUAL(output[1].type, GOAWAY);
+    BOOST_CHECK_EQUAL(output[1].payload, uint32(0) + uint32(0x1));
+    BOOST_CHECK(even_stream.TakeRequests().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
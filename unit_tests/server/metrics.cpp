@@ -0,0 +1,74 @@
+#include "server/metrics.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(metrics)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+bool hasLine(const std::string &text, const std::string &line)
+{
+    return boost::starts_with(text, line + "\n") ||
+           text.find("\n" + line + "\n") != std::string::npos;
+}
+}
+
+BOOST_AUTO_TEST_CASE(render_latency_histograms)
+{
+    Metrics metrics;
+    metrics.ObserveRequest("route", 0.003, 200);
+    metrics.ObserveRequest("route", 0.2, 200);
+    metrics.ObserveRequest("route", 20, 503);
+    metrics.ObserveRequest("unknown-service", 0.001, 400);
+
+    const auto text = metrics.Render({});
+    const std::string route_bucket =
+        "osrm_http_request_duration_seconds_bucket{service=\"route\",le=";
+    const std::string other_bucket =
+        "osrm_http_request_duration_seconds_bucket{service=\"other\",le=";
+    BOOST_CHECK(hasLine(text, "# TYPE osrm_http_request_duration_seconds histogram"));
+    BOOST_CHECK(hasLine(text, route_bucket + "\"0.0025\"} 0"));
+    BOOST_CHECK(hasLine(text, route_bucket + "\"0.005\"} 1"));
+    BOOST_CHECK(hasLine(text, route_bucket + "\"10\"} 2"));
+    BOOST_CHECK(hasLine(text, route_bucket + "\"+Inf\"} 3"));
+    BOOST_CHECK(hasLine(text, "osrm_http_request_duration_seconds_count{service=\"route\"} 3"));
+    BOOST_CHECK(hasLine(text, "osrm_http_request_duration_seconds_sum{service=\"route\"} 20.203"));
+    BOOST_CHECK(hasLine(text, other_bucket + "\"0.001\"} 1"));
+    BOOST_CHECK(hasLine(text, "osrm_http_request_duration_seconds_count{service=\"table\"} 0"));
+
+    BOOST_CHECK(hasLine(text, "osrm_http_responses_total{service=\"route\",code=\"200\"} 2"));
+    BOOST_CHECK(hasLine(text, "osrm_http_responses_total{service=\"route\",code=\"503\"} 1"));
+    BOOST_CHECK(hasLine(text, "osrm_http_responses_total{service=\"other\",code=\"400\"} 1"));
+    BOOST_CHECK(text.find("unknown-service") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(render_connection_metrics_and_gauges)
+{
+    Metrics metrics;
+    metrics.AddConnection();
+    metrics.AddConnection();
+    metrics.RemoveConnection();
+    metrics.AddBytesOut(100);
+    metrics.AddBytesOut(50);
+    metrics.AddCompression(1000, 250);
+    metrics.RegisterGauge("osrm_dataset_timestamp", "Dataset timestamp.", [] { return 7.; });
+
+    const auto text = metrics.Render({{"other", 0}, {"table", 3}});
+    BOOST_CHECK(hasLine(text, "osrm_worker_queue_depth{service=\"other\"} 0"));
+    BOOST_CHECK(hasLine(text, "osrm_worker_queue_depth{service=\"table\"} 3"));
+    BOOST_CHECK(hasLine(text, "osrm_http_active_connections 1"));
+    BOOST_CHECK(hasLine(text, "osrm_http_response_bytes_total 150"));
+    BOOST_CHECK(hasLine(text, "osrm_http_compression_input_bytes_total 1000"));
+    BOOST_CHECK(hasLine(text, "osrm_http_compression_output_bytes_total 250"));
+    BOOST_CHECK(hasLine(text, "osrm_http_compression_ratio 0.25"));
+    BOOST_CHECK(hasLine(text, "# HELP osrm_dataset_timestamp Dataset timestamp."));
+    BOOST_CHECK(hasLine(text, "osrm_dataset_timestamp 7"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
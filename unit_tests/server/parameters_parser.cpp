@@ -3,6 +3,8 @@
 #include "parameters_io.hpp"
 
 #include "engine/api/base_parameters.hpp"
+#include "engine/api/batch_parameters.hpp"
+#include "engine/api/isochrone_parameters.hpp"
 #include "engine/api/match_parameters.hpp"
 #include "engine/api/nearest_parameters.hpp"
 #include "engine/api/route_parameters.hpp"
@@ -73,6 +75,7 @@ BOOST_AUTO_TEST_CASE(invalid_route_urls)
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>(std::string{"1,2;3,"} + '\0'), 6);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?annotations=distances"), 28UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?annotations="), 20UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?metric="), 15UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?annotations=true,false"), 24UL);
     BOOST_CHECK_EQUAL(
         testInvalidOptions<RouteParameters>("1,2;3,4?annotations=&overview=simplified"), 20UL);
@@ -86,6 +89,7 @@ BOOST_AUTO_TEST_CASE(invalid_table_urls)
         testInvalidOptions<TableParameters>("1,2;3,4?sources=1&destinations=1&bla=foo"), 32UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?sources=foo"), 16UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?destinations=foo"), 21UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?annotations=speed"), 20UL);
 }
 
 BOOST_AUTO_TEST_CASE(valid_route_hint)
@@ -491,6 +495,24 @@ BOOST_AUTO_TEST_CASE(valid_route_urls)
     CHECK_EQUAL_RANGE(reference_21.coordinates, result_21->coordinates);
     CHECK_EQUAL_RANGE(reference_21.hints, result_21->hints);
     CHECK_EQUAL_RANGE(reference_21.exclude, result_21->exclude);
+
+    // named metric
+    RouteParameters reference_22{};
+    reference_22.metric = "truck_2";
+    reference_22.coordinates = coords_1;
+    auto result_22 = parseParameters<RouteParameters>("1,2;3,4?metric=truck_2");
+    BOOST_CHECK(result_22);
+    BOOST_CHECK_EQUAL(reference_22.metric, result_22->metric);
+    CHECK_EQUAL_RANGE(reference_22.coordinates, result_22->coordinates);
+    CHECK_EQUAL_RANGE(reference_22.exclude, result_22->exclude);
+
+    // departure time of the day
+    auto result_23 = parseParameters<RouteParameters>("1,2;3,4?depart_at=07:30");
+    BOOST_CHECK(result_23);
+    BOOST_REQUIRE(result_23->depart_at);
+    BOOST_CHECK_EQUAL(*result_23->depart_at, 7 * 60 + 30);
+    BOOST_CHECK(!parseParameters<RouteParameters>("1,2;3,4?depart_at=24:00"));
+    BOOST_CHECK(!parseParameters<RouteParameters>("1,2;3,4?depart_at=7:3"));
 }
 
 BOOST_AUTO_TEST_CASE(valid_table_urls)
@@ -530,6 +552,30 @@ BOOST_AUTO_TEST_CASE(valid_table_urls)
     CHECK_EQUAL_RANGE(reference_1.radiuses, result_3->radiuses);
     CHECK_EQUAL_RANGE(reference_1.approaches, result_3->approaches);
     CHECK_EQUAL_RANGE(reference_1.coordinates, result_3->coordinates);
+    BOOST_CHECK(result_3->annotations == TableParameters::AnnotationsType::Duration);
+
+    auto result_4 = parseParameters<TableParameters>("1,2;3,4?annotations=distance");
+    BOOST_CHECK(result_4);
+    BOOST_CHECK(result_4->annotations == TableParameters::AnnotationsType::Distance);
+    BOOST_CHECK(result_4->IsValid());
+
+    auto result_5 =
+        parseParameters<TableParameters>("1,2;3,4?sources=0&annotations=duration,distance");
+    BOOST_CHECK(result_5);
+    BOOST_CHECK(result_5->annotations == TableParameters::AnnotationsType::All);
+    std::vector<std::size_t> sources_5 = {0};
+    CHECK_EQUAL_RANGE(sources_5, result_5->sources);
+
+    // the binary format only has durations
+    auto result_6 = parseParameters<TableParameters>("1,2;3,4.bin?annotations=distance");
+    BOOST_CHECK(result_6);
+    BOOST_CHECK(!result_6->IsValid());
+
+    auto result_7 = parseParameters<TableParameters>("1,2;3,4?sources=0&approximate=true");
+    BOOST_CHECK(result_7);
+    BOOST_CHECK(result_7->approximate);
+    BOOST_CHECK(!result_3->approximate);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?approximate=yes"), 20UL);
 }
 
 BOOST_AUTO_TEST_CASE(valid_match_urls)
@@ -573,6 +619,11 @@ BOOST_AUTO_TEST_CASE(valid_match_urls)
     CHECK_EQUAL_RANGE(reference_3.radiuses, result_3->radiuses);
     CHECK_EQUAL_RANGE(reference_3.approaches, result_3->approaches);
     CHECK_EQUAL_RANGE(reference_3.coordinates, result_3->coordinates);
+
+    auto result_4 = parseParameters<MatchParameters>("1,2;3,4?session=trace-17.a_b");
+    BOOST_CHECK(result_4);
+    BOOST_CHECK_EQUAL(result_4->session, "trace-17.a_b");
+    BOOST_CHECK(result_1->session.empty());
 }
 
 BOOST_AUTO_TEST_CASE(invalid_match_urls)
@@ -598,6 +649,85 @@ BOOST_AUTO_TEST_CASE(invalid_match_urls)
     BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?waypoints=0,4"), 19UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?waypoints=x;4"), 18UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?waypoints=0;3.5"), 21UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?session="), 16UL);
+}
+
+BOOST_AUTO_TEST_CASE(valid_batch_urls)
+{
+    std::vector<util::Coordinate> coords_1 = {{util::FloatLongitude{1}, util::FloatLatitude{2}},
+                                              {util::FloatLongitude{3}, util::FloatLatitude{4}},
+                                              {util::FloatLongitude{5}, util::FloatLatitude{6}},
+                                              {util::FloatLongitude{7}, util::FloatLatitude{8}}};
+
+    BatchParameters reference_1{};
+    reference_1.coordinates = coords_1;
+    auto result_1 = parseParameters<BatchParameters>("1,2;3,4;5,6;7,8");
+    BOOST_CHECK(result_1);
+    BOOST_CHECK(result_1->IsValid());
+    BOOST_CHECK(result_1->pairs.empty());
+    BOOST_CHECK(result_1->overview == RouteParameters::OverviewType::False);
+    const std::vector<BatchParameters::Pair> consecutive_pairs = {{0, 1}, {2, 3}};
+    BOOST_CHECK(result_1->GetPairs() == consecutive_pairs);
+    CHECK_EQUAL_RANGE(reference_1.coordinates, result_1->coordinates);
+
+    BatchParameters reference_2{};
+    reference_2.coordinates = {coords_1[0], coords_1[1], coords_1[2]};
+    reference_2.pairs = {{0, 1}, {0, 2}, {2, 0}};
+    reference_2.overview = RouteParameters::OverviewType::Full;
+    reference_2.geometries = RouteParameters::GeometriesType::Polyline6;
+    reference_2.continue_straight = false;
+    auto result_2 = parseParameters<BatchParameters>(
+        "1,2;3,4;5,6.json?pairs=0,1;0,2;2,0&overview=full&geometries=polyline6&"
+        "continue_straight=false");
+    BOOST_CHECK(result_2);
+    BOOST_CHECK(result_2->IsValid());
+    BOOST_CHECK(reference_2.pairs == result_2->pairs);
+    BOOST_CHECK(reference_2.GetPairs() == result_2->GetPairs());
+    BOOST_CHECK(reference_2.overview == result_2->overview);
+    BOOST_CHECK(reference_2.geometries == result_2->geometries);
+    BOOST_CHECK_EQUAL(reference_2.continue_straight, result_2->continue_straight);
+    CHECK_EQUAL_RANGE(reference_2.coordinates, result_2->coordinates);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_batch_urls)
+{
+    BOOST_CHECK_EQUAL(testInvalidOptions<BatchParameters>("1,2;3,4?pairs=0"), 15UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<BatchParameters>("1,2;3,4?pairs=0,1;"), 17UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<BatchParameters>("1,2;3,4?pairs=0,x"), 16UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<BatchParameters>("1,2;3,4.bin"), 7UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<BatchParameters>("1,2;3,4?alternatives=true"), 8UL);
+
+    // parseable but not supported
+    BOOST_CHECK(!parseParameters<BatchParameters>("1,2;3,4;5,6")->IsValid());
+    BOOST_CHECK(!parseParameters<BatchParameters>("1,2;3,4?pairs=0,2")->IsValid());
+    BOOST_CHECK(!parseParameters<BatchParameters>("1,2;3,4?steps=true")->IsValid());
+    BOOST_CHECK(!parseParameters<BatchParameters>("1,2;3,4?annotations=true")->IsValid());
+}
+
+BOOST_AUTO_TEST_CASE(valid_isochrone_urls)
+{
+    auto result_1 = parseParameters<IsochroneParameters>("1,2?max_duration=600");
+    BOOST_CHECK(result_1);
+    BOOST_CHECK(result_1->IsValid());
+    BOOST_CHECK_EQUAL(result_1->max_duration, 600.);
+    BOOST_CHECK_EQUAL(result_1->coordinates.size(), 1);
+
+    auto result_2 = parseParameters<IsochroneParameters>("1,2.json?max_duration=90.5&radiuses=10");
+    BOOST_CHECK(result_2);
+    BOOST_CHECK(result_2->IsValid());
+    BOOST_CHECK_EQUAL(result_2->max_duration, 90.5);
+    BOOST_CHECK_EQUAL(result_2->radiuses.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_isochrone_urls)
+{
+    BOOST_CHECK_EQUAL(testInvalidOptions<IsochroneParameters>("1,2?max_duration=x"), 17UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<IsochroneParameters>("1,2?duration=60"), 4UL);
+
+    // parseable but not supported
+    BOOST_CHECK(!parseParameters<IsochroneParameters>("1,2")->IsValid());
+    BOOST_CHECK(!parseParameters<IsochroneParameters>("1,2;3,4?max_duration=60")->IsValid());
+    BOOST_CHECK(!parseParameters<IsochroneParameters>("1,2?max_duration=-60")->IsValid());
 }
 
 BOOST_AUTO_TEST_CASE(valid_nearest_urls)
@@ -696,4 +826,35 @@ BOOST_AUTO_TEST_CASE(valid_trip_urls)
     BOOST_CHECK_EQUAL(param_fail_2, 33UL);
 }
 
+BOOST_AUTO_TEST_CASE(output_format)
+{
+    using engine::api::BaseParameters;
+
+    auto route_json = parseParameters<RouteParameters>("1,2;3,4.json");
+    BOOST_CHECK(route_json);
+    BOOST_CHECK(route_json->format == BaseParameters::OutputFormatType::JSON);
+    auto route_default = parseParameters<RouteParameters>("1,2;3,4?steps=true");
+    BOOST_CHECK(route_default);
+    BOOST_CHECK(route_default->format == BaseParameters::OutputFormatType::JSON);
+
+    auto route_binary = parseParameters<RouteParameters>("1,2;3,4.bin?overview=full");
+    BOOST_CHECK(route_binary);
+    BOOST_CHECK(route_binary->format == BaseParameters::OutputFormatType::Binary);
+    BOOST_CHECK(route_binary->IsValid());
+    auto route_binary_steps = parseParameters<RouteParameters>("1,2;3,4.bin?steps=true");
+    BOOST_CHECK(route_binary_steps);
+    BOOST_CHECK(!route_binary_steps->IsValid());
+
+    auto table_binary = parseParameters<TableParameters>("1,2;3,4.bin?sources=0");
+    BOOST_CHECK(table_binary);
+    BOOST_CHECK(table_binary->format == BaseParameters::OutputFormatType::Binary);
+    auto match_binary = parseParameters<MatchParameters>("1,2;3,4.bin");
+    BOOST_CHECK(match_binary);
+    BOOST_CHECK(match_binary->format == BaseParameters::OutputFormatType::Binary);
+
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4.xml"), 8UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4.binary"), 11UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TripParameters>("1,2;3,4.bin"), 7UL);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
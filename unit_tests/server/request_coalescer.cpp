@@ -0,0 +1,76 @@
+#include "server/request_coalescer.hpp"
+#include "server/http/reply.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(request_coalescer)
+
+using namespace osrm;
+using namespace osrm::server;
+
+BOOST_AUTO_TEST_CASE(followers_get_the_reply_of_the_leader)
+{
+    RequestCoalescer coalescer;
+    std::vector<const http::reply *> replies;
+    const auto follower = [&replies](const http::reply *reply) { replies.push_back(reply); };
+
+    BOOST_CHECK(coalescer.Join("a", follower));
+    BOOST_CHECK(!coalescer.Join("a", follower));
+    BOOST_CHECK(!coalescer.Join("a", follower));
+    // other keys lead their own flight
+    BOOST_CHECK(coalescer.Join("b", follower));
+
+    http::reply reply;
+    const auto followers = coalescer.Finish("a");
+    BOOST_REQUIRE_EQUAL(followers.size(), 2);
+    for (const auto &waiting : followers)
+        waiting(&reply);
+    BOOST_REQUIRE_EQUAL(replies.size(), 2);
+    BOOST_CHECK_EQUAL(replies[0], &reply);
+    BOOST_CHECK_EQUAL(replies[1], &reply);
+
+    BOOST_CHECK(coalescer.Finish("b").empty());
+
+    // a finished flight is not joined anymore
+    BOOST_CHECK(coalescer.Join("a", follower));
+    BOOST_CHECK(coalescer.Finish("a").empty());
+}
+
+BOOST_AUTO_TEST_CASE(cancelled_leader_promotes_followers_in_order)
+{
+    RequestCoalescer coalescer;
+    std::vector<int> called;
+    const auto follower = [&called](const int index) {
+        return [&called, index](const http::reply *) { called.push_back(index); };
+    };
+
+    BOOST_CHECK(coalescer.Join("a", follower(0)));
+    BOOST_CHECK(!coalescer.Join("a", follower(1)));
+    BOOST_CHECK(!coalescer.Join("a", follower(2)));
+
+    RequestCoalescer::Follower promoted;
+    BOOST_REQUIRE(coalescer.Promote("a", promoted));
+    promoted(nullptr);
+    BOOST_CHECK_EQUAL(called.back(), 1);
+
+    // the promoted follower leads the flight now, later requests still follow
+    BOOST_CHECK(!coalescer.Join("a", follower(3)));
+    BOOST_REQUIRE(coalescer.Promote("a", promoted));
+    promoted(nullptr);
+    BOOST_CHECK_EQUAL(called.back(), 2);
+
+    const auto followers = coalescer.Finish("a");
+    BOOST_REQUIRE_EQUAL(followers.size(), 1);
+    followers.front()(nullptr);
+    BOOST_CHECK_EQUAL(called.back(), 3);
+
+    // without followers promoting ends the flight
+    BOOST_CHECK(coalescer.Join("a", follower(4)));
+    BOOST_CHECK(!coalescer.Promote("a", promoted));
+    BOOST_CHECK(coalescer.Join("a", follower(5)));
+    BOOST_CHECK_EQUAL(called.size(), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
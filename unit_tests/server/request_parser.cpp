@@ -0,0 +1,174 @@
+#include "server/http/request.hpp"
+#include "server/request_parser.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <tuple>
+
+BOOST_AUTO_TEST_SUITE(request_parser)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+std::tuple<RequestParser::RequestStatus, http::compression_type, std::size_t>
+parse(RequestParser &parser, http::request &request, std::string &input, std::size_t offset = 0)
+{
+    RequestParser::RequestStatus status;
+    http::compression_type compression_type;
+    char *end;
+    std::tie(status, compression_type, end) =
+        parser.parse(request, &input[offset], &input[0] + input.size());
+    return std::make_tuple(status, compression_type, end - &input[0]);
+}
+}
+
+BOOST_AUTO_TEST_CASE(pipelined_requests)
+{
+    const std::string first = "GET /route/v1/driving/1,2;3,4 HTTP/1.1\r\n"
+                              "Host: localhost\r\n"
+                              "Accept-Encoding: gzip\r\n"
+                              "X-OSRM-Priority: batch\r\n"
+                              "If-None-Match: W/\"1a-2b\"\r\n\r\n";
+    const std::string second = "GET /nearest/v1/driving/1,2 HTTP/1.1\r\n"
+                               "Connection: close\r\n\r\n";
+    std::string input = first + second;
+
+    RequestParser parser;
+    http::request request;
+    RequestParser::RequestStatus status;
+    http::compression_type compression_type;
+    std::size_t position;
+
+    std::tie(status, compression_type, position) = parse(parser, request, input);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(compression_type, http::gzip_rfc1952);
+    BOOST_CHECK_EQUAL(position, first.size());
+    BOOST_CHECK_EQUAL(request.uri, "/route/v1/driving/1,2;3,4");
+    BOOST_CHECK_EQUAL(request.priority, "batch");
+    BOOST_CHECK_EQUAL(request.if_none_match, "W/\"1a-2b\"");
+    BOOST_CHECK(request.keep_alive);
+
+    parser.reset();
+    request = http::request();
+    std::tie(status, compression_type, position) = parse(parser, request, input, position);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(compression_type, http::no_compression);
+    BOOST_CHECK_EQUAL(position, input.size());
+    BOOST_CHECK_EQUAL(request.uri, "/nearest/v1/driving/1,2");
+    BOOST_CHECK(request.priority.empty());
+    BOOST_CHECK(request.if_none_match.empty());
+    BOOST_CHECK(!request.keep_alive);
+}
+
+BOOST_AUTO_TEST_CASE(http_1_0_keep_alive)
+{
+    RequestParser parser;
+    http::request request;
+
+    std::string input = "GET /route/v1/driving/1,2;3,4 HTTP/1.0\r\n\r\n";
+    BOOST_CHECK(std::get<0>(parse(parser, request, input)) ==
+                RequestParser::RequestStatus::valid);
+    BOOST_CHECK(!request.keep_alive);
+
+    parser.reset();
+    request = http::request();
+    input = "GET /route/v1/driving/1,2;3,4 HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n";
+    BOOST_CHECK(std::get<0>(parse(parser, request, input)) ==
+                RequestParser::RequestStatus::valid);
+    BOOST_CHECK(request.keep_alive);
+}
+
+BOOST_AUTO_TEST_CASE(request_split_over_reads)
+{
+    RequestParser parser;
+    http::request request;
+
+    std::string first = "GET /table/v1/driving/" + std::string(10000, '1');
+    std::string second = " HTTP/1.1\r\n\r\n";
+    BOOST_CHECK(std::get<0>(parse(parser, request, first)) ==
+                RequestParser::RequestStatus::indeterminate);
+    BOOST_CHECK(std::get<0>(parse(parser, request, second)) ==
+                RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(request.uri.size(), 10000 + 18);
+}
+
+BOOST_AUTO_TEST_CASE(post_body)
+{
+    const std::string body = "1,2;3,4;5,6?sources=0";
+    const std::string first = "POST /table/v1/driving HTTP/1.1\r\n"
+                              "Content-Type: text/plain\r\n"
+                              "Content-Length: " +
+                              std::to_string(body.size()) + "\r\n\r\n" + body;
+    const std::string second = "GET /nearest/v1/driving/1,2 HTTP/1.1\r\n\r\n";
+    std::string input = first + second;
+
+    RequestParser parser;
+    http::request request;
+    RequestParser::RequestStatus status;
+    http::compression_type compression_type;
+    std::size_t position;
+
+    std::tie(status, compression_type, position) = parse(parser, request, input);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(position, first.size());
+    BOOST_CHECK_EQUAL(request.method, "POST");
+    BOOST_CHECK_EQUAL(request.uri, "/table/v1/driving");
+    BOOST_CHECK_EQUAL(request.body, body);
+    BOOST_CHECK(!parser.take_expected_continue());
+
+    parser.reset();
+    request = http::request();
+    std::tie(status, compression_type, position) = parse(parser, request, input, position);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(position, input.size());
+    BOOST_CHECK_EQUAL(request.method, "GET");
+    BOOST_CHECK(request.body.empty());
+}
+
+BOOST_AUTO_TEST_CASE(post_body_split_over_reads)
+{
+    RequestParser parser;
+    http::request request;
+
+    const std::string body(100000, '1');
+    std::string headers = "POST /table/v1/driving/ HTTP/1.1\r\n"
+                          "Expect: 100-continue\r\n"
+                          "Content-Length: " +
+                          std::to_string(body.size()) + "\r\n\r\n";
+    BOOST_CHECK(std::get<0>(parse(parser, request, headers)) ==
+                RequestParser::RequestStatus::indeterminate);
+    BOOST_CHECK(parser.take_expected_continue());
+    BOOST_CHECK(!parser.take_expected_continue());
+
+    std::string first = body.substr(0, 8192 + 1);
+    std::string second = body.substr(first.size());
+    BOOST_CHECK(std::get<0>(parse(parser, request, first)) ==
+                RequestParser::RequestStatus::indeterminate);
+    BOOST_CHECK(std::get<0>(parse(parser, request, second)) ==
+                RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(request.body, body);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_post_body)
+{
+    const auto parse_headers = [](std::string input) {
+        RequestParser parser;
+        http::request request;
+        return std::get<0>(parse(parser, request, input));
+    };
+
+    BOOST_CHECK(parse_headers("POST /table/v1/driving HTTP/1.1\r\n"
+                              "Content-Length: 1x\r\n\r\n") ==
+                RequestParser::RequestStatus::invalid);
+    BOOST_CHECK(parse_headers("POST /table/v1/driving HTTP/1.1\r\n"
+                              "Content-Length: 1000000000\r\n\r\n") ==
+                RequestParser::RequestStatus::invalid);
+    BOOST_CHECK(parse_headers("POST /table/v1/driving HTTP/1.1\r\n"
+                              "Transfer-Encoding: chunked\r\n\r\n") ==
+                RequestParser::RequestStatus::invalid);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,277 @@
+#include "server/worker_pool.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(worker_pool)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+// Blocks tasks until it is opened
+class Gate
+{
+  public:
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return open; });
+    }
+
+    void Open()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            open = true;
+        }
+        condition.notify_all();
+    }
+
+  private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool open = false;
+};
+}
+
+BOOST_AUTO_TEST_CASE(runs_all_tasks)
+{
+    std::atomic<int> counter{0};
+    {
+        WorkerPool pool(4, 1000);
+        for (int i = 0; i < 100; ++i)
+        {
+            BOOST_CHECK(pool.Post(i % 2 == 0 ? "route" : "table", [&counter] { ++counter; }));
+        }
+        while (counter < 100)
+        {
+            std::this_thread::yield();
+        }
+    }
+    BOOST_CHECK_EQUAL(counter, 100);
+}
+
+BOOST_AUTO_TEST_CASE(pinned_workers_run_all_tasks)
+{
+    std::atomic<int> counter{0};
+    {
+        WorkerPool pool(3, 1000, true);
+        for (int i = 0; i < 30; ++i)
+        {
+            BOOST_CHECK(pool.Post("nearest", [&counter] { ++counter; }));
+        }
+        while (counter < 30)
+        {
+            std::this_thread::yield();
+        }
+    }
+    BOOST_CHECK_EQUAL(counter, 30);
+}
+
+BOOST_AUTO_TEST_CASE(rejects_tasks_of_full_queue)
+{
+    Gate gate;
+    std::atomic<int> started{0};
+
+    WorkerPool pool(2, 2);
+    const auto blocking_task = [&] {
+        ++started;
+        gate.Wait();
+    };
+
+    // with two workers a single service only runs on one of them
+    BOOST_CHECK(pool.Post("table", blocking_task));
+    while (started < 1)
+    {
+        std::this_thread::yield();
+    }
+    BOOST_CHECK(pool.Post("table", blocking_task));
+    BOOST_CHECK(pool.Post("table", blocking_task));
+    BOOST_CHECK(!pool.Post("table", blocking_task));
+    const auto depths = pool.QueueDepths();
+    const auto table_depth = std::make_pair(std::string("table"), std::size_t{2});
+    BOOST_CHECK(std::find(depths.begin(), depths.end(), table_depth) != depths.end());
+
+    // other services still have a free worker
+    std::atomic<bool> nearest_done{false};
+    BOOST_CHECK(pool.Post("nearest", [&] { nearest_done = true; }));
+    while (!nearest_done)
+    {
+        std::this_thread::yield();
+    }
+    BOOST_CHECK_EQUAL(started, 1);
+
+    gate.Open();
+    while (started < 3)
+    {
+        std::this_thread::yield();
+    }
+    pool.Stop();
+    BOOST_CHECK(!pool.Post("table", blocking_task));
+}
+
+BOOST_AUTO_TEST_CASE(runs_task_on_every_worker)
+{
+    Gate gate;
+    std::atomic<bool> started{false};
+
+    WorkerPool pool(3, 10);
+    // busy workers run the task after their current one
+    BOOST_CHECK(pool.Post("table", [&] {
+        started = true;
+        gate.Wait();
+    }));
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::thread opener([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        gate.Open();
+    });
+    pool.RunOnEveryWorker([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    });
+    opener.join();
+    BOOST_CHECK_EQUAL(threads.size(), 3);
+
+    // the pool keeps serving requests afterwards
+    std::atomic<int> counter{0};
+    for (int i = 0; i < 10; ++i)
+    {
+        BOOST_CHECK(pool.Post("route", [&counter] { ++counter; }));
+    }
+    while (counter < 10)
+    {
+        std::this_thread::yield();
+    }
+
+    threads.clear();
+    pool.RunOnEveryWorker([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    });
+    BOOST_CHECK_EQUAL(threads.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(serves_interactive_tasks_before_batch_tasks)
+{
+    Gate gate;
+    std::atomic<bool> started{false};
+
+    WorkerPool pool(1, 10);
+    BOOST_CHECK(pool.Post("nearest", [&] {
+        started = true;
+        gate.Wait();
+    }));
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+
+    std::vector<std::string> order;
+    std::atomic<int> done{0};
+    BOOST_CHECK(pool.Post("table",
+                          [&] {
+                              order.push_back("batch");
+                              ++done;
+                          },
+                          WorkerPool::Priority::Batch));
+    BOOST_CHECK(pool.Post("route", [&] {
+        order.push_back("interactive");
+        ++done;
+    }));
+
+    gate.Open();
+    while (done < 2)
+    {
+        std::this_thread::yield();
+    }
+    BOOST_CHECK_EQUAL(order.front(), "interactive");
+    BOOST_CHECK_EQUAL(order.back(), "batch");
+}
+
+BOOST_AUTO_TEST_CASE(batch_tasks_leave_a_worker_free)
+{
+    Gate gate;
+    std::atomic<int> started{0};
+
+    WorkerPool pool(2, 10);
+    const auto blocking_task = [&] {
+        ++started;
+        gate.Wait();
+    };
+
+    BOOST_CHECK(pool.Post("table", blocking_task, WorkerPool::Priority::Batch));
+    BOOST_CHECK(pool.Post("trip", blocking_task, WorkerPool::Priority::Batch));
+    while (started < 1)
+    {
+        std::this_thread::yield();
+    }
+
+    std::atomic<bool> route_done{false};
+    BOOST_CHECK(pool.Post("route", [&] { route_done = true; }));
+    while (!route_done)
+    {
+        std::this_thread::yield();
+    }
+    BOOST_CHECK_EQUAL(started, 1);
+
+    gate.Open();
+    while (started < 2)
+    {
+        std::this_thread::yield();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sheds_tasks_that_waited_too_long)
+{
+    Gate gate;
+    std::atomic<bool> started{false};
+
+    WorkerPool pool(1, 10, false, std::chrono::milliseconds(20));
+    BOOST_CHECK(pool.Post("table", [&] {
+        started = true;
+        gate.Wait();
+    }));
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+
+    std::atomic<bool> ran{false};
+    std::atomic<bool> rejected{false};
+    BOOST_CHECK(pool.Post("route", [&] { ran = true; }, WorkerPool::Priority::Interactive, [&] {
+        rejected = true;
+    }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    // the oldest task of the queue waits longer than the budget already
+    BOOST_CHECK(!pool.Post("route", [] {}));
+    // other priorities and services are not affected
+    BOOST_CHECK(pool.Post("route", [] {}, WorkerPool::Priority::Batch));
+
+    gate.Open();
+    while (!rejected)
+    {
+        std::this_thread::yield();
+    }
+    BOOST_CHECK(!ran);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
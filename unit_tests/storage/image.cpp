@@ -0,0 +1,99 @@
+#include "storage/image.hpp"
+
+#include "../common/temporary_file.hpp"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <numeric>
+
+BOOST_AUTO_TEST_SUITE(image)
+
+using namespace osrm;
+using namespace osrm::storage;
+
+BOOST_AUTO_TEST_CASE(write_and_map_image)
+{
+    TemporaryFile file;
+
+    DataLayout layout;
+    layout.SetBlock("/common/a", Block{100, 100 * sizeof(std::uint32_t)});
+    layout.SetBlock("/common/b", Block{3, 3 * sizeof(std::uint64_t)});
+
+    writeImage(file.path, layout, [](const SharedDataIndex &index) {
+        auto a = index.GetBlockPtr<std::uint32_t>("/common/a");
+        std::iota(a, a + index.GetBlockEntries("/common/a"), 0);
+        auto b = index.GetBlockPtr<std::uint64_t>("/common/b");
+        b[0] = 1;
+        b[1] = 2;
+        b[2] = 3;
+    });
+    // the temporary file was renamed to the image
+    const auto prefix = file.path.filename().string() + ".";
+    for (const auto &entry : boost::filesystem::directory_iterator(
+             boost::filesystem::absolute(file.path).parent_path()))
+        BOOST_CHECK(entry.path().filename().string().compare(0, prefix.size(), prefix) != 0);
+
+    for (const auto populate : {false, true})
+    {
+        MappedImage image(file.path, populate);
+        const auto &index = image.GetIndex();
+
+        BOOST_CHECK_EQUAL(index.GetBlockEntries("/common/a"), 100);
+        const auto a = index.GetBlockPtr<std::uint32_t>("/common/a");
+        for (std::uint32_t value = 0; value < 100; ++value)
+            BOOST_CHECK_EQUAL(a[value], value);
+
+        const auto b = index.GetBlockPtr<std::uint64_t>("/common/b");
+        BOOST_CHECK_EQUAL(b[0], 1);
+        BOOST_CHECK_EQUAL(b[1], 2);
+        BOOST_CHECK_EQUAL(b[2], 3);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(replace_mapped_image)
+{
+    TemporaryFile file;
+    BOOST_CHECK(!getImageFileId(file.path).IsValid());
+
+    DataLayout layout;
+    layout.SetBlock("/common/a", Block{1, sizeof(std::uint32_t)});
+    const auto write = [&](const std::uint32_t value) {
+        writeImage(file.path, layout, [value](const SharedDataIndex &index) {
+            *index.GetBlockPtr<std::uint32_t>("/common/a") = value;
+        });
+    };
+
+    write(1);
+    MappedImage first(file.path, false);
+    BOOST_CHECK(first.GetFileId().IsValid());
+    BOOST_CHECK(first.GetFileId() == getImageFileId(file.path));
+
+    // the new image is a new file, the old mapping keeps the old one
+    write(2);
+    MappedImage second(file.path, false);
+    BOOST_CHECK(second.GetFileId() != first.GetFileId());
+    BOOST_CHECK(second.GetFileId() == getImageFileId(file.path));
+    BOOST_CHECK_EQUAL(*first.GetIndex().GetBlockPtr<std::uint32_t>("/common/a"), 1);
+    BOOST_CHECK_EQUAL(*second.GetIndex().GetBlockPtr<std::uint32_t>("/common/a"), 2);
+}
+
+BOOST_AUTO_TEST_CASE(reject_other_files)
+{
+    TemporaryFile file;
+    {
+        boost::filesystem::ofstream out(file.path);
+        out << "this is not an image of a dataset, but it is longer than the header";
+    }
+    BOOST_CHECK_THROW(MappedImage(file.path, false), util::exception);
+
+    TemporaryFile empty_file;
+    {
+        boost::filesystem::ofstream out(empty_file.path);
+    }
+    BOOST_CHECK_THROW(MappedImage(empty_file.path, false), util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
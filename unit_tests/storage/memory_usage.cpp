@@ -0,0 +1,69 @@
+#include "storage/memory_usage.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(memory_usage)
+
+using namespace osrm;
+using namespace osrm::storage;
+
+BOOST_AUTO_TEST_CASE(subsystems_of_blocks)
+{
+    BOOST_CHECK_EQUAL(getSubsystem("/common/rtree/leaves"), "rtree");
+    BOOST_CHECK_EQUAL(getSubsystem("/common/names/values"), "names");
+    BOOST_CHECK_EQUAL(getSubsystem("/common/segment_data/nodes"), "geometry");
+    BOOST_CHECK_EQUAL(getSubsystem("/common/turn_lanes/data"), "guidance");
+    BOOST_CHECK_EQUAL(getSubsystem("/mld/multilevelgraph/node_array"), "mld/graph");
+    BOOST_CHECK_EQUAL(getSubsystem("/mld/metrics/duration/exclude/0/weights"),
+                      "mld/cells/duration");
+    BOOST_CHECK_EQUAL(getSubsystem("/ch/metrics/routability/contracted_graph/edge_array"),
+                      "ch/graph/routability");
+    BOOST_CHECK_EQUAL(getSubsystem("/common/properties"), "other");
+}
+
+BOOST_AUTO_TEST_CASE(memory_of_blocks)
+{
+    DataLayout layout;
+    layout.SetBlock("/common/rtree/leaves", Block{1000, 1000 * 16});
+    layout.SetBlock("/common/names/values", Block{10, 10});
+    layout.SetBlock("/mld/metrics/duration/exclude/0/weights", Block{5000, 5000 * 4});
+    layout.SetBlock("/mld/metrics/duration/exclude/0/durations", Block{5000, 5000 * 4});
+
+    // the buffer is written when it is allocated, all of its pages are resident
+    std::vector<char> buffer(layout.GetSizeOfLayout(), 1);
+    const SharedDataIndex index({{buffer.data(), layout}});
+
+    const auto blocks = getMemoryUsage(index);
+    BOOST_REQUIRE_EQUAL(blocks.size(), 4);
+    BOOST_CHECK_EQUAL(blocks[0].name, "/common/names/values");
+    BOOST_CHECK_EQUAL(blocks[0].entries, 10);
+    BOOST_CHECK_EQUAL(blocks[1].name, "/common/rtree/leaves");
+    BOOST_CHECK_EQUAL(blocks[1].subsystem, "rtree");
+    for (const auto &block : blocks)
+    {
+        BOOST_CHECK_EQUAL(block.mapped_bytes, layout.GetBlockSize(block.name));
+        BOOST_CHECK_EQUAL(block.resident_bytes, block.mapped_bytes);
+    }
+
+    const auto report = makeMemoryReport(blocks);
+    BOOST_CHECK_EQUAL(report.values.at("mapped_bytes").get<util::json::Number>().value,
+                      10 + 1000 * 16 + 2 * 5000 * 4);
+    const auto &subsystems = report.values.at("subsystems").get<util::json::Object>().values;
+    BOOST_REQUIRE_EQUAL(subsystems.size(), 3);
+    const auto &cells = subsystems.at("mld/cells/duration").get<util::json::Object>().values;
+    BOOST_CHECK_EQUAL(cells.at("mapped_bytes").get<util::json::Number>().value, 2 * 5000 * 4);
+
+    // the largest blocks come first
+    const auto &blocks_json = report.values.at("blocks").get<util::json::Array>().values;
+    BOOST_REQUIRE_EQUAL(blocks_json.size(), 4);
+    const auto &largest = blocks_json[0].get<util::json::Object>().values;
+    BOOST_CHECK_EQUAL(largest.at("name").get<util::json::String>().value,
+                      "/mld/metrics/duration/exclude/0/durations");
+    const auto &smallest = blocks_json[3].get<util::json::Object>().values;
+    BOOST_CHECK_EQUAL(smallest.at("name").get<util::json::String>().value,
+                      "/common/names/values");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,50 @@
+#include "storage/shared_data_index.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(shared_data_index)
+
+using namespace osrm;
+using namespace osrm::storage;
+
+BOOST_AUTO_TEST_CASE(blocks_of_two_regions)
+{
+    DataLayout static_layout;
+    static_layout.SetBlock("/static/a", Block{4, 4 * sizeof(std::uint32_t)});
+    DataLayout updatable_layout;
+    updatable_layout.SetBlock("/updatable/b", Block{2, 2 * sizeof(std::uint64_t)});
+
+    std::vector<char> static_memory(static_layout.GetSizeOfLayout());
+    std::vector<char> updatable_memory(updatable_layout.GetSizeOfLayout());
+
+    SharedDataIndex index{{{static_memory.data(), static_layout},
+                           {updatable_memory.data(), updatable_layout}}};
+
+    BOOST_CHECK(index.HasBlock("/static/a"));
+    BOOST_CHECK(index.HasBlock("/updatable/b"));
+    BOOST_CHECK(!index.HasBlock("/missing"));
+    BOOST_CHECK_EQUAL(index.GetBlockEntries("/static/a"), 4);
+    BOOST_CHECK_EQUAL(index.GetBlockSize("/updatable/b"), 2 * sizeof(std::uint64_t));
+
+    auto static_ptr = index.GetBlockPtr<char>("/static/a");
+    auto updatable_ptr = index.GetBlockPtr<char>("/updatable/b");
+    BOOST_CHECK(static_ptr >= static_memory.data() &&
+                static_ptr < static_memory.data() + static_memory.size());
+    BOOST_CHECK(updatable_ptr >= updatable_memory.data() &&
+                updatable_ptr < updatable_memory.data() + updatable_memory.size());
+
+    // lists the directories of both regions
+    std::vector<std::string> names;
+    index.List("/", std::back_inserter(names));
+    std::vector<std::string> expected_names = {"/static", "/updatable"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        names.begin(), names.end(), expected_names.begin(), expected_names.end());
+
+    BOOST_CHECK_THROW(index.GetBlockPtr<char>("/missing"), util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,10 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <fstream>
+#include <numeric>
+#include <thread>
+
 BOOST_AUTO_TEST_SUITE(tar)
 
 using namespace osrm;
@@ -187,4 +191,149 @@ BOOST_AUTO_TEST_CASE(continue_write_tar_file)
     CHECK_EQUAL_COLLECTIONS(result_64bit_vector, vector_64bit);
 }
 
+BOOST_AUTO_TEST_CASE(read_large_tar_entries)
+{
+    TemporaryFile tmp{TEST_DATA_DIR "/tar_large_test.tar"};
+
+    // spans several read chunks and does not end at a chunk boundary
+    std::vector<std::uint32_t> large_vector(2.5 * storage::tar::detail::READ_CHUNK_SIZE /
+                                            sizeof(std::uint32_t));
+    std::iota(large_vector.begin(), large_vector.end(), 0);
+    std::vector<std::uint64_t> small_vector = {1, 2, 3};
+
+    {
+        storage::tar::FileWriter writer(tmp.path, storage::tar::FileWriter::GenerateFingerprint);
+        writer.WriteFrom("large", large_vector.data(), large_vector.size());
+        writer.WriteFrom("small", small_vector.data(), small_vector.size());
+    }
+
+    storage::tar::FileReader reader(tmp.path, storage::tar::FileReader::VerifyFingerprint);
+
+    std::vector<std::uint32_t> streamed_vector;
+    reader.ReadStreaming<std::uint32_t>("large", std::back_inserter(streamed_vector));
+    CHECK_EQUAL_COLLECTIONS(streamed_vector, large_vector);
+
+    // the reads don't share a file position
+    std::vector<std::uint32_t> result_large(large_vector.size());
+    std::vector<std::uint64_t> result_small(small_vector.size());
+    std::thread large_thread(
+        [&] { reader.ReadInto("large", result_large.data(), result_large.size()); });
+    std::thread small_thread(
+        [&] { reader.ReadInto("small", result_small.data(), result_small.size()); });
+    large_thread.join();
+    small_thread.join();
+    CHECK_EQUAL_COLLECTIONS(result_large, large_vector);
+    CHECK_EQUAL_COLLECTIONS(result_small, small_vector);
+
+    std::uint64_t missing;
+    BOOST_CHECK_THROW(reader.ReadInto("missing", missing), util::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE(write_compressed_tar_entries)
+{
+    TemporaryFile tmp{TEST_DATA_DIR "/tar_compressed_test.tar"};
+
+    // several compression blocks, the last one is shorter
+    std::vector<std::uint32_t> large_vector(2.5 * storage::tar::detail::COMPRESSION_BLOCK_SIZE /
+                                            sizeof(std::uint32_t));
+    std::iota(large_vector.begin(), large_vector.end(), 0);
+    std::vector<std::uint64_t> small_vector = {1, 2, 3};
+
+    {
+        storage::tar::FileWriter writer(tmp.path,
+                                        storage::tar::FileWriter::GenerateFingerprint,
+                                        storage::tar::FileWriter::CompressLargeEntries);
+        writer.WriteElementCount64("large", large_vector.size());
+        writer.WriteFrom("large", large_vector.data(), large_vector.size());
+        writer.WriteFrom("small", small_vector.data(), small_vector.size());
+    }
+
+    storage::tar::FileReader reader(tmp.path, storage::tar::FileReader::VerifyFingerprint);
+
+    std::vector<storage::tar::FileReader::FileEntry> file_list;
+    reader.List(std::back_inserter(file_list));
+    BOOST_REQUIRE_EQUAL(file_list.size(), 4);
+    BOOST_CHECK_EQUAL(file_list[2].name, "large");
+    BOOST_CHECK_EQUAL(file_list[2].size, large_vector.size() * sizeof(std::uint32_t));
+    BOOST_CHECK(file_list[2].compressed);
+    BOOST_CHECK_EQUAL(file_list[3].name, "small");
+    BOOST_CHECK(!file_list[3].compressed);
+
+    BOOST_CHECK_EQUAL(reader.ReadElementCount64("large"), large_vector.size());
+    std::vector<std::uint32_t> result_large(large_vector.size());
+    reader.ReadInto("large", result_large.data(), result_large.size());
+    CHECK_EQUAL_COLLECTIONS(result_large, large_vector);
+
+    std::vector<std::uint32_t> streamed_vector;
+    reader.ReadStreaming<std::uint32_t>("large", std::back_inserter(streamed_vector));
+    CHECK_EQUAL_COLLECTIONS(streamed_vector, large_vector);
+
+    std::vector<std::uint64_t> result_small(small_vector.size());
+    reader.ReadInto("small", result_small.data(), result_small.size());
+    CHECK_EQUAL_COLLECTIONS(result_small, small_vector);
+}
+
+BOOST_AUTO_TEST_CASE(verify_tar_checksums)
+{
+    TemporaryFile compressed{TEST_DATA_DIR "/tar_checksums_test.tar"};
+    TemporaryFile uncompressed{TEST_DATA_DIR "/tar_checksums_uncompressed_test.tar"};
+
+    // several checksum blocks, the last one is shorter
+    std::vector<std::uint32_t> large_vector(2.5 * storage::tar::detail::CHECKSUM_BLOCK_SIZE /
+                                            sizeof(std::uint32_t));
+    std::iota(large_vector.begin(), large_vector.end(), 0);
+    std::vector<std::uint64_t> small_vector = {1, 2, 3};
+
+    {
+        storage::tar::FileWriter writer(compressed.path,
+                                        storage::tar::FileWriter::GenerateFingerprint,
+                                        storage::tar::FileWriter::CompressLargeEntries);
+        writer.WriteFrom("large", large_vector.data(), large_vector.size());
+        writer.WriteStreaming<std::uint64_t>("streamed", small_vector.begin(), small_vector.size());
+    }
+    {
+        storage::tar::FileWriter writer(uncompressed.path,
+                                        storage::tar::FileWriter::GenerateFingerprint);
+        writer.WriteFrom("large", large_vector.data(), large_vector.size());
+        writer.WriteFrom("small", small_vector.data(), small_vector.size());
+    }
+
+    std::size_t large_offset = 0;
+    for (const auto &path : {compressed.path, uncompressed.path})
+    {
+        storage::tar::FileReader reader(path, storage::tar::FileReader::VerifyFingerprint);
+
+        // the checksums are not listed
+        std::vector<storage::tar::FileReader::FileEntry> file_list;
+        reader.List(std::back_inserter(file_list));
+        BOOST_REQUIRE_EQUAL(file_list.size(), 3);
+        for (const auto &entry : file_list)
+        {
+            BOOST_CHECK(entry.checksums_offset > 0);
+        }
+        large_offset = file_list[1].offset;
+
+        std::size_t stored_size = 0;
+        for (const auto &entry : file_list)
+        {
+            stored_size += entry.stored_size;
+        }
+        BOOST_CHECK_EQUAL(reader.VerifyChecksums(), stored_size);
+    }
+
+    // flip a bit in the last block of the uncompressed entry
+    {
+        std::fstream file(uncompressed.path.string(),
+                          std::ios::in | std::ios::out | std::ios::binary);
+        const auto position = large_offset + large_vector.size() * sizeof(std::uint32_t) - 1;
+        file.seekg(position);
+        const auto byte = static_cast<char>(file.get() ^ 1);
+        file.seekp(position);
+        file.put(byte);
+    }
+    storage::tar::FileReader reader(uncompressed.path,
+                                    storage::tar::FileReader::VerifyFingerprint);
+    BOOST_CHECK_THROW(reader.VerifyChecksums(), util::RuntimeError);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,160 @@
+#include "updater/csv_source.hpp"
+
+#include "util/exception.hpp"
+
+#include "../common/temporary_file.hpp"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+BOOST_AUTO_TEST_SUITE(csv_source)
+
+using namespace osrm;
+using namespace osrm::updater;
+
+namespace
+{
+void writeFile(const TemporaryFile &file, const std::string &content)
+{
+    boost::filesystem::ofstream stream(file.path, std::ios::binary);
+    stream << content;
+}
+}
+
+BOOST_AUTO_TEST_CASE(later_lines_and_files_take_precedence)
+{
+    TemporaryFile first, second;
+    writeFile(first, "1,2,10\n3,4,20,1.5\n1,2,11\n5,6,30,\n");
+    writeFile(second, "3,4,40\n7,8,50,2,comment\n");
+
+    const auto lookup = csv::readSegmentValues({first.path.string(), second.path.string()});
+    BOOST_CHECK_EQUAL(lookup.lookup.size(), 4);
+
+    BOOST_REQUIRE(lookup(Segment{1, 2}));
+    BOOST_CHECK_EQUAL(lookup(Segment{1, 2})->speed, 11);
+    BOOST_CHECK_EQUAL(lookup(Segment{1, 2})->source, 1);
+    BOOST_CHECK(!lookup(Segment{1, 2})->rate);
+
+    BOOST_REQUIRE(lookup(Segment{3, 4}));
+    BOOST_CHECK_EQUAL(lookup(Segment{3, 4})->speed, 40);
+    BOOST_CHECK_EQUAL(lookup(Segment{3, 4})->source, 2);
+
+    BOOST_REQUIRE(lookup(Segment{5, 6}));
+    BOOST_REQUIRE(lookup(Segment{5, 6})->rate);
+    BOOST_CHECK(std::isnan(*lookup(Segment{5, 6})->rate));
+
+    BOOST_REQUIRE(lookup(Segment{7, 8}));
+    BOOST_CHECK_EQUAL(*lookup(Segment{7, 8})->rate, 2.);
+
+    BOOST_CHECK(!lookup(Segment{2, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(files_are_parsed_in_chunks)
+{
+    // several chunks of the parser, with the same segments at the start and at the end
+    const std::uint64_t number_of_segments = 500000;
+    std::string content;
+    for (std::uint64_t node = 0; node < number_of_segments; ++node)
+    {
+        content += std::to_string(node) + "," + std::to_string(node + 1) + ",10,0.5,comment\n";
+    }
+    for (std::uint64_t node = 0; node < number_of_segments; node += 1000)
+    {
+        content += std::to_string(node) + "," + std::to_string(node + 1) + ",20\r\n";
+    }
+    BOOST_REQUIRE_GT(content.size(), 2 * 4 * 1024 * 1024);
+    TemporaryFile file;
+    writeFile(file, content);
+
+    const auto lookup = csv::readSegmentValues({file.path.string()});
+    BOOST_REQUIRE_EQUAL(lookup.lookup.size(), number_of_segments);
+    for (std::uint64_t node = 0; node < number_of_segments; ++node)
+    {
+        const auto value = lookup(Segment{node, node + 1});
+        BOOST_REQUIRE(value);
+        BOOST_CHECK_EQUAL(value->speed, node % 1000 == 0 ? 20 : 10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(malformed_lines_are_reported)
+{
+    TemporaryFile file;
+    writeFile(file, "1,2,10\n3,4,x\n");
+    BOOST_CHECK_THROW(csv::readSegmentValues({file.path.string()}), util::exception);
+}
+
+BOOST_AUTO_TEST_CASE(binary_speed_files)
+{
+    TemporaryFile csv_file, binary_file, later_file;
+    writeFile(csv_file, "5,6,30,\n1,2,10\n3,4,20,1.5\n");
+    writeFile(later_file, "3,4,40\n");
+
+    const auto csv_lookup = csv::readSegmentValues({csv_file.path.string()});
+    csv::writeSegmentValues(binary_file.path.string(), csv_lookup);
+
+    const auto binary_lookup = csv::readSegmentValues({binary_file.path.string()});
+    BOOST_REQUIRE_EQUAL(binary_lookup.lookup.size(), csv_lookup.lookup.size());
+    for (const auto &entry : csv_lookup.lookup)
+    {
+        const auto value = binary_lookup(entry.first);
+        BOOST_REQUIRE(value);
+        BOOST_CHECK_EQUAL(value->speed, entry.second.speed);
+        BOOST_CHECK_EQUAL(value->source, 1);
+        BOOST_REQUIRE_EQUAL(static_cast<bool>(value->rate), static_cast<bool>(entry.second.rate));
+    }
+    BOOST_CHECK_EQUAL(*binary_lookup(Segment{3, 4})->rate, 1.5);
+    BOOST_CHECK(std::isnan(*binary_lookup(Segment{5, 6})->rate));
+
+    // binary and CSV files can be mixed
+    const auto mixed_lookup =
+        csv::readSegmentValues({binary_file.path.string(), later_file.path.string()});
+    BOOST_CHECK_EQUAL(mixed_lookup(Segment{3, 4})->speed, 40);
+    BOOST_CHECK_EQUAL(mixed_lookup(Segment{3, 4})->source, 2);
+    BOOST_CHECK_EQUAL(mixed_lookup(Segment{1, 2})->source, 1);
+
+    // a truncated file is not read as CSV
+    const auto size = boost::filesystem::file_size(binary_file.path);
+    boost::filesystem::resize_file(binary_file.path, size - 1);
+    BOOST_CHECK_THROW(csv::readSegmentValues({binary_file.path.string()}), util::exception);
+}
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(named_pipes_are_read_to_their_end)
+{
+    TemporaryFile csv_file, binary_file, pipe;
+    writeFile(csv_file, "1,2,10\n3,4,20,1.5\n");
+    csv::writeSegmentValues(binary_file.path.string(),
+                            csv::readSegmentValues({csv_file.path.string()}));
+
+    // a traffic feed writes its binary records to the pipe
+    BOOST_REQUIRE_EQUAL(::mkfifo(pipe.path.c_str(), 0600), 0);
+    std::thread feed([&] {
+        boost::filesystem::ifstream records(binary_file.path, std::ios::binary);
+        boost::filesystem::ofstream stream(pipe.path, std::ios::binary);
+        stream << records.rdbuf();
+    });
+    const auto lookup = csv::readSegmentValues({pipe.path.string()});
+    feed.join();
+
+    BOOST_CHECK_EQUAL(lookup.lookup.size(), 2);
+    BOOST_REQUIRE(lookup(Segment{3, 4}));
+    BOOST_CHECK_EQUAL(lookup(Segment{3, 4})->speed, 20);
+    BOOST_CHECK_EQUAL(*lookup(Segment{3, 4})->rate, 1.5);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(stdin_is_read_once)
+{
+    BOOST_CHECK_THROW(csv::readSegmentValues({"-", "-"}), util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,50 @@
+#include "updater/source.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(lookup_table)
+
+using namespace osrm;
+using namespace osrm::updater;
+
+BOOST_AUTO_TEST_CASE(hash_index_finds_the_same_values)
+{
+    SegmentLookupTable table;
+    // the lookup is sorted descending on the key
+    for (std::uint64_t from = 1000; from > 0; --from)
+    {
+        SpeedSource value;
+        value.speed = from;
+        table.lookup.push_back({Segment{from, from + 1}, value});
+    }
+
+    std::vector<boost::optional<SpeedSource>> searched_values;
+    for (std::uint64_t from = 0; from <= 1001; ++from)
+    {
+        searched_values.push_back(table(Segment{from, from + 1}));
+    }
+
+    table.BuildIndex();
+    BOOST_CHECK_GE(table.index.size(), 2 * table.lookup.size());
+    for (std::uint64_t from = 0; from <= 1001; ++from)
+    {
+        const auto value = table(Segment{from, from + 1});
+        BOOST_REQUIRE_EQUAL(static_cast<bool>(value), static_cast<bool>(searched_values[from]));
+        if (value)
+        {
+            BOOST_CHECK_EQUAL(value->speed, from);
+        }
+        BOOST_CHECK(!table(Segment{from + 1, from}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(hash_index_of_empty_table)
+{
+    TurnLookupTable table;
+    table.BuildIndex();
+    BOOST_CHECK(!table(Turn{1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
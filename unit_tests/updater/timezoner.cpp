@@ -2,9 +2,15 @@
 #include "util/geojson_validation.hpp"
 #include "util/timezones.hpp"
 
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <random>
+#include <string>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(timezoner)
 
 using namespace osrm;
@@ -54,4 +60,94 @@ BOOST_AUTO_TEST_CASE(timezoner_test)
         "49.07206], [8.28369, 48.88277]]] }} ]}";
     BOOST_CHECK_THROW(Timezoner tz(missing_featc, now), util::exception);
 }
+
+// Time zones of a triangle with long edges, a square in it and a square next to it
+const char zones_json[] =
+    "{ \"type\" : \"FeatureCollection\", \"features\": ["
+    "{ \"type\" : \"Feature\", \"properties\" : { \"tzid\" : \"Asia/Tokyo\"}, "
+    "\"geometry\" : { \"type\": \"Polygon\", \"coordinates\": "
+    "[[[10, 10], [14, 11], [12, 14], [10, 10]]] }},"
+    "{ \"type\" : \"Feature\", \"properties\" : { \"tzid\" : \"Europe/Berlin\"}, "
+    "\"geometry\" : { \"type\": \"Polygon\", \"coordinates\": "
+    "[[[-20, 40], [30, 40], [30, 70], [5, 60], [-20, 70], [-20, 40]]] }},"
+    "{ \"type\" : \"Feature\", \"properties\" : { \"tzid\" : \"America/New_York\"}, "
+    "\"geometry\" : { \"type\": \"Polygon\", \"coordinates\": "
+    "[[[0, 45], [1, 45], [1, 46], [0, 46], [0, 45]]] }},"
+    "{ \"type\" : \"Feature\", \"properties\" : { \"tzid\" : \"Asia/Tokyo\"}, "
+    "\"geometry\" : { \"type\": \"Polygon\", \"coordinates\": "
+    "[[[30, 40], [40, 40], [40, 50], [30, 50], [30, 40]]] }} ]}";
+
+BOOST_AUTO_TEST_CASE(timezoner_lookup_test)
+{
+    // Sunday, 2 July 2017 12:00 UTC
+    const std::time_t now = 1498996800;
+    const Timezoner tz(zones_json, now);
+
+    const auto hour = [&tz](const double lon, const double lat) {
+        const auto local_time = tz(point_t{lon, lat});
+        return local_time ? local_time->tm_hour : -1;
+    };
+    BOOST_CHECK_EQUAL(hour(-10, 50), 14);
+    BOOST_CHECK_EQUAL(hour(0.5, 45.5), 14);
+    BOOST_CHECK_EQUAL(hour(12, 12), 21);
+    BOOST_CHECK_EQUAL(hour(35, 45), 21);
+    BOOST_CHECK_EQUAL(hour(5, 65), -1);
+    BOOST_CHECK_EQUAL(hour(50, 45), -1);
+    BOOST_CHECK_EQUAL(hour(10, 13), -1);
+
+    // the grid finds the polygons that contain points, the polygons are tested in file order
+    std::vector<polygon_t> polygons(4);
+    boost::geometry::read_wkt("POLYGON((10 10,14 11,12 14,10 10))", polygons[0]);
+    boost::geometry::read_wkt("POLYGON((-20 40,30 40,30 70,5 60,-20 70,-20 40))", polygons[1]);
+    boost::geometry::read_wkt("POLYGON((0 45,1 45,1 46,0 46,0 45))", polygons[2]);
+    boost::geometry::read_wkt("POLYGON((30 40,40 40,40 50,30 50,30 40))", polygons[3]);
+    const int hours[] = {21, 14, 14, 21};
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> lon(-25, 45), lat(5, 75);
+    std::vector<point_t> points;
+    for (int i = 0; i < 100000; ++i)
+    {
+        points.emplace_back(lon(generator), lat(generator));
+    }
+
+    const auto local_times = tz(points);
+    BOOST_REQUIRE_EQUAL(local_times.size(), points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        int expected = -1;
+        for (std::size_t polygon = 0; polygon < polygons.size(); ++polygon)
+        {
+            if (boost::geometry::within(points[i], polygons[polygon]))
+            {
+                expected = hours[polygon];
+                break;
+            }
+        }
+        const auto found = local_times[i] ? local_times[i]->tm_hour : -1;
+        BOOST_CHECK_EQUAL(found, expected);
+        BOOST_CHECK_EQUAL(hour(points[i].get<0>(), points[i].get<1>()), expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(timezoner_file_test)
+{
+    const auto path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path("timezones-%%%%-%%%%.geojson");
+    {
+        boost::filesystem::ofstream file(path);
+        file << zones_json;
+    }
+
+    // the second time zones use the cached index of the file
+    const Timezoner summer(path, 1498996800);
+    const Timezoner winter(path, 1483272000);
+    BOOST_CHECK_EQUAL(summer(point_t{-10, 50})->tm_hour, 14);
+    BOOST_CHECK_EQUAL(winter(point_t{-10, 50})->tm_hour, 13);
+    BOOST_CHECK_EQUAL(winter(point_t{12, 12})->tm_hour, 21);
+
+    boost::filesystem::remove(path);
+    BOOST_CHECK_THROW(Timezoner(path, 1498996800), util::exception);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -76,4 +76,31 @@ BOOST_AUTO_TEST_CASE(bearing_angle_test)
     BOOST_CHECK_CLOSE(bearing::angleBetween(90., 269.99), 0.01, 1e-10);
 }
 
+BOOST_AUTO_TEST_CASE(bearing_sector_mask_test)
+{
+    BOOST_CHECK_EQUAL(bearing::sectorMask(0), 1u);
+    BOOST_CHECK_EQUAL(bearing::sectorMask(360), 1u);
+    BOOST_CHECK_EQUAL(bearing::sectorMask(-1), 1u << 31);
+    BOOST_CHECK_EQUAL(bearing::sectorMask(90), 1u << 8);
+    BOOST_CHECK_EQUAL(bearing::sectorMask(359), 1u << 31);
+
+    BOOST_CHECK_EQUAL(bearing::sectorMask(90, 180), bearing::ALL_SECTORS);
+    BOOST_CHECK_EQUAL(bearing::sectorMask(90, -1), 0u);
+    BOOST_CHECK_EQUAL(bearing::sectorMask(0, 5), 1u | (1u << 31));
+
+    // every bearing accepted by CheckInBounds is in the mask
+    for (const int bearing : {0, 45, 90, 179, 270, 355})
+    {
+        for (const int range : {0, 5, 10, 45, 90})
+        {
+            const auto mask = bearing::sectorMask(bearing, range);
+            for (int other = 0; other <= 360; ++other)
+            {
+                if (bearing::CheckInBounds(other, bearing, range))
+                    BOOST_CHECK(mask & bearing::sectorMask(other));
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
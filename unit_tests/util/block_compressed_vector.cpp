@@ -0,0 +1,90 @@
+#include "util/block_compressed_vector.hpp"
+#include "util/typedefs.hpp"
+
+#include "../common/range_tools.hpp"
+
+#include <boost/range/adaptor/reversed.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(block_compressed_vector)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(empty_vector)
+{
+    BlockCompressedVector<NodeID> vector{std::vector<NodeID>{}};
+    BOOST_CHECK(vector.empty());
+    BOOST_CHECK(vector.begin() == vector.end());
+}
+
+BOOST_AUTO_TEST_CASE(decode_blocks_of_different_widths)
+{
+    std::vector<NodeID> values;
+    // equal values do not need any bits
+    values.insert(values.end(), 40, 17);
+    // close node ids like in one geometry
+    for (NodeID node = 1000000; node < 1000050; ++node)
+        values.push_back(node);
+    // the full range
+    values.push_back(0);
+    values.push_back(std::numeric_limits<NodeID>::max());
+    values.push_back(SPECIAL_NODEID - 1);
+
+    const BlockCompressedVector<NodeID> vector{values};
+    BOOST_REQUIRE_EQUAL(vector.size(), values.size());
+    for (std::size_t index = 0; index < values.size(); ++index)
+    {
+        BOOST_CHECK_EQUAL(vector[index], values[index]);
+    }
+    CHECK_EQUAL_COLLECTIONS(vector, values);
+    BOOST_CHECK_EQUAL(vector.front(), 17);
+    BOOST_CHECK_EQUAL(vector.back(), SPECIAL_NODEID - 1);
+    BOOST_CHECK_THROW(vector.at(values.size()), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(decode_random_ranges)
+{
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<NodeID> start(0, 100000000);
+    std::uniform_int_distribution<int> step(-300, 300);
+    std::uniform_int_distribution<std::size_t> length(1, 40);
+
+    std::vector<NodeID> values;
+    NodeID node = start(generator);
+    for (int index = 0; index < 10000; ++index)
+    {
+        // mostly close ids with jumps between far apart ways
+        node = index % 97 == 0 ? start(generator) : node + step(generator);
+        values.push_back(node);
+    }
+
+    const BlockCompressedVector<NodeID> vector{values};
+    CHECK_EQUAL_COLLECTIONS(vector, values);
+
+    for (int range = 0; range < 1000; ++range)
+    {
+        const auto first =
+            std::uniform_int_distribution<std::size_t>(0, values.size() - 1)(generator);
+        const auto last = std::min(values.size(), first + length(generator));
+        const auto reference =
+            boost::make_iterator_range(values.begin() + first, values.begin() + last);
+        const auto result =
+            boost::make_iterator_range(vector.begin() + first, vector.begin() + last);
+        CHECK_EQUAL_COLLECTIONS(result, reference);
+        CHECK_EQUAL_COLLECTIONS(boost::adaptors::reverse(result),
+                                boost::adaptors::reverse(reference));
+
+        std::vector<NodeID> unpacked(last - first);
+        BOOST_CHECK(vector.unpack(first, last, unpacked.begin()) == unpacked.end());
+        CHECK_EQUAL_COLLECTIONS(unpacked, reference);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,58 @@
+#include "util/block_pool.hpp"
+#include "util/deallocating_vector.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+
+BOOST_AUTO_TEST_SUITE(block_pool)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(freed_blocks_are_reused)
+{
+    auto &pool = BlockPool::GetInstance();
+    pool.Trim();
+
+    auto block = pool.Allocate();
+    std::memset(block, 0xff, BlockPool::BLOCK_SIZE);
+    pool.Deallocate(block);
+    BOOST_CHECK_EQUAL(pool.NumberOfFreeBlocks(), 1);
+
+    BOOST_CHECK_EQUAL(pool.Allocate(), block);
+    BOOST_CHECK_EQUAL(pool.NumberOfFreeBlocks(), 0);
+    pool.Deallocate(block);
+
+    pool.Trim();
+    BOOST_CHECK_EQUAL(pool.NumberOfFreeBlocks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(deallocating_vector_returns_its_buckets)
+{
+    auto &pool = BlockPool::GetInstance();
+    pool.Trim();
+
+    const std::size_t elements_per_bucket = BlockPool::BLOCK_SIZE / sizeof(unsigned);
+    {
+        DeallocatingVector<unsigned> vector;
+        vector.resize(2 * elements_per_bucket + 1);
+        vector[2 * elements_per_bucket] = 42;
+        BOOST_CHECK_EQUAL(vector.back(), 42);
+
+        vector.resize(elements_per_bucket / 2);
+        BOOST_CHECK_EQUAL(pool.NumberOfFreeBlocks(), 2);
+    }
+    BOOST_CHECK_EQUAL(pool.NumberOfFreeBlocks(), 3);
+
+    // a new vector grows into the freed buckets
+    DeallocatingVector<unsigned> vector;
+    BOOST_CHECK_EQUAL(pool.NumberOfFreeBlocks(), 2);
+    vector.push_back(1);
+    BOOST_CHECK_EQUAL(vector[0], 1);
+
+    pool.Trim();
+    BOOST_CHECK_EQUAL(pool.NumberOfFreeBlocks(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,51 @@
+#include "util/crc32c.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(crc32c)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(check_values)
+{
+    const std::string digits = "123456789";
+    BOOST_CHECK_EQUAL(computeCRC32C(digits.data(), digits.size()), 0xe3069283);
+    BOOST_CHECK_EQUAL(computeCRC32C(digits.data(), 0), 0);
+
+    const std::vector<unsigned char> zeros(32, 0);
+    BOOST_CHECK_EQUAL(computeCRC32C(zeros.data(), zeros.size()), 0x8a9136aa);
+}
+
+BOOST_AUTO_TEST_CASE(update_in_parts)
+{
+    std::vector<unsigned char> data(1000);
+    std::iota(data.begin(), data.end(), 0);
+    const auto crc = computeCRC32C(data.data(), data.size());
+
+    // unaligned parts that are not multiples of words
+    auto crc_of_parts = updateCRC32C(0, data.data(), 3);
+    crc_of_parts = updateCRC32C(crc_of_parts, data.data() + 3, 500);
+    crc_of_parts = updateCRC32C(crc_of_parts, data.data() + 503, data.size() - 503);
+    BOOST_CHECK_EQUAL(crc_of_parts, crc);
+}
+
+BOOST_AUTO_TEST_CASE(block_checksums)
+{
+    std::vector<unsigned char> data(1000);
+    std::iota(data.begin(), data.end(), 0);
+
+    const auto checksums = computeBlockCRC32C(data.data(), data.size(), 300);
+    BOOST_REQUIRE_EQUAL(checksums.size(), 4);
+    BOOST_CHECK_EQUAL(checksums[0], computeCRC32C(data.data(), 300));
+    BOOST_CHECK_EQUAL(checksums[2], computeCRC32C(data.data() + 600, 300));
+    BOOST_CHECK_EQUAL(checksums[3], computeCRC32C(data.data() + 900, 100));
+
+    BOOST_CHECK(computeBlockCRC32C(data.data(), 0, 300).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
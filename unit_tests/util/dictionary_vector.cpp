@@ -0,0 +1,81 @@
+#include "util/dictionary_vector.hpp"
+#include "util/typedefs.hpp"
+
+#include "../common/range_tools.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(dictionary_vector)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(empty_vector)
+{
+    DictionaryVector<TurnPenalty> vector{std::vector<TurnPenalty>{}};
+    BOOST_CHECK(vector.empty());
+    BOOST_CHECK(vector.begin() == vector.end());
+    BOOST_CHECK_EQUAL(vector.number_of_exceptions(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(decode_repeating_values)
+{
+    // most turns have no penalty, u-turns and traffic signals have the same few
+    std::vector<TurnPenalty> values;
+    for (int index = 0; index < 1000; ++index)
+        values.push_back(index % 10 == 0 ? 200 : (index % 7 == 0 ? 20 : 0));
+    values.push_back(std::numeric_limits<TurnPenalty>::min());
+    values.push_back(INVALID_TURN_PENALTY);
+
+    const DictionaryVector<TurnPenalty> vector{values};
+    BOOST_REQUIRE_EQUAL(vector.size(), values.size());
+    BOOST_CHECK_EQUAL(vector.number_of_exceptions(), 0);
+    for (std::size_t index = 0; index < values.size(); ++index)
+    {
+        BOOST_CHECK_EQUAL(vector[index], values[index]);
+    }
+    CHECK_EQUAL_COLLECTIONS(vector, values);
+    BOOST_CHECK_EQUAL(vector.front(), 200);
+    BOOST_CHECK_EQUAL(vector.back(), INVALID_TURN_PENALTY);
+    BOOST_CHECK_THROW(vector.at(values.size()), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(decode_exceptions)
+{
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<TurnPenalty> penalty(-2000, 2000);
+
+    // more distinct values than a dictionary holds, the rare ones are exceptions
+    std::vector<TurnPenalty> values;
+    for (int index = 0; index < 20000; ++index)
+        values.push_back(index % 3 == 0 ? penalty(generator) : 0);
+
+    const DictionaryVector<TurnPenalty> vector{values};
+    BOOST_REQUIRE_EQUAL(vector.size(), values.size());
+    BOOST_CHECK_GT(vector.number_of_exceptions(), 0);
+    CHECK_EQUAL_COLLECTIONS(vector, values);
+}
+
+BOOST_AUTO_TEST_CASE(equal_values_give_equal_vectors)
+{
+    std::vector<TurnPenalty> values;
+    for (TurnPenalty value = 0; value < 1000; ++value)
+        values.push_back(value);
+
+    // equally frequent values are ordered by their value, whatever the order of the hash map
+    const DictionaryVector<TurnPenalty> vector{values};
+    std::vector<TurnPenalty> reversed(values.rbegin(), values.rend());
+    const DictionaryVector<TurnPenalty> reversed_vector{reversed};
+    BOOST_CHECK_EQUAL(vector.number_of_exceptions(),
+                      values.size() - DictionaryVector<TurnPenalty>::MAX_DICTIONARY_SIZE);
+    BOOST_CHECK_EQUAL(vector.number_of_exceptions(), reversed_vector.number_of_exceptions());
+    CHECK_EQUAL_COLLECTIONS(vector, values);
+    CHECK_EQUAL_COLLECTIONS(reversed_vector, reversed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
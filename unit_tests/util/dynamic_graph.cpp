@@ -159,4 +159,32 @@ BOOST_AUTO_TEST_CASE(filter_test)
                       filtered_simple_graph.FindEdge(4, 1));
 }
 
+BOOST_AUTO_TEST_CASE(reserve_edges_test)
+{
+    std::vector<TestInputEdge> input_edges = {TestInputEdge{0, 1, TestData{1}},
+                                              TestInputEdge{1, 0, TestData{2}},
+                                              TestInputEdge{1, 2, TestData{3}},
+                                              TestInputEdge{2, 0, TestData{4}}};
+    TestDynamicGraph graph(3, input_edges);
+
+    graph.ReserveEdges(1, 3);
+    const auto capacity = graph.GetEdgeCapacity();
+    const auto first_edges_of_other_nodes =
+        std::make_pair(graph.BeginEdges(0), graph.BeginEdges(2));
+
+    // the reserved edges neither move other nodes nor grow the edge list
+    graph.InsertEdge(1, 2, TestData{5});
+    graph.InsertEdge(1, 1, TestData{6});
+    graph.InsertEdge(1, 0, TestData{7});
+    BOOST_CHECK_EQUAL(graph.GetEdgeCapacity(), capacity);
+    BOOST_CHECK(std::make_pair(graph.BeginEdges(0), graph.BeginEdges(2)) ==
+                first_edges_of_other_nodes);
+
+    BOOST_CHECK_EQUAL(graph.GetNumberOfEdges(), 7);
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(1), 5);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(1, 1)).id, 6);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(0, 1)).id, 1);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(2, 0)).id, 4);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+#include "util/external_sorter.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(external_sorter)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+std::size_t countRunFiles(const boost::filesystem::path &directory)
+{
+    return std::count_if(boost::filesystem::directory_iterator(directory),
+                         boost::filesystem::directory_iterator(),
+                         [](const auto &entry) { return entry.path().extension() == ".run"; });
+}
+}
+
+BOOST_AUTO_TEST_CASE(merge_spilled_runs)
+{
+    const auto directory =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directory(directory);
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 1000);
+    std::vector<int> values(10007);
+    std::generate(values.begin(), values.end(), [&] { return distribution(generator); });
+
+    {
+        ExternalSorter<int, std::greater<int>> sorter(directory, 1000);
+        for (const auto value : values)
+        {
+            sorter.push_back(value);
+        }
+        BOOST_CHECK_EQUAL(sorter.size(), values.size());
+        BOOST_CHECK_EQUAL(countRunFiles(directory), 10);
+
+        std::vector<int> merged;
+        sorter.Merge([&](const int value) { merged.push_back(value); });
+        std::sort(values.begin(), values.end(), std::greater<int>());
+        BOOST_CHECK_EQUAL_COLLECTIONS(merged.begin(), merged.end(), values.begin(), values.end());
+        BOOST_CHECK(sorter.empty());
+        BOOST_CHECK_EQUAL(countRunFiles(directory), 0);
+
+        // the runs of a sorter are removed with it
+        sorter.push_back(1);
+        sorter.push_back(2);
+        for (const auto value : values)
+        {
+            sorter.push_back(value);
+        }
+        BOOST_CHECK_GT(countRunFiles(directory), 0);
+    }
+    BOOST_CHECK_EQUAL(countRunFiles(directory), 0);
+
+    boost::filesystem::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_CASE(merge_without_runs)
+{
+    ExternalSorter<int, std::less<int>> sorter(boost::filesystem::temp_directory_path(), 10);
+    std::vector<int> values = {5, 3, 9, 1};
+    for (const auto value : values)
+    {
+        sorter.push_back(value);
+    }
+
+    std::vector<int> merged;
+    sorter.Merge([&](const int value) { merged.push_back(value); });
+    std::vector<int> expected = {1, 3, 5, 9};
+    BOOST_CHECK_EQUAL_COLLECTIONS(merged.begin(), merged.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
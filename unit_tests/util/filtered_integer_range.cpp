@@ -1,10 +1,14 @@
 #include "util/filtered_integer_range.hpp"
+#include "util/vector_view.hpp"
 
 #include "../common/range_tools.hpp"
 
 #include <boost/test/test_case_template.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <cstdint>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(bit_range_test)
 
 using namespace osrm;
@@ -35,4 +39,35 @@ BOOST_AUTO_TEST_CASE(filtered_irange_test)
     BOOST_CHECK(empty_4.begin() == empty_4.end());
 }
 
+BOOST_AUTO_TEST_CASE(filtered_irange_packed_test)
+{
+    // bits 1, 63, 64 and 130 are set, the words are skipped a word at a time
+    std::vector<std::uint64_t> words = {(1ULL << 63) | (1ULL << 1), 1, 1ULL << 2};
+    vector_view<bool> filter(words.data(), 150);
+
+    CHECK_EQUAL_RANGE(filtered_irange<std::uint32_t>(0, 150, filter), 1, 63, 64, 130);
+    CHECK_EQUAL_RANGE(filtered_irange<std::uint32_t>(2, 64, filter), 63);
+    CHECK_EQUAL_RANGE(filtered_irange<std::uint32_t>(64, 131, filter), 64, 130);
+
+    auto empty_1 = filtered_irange<std::uint32_t>(65, 130, filter);
+    auto empty_2 = filtered_irange<std::uint32_t>(131, 150, filter);
+    BOOST_CHECK(empty_1.begin() == empty_1.end());
+    BOOST_CHECK(empty_2.begin() == empty_2.end());
+    BOOST_CHECK(!filter.all());
+
+    std::vector<std::uint64_t> all_words = {~0ULL, (1ULL << 6) - 1};
+    BOOST_CHECK(vector_view<bool>(all_words.data(), 70).all());
+    BOOST_CHECK(!vector_view<bool>(all_words.data(), 71).all());
+    BOOST_CHECK(vector_view<bool>().all());
+}
+
+BOOST_AUTO_TEST_CASE(unfiltered_irange_test)
+{
+    using UnfilteredRange = filtered_range<std::uint8_t, std::vector<bool>>;
+    CHECK_EQUAL_RANGE(UnfilteredRange(1, 4), 1, 2, 3);
+
+    auto empty = UnfilteredRange(3, 3);
+    BOOST_CHECK(empty.begin() == empty.end());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,77 @@
+#include "util/flat_id_map.hpp"
+#include "util/id_set.hpp"
+#include "util/typedefs.hpp"
+
+#include "../common/range_tools.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(id_set_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(insert_and_erase)
+{
+    IdSet<NodeID> set{3, 64, 130};
+    BOOST_CHECK_EQUAL(set.size(), 3);
+    BOOST_CHECK_EQUAL(set.count(3), 1);
+    BOOST_CHECK_EQUAL(set.count(64), 1);
+    BOOST_CHECK_EQUAL(set.count(130), 1);
+    BOOST_CHECK_EQUAL(set.count(4), 0);
+    BOOST_CHECK_EQUAL(set.count(63), 0);
+    // ids beyond the bits of the set
+    BOOST_CHECK_EQUAL(set.count(100000), 0);
+
+    BOOST_CHECK(!set.insert(64));
+    BOOST_CHECK(set.insert(0));
+    BOOST_CHECK_EQUAL(set.size(), 4);
+
+    BOOST_CHECK_EQUAL(set.erase(3), 1);
+    BOOST_CHECK_EQUAL(set.erase(3), 0);
+    BOOST_CHECK_EQUAL(set.erase(100000), 0);
+    BOOST_CHECK_EQUAL(set.size(), 3);
+    BOOST_CHECK_EQUAL(set.count(3), 0);
+
+    set.clear();
+    BOOST_CHECK(set.empty());
+    BOOST_CHECK_EQUAL(set.count(64), 0);
+}
+
+BOOST_AUTO_TEST_CASE(iterates_in_ascending_order)
+{
+    IdSet<EdgeID> empty;
+    BOOST_CHECK(empty.begin() == empty.end());
+
+    IdSet<EdgeID> set;
+    set.resize(1000);
+    BOOST_CHECK(set.begin() == set.end());
+
+    const std::vector<EdgeID> ids = {700, 1, 63, 64, 0, 1300, 127};
+    set.insert(ids.begin(), ids.end());
+    CHECK_EQUAL_RANGE(set, 0, 1, 63, 64, 127, 700, 1300);
+}
+
+BOOST_AUTO_TEST_CASE(flat_id_map)
+{
+    const FlatIdMap<NodeID, int> map(
+        std::vector<std::pair<NodeID, int>>{{40, 4}, {10, 1}, {30, 3}, {20, 2}});
+    BOOST_CHECK_EQUAL(map.size(), 4);
+    BOOST_CHECK_EQUAL(map.at(10), 1);
+    BOOST_CHECK_EQUAL(map.at(40), 4);
+    BOOST_CHECK_EQUAL(map.count(30), 1);
+    BOOST_CHECK_EQUAL(map.count(25), 0);
+    BOOST_CHECK(map.find(0) == map.end());
+    BOOST_CHECK(map.find(50) == map.end());
+    BOOST_CHECK_EQUAL(map.find(20)->second, 2);
+    BOOST_CHECK_EQUAL(map.begin()->first, 10);
+
+    const FlatIdMap<NodeID, int> empty;
+    BOOST_CHECK(empty.empty());
+    BOOST_CHECK(empty.find(0) == empty.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,198 @@
+#include "util/json_renderer.hpp"
+#include "util/cast.hpp"
+#include "util/json_container.hpp"
+#include "util/json_number.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(json_renderer)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+json::Object makeMatrix(const std::size_t size)
+{
+    json::Array rows;
+    for (std::size_t row = 0; row < size; ++row)
+    {
+        json::Array columns;
+        for (std::size_t column = 0; column < size; ++column)
+        {
+            columns.values.push_back(json::Number(row * size + column + 0.5));
+        }
+        columns.values.push_back(json::Null());
+        rows.values.push_back(std::move(columns));
+    }
+
+    json::Object object;
+    object.values["code"] = "Ok";
+    object.values["durations"] = std::move(rows);
+    object.values["valid"] = json::True();
+    return object;
+}
+
+std::string formatNumber(const double value)
+{
+    char buffer[json::MAX_NUMBER_LENGTH];
+    const auto end = json::formatNumber(value, buffer);
+    BOOST_CHECK_LE(static_cast<std::size_t>(end - buffer), json::MAX_NUMBER_LENGTH);
+    return std::string(buffer, end);
+}
+
+std::string formatFixed(const std::int64_t value)
+{
+    char buffer[json::MAX_NUMBER_LENGTH];
+    return std::string(buffer, json::formatFixed(value, buffer));
+}
+}
+
+BOOST_AUTO_TEST_CASE(render_array)
+{
+    json::Array values;
+    values.values.push_back("a \"quoted\" name");
+    values.values.push_back(json::Number(1.5));
+    values.values.push_back(json::Array());
+    values.values.push_back(json::False());
+
+    json::Object object;
+    object.values["values"] = std::move(values);
+
+    std::vector<char> buffer;
+    json::render(buffer, object);
+    BOOST_CHECK_EQUAL(std::string(buffer.begin(), buffer.end()),
+                      R"({"values":["a \"quoted\" name",1.5,[],false]})");
+}
+
+BOOST_AUTO_TEST_CASE(render_escaped_strings)
+{
+    json::Array values;
+    values.values.push_back("\\polyline\\_?@\\");
+    values.values.push_back("tab\tand/slash\n");
+    values.values.push_back("");
+
+    json::Object object;
+    object.values["values"] = std::move(values);
+
+    std::vector<char> buffer;
+    json::render(buffer, object);
+    BOOST_CHECK_EQUAL(std::string(buffer.begin(), buffer.end()),
+                      R"({"values":["\\polyline\\_?@\\","tab\tand\/slash\n",""]})");
+
+    std::ostringstream stream;
+    json::render(stream, object);
+    BOOST_CHECK_EQUAL(stream.str(), std::string(buffer.begin(), buffer.end()));
+}
+
+BOOST_AUTO_TEST_CASE(render_chunks)
+{
+    const auto object = makeMatrix(50);
+
+    std::vector<char> buffer;
+    json::render(buffer, object);
+
+    const std::size_t chunk_size = 100;
+    std::vector<std::vector<char>> chunks;
+    json::render(chunks, object, chunk_size);
+
+    BOOST_CHECK_EQUAL(chunks.size(), (buffer.size() + chunk_size - 1) / chunk_size);
+    std::string joined;
+    for (const auto &chunk : chunks)
+    {
+        BOOST_CHECK(!chunk.empty());
+        BOOST_CHECK_LE(chunk.size(), chunk_size);
+        joined.append(chunk.begin(), chunk.end());
+    }
+    BOOST_CHECK_EQUAL(joined, std::string(buffer.begin(), buffer.end()));
+}
+
+BOOST_AUTO_TEST_CASE(format_numbers)
+{
+    BOOST_CHECK_EQUAL(formatNumber(0), "0");
+    BOOST_CHECK_EQUAL(formatNumber(-0.0), "0");
+    BOOST_CHECK_EQUAL(formatNumber(1), "1");
+    BOOST_CHECK_EQUAL(formatNumber(-12.5), "-12.5");
+    BOOST_CHECK_EQUAL(formatNumber(0.1), "0.1");
+    BOOST_CHECK_EQUAL(formatNumber(0.000001), "0.000001");
+    BOOST_CHECK_EQUAL(formatNumber(0.0000004), "0");
+    BOOST_CHECK_EQUAL(formatNumber(1234.5678901), "1234.56789");
+    BOOST_CHECK_EQUAL(formatNumber(13.38886), "13.38886");
+    BOOST_CHECK_EQUAL(formatNumber(-179.999999), "-179.999999");
+    BOOST_CHECK_EQUAL(formatNumber(0.9999999), "1");
+    BOOST_CHECK_EQUAL(formatNumber(1e9), "1000000000");
+    BOOST_CHECK_EQUAL(formatNumber(12345678901.25), "12345678901.25");
+    BOOST_CHECK_EQUAL(formatNumber(9999999999.9999999), "10000000000");
+    BOOST_CHECK_EQUAL(formatNumber(-1e20), "-100000000000000000000");
+    BOOST_CHECK_EQUAL(formatNumber(std::numeric_limits<double>::infinity()), "null");
+    BOOST_CHECK_EQUAL(formatNumber(std::numeric_limits<double>::quiet_NaN()), "null");
+
+    const auto max = formatNumber(std::numeric_limits<double>::max());
+    BOOST_CHECK_EQUAL(max.size(), 309);
+    BOOST_CHECK_EQUAL(max.substr(0, 17), "17976931348623157");
+}
+
+BOOST_AUTO_TEST_CASE(format_numbers_like_cast)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> small(-200, 200);
+    std::uniform_real_distribution<double> large(-1e12, 1e12);
+    std::uniform_int_distribution<int> tenths(0, 1000000);
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        const double values[] = {small(generator), tenths(generator) / 10.};
+        for (const auto value : values)
+        {
+            BOOST_CHECK_EQUAL(formatNumber(value), cast::to_string_with_precision(value));
+        }
+
+        // large numbers use their shortest digits instead of the exact binary expansion,
+        // they are only rounded below 1e10 where they can have more than six decimals
+        const auto value = large(generator);
+        const auto parsed = std::stod(formatNumber(value));
+        if (std::abs(value) >= 1e10)
+        {
+            BOOST_CHECK_EQUAL(parsed, value);
+        }
+        BOOST_CHECK_LE(std::abs(parsed - value), 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(format_fixed_coordinates)
+{
+    BOOST_CHECK_EQUAL(formatFixed(0), "0");
+    BOOST_CHECK_EQUAL(formatFixed(13388860), "13.38886");
+    BOOST_CHECK_EQUAL(formatFixed(-52517037), "-52.517037");
+    BOOST_CHECK_EQUAL(formatFixed(-1), "-0.000001");
+    BOOST_CHECK_EQUAL(formatFixed(180000000), "180");
+    BOOST_CHECK_EQUAL(formatFixed(std::numeric_limits<std::int64_t>::min()),
+                      "-9223372036854.775808");
+}
+
+BOOST_AUTO_TEST_CASE(render_literals)
+{
+    json::Array values;
+    values.values.push_back(json::True());
+    values.values.push_back(json::Null());
+    values.values.push_back(json::Number(52.517037));
+    values.values.push_back(json::Number(std::numeric_limits<double>::infinity()));
+
+    json::Object object;
+    object.values["values"] = std::move(values);
+
+    std::vector<char> buffer;
+    json::render(buffer, object);
+    BOOST_CHECK_EQUAL(std::string(buffer.begin(), buffer.end()),
+                      R"({"values":[true,null,52.517037,null]})");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
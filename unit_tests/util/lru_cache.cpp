@@ -0,0 +1,47 @@
+#include "util/lru_cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(lru_cache)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(evicts_least_recently_used)
+{
+    LRUCache<int, std::string> cache(2);
+
+    cache.Put(1, "one");
+    cache.Put(2, "two");
+    BOOST_CHECK_EQUAL(cache.Size(), 2);
+
+    // makes 2 the least recently used entry
+    BOOST_CHECK_EQUAL(*cache.Get(1), "one");
+    cache.Put(3, "three");
+    BOOST_CHECK_EQUAL(cache.Size(), 2);
+    BOOST_CHECK(!cache.Get(2));
+    BOOST_CHECK_EQUAL(*cache.Get(1), "one");
+    BOOST_CHECK_EQUAL(*cache.Get(3), "three");
+}
+
+BOOST_AUTO_TEST_CASE(put_replaces_value)
+{
+    LRUCache<int, std::string> cache(2);
+
+    cache.Put(1, "one");
+    cache.Put(2, "two");
+    cache.Put(1, "uno");
+    cache.Put(3, "three");
+
+    BOOST_CHECK_EQUAL(cache.Size(), 2);
+    BOOST_CHECK_EQUAL(*cache.Get(1), "uno");
+    BOOST_CHECK(!cache.Get(2));
+
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.Size(), 0);
+    BOOST_CHECK(!cache.Get(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
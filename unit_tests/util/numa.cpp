@@ -0,0 +1,47 @@
+#include "util/numa.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <memory>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(numa)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(every_node_has_cpus)
+{
+    const auto &nodes = GetNumaNodes();
+    BOOST_REQUIRE(!nodes.empty());
+    for (const auto &node : nodes)
+    {
+        BOOST_CHECK(!node.cpus.empty());
+    }
+    BOOST_CHECK(CurrentNumaNode() < nodes.size());
+}
+
+BOOST_AUTO_TEST_CASE(pinned_thread_reports_its_node)
+{
+    const auto last_node = GetNumaNodes().size() - 1;
+    std::size_t current_node = 0;
+    std::thread thread([&] {
+        PinThreadToNumaNode(last_node);
+        current_node = CurrentNumaNode();
+    });
+    thread.join();
+    BOOST_CHECK_EQUAL(current_node, last_node);
+}
+
+BOOST_AUTO_TEST_CASE(placed_memory_is_usable)
+{
+    constexpr std::size_t size = 1024 * 1024;
+    auto memory = std::make_unique<char[]>(size);
+    BindMemoryToNumaNode(memory.get(), size, 0);
+    InterleaveMemory(memory.get(), size);
+    std::memset(memory.get(), 1, size);
+    BOOST_CHECK_EQUAL(memory[size - 1], 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
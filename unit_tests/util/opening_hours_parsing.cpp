@@ -4,11 +4,16 @@
 #include <boost/test/test_case_template.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(opening_hours)
 
 // Some tests from https://www.netzwolf.info/en/cartography/osm/time_domain/explanation
 
 using osrm::util::CheckOpeningHours;
+using osrm::util::CheckWeeklySchedule;
+using osrm::util::CompileWeeklySchedule;
 using osrm::util::ParseOpeningHours;
 
 // convert a string representation of time to a tm structure
@@ -314,4 +319,52 @@ BOOST_AUTO_TEST_CASE(check_opening_hours_school_hours)
     BOOST_CHECK_EQUAL(CheckOpeningHours(opening_hours, time("Sun, 02 Sep 2018 15:00:00")), false);
 }
 
+BOOST_AUTO_TEST_CASE(check_weekly_schedule)
+{
+    const std::string weekly_opening_hours[] = {
+        "24/7",
+        "Mo-Sa",
+        "Sa-Mo",
+        "Su 00:00-24:00",
+        "Mo-Fr 08:30-20:00",
+        "Mo 10:00-12:00,12:30-15:00; Tu-Fr 08:00-12:00,12:30-15:00; Sa 08:00-12:00",
+        "Mo-Sa 10:00-20:00; Tu off",
+        "Mo-Sa 10:00-20:00; Tu 10:00-14:00",
+        "Su-Tu 11:00-01:00, We-Th 11:00-03:00, Fr 11:00-06:00, Sa 11:00-07:00",
+        "08:30-12:30,15:30-20:00",
+        "22:00-03:00",
+        "Tu,Th 16:00-20:00"};
+
+    // every minute of the week from Sunday 00:00
+    auto minute = time("Sun, 30 Jul 2017 00:00:00");
+    std::vector<struct tm> minutes;
+    for (int index = 0; index < 7 * 24 * 60; ++index)
+    {
+        minutes.push_back(minute);
+        minute.tm_min = (minute.tm_min + 1) % 60;
+        minute.tm_hour = (minute.tm_hour + (minute.tm_min == 0)) % 24;
+        minute.tm_wday = (minute.tm_wday + (minute.tm_hour == 0 && minute.tm_min == 0)) % 7;
+    }
+
+    for (const auto &input : weekly_opening_hours)
+    {
+        const auto opening_hours = ParseOpeningHours(input);
+        const auto schedule = CompileWeeklySchedule(opening_hours);
+        BOOST_REQUIRE_MESSAGE(schedule, "compiling " << input << " failed");
+        BOOST_CHECK(std::is_sorted(schedule->begin(), schedule->end()));
+        for (const auto &time : minutes)
+        {
+            BOOST_CHECK_MESSAGE(CheckWeeklySchedule(*schedule, time) ==
+                                    CheckOpeningHours(opening_hours, time),
+                                input << " differs at " << time.tm_wday << " " << time.tm_hour
+                                      << ":" << time.tm_min);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(CompileWeeklySchedule(ParseOpeningHours("Mo-Fr 08:30-20:00"))->size(), 10);
+    BOOST_CHECK(!CompileWeeklySchedule(ParseOpeningHours("2016 Feb-2017 Dec")));
+    BOOST_CHECK(!CompileWeeklySchedule(ParseOpeningHours("Mo-Su 08:00-18:00; Aug off")));
+    BOOST_CHECK(!CompileWeeklySchedule(ParseOpeningHours("sunrise-(sunset-01:30)")));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
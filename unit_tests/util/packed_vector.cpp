@@ -7,6 +7,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <algorithm>
+#include <limits>
 #include <numeric>
 #include <random>
 
@@ -203,4 +204,59 @@ BOOST_AUTO_TEST_CASE(packed_vector_33bit_continious)
     }
 }
 
+
+template <typename T, std::size_t Bits> void check_unpack_ranges()
+{
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<std::uint64_t> value(
+        0, std::numeric_limits<std::uint64_t>::max() >> (64 - Bits));
+    std::uniform_int_distribution<std::size_t> length(0, 150);
+
+    PackedVector<T, Bits> vector;
+    std::vector<T> reference;
+    for (std::size_t index = 0; index < 1000; ++index)
+    {
+        const T element{static_cast<std::uint64_t>(value(generator))};
+        vector.push_back(element);
+        reference.push_back(element);
+    }
+
+    std::vector<T> result;
+    for (std::size_t range = 0; range < 500; ++range)
+    {
+        const auto first =
+            std::uniform_int_distribution<std::size_t>(0, reference.size())(generator);
+        const auto last = std::min(reference.size(), first + length(generator));
+
+        result.resize(last - first);
+        BOOST_CHECK(vector.unpack(first, last, result.begin()) == result.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            result.begin(), result.end(), reference.begin() + first, reference.begin() + last);
+
+        vector.unpack(first, last, result.rbegin());
+        BOOST_CHECK_EQUAL_COLLECTIONS(result.rbegin(),
+                                      result.rend(),
+                                      reference.begin() + first,
+                                      reference.begin() + last);
+    }
+
+    // the last value ends in front of the sentinel word
+    result.resize(reference.size());
+    vector.unpack(0, reference.size(), result.begin());
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        result.begin(), result.end(), reference.begin(), reference.end());
+}
+
+BOOST_AUTO_TEST_CASE(packed_vector_unpack_ranges)
+{
+    check_unpack_ranges<std::uint32_t, 1>();
+    check_unpack_ranges<std::uint32_t, 10>();
+    check_unpack_ranges<std::uint32_t, 22>();
+    check_unpack_ranges<std::uint32_t, 32>();
+    check_unpack_ranges<std::uint64_t, 33>();
+    check_unpack_ranges<std::uint64_t, 63>();
+    check_unpack_ranges<std::uint64_t, 64>();
+    check_unpack_ranges<OSMNodeID, 33>();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+#include "util/phase_report.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(phase_report)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(record_phases)
+{
+    auto &report = PhaseReport::GetInstance();
+    const auto number_of_phases = report.GetPhases().size();
+
+    {
+        ReportPhase phase("summing");
+        std::vector<int> values(1 << 20, 1);
+        BOOST_CHECK_EQUAL(std::accumulate(values.begin(), values.end(), 0), 1 << 20);
+        phase.Stop();
+        // a stopped phase is not recorded again when it goes out of scope
+    }
+    {
+        ReportPhase phase("scoped");
+    }
+
+    const auto phases = report.GetPhases();
+    BOOST_REQUIRE_EQUAL(phases.size(), number_of_phases + 2);
+    const auto &summing = phases[number_of_phases];
+    BOOST_CHECK_EQUAL(summing.name, "summing");
+    BOOST_CHECK_LE(summing.begin.wall_seconds, summing.end.wall_seconds);
+    BOOST_CHECK_LE(summing.begin.cpu_seconds, summing.end.cpu_seconds);
+    BOOST_CHECK_GE(summing.end.peak_rss_bytes, (1 << 20) * sizeof(int));
+    BOOST_CHECK_EQUAL(phases[number_of_phases + 1].name, "scoped");
+
+    const auto json = report.ToJSON("unit-test", 2);
+    BOOST_CHECK_EQUAL(json.values.at("tool").get<json::String>().value, "unit-test");
+    BOOST_CHECK_EQUAL(json.values.at("threads").get<json::Number>().value, 2);
+    BOOST_CHECK(json.values.count("peak_rss_bytes"));
+    const auto &phases_json = json.values.at("phases").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(phases_json.size(), phases.size());
+    const auto &summing_json = phases_json[number_of_phases].get<json::Object>().values;
+    BOOST_CHECK_EQUAL(summing_json.at("name").get<json::String>().value, "summing");
+    for (const auto key : {"start_seconds",
+                           "wall_seconds",
+                           "cpu_seconds",
+                           "thread_utilization",
+                           "peak_rss_bytes",
+                           "read_bytes",
+                           "written_bytes"})
+    {
+        BOOST_CHECK_MESSAGE(summing_json.count(key), key);
+        BOOST_CHECK_GE(summing_json.at(key).get<json::Number>().value, 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(write_report)
+{
+    const auto path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path("osrm-phase-report-%%%%%%%%.json");
+    BOOST_REQUIRE(PhaseReport::GetInstance().Write(path, "unit-test", 1));
+
+    boost::filesystem::ifstream in(path);
+    const std::string contents{std::istreambuf_iterator<char>(in),
+                               std::istreambuf_iterator<char>()};
+    BOOST_CHECK(contents.find("\"tool\":\"unit-test\"") != std::string::npos);
+    BOOST_CHECK(contents.find("\"phases\":[") != std::string::npos);
+    boost::filesystem::remove(path);
+
+    BOOST_CHECK(!PhaseReport::GetInstance().Write(path / "missing" / "report.json", "test", 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
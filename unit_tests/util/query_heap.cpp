@@ -25,7 +25,10 @@ typedef int TestKey;
 typedef int TestWeight;
 typedef boost::mpl::list<ArrayStorage<TestNodeID, TestKey>,
                          MapStorage<TestNodeID, TestKey>,
-                         UnorderedMapStorage<TestNodeID, TestKey>>
+                         UnorderedMapStorage<TestNodeID, TestKey>,
+                         GenerationArrayStorage<TestNodeID, TestKey>,
+                         PagedGenerationArrayStorage<TestNodeID, TestKey>,
+                         SelectableStorage<TestNodeID, TestKey>>
     storage_types;
 
 template <unsigned NUM_ELEM> struct RandomDataFixture
@@ -157,4 +160,109 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(decrease_key_test, T, storage_types, RandomData
     }
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(clear_test, T, storage_types, RandomDataFixture<NUM_NODES>)
+{
+    QueryHeap<TestNodeID, TestKey, TestWeight, TestData, T> heap(NUM_NODES);
+
+    for (unsigned idx : order)
+    {
+        heap.Insert(ids[idx], weights[idx], data[idx]);
+    }
+
+    heap.Clear();
+
+    BOOST_CHECK(heap.Empty());
+    for (auto id : ids)
+    {
+        BOOST_CHECK(!heap.WasInserted(id));
+    }
+
+    heap.Insert(ids[1], weights[1], data[1]);
+    BOOST_CHECK(heap.WasInserted(ids[1]));
+    BOOST_CHECK(!heap.WasInserted(ids[0]));
+    BOOST_CHECK_EQUAL(heap.Min(), ids[1]);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(prefetch_test, T, storage_types, RandomDataFixture<NUM_NODES>)
+{
+    QueryHeap<TestNodeID, TestKey, TestWeight, TestData, T> heap(NUM_NODES);
+
+    // prefetching nodes neither inserts them nor allocates pages of paged storages
+    for (const auto id : ids)
+    {
+        heap.Prefetch(id);
+    }
+    for (const auto id : ids)
+    {
+        BOOST_CHECK(!heap.WasInserted(id));
+    }
+
+    heap.Insert(ids[1], weights[1], data[1]);
+    heap.Prefetch(ids[1]);
+    heap.Prefetch(ids[0]);
+    BOOST_CHECK(heap.WasInserted(ids[1]));
+    BOOST_CHECK(!heap.WasInserted(ids[0]));
+    BOOST_CHECK_EQUAL(heap.GetData(ids[1]).value, data[1].value);
+}
+
+BOOST_AUTO_TEST_CASE(selectable_storage_test)
+{
+    const std::vector<HeapStorageType> types = {HeapStorageType::UnorderedMap,
+                                                HeapStorageType::GenerationArray,
+                                                HeapStorageType::PagedGenerationArray};
+    for (const auto type : types)
+    {
+        QueryHeap<TestNodeID, TestKey, TestWeight, TestData, SelectableStorage<TestNodeID, TestKey>>
+            heap(10000, type);
+        BOOST_CHECK(heap.GetIndexStorage().GetType() == type);
+        BOOST_CHECK(heap.GetIndexStorage().IsReusable(10000, type));
+
+        heap.Insert(9999, 1, TestData{1});
+        heap.Insert(0, 2, TestData{2});
+        BOOST_CHECK(heap.WasInserted(9999));
+        BOOST_CHECK(!heap.WasInserted(5000));
+        BOOST_CHECK_EQUAL(heap.DeleteMin(), 9999);
+        BOOST_CHECK_EQUAL(heap.GetData(0).value, 2);
+    }
+
+    SelectableStorage<TestNodeID, TestKey> array_storage(100, HeapStorageType::GenerationArray);
+    BOOST_CHECK(!array_storage.IsReusable(200, HeapStorageType::GenerationArray));
+    BOOST_CHECK(!array_storage.IsReusable(100, HeapStorageType::UnorderedMap));
+
+    SelectableStorage<TestNodeID, TestKey> map_storage(100, HeapStorageType::UnorderedMap);
+    BOOST_CHECK(map_storage.IsReusable(200, HeapStorageType::UnorderedMap));
+}
+
+BOOST_AUTO_TEST_CASE(shrink_releases_retained_memory_test)
+{
+    const std::vector<HeapStorageType> types = {HeapStorageType::UnorderedMap,
+                                                HeapStorageType::GenerationArray,
+                                                HeapStorageType::PagedGenerationArray};
+    for (const auto type : types)
+    {
+        QueryHeap<TestNodeID, TestKey, TestWeight, TestData, SelectableStorage<TestNodeID, TestKey>>
+            heap(100000, type);
+        const auto initial = heap.RetainedMemory();
+
+        for (TestNodeID node = 0; node < 100000; node += 3)
+        {
+            heap.Insert(node, node, TestData{node});
+        }
+        heap.Clear();
+        const auto retained = heap.RetainedMemory();
+        BOOST_CHECK_GT(retained, initial);
+
+        heap.Shrink();
+        BOOST_CHECK_LT(heap.RetainedMemory(), retained);
+        BOOST_CHECK(heap.Empty());
+
+        // the heap is still usable afterwards
+        heap.Insert(99999, 1, TestData{1});
+        heap.Insert(0, 2, TestData{2});
+        BOOST_CHECK(!heap.WasInserted(3));
+        BOOST_CHECK_EQUAL(heap.DeleteMin(), 99999);
+        BOOST_CHECK_EQUAL(heap.GetData(0).value, 2);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
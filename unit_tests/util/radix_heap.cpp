@@ -0,0 +1,139 @@
+#include "util/radix_heap.hpp"
+#include "util/query_heap.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(radix_heap)
+
+using namespace osrm;
+using namespace osrm::util;
+
+struct TestData
+{
+    unsigned value;
+};
+
+typedef NodeID TestNodeID;
+typedef int TestKey;
+typedef int TestWeight;
+typedef boost::mpl::list<ArrayStorage<TestNodeID, TestKey>,
+                         UnorderedMapStorage<TestNodeID, TestKey>,
+                         SelectableStorage<TestNodeID, TestKey>>
+    storage_types;
+
+constexpr unsigned NUM_NODES = 100;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(insert_delete_min_test, T, storage_types)
+{
+    RadixQueryHeap<TestNodeID, TestKey, TestWeight, TestData, T> heap(NUM_NODES);
+
+    std::vector<TestNodeID> order(NUM_NODES);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 g(15);
+    std::shuffle(order.begin(), order.end(), g);
+
+    // keys are (id - 50) * 100, so the phantom-like negative keys are covered
+    for (const auto id : order)
+    {
+        BOOST_CHECK(!heap.WasInserted(id));
+        heap.Insert(id, (static_cast<TestWeight>(id) - 50) * 100, TestData{id * 3});
+        BOOST_CHECK(heap.WasInserted(id));
+    }
+    BOOST_CHECK_EQUAL(heap.Size(), NUM_NODES);
+
+    for (TestNodeID id = 0; id < NUM_NODES; ++id)
+    {
+        BOOST_CHECK(!heap.WasRemoved(id));
+        BOOST_CHECK_EQUAL(heap.Min(), id);
+        BOOST_CHECK_EQUAL(heap.MinKey(), (static_cast<TestWeight>(id) - 50) * 100);
+        BOOST_CHECK_EQUAL(heap.DeleteMin(), id);
+        BOOST_CHECK(heap.WasRemoved(id));
+        BOOST_CHECK_EQUAL(heap.GetData(id).value, id * 3);
+    }
+    BOOST_CHECK(heap.Empty());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(delete_all_test, T, storage_types)
+{
+    RadixQueryHeap<TestNodeID, TestKey, TestWeight, TestData, T> heap(NUM_NODES);
+
+    for (TestNodeID id = 0; id < NUM_NODES; ++id)
+    {
+        heap.Insert(id, id, TestData{id});
+    }
+
+    heap.DeleteAll();
+
+    BOOST_CHECK(heap.Empty());
+    BOOST_CHECK(heap.WasInserted(0));
+    BOOST_CHECK(heap.WasRemoved(0));
+
+    heap.Clear();
+    BOOST_CHECK(!heap.WasInserted(0));
+}
+
+// Runs random monotone operation sequences side by side on a QueryHeap and a RadixQueryHeap
+BOOST_AUTO_TEST_CASE(compare_with_query_heap_test)
+{
+    using Storage = ArrayStorage<TestNodeID, TestKey>;
+    QueryHeap<TestNodeID, TestKey, TestWeight, TestData, Storage> reference_heap(1000);
+    RadixQueryHeap<TestNodeID, TestKey, TestWeight, TestData, Storage> heap(1000);
+
+    std::mt19937 g(42);
+    std::uniform_int_distribution<TestNodeID> node_distribution(0, 999);
+    std::uniform_int_distribution<TestWeight> weight_distribution(0, 5000);
+
+    for (int round = 0; round < 10; ++round)
+    {
+        reference_heap.Clear();
+        heap.Clear();
+
+        TestWeight last_weight = -1000;
+        for (int step = 0; step < 3000; ++step)
+        {
+            const auto node = node_distribution(g);
+            const auto weight = last_weight + weight_distribution(g);
+
+            if (!reference_heap.WasInserted(node))
+            {
+                reference_heap.Insert(node, weight, TestData{0});
+                heap.Insert(node, weight, TestData{0});
+            }
+            else if (!reference_heap.WasRemoved(node) && weight < reference_heap.GetKey(node))
+            {
+                reference_heap.DecreaseKey(node, weight);
+                heap.DecreaseKey(node, weight);
+            }
+
+            BOOST_REQUIRE_EQUAL(heap.Size(), reference_heap.Size());
+
+            if (step % 3 == 0 && !reference_heap.Empty())
+            {
+                // ties may be broken differently, so compare all nodes with the minimal key
+                BOOST_REQUIRE_EQUAL(heap.MinKey(), reference_heap.MinKey());
+                last_weight = reference_heap.MinKey();
+
+                std::vector<TestNodeID> reference_nodes, radix_nodes;
+                while (!reference_heap.Empty() && reference_heap.MinKey() == last_weight)
+                    reference_nodes.push_back(reference_heap.DeleteMin());
+                while (!heap.Empty() && heap.MinKey() == last_weight)
+                    radix_nodes.push_back(heap.DeleteMin());
+
+                std::sort(reference_nodes.begin(), reference_nodes.end());
+                std::sort(radix_nodes.begin(), radix_nodes.end());
+                BOOST_REQUIRE(reference_nodes == radix_nodes);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+#include "util/read_epochs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(read_epochs)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(synchronize_without_readers)
+{
+    ReadEpochs::Synchronize();
+
+    // the slot of a finished thread does not block writers
+    std::thread([] { ReadEpochs::ReadSection read_section; }).join();
+    ReadEpochs::Synchronize();
+}
+
+BOOST_AUTO_TEST_CASE(synchronize_waits_for_read_sections)
+{
+    const constexpr std::size_t number_of_values = 2000;
+    const constexpr std::size_t number_of_readers = 4;
+
+    // values are marked as freed instead of freeing them to find reads after the reclamation
+    std::vector<std::atomic<bool>> freed(number_of_values);
+    for (auto &value : freed)
+        value = false;
+    std::atomic<std::size_t> current{0};
+    std::atomic<bool> done{false};
+    std::atomic<std::size_t> reads_of_freed{0};
+
+    std::vector<std::thread> readers;
+    for (std::size_t reader = 0; reader < number_of_readers; ++reader)
+    {
+        readers.emplace_back([&] {
+            while (!done)
+            {
+                ReadEpochs::ReadSection read_section;
+                const auto value = current.load();
+                for (int spin = 0; spin < 100; ++spin)
+                {
+                    if (freed[value])
+                        ++reads_of_freed;
+                }
+            }
+        });
+    }
+
+    for (std::size_t value = 1; value < number_of_values; ++value)
+    {
+        current.store(value);
+        ReadEpochs::Synchronize();
+        freed[value - 1] = true;
+    }
+
+    done = true;
+    for (auto &reader : readers)
+        reader.join();
+
+    BOOST_CHECK_EQUAL(reads_of_freed, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
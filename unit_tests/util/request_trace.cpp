@@ -0,0 +1,70 @@
+#include "util/request_trace.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(request_trace)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(spans_without_trace)
+{
+    // nothing is recorded if the thread has no trace
+    const TraceSpan span("untraced");
+    BOOST_CHECK(detail::threadTrace() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(nested_spans)
+{
+    RequestTrace trace;
+    {
+        const TraceScope scope(&trace);
+        TraceSpan query("query");
+        {
+            const TraceSpan search("search");
+            const TraceSpan unpacking("unpacking");
+        }
+        query.Stop();
+        const TraceSpan rendering("rendering");
+    }
+    BOOST_CHECK(detail::threadTrace() == nullptr);
+
+    const auto &spans = trace.GetSpans();
+    BOOST_REQUIRE_EQUAL(spans.size(), 4);
+    BOOST_CHECK_EQUAL(spans[0].name, "query");
+    BOOST_CHECK_EQUAL(spans[0].depth, 0);
+    BOOST_CHECK_EQUAL(spans[1].name, "search");
+    BOOST_CHECK_EQUAL(spans[1].depth, 1);
+    BOOST_CHECK_EQUAL(spans[2].name, "unpacking");
+    BOOST_CHECK_EQUAL(spans[2].depth, 2);
+    BOOST_CHECK_EQUAL(spans[3].name, "rendering");
+    BOOST_CHECK_EQUAL(spans[3].depth, 0);
+
+    // the spans are nested into their parents
+    BOOST_CHECK(spans[1].start >= spans[0].start);
+    BOOST_CHECK(spans[1].start + spans[1].duration <= spans[0].start + spans[0].duration);
+    BOOST_CHECK(spans[3].start >= spans[0].start + spans[0].duration);
+
+    const auto json = trace.ToJSON("/route/v1/driving/1,2;3,4", 200);
+    BOOST_CHECK_EQUAL(json.values.at("status").get<json::Number>().value, 200);
+    const auto &spans_json = json.values.at("spans").get<json::Array>().values;
+    BOOST_REQUIRE_EQUAL(spans_json.size(), 4);
+    const auto &unpacking = spans_json[2].get<json::Object>().values;
+    BOOST_CHECK_EQUAL(unpacking.at("name").get<json::String>().value, "unpacking");
+    BOOST_CHECK_EQUAL(unpacking.at("depth").get<json::Number>().value, 2);
+    BOOST_CHECK_GE(unpacking.at("duration_ms").get<json::Number>().value, 0);
+}
+
+BOOST_AUTO_TEST_CASE(dropped_spans)
+{
+    RequestTrace trace;
+    const TraceScope scope(&trace);
+    for (std::size_t span = 0; span < RequestTrace::MAX_SPANS + 10; ++span)
+    {
+        const TraceSpan search("search");
+    }
+    const TraceSpan rendering("rendering");
+    BOOST_CHECK_EQUAL(trace.GetSpans().size(), RequestTrace::MAX_SPANS);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+#include "util/search_counters.hpp"
+#include "util/query_heap.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(search_counters)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+std::string format(const SearchCounters &counters)
+{
+    std::ostringstream out;
+    out << counters;
+    return out.str();
+}
+}
+
+BOOST_AUTO_TEST_CASE(format_and_add_counters)
+{
+    SearchCounters counters;
+    BOOST_CHECK_EQUAL(format(counters), "settled=0 inserts=0 decreases=0 relaxed=0 cells=0 unpacked=0");
+
+    counters.SettleNode();
+    counters.InsertNode();
+    counters.InsertNode();
+    counters.RelaxEdge();
+    counters.EnterCell(1);
+    counters.EnterCell(2);
+    counters.EnterCell(100);
+    counters.UnpackEdges(4);
+
+    SearchCounters total = counters;
+    total += counters;
+    BOOST_CHECK_EQUAL(
+        format(total),
+        "settled=2 inserts=4 decreases=0 relaxed=2 cells=0/2/2/0/0/0/0/2 unpacked=8");
+}
+
+BOOST_AUTO_TEST_CASE(count_searches_of_tasks)
+{
+    threadSearchCounters() = SearchCounters{};
+    OSRM_COUNT_SEARCH(SettleNode());
+
+    const auto task_counters = countSearches([] {
+        QueryHeap<NodeID, int, int, int, ArrayStorage<NodeID, int>> heap(10);
+        heap.Insert(1, 10, 0);
+        heap.Insert(2, 20, 0);
+        heap.DecreaseKey(2, 5);
+        heap.DeleteMin();
+    });
+
+#ifdef OSRM_ENABLE_SEARCH_COUNTERS
+    BOOST_CHECK_EQUAL(task_counters.settled_nodes, 1);
+    BOOST_CHECK_EQUAL(task_counters.heap_inserts, 2);
+    BOOST_CHECK_EQUAL(task_counters.heap_decreases, 1);
+    BOOST_CHECK_EQUAL(threadSearchCounters().settled_nodes, 1);
+    BOOST_CHECK_EQUAL(threadSearchCounters().heap_inserts, 0);
+#else
+    BOOST_CHECK_EQUAL(task_counters.settled_nodes, 0);
+    BOOST_CHECK_EQUAL(threadSearchCounters().settled_nodes, 0);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(time_outermost_unpacking)
+{
+    threadSearchCounters() = SearchCounters{};
+    {
+        UnpackingTimer outer_timer;
+        {
+            UnpackingTimer inner_timer;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        BOOST_CHECK_EQUAL(threadSearchCounters().unpack_nanoseconds, 0);
+    }
+    BOOST_CHECK_GE(threadSearchCounters().unpack_nanoseconds, 2000000);
+    BOOST_CHECK_LT(threadSearchCounters().unpack_nanoseconds, 1000000000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -77,6 +77,67 @@ BOOST_AUTO_TEST_CASE(tar_serialize_packed_vector)
     }
 }
 
+BOOST_AUTO_TEST_CASE(tar_serialize_block_compressed_vector)
+{
+    TemporaryFile tmp;
+    {
+        using TestBlockCompressedVector = BlockCompressedVector<std::uint32_t>;
+
+        std::vector<std::vector<std::uint32_t>> data = {
+            {1597322404, 1939964443, 2112255763, 1432114613, 1067854538, 352118606},
+            {0, 1, 2, 3},
+            {}};
+
+        for (const auto &v : data)
+        {
+            TestBlockCompressedVector reference{v};
+            {
+                storage::tar::FileWriter writer(tmp.path,
+                                                storage::tar::FileWriter::GenerateFingerprint);
+                util::serialization::write(writer, "my_compressed_vector", reference);
+            }
+
+            TestBlockCompressedVector result;
+            storage::tar::FileReader reader(tmp.path, storage::tar::FileReader::VerifyFingerprint);
+            util::serialization::read(reader, "my_compressed_vector", result);
+
+            CHECK_EQUAL_COLLECTIONS(result, v);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tar_serialize_dictionary_vector)
+{
+    TemporaryFile tmp;
+    {
+        using TestDictionaryVector = DictionaryVector<std::int16_t>;
+
+        std::vector<std::int16_t> many_values;
+        for (std::int16_t value = -300; value < 300; ++value)
+            many_values.push_back(value);
+
+        std::vector<std::vector<std::int16_t>> data = {
+            {0, 0, 20, 0, 200, 0, 0, -1}, many_values, {}};
+
+        for (const auto &v : data)
+        {
+            TestDictionaryVector reference{v};
+            {
+                storage::tar::FileWriter writer(tmp.path,
+                                                storage::tar::FileWriter::GenerateFingerprint);
+                util::serialization::write(writer, "my_dictionary_vector", reference);
+            }
+
+            TestDictionaryVector result;
+            storage::tar::FileReader reader(tmp.path, storage::tar::FileReader::VerifyFingerprint);
+            util::serialization::read(reader, "my_dictionary_vector", result);
+
+            BOOST_CHECK_EQUAL(result.number_of_exceptions(), reference.number_of_exceptions());
+            CHECK_EQUAL_COLLECTIONS(result, v);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(tar_serialize_variable_indexed_data)
 {
     TemporaryFile tmp;
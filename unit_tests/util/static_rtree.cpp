@@ -294,6 +294,216 @@ BOOST_FIXTURE_TEST_CASE(construct_multiple_levels_test, TestRandomGraphFixture_M
     construction_test("test_5", *this);
 }
 
+BOOST_FIXTURE_TEST_CASE(construct_runtime_layout_test, TestRandomGraphFixture_MultipleLevels)
+{
+    // the tree uses the layout it is built with instead of the template defaults
+    TestStaticRTree rtree(edges, coords, "test_layout", 3, 128);
+    LinearSearchNN<TestData> lsnn(coords, edges);
+
+    simple_verify_rtree(rtree, coords, edges);
+    sampling_verify_rtree(rtree, lsnn, coords, 100);
+
+    BOOST_CHECK_THROW((TestStaticRTree{edges, coords, "test_layout", 1, 128}), osrm::util::exception);
+    BOOST_CHECK_THROW((TestStaticRTree{edges, coords, "test_layout", 3, 100}), osrm::util::exception);
+}
+
+BOOST_FIXTURE_TEST_CASE(bearing_sectors_test, TestRandomGraphFixture_MultipleLevels)
+{
+    auto edges_in_both_directions = edges;
+    for (auto index : irange<std::size_t>(0, edges_in_both_directions.size()))
+    {
+        edges_in_both_directions[index].forward_segment_id = {static_cast<NodeID>(index), true};
+        edges_in_both_directions[index].reverse_segment_id = {static_cast<NodeID>(index), true};
+    }
+    TemporaryFile tmp;
+    TestStaticRTree rtree(edges_in_both_directions, coords, tmp.path);
+
+    const int filter_bearing = 90;
+    const int filter_range = 20;
+    const auto filter = [&](const TestStaticRTree::CandidateSegment &segment) {
+        const auto forward_bearing =
+            coordinate_calculation::bearing(coords[segment.data.u], coords[segment.data.v]);
+        const auto backward_bearing =
+            forward_bearing + 180 > 360 ? forward_bearing - 180 : forward_bearing + 180;
+        return std::make_pair(
+            bearing::CheckInBounds(std::round(forward_bearing), filter_bearing, filter_range),
+            bearing::CheckInBounds(std::round(backward_bearing), filter_bearing, filter_range));
+    };
+    // all segments with matching bearings are found, not only the nearest ones which could tie
+    const auto terminate = [](const std::size_t, const TestStaticRTree::CandidateSegment &) {
+        return false;
+    };
+
+    std::mt19937 g(RANDOM_SEED);
+    std::uniform_int_distribution<> lat_udist(WORLD_MIN_LAT, WORLD_MAX_LAT);
+    std::uniform_int_distribution<> lon_udist(WORLD_MIN_LON, WORLD_MAX_LON);
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        const Coordinate input(FixedLongitude{lon_udist(g)}, FixedLatitude{lat_udist(g)});
+
+        // skipping the subtrees without matching bearings does not change the results
+        const auto all_results = rtree.Nearest(input, filter, terminate);
+        const auto results = rtree.Nearest(
+            input, filter, terminate, bearing::sectorMask(filter_bearing, filter_range));
+        // segments in the same distance are found in any order
+        const auto ids = [](const std::vector<TestData> &segments) {
+            std::vector<NodeID> ids;
+            for (const auto &segment : segments)
+                ids.push_back(segment.forward_segment_id.id);
+            std::sort(ids.begin(), ids.end());
+            return ids;
+        };
+        const auto result_ids = ids(results);
+        const auto all_result_ids = ids(all_results);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            result_ids.begin(), result_ids.end(), all_result_ids.begin(), all_result_ids.end());
+
+        const auto none = rtree.Nearest(input, filter, terminate, 0);
+        BOOST_CHECK_EQUAL(none.size(), 0);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(big_component_nodes_test, TestRandomGraphFixture_MultipleLevels)
+{
+    // most segments are in tiny components, the nearest big one is usually far away
+    auto segments = edges;
+    std::vector<bool> tiny_component_segments(segments.size());
+    for (auto index : irange<std::size_t>(0, segments.size()))
+    {
+        segments[index].forward_segment_id = {static_cast<NodeID>(index), true};
+        tiny_component_segments[index] = index % 50 != 0;
+    }
+    TemporaryFile tmp;
+    TestStaticRTree rtree(segments,
+                          coords,
+                          tmp.path,
+                          TEST_BRANCHING_FACTOR,
+                          TEST_LEAF_NODE_SIZE,
+                          tiny_component_segments);
+
+    std::mt19937 g(RANDOM_SEED);
+    std::uniform_int_distribution<> lat_udist(WORLD_MIN_LAT, WORLD_MAX_LAT);
+    std::uniform_int_distribution<> lon_udist(WORLD_MIN_LON, WORLD_MAX_LON);
+    for (unsigned i = 0; i < 100; ++i)
+    {
+        const Coordinate input(FixedLongitude{lon_udist(g)}, FixedLatitude{lat_udist(g)});
+
+        // the nearest segment and the nearest segment in a big component, like
+        // GeospatialQuery::NearestPhantomNodeWithAlternativeFromBigComponent
+        const auto nearest = [&](const bool big_components_after_first_result) {
+            bool has_small_component = false;
+            bool has_big_component = false;
+            return rtree.Nearest(
+                input,
+                [&](const TestStaticRTree::CandidateSegment &segment) {
+                    const bool is_tiny =
+                        tiny_component_segments[segment.data.forward_segment_id.id];
+                    const bool use_segment =
+                        !has_small_component || (!has_big_component && !is_tiny);
+                    has_big_component = has_big_component || (use_segment && !is_tiny);
+                    has_small_component = has_small_component || (use_segment && is_tiny);
+                    return std::make_pair(use_segment, use_segment);
+                },
+                [&](const std::size_t num_results, const TestStaticRTree::CandidateSegment &) {
+                    return num_results > 0 && has_big_component;
+                },
+                bearing::ALL_SECTORS,
+                big_components_after_first_result);
+        };
+
+        const auto all_results = nearest(false);
+        const auto results = nearest(true);
+        BOOST_REQUIRE_EQUAL(results.size(), all_results.size());
+        BOOST_CHECK_EQUAL(results.front().forward_segment_id.id,
+                          all_results.front().forward_segment_id.id);
+        BOOST_CHECK(!tiny_component_segments[results.back().forward_segment_id.id]);
+        const auto distance = [&](const TestData &segment) {
+            return coordinate_calculation::perpendicularDistance(
+                coords[segment.u], coords[segment.v], input);
+        };
+        BOOST_CHECK_CLOSE(distance(results.back()), distance(all_results.back()), 0.0001);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(nearest_k_test, TestRandomGraphFixture_MultipleLevels)
+{
+    auto segments = edges;
+    for (auto index : irange<std::size_t>(0, segments.size()))
+    {
+        segments[index].forward_segment_id = {static_cast<NodeID>(index), true};
+        segments[index].reverse_segment_id = {static_cast<NodeID>(index), index % 2 == 0};
+    }
+    TemporaryFile tmp;
+    TestStaticRTree rtree(segments, coords, tmp.path);
+
+    // every third segment is rejected, the reverse direction of some others too
+    const auto filter = [](const TestStaticRTree::CandidateSegment &segment) {
+        const auto id = segment.data.forward_segment_id.id;
+        return std::make_pair(id % 3 != 0, id % 3 != 0 && id % 5 != 0);
+    };
+
+    std::mt19937 g(RANDOM_SEED);
+    std::uniform_int_distribution<> lat_udist(WORLD_MIN_LAT, WORLD_MAX_LAT);
+    std::uniform_int_distribution<> lon_udist(WORLD_MIN_LON, WORLD_MAX_LON);
+    for (unsigned i = 0; i < 100; ++i)
+    {
+        const Coordinate input(FixedLongitude{lon_udist(g)}, FixedLatitude{lat_udist(g)});
+        const auto distance = [&](const TestData &segment) {
+            return coordinate_calculation::perpendicularDistance(
+                coords[segment.u], coords[segment.v], input);
+        };
+
+        for (const std::size_t max_results : {1, 7, 100})
+        {
+            // the same segments as a search that stops after max_results results
+            const auto expected = rtree.Nearest(
+                input,
+                filter,
+                [max_results](const std::size_t num_results,
+                              const TestStaticRTree::CandidateSegment &) {
+                    return num_results >= max_results;
+                });
+            const auto results = rtree.NearestK(
+                input, max_results, filter, [](const TestStaticRTree::CandidateSegment &) {
+                    return false;
+                });
+            // segments that share a node are often in the same distance and found in any order
+            BOOST_REQUIRE_EQUAL(results.size(), expected.size());
+            for (auto index : irange<std::size_t>(0, results.size()))
+            {
+                BOOST_CHECK_CLOSE(distance(results[index]), distance(expected[index]), 0.0001);
+
+                const auto id = results[index].forward_segment_id.id;
+                BOOST_CHECK_EQUAL(results[index].forward_segment_id.enabled, id % 3 != 0);
+                BOOST_CHECK_EQUAL(results[index].reverse_segment_id.enabled,
+                                  id % 2 == 0 && id % 3 != 0 && id % 5 != 0);
+            }
+        }
+
+        // no segment at or behind the first one that is too far is returned
+        const double max_distance = 500000;
+        const auto too_far = [&](const TestStaticRTree::CandidateSegment &segment) {
+            const Coordinate projected{web_mercator::toWGS84(segment.fixed_projected_coordinate)};
+            return coordinate_calculation::haversineDistance(input, projected) > max_distance;
+        };
+        const auto expected = rtree.Nearest(
+            input,
+            filter,
+            [&](const std::size_t num_results, const TestStaticRTree::CandidateSegment &segment) {
+                return num_results >= 20 || too_far(segment);
+            });
+        const auto results = rtree.NearestK(input, 20, filter, too_far);
+        BOOST_REQUIRE_EQUAL(results.size(), expected.size());
+        if (!results.empty())
+        {
+            BOOST_CHECK_CLOSE(distance(results.back()), distance(expected.back()), 0.0001);
+        }
+    }
+
+    BOOST_CHECK(rtree.NearestK(coords.front(), 0, filter, [](const auto &) { return false; })
+                    .empty());
+}
+
 // Bug: If you querry a point that lies between two BBs that have a gap,
 // one BB will be pruned, even if it could contain a nearer match.
 BOOST_AUTO_TEST_CASE(regression_test)